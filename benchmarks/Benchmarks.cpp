@@ -0,0 +1,143 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Benchmarks.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "Suite.h"
+#include "edb.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTimer>
+#include <QtDebug>
+
+namespace BenchmarksPlugin {
+namespace {
+
+const int PollInterval = 100;  // ms
+const int MaxPolls     = 600;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: Benchmarks
+// Desc:
+//------------------------------------------------------------------------------
+Benchmarks::Benchmarks() : stage_(Starting), polls_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~Benchmarks
+// Desc:
+//------------------------------------------------------------------------------
+Benchmarks::~Benchmarks() {
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc: there is nothing to do interactively
+//------------------------------------------------------------------------------
+QMenu *Benchmarks::menu(QWidget *parent) {
+	Q_UNUSED(parent);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: extra_arguments
+// Desc:
+//------------------------------------------------------------------------------
+QString Benchmarks::extra_arguments() const {
+	return " --benchmark <filename>    : run the benchmarks against edb-bench-target, write the results to <filename> and exit";
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_arguments
+// Desc:
+//------------------------------------------------------------------------------
+IPlugin::ArgumentStatus Benchmarks::parse_arguments(QStringList &args) {
+
+	if(args.size() >= 2 && args[1] == "--benchmark") {
+		if(args.size() < 3) {
+			return ARG_ERROR;
+		}
+
+		filename_ = args[2];
+		args.erase(args.begin() + 1, args.begin() + 3);
+		QTimer::singleShot(PollInterval, this, SLOT(poll()));
+	}
+
+	return ARG_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Name: poll
+// Desc: waits for the target to stop at its first breakpoint, lets it run
+//       until it has set its memory up and stopped itself, then benchmarks
+//------------------------------------------------------------------------------
+void Benchmarks::poll() {
+
+	if(++polls_ > MaxPolls) {
+		qWarning() << "[Benchmarks] edb-bench-target never got ready";
+		finish(-1);
+		return;
+	}
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	if(!process || !process->isPaused()) {
+		QTimer::singleShot(PollInterval, this, SLOT(poll()));
+		return;
+	}
+
+	if(stage_ == Starting) {
+		stage_ = Running;
+		QMetaObject::invokeMethod(edb::v1::debugger_ui, "on_action_Run_triggered");
+		QTimer::singleShot(PollInterval, this, SLOT(poll()));
+		return;
+	}
+
+	const QVector<BenchmarkResult> results = run_suite();
+
+	QFile file(filename_);
+	if(results.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "[Benchmarks] unable to write" << filename_;
+		finish(-1);
+		return;
+	}
+
+	file.write(format_results(results));
+	finish(0);
+}
+
+//------------------------------------------------------------------------------
+// Name: finish
+// Desc:
+//------------------------------------------------------------------------------
+void Benchmarks::finish(int exit_code) {
+	if(edb::v1::debugger_core->process()) {
+		edb::v1::debugger_core->kill();
+	}
+	QCoreApplication::exit(exit_code);
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Benchmarks, Benchmarks)
+#endif
+
+}
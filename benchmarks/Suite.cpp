@@ -0,0 +1,397 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Suite.h"
+#include "IAnalyzer.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "ISymbolManager.h"
+#include "Instruction.h"
+#include "MemoryRegions.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
+#include "Symbol.h"
+#include "edb.h"
+#include "version.h"
+
+#include <QAbstractScrollArea>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace BenchmarksPlugin {
+namespace {
+
+// one iteration of a benchmark, returns how many items it found or handled
+typedef std::function<quint64()> Body;
+
+//------------------------------------------------------------------------------
+// Name: measure
+// Desc: runs <body> <iterations> times, after one untimed warm up run
+//------------------------------------------------------------------------------
+BenchmarkResult measure(const QString &name, int iterations, quint64 bytes, const Body &body) {
+
+	const quint64 items = body();
+
+	QElapsedTimer timer;
+	timer.start();
+	for(int i = 0; i < iterations; ++i) {
+		body();
+	}
+
+	BenchmarkResult result = { name, iterations, timer.nsecsElapsed(), bytes, items };
+	qDebug() << "[Benchmarks]" << qPrintable(name) << result.nsecs / iterations << "ns";
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// Name: largest_region
+// Desc: the largest region of the process which is writable or executable
+//------------------------------------------------------------------------------
+std::shared_ptr<IRegion> largest_region(bool executable) {
+	std::shared_ptr<IRegion> largest;
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(region->readable() && (executable ? region->executable() : region->writable())) {
+			if(!largest || region->size() > largest->size()) {
+				largest = region;
+			}
+		}
+	}
+	return largest;
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_reads
+// Desc: reads <region> (up to <limit> bytes of it) <chunk> bytes at a time
+//------------------------------------------------------------------------------
+BenchmarkResult bench_reads(const std::shared_ptr<IRegion> &region, std::size_t chunk, std::size_t limit) {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	const std::size_t size  = std::min<std::size_t>(region->size(), limit);
+
+	QByteArray buffer(static_cast<int>(chunk), '\0');
+	return measure(QString("read_bytes/%1").arg(chunk), 5, size, [&]() {
+		quint64 reads = 0;
+		for(std::size_t offset = 0; offset + chunk <= size; offset += chunk) {
+			process->read_bytes(region->start() + offset, buffer.data(), chunk);
+			++reads;
+		}
+		return reads;
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_page_reads
+// Desc: reads all of <region>, <pages> pages at a time
+//------------------------------------------------------------------------------
+BenchmarkResult bench_page_reads(const std::shared_ptr<IRegion> &region, std::size_t pages) {
+
+	IProcess *const process     = edb::v1::debugger_core->process();
+	const std::size_t page_size = edb::v1::debugger_core->page_size();
+	const std::size_t count     = region->size() / page_size;
+
+	QByteArray buffer(static_cast<int>(pages * page_size), '\0');
+	return measure(QString("read_pages/%1").arg(pages), 5, count * page_size, [&]() {
+		quint64 reads = 0;
+		for(std::size_t page = 0; page < count; page += pages) {
+			process->read_pages(region->start() + page * page_size, buffer.data(), std::min(pages, count - page));
+			++reads;
+		}
+		return reads;
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_search
+// Desc: a whole region search with <matcher>, the way the search plugins do
+//------------------------------------------------------------------------------
+BenchmarkResult bench_search(const QString &name, const std::shared_ptr<IRegion> &region, const RegionSearch::Matcher &matcher, std::size_t overlap) {
+
+	const RegionSearch search(matcher, overlap);
+	return measure(name, 3, region->size(), [&]() {
+		quint64 found = 0;
+		search.run(region, [&found](const QVector<SearchResult> &results) {
+			found += results.size();
+		});
+		return found;
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: pattern_matcher
+// Desc: like the binary string search
+//------------------------------------------------------------------------------
+RegionSearch::Matcher pattern_matcher(const QByteArray &pattern) {
+	return [pattern](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+		const char *const first = reinterpret_cast<const char *>(window.data.constData());
+		const char *const last  = first + window.data.size();
+		for(const char *p = std::search(first, last, pattern.begin(), pattern.end()); p != last; p = std::search(p + 1, last, pattern.begin(), pattern.end())) {
+			results.push_back({window.address + (p - first), QString(), 0, static_cast<quint32>(pattern.size())});
+		}
+		return results;
+	};
+}
+
+//------------------------------------------------------------------------------
+// Name: reference_matcher
+// Desc: like the references search, aligned pointers into [first, last)
+//------------------------------------------------------------------------------
+RegionSearch::Matcher reference_matcher(edb::address_t start, edb::address_t end) {
+	const quint64 first = start.toUint();
+	const quint64 last  = end.toUint();
+	return [first, last](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+		const std::size_t pointer_size = edb::v1::pointer_size();
+		for(std::size_t i = 0; i + pointer_size <= static_cast<std::size_t>(window.data.size()); i += pointer_size) {
+			quint64 value = 0;
+			std::memcpy(&value, window.data.constData() + i, pointer_size);
+			if(value >= first && value < last) {
+				results.push_back({window.address + i, QString(), 0, static_cast<quint32>(pointer_size)});
+			}
+		}
+		return results;
+	};
+}
+
+//------------------------------------------------------------------------------
+// Name: string_matcher
+// Desc: like the strings search, runs of at least 4 printable characters. A
+//       run reaching the end of a window is left to the next one
+//------------------------------------------------------------------------------
+RegionSearch::Matcher string_matcher() {
+	return [](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+		const int size = window.data.size();
+		int start      = -1;
+		for(int i = 0; i < size; ++i) {
+			const bool printable = std::isprint(window.data[i]) || window.data[i] == '\t';
+			if(printable && start < 0) {
+				start = i;
+			} else if(!printable && start >= 0) {
+				if(i - start >= 4 && static_cast<std::size_t>(start) >= window.repeated) {
+					results.push_back({window.address + start, QString(), 0, static_cast<quint32>(i - start)});
+				}
+				start = -1;
+			}
+		}
+		return results;
+	};
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_decode
+// Desc: decodes <region> (up to <limit> bytes of it) from start to end
+//------------------------------------------------------------------------------
+BenchmarkResult bench_decode(const std::shared_ptr<IRegion> &region, std::size_t limit) {
+
+	const std::size_t size = std::min<std::size_t>(region->size(), limit);
+
+	QByteArray code(static_cast<int>(size), '\0');
+	edb::v1::debugger_core->process()->read_bytes(region->start(), code.data(), size);
+
+	const auto first = reinterpret_cast<const quint8 *>(code.constData());
+	const auto last  = first + code.size();
+
+	return measure("decode", 3, size, [&]() {
+		quint64 count = 0;
+		for(const quint8 *p = first; p < last; ++count) {
+			edb::Instruction inst(p, last, (region->start() + (p - first)).toUint());
+			p += inst.valid() ? inst.byte_size() : 1;
+		}
+		return count;
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_symbols
+// Desc: loading the symbols of every module, then looking them up by address
+//       and by name
+//------------------------------------------------------------------------------
+QVector<BenchmarkResult> bench_symbols(const std::shared_ptr<IRegion> &code) {
+
+	QVector<BenchmarkResult> results;
+	ISymbolManager &symbols = edb::v1::symbol_manager();
+
+	results.push_back(measure("symbols/load", 3, 0, [&]() {
+		symbols.clear();
+		for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+			if(region->executable()) {
+				symbols.find_near_symbol(region->start());
+			}
+		}
+		return static_cast<quint64>(symbols.symbols().size());
+	}));
+
+	const int lookups = 100000;
+	const edb::address_t step = std::max<edb::address_t>(code->size() / lookups, edb::address_t(1));
+	results.push_back(measure("symbols/find_near_symbol", 3, 0, [&]() {
+		quint64 found = 0;
+		for(edb::address_t address = code->start(); address < code->end(); address += step) {
+			if(symbols.find_near_symbol(address)) {
+				++found;
+			}
+		}
+		return found;
+	}));
+
+	QStringList names;
+	for(const std::shared_ptr<Symbol> &symbol : symbols.symbols()) {
+		names.push_back(symbol->name);
+		if(names.size() == lookups) {
+			break;
+		}
+	}
+
+	results.push_back(measure("symbols/find_name", 3, 0, [&]() {
+		quint64 found = 0;
+		for(const QString &name : names) {
+			if(symbols.find(name)) {
+				++found;
+			}
+		}
+		return found;
+	}));
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: bench_paint
+// Desc: paints the disassembly view into an image, so it works offscreen too
+//------------------------------------------------------------------------------
+BenchmarkResult bench_paint(const std::shared_ptr<IRegion> &code) {
+
+	QAbstractScrollArea *const view = edb::v1::disassembly_widget();
+	edb::v1::jump_to_address(code->start());
+
+	QWidget *const viewport = view->viewport();
+	QImage image(viewport->size(), QImage::Format_ARGB32_Premultiplied);
+
+	return measure("disassembly_paint", 50, 0, [&]() {
+		viewport->render(&image);
+		return quint64(1);
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: json_string
+// Desc:
+//------------------------------------------------------------------------------
+QByteArray json_string(const QString &s) {
+	QByteArray result = "\"";
+	for(const QChar ch : s) {
+		if(ch == '"' || ch == '\\') {
+			result.append('\\');
+		}
+		result.append(ch.toLatin1());
+	}
+	result.append('"');
+	return result;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: run_suite
+// Desc:
+//------------------------------------------------------------------------------
+QVector<BenchmarkResult> run_suite() {
+
+	QVector<BenchmarkResult> results;
+
+	edb::v1::memory_regions().sync();
+
+	const std::shared_ptr<IRegion> data    = largest_region(false);
+	const std::shared_ptr<IRegion> library = largest_region(true);
+	const std::shared_ptr<IRegion> program = edb::v1::primary_code_region();
+	if(!data || !library || !program) {
+		qWarning() << "[Benchmarks] the process doesn't look like edb-bench-target";
+		return results;
+	}
+
+	// reads
+	for(std::size_t chunk : {std::size_t(8), std::size_t(4096), std::size_t(1024 * 1024)}) {
+		results.push_back(bench_reads(data, chunk, chunk < 4096 ? 1024 * 1024 : data->size()));
+	}
+
+	for(std::size_t pages : {std::size_t(1), std::size_t(256)}) {
+		results.push_back(bench_page_reads(data, pages));
+	}
+
+	// analysis
+	if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+		for(const std::shared_ptr<IRegion> &region : {program, library}) {
+			results.push_back(measure(QString("analyze/%1").arg(region == program ? "program" : "library"), 3, region->size(), [&]() {
+				analyzer->invalidate_analysis(region);
+				analyzer->analyze(region);
+				return static_cast<quint64>(analyzer->functions(region).size());
+			}));
+		}
+	}
+
+	// the scans of the search plugins
+	results.push_back(bench_search("search/pattern", data, pattern_matcher("edb-bench-"), 9));
+	results.push_back(bench_search("search/references", data, reference_matcher(data->start(), data->end()), edb::v1::pointer_size() - 1));
+	results.push_back(bench_search("search/strings", data, string_matcher(), 0));
+
+	// decoding, symbols and painting
+	results.push_back(bench_decode(library, 4 * 1024 * 1024));
+	results += bench_symbols(library);
+	if(edb::v1::debugger_ui) {
+		results.push_back(bench_paint(library));
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: format_results
+// Desc:
+//------------------------------------------------------------------------------
+QByteArray format_results(const QVector<BenchmarkResult> &results) {
+
+	QByteArray json = "{\n";
+	json.append("  \"edb_version\": " + json_string(edb::version) + ",\n");
+	json.append("  \"time\": " + json_string(QDateTime::currentDateTimeUtc().toString(Qt::ISODate)) + ",\n");
+	json.append("  \"results\": [");
+
+	for(int i = 0; i < results.size(); ++i) {
+		const BenchmarkResult &r = results[i];
+		json.append(i ? ",\n    " : "\n    ");
+		json.append(QString("{\"name\": %1, \"iterations\": %2, \"nsecs\": %3, \"nsecs_per_iteration\": %4, \"bytes\": %5, \"items\": %6}")
+			.arg(QString::fromLatin1(json_string(r.name)))
+			.arg(r.iterations)
+			.arg(r.nsecs)
+			.arg(r.nsecs / r.iterations)
+			.arg(r.bytes)
+			.arg(r.items).toLatin1());
+	}
+
+	json.append("\n  ]\n}\n");
+	return json;
+}
+
+}
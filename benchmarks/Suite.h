@@ -0,0 +1,46 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SUITE_20171014_H_
+#define SUITE_20171014_H_
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace BenchmarksPlugin {
+
+struct BenchmarkResult {
+	QString name;
+	int     iterations;
+	qint64  nsecs;  // all iterations together
+	quint64 bytes;  // processed by one iteration, 0 if it doesn't apply
+	quint64 items;  // found or handled by one iteration, 0 if it doesn't apply
+};
+
+// runs every benchmark against the process being debugged, which is expected
+// to be edb-bench-target stopped once it is ready
+QVector<BenchmarkResult> run_suite();
+
+// the results as a JSON document, one object per benchmark
+QByteArray format_results(const QVector<BenchmarkResult> &results);
+
+}
+
+#endif
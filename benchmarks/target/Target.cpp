@@ -0,0 +1,61 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// the debuggee of the benchmarks. It fills a fixed block of memory the same
+// way every time, with strings and pointers sprinkled in for the scans to
+// find, then stops itself so that edb knows it is ready
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const std::size_t DataSize      = 16 * 1024 * 1024;
+const std::size_t StringSpacing = 4096;
+const std::size_t PointerSpacing = 8192;
+
+unsigned char data[DataSize];
+
+}
+
+int main() {
+
+	// a plain LCG, so the bytes are the same on every run and platform
+	std::uint32_t seed = 0x12345678;
+	for(std::size_t i = 0; i < DataSize; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		data[i] = static_cast<unsigned char>(seed >> 16);
+	}
+
+	char text[32];
+	for(std::size_t i = 0; i + sizeof(text) <= DataSize; i += StringSpacing) {
+		const int n = std::snprintf(text, sizeof(text), "edb-bench-%08zu", i / StringSpacing);
+		std::memcpy(&data[i], text, n + 1);
+	}
+
+	for(std::size_t i = StringSpacing / 2; i + sizeof(void *) <= DataSize; i += PointerSpacing) {
+		const void *const p = &data[0];
+		std::memcpy(&data[i], &p, sizeof(p));
+	}
+
+	std::raise(SIGSTOP);
+	return data[DataSize / 2];
+}
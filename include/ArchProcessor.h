@@ -23,11 +23,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include "Status.h"
 #include <QObject>
+#include <QStringList>
 
 class QByteArray;
 class QMenu;
 class QString;
-class QStringList;
 class State;
 
 class ArchProcessor : public QObject {
@@ -47,12 +47,25 @@ public:
 	edb::address_t get_effective_address(const edb::Instruction &inst, const edb::Operand &op, const State &state, bool& ok) const;
 	void reset();
 	void about_to_resume();
+	void invalidate_instruction_info();
 	void setup_register_view();
 	void update_register_view(const QString &default_region_name, const State &state);
 	std::unique_ptr<QMenu> register_item_context_menu(const Register& reg);
 	RegisterViewModelBase::Model& get_register_view_model() const;
 
 private:
+	struct InstructionInfo {
+		bool                  valid = false;
+		edb::address_t        address;
+		quint64               epoch;
+		quint64               symbols_generation;
+		std::vector<Register> registers;
+		QStringList           text;
+	};
+
+private:
+	InstructionInfo instruction_info_; // what update_instruction_info last worked out
+	quint64         epoch_ = 0;        // bumped whenever the debuggee may have changed
 	bool just_attached_ = true;
 	bool has_mmx_;
 	bool has_xmm_;
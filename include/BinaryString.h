@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace Ui { class BinaryStringWidget; }
 
+class HexStringValidator;
 class QString;
 class QByteArray;
 
@@ -42,13 +43,16 @@ private Q_SLOTS:
 
 public:
 	void setMaxLength(int n);
+	void setWildcardsAllowed(bool allowed);
 	QByteArray value() const;
+	QByteArray mask() const;
 	void setValue(const QByteArray &);
 
 private:
 	void setEntriesMaxLength(int n);
 
 	Ui::BinaryStringWidget *const ui;
+	HexStringValidator *const     validator_;
 	enum class Mode {
 	    LengthLimited, // obeys setMaxLength()
 	    MemoryEditing  // obeys user's choice in keepSize checkbox
@@ -0,0 +1,45 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BRANCH_TRACE_20170705_H_
+#define BRANCH_TRACE_20170705_H_
+
+#include "Types.h"
+#include <QVector>
+
+// a branch taken by the debuggee, as recorded by the CPU
+struct BranchRecord {
+	edb::address_t from = 0; // the branch instruction
+	edb::address_t to   = 0; // where it went
+};
+
+// the branch history of one thread at the moment it was sampled, oldest
+// first. Consecutive records are contiguous, everything from one record's
+// "to" up to the next record's "from" executed without branching, but there
+// is no such relation between different samples
+struct BranchSample {
+	edb::tid_t            tid = 0;
+	QVector<BranchRecord> branches;
+};
+
+// the result of IDebugger::stop_branch_trace
+struct BranchTrace {
+	QVector<BranchSample> samples;
+	quint64               lost = 0; // samples the kernel or the core had to drop
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BYTE_PATTERN_20170716_H_
+#define BYTE_PATTERN_20170716_H_
+
+#include "API.h"
+#include <QByteArray>
+#include <QVector>
+
+// A byte string to search memory for, where each byte may be only partly
+// given: a byte matches p[i] when (byte & mask[i]) == (p[i] & mask[i]), so a
+// mask of 0x00 is a wildcard and 0xf0 only compares the high nibble. Typical
+// use, together with a RegionScanner overlapping by size() - 1:
+//
+//   const quint8 *p = data;
+//   while((p = pattern.find(p, data + size))) {
+//       report(p - data);
+//       ++p;
+//   }
+//
+// Patterns whose last few bytes are given in full are searched with
+// Horspool's algorithm, the rest jump between the occurrences of their most
+// useful fully given byte with memchr
+class EDB_EXPORT BytePattern {
+public:
+	BytePattern() = default;
+	explicit BytePattern(const QByteArray &bytes);
+	BytePattern(const QByteArray &bytes, const QByteArray &mask);
+
+public:
+	int size() const     { return bytes_.size(); }
+	bool isEmpty() const { return bytes_.isEmpty(); }
+
+public:
+	const quint8 *find(const quint8 *first, const quint8 *last) const;
+	bool matches(const quint8 *p) const;
+
+private:
+	void prepare();
+
+private:
+	QByteArray    bytes_; // with the masked out bits cleared
+	QByteArray    mask_;
+	QVector<int>  shift_; // Horspool's bad character table, empty if unused
+	int           anchor_ = -1; // a fully given byte for memchr, -1 if none
+	bool          exact_  = true;
+};
+
+#endif
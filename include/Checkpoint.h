@@ -0,0 +1,40 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHECKPOINT_20171014_H_
+#define CHECKPOINT_20171014_H_
+
+#include "OSTypes.h"
+#include "Types.h"
+#include <QDateTime>
+
+// a stopped copy of the debuggee taken with fork(), see
+// IDebugger::create_checkpoint. The copy shares the debuggee's memory
+// copy-on-write, so it costs little more than its page tables until either of
+// them writes. Only the thread which was current is in it, fork doesn't copy
+// the others, and file descriptors and shared memory are shared rather than
+// copied, so a checkpoint rewinds memory and registers but not the outside world
+struct Checkpoint {
+	int            id      = 0; // stays the same across restores
+	edb::pid_t     pid     = 0; // the process holding the copy right now
+	edb::address_t address = 0; // where the debuggee was stopped
+	QDateTime      created;
+};
+
+#endif
@@ -49,6 +49,14 @@ public:
 		KillIfLaunchedDetachIfAttached
 	};
 
+	// what becomes of a child the debuggee forks, inherited breakpoints are
+	// taken out of it in any case
+	enum ForkBehavior {
+		DetachChild,   // it runs on its own
+		ContinueChild, // it stays traced, but runs without stopping
+		DebugChild     // it is debugged by another instance of edb
+	};
+
 	enum InitialBreakpoint {
 		EntryPoint,
 		MainSymbol
@@ -63,6 +71,7 @@ public:
 public:
 	// general tab
 	CloseBehavior     close_behavior;
+	int               max_worker_threads; // for all background work, 0 for one per core
 
 	// appearance tab
 	bool                  show_address_separator;
@@ -88,6 +97,9 @@ public:
 	bool              disableASLR;
 	bool              disableLazyBinding;
     bool              break_on_library_load;
+	bool              non_stop_mode;
+	ForkBehavior      fork_behavior;
+	int               gui_update_interval; // in ms, stops closer together than this are drawn once
 	IBreakpoint::TypeId default_breakpoint_type;
 	QString           tty_command;
 
@@ -112,7 +124,8 @@ public:
 
 	// Exceptions tab
 	bool              enable_signals_message_box;
-    QList<qlonglong>  ignored_exceptions;
+    QList<qlonglong>  ignored_exceptions; // passed to the program without stopping
+	QList<qlonglong>  logged_exceptions;  // the same, but each one is logged
 
 protected:
 	void readSettings();
@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EXPRESSION_20070402_H_
 
 #include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+#include <algorithm>
 #include <functional>
 
 struct ExpressionError {
@@ -81,6 +84,7 @@ class Expression {
 public:
 	typedef std::function<T(const QString&, bool*, ExpressionError*)> variable_getter_t;
 	typedef std::function<T(T, bool*, ExpressionError*)>              memory_reader_t;
+	typedef std::function<bool(const QString&, T*)>                   constant_resolver_t;
 
 public:
 	Expression(const QString &s, variable_getter_t vg, memory_reader_t mr);
@@ -135,42 +139,53 @@ private:
 		}
 	};
 
-private:
-	T evaluate_expression() {
-		T result;
+	// one step of the compiled form, a program for a simple stack machine
+	// in postfix order
+	struct Instruction {
+		enum Type {
+			CONSTANT, // push value_
+			VARIABLE, // push the value of the variable variables_[slot_]
+			MEMORY,   // replace the top of the stack with the value it points to
+			UNARY,    // apply operator_ to the top of the stack
+			BINARY    // apply operator_ to the top two entries of the stack
+		} type_;
 
-		get_token();
-		eval_exp(result);
+		typename Token::Operator operator_;
+		T                        value_;
+		int                      slot_;
+	};
 
-		return result;
-	}
+public:
+	// parses the expression once, anything after this only runs the
+	// compiled program. Variables which <resolver> knows the value of are
+	// folded into constants
+	bool compile(const constant_resolver_t &resolver, ExpressionError *error) noexcept;
+	bool compiled() const { return compiled_; }
+	const QString &expression() const { return expression_; }
 
 public:
-	T evaluate_expression(bool *ok, ExpressionError *error) noexcept {
-
-		Q_ASSERT(ok);
-		Q_ASSERT(error);
-
-		try {
-			*ok = true;
-			return evaluate_expression();
-		} catch(const ExpressionError &e) {
-			*ok = false;
-			*error = e;
-			return T();
-		}
-	}
+	T evaluate_expression(bool *ok, ExpressionError *error) noexcept;
+	T evaluate_expression(const variable_getter_t &vg, const memory_reader_t &mr, bool *ok, ExpressionError *error) const noexcept;
+
+private:
+	T run(const variable_getter_t &vg, const memory_reader_t &mr) const;
+	static void apply_unary(typename Token::Operator oper, T &result);
+	static void apply_binary(typename Token::Operator oper, T &result, const T &partial_value);
+
 private:
-	void eval_exp(T &result);
-	void eval_exp0(T &result);
-	void eval_exp1(T &result);
-	void eval_exp2(T &result);
-	void eval_exp3(T &result);
-	void eval_exp4(T &result);
-	void eval_exp5(T &result);
-	void eval_exp6(T &result);
-	void eval_exp7(T &result);
-	void eval_atom(T &result);
+	void compile_exp();
+	void compile_exp0();
+	void compile_exp1();
+	void compile_exp2();
+	void compile_exp3();
+	void compile_exp4();
+	void compile_exp5();
+	void compile_exp6();
+	void compile_exp7();
+	void compile_atom();
+	void emit_unary(typename Token::Operator oper);
+	void emit_binary(typename Token::Operator oper);
+	int variable_slot(const QString &name);
 	void get_token();
 
 	static bool is_delim(QChar ch) {
@@ -183,6 +198,12 @@ private:
 	Token                   token_;
 	variable_getter_t       variable_reader_;
 	memory_reader_t         memory_reader_;
+	constant_resolver_t     constant_resolver_;
+	QVector<Instruction>    program_;
+	QVector<QString>        variables_;   // each one is read once an evaluation
+	int                     stack_depth_; // the most program_ ever pushes
+	ExpressionError         compile_error_;
+	bool                    compiled_;
 };
 
 #include "Expression.tcc"
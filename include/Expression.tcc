@@ -26,20 +26,341 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 template <class T>
 Expression<T>::Expression(const QString &s, variable_getter_t vg, memory_reader_t mr) :
 		expression_(s), expression_ptr_(expression_.begin()),
-		variable_reader_(vg), memory_reader_(mr) {
+		variable_reader_(vg), memory_reader_(mr), stack_depth_(0), compiled_(false) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp
+// Name: compile
+// Desc: parses the expression into program_. Only the first call does any
+//       work, a failure is remembered and reported by every evaluation
+//------------------------------------------------------------------------------
+template <class T>
+bool Expression<T>::compile(const constant_resolver_t &resolver, ExpressionError *error) noexcept {
+
+	Q_ASSERT(error);
+
+	if(!compiled_) {
+		compiled_          = true;
+		constant_resolver_ = resolver;
+		expression_ptr_    = expression_.begin();
+
+		try {
+			get_token();
+			compile_exp();
+		} catch(const ExpressionError &e) {
+			program_.clear();
+			variables_.clear();
+			compile_error_ = e;
+		}
+
+		// size the stack once, so that running needs no allocation
+		int depth    = 0;
+		stack_depth_ = 0;
+		for(const Instruction &insn : program_) {
+			switch(insn.type_) {
+			case Instruction::CONSTANT:
+			case Instruction::VARIABLE:
+				stack_depth_ = std::max(stack_depth_, ++depth);
+				break;
+			case Instruction::BINARY:
+				--depth;
+				break;
+			default:
+				break;
+			}
+		}
+
+		constant_resolver_ = nullptr;
+	}
+
+	*error = compile_error_;
+	return !program_.isEmpty();
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate_expression
+// Desc: compiles (if it hasn't been already) and runs the expression using
+//       the variable getter and memory reader it was constructed with
+//------------------------------------------------------------------------------
+template <class T>
+T Expression<T>::evaluate_expression(bool *ok, ExpressionError *error) noexcept {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(error);
+
+	if(!compile(nullptr, error)) {
+		*ok = false;
+		return T();
+	}
+
+	return evaluate_expression(variable_reader_, memory_reader_, ok, error);
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate_expression
+// Desc: runs the compiled expression, letting the caller supply how variables
+//       and memory are read for this evaluation
+//------------------------------------------------------------------------------
+template <class T>
+T Expression<T>::evaluate_expression(const variable_getter_t &vg, const memory_reader_t &mr, bool *ok, ExpressionError *error) const noexcept {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(error);
+
+	if(program_.isEmpty()) {
+		*ok    = false;
+		*error = compiled_ ? compile_error_ : ExpressionError(ExpressionError::SYNTAX);
+		return T();
+	}
+
+	try {
+		*ok = true;
+		return run(vg, mr);
+	} catch(const ExpressionError &e) {
+		*ok = false;
+		*error = e;
+		return T();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: executes program_. Variables are read the first time they are used,
+//       any further use of the same one takes that value
+//------------------------------------------------------------------------------
+template <class T>
+T Expression<T>::run(const variable_getter_t &vg, const memory_reader_t &mr) const {
+
+	QVarLengthArray<T, 16>   stack(stack_depth_);
+	QVarLengthArray<T, 8>    values(variables_.size());
+	QVarLengthArray<bool, 8> loaded(variables_.size());
+	std::fill(loaded.begin(), loaded.end(), false);
+
+	T *top = stack.data() - 1;
+
+	for(const Instruction &insn : program_) {
+		switch(insn.type_) {
+		case Instruction::CONSTANT:
+			*++top = insn.value_;
+			break;
+		case Instruction::VARIABLE:
+			if(!loaded[insn.slot_]) {
+				if(!vg) {
+					throw ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+				}
+
+				bool ok;
+				ExpressionError error;
+				values[insn.slot_] = vg(variables_[insn.slot_], &ok, &error);
+				if(!ok) {
+					throw error;
+				}
+				loaded[insn.slot_] = true;
+			}
+			*++top = values[insn.slot_];
+			break;
+		case Instruction::MEMORY:
+			if(mr) {
+				bool ok;
+				ExpressionError error;
+				*top = mr(*top, &ok, &error);
+				if(!ok) {
+					throw error;
+				}
+			} else {
+				throw ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
+			}
+			break;
+		case Instruction::UNARY:
+			apply_unary(insn.operator_, *top);
+			break;
+		case Instruction::BINARY:
+			--top;
+			apply_binary(insn.operator_, *top, top[1]);
+			break;
+		}
+	}
+
+	Q_ASSERT(top == stack.data());
+	return *top;
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_unary
+// Desc:
+//------------------------------------------------------------------------------
+template <class T>
+void Expression<T>::apply_unary(typename Token::Operator oper, T &result) {
+	switch(oper) {
+	case Token::PLUS:
+		// this may seems like a waste, but unary + can be overloaded for a type
+		// to have a non-nop effect!
+		result = +result;
+		break;
+	case Token::MINUS:
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4146)
+#endif
+		result = -result;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+		break;
+	case Token::CMP:
+		result = ~result;
+		break;
+	case Token::NOT:
+		result = !result;
+		break;
+	default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_binary
+// Desc:
+//------------------------------------------------------------------------------
+template <class T>
+void Expression<T>::apply_binary(typename Token::Operator oper, T &result, const T &partial_value) {
+	switch(oper) {
+	case Token::LOGICAL_AND:
+		result = result && partial_value;
+		break;
+	case Token::LOGICAL_OR:
+		result = result || partial_value;
+		break;
+	case Token::AND:
+		result &= partial_value;
+		break;
+	case Token::OR:
+		result |= partial_value;
+		break;
+	case Token::XOR:
+		result ^= partial_value;
+		break;
+	case Token::LT:
+		result = result < partial_value;
+		break;
+	case Token::LE:
+		result = result <= partial_value;
+		break;
+	case Token::GT:
+		result = result > partial_value;
+		break;
+	case Token::GE:
+		result = result >= partial_value;
+		break;
+	case Token::EQ:
+		result = result == partial_value;
+		break;
+	case Token::NE:
+		result = result != partial_value;
+		break;
+	case Token::LSHFT:
+		result <<= partial_value;
+		break;
+	case Token::RSHFT:
+		result >>= partial_value;
+		break;
+	case Token::PLUS:
+		result += partial_value;
+		break;
+	case Token::MINUS:
+#ifdef _MSC_VER
+#pragma warning(push)
+/* disable warning about applying unary - to an unsigned type */
+#pragma warning(disable : 4146)
+#endif
+		result -= partial_value;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+		break;
+	case Token::MUL:
+		result *= partial_value;
+		break;
+	case Token::DIV:
+		if(partial_value == 0) {
+			throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
+		}
+		result /= partial_value;
+		break;
+	case Token::MOD:
+		if(partial_value == 0) {
+			throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
+		}
+		result %= partial_value;
+		break;
+	default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: emit_unary
+// Desc: constant operands are folded right away
+//------------------------------------------------------------------------------
+template <class T>
+void Expression<T>::emit_unary(typename Token::Operator oper) {
+
+	Instruction &operand = program_.back();
+	if(operand.type_ == Instruction::CONSTANT) {
+		apply_unary(oper, operand.value_);
+	} else {
+		Instruction insn;
+		insn.type_     = Instruction::UNARY;
+		insn.operator_ = oper;
+		program_.push_back(insn);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: emit_binary
+// Desc: constant operands are folded right away
+//------------------------------------------------------------------------------
+template <class T>
+void Expression<T>::emit_binary(typename Token::Operator oper) {
+
+	const int n = program_.size();
+	if(n >= 2 && program_[n - 1].type_ == Instruction::CONSTANT && program_[n - 2].type_ == Instruction::CONSTANT) {
+		apply_binary(oper, program_[n - 2].value_, program_[n - 1].value_);
+		program_.pop_back();
+	} else {
+		Instruction insn;
+		insn.type_     = Instruction::BINARY;
+		insn.operator_ = oper;
+		program_.push_back(insn);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: variable_slot
+// Desc: the same variable always gets the same slot
+//------------------------------------------------------------------------------
+template <class T>
+int Expression<T>::variable_slot(const QString &name) {
+	const int slot = variables_.indexOf(name);
+	if(slot != -1) {
+		return slot;
+	}
+
+	variables_.push_back(name);
+	return variables_.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+// Name: compile_exp
 // Desc: private entry point with sanity check
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp(T &result) {
+void Expression<T>::compile_exp() {
 	if(token_.type_ == Token::UNKNOWN) {
 		throw ExpressionError(ExpressionError::SYNTAX);
 	}
 
-	eval_exp0(result);
+	compile_exp0();
 
 	switch(token_.type_) {
 	case Token::OPERATOR:
@@ -63,240 +384,115 @@ void Expression<T>::eval_exp(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp0
+// Name: compile_exp0
 // Desc: logic
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp0(T &result) {
-	eval_exp1(result);
+void Expression<T>::compile_exp0() {
+	compile_exp1();
 
 	for(Token op = token_; op.operator_ == Token::LOGICAL_AND || op.operator_ == Token::LOGICAL_OR; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp1(partial_value);
-
-		// add or subtract
-		switch(op.operator_) {
-		case Token::LOGICAL_AND:
-			result = result && partial_value;
-			break;
-		case Token::LOGICAL_OR:
-			result = result || partial_value;
-			break;
-		default:
-			break;
-		}
+		compile_exp1();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp1
+// Name: compile_exp1
 // Desc: binary logic
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp1(T &result) {
-	eval_exp2(result);
+void Expression<T>::compile_exp1() {
+	compile_exp2();
 
 	for(Token op = token_; op.operator_ == Token::AND || op.operator_ == Token::OR || op.operator_ == Token::XOR; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp2(partial_value);
-
-		// add or subtract
-		switch(op.operator_) {
-		case Token::AND:
-			result &= partial_value;
-			break;
-		case Token::OR:
-			result |= partial_value;
-			break;
-		case Token::XOR:
-			result ^= partial_value;
-			break;
-		default:
-			break;
-		}
+		compile_exp2();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp2
+// Name: compile_exp2
 // Desc: comparisons
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp2(T &result) {
-	eval_exp3(result);
+void Expression<T>::compile_exp2() {
+	compile_exp3();
 
 	for(Token op = token_; op.operator_ == Token::LT || op.operator_ == Token::LE || op.operator_ == Token::GT || op.operator_ == Token::GE || op.operator_ == Token::EQ || op.operator_ == Token::NE; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp3(partial_value);
-
-		// perform the relational operation
-		switch(op.operator_) {
-		case Token::LT:
-			result = result < partial_value;
-			break;
-		case Token::LE:
-			result = result <= partial_value;
-			break;
-		case Token::GT:
-			result = result > partial_value;
-			break;
-		case Token::GE:
-			result = result >= partial_value;
-			break;
-		case Token::EQ:
-			result = result == partial_value;
-			break;
-		case Token::NE:
-			result = result != partial_value;
-			break;
-		default:
-			break;
-		}
+		compile_exp3();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp3
+// Name: compile_exp3
 // Desc: shifts
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp3(T &result) {
-	eval_exp4(result);
+void Expression<T>::compile_exp3() {
+	compile_exp4();
 
 	for(Token op = token_; op.operator_ == Token::RSHFT || op.operator_ == Token::LSHFT; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp4(partial_value);
-
-		// perform the shift operation
-		switch(op.operator_) {
-		case Token::LSHFT:
-			result <<= partial_value;
-			break;
-		case Token::RSHFT:
-			result >>= partial_value;
-			break;
-		default:
-			break;
-		}
+		compile_exp4();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp4
+// Name: compile_exp4
 // Desc: addition/subtraction
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp4(T &result) {
-	eval_exp5(result);
+void Expression<T>::compile_exp4() {
+	compile_exp5();
 
 	for(Token op = token_; op.operator_ == Token::PLUS || op.operator_ == Token::MINUS; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp5(partial_value);
-
-		// add or subtract
-		switch(op.operator_) {
-		case Token::PLUS:
-			result += partial_value;
-			break;
-		case Token::MINUS:
-#ifdef _MSC_VER
-#pragma warning(push)
-/* disable warning about applying unary - to an unsigned type */
-#pragma warning(disable : 4146)
-#endif
-			result -= partial_value;
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
-			break;
-		default:
-			break;
-		}
+		compile_exp5();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp5
+// Name: compile_exp5
 // Desc: multiplication/division
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp5(T &result) {
-	eval_exp6(result);
+void Expression<T>::compile_exp5() {
+	compile_exp6();
 
 	for(Token op = token_; op.operator_ == Token::MUL || op.operator_ == Token::DIV || op.operator_ == Token::MOD; op = token_) {
-		T partial_value;
-
 		get_token();
-		eval_exp6(partial_value);
-
-		// mul, div, or modulus
-		switch(op.operator_) {
-		case Token::MUL:
-			result *= partial_value;
-			break;
-		case Token::DIV:
-			if(partial_value == 0) {
-				throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
-			}
-			result /= partial_value;
-			break;
-		case Token::MOD:
-			if(partial_value == 0) {
-				throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
-			}
-			result %= partial_value;
-			break;
-		default:
-			break;
-		}
+		compile_exp6();
+		emit_binary(op.operator_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp6
+// Name: compile_exp6
 // Desc: unary expressions
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp6(T &result) {
+void Expression<T>::compile_exp6() {
 
 	Token op = token_;
 	if(op.operator_ == Token::PLUS || op.operator_ == Token::MINUS || op.operator_ == Token::CMP || op.operator_ == Token::NOT) {
 		get_token();
 	}
 
-	eval_exp7(result);
+	compile_exp7();
 
 	switch(op.operator_) {
 	case Token::PLUS:
-		// this may seems like a waste, but unary + can be overloaded for a type
-		// to have a non-nop effect!
-		result = +result;
-		break;
 	case Token::MINUS:
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable:4146)
-#endif
-		result = -result;
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
-		break;
 	case Token::CMP:
-		result = ~result;
-		break;
 	case Token::NOT:
-		result = !result;
+		emit_unary(op.operator_);
 		break;
 	default:
 		break;
@@ -304,18 +500,18 @@ void Expression<T>::eval_exp6(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp7
+// Name: compile_exp7
 // Desc: sub-expressions
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp7(T &result) {
+void Expression<T>::compile_exp7() {
 
 	switch(token_.operator_) {
 	case Token::LPAREN:
 		get_token();
 
 		// get sub-expression
-		eval_exp0(result);
+		compile_exp0();
 
 		if(token_.operator_ != Token::RPAREN) {
 			throw ExpressionError(ExpressionError::UNBALANCED_PARENS);
@@ -330,21 +526,13 @@ void Expression<T>::eval_exp7(T &result) {
 		do {
 			get_token();
 
-			// get sub-expression
-			T effective_address;
-			eval_exp0(effective_address);
+			// get sub-expression, which is the effective address
+			compile_exp0();
 
-			if(memory_reader_) {
-				bool ok;
-				ExpressionError error;
-
-				result = memory_reader_(effective_address, &ok, &error);
-				if(!ok) {
-					throw error;
-				}
-			} else {
-				throw ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
-			}
+			Instruction insn;
+			insn.type_     = Instruction::MEMORY;
+			insn.operator_ = Token::NONE;
+			program_.push_back(insn);
 
 			if(token_.operator_ != Token::RBRACE) {
 				throw ExpressionError(ExpressionError::UNBALANCED_BRACES);
@@ -357,39 +545,42 @@ void Expression<T>::eval_exp7(T &result) {
 		throw ExpressionError(ExpressionError::UNBALANCED_BRACES);
 		break;
 	default:
-		eval_atom(result);
+		compile_atom();
 		break;
 
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_atom
+// Name: compile_atom
 // Desc: atoms (variables/constants)
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_atom(T &result) {
+void Expression<T>::compile_atom() {
+
+	Instruction insn;
+	insn.operator_ = Token::NONE;
+	insn.slot_     = -1;
 
 	switch(token_.type_) {
 	case Token::VARIABLE:
-		if(variable_reader_) {
-			bool ok;
-			ExpressionError error;
-			result = variable_reader_(token_.data_, &ok, &error);
-			if(!ok) {
-				throw error;
-			}
+		if(constant_resolver_ && constant_resolver_(token_.data_, &insn.value_)) {
+			insn.type_ = Instruction::CONSTANT;
 		} else {
-			throw ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+			insn.type_ = Instruction::VARIABLE;
+			insn.slot_ = variable_slot(token_.data_);
 		}
+		program_.push_back(insn);
 		get_token();
 		break;
 	case Token::NUMBER:
 		bool ok;
-		result = token_.data_.toULongLong(&ok, 0);
+		insn.type_  = Instruction::CONSTANT;
+		insn.value_ = token_.data_.toULongLong(&ok, 0);
 		if(!ok) {
 			throw ExpressionError(ExpressionError::INVALID_NUMBER);
 		}
+		program_.push_back(insn);
 		get_token();
 		break;
 	default:
@@ -0,0 +1,41 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FAST_HASH_20171014_H_
+#define FAST_HASH_20171014_H_
+
+#include "API.h"
+#include <QVector>
+#include <QtGlobal>
+#include <cstddef>
+
+// A 64-bit hash for telling whether memory changed, several times the speed
+// of MD5. It is XXH64, which works on four independent lanes so the compiler
+// can keep them all busy, and is the same on every build of edb. It is not
+// cryptographic: MD5 stays where a file's identity is recorded
+class EDB_EXPORT FastHash {
+public:
+	static quint64 hash(const void *p, std::size_t n, quint64 seed = 0);
+	static QVector<quint64> hash_pages(const void *p, std::size_t page_count, std::size_t page_size);
+	static quint64 digest(const QVector<quint64> &hashes);
+
+private:
+	FastHash() = delete;
+};
+
+#endif
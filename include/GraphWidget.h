@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef GRAPHWIDGET_20090903_H_
 #define GRAPHWIDGET_20090903_H_
 
+#include <QFutureWatcher>
 #include <QGraphicsView>
 #include <graphviz/cgraph.h>
 #include <graphviz/gvcext.h>
@@ -50,6 +51,9 @@ public Q_SLOTS:
 	void setScale(qreal factor);
 	void setHUDNotification(const QString &s, int duration = 1000);
 
+private Q_SLOTS:
+	void layoutFinished();
+
 Q_SIGNALS:
 	void backgroundContextMenuEvent(QContextMenuEvent* event);
 	void nodeContextMenuEvent(QContextMenuEvent* event, GraphNode *node);
@@ -67,9 +71,13 @@ private:
 	void setGraphAttribute(const QString name, const QString value);
 	void setNodeAttribute(const QString name, const QString value);
 	void setEdgeAttribute(const QString name, const QString value);
+	void waitForLayout();
 
 private:
 	bool                  inLayout_;
+	bool                  laidOut_;
+	bool                  layoutPending_;
+	QFutureWatcher<void>  layoutWatcher_;
 	QLayout              *HUDLayout_;
 	QLabel               *HUDLabel_;
 	GVC_t                *context_;
@@ -32,6 +32,13 @@ public:
 public:
 	virtual void fixup(QString &input) const;
 	virtual State validate(QString &input, int &pos) const;
+
+public:
+	// lets '?' stand for a nibble which can be anything
+	void setWildcardsAllowed(bool allowed) { wildcards_ = allowed; }
+
+private:
+	bool wildcards_ = false;
 };
 
 #endif
@@ -21,7 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Types.h"
 #include "Function.h"
+#include <QPair>
 #include <QSet>
+#include <QVector>
+#include <algorithm>
 #include <memory>
 #include <functional>
 
@@ -37,6 +40,40 @@ public:
 public:
 	typedef QMap<edb::address_t, Function> FunctionMap;
 
+	// the functions of a region in address order, as parallel arrays. Being
+	// implicitly shared, a copy costs nothing, unlike one of a FunctionMap
+	struct FunctionIndex {
+		QVector<edb::address_t> entries;
+		QVector<edb::address_t> ends;             // Function::end_address of each
+		QVector<int>            reference_counts; // Function::reference_count of each
+		QVector<Function::Type> types;            // Function::type of each
+	};
+
+	// compressed adjacency lists, in key order. The edges of keys[n] are
+	// edges[offsets[n]] up to edges[offsets[n + 1]], in address order, so a
+	// lookup only costs a search of the keys and a copy of its own edges
+	struct Adjacency {
+		QVector<edb::address_t> keys;
+		QVector<int>            offsets; // one more than there are keys
+		QVector<edb::address_t> edges;
+
+		QVector<edb::address_t> find(edb::address_t key) const {
+			auto it = std::lower_bound(keys.begin(), keys.end(), key);
+			if(it == keys.end() || *it != key) {
+				return QVector<edb::address_t>();
+			}
+
+			const int n = static_cast<int>(it - keys.begin());
+			return edges.mid(offsets[n], offsets[n + 1] - offsets[n]);
+		}
+	};
+
+	// the direct calls made by the functions of a region, both ways round
+	struct CallGraph {
+		Adjacency callees; // function entry to the targets of its calls
+		Adjacency callers; // call target to the entries of the functions calling it
+	};
+
 public:
 	enum AddressCategory {
 		ADDRESS_FUNC_UNKNOWN = 0x00,
@@ -55,6 +92,33 @@ public:
 	virtual void invalidate_analysis() = 0;
 	virtual void invalidate_analysis(const std::shared_ptr<IRegion> &region) = 0;
 	virtual bool for_funcs_in_range(const edb::address_t start, const edb::address_t end, std::function<bool(const Function*)> functor) const = 0;
+
+	// function entry points seen while tracing, e.g. call targets, they are
+	// used as extra roots the next time the containing region is analyzed
+	virtual void add_traced_functions(const QSet<edb::address_t> &entries) { Q_UNUSED(entries); }
+
+	// the places in analyzed code which refer to <address>, or to anything in
+	// [first, last], with a branch, a call or an immediate operand. Only
+	// regions for which analyzed() is true are covered completely
+	virtual QVector<edb::address_t> references(edb::address_t address) const { Q_UNUSED(address); return QVector<edb::address_t>(); }
+	virtual QVector<edb::address_t> references(edb::address_t first, edb::address_t last) const { Q_UNUSED(first); Q_UNUSED(last); return QVector<edb::address_t>(); }
+	virtual bool analyzed(const std::shared_ptr<IRegion> &region) const { Q_UNUSED(region); return false; }
+
+	// the references whose target is in [first, last], as pairs of site and
+	// target, in target order
+	virtual QVector<QPair<edb::address_t, edb::address_t>> references_into(edb::address_t first, edb::address_t last) const { Q_UNUSED(first); Q_UNUSED(last); return QVector<QPair<edb::address_t, edb::address_t>>(); }
+
+	// the index of the functions found in <region> so far, empty if it wasn't
+	// analyzed. Lists of functions should prefer this to functions(region)
+	virtual FunctionIndex function_index(const std::shared_ptr<IRegion> &region) const { Q_UNUSED(region); return FunctionIndex(); }
+
+	// the direct calls found by the analysis, calls through a register or
+	// memory aren't known. callers() are the entries of the functions calling
+	// <entry>, callees() the targets of the calls made by the function at
+	// <entry>, both in address order
+	virtual QVector<edb::address_t> callers(edb::address_t entry) const { Q_UNUSED(entry); return QVector<edb::address_t>(); }
+	virtual QVector<edb::address_t> callees(edb::address_t entry) const { Q_UNUSED(entry); return QVector<edb::address_t>(); }
+	virtual CallGraph call_graph(const std::shared_ptr<IRegion> &region) const { Q_UNUSED(region); return CallGraph(); }
 };
 
 #endif
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "API.h"
 #include "Types.h"
+#include <QString>
 #include <QVector>
 #include <memory>
 
@@ -33,6 +34,15 @@ public:
 		size_t         size;
 		// TODO(eteran): maybe label/type/etc...
 	};
+
+	// a symbol the binary gets from another module, where the process has
+	// the stub which calls go through and the slot the dynamic linker puts
+	// its address in
+	struct Import {
+		edb::address_t plt;  // 0 if it is used through the slot directly
+		edb::address_t got;
+		QString        name;
+	};
 public:
 	virtual ~IBinary() = default;
 
@@ -51,6 +61,13 @@ public:
 	// this should return a pointer to it
 	virtual edb::address_t debug_pointer() { return 0; }
 
+	// optional: the functions the binary itself has symbols for, at their
+	// addresses in the process, found without any symbol files
+	virtual QVector<edb::address_t> function_entries() const { return QVector<edb::address_t>(); }
+
+	// optional: the symbols the binary imports, read from its relocations
+	virtual QVector<Import> imports() const { return QVector<Import>(); }
+
 public:
 	typedef std::unique_ptr<IBinary> (*create_func_ptr_t)(const std::shared_ptr<IRegion> &);
 };
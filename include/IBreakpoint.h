@@ -19,10 +19,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef IBREAKPOINT_20060720_H_
 #define IBREAKPOINT_20060720_H_
 
+#include "OSTypes.h"
 #include "Types.h"
 
+#include <QSet>
 #include <QString>
 #include <exception>
+#include <memory>
 
 class breakpoint_creation_error : public std::exception {
 	const char *what() const noexcept {
@@ -32,9 +35,21 @@ class breakpoint_creation_error : public std::exception {
 
 class QByteArray;
 
+template <class T>
+class Expression;
+
+// an expression of a breakpoint, parsed once and with symbols already
+// resolved. Only valid while its source still matches the breakpoint's text
+// and the modules it was compiled against are still loaded
+// (see MemoryRegions::modules_generation)
+struct CompiledBreakpointExpression {
+	std::shared_ptr<Expression<edb::address_t>> expression;
+	quint64                                     generation = 0;
+};
+
 class IBreakpoint {
 protected:
-	IBreakpoint() : tag(0) {}
+	IBreakpoint() : tag(0), tracepoint(false), ignore_count(0), hit_limit(0) {}
 
 public:
 	virtual ~IBreakpoint() = default;
@@ -73,6 +88,30 @@ public:
 	QString condition;
 	quint64 tag;
 
+	// a tracepoint logs each hit to edb::v1::trace_log() and continues
+	bool    tracepoint;
+	QString trace_expression;
+
+	CompiledBreakpointExpression compiled_condition;
+	CompiledBreakpointExpression compiled_trace_expression;
+
+	// filters which are checked before the condition, they need no
+	// expression evaluated. Hits by threads not in <threads> (unless it is
+	// empty) are not counted, of the counted hits the first <ignore_count>
+	// and those after <hit_limit> (unless it is 0) don't stop
+	quint64          ignore_count;
+	quint64          hit_limit;
+	QSet<edb::tid_t> threads;
+
+public:
+	bool counts_hits_by(edb::tid_t tid) const {
+		return threads.isEmpty() || threads.contains(tid);
+	}
+
+	// whether the <hit>th counted hit is one that doesn't stop
+	bool hit_filtered(quint64 hit) const {
+		return hit <= ignore_count || (hit_limit != 0 && hit > hit_limit);
+	}
 };
 
 Q_DECLARE_METATYPE(IBreakpoint::TypeId);
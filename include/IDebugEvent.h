@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "API.h"
 #include "OSTypes.h"
+#include "Types.h"
 #include <QString>
 
 class EDB_EXPORT IDebugEvent {
@@ -34,7 +35,8 @@ public:
 
 	enum TRAP_REASON {
 		TRAP_STEPPING,
-		TRAP_BREAKPOINT
+		TRAP_BREAKPOINT,
+		TRAP_SYSCALL    // see IDebugger::set_syscall_catchpoints
 	};
 
 	struct Message {
@@ -69,6 +71,16 @@ public:
 	virtual edb::pid_t process() const = 0;
 	virtual edb::tid_t thread() const = 0;
 	virtual int code() const = 0;
+
+public:
+	// only meaningful for TRAP_SYSCALL events
+	virtual int syscall_number() const { return -1; }
+	virtual bool syscall_exit() const  { return false; }
+
+public:
+	// the address whose access raised a segmentation fault, 0 for any other
+	// event or when the platform doesn't tell
+	virtual edb::address_t fault_address() const { return edb::address_t(0); }
 };
 
 #endif
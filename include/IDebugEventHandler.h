@@ -20,16 +20,42 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IDEBUG_EVENT_HANDLER_20061101_H_
 
 #include "Types.h"
+#include <QVector>
 #include <memory>
 
 class IDebugEvent;
 
 class IDebugEventHandler {
+public:
+	// the events a handler wants to be given, handlers which are not
+	// interested in an event are skipped as though they returned
+	// DEBUG_NEXT_HANDLER
+	enum EventKind {
+		EVENT_STEP       = 0x01, // single step traps
+		EVENT_BREAKPOINT = 0x02, // breakpoint traps
+		EVENT_SYSCALL    = 0x04, // syscall catchpoint traps
+		EVENT_SIGNAL     = 0x08, // any other stop
+		EVENT_EXIT       = 0x10, // exited or terminated
+		EVENT_STOPPED    = EVENT_STEP | EVENT_BREAKPOINT | EVENT_SYSCALL | EVENT_SIGNAL,
+		EVENT_ALL        = EVENT_STOPPED | EVENT_EXIT
+	};
+
+	struct Interest {
+		unsigned int  kinds = EVENT_ALL;
+		QVector<int>  signal_codes; // EVENT_SIGNAL stops only for these, empty means all of them
+		edb::address_t low  = 0;    // stops only when the instruction pointer is in [low, high),
+		edb::address_t high = 0;    // high == 0 means anywhere
+	};
+
 public:
 	virtual ~IDebugEventHandler() = default;
 
 public:
 	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event) = 0;
+
+	// read when the handler is added, and again when it calls
+	// edb::v1::refresh_debug_event_handler
+	virtual Interest interest() const { return Interest(); }
 };
 
 #endif
@@ -21,19 +21,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "OSTypes.h"
 #include "Types.h"
+#include "Checkpoint.h"
 #include "IBreakpoint.h"
+#include "IProcess.h"
+#include "ProcessSummary.h"
+#include "Status.h"
 #include <QByteArray>
 #include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QString>
+#include <QVector>
 #include <QtPlugin>
 #include <memory>
 
 class IDebugEvent;
-class IProcess;
 class IState;
 class State;
-class Status;
+struct BranchTrace;
+struct Profile;
+struct StepCondition;
+struct StepResult;
+struct SyscallStats;
+struct TraceRequest;
+struct TraceResult;
 
 class IDebugger {
 public:
@@ -83,6 +94,19 @@ public:
 	virtual edb::pid_t parent_pid(edb::pid_t pid) const = 0;
 	virtual QMap<edb::pid_t, std::shared_ptr<IProcess>> enumerate_processes() const = 0;
 
+	// optional, overload this if the platform can list processes more cheaply
+	// than by opening every one of them
+	virtual QMap<edb::pid_t, ProcessSummary> enumerate_process_summaries() const {
+		QMap<edb::pid_t, ProcessSummary> ret;
+		for(const std::shared_ptr<IProcess> &process : enumerate_processes()) {
+			const ProcessSummary summary = {
+				process->pid(), process->uid(), process->user(), process->name()
+			};
+			ret.insert(summary.pid, summary);
+		}
+		return ret;
+	}
+
 public:
 	// basic process management
 	virtual Status attach(edb::pid_t pid) = 0;
@@ -99,6 +123,11 @@ public:
 	// basic breakpoint managment
 	virtual BreakpointList               backup_breakpoints() const = 0;
 	virtual std::shared_ptr<IBreakpoint> add_breakpoint(edb::address_t address) = 0;
+
+	// creates breakpoints at those of <addresses> which have none yet, arming
+	// them all in one batch. Returns the addresses where none could be placed
+	virtual QVector<edb::address_t>      add_breakpoints(const QVector<edb::address_t> &addresses) = 0;
+
 	virtual std::shared_ptr<IBreakpoint> find_breakpoint(edb::address_t address) = 0;
 	virtual std::shared_ptr<IBreakpoint> find_triggered_breakpoint(edb::address_t address) = 0;
 	virtual void                         clear_breakpoints() = 0;
@@ -108,6 +137,177 @@ public:
 public:
 	virtual IState *create_state() const = 0;
 
+public:
+	// single steps the current thread in a tight loop, writing a compact
+	// trace to a file, see TraceRequest. Cores which can't do this leave it
+	// to the default, which fails
+	virtual Status record_trace(const TraceRequest &request, TraceResult *result) {
+		Q_UNUSED(request);
+		Q_UNUSED(result);
+		return Status(QString("Instruction tracing is not supported by this debugger core"));
+	}
+
+	// single steps the current thread in a tight loop until the condition is
+	// met, see StepCondition. Cores which can't do this leave it to the
+	// default, which fails
+	virtual Status step_until(const StepCondition &condition, StepResult *result) {
+		Q_UNUSED(condition);
+		Q_UNUSED(result);
+		return Status(QString("Stepping until a condition is not supported by this debugger core"));
+	}
+
+	// samples the branches the debuggee takes using the CPU's branch recording
+	// hardware while it runs at full speed. Tracing covers every thread, until
+	// stop_branch_trace collects what was recorded, see BranchTrace.h
+	virtual Status start_branch_trace(quint64 sample_period) {
+		Q_UNUSED(sample_period);
+		return Status(QString("Hardware branch tracing is not supported by this debugger core"));
+	}
+
+	virtual Status stop_branch_trace(BranchTrace *trace) {
+		Q_UNUSED(trace);
+		return Status(QString("Hardware branch tracing is not supported by this debugger core"));
+	}
+
+	virtual bool branch_trace_active() const { return false; }
+
+	// samples where the debuggee's threads are while it runs at full speed,
+	// about <frequency> times for every second of CPU time a thread uses, and
+	// if <call_stacks> is set, who called them. Sampling covers every thread,
+	// until stop_profile collects what was recorded, see Profile.h
+	virtual Status start_profile(quint64 frequency, bool call_stacks) {
+		Q_UNUSED(frequency);
+		Q_UNUSED(call_stacks);
+		return Status(QString("Profiling is not supported by this debugger core"));
+	}
+
+	virtual Status stop_profile(Profile *profile) {
+		Q_UNUSED(profile);
+		return Status(QString("Profiling is not supported by this debugger core"));
+	}
+
+	virtual bool profile_active() const { return false; }
+
+	// coverage points are one-shot breakpoints which the core takes out by
+	// itself the first time they are hit, remembering the hit instead of
+	// reporting an event, so every basic block of a program can have one.
+	// Addresses which already have a breakpoint or coverage point are skipped
+	virtual Status add_coverage_points(const QVector<edb::address_t> &addresses) {
+		Q_UNUSED(addresses);
+		return Status(QString("Code coverage is not supported by this debugger core"));
+	}
+
+	// the coverage points hit since the last call, in the order they were hit
+	virtual QVector<edb::address_t> take_coverage_hits() { return QVector<edb::address_t>(); }
+
+	// takes out the coverage points which haven't been hit yet
+	virtual void clear_coverage_points() {}
+	virtual int coverage_points() const { return 0; }
+
+	// stops the debuggee at the system calls in <syscalls>, or at every one
+	// if it is empty. The stops are reported as TRAP_SYSCALL events
+	virtual Status set_syscall_catchpoints(bool enabled, const QSet<int> &syscalls) {
+		Q_UNUSED(enabled);
+		Q_UNUSED(syscalls);
+		return Status(QString("Breaking on system calls is not supported by this debugger core"));
+	}
+
+	virtual bool syscall_catchpoints_enabled() const { return false; }
+	virtual QSet<int> syscall_catchpoints() const    { return QSet<int>(); }
+
+	// counts the system calls of every thread, how many failed and how long
+	// they took, without stopping at them. take_syscall_stats collects what
+	// was counted since it was last called, see SyscallStats.h
+	virtual Status start_syscall_stats() {
+		return Status(QString("System call statistics are not supported by this debugger core"));
+	}
+
+	virtual void stop_syscall_stats() {}
+	virtual bool syscall_stats_active() const { return false; }
+
+	virtual bool take_syscall_stats(SyscallStats *stats) {
+		Q_UNUSED(stats);
+		return false;
+	}
+
+	// has the stopped debuggee fork a frozen copy of itself, returning the id
+	// of the new checkpoint, see Checkpoint.h. restore_checkpoint replaces
+	// the debuggee with a copy of the checkpoint, which stays to be restored
+	// again, the breakpoints set at the time carry over to it
+	virtual Result<int> create_checkpoint() {
+		return Result<int>(QString("Checkpoints are not supported by this debugger core"), 0);
+	}
+
+	virtual Status restore_checkpoint(int id) {
+		Q_UNUSED(id);
+		return Status(QString("Checkpoints are not supported by this debugger core"));
+	}
+
+	virtual void discard_checkpoint(int id) { Q_UNUSED(id); }
+	virtual QVector<Checkpoint> checkpoints() const { return QVector<Checkpoint>(); }
+
+	// what checkpoint <id> holds at <address>, as the debuggee had it when the
+	// checkpoint was taken. Returns the number of bytes read
+	virtual std::size_t read_checkpoint(int id, edb::address_t address, void *buf, std::size_t len) const {
+		Q_UNUSED(id);
+		Q_UNUSED(address);
+		Q_UNUSED(buf);
+		Q_UNUSED(len);
+		return 0;
+	}
+
+	// loads a core file in place of a live process. process() then reads
+	// from the file, nothing can be run, stepped or written to
+	virtual Status open_core(const QString &filename) {
+		Q_UNUSED(filename);
+		return Status(QString("Opening core files is not supported by this debugger core"));
+	}
+
+	// lays out a program's file the way it would be loaded and looks at that
+	// in place of a live process, without ever running it. It is closed the
+	// same way a core is
+	virtual Status open_image(const QString &filename) {
+		Q_UNUSED(filename);
+		return Status(QString("Opening files without running them is not supported by this debugger core"));
+	}
+
+	// debugs whatever the GDB remote stub listening at <host>:<port> is
+	// stopped in, in place of a local process
+	virtual Status connect_remote(const QString &host, quint16 port) {
+		Q_UNUSED(host);
+		Q_UNUSED(port);
+		return Status(QString("Remote debugging is not supported by this debugger core"));
+	}
+
+	// debugs <pid> alongside the processes already being debugged, it
+	// becomes the current one. process() is always the current inferior,
+	// the others stop and run along with it and the first to report an
+	// event becomes the current one. release_inferior detaches from the
+	// current one only (one which exited is just forgotten) and makes
+	// another the current one
+	virtual Status attach_inferior(edb::pid_t pid) {
+		Q_UNUSED(pid);
+		return Status(QString("Debugging several processes at once is not supported by this debugger core"));
+	}
+
+	virtual Status select_inferior(edb::pid_t pid) {
+		Q_UNUSED(pid);
+		return Status(QString("Debugging several processes at once is not supported by this debugger core"));
+	}
+
+	virtual Status release_inferior() {
+		return detach();
+	}
+
+	// the current inferior first
+	virtual QList<edb::pid_t> inferiors() const {
+		QList<edb::pid_t> pids;
+		if(IProcess *const current = process()) {
+			pids.push_back(current->pid());
+		}
+		return pids;
+	}
+
 public:
 	// NULL if not attached
 	virtual IProcess *process() const = 0;
@@ -22,9 +22,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtPlugin>
 #include <QList>
 #include <QVariantMap>
+#include <memory>
 
 class QMenu;
 class QAction;
+class StopSnapshot;
 
 class IPlugin {
 public:
@@ -52,6 +54,21 @@ public:
 	virtual QVariantMap save_state() const          { return QVariantMap(); }
 	virtual void restore_state(const QVariantMap &) { }
 
+public:
+	enum UpdateMode {
+		UPDATE_NONE,       // gui_updated() is all there is, for those connected to it
+		UPDATE_IMMEDIATE,  // right after gui_updated(), before the next event is handled
+		UPDATE_DEFERRED,   // on the GUI thread, once the stop is shown and input was handled
+		UPDATE_BACKGROUND  // on a worker thread, it may not touch any widgets
+	};
+
+	// optional, overload these to be updated at each stop which is drawn, with
+	// a snapshot of it. Unlike what is connected to gui_updated(), each call is
+	// timed, and the plugins dialog points out those which take too long. A
+	// background update isn't started again while the previous one still runs
+	virtual UpdateMode update_mode() const                                 { return UPDATE_NONE; }
+	virtual void stop_updated(const std::shared_ptr<const StopSnapshot> &) { }
+
 public:
 	enum ArgumentStatus {
 		ARG_SUCCESS,
@@ -21,10 +21,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "OSTypes.h"
 #include "Types.h"
+#include "MemoryRange.h"
 #include "Patch.h"
+#include "ReadRequest.h"
+#include "RegionUsage.h"
 #include "Status.h"
+#include "WriteRequest.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
 #include <QList>
 #include <QMap>
+#include <QString>
+#include <QVector>
+#include <functional>
 #include <memory>
 
 class IRegion;
@@ -37,6 +48,10 @@ class IProcess {
 public:
 	virtual ~IProcess() = default;
 
+public:
+	typedef std::function<bool(const QVector<RegionUsage> &)> UsageFunction; // returns false to stop
+	typedef std::function<void(const UsageFunction &)>          UsageReader;
+
 public:
 	// legal to call when not attached
 	virtual QDateTime                       start_time() const = 0;
@@ -67,6 +82,146 @@ public:
 	virtual Status                           step(edb::EVENT_STATUS status) = 0;
 	virtual bool                             isPaused() const = 0;
 	virtual QMap<edb::address_t, Patch>      patches() const = 0;
+
+public:
+	// optional, overload this if the platform can visit its threads without
+	// building the list threads() returns. calls <function> once per thread
+	virtual void for_each_thread(const std::function<void(const std::shared_ptr<IThread> &)> &function) const {
+		for(const std::shared_ptr<IThread> &thread : threads()) {
+			function(thread);
+		}
+	}
+
+	// optional, overload this if the platform can service many reads at once.
+	// returns the number of bytes read for each request, in the same order
+	virtual QVector<std::size_t> read_many(const QVector<ReadRequest> &requests) const {
+		QVector<std::size_t> results;
+		results.reserve(requests.size());
+		for(const ReadRequest &request : requests) {
+			results.push_back(read_bytes(request.address, request.buffer, request.size));
+		}
+		return results;
+	}
+
+	// optional, overload this if the platform can read memory without making
+	// the caller wait for it. reads each of <ranges>, the result holds as much
+	// of each one as could be read, in the same order. The default reads them
+	// before returning, an already finished future
+	virtual QFuture<QVector<QByteArray>> read_async(const QVector<MemoryRange> &ranges) const {
+		QVector<QByteArray> results;
+		results.reserve(ranges.size());
+		for(const MemoryRange &range : ranges) {
+			QByteArray bytes(static_cast<int>(range.size), '\0');
+			bytes.resize(static_cast<int>(read_bytes(range.address, bytes.data(), range.size)));
+			results.push_back(bytes);
+		}
+
+		QFutureInterface<QVector<QByteArray>> future;
+		future.reportStarted();
+		future.reportResult(results);
+		future.reportFinished();
+		return future.future();
+	}
+
+	// optional, overload this if the platform can service many writes at once.
+	// returns the number of bytes written for each request, in the same order
+	virtual QVector<std::size_t> write_many(const QVector<WriteRequest> &requests) {
+		QVector<std::size_t> results;
+		results.reserve(requests.size());
+		for(const WriteRequest &request : requests) {
+			results.push_back(write_bytes(request.address, request.buffer, request.size));
+		}
+		return results;
+	}
+
+	// optional, overload this if the platform keeps its patches by range.
+	// returns the patches which have a byte in [address, address + size), in
+	// address order
+	virtual QList<Patch> patches_in(edb::address_t address, std::size_t size) const {
+		QList<Patch> results;
+		const QMap<edb::address_t, Patch> all = patches();
+		for(const Patch &patch : all) {
+			if(patch.address < address + size && patch.address + patch.new_bytes.size() > address) {
+				results.push_back(patch);
+			}
+		}
+		return results;
+	}
+
+	// optional, overload this if the platform can track which pages the
+	// process writes to. fills <pages> with the start of every page of <region>
+	// which may have changed since the process was last continued (single
+	// steps don't count). returns false if that isn't known, in which case
+	// the caller has to assume that the whole region changed
+	virtual bool changed_pages(const std::shared_ptr<IRegion> &region, QVector<edb::address_t> *pages) const {
+		Q_UNUSED(region);
+		Q_UNUSED(pages);
+		return false;
+	}
+
+	// optional, overload this if the platform knows when the memory of the
+	// process may have changed. returns a value which stays the same for as
+	// long as reads keep returning the same bytes, so callers may keep what
+	// they read until it doesn't. The default never repeats, so nothing is
+	// kept
+	virtual quint64 memory_epoch() const {
+		static quint64 epoch = 0;
+		return ++epoch;
+	}
+
+	// optional, overload this if reads are served from a cache of whole pages.
+	// returns the pages it holds right now by their address, as they were
+	// read, breakpoints and all. Only good for as long as the process is
+	// stopped
+	virtual QHash<edb::address_t, QByteArray> cached_pages() const {
+		return QHash<edb::address_t, QByteArray>();
+	}
+
+	// optional, overload this if the platform can write core files. writes
+	// an ELF core of the process to <filename>, gzip compressed if <compress>
+	// is set. <progress> is called with the percentage done so far, returning
+	// false from it cancels
+	virtual Status write_core(const QString &filename, bool compress, const std::function<bool(int)> &progress) {
+		Q_UNUSED(filename);
+		Q_UNUSED(compress);
+		Q_UNUSED(progress);
+		return Status(QString("Writing core files is not supported by this debugger core"));
+	}
+
+	// optional, overload this if the platform can write snapshots. like
+	// write_core, but the memory goes to a store of pages shared by all the
+	// snapshots in the directory of <filename>, each distinct page once, so
+	// that many snapshots of one process take little more than one. the
+	// result opens with IDebugger::open_core
+	virtual Status write_snapshot(const QString &filename, const std::function<bool(int)> &progress) {
+		Q_UNUSED(filename);
+		Q_UNUSED(progress);
+		return Status(QString("Writing snapshots is not supported by this debugger core"));
+	}
+
+	// optional, overload this if the platform knows how much of each region
+	// is in memory. returns something which, when called, hands the usage of
+	// every region to its UsageFunction a batch at a time in address order.
+	// It doesn't use this object, so it may be run on a worker thread, and
+	// keep running after the process is gone (reporting nothing). The default
+	// returns an empty function
+	virtual UsageReader usage_reader() const {
+		return UsageReader();
+	}
+
+	// optional, overload this if the platform can change page protections
+	// synchronously. makes the pages of [address, address + size) readable,
+	// writable and executable as given, before returning. unlike
+	// IRegion::set_permissions this doesn't go through the debug event loop,
+	// so it can be used from inside a debug event handler
+	virtual Status protect(edb::address_t address, std::size_t size, bool read, bool write, bool execute) {
+		Q_UNUSED(address);
+		Q_UNUSED(size);
+		Q_UNUSED(read);
+		Q_UNUSED(write);
+		Q_UNUSED(execute);
+		return Status(QString("Changing page protections is not supported by this debugger core"));
+	}
 };
 
 #endif
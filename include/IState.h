@@ -57,6 +57,10 @@ public:
 	// GP
 	virtual Register gp_register(size_t n) const = 0;
 
+	// the *_value variants skip building a named Register, implementations
+	// which can read the value directly should override them
+	virtual edb::reg_t gp_register_value(size_t n) const { return gp_register(n).valueAsAddress(); }
+
 #if defined(EDB_X86) || defined(EDB_X86_64)
 public:
 	// FPU
@@ -75,9 +79,11 @@ public:
 public:
 	// SSE
 	virtual Register xmm_register(std::size_t n) const = 0;
+	virtual edb::value128 xmm_register_value(std::size_t n) const { return xmm_register(n).value<edb::value128>(); }
 public:
 	// AVX
 	virtual Register ymm_register(std::size_t n) const = 0;
+	virtual edb::value256 ymm_register_value(std::size_t n) const { return ymm_register(n).value<edb::value256>(); }
 #endif
 };
 
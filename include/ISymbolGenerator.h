@@ -29,6 +29,8 @@ public:
 	virtual ~ISymbolGenerator() = default;
 
 public:
+	// writes the symbols of <filename> to <symbol_file> as a SymbolFile. It is
+	// called from several threads at once for different files
 	virtual bool generate_symbol_file(const QString &filename, const QString &symbol_file) = 0;
 };
 
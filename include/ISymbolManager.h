@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "API.h"
 #include "Types.h"
+#include <functional>
 #include <memory>
 #include <QHash>
 #include <QList>
@@ -30,6 +31,10 @@ class Symbol;
 class ISymbolGenerator;
 
 class EDB_EXPORT ISymbolManager {
+public:
+	// given each match of a search, returns false to end it
+	typedef std::function<bool(const std::shared_ptr<Symbol> &)> SearchFunction;
+
 public:
 	virtual ~ISymbolManager() = default;
 
@@ -38,14 +43,26 @@ public:
 	virtual const std::shared_ptr<Symbol> find(const QString &name) const = 0;
 	virtual const std::shared_ptr<Symbol> find(edb::address_t address) const = 0;
 	virtual const std::shared_ptr<Symbol> find_near_symbol(edb::address_t address) const = 0;
+	virtual void search(const QString &text, bool prefix, const SearchFunction &found) const = 0;
 	virtual void add_symbol(const std::shared_ptr<Symbol> &symbol) = 0;
 	virtual void clear() = 0;
 	virtual void load_symbol_file(const QString &filename, edb::address_t base) = 0;
+	virtual void add_module(const QString &filename, edb::address_t base, edb::address_t start, edb::address_t end) = 0;
 	virtual void set_symbol_generator(ISymbolGenerator *generator) = 0;
 	virtual void set_label(edb::address_t address, const QString &label) = 0;
 	virtual QString find_address_name(edb::address_t address, bool prefixed=true) = 0;
 	virtual QHash<edb::address_t, QString> labels() const = 0;
 	virtual QList<QString> files() const = 0;
+
+public:
+	// changes whenever symbols or labels are added or removed, anything worked
+	// out from them stays valid for as long as it doesn't
+	virtual quint64 generation() const = 0;
+
+public:
+	// the import which the PLT stub or GOT slot at <address> is for, named
+	// like "printf@plt" and "printf@got", or an empty string if it isn't one
+	virtual QString find_import(edb::address_t address) const = 0;
 };
 
 #endif
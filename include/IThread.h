@@ -22,8 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include "OSTypes.h"
 #include "Status.h"
-
-class State;
+#include "State.h"
+#include <array>
+#include <initializer_list>
 
 class IThread {
 public:
@@ -47,6 +48,41 @@ public:
 	virtual Status resume(edb::EVENT_STATUS status) = 0;
 	virtual Status stop() = 0;
 
+public:
+	// runs until the next taken branch, where the hardware and OS support it
+	virtual bool supports_block_step() const { return false; }
+	virtual Status step_block(edb::EVENT_STATUS status) {
+		Q_UNUSED(status);
+		return Status(QString("Block stepping is not supported"));
+	}
+
+public:
+	// the hardware debug registers, DR0 - DR7 on x86. Going through these
+	// instead of get_state/set_state touches nothing else, the setter leaves
+	// the status registers (DR4 - DR6) alone
+	typedef std::array<edb::reg_t, 8> DebugRegisters;
+
+	virtual DebugRegisters get_debug_registers() {
+		State state;
+		get_state(&state);
+
+		DebugRegisters regs;
+		for(std::size_t i = 0; i < regs.size(); ++i) {
+			regs[i] = state.debug_register(i);
+		}
+		return regs;
+	}
+
+	virtual void set_debug_registers(const DebugRegisters &regs) {
+		State state;
+		get_state(&state);
+
+		for(std::size_t i : { 0, 1, 2, 3, 7 }) {
+			state.set_debug_register(i, regs[i]);
+		}
+		set_state(state);
+	}
+
 public:
 	virtual bool isPaused() const = 0;
 };
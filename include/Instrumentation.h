@@ -0,0 +1,135 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef INSTRUMENTATION_20171014_H_
+#define INSTRUMENTATION_20171014_H_
+
+#include "API.h"
+#include "LatencyHistogram.h"
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Timings of the hot paths (waiting for events, syncing regions, drawing, ...)
+// which can be looked at in chrome://tracing. Mark a scope with
+//
+//   EDB_TRACE_SCOPE("MemoryRegions::sync");
+//
+// which costs a single relaxed load while recording is off. While it is on,
+// each thread records into a ring of its own, so a long session only keeps
+// the most recent RingSize scopes of every thread. The names must be string
+// literals, only the pointers are kept.
+//
+// Independently of that, the commands of the user (a step, a run, ...) are
+// always timed from the command to the end of the update_gui it led to. A
+// scope marked with EDB_TRACE_SEGMENT counts towards one segment of that
+// time, less the segments nested in it, and every command finished adds to
+// the histograms of its segments
+class EDB_EXPORT Instrumentation {
+public:
+	static constexpr int RingSize = 65536;
+
+	enum Flags {
+		Recording = 1,
+		Measuring = 2 // a command is under way
+	};
+
+	enum Command {
+		StepInto,
+		StepOver,
+		Run,
+		Pause,
+		CommandCount
+	};
+
+	enum Segment {
+		EventWait,
+		ThreadStop,
+		StateFetch,
+		EventHandlers,
+		GuiRefresh,
+		SegmentCount,
+		Other = SegmentCount, // what no segment accounts for
+		Total,
+		HistogramCount
+	};
+
+public:
+	static int flags()    { return flags_.load(std::memory_order_relaxed); }
+	static bool enabled() { return flags() & Recording; }
+	static void set_enabled(bool enable);
+	static void clear();
+
+public:
+	static qint64 now(); // ns
+	static void record(const char *name, qint64 start, qint64 end);
+
+public:
+	// everything recorded so far, in the Chrome trace_event format
+	static QByteArray chrome_trace();
+
+public:
+	// a command which is still under way when the next one begins isn't counted
+	static void begin_command(Command command);
+	static void end_command();
+	static void add_segment(int segment, qint64 ns);
+	static LatencyHistogram histogram(Command command, int segment);
+	static void reset_histograms();
+	static QString command_name(int command);
+	static QString segment_name(int segment);
+
+private:
+	static std::atomic<int> flags_;
+};
+
+class EDB_EXPORT ScopedTrace {
+	Q_DISABLE_COPY(ScopedTrace)
+public:
+	explicit ScopedTrace(const char *name, int segment = -1) : name_(name), segment_(segment), flags_(Instrumentation::flags()) {
+		if(flags_) {
+			begin();
+		}
+	}
+
+	~ScopedTrace() {
+		if(flags_) {
+			end();
+		}
+	}
+
+private:
+	void begin();
+	void end();
+
+private:
+	const char * name_;
+	int          segment_;
+	int          flags_;
+	qint64       start_    = 0;
+	qint64       children_ = 0; // spent in segments nested in this one
+	ScopedTrace *parent_   = nullptr;
+};
+
+#define EDB_TRACE_CONCAT_(a, b)         a##b
+#define EDB_TRACE_CONCAT(a, b)          EDB_TRACE_CONCAT_(a, b)
+#define EDB_TRACE_SCOPE(name)           ScopedTrace EDB_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define EDB_TRACE_SEGMENT(name, segment) ScopedTrace EDB_TRACE_CONCAT(trace_scope_, __LINE__)(name, Instrumentation::segment)
+
+#endif
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LATENCY_HISTOGRAM_20171014_H_
+#define LATENCY_HISTOGRAM_20171014_H_
+
+#include "API.h"
+#include <QVector>
+#include <QtGlobal>
+
+// A histogram of durations in the manner of HdrHistogram: buckets get wider
+// as the values get larger, so that every value is kept to within about 1.6%
+// from nanoseconds up to centuries, in a fixed amount of memory
+class EDB_EXPORT LatencyHistogram {
+public:
+	void add(qint64 ns);
+	void clear();
+
+public:
+	quint64 count() const { return count_; }
+	qint64 min() const    { return min_; }
+	qint64 max() const    { return max_; }
+	qint64 mean() const;
+	qint64 percentile(double p) const;
+
+private:
+	static int bucket(qint64 ns);
+	static qint64 bucket_value(int index);
+
+private:
+	QVector<quint64> counts_; // allocated with the first value
+	quint64          count_ = 0;
+	qint64           min_   = 0;
+	qint64           max_   = 0;
+	double           sum_   = 0;
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORY_RANGE_H_
+#define MEMORY_RANGE_H_
+
+#include "Types.h"
+#include <cstddef>
+
+// a piece of memory to be read into a buffer of the reader's own, see
+// IProcess::read_async
+struct MemoryRange {
+	edb::address_t address;
+	std::size_t    size;
+};
+
+#endif
@@ -20,9 +20,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MEMORY_REGIONS_20060501_H_
 
 #include "API.h"
+#include "RegionUsage.h"
 #include "Types.h"
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
+#include <QVector>
+#include <memory>
 
 class IRegion;
 
@@ -38,18 +42,39 @@ public:
 	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
 	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
 
+public:
+	// the columns from here on are the usage ones, empty until merge_usage
+	// is given the region's usage. Views which don't want them hide them
+	static const int FirstUsageColumn = 4;
+
 public:
 	MemoryRegions();
 	virtual ~MemoryRegions();
 
 public:
 	std::shared_ptr<IRegion> find_region(edb::address_t address) const;
+	QVector<std::shared_ptr<IRegion>> find_regions(const QVector<edb::address_t> &addresses) const;
 	const QList<std::shared_ptr<IRegion>> &regions() const { return regions_; }
+	quint64 modules_generation() const { return modules_generation_; }
 	void clear();
 	void sync();
+	void merge_usage(const QVector<RegionUsage> &usage);
+	bool find_usage(const std::shared_ptr<IRegion> &region, RegionUsage *usage) const;
+
+private:
+	static bool is_module(const std::shared_ptr<IRegion> &region);
+	void note_module(const std::shared_ptr<IRegion> &region);
+	void add_modules();
+	void note_removed(int first, int last);
+	void rebuild_index();
+	int find_row(edb::address_t address) const;
 
 private:
 	QList<std::shared_ptr<IRegion>> regions_;
+	QVector<edb::address_t>         region_ends_; // end() of each entry of regions_, for binary searching
+	quint64                         modules_generation_; // bumped whenever a named mapping comes or goes
+	QList<std::shared_ptr<IRegion>> new_modules_;        // modules found by the current sync
+	QHash<quint64, RegionUsage>     usage_;              // by start address, see merge_usage
 };
 
 #endif
@@ -0,0 +1,47 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PATCH_LEDGER_20171014_H_
+#define PATCH_LEDGER_20171014_H_
+
+#include "API.h"
+#include "Patch.h"
+#include <QList>
+#include <QMap>
+#include <cstddef>
+
+// The patches made to a process, kept as ranges which neither overlap nor
+// touch: a patch which does is merged with them, so filling or editing a
+// selection piece by piece still leaves one range. The original bytes of a
+// merged range are those from before the first patch of each byte, the new
+// ones those of the last
+class EDB_EXPORT PatchLedger {
+public:
+	void record(edb::address_t address, const QByteArray &orig_bytes, const QByteArray &new_bytes);
+	void clear();
+
+public:
+	bool isEmpty() const                        { return patches_.isEmpty(); }
+	QMap<edb::address_t, Patch> patches() const { return patches_; }
+	QList<Patch> patches(edb::address_t address, std::size_t size) const;
+
+private:
+	QMap<edb::address_t, Patch> patches_; // by their first address
+};
+
+#endif
@@ -0,0 +1,35 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROCESS_SUMMARY_H_
+#define PROCESS_SUMMARY_H_
+
+#include "OSTypes.h"
+#include <QString>
+
+// what a process listing needs to know about a process, without opening it,
+// see IDebugger::enumerate_process_summaries
+struct ProcessSummary {
+	edb::pid_t pid;
+	edb::uid_t uid;
+	QString    user;
+	QString    name;
+};
+
+#endif
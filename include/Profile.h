@@ -0,0 +1,39 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROFILE_20171014_H_
+#define PROFILE_20171014_H_
+
+#include "Types.h"
+#include <QVector>
+
+// where one of the debuggee's threads was when it was sampled
+struct ProfileSample {
+	edb::tid_t              tid = 0;
+	edb::address_t          ip  = 0;
+	QVector<edb::address_t> callers; // return addresses, innermost first, empty unless call stacks were asked for
+};
+
+// the result of IDebugger::stop_profile
+struct Profile {
+	QVector<ProfileSample> samples;
+	quint64                lost = 0; // samples the kernel or the core had to drop
+};
+
+#endif
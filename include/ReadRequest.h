@@ -0,0 +1,32 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef READ_REQUEST_H_
+#define READ_REQUEST_H_
+
+#include "Types.h"
+#include <cstddef>
+
+// a single piece of a vectored read, see IProcess::read_many
+struct ReadRequest {
+	edb::address_t address;
+	void          *buffer;
+	std::size_t    size;
+};
+
+#endif
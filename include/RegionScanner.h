@@ -0,0 +1,75 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_SCANNER_20170614_H_
+#define REGION_SCANNER_20170614_H_
+
+#include "API.h"
+#include "Types.h"
+#include <QVector>
+#include <cstddef>
+#include <memory>
+
+class IRegion;
+
+// Streams the contents of a region through a fixed size buffer, so that
+// searching a region never needs more memory than one window. Typical use:
+//
+//   RegionScanner scanner(region, pattern_size - 1);
+//   while(scanner.next()) {
+//       search(scanner.address(), scanner.data(), scanner.size());
+//       progress(scanner.progress());
+//   }
+//
+// The first overlap() bytes of each window repeat the end of the previous
+// one (when the two are contiguous), so a match of up to overlap() + 1 bytes
+// is never split across windows, and never reported twice.
+class EDB_EXPORT RegionScanner {
+	Q_DISABLE_COPY(RegionScanner)
+public:
+	static constexpr std::size_t DefaultWindowSize = 0x100000;
+
+public:
+	explicit RegionScanner(const std::shared_ptr<IRegion> &region, std::size_t overlap = 0, std::size_t window_size = DefaultWindowSize);
+	RegionScanner(edb::address_t start, edb::address_t end, std::size_t overlap = 0, std::size_t window_size = DefaultWindowSize);
+
+public:
+	bool next();
+	void cancel();
+
+public:
+	edb::address_t address() const { return address_; }
+	const quint8 *data() const     { return buffer_.constData(); }
+	std::size_t size() const       { return size_; }
+	std::size_t overlap() const    { return overlap_; }
+	bool cancelled() const         { return cancelled_; }
+	int progress() const;
+
+private:
+	edb::address_t  start_;
+	edb::address_t  end_;
+	edb::address_t  position_;
+	edb::address_t  address_;
+	std::size_t     overlap_;
+	std::size_t     window_size_;
+	std::size_t     size_;
+	bool            cancelled_;
+	QVector<quint8> buffer_;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef REGION_SEARCH_20170716_H_
+#define REGION_SEARCH_20170716_H_
+
+#include "API.h"
+#include "SearchResultModel.h"
+#include "Types.h"
+#include <QList>
+#include <QVector>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class IRegion;
+
+// Searches a region a window at a time like RegionScanner, but matches
+// several windows at once on the global thread pool while the next ones are
+// read. Reading stays on the calling thread, the only one allowed to touch
+// the debuggee, so the matcher must not call into the debugger core; it is
+// given its own copy of each window. Typical use:
+//
+//   RegionSearch search([&pattern](const RegionSearch::Window &window) {
+//       QVector<SearchResult> results;
+//       ... look through window.data ...
+//       return results;
+//   }, pattern.size() - 1);
+//
+//   search.run(region, [&](const QVector<SearchResult> &results) {
+//       ui->listView->results()->append(results);
+//   }, [&](int percent) {
+//       ui->progressBar->setValue(percent);
+//   });
+//
+// Results are passed on in the order of the windows they came from
+class EDB_EXPORT RegionSearch {
+public:
+	struct Window {
+		edb::address_t  address;
+		QVector<quint8> data;
+		std::size_t     repeated;  // the leading bytes which are the tail of the previous window
+		bool            continued; // the next window goes on where this one ends
+	};
+
+	typedef std::function<QVector<SearchResult>(const Window &)> Matcher;
+	typedef std::function<void(const QVector<SearchResult> &)>   ResultFunction;
+	typedef std::function<void(int)>                             ProgressFunction;
+
+public:
+	explicit RegionSearch(const Matcher &matcher, std::size_t overlap = 0);
+
+public:
+	void run(const std::shared_ptr<IRegion> &region, const ResultFunction &results, const ProgressFunction &progress = ProgressFunction()) const;
+	void run(const QList<std::shared_ptr<IRegion>> &regions, const ResultFunction &results, const ProgressFunction &progress = ProgressFunction()) const;
+
+private:
+	Matcher     matcher_;
+	std::size_t overlap_;
+};
+
+#endif
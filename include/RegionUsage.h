@@ -0,0 +1,35 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_USAGE_20171014_H_
+#define REGION_USAGE_20171014_H_
+
+#include "Types.h"
+#include <QtGlobal>
+
+// how much of the region starting at <start> is actually in memory, all in
+// bytes, see IProcess::usage_reader
+struct RegionUsage {
+	edb::address_t start;
+	quint64        resident;     // in RAM
+	quint64        proportional; // resident, with shared pages split among their users
+	quint64        swapped;
+	quint64        dirty;        // resident and written to, shared or not
+};
+
+#endif
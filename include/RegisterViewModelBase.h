@@ -4,6 +4,7 @@
 #include "Register.h"
 #include <QAbstractItemModel>
 #include <deque>
+#include <functional>
 #include <vector>
 
 Q_DECLARE_METATYPE(std::vector<NumberDisplayMode>)
@@ -151,7 +152,8 @@ public:
 	virtual void setChosenSIMDFormat(QModelIndex const& index, NumberDisplayMode newFormat);
 	virtual void setChosenFPUFormat(QModelIndex const& index, NumberDisplayMode newFormat);
 
-	// Should be called after updating all the data
+	// Should be called after updating all the data, announces only the registers which differ
+	// from what the views were shown on the previous call
 	virtual void dataUpdateFinished();
 	// should be called when the debugger is about to resume, to save current register values to previous
 	virtual void saveValues();
@@ -211,19 +213,25 @@ public:
 	virtual bool setValue(QString const& valueStr) = 0;
 	virtual bool setValue(QByteArray const& value) = 0;
 	virtual bool setValue(Register const& reg) = 0;
+	// whether the value, comment or changed state differs from what the views have been told
+	// about, cleared by the call
+	virtual bool takeUpdated() = 0;
 };
 
 template<class StoredType>
 class RegisterItem : public AbstractRegisterItem
 {
 protected:
-	QString comment_;
+	mutable QString comment_;
+	mutable std::function<QString()> commentSource_; // makes comment_ when it's first asked for
 	bool valueKnown_=false;
 	bool prevValueKnown_=false;
+	bool updated_=true;
 	StoredType value_;
 	StoredType prevValue_;
 
 	virtual QString valueString() const;
+	QString comment() const;
 public:
 	RegisterItem(QString const& name);
 	bool valid() const override;
@@ -237,6 +245,7 @@ public:
 	bool setValue(QString const& valueStr) override;
 	bool setValue(QByteArray const& value) override;
 	bool setValue(Register const& reg) override;
+	bool takeUpdated() override;
 };
 
 template<class StoredType>
@@ -245,6 +254,9 @@ class SimpleRegister : public RegisterItem<StoredType>
 public:
 	SimpleRegister(QString const& name) : RegisterItem<StoredType>(name) {}
 	virtual void update(StoredType const& newValue, QString const& newComment);
+	// For comments which are expensive to make and can change while the value doesn't, like the
+	// string a register points to: made only if a view asks for it, and announced on every update
+	void updateLazily(StoredType const& newValue, std::function<QString()> const& commentSource);
 	virtual int valueMaxLength() const override;
 };
 
@@ -0,0 +1,85 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SEARCH_RESULT_MODEL_20170716_H_
+#define SEARCH_RESULT_MODEL_20170716_H_
+
+#include "API.h"
+#include "Types.h"
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QIODevice;
+
+struct SearchResult {
+	edb::address_t address;
+	QString        text; // shown after the address, may be empty
+	int            tag;  // for the owner of the model to tell kinds of result apart
+	quint32        size; // how many bytes were matched, if the owner needs to know
+};
+
+// The results of a memory search, kept in one flat vector instead of an item
+// a result, so that a search which turns up millions of hits only costs a
+// few dozen bytes for each and the view only ever formats the rows on screen.
+// Results arrive in batches, and each batch is one insertion for the view.
+// Searches with many hits can leave the text out and supply a TextFunction,
+// which makes it only for the rows which are shown
+class EDB_EXPORT SearchResultModel : public QAbstractListModel {
+	Q_OBJECT
+
+public:
+	enum Role {
+		AddressRole = Qt::UserRole,
+		TagRole
+	};
+
+	enum SortKey {
+		SortByAddress,
+		SortByText
+	};
+
+	typedef std::function<QString(const SearchResult &)> TextFunction;
+
+public:
+	SearchResultModel(QObject *parent = 0);
+	virtual ~SearchResultModel();
+
+public:
+	virtual QVariant data(const QModelIndex &index, int role) const;
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+public:
+	void append(const QVector<SearchResult> &results);
+	void append(edb::address_t address, const QString &text = QString(), int tag = 0);
+	void clear();
+	void setTextFunction(const TextFunction &function);
+	const SearchResult &result(int row) const { return results_[row]; }
+	QString text(int row) const;
+	QString displayText(int row) const;
+	bool save(QIODevice *device) const;
+
+private:
+	QVector<SearchResult> results_;
+	TextFunction          text_function_;
+};
+
+#endif
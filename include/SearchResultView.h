@@ -0,0 +1,49 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SEARCH_RESULT_VIEW_20170716_H_
+#define SEARCH_RESULT_VIEW_20170716_H_
+
+#include "API.h"
+#include <QListView>
+
+class SearchResultModel;
+
+// A list of search results which scales to as many as a search can find.
+// It owns its model, which callers fill through results(), and offers to
+// sort and export them from its context menu
+class EDB_EXPORT SearchResultView : public QListView {
+	Q_OBJECT
+
+public:
+	SearchResultView(QWidget *parent = 0);
+	virtual ~SearchResultView();
+
+public:
+	SearchResultModel *results() const { return model_; }
+
+private Q_SLOTS:
+	void showContextMenu(const QPoint &pos);
+	void exportResults();
+
+private:
+	SearchResultModel *const model_;
+};
+
+#endif
@@ -21,12 +21,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "API.h"
 #include "Types.h"
+#include <memory>
 
 class IState;
 class Register;
 class QString;
 
 namespace DebuggerCorePlugin {
+class CoreThread;
+class ImageThread;
+class RemoteThread;
 class DebuggerCore;
 class PlatformThread;
 }
@@ -35,6 +39,9 @@ class EDB_EXPORT State {
 
 	// TODO(eteran): I don't like needing to do this
 	// need to revisit the IState/State/PlatformState stuff...
+	friend class DebuggerCorePlugin::CoreThread;
+	friend class DebuggerCorePlugin::ImageThread;
+	friend class DebuggerCorePlugin::RemoteThread;
 	friend class DebuggerCorePlugin::DebuggerCore;
 	friend class DebuggerCorePlugin::PlatformThread;
 
@@ -59,6 +66,7 @@ public:
 	edb::reg_t debug_register(size_t n) const;
 	edb::reg_t flags() const;
 	Register gp_register(size_t n) const;
+	edb::reg_t gp_register_value(size_t n) const;
 	int fpu_stack_pointer() const;
 	edb::value80 fpu_register(size_t n) const;
 	bool fpu_register_is_empty(std::size_t n) const;
@@ -69,6 +77,8 @@ public:
 	Register mmx_register(std::size_t n) const;
 	Register xmm_register(std::size_t n) const;
 	Register ymm_register(std::size_t n) const;
+	edb::value128 xmm_register_value(std::size_t n) const;
+	edb::value256 ymm_register_value(std::size_t n) const;
 	void adjust_stack(int bytes);
 	void clear();
 	bool empty() const;
@@ -84,7 +94,12 @@ public:
 	Register operator[](const QString &reg) const;
 
 private:
-	IState *impl_;
+	IState *writable_impl();
+
+private:
+	// shared between copies until one of them is written to, and not created
+	// at all until something is stored in it
+	std::shared_ptr<IState> impl_;
 };
 
 Q_DECLARE_METATYPE(State)
@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STEP_CONDITION_20171014_H_
+#define STEP_CONDITION_20171014_H_
+
+#include "StepFilter.h"
+#include "Types.h"
+#include <functional>
+
+class State;
+
+// describes a run of single steps which never leaves the debugger core, see
+// IDebugger::step_until. The current thread is stepped until one of the
+// conditions which are set is met, and only that final stop is left for the
+// caller to show.
+//
+// The call depth starts at 0, a call makes it one deeper and a return one
+// shallower, so a depth target of -1 stops once the current function has
+// returned to its caller.
+struct StepCondition {
+	quint64        max_steps           = 0;     // instruction budget, 0 for no limit
+	edb::address_t range_start         = 0;     // stop once the instruction pointer leaves
+	edb::address_t range_end           = 0;     // [range_start, range_end), 0 for no range
+	bool           depth_limit         = false; // stop once the call depth is depth_target
+	int            depth_target        = 0;
+	bool           over_calls          = false; // run calls at full speed, as though filtered out
+	bool           stop_at_breakpoints = true;
+	StepFilter     filter;                      // calls out of it aren't stepped
+
+	// optional, usually a compiled Expression, stops once this returns true
+	// for the state before a step
+	std::function<bool(const State &)> condition;
+
+	// optional, called every so often with the number of steps so far,
+	// returning false cancels
+	std::function<bool(quint64)> progress;
+};
+
+struct StepResult {
+	enum Reason {
+		StepLimit,
+		Breakpoint,
+		Condition,
+		LeftRange,
+		Depth,
+		Cancelled,
+		Event,     // something other than a step happened, it is reported by wait_debug_event
+		Error
+	};
+
+	quint64 steps  = 0;
+	int     depth  = 0;
+	Reason  reason = Error;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STEP_FILTER_20171014_H_
+#define STEP_FILTER_20171014_H_
+
+#include "Types.h"
+#include <QVector>
+
+// the code which the core's step loops single step through, see
+// StepCondition and TraceRequest. A call to anywhere else runs at full speed
+// until it returns, with a breakpoint on its return address, so library code
+// can be left out of a trace without paying for stepping through it
+struct StepFilter {
+	struct Range {
+		edb::address_t start;
+		edb::address_t end;
+	};
+
+	QVector<Range> ranges; // empty steps through everything
+
+	bool empty() const { return ranges.isEmpty(); }
+
+	bool contains(edb::address_t address) const {
+		if(ranges.isEmpty()) {
+			return true;
+		}
+
+		for(const Range &range : ranges) {
+			if(address >= range.start && address < range.end) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STOP_SNAPSHOT_20171014_H_
+#define STOP_SNAPSHOT_20171014_H_
+
+#include "API.h"
+#include "OSTypes.h"
+#include "State.h"
+#include "Types.h"
+#include <QByteArray>
+#include <QHash>
+#include <memory>
+
+// A stop as a plugin updating after it gets to see it: the state of the
+// current thread, and the pages of the process which were read while the
+// views were drawn, with the breakpoints taken back out of them. Nothing in it
+// changes once it is made, so it may be read from any thread, and after the
+// process was continued. It only has what was cached, a read of anything
+// else comes up short
+class EDB_EXPORT StopSnapshot {
+public:
+	// of the current stop, nullptr if there is no process
+	static std::shared_ptr<const StopSnapshot> capture();
+
+private:
+	StopSnapshot() = default;
+
+public:
+	const State &state() const { return state_; }
+	edb::tid_t thread() const  { return thread_; }
+	int page_count() const     { return pages_.size(); }
+
+public:
+	std::size_t read_bytes(edb::address_t address, void *buf, std::size_t len) const;
+
+private:
+	State                             state_;
+	edb::tid_t                        thread_    = 0;
+	quint64                           page_size_ = 0;
+	QHash<edb::address_t, QByteArray> pages_;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SYMBOL_FILE_20170716_H_
+#define SYMBOL_FILE_20170716_H_
+
+#include "API.h"
+#include "Status.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+#include <memory>
+
+class QFile;
+
+// The binary form the symbols of a binary are cached in, so that loading them
+// is mapping a file instead of parsing one. It is laid out as
+//
+//   Header
+//   Entry[entry_count]    in address order
+//   quint32[slot_count]   the entries by name, open addressed by hash() with
+//                         linear probing, entry index + 1 and 0 if empty
+//   char[strings_size]    the NUL terminated UTF-8 names and the path of the
+//                         binary, each once
+//
+// in the byte order of the machine which wrote it, which is the only one
+// meant to read it. A file is for the binary with the MD5 in its header, and
+// is stale once that doesn't match
+class EDB_EXPORT SymbolFile {
+public:
+	static const quint32 VERSION = 2;
+
+	// Entry::flags
+	static const quint8 MANGLED = 0x01; // the name is to be demangled when it is shown
+
+	struct Header {
+		char    magic[8];
+		quint32 version;
+		quint32 header_size;  // sizeof(Header), so a different layout is refused
+		quint8  md5[16];
+		quint32 entry_count;
+		quint32 slot_count;   // a power of two, larger than entry_count
+		quint32 strings_size;
+		quint32 path;         // offset of the binary's path in the strings
+	};
+
+	struct Entry {
+		quint64 address;
+		quint32 size;
+		quint32 name;         // offset in the strings
+		quint8  type;
+		quint8  flags;
+		quint8  reserved[6];
+	};
+
+	// a symbol as it is handed to write()
+	struct Symbol {
+		quint64    address;
+		quint32    size;
+		QByteArray name; // UTF-8
+		char       type;
+		quint8     flags;
+	};
+
+public:
+	static Status write(const QString &filename, const QString &binary, const QByteArray &md5, QVector<Symbol> symbols);
+	static Result<std::shared_ptr<SymbolFile>> open(const QString &filename);
+	static quint32 hash(const char *name, std::size_t size);
+
+public:
+	~SymbolFile();
+
+private:
+	SymbolFile() = default;
+	SymbolFile(const SymbolFile &)            = delete;
+	SymbolFile &operator=(const SymbolFile &) = delete;
+
+public:
+	QByteArray md5() const;
+	QString path() const;
+
+public:
+	quint32 count() const                 { return header_->entry_count; }
+	const Entry &entry(quint32 n) const   { return entries_[n]; }
+	const char *strings() const           { return strings_; }
+	quint32 strings_size() const          { return header_->strings_size; }
+	const char *name(quint32 n) const;
+	int find_name(const QByteArray &name, quint32 hash) const;
+
+private:
+	std::unique_ptr<QFile> file_;
+	const Header          *header_  = nullptr;
+	const Entry           *entries_ = nullptr;
+	const quint32         *table_   = nullptr;
+	const char            *strings_ = nullptr;
+};
+
+#endif
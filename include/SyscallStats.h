@@ -0,0 +1,64 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SYSCALL_STATS_20171014_H_
+#define SYSCALL_STATS_20171014_H_
+
+#include "OSTypes.h"
+#include <QHash>
+#include <QMap>
+
+// what the system calls of a thread, of one number, added up to
+struct SyscallCounts {
+	quint64           calls       = 0;
+	quint64           errors      = 0; // returned -4095 to -1, like strace takes it
+	quint64           nanoseconds = 0; // between the entry and exit stops
+	QMap<int, quint64> errnos;         // how often each error was returned
+
+	SyscallCounts &operator+=(const SyscallCounts &rhs) {
+		calls       += rhs.calls;
+		errors      += rhs.errors;
+		nanoseconds += rhs.nanoseconds;
+		for(auto it = rhs.errnos.begin(); it != rhs.errnos.end(); ++it) {
+			errnos[it.key()] += it.value();
+		}
+		return *this;
+	}
+};
+
+// the system calls counted by IDebugger::start_syscall_stats, by thread and
+// then by number. A call is counted when it returns, so one which is still
+// running doesn't show up yet
+struct SyscallStats {
+	QHash<edb::tid_t, QMap<int, SyscallCounts>> threads;
+
+	bool isEmpty() const { return threads.isEmpty(); }
+
+	SyscallStats &operator+=(const SyscallStats &rhs) {
+		for(auto thread = rhs.threads.begin(); thread != rhs.threads.end(); ++thread) {
+			QMap<int, SyscallCounts> &counts = threads[thread.key()];
+			for(auto it = thread->begin(); it != thread->end(); ++it) {
+				counts[it.key()] += it.value();
+			}
+		}
+		return *this;
+	}
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TASK_SCHEDULER_20171014_H_
+#define TASK_SCHEDULER_20171014_H_
+
+#include "API.h"
+#include <QFuture>
+#include <QFutureInterface>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <memory>
+
+// What a task is handed, and what whoever started it keeps: a way to ask it
+// to stop, and to see how far it got. Copies share the same state
+class EDB_EXPORT TaskToken {
+public:
+	TaskToken();
+
+public:
+	void cancel() const;
+	bool cancelled() const;
+	bool finished() const;
+	int progress() const; // percent, -1 if the task doesn't say
+	void set_progress(int percent) const;
+	QString description() const;
+
+private:
+	friend class TaskScheduler;
+	struct State;
+	std::shared_ptr<State> state_;
+};
+
+// The one pool all background work runs on, edb::v1::task_scheduler(). It is
+// the global QThreadPool, which QtConcurrent uses too, so nothing started
+// anywhere can have more threads busy than the "max worker threads" option
+// allows (0 for one per core). Queued tasks are started highest priority
+// first; a running task is never preempted, so long ones should check
+// cancelled() and report progress() now and then. Typical use:
+//
+//   TaskToken token;
+//   QFuture<int> future = edb::v1::task_scheduler().run<int>("Plugin::count", TaskScheduler::Search, tr("Counting"), [](const TaskToken &token) {
+//       ...
+//       token.set_progress(percent);
+//       ...
+//   }, &token);
+//
+// Tasks with a description show it and their progress in the status bar
+// while they run. With instrumentation recording, every task is recorded
+// under its name, which must be a string literal
+class EDB_EXPORT TaskScheduler : public QObject {
+	Q_OBJECT
+public:
+	enum Priority {
+		Background  = 0,  // analysis, indexing, ...
+		Search      = 10, // something the user asked for and is waiting on
+		Interactive = 20  // prefetching for what is being looked at
+	};
+
+	typedef std::function<void(const TaskToken &)> Function;
+
+public:
+	TaskScheduler();
+	virtual ~TaskScheduler() override = default;
+
+public:
+	TaskToken start(const char *name, Priority priority, const QString &description, const Function &function);
+	QFuture<void> run(const char *name, Priority priority, const QString &description, const Function &function, TaskToken *token = nullptr);
+
+	// as above, the future is given what <function> returns
+	template <class T>
+	QFuture<T> run(const char *name, Priority priority, const QString &description, const std::function<T(const TaskToken &)> &function, TaskToken *token = nullptr) {
+		QFutureInterface<T> future;
+		future.reportStarted();
+
+		const TaskToken started = start(name, priority, description, [future, function](const TaskToken &token) mutable {
+			future.reportResult(token.cancelled() ? T() : function(token));
+			future.reportFinished();
+		});
+
+		if(token) {
+			*token = started;
+		}
+		return future.future();
+	}
+
+public:
+	void cancel_all();
+	int max_threads() const;
+
+public Q_SLOTS:
+	void apply_settings();
+
+private Q_SLOTS:
+	void update_status();
+
+private:
+	void finished(const TaskToken &token);
+
+private:
+	mutable QMutex   lock_;
+	QList<TaskToken> running_; // started and not yet finished
+	bool             status_scheduled_ = false;
+	bool             status_shown_     = false;
+};
+
+#endif
@@ -19,7 +19,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef THREADS_MODEL_H_
 #define THREADS_MODEL_H_
 
+#include "Types.h"
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QString>
 #include <QVector>
 #include <memory>
 
@@ -32,6 +36,14 @@ public:
 	struct Item {
 		std::shared_ptr<IThread> thread;
 		bool                     current;
+
+		// read from the thread the first time the row is shown after an update,
+		// with thousands of threads only the rows in view are ever looked at
+		mutable bool             fetched;
+		mutable int              priority;
+		mutable edb::address_t   instruction_pointer;
+		mutable QString          run_state;
+		mutable QString          name;
 	};
 
 public:
@@ -48,10 +60,16 @@ public:
 
 public:
 	void addThread(const std::shared_ptr<IThread> &thread, bool current);
+	void update(const QList<std::shared_ptr<IThread>> &threads, const std::shared_ptr<IThread> &current);
 	void clear();
+	std::shared_ptr<IThread> thread(const QModelIndex &index) const;
+
+private:
+	const Item &fetch(int row) const;
 
 private:
-	QVector<Item> items_;
+	QVector<Item>          items_;
+	QHash<edb::tid_t, int> rows_; // the row of each thread
 };
 
 #endif
@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_LOG_20170620_H_
+#define TRACE_LOG_20170620_H_
+
+#include "API.h"
+#include "State.h"
+#include "Types.h"
+#include <QVector>
+
+// one hit of a tracepoint. If the tracepoint has an expression, its value is
+// recorded, otherwise the whole register state is
+struct TraceRecord {
+	quint64        sequence  = 0;
+	quint64        hit_count = 0;
+	edb::address_t address   = 0;
+	edb::tid_t     tid       = 0;
+	bool           has_value = false;
+	edb::address_t value     = 0;
+	bool           has_state = false;
+	State          state;
+};
+
+// A fixed size ring of tracepoint hits. Once it is full, the oldest records
+// are overwritten, so a tracepoint which is hit forever never costs more
+// memory than capacity() records. Records are only ever added from the debug
+// event handler and read from the GUI, which run on the same thread, so no
+// locking is needed.
+class EDB_EXPORT TraceLog {
+	Q_DISABLE_COPY(TraceLog)
+public:
+	static constexpr int DefaultCapacity = 4096;
+
+public:
+	explicit TraceLog(int capacity = DefaultCapacity);
+
+public:
+	TraceRecord &append();
+	void clear();
+	void set_capacity(int capacity);
+
+public:
+	QVector<TraceRecord> records() const;
+	int capacity() const      { return capacity_; }
+	int size() const          { return ring_.size(); }
+	quint64 total() const     { return next_sequence_; }
+	quint64 dropped() const   { return next_sequence_ - ring_.size(); }
+
+private:
+	QVector<TraceRecord> ring_;
+	int                  capacity_;
+	quint64              next_sequence_;
+};
+
+#endif
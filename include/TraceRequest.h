@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRACE_REQUEST_20170622_H_
+#define TRACE_REQUEST_20170622_H_
+
+#include "StepFilter.h"
+#include "Types.h"
+#include <QString>
+#include <functional>
+
+class State;
+
+// describes a headless instruction trace, see IDebugger::record_trace.
+// The current thread is single stepped without returning to the event loop
+// until one of the stop conditions is met.
+//
+// The trace file starts with a header:
+//
+//   char    magic[8]        "EDBTRACE"
+//   quint32 version         1
+//   quint32 pointer_size
+//   quint32 tid             0 for hardware branch traces, they span threads
+//   quint32 register_count
+//   then register_count times: quint8 length, followed by that many
+//   latin1 characters, naming the registers in the order they are indexed
+//
+// followed by one record per traced instruction, or per block when block
+// stepping (all fields native endian):
+//
+//   quint64 ip
+//   quint8  delta_count     0 unless registers are recorded
+//   then delta_count times: quint8 register index, quint64 new value
+//
+// The first record with registers has every register as a delta.
+struct TraceRequest {
+	QString        filename;
+	quint64        max_steps        = 1000000; // 0 for no limit
+	edb::address_t range_start      = 0;       // only instructions in [range_start, range_end)
+	edb::address_t range_end        = 0;       // are recorded, 0 to record everything
+	bool           stop_outside_range  = false;
+	bool           stop_at_breakpoints = true;
+	bool           record_registers    = false;
+	bool           block_step          = false; // stop only at branch targets, see IThread::step_block
+	StepFilter     filter;                      // calls out of it aren't stepped, unless block stepping
+
+	// optional, stop once this returns true for the state before a step
+	std::function<bool(const State &)> stop_condition;
+
+	// optional, called every so often with the number of steps so far,
+	// returning false cancels the trace
+	std::function<bool(quint64)> progress;
+};
+
+struct TraceResult {
+	enum Reason {
+		StepLimit,
+		Breakpoint,
+		Condition,
+		LeftRange,
+		Cancelled,
+		Event,     // something other than a step happened, it is reported by wait_debug_event
+		Error
+	};
+
+	quint64 steps    = 0;
+	quint64 recorded = 0;
+	quint64 bytes    = 0;
+	Reason  reason   = Error;
+};
+
+#endif
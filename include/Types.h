@@ -49,6 +49,14 @@ enum EVENT_STATUS {
 	DEBUG_NEXT_HANDLER
 };
 
+// what the debugger core does with a signal the debuggee receives, before
+// any event is made of it
+enum SIGNAL_POLICY {
+	SIGNAL_STOP, // report it, the UI decides
+	SIGNAL_PASS, // deliver it straight away, nothing is reported
+	SIGNAL_LOG   // like SIGNAL_PASS, with a line in the log
+};
+
 namespace detail {
 
 template <int N>
@@ -0,0 +1,81 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WORD_SCAN_20171014_H_
+#define WORD_SCAN_20171014_H_
+
+#include <QtGlobal>
+#include <cstddef>
+#include <cstring>
+
+// Loops over the pointer sized words of a block of the debuggee's memory.
+// The size of a pointer is only known at run time, so rather than checking
+// it for every word, for_each_word checks it once and runs a loop made for
+// that size: every load is a single fixed size move and <function> is
+// inlined into it, which leaves the compiler free to unroll and vectorize.
+// The debuggee runs on the same machine, so its words are in our byte order.
+// Typical use:
+//
+//   util::for_each_word(edb::v1::pointer_size(), data, size, 0, [&](std::size_t offset, quint64 value) {
+//       ...
+//   });
+
+namespace util {
+
+// the <Word> at <p>, which needn't be aligned
+template <class Word>
+inline quint64 load_word(const quint8 *p) {
+	Word value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+// as above, for when the size isn't known up front
+inline quint64 load_word(std::size_t word_size, const quint8 *p) {
+	return (word_size == 8) ? load_word<quint64>(p) : load_word<quint32>(p);
+}
+
+// calls function(offset, value) for the <Word> at each offset from <first>
+// on, one word apart, which lies entirely in the <size> bytes at <data>
+template <class Word, class F>
+void for_each_word(const quint8 *data, std::size_t size, std::size_t first, F function) {
+	if(size < sizeof(Word)) {
+		return;
+	}
+
+	const std::size_t last = size - sizeof(Word);
+	for(std::size_t offset = first; offset <= last; offset += sizeof(Word)) {
+		function(offset, load_word<Word>(data + offset));
+	}
+}
+
+// as above, for words of <word_size> bytes (4 or 8)
+template <class F>
+void for_each_word(std::size_t word_size, const quint8 *data, std::size_t size, std::size_t first, F function) {
+	Q_ASSERT(word_size == 4 || word_size == 8);
+
+	if(word_size == 8) {
+		for_each_word<quint64>(data, size, first, function);
+	} else {
+		for_each_word<quint32>(data, size, first, function);
+	}
+}
+
+}
+
+#endif
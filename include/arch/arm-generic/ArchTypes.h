@@ -24,8 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace edb {
 
-typedef CapstoneEDB::Instruction  Instruction;
-typedef CapstoneEDB::Operand      Operand;
+typedef CapstoneEDB::Instruction     Instruction;
+typedef CapstoneEDB::Operand         Operand;
+typedef CapstoneEDB::Decoder         Decoder;
+typedef CapstoneEDB::InstructionPool InstructionPool;
+
+using CapstoneEDB::decode;
+using CapstoneEDB::decode_brief;
 
 }
 
@@ -22,9 +22,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "API.h"
 #include "IBinary.h"
 #include "Status.h"
+#include "OSTypes.h"
 #include "Types.h"
 #include <QMap>
 #include <QPointer>
+#include <QSet>
 #include <QStringList>
 #include <QVector>
 #include <memory>
@@ -42,6 +44,8 @@ class ISymbolManager;
 class MemoryRegions;
 class Register;
 class State;
+class TaskScheduler;
+class TraceLog;
 
 class QAbstractScrollArea;
 class QByteArray;
@@ -50,6 +54,7 @@ class QWidget;
 class QString;
 
 struct ExpressionError;
+struct HeatRange;
 
 namespace RegisterViewModelBase {
 class Model;
@@ -58,6 +63,7 @@ class Model;
 namespace edb {
 
 struct Prototype;
+struct StepFilter;
 
 namespace v1 {
 
@@ -74,6 +80,12 @@ EDB_EXPORT MemoryRegions &memory_regions();
 // the current arch processor
 EDB_EXPORT ArchProcessor &arch_processor();
 
+// the records of tracepoint hits
+EDB_EXPORT TraceLog &trace_log();
+
+// the pool all background work runs on
+EDB_EXPORT TaskScheduler &task_scheduler();
+
 // widgets
 EDB_EXPORT QAbstractScrollArea *disassembly_widget();
 
@@ -86,8 +98,18 @@ EDB_EXPORT address_t enable_breakpoint(address_t address);
 EDB_EXPORT std::shared_ptr<IBreakpoint> create_breakpoint(address_t address);
 EDB_EXPORT void remove_breakpoint(address_t address);
 EDB_EXPORT void set_breakpoint_condition(address_t address, const QString &condition);
+EDB_EXPORT void set_breakpoint_tracepoint(address_t address, bool tracepoint, const QString &expression);
+EDB_EXPORT void set_breakpoint_filters(address_t address, quint64 ignore_count, quint64 hit_limit, const QSet<tid_t> &threads);
 EDB_EXPORT void toggle_breakpoint(address_t address);
 
+// breakpoints in modules which may not be loaded yet, written as
+// "module!symbol", "module!symbol+offset" or "module+offset". Each is placed
+// whenever a module of that file name is loaded. Adding one fails if the
+// text can't be parsed or it is there already
+EDB_EXPORT bool add_pending_breakpoint(const QString &location);
+EDB_EXPORT bool remove_pending_breakpoint(const QString &location);
+EDB_EXPORT QStringList pending_breakpoints();
+
 EDB_EXPORT address_t current_data_view_address();
 
 // change what the various views show
@@ -118,10 +140,19 @@ EDB_EXPORT bool get_utf16_string_at_address(address_t address, QString &s, int m
 // Combination of get_ascii/utf16_at_address using current user configuration. May perform more analysis types in the future
 EDB_EXPORT bool get_human_string_at_address(address_t address, QString &s);
 
+// the same for many addresses at once, read together. Each entry is what the
+// one above would append without its trailing space, or empty if there is no
+// string at that address
+EDB_EXPORT QVector<QString> get_human_strings_at_addresses(const QVector<address_t> &addresses);
+
 EDB_EXPORT std::shared_ptr<IRegion> current_cpu_view_region();
 EDB_EXPORT std::shared_ptr<IRegion> primary_code_region();
 EDB_EXPORT std::shared_ptr<IRegion> primary_data_region();
 
+// the code of the named modules (by file name or path), for the core to step
+// through while everything else runs at full speed
+EDB_EXPORT StepFilter module_step_filter(const QStringList &modules);
+
 // configuration
 EDB_EXPORT QPointer<QDialog> dialog_options();
 EDB_EXPORT Configuration &config();
@@ -138,11 +169,17 @@ EDB_EXPORT QString find_function_symbol(address_t address, const QString &defaul
 // ask the user for either a value or a variable (register name and such)
 EDB_EXPORT address_t get_value(address_t address, bool *ok, ExpressionError *err);
 EDB_EXPORT address_t get_variable(const QString &s, bool *ok, ExpressionError *err);
+EDB_EXPORT address_t get_state_variable(const State &state, const QString &s, bool *ok, ExpressionError *err);
+EDB_EXPORT address_t evaluate_expression(const QString &expression, bool *ok, ExpressionError *err);
 
 // hook the debug event system
 EDB_EXPORT edb::EVENT_STATUS execute_debug_event_handlers(const std::shared_ptr<IDebugEvent> &e);
 EDB_EXPORT void add_debug_event_handler(IDebugEventHandler *p);
 EDB_EXPORT void remove_debug_event_handler(IDebugEventHandler *p);
+EDB_EXPORT void refresh_debug_event_handler(IDebugEventHandler *p);
+
+// for the debugger core, asked on every signal
+EDB_EXPORT edb::SIGNAL_POLICY signal_policy(int signal);
 
 EDB_EXPORT IAnalyzer *set_analyzer(IAnalyzer *p);
 EDB_EXPORT IAnalyzer *analyzer();
@@ -162,7 +199,8 @@ int get_instruction_bytes(address_t address, quint8 (&buffer)[N]) {
 
 EDB_EXPORT QString disassemble_address(address_t address);
 
-EDB_EXPORT std::unique_ptr<IBinary> get_binary_info(const std::shared_ptr<IRegion> &region);
+EDB_EXPORT std::shared_ptr<IBinary> get_binary_info(const std::shared_ptr<IRegion> &region);
+EDB_EXPORT QString module_cache_path(const std::shared_ptr<IRegion> &region, const QString &kind);
 EDB_EXPORT const Prototype *get_function_info(const QString &function);
 
 EDB_EXPORT address_t locate_main_function();
@@ -172,6 +210,10 @@ EDB_EXPORT IPlugin *find_plugin_by_name(const QString &name);
 
 EDB_EXPORT void reload_symbols();
 EDB_EXPORT void repaint_cpu_view();
+
+// tints the lines of the disassembly in <ranges>, more strongly the hotter
+// they are, e.g. to show which code ran. An empty list takes the tint away
+EDB_EXPORT void set_code_heat(const QVector<HeatRange> &ranges);
 EDB_EXPORT void update_ui();
 
 // these are here and not members of state because
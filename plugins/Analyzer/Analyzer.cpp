@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "AnalyzerWidget.h"
 #include "Configuration.h"
 #include "DialogXRefs.h"
+#include "FastHash.h"
 #include "Function.h"
 #include "IBinary.h"
 #include "IDebugger.h"
@@ -37,18 +38,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QMainWindow>
 #include <QMenu>
 #include <QMessageBox>
-#include <QProgressDialog>
+#include <QMutexLocker>
 #include <QSettings>
 #include <QStack>
+#include <QStringList>
 #include <QTime>
 #include <QToolBar>
 #include <QtDebug>
 
+#include <algorithm>
 #include <functional>
 #include <cstring>
 
@@ -71,6 +76,146 @@ namespace {
 
 const int MIN_REFCOUNT = 2;
 
+// how often a running analysis shows what it has found so far
+const int PUBLISH_INTERVAL = 250;
+
+// roughly what a node of a Qt container, or a shared_ptr's control block,
+// costs on top of its payload
+const int NODE_OVERHEAD = 32;
+
+// the analysis cache files. Addresses are stored relative to the start of the
+// region, so a cache stays good when the module is loaded somewhere else.
+// Bump the version whenever the layout changes
+const char    CACHE_MAGIC[8] = { 'E', 'D', 'B', 'A', 'N', 'L', 'Y', 'Z' };
+const quint32 CACHE_VERSION  = 5;
+
+//------------------------------------------------------------------------------
+// Name: put
+// Desc: appends <value> to a cache file being built
+//------------------------------------------------------------------------------
+template <class T>
+void put(QByteArray &out, T value) {
+	out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// reads a cache file straight out of its mapping, refusing to go past the end
+// of it so that a truncated file is just rejected
+class CacheReader {
+public:
+	CacheReader(const uchar *data, qint64 size) : p_(data), last_(data + size) {
+	}
+
+public:
+	bool read(void *buf, std::size_t n) {
+		if(static_cast<std::size_t>(last_ - p_) < n) {
+			return false;
+		}
+
+		std::memcpy(buf, p_, n);
+		p_ += n;
+		return true;
+	}
+
+	template <class T>
+	bool get(T *value) {
+		return read(value, sizeof(T));
+	}
+
+	bool at_end() const {
+		return p_ == last_;
+	}
+
+private:
+	const uchar *p_;
+	const uchar *last_;
+};
+
+//------------------------------------------------------------------------------
+// Name: make_adjacency
+// Desc: the adjacency lists of <edges>, (from, to) pairs which are sorted and
+//       have no duplicates
+//------------------------------------------------------------------------------
+IAnalyzer::Adjacency make_adjacency(const QVector<QPair<edb::address_t, edb::address_t>> &edges) {
+
+	IAnalyzer::Adjacency adjacency;
+	adjacency.edges.reserve(edges.size());
+
+	for(const QPair<edb::address_t, edb::address_t> &edge : edges) {
+		if(adjacency.keys.isEmpty() || adjacency.keys.last() != edge.first) {
+			adjacency.keys.push_back(edge.first);
+			adjacency.offsets.push_back(adjacency.edges.size());
+		}
+		adjacency.edges.push_back(edge.second);
+	}
+
+	adjacency.offsets.push_back(adjacency.edges.size());
+	return adjacency;
+}
+
+//------------------------------------------------------------------------------
+// Name: make_call_graph
+// Desc: the call graph of <calls>, which are (caller entry, target) pairs in
+//       any order
+//------------------------------------------------------------------------------
+IAnalyzer::CallGraph make_call_graph(QVector<QPair<edb::address_t, edb::address_t>> calls) {
+
+	IAnalyzer::CallGraph graph;
+
+	std::sort(calls.begin(), calls.end());
+	calls.erase(std::unique(calls.begin(), calls.end()), calls.end());
+	graph.callees = make_adjacency(calls);
+
+	for(QPair<edb::address_t, edb::address_t> &call : calls) {
+		qSwap(call.first, call.second);
+	}
+
+	std::sort(calls.begin(), calls.end());
+	graph.callers = make_adjacency(calls);
+	return graph;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_prefix
+// Desc: true for the bytes which may come before the opcode of a near call.
+//       REX is included regardless of the mode, outside of 64-bit mode these
+//       just decode as inc/dec and are rejected there
+//------------------------------------------------------------------------------
+bool is_prefix(quint8 byte) {
+	switch(byte) {
+	case 0x26: case 0x2e: case 0x36: case 0x3e:
+	case 0x64: case 0x65: case 0x66: case 0x67:
+	case 0xf0: case 0xf2: case 0xf3:
+		return true;
+	default:
+		return (byte & 0xf0) == 0x40;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: immediate_reference
+// Desc: true if <inst> is "push <imm>" or "mov [...], <imm>", which is as far
+//       as the References plugin goes for instructions that aren't branches
+//------------------------------------------------------------------------------
+bool immediate_reference(const edb::Instruction &inst, edb::address_t *target) {
+	switch(inst.operation()) {
+	case X86_INS_PUSH:
+		if(inst.operand_count() == 1 && is_immediate(inst[0])) {
+			*target = inst[0]->imm;
+			return true;
+		}
+		break;
+	case X86_INS_MOV:
+		if(inst.operand_count() == 2 && is_expression(inst[0]) && is_immediate(inst[1])) {
+			*target = inst[1]->imm;
+			return true;
+		}
+		break;
+	default:
+		break;
+	}
+	return false;
+}
+
 //------------------------------------------------------------------------------
 // Name: module_entry_point
 // Desc:
@@ -85,13 +230,61 @@ edb::address_t module_entry_point(const std::shared_ptr<IRegion> &region) {
 	return entry;
 }
 
+//------------------------------------------------------------------------------
+// Name: noreturn_functions
+// Desc: the addresses of the symbols whose prototypes say they don't return.
+//       The symbol manager may only be used from the GUI thread, so this is
+//       taken up front for the analysis to use
+//------------------------------------------------------------------------------
+QSet<edb::address_t> noreturn_functions() {
+
+	QSet<edb::address_t> results;
+
+	for(const std::shared_ptr<Symbol> &sym: edb::v1::symbol_manager().symbols()) {
+		const QString symname   = sym->name_no_prefix;
+		const QString func_name = symname.mid(0, symname.indexOf("@"));
+
+		if(const edb::Prototype *const info = edb::v1::get_function_info(func_name)) {
+			if(info->noreturn) {
+				results.insert(sym->address);
+			}
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: size_to_string
+// Desc:
+//------------------------------------------------------------------------------
+QString size_to_string(quint64 n) {
+
+	static constexpr quint64 KiB = 1024;
+	static constexpr quint64 MiB = KiB * 1024;
+	static constexpr quint64 GiB = MiB * 1024;
+
+	if(n < KiB) {
+		return QString::number(n);
+	} else if(n < MiB) {
+		return QString::number(n / KiB) + " KiB";
+	} else if(n < GiB) {
+		return QString::number(n / MiB) + " MiB";
+	} else {
+		return QString::number(n / GiB) + " GiB";
+	}
+}
+
 }
 
 //------------------------------------------------------------------------------
 // Name: Analyzer
 // Desc:
 //------------------------------------------------------------------------------
-Analyzer::Analyzer() : menu_(0), analyzer_widget_(0) {
+Analyzer::Analyzer() : menu_(0), generation_(0), analysis_watcher_(new QFutureWatcher<void>(this)), analyzer_widget_(0) {
+	connect(analysis_watcher_, SIGNAL(progressValueChanged(int)), this, SLOT(analysis_progress(int)));
+	connect(analysis_watcher_, SIGNAL(finished()), this, SLOT(analysis_finished()));
+	connect(this, SIGNAL(analysis_updated()), this, SLOT(update_views()));
 }
 
 //------------------------------------------------------------------------------
@@ -119,11 +312,15 @@ QMenu *Analyzer::menu(QWidget *parent) {
 		}
 
 		menu_->addAction(tr("&Analyze Viewed Region"), this, SLOT(do_view_analysis()), QKeySequence(tr("Ctrl+Shift+A")));
+		menu_->addAction(tr("Analyze All &Modules"), this, SLOT(do_module_analysis()));
 
 		// if we are dealing with a main window (and we are...)
 		// add the dock object
 		if(auto main_window = qobject_cast<QMainWindow *>(edb::v1::debugger_ui)) {
 			analyzer_widget_ = new AnalyzerWidget;
+			connect(this, SIGNAL(update_progress(int)), analyzer_widget_, SLOT(set_progress(int)));
+			connect(analyzer_widget_, SIGNAL(cancel_requested()), this, SLOT(cancel_analysis()));
+			connect(this, SIGNAL(analysis_changed()), analyzer_widget_, SLOT(invalidate_cache()));
 
 			// make the toolbar widget and _name_ it, it is important to name it so
 			// that it's state is saved in the GUI info
@@ -186,6 +383,137 @@ void Analyzer::do_view_analysis() {
 	do_analysis(edb::v1::current_cpu_view_region());
 }
 
+//------------------------------------------------------------------------------
+// Name: do_module_analysis
+// Desc: analyzes the executable regions of every module, spread over the
+//       thread pool
+//------------------------------------------------------------------------------
+void Analyzer::do_module_analysis() {
+
+	QList<std::shared_ptr<IRegion>> regions;
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(region->executable() && !region->name().isEmpty() && region->size() != 0) {
+			regions.push_back(region);
+		}
+	}
+
+	start_analysis(regions);
+}
+
+//------------------------------------------------------------------------------
+// Name: start_analysis
+// Desc: analyzes <regions> in the background, spread over the thread pool.
+//       Whatever analysis is still running is cancelled, this one supersedes it
+//------------------------------------------------------------------------------
+void Analyzer::start_analysis(const QList<std::shared_ptr<IRegion>> &regions) {
+
+	cancel_analysis();
+
+	// reading the process and the bonus steps have to happen here, everything
+	// after that only works on the copies
+	auto pending = std::make_shared<QVector<RegionData>>();
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		RegionData data;
+		if(prepare_region(region, &data)) {
+			pending->push_back(data);
+		}
+	}
+
+	if(pending->isEmpty()) {
+		return;
+	}
+
+	qDebug("[Analyzer] analyzing %d regions", pending->size());
+
+	Q_EMIT update_progress(0);
+
+#if QT_VERSION >= 0x040800 && defined(QT_CONCURRENT_LIB)
+	// each region is stored as soon as it is done, so the views can already
+	// show it while the rest are still being worked on. The functor keeps the
+	// regions alive for as long as the run needs them
+	analysis_watcher_->setFuture(QtConcurrent::map(*pending, [this, pending](RegionData &data) {
+		analyze_region(&data, false);
+		store_analysis(data);
+		data.memory = QVector<quint8>();
+	}));
+#else
+	for(RegionData &data : *pending) {
+		analyze_region(&data, false);
+		store_analysis(data);
+		data.memory = QVector<quint8>();
+	}
+
+	analysis_finished();
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: cancel_analysis
+// Desc: stops the background analysis, what it has stored so far is kept.
+//       Bumping the generation makes the workers give up at their next check
+//       and keeps anything they were about to store out of analysis_info_
+//------------------------------------------------------------------------------
+void Analyzer::cancel_analysis() {
+	{
+		QMutexLocker locker(&analysis_mutex_);
+		++generation_;
+	}
+
+	if(analysis_watcher_->isRunning()) {
+		qDebug("[Analyzer] analysis cancelled");
+		analysis_watcher_->cancel();
+		Q_EMIT update_progress(-1);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: cancelled
+// Desc: true if <data> belongs to a run which was cancelled or superseded
+//------------------------------------------------------------------------------
+bool Analyzer::cancelled(const RegionData *data) const {
+	Q_ASSERT(data);
+	return data->generation != generation_.load();
+}
+
+//------------------------------------------------------------------------------
+// Name: analysis_progress
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::analysis_progress(int value) {
+	const int minimum = analysis_watcher_->progressMinimum();
+	const int maximum = analysis_watcher_->progressMaximum();
+	if(maximum > minimum && !analysis_watcher_->isCanceled()) {
+		Q_EMIT update_progress(util::percentage(value - minimum, maximum - minimum));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: analysis_finished
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::analysis_finished() {
+	if(!analysis_watcher_->isCanceled()) {
+		qDebug("[Analyzer] complete");
+		Q_EMIT update_progress(100);
+	}
+
+	name_library_functions();
+	update_views();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_views
+// Desc: shows what the analysis has found so far
+//------------------------------------------------------------------------------
+void Analyzer::update_views() {
+	if(analyzer_widget_) {
+		analyzer_widget_->set_memory_report(memory_report());
+		analyzer_widget_->update();
+	}
+
+	edb::v1::repaint_cpu_view();
+}
+
 //------------------------------------------------------------------------------
 // Name: mark_function_start
 // Desc:
@@ -209,17 +537,9 @@ void Analyzer::show_xrefs() {
 	const edb::address_t address = edb::v1::cpu_selected_address();
 	
 	auto dialog = new DialogXRefs(edb::v1::debugger_ui);
-	
-	for(const RegionData &data : analysis_info_) {
-		for(const BasicBlock &bb : data.basic_blocks) {	
-			QVector<QPair<edb::address_t, edb::address_t>> refs = bb.refs();
-			for(auto it = refs.begin(); it != refs.end(); ++it) {
-			
-				if(it->second == address) {					
-					dialog->addReference(*it);
-				}	
-			}
-		}
+
+	for(const edb::address_t site : references(address)) {
+		dialog->addReference(qMakePair(site, address));
 	}
 	
 	dialog->setWindowTitle(tr("X-Refs For %1").arg(address.toPointerString()));
@@ -297,12 +617,7 @@ QList<QAction *> Analyzer::cpu_context_menu() {
 //------------------------------------------------------------------------------
 void Analyzer::do_analysis(const std::shared_ptr<IRegion> &region) {
 	if(region && region->size() != 0) {
-		QProgressDialog progress(tr("Performing Analysis"), 0, 0, 100, edb::v1::debugger_ui);
-		connect(this, SIGNAL(update_progress(int)), &progress, SLOT(setValue(int)));
-		progress.show();
-		progress.setValue(0);
-		analyze(region);
-		edb::v1::repaint_cpu_view();
+		start_analysis(QList<std::shared_ptr<IRegion>>() << region);
 	}
 }
 
@@ -343,6 +658,24 @@ void Analyzer::bonus_symbols(RegionData *data) {
 			data->known_functions.insert(addr);
 		}
 	}
+
+	// and for the ones the binary names, which the symbol files may not have
+	// been generated for yet. The header is usually in another region of the
+	// same module than the code
+	if(!data->region->name().isEmpty()) {
+		for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+			if(region->name() == data->region->name()) {
+				if(auto binary_info = edb::v1::get_binary_info(region)) {
+					for(const edb::address_t addr : binary_info->function_entries()) {
+						if(data->region->contains(addr)) {
+							data->known_functions.insert(addr);
+						}
+					}
+					break;
+				}
+			}
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -361,17 +694,85 @@ void Analyzer::bonus_marked_functions(RegionData *data) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: bonus_traced_functions
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::bonus_traced_functions(RegionData *data) {
+
+	Q_ASSERT(data);
+
+	Q_FOREACH(const edb::address_t addr, traced_functions_) {
+		if(data->region->contains(addr)) {
+			data->known_functions.insert(addr);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add_traced_functions
+// Desc: the regions which gained functions are analyzed again next time
+//------------------------------------------------------------------------------
+void Analyzer::add_traced_functions(const QSet<edb::address_t> &entries) {
+
+	QSet<edb::address_t> invalidated;
+
+	Q_FOREACH(const edb::address_t addr, entries) {
+		if(traced_functions_.contains(addr)) {
+			continue;
+		}
+
+		if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(addr)) {
+			traced_functions_.insert(addr);
+
+			bool analyzed;
+			{
+				QMutexLocker locker(&analysis_mutex_);
+				analyzed = analysis_info_.contains(region->start());
+			}
+
+			if(!invalidated.contains(region->start()) && analyzed) {
+				invalidated.insert(region->start());
+				invalidate_dynamic_analysis(region);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: instruction_bytes
+// Desc: copies the bytes of the instruction at <address> out of the copy of the
+//       region, so that the analysis never has to touch the process. Returns
+//       how many bytes there were, at most edb::Instruction::MAX_SIZE
+//------------------------------------------------------------------------------
+int Analyzer::instruction_bytes(const RegionData *data, edb::address_t address, quint8 *buf) const {
+
+	Q_ASSERT(data);
+
+	if(!data->region->contains(address)) {
+		return 0;
+	}
+
+	const std::size_t offset = address - data->region->start();
+	if(offset >= static_cast<std::size_t>(data->memory.size())) {
+		return 0;
+	}
+
+	const int size = static_cast<int>(std::min<std::size_t>(edb::Instruction::MAX_SIZE, data->memory.size() - offset));
+	std::memcpy(buf, data->memory.constData() + offset, size);
+	return size;
+}
+
 //------------------------------------------------------------------------------
 // Name: is_thunk
 // Desc: basically returns true if the first instruction of the function is a
 //       jmp
 //------------------------------------------------------------------------------
-bool Analyzer::is_thunk(edb::address_t address) const {
+bool Analyzer::is_thunk(const RegionData *data, edb::address_t address) const {
 
 	quint8 buf[edb::Instruction::MAX_SIZE];
-	if(const int buf_size = edb::v1::get_instruction_bytes(address, buf)) {
-		const edb::Instruction inst(buf, buf + buf_size, address);
-		return is_unconditional_jump(inst);
+	if(const int buf_size = instruction_bytes(data, address, buf)) {
+		return is_unconditional_jump(*edb::decode(buf, buf + buf_size, address));
 	}
 
 	return false;
@@ -381,9 +782,9 @@ bool Analyzer::is_thunk(edb::address_t address) const {
 // Name: set_function_types_helper
 // Desc:
 //------------------------------------------------------------------------------
-void Analyzer::set_function_types_helper(Function &function) const {
+void Analyzer::set_function_types_helper(const RegionData *data, Function &function) const {
 
-	if(is_thunk(function.entry_address())) {
+	if(is_thunk(data, function.entry_address())) {
 		function.set_type(Function::FUNCTION_THUNK);
 	} else {
 		function.set_type(Function::FUNCTION_STANDARD);
@@ -392,22 +793,44 @@ void Analyzer::set_function_types_helper(Function &function) const {
 
 //------------------------------------------------------------------------------
 // Name: set_function_types
-// Desc:
+// Desc: the type only depends on the first instruction, so the functions the
+//       previous analysis typed, at entries which didn't change since, keep
+//       theirs and only the rest are looked at
 //------------------------------------------------------------------------------
-void Analyzer::set_function_types(FunctionMap *results) {
+void Analyzer::set_function_types(RegionData *data) {
 
-	Q_ASSERT(results);
+	Q_ASSERT(data);
+
+	QHash<edb::address_t, Function::Type> function_types;
+	QVector<Function *> untyped;
+
+	for(Function &function : data->functions) {
+		auto it = data->function_types.find(function.entry_address());
+		if(it != data->function_types.end()) {
+			function.set_type(*it);
+			function_types.insert(it.key(), *it);
+		} else {
+			untyped.push_back(&function);
+		}
+	}
 
 	// give bonus if we have a symbol for the address
 #if QT_VERSION >= 0x040800 && defined(QT_CONCURRENT_LIB)
-	QtConcurrent::blockingMap(*results, [this](Function &function) {
-		set_function_types_helper(function);
+	QtConcurrent::blockingMap(untyped, [this, data](Function *function) {
+		set_function_types_helper(data, *function);
 	});
 #else
-	std::for_each(results->begin(), results->end(), [this](Function &function) {
-		set_function_types_helper(function);
+	std::for_each(untyped.begin(), untyped.end(), [this, data](Function *function) {
+		set_function_types_helper(data, *function);
 	});
 #endif
+
+	for(const Function *function : untyped) {
+		function_types.insert(function->entry_address(), function->type());
+	}
+
+	qDebug("[Analyzer] function types: %d remembered, %d looked up", data->functions.size() - untyped.size(), untyped.size());
+	qSwap(data->function_types, function_types);
 }
 
 //------------------------------------------------------------------------------
@@ -425,25 +848,45 @@ void Analyzer::ident_header(Analyzer::RegionData *data) {
 void Analyzer::collect_functions(Analyzer::RegionData *data) {
 	Q_ASSERT(data);
 
-	// results
-	QHash<edb::address_t, BasicBlock> basic_blocks;
-	FunctionMap                       functions;
+	// results, what was carried over from the previous analysis stays
+	QHash<edb::address_t, BasicBlock> basic_blocks = data->basic_blocks;
+	FunctionMap                       functions    = data->functions;
 
 	// push all known functions onto a stack
 	QStack<edb::address_t> known_functions;
 	Q_FOREACH(const edb::address_t function, data->known_functions) {
-		known_functions.push(function);
+		if(!functions.contains(function)) {
+			known_functions.push(function);
+		}
 	}
 
 	// push all fuzzy function too...
 	Q_FOREACH(const edb::address_t function, data->fuzzy_functions) {
-		known_functions.push(function);
+		if(!functions.contains(function)) {
+			known_functions.push(function);
+		}
 	}
 
+	QElapsedTimer publish_timer;
+	publish_timer.start();
+
 	// process all functions that are known
 	while(!known_functions.empty()) {
+		if(cancelled(data)) {
+			return;
+		}
+
+		if(publish_timer.elapsed() >= PUBLISH_INTERVAL) {
+			publish_partial(data, functions);
+			publish_timer.restart();
+		}
+
 		const edb::address_t function_address = known_functions.pop();
 
+		// what a library function calls is library code too, it is only
+		// worth looking at if it is a known function start on its own
+		const bool library_function = data->library_functions.contains(function_address);
+
 		if(!functions.contains(function_address)) {
 
 			QStack<edb::address_t> blocks;
@@ -462,12 +905,12 @@ void Analyzer::collect_functions(Analyzer::RegionData *data) {
 					while(data->region->contains(address)) {
 
 						quint8 buffer[edb::Instruction::MAX_SIZE];
-						const int buf_size = edb::v1::get_instruction_bytes(address, buffer);
+						const int buf_size = instruction_bytes(data, address, buffer);
 						if(buf_size == 0) {
 							break;
 						}
 
-						auto inst = std::make_shared<edb::Instruction>(buffer, buffer + buf_size, address);
+						auto inst = edb::decode(buffer, buffer + buf_size, address);
 						if(!inst->valid()) {
 							break;
 						}
@@ -485,9 +928,11 @@ void Analyzer::collect_functions(Analyzer::RegionData *data) {
 
 								// skip over ones which are: "call <label>; label:"
 								if(ea != address + inst->byte_size()) {
-									known_functions.push(ea);
+									if(!library_function) {
+										known_functions.push(ea);
+									}
 
-									if(!will_return(ea)) {
+									if(!will_return(data, ea)) {
 										break;
 									}
 									
@@ -545,6 +990,11 @@ void Analyzer::collect_functions(Analyzer::RegionData *data) {
 							break;
 						} else if(is_terminator(*inst)) {
 							break;
+						} else {
+							edb::address_t ea;
+							if(immediate_reference(*inst, &ea)) {
+								block.addRef(address, ea);
+							}
 						}
 
 						address += inst->byte_size();
@@ -582,6 +1032,8 @@ void Analyzer::collect_functions(Analyzer::RegionData *data) {
 
 	qSwap(data->basic_blocks, basic_blocks);
 	qSwap(data->functions, functions);
+
+	build_call_graph(data);
 }
 
 //------------------------------------------------------------------------------
@@ -591,126 +1043,690 @@ void Analyzer::collect_functions(Analyzer::RegionData *data) {
 void Analyzer::collect_fuzzy_functions(RegionData *data) {
 	Q_ASSERT(data);
 
-	data->fuzzy_functions.clear();
-
-	if(data->fuzzy) {
-
-		QHash<edb::address_t, int> fuzzy_functions;
-
-		quint8 *const first = &data->memory[0];
-		quint8 *const last  = &first[data->memory.size()];
-		quint8 *p           = first;
-
-		// fuzzy_functions, known_functions
-		for(edb::address_t addr = data->region->start(); addr != data->region->end(); ++addr) {
-			const edb::Instruction inst(p, last, addr);
-			if(inst) {
-				if(is_call(inst)) {
-
-					// note the destination and move on
-					// we special case some simple things.
-					// also this is an opportunity to find call tables.
-					const auto op = inst[0];
-					if(is_immediate(op)) {
-						const edb::address_t ea = op->imm;
+	if(!data->fuzzy) {
+		data->fuzzy_functions.clear();
+		return;
+	}
 
-						// skip over ones which are: "call <label>; label:"
-						if(ea != addr + inst.byte_size()) {
+	QHash<edb::address_t, int> fuzzy_functions;
 
-							if(!data->known_functions.contains(ea)) {
-								fuzzy_functions[ea]++;
-							}
-						}
-					}
-				}
+	if(data->dirty_ranges.isEmpty()) {
+		data->fuzzy_functions.clear();
+		count_fuzzy_calls(data, data->region->start(), data->region->end(), &fuzzy_functions);
+	} else {
+		// the counts of the unchanged pages aren't kept, so this only finds
+		// what the changed pages call often enough on their own. Candidates
+		// inside them are dropped, collect_functions gets back the real ones
+		for(auto it = data->fuzzy_functions.begin(); it != data->fuzzy_functions.end();) {
+			if(is_dirty(data, *it, *it + 1)) {
+				it = data->fuzzy_functions.erase(it);
+			} else {
+				++it;
 			}
+		}
 
-			++p;
+		for(const QPair<edb::address_t, edb::address_t> &range : data->dirty_ranges) {
+			// an instruction which starts just before the range may reach into it
+			const edb::address_t first = qMax<edb::address_t>(data->region->start(), range.first - (edb::Instruction::MAX_SIZE - 1));
+			count_fuzzy_calls(data, first, range.second, &fuzzy_functions);
 		}
+	}
 
-		// transfer results to data->fuzzy_functions
-		for(auto it = fuzzy_functions.begin(); it != fuzzy_functions.end(); ++it) {
-			if(it.value() > MIN_REFCOUNT) {
-				data->fuzzy_functions.insert(it.key());
-			}
+	if(cancelled(data)) {
+		return;
+	}
+
+	// transfer results to data->fuzzy_functions
+	for(auto it = fuzzy_functions.begin(); it != fuzzy_functions.end(); ++it) {
+		if(it.value() > MIN_REFCOUNT && !data->known_functions.contains(it.key())) {
+			data->fuzzy_functions.insert(it.key());
 		}
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: analyze
-// Desc:
+// Name: match_signatures
+// Desc: looks each function start up in the library signatures, one hash
+//       lookup on its first bytes narrows that down to a handful to compare
 //------------------------------------------------------------------------------
-void Analyzer::analyze(const std::shared_ptr<IRegion> &region) {
-
-	QTime t;
-	t.start();
+void Analyzer::match_signatures(RegionData *data) const {
+	Q_ASSERT(data);
 
-	RegionData &region_data = analysis_info_[region->start()];
-	qDebug() << "[Analyzer] Region name:" << region->name();
+	data->library_functions.clear();
 
-	QSettings settings;
-	const bool fuzzy = settings.value("Analyzer/fuzzy_logic_functions.enabled", true).toBool();
+	if(!data->signatures || data->signatures->isEmpty() || data->memory.isEmpty()) {
+		return;
+	}
 
-	const edb::address_t page_size = edb::v1::debugger_core->page_size();
-	const size_t page_count        = region->size() / page_size;
+	const auto match = [data](edb::address_t address) {
+		if(!data->region->contains(address)) {
+			return;
+		}
 
-	QVector<quint8> memory = edb::v1::read_pages(region->start(), page_count);
+		const std::size_t offset = (address - data->region->start()).toUint();
+		if(offset >= static_cast<std::size_t>(data->memory.size())) {
+			return;
+		}
 
-	const QByteArray md5      = (!memory.isEmpty()) ? edb::v1::get_md5(memory) : QByteArray();
-	const QByteArray prev_md5 = region_data.md5;
-
-	if(md5 != prev_md5 || fuzzy != region_data.fuzzy) {
-
-		region_data.basic_blocks.clear();
-		region_data.functions.clear();
-		region_data.fuzzy_functions.clear();
-		region_data.known_functions.clear();
-
-		region_data.memory = memory;
-		region_data.region = region;
-		region_data.md5    = md5;
-		region_data.fuzzy  = fuzzy;
-
-		const struct {
-			const char             *message;
-			std::function<void()> function;
-		} analysis_steps[] = {
-			{ "identifying executable headers...",                       [this, &region_data]() { ident_header(&region_data);            } },
-			{ "adding entry points to the list...",                      [this, &region_data]() { bonus_entry_point(&region_data);       } },
-			{ "attempting to add 'main' to the list...",                 [this, &region_data]() { bonus_main(&region_data);              } },
-			{ "attempting to add functions with symbols to the list...", [this, &region_data]() { bonus_symbols(&region_data);           } },
-			{ "attempting to add marked functions to the list...",       [this, &region_data]() { bonus_marked_functions(&region_data);  } },
-			{ "attempting to collect functions with fuzzy analysis...",  [this, &region_data]() { collect_fuzzy_functions(&region_data); } },
-			{ "collecting basic blocks...",                              [this, &region_data]() { collect_functions(&region_data);       } },
-		};
-
-		const int total_steps = sizeof(analysis_steps) / sizeof(analysis_steps[0]);
-
-		Q_EMIT update_progress(util::percentage(0, total_steps));
-		for(int i = 0; i < total_steps; ++i) {
-			qDebug("[Analyzer] %s", analysis_steps[i].message);
-			analysis_steps[i].function();
-			Q_EMIT update_progress(util::percentage(i + 1, total_steps));
+		if(const SignatureDatabase::Signature *signature = data->signatures->match(data->memory.constData() + offset, data->memory.size() - offset)) {
+			data->library_functions.insert(address, signature->name);
 		}
+	};
 
-		qDebug("[Analyzer] determining function types...");
+	Q_FOREACH(const edb::address_t function, data->known_functions) {
+		match(function);
+	}
 
-		set_function_types(&region_data.functions);
+	Q_FOREACH(const edb::address_t function, data->fuzzy_functions) {
+		match(function);
+	}
 
-		qDebug("[Analyzer] complete");
-		Q_EMIT update_progress(100);
+	qDebug("[Analyzer] %d of the function starts are library functions", data->library_functions.size());
+}
 
-		if(analyzer_widget_) {
-			analyzer_widget_->update();
+//------------------------------------------------------------------------------
+// Name: signature_database
+// Desc: the signatures in the directory the options name, loaded again only
+//       when that changes
+//------------------------------------------------------------------------------
+std::shared_ptr<const SignatureDatabase> Analyzer::signature_database() {
+
+	QSettings settings;
+	const QString directory = settings.value("Analyzer/signature_directory", QString()).toString();
+
+	if(!signatures_ || directory != signature_directory_) {
+		auto signatures = std::make_shared<SignatureDatabase>();
+		if(!directory.isEmpty()) {
+			signatures->load(directory);
 		}
 
+		signatures_          = signatures;
+		signature_directory_ = directory;
+	}
 
-	} else {
-		qDebug("[Analyzer] region unchanged, using previous analysis");
+	return signatures_;
+}
+
+//------------------------------------------------------------------------------
+// Name: name_library_functions
+// Desc: gives the library functions the analysis found the names of their
+//       signatures, unless they already have a symbol or a label. The symbol
+//       manager may only be used from the GUI thread
+//------------------------------------------------------------------------------
+void Analyzer::name_library_functions() {
+
+	QHash<edb::address_t, QString> library_functions;
+	{
+		QMutexLocker locker(&analysis_mutex_);
+		for(const RegionData &data : analysis_info_) {
+			for(auto it = data.library_functions.begin(); it != data.library_functions.end(); ++it) {
+				library_functions.insert(it.key(), it.value());
+			}
+		}
+	}
+
+	if(library_functions.isEmpty()) {
+		return;
+	}
+
+	ISymbolManager &symbols = edb::v1::symbol_manager();
+	const QHash<edb::address_t, QString> labels = symbols.labels();
+
+	for(auto it = library_functions.begin(); it != library_functions.end(); ++it) {
+		if(!labels.contains(it.key()) && !symbols.find(it.key())) {
+			symbols.set_label(it.key(), it.value());
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: count_fuzzy_calls
+// Desc: counts the targets of anything which decodes as a direct call at an
+//       address in [first, last). Those all have an E8 opcode, maybe behind
+//       some prefixes, so the region is searched for that byte first and only
+//       the places which could be such a call are decoded
+//------------------------------------------------------------------------------
+void Analyzer::count_fuzzy_calls(const RegionData *data, edb::address_t first, edb::address_t last, QHash<edb::address_t, int> *counts) const {
+	Q_ASSERT(data);
+	Q_ASSERT(counts);
+
+	const quint8 *const memory = data->memory.constData();
+	const quint8 *const end    = memory + data->memory.size();
+	const quint8 *const from   = memory + (first - data->region->start());
+	const quint8 *const to     = memory + qMin<edb::address_t>(last - data->region->start(), data->memory.size());
+
+	// an instruction starting before <to> may have its opcode after it
+	const quint8 *const scan_end = std::min(end, to + (edb::Instruction::MAX_SIZE - 1));
+
+	edb::Decoder decoder;
+
+	const quint8 *next_check = from;
+	const quint8 *p          = from;
+	while(p < scan_end) {
+		if(p >= next_check) {
+			if(cancelled(data)) {
+				return;
+			}
+			next_check = p + 0x10000;
+		}
+
+		const auto opcode = static_cast<const quint8 *>(std::memchr(p, 0xe8, scan_end - p));
+		if(!opcode) {
+			break;
+		}
+
+		// the call itself, and each start which puts it behind prefixes. The
+		// runs of prefixes belonging to different opcodes never overlap
+		const quint8 *start = opcode;
+		while(start > from && opcode - (start - 1) < static_cast<std::ptrdiff_t>(edb::Instruction::MAX_SIZE) && is_prefix(start[-1])) {
+			--start;
+		}
+
+		for(const quint8 *q = start; q <= opcode && q < to; ++q) {
+			const edb::address_t addr = data->region->start() + (q - memory);
+			const edb::Instruction &inst = decoder.decode(q, end, addr);
+			if(inst && is_call(inst)) {
+
+				// note the destination and move on
+				// we special case some simple things.
+				// also this is an opportunity to find call tables.
+				const auto op = inst[0];
+				if(is_immediate(op)) {
+					const edb::address_t ea = op->imm;
+
+					// skip over ones which are: "call <label>; label:"
+					if(ea != addr + inst.byte_size()) {
+						(*counts)[ea]++;
+					}
+				}
+			}
+		}
+
+		p = opcode + 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: is_dirty
+// Desc: true if [first, last) overlaps a page which changed since the previous
+//       analysis
+//------------------------------------------------------------------------------
+bool Analyzer::is_dirty(const RegionData *data, edb::address_t first, edb::address_t last) const {
+	Q_ASSERT(data);
+
+	for(const QPair<edb::address_t, edb::address_t> &range : data->dirty_ranges) {
+		if(first < range.second && range.first < last) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: discard_dirty_analysis
+// Desc: throws away the blocks, and the functions, which were carried over
+//       from the previous analysis but overlap a changed page. The entries of
+//       those functions are explored again by collect_functions
+//------------------------------------------------------------------------------
+void Analyzer::discard_dirty_analysis(RegionData *data) {
+	Q_ASSERT(data);
+
+	if(data->dirty_ranges.isEmpty()) {
+		return;
+	}
+
+	// a thunk is told apart by its first instruction
+	for(auto it = data->function_types.begin(); it != data->function_types.end();) {
+		if(is_dirty(data, it.key(), it.key() + edb::Instruction::MAX_SIZE)) {
+			it = data->function_types.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for(auto it = data->basic_blocks.begin(); it != data->basic_blocks.end();) {
+		if(is_dirty(data, it.key(), it.key() + it->byteSize())) {
+			it = data->basic_blocks.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	int discarded = 0;
+	for(auto it = data->functions.begin(); it != data->functions.end();) {
+
+		bool dirty = false;
+		for(const BasicBlock &block : *it) {
+			if(is_dirty(data, block.firstAddress(), block.firstAddress() + block.byteSize())) {
+				dirty = true;
+				break;
+			}
+		}
+
+		if(dirty) {
+			// its clean blocks have to go too, or exploring it again would
+			// stop at them instead of adding them to the new function
+			for(const BasicBlock &block : *it) {
+				data->basic_blocks.remove(block.firstAddress());
+			}
+
+			data->known_functions.insert(it.key());
+			it = data->functions.erase(it);
+			++discarded;
+		} else {
+			++it;
+		}
+	}
+
+	qDebug("[Analyzer] %d changed page runs, %d functions to analyze again, %d kept", data->dirty_ranges.size(), discarded, data->functions.size());
+}
+
+//------------------------------------------------------------------------------
+// Name: prepare_region
+// Desc: takes a copy of <region> and does the steps which need the debugger or
+//       the symbols, both of which may only be used from the GUI thread.
+//       Returns false if the previous analysis of the region still holds
+//------------------------------------------------------------------------------
+bool Analyzer::prepare_region(const std::shared_ptr<IRegion> &region, RegionData *data) {
+
+	Q_ASSERT(data);
+
+	qDebug() << "[Analyzer] Region name:" << region->name();
+
+	QSettings settings;
+	const bool fuzzy = settings.value("Analyzer/fuzzy_logic_functions.enabled", true).toBool();
+
+	const edb::address_t page_size = edb::v1::debugger_core->page_size();
+	const size_t page_count        = region->size() / page_size;
+
+	QVector<quint8> memory = edb::v1::read_pages(region->start(), page_count);
+
+	// hashing each page is what lets a region which changed in only a few
+	// places keep the analysis of the rest. This only has to notice changes,
+	// so it is the fast hash, spread over the thread pool
+	QVector<quint64> page_hashes;
+	quint64          digest = 0;
+	if(!memory.isEmpty()) {
+		page_hashes = FastHash::hash_pages(memory.constData(), page_count, page_size.toUint());
+		digest      = FastHash::digest(page_hashes);
+	}
+
+	RegionData previous;
+	{
+		QMutexLocker locker(&analysis_mutex_);
+		auto it = analysis_info_.find(region->start());
+		if(it != analysis_info_.end() && it->digest == digest && it->fuzzy == fuzzy) {
+			qDebug("[Analyzer] region unchanged, using previous analysis");
+			return false;
+		}
+
+		const RegionData *candidate = (it != analysis_info_.end()) ? &it.value() : nullptr;
+
+		// the last process had the same module here, so it was restarted
+		RegionData kept;
+		auto retained = retained_analysis_.find(region->start());
+		if(!candidate && retained != retained_analysis_.end()) {
+			if(retained->region->name() == region->name() && retained->region->size() == region->size()) {
+				kept = *retained;
+				retained_analysis_.erase(retained);
+
+				if(kept.digest == digest && kept.fuzzy == fuzzy) {
+					qDebug("[Analyzer] region unchanged since the restart, using previous analysis");
+					kept.region     = region;
+					kept.generation = generation_.load();
+					analysis_info_.insert(region->start(), kept);
+					locker.unlock();
+					Q_EMIT analysis_changed();
+					return false;
+				}
+
+				candidate = &kept;
+			}
+		}
+
+		// only a finished analysis of the same pages can be built on
+		if(candidate && candidate->digest != 0 && digest != 0 && candidate->fuzzy == fuzzy && candidate->page_hashes.size() == page_hashes.size()) {
+			previous = *candidate;
+		}
+	}
+
+	if(previous.region) {
+		for(int i = 0; i < page_hashes.size(); ++i) {
+			if(page_hashes[i] != previous.page_hashes[i]) {
+				const edb::address_t page = region->start() + page_size * i;
+				if(!data->dirty_ranges.isEmpty() && data->dirty_ranges.back().second == page) {
+					data->dirty_ranges.back().second = page + page_size;
+				} else {
+					data->dirty_ranges.push_back(qMakePair(page, page + page_size));
+				}
+			}
+		}
+
+		edb::address_t dirty_size = 0;
+		for(const QPair<edb::address_t, edb::address_t> &range : data->dirty_ranges) {
+			dirty_size += range.second - range.first;
+		}
+
+		// past a point starting over is cheaper than sorting out what survived
+		if(dirty_size > region->size() / 2) {
+			data->dirty_ranges.clear();
+		} else {
+			data->basic_blocks    = previous.basic_blocks;
+			data->functions       = previous.functions;
+			data->fuzzy_functions = previous.fuzzy_functions;
+			data->function_types  = previous.function_types;
+		}
+	}
+
+	data->memory             = memory;
+	data->page_hashes        = page_hashes;
+	data->region             = region;
+	data->digest             = digest;
+	data->fuzzy              = fuzzy;
+	data->noreturn_functions = noreturn_functions();
+	data->signatures         = signature_database();
+	data->generation         = generation_.load();
+	data->cache_path         = get_analysis_path(region);
+
+	const struct {
+		const char             *message;
+		std::function<void()> function;
+	} analysis_steps[] = {
+		{ "identifying executable headers...",                       [this, data]() { ident_header(data);           } },
+		{ "adding entry points to the list...",                      [this, data]() { bonus_entry_point(data);      } },
+		{ "attempting to add 'main' to the list...",                 [this, data]() { bonus_main(data);             } },
+		{ "attempting to add functions with symbols to the list...", [this, data]() { bonus_symbols(data);          } },
+		{ "attempting to add marked functions to the list...",       [this, data]() { bonus_marked_functions(data); } },
+		{ "attempting to add traced functions to the list...",       [this, data]() { bonus_traced_functions(data); } },
+	};
+
+	for(const auto &step : analysis_steps) {
+		qDebug("[Analyzer] %s", step.message);
+		step.function();
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: publish_partial
+// Desc: stores the functions found so far, so they can be shown before the
+//       analysis is done. Without a digest the next analysis won't mistake it for
+//       a finished one
+//------------------------------------------------------------------------------
+void Analyzer::publish_partial(const RegionData *data, const FunctionMap &functions) {
+
+	RegionData partial;
+	partial.functions = functions;
+	build_index(&partial);
+
+	{
+		QMutexLocker locker(&analysis_mutex_);
+		if(cancelled(data)) {
+			return;
+		}
+
+		RegionData &info = analysis_info_[data->region->start()];
+		info.region     = data->region;
+		info.fuzzy      = data->fuzzy;
+		info.generation = data->generation;
+		info.functions  = functions;
+		info.digest     = 0;
+		qSwap(info.index, partial.index);
+	}
+
+	Q_EMIT analysis_updated();
+}
+
+//------------------------------------------------------------------------------
+// Name: analyze_region
+// Desc: the expensive part of the analysis. It only works on the copy made by
+//       prepare_region, so it is safe to run on any thread
+//------------------------------------------------------------------------------
+void Analyzer::analyze_region(RegionData *data, bool report_progress) {
+
+	Q_ASSERT(data);
+
+	const struct {
+		const char             *message;
+		std::function<void()> function;
+	} analysis_steps[] = {
+		{ "discarding the analysis of changed pages...",             [this, data]() { discard_dirty_analysis(data);  } },
+		{ "attempting to collect functions with fuzzy analysis...",  [this, data]() { collect_fuzzy_functions(data); } },
+		{ "matching library function signatures...",                 [this, data]() { match_signatures(data);        } },
+		{ "collecting basic blocks...",                              [this, data]() { collect_functions(data);       } },
+		{ "determining function types...",                           [this, data]() { set_function_types(data);      } },
+	};
+
+	const int total_steps = sizeof(analysis_steps) / sizeof(analysis_steps[0]);
+
+	if(load_analysis(data)) {
+		qDebug("[Analyzer] using the cached analysis of %s", qPrintable(data->region->name()));
+		match_signatures(data);
+		if(report_progress) {
+			Q_EMIT update_progress(100);
+		}
+		return;
+	}
+
+	for(int i = 0; i < total_steps; ++i) {
+		if(cancelled(data)) {
+			qDebug("[Analyzer] analysis of %s superseded", qPrintable(data->region->name()));
+			return;
+		}
+
+		qDebug("[Analyzer] %s", analysis_steps[i].message);
+		analysis_steps[i].function();
+		if(report_progress) {
+			Q_EMIT update_progress(util::percentage(i + 1, total_steps));
+		}
+	}
+
+	if(!cancelled(data)) {
+		save_analysis(data);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: store_analysis
+// Desc: publishes a finished analysis, may be called from any thread. The
+//       results of a cancelled run are dropped, they may be incomplete
+//------------------------------------------------------------------------------
+void Analyzer::store_analysis(const RegionData &data) {
+
+	// the copy of the region is only needed while analyzing it, the next
+	// analysis reads the region again and compares the page hashes
+	RegionData stored = data;
+	stored.memory = QVector<quint8>();
+	build_index(&stored);
+	stored.footprint = footprint(&stored);
+
+	{
+		QMutexLocker locker(&analysis_mutex_);
+		if(cancelled(&data)) {
+			return;
+		}
+		analysis_info_[data.region->start()] = stored;
+	}
+
+	// may be a worker thread, the widget gets it queued
+	Q_EMIT analysis_changed();
+}
+
+//------------------------------------------------------------------------------
+// Name: build_index
+// Desc: FunctionMap is a QMap, so walking it already gives address order. The
+//       references the blocks noted are turned around, target to sites, so
+//       that finding what refers to an address is a single lookup
+//------------------------------------------------------------------------------
+void Analyzer::build_index(RegionData *data) const {
+
+	Q_ASSERT(data);
+
+	FunctionIndex index;
+	index.entries.reserve(data->functions.size());
+	index.ends.reserve(data->functions.size());
+	index.reference_counts.reserve(data->functions.size());
+	index.types.reserve(data->functions.size());
+
+	for(auto it = data->functions.begin(); it != data->functions.end(); ++it) {
+		index.entries.push_back(it.key());
+		index.ends.push_back(it->end_address());
+		index.reference_counts.push_back(it->reference_count());
+		index.types.push_back(it->type());
+	}
+
+	QHash<edb::address_t, QVector<edb::address_t>> xrefs;
+	QVector<QPair<edb::address_t, edb::address_t>> xref_targets;
+	for(const BasicBlock &block : data->basic_blocks) {
+		for(const QPair<edb::address_t, edb::address_t> &ref : block.refs()) {
+			xrefs[ref.second].push_back(ref.first);
+			xref_targets.push_back(qMakePair(ref.second, ref.first));
+		}
+	}
+
+	for(QVector<edb::address_t> &sites : xrefs) {
+		std::sort(sites.begin(), sites.end());
+	}
+
+	std::sort(xref_targets.begin(), xref_targets.end());
+
+	qSwap(data->index, index);
+	qSwap(data->xrefs, xrefs);
+	qSwap(data->xref_targets, xref_targets);
+}
+
+//------------------------------------------------------------------------------
+// Name: build_call_graph
+// Desc: the calls are the references made by call instructions, each one a
+//       single edge from the function it is in however often it is made
+//------------------------------------------------------------------------------
+void Analyzer::build_call_graph(RegionData *data) const {
+
+	Q_ASSERT(data);
+
+	QVector<QPair<edb::address_t, edb::address_t>> calls;
+	for(auto it = data->functions.begin(); it != data->functions.end(); ++it) {
+		for(const BasicBlock &block : it.value()) {
+			const QVector<QPair<edb::address_t, edb::address_t>> refs = block.refs();
+			if(refs.isEmpty()) {
+				continue;
+			}
+
+			for(const instruction_pointer &inst : block) {
+				if(is_call(*inst)) {
+					for(const QPair<edb::address_t, edb::address_t> &ref : refs) {
+						if(ref.first == inst->rva()) {
+							calls.push_back(qMakePair(it.key(), ref.second));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	data->calls = make_call_graph(calls);
+}
+
+//------------------------------------------------------------------------------
+// Name: footprint
+// Desc: estimates how much memory the analysis of a region holds on to. The
+//       decoded instructions of the blocks are most of it, the functions share
+//       them
+//------------------------------------------------------------------------------
+quint64 Analyzer::footprint(const RegionData *data) const {
+
+	Q_ASSERT(data);
+
+	quint64 bytes = data->memory.size();
+	bytes += data->page_hashes.size() * sizeof(quint64);
+	bytes += (data->known_functions.size() + data->fuzzy_functions.size()) * (sizeof(edb::address_t) + NODE_OVERHEAD);
+	bytes += data->function_types.size() * (sizeof(edb::address_t) + sizeof(Function::Type) + NODE_OVERHEAD);
+	bytes += data->library_functions.size() * (sizeof(edb::address_t) + sizeof(QString) + NODE_OVERHEAD);
+	bytes += data->index.entries.size() * (2 * sizeof(edb::address_t) + sizeof(int) + sizeof(Function::Type));
+
+	for(const QVector<edb::address_t> &sites : data->xrefs) {
+		bytes += sizeof(edb::address_t) + sizeof(QVector<edb::address_t>) + NODE_OVERHEAD;
+		bytes += sites.size() * sizeof(edb::address_t);
+	}
+	bytes += data->xref_targets.size() * sizeof(QPair<edb::address_t, edb::address_t>);
+
+	const CallGraph &calls = data->calls;
+	bytes += (calls.callees.keys.size() + calls.callees.edges.size() + calls.callers.keys.size() + calls.callers.edges.size()) * sizeof(edb::address_t);
+	bytes += (calls.callees.offsets.size() + calls.callers.offsets.size()) * sizeof(int);
+
+	for(const BasicBlock &block : data->basic_blocks) {
+		bytes += sizeof(BasicBlock) + NODE_OVERHEAD;
+		bytes += block.size() * (sizeof(instruction_pointer) + sizeof(edb::Instruction) + NODE_OVERHEAD);
+		bytes += block.refs().size() * sizeof(QPair<edb::address_t, edb::address_t>);
+	}
+
+	for(const Function &function : data->functions) {
+		bytes += sizeof(Function) + NODE_OVERHEAD;
+		bytes += function.size() * (sizeof(BasicBlock) + NODE_OVERHEAD);
+	}
+
+	return bytes;
+}
+
+//------------------------------------------------------------------------------
+// Name: memory_report
+// Desc: what the analysis data of each region takes, for the widget to show
+//------------------------------------------------------------------------------
+QString Analyzer::memory_report() const {
+
+	QMutexLocker locker(&analysis_mutex_);
+
+	QStringList lines;
+	quint64     total = 0;
+
+	for(const RegionData &data : analysis_info_) {
+		if(data.region && !data.functions.isEmpty()) {
+			lines << tr("%1: %2 functions, %3 blocks, %4").arg(
+				data.region->name().split(QDir::separator()).last(),
+				QString::number(data.functions.size()),
+				QString::number(data.basic_blocks.size()),
+				size_to_string(data.footprint));
+			total += data.footprint;
+		}
+	}
+
+	lines.sort();
+	lines.prepend(tr("Analysis data: %1").arg(size_to_string(total)));
+	return lines.join("\n");
+}
+
+//------------------------------------------------------------------------------
+// Name: analyze
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::analyze(const std::shared_ptr<IRegion> &region) {
+
+	QTime t;
+	t.start();
+
+	Q_EMIT update_progress(0);
+
+	// the caller wants the results now, so this supersedes a background run
+	cancel_analysis();
+
+	RegionData region_data;
+	if(prepare_region(region, &region_data)) {
+		analyze_region(&region_data, true);
+		store_analysis(region_data);
+		name_library_functions();
+
+		qDebug("[Analyzer] complete");
+		Q_EMIT update_progress(100);
+
+		if(analyzer_widget_) {
+			analyzer_widget_->set_memory_report(memory_report());
+			analyzer_widget_->update();
+		}
 	}
 
-	qDebug("[Analyzer] elapsed: %d ms", t.elapsed());
+	const CapstoneEDB::DecodeCacheStats stats = CapstoneEDB::decode_cache_stats();
+	qDebug("[Analyzer] elapsed: %d ms, decode cache %llu hits, %llu misses", t.elapsed(), static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses));
 }
 
 //------------------------------------------------------------------------------
@@ -719,11 +1735,12 @@ void Analyzer::analyze(const std::shared_ptr<IRegion> &region) {
 //------------------------------------------------------------------------------
 IAnalyzer::AddressCategory Analyzer::category(edb::address_t address) const {
 
-	Function func;
-	if(find_containing_function(address, &func)) {
-		if(address == func.entry_address()) {
+	edb::address_t entry;
+	edb::address_t end;
+	if(find_containing_entry(address, &entry, &end)) {
+		if(address == entry) {
 			return ADDRESS_FUNC_START;
-		} else if(address == func.end_address()) {
+		} else if(address == end) {
 			return ADDRESS_FUNC_END;
 		} else {
 			return ADDRESS_FUNC_BODY;
@@ -737,7 +1754,131 @@ IAnalyzer::AddressCategory Analyzer::category(edb::address_t address) const {
 // Desc:
 //------------------------------------------------------------------------------
 IAnalyzer::FunctionMap Analyzer::functions(const std::shared_ptr<IRegion> &region) const {
-	return analysis_info_[region->start()].functions;
+	QMutexLocker locker(&analysis_mutex_);
+	return analysis_info_.value(region->start()).functions;
+}
+
+//------------------------------------------------------------------------------
+// Name: references
+// Desc: the sites in the analyzed code of every region which refer to
+//       <address>, in address order
+//------------------------------------------------------------------------------
+QVector<edb::address_t> Analyzer::references(edb::address_t address) const {
+	QMutexLocker locker(&analysis_mutex_);
+
+	QVector<edb::address_t> results;
+	for(const RegionData &data : analysis_info_) {
+		auto it = data.xrefs.find(address);
+		if(it != data.xrefs.end()) {
+			results += *it;
+		}
+	}
+
+	std::sort(results.begin(), results.end());
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: references
+// Desc: the sites referring to anything in [first, last], each one once
+//------------------------------------------------------------------------------
+QVector<edb::address_t> Analyzer::references(edb::address_t first, edb::address_t last) const {
+
+	QVector<edb::address_t> results;
+	for(const QPair<edb::address_t, edb::address_t> &ref : references_into(first, last)) {
+		results.push_back(ref.first);
+	}
+
+	std::sort(results.begin(), results.end());
+	results.erase(std::unique(results.begin(), results.end()), results.end());
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: references_into
+// Desc: each region's references are sorted by target, so this only visits
+//       those in [first, last]
+//------------------------------------------------------------------------------
+QVector<QPair<edb::address_t, edb::address_t>> Analyzer::references_into(edb::address_t first, edb::address_t last) const {
+	QMutexLocker locker(&analysis_mutex_);
+
+	QVector<QPair<edb::address_t, edb::address_t>> results;
+	for(const RegionData &data : analysis_info_) {
+		const QVector<QPair<edb::address_t, edb::address_t>> &targets = data.xref_targets;
+
+		auto it = std::lower_bound(targets.begin(), targets.end(), qMakePair(first, edb::address_t(0)));
+		for(; it != targets.end() && it->first <= last; ++it) {
+			results.push_back(qMakePair(it->second, it->first));
+		}
+	}
+
+	std::sort(results.begin(), results.end(), [](const QPair<edb::address_t, edb::address_t> &a, const QPair<edb::address_t, edb::address_t> &b) {
+		return a.second < b.second;
+	});
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: analyzed
+// Desc: true if <region> has a complete analysis. A partial one, from a run
+//       which is still going, has no digest yet
+//------------------------------------------------------------------------------
+bool Analyzer::analyzed(const std::shared_ptr<IRegion> &region) const {
+	QMutexLocker locker(&analysis_mutex_);
+
+	auto it = analysis_info_.find(region->start());
+	return it != analysis_info_.end() && it->digest != 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: function_index
+// Desc:
+//------------------------------------------------------------------------------
+IAnalyzer::FunctionIndex Analyzer::function_index(const std::shared_ptr<IRegion> &region) const {
+	QMutexLocker locker(&analysis_mutex_);
+	return analysis_info_.value(region->start()).index;
+}
+
+//------------------------------------------------------------------------------
+// Name: callers
+// Desc: a function may be called from any region, so each one's callers of
+//       <entry> are looked up
+//------------------------------------------------------------------------------
+QVector<edb::address_t> Analyzer::callers(edb::address_t entry) const {
+	QMutexLocker locker(&analysis_mutex_);
+
+	QVector<edb::address_t> results;
+	for(const RegionData &data : analysis_info_) {
+		results += data.calls.callers.find(entry);
+	}
+
+	std::sort(results.begin(), results.end());
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: callees
+// Desc:
+//------------------------------------------------------------------------------
+QVector<edb::address_t> Analyzer::callees(edb::address_t entry) const {
+	QMutexLocker locker(&analysis_mutex_);
+
+	for(const RegionData &data : analysis_info_) {
+		if(data.region && data.region->contains(entry)) {
+			return data.calls.callees.find(entry);
+		}
+	}
+
+	return QVector<edb::address_t>();
+}
+
+//------------------------------------------------------------------------------
+// Name: call_graph
+// Desc:
+//------------------------------------------------------------------------------
+IAnalyzer::CallGraph Analyzer::call_graph(const std::shared_ptr<IRegion> &region) const {
+	QMutexLocker locker(&analysis_mutex_);
+	return analysis_info_.value(region->start()).calls;
 }
 
 //------------------------------------------------------------------------------
@@ -745,6 +1886,8 @@ IAnalyzer::FunctionMap Analyzer::functions(const std::shared_ptr<IRegion> &regio
 // Desc:
 //------------------------------------------------------------------------------
 IAnalyzer::FunctionMap Analyzer::functions() const {
+	QMutexLocker locker(&analysis_mutex_);
+
 	FunctionMap results;
 	for(auto &it : analysis_info_) {
 		results.unite(it.functions);
@@ -760,30 +1903,53 @@ bool Analyzer::find_containing_function(edb::address_t address, Function *functi
 
 	Q_ASSERT(function);
 
+	edb::address_t entry;
+	edb::address_t end;
+	if(find_containing_entry(address, &entry, &end)) {
+		if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(address)) {
+			QMutexLocker locker(&analysis_mutex_);
+			auto data = analysis_info_.find(region->start());
+			if(data != analysis_info_.end()) {
+				auto it = data->functions.find(entry);
+				if(it != data->functions.end()) {
+					*function = *it;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_containing_entry
+// Desc: finds the entry and the end of the function containing <address>,
+//       that is the last one starting at or before it, if it reaches that far
+//------------------------------------------------------------------------------
+bool Analyzer::find_containing_entry(edb::address_t address, edb::address_t *entry, edb::address_t *end) const {
+
+	Q_ASSERT(entry);
+	Q_ASSERT(end);
+
 	if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(address)) {
-		const FunctionMap &funcs = functions(region);
+		QMutexLocker locker(&analysis_mutex_);
 
-		// upperBound returns the first item that is >= address here, or end().
-		// Note the ">", it does not do the opposite of lowerBound!
-		auto iter = funcs.upperBound(address);
-		if (iter == funcs.end()) {
+		auto it = analysis_info_.find(region->start());
+		if(it == analysis_info_.end()) {
 			return false;
 		}
 
-		// handle address == entrypoint case
-		if ((*iter).entry_address() == address) {
-			*function = *iter;
-			return true;
-		}
+		const FunctionIndex &index = it->index;
 
-		// go to previous function and test it
-		if (iter == funcs.begin()) {
+		const auto first = std::upper_bound(index.entries.begin(), index.entries.end(), address);
+		if(first == index.entries.begin()) {
 			return false;
 		}
 
-		const Function& func = *(--iter);
-		if (address >= func.entry_address() && address <= func.end_address()) {
-			*function = func;
+		const int n = static_cast<int>(first - index.entries.begin()) - 1;
+		if(address <= index.ends[n]) {
+			*entry = index.entries[n];
+			*end   = index.ends[n];
 			return true;
 		}
 	}
@@ -800,25 +1966,35 @@ bool Analyzer::find_containing_function(edb::address_t address, Function *functi
 //------------------------------------------------------------------------------
 bool Analyzer::for_funcs_in_range(const edb::address_t start, const edb::address_t end, std::function<bool(const Function*)> functor) const {
 	if (std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(start)) {
-		const FunctionMap &funcs = functions(region);
-		auto it = funcs.lowerBound(start - 4096);
 
-		while (it != funcs.end()) {
-			auto f_start = it->entry_address();
-			auto f_end = it->end_address();
+		FunctionMap   funcs;
+		FunctionIndex index;
+		{
+			QMutexLocker locker(&analysis_mutex_);
+			auto it = analysis_info_.find(region->start());
+			if(it == analysis_info_.end()) {
+				return true;
+			}
+			funcs = it->functions;
+			index = it->index;
+		}
+
+		// only the functions which overlap the range come out of the map, the
+		// rest are skipped over in the index
+		for(auto it = std::lower_bound(index.entries.begin(), index.entries.end(), start - 4096); it != index.entries.end(); ++it) {
+			const edb::address_t f_start = *it;
+			const edb::address_t f_end   = index.ends[static_cast<int>(it - index.entries.begin())];
 
-			// Only works if FunctionMap is a QMap
 			if (f_start > end) {
 				return true;
 			}
 			// ranges overlap: http://stackoverflow.com/a/3269471
 			if (f_start <= end && start <= f_end) {
-				if (!functor(&(*it))) {
+				auto func = funcs.find(f_start);
+				if (func != funcs.end() && !functor(&(*func))) {
 					return false;
 				}
 			}
-
-			++it;
 		}
 	}
 	return true;
@@ -859,6 +2035,11 @@ void Analyzer::invalidate_analysis(const std::shared_ptr<IRegion> &region) {
 			specified_functions_.remove(addr);
 		}
 	}
+	Q_FOREACH(const edb::address_t addr, traced_functions_) {
+		if(addr >= region->start() && addr < region->end()) {
+			traced_functions_.remove(addr);
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -867,11 +2048,16 @@ void Analyzer::invalidate_analysis(const std::shared_ptr<IRegion> &region) {
 //------------------------------------------------------------------------------
 void Analyzer::invalidate_dynamic_analysis(const std::shared_ptr<IRegion> &region) {
 
+	// a run which is still working on the region would bring back
+	// what this throws away
+	cancel_analysis();
+
 	RegionData info;
-	info.region = region;
-	info.fuzzy  = false;
+	info.region     = region;
+	info.fuzzy      = false;
+	info.generation = generation_.load();
 
-	analysis_info_[region->start()] = info;
+	store_analysis(info);
 }
 
 //------------------------------------------------------------------------------
@@ -879,8 +2065,24 @@ void Analyzer::invalidate_dynamic_analysis(const std::shared_ptr<IRegion> &regio
 // Desc:
 //------------------------------------------------------------------------------
 void Analyzer::invalidate_analysis() {
-	analysis_info_.clear();
+	cancel_analysis();
+	{
+		QMutexLocker locker(&analysis_mutex_);
+
+		// restarting maps the same modules again, usually at the same
+		// addresses, what was finished for them is kept for when they are
+		retained_analysis_.clear();
+		for(auto it = analysis_info_.begin(); it != analysis_info_.end(); ++it) {
+			if(it->digest != 0 && it->region && !it->region->name().isEmpty()) {
+				retained_analysis_.insert(it.key(), it.value());
+			}
+		}
+
+		analysis_info_.clear();
+	}
 	specified_functions_.clear();
+	traced_functions_.clear();
+	Q_EMIT analysis_changed();
 }
 
 //------------------------------------------------------------------------------
@@ -901,80 +2103,296 @@ Result<edb::address_t> Analyzer::find_containing_function(edb::address_t address
 // Name: will_return
 // Desc:
 //------------------------------------------------------------------------------
-bool Analyzer::will_return(edb::address_t address) const {
+bool Analyzer::will_return(const RegionData *data, edb::address_t address) const {
+	Q_ASSERT(data);
+	return !data->noreturn_functions.contains(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: save_analysis
+// Desc: writes the results for <data> to its cache file, so later sessions can
+//       skip the analysis of an unchanged region
+//------------------------------------------------------------------------------
+void Analyzer::save_analysis(const RegionData *data) const {
 
-	const std::shared_ptr<Symbol> symbol = edb::v1::symbol_manager().find(address);
-	if(symbol) {
-		const QString symname = symbol->name_no_prefix;
-		const QString func_name = symname.mid(0, symname.indexOf("@"));
-		
-		if(const edb::Prototype *const info = edb::v1::get_function_info(func_name)) {
-			if(info->noreturn) {
-				return false;
-			}
+	Q_ASSERT(data);
+
+	if(data->cache_path.isEmpty() || data->digest == 0) {
+		return;
+	}
+
+	const quint64 start = data->region->start().toUint();
+
+	QByteArray out;
+	out.append(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	put<quint32>(out, CACHE_VERSION);
+	put<quint32>(out, data->fuzzy);
+	put<quint64>(out, data->digest);
+	put<quint64>(out, data->region->size().toUint());
+
+	put<quint32>(out, data->known_functions.size());
+	for(const edb::address_t address : data->known_functions) {
+		put<quint64>(out, address.toUint() - start);
+	}
+
+	put<quint32>(out, data->fuzzy_functions.size());
+	for(const edb::address_t address : data->fuzzy_functions) {
+		put<quint64>(out, address.toUint() - start);
+	}
+
+	// only the extent of each block is kept, the instructions are decoded again
+	// from the region when it is loaded
+	put<quint32>(out, data->basic_blocks.size());
+	for(auto it = data->basic_blocks.begin(); it != data->basic_blocks.end(); ++it) {
+		const QVector<QPair<edb::address_t, edb::address_t>> refs = it.value().refs();
+
+		put<quint64>(out, it.key().toUint() - start);
+		put<quint32>(out, it.value().byteSize());
+		put<quint32>(out, refs.size());
+		for(const QPair<edb::address_t, edb::address_t> &ref : refs) {
+			put<quint64>(out, ref.first.toUint() - start);
+			put<quint64>(out, ref.second.toUint() - start);
 		}
 	}
 
+	put<quint32>(out, data->functions.size());
+	for(const Function &function : data->functions) {
+		put<quint64>(out, function.entry_address().toUint() - start);
+		put<quint32>(out, function.type());
+		put<quint32>(out, function.reference_count());
+		put<quint32>(out, function.size());
+		for(const BasicBlock &block : function) {
+			put<quint64>(out, block.firstAddress().toUint() - start);
+		}
+	}
 
-	return true;
+	// only the callees are kept, the callers are the same edges turned round
+	const IAnalyzer::Adjacency &callees = data->calls.callees;
+	put<quint32>(out, callees.keys.size());
+	for(int i = 0; i < callees.keys.size(); ++i) {
+		put<quint64>(out, callees.keys[i].toUint() - start);
+		put<quint32>(out, callees.offsets[i + 1] - callees.offsets[i]);
+		for(int j = callees.offsets[i]; j != callees.offsets[i + 1]; ++j) {
+			put<quint64>(out, callees.edges[j].toUint() - start);
+		}
+	}
+
+	QFile file(data->cache_path);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(out) != out.size()) {
+		qDebug("[Analyzer] unable to write the analysis cache %s", qPrintable(data->cache_path));
+		file.remove();
+	}
 }
 
 //------------------------------------------------------------------------------
-// Name: get_analysis_path
-// Desc:
+// Name: load_analysis
+// Desc: fills in <data> from its cache file, if there is one for exactly these
+//       bytes. Returns false if the region has to be analyzed after all
 //------------------------------------------------------------------------------
+bool Analyzer::load_analysis(RegionData *data) const {
 
-QString Analyzer::get_analysis_path(const std::shared_ptr<IRegion> &region) const {
-	if (region->name().isEmpty()) {
-		return QString();
+	Q_ASSERT(data);
+
+	if(data->cache_path.isEmpty() || data->digest == 0) {
+		return false;
 	}
 
-	QString session_path = edb::v1::config().session_path;
-	if(session_path.isEmpty()) {
-		return QString();
+	QFile file(data->cache_path);
+	if(!file.open(QIODevice::ReadOnly)) {
+		return false;
 	}
 
-	// We need the base address of this region. However, this region might not
-	// be the same region that has the header. For instance, on Windows the
-	// PE header is not in the same region as the ELF header. The binary might
-	// also have multiple code sections.
-	edb::address_t base_address = 0;
-	edb::address_t loaded_address = 0;
-	{
-		QList<std::shared_ptr<IRegion>> regions = edb::v1::memory_regions().regions();
-		bool base_addr_found = false;
-		for(const std::shared_ptr<IRegion> &iregion: regions) {
-			if (iregion->name() == region->name()) {
-				if(auto binary_info = edb::v1::get_binary_info(iregion)) {
-					base_address = binary_info->base_address();
-					loaded_address = iregion->start();
-					base_addr_found = true;
-					break;
-				}
+	const uchar *const map = file.map(0, file.size());
+	if(!map) {
+		return false;
+	}
+
+	CacheReader reader(map, file.size());
+
+	char    magic[sizeof(CACHE_MAGIC)];
+	quint64 digest;
+	quint32 version;
+	quint32 fuzzy;
+	quint64 region_size;
+
+	if(!reader.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+		return false;
+	}
+
+	if(!reader.get(&version) || version != CACHE_VERSION) {
+		return false;
+	}
+
+	if(!reader.get(&fuzzy) || !reader.get(&digest) || !reader.get(&region_size)) {
+		return false;
+	}
+
+	if(static_cast<bool>(fuzzy) != data->fuzzy || digest != data->digest || region_size != data->region->size().toUint()) {
+		return false;
+	}
+
+	const edb::address_t start = data->region->start();
+
+	auto read_addresses = [&reader, start](QSet<edb::address_t> *addresses) {
+		quint32 count;
+		if(!reader.get(&count)) {
+			return false;
+		}
+
+		for(quint32 i = 0; i < count; ++i) {
+			quint64 rva;
+			if(!reader.get(&rva)) {
+				return false;
+			}
+			addresses->insert(start + edb::address_t::fromZeroExtended(rva));
+		}
+		return true;
+	};
+
+	QSet<edb::address_t>              known_functions;
+	QSet<edb::address_t>              fuzzy_functions;
+	QHash<edb::address_t, BasicBlock> basic_blocks;
+	FunctionMap                       functions;
+
+	if(!read_addresses(&known_functions) || !read_addresses(&fuzzy_functions)) {
+		return false;
+	}
+
+	// functions marked or traced since the cache was written would be missed
+	Q_FOREACH(const edb::address_t address, data->known_functions) {
+		if(!known_functions.contains(address)) {
+			return false;
+		}
+	}
+
+	quint32 block_count;
+	if(!reader.get(&block_count)) {
+		return false;
+	}
+
+	for(quint32 i = 0; i < block_count; ++i) {
+		quint64 rva;
+		quint32 byte_size;
+		quint32 ref_count;
+		if(!reader.get(&rva) || !reader.get(&byte_size) || !reader.get(&ref_count)) {
+			return false;
+		}
+
+		const edb::address_t block_address = start + edb::address_t::fromZeroExtended(rva);
+		const edb::address_t last          = block_address + byte_size;
+
+		BasicBlock block;
+		for(edb::address_t address = block_address; address != last;) {
+
+			quint8 buffer[edb::Instruction::MAX_SIZE];
+			const int buf_size = instruction_bytes(data, address, buffer);
+			if(buf_size == 0) {
+				return false;
 			}
+
+			auto inst = edb::decode(buffer, buffer + buf_size, address);
+			if(!inst->valid() || address + inst->byte_size() > last) {
+				return false;
+			}
+
+			block.push_back(inst);
+			address += inst->byte_size();
 		}
 
-		if (!base_addr_found) {
-			return QString();
+		for(quint32 j = 0; j < ref_count; ++j) {
+			quint64 site;
+			quint64 target;
+			if(!reader.get(&site) || !reader.get(&target)) {
+				return false;
+			}
+			block.addRef(start + edb::address_t::fromZeroExtended(site), start + edb::address_t::fromZeroExtended(target));
 		}
+
+		basic_blocks.insert(block_address, block);
+	}
+
+	quint32 function_count;
+	if(!reader.get(&function_count)) {
+		return false;
 	}
 
-	QFileInfo info(region->name());
+	for(quint32 i = 0; i < function_count; ++i) {
+		quint64 entry;
+		quint32 type;
+		quint32 reference_count;
+		quint32 function_blocks;
+		if(!reader.get(&entry) || !reader.get(&type) || !reader.get(&reference_count) || !reader.get(&function_blocks)) {
+			return false;
+		}
 
-	if(info.isRelative()) {
-		info.makeAbsolute();
+		Function function;
+		for(quint32 j = 0; j < function_blocks; ++j) {
+			quint64 rva;
+			if(!reader.get(&rva)) {
+				return false;
+			}
+
+			auto it = basic_blocks.find(start + edb::address_t::fromZeroExtended(rva));
+			if(it == basic_blocks.end()) {
+				return false;
+			}
+			function.insert(it.value());
+		}
+
+		function.set_type(type == Function::FUNCTION_THUNK ? Function::FUNCTION_THUNK : Function::FUNCTION_STANDARD);
+		for(quint32 j = 0; j < reference_count; ++j) {
+			function.add_reference();
+		}
+
+		functions.insert(start + edb::address_t::fromZeroExtended(entry), function);
+	}
+
+	quint32 caller_count;
+	if(!reader.get(&caller_count)) {
+		return false;
+	}
+
+	QVector<QPair<edb::address_t, edb::address_t>> calls;
+	for(quint32 i = 0; i < caller_count; ++i) {
+		quint64 entry;
+		quint32 callee_count;
+		if(!reader.get(&entry) || !reader.get(&callee_count)) {
+			return false;
+		}
+
+		for(quint32 j = 0; j < callee_count; ++j) {
+			quint64 target;
+			if(!reader.get(&target)) {
+				return false;
+			}
+			calls.push_back(qMakePair(start + edb::address_t::fromZeroExtended(entry), start + edb::address_t::fromZeroExtended(target)));
+		}
+	}
+
+	if(!reader.at_end()) {
+		return false;
 	}
 
-	auto path          = tr("%1/%2").arg(session_path, info.absolutePath());
-	const QString name = info.fileName();
+	data->function_types.clear();
+	for(auto it = functions.begin(); it != functions.end(); ++it) {
+		data->function_types.insert(it.key(), it->type());
+	}
+
+	qSwap(data->known_functions, known_functions);
+	qSwap(data->fuzzy_functions, fuzzy_functions);
+	qSwap(data->basic_blocks, basic_blocks);
+	qSwap(data->functions, functions);
+	data->calls = make_call_graph(calls);
+	return true;
+}
 
-	// ensure that the sub-directory exists
-	QDir().mkpath(path);
+//------------------------------------------------------------------------------
+// Name: get_analysis_path
+// Desc:
+//------------------------------------------------------------------------------
 
-	return tr("%1/%2.Analysis.%3").arg(
-		path,
-		name,
-		QString::number(region->start() - loaded_address + base_address, 16));
+QString Analyzer::get_analysis_path(const std::shared_ptr<IRegion> &region) const {
+	return edb::v1::module_cache_path(region, "Analysis");
 }
 
 #if QT_VERSION < 0x050000
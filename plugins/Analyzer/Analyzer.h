@@ -25,13 +25,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Symbol.h"
 #include "Types.h"
 #include "BasicBlock.h"
+#include "SignatureDatabase.h"
 #include <QSet>
 #include <QMap>
 #include <QHash>
 #include <QVector>
 #include <QList>
+#include <QMutex>
+#include <atomic>
+#include <memory>
 
 class QMenu;
+template <class T>
+class QFutureWatcher;
 
 namespace AnalyzerPlugin {
 
@@ -71,35 +77,74 @@ public:
 	virtual void invalidate_analysis();
 	virtual void invalidate_analysis(const std::shared_ptr<IRegion> &region);
 	virtual bool for_funcs_in_range(const edb::address_t start, const edb::address_t end, std::function<bool(const Function*)> functor) const;
+	virtual void add_traced_functions(const QSet<edb::address_t> &entries);
+	virtual QVector<edb::address_t> references(edb::address_t address) const;
+	virtual QVector<edb::address_t> references(edb::address_t first, edb::address_t last) const;
+	virtual bool analyzed(const std::shared_ptr<IRegion> &region) const;
+	virtual QVector<QPair<edb::address_t, edb::address_t>> references_into(edb::address_t first, edb::address_t last) const;
+	virtual FunctionIndex function_index(const std::shared_ptr<IRegion> &region) const;
+	virtual QVector<edb::address_t> callers(edb::address_t entry) const;
+	virtual QVector<edb::address_t> callees(edb::address_t entry) const;
+	virtual CallGraph call_graph(const std::shared_ptr<IRegion> &region) const;
 
 private:
 	bool find_containing_function(edb::address_t address, Function *function) const;
-	bool is_thunk(edb::address_t address) const;
-	bool will_return(edb::address_t address) const;
+	bool find_containing_entry(edb::address_t address, edb::address_t *entry, edb::address_t *end) const;
+	void build_index(RegionData *data) const;
+	void build_call_graph(RegionData *data) const;
+	quint64 footprint(const RegionData *data) const;
+	QString memory_report() const;
+	bool is_thunk(const RegionData *data, edb::address_t address) const;
+	bool will_return(const RegionData *data, edb::address_t address) const;
+	int instruction_bytes(const RegionData *data, edb::address_t address, quint8 *buf) const;
+	bool prepare_region(const std::shared_ptr<IRegion> &region, RegionData *data);
+	void analyze_region(RegionData *data, bool report_progress);
+	void store_analysis(const RegionData &data);
+	void publish_partial(const RegionData *data, const FunctionMap &functions);
+	bool cancelled(const RegionData *data) const;
+	bool load_analysis(RegionData *data) const;
+	void save_analysis(const RegionData *data) const;
+	void start_analysis(const QList<std::shared_ptr<IRegion>> &regions);
 	void bonus_entry_point(RegionData *data) const;
 	void bonus_main(RegionData *data) const;
 	void bonus_marked_functions(RegionData *data);
 	void bonus_symbols(RegionData *data);
+	void bonus_traced_functions(RegionData *data);
 	void collect_functions(RegionData *data);
 	void collect_fuzzy_functions(RegionData *data);
+	void match_signatures(RegionData *data) const;
+	void name_library_functions();
+	std::shared_ptr<const SignatureDatabase> signature_database();
+	void count_fuzzy_calls(const RegionData *data, edb::address_t first, edb::address_t last, QHash<edb::address_t, int> *counts) const;
+	void discard_dirty_analysis(RegionData *data);
+	bool is_dirty(const RegionData *data, edb::address_t first, edb::address_t last) const;
 	void do_analysis(const std::shared_ptr<IRegion> &region);
 	void ident_header(Analyzer::RegionData *data);
 	void invalidate_dynamic_analysis(const std::shared_ptr<IRegion> &region);
-	void set_function_types(FunctionMap *results);
-	void set_function_types_helper(Function &function) const;
+	void set_function_types(RegionData *data);
+	void set_function_types_helper(const RegionData *data, Function &function) const;
 	QString get_analysis_path(const std::shared_ptr<IRegion> &region) const;
 
 Q_SIGNALS:
 	void update_progress(int);
+	void analysis_updated();
+	void analysis_changed(); // a region's stored analysis was replaced or dropped
 
 public Q_SLOTS:
 	void do_ip_analysis();
 	void do_view_analysis();
+	void do_module_analysis();
 	void goto_function_start();
 	void goto_function_end();
 	void mark_function_start();
 	void show_xrefs();
 	void show_specified();
+	void cancel_analysis();
+
+private Q_SLOTS:
+	void analysis_progress(int value);
+	void analysis_finished();
+	void update_views();
 
 private:
 	struct RegionData {
@@ -108,18 +153,55 @@ private:
 
 		FunctionMap                       functions;
 		QHash<edb::address_t, BasicBlock> basic_blocks;
+		FunctionIndex                     index;     // of functions, built when stored
+		QHash<edb::address_t, QVector<edb::address_t>> xrefs; // target to sites, built when stored
+		QVector<QPair<edb::address_t, edb::address_t>> xref_targets; // (target, site) in order, built when stored
+		CallGraph                         calls;     // between the functions, built by collect_functions
+		quint64                           footprint; // roughly what this takes, set when stored
 
-		QByteArray                        md5;
+		quint64                           digest = 0; // of the page hashes, 0 until the analysis is finished
 		bool                              fuzzy;
 		std::shared_ptr<IRegion>          region;
 
-		// a copy of the whole region
+		// a copy of the whole region, only while it is being analyzed
 		QVector<quint8>                   memory;
+
+		// the FastHash of each page, which the digest above is made of
+		QVector<quint64>                  page_hashes;
+
+		// the page runs which changed since the previous analysis, which the
+		// rest was carried over from. Empty means analyze everything
+		QVector<QPair<edb::address_t, edb::address_t>> dirty_ranges;
+
+		// the type of each function entry typed so far, carried over with the
+		// rest while the entry's bytes stay the same
+		QHash<edb::address_t, Function::Type> function_types;
+
+		// the symbols known not to return, taken when the analysis started
+		QSet<edb::address_t>              noreturn_functions;
+
+		// the signatures of library functions, and which of the function
+		// starts matched one. Calls out of those aren't followed
+		std::shared_ptr<const SignatureDatabase> signatures;
+		QHash<edb::address_t, QString>    library_functions;
+
+		// which run this belongs to, anything but the current one is stale
+		int                               generation;
+
+		// where the analysis is kept between sessions, empty if nowhere
+		QString                           cache_path;
 	};
 
 	QMenu                             *menu_;
-	QHash<edb::address_t, RegionData>  analysis_info_;
+	QHash<edb::address_t, RegionData>  analysis_info_; // guarded by analysis_mutex_
+	QHash<edb::address_t, RegionData>  retained_analysis_; // the previous process's, guarded by analysis_mutex_
+	mutable QMutex                     analysis_mutex_;
+	std::atomic<int>                   generation_;   // written under analysis_mutex_
+	QFutureWatcher<void>              *analysis_watcher_;
 	QSet<edb::address_t>               specified_functions_;
+	QSet<edb::address_t>               traced_functions_;
+	std::shared_ptr<const SignatureDatabase> signatures_;
+	QString                            signature_directory_; // what signatures_ was loaded from
 	AnalyzerWidget                    *analyzer_widget_;
 };
 
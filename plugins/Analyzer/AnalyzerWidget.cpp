@@ -25,10 +25,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IRegion.h"
 #include "Function.h"
 #include <QAbstractScrollArea>
+#include <QContextMenuEvent>
 #include <QDebug>
 #include <QFontMetrics>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QResizeEvent>
+#include <QMenu>
+#include <QMessageBox>
 #include <QScrollBar>
 #include <QDir>
 #include <QElapsedTimer>
@@ -38,7 +42,7 @@ namespace AnalyzerPlugin {
 //------------------------------------------------------------------------------
 // Name:
 //------------------------------------------------------------------------------
-AnalyzerWidget::AnalyzerWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), mouse_pressed_(false), cache_(nullptr) {
+AnalyzerWidget::AnalyzerWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), mouse_pressed_(false), cache_valid_(false), cache_has_functions_(false), cache_region_start_(0), cache_region_size_(0), progress_(-1) {
 
 	QFontMetrics fm(font());
 
@@ -73,18 +77,19 @@ void AnalyzerWidget::paintEvent(QPaintEvent *event) {
 		return;
 	}
 
-	const QSet<edb::address_t> specified_functions = edb::v1::analyzer()->specified_functions();
-	const IAnalyzer::FunctionMap functions = edb::v1::analyzer()->functions(region);
 	const auto byte_width = static_cast<float>(width()) / region->size();
 
-	if (!cache_ || width() != cache_->width() || height() != cache_->height() || cache_num_funcs_ != functions.size()) {
-		if (cache_) {
-			delete cache_;
-		}
-		cache_ = new QPixmap(width(), height());
-		cache_num_funcs_ = functions.size();
+	if(!cache_valid_ || cache_region_start_ != region->start() || cache_region_size_ != region->size() || cache_.size() != size()) {
+		const QSet<edb::address_t> specified_functions = edb::v1::analyzer()->specified_functions();
+		const IAnalyzer::FunctionMap functions         = edb::v1::analyzer()->functions(region);
+
+		cache_               = QPixmap(size());
+		cache_valid_         = true;
+		cache_has_functions_ = !functions.isEmpty();
+		cache_region_start_  = region->start();
+		cache_region_size_   = region->size();
 
-		QPainter painter(cache_);
+		QPainter painter(&cache_);
 		painter.fillRect(0, 0, width(), height(), QBrush(Qt::black));
 
 		for(auto it = functions.begin(); it != functions.end(); ++it) {
@@ -107,9 +112,9 @@ void AnalyzerWidget::paintEvent(QPaintEvent *event) {
 	}
 
 	QPainter painter(this);
-	painter.drawPixmap(0, 0, *cache_);
+	painter.drawPixmap(0, 0, cache_);
 
-	if(!functions.isEmpty()) {
+	if(cache_has_functions_) {
 		if(auto scroll_area = qobject_cast<QAbstractScrollArea*>(edb::v1::disassembly_widget())) {
 			if(QScrollBar *scrollbar = scroll_area->verticalScrollBar()) {
 				QFontMetrics fm(font());
@@ -129,7 +134,7 @@ void AnalyzerWidget::paintEvent(QPaintEvent *event) {
 			}
 		}
 	}
-	else {
+	else if(progress_ == -1) {
 		painter.setPen(QPen(Qt::white));
 		painter.drawText(rect(), Qt::AlignCenter,
 			QString("%1: %2").arg(
@@ -139,12 +144,71 @@ void AnalyzerWidget::paintEvent(QPaintEvent *event) {
 		);
 	}
 
+	if(progress_ != -1) {
+		painter.setPen(QPen(Qt::white));
+		painter.drawText(rect(), Qt::AlignRight | Qt::AlignVCenter, tr("Analyzing... %1%").arg(progress_));
+	}
+
 	const int renderTime = timer.elapsed();
 	if(renderTime > 8) {
 		qDebug() << "AnalyzerWidget: Painting took longer than desired: " << renderTime << "ms";
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: set_progress
+// Desc: how far the running analysis is, 100 or -1 once there is none
+//------------------------------------------------------------------------------
+void AnalyzerWidget::set_progress(int percent) {
+	progress_ = (percent >= 0 && percent < 100) ? percent : -1;
+	update();
+}
+
+//------------------------------------------------------------------------------
+// Name: set_memory_report
+// Desc: how much memory the analysis data takes, shown as the tooltip
+//------------------------------------------------------------------------------
+void AnalyzerWidget::set_memory_report(const QString &report) {
+	memory_report_ = report;
+	setToolTip(report);
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_cache
+// Desc: the stored analysis changed, the cached image is redrawn on the next
+//       paint
+//------------------------------------------------------------------------------
+void AnalyzerWidget::invalidate_cache() {
+	cache_valid_ = false;
+	update();
+}
+
+//------------------------------------------------------------------------------
+// Name: resizeEvent
+//------------------------------------------------------------------------------
+void AnalyzerWidget::resizeEvent(QResizeEvent *event) {
+	QWidget::resizeEvent(event);
+	cache_valid_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: contextMenuEvent
+//------------------------------------------------------------------------------
+void AnalyzerWidget::contextMenuEvent(QContextMenuEvent *event) {
+	QMenu menu;
+	QAction *const cancel = menu.addAction(tr("Cancel Analysis"));
+	QAction *const usage  = menu.addAction(tr("Analysis Memory Usage..."));
+	cancel->setEnabled(progress_ != -1);
+	usage->setEnabled(!memory_report_.isEmpty());
+
+	QAction *const chosen = menu.exec(event->globalPos());
+	if(chosen == cancel) {
+		Q_EMIT cancel_requested();
+	} else if(chosen == usage) {
+		QMessageBox::information(this, tr("Analysis Memory Usage"), memory_report_);
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name:
 //------------------------------------------------------------------------------
@@ -153,8 +217,10 @@ void AnalyzerWidget::mousePressEvent(QMouseEvent *event) {
 	mouse_pressed_ = true;
 
 	if(const std::shared_ptr<IRegion> region = edb::v1::current_cpu_view_region()) {
-		const IAnalyzer::FunctionMap functions = edb::v1::analyzer()->functions(region);
-		if(region->size() != 0 && !functions.empty()) {
+		// what was drawn is what can be clicked, a drag doesn't need to look
+		// the functions up again for every move
+		const bool drawn = cache_valid_ && cache_has_functions_ && cache_region_start_ == region->start();
+		if(region->size() != 0 && drawn) {
 			const auto byte_width = static_cast<float>(width()) / region->size();
 			const edb::address_t address = qBound<edb::address_t>(region->start(), region->start() + edb::address_t(event->x() / byte_width), region->end() - 1);
 			edb::v1::jump_to_address(address);
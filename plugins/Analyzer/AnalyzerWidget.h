@@ -16,6 +16,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "Types.h"
 #include <QWidget>
 #include <QPixmap>
 
@@ -26,16 +27,33 @@ class AnalyzerWidget : public QWidget {
 public:
 	AnalyzerWidget(QWidget *parent = 0, Qt::WindowFlags f = 0);
 
+public Q_SLOTS:
+	void set_progress(int percent);
+	void set_memory_report(const QString &report);
+	void invalidate_cache();
+
+Q_SIGNALS:
+	void cancel_requested();
+
 protected:
 	virtual void paintEvent(QPaintEvent *event);
 	virtual void mousePressEvent(QMouseEvent *event);
 	virtual void mouseReleaseEvent(QMouseEvent *event);
 	virtual void mouseMoveEvent(QMouseEvent *event);
+	virtual void contextMenuEvent(QContextMenuEvent *event);
+	virtual void resizeEvent(QResizeEvent *event);
 
 private:
 	bool mouse_pressed_;
-	QPixmap* cache_;
-	int cache_num_funcs_;
+	// the functions of the region, drawn once per analysis result; a paint
+	// only adds the marker and the text on top
+	QPixmap cache_;
+	bool cache_valid_;
+	bool cache_has_functions_;
+	edb::address_t cache_region_start_;
+	edb::address_t cache_region_size_;
+	int progress_; // of the running analysis, -1 if there is none
+	QString memory_report_;
 };
 
 }
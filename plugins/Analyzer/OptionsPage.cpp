@@ -48,6 +48,7 @@ void OptionsPage::showEvent(QShowEvent *event) {
 
 	QSettings settings;
 	ui->checkBox->setChecked(settings.value("Analyzer/fuzzy_logic_functions.enabled", true).toBool());
+	ui->signatureDirectory->setText(settings.value("Analyzer/signature_directory", QString()).toString());
 }
 
 //------------------------------------------------------------------------------
@@ -61,4 +62,13 @@ void OptionsPage::on_checkBox_toggled(bool checked) {
 	settings.setValue("Analyzer/fuzzy_logic_functions.enabled", ui->checkBox->isChecked());
 }
 
+//------------------------------------------------------------------------------
+// Name: on_signatureDirectory_textChanged
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_signatureDirectory_textChanged(const QString &text) {
+	QSettings settings;
+	settings.setValue("Analyzer/signature_directory", text);
+}
+
 }
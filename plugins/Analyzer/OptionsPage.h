@@ -37,6 +37,7 @@ public:
 
 public Q_SLOTS:
 	void on_checkBox_toggled(bool checked = false);
+	void on_signatureDirectory_textChanged(const QString &text);
 
 private:
 	Ui::OptionsPage *const ui;
@@ -0,0 +1,248 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SignatureDatabase.h"
+
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <QtDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace AnalyzerPlugin {
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: prefix_key
+// Desc: the first four bytes of <data> as one word, which signatures are
+//       indexed by
+//------------------------------------------------------------------------------
+quint32 prefix_key(const quint8 *data) {
+	quint32 key;
+	std::memcpy(&key, data, sizeof(key));
+	return key;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_line
+// Desc: "<pattern> <crc length> <crc> <length> :<offset> <name> ...", anything
+//       after the public names (referenced names, tail bytes) isn't used
+//------------------------------------------------------------------------------
+bool parse_line(const QByteArray &line, SignatureDatabase::Signature *signature) {
+
+	const QList<QByteArray> fields = line.simplified().split(' ');
+	if(fields.size() < 6) {
+		return false;
+	}
+
+	const QByteArray &pattern = fields[0];
+	if(pattern.size() % 2 != 0 || pattern.size() > static_cast<int>(SignatureDatabase::PatternSize * 2)) {
+		return false;
+	}
+
+	signature->bytes.clear();
+	signature->mask.clear();
+	for(int i = 0; i < pattern.size(); i += 2) {
+		const QByteArray byte = pattern.mid(i, 2);
+		if(byte == "..") {
+			signature->bytes.append('\0');
+			signature->mask.append('\0');
+		} else {
+			bool ok;
+			signature->bytes.append(static_cast<char>(byte.toUInt(&ok, 16)));
+			signature->mask.append('\xff');
+			if(!ok) {
+				return false;
+			}
+		}
+	}
+
+	bool ok[3];
+	signature->crc_length = fields[1].toInt(&ok[0], 16);
+	signature->crc        = fields[2].toUShort(&ok[1], 16);
+	signature->length     = fields[3].toUInt(&ok[2], 16);
+	if(!ok[0] || !ok[1] || !ok[2]) {
+		return false;
+	}
+
+	// the name of the public at offset 0, the function itself. A trailing @
+	// on the offset marks a local name, which is as good
+	for(int i = 4; i + 1 < fields.size(); i += 2) {
+		if(!fields[i].startsWith(':')) {
+			break;
+		}
+
+		QByteArray offset = fields[i].mid(1);
+		if(offset.endsWith('@')) {
+			offset.chop(1);
+		}
+
+		if(offset.toUInt(nullptr, 16) == 0) {
+			signature->name = QString::fromLatin1(fields[i + 1]);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: crc16
+// Desc: the CRC16 FLIRT uses, CCITT polynomial reversed, byte swapped result
+//------------------------------------------------------------------------------
+quint16 SignatureDatabase::crc16(const quint8 *data, std::size_t size) {
+
+	if(size == 0) {
+		return 0;
+	}
+
+	quint32 crc = 0xffff;
+	for(std::size_t i = 0; i < size; ++i) {
+		quint32 byte = data[i];
+		for(int bit = 0; bit < 8; ++bit) {
+			if((crc ^ byte) & 1) {
+				crc = (crc >> 1) ^ 0x8408;
+			} else {
+				crc >>= 1;
+			}
+			byte >>= 1;
+		}
+	}
+
+	crc = ~crc & 0xffff;
+	return static_cast<quint16>((crc << 8) | (crc >> 8));
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: adds the signatures of each .pat file in <directory>, returns how many
+//       there are now
+//------------------------------------------------------------------------------
+int SignatureDatabase::load(const QString &directory) {
+
+	const QDir dir(directory);
+	for(const QString &name : dir.entryList(QStringList() << "*.pat", QDir::Files, QDir::Name)) {
+		if(!load_file(dir.absoluteFilePath(name))) {
+			qDebug() << "[Analyzer] unable to read the signature file" << name;
+		}
+	}
+
+	qDebug() << "[Analyzer] loaded" << signatures_.size() << "library signatures from" << directory;
+	return signatures_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: load_file
+// Desc: lines which aren't signatures are skipped, "---" ends the file
+//------------------------------------------------------------------------------
+bool SignatureDatabase::load_file(const QString &filename) {
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+
+	while(!file.atEnd()) {
+		const QByteArray line = file.readLine().trimmed();
+		if(line == "---") {
+			break;
+		}
+
+		Signature signature;
+		if(!parse_line(line, &signature)) {
+			continue;
+		}
+
+		const int index = signatures_.size();
+		signatures_.push_back(signature);
+
+		if(signature.mask.size() >= 4 && prefix_key(reinterpret_cast<const quint8 *>(signature.mask.constData())) == 0xffffffff) {
+			by_prefix_[prefix_key(reinterpret_cast<const quint8 *>(signature.bytes.constData()))].push_back(index);
+		} else {
+			unindexed_.push_back(index);
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: matches
+// Desc:
+//------------------------------------------------------------------------------
+bool SignatureDatabase::matches(const Signature &signature, const quint8 *data, std::size_t available) const {
+
+	const std::size_t pattern_size = signature.bytes.size();
+	if(available < std::max<std::size_t>(pattern_size + signature.crc_length, signature.length)) {
+		return false;
+	}
+
+	for(std::size_t i = 0; i < pattern_size; ++i) {
+		if((data[i] & static_cast<quint8>(signature.mask[i])) != static_cast<quint8>(signature.bytes[i])) {
+			return false;
+		}
+	}
+
+	return crc16(data + pattern_size, signature.crc_length) == signature.crc;
+}
+
+//------------------------------------------------------------------------------
+// Name: match
+// Desc: the signature the function at <data> matches, nullptr if none or if
+//       signatures of different names match it
+//------------------------------------------------------------------------------
+const SignatureDatabase::Signature *SignatureDatabase::match(const quint8 *data, std::size_t available) const {
+
+	const Signature *found = nullptr;
+
+	const auto check = [&](int index) {
+		const Signature &signature = signatures_[index];
+		if(matches(signature, data, available)) {
+			if(found && found->name != signature.name) {
+				return false;
+			}
+			found = &signature;
+		}
+		return true;
+	};
+
+	if(available >= 4) {
+		auto it = by_prefix_.find(prefix_key(data));
+		if(it != by_prefix_.end()) {
+			for(int index : *it) {
+				if(!check(index)) {
+					return nullptr;
+				}
+			}
+		}
+	}
+
+	for(int index : unindexed_) {
+		if(!check(index)) {
+			return nullptr;
+		}
+	}
+
+	return found;
+}
+
+}
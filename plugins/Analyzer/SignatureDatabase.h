@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIGNATURE_DATABASE_20171014_H_
+#define SIGNATURE_DATABASE_20171014_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+
+namespace AnalyzerPlugin {
+
+// Library function signatures in the text format of FLIRT's .pat files. Each
+// one is the first 32 bytes of a function, with the bytes which get relocated
+// wildcarded, the CRC16 of the bytes after those up to the first relocated
+// one, and the function's length and name. They are indexed by their first
+// four bytes, so a function start is checked against the few signatures which
+// could match instead of all of them
+class SignatureDatabase {
+public:
+	static constexpr std::size_t PatternSize = 32;
+
+public:
+	struct Signature {
+		QByteArray bytes;      // the pattern, PatternSize bytes or fewer
+		QByteArray mask;       // 0 where the pattern has a wildcard
+		int        crc_length; // of the bytes after the pattern which the crc covers
+		quint16    crc;
+		quint32    length;     // of the whole function
+		QString    name;
+	};
+
+public:
+	int load(const QString &directory);
+	int size() const { return signatures_.size(); }
+	bool isEmpty() const { return signatures_.isEmpty(); }
+
+public:
+	const Signature *match(const quint8 *data, std::size_t available) const;
+
+public:
+	static quint16 crc16(const quint8 *data, std::size_t size);
+
+private:
+	bool load_file(const QString &filename);
+	bool matches(const Signature &signature, const quint8 *data, std::size_t available) const;
+
+private:
+	QVector<Signature>            signatures_;
+	QHash<quint32, QVector<int>>  by_prefix_;  // the first four bytes to signatures_ indexes
+	QVector<int>                  unindexed_;  // those with a wildcard in the first four
+};
+
+}
+
+#endif
@@ -30,7 +30,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QSettings>
+#include <QStringList>
 #include <QDomDocument>
 #include <QXmlQuery>
 #include <QLineEdit>
@@ -69,9 +71,7 @@ static QString toHtmlEscaped(QString const& str) { return str.toHtmlEscaped(); }
 static QString toHtmlEscaped(QString const& str) { return Qt::escape(str); }
 #endif
 
-QDomDocument getAssemblerDescription() {
-
-	const QString assembler = QSettings().value("Assembler/helper", "yasm").toString();
+QDomDocument loadAssemblerDescription(const QString &assembler) {
 
 	QFile file(":/debugger/Assembler/xml/assemblers.xml");
 	if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -91,6 +91,35 @@ QDomDocument getAssemblerDescription() {
 	return {};
 }
 
+// querying the description is far slower than assembling a line, and it is
+// needed for every instruction, so each assembler's is only looked up once
+QDomDocument getAssemblerDescription() {
+
+	static QHash<QString, QDomDocument> descriptions;
+
+	const QString assembler = QSettings().value("Assembler/helper", "yasm").toString();
+
+	auto it = descriptions.find(assembler);
+	if(it == descriptions.end()) {
+		it = descriptions.insert(assembler, loadAssemblerDescription(assembler));
+	}
+
+	return *it;
+}
+
+// several instructions may be given at once, separated by ';', they are put
+// one a line and assembled together so the whole block is written in one go
+QString blockSource(const QString &text) {
+	QStringList lines;
+	for(const QString &line : text.split(';')) {
+		const QString insn = line.trimmed();
+		if(!insn.isEmpty()) {
+			lines.push_back(insn);
+		}
+	}
+	return lines.join("\n");
+}
+
 QString fixupSyntax(QString insn) {
 
 	const auto asmRoot=getAssemblerDescription().documentElement();
@@ -130,7 +159,7 @@ void DialogAssembler::set_address(edb::address_t address) {
 //------------------------------------------------------------------------------
 void DialogAssembler::on_buttonBox_accepted() {
 
-	const QString nasm_syntax = ui->assembly->currentText().trimmed();
+	const QString nasm_syntax = blockSource(ui->assembly->currentText());
 
 	const auto asm_root=getAssemblerDescription().documentElement();
 	if(!asm_root.isNull()) {
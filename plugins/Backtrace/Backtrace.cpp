@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "Backtrace.h"
+#include "DialogAllThreads.h"
 #include "DialogBacktrace.h"
 #include "edb.h"
 
@@ -32,6 +33,7 @@ Backtrace::Backtrace() : menu_(0), dialog_(0)
 
 Backtrace::~Backtrace() {
 	delete dialog_;
+	delete all_threads_dialog_;
 }
 
 //------------------------------------------------------------------------------
@@ -48,6 +50,7 @@ QMenu *Backtrace::menu(QWidget *parent) {
 
 		//Ctrl + K shortcut, reminiscent of OllyDbg
 		menu_->addAction(tr("Backtrace"), this, SLOT(show_menu()), QKeySequence(tr("Ctrl+K")));
+		menu_->addAction(tr("Backtrace All Threads"), this, SLOT(show_all_threads()));
 	}
 
 	return menu_;
@@ -64,6 +67,17 @@ void Backtrace::show_menu() {
 	dialog_->show();
 }
 
+//------------------------------------------------------------------------------
+// Name: show_all_threads
+// Desc: Shows the backtrace of every thread, grouped by stack
+//------------------------------------------------------------------------------
+void Backtrace::show_all_threads() {
+	if (!all_threads_dialog_) {
+		all_threads_dialog_ = new DialogAllThreads(edb::v1::debugger_ui);
+	}
+	all_threads_dialog_->show();
+}
+
 //Do we need this?  Wasn't included by default; I saw it in other plugins and added it.
 #if QT_VERSION < 0x050000
 Q_EXPORT_PLUGIN2(Backtrace, Backtrace)
@@ -45,10 +45,12 @@ public:
 
 public Q_SLOTS:
 	void show_menu();
+	void show_all_threads();
 
 private:
 	QMenu	         *menu_;
 	QPointer<QDialog> dialog_;
+	QPointer<QDialog> all_threads_dialog_;
 };
 
 }
@@ -0,0 +1,251 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "DialogAllThreads.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "ISymbolManager.h"
+#include "IThread.h"
+#include "MemoryRegions.h"
+#include "State.h"
+#include "Symbol.h"
+#include "Unwinder.h"
+#include "edb.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+#include <QTreeWidgetItem>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#if QT_VERSION >= 0x050000
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+#elif QT_VERSION >= 0x040800
+#include <QtConcurrentMap>
+
+#ifndef QT_NO_CONCURRENT
+#define QT_CONCURRENT_LIB
+#endif
+
+#endif
+
+#include "ui_DialogAllThreads.h"
+
+namespace BacktracePlugin {
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: format_address
+// Desc:
+//------------------------------------------------------------------------------
+QString format_address(quint64 address) {
+	if(const std::shared_ptr<Symbol> symbol = edb::v1::symbol_manager().find_near_symbol(address)) {
+		return QString("0x%1 <%2+%3>").arg(QString::number(address, 16), symbol->name).arg(address - symbol->address.toUint());
+	}
+
+	return QString("0x%1").arg(QString::number(address, 16));
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DialogAllThreads
+// Desc:
+//------------------------------------------------------------------------------
+DialogAllThreads::DialogAllThreads(QWidget *parent) : QDialog(parent), ui(new Ui::DialogAllThreads) {
+	ui->setupUi(this);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogAllThreads
+// Desc:
+//------------------------------------------------------------------------------
+DialogAllThreads::~DialogAllThreads() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void DialogAllThreads::showEvent(QShowEvent *event) {
+	QDialog::showEvent(event);
+	populate();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnRefresh_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogAllThreads::on_btnRefresh_clicked() {
+	populate();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_treeWidget_itemDoubleClicked
+// Desc: jumps to the frame in the CPU view
+//------------------------------------------------------------------------------
+void DialogAllThreads::on_treeWidget_itemDoubleClicked(QTreeWidgetItem *item, int column) {
+	Q_UNUSED(column);
+
+	if(item->parent()) {
+		edb::v1::jump_to_address(item->data(1, Qt::UserRole).value<qulonglong>());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: populate
+// Desc: unwinds every thread and groups those with identical stacks. Talking
+//       to the process is left to this thread: the registers come from the
+//       thread state caches and all of the stacks are read in one batch, the
+//       unwinding itself is spread over the thread pool, in rounds, between
+//       which the modules the workers asked for are loaded
+//------------------------------------------------------------------------------
+void DialogAllThreads::populate() {
+
+	ui->treeWidget->clear();
+	ui->labelSummary->clear();
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	edb::v1::memory_regions().sync();
+	UnwindTables tables(process);
+
+	const QList<std::shared_ptr<IThread>> threads = process->threads();
+
+	QVector<edb::tid_t>     tids;
+	QVector<edb::address_t> pcs;
+	std::vector<Unwinder>   unwinders;
+	unwinders.reserve(threads.size());
+
+	for(const std::shared_ptr<IThread> &thread : threads) {
+		State state;
+		thread->get_state(&state);
+
+		tids.push_back(thread->tid());
+		pcs.push_back(state.instruction_pointer());
+		unwinders.emplace_back(state);
+	}
+
+	QVector<QByteArray>  stacks(static_cast<int>(unwinders.size()));
+	QVector<ReadRequest> requests;
+	for(std::size_t i = 0; i < unwinders.size(); ++i) {
+		stacks[i].resize(static_cast<int>(unwinders[i].stack_size()));
+		requests.push_back({unwinders[i].stack_pointer(), stacks[i].data(), static_cast<std::size_t>(stacks[i].size())});
+	}
+
+	const QVector<std::size_t> results = process->read_many(requests);
+	for(std::size_t i = 0; i < unwinders.size(); ++i) {
+		stacks[i].resize(static_cast<int>(results[i]));
+		unwinders[i].set_stack(stacks[i]);
+	}
+
+	std::vector<Unwinder *> pending;
+	for(Unwinder &unwinder : unwinders) {
+		pending.push_back(&unwinder);
+	}
+
+	auto run = [&tables](Unwinder *unwinder) {
+		unwinder->run(tables);
+	};
+
+	while(!pending.empty()) {
+#ifdef QT_CONCURRENT_LIB
+		QtConcurrent::blockingMap(pending, run);
+#else
+		std::for_each(pending.begin(), pending.end(), run);
+#endif
+
+		QSet<quint64> modules;
+		std::vector<Unwinder *> next;
+		for(Unwinder *unwinder : pending) {
+			switch(unwinder->status()) {
+			case Unwinder::NeedsModule:
+				modules.insert(unwinder->needed_module());
+				next.push_back(unwinder);
+				break;
+			case Unwinder::NeedsScan:
+				unwinder->scan(process, tables);
+				break;
+			default:
+				break;
+			}
+		}
+
+		for(const quint64 base : modules) {
+			tables.load(base);
+		}
+
+		pending.swap(next);
+	}
+
+	// pstack style, the most common stack first
+	std::map<std::vector<quint64>, QVector<edb::tid_t>> groups;
+	for(std::size_t i = 0; i < unwinders.size(); ++i) {
+		std::vector<quint64> stack;
+		stack.push_back(pcs[i].toUint());
+		for(const edb::address_t address : unwinders[i].return_addresses()) {
+			stack.push_back(address.toUint());
+		}
+		groups[stack].push_back(tids[i]);
+	}
+
+	std::vector<const std::pair<const std::vector<quint64>, QVector<edb::tid_t>> *> sorted;
+	for(const auto &group : groups) {
+		sorted.push_back(&group);
+	}
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<const std::vector<quint64>, QVector<edb::tid_t>> *a, const std::pair<const std::vector<quint64>, QVector<edb::tid_t>> *b) {
+		return a->second.size() > b->second.size();
+	});
+
+	for(const auto *group : sorted) {
+		QStringList ids;
+		for(const edb::tid_t tid : group->second) {
+			ids << QString::number(tid);
+		}
+
+		auto item = new QTreeWidgetItem(ui->treeWidget);
+		item->setText(0, tr("%n thread(s)", "", group->second.size()));
+		item->setText(1, ids.join(", "));
+
+		int index = 0;
+		for(const quint64 address : group->first) {
+			auto frame = new QTreeWidgetItem(item);
+			frame->setText(0, QString("#%1").arg(index++));
+			frame->setText(1, format_address(address));
+			frame->setData(1, Qt::UserRole, static_cast<qulonglong>(address));
+		}
+	}
+
+	ui->labelSummary->setText(tr("%1 threads, %2 distinct stacks, %3 ms").arg(threads.size()).arg(groups.size()).arg(timer.elapsed()));
+	ui->treeWidget->resizeColumnToContents(0);
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DIALOG_ALL_THREADS_20171014_H_
+#define DIALOG_ALL_THREADS_20171014_H_
+
+#include <QDialog>
+
+class QTreeWidgetItem;
+
+namespace BacktracePlugin {
+
+namespace Ui {
+class DialogAllThreads;
+}
+
+// the backtrace of every thread at once, threads with the same stack are
+// shown together
+class DialogAllThreads : public QDialog {
+	Q_OBJECT
+
+public:
+	explicit DialogAllThreads(QWidget *parent = 0);
+	virtual ~DialogAllThreads();
+
+protected:
+	virtual void showEvent(QShowEvent *event);
+
+public Q_SLOTS:
+	void populate();
+
+private Q_SLOTS:
+	void on_treeWidget_itemDoubleClicked(QTreeWidgetItem *item, int column);
+	void on_btnRefresh_clicked();
+
+private:
+	Ui::DialogAllThreads *ui;
+};
+
+}
+
+#endif
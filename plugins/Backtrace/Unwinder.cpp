@@ -0,0 +1,1248 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Unwinder.h"
+#include "IAnalyzer.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "State.h"
+#include "WordScan.h"
+#include "edb.h"
+
+#include <QDebug>
+#include <QHash>
+#include <algorithm>
+#include <cstring>
+
+namespace BacktracePlugin {
+namespace {
+
+// the most of a stack read in one go, anything deeper is read as needed
+constexpr quint64 MaxStackWindow = 8 * 1024 * 1024;
+
+constexpr quint32 PtLoad       = 1;
+constexpr quint32 PtGnuEhFrame = 0x6474e550;
+
+enum Encoding : quint8 {
+	DW_EH_PE_absptr  = 0x00,
+	DW_EH_PE_uleb128 = 0x01,
+	DW_EH_PE_udata2  = 0x02,
+	DW_EH_PE_udata4  = 0x03,
+	DW_EH_PE_udata8  = 0x04,
+	DW_EH_PE_sleb128 = 0x09,
+	DW_EH_PE_sdata2  = 0x0a,
+	DW_EH_PE_sdata4  = 0x0b,
+	DW_EH_PE_sdata8  = 0x0c,
+	DW_EH_PE_pcrel   = 0x10,
+	DW_EH_PE_datarel = 0x30,
+	DW_EH_PE_omit    = 0xff
+};
+
+enum CallFrameInstruction : quint8 {
+	DW_CFA_nop                        = 0x00,
+	DW_CFA_set_loc                    = 0x01,
+	DW_CFA_advance_loc1               = 0x02,
+	DW_CFA_advance_loc2               = 0x03,
+	DW_CFA_advance_loc4               = 0x04,
+	DW_CFA_offset_extended            = 0x05,
+	DW_CFA_restore_extended           = 0x06,
+	DW_CFA_undefined                  = 0x07,
+	DW_CFA_same_value                 = 0x08,
+	DW_CFA_register                   = 0x09,
+	DW_CFA_remember_state             = 0x0a,
+	DW_CFA_restore_state              = 0x0b,
+	DW_CFA_def_cfa                    = 0x0c,
+	DW_CFA_def_cfa_register           = 0x0d,
+	DW_CFA_def_cfa_offset             = 0x0e,
+	DW_CFA_def_cfa_expression         = 0x0f,
+	DW_CFA_expression                 = 0x10,
+	DW_CFA_offset_extended_sf         = 0x11,
+	DW_CFA_def_cfa_sf                 = 0x12,
+	DW_CFA_def_cfa_offset_sf          = 0x13,
+	DW_CFA_val_offset                 = 0x14,
+	DW_CFA_val_offset_sf              = 0x15,
+	DW_CFA_val_expression             = 0x16,
+	DW_CFA_GNU_args_size              = 0x2e,
+	DW_CFA_GNU_negative_offset_extended = 0x2f,
+	DW_CFA_advance_loc                = 0x40,
+	DW_CFA_offset                     = 0x80,
+	DW_CFA_restore                    = 0xc0
+};
+
+// reads the little endian, DWARF encoded data of one segment, bounds checked.
+// Any read out of bounds leaves the cursor failed, reading nothing more
+class Cursor {
+public:
+	Cursor() = default;
+	Cursor(const UnwindTables::Segment &segment, quint64 address, int pointer_size) : data_(segment.data), base_(segment.address), address_(address), end_(segment.address + segment.data.size()), pointer_size_(pointer_size), ok_(address >= segment.address && address < end_) {
+	}
+
+public:
+	quint64 address() const { return address_; }
+	bool ok() const         { return ok_; }
+	bool at_end() const     { return !ok_ || address_ >= end_; }
+
+public:
+	quint8  u8()  { return read<quint8>(); }
+	quint16 u16() { return read<quint16>(); }
+	quint32 u32() { return read<quint32>(); }
+	quint64 u64() { return read<quint64>(); }
+
+	quint64 uleb() {
+		quint64 result = 0;
+		int shift      = 0;
+		quint8 byte;
+		do {
+			byte = u8();
+			if(shift < 64) {
+				result |= static_cast<quint64>(byte & 0x7f) << shift;
+			}
+			shift += 7;
+		} while(ok_ && (byte & 0x80));
+		return result;
+	}
+
+	qint64 sleb() {
+		quint64 result = 0;
+		int shift      = 0;
+		quint8 byte;
+		do {
+			byte = u8();
+			if(shift < 64) {
+				result |= static_cast<quint64>(byte & 0x7f) << shift;
+			}
+			shift += 7;
+		} while(ok_ && (byte & 0x80));
+
+		if(shift < 64 && (byte & 0x40)) {
+			result |= ~quint64(0) << shift;
+		}
+		return static_cast<qint64>(result);
+	}
+
+	QByteArray string() {
+		QByteArray result;
+		while(ok_) {
+			const char ch = static_cast<char>(u8());
+			if(ch == '\0') {
+				break;
+			}
+			result.append(ch);
+		}
+		return result;
+	}
+
+	void skip(quint64 count) {
+		if(!ok_ || count > end_ - address_) {
+			ok_ = false;
+		} else {
+			address_ += count;
+		}
+	}
+
+	// a cursor over the next <length> bytes, which this one skips
+	Cursor block(quint64 length) {
+		Cursor child = *this;
+		skip(length);
+		child.end_ = address_;
+		child.ok_  = ok_;
+		return child;
+	}
+
+	quint64 encoded(quint8 encoding, quint64 datarel) {
+		if(encoding == DW_EH_PE_omit) {
+			return 0;
+		}
+
+		const quint64 field = address_;
+		quint64 value;
+
+		switch(encoding & 0x0f) {
+		case DW_EH_PE_absptr:  value = (pointer_size_ == 8) ? u64() : u32(); break;
+		case DW_EH_PE_uleb128: value = uleb(); break;
+		case DW_EH_PE_udata2:  value = u16(); break;
+		case DW_EH_PE_udata4:  value = u32(); break;
+		case DW_EH_PE_udata8:  value = u64(); break;
+		case DW_EH_PE_sleb128: value = static_cast<quint64>(sleb()); break;
+		case DW_EH_PE_sdata2:  value = static_cast<quint64>(static_cast<qint16>(u16())); break;
+		case DW_EH_PE_sdata4:  value = static_cast<quint64>(static_cast<qint32>(u32())); break;
+		case DW_EH_PE_sdata8:  value = u64(); break;
+		default:
+			ok_ = false;
+			return 0;
+		}
+
+		// DW_EH_PE_indirect is only found on personality routines, which are
+		// of no interest, so it is ignored
+		switch(encoding & 0x70) {
+		case 0:                break;
+		case DW_EH_PE_pcrel:   value += field; break;
+		case DW_EH_PE_datarel: value += datarel; break;
+		default:
+			ok_ = false;
+			return 0;
+		}
+
+		if(pointer_size_ == 4) {
+			value &= 0xffffffff;
+		}
+
+		return value;
+	}
+
+private:
+	template <class T>
+	T read() {
+		T value = 0;
+		if(ok_ && sizeof(T) <= end_ - address_) {
+			std::memcpy(&value, data_.constData() + (address_ - base_), sizeof(T));
+			address_ += sizeof(T);
+		} else {
+			ok_ = false;
+		}
+		return value;
+	}
+
+private:
+	QByteArray data_;
+	quint64    base_         = 0;
+	quint64    address_      = 0;
+	quint64    end_          = 0;
+	int        pointer_size_ = 8;
+	bool       ok_           = false;
+};
+
+struct Cie {
+	quint64 code_align   = 1;
+	qint64  data_align   = 1;
+	quint64 ra_register  = 0;
+	quint8  fde_encoding = DW_EH_PE_absptr;
+	bool    augmented    = false;
+	bool    signal_frame = false;
+	Cursor  instructions;
+};
+
+struct Fde {
+	quint64 start = 0;
+	quint64 end   = 0;
+	Cie     cie;
+	Cursor  instructions;
+};
+
+struct Rule {
+	enum Type {
+		SameValue,
+		Undefined,
+		Offset,
+		ValOffset,
+		InRegister,
+		Unsupported
+	};
+
+	Type    type   = SameValue;
+	qint64  offset = 0;
+	quint64 reg    = 0;
+};
+
+struct Row {
+	quint64 cfa_register  = 0;
+	qint64  cfa_offset    = 0;
+	bool    cfa_supported = true;
+	Rule    rules[UnwindTables::MaxRegisters];
+};
+
+//------------------------------------------------------------------------------
+// Name: containing_function
+// Desc: the entry of the analyzed function which has <address> in it, 0 if
+//       there is none
+//------------------------------------------------------------------------------
+edb::address_t containing_function(const IAnalyzer *analyzer, edb::address_t address) {
+	if(analyzer) {
+		if(const Result<edb::address_t> entry = analyzer->find_containing_function(address)) {
+			return *entry;
+		}
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_standard_function
+// Desc: true if the analysis found a function other than a thunk at <address>.
+//       A call to a thunk says nothing about where it ends up
+//------------------------------------------------------------------------------
+bool is_standard_function(const IAnalyzer *analyzer, edb::address_t address) {
+	if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(address)) {
+		const IAnalyzer::FunctionIndex index = analyzer->function_index(region);
+
+		auto it = std::lower_bound(index.entries.begin(), index.entries.end(), address);
+		if(it != index.entries.end() && *it == address) {
+			return index.types[static_cast<int>(it - index.entries.begin())] != Function::FUNCTION_THUNK;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: cursor_at
+// Desc: a cursor at <address>, which is only valid if one of the segments
+//       read of <module> has it
+//------------------------------------------------------------------------------
+Cursor cursor_at(const UnwindTables::Module &module, quint64 address, int pointer_size) {
+	for(const UnwindTables::Segment &segment : module.segments) {
+		if(address >= segment.address && address < segment.address + segment.data.size()) {
+			return Cursor(segment, address, pointer_size);
+		}
+	}
+	return Cursor();
+}
+
+//------------------------------------------------------------------------------
+// Name: read_segment
+// Desc: makes sure that the loaded segment (<loads> holds their relocated
+//       start and size) which has <address> in it is read, in one go
+//------------------------------------------------------------------------------
+bool read_segment(const IProcess *process, UnwindTables::Module *module, const QVector<QPair<quint64, quint64>> &loads, quint64 address) {
+
+	for(const UnwindTables::Segment &segment : module->segments) {
+		if(address >= segment.address && address < segment.address + segment.data.size()) {
+			return true;
+		}
+	}
+
+	for(const QPair<quint64, quint64> &load : loads) {
+		if(address >= load.first && address - load.first < load.second) {
+			UnwindTables::Segment segment;
+			segment.address = load.first;
+			segment.data.resize(static_cast<int>(load.second));
+			segment.data.resize(static_cast<int>(process->read_bytes(load.first, segment.data.data(), segment.data.size())));
+			module->segments.push_back(segment);
+			return !segment.data.isEmpty();
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_cie
+// Desc:
+//------------------------------------------------------------------------------
+bool parse_cie(const UnwindTables::Module &module, quint64 address, int pointer_size, Cie *cie) {
+
+	Cursor cursor = cursor_at(module, address, pointer_size);
+
+	quint64 length = cursor.u32();
+	if(length == 0xffffffff) {
+		length = cursor.u64();
+	}
+
+	Cursor entry = cursor.block(length);
+	if(length == 0 || entry.u32() != 0) {
+		return false;
+	}
+
+	const quint8 version = entry.u8();
+	if(version != 1 && version != 3) {
+		return false;
+	}
+
+	const QByteArray augmentation = entry.string();
+	if(augmentation.contains("eh")) {
+		entry.skip(pointer_size);
+	}
+
+	cie->code_align  = entry.uleb();
+	cie->data_align  = entry.sleb();
+	cie->ra_register = (version == 1) ? entry.u8() : entry.uleb();
+
+	if(augmentation.startsWith('z')) {
+		cie->augmented = true;
+		Cursor data = entry.block(entry.uleb());
+
+		for(int i = 1; i < augmentation.size(); ++i) {
+			switch(augmentation[i]) {
+			case 'R':
+				cie->fde_encoding = data.u8();
+				break;
+			case 'P':
+				data.encoded(data.u8() & 0x7f, module.hdr);
+				break;
+			case 'L':
+				data.u8();
+				break;
+			case 'S':
+				cie->signal_frame = true;
+				break;
+			default:
+				// the rest is skipped over with the augmentation data
+				i = augmentation.size();
+				break;
+			}
+		}
+	} else if(!augmentation.isEmpty()) {
+		return false;
+	}
+
+	cie->instructions = entry;
+	return entry.ok();
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_fde
+// Desc:
+//------------------------------------------------------------------------------
+bool parse_fde(const UnwindTables::Module &module, quint64 address, int pointer_size, Fde *fde) {
+
+	Cursor cursor = cursor_at(module, address, pointer_size);
+
+	quint64 length = cursor.u32();
+	if(length == 0xffffffff) {
+		length = cursor.u64();
+	}
+
+	Cursor entry = cursor.block(length);
+
+	// the CIE pointer is relative to itself
+	const quint64 id_address = entry.address();
+	const quint32 id         = entry.u32();
+	if(length == 0 || !entry.ok() || id == 0) {
+		return false;
+	}
+
+	if(!parse_cie(module, id_address - id, pointer_size, &fde->cie)) {
+		return false;
+	}
+
+	fde->start = entry.encoded(fde->cie.fde_encoding, module.hdr);
+	fde->end   = fde->start + entry.encoded(fde->cie.fde_encoding & 0x0f, module.hdr);
+
+	if(fde->cie.augmented) {
+		entry.skip(entry.uleb());
+	}
+
+	fde->instructions = entry;
+	return entry.ok();
+}
+
+//------------------------------------------------------------------------------
+// Name: load_module
+// Desc: finds the call frame information of the module whose ELF header is
+//       at <base> through its PT_GNU_EH_FRAME segment, and the FDE of each
+//       function. The search table of .eh_frame_hdr is used when there is
+//       one, otherwise .eh_frame is walked once
+//------------------------------------------------------------------------------
+std::shared_ptr<UnwindTables::Module> load_module(const IProcess *process, const QString &name, quint64 base, int pointer_size) {
+
+	auto module  = std::make_shared<UnwindTables::Module>();
+	module->name = name;
+
+	const bool is64 = (pointer_size == 8);
+
+	quint8 header[64];
+	const std::size_t header_size = is64 ? 64 : 52;
+	if(process->read_bytes(base, header, header_size) != header_size || std::memcmp(header, "\x7f" "ELF", 4) != 0 || header[4] != (is64 ? 2 : 1)) {
+		return module;
+	}
+
+	quint64 phoff     = 0;
+	quint16 phentsize = 0;
+	quint16 phnum     = 0;
+	if(is64) {
+		std::memcpy(&phoff, header + 32, 8);
+		std::memcpy(&phentsize, header + 54, 2);
+		std::memcpy(&phnum, header + 56, 2);
+	} else {
+		quint32 phoff32;
+		std::memcpy(&phoff32, header + 28, 4);
+		std::memcpy(&phentsize, header + 42, 2);
+		std::memcpy(&phnum, header + 44, 2);
+		phoff = phoff32;
+	}
+
+	if(phnum == 0 || phentsize < (is64 ? 56 : 32)) {
+		return module;
+	}
+
+	QByteArray phdrs(phentsize * phnum, '\0');
+	if(process->read_bytes(base + phoff, phdrs.data(), phdrs.size()) != static_cast<std::size_t>(phdrs.size())) {
+		return module;
+	}
+
+	QVector<QPair<quint64, quint64>> loads;
+	quint64 eh_frame_hdr = 0;
+	quint64 lowest       = ~quint64(0);
+
+	for(int i = 0; i < phnum; ++i) {
+		const char *const phdr = phdrs.constData() + i * phentsize;
+
+		quint32 type;
+		quint64 vaddr  = 0;
+		quint64 filesz = 0;
+		std::memcpy(&type, phdr, 4);
+		if(is64) {
+			std::memcpy(&vaddr, phdr + 16, 8);
+			std::memcpy(&filesz, phdr + 32, 8);
+		} else {
+			quint32 vaddr32;
+			quint32 filesz32;
+			std::memcpy(&vaddr32, phdr + 8, 4);
+			std::memcpy(&filesz32, phdr + 16, 4);
+			vaddr  = vaddr32;
+			filesz = filesz32;
+		}
+
+		if(type == PtLoad) {
+			loads.push_back(qMakePair(vaddr, filesz));
+			lowest = qMin(lowest, vaddr);
+		} else if(type == PtGnuEhFrame) {
+			eh_frame_hdr = vaddr;
+		}
+	}
+
+	if(loads.isEmpty() || eh_frame_hdr == 0) {
+		return module;
+	}
+
+	// 0 for executables, which are not position independent
+	const quint64 bias = base - (lowest & ~quint64(0xfff));
+	for(QPair<quint64, quint64> &load : loads) {
+		load.first += bias;
+	}
+
+	module->hdr = eh_frame_hdr + bias;
+	if(!read_segment(process, module.get(), loads, module->hdr)) {
+		return module;
+	}
+
+	Cursor cursor = cursor_at(*module, module->hdr, pointer_size);
+	if(cursor.u8() != 1) {
+		return module;
+	}
+
+	const quint8 eh_frame_encoding  = cursor.u8();
+	const quint8 fde_count_encoding = cursor.u8();
+	const quint8 table_encoding     = cursor.u8();
+
+	const quint64 eh_frame  = cursor.encoded(eh_frame_encoding, module->hdr);
+	const quint64 fde_count = cursor.encoded(fde_count_encoding, module->hdr);
+
+	if(cursor.ok() && fde_count_encoding != DW_EH_PE_omit && table_encoding == (DW_EH_PE_datarel | DW_EH_PE_sdata4)) {
+		for(quint64 i = 0; i < fde_count; ++i) {
+			const quint64 start = cursor.encoded(table_encoding, module->hdr);
+			const quint64 fde   = cursor.encoded(table_encoding, module->hdr);
+			if(!cursor.ok()) {
+				break;
+			}
+			module->fdes.insert(start, fde);
+		}
+	}
+
+	// the FDEs themselves are read from here on
+	if(!read_segment(process, module.get(), loads, eh_frame)) {
+		module->fdes.clear();
+		return module;
+	}
+
+	if(module->fdes.isEmpty()) {
+		Cursor entries = cursor_at(*module, eh_frame, pointer_size);
+		while(!entries.at_end()) {
+			const quint64 entry_address = entries.address();
+
+			quint64 length = entries.u32();
+			if(length == 0) {
+				break;
+			}
+
+			if(length == 0xffffffff) {
+				length = entries.u64();
+			}
+
+			entries.skip(length);
+
+			Fde fde;
+			if(entries.ok() && parse_fde(*module, entry_address, pointer_size, &fde)) {
+				module->fdes.insert(fde.start, entry_address);
+			}
+		}
+	}
+
+	return module;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_rule
+// Desc: the registers which are not tracked are parsed over, but ignored
+//------------------------------------------------------------------------------
+void set_rule(Row *row, quint64 reg, Rule::Type type, qint64 offset = 0, quint64 other = 0) {
+	if(reg < UnwindTables::MaxRegisters) {
+		row->rules[reg].type   = type;
+		row->rules[reg].offset = offset;
+		row->rules[reg].reg    = other;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: execute
+// Desc: runs the call frame instructions of <program> on <row>, up to the one
+//       which would move past <target>. <initial> is the row the CIE set up,
+//       which DW_CFA_restore goes back to
+//------------------------------------------------------------------------------
+bool execute(Cursor program, const Cie &cie, quint64 start, quint64 target, const Row &initial, Row *row, quint64 datarel) {
+
+	quint64 location = start;
+	QVector<Row> remembered;
+
+	auto advance = [&](quint64 delta) {
+		location += delta * cie.code_align;
+		return location <= target;
+	};
+
+	while(!program.at_end()) {
+		const quint8 op = program.u8();
+
+		switch(op & 0xc0) {
+		case DW_CFA_advance_loc:
+			if(!advance(op & 0x3f)) {
+				return true;
+			}
+			continue;
+		case DW_CFA_offset:
+			set_rule(row, op & 0x3f, Rule::Offset, static_cast<qint64>(program.uleb()) * cie.data_align);
+			continue;
+		case DW_CFA_restore:
+			if((op & 0x3f) < UnwindTables::MaxRegisters) {
+				row->rules[op & 0x3f] = initial.rules[op & 0x3f];
+			}
+			continue;
+		}
+
+		switch(op) {
+		case DW_CFA_nop:
+			break;
+		case DW_CFA_set_loc:
+			location = program.encoded(cie.fde_encoding, datarel);
+			if(location > target) {
+				return true;
+			}
+			break;
+		case DW_CFA_advance_loc1:
+			if(!advance(program.u8())) {
+				return true;
+			}
+			break;
+		case DW_CFA_advance_loc2:
+			if(!advance(program.u16())) {
+				return true;
+			}
+			break;
+		case DW_CFA_advance_loc4:
+			if(!advance(program.u32())) {
+				return true;
+			}
+			break;
+		case DW_CFA_offset_extended: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::Offset, static_cast<qint64>(program.uleb()) * cie.data_align);
+			break;
+		}
+		case DW_CFA_restore_extended: {
+			const quint64 reg = program.uleb();
+			if(reg < UnwindTables::MaxRegisters) {
+				row->rules[reg] = initial.rules[reg];
+			}
+			break;
+		}
+		case DW_CFA_undefined:
+			set_rule(row, program.uleb(), Rule::Undefined);
+			break;
+		case DW_CFA_same_value:
+			set_rule(row, program.uleb(), Rule::SameValue);
+			break;
+		case DW_CFA_register: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::InRegister, 0, program.uleb());
+			break;
+		}
+		case DW_CFA_remember_state:
+			remembered.push_back(*row);
+			break;
+		case DW_CFA_restore_state: {
+			if(remembered.isEmpty()) {
+				return false;
+			}
+			// the CFA is not part of the state
+			const Row saved = *row;
+			*row = remembered.takeLast();
+			row->cfa_register  = saved.cfa_register;
+			row->cfa_offset    = saved.cfa_offset;
+			row->cfa_supported = saved.cfa_supported;
+			break;
+		}
+		case DW_CFA_def_cfa:
+			row->cfa_register  = program.uleb();
+			row->cfa_offset    = static_cast<qint64>(program.uleb());
+			row->cfa_supported = true;
+			break;
+		case DW_CFA_def_cfa_sf:
+			row->cfa_register  = program.uleb();
+			row->cfa_offset    = program.sleb() * cie.data_align;
+			row->cfa_supported = true;
+			break;
+		case DW_CFA_def_cfa_register:
+			row->cfa_register = program.uleb();
+			break;
+		case DW_CFA_def_cfa_offset:
+			row->cfa_offset = static_cast<qint64>(program.uleb());
+			break;
+		case DW_CFA_def_cfa_offset_sf:
+			row->cfa_offset = program.sleb() * cie.data_align;
+			break;
+		case DW_CFA_def_cfa_expression:
+			// DWARF expressions are not evaluated, the PLT is about the only
+			// place they are found in
+			program.skip(program.uleb());
+			row->cfa_supported = false;
+			break;
+		case DW_CFA_expression:
+		case DW_CFA_val_expression: {
+			const quint64 reg = program.uleb();
+			program.skip(program.uleb());
+			set_rule(row, reg, Rule::Unsupported);
+			break;
+		}
+		case DW_CFA_offset_extended_sf: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::Offset, program.sleb() * cie.data_align);
+			break;
+		}
+		case DW_CFA_val_offset: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::ValOffset, static_cast<qint64>(program.uleb()) * cie.data_align);
+			break;
+		}
+		case DW_CFA_val_offset_sf: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::ValOffset, program.sleb() * cie.data_align);
+			break;
+		}
+		case DW_CFA_GNU_args_size:
+			program.uleb();
+			break;
+		case DW_CFA_GNU_negative_offset_extended: {
+			const quint64 reg = program.uleb();
+			set_rule(row, reg, Rule::Offset, -static_cast<qint64>(program.uleb()) * cie.data_align);
+			break;
+		}
+		default:
+			qDebug() << "[Unwinder] unknown call frame instruction" << hex << op;
+			return false;
+		}
+	}
+
+	return program.ok();
+}
+
+//------------------------------------------------------------------------------
+// Name: module_cache
+// Desc: the modules parsed so far, by their base, kept until the process they
+//       are from goes away
+//------------------------------------------------------------------------------
+struct ModuleCache {
+	edb::pid_t                                           pid = 0;
+	QMap<quint64, std::shared_ptr<UnwindTables::Module>> modules;
+};
+
+ModuleCache &module_cache() {
+	static ModuleCache cache;
+	return cache;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: UnwindTables
+// Desc: takes note of where the code of the process is, the tables of the
+//       modules are shared with every other UnwindTables of the same process
+//------------------------------------------------------------------------------
+UnwindTables::UnwindTables(const IProcess *process) : process_(process), pointer_size_(edb::v1::pointer_size()) {
+
+	ModuleCache &cache = module_cache();
+	if(cache.pid != process->pid()) {
+		cache.modules.clear();
+		cache.pid = process->pid();
+	}
+
+	QHash<QString, quint64> bases;
+	const QList<std::shared_ptr<IRegion>> &regions = edb::v1::memory_regions().regions();
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		const quint64 start = region->start().toUint();
+		auto it = bases.find(region->name());
+		if(it == bases.end()) {
+			bases.insert(region->name(), start);
+		} else if(start < it.value()) {
+			it.value() = start;
+		}
+	}
+
+	// the regions are sorted already
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		if(region->executable()) {
+			regions_.push_back({region->start().toUint(), region->end().toUint(), bases.value(region->name()), region->name()});
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: region
+// Desc: the executable region <address> is in, if any
+//------------------------------------------------------------------------------
+const UnwindTables::Region *UnwindTables::region(quint64 address) const {
+
+	auto it = std::upper_bound(regions_.begin(), regions_.end(), address, [](quint64 value, const Region &region) {
+		return value < region.start;
+	});
+
+	if(it == regions_.begin()) {
+		return nullptr;
+	}
+
+	--it;
+	return (address < it->end) ? &*it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_code
+// Desc:
+//------------------------------------------------------------------------------
+bool UnwindTables::is_code(quint64 address) const {
+	return region(address) != nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: the call frame information of the module <address> is in. If that
+//       module still has to be loaded, the result is null and <missing> is
+//       set to its base, otherwise <missing> is 0
+//------------------------------------------------------------------------------
+std::shared_ptr<const UnwindTables::Module> UnwindTables::find(quint64 address, quint64 *missing) const {
+
+	*missing = 0;
+
+	const Region *const r = region(address);
+	if(!r || r->name.isEmpty()) {
+		return nullptr;
+	}
+
+	const QMap<quint64, std::shared_ptr<Module>> &modules = module_cache().modules;
+	auto it = modules.constFind(r->base);
+	if(it == modules.constEnd() || it.value()->name != r->name) {
+		*missing = r->base;
+		return nullptr;
+	}
+
+	return it.value();
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: reads the call frame information of the module at <base>, must not be
+//       called while anything is using the tables
+//------------------------------------------------------------------------------
+void UnwindTables::load(quint64 base) {
+
+	QString name;
+	for(const Region &r : regions_) {
+		if(r.base == base) {
+			name = r.name;
+			break;
+		}
+	}
+
+	module_cache().modules.insert(base, load_module(process_, name, base, pointer_size_));
+}
+
+//------------------------------------------------------------------------------
+// Name: Unwinder
+// Desc:
+//------------------------------------------------------------------------------
+Unwinder::Unwinder(const State &state, int max_frames) : max_frames_(max_frames) {
+
+	const bool is64 = edb::v1::debuggeeIs64Bit();
+
+	pointer_size_   = is64 ? 8 : 4;
+	register_count_ = is64 ? 17 : 9;
+	sp_register_    = is64 ? 7 : 4;
+	fp_register_    = is64 ? 6 : 5;
+
+	frame_.pc       = state.instruction_pointer().toUint();
+	frame_.exact_pc = true;
+	for(int i = 0; i < UnwindTables::MaxRegisters; ++i) {
+		frame_.regs[i]  = 0;
+		frame_.valid[i] = false;
+	}
+
+	// the DWARF numbering of x86-64 doesn't follow the encoding of the
+	// registers, that of x86 does
+	static const int x86_64_registers[16] = {0, 2, 1, 3, 6, 7, 5, 4, 8, 9, 10, 11, 12, 13, 14, 15};
+
+	const int gp_count = is64 ? 16 : 8;
+	for(int i = 0; i < gp_count; ++i) {
+		if(const Register reg = state.gp_register(is64 ? x86_64_registers[i] : i)) {
+			frame_.regs[i]  = reg.valueAsInteger();
+			frame_.valid[i] = true;
+		}
+	}
+
+	stack_start_ = frame_.regs[sp_register_];
+	if(!frame_.valid[sp_register_]) {
+		status_ = Done;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: stack_pointer
+// Desc:
+//------------------------------------------------------------------------------
+quint64 Unwinder::stack_pointer() const {
+	return stack_start_;
+}
+
+//------------------------------------------------------------------------------
+// Name: stack_size
+// Desc: how much of the stack there is above the stack pointer, which is how
+//       much should be passed to set_stack
+//------------------------------------------------------------------------------
+quint64 Unwinder::stack_size() const {
+
+	const quint64 sp = stack_pointer();
+	if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(sp)) {
+		return qMin(region->end().toUint() - sp, MaxStackWindow);
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_stack
+// Desc:
+//------------------------------------------------------------------------------
+void Unwinder::set_stack(const QByteArray &stack) {
+	stack_ = stack;
+}
+
+//------------------------------------------------------------------------------
+// Name: unwind
+// Desc: reads the stack in one go, and gives run() whatever it asks for
+//------------------------------------------------------------------------------
+QVector<edb::address_t> Unwinder::unwind(const IProcess *process, const State &state) {
+
+	UnwindTables tables(process);
+	Unwinder unwinder(state);
+
+	QByteArray stack(static_cast<int>(unwinder.stack_size()), '\0');
+	stack.resize(static_cast<int>(process->read_bytes(unwinder.stack_pointer(), stack.data(), stack.size())));
+	unwinder.set_stack(stack);
+
+	while(unwinder.status() != Done) {
+		unwinder.run(tables);
+
+		switch(unwinder.status()) {
+		case NeedsModule:
+			tables.load(unwinder.needed_module());
+			break;
+		case NeedsScan:
+			unwinder.scan(process, tables);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return unwinder.return_addresses();
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: each frame is unwound with the call frame information of its code.
+//       Without any, the frame pointer is followed, and if that doesn't get
+//       anywhere either, the rest of the stack has to be scanned for anything
+//       that looks like a return address
+//------------------------------------------------------------------------------
+void Unwinder::run(const UnwindTables &tables) {
+
+	if(status_ == Done || status_ == NeedsScan) {
+		return;
+	}
+
+	status_ = Unwinding;
+
+	while(addresses_.size() < max_frames_) {
+		const quint64 sp = frame_.regs[sp_register_];
+
+		Frame caller = frame_;
+		const StepResult result = step_cfi(tables, &caller);
+		if(result == Missing) {
+			status_ = NeedsModule;
+			return;
+		}
+
+		if(result == Outermost) {
+			break;
+		}
+
+		if(result == Failed) {
+			caller = frame_;
+			if(!step_frame_pointer(&caller)) {
+				scan_from_ = sp;
+				status_    = NeedsScan;
+				return;
+			}
+		}
+
+		// the stack only ever grows down, anything else means we got lost
+		if(caller.regs[sp_register_] <= sp || !tables.is_code(caller.pc)) {
+			scan_from_ = sp;
+			status_    = NeedsScan;
+			return;
+		}
+
+		addresses_.push_back(caller.pc);
+		frame_ = caller;
+	}
+
+	status_ = Done;
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: the last resort, every slot of the stack from where run() gave up on
+//       which points just after a call. This reads the code, so it has to be
+//       done by the thread which may read the process
+//------------------------------------------------------------------------------
+void Unwinder::scan(const IProcess *process, const UnwindTables &tables) {
+
+	if(status_ != NeedsScan) {
+		return;
+	}
+
+	// a slot which was left behind by an earlier call looks just like a return
+	// address. Where the call before it goes straight to an analyzed function,
+	// the call graph has to agree that its caller calls the function of the
+	// frame below, or it can't be how we got there
+	IAnalyzer *const analyzer = edb::v1::analyzer();
+	edb::address_t callee = containing_function(analyzer, frame_.exact_pc ? frame_.pc : frame_.pc - 1);
+
+	const quint64 address = scan_from_ + (pointer_size_ - scan_from_ % pointer_size_) % pointer_size_;
+	if(address >= stack_start_) {
+		const quint8 *const data = reinterpret_cast<const quint8 *>(stack_.constData());
+		util::for_each_word(pointer_size_, data, stack_.size(), address - stack_start_, [&](std::size_t, quint64 value) {
+			edb::address_t caller;
+			edb::address_t target;
+			if(addresses_.size() < max_frames_ && tables.is_code(value) && call_before(process, value, &caller, &target)) {
+				const edb::address_t function = containing_function(analyzer, caller);
+
+				if(callee != 0 && function != 0 && target != 0 && target != callee && is_standard_function(analyzer, target)) {
+					if(!analyzer->callees(function).contains(callee)) {
+						return;
+					}
+				}
+
+				addresses_.push_back(value);
+				callee = function;
+			}
+		});
+	}
+
+	status_ = Done;
+}
+
+//------------------------------------------------------------------------------
+// Name: call_before
+// Desc: <target> is where the call goes, if it is to an immediate, otherwise 0
+//------------------------------------------------------------------------------
+bool Unwinder::call_before(const IProcess *process, edb::address_t address, edb::address_t *caller, edb::address_t *target) {
+
+	const quint8 CALL_MIN_SIZE = 2, CALL_MAX_SIZE = 7;
+	quint8 buffer[edb::Instruction::MAX_SIZE];
+
+	if(address.toUint() < CALL_MAX_SIZE || process->read_bytes(address - CALL_MAX_SIZE, buffer, sizeof(buffer)) != sizeof(buffer)) {
+		return false;
+	}
+
+	for(int i = (CALL_MAX_SIZE - CALL_MIN_SIZE); i >= 0; --i) {
+		const edb::address_t site = address - CALL_MAX_SIZE + i;
+
+		edb::Instruction inst(buffer + i, buffer + sizeof(buffer), site);
+		if(is_call(inst) && inst.byte_size() == static_cast<std::size_t>(CALL_MAX_SIZE - i)) {
+			*caller = site;
+			if(target) {
+				*target = is_immediate(inst[0]) ? static_cast<edb::address_t>(inst[0]->imm) : edb::address_t(0);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: step_cfi
+// Desc: turns <frame> into the one of its caller
+//------------------------------------------------------------------------------
+Unwinder::StepResult Unwinder::step_cfi(const UnwindTables &tables, Frame *frame) {
+
+	// a return address may be one past the end of the function, when the call
+	// never returns
+	const quint64 lookup = frame->exact_pc ? frame->pc : frame->pc - 1;
+
+	quint64 missing;
+	const std::shared_ptr<const UnwindTables::Module> module = tables.find(lookup, &missing);
+	if(!module) {
+		needed_module_ = missing;
+		return missing ? Missing : Failed;
+	}
+
+	if(module->fdes.isEmpty()) {
+		return Failed;
+	}
+
+	auto it = module->fdes.upperBound(lookup);
+	if(it == module->fdes.begin()) {
+		return Failed;
+	}
+	--it;
+
+	Fde fde;
+	if(!parse_fde(*module, it.value(), pointer_size_, &fde) || lookup < fde.start || lookup >= fde.end || fde.cie.ra_register >= static_cast<quint64>(register_count_)) {
+		return Failed;
+	}
+
+	Row initial;
+	if(!execute(fde.cie.instructions, fde.cie, 0, ~quint64(0), initial, &initial, module->hdr)) {
+		return Failed;
+	}
+
+	Row row = initial;
+	if(!execute(fde.instructions, fde.cie, fde.start, lookup, initial, &row, module->hdr)) {
+		return Failed;
+	}
+
+	if(!row.cfa_supported || row.cfa_register >= static_cast<quint64>(register_count_) || !frame->valid[row.cfa_register]) {
+		return Failed;
+	}
+
+	const quint64 cfa = frame->regs[row.cfa_register] + row.cfa_offset;
+
+	Frame caller = *frame;
+	for(int i = 0; i < register_count_; ++i) {
+		const Rule &rule = row.rules[i];
+		switch(rule.type) {
+		case Rule::SameValue:
+			break;
+		case Rule::Undefined:
+		case Rule::Unsupported:
+			caller.valid[i] = false;
+			break;
+		case Rule::Offset:
+			caller.valid[i] = read_pointer(cfa + rule.offset, &caller.regs[i]);
+			break;
+		case Rule::ValOffset:
+			caller.regs[i]  = cfa + rule.offset;
+			caller.valid[i] = true;
+			break;
+		case Rule::InRegister:
+			caller.valid[i] = rule.reg < static_cast<quint64>(register_count_) && frame->valid[rule.reg];
+			caller.regs[i]  = caller.valid[i] ? frame->regs[rule.reg] : 0;
+			break;
+		}
+	}
+
+	// that is how the outermost frames, _start and the thread entry points,
+	// say so
+	const Rule &ra = row.rules[fde.cie.ra_register];
+	if(ra.type == Rule::Undefined) {
+		return Outermost;
+	}
+
+	if(ra.type == Rule::SameValue || !caller.valid[fde.cie.ra_register]) {
+		return Failed;
+	}
+
+	caller.pc                  = caller.regs[fde.cie.ra_register];
+	caller.regs[sp_register_]  = cfa;
+	caller.valid[sp_register_] = true;
+	caller.exact_pc            = fde.cie.signal_frame;
+
+	if(pointer_size_ == 4) {
+		caller.pc &= 0xffffffff;
+		caller.regs[sp_register_] &= 0xffffffff;
+	}
+
+	*frame = caller;
+	return Stepped;
+}
+
+//------------------------------------------------------------------------------
+// Name: step_frame_pointer
+// Desc: the classic frame layout, the saved frame pointer just under the
+//       return address
+//------------------------------------------------------------------------------
+bool Unwinder::step_frame_pointer(Frame *frame) const {
+
+	if(!frame->valid[fp_register_]) {
+		return false;
+	}
+
+	const quint64 fp = frame->regs[fp_register_];
+	if(fp < frame->regs[sp_register_] || fp % pointer_size_ != 0 || fp < stack_start_ || fp - stack_start_ + 2 * pointer_size_ > static_cast<quint64>(stack_.size())) {
+		return false;
+	}
+
+	quint64 saved_fp;
+	quint64 ra;
+	if(!read_pointer(fp, &saved_fp) || !read_pointer(fp + pointer_size_, &ra)) {
+		return false;
+	}
+
+	frame->pc                  = ra;
+	frame->exact_pc            = false;
+	frame->regs[fp_register_]  = saved_fp;
+	frame->regs[sp_register_]  = fp + 2 * pointer_size_;
+	frame->valid[sp_register_] = true;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pointer
+// Desc: from the copy of the stack, nothing outside of it can be read
+//------------------------------------------------------------------------------
+bool Unwinder::read_pointer(quint64 address, quint64 *value) const {
+
+	*value = 0;
+
+	if(address >= stack_start_ && address - stack_start_ + pointer_size_ <= static_cast<quint64>(stack_.size())) {
+		*value = util::load_word(pointer_size_, reinterpret_cast<const quint8 *>(stack_.constData()) + (address - stack_start_));
+		return true;
+	}
+
+	return false;
+}
+
+}
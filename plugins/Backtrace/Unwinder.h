@@ -0,0 +1,160 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef UNWINDER_20171014_H_
+#define UNWINDER_20171014_H_
+
+#include "Types.h"
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class IProcess;
+class State;
+
+namespace BacktracePlugin {
+
+// the call frame information (.eh_frame, located through .eh_frame_hdr) of
+// the modules of a process, and where its code is. Only load() reads from the
+// process, so once the modules needed are loaded, any number of threads can
+// unwind against the same tables
+class UnwindTables {
+public:
+	enum {
+		MaxRegisters = 17
+	};
+
+	struct Segment {
+		quint64    address;
+		QByteArray data;
+	};
+
+	struct Module {
+		QString          name;
+		quint64          hdr = 0; // the base of datarel encoded pointers
+		QVector<Segment> segments;
+
+		// the address of every FDE, by the address of the code it describes
+		QMap<quint64, quint64> fdes;
+	};
+
+public:
+	explicit UnwindTables(const IProcess *process);
+
+public:
+	std::shared_ptr<const Module> find(quint64 address, quint64 *missing) const;
+	bool is_code(quint64 address) const;
+	void load(quint64 base);
+
+private:
+	struct Region {
+		quint64 start;
+		quint64 end;
+		quint64 base; // the start of the first region of the same file
+		QString name;
+	};
+
+private:
+	const Region *region(quint64 address) const;
+
+private:
+	const IProcess *process_;
+	QVector<Region> regions_;
+	int             pointer_size_;
+};
+
+// walks the stack of one thread using the call frame information of its code,
+// and only guesses, by following the frame pointer or scanning for return
+// addresses, where there is none. run() works on a copy of the stack and
+// nothing else, it stops whenever it needs the process for something, and
+// picks up where it left off when called again after that
+class Unwinder {
+public:
+	enum Status {
+		Unwinding,
+		NeedsModule, // the one of needed_module() has to be loaded
+		NeedsScan,   // scan() has to finish the job
+		Done
+	};
+
+public:
+	explicit Unwinder(const State &state, int max_frames = 1024);
+
+public:
+	// the stack which run() works with, from the stack pointer on
+	quint64 stack_pointer() const;
+	quint64 stack_size() const;
+	void set_stack(const QByteArray &stack);
+
+	void run(const UnwindTables &tables);
+	void scan(const IProcess *process, const UnwindTables &tables);
+
+	Status status() const          { return status_; }
+	quint64 needed_module() const  { return needed_module_; }
+
+	// the return address of each frame, innermost first
+	const QVector<edb::address_t> &return_addresses() const { return addresses_; }
+
+public:
+	// all of the above for the current thread, in one go
+	static QVector<edb::address_t> unwind(const IProcess *process, const State &state);
+
+	// is the instruction just before <address> a call, and where is it
+	static bool call_before(const IProcess *process, edb::address_t address, edb::address_t *caller, edb::address_t *target = nullptr);
+
+private:
+	struct Frame {
+		quint64 pc;
+		quint64 regs[UnwindTables::MaxRegisters];
+		bool    valid[UnwindTables::MaxRegisters];
+		bool    exact_pc; // it is not a return address, the code was interrupted
+	};
+
+	enum StepResult {
+		Failed,
+		Stepped,
+		Outermost,
+		Missing
+	};
+
+private:
+	StepResult step_cfi(const UnwindTables &tables, Frame *frame);
+	bool step_frame_pointer(Frame *frame) const;
+	bool read_pointer(quint64 address, quint64 *value) const;
+
+private:
+	Frame                   frame_;
+	quint64                 stack_start_   = 0;
+	QByteArray              stack_;
+	QVector<edb::address_t> addresses_;
+	Status                  status_        = Unwinding;
+	quint64                 needed_module_ = 0;
+	quint64                 scan_from_     = 0;
+	int                     max_frames_;
+	int                     pointer_size_;
+	int                     register_count_;
+	int                     sp_register_;
+	int                     fp_register_;
+};
+
+}
+
+#endif
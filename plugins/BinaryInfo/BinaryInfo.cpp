@@ -17,9 +17,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "BinaryInfo.h"
+#include "Configuration.h"
+#include "DebugInfoIndex.h"
 #include "DialogHeader.h"
 #include "ELFXX.h"
 #include "IBinary.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
 #include "ISymbolManager.h"
 #include "PE32.h"
 #include "edb.h"
@@ -28,18 +33,42 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDebug>
 #include <QMenu>
+#include <QSettings>
 
-#include <fstream>
 #include <memory>
 
 namespace BinaryInfoPlugin {
 namespace {
 
+//------------------------------------------------------------------------------
+// Name: read_magic
+// Desc: the first <size> bytes of <region>, so that a parser is only built
+//       for regions which look like its format
+//------------------------------------------------------------------------------
+bool read_magic(const std::shared_ptr<IRegion> &region, void *magic, std::size_t size) {
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	return region && process && process->read_bytes(region->start(), magic, size);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_elf
+// Desc:
+//------------------------------------------------------------------------------
+bool is_elf(const std::shared_ptr<IRegion> &region, quint8 elf_class) {
+	quint8 ident[EI_CLASS + 1];
+	return read_magic(region, ident, sizeof(ident))
+		&& ident[0] == ELFMAG0 && ident[1] == ELFMAG1 && ident[2] == ELFMAG2 && ident[3] == ELFMAG3
+		&& ident[EI_CLASS] == elf_class;
+}
+
 //------------------------------------------------------------------------------
 // Name: create_binary_info_elf32
 // Desc:
 //------------------------------------------------------------------------------
 std::unique_ptr<IBinary> create_binary_info_elf32(const std::shared_ptr<IRegion> &region) {
+	if(!is_elf(region, elf32_header::ELFCLASS)) {
+		return nullptr;
+	}
 	return std::unique_ptr<IBinary>(new ELF32(region));
 }
 
@@ -48,6 +77,9 @@ std::unique_ptr<IBinary> create_binary_info_elf32(const std::shared_ptr<IRegion>
 // Desc:
 //------------------------------------------------------------------------------
 std::unique_ptr<IBinary> create_binary_info_elf64(const std::shared_ptr<IRegion> &region) {
+	if(!is_elf(region, elf64_header::ELFCLASS)) {
+		return nullptr;
+	}
 	return std::unique_ptr<IBinary>(new ELF64(region));
 }
 
@@ -56,6 +88,10 @@ std::unique_ptr<IBinary> create_binary_info_elf64(const std::shared_ptr<IRegion>
 // Desc:
 //------------------------------------------------------------------------------
 std::unique_ptr<IBinary> create_binary_info_pe32(const std::shared_ptr<IRegion> &region) {
+	char magic[2];
+	if(!read_magic(region, magic, sizeof(magic)) || magic[0] != 'M' || magic[1] != 'Z') {
+		return nullptr;
+	}
 	return std::unique_ptr<IBinary>(new PE32(region));
 }
 
@@ -68,6 +104,12 @@ std::unique_ptr<IBinary> create_binary_info_pe32(const std::shared_ptr<IRegion>
 BinaryInfo::BinaryInfo() : menu_(0) {
 }
 
+//------------------------------------------------------------------------------
+// Name: ~BinaryInfo
+// Desc:
+//------------------------------------------------------------------------------
+BinaryInfo::~BinaryInfo() = default;
+
 //------------------------------------------------------------------------------
 // Name: private_init
 // Desc:
@@ -77,6 +119,11 @@ void BinaryInfo::private_init() {
 	edb::v1::register_binary_info(create_binary_info_elf64);
 	edb::v1::register_binary_info(create_binary_info_pe32);
 	edb::v1::symbol_manager().set_symbol_generator(this);
+
+	// the index is kept with the symbol files, which are just as specific to
+	// this machine
+	debug_index_.reset(new DebugInfoIndex(QString("%1/debug-info.index").arg(edb::v1::config().symbol_path)));
+	debug_index_->scan(QSettings().value("BinaryInfo/debug_info_path", "/usr/lib/debug").toString());
 }
 
 QWidget* BinaryInfo::options_page() {
@@ -135,15 +182,7 @@ IPlugin::ArgumentStatus BinaryInfo::parse_arguments(QStringList &args) {
 // Desc:
 //------------------------------------------------------------------------------
 bool BinaryInfo::generate_symbol_file(const QString &filename, const QString &symbol_file) {
-
-	std::ofstream file(qPrintable(symbol_file));
-	if(file) {
-		if(generate_symbols(filename, file)) {
-			return true;
-		}
-	}
-
-	return false;
+	return generate_symbol_cache(filename, symbol_file, debug_index_.get());
 }
 
 #if QT_VERSION < 0x050000
@@ -23,10 +23,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ISymbolGenerator.h"
 #include "Types.h"
 
+#include <memory>
+
 class QMenu;
 
 namespace BinaryInfoPlugin {
 
+class DebugInfoIndex;
+
 class BinaryInfo : public QObject, public IPlugin, public ISymbolGenerator {
 	Q_OBJECT
 	Q_INTERFACES(IPlugin)
@@ -38,6 +42,7 @@ class BinaryInfo : public QObject, public IPlugin, public ISymbolGenerator {
 
 public:
 	BinaryInfo();
+	virtual ~BinaryInfo() override;
 
 private:
 	virtual void private_init() override;
@@ -55,7 +60,8 @@ public Q_SLOTS:
 	void explore_header();
 
 private:
-	QMenu *menu_;
+	QMenu                          *menu_;
+	std::unique_ptr<DebugInfoIndex> debug_index_;
 };
 
 }
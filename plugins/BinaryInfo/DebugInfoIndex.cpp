@@ -0,0 +1,435 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DebugInfoIndex.h"
+#include "edb.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QObject>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "elf/elf_types.h"
+#include "elf/elf_header.h"
+#include "elf/elf_nhdr.h"
+#include "elf/elf_shdr.h"
+
+namespace BinaryInfoPlugin {
+namespace {
+
+const quint32 INDEX_MAGIC   = 0x45444249; // "EDBI"
+const quint32 INDEX_VERSION = 1;
+
+// the CRC of a big debug file is worked out in pieces, so that a cancelled
+// scan doesn't have to finish it first
+const std::size_t CRC_CHUNK_SIZE = 16 * 1024 * 1024;
+
+//------------------------------------------------------------------------------
+// Name: in_file
+// Desc: true if [offset, offset + length) lies within a file of <size> bytes
+//------------------------------------------------------------------------------
+bool in_file(quint64 offset, quint64 length, std::size_t size) {
+	return offset <= size && length <= size - offset;
+}
+
+//------------------------------------------------------------------------------
+// Name: align4
+// Desc:
+//------------------------------------------------------------------------------
+std::size_t align4(std::size_t n) {
+	return (n + 3) & ~std::size_t(3);
+}
+
+//------------------------------------------------------------------------------
+// Name: note_build_id
+// Desc: the descriptor of the GNU build-id note in the note section [p, p + size)
+//------------------------------------------------------------------------------
+QByteArray note_build_id(const uchar *p, std::size_t size) {
+
+	// the note header is three words in both ELF classes
+	while(size >= sizeof(elf32_nhdr)) {
+		const auto note = reinterpret_cast<const elf32_nhdr *>(p);
+		const std::size_t name_size = align4(note->n_namesz);
+		const std::size_t desc_size = align4(note->n_descsz);
+
+		size -= sizeof(elf32_nhdr);
+		p    += sizeof(elf32_nhdr);
+		if(name_size > size || desc_size > size - name_size) {
+			break;
+		}
+
+		if(note->n_type == NT_GNU_BUILD_ID && note->n_namesz == sizeof(ELF_NOTE_GNU) && std::memcmp(p, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)) == 0) {
+			return QByteArray(reinterpret_cast<const char *>(p + name_size), note->n_descsz);
+		}
+
+		size -= name_size + desc_size;
+		p    += name_size + desc_size;
+	}
+
+	return QByteArray();
+}
+
+//------------------------------------------------------------------------------
+// Name: identify_elf
+// Desc: reads the build-id and the debug link out of the section headers, the
+//       file may be anything so every offset is checked against its size
+//------------------------------------------------------------------------------
+template <class Header, class Section>
+DebugInfoIndex::Identity identify_elf(const uchar *image, std::size_t size) {
+
+	DebugInfoIndex::Identity identity;
+
+	if(size < sizeof(Header)) {
+		return identity;
+	}
+
+	const auto header = reinterpret_cast<const Header *>(image);
+	if(header->e_shoff == 0 || header->e_shentsize != sizeof(Section) || header->e_shstrndx >= header->e_shnum) {
+		return identity;
+	}
+
+	if(!in_file(header->e_shoff, quint64(header->e_shnum) * sizeof(Section), size)) {
+		return identity;
+	}
+
+	const auto sections = reinterpret_cast<const Section *>(image + header->e_shoff);
+	const Section &names = sections[header->e_shstrndx];
+	if(!in_file(names.sh_offset, names.sh_size, size)) {
+		return identity;
+	}
+
+	for(int i = 0; i < header->e_shnum; ++i) {
+		const Section &section = sections[i];
+		if(section.sh_type == SHT_NOBITS || !in_file(section.sh_offset, section.sh_size, size)) {
+			continue;
+		}
+
+		const uchar *const data = image + section.sh_offset;
+
+		if(section.sh_type == SHT_NOTE) {
+			if(identity.build_id.isEmpty()) {
+				identity.build_id = note_build_id(data, section.sh_size);
+			}
+			continue;
+		}
+
+		if(section.sh_name >= names.sh_size) {
+			continue;
+		}
+
+		const auto name = reinterpret_cast<const char *>(image + names.sh_offset + section.sh_name);
+		if(qstrncmp(name, ".gnu_debuglink", names.sh_size - section.sh_name) != 0) {
+			continue;
+		}
+
+		// the file name, padded to four bytes, then its CRC
+		const auto link  = reinterpret_cast<const char *>(data);
+		const uint length = qstrnlen(link, section.sh_size);
+		if(length != 0 && align4(length + 1) + sizeof(quint32) <= section.sh_size) {
+			identity.debug_link = QString::fromLocal8Bit(link, length);
+			std::memcpy(&identity.debug_link_crc, data + align4(length + 1), sizeof(quint32));
+		}
+	}
+
+	return identity;
+}
+
+//------------------------------------------------------------------------------
+// Name: link_key
+// Desc:
+//------------------------------------------------------------------------------
+QString link_key(const QString &name, quint32 crc) {
+	return QString("%1/%2").arg(name).arg(crc, 8, 16, QChar('0'));
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DebugInfoIndex
+// Desc: starts out with what the last session found, <index_file> is where it
+//       was kept
+//------------------------------------------------------------------------------
+DebugInfoIndex::DebugInfoIndex(const QString &index_file) : index_file_(index_file) {
+	load();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DebugInfoIndex
+// Desc:
+//------------------------------------------------------------------------------
+DebugInfoIndex::~DebugInfoIndex() {
+	token_.cancel();
+	future_.waitForFinished();
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: brings the index up to date with <directory> in the background, lookups
+//       are answered from what is known so far in the meantime
+//------------------------------------------------------------------------------
+void DebugInfoIndex::scan(const QString &directory) {
+
+	if(directory.isEmpty() || future_.isRunning()) {
+		return;
+	}
+
+	future_ = edb::v1::task_scheduler().run("DebugInfoIndex::scan", TaskScheduler::Background, QObject::tr("Indexing debug info"), [this, directory](const TaskToken &token) {
+		scan_directory(directory, token);
+	}, &token_);
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: the debug file which goes with <identity>, or an empty string
+//------------------------------------------------------------------------------
+QString DebugInfoIndex::find(const Identity &identity) const {
+
+	QString path;
+	{
+		QMutexLocker locker(&mutex_);
+		if(!identity.build_id.isEmpty()) {
+			path = by_build_id_.value(identity.build_id);
+		}
+
+		if(path.isEmpty() && !identity.debug_link.isEmpty()) {
+			path = by_link_.value(link_key(identity.debug_link, identity.debug_link_crc));
+		}
+	}
+
+	// the index may be from before the file was removed
+	if(!path.isEmpty() && !QFile::exists(path)) {
+		return QString();
+	}
+
+	return path;
+}
+
+//------------------------------------------------------------------------------
+// Name: identify
+// Desc: an empty identity for anything which isn't an ELF file
+//------------------------------------------------------------------------------
+DebugInfoIndex::Identity DebugInfoIndex::identify(const uchar *image, std::size_t size) {
+
+	if(size > EI_CLASS && std::memcmp(image, ELFMAG, SELFMAG) == 0) {
+		switch(image[EI_CLASS]) {
+		case ELFCLASS32:
+			return identify_elf<elf32_header, elf32_shdr>(image, size);
+		case ELFCLASS64:
+			return identify_elf<elf64_header, elf64_shdr>(image, size);
+		}
+	}
+
+	return Identity();
+}
+
+//------------------------------------------------------------------------------
+// Name: crc32
+// Desc: the CRC which .gnu_debuglink carries, continuing from <crc> so that a
+//       file can be done in pieces
+//------------------------------------------------------------------------------
+quint32 DebugInfoIndex::crc32(const uchar *p, std::size_t size, quint32 crc) {
+
+	static const std::vector<quint32> table = [] {
+		std::vector<quint32> t(256);
+		for(quint32 i = 0; i < 256; ++i) {
+			quint32 c = i;
+			for(int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+
+	crc = ~crc;
+	for(std::size_t i = 0; i < size; ++i) {
+		crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: a missing or unreadable index just means everything gets read again
+//------------------------------------------------------------------------------
+void DebugInfoIndex::load() {
+
+	QFile file(index_file_);
+	if(!file.open(QIODevice::ReadOnly)) {
+		return;
+	}
+
+	QDataStream stream(&file);
+
+	quint32 magic;
+	quint32 version;
+	quint32 count;
+	stream >> magic >> version >> count;
+	if(stream.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION) {
+		return;
+	}
+
+	QMutexLocker locker(&mutex_);
+	for(quint32 i = 0; i < count; ++i) {
+		Entry entry;
+		stream >> entry.path >> entry.size >> entry.mtime >> entry.build_id >> entry.crc;
+		if(stream.status() != QDataStream::Ok) {
+			break;
+		}
+		insert(entry);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: save
+// Desc: replaces the index file, so that a crash can't leave half of one
+//------------------------------------------------------------------------------
+void DebugInfoIndex::save(const QList<Entry> &entries) const {
+
+	if(index_file_.isEmpty()) {
+		return;
+	}
+
+	const QString temp_file = index_file_ + ".tmp";
+
+	{
+		QFile file(temp_file);
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			qDebug() << "[BinaryInfo] could not write" << temp_file << file.errorString();
+			return;
+		}
+
+		QDataStream stream(&file);
+		stream << INDEX_MAGIC << INDEX_VERSION << quint32(entries.size());
+		for(const Entry &entry : entries) {
+			stream << entry.path << entry.size << entry.mtime << entry.build_id << entry.crc;
+		}
+
+		if(stream.status() != QDataStream::Ok) {
+			file.remove();
+			return;
+		}
+	}
+
+	QFile::remove(index_file_);
+	if(!QFile::rename(temp_file, index_file_)) {
+		QFile::remove(temp_file);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: scan_directory
+// Desc: files whose size and time are what the index has are taken as they
+//       are, anything else is identified and has its CRC worked out; stops
+//       early, keeping nothing new, if <token> is cancelled
+//------------------------------------------------------------------------------
+void DebugInfoIndex::scan_directory(const QString &directory, const TaskToken &token) {
+
+	QHash<QString, Entry> previous;
+	{
+		QMutexLocker locker(&mutex_);
+		previous = entries_;
+	}
+
+	QList<Entry> found;
+
+	// .build-id is all symlinks to the files which are scanned anyway
+	QDirIterator it(directory, QDir::Files | QDir::Readable | QDir::NoSymLinks, QDirIterator::Subdirectories);
+	while(it.hasNext() && !token.cancelled()) {
+
+		Entry entry;
+		entry.path  = it.next();
+		entry.size  = it.fileInfo().size();
+		entry.mtime = it.fileInfo().lastModified().toTime_t();
+
+		auto known = previous.find(entry.path);
+		if(known != previous.end() && known->size == entry.size && known->mtime == entry.mtime) {
+			found.push_back(*known);
+			continue;
+		}
+
+		QFile file(entry.path);
+		if(entry.size > 0 && file.open(QIODevice::ReadOnly)) {
+			if(uchar *image = file.map(0, entry.size)) {
+				const std::size_t size = static_cast<std::size_t>(entry.size);
+
+				if(size > SELFMAG && std::memcmp(image, ELFMAG, SELFMAG) == 0) {
+					entry.build_id = identify(image, size).build_id;
+
+					quint32 crc = 0;
+					for(std::size_t offset = 0; offset < size && !token.cancelled(); offset += CRC_CHUNK_SIZE) {
+						crc = crc32(image + offset, std::min(CRC_CHUNK_SIZE, size - offset), crc);
+					}
+					entry.crc = crc;
+				}
+
+				file.unmap(image);
+			}
+		}
+
+		// files which aren't debug info are kept too, so they aren't read again
+		QMutexLocker locker(&mutex_);
+		insert(entry);
+		found.push_back(entry);
+	}
+
+	// a partial scan would forget the files it didn't get to
+	if(token.cancelled()) {
+		return;
+	}
+
+	{
+		QMutexLocker locker(&mutex_);
+		entries_.clear();
+		by_build_id_.clear();
+		by_link_.clear();
+		for(const Entry &entry : found) {
+			insert(entry);
+		}
+	}
+
+	save(found);
+	qDebug("[BinaryInfo] indexed %d debug files in %s", found.size(), qPrintable(directory));
+}
+
+//------------------------------------------------------------------------------
+// Name: insert
+// Desc: the caller holds mutex_
+//------------------------------------------------------------------------------
+void DebugInfoIndex::insert(const Entry &entry) {
+
+	entries_.insert(entry.path, entry);
+
+	if(!entry.build_id.isEmpty()) {
+		by_build_id_.insert(entry.build_id, entry.path);
+	}
+
+	if(entry.crc != 0) {
+		by_link_.insert(link_key(QFileInfo(entry.path).fileName(), entry.crc), entry.path);
+	}
+}
+
+}
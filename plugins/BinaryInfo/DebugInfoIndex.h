@@ -0,0 +1,87 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEBUG_INFO_INDEX_20170716_H_
+#define DEBUG_INFO_INDEX_20170716_H_
+
+#include "TaskScheduler.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <cstddef>
+
+namespace BinaryInfoPlugin {
+
+// Where the separate debug info of a module is, by the build-id note or the
+// .gnu_debuglink name and CRC the module carries. The debug directory is
+// scanned once a session in the background, what was learnt about each file is
+// kept next to the symbol files so that only new or changed ones are read again
+class DebugInfoIndex {
+public:
+	// what a module or a debug file says about itself
+	struct Identity {
+		QByteArray build_id;
+		QString    debug_link;
+		quint32    debug_link_crc = 0;
+	};
+
+public:
+	explicit DebugInfoIndex(const QString &index_file);
+	~DebugInfoIndex();
+	DebugInfoIndex(const DebugInfoIndex &) = delete;
+	DebugInfoIndex &operator=(const DebugInfoIndex &) = delete;
+
+public:
+	void scan(const QString &directory);
+	QString find(const Identity &identity) const;
+
+public:
+	static Identity identify(const uchar *image, std::size_t size);
+	static quint32 crc32(const uchar *p, std::size_t size, quint32 crc = 0);
+
+private:
+	struct Entry {
+		QString    path;
+		qint64     size  = 0;
+		qint64     mtime = 0;
+		QByteArray build_id;
+		quint32    crc   = 0;
+	};
+
+private:
+	void load();
+	void save(const QList<Entry> &entries) const;
+	void scan_directory(const QString &directory, const TaskToken &token);
+	void insert(const Entry &entry);
+
+private:
+	QString                      index_file_;
+	mutable QMutex               mutex_;
+	QHash<QString, Entry>        entries_;   // by path
+	QHash<QByteArray, QString>   by_build_id_;
+	QHash<QString, QString>      by_link_;   // by "name/crc"
+	QFuture<void>                future_;
+	TaskToken                    token_;    // of the scan, cancelled when the index goes
+};
+
+}
+
+#endif
@@ -460,6 +460,71 @@ QTreeWidgetItem *create_elf_entry_point(const T *header) {
 	return item;
 }
 
+template <class T>
+QTreeWidgetItem *create_elf_segments(const ElfFile<T> &file) {
+
+	auto item = new QTreeWidgetItem;
+
+	item->setText(0, QT_TRANSLATE_NOOP("BinaryInfo", "Segments"));
+	item->setText(1, QString::number(file.program_header_count()));
+
+	if(auto phdrs = file.program_headers()) {
+		for(int i = 0; i < file.program_header_count(); ++i) {
+			auto segment = new QTreeWidgetItem;
+			segment->setText(0, QString("[%1] type 0x%2").arg(i).arg(phdrs[i].p_type, 0, 16));
+			segment->setText(1, QString("vaddr 0x%1, memsz 0x%2, offset 0x%3, filesz 0x%4, flags %5%6%7")
+				.arg(phdrs[i].p_vaddr, 0, 16)
+				.arg(phdrs[i].p_memsz, 0, 16)
+				.arg(phdrs[i].p_offset, 0, 16)
+				.arg(phdrs[i].p_filesz, 0, 16)
+				.arg((phdrs[i].p_flags & PF_R) ? 'r' : '-')
+				.arg((phdrs[i].p_flags & PF_W) ? 'w' : '-')
+				.arg((phdrs[i].p_flags & PF_X) ? 'x' : '-'));
+			item->addChild(segment);
+		}
+	}
+
+	return item;
+}
+
+template <class T>
+QTreeWidgetItem *create_elf_sections(const ElfFile<T> &file) {
+
+	auto item = new QTreeWidgetItem;
+
+	item->setText(0, QT_TRANSLATE_NOOP("BinaryInfo", "Sections"));
+	item->setText(1, QString::number(file.section_count()));
+
+	if(auto sections = file.sections()) {
+		for(int i = 0; i < file.section_count(); ++i) {
+			const char *const name = file.section_name(&sections[i]);
+
+			auto section = new QTreeWidgetItem;
+			section->setText(0, QString("[%1] %2").arg(i).arg(QString::fromLatin1(name ? name : "")));
+			section->setText(1, QString("addr 0x%1, size 0x%2, offset 0x%3, type 0x%4")
+				.arg(sections[i].sh_addr, 0, 16)
+				.arg(sections[i].sh_size, 0, 16)
+				.arg(sections[i].sh_offset, 0, 16)
+				.arg(sections[i].sh_type, 0, 16));
+			item->addChild(section);
+		}
+	}
+
+	return item;
+}
+
+//------------------------------------------------------------------------------
+// Name: add_elf_file
+// Desc: the parts of the binary only the file on disk has, if it was found
+//------------------------------------------------------------------------------
+template <class T>
+void add_elf_file(QTreeWidgetItem *root, const std::shared_ptr<ElfFile<T>> &file) {
+	if(file) {
+		root->addChild(create_elf_segments(*file));
+		root->addChild(create_elf_sections(*file));
+	}
+}
+
 
 #if 0
 	elf32_off  e_phoff;     /* Program header table file offset */
@@ -509,6 +574,9 @@ void DialogHeader::showEvent(QShowEvent *) {
 	filter_model_->setFilterKeyColumn(3);
 	filter_model_->setSourceModel(&edb::v1::memory_regions());
 	ui->tableView->setModel(filter_model_);
+	for(int column = MemoryRegions::FirstUsageColumn; column < filter_model_->columnCount(); ++column) {
+		ui->tableView->hideColumn(column);
+	}
 	ui->treeWidget->clear();
 }
 
@@ -553,6 +621,7 @@ void DialogHeader::on_btnExplore_clicked() {
 						root->addChild(create_elf_machine(header));
 						root->addChild(create_elf_object_version(header));
 						root->addChild(create_elf_entry_point(header));
+						add_elf_file(root, elf32->file());
 
 						ui->treeWidget->insertTopLevelItem(0, root);
 					}
@@ -574,6 +643,7 @@ void DialogHeader::on_btnExplore_clicked() {
 						root->addChild(create_elf_machine(header));
 						root->addChild(create_elf_object_version(header));
 						root->addChild(create_elf_entry_point(header));
+						add_elf_file(root, elf64->file());
 
 						ui->treeWidget->insertTopLevelItem(0, root);
 					}
@@ -30,8 +30,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QVector>
 #include <QFile>
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
+#include <iterator>
 
 namespace BinaryInfoPlugin {
 
@@ -67,6 +69,20 @@ public:
 	}
 };
 
+namespace {
+
+// both x86 classes have 16 byte PLT stubs
+const int PLT_ENTRY_SIZE = 0x10;
+
+// the symbol and the type a relocation's r_info holds, which each class
+// packs differently
+quint64 relocation_symbol(elf32_word info)  { return ELF32_R_SYM(info); }
+quint64 relocation_symbol(elf64_xword info) { return ELF64_R_SYM(info); }
+quint32 relocation_type(elf32_word info)    { return ELF32_R_TYPE(info); }
+quint32 relocation_type(elf64_xword info)   { return ELF64_R_TYPE(info); }
+
+}
+
 template <class elfxx_header>
 ELFXX<elfxx_header>::ELFXX(const std::shared_ptr<IRegion> &region) : region_(region) {
 
@@ -90,6 +106,14 @@ ELFXX<elfxx_header>::ELFXX(const std::shared_ptr<IRegion> &region) : region_(reg
 	headers_.push_back({region_->start(), header_.e_ehsize});
 	headers_.push_back({region_->start() + header_.e_phoff, static_cast<size_t>(header_.e_phentsize * header_.e_phnum) });
 
+	// the file has the same headers without asking the process for them, and
+	// the sections and symbols the process doesn't have at all
+	if(auto file = ElfFile<elfxx_header>::open(region_->name())) {
+		if(std::memcmp(file->header(), &header_, sizeof(elfxx_header)) == 0) {
+			file_ = file;
+		}
+	}
+
 	auto phdr_size = header_.e_phentsize;
 
 	if (phdr_size < sizeof(phdr_type)) {
@@ -98,20 +122,30 @@ ELFXX<elfxx_header>::ELFXX(const std::shared_ptr<IRegion> &region) : region_(reg
 		return;
 	}
 
-	phdr_type phdr;
-
-	auto phdr_base = region_->start() + header_.e_phoff;
-	edb::address_t lowest = ULLONG_MAX;
-
-	// iterate all of the program headers
-	for (quint16 entry = 0; entry < header_.e_phnum; entry++) {
-	
-		if (!process->read_bytes(phdr_base + (phdr_size * entry), &phdr, sizeof(phdr_type))) {
+	QVector<phdr_type> phdrs;
+	if(file_ && file_->program_headers()) {
+		const phdr_type *const first = file_->program_headers();
+		std::copy(first, first + file_->program_header_count(), std::back_inserter(phdrs));
+	} else {
+		// the whole table at once, it is usually on the page we just read from
+		QVector<quint8> table(phdr_size * header_.e_phnum);
+		if (!table.isEmpty() && !process->read_bytes(region_->start() + header_.e_phoff, table.data(), table.size())) {
 			qDebug() << "Failed to read program header";
 			base_address_ = region_->start();
 			return;
 		}
 
+		for (quint16 entry = 0; entry < header_.e_phnum; entry++) {
+			phdr_type phdr;
+			std::memcpy(&phdr, table.constData() + (phdr_size * entry), sizeof(phdr_type));
+			phdrs.push_back(phdr);
+		}
+	}
+
+	edb::address_t lowest = ULLONG_MAX;
+
+	// iterate all of the program headers
+	for (const phdr_type &phdr : phdrs) {
 		if (phdr.p_type == PT_LOAD && phdr.p_vaddr < lowest) {
 			lowest = phdr.p_vaddr;
 		}
@@ -199,6 +233,140 @@ const void *ELFXX<elfxx_header>::header() const {
 	return &header_;
 }
 
+//------------------------------------------------------------------------------
+// Name: function_entries
+// Desc: the functions the file has symbols for, where they are in the process
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+QVector<edb::address_t> ELFXX<elfxx_header>::function_entries() const {
+	QVector<edb::address_t> results;
+	if(file_) {
+		for(const typename ElfFile<elfxx_header>::Symbol &symbol : file_->symbols()) {
+			if(symbol.function) {
+				results.push_back(symbol.address + region_->start() - base_address_);
+			}
+		}
+	}
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: imports
+// Desc: the symbols the jump slots and GOT entries of the file are resolved
+//       to, where their stubs and slots are in the process
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+QVector<IBinary::Import> ELFXX<elfxx_header>::imports() const {
+
+	using shdr_type = typename elfxx_header::elf_shdr;
+
+	QVector<Import> results;
+
+	// the stubs are only laid out this way on x86
+	if(!file_ || (header_.e_machine != EM_386 && header_.e_machine != EM_X86_64)) {
+		return results;
+	}
+
+	// with IBT calls go through the stubs in .plt.sec, one for each jump
+	// slot. Otherwise they come after the first entry of .plt
+	edb::address_t plt(0);
+	if(const shdr_type *const section = file_->find_section(".plt.sec")) {
+		plt = section->sh_addr + region_->start() - base_address_;
+	} else if(const shdr_type *const section = file_->find_section(".plt")) {
+		plt = section->sh_addr + PLT_ENTRY_SIZE + region_->start() - base_address_;
+	}
+
+	for(int i = 0; i < file_->section_count(); ++i) {
+		const shdr_type *const section = file_->section(i);
+		if(!section || section->sh_link == 0) {
+			continue;
+		}
+
+		const char *const name = file_->section_name(section);
+		if(!name) {
+			continue;
+		}
+
+		edb::address_t stubs(0);
+		if(std::strcmp(name, ".rela.plt") == 0 || std::strcmp(name, ".rel.plt") == 0) {
+			stubs = plt;
+		} else if(std::strcmp(name, ".rela.dyn") != 0 && std::strcmp(name, ".rel.dyn") != 0) {
+			continue;
+		}
+
+		switch(section->sh_type) {
+		case SHT_RELA:
+			add_imports<typename elfxx_header::elf_rela>(section, stubs, &results);
+			break;
+		case SHT_REL:
+			add_imports<typename elfxx_header::elf_rel>(section, stubs, &results);
+			break;
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: add_imports
+// Desc: adds the jump slots and GOT entries <section> relocates. If <plt> is
+//       set they are jump slots, each with the next stub from there on
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+template <class relocation_t>
+void ELFXX<elfxx_header>::add_imports(const typename elfxx_header::elf_shdr *section, edb::address_t plt, QVector<Import> *results) const {
+
+	using shdr_type = typename elfxx_header::elf_shdr;
+	using sym_type  = typename elfxx_header::elf_sym;
+
+	const shdr_type *const symbols = file_->section(section->sh_link);
+	if(!symbols) {
+		return;
+	}
+
+	const shdr_type *const strings = file_->section(symbols->sh_link);
+
+	int symbol_count;
+	const sym_type *const symbol_table = file_->template section_data<sym_type>(symbols, &symbol_count);
+
+	int count;
+	const relocation_t *const relocations = file_->template section_data<relocation_t>(section, &count);
+
+	if(!symbol_table || !relocations) {
+		return;
+	}
+
+	const bool x86_64       = header_.e_machine == EM_X86_64;
+	const quint32 jump_slot = x86_64 ? R_X86_64_JUMP_SLOT : R_386_JMP_SLOT;
+	const quint32 glob_dat  = x86_64 ? R_X86_64_GLOB_DAT  : R_386_GLOB_DAT;
+
+	for(int i = 0; i < count; ++i) {
+		const relocation_t &relocation = relocations[i];
+
+		// every relocation of .rel[a].plt has a stub, whatever its type
+		edb::address_t stub(0);
+		if(plt) {
+			stub = plt + i * PLT_ENTRY_SIZE;
+		}
+
+		const quint32 type = relocation_type(relocation.r_info);
+		if(type != jump_slot && type != glob_dat) {
+			continue;
+		}
+
+		const quint64 index = relocation_symbol(relocation.r_info);
+		if(index == 0 || index >= static_cast<quint64>(symbol_count)) {
+			continue;
+		}
+
+		const char *const name = file_->string(strings, symbol_table[index].st_name);
+		if(!name || !*name) {
+			continue;
+		}
+
+		results->push_back(Import{stub, relocation.r_offset + region_->start() - base_address_, QString::fromLatin1(name)});
+	}
+}
 
 // explicit instantiations
 template class ELFXX<elf32_header>;
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "IBinary.h"
 #include "elf_binary.h"
+#include "ElfFile.h"
 
 namespace BinaryInfoPlugin {
 
@@ -38,15 +39,26 @@ public:
 	virtual const void *header() const;
 	virtual QVector<Header> headers() const;
 	virtual edb::address_t base_address() const;
+	virtual QVector<edb::address_t> function_entries() const;
+	virtual QVector<Import> imports() const;
+
+public:
+	// the file the region was loaded from, nullptr if it can't be found or
+	// no longer matches what is in the process
+	std::shared_ptr<ElfFile<elfxx_header>> file() const { return file_; }
 
 private:
 	void validate_header();
 
+	template <class relocation_type>
+	void add_imports(const typename elfxx_header::elf_shdr *section, edb::address_t plt, QVector<Import> *results) const;
+
 private:
 	std::shared_ptr<IRegion> region_;
 	elfxx_header             header_;
 	edb::address_t           base_address_;
 	QVector<Header>          headers_;
+	std::shared_ptr<ElfFile<elfxx_header>> file_;
 };
 
 typedef ELFXX<elf32_header> ELF32;
@@ -0,0 +1,299 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ElfFile.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+
+namespace BinaryInfoPlugin {
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: the mapping of <filename>, shared with whoever else has it open, or
+//       nullptr if it can't be mapped or isn't this class of ELF. A file which
+//       changed on disk since it was mapped gets a new mapping
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+std::shared_ptr<ElfFile<elfxx_header>> ElfFile<elfxx_header>::open(const QString &filename) {
+
+	struct Entry {
+		QDateTime               modified;
+		qint64                  size;
+		std::weak_ptr<ElfFile> file;
+	};
+
+	static QMutex               cache_mutex;
+	static QHash<QString, Entry> cache;
+
+	const QFileInfo info(filename);
+	if(!info.isFile()) {
+		return nullptr;
+	}
+
+	const QString path = info.canonicalFilePath();
+
+	QMutexLocker locker(&cache_mutex);
+
+	auto it = cache.find(path);
+	if(it != cache.end() && it->modified == info.lastModified() && it->size == info.size()) {
+		if(std::shared_ptr<ElfFile> file = it->file.lock()) {
+			return file;
+		}
+	}
+
+	auto file = std::make_shared<ElfFile>(path);
+	if(!file->valid()) {
+		cache.remove(path);
+		return nullptr;
+	}
+
+	cache.insert(path, Entry{info.lastModified(), info.size(), file});
+	return file;
+}
+
+//------------------------------------------------------------------------------
+// Name: ElfFile
+// Desc: maps <filename>, only the ELF header is looked at up front
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+ElfFile<elfxx_header>::ElfFile(const QString &filename) : file_(filename) {
+
+	if(!file_.open(QIODevice::ReadOnly) || file_.size() < static_cast<qint64>(sizeof(elfxx_header))) {
+		return;
+	}
+
+	if(uchar *p = file_.map(0, file_.size())) {
+		data_ = p;
+		size_ = static_cast<std::size_t>(file_.size());
+
+		auto header = reinterpret_cast<const elfxx_header *>(data_);
+		if(std::memcmp(header->e_ident, ELFMAG, SELFMAG) == 0 && header->e_ident[EI_CLASS] == elfxx_header::ELFCLASS) {
+			header_ = header;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: program_headers
+// Desc: the segment table, or nullptr if the file doesn't have a whole one
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+auto ElfFile<elfxx_header>::program_headers() const -> const phdr_type * {
+	if(!header_ || header_->e_phentsize != sizeof(phdr_type)) {
+		return nullptr;
+	}
+	return at<phdr_type>(header_->e_phoff, header_->e_phnum);
+}
+
+//------------------------------------------------------------------------------
+// Name: program_header_count
+// Desc:
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+int ElfFile<elfxx_header>::program_header_count() const {
+	return program_headers() ? header_->e_phnum : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: load_sections
+// Desc: checks the section table the first time it is needed. The mutex
+//       has to be held
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+void ElfFile<elfxx_header>::load_sections() const {
+
+	if(sections_loaded_) {
+		return;
+	}
+
+	sections_loaded_ = true;
+
+	if(!header_ || header_->e_shnum == 0 || header_->e_shentsize != sizeof(shdr_type)) {
+		return;
+	}
+
+	sections_ = at<shdr_type>(header_->e_shoff, header_->e_shnum);
+	if(!sections_) {
+		qDebug() << "[ElfFile]" << filename() << "has a truncated section table";
+		return;
+	}
+
+	section_count_ = header_->e_shnum;
+	if(header_->e_shstrndx < section_count_) {
+		section_strings_ = &sections_[header_->e_shstrndx];
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: sections
+// Desc: the section table, or nullptr if the file has none or it is damaged
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+auto ElfFile<elfxx_header>::sections() const -> const shdr_type * {
+	QMutexLocker locker(&mutex_);
+	load_sections();
+	return sections_;
+}
+
+//------------------------------------------------------------------------------
+// Name: section_count
+// Desc:
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+int ElfFile<elfxx_header>::section_count() const {
+	QMutexLocker locker(&mutex_);
+	load_sections();
+	return section_count_;
+}
+
+//------------------------------------------------------------------------------
+// Name: section
+// Desc: the section <index> refers to, nullptr for SHN_UNDEF and the like
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+auto ElfFile<elfxx_header>::section(int index) const -> const shdr_type * {
+	const shdr_type *const table = sections();
+	if(!table || index <= SHN_UNDEF || index >= section_count_) {
+		return nullptr;
+	}
+	return &table[index];
+}
+
+//------------------------------------------------------------------------------
+// Name: find_section
+// Desc: the first section called <name>, or nullptr
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+auto ElfFile<elfxx_header>::find_section(const char *name) const -> const shdr_type * {
+	const shdr_type *const table = sections();
+	for(int i = 0; i < section_count_; ++i) {
+		const char *const section_name = this->section_name(&table[i]);
+		if(section_name && std::strcmp(section_name, name) == 0) {
+			return &table[i];
+		}
+	}
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: section_name
+// Desc:
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+const char *ElfFile<elfxx_header>::section_name(const shdr_type *section) const {
+	{
+		QMutexLocker locker(&mutex_);
+		load_sections();
+	}
+	return string(section_strings_, section->sh_name);
+}
+
+//------------------------------------------------------------------------------
+// Name: string
+// Desc: the string at <offset> in <string_table>, or nullptr if it would run
+//       past the end of the table
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+const char *ElfFile<elfxx_header>::string(const shdr_type *string_table, quint64 offset) const {
+	int size;
+	if(auto strings = section_data<char>(string_table, &size)) {
+		if(offset < static_cast<quint64>(size) && std::memchr(strings + offset, '\0', size - offset)) {
+			return strings + offset;
+		}
+	}
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: load_symbols
+// Desc: collects the defined, named symbols of the symbol tables, the static
+//       one if there is one, the dynamic one otherwise. The mutex has to be held
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+void ElfFile<elfxx_header>::load_symbols() const {
+
+	if(symbols_loaded_) {
+		return;
+	}
+
+	symbols_loaded_ = true;
+	load_sections();
+
+	const shdr_type *table = nullptr;
+	for(int i = 0; i < section_count_; ++i) {
+		if(sections_[i].sh_type == SHT_SYMTAB || (sections_[i].sh_type == SHT_DYNSYM && !table)) {
+			table = &sections_[i];
+		}
+	}
+
+	if(!table || table->sh_link >= static_cast<quint64>(section_count_)) {
+		return;
+	}
+
+	int count;
+	const sym_type *const entries = section_data<sym_type>(table, &count);
+	if(!entries) {
+		return;
+	}
+
+	const shdr_type *const strings = &sections_[table->sh_link];
+
+	symbols_.reserve(count);
+	for(int i = 0; i < count; ++i) {
+		const sym_type &entry = entries[i];
+		if(entry.st_shndx == SHN_UNDEF || entry.st_value == 0) {
+			continue;
+		}
+
+		const unsigned char type = ELF32_ST_TYPE(entry.st_info); // the same for both classes
+		if(type != STT_FUNC && type != STT_OBJECT) {
+			continue;
+		}
+
+		const char *const name = string(strings, entry.st_name);
+		if(name && *name) {
+			symbols_.push_back(Symbol{entry.st_value, entry.st_size, name, type == STT_FUNC});
+		}
+	}
+
+	std::sort(symbols_.begin(), symbols_.end());
+}
+
+//------------------------------------------------------------------------------
+// Name: symbols
+// Desc: the defined symbols, by address
+//------------------------------------------------------------------------------
+template <class elfxx_header>
+auto ElfFile<elfxx_header>::symbols() const -> QVector<Symbol> {
+	QMutexLocker locker(&mutex_);
+	load_symbols();
+	return symbols_;
+}
+
+// explicit instantiations
+template class ElfFile<elf32_header>;
+template class ElfFile<elf64_header>;
+
+}
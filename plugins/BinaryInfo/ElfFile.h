@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ELF_FILE_20171014_H_
+#define ELF_FILE_20171014_H_
+
+#include "elf_binary.h"
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+#include <memory>
+
+namespace BinaryInfoPlugin {
+
+// An ELF file as it is on disk, mapped once and shared by everything which
+// looks at it, so the headers, sections and symbols cost no reads from the
+// process. The section and symbol tables are only checked and collected the
+// first time they are asked for. Every pointer handed out lies entirely in
+// the file, and stays valid as long as the ElfFile does
+template <class elfxx_header>
+class ElfFile {
+public:
+	typedef typename elfxx_header::elf_phdr phdr_type;
+	typedef typename elfxx_header::elf_shdr shdr_type;
+	typedef typename elfxx_header::elf_sym  sym_type;
+
+	// a defined symbol, at the address the file gives it
+	struct Symbol {
+		quint64     address;
+		quint64     size;
+		const char *name;
+		bool        function;
+
+		bool operator<(const Symbol &rhs) const { return address < rhs.address; }
+	};
+
+public:
+	static std::shared_ptr<ElfFile> open(const QString &filename);
+
+public:
+	explicit ElfFile(const QString &filename);
+	ElfFile(const ElfFile &) = delete;
+	ElfFile &operator=(const ElfFile &) = delete;
+
+public:
+	bool valid() const                 { return header_ != nullptr; }
+	QString filename() const           { return file_.fileName(); }
+	const quint8 *data() const         { return data_; }
+	std::size_t size() const           { return size_; }
+	const elfxx_header *header() const { return header_; }
+
+public:
+	template <class T>
+	const T *at(quint64 offset, quint64 count = 1) const {
+		if(offset > size_ || count > (size_ - offset) / sizeof(T)) {
+			return nullptr;
+		}
+		return reinterpret_cast<const T *>(data_ + offset);
+	}
+
+public:
+	const phdr_type *program_headers() const;
+	int program_header_count() const;
+
+public:
+	const shdr_type *sections() const;
+	int section_count() const;
+	const shdr_type *section(int index) const;
+	const shdr_type *find_section(const char *name) const;
+	const char *section_name(const shdr_type *section) const;
+	const char *string(const shdr_type *string_table, quint64 offset) const;
+
+	template <class T>
+	const T *section_data(const shdr_type *section, int *count = nullptr) const {
+		if(!section || section->sh_type == SHT_NOBITS) {
+			return nullptr;
+		}
+		const quint64 n = section->sh_size / sizeof(T);
+		if(count) {
+			*count = static_cast<int>(n);
+		}
+		return at<T>(section->sh_offset, n);
+	}
+
+public:
+	QVector<Symbol> symbols() const;
+
+private:
+	void load_sections() const;
+	void load_symbols() const;
+
+private:
+	QFile               file_;
+	const quint8       *data_   = nullptr;
+	std::size_t         size_   = 0;
+	const elfxx_header *header_ = nullptr;
+
+	mutable QMutex           mutex_;
+	mutable bool             sections_loaded_ = false;
+	mutable const shdr_type *sections_        = nullptr;
+	mutable int              section_count_   = 0;
+	mutable const shdr_type *section_strings_ = nullptr;
+	mutable bool             symbols_loaded_  = false;
+	mutable QVector<Symbol>  symbols_;
+};
+
+typedef ElfFile<elf32_header> ElfFile32;
+typedef ElfFile<elf64_header> ElfFile64;
+
+}
+
+#endif
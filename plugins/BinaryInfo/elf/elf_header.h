@@ -192,8 +192,16 @@ enum {
 #define EM_ALPHA	0x9026
 
 struct elf32_phdr;
+struct elf32_shdr;
+struct elf32_sym;
+struct elf32_rel;
+struct elf32_rela;
 struct elf32_header {
 	typedef elf32_phdr elf_phdr;
+	typedef elf32_shdr elf_shdr;
+	typedef elf32_sym  elf_sym;
+	typedef elf32_rel  elf_rel;
+	typedef elf32_rela elf_rela;
 	enum { ELFCLASS = ELFCLASS32 };
 
 	unsigned char	e_ident[EI_NIDENT];	/* Magic number and other info */
@@ -213,8 +221,16 @@ struct elf32_header {
 };
 
 struct elf64_phdr;
+struct elf64_shdr;
+struct elf64_sym;
+struct elf64_rel;
+struct elf64_rela;
 struct elf64_header {
 	typedef elf64_phdr elf_phdr;
+	typedef elf64_shdr elf_shdr;
+	typedef elf64_sym  elf_sym;
+	typedef elf64_rel  elf_rel;
+	typedef elf64_rela elf_rela;
 	enum { ELFCLASS = ELFCLASS64 };
 
 	unsigned char	e_ident[EI_NIDENT];	/* Magic number and other info */
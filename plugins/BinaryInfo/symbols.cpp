@@ -17,20 +17,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "symbols.h"
+#include "DebugInfoIndex.h"
 #include "demangle.h"
+#include "ElfFile.h"
 #include "edb.h"
+#include "SymbolFile.h"
 
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
-#include <QList>
 #include <QSet>
 #include <QString>
 #include <QSettings>
+#include <QVector>
 #include <iostream>
 #include <memory>
 
+#if QT_VERSION >= 0x050000
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+#elif QT_VERSION >= 0x040800
+#include <QtConcurrentMap>
+
+#ifndef QT_NO_CONCURRENT
+#define QT_CONCURRENT_LIB
+#endif
+
+#endif
+
 #include "elf/elf_types.h"
 #include "elf/elf_header.h"
 #include "elf/elf_rela.h"
@@ -116,22 +132,6 @@ struct elf64_model {
 };
 
 
-bool is_elf32(const void *ptr) {
-	auto elf32_hdr = reinterpret_cast<const elf32_header *>(ptr);
-	if(std::memcmp(elf32_hdr->e_ident, ELFMAG, SELFMAG) == 0) {
-		return elf32_hdr->e_ident[EI_CLASS] == ELFCLASS32;
-	}
-	return false;
-}
-
-bool is_elf64(const void *ptr) {
-	auto elf64_hdr = reinterpret_cast<const elf64_header *>(ptr);
-	if(std::memcmp(elf64_hdr->e_ident, ELFMAG, SELFMAG) == 0) {
-		return elf64_hdr->e_ident[EI_CLASS] == ELFCLASS64;
-	}
-	return false;
-}
-
 /*
 The  symbol  type.   At least the following types are used; others are, as well, depending on the object file format.  If lowercase,
 the symbol is local; if uppercase, the symbol is global (external).
@@ -188,24 +188,37 @@ the symbol is local; if uppercase, the symbol is global (external).
 
 
 template <class M>
-void collect_symbols(const void *p, size_t size, QList<typename M::symbol> &symbols) {
-	Q_UNUSED(size);
+void collect_symbols(const ElfFile<typename M::elf_header_t> &file, QVector<typename M::symbol> &symbols) {
 
 	typedef typename M::address_t            address_t;
-	typedef typename M::elf_header_t         elf_header_t;
 	typedef typename M::elf_section_header_t elf_section_header_t;
 	typedef typename M::elf_symbol_t         elf_symbol_t;
 	typedef typename M::elf_relocation_a_t   elf_relocation_a_t;
 	typedef typename M::elf_relocation_t     elf_relocation_t;
 	typedef typename M::symbol               symbol;
 
-	const auto base = reinterpret_cast<uintptr_t>(p);
+	// the section table is checked for us, and everything it points to is
+	// looked up through the file, which refuses what would run past its end
+	const elf_section_header_t *const sections_begin = file.sections();
+	if(!sections_begin) {
+		return;
+	}
 
-	const auto header                              = static_cast<const elf_header_t*>(p);
-	const auto sections_begin                      = reinterpret_cast<elf_section_header_t*>(base + header->e_shoff);
-	const elf_section_header_t *const sections_end = sections_begin + header->e_shnum;
-	auto section_strings                           = reinterpret_cast<const char*>(base + sections_begin[header->e_shstrndx].sh_offset);
+	const elf_section_header_t *const sections_end = sections_begin + file.section_count();
 
+	auto section_name = [&file](const elf_section_header_t *section) {
+		const char *const name = file.section_name(section);
+		return name ? name : "";
+	};
+
+	// nearly all of them come from the symbol tables, so make room up front
+	int expected = symbols.size();
+	for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
+		if((section->sh_type == SHT_SYMTAB || section->sh_type == SHT_DYNSYM) && section->sh_entsize != 0) {
+			expected += section->sh_size / section->sh_entsize;
+		}
+	}
+	symbols.reserve(expected);
 
 	address_t plt_address = 0;
 	address_t got_address = 0;
@@ -213,284 +226,301 @@ void collect_symbols(const void *p, size_t size, QList<typename M::symbol> &symb
 
 	// collect special section addresses
 	for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
-		if(strcmp(&section_strings[section->sh_name], ".plt") == 0) {
+		if(strcmp(section_name(section), ".plt") == 0) {
 			plt_address = section->sh_addr;
-		} else if(strcmp(&section_strings[section->sh_name], ".got") == 0) {
+		} else if(strcmp(section_name(section), ".got") == 0) {
 			got_address = section->sh_addr;
 		}
 	}
 
+	// the symbol a relocation refers to, and its name
+	auto relocated_symbol = [&file](const elf_section_header_t *section, int sym_index, const char **name) -> const elf_symbol_t * {
+		const elf_section_header_t *const linked = file.section(section->sh_link);
+		int count;
+		const elf_symbol_t *const symbol_tab = file.template section_data<elf_symbol_t>(linked, &count);
+		if(!symbol_tab || sym_index >= count) {
+			return nullptr;
+		}
+
+		*name = file.string(file.section(linked->sh_link), symbol_tab[sym_index].st_name);
+		return *name ? &symbol_tab[sym_index] : nullptr;
+	};
+
+	auto add_plt_symbol = [&](const elf_section_header_t *section, const elf_symbol_t *entry, const char *name, address_t symbol_address, const char *prefix) {
+		const char *sym_name = section_name(section);
+		if(strlen(sym_name) > strlen(prefix) && memcmp(sym_name, prefix, strlen(prefix)) == 0) {
+			sym_name += strlen(prefix);
+		}
+
+		plt_addresses.insert(symbol_address);
+
+		symbol sym;
+		sym.address = symbol_address;
+		sym.size    = (entry->st_size ? entry->st_size : 0x10);
+		sym.name    = name;
+		sym.name    += "@";
+		sym.name    += sym_name;
+		sym.type    = 'P';
+		symbols.push_back(sym);
+	};
+
 	// print out relocated symbols for special sections
 	for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
 		address_t base_address = 0;
-		if(strcmp(&section_strings[section->sh_name], ".rela.plt") == 0) {
+		if(strcmp(section_name(section), ".rela.plt") == 0) {
 			base_address = plt_address;
-		} else if(strcmp(&section_strings[section->sh_name], ".rel.plt") == 0) {
+		} else if(strcmp(section_name(section), ".rel.plt") == 0) {
 			base_address = plt_address;
-		} else if(strcmp(&section_strings[section->sh_name], ".rela.got") == 0) {
+		} else if(strcmp(section_name(section), ".rela.got") == 0) {
 			base_address = got_address;
-		} else if(strcmp(&section_strings[section->sh_name], ".rel.got") == 0) {
+		} else if(strcmp(section_name(section), ".rel.got") == 0) {
 			base_address = got_address;
 		} else {
 			continue;
 		}
 
+		if(section->sh_link == 0) {
+			continue;
+		}
+
 		switch(section->sh_type) {
 		case SHT_RELA:
 			{
 				int n = 0;
-				auto relocation = reinterpret_cast<elf_relocation_a_t*>(base + section->sh_offset);
-
-                if(section->sh_link == 0) {
-                    break;
-                }
-
-				for(size_t i = 0; i < section->sh_size / section->sh_entsize; ++i) {
-
-					const int sym_index                = M::elf_r_sym(relocation[i].r_info);
-					const elf_section_header_t *linked = &sections_begin[section->sh_link];
-					auto symbol_tab                    = reinterpret_cast<elf_symbol_t*>(base + linked->sh_offset);
-					auto string_tab                    = reinterpret_cast<const char*>(base + sections_begin[linked->sh_link].sh_offset);
-
-					const address_t symbol_address = base_address + ++n * M::plt_entry_size;
-
-					const char *sym_name = &section_strings[section->sh_name];
-					if(strlen(sym_name) > (sizeof(".rela.") - 1) && memcmp(sym_name, ".rela.", (sizeof(".rela.") - 1)) == 0) {
-						sym_name += 6;
+				int count;
+				if(auto relocation = file.template section_data<elf_relocation_a_t>(section, &count)) {
+					for(int i = 0; i < count; ++i) {
+						const char *name;
+						if(const elf_symbol_t *entry = relocated_symbol(section, M::elf_r_sym(relocation[i].r_info), &name)) {
+							add_plt_symbol(section, entry, name, base_address + ++n * M::plt_entry_size, ".rela.");
+						}
 					}
-
-					plt_addresses.insert(symbol_address);
-
-					symbol sym;
-					sym.address = symbol_address;
-					sym.size    = (symbol_tab[sym_index].st_size ? symbol_tab[sym_index].st_size : 0x10);
-					sym.name    = &string_tab[symbol_tab[sym_index].st_name];
-					sym.name    += "@";
-					sym.name    += sym_name;
-					sym.type    = 'P';
-					symbols.push_back(sym);
 				}
-
 			}
 			break;
 		case SHT_REL:
 			{
 				int n = 0;
-				auto relocation = reinterpret_cast<elf_relocation_t*>(base + section->sh_offset);
-
-                if(section->sh_link == 0) {
-                    break;
-                }
-
-				for(size_t i = 0; i < section->sh_size / section->sh_entsize; ++i) {
-
-					const int sym_index                = M::elf_r_sym(relocation[i].r_info);
-					const elf_section_header_t *linked = &sections_begin[section->sh_link];
-					auto symbol_tab                    = reinterpret_cast<elf_symbol_t*>(base + linked->sh_offset);
-					auto string_tab                    = reinterpret_cast<const char*>(base + sections_begin[linked->sh_link].sh_offset);
-
-					const address_t symbol_address = base_address + ++n * M::plt_entry_size;
-
-					const char *sym_name = &section_strings[section->sh_name];
-					if(strlen(sym_name) > (sizeof(".rel.") - 1) && memcmp(sym_name, ".rel.", (sizeof(".rel.") - 1)) == 0) {
-						sym_name += 5;
+				int count;
+				if(auto relocation = file.template section_data<elf_relocation_t>(section, &count)) {
+					for(int i = 0; i < count; ++i) {
+						const char *name;
+						if(const elf_symbol_t *entry = relocated_symbol(section, M::elf_r_sym(relocation[i].r_info), &name)) {
+							add_plt_symbol(section, entry, name, base_address + ++n * M::plt_entry_size, ".rel.");
+						}
 					}
-
-					plt_addresses.insert(symbol_address);
-
-					symbol sym;
-					sym.address = symbol_address;
-					sym.size    = (symbol_tab[sym_index].st_size ? symbol_tab[sym_index].st_size : 0x10);
-					sym.name    = &string_tab[symbol_tab[sym_index].st_name];
-					sym.name    += "@";
-					sym.name    += sym_name;
-					sym.type    = 'P';
-					symbols.push_back(sym);
 				}
-
 			}
 			break;
 		}
 	}
 
-	// collect regular symbols
-	for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
-
-		switch(section->sh_type) {
-		case SHT_SYMTAB:
-		case SHT_DYNSYM:
-			{
-				auto symbol_tab = reinterpret_cast<elf_symbol_t*>(base + section->sh_offset);
-				auto string_tab = reinterpret_cast<const char*>(base + sections_begin[section->sh_link].sh_offset);
-
-				for(size_t i = 0; i < section->sh_size / section->sh_entsize; ++i) {
+	// collect regular symbols, then the unnamed ones, which are named after
+	// the section they are in
+	for(const bool named : {true, false}) {
+		for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
 
-					const elf_section_header_t *related_section = 0;
-
-					if(symbol_tab[i].st_shndx != SHN_UNDEF && symbol_tab[i].st_shndx < SHN_LORESERVE) {
-						related_section = &sections_begin[symbol_tab[i].st_shndx];
-					}
-
-					Q_UNUSED(related_section);
-
-					if(plt_addresses.find(symbol_tab[i].st_value) == plt_addresses.end()) {
-
-						if(symbol_tab[i].st_value && strlen(&string_tab[symbol_tab[i].st_name]) > 0) {
+			if(section->sh_type != SHT_SYMTAB && section->sh_type != SHT_DYNSYM) {
+				continue;
+			}
 
-							symbol sym;
-							sym.address = symbol_tab[i].st_value;
-							sym.size    = symbol_tab[i].st_size;
-							sym.name    = &string_tab[symbol_tab[i].st_name];
-							sym.type    = (M::elf_st_type(symbol_tab[i].st_info) == STT_FUNC ? 'T' : 'D');
-							symbols.push_back(sym);
-						}
-					}
-				}
+			int count;
+			auto symbol_tab = file.template section_data<elf_symbol_t>(section, &count);
+			if(!symbol_tab) {
+				continue;
 			}
-			break;
-		}
-	}
 
-	// collect unnamed symbols
-	for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
+			const elf_section_header_t *const string_tab = file.section(section->sh_link);
 
-		switch(section->sh_type) {
-		case SHT_SYMTAB:
-		case SHT_DYNSYM:
-			{
-				auto symbol_tab = reinterpret_cast<elf_symbol_t*>(base + section->sh_offset);
-				auto string_tab = reinterpret_cast<const char*>(base + sections_begin[section->sh_link].sh_offset);
-
-				for(size_t i = 0; i < section->sh_size / section->sh_entsize; ++i) {
+			for(int i = 0; i < count; ++i) {
 
-					const elf_section_header_t *related_section = 0;
+				if(!symbol_tab[i].st_value || plt_addresses.contains(symbol_tab[i].st_value)) {
+					continue;
+				}
 
-					if(symbol_tab[i].st_shndx != SHN_UNDEF && symbol_tab[i].st_shndx < SHN_LORESERVE) {
-						related_section = &sections_begin[symbol_tab[i].st_shndx];
-					}
+				const char *const name = file.string(string_tab, symbol_tab[i].st_name);
+				if(!name || (strlen(name) > 0) != named) {
+					continue;
+				}
 
-					Q_UNUSED(related_section);
-
-					if(plt_addresses.find(symbol_tab[i].st_value) == plt_addresses.end()) {
-
-						if(symbol_tab[i].st_value && strlen(&string_tab[symbol_tab[i].st_name]) == 0) {
-							symbol sym;
-							sym.address = symbol_tab[i].st_value;
-							sym.size    = symbol_tab[i].st_size;
-							for(const elf_section_header_t *section = sections_begin; section != sections_end; ++section) {
-								if(sym.address>=section->sh_addr && sym.address+sym.size<=section->sh_addr+section->sh_size) {
-									const std::int64_t offset=sym.address-section->sh_addr;
-									const QString hexPrefix=std::abs(offset)>9?"0x":"";
-									const QString offsetStr=offset ? "+"+hexPrefix+QString::number(offset,16) : "";
-									const QString sectionName(&section_strings[section->sh_name]);
-									if(!sectionName.isEmpty()) {
-										sym.name = QString(sectionName+offsetStr);
-										break;
-									}
-								}
+				symbol sym;
+				sym.address = symbol_tab[i].st_value;
+				sym.size    = symbol_tab[i].st_size;
+				sym.type    = (M::elf_st_type(symbol_tab[i].st_info) == STT_FUNC ? 'T' : 'D');
+
+				if(named) {
+					sym.name = name;
+				} else {
+					for(const elf_section_header_t *other = sections_begin; other != sections_end; ++other) {
+						if(sym.address>=other->sh_addr && sym.address+sym.size<=other->sh_addr+other->sh_size) {
+							const std::int64_t offset=sym.address-other->sh_addr;
+							const QString hexPrefix=std::abs(offset)>9?"0x":"";
+							const QString offsetStr=offset ? "+"+hexPrefix+QString::number(offset,16) : "";
+							const QString sectionName(section_name(other));
+							if(!sectionName.isEmpty()) {
+								sym.name = QString(sectionName+offsetStr);
+								break;
 							}
-							if(sym.name.isEmpty())
-								sym.name = QString("$sym_%1").arg(edb::v1::format_pointer(symbol_tab[i].st_value));
-							sym.type    = (M::elf_st_type(symbol_tab[i].st_info) == STT_FUNC ? 'T' : 'D');
-							symbols.push_back(sym);
 						}
 					}
+					if(sym.name.isEmpty())
+						sym.name = QString("$sym_%1").arg(edb::v1::format_pointer(symbol_tab[i].st_value));
 				}
+
+				symbols.push_back(sym);
 			}
-			break;
 		}
 	}
 }
 
 //--------------------------------------------------------------------------
 // Name: output_symbols
-// Desc: outputs the symbols to OS ensuring uniqueness and adding any
-//       needed demangling
+// Desc: outputs the symbols to <os> and/or <records>, ensuring uniqueness.
+//       The records keep the mangled names, only marked to be demangled, as
+//       edb does that when they are shown. The text output is demangled here
 //--------------------------------------------------------------------------
 template <class Symbol>
-void output_symbols(QList<Symbol> &symbols, std::ostream &os) {
+void output_symbols(QVector<Symbol> &symbols, std::ostream *os, QVector<SymbolFile::Symbol> *records) {
 	qSort(symbols.begin(), symbols.end());
-	auto new_end = std::unique(symbols.begin(), symbols.end());
-	const auto demanglingEnabled = QSettings().value("BinaryInfo/demangling_enabled", true).toBool();
-	for(auto it = symbols.begin(); it != new_end; ++it) {
-		if(demanglingEnabled) {
-			it->name = demangle(it->name);
+	symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+	const bool demangling = QSettings().value("BinaryInfo/demangling_enabled", true).toBool();
+
+	if(records) {
+		records->reserve(records->size() + symbols.size());
+
+		for(const Symbol &symbol : symbols) {
+			SymbolFile::Symbol record;
+			record.address = symbol.address;
+			record.size    = static_cast<quint32>(symbol.size);
+			record.name    = symbol.name.toUtf8();
+			record.type    = symbol.type;
+			record.flags   = (demangling && symbol.name.startsWith(QLatin1String("_Z"))) ? SymbolFile::MANGLED : 0;
+			records->push_back(record);
+		}
+	}
+
+	if(os) {
+		// demangling is most of the work for C++ libraries, and every name is
+		// independent of the others
+		if(demangling) {
+#ifdef QT_CONCURRENT_LIB
+			QtConcurrent::blockingMap(symbols, [](Symbol &symbol) {
+				symbol.name = demangle(symbol.name);
+			});
+#else
+			for(Symbol &symbol : symbols) {
+				symbol.name = demangle(symbol.name);
+			}
+#endif
+		}
+
+		for(const Symbol &symbol : symbols) {
+			*os << qPrintable(symbol.to_string()) << '\n';
 		}
-		os << qPrintable(it->to_string()) << '\n';
 	}
 }
 
 
 //--------------------------------------------------------------------------
 // Name: generate_symbols_internal
-// Desc:
+// Desc: <filename> is looked at through the mapping BinaryInfo shares, so a
+//       module which is loaded isn't parsed twice
 //--------------------------------------------------------------------------
-bool generate_symbols_internal(QFile &file, std::shared_ptr<QFile> &debugFile, std::ostream &os) {
-	if(auto file_ptr = reinterpret_cast<void *>(file.map(0, file.size(), QFile::NoOptions))) {
-		if(is_elf64(file_ptr)) {
+template <class M>
+bool generate_symbols_internal(const QString &filename, const std::shared_ptr<QFile> &debugFile, std::ostream *os, QVector<SymbolFile::Symbol> *records) {
 
-			typedef typename elf64_model::symbol symbol;
-			QList<symbol> symbols;
+	typedef ElfFile<typename M::elf_header_t> file_type;
 
-			collect_symbols<elf64_model>(file_ptr, file.size(), symbols);
+	const std::shared_ptr<file_type> file = file_type::open(filename);
+	if(!file) {
+		return false;
+	}
 
-			// if there was a debug file
-			if(debugFile) {
-				// and we sucessfully opened it
-				if(debugFile->open(QIODevice::ReadOnly)) {
+	QVector<typename M::symbol> symbols;
+	collect_symbols<M>(*file, symbols);
 
-					// map it and include it with the symbols
-					if(auto debug_ptr = reinterpret_cast<void *>(debugFile->map(0, debugFile->size(), QFile::NoOptions))) {
+	// if there was a debug file, and it is the same kind, include it with the symbols
+	if(debugFile) {
+		if(const std::shared_ptr<file_type> debug = file_type::open(debugFile->fileName())) {
+			collect_symbols<M>(*debug, symbols);
+		}
+	}
 
-						// this should never fail... but just being sure
-						if(is_elf64(debug_ptr)) {
-							collect_symbols<elf64_model>(debug_ptr, debugFile->size(), symbols);
-						}
-					}
-				}
-			}
+	output_symbols(symbols, os, records);
+	return true;
+}
+
+//--------------------------------------------------------------------------
+// Name: generate_symbols_internal
+// Desc:
+//--------------------------------------------------------------------------
+bool generate_symbols_internal(const QString &filename, const std::shared_ptr<QFile> &debugFile, std::ostream *os, QVector<SymbolFile::Symbol> *records) {
+	if(generate_symbols_internal<elf64_model>(filename, debugFile, os, records)) {
+		return true;
+	}
 
-			output_symbols(symbols, os);
-			return true;
-		} else if(is_elf32(file_ptr)) {
+	if(generate_symbols_internal<elf32_model>(filename, debugFile, os, records)) {
+		return true;
+	}
 
-			typedef typename elf32_model::symbol symbol;
-			QList<symbol> symbols;
+	qDebug() << "unknown file type";
+	return false;
+}
 
-			collect_symbols<elf32_model>(file_ptr, file.size(), symbols);
+//--------------------------------------------------------------------------
+// Name: debug_file
+// Desc: the separate debug info of <filename>, which may not exist. Going by
+//       the build-id or the debug link finds it wherever the distribution put
+//       it, the paths derived from the name are the last resort
+//--------------------------------------------------------------------------
+std::shared_ptr<QFile> debug_file(const QString &filename, const DebugInfoIndex *index) {
 
-			// if there was a debug file
-			if(debugFile) {
-				// and we sucessfully opened it
-				if(debugFile->open(QIODevice::ReadOnly)) {
+	const QString debugInfoPath = QSettings().value("BinaryInfo/debug_info_path", "/usr/lib/debug").toString();
+	if(debugInfoPath.isEmpty()) {
+		return nullptr;
+	}
 
-					// map it and include it with the symbols
-					if(auto debug_ptr = reinterpret_cast<void *>(debugFile->map(0, debugFile->size(), QFile::NoOptions))) {
+	DebugInfoIndex::Identity identity;
 
-						// this should never fail... but just being sure
-						if(is_elf32(debug_ptr)) {
-							collect_symbols<elf32_model>(debug_ptr, debugFile->size(), symbols);
-						}
-					}
-				}
-			}
+	QFile file(filename);
+	if(file.open(QIODevice::ReadOnly)) {
+		if(uchar *image = file.map(0, file.size())) {
+			identity = DebugInfoIndex::identify(image, static_cast<size_t>(file.size()));
+			file.unmap(image);
+		}
+	}
 
-			output_symbols(symbols, os);
-			return true;
-		} else {
-			qDebug() << "unknown file type";
+	// the layout gdb uses, .build-id/<first byte>/<the rest>.debug
+	if(identity.build_id.size() > 1) {
+		const QByteArray hex = identity.build_id.toHex();
+		const QString path   = QString("%1/.build-id/%2/%3.debug").arg(debugInfoPath, QString(hex.left(2)), QString(hex.mid(2)));
+		if(QFile::exists(path)) {
+			return std::make_shared<QFile>(path);
 		}
 	}
 
-	return false;
-}
+	if(index) {
+		const QString path = index->find(identity);
+		if(!path.isEmpty()) {
+			return std::make_shared<QFile>(path);
+		}
+	}
 
+	auto debugFile = std::make_shared<QFile>(QString("%1/%2.debug").arg(debugInfoPath, filename));
+	if(!debugFile->exists()) // systems such as Ubuntu don't have .debug suffix, try without it
+		debugFile = std::make_shared<QFile>(QString("%1/%2").arg(debugInfoPath, filename));
+
+	return debugFile;
+}
 
 }
 
 //--------------------------------------------------------------------------
 // Name: generate_symbols
-// Desc:
+// Desc: writes the symbols of <filename> to <os> as text, which is for people
+//       and other tools, edb itself loads them from generate_symbol_cache's
+//       files
 //--------------------------------------------------------------------------
 bool generate_symbols(const QString &filename, std::ostream &os) {
 
@@ -504,16 +534,32 @@ bool generate_symbols(const QString &filename, std::ostream &os) {
 		const QByteArray md5 = edb::v1::get_file_md5(filename);
 		os << md5.toHex().data() << ' ' << qPrintable(QFileInfo(filename).absoluteFilePath()) << '\n';
 
-		const QString debugInfoPath = QSettings().value("BinaryInfo/debug_info_path", "/usr/lib/debug").toString();
+		std::shared_ptr<QFile> debugFile = debug_file(filename, nullptr);
+		return generate_symbols_internal(filename, debugFile, &os, nullptr);
+	}
 
-		std::shared_ptr<QFile> debugFile;
-		if(!debugInfoPath.isEmpty()) {
-			debugFile = std::make_shared<QFile>(QString("%1/%2.debug").arg(debugInfoPath, filename));
-			if(!debugFile->exists()) // systems such as Ubuntu don't have .debug suffix, try without it
-				debugFile = std::make_shared<QFile>(QString("%1/%2").arg(debugInfoPath, filename));
-		}
+	return false;
+}
 
-		return generate_symbols_internal(file, debugFile, os);
+//--------------------------------------------------------------------------
+// Name: generate_symbol_cache
+// Desc: writes the symbols of <filename> to <symbol_file>, as a SymbolFile.
+//       <index> helps finding the debug info, it may be null
+//--------------------------------------------------------------------------
+bool generate_symbol_cache(const QString &filename, const QString &symbol_file, const DebugInfoIndex *index) {
+
+	QFile file(filename);
+	if(file.open(QIODevice::ReadOnly)) {
+		QVector<SymbolFile::Symbol> records;
+
+		std::shared_ptr<QFile> debugFile = debug_file(filename, index);
+		if(generate_symbols_internal(filename, debugFile, nullptr, &records)) {
+			const Status status = SymbolFile::write(symbol_file, QFileInfo(filename).absoluteFilePath(), edb::v1::get_file_md5(filename), records);
+			if(!status) {
+				qDebug() << "[BinaryInfo]" << status.toString();
+			}
+			return status.success();
+		}
 	}
 
 	return false;
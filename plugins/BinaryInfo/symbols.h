@@ -23,7 +23,9 @@ class QString;
 #include <iostream>
 
 namespace BinaryInfoPlugin {
+class DebugInfoIndex;
 bool generate_symbols(const QString &filename, std::ostream &os = std::cout);
+bool generate_symbol_cache(const QString &filename, const QString &symbol_file, const DebugInfoIndex *index = nullptr);
 }
 
 #endif
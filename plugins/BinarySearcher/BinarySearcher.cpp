@@ -20,6 +20,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "edb.h"
 #include "DialogASCIIString.h"
 #include "DialogBinaryString.h"
+#include "DialogMultiPattern.h"
+#include "DialogRegexSearch.h"
 #include <QMenu>
 
 namespace BinarySearcherPlugin {
@@ -49,6 +51,8 @@ QMenu *BinarySearcher::menu(QWidget *parent) {
 	if(!menu_) {
 		menu_ = new QMenu(tr("BinarySearcher"), parent);
 		menu_->addAction(tr("&Binary String Search"), this, SLOT(show_menu()), QKeySequence(tr("Ctrl+F")));
+		menu_->addAction(tr("&Multi-Pattern Search"), this, SLOT(show_multi_pattern_menu()));
+		menu_->addAction(tr("&Regular Expression Search"), this, SLOT(show_regex_menu()));
 	}
 
 	return menu_;
@@ -78,6 +82,24 @@ void BinarySearcher::show_menu() {
 	dialog->show();
 }
 
+//------------------------------------------------------------------------------
+// Name: show_multi_pattern_menu
+// Desc:
+//------------------------------------------------------------------------------
+void BinarySearcher::show_multi_pattern_menu() {
+	static auto dialog = new DialogMultiPattern(edb::v1::debugger_ui);
+	dialog->show();
+}
+
+//------------------------------------------------------------------------------
+// Name: show_regex_menu
+// Desc:
+//------------------------------------------------------------------------------
+void BinarySearcher::show_regex_menu() {
+	static auto dialog = new DialogRegexSearch(edb::v1::debugger_ui);
+	dialog->show();
+}
+
 //------------------------------------------------------------------------------
 // Name: mnuStackFindASCII
 // Desc:
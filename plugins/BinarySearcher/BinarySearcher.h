@@ -45,6 +45,8 @@ public:
 
 public Q_SLOTS:
 	void show_menu();
+	void show_multi_pattern_menu();
+	void show_regex_menu();
 	void mnuStackFindASCII();
 
 private:
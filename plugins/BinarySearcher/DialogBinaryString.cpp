@@ -17,14 +17,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogBinaryString.h"
+#include "BytePattern.h"
 #include "edb.h"
 #include "IDebugger.h"
 #include "IRegion.h"
 #include "MemoryRegions.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
 #include "Util.h"
 #include <QMessageBox>
 #include <QVector>
-#include <cstring>
 
 #include "ui_DialogBinaryString.h"
 
@@ -36,8 +39,8 @@ namespace BinarySearcherPlugin {
 //------------------------------------------------------------------------------
 DialogBinaryString::DialogBinaryString(QWidget *parent) : QDialog(parent), ui(new Ui::DialogBinaryString) {
 	ui->setupUi(this);
+	ui->binaryString->setWildcardsAllowed(true);
 	ui->progressBar->setValue(0);
-	ui->listWidget->clear();
 }
 
 //------------------------------------------------------------------------------
@@ -54,54 +57,52 @@ DialogBinaryString::~DialogBinaryString() {
 //------------------------------------------------------------------------------
 void DialogBinaryString::do_find() {
 
-	const QByteArray b = ui->binaryString->value();
-	ui->listWidget->clear();
+	const BytePattern pattern(ui->binaryString->value(), ui->binaryString->mask());
+	ui->listView->results()->clear();
 
-	const int sz = b.size();
+	const int sz = pattern.size();
 	if(sz != 0) {
 		edb::v1::memory_regions().sync();
 		const QList<std::shared_ptr<IRegion>> regions = edb::v1::memory_regions().regions();
-		const edb::address_t page_size = edb::v1::debugger_core->page_size();
+
+		const bool aligned         = ui->chkAlignment->isChecked();
+		const edb::address_t align   = 1 << (ui->cmbAlignment->currentIndex() + 1);
+
+		// overlap the windows by sz - 1 bytes so that a match spanning two
+		// windows is still found, and found exactly once
+		const RegionSearch search([pattern, aligned, align](const RegionSearch::Window &window) {
+			QVector<SearchResult> results;
+
+			const quint8 *p = window.data.constData();
+			const quint8 *const window_end = p + window.data.size();
+
+			while((p = pattern.find(p, window_end))) {
+				const edb::address_t addr = p - window.data.constData() + window.address;
+
+				if(!aligned || (addr % align) == 0) {
+					results.push_back(SearchResult{addr, QString(), 0, static_cast<quint32>(pattern.size())});
+				}
+
+				++p;
+			}
+
+			return results;
+		}, sz - 1);
 
 		int i = 0;
 		for(const std::shared_ptr<IRegion> &region: regions) {
-			const auto region_size = region->size();
-
 			// a short circut for speading things up
 			if(ui->chkSkipNoAccess->isChecked() && !region->accessible()) {
 				ui->progressBar->setValue(util::percentage(++i, regions.size()));
 				continue;
 			}
 
-			const size_t page_count     = region_size / page_size;
-			const QVector<quint8> pages = edb::v1::read_pages(region->start(), page_count);
-
-			if(!pages.isEmpty()) {
-
-				const quint8 *p = &pages[0];
-				const quint8 *const pages_end = &pages[0] + region_size - sz;
-
-				while(p < pages_end) {
-					// compare values..
-					if(std::memcmp(p, b.constData(), sz) == 0) {
-						const edb::address_t addr = p - &pages[0] + region->start();
-						const edb::address_t align = 1 << (ui->cmbAlignment->currentIndex() + 1);
+			search.run(region, [this](const QVector<SearchResult> &results) {
+				ui->listView->results()->append(results);
+			}, [this, i, &regions](int progress) {
+				ui->progressBar->setValue(util::percentage(i, regions.size(), progress, 100));
+			});
 
-						if(!ui->chkAlignment->isChecked() || (addr % align) == 0) {
-							auto item = new QListWidgetItem(edb::v1::format_pointer(addr));
-							item->setData(Qt::UserRole, addr);
-							ui->listWidget->addItem(item);
-						}
-					}
-
-					// update progress bar every 64KB
-					if ((quint64(p) & 0xFFFF) == 0) {
-						ui->progressBar->setValue(util::percentage(i, regions.size(), p - &pages[0], region_size));
-					}
-
-					++p;
-				}
-			}
 			++i;
 		}
 	}
@@ -121,11 +122,11 @@ void DialogBinaryString::on_btnFind_clicked() {
 }
 
 //------------------------------------------------------------------------------
-// Name: on_listWidget_itemDoubleClicked
+// Name: on_listView_doubleClicked
 // Desc: follows the found item in the data view
 //------------------------------------------------------------------------------
-void DialogBinaryString::on_listWidget_itemDoubleClicked(QListWidgetItem *item) {
-	const edb::address_t addr = item->data(Qt::UserRole).toULongLong();
+void DialogBinaryString::on_listView_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong();
 	edb::v1::dump_data(addr, false);
 }
 
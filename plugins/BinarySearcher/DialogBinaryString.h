@@ -21,7 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDialog>
 
-class QListWidgetItem;
+class QModelIndex;
 
 namespace BinarySearcherPlugin {
 
@@ -36,7 +36,7 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
-	void on_listWidget_itemDoubleClicked(QListWidgetItem *);
+	void on_listView_doubleClicked(const QModelIndex &index);
 
 private:
 	void do_find();
@@ -0,0 +1,201 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogMultiPattern.h"
+#include "PatternSet.h"
+#include "edb.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
+#include "Util.h"
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QStringList>
+
+#include <algorithm>
+
+#include "ui_DialogMultiPattern.h"
+
+namespace BinarySearcherPlugin {
+
+//------------------------------------------------------------------------------
+// Name: DialogMultiPattern
+// Desc: constructor
+//------------------------------------------------------------------------------
+DialogMultiPattern::DialogMultiPattern(QWidget *parent) : QDialog(parent), ui(new Ui::DialogMultiPattern) {
+	ui->setupUi(this);
+	ui->progressBar->setValue(0);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogMultiPattern
+// Desc:
+//------------------------------------------------------------------------------
+DialogMultiPattern::~DialogMultiPattern() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_patterns
+// Desc: one pattern a line, either hex bytes or a "quoted" string. Blank lines
+//       and those starting with a '#' are skipped. <labels> gets the text of
+//       the line each pattern came from
+//------------------------------------------------------------------------------
+bool DialogMultiPattern::parse_patterns(PatternSet *patterns, QStringList *labels) {
+
+	Q_ASSERT(patterns);
+	Q_ASSERT(labels);
+
+	const QStringList lines = ui->txtPatterns->toPlainText().split('\n');
+
+	for(int i = 0; i < lines.size(); ++i) {
+		const QString line = lines[i].trimmed();
+		if(line.isEmpty() || line.startsWith('#')) {
+			continue;
+		}
+
+		QByteArray bytes;
+		if(line.size() >= 2 && line.startsWith('"') && line.endsWith('"')) {
+			bytes = line.mid(1, line.size() - 2).toLatin1();
+		} else {
+			QString hex = line;
+			hex.remove(' ');
+			if(hex.size() % 2 != 0 || hex.contains(QRegExp("[^0-9a-fA-F]"))) {
+				QMessageBox::warning(this, tr("Invalid Pattern"), tr("Line %1 is neither hex bytes nor a quoted string:\n%2").arg(i + 1).arg(line));
+				return false;
+			}
+			bytes = QByteArray::fromHex(hex.toLatin1());
+		}
+
+		const int index = patterns->add(bytes);
+		if(index == labels->size()) {
+			labels->push_back(line);
+		}
+	}
+
+	patterns->build();
+	return !patterns->isEmpty();
+}
+
+//------------------------------------------------------------------------------
+// Name: do_find
+// Desc: a single pass over memory finds every pattern
+//------------------------------------------------------------------------------
+void DialogMultiPattern::do_find() {
+
+	PatternSet  patterns;
+	QStringList labels;
+
+	ui->listView->results()->clear();
+
+	if(!parse_patterns(&patterns, &labels)) {
+		return;
+	}
+
+	int longest = 0;
+	for(int n = 0; n < patterns.count(); ++n) {
+		longest = std::max(longest, patterns.pattern(n).size());
+	}
+
+	// each window is matched on its own, from the initial state, so they
+	// overlap by enough for any match spanning two windows to be whole in the
+	// second one. A match which ends in the repeated bytes was already found
+	// in the first one
+	const RegionSearch search([patterns, labels](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+
+		const quint8 *const first = window.data.constData();
+		patterns.scan(patterns.initialState(), first, first + window.data.size(), [&](int index, std::size_t end) {
+			if(end > window.repeated) {
+				const edb::address_t addr = window.address + end - patterns.pattern(index).size();
+				results.push_back(SearchResult{addr, labels[index], index, static_cast<quint32>(patterns.pattern(index).size())});
+			}
+		});
+
+		return results;
+	}, longest - 1);
+
+	edb::v1::memory_regions().sync();
+	const QList<std::shared_ptr<IRegion>> regions = edb::v1::memory_regions().regions();
+
+	int i = 0;
+	for(const std::shared_ptr<IRegion> &region: regions) {
+		// a short circut for speading things up
+		if(ui->chkSkipNoAccess->isChecked() && !region->accessible()) {
+			ui->progressBar->setValue(util::percentage(++i, regions.size()));
+			continue;
+		}
+
+		search.run(region, [this](const QVector<SearchResult> &results) {
+			ui->listView->results()->append(results);
+		}, [this, i, &regions](int progress) {
+			ui->progressBar->setValue(util::percentage(i, regions.size(), progress, 100));
+		});
+
+		++i;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnFind_clicked
+// Desc: find button event handler
+//------------------------------------------------------------------------------
+void DialogMultiPattern::on_btnFind_clicked() {
+
+	ui->btnFind->setEnabled(false);
+	ui->progressBar->setValue(0);
+	do_find();
+	ui->progressBar->setValue(100);
+	ui->btnFind->setEnabled(true);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnLoad_clicked
+// Desc: reads the patterns from a file, in the same format as they are typed
+//------------------------------------------------------------------------------
+void DialogMultiPattern::on_btnLoad_clicked() {
+
+	const QString file_name = QFileDialog::getOpenFileName(this, tr("Pattern File"), QDir::homePath());
+	if(file_name.isEmpty()) {
+		return;
+	}
+
+	QFile file(file_name);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		QMessageBox::critical(this, tr("Error Opening File"), tr("Unable to open pattern file: %1").arg(file_name));
+		return;
+	}
+
+	ui->txtPatterns->setPlainText(QString::fromLatin1(file.readAll()));
+}
+
+//------------------------------------------------------------------------------
+// Name: on_listView_doubleClicked
+// Desc: follows the found item in the data view
+//------------------------------------------------------------------------------
+void DialogMultiPattern::on_listView_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong();
+	edb::v1::dump_data(addr, false);
+}
+
+}
@@ -0,0 +1,200 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "DialogRegexSearch.h"
+#include "RegexDFA.h"
+#include "edb.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
+#include <QMessageBox>
+#include <QVector>
+
+#include <algorithm>
+
+#include "ui_DialogRegexSearch.h"
+
+namespace BinarySearcherPlugin {
+
+namespace {
+
+// longer matches are still found whole, only their text is cut short
+const int MAX_TEXT_SIZE = 128;
+
+//------------------------------------------------------------------------------
+// Name: match_text
+// Desc: the matched characters, quoted like a C string literal
+//------------------------------------------------------------------------------
+QString match_text(const quint8 *p, std::size_t size, RegexDFA::Encoding encoding) {
+
+	const std::size_t width = (encoding == RegexDFA::Utf16) ? 2 : 1;
+
+	QString text = (encoding == RegexDFA::Utf16) ? QLatin1String("L\"") : QLatin1String("\"");
+	for(std::size_t i = 0; i < size; i += width) {
+		if(text.size() >= MAX_TEXT_SIZE) {
+			text += QLatin1String("...");
+			break;
+		}
+
+		const QChar ch(static_cast<ushort>(p[i]));
+		text += ch.isPrint() ? ch : QChar('.');
+	}
+	text += QLatin1Char('"');
+	return text;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DialogRegexSearch
+// Desc: constructor
+//------------------------------------------------------------------------------
+DialogRegexSearch::DialogRegexSearch(QWidget *parent) : QDialog(parent), ui(new Ui::DialogRegexSearch) {
+	ui->setupUi(this);
+	ui->progressBar->setValue(0);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogRegexSearch
+// Desc:
+//------------------------------------------------------------------------------
+DialogRegexSearch::~DialogRegexSearch() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_find
+// Desc:
+//------------------------------------------------------------------------------
+void DialogRegexSearch::do_find() {
+
+	ui->listView->results()->clear();
+
+	const QString pattern     = ui->txtRegex->text();
+	const bool case_sensitive = ui->chkCaseSensitive->isChecked();
+
+	if(!ui->chkAscii->isChecked() && !ui->chkUtf16->isChecked()) {
+		QMessageBox::warning(this, tr("Nothing To Search"), tr("Choose at least one of the encodings to search."));
+		return;
+	}
+
+	// one compiled expression for each encoding, their index is the tag of
+	// the results
+	QVector<RegexDFA> expressions;
+	for(const RegexDFA::Encoding encoding : {RegexDFA::Ascii, RegexDFA::Utf16}) {
+		const QCheckBox *const enabled = (encoding == RegexDFA::Ascii) ? ui->chkAscii : ui->chkUtf16;
+		if(!enabled->isChecked()) {
+			continue;
+		}
+
+		RegexDFA regex;
+		const Status status = regex.compile(pattern, encoding, case_sensitive);
+		if(!status) {
+			QMessageBox::warning(this, tr("Invalid Expression"), status.toString());
+			return;
+		}
+		expressions.push_back(regex);
+	}
+
+	std::size_t longest = 0;
+	for(const RegexDFA &regex : expressions) {
+		longest = std::max(longest, regex.maxSize());
+	}
+
+	// every window only reports the matches starting before its tail, so
+	// they are whole in it, and leaves the others to the next one. A match
+	// which the previous window found can still run into the start of this
+	// one, where a search starting afresh may find a piece of it; those are
+	// dropped below, once the results are back in order
+	const RegionSearch search([expressions, longest](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+
+		const quint8 *const first = window.data.constData();
+		const std::size_t size    = window.data.size();
+		const std::size_t tail    = window.continued ? std::min(size, longest - 1) : 0;
+
+		for(int tag = 0; tag < expressions.size(); ++tag) {
+			const RegexDFA &regex = expressions[tag];
+			for(const RegexDFA::Match &match : regex.scan(first, first + size, size - tail)) {
+				const QString text = match_text(first + match.offset, match.size, regex.encoding());
+				results.push_back(SearchResult{window.address + match.offset, text, tag, static_cast<quint32>(match.size)});
+			}
+		}
+
+		if(expressions.size() > 1) {
+			std::stable_sort(results.begin(), results.end(), [](const SearchResult &lhs, const SearchResult &rhs) {
+				return lhs.address < rhs.address;
+			});
+		}
+
+		return results;
+	}, longest - 1);
+
+	edb::v1::memory_regions().sync();
+
+	QList<std::shared_ptr<IRegion>> regions;
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		// a short circut for speading things up
+		if(!ui->chkSkipNoAccess->isChecked() || region->accessible()) {
+			regions.push_back(region);
+		}
+	}
+
+	// where the last match of each encoding ended
+	QVector<edb::address_t> ends(expressions.size(), 0);
+
+	search.run(regions, [this, &ends](const QVector<SearchResult> &results) {
+		QVector<SearchResult> kept;
+		for(const SearchResult &result : results) {
+			if(result.address >= ends[result.tag]) {
+				ends[result.tag] = result.address + result.size;
+				kept.push_back(result);
+			}
+		}
+		ui->listView->results()->append(kept);
+	}, [this](int progress) {
+		ui->progressBar->setValue(progress);
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnFind_clicked
+// Desc: find button event handler
+//------------------------------------------------------------------------------
+void DialogRegexSearch::on_btnFind_clicked() {
+
+	ui->btnFind->setEnabled(false);
+	ui->progressBar->setValue(0);
+	do_find();
+	ui->progressBar->setValue(100);
+	ui->btnFind->setEnabled(true);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_listView_doubleClicked
+// Desc: follows the found item in the data view
+//------------------------------------------------------------------------------
+void DialogRegexSearch::on_listView_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong();
+	edb::v1::dump_data(addr, false);
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DIALOG_REGEX_SEARCH_20170716_H_
+#define DIALOG_REGEX_SEARCH_20170716_H_
+
+#include <QDialog>
+
+class QModelIndex;
+
+namespace BinarySearcherPlugin {
+
+namespace Ui { class DialogRegexSearch; }
+
+class DialogRegexSearch : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogRegexSearch(QWidget *parent = 0);
+	virtual ~DialogRegexSearch();
+
+public Q_SLOTS:
+	void on_btnFind_clicked();
+	void on_listView_doubleClicked(const QModelIndex &index);
+
+private:
+	void do_find();
+
+private:
+	 Ui::DialogRegexSearch *const ui;
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PatternSet.h"
+
+#include <QQueue>
+
+#include <algorithm>
+
+namespace BinarySearcherPlugin {
+
+//------------------------------------------------------------------------------
+// Name: PatternSet
+// Desc: constructor
+//------------------------------------------------------------------------------
+PatternSet::PatternSet() {
+	build();
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: returns the index of <pattern>, identical patterns share one. Empty
+//       ones can't be found and are refused with -1. build() has to be called
+//       before the next scan
+//------------------------------------------------------------------------------
+int PatternSet::add(const QByteArray &pattern) {
+
+	if(pattern.isEmpty()) {
+		return -1;
+	}
+
+	const int existing = patterns_.indexOf(pattern);
+	if(existing != -1) {
+		return existing;
+	}
+
+	patterns_.push_back(pattern);
+	return patterns_.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+// Name: build
+// Desc: makes the automaton for the patterns added so far
+//------------------------------------------------------------------------------
+void PatternSet::build() {
+
+	next_   = QVector<int>(256, -1);
+	output_ = QVector<int>(1, -1);
+	suffix_ = QVector<int>(1, -1);
+
+	// the trie of the patterns
+	for(int i = 0; i < patterns_.size(); ++i) {
+		int state = 0;
+		for(const char ch : patterns_[i]) {
+			const int index = state * 256 + static_cast<quint8>(ch);
+			if(next_[index] == -1) {
+				next_[index] = output_.size();
+				next_.resize(next_.size() + 256);
+				std::fill(next_.end() - 256, next_.end(), -1);
+				output_.push_back(-1);
+				suffix_.push_back(-1);
+			}
+			state = next_[index];
+		}
+		output_[state] = i;
+	}
+
+	// then the missing transitions, breadth first, so the failure state of
+	// whatever is dequeued is already complete
+	QVector<int> failure(output_.size(), 0);
+	QQueue<int>  queue;
+
+	for(int ch = 0; ch < 256; ++ch) {
+		if(next_[ch] == -1) {
+			next_[ch] = 0;
+		} else {
+			queue.enqueue(next_[ch]);
+		}
+	}
+
+	while(!queue.isEmpty()) {
+		const int state = queue.dequeue();
+
+		for(int ch = 0; ch < 256; ++ch) {
+			const int fallback = next_[failure[state] * 256 + ch];
+			int &target        = next_[state * 256 + ch];
+
+			if(target == -1) {
+				target = fallback;
+			} else {
+				failure[target] = fallback;
+				suffix_[target] = (output_[fallback] != -1) ? fallback : suffix_[fallback];
+				queue.enqueue(target);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: runs [first, last) through the automaton, starting in <state>, calls
+//       <match> for every occurrence of every pattern which ends in it and
+//       returns the state to continue in
+//------------------------------------------------------------------------------
+PatternSet::State PatternSet::scan(State state, const quint8 *first, const quint8 *last, const MatchFunction &match) const {
+
+	const int *const next = next_.constData();
+
+	for(const quint8 *p = first; p != last; ++p) {
+		state = next[state * 256 + *p];
+
+		int found = (output_[state] != -1) ? state : suffix_[state];
+		while(found != -1) {
+			match(output_[found], (p - first) + 1);
+			found = suffix_[found];
+		}
+	}
+
+	return state;
+}
+
+}
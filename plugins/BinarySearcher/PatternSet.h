@@ -0,0 +1,66 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PATTERN_SET_20170716_H_
+#define PATTERN_SET_20170716_H_
+
+#include <QByteArray>
+#include <QVector>
+#include <cstddef>
+#include <functional>
+
+namespace BinarySearcherPlugin {
+
+// Finds any number of byte strings in one pass, with an Aho-Corasick
+// automaton whose transitions are all worked out up front, so each byte of
+// input costs one table lookup no matter how many patterns there are. The
+// scan can be resumed, feeding it contiguous windows one after another with
+// the same State finds the matches which span them
+class PatternSet {
+public:
+	typedef int State;
+
+	// the index of the pattern, and the offset just past its last byte
+	typedef std::function<void(int, std::size_t)> MatchFunction;
+
+public:
+	PatternSet();
+
+public:
+	int add(const QByteArray &pattern);
+	void build();
+
+public:
+	int count() const                 { return patterns_.size(); }
+	bool isEmpty() const              { return patterns_.isEmpty(); }
+	QByteArray pattern(int n) const   { return patterns_[n]; }
+	State initialState() const        { return 0; }
+
+public:
+	State scan(State state, const quint8 *first, const quint8 *last, const MatchFunction &match) const;
+
+private:
+	QVector<QByteArray> patterns_;
+	QVector<int>        next_;    // 256 transitions a state
+	QVector<int>        output_;  // the pattern ending at each state, or -1
+	QVector<int>        suffix_;  // the next state down the suffix chain with an output, or -1
+};
+
+}
+
+#endif
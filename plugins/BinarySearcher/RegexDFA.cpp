@@ -0,0 +1,932 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "RegexDFA.h"
+
+#include <QObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <map>
+#include <vector>
+
+namespace BinarySearcherPlugin {
+
+namespace {
+
+// patterns which would need more than these are refused rather than built,
+// the tables of a DFA this size already take a few megabytes
+const int         MAX_REPEAT     = 1000;
+const int         MAX_NFA_STATES = 100000;
+const int         MAX_DFA_STATES = 8192;
+const std::size_t MAX_MATCH_SIZE = 4096;
+
+typedef std::bitset<256> ByteSet;
+
+struct Node {
+	enum Kind {
+		Set,
+		Concat,
+		Alternate,
+		Repeat
+	};
+
+	Kind         kind;
+	ByteSet      set;
+	QVector<int> children;
+	int          min = 0;
+	int          max = 0; // -1 for no limit
+};
+
+//------------------------------------------------------------------------------
+// Name: fold
+// Desc: adds the other case of every letter in <set>
+//------------------------------------------------------------------------------
+ByteSet fold(const ByteSet &set) {
+	ByteSet folded = set;
+	for(int c = 0; c < 256; ++c) {
+		if(set[c]) {
+			const ushort lower = QChar(c).toLower().unicode();
+			const ushort upper = QChar(c).toUpper().unicode();
+			if(lower < 256) {
+				folded.set(lower);
+			}
+			if(upper < 256) {
+				folded.set(upper);
+			}
+		}
+	}
+	return folded;
+}
+
+// A recursive descent parser making a tree of Nodes, where every character,
+// class and escape has become the set of bytes it stands for
+class Parser {
+public:
+	Parser(const QString &pattern, bool case_sensitive) : pattern_(pattern), pos_(0), case_sensitive_(case_sensitive) {
+	}
+
+public:
+	Status parse(int *root) {
+		const Status status = alternation(root);
+		if(status && pos_ != pattern_.size()) {
+			return error(QObject::tr("Unbalanced ')'"));
+		}
+		return status;
+	}
+
+	const std::vector<Node> &nodes() const { return nodes_; }
+
+private:
+	Status error(const QString &what) const {
+		return Status(QObject::tr("%1 at offset %2 of the expression.").arg(what).arg(pos_));
+	}
+
+	bool at_end() const     { return pos_ >= pattern_.size(); }
+	bool at(char ch) const  { return !at_end() && pattern_[pos_] == QLatin1Char(ch); }
+
+	int add_node(Node::Kind kind) {
+		Node node;
+		node.kind = kind;
+		nodes_.push_back(node);
+		return nodes_.size() - 1;
+	}
+
+	int add_set(const ByteSet &set) {
+		const int node = add_node(Node::Set);
+		nodes_[node].set = set;
+		return node;
+	}
+
+private:
+	Status alternation(int *node);
+	Status concatenation(int *node);
+	Status repetition(int *node);
+	Status bounds(int *min, int *max);
+	Status atom(int *node);
+	Status bracket(ByteSet *set);
+	Status escape(ByteSet *set);
+	Status character(ByteSet *set, int *byte);
+
+private:
+	QString           pattern_;
+	int               pos_;
+	bool              case_sensitive_;
+	std::vector<Node> nodes_;
+};
+
+//------------------------------------------------------------------------------
+// Name: alternation
+// Desc:
+//------------------------------------------------------------------------------
+Status Parser::alternation(int *node) {
+
+	int branch;
+	Status status = concatenation(&branch);
+	if(!status || !at('|')) {
+		*node = branch;
+		return status;
+	}
+
+	*node = add_node(Node::Alternate);
+	nodes_[*node].children.push_back(branch);
+
+	while(at('|')) {
+		++pos_;
+		status = concatenation(&branch);
+		if(!status) {
+			return status;
+		}
+		nodes_[*node].children.push_back(branch);
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: concatenation
+// Desc: may be empty, as in "a|"
+//------------------------------------------------------------------------------
+Status Parser::concatenation(int *node) {
+
+	*node = add_node(Node::Concat);
+
+	while(!at_end() && !at('|') && !at(')')) {
+		int item;
+		const Status status = repetition(&item);
+		if(!status) {
+			return status;
+		}
+		nodes_[*node].children.push_back(item);
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: repetition
+// Desc: an atom followed by any number of quantifiers
+//------------------------------------------------------------------------------
+Status Parser::repetition(int *node) {
+
+	Status status = atom(node);
+
+	while(status && !at_end()) {
+		int min;
+		int max;
+
+		if(at('*')) {
+			min = 0;
+			max = -1;
+			++pos_;
+		} else if(at('+')) {
+			min = 1;
+			max = -1;
+			++pos_;
+		} else if(at('?')) {
+			min = 0;
+			max = 1;
+			++pos_;
+		} else if(at('{')) {
+			status = bounds(&min, &max);
+			if(!status) {
+				break;
+			}
+		} else {
+			break;
+		}
+
+		const int repeat = add_node(Node::Repeat);
+		nodes_[repeat].children.push_back(*node);
+		nodes_[repeat].min = min;
+		nodes_[repeat].max = max;
+		*node = repeat;
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+// Name: bounds
+// Desc: {n}, {n,} or {n,m}
+//------------------------------------------------------------------------------
+Status Parser::bounds(int *min, int *max) {
+
+	const int close = pattern_.indexOf('}', pos_);
+	if(close == -1) {
+		return error(QObject::tr("Missing '}'"));
+	}
+
+	const QStringList counts = pattern_.mid(pos_ + 1, close - pos_ - 1).split(',');
+
+	bool ok = counts.size() <= 2;
+	if(ok) {
+		*min = counts[0].toInt(&ok);
+	}
+
+	if(ok && counts.size() == 2) {
+		if(counts[1].isEmpty()) {
+			*max = -1;
+		} else {
+			*max = counts[1].toInt(&ok);
+			ok = ok && *max >= *min;
+		}
+	} else if(ok) {
+		*max = *min;
+	}
+
+	if(!ok || *min < 0) {
+		return error(QObject::tr("Invalid repetition count"));
+	}
+
+	if(*min > MAX_REPEAT || *max > MAX_REPEAT) {
+		return error(QObject::tr("Repetition counts over %1 are not supported").arg(MAX_REPEAT));
+	}
+
+	pos_ = close + 1;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: atom
+// Desc:
+//------------------------------------------------------------------------------
+Status Parser::atom(int *node) {
+
+	const QChar ch = pattern_[pos_++];
+
+	switch(ch.unicode()) {
+	case '(':
+		if(at('?')) {
+			if(pattern_.mid(pos_, 2) != QLatin1String("?:")) {
+				return error(QObject::tr("Only (?:...) groups are supported"));
+			}
+			pos_ += 2;
+		}
+
+		if(const Status status = alternation(node)) {
+			if(!at(')')) {
+				return error(QObject::tr("Missing ')'"));
+			}
+			++pos_;
+			return Status::Ok;
+		} else {
+			return status;
+		}
+
+	case '[': {
+		ByteSet set;
+		const Status status = bracket(&set);
+		*node = add_set(set);
+		return status;
+	}
+
+	case '.': {
+		ByteSet set;
+		set.set();
+		set.reset('\n');
+		*node = add_set(set);
+		return Status::Ok;
+	}
+
+	case '^':
+	case '$':
+		--pos_;
+		return error(QObject::tr("Memory has no lines, anchors are not supported"));
+
+	case '*':
+	case '+':
+	case '?':
+	case '{':
+		--pos_;
+		return error(QObject::tr("Nothing to repeat"));
+
+	default: {
+		--pos_;
+
+		ByteSet set;
+		int byte;
+		const Status status = character(&set, &byte);
+		*node = add_set(case_sensitive_ ? set : fold(set));
+		return status;
+	}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: bracket
+// Desc: a [class], just past the '['
+//------------------------------------------------------------------------------
+Status Parser::bracket(ByteSet *set) {
+
+	set->reset();
+
+	const bool negate = at('^');
+	if(negate) {
+		++pos_;
+	}
+
+	// a ']' right at the start is taken literally
+	bool first = true;
+
+	while(true) {
+		if(at_end()) {
+			return error(QObject::tr("Missing ']'"));
+		}
+
+		if(at(']') && !first) {
+			++pos_;
+			break;
+		}
+
+		first = false;
+
+		ByteSet item;
+		int low;
+		Status status = character(&item, &low);
+		if(!status) {
+			return status;
+		}
+
+		if(at('-') && pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] != QLatin1Char(']')) {
+			++pos_;
+
+			int high;
+			status = character(&item, &high);
+			if(!status) {
+				return status;
+			}
+
+			if(low == -1 || high == -1 || high < low) {
+				return error(QObject::tr("Invalid range"));
+			}
+
+			for(int c = low; c <= high; ++c) {
+				set->set(c);
+			}
+		} else {
+			*set |= item;
+		}
+	}
+
+	if(!case_sensitive_) {
+		*set = fold(*set);
+	}
+
+	if(negate) {
+		set->flip();
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: character
+// Desc: a single character or an escape. <byte> is the byte it stands for,
+//       or -1 for an escape standing for a whole class
+//------------------------------------------------------------------------------
+Status Parser::character(ByteSet *set, int *byte) {
+
+	set->reset();
+	*byte = -1;
+
+	const QChar ch = pattern_[pos_];
+
+	if(ch == QLatin1Char('\\')) {
+		++pos_;
+		const Status status = escape(set);
+		if(status && set->count() == 1) {
+			for(int c = 0; c < 256; ++c) {
+				if((*set)[c]) {
+					*byte = c;
+				}
+			}
+		}
+		return status;
+	}
+
+	if(ch.unicode() > 0xff) {
+		return error(QObject::tr("Only characters up to U+00FF can be searched for"));
+	}
+
+	*byte = ch.unicode();
+	set->set(*byte);
+	++pos_;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: escape
+// Desc: just past the '\'
+//------------------------------------------------------------------------------
+Status Parser::escape(ByteSet *set) {
+
+	if(at_end()) {
+		return error(QObject::tr("Trailing '\\'"));
+	}
+
+	const QChar ch = pattern_[pos_++];
+
+	switch(ch.unicode()) {
+	case 'd':
+	case 'D':
+		for(int c = '0'; c <= '9'; ++c) {
+			set->set(c);
+		}
+		break;
+	case 'w':
+	case 'W':
+		for(int c = 0; c < 128; ++c) {
+			if(std::isalnum(c) || c == '_') {
+				set->set(c);
+			}
+		}
+		break;
+	case 's':
+	case 'S':
+		for(const char c : {' ', '\t', '\n', '\r', '\f', '\v'}) {
+			set->set(c);
+		}
+		break;
+	case 'n': set->set('\n'); break;
+	case 'r': set->set('\r'); break;
+	case 't': set->set('\t'); break;
+	case 'f': set->set('\f'); break;
+	case 'v': set->set('\v'); break;
+	case '0': set->set(0);    break;
+	case 'x': {
+		bool ok;
+		const int value = pattern_.mid(pos_, 2).toInt(&ok, 16);
+		if(!ok || pattern_.mid(pos_, 2).size() != 2) {
+			return error(QObject::tr("\\x needs two hex digits"));
+		}
+		set->set(value);
+		pos_ += 2;
+		break;
+	}
+	default:
+		if(ch.isLetterOrNumber() || ch.unicode() > 0xff) {
+			--pos_;
+			return error(QObject::tr("Unsupported escape \\%1").arg(ch));
+		}
+		set->set(ch.unicode());
+		break;
+	}
+
+	if(ch.isUpper()) {
+		set->flip();
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: match_size
+// Desc: the fewest or the most bytes <node> can match, which are never
+//       counted past MAX_MATCH_SIZE + 1, so that stands for no limit
+//------------------------------------------------------------------------------
+std::size_t match_size(const std::vector<Node> &nodes, int index, std::size_t width, bool most) {
+
+	const std::size_t unlimited = MAX_MATCH_SIZE + 1;
+	const Node &node = nodes[index];
+
+	std::size_t size = 0;
+
+	switch(node.kind) {
+	case Node::Set:
+		size = width;
+		break;
+	case Node::Concat:
+		for(int child : node.children) {
+			size += match_size(nodes, child, width, most);
+		}
+		break;
+	case Node::Alternate:
+		size = most ? 0 : unlimited;
+		for(int child : node.children) {
+			const std::size_t n = match_size(nodes, child, width, most);
+			size = most ? std::max(size, n) : std::min(size, n);
+		}
+		break;
+	case Node::Repeat: {
+		const std::size_t n = match_size(nodes, node.children.front(), width, most);
+		if(!most) {
+			size = n * node.min;
+		} else if(node.max == -1) {
+			size = (n == 0) ? 0 : unlimited;
+		} else {
+			size = n * node.max;
+		}
+		break;
+	}
+	}
+
+	return std::min(size, unlimited);
+}
+
+struct NfaState {
+	ByteSet bytes;     // none for an epsilon move
+	int     next = -1;
+	int     alt  = -1; // a second epsilon move, for a split
+};
+
+// Thompson's construction, built back to front so that every state is made
+// knowing where it goes. State 0 is the one to reach
+class NfaBuilder {
+public:
+	NfaBuilder(const std::vector<Node> &nodes, RegexDFA::Encoding encoding) : nodes_(nodes), encoding_(encoding), overflow_(false) {
+		states_.push_back(NfaState());
+	}
+
+public:
+	int build(int index, int out);
+	bool overflowed() const                     { return overflow_; }
+	const std::vector<NfaState> &states() const { return states_; }
+
+private:
+	int add(const ByteSet &bytes, int next, int alt = -1) {
+		if(states_.size() >= static_cast<std::size_t>(MAX_NFA_STATES)) {
+			overflow_ = true;
+			return 0;
+		}
+
+		NfaState state;
+		state.bytes = bytes;
+		state.next  = next;
+		state.alt   = alt;
+		states_.push_back(state);
+		return states_.size() - 1;
+	}
+
+private:
+	const std::vector<Node> &nodes_;
+	RegexDFA::Encoding       encoding_;
+	std::vector<NfaState>    states_;
+	bool                     overflow_;
+};
+
+//------------------------------------------------------------------------------
+// Name: build
+// Desc: returns the state which matches <index> and then goes on to <out>
+//------------------------------------------------------------------------------
+int NfaBuilder::build(int index, int out) {
+
+	if(overflow_) {
+		return out;
+	}
+
+	const Node &node = nodes_[index];
+
+	switch(node.kind) {
+	case Node::Set:
+		if(encoding_ == RegexDFA::Utf16) {
+			out = add(ByteSet().set(0), out);
+		}
+		return add(node.set, out);
+
+	case Node::Concat:
+		for(int i = node.children.size() - 1; i >= 0; --i) {
+			out = build(node.children[i], out);
+		}
+		return out;
+
+	case Node::Alternate: {
+		int start = build(node.children.last(), out);
+		for(int i = node.children.size() - 2; i >= 0; --i) {
+			start = add(ByteSet(), build(node.children[i], out), start);
+		}
+		return start;
+	}
+
+	case Node::Repeat: {
+		const int child = node.children.front();
+		const int exit  = out;
+
+		if(node.max == -1) {
+			// either once more around or out
+			const int loop = add(ByteSet(), -1, exit);
+			const int body = build(child, loop);
+			if(!overflow_) {
+				states_[loop].next = body;
+			}
+			out = loop;
+		} else {
+			// the optional ones nest, x{0,2} is (x(x)?)?
+			for(int i = node.min; i < node.max; ++i) {
+				out = add(ByteSet(), build(child, out), exit);
+			}
+		}
+
+		for(int i = 0; i < node.min; ++i) {
+			out = build(child, out);
+		}
+		return out;
+	}
+	}
+
+	return out;
+}
+
+//------------------------------------------------------------------------------
+// Name: make_classes
+// Desc: splits the bytes into the classes which every set of the NFA either
+//       takes whole or not at all, returns how many there are
+//------------------------------------------------------------------------------
+int make_classes(const std::vector<NfaState> &nfa, std::array<quint8, 256> *classes) {
+
+	classes->fill(0);
+	int count = 1;
+
+	for(const NfaState &state : nfa) {
+		if(state.bytes.none()) {
+			continue;
+		}
+
+		int remap[256][2];
+		std::fill(&remap[0][0], &remap[0][0] + 512, -1);
+
+		int refined = 0;
+		for(int c = 0; c < 256; ++c) {
+			int &target = remap[(*classes)[c]][state.bytes[c]];
+			if(target == -1) {
+				target = refined++;
+			}
+			(*classes)[c] = target;
+		}
+		count = refined;
+	}
+
+	return count;
+}
+
+// The subset construction. Sets of NFA states only keep those which consume
+// a byte, and the one to reach, so that sets which only differ in how they
+// got there are the same DFA state
+class DfaBuilder {
+public:
+	DfaBuilder(const std::vector<NfaState> &nfa, const std::array<quint8, 256> &classes, int class_count) : nfa_(nfa), class_count_(class_count), marks_(nfa.size(), 0), generation_(0) {
+		representatives_.resize(class_count);
+		for(int c = 255; c >= 0; --c) {
+			representatives_[classes[c]] = c;
+		}
+	}
+
+public:
+	Status build(int start, bool search, QVector<int> *next, QVector<bool> *accept);
+
+private:
+	std::vector<int> closure(const std::vector<int> &seeds);
+
+private:
+	const std::vector<NfaState> &nfa_;
+	int                          class_count_;
+	QVector<int>                 representatives_;
+	std::vector<int>             marks_;
+	int                          generation_;
+};
+
+//------------------------------------------------------------------------------
+// Name: closure
+// Desc: the sorted states reachable from <seeds> without consuming anything
+//------------------------------------------------------------------------------
+std::vector<int> DfaBuilder::closure(const std::vector<int> &seeds) {
+
+	++generation_;
+
+	std::vector<int> result;
+	std::vector<int> stack(seeds);
+
+	while(!stack.empty()) {
+		const int index = stack.back();
+		stack.pop_back();
+
+		if(index == -1 || marks_[index] == generation_) {
+			continue;
+		}
+		marks_[index] = generation_;
+
+		const NfaState &state = nfa_[index];
+		if(state.bytes.any() || index == 0) {
+			result.push_back(index);
+		} else {
+			stack.push_back(state.next);
+			stack.push_back(state.alt);
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// Name: build
+// Desc: with <search> every state also starts a new match, so the DFA runs
+//       over any amount of input and accepts wherever a match ends. Without
+//       it state 0 is the dead one and 1 the start
+//------------------------------------------------------------------------------
+Status DfaBuilder::build(int start, bool search, QVector<int> *next, QVector<bool> *accept) {
+
+	std::map<std::vector<int>, int>      ids;
+	std::vector<const std::vector<int> *> sets;
+
+	auto intern = [&](const std::vector<int> &set) {
+		auto it = ids.find(set);
+		if(it == ids.end()) {
+			if(sets.size() >= static_cast<std::size_t>(MAX_DFA_STATES)) {
+				return -1;
+			}
+			it = ids.insert(std::make_pair(set, static_cast<int>(sets.size()))).first;
+			sets.push_back(&it->first);
+		}
+		return it->second;
+	};
+
+	const std::vector<int> initial = closure(std::vector<int>(1, start));
+
+	if(!search) {
+		intern(std::vector<int>());
+	}
+	intern(initial);
+
+	next->clear();
+	accept->clear();
+
+	for(std::size_t n = 0; n < sets.size(); ++n) {
+		const std::vector<int> &set = *sets[n];
+
+		accept->push_back(std::binary_search(set.begin(), set.end(), 0));
+
+		for(int cls = 0; cls < class_count_; ++cls) {
+			const int byte = representatives_[cls];
+
+			std::vector<int> seeds;
+			for(const int index : set) {
+				if(nfa_[index].bytes[byte]) {
+					seeds.push_back(nfa_[index].next);
+				}
+			}
+
+			if(search) {
+				seeds.push_back(start);
+			}
+
+			const int id = intern(closure(seeds));
+			if(id == -1) {
+				return Status(QObject::tr("The expression is too complex, it needs more than %1 states.").arg(MAX_DFA_STATES));
+			}
+			next->push_back(id);
+		}
+	}
+
+	return Status::Ok;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: compile
+// Desc: replaces whatever was compiled before only if <pattern> is valid
+//------------------------------------------------------------------------------
+Status RegexDFA::compile(const QString &pattern, Encoding encoding, bool case_sensitive) {
+
+	Parser parser(pattern, case_sensitive);
+
+	int root;
+	Status status = parser.parse(&root);
+	if(!status) {
+		return status;
+	}
+
+	const std::size_t width = (encoding == Utf16) ? 2 : 1;
+
+	if(match_size(parser.nodes(), root, width, false) == 0) {
+		return Status(QObject::tr("The expression matches an empty string, which is found everywhere."));
+	}
+
+	NfaBuilder nfa(parser.nodes(), encoding);
+	const int start = nfa.build(root, 0);
+	if(nfa.overflowed()) {
+		return Status(QObject::tr("The expression is too large, it needs more than %1 states.").arg(MAX_NFA_STATES));
+	}
+
+	std::array<quint8, 256> classes;
+	const int class_count = make_classes(nfa.states(), &classes);
+
+	DfaBuilder dfa(nfa.states(), classes, class_count);
+
+	QVector<int>  search_next;
+	QVector<bool> search_accept;
+	QVector<int>  anchored_next;
+	QVector<bool> anchored_accept;
+
+	status = dfa.build(start, true, &search_next, &search_accept);
+	if(status) {
+		status = dfa.build(start, false, &anchored_next, &anchored_accept);
+	}
+
+	if(!status) {
+		return status;
+	}
+
+	encoding_        = encoding;
+	max_size_        = std::min(match_size(parser.nodes(), root, width, true), MAX_MATCH_SIZE);
+	class_count_     = class_count;
+	classes_         = classes;
+	search_next_     = search_next;
+	search_accept_   = search_accept;
+	anchored_next_   = anchored_next;
+	anchored_accept_ = anchored_accept;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: longest
+// Desc: the size of the longest match starting at <first>, or 0 if none does
+//------------------------------------------------------------------------------
+std::size_t RegexDFA::longest(const quint8 *first, const quint8 *last) const {
+
+	const std::size_t available = std::min<std::size_t>(last - first, max_size_);
+	const int *const next       = anchored_next_.constData();
+
+	std::size_t found = 0;
+	int state = 1;
+
+	for(std::size_t i = 0; i < available; ++i) {
+		state = next[state * class_count_ + classes_[first[i]]];
+		if(state == 0) {
+			break;
+		}
+
+		if(anchored_accept_[state]) {
+			found = i + 1;
+		}
+	}
+
+	return found;
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: the leftmost-longest matches in [first, last) which don't overlap one
+//       another and start below <limit>. Once the search DFA sees a match end
+//       the leftmost one can't start more than maxSize() before it, only
+//       those few starts are tried with the anchored DFA
+//------------------------------------------------------------------------------
+QVector<RegexDFA::Match> RegexDFA::scan(const quint8 *first, const quint8 *last, std::size_t limit) const {
+
+	QVector<Match> matches;
+
+	if(search_next_.isEmpty()) {
+		return matches;
+	}
+
+	const std::size_t size = std::min<std::size_t>(last - first, limit + max_size_);
+	const int *const next  = search_next_.constData();
+
+	std::size_t pos = 0;
+	int state = 0;
+
+	for(std::size_t i = 0; i < size && pos < limit; ++i) {
+		state = next[state * class_count_ + classes_[first[i]]];
+		if(!search_accept_[state]) {
+			continue;
+		}
+
+		const std::size_t end = i + 1;
+
+		std::size_t start = (end > max_size_) ? std::max(pos, end - max_size_) : pos;
+		for(; start < end && start < limit; ++start) {
+			if(const std::size_t n = longest(first + start, last)) {
+				matches.push_back(Match{start, n});
+
+				// the search starts over past it
+				pos   = start + n;
+				i     = pos - 1;
+				state = 0;
+				break;
+			}
+		}
+	}
+
+	return matches;
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef REGEX_DFA_20170716_H_
+#define REGEX_DFA_20170716_H_
+
+#include "Status.h"
+#include <QString>
+#include <QVector>
+#include <array>
+#include <cstddef>
+
+namespace BinarySearcherPlugin {
+
+// A regular expression compiled to two DFAs whose transitions are all worked
+// out up front: one which runs over memory a byte at a time and only notices
+// that some match has ended, and an anchored one which then finds where the
+// leftmost of them starts and how far it goes. The bulk of memory, where
+// nothing matches, costs one table lookup per byte.
+//
+// The syntax is the common subset: literals, '.', [classes], \d \w \s and
+// their negations, \xHH, groups, '|' and the *, +, ? and {n,m} quantifiers.
+// With Utf16 each character is searched for as UTF-16LE, so only the
+// characters up to U+00FF can be given. Matches never grow past maxSize(),
+// which a search with RegionSearch has to overlap its windows by less one
+class RegexDFA {
+public:
+	enum Encoding {
+		Ascii,
+		Utf16
+	};
+
+	struct Match {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+public:
+	RegexDFA() = default;
+
+public:
+	Status compile(const QString &pattern, Encoding encoding, bool case_sensitive);
+
+public:
+	Encoding encoding() const   { return encoding_; }
+	std::size_t maxSize() const { return max_size_; }
+
+public:
+	QVector<Match> scan(const quint8 *first, const quint8 *last, std::size_t limit) const;
+
+private:
+	std::size_t longest(const quint8 *first, const quint8 *last) const;
+
+private:
+	Encoding                encoding_    = Ascii;
+	std::size_t             max_size_    = 0;
+	int                     class_count_ = 1;
+	std::array<quint8, 256> classes_;          // bytes which no part of the pattern tells apart share a class
+	QVector<int>            search_next_;      // class_count_ transitions a state, state 0 is the start
+	QVector<bool>           search_accept_;
+	QVector<int>            anchored_next_;    // the same, but state 0 is dead and 1 the start
+	QVector<bool>           anchored_accept_;
+};
+
+}
+
+#endif
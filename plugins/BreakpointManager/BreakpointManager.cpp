@@ -18,9 +18,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "BreakpointManager.h"
 #include "DialogBreakpoints.h"
+#include "TraceLogWidget.h"
+#include "IDebugger.h"
 #include "edb.h"
+#include <QDockWidget>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QMainWindow>
 #include <QMenu>
+#include <QMessageBox>
 #include <QKeySequence>
+#include <QRegExp>
+#include <QStringList>
+#include <algorithm>
 
 namespace BreakpointManagerPlugin {
 
@@ -50,6 +60,25 @@ QMenu *BreakpointManager::menu(QWidget *parent) {
 	if(!menu_) {
 		menu_ = new QMenu(tr("BreakpointManager"), parent);
 		menu_->addAction(tr("&Breakpoints"), this, SLOT(show_menu()), QKeySequence(tr("Ctrl+B")));
+		menu_->addAction(tr("Break on &System Calls..."), this, SLOT(set_syscall_catchpoints()));
+
+		if(auto main_window = qobject_cast<QMainWindow *>(edb::v1::debugger_ui)) {
+			auto trace_log_widget = new TraceLogWidget;
+
+			// make the dock widget and _name_ it, it is important to name it so
+			// that it's state is saved in the GUI info
+			auto dock_widget = new QDockWidget(tr("Trace Log"), main_window);
+			dock_widget->setObjectName(QString::fromUtf8("Trace Log"));
+			dock_widget->setWidget(trace_log_widget);
+			dock_widget->hide();
+
+			main_window->addDockWidget(Qt::BottomDockWidgetArea, dock_widget);
+
+			// the log is only looked at when the debuggee stops
+			connect(edb::v1::disassembly_widget(), SIGNAL(signal_updated()), trace_log_widget, SLOT(refresh()));
+
+			menu_->addAction(dock_widget->toggleViewAction());
+		}
 	}
 
 	return menu_;
@@ -68,6 +97,60 @@ void BreakpointManager::show_menu() {
 	dialog_->show();
 }
 
+//------------------------------------------------------------------------------
+// Name: set_syscall_catchpoints
+// Desc: asks for the system call numbers to stop at, "*" for all of them and
+//       nothing to stop breaking on system calls
+//------------------------------------------------------------------------------
+void BreakpointManager::set_syscall_catchpoints() {
+
+	QString current;
+	if(edb::v1::debugger_core->syscall_catchpoints_enabled()) {
+		QList<int> numbers = edb::v1::debugger_core->syscall_catchpoints().toList();
+		std::sort(numbers.begin(), numbers.end());
+
+		QStringList list;
+		for(int number : numbers) {
+			list << QString::number(number);
+		}
+
+		current = list.isEmpty() ? QString("*") : list.join(", ");
+	}
+
+	bool ok;
+	const QString text = QInputDialog::getText(
+		edb::v1::debugger_ui,
+		tr("Break on System Calls"),
+		tr("System call numbers, \"*\" for all of them, or nothing to disable.\n"
+		   "Short lists set before launching run at full speed in between."),
+		QLineEdit::Normal,
+		current,
+		&ok).trimmed();
+
+	if(!ok) {
+		return;
+	}
+
+	QSet<int> syscalls;
+	if(!text.isEmpty() && text != "*") {
+		for(const QString &item : text.split(QRegExp("[\\s,]+"), QString::SkipEmptyParts)) {
+			bool valid;
+			const int number = item.toInt(&valid, 0);
+			if(!valid || number < 0) {
+				QMessageBox::critical(edb::v1::debugger_ui, tr("Break on System Calls"), tr("\"%1\" is not a system call number.").arg(item));
+				return;
+			}
+
+			syscalls.insert(number);
+		}
+	}
+
+	const Status status = edb::v1::debugger_core->set_syscall_catchpoints(!text.isEmpty(), syscalls);
+	if(!status) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Break on System Calls"), status.toString());
+	}
+}
+
 #if QT_VERSION < 0x050000
 Q_EXPORT_PLUGIN2(BreakpointManager, BreakpointManager)
 #endif
@@ -44,6 +44,7 @@ public:
 
 public Q_SLOTS:
 	void show_menu();
+	void set_syscall_catchpoints();
 
 private:
 	QMenu *   menu_;
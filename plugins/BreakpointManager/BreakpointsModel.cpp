@@ -0,0 +1,224 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BreakpointsModel.h"
+#include "IBreakpoint.h"
+#include "IDebugger.h"
+#include "edb.h"
+
+#include <QStringList>
+#include <algorithm>
+
+namespace BreakpointManagerPlugin {
+
+//------------------------------------------------------------------------------
+// Name: BreakpointsModel
+// Desc:
+//------------------------------------------------------------------------------
+BreakpointsModel::BreakpointsModel(QObject *parent) : QAbstractItemModel(parent) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~BreakpointsModel
+// Desc:
+//------------------------------------------------------------------------------
+BreakpointsModel::~BreakpointsModel() {
+}
+
+//------------------------------------------------------------------------------
+// Name: update
+// Desc: takes the addresses of the user's breakpoints from the core again,
+//       the internal ones aren't shown
+//------------------------------------------------------------------------------
+void BreakpointsModel::update() {
+
+	QVector<edb::address_t> addresses;
+	if(edb::v1::debugger_core) {
+		const IDebugger::BreakpointList breakpoints = edb::v1::debugger_core->backup_breakpoints();
+		addresses.reserve(breakpoints.size());
+		for(auto it = breakpoints.constBegin(); it != breakpoints.constEnd(); ++it) {
+			if(!it.value()->internal()) {
+				addresses.push_back(it.key());
+			}
+		}
+	}
+
+	std::sort(addresses.begin(), addresses.end());
+
+	// the same breakpoints as before, only what they show may have changed,
+	// and the view keeps its selection and scroll position
+	if(addresses == addresses_) {
+		if(!addresses_.isEmpty()) {
+			Q_EMIT dataChanged(index(0, 0), index(addresses_.size() - 1, columnCount() - 1));
+		}
+		return;
+	}
+
+	beginResetModel();
+	qSwap(addresses_, addresses);
+	functions_.clear();
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: address
+// Desc: the address of the breakpoint in the row of <index>
+//------------------------------------------------------------------------------
+edb::address_t BreakpointsModel::address(const QModelIndex &index) const {
+	return addresses_[index.row()];
+}
+
+//------------------------------------------------------------------------------
+// Name: type
+// Desc: what kind of breakpoint <bp> is, with its hit filters
+//------------------------------------------------------------------------------
+QString BreakpointsModel::type(const std::shared_ptr<IBreakpoint> &bp) const {
+
+	QString type;
+	if(bp->tracepoint) {
+		type = bp->trace_expression.isEmpty() ? tr("Tracepoint") : tr("Tracepoint: %1").arg(bp->trace_expression);
+	} else {
+		type = bp->one_time() ? tr("One Time") : tr("Standard");
+	}
+
+	QStringList filters;
+	if(bp->ignore_count != 0) {
+		filters << tr("from hit %1").arg(bp->ignore_count + 1);
+	}
+
+	if(bp->hit_limit != 0) {
+		filters << tr("until hit %1").arg(bp->hit_limit);
+	}
+
+	if(!bp->threads.isEmpty()) {
+		QStringList threads;
+		for(const edb::tid_t tid : bp->threads) {
+			threads << QString::number(tid);
+		}
+		threads.sort();
+		filters << tr("threads %1").arg(threads.join(", "));
+	}
+
+	if(!filters.isEmpty()) {
+		type = tr("%1 (%2)").arg(type, filters.join(", "));
+	}
+
+	return type;
+}
+
+//------------------------------------------------------------------------------
+// Name: function
+// Desc: the symbol lookup is the costly part of a row, so it is kept
+//------------------------------------------------------------------------------
+QString BreakpointsModel::function(edb::address_t address) const {
+	auto it = functions_.find(address);
+	if(it == functions_.end()) {
+		it = functions_.insert(address, edb::v1::find_function_symbol(address, QString(), 0));
+	}
+	return it.value();
+}
+
+//------------------------------------------------------------------------------
+// Name: data
+// Desc:
+//------------------------------------------------------------------------------
+QVariant BreakpointsModel::data(const QModelIndex &index, int role) const {
+
+	if(index.isValid() && (role == Qt::DisplayRole || role == Qt::UserRole)) {
+
+		const edb::address_t address = addresses_[index.row()];
+
+		// it may have been removed since the last update
+		const std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core ? edb::v1::debugger_core->find_breakpoint(address) : nullptr;
+
+		switch(index.column()) {
+		case 0:
+			if(role == Qt::UserRole) {
+				return static_cast<qulonglong>(address.toUint());
+			}
+			return edb::v1::format_pointer(address);
+		case 1: return bp ? bp->condition : QString();
+		case 2: return bp ? edb::v1::format_bytes(bp->original_bytes(), bp->size()) : QString();
+		case 3: return bp ? type(bp) : tr("Removed");
+		case 4: return function(address);
+		}
+	}
+
+	return QVariant();
+}
+
+//------------------------------------------------------------------------------
+// Name: index
+// Desc:
+//------------------------------------------------------------------------------
+QModelIndex BreakpointsModel::index(int row, int column, const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+
+	if(row >= rowCount(parent) || column >= columnCount(parent)) {
+		return QModelIndex();
+	}
+
+	return createIndex(row, column);
+}
+
+//------------------------------------------------------------------------------
+// Name: parent
+// Desc:
+//------------------------------------------------------------------------------
+QModelIndex BreakpointsModel::parent(const QModelIndex &index) const {
+	Q_UNUSED(index);
+	return QModelIndex();
+}
+
+//------------------------------------------------------------------------------
+// Name: rowCount
+// Desc:
+//------------------------------------------------------------------------------
+int BreakpointsModel::rowCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return addresses_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: columnCount
+// Desc:
+//------------------------------------------------------------------------------
+int BreakpointsModel::columnCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return 5;
+}
+
+//------------------------------------------------------------------------------
+// Name: headerData
+// Desc:
+//------------------------------------------------------------------------------
+QVariant BreakpointsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	if(role == Qt::DisplayRole && orientation == Qt::Horizontal) {
+		switch(section) {
+		case 0: return tr("Address");
+		case 1: return tr("Condition");
+		case 2: return tr("Original Byte");
+		case 3: return tr("Type");
+		case 4: return tr("Function");
+		}
+	}
+
+	return QVariant();
+}
+
+}
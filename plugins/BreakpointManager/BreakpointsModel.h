@@ -0,0 +1,66 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BREAKPOINTS_MODEL_20171014_H_
+#define BREAKPOINTS_MODEL_20171014_H_
+
+#include "Types.h"
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class IBreakpoint;
+
+namespace BreakpointManagerPlugin {
+
+// The user's breakpoints, by address. Only the addresses are kept, what a row
+// shows is looked up in the core's breakpoint table when it is shown, so that
+// tens of thousands of breakpoints cost no more than the rows on screen
+class BreakpointsModel : public QAbstractItemModel {
+	Q_OBJECT
+
+public:
+	BreakpointsModel(QObject *parent = 0);
+	virtual ~BreakpointsModel();
+
+public:
+	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+	virtual QModelIndex parent(const QModelIndex &index) const;
+	virtual QVariant data(const QModelIndex &index, int role) const;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+
+public:
+	void update();
+	edb::address_t address(const QModelIndex &index) const;
+
+private:
+	QString type(const std::shared_ptr<IBreakpoint> &bp) const;
+	QString function(edb::address_t address) const;
+
+private:
+	QVector<edb::address_t>                 addresses_;
+	mutable QHash<edb::address_t, QString>  functions_; // the symbols of the rows shown so far
+};
+
+}
+
+#endif
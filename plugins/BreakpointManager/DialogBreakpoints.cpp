@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogBreakpoints.h"
+#include "BreakpointsModel.h"
 #include "Expression.h"
 #include "IDebugger.h"
 #include "IBreakpoint.h"
@@ -25,7 +26,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QHeaderView>
 #include <QInputDialog>
+#include <QMenu>
 #include <QMessageBox>
+#include <QSortFilterProxyModel>
 
 #include <QDir>
 #include <QFileDialog>
@@ -34,9 +37,117 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMessageBox>
 #include <QStringList>
 
+#include <algorithm>
+#include <climits>
+
 #include "ui_DialogBreakpoints.h"
 
 namespace BreakpointManagerPlugin {
+namespace {
+
+// what a line of a breakpoint file sets up, see export_line
+struct ImportedBreakpoint {
+	edb::address_t   address = 0;
+	QString          condition;
+	bool             tracepoint = false;
+	QString          trace_expression;
+	quint64          ignore_count = 0;
+	quint64          hit_limit = 0;
+	QSet<edb::tid_t> threads;
+};
+
+//------------------------------------------------------------------------------
+// Name: export_line
+// Desc: the address in hex, followed by a tab separated name=value field for
+//       each of the settings which isn't the default. A file of just the
+//       addresses is as valid as ever
+//------------------------------------------------------------------------------
+QString export_line(const std::shared_ptr<IBreakpoint> &bp) {
+
+	QStringList fields;
+	fields << "0x" + QString::number(bp->address().toUint(), 16);
+
+	if(!bp->condition.isEmpty()) {
+		fields << "condition=" + bp->condition;
+	}
+
+	if(bp->tracepoint) {
+		fields << "trace=" + bp->trace_expression;
+	}
+
+	if(bp->ignore_count != 0) {
+		fields << "ignore=" + QString::number(bp->ignore_count);
+	}
+
+	if(bp->hit_limit != 0) {
+		fields << "limit=" + QString::number(bp->hit_limit);
+	}
+
+	if(!bp->threads.isEmpty()) {
+		QStringList threads;
+		for(const edb::tid_t tid : bp->threads) {
+			threads << QString::number(tid);
+		}
+		threads.sort();
+		fields << "threads=" + threads.join(",");
+	}
+
+	return fields.join("\t");
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_line
+// Desc: the reverse of export_line
+//------------------------------------------------------------------------------
+bool parse_line(const QString &line, ImportedBreakpoint *imported) {
+
+	Q_ASSERT(imported);
+
+	const QStringList fields = line.split('\t');
+
+	bool ok;
+	imported->address = fields[0].trimmed().toULongLong(&ok, 16);
+	if(!ok) {
+		return false;
+	}
+
+	for(int i = 1; i < fields.size(); ++i) {
+		const QString &field = fields[i];
+		const int equals     = field.indexOf('=');
+		const QString name   = field.left(equals);
+		const QString value  = field.mid(equals + 1);
+
+		if(equals < 0) {
+			return false;
+		} else if(name == "condition") {
+			imported->condition = value;
+		} else if(name == "trace") {
+			imported->tracepoint       = true;
+			imported->trace_expression = value;
+		} else if(name == "ignore") {
+			imported->ignore_count = value.toULongLong(&ok);
+		} else if(name == "limit") {
+			imported->hit_limit = value.toULongLong(&ok);
+		} else if(name == "threads") {
+			for(const QString &tid : value.split(',', QString::SkipEmptyParts)) {
+				imported->threads.insert(tid.toInt(&ok));
+				if(!ok) {
+					break;
+				}
+			}
+		} else {
+			return false;
+		}
+
+		if(!ok) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
 
 //------------------------------------------------------------------------------
 // Name: DialogBreakpoints
@@ -44,10 +155,18 @@ namespace BreakpointManagerPlugin {
 //------------------------------------------------------------------------------
 DialogBreakpoints::DialogBreakpoints(QWidget *parent) : QDialog(parent), ui(new Ui::DialogBreakpoints) {
 	ui->setupUi(this);
+
+	model_  = new BreakpointsModel(this);
+	filter_ = new QSortFilterProxyModel(this);
+	filter_->setSourceModel(model_);
+	filter_->setSortRole(Qt::UserRole);
+	ui->tableView->setModel(filter_);
+	ui->tableView->sortByColumn(0, Qt::AscendingOrder);
+
 #if QT_VERSION >= 0x050000
-	ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 #else
-	ui->tableWidget->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
+	ui->tableView->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
 #endif
 }
 
@@ -77,39 +196,24 @@ void DialogBreakpoints::hideEvent(QHideEvent *) {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogBreakpoints::updateList() {
+	model_->update();
+}
 
+//------------------------------------------------------------------------------
+// Name: selected_address
+// Desc: the address of the selected breakpoint, false if none is selected
+//------------------------------------------------------------------------------
+bool DialogBreakpoints::selected_address(edb::address_t *address) const {
 
-	ui->tableWidget->setSortingEnabled(false);
-	ui->tableWidget->setRowCount(0);
-
-	const IDebugger::BreakpointList breakpoint_state = edb::v1::debugger_core->backup_breakpoints();
-
-	for(const std::shared_ptr<IBreakpoint> &bp: breakpoint_state) {
-
-		//Skip if it's an internal bp; we don't want to insert a row for it.
-		if (bp->internal()) {
-			continue; }
-
-		const int row = ui->tableWidget->rowCount();
-		ui->tableWidget->insertRow(row);
-
-		const edb::address_t address = bp->address();
-		const QString condition      = bp->condition;
-		const bool onetime           = bp->one_time();
-		const QString symname        = edb::v1::find_function_symbol(address, QString(), 0);
-		const QString bytes          = edb::v1::format_bytes(bp->original_bytes(), bp->size());
-
-		auto item = new QTableWidgetItem(edb::v1::format_pointer(address));
-		item->setData(Qt::UserRole, address);
+	Q_ASSERT(address);
 
-		ui->tableWidget->setItem(row, 0, item);
-		ui->tableWidget->setItem(row, 1, new QTableWidgetItem(condition));
-		ui->tableWidget->setItem(row, 2, new QTableWidgetItem(bytes));
-		ui->tableWidget->setItem(row, 3, new QTableWidgetItem(onetime ? tr("One Time") : tr("Standard")));
-		ui->tableWidget->setItem(row, 4, new QTableWidgetItem(symname));
+	const QModelIndexList sel = ui->tableView->selectionModel()->selectedRows();
+	if(sel.isEmpty()) {
+		return false;
 	}
 
-	ui->tableWidget->setSortingEnabled(true);
+	*address = model_->address(filter_->mapToSource(sel[0]));
+	return true;
 }
 
 //------------------------------------------------------------------------------
@@ -122,9 +226,8 @@ void DialogBreakpoints::on_btnAdd_clicked() {
     QString text = QInputDialog::getText(this, tr("Add Breakpoint"), tr("Address:"), QLineEdit::Normal, QString(), &ok);
 
 	if(ok && !text.isEmpty()) {
-		Expression<edb::address_t> expr(text, edb::v1::get_variable, edb::v1::get_value);
 		ExpressionError err;
-		const edb::address_t address = expr.evaluate_expression(&ok, &err);
+		const edb::address_t address = edb::v1::evaluate_expression(text, &ok, &err);
 		if(ok) {
 			edb::v1::create_breakpoint(address);
 			updateList();
@@ -140,11 +243,9 @@ void DialogBreakpoints::on_btnAdd_clicked() {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogBreakpoints::on_btnCondition_clicked() {
-	QList<QTableWidgetItem *> sel = ui->tableWidget->selectedItems();
-	if(!sel.empty()) {
-		QTableWidgetItem *const item = sel[0];
+	edb::address_t address;
+	if(selected_address(&address)) {
 		bool ok;
-		const edb::address_t address = item->data(Qt::UserRole).toULongLong();
 		const QString condition      = edb::v1::get_breakpoint_condition(address);
 		const QString text           = QInputDialog::getText(this, tr("Set Breakpoint Condition"), tr("Expression:"), QLineEdit::Normal, condition, &ok);
 		if(ok) {
@@ -154,6 +255,129 @@ void DialogBreakpoints::on_btnCondition_clicked() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: on_btnTracepoint_clicked
+// Desc: turns the selected breakpoint into a tracepoint, which logs the value
+//       of an expression (or the registers) to the trace log and continues
+//------------------------------------------------------------------------------
+void DialogBreakpoints::on_btnTracepoint_clicked() {
+	edb::address_t address;
+	if(selected_address(&address)) {
+
+		if(const std::shared_ptr<IBreakpoint> bp = edb::v1::find_breakpoint(address)) {
+			if(bp->tracepoint) {
+				const int ret = QMessageBox::question(
+					this,
+					tr("Tracepoint"),
+					tr("This breakpoint is a tracepoint. Make it a normal breakpoint again?"),
+					QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+
+				if(ret == QMessageBox::Cancel) {
+					return;
+				}
+
+				if(ret == QMessageBox::Yes) {
+					edb::v1::set_breakpoint_tracepoint(address, false, QString());
+					updateList();
+					return;
+				}
+			}
+
+			bool ok;
+			const QString text = QInputDialog::getText(this, tr("Set Tracepoint"), tr("Expression to log (leave empty to log the registers):"), QLineEdit::Normal, bp->trace_expression, &ok);
+			if(ok) {
+				edb::v1::set_breakpoint_tracepoint(address, true, text);
+				updateList();
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnFilters_clicked
+// Desc: sets which hits of the selected breakpoint stop, by count and by thread
+//------------------------------------------------------------------------------
+void DialogBreakpoints::on_btnFilters_clicked() {
+	edb::address_t address;
+	if(selected_address(&address)) {
+
+		if(const std::shared_ptr<IBreakpoint> bp = edb::v1::find_breakpoint(address)) {
+			bool ok;
+			const int ignore_count = QInputDialog::getInt(this, tr("Set Breakpoint Filters"), tr("Number of hits to ignore:"), static_cast<int>(qMin<quint64>(bp->ignore_count, INT_MAX)), 0, INT_MAX, 1, &ok);
+			if(!ok) {
+				return;
+			}
+
+			const int hit_limit = QInputDialog::getInt(this, tr("Set Breakpoint Filters"), tr("Last hit to stop on (0 for no limit):"), static_cast<int>(qMin<quint64>(bp->hit_limit, INT_MAX)), 0, INT_MAX, 1, &ok);
+			if(!ok) {
+				return;
+			}
+
+			QStringList current;
+			for(const edb::tid_t tid : bp->threads) {
+				current << QString::number(tid);
+			}
+			current.sort();
+
+			const QString text = QInputDialog::getText(this, tr("Set Breakpoint Filters"), tr("Threads to stop in (comma separated, empty for all):"), QLineEdit::Normal, current.join(", "), &ok);
+			if(!ok) {
+				return;
+			}
+
+			QSet<edb::tid_t> threads;
+			for(const QString &field : text.split(',', QString::SkipEmptyParts)) {
+				const edb::tid_t tid = field.trimmed().toInt(&ok);
+				if(!ok) {
+					QMessageBox::critical(this, tr("Invalid Thread"), tr("\"%1\" is not a thread ID.").arg(field.trimmed()));
+					return;
+				}
+				threads.insert(tid);
+			}
+
+			edb::v1::set_breakpoint_filters(address, ignore_count, hit_limit, threads);
+			updateList();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnPending_clicked
+// Desc: adds a breakpoint by module and symbol or offset, or removes one of
+//       those added before
+//------------------------------------------------------------------------------
+void DialogBreakpoints::on_btnPending_clicked() {
+
+	QMenu menu;
+	QAction *const add_action = menu.addAction(tr("&Add Pending Breakpoint..."));
+
+	const QStringList pending = edb::v1::pending_breakpoints();
+	if(!pending.isEmpty()) {
+		menu.addSeparator();
+	}
+
+	QHash<QAction *, QString> remove_actions;
+	for(const QString &location : pending) {
+		remove_actions.insert(menu.addAction(tr("Remove %1").arg(location)), location);
+	}
+
+	QAction *const chosen = menu.exec(ui->btnPending->mapToGlobal(QPoint(0, ui->btnPending->height())));
+	if(!chosen) {
+		return;
+	}
+
+	if(chosen == add_action) {
+		bool ok;
+		const QString text = QInputDialog::getText(this, tr("Add Pending Breakpoint"), tr("Location (module!symbol, module!symbol+offset or module+offset):"), QLineEdit::Normal, QString(), &ok);
+		if(ok && !text.isEmpty() && !edb::v1::add_pending_breakpoint(text)) {
+			QMessageBox::critical(this, tr("Invalid Location"), tr("The location is either not of a recognized form or already pending."));
+		}
+	} else {
+		edb::v1::remove_pending_breakpoint(remove_actions.value(chosen));
+	}
+
+	updateList();
+}
+
 #if 0
 //------------------------------------------------------------------------------
 // Name: on_btnAddFunction_clicked
@@ -179,33 +403,30 @@ void DialogBreakpoints::on_btnAddFunction_clicked() {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogBreakpoints::on_btnRemove_clicked() {
-	QList<QTableWidgetItem *> sel = ui->tableWidget->selectedItems();
-	if(!sel.empty()) {
-		QTableWidgetItem *const item = sel[0];
-		const edb::address_t address = item->data(Qt::UserRole).toULongLong();
+	edb::address_t address;
+	if(selected_address(&address)) {
 		edb::v1::remove_breakpoint(address);
 	}
 	updateList();
 }
 
 //------------------------------------------------------------------------------
-// Name: on_tableWidget_cellDoubleClicked
+// Name: on_tableView_doubleClicked
 // Desc:
 //------------------------------------------------------------------------------
-void DialogBreakpoints::on_tableWidget_cellDoubleClicked(int row, int col) {
-	switch(col) {
+void DialogBreakpoints::on_tableView_doubleClicked(const QModelIndex &index) {
+
+	const edb::address_t address = model_->address(filter_->mapToSource(index));
+
+	switch(index.column()) {
 	case 0: // address
-		if(QTableWidgetItem *const address_item = ui->tableWidget->item(row, 0)) {
-			const edb::address_t address = address_item->data(Qt::UserRole).toULongLong();
-			edb::v1::jump_to_address(address);
-		}
+		edb::v1::jump_to_address(address);
 		break;
 	case 1: // condition
-		if(QTableWidgetItem *const address_item = ui->tableWidget->item(row, 0)) {
+		{
 			bool ok;
-			const edb::address_t address = address_item->data(Qt::UserRole).toULongLong();
-			const QString condition      = edb::v1::get_breakpoint_condition(address);
-			const QString text           = QInputDialog::getText(this, tr("Set Breakpoint Condition"), tr("Expression:"), QLineEdit::Normal, condition, &ok);
+			const QString condition = edb::v1::get_breakpoint_condition(address);
+			const QString text      = QInputDialog::getText(this, tr("Set Breakpoint Condition"), tr("Expression:"), QLineEdit::Normal, condition, &ok);
 			if(ok) {
 				edb::v1::set_breakpoint_condition(address, text);
 				updateList();
@@ -240,59 +461,68 @@ void DialogBreakpoints::on_btnImport_clicked() {
 	//Keep a list of any lines in the file that don't make valid breakpoints.
 	QStringList errors;
 
-	//Iterate through each line; attempt to make a breakpoint for each line.
-	//Addreses should be prefixed with 0x, i.e. a hex number.
-	//Count each breakpoint successfully made.
-	int count = 0;
-	Q_FOREVER {
-
-		//Get the address
-		QString line = file.readLine().trimmed();
+	// the regions only have to be up to date once for the whole file
+	edb::v1::memory_regions().sync();
 
-		if(line.isEmpty()) {
-			break;
-		}
+	QVector<edb::address_t>                    addresses;
+	QHash<edb::address_t, ImportedBreakpoint>  settings; // of those with more than an address
+	while(!file.atEnd()) {
 
-		bool ok;
-		int base = 16;
-		edb::address_t address = line.toULong(&ok, base);
-
-		//Skip if there's an issue.
-		if (!ok) {
-			errors.append(line);
+		const QString line = QString::fromUtf8(file.readLine()).trimmed();
+		if(line.isEmpty() || line.startsWith('#')) {
 			continue;
 		}
 
-		//If there's an issue with the line or address isn't in any region,
-		//add to error list and skip.
-		edb::v1::memory_regions().sync();
-		std::shared_ptr<IRegion> p = edb::v1::memory_regions().find_region(address);
-		if (!p) {
+		ImportedBreakpoint imported;
+		if(!parse_line(line, &imported) || !edb::v1::memory_regions().find_region(imported.address)) {
 			errors.append(line);
 			continue;
 		}
 
 		//If the bp already exists, skip.  No error.
-		if (edb::v1::debugger_core->find_breakpoint(address)) {
+		if(edb::v1::debugger_core->find_breakpoint(imported.address) || settings.contains(imported.address)) {
 			continue;
 		}
 
-		//If the line was converted to an address, try to create the breakpoint.
-		//Access debugger_core directly to avoid many possible error windows by edb::v1::create_breakpoint()
-		if (const std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core->add_breakpoint(address)) {
-			count++;
-		} else{
-			errors.append(line);
+		addresses.push_back(imported.address);
+		if(line.contains('\t')) {
+			settings.insert(imported.address, imported);
 		}
 	}
 
-	//Report any errors to the user
+	std::sort(addresses.begin(), addresses.end());
+	addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+	//Access debugger_core directly to avoid many possible error windows by edb::v1::create_breakpoint(),
+	//and to arm them all in one batch
+	const QVector<edb::address_t> failed = edb::v1::debugger_core->add_breakpoints(addresses);
+	for(const edb::address_t address : failed) {
+		errors.append(edb::v1::format_pointer(address));
+	}
+
+	for(const ImportedBreakpoint &imported : settings) {
+		if(const std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core->find_breakpoint(imported.address)) {
+			bp->condition        = imported.condition;
+			bp->tracepoint       = imported.tracepoint;
+			bp->trace_expression = imported.trace_expression;
+			bp->ignore_count     = imported.ignore_count;
+			bp->hit_limit        = imported.hit_limit;
+			bp->threads          = imported.threads;
+		}
+	}
+
+	//Report any errors to the user, a file of 20k breakpoints can have a lot of them
 	if (errors.size() > 0) {
-		QMessageBox::warning(this, tr("Invalid Breakpoints"), tr("The following breakpoints were not made:\n%1").arg(errors.join("")));
+		const int shown = std::min(errors.size(), 20);
+		QString message = QStringList(errors.mid(0, shown)).join("\n");
+		if(shown != errors.size()) {
+			message += tr("\n(and %1 more)").arg(errors.size() - shown);
+		}
+		QMessageBox::warning(this, tr("Invalid Breakpoints"), tr("The following breakpoints were not made:\n%1").arg(message));
 	}
 
 	//Report breakpoints successfully made
-	QMessageBox::information(this, tr("Breakpoint Import"), tr("Imported %1 breakpoints.").arg(count));
+	QMessageBox::information(this, tr("Breakpoint Import"), tr("Imported %1 breakpoints.").arg(addresses.size() - failed.size()));
 
 	updateList();
 }
@@ -307,13 +537,13 @@ void DialogBreakpoints::on_btnExport_clicked() {
 	//Get the current list of breakpoints
 	const IDebugger::BreakpointList breakpoint_state = edb::v1::debugger_core->backup_breakpoints();
 
-	//Create a list for addresses to be exported at the end
-	QList<edb::address_t> export_list;
+	//Create a list for those to be exported at the end, in address order
+	QMap<edb::address_t, std::shared_ptr<IBreakpoint>> export_list;
 
 	//Go through our breakpoints and add for export if not one-time and not internal.
 	for(const std::shared_ptr<IBreakpoint> &bp: breakpoint_state) {
 		if (!bp->one_time() && !bp->internal()) {
-			export_list.append(bp->address());
+			export_list.insert(bp->address(), bp);
 		}
 	}
 
@@ -336,11 +566,12 @@ void DialogBreakpoints::on_btnExport_clicked() {
 		return;
 	}
 
-	for(edb::address_t address: export_list) {
-		int base = 16;
-		QString string_address = "0x" + QString::number(address, base) + "\n";
-		file.write(string_address.toLatin1());
+	QByteArray contents;
+	for(const std::shared_ptr<IBreakpoint> &bp: export_list) {
+		contents += export_line(bp).toUtf8();
+		contents += '\n';
 	}
+	file.write(contents);
 
 	QMessageBox::information(this, tr("Breakpoint Export"), tr("Exported %1 breakpoints").arg(export_list.size()));
 }
@@ -19,12 +19,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef DIALOGBREAKPOINTS_20061101_H_
 #define DIALOGBREAKPOINTS_20061101_H_
 
+#include "Types.h"
 #include <QDialog>
 
+class QModelIndex;
+class QSortFilterProxyModel;
+
 namespace BreakpointManagerPlugin {
 
 namespace Ui { class DialogBreakpoints; }
 
+class BreakpointsModel;
+
 class DialogBreakpoints : public QDialog {
 	Q_OBJECT
 
@@ -37,7 +43,10 @@ public Q_SLOTS:
 	void on_btnAdd_clicked();
 	void on_btnRemove_clicked();
 	void on_btnCondition_clicked();
-	void on_tableWidget_cellDoubleClicked(int row, int col);
+	void on_btnTracepoint_clicked();
+	void on_btnFilters_clicked();
+	void on_btnPending_clicked();
+	void on_tableView_doubleClicked(const QModelIndex &index);
     void on_btnImport_clicked();
     void on_btnExport_clicked();
 
@@ -45,8 +54,13 @@ private:
 	virtual void showEvent(QShowEvent *event);
 	virtual void hideEvent(QHideEvent *event);
 
+private:
+	bool selected_address(edb::address_t *address) const;
+
 private:
 	 Ui::DialogBreakpoints *const ui;
+	 BreakpointsModel      *model_  = nullptr;
+	 QSortFilterProxyModel *filter_ = nullptr;
 };
 
 }
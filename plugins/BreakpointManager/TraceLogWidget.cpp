@@ -0,0 +1,208 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TraceLogWidget.h"
+#include "TraceLog.h"
+#include "edb.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QStringList>
+#include <QTableWidget>
+#include <QTextStream>
+#include <QVBoxLayout>
+
+namespace BreakpointManagerPlugin {
+
+//------------------------------------------------------------------------------
+// Name: TraceLogWidget
+// Desc:
+//------------------------------------------------------------------------------
+TraceLogWidget::TraceLogWidget(QWidget *parent) : QWidget(parent) {
+
+	table_ = new QTableWidget(0, 5, this);
+	table_->setHorizontalHeaderLabels(QStringList() << tr("#") << tr("Address") << tr("Thread") << tr("Hit") << tr("Data"));
+	table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table_->setAlternatingRowColors(true);
+	table_->verticalHeader()->setVisible(false);
+	table_->horizontalHeader()->setStretchLastSection(true);
+
+	status_ = new QLabel(this);
+
+	auto refresh_button = new QPushButton(tr("&Refresh"), this);
+	auto clear_button   = new QPushButton(tr("C&lear"), this);
+	auto export_button  = new QPushButton(tr("&Export..."), this);
+
+	connect(refresh_button, SIGNAL(clicked()), this, SLOT(refresh()));
+	connect(clear_button,   SIGNAL(clicked()), this, SLOT(clear()));
+	connect(export_button,  SIGNAL(clicked()), this, SLOT(export_log()));
+
+	auto buttons = new QHBoxLayout;
+	buttons->addWidget(status_);
+	buttons->addStretch();
+	buttons->addWidget(refresh_button);
+	buttons->addWidget(clear_button);
+	buttons->addWidget(export_button);
+
+	auto layout = new QVBoxLayout(this);
+	layout->addWidget(table_);
+	layout->addLayout(buttons);
+
+	connect(table_, SIGNAL(cellDoubleClicked(int, int)), this, SLOT(cell_double_clicked(int)));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceLogWidget
+// Desc:
+//------------------------------------------------------------------------------
+TraceLogWidget::~TraceLogWidget() {
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void TraceLogWidget::showEvent(QShowEvent *) {
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: cell_double_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void TraceLogWidget::cell_double_clicked(int row) {
+	if(QTableWidgetItem *const item = table_->item(row, 1)) {
+		edb::v1::jump_to_address(item->data(Qt::UserRole).toULongLong());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: record_data
+// Desc: the traced value, or the general purpose registers
+//------------------------------------------------------------------------------
+QString TraceLogWidget::record_data(const TraceRecord &record) {
+
+	if(record.has_state) {
+		QStringList registers;
+		for(size_t i = 0; ; ++i) {
+			const Register reg = record.state.gp_register(i);
+			if(!reg) {
+				break;
+			}
+			registers << QString("%1=%2").arg(reg.name(), reg.toHexString());
+		}
+		return registers.join(" ");
+	}
+
+	if(record.has_value) {
+		return edb::v1::format_pointer(record.value);
+	}
+
+	return tr("<error>");
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh
+// Desc:
+//------------------------------------------------------------------------------
+void TraceLogWidget::refresh() {
+
+	if(!isVisible()) {
+		return;
+	}
+
+	const TraceLog &log = edb::v1::trace_log();
+	const QVector<TraceRecord> records = log.records();
+
+	table_->setUpdatesEnabled(false);
+	table_->setRowCount(records.size());
+
+	int row = 0;
+	for(const TraceRecord &record : records) {
+		auto address = new QTableWidgetItem(edb::v1::format_pointer(record.address));
+		address->setData(Qt::UserRole, record.address.toUint());
+
+		table_->setItem(row, 0, new QTableWidgetItem(QString::number(record.sequence)));
+		table_->setItem(row, 1, address);
+		table_->setItem(row, 2, new QTableWidgetItem(QString::number(record.tid)));
+		table_->setItem(row, 3, new QTableWidgetItem(QString::number(record.hit_count)));
+		table_->setItem(row, 4, new QTableWidgetItem(record_data(record)));
+		++row;
+	}
+
+	table_->setUpdatesEnabled(true);
+
+	if(log.dropped() != 0) {
+		status_->setText(tr("%1 hits, oldest %2 dropped").arg(log.total()).arg(log.dropped()));
+	} else {
+		status_->setText(tr("%1 hits").arg(log.total()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void TraceLogWidget::clear() {
+	edb::v1::trace_log().clear();
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: export_log
+// Desc: writes the log as tab separated text, oldest first
+//------------------------------------------------------------------------------
+void TraceLogWidget::export_log() {
+
+	const QVector<TraceRecord> records = edb::v1::trace_log().records();
+	if(records.isEmpty()) {
+		QMessageBox::critical(this, tr("Empty Trace Log"), tr("There are no tracepoint hits to export."));
+		return;
+	}
+
+	const QString filename = QFileDialog::getSaveFileName(this, tr("Trace Log Export File"), QDir::homePath());
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	QFile file(filename);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		QMessageBox::critical(this, tr("Error Opening File"), tr("Unable to open file: %1").arg(filename));
+		return;
+	}
+
+	QTextStream stream(&file);
+	for(const TraceRecord &record : records) {
+		stream << record.sequence << '\t'
+		       << edb::v1::format_pointer(record.address) << '\t'
+		       << record.tid << '\t'
+		       << record.hit_count << '\t'
+		       << record_data(record) << '\n';
+	}
+
+	QMessageBox::information(this, tr("Trace Log Export"), tr("Exported %1 records").arg(records.size()));
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_LOG_WIDGET_20170620_H_
+#define TRACE_LOG_WIDGET_20170620_H_
+
+#include <QWidget>
+
+class QLabel;
+class QTableWidget;
+struct TraceRecord;
+
+namespace BreakpointManagerPlugin {
+
+// shows the contents of edb::v1::trace_log(). The log is only read when the
+// debugger stops or the user asks for it, never on each tracepoint hit
+class TraceLogWidget : public QWidget {
+	Q_OBJECT
+
+public:
+	explicit TraceLogWidget(QWidget *parent = 0);
+	virtual ~TraceLogWidget();
+
+public Q_SLOTS:
+	void refresh();
+	void clear();
+	void export_log();
+
+private Q_SLOTS:
+	void cell_double_clicked(int row);
+
+private:
+	virtual void showEvent(QShowEvent *event);
+
+private:
+	static QString record_data(const TraceRecord &record);
+
+private:
+	QTableWidget *table_;
+	QLabel       *status_;
+};
+
+}
+
+#endif
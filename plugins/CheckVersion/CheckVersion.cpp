@@ -20,24 +20,101 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "OptionsPage.h"
 #include "edb.h"
 
+#include <QApplication>
+#include <QDateTime>
 #include <QDebug>
 #include <QMenu>
 #include <QMessageBox>
 #include <QNetworkAccessManager>
+#include <QNetworkInterface>
 #include <QNetworkProxy>
 #include <QNetworkProxyFactory>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QSettings>
+#include <QTimer>
 #include <QUrl>
 
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+
 namespace CheckVersionPlugin {
 
+namespace {
+
+// how long after startup the check is made, so that it never competes with
+// edb coming up
+const int STARTUP_DELAY = 10000;
+
+// a check at startup is skipped if the last one was less than this long ago
+const int CHECK_INTERVAL = 24 * 60 * 60;
+
+// a request which takes longer than this is given up on
+const int REQUEST_TIMEOUT = 15000;
+
+const char DEFAULT_URL[] = "http://codef00.com/projects/debugger-latest";
+
+//------------------------------------------------------------------------------
+// Name: network_available
+// Desc: true if there is an interface, other than loopback, with an address.
+//       Without one the check can only fail, after DNS and the proxy have
+//       taken their time to say so
+//------------------------------------------------------------------------------
+bool network_available() {
+	for(const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+		const QNetworkInterface::InterfaceFlags flags = iface.flags();
+		if((flags & QNetworkInterface::IsUp) && (flags & QNetworkInterface::IsRunning) && !(flags & QNetworkInterface::IsLoopBack)) {
+			if(!iface.addressEntries().isEmpty()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_proxy
+// Desc: the proxy to reach <url> through. The system's proxy configuration
+//       can take seconds to query, so this runs on the thread pool
+//------------------------------------------------------------------------------
+QNetworkProxy find_proxy(const QUrl &url) {
+
+	QNetworkProxy proxy;
+
+#ifdef Q_OS_LINUX
+	Q_UNUSED(url);
+	auto proxy_str = QString::fromUtf8(qgetenv("HTTP_PROXY"));
+	if(proxy_str.isEmpty()) {
+		proxy_str = QString::fromUtf8(qgetenv("http_proxy"));
+	}
+
+	if(!proxy_str.isEmpty()) {
+		const QUrl proxy_url = QUrl::fromUserInput(proxy_str);
+		proxy = QNetworkProxy(
+			QNetworkProxy::HttpProxy,
+			proxy_url.host(),
+			proxy_url.port(80),
+			proxy_url.userName(),
+			proxy_url.password());
+	}
+
+#else
+	QList<QNetworkProxy> proxies = QNetworkProxyFactory::systemProxyForQuery(QNetworkProxyQuery(url));
+	if(proxies.size() >= 1) {
+		proxy = proxies.first();
+	}
+#endif
+	return proxy;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: CheckVersion
 // Desc:
 //------------------------------------------------------------------------------
-CheckVersion::CheckVersion() : menu_(0), network_(0), initial_check_(true) {
+CheckVersion::CheckVersion() : menu_(0), network_(0), proxy_watcher_(0), initial_check_(true) {
 }
 
 //------------------------------------------------------------------------------
@@ -49,13 +126,20 @@ CheckVersion::~CheckVersion() {
 
 //------------------------------------------------------------------------------
 // Name: private_init
-// Desc:
+// Desc: nothing here touches the network, the check at startup is made a
+//       while after edb is up, and not at all in a headless session
 //------------------------------------------------------------------------------
 void CheckVersion::private_init() {
 	QSettings settings;
-	if(settings.value("CheckVersion/check_on_start.enabled", true).toBool()) {
-		do_check();
+	if(!settings.value("CheckVersion/check_on_start.enabled", true).toBool()) {
+		return;
+	}
+
+	if(!qobject_cast<QApplication *>(QCoreApplication::instance())) {
+		return;
 	}
+
+	QTimer::singleShot(STARTUP_DELAY, this, SLOT(do_check()));
 }
 
 //------------------------------------------------------------------------------
@@ -84,57 +168,71 @@ QMenu *CheckVersion::menu(QWidget *parent) {
 
 //------------------------------------------------------------------------------
 // Name: do_check
-// Desc:
+// Desc: the check at startup uses the last result while it is recent, and is
+//       skipped when there is no network. One asked for from the menu always
+//       goes out
 //------------------------------------------------------------------------------
 void CheckVersion::do_check() {
 
-	if(!network_) {
-		network_ = new QNetworkAccessManager(this);
-		connect(network_, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
+	if(initial_check_) {
+		QSettings settings;
+		const QDateTime last_check = settings.value("CheckVersion/last_check").toDateTime();
+		if(last_check.isValid() && last_check.secsTo(QDateTime::currentDateTime()) < CHECK_INTERVAL) {
+			report_version(settings.value("CheckVersion/last_version").toString());
+			initial_check_ = false;
+			return;
+		}
+
+		if(!network_available()) {
+			qDebug("[CheckVersion] no network, not checking");
+			initial_check_ = false;
+			return;
+		}
 	}
 
-	//network_->abort(); //?
+	if(proxy_watcher_ && proxy_watcher_->isRunning()) {
+		return;
+	}
 
-	const QUrl update_url("http://codef00.com/projects/debugger-latest");
-	const QNetworkRequest request(update_url);
+	const QUrl update_url(QString::fromLatin1(DEFAULT_URL));
 
-	set_proxy(update_url);
+#ifdef QT_CONCURRENT_LIB
+	if(!proxy_watcher_) {
+		proxy_watcher_ = new QFutureWatcher<QNetworkProxy>(this);
+		connect(proxy_watcher_, SIGNAL(finished()), this, SLOT(proxy_found()));
+	}
 
-	network_->get(request);
+	proxy_watcher_->setFuture(QtConcurrent::run(find_proxy, update_url));
+#else
+	send_request(find_proxy(update_url));
+#endif
 }
 
 //------------------------------------------------------------------------------
-// Name: set_proxy
+// Name: proxy_found
 // Desc:
 //------------------------------------------------------------------------------
-void CheckVersion::set_proxy(const QUrl &url) {
-
-	QNetworkProxy proxy;
+void CheckVersion::proxy_found() {
+	send_request(proxy_watcher_->result());
+}
 
-#ifdef Q_OS_LINUX
-	Q_UNUSED(url);
-	auto proxy_str = QString::fromUtf8(qgetenv("HTTP_PROXY"));
-	if(proxy_str.isEmpty()) {
-		proxy_str = QString::fromUtf8(qgetenv("http_proxy"));
-	}
+//------------------------------------------------------------------------------
+// Name: send_request
+// Desc: the request is given up on if it takes too long, a DNS lookup or a
+//       proxy which never answers shouldn't leave it hanging
+//------------------------------------------------------------------------------
+void CheckVersion::send_request(const QNetworkProxy &proxy) {
 
-	if(!proxy_str.isEmpty()) {
-		const QUrl proxy_url = QUrl::fromUserInput(proxy_str);
-		proxy = QNetworkProxy(
-			QNetworkProxy::HttpProxy,
-			proxy_url.host(),
-			proxy_url.port(80),
-			proxy_url.userName(),
-			proxy_url.password());
+	if(!network_) {
+		network_ = new QNetworkAccessManager(this);
+		connect(network_, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
 	}
 
-#else
-	QList<QNetworkProxy> proxies = QNetworkProxyFactory::systemProxyForQuery(QNetworkProxyQuery(url));
-	if(proxies.size() >= 1) {
-		proxy = proxies.first();
-	}
-#endif
 	network_->setProxy(proxy);
+
+	const QNetworkRequest request(QUrl(QString::fromLatin1(DEFAULT_URL)));
+	QNetworkReply *const reply = network_->get(request);
+	QTimer::singleShot(REQUEST_TIMEOUT, reply, SLOT(abort()));
 }
 
 //------------------------------------------------------------------------------
@@ -148,38 +246,62 @@ void CheckVersion::show_menu() {
 
 //------------------------------------------------------------------------------
 // Name: requestFinished
-// Desc:
+// Desc: a check at startup is remembered either way, so the next startups
+//       don't try again before the interval is up
 //------------------------------------------------------------------------------
 void CheckVersion::requestFinished(QNetworkReply *reply) {
 
+	reply->deleteLater();
+
+	QSettings settings;
+
 	if(QNetworkReply::NoError != reply->error()) {
 		if(!initial_check_) {
 			QMessageBox::critical(
 				0,
 				tr("An Error Occured"),
 				reply->errorString());
+		} else {
+			settings.setValue("CheckVersion/last_check", QDateTime::currentDateTime());
 		}
 	} else {
 		const QByteArray result = reply->readAll();
 		const QString s = result;
 
-		qDebug("comparing versions: [%d] [%d]", edb::v1::int_version(s), edb::v1::edb_version());
+		settings.setValue("CheckVersion/last_check", QDateTime::currentDateTime());
+		settings.setValue("CheckVersion/last_version", s);
 
-		if(edb::v1::int_version(s) > edb::v1::edb_version()) {
+		report_version(s);
+	}
+	initial_check_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: report_version
+// Desc: tells of <latest> if it is newer, and that there is nothing new if the
+//       check was asked for
+//------------------------------------------------------------------------------
+void CheckVersion::report_version(const QString &latest) {
+
+	if(latest.isEmpty()) {
+		return;
+	}
+
+	qDebug("comparing versions: [%d] [%d]", edb::v1::int_version(latest), edb::v1::edb_version());
+
+	if(edb::v1::int_version(latest) > edb::v1::edb_version()) {
+		QMessageBox::information(
+			0,
+			tr("New Version Available"),
+			tr("There is a newer version of edb available: <strong>%1</strong>").arg(latest));
+	} else {
+		if(!initial_check_) {
 			QMessageBox::information(
 				0,
-				tr("New Version Available"),
-				tr("There is a newer version of edb available: <strong>%1</strong>").arg(s));
-		} else {
-			if(!initial_check_) {
-				QMessageBox::information(
-					0,
-					tr("You are up to date"),
-					tr("You are running the latest version of edb"));
-			}
+				tr("You are up to date"),
+				tr("You are running the latest version of edb"));
 		}
 	}
-	initial_check_ = false;
 }
 
 #if QT_VERSION < 0x050000
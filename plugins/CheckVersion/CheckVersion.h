@@ -20,6 +20,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CHECKVERSION_20061122_H_
 
 #include "IPlugin.h"
+#include <QFutureWatcher>
+#include <QNetworkProxy>
 
 class QMenu;
 class QNetworkReply;
@@ -52,14 +54,19 @@ public Q_SLOTS:
 protected:
 	virtual void private_init();
 
-private:
+private Q_SLOTS:
 	void do_check();
-	void set_proxy(const QUrl &url);
+	void proxy_found();
+
+private:
+	void send_request(const QNetworkProxy &proxy);
+	void report_version(const QString &latest);
 
 private:
-	QMenu                 *menu_;
-	QNetworkAccessManager *network_;
-	bool                   initial_check_;
+	QMenu                         *menu_;
+	QNetworkAccessManager         *network_;
+	QFutureWatcher<QNetworkProxy> *proxy_watcher_;
+	bool                           initial_check_;
 };
 
 }
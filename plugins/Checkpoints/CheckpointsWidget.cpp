@@ -0,0 +1,203 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "CheckpointsWidget.h"
+#include "Checkpoint.h"
+#include "IDebugger.h"
+#include "MemoryRegions.h"
+#include "edb.h"
+
+#include <QMessageBox>
+#include <QTableWidgetItem>
+
+#include "ui_CheckpointsWidget.h"
+
+namespace CheckpointsPlugin {
+
+namespace {
+
+enum Column {
+	ColumnId,
+	ColumnAddress,
+	ColumnProcess,
+	ColumnCreated
+};
+
+}
+
+//------------------------------------------------------------------------------
+// Name: CheckpointsWidget
+// Desc:
+//------------------------------------------------------------------------------
+CheckpointsWidget::CheckpointsWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), ui(new Ui::CheckpointsWidget) {
+	ui->setupUi(this);
+	connect(edb::v1::debugger_ui, SIGNAL(detachEvent()), this, SLOT(detached()));
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~CheckpointsWidget
+// Desc:
+//------------------------------------------------------------------------------
+CheckpointsWidget::~CheckpointsWidget() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnCreate_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::on_btnCreate_clicked() {
+
+	const Result<int> result = edb::v1::debugger_core->create_checkpoint();
+	if(!result) {
+		QMessageBox::critical(this, tr("Checkpoints"), result.errorMessage());
+		return;
+	}
+
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnRestore_clicked
+// Desc: the debuggee is a different process afterwards, with the memory and
+//       registers it had back then, which the whole GUI has to catch up with
+//------------------------------------------------------------------------------
+void CheckpointsWidget::on_btnRestore_clicked() {
+
+	const int id = selected_checkpoint();
+	if(id == 0) {
+		return;
+	}
+
+	const Status status = edb::v1::debugger_core->restore_checkpoint(id);
+	if(!status) {
+		QMessageBox::critical(this, tr("Checkpoints"), status.toString());
+	}
+
+	edb::v1::memory_regions().sync();
+	edb::v1::update_ui();
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnDiscard_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::on_btnDiscard_clicked() {
+
+	const int id = selected_checkpoint();
+	if(id == 0) {
+		return;
+	}
+
+	edb::v1::debugger_core->discard_checkpoint(id);
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_tableWidget_itemDoubleClicked
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::on_tableWidget_itemDoubleClicked(QTableWidgetItem *item) {
+	Q_UNUSED(item);
+	on_btnRestore_clicked();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_tableWidget_itemSelectionChanged
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::on_tableWidget_itemSelectionChanged() {
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: detached
+// Desc: the core discards the checkpoints along with the debuggee
+//------------------------------------------------------------------------------
+void CheckpointsWidget::detached() {
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::showEvent(QShowEvent *event) {
+	QWidget::showEvent(event);
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: selected_checkpoint
+// Desc: the id of the selected checkpoint, 0 if there is none
+//------------------------------------------------------------------------------
+int CheckpointsWidget::selected_checkpoint() const {
+	const QList<QTableWidgetItem *> items = ui->tableWidget->selectedItems();
+	if(items.isEmpty()) {
+		return 0;
+	}
+
+	const QTableWidgetItem *const item = ui->tableWidget->item(items.front()->row(), ColumnId);
+	return item ? item->data(Qt::DisplayRole).toInt() : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: update_table
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::update_table() {
+
+	const QVector<Checkpoint> checkpoints = edb::v1::debugger_core ? edb::v1::debugger_core->checkpoints() : QVector<Checkpoint>();
+
+	ui->tableWidget->setRowCount(0);
+	ui->tableWidget->setRowCount(checkpoints.size());
+
+	int row = 0;
+	for(const Checkpoint &checkpoint : checkpoints) {
+		const QString symbol = edb::v1::find_function_symbol(checkpoint.address);
+		const QString address = symbol.isEmpty() ?
+			edb::v1::format_pointer(checkpoint.address) :
+			QString("%1 <%2>").arg(edb::v1::format_pointer(checkpoint.address), symbol);
+
+		auto id = new QTableWidgetItem;
+		id->setData(Qt::DisplayRole, checkpoint.id);
+
+		ui->tableWidget->setItem(row, ColumnId,      id);
+		ui->tableWidget->setItem(row, ColumnAddress, new QTableWidgetItem(address));
+		ui->tableWidget->setItem(row, ColumnProcess, new QTableWidgetItem(QString::number(checkpoint.pid)));
+		ui->tableWidget->setItem(row, ColumnCreated, new QTableWidgetItem(checkpoint.created.toString(Qt::DefaultLocaleShortDate)));
+		++row;
+	}
+
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_buttons
+// Desc:
+//------------------------------------------------------------------------------
+void CheckpointsWidget::update_buttons() {
+	const bool selected = selected_checkpoint() != 0;
+	ui->btnRestore->setEnabled(selected);
+	ui->btnDiscard->setEnabled(selected);
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CHECKPOINTS_WIDGET_20171014_H_
+#define CHECKPOINTS_WIDGET_20171014_H_
+
+#include <QWidget>
+
+class QTableWidgetItem;
+
+namespace CheckpointsPlugin {
+
+namespace Ui { class CheckpointsWidget; }
+
+// Lists the checkpoints taken of the debuggee, see IDebugger::create_checkpoint.
+// Restoring one replaces the debuggee with a copy of it, so a crash can be
+// gone through again from just before it as often as needed
+class CheckpointsWidget : public QWidget {
+	Q_OBJECT
+
+public:
+	CheckpointsWidget(QWidget *parent = 0, Qt::WindowFlags f = 0);
+	virtual ~CheckpointsWidget() override;
+
+public Q_SLOTS:
+	void on_btnCreate_clicked();
+	void on_btnRestore_clicked();
+	void on_btnDiscard_clicked();
+	void on_tableWidget_itemDoubleClicked(QTableWidgetItem *item);
+	void on_tableWidget_itemSelectionChanged();
+
+private Q_SLOTS:
+	void detached();
+
+protected:
+	virtual void showEvent(QShowEvent *event) override;
+
+private:
+	int selected_checkpoint() const;
+	void update_table();
+	void update_buttons();
+
+private:
+	Ui::CheckpointsWidget *ui;
+};
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Coverage.h"
+#include "CoverageEngine.h"
+#include "DialogCoverage.h"
+#include "edb.h"
+
+#include <QMenu>
+
+namespace CoveragePlugin {
+
+//------------------------------------------------------------------------------
+// Name: Coverage
+// Desc:
+//------------------------------------------------------------------------------
+Coverage::Coverage() : engine_(new CoverageEngine(this)) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~Coverage
+// Desc:
+//------------------------------------------------------------------------------
+Coverage::~Coverage() {
+	delete dialog_;
+}
+
+//------------------------------------------------------------------------------
+// Name: private_init
+// Desc: the hits are taken from the core whenever an event gets as far as the
+//       UI, and one last time before the core forgets them with the process
+//------------------------------------------------------------------------------
+void Coverage::private_init() {
+	connect(edb::v1::debugger_ui, SIGNAL(debugEvent()), engine_, SLOT(collect()));
+	connect(edb::v1::debugger_ui, SIGNAL(aboutToDetach()), engine_, SLOT(collect()));
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *Coverage::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		menu_ = new QMenu(tr("Coverage"), parent);
+		menu_->addAction(tr("&Code Coverage"), this, SLOT(show_menu()));
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: show_menu
+// Desc:
+//------------------------------------------------------------------------------
+void Coverage::show_menu() {
+
+	if(!dialog_) {
+		dialog_ = new DialogCoverage(engine_, edb::v1::debugger_ui);
+	}
+
+	dialog_->show();
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Coverage, Coverage)
+#endif
+
+}
@@ -0,0 +1,231 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CoverageEngine.h"
+#include "IAnalyzer.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "Module.h"
+#include "edb.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <limits>
+
+namespace CoveragePlugin {
+
+//------------------------------------------------------------------------------
+// Name: CoverageEngine
+// Desc:
+//------------------------------------------------------------------------------
+CoverageEngine::CoverageEngine(QObject *parent) : QObject(parent) {
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: starts over with the basic blocks of <modules>, analyzing the regions
+//       of them which haven't been yet
+//------------------------------------------------------------------------------
+Status CoverageEngine::start(const QStringList &modules) {
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		return Status(tr("Not attached to a process"));
+	}
+
+	IAnalyzer *const analyzer = edb::v1::analyzer();
+	if(!analyzer) {
+		return Status(tr("Code coverage needs the analyzer to find the basic blocks"));
+	}
+
+	stop();
+	modules_.clear();
+	blocks_.clear();
+
+	edb::v1::memory_regions().sync();
+	const QList<std::shared_ptr<IRegion>> regions = edb::v1::memory_regions().regions();
+
+	for(const Module &module : process->loaded_modules()) {
+		if(!modules.contains(module.name) || modules_.size() > std::numeric_limits<quint16>::max()) {
+			continue;
+		}
+
+		ModuleCoverage coverage;
+		coverage.name = module.name;
+		coverage.base = module.base_address;
+		coverage.end  = module.base_address;
+
+		const auto index = static_cast<quint16>(modules_.size());
+
+		for(const std::shared_ptr<IRegion> &region : regions) {
+			if(region->name() != module.name) {
+				continue;
+			}
+
+			coverage.end = std::max(coverage.end, region->end());
+
+			if(!region->executable()) {
+				continue;
+			}
+
+			if(!analyzer->analyzed(region)) {
+				analyzer->analyze(region);
+			}
+
+			for(const Function &function : analyzer->functions(region)) {
+				for(const BasicBlock &block : function) {
+					if(block.byteSize() != 0 && block.firstAddress() >= coverage.base) {
+						const auto size = static_cast<quint16>(std::min<std::size_t>(block.byteSize(), std::numeric_limits<quint16>::max()));
+						blocks_.insert(block.firstAddress(), Block{size, index, false});
+					}
+				}
+			}
+		}
+
+		modules_.push_back(coverage);
+	}
+
+	// functions can share blocks, so they are only counted once they're unique
+	for(const Block &block : blocks_) {
+		++modules_[block.module].blocks;
+	}
+
+	Q_EMIT changed();
+
+	if(blocks_.isEmpty()) {
+		return Status(tr("No basic blocks were found in the selected modules"));
+	}
+
+	return edb::v1::debugger_core->add_coverage_points(blocks_.keys().toVector());
+}
+
+//------------------------------------------------------------------------------
+// Name: collect
+// Desc: picks up the blocks hit since the last time
+//------------------------------------------------------------------------------
+void CoverageEngine::collect() {
+
+	if(!edb::v1::debugger_core || blocks_.isEmpty()) {
+		return;
+	}
+
+	const QVector<edb::address_t> hits = edb::v1::debugger_core->take_coverage_hits();
+	if(hits.isEmpty()) {
+		return;
+	}
+
+	for(const edb::address_t address : hits) {
+		auto it = blocks_.find(address);
+		if(it != blocks_.end() && !it->hit) {
+			it->hit = true;
+			++modules_[it->module].hit;
+		}
+	}
+
+	Q_EMIT changed();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc: takes out the points which weren't hit, what was hit is kept
+//------------------------------------------------------------------------------
+void CoverageEngine::stop() {
+
+	collect();
+
+	if(edb::v1::debugger_core && edb::v1::debugger_core->coverage_points() != 0) {
+		edb::v1::debugger_core->clear_coverage_points();
+		Q_EMIT changed();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: heat
+// Desc: the blocks which were hit
+//------------------------------------------------------------------------------
+QVector<HeatRange> CoverageEngine::heat() const {
+
+	QVector<HeatRange> ranges;
+	for(auto it = blocks_.constBegin(); it != blocks_.constEnd(); ++it) {
+		if(it->hit) {
+			ranges.push_back(HeatRange{it.key(), it.key() + it->size - 1, 255});
+		}
+	}
+
+	return ranges;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_drcov
+// Desc: writes the blocks which were hit in the format of DynamoRIO's drcov
+//       tool (version 2), which most coverage viewers read
+//------------------------------------------------------------------------------
+Status CoverageEngine::write_drcov(const QString &filename) const {
+
+	QFile file(filename);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return Status(file.errorString());
+	}
+
+	int hit = 0;
+	for(const Block &block : blocks_) {
+		if(block.hit) {
+			++hit;
+		}
+	}
+
+	{
+		QTextStream header(&file);
+		header << "DRCOV VERSION: 2\n";
+		header << "DRCOV FLAVOR: edb\n";
+		header << "Module Table: version 2, count " << modules_.size() << "\n";
+		header << "Columns: id, base, end, entry, checksum, timestamp, path\n";
+		for(int i = 0; i < modules_.size(); ++i) {
+			const ModuleCoverage &module = modules_[i];
+			header << QString("%1, 0x%2, 0x%3, 0x%4, 0x%5, 0x%5, %6\n")
+				.arg(i, 2)
+				.arg(module.base.toUint(), 16, 16, QChar('0'))
+				.arg(module.end.toUint(), 16, 16, QChar('0'))
+				.arg(0, 16, 16, QChar('0'))
+				.arg(0, 8, 16, QChar('0'))
+				.arg(module.name);
+		}
+		header << "BB Table: " << hit << " bbs\n";
+	}
+
+	QDataStream table(&file);
+	table.setByteOrder(QDataStream::LittleEndian);
+	for(auto it = blocks_.constBegin(); it != blocks_.constEnd(); ++it) {
+		if(it->hit) {
+			table << static_cast<quint32>((it.key() - modules_[it->module].base).toUint()) << it->size << it->module;
+		}
+	}
+
+	if(file.error() != QFile::NoError) {
+		return Status(file.errorString());
+	}
+
+	return Status::Ok;
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COVERAGE_ENGINE_20171014_H_
+#define COVERAGE_ENGINE_20171014_H_
+
+#include "HeatRange.h"
+#include "Status.h"
+#include "Types.h"
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+namespace CoveragePlugin {
+
+// Records which basic blocks of some modules run, with a coverage point (see
+// IDebugger::add_coverage_points) on the first instruction of every block
+// the analyzer found. The core takes each point out on its first hit without
+// telling anyone, the hits are only picked up from it here now and then
+class CoverageEngine : public QObject {
+	Q_OBJECT
+
+public:
+	struct ModuleCoverage {
+		QString        name;
+		edb::address_t base   = 0;
+		edb::address_t end    = 0;
+		int            blocks = 0;
+		int            hit    = 0;
+	};
+
+public:
+	explicit CoverageEngine(QObject *parent = nullptr);
+	virtual ~CoverageEngine() override = default;
+
+public:
+	Status start(const QStringList &modules);
+	Status write_drcov(const QString &filename) const;
+
+public:
+	QVector<ModuleCoverage> modules() const { return modules_; }
+	QVector<HeatRange> heat() const;
+
+public Q_SLOTS:
+	void collect();
+	void stop();
+
+Q_SIGNALS:
+	void changed();
+
+private:
+	struct Block {
+		quint16 size;
+		quint16 module; // index in modules_
+		bool    hit;
+	};
+
+private:
+	QVector<ModuleCoverage>     modules_;
+	QMap<edb::address_t, Block> blocks_;
+};
+
+}
+
+#endif
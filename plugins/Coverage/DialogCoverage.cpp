@@ -0,0 +1,183 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogCoverage.h"
+#include "CoverageEngine.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "Module.h"
+#include "edb.h"
+
+#include <QFileDialog>
+#include <QListWidgetItem>
+#include <QMessageBox>
+#include <QTableWidgetItem>
+
+#include "ui_DialogCoverage.h"
+
+namespace CoveragePlugin {
+
+//------------------------------------------------------------------------------
+// Name: DialogCoverage
+// Desc:
+//------------------------------------------------------------------------------
+DialogCoverage::DialogCoverage(CoverageEngine *engine, QWidget *parent) : QDialog(parent), ui(new Ui::DialogCoverage), engine_(engine) {
+	ui->setupUi(this);
+
+	connect(engine_, SIGNAL(changed()), this, SLOT(refresh()));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogCoverage
+// Desc:
+//------------------------------------------------------------------------------
+DialogCoverage::~DialogCoverage() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void DialogCoverage::showEvent(QShowEvent *event) {
+	Q_UNUSED(event);
+	update_modules();
+	engine_->collect();
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_modules
+// Desc: lists the modules loaded now, those which were checked stay checked
+//------------------------------------------------------------------------------
+void DialogCoverage::update_modules() {
+
+	QStringList checked;
+	for(int i = 0; i < ui->listModules->count(); ++i) {
+		QListWidgetItem *const item = ui->listModules->item(i);
+		if(item->checkState() == Qt::Checked) {
+			checked << item->text();
+		}
+	}
+
+	ui->listModules->clear();
+
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		for(const Module &module : process->loaded_modules()) {
+			auto item = new QListWidgetItem(module.name, ui->listModules);
+			item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+			item->setCheckState(checked.contains(module.name) ? Qt::Checked : Qt::Unchecked);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh
+// Desc: the disassembly is kept up to date even while the dialog is closed
+//------------------------------------------------------------------------------
+void DialogCoverage::refresh() {
+
+	if(ui->chkHeat->isChecked()) {
+		edb::v1::set_code_heat(engine_->heat());
+	}
+
+	if(!isVisible()) {
+		return;
+	}
+
+	const QVector<CoverageEngine::ModuleCoverage> modules = engine_->modules();
+
+	ui->tableCoverage->setRowCount(modules.size());
+	for(int row = 0; row < modules.size(); ++row) {
+		const CoverageEngine::ModuleCoverage &module = modules[row];
+
+		const QString percent = module.blocks ? QString::number(100.0 * module.hit / module.blocks, 'f', 1) : QString();
+
+		ui->tableCoverage->setItem(row, 0, new QTableWidgetItem(QString::number(module.blocks)));
+		ui->tableCoverage->setItem(row, 1, new QTableWidgetItem(QString::number(module.hit)));
+		ui->tableCoverage->setItem(row, 2, new QTableWidgetItem(percent));
+		ui->tableCoverage->setItem(row, 3, new QTableWidgetItem(module.name));
+	}
+
+	ui->btnStop->setEnabled(edb::v1::debugger_core->coverage_points() != 0);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnStart_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogCoverage::on_btnStart_clicked() {
+
+	QStringList modules;
+	for(int i = 0; i < ui->listModules->count(); ++i) {
+		QListWidgetItem *const item = ui->listModules->item(i);
+		if(item->checkState() == Qt::Checked) {
+			modules << item->text();
+		}
+	}
+
+	if(modules.isEmpty()) {
+		QMessageBox::information(this, tr("Code Coverage"), tr("Please check the modules to cover first."));
+		return;
+	}
+
+	const Status status = engine_->start(modules);
+	if(!status) {
+		QMessageBox::critical(this, tr("Code Coverage"), tr("Failed to start: %1").arg(status.toString()));
+	}
+
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnStop_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogCoverage::on_btnStop_clicked() {
+	engine_->stop();
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnExport_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogCoverage::on_btnExport_clicked() {
+
+	engine_->collect();
+
+	const QString filename = QFileDialog::getSaveFileName(this, tr("Export Coverage"), QString(), tr("drcov Files (*.log);;All Files (*)"));
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	const Status status = engine_->write_drcov(filename);
+	if(!status) {
+		QMessageBox::critical(this, tr("Code Coverage"), tr("Failed to write %1: %2").arg(filename, status.toString()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkHeat_toggled
+// Desc:
+//------------------------------------------------------------------------------
+void DialogCoverage::on_chkHeat_toggled(bool checked) {
+	edb::v1::set_code_heat(checked ? engine_->heat() : QVector<HeatRange>());
+}
+
+}
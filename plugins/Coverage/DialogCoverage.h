@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIALOG_COVERAGE_20171014_H_
+#define DIALOG_COVERAGE_20171014_H_
+
+#include <QDialog>
+
+namespace CoveragePlugin {
+
+class CoverageEngine;
+
+namespace Ui { class DialogCoverage; }
+
+class DialogCoverage : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogCoverage(CoverageEngine *engine, QWidget *parent = 0);
+	virtual ~DialogCoverage() override;
+
+private:
+	virtual void showEvent(QShowEvent *event) override;
+
+public Q_SLOTS:
+	void on_btnStart_clicked();
+	void on_btnStop_clicked();
+	void on_btnExport_clicked();
+	void on_chkHeat_toggled(bool checked);
+
+private Q_SLOTS:
+	void refresh();
+
+private:
+	void update_modules();
+
+private:
+	Ui::DialogCoverage *const ui;
+	CoverageEngine *const     engine_;
+};
+
+}
+
+#endif
@@ -19,10 +19,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DebuggerCoreBase.h"
 #include "Breakpoint.h"
 #include "Configuration.h"
+#include "IProcess.h"
 #include "edb.h"
 #include <QtDebug>
+#include <QVector>
+#include <algorithm>
 
 namespace DebuggerCorePlugin {
+namespace {
+
+// no supported breakpoint type is anywhere near this big, it just bounds how
+// far before a range we need to look for breakpoints that extend into it
+constexpr std::size_t MaxBreakpointSize = 16;
+
+}
 
 //------------------------------------------------------------------------------
 // Name: DebuggerCoreBase
@@ -44,7 +54,61 @@ DebuggerCoreBase::~DebuggerCoreBase() {
 //------------------------------------------------------------------------------
 void DebuggerCoreBase::clear_breakpoints() {
 	if(attached()) {
+		disable_breakpoints();
 		breakpoints_.clear();
+		breakpoint_index_.clear();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: disable_breakpoints
+// Desc: restores the original bytes of all enabled breakpoints in one batch
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::disable_breakpoints() {
+
+	IProcess *const process = this->process();
+	if(!process) {
+		return;
+	}
+
+	QVector<WriteRequest>                requests;
+	QVector<std::shared_ptr<Breakpoint>> disabled;
+
+	for(auto it = breakpoint_index_.constBegin(); it != breakpoint_index_.constEnd(); ++it) {
+		const std::shared_ptr<IBreakpoint> &bp = it.value();
+		if(bp->enabled()) {
+			requests.push_back(WriteRequest{bp->address(), bp->original_bytes(), bp->size()});
+			disabled.push_back(std::static_pointer_cast<Breakpoint>(bp));
+		}
+	}
+
+	if(requests.isEmpty()) {
+		return;
+	}
+
+	const QVector<std::size_t> results = process->write_many(requests);
+	for(int i = 0; i < results.size(); ++i) {
+		if(results[i] == requests[i].size) {
+			disabled[i]->mark_disabled();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: swap_breakpoints
+// Desc: trades the breakpoints for those of <breakpoints>, for cores which
+//       keep a set for each of several processes. Nothing is written to the
+//       process, the breakpoints stay as they are in the one they belong to
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::swap_breakpoints(BreakpointList *breakpoints) {
+
+	Q_ASSERT(breakpoints);
+
+	qSwap(breakpoints_, *breakpoints);
+
+	breakpoint_index_.clear();
+	for(auto it = breakpoints_.constBegin(); it != breakpoints_.constEnd(); ++it) {
+		breakpoint_index_.insert(it.key(), it.value());
 	}
 }
 
@@ -60,6 +124,7 @@ std::shared_ptr<IBreakpoint> DebuggerCoreBase::add_breakpoint(edb::address_t add
 			if(!find_breakpoint(address)) {
 				auto bp = std::make_shared<Breakpoint>(address);
 				breakpoints_[address] = bp;
+				breakpoint_index_[address] = bp;
 				return bp;
 			}
 		}
@@ -71,6 +136,85 @@ std::shared_ptr<IBreakpoint> DebuggerCoreBase::add_breakpoint(edb::address_t add
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: add_breakpoints
+// Desc: arms them all with one vectored read of the bytes they replace and
+//       one vectored write, instead of a read and a write each
+//------------------------------------------------------------------------------
+QVector<edb::address_t> DebuggerCoreBase::add_breakpoints(const QVector<edb::address_t> &addresses) {
+
+	IProcess *const process = this->process();
+	if(!attached() || !process) {
+		return addresses;
+	}
+
+	QVector<edb::address_t> points;
+	points.reserve(addresses.size());
+	for(const edb::address_t address : addresses) {
+		if(!find_breakpoint(address)) {
+			points.push_back(address);
+		}
+	}
+
+	std::sort(points.begin(), points.end());
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	QVector<edb::address_t>              failed;
+	QVector<std::shared_ptr<Breakpoint>> pending;
+	std::vector<std::vector<quint8>>     original;
+	pending.reserve(points.size());
+	original.reserve(points.size());
+
+	for(const edb::address_t address : points) {
+		auto bp = std::make_shared<Breakpoint>(address, Breakpoint::Deferred());
+		if(const std::vector<quint8> *const bytes = bp->instruction()) {
+			pending.push_back(bp);
+			original.push_back(std::vector<quint8>(bytes->size()));
+		} else {
+			failed.push_back(address);
+		}
+	}
+
+	QVector<ReadRequest> reads;
+	reads.reserve(pending.size());
+	for(int i = 0; i < pending.size(); ++i) {
+		reads.push_back(ReadRequest{pending[i]->address(), original[i].data(), original[i].size()});
+	}
+
+	const QVector<std::size_t> read = process->read_many(reads);
+
+	QVector<WriteRequest> writes;
+	QVector<int>          written_points;
+	writes.reserve(pending.size());
+	written_points.reserve(pending.size());
+	for(int i = 0; i < pending.size(); ++i) {
+		if(read[i] == original[i].size()) {
+			const std::vector<quint8> *const bytes = pending[i]->instruction();
+			writes.push_back(WriteRequest{pending[i]->address(), bytes->data(), bytes->size()});
+			written_points.push_back(i);
+		} else {
+			failed.push_back(pending[i]->address());
+		}
+	}
+
+	const QVector<std::size_t> written = process->write_many(writes);
+
+	for(int i = 0; i < written.size(); ++i) {
+		const int n = written_points[i];
+		const std::shared_ptr<Breakpoint> &bp = pending[n];
+		if(written[i] == writes[i].size) {
+			bp->mark_enabled(original[n]);
+			breakpoints_[bp->address()]      = bp;
+			breakpoint_index_[bp->address()] = bp;
+		} else {
+			failed.push_back(bp->address());
+		}
+	}
+
+	std::sort(failed.begin(), failed.end());
+	return failed;
+}
+
 //------------------------------------------------------------------------------
 // Name: find_breakpoint
 // Desc: returns the breakpoint at the given address or std::shared_ptr<IBreakpoint>()
@@ -119,10 +263,88 @@ void DebuggerCoreBase::remove_breakpoint(edb::address_t address) {
 		auto it = breakpoints_.find(address);
 		if(it != breakpoints_.end()) {
 			breakpoints_.erase(it);
+			breakpoint_index_.remove(address);
 		}
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: restore_breakpoint_bytes
+// Desc: replaces any breakpoint bytes found in the <len> bytes of <buf> (which
+//       were read from <address>) with the original bytes
+// Note: only the breakpoints which overlap the buffer are visited
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::restore_breakpoint_bytes(edb::address_t address, void *buf, std::size_t len) const {
+
+	if(len == 0 || (breakpoint_index_.isEmpty() && coverage_points_.isEmpty())) {
+		return;
+	}
+
+	auto ptr = reinterpret_cast<quint8 *>(buf);
+	const edb::address_t end = address + len;
+
+	edb::address_t first = 0;
+	if(address > MaxBreakpointSize) {
+		first = address - MaxBreakpointSize;
+	}
+
+	for(auto it = breakpoint_index_.lowerBound(first); it != breakpoint_index_.end() && it.key() < end; ++it) {
+		const std::shared_ptr<IBreakpoint> &bp = it.value();
+		auto*const bpBytes=bp->original_bytes();
+		const auto bpAddr=bp->address();
+		// show the original bytes in the buffer..
+		for(size_t i=0; i < bp->size(); ++i) {
+			if(bpAddr + i >= address && bpAddr + i < end) {
+				ptr[bpAddr + i - address] = bpBytes[i];
+			}
+		}
+	}
+
+	// ..and the ones under the coverage points, which are a byte each
+	for(auto it = coverage_points_.lowerBound(address); it != coverage_points_.end() && it.key() < end; ++it) {
+		ptr[it.key() - address] = it.value();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: breakpoint_bytes
+// Desc: the original bytes under the breakpoints and coverage points which
+//       overlap [address, address + len), for when restore_breakpoint_bytes
+//       can't be called on the buffer itself
+//------------------------------------------------------------------------------
+QVector<QPair<edb::address_t, quint8>> DebuggerCoreBase::breakpoint_bytes(edb::address_t address, std::size_t len) const {
+
+	QVector<QPair<edb::address_t, quint8>> bytes;
+
+	if(len == 0 || (breakpoint_index_.isEmpty() && coverage_points_.isEmpty())) {
+		return bytes;
+	}
+
+	const edb::address_t end = address + len;
+
+	edb::address_t first = 0;
+	if(address > MaxBreakpointSize) {
+		first = address - MaxBreakpointSize;
+	}
+
+	for(auto it = breakpoint_index_.lowerBound(first); it != breakpoint_index_.end() && it.key() < end; ++it) {
+		const std::shared_ptr<IBreakpoint> &bp = it.value();
+		auto*const bpBytes=bp->original_bytes();
+		const auto bpAddr=bp->address();
+		for(size_t i=0; i < bp->size(); ++i) {
+			if(bpAddr + i >= address && bpAddr + i < end) {
+				bytes.push_back(qMakePair(edb::address_t(bpAddr + i), bpBytes[i]));
+			}
+		}
+	}
+
+	for(auto it = coverage_points_.lowerBound(address); it != coverage_points_.end() && it.key() < end; ++it) {
+		bytes.push_back(qMakePair(it.key(), it.value()));
+	}
+
+	return bytes;
+}
+
 //------------------------------------------------------------------------------
 // Name: end_debug_session
 // Desc: Ends debug session, detaching from or killing debuggee according to
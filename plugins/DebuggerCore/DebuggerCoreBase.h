@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define DEBUGGERCOREBASE_20090529_H_
 
 #include "IDebugger.h"
+#include <QMap>
+#include <QPair>
+#include <QVector>
 
 class Status;
 
@@ -44,6 +47,7 @@ public:
 public:
 	virtual BreakpointList backup_breakpoints() const override;
 	virtual std::shared_ptr<IBreakpoint> add_breakpoint(edb::address_t address) override;
+	virtual QVector<edb::address_t> add_breakpoints(const QVector<edb::address_t> &addresses) override;
 	virtual std::shared_ptr<IBreakpoint> find_breakpoint(edb::address_t address) override;
 	virtual std::shared_ptr<IBreakpoint> find_triggered_breakpoint(edb::address_t address) override;
 	virtual void clear_breakpoints() override;
@@ -57,10 +61,24 @@ public:
 
 protected:
 	bool attached() const;
+	void restore_breakpoint_bytes(edb::address_t address, void *buf, std::size_t len) const;
+	QVector<QPair<edb::address_t, quint8>> breakpoint_bytes(edb::address_t address, std::size_t len) const;
+	void disable_breakpoints();
+	void swap_breakpoints(BreakpointList *breakpoints);
 
 protected:
 	edb::pid_t      pid_;
 	BreakpointList  breakpoints_;
+
+	// for cores which support IDebugger::add_coverage_points, the byte each
+	// armed point replaced, and the points hit but not yet taken
+	QMap<edb::address_t, quint8> coverage_points_;
+	QVector<edb::address_t>      coverage_hits_;
+
+private:
+	// the same breakpoints as breakpoints_, but ordered by address so that we
+	// can quickly find the ones which overlap a given range
+	QMap<edb::address_t, std::shared_ptr<IBreakpoint>> breakpoint_index_;
 };
 
 }
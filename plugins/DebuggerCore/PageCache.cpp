@@ -0,0 +1,105 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PageCache.h"
+
+namespace DebuggerCorePlugin {
+
+//------------------------------------------------------------------------------
+// Name: PageCache
+// Desc: constructor
+//------------------------------------------------------------------------------
+PageCache::PageCache(edb::address_t page_size) : page_size_(page_size) {
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: returns the cached copy of the page starting at <page> or nullptr
+//------------------------------------------------------------------------------
+const QByteArray *PageCache::find(edb::address_t page) const {
+	auto it = pages_.find(page);
+	if(it != pages_.end()) {
+		++hits_;
+		return &it.value();
+	}
+
+	++misses_;
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: insert
+// Desc: records the contents of the page starting at <page>
+// Note: the returned pointer is only valid until the cache is next modified
+//------------------------------------------------------------------------------
+const QByteArray *PageCache::insert(edb::address_t page, const QByteArray &data) {
+	Q_ASSERT(data.size() == static_cast<int>(page_size_));
+
+	// we don't bother with an eviction policy, anything that reads this much
+	// between two stops doesn't benefit from the cache anyway
+	if(pages_.size() >= MaxCachedPages) {
+		pages_.clear();
+	}
+
+	return &pages_.insert(page, data).value();
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate
+// Desc: forgets everything, must be called whenever the debuggee runs
+//------------------------------------------------------------------------------
+void PageCache::invalidate() {
+	pages_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate
+// Desc: forgets any pages overlapping with [address, address + len)
+//------------------------------------------------------------------------------
+void PageCache::invalidate(edb::address_t address, std::size_t len) {
+	if(pages_.isEmpty() || len == 0) {
+		return;
+	}
+
+	const edb::address_t first = address - (address & (page_size_ - 1));
+	const edb::address_t last  = (address + (len - 1)) - ((address + (len - 1)) & (page_size_ - 1));
+
+	// if the range covers more pages than we have, it is cheaper to walk the
+	// cache than to walk the range
+	if((last - first).toUint() / page_size_.toUint() >= static_cast<quint64>(pages_.size())) {
+		for(auto it = pages_.begin(); it != pages_.end();) {
+			if(it.key() >= first && it.key() <= last) {
+				it = pages_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		return;
+	}
+
+	for(edb::address_t page = first; page <= last; page += page_size_) {
+		pages_.remove(page);
+
+		// don't wrap around at the top of the address space
+		if(page + page_size_ < page) {
+			break;
+		}
+	}
+}
+
+}
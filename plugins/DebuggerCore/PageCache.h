@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAGE_CACHE_20170612_H_
+#define PAGE_CACHE_20170612_H_
+
+#include "Types.h"
+#include <QByteArray>
+#include <QHash>
+
+namespace DebuggerCorePlugin {
+
+// A read-through cache of whole debuggee pages. The contents are only valid
+// for as long as the debuggee stays stopped, so the owner must call
+// invalidate() whenever any thread is allowed to run.
+class PageCache {
+public:
+	// reads larger than this bypass the cache entirely, scanning a big region
+	// would otherwise just evict everything the views are interested in
+	static constexpr std::size_t MaxCachedRead  = 0x4000;
+	static constexpr int         MaxCachedPages = 1024;
+
+public:
+	explicit PageCache(edb::address_t page_size);
+
+public:
+	const QByteArray *find(edb::address_t page) const;
+	const QByteArray *insert(edb::address_t page, const QByteArray &data);
+	void invalidate();
+	void invalidate(edb::address_t address, std::size_t len);
+
+public:
+	edb::address_t page_size() const { return page_size_; }
+	quint64 hits() const             { return hits_; }
+	quint64 misses() const           { return misses_; }
+	const QHash<edb::address_t, QByteArray> &pages() const { return pages_; }
+
+private:
+	edb::address_t                     page_size_;
+	QHash<edb::address_t, QByteArray>  pages_;
+	mutable quint64                    hits_   = 0;
+	mutable quint64                    misses_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "TraceWriter.h"
+#include "State.h"
+
+#include <QByteArray>
+#include <cstring>
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+const char TraceMagic[8]    = { 'E', 'D', 'B', 'T', 'R', 'A', 'C', 'E' };
+const quint32 TraceVersion  = 1;
+
+// register indexes and delta counts are stored in a byte
+const int MaxRegisters      = 0xff;
+
+//------------------------------------------------------------------------------
+// Name: traced_registers
+// Desc: the registers recorded with each step, the general purpose ones
+//       followed by the flags
+//------------------------------------------------------------------------------
+template <class F>
+void traced_registers(const State &state, F f) {
+	for(size_t i = 0; ; ++i) {
+		const Register reg = state.gp_register(i);
+		if(!reg) {
+			break;
+		}
+		f(reg);
+	}
+
+	if(const Register flags = state.flags_register()) {
+		f(flags);
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceWriter
+// Desc:
+//------------------------------------------------------------------------------
+TraceWriter::TraceWriter(const QString &filename, edb::tid_t tid, std::size_t pointer_size, bool record_registers) : file_(filename), tid_(tid), pointer_size_(pointer_size), record_registers_(record_registers) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceWriter
+// Desc:
+//------------------------------------------------------------------------------
+TraceWriter::~TraceWriter() {
+	close();
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc:
+//------------------------------------------------------------------------------
+bool TraceWriter::open() {
+	return file_.open(QIODevice::ReadWrite | QIODevice::Truncate);
+}
+
+//------------------------------------------------------------------------------
+// Name: close
+// Desc: unmaps the file and trims the unused part of the last chunk
+//------------------------------------------------------------------------------
+bool TraceWriter::close() {
+
+	if(!file_.isOpen()) {
+		return true;
+	}
+
+	if(map_) {
+		file_.unmap(map_);
+		map_ = nullptr;
+	}
+
+	const bool ok = file_.resize(position_);
+	file_.close();
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: remap
+// Desc: makes sure that the next <size> bytes are mapped
+//------------------------------------------------------------------------------
+bool TraceWriter::remap(qint64 size) {
+
+	if(map_ && position_ + size <= map_offset_ + map_size_) {
+		return true;
+	}
+
+	if(map_) {
+		file_.unmap(map_);
+		map_ = nullptr;
+	}
+
+	map_offset_ = position_;
+	map_size_   = qMax(ChunkSize, size);
+
+	if(!file_.resize(map_offset_ + map_size_)) {
+		return false;
+	}
+
+	map_ = file_.map(map_offset_, map_size_);
+	return map_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc:
+//------------------------------------------------------------------------------
+bool TraceWriter::write(const void *data, qint64 size) {
+
+	if(!remap(size)) {
+		return false;
+	}
+
+	std::memcpy(map_ + (position_ - map_offset_), data, size);
+	position_ += size;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_header
+// Desc: the register table comes from the first state we see
+//------------------------------------------------------------------------------
+bool TraceWriter::write_header(const State &state) {
+
+	QByteArray header(TraceMagic, sizeof(TraceMagic));
+
+	QVector<QByteArray> names;
+	if(record_registers_) {
+		traced_registers(state, [&names](const Register &reg) {
+			if(names.size() < MaxRegisters) {
+				names.push_back(reg.name().toLatin1().left(0xff));
+			}
+		});
+	}
+
+	const quint32 fields[] = {
+		TraceVersion,
+		static_cast<quint32>(pointer_size_),
+		static_cast<quint32>(tid_),
+		static_cast<quint32>(names.size())
+	};
+
+	header.append(reinterpret_cast<const char *>(fields), sizeof(fields));
+
+	for(const QByteArray &name : names) {
+		header.append(static_cast<char>(name.size()));
+		header.append(name);
+	}
+
+	header_written_ = true;
+	return write(header.constData(), header.size());
+}
+
+//------------------------------------------------------------------------------
+// Name: write_step
+// Desc: records the instruction about to be executed, and the registers which
+//       changed since the previous record
+//------------------------------------------------------------------------------
+bool TraceWriter::write_step(const State &state) {
+
+	if(!header_written_ && !write_header(state)) {
+		return false;
+	}
+
+	// ip, count, then up to MaxRegisters * (index, value)
+	quint8 record[sizeof(quint64) + 1 + MaxRegisters * (1 + sizeof(quint64))];
+
+	const quint64 ip = state.instruction_pointer().toUint();
+	std::memcpy(record, &ip, sizeof(ip));
+
+	quint8 count = 0;
+	std::size_t size = sizeof(ip) + 1;
+
+	if(record_registers_) {
+		const bool first = registers_.isEmpty();
+		int index = 0;
+
+		traced_registers(state, [&](const Register &reg) {
+			if(index >= MaxRegisters) {
+				return;
+			}
+
+			const quint64 value = reg.valueAsAddress().toUint();
+			if(first) {
+				registers_.push_back(value);
+			} else if(index < registers_.size() && registers_[index] == value) {
+				++index;
+				return;
+			} else if(index < registers_.size()) {
+				registers_[index] = value;
+			}
+
+			record[size] = static_cast<quint8>(index);
+			std::memcpy(&record[size + 1], &value, sizeof(value));
+			size += 1 + sizeof(value);
+			++count;
+			++index;
+		});
+	}
+
+	record[sizeof(ip)] = count;
+	return write(record, size);
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRACE_WRITER_20170622_H_
+#define TRACE_WRITER_20170622_H_
+
+#include "Types.h"
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class State;
+
+namespace DebuggerCorePlugin {
+
+// Writes the trace file described in TraceRequest.h. The file is grown and
+// memory mapped a chunk at a time, so recording a step is just a copy into
+// the mapping.
+class TraceWriter {
+	Q_DISABLE_COPY(TraceWriter)
+public:
+	static constexpr qint64 ChunkSize = 0x1000000;
+
+public:
+	TraceWriter(const QString &filename, edb::tid_t tid, std::size_t pointer_size, bool record_registers);
+	~TraceWriter();
+
+public:
+	bool open();
+	bool write_step(const State &state);
+	bool close();
+
+public:
+	QString error_string() const { return file_.errorString(); }
+	quint64 bytes() const        { return position_; }
+
+private:
+	bool write_header(const State &state);
+	bool write(const void *data, qint64 size);
+	bool remap(qint64 size);
+
+private:
+	QFile            file_;
+	edb::tid_t       tid_;
+	std::size_t      pointer_size_;
+	bool             record_registers_;
+	bool             header_written_ = false;
+	uchar           *map_            = nullptr;
+	qint64           map_offset_     = 0;
+	qint64           map_size_       = 0;
+	qint64           position_       = 0;
+	QVector<quint64> registers_;
+};
+
+}
+
+#endif
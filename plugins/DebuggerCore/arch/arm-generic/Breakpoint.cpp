@@ -50,6 +50,13 @@ Breakpoint::Breakpoint(edb::address_t address) : address_(address), hit_count_(0
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: Breakpoint
+// Desc: constructor, for a breakpoint which its creator arms
+//------------------------------------------------------------------------------
+Breakpoint::Breakpoint(edb::address_t address, Deferred) : address_(address), hit_count_(0), enabled_(false), one_time_(false), internal_(false), type_(edb::v1::config().default_breakpoint_type) {
+}
+
 auto Breakpoint::supported_types() -> std::vector<BreakpointType> {
 	std::vector<BreakpointType> types = {
 		BreakpointType{Type{TypeId::Automatic          },QObject::tr("Automatic")},
@@ -86,6 +93,29 @@ Breakpoint::~Breakpoint() {
 	disable();
 }
 
+//------------------------------------------------------------------------------
+// Name: instruction
+// Desc:
+//------------------------------------------------------------------------------
+const std::vector<quint8> *Breakpoint::instruction() const {
+	switch(TypeId{type_})
+	{
+	case TypeId::Automatic:
+		if(edb::v1::debugger_core->cpu_mode()==IDebugger::CPUMode::Thumb) {
+			return &BreakpointInstructionThumb_LE;
+		} else {
+			return &BreakpointInstructionARM_LE;
+		}
+	case TypeId::ARM32:               return &BreakpointInstructionARM_LE;
+	case TypeId::Thumb2Byte:          return &BreakpointInstructionThumb_LE;
+	case TypeId::Thumb4Byte:          return &BreakpointInstructionThumb2_LE;
+	case TypeId::UniversalThumbARM32: return &BreakpointInstructionUniversalThumbARM_LE;
+	case TypeId::ARM32BKPT:           return &BreakpointInstructionARM32BKPT_LE;
+	case TypeId::ThumbBKPT:           return &BreakpointInstructionThumbBKPT_LE;
+	default:                          return nullptr;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: enable
 // Desc:
@@ -93,31 +123,14 @@ Breakpoint::~Breakpoint() {
 bool Breakpoint::enable() {
 	if(!enabled()) {
 		if(IProcess *process = edb::v1::debugger_core->process()) {
-			std::vector<quint8> prev(4);
-			prev.resize(process->read_bytes(address(), &prev[0], prev.size()));
-			if(prev.size()) {
-				original_bytes_ = prev;
+			const std::vector<quint8> *const bpBytes = instruction();
+			if(!bpBytes) {
+				return false;
+			}
 
-				const std::vector<quint8>* bpBytes=nullptr;
-				switch(TypeId{type_})
-				{
-				case TypeId::Automatic:
-					if(edb::v1::debugger_core->cpu_mode()==IDebugger::CPUMode::Thumb) {
-						bpBytes=&BreakpointInstructionThumb_LE;
-					} else {
-						bpBytes=&BreakpointInstructionARM_LE;
-					}
-					break;
-				case TypeId::ARM32:               bpBytes=&BreakpointInstructionARM_LE; break;
-				case TypeId::Thumb2Byte:          bpBytes=&BreakpointInstructionThumb_LE; break;
-				case TypeId::Thumb4Byte:          bpBytes=&BreakpointInstructionThumb2_LE; break;
-				case TypeId::UniversalThumbARM32: bpBytes=&BreakpointInstructionUniversalThumbARM_LE; break;
-				case TypeId::ARM32BKPT:           bpBytes=&BreakpointInstructionARM32BKPT_LE; break;
-				case TypeId::ThumbBKPT:           bpBytes=&BreakpointInstructionThumbBKPT_LE; break;
-				}
-				assert(bpBytes);
-				assert(original_bytes_.size() >= bpBytes->size());
-				original_bytes_.resize(bpBytes->size());
+			std::vector<quint8> prev(bpBytes->size());
+			if(process->read_bytes(address(), &prev[0], prev.size()) == prev.size()) {
+				original_bytes_ = prev;
 
 				// FIXME: we don't check whether this breakpoint will overlap any of the existing breakpoints
 
@@ -39,8 +39,14 @@ public:
 		TYPE_COUNT
 	};
 	using Type=util::AbstractEnumData<IBreakpoint::TypeId, TypeId>;
+public:
+	// for batches of breakpoints which are armed all at once, with
+	// mark_enabled, rather than each by itself
+	struct Deferred {};
+
 public:
 	Breakpoint(edb::address_t address);
+	Breakpoint(edb::address_t address, Deferred);
 	virtual ~Breakpoint();
 
 public:
@@ -66,6 +72,19 @@ public:
 	virtual void set_type(IBreakpoint::TypeId type) override;
 	void set_type(TypeId type);
 
+	// the bytes enable() puts in place of the original ones, nullptr if the
+	// type has none
+	const std::vector<quint8> *instruction() const;
+
+public:
+	// used when the original bytes have already been written back as part of
+	// a batch, so there is no need to write them again
+	void mark_disabled() { enabled_ = false; }
+
+	// used when the breakpoint's bytes have been written as part of a batch,
+	// <original_bytes> being those they replaced
+	void mark_enabled(const std::vector<quint8> &original_bytes) { original_bytes_ = original_bytes; enabled_ = true; }
+
 private:
 	std::vector<quint8> original_bytes_;
 	edb::address_t        address_;
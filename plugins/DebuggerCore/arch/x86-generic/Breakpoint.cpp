@@ -49,6 +49,13 @@ Breakpoint::Breakpoint(edb::address_t address) : address_(address), hit_count_(0
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: Breakpoint
+// Desc: constructor, for a breakpoint which its creator arms
+//------------------------------------------------------------------------------
+Breakpoint::Breakpoint(edb::address_t address, Deferred) : address_(address), hit_count_(0), enabled_(false), one_time_(false), internal_(false), type_(edb::v1::config().default_breakpoint_type) {
+}
+
 auto Breakpoint::supported_types() -> std::vector<BreakpointType> {
 	std::vector<BreakpointType> types = {
 		BreakpointType{Type{TypeId::Automatic},QObject::tr("Automatic")},
@@ -91,6 +98,29 @@ Breakpoint::~Breakpoint() {
 	disable();
 }
 
+//------------------------------------------------------------------------------
+// Name: instruction
+// Desc:
+//------------------------------------------------------------------------------
+const std::vector<quint8> *Breakpoint::instruction() const {
+	switch(TypeId{type_})
+	{
+	case TypeId::Automatic:
+	case TypeId::INT3:  return &BreakpointInstructionINT3;
+	case TypeId::INT1:  return &BreakpointInstructionINT1;
+	case TypeId::HLT:   return &BreakpointInstructionHLT;
+	case TypeId::CLI:   return &BreakpointInstructionCLI;
+	case TypeId::STI:   return &BreakpointInstructionSTI;
+	case TypeId::INSB:  return &BreakpointInstructionINSB;
+	case TypeId::INSD:  return &BreakpointInstructionINSD;
+	case TypeId::OUTSB: return &BreakpointInstructionOUTSB;
+	case TypeId::OUTSD: return &BreakpointInstructionOUTSD;
+	case TypeId::UD2:   return &BreakpointInstructionUD2;
+	case TypeId::UD0:   return &BreakpointInstructionUD0;
+	default:            return nullptr;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: enable
 // Desc:
@@ -98,29 +128,14 @@ Breakpoint::~Breakpoint() {
 bool Breakpoint::enable() {
 	if(!enabled()) {
 		if(IProcess *process = edb::v1::debugger_core->process()) {
-			std::vector<quint8> prev(2);
-			if(process->read_bytes(address(), &prev[0], prev.size())) {
+			const std::vector<quint8> *const bpBytes = instruction();
+			if(!bpBytes) {
+				return false;
+			}
+
+			std::vector<quint8> prev(bpBytes->size());
+			if(process->read_bytes(address(), &prev[0], prev.size()) == prev.size()) {
 				original_bytes_ = prev;
-				const std::vector<quint8>* bpBytes=nullptr;
-				switch(TypeId{type_})
-				{
-				case TypeId::Automatic:
-				case TypeId::INT3:  bpBytes=&BreakpointInstructionINT3;  break;
-				case TypeId::INT1:  bpBytes=&BreakpointInstructionINT1;  break;
-				case TypeId::HLT:   bpBytes=&BreakpointInstructionHLT;   break;
-				case TypeId::CLI:   bpBytes=&BreakpointInstructionCLI;   break;
-				case TypeId::STI:   bpBytes=&BreakpointInstructionSTI;   break;
-				case TypeId::INSB:  bpBytes=&BreakpointInstructionINSB;  break;
-				case TypeId::INSD:  bpBytes=&BreakpointInstructionINSD;  break;
-				case TypeId::OUTSB: bpBytes=&BreakpointInstructionOUTSB; break;
-				case TypeId::OUTSD: bpBytes=&BreakpointInstructionOUTSD; break;
-				case TypeId::UD2:   bpBytes=&BreakpointInstructionUD2;   break;
-				case TypeId::UD0:   bpBytes=&BreakpointInstructionUD0;   break;
-				default: return false;
-				}
-				assert(bpBytes);
-				assert(original_bytes_.size() >= bpBytes->size());
-				original_bytes_.resize(bpBytes->size());
 
 				if(process->write_bytes(address(), bpBytes->data(), bpBytes->size())) {
 					enabled_ = true;
@@ -0,0 +1,364 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GdbRemote.h"
+
+#include <QElapsedTimer>
+#include <QtDebug>
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: checksum
+// Desc: the modulo 256 sum of the packet's payload
+//------------------------------------------------------------------------------
+quint8 checksum(const QByteArray &data) {
+	quint8 sum = 0;
+	for(char ch : data) {
+		sum += static_cast<quint8>(ch);
+	}
+	return sum;
+}
+
+//------------------------------------------------------------------------------
+// Name: decode
+// Desc: undoes the escaping and the run length encoding of a payload
+//------------------------------------------------------------------------------
+QByteArray decode(const QByteArray &body) {
+	QByteArray decoded;
+	decoded.reserve(body.size());
+
+	for(int i = 0; i < body.size(); ++i) {
+		const char ch = body[i];
+		if(ch == '}' && i + 1 < body.size()) {
+			decoded.append(body[++i] ^ 0x20);
+		} else if(ch == '*' && i + 1 < body.size() && !decoded.isEmpty()) {
+			const int count = static_cast<quint8>(body[++i]) - 29;
+			decoded.append(QByteArray(count, decoded[decoded.size() - 1]));
+		} else {
+			decoded.append(ch);
+		}
+	}
+
+	return decoded;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: connect
+// Desc: connects to the stub and finds out what it can do
+//------------------------------------------------------------------------------
+Status GdbRemote::connect(const QString &host, quint16 port) {
+
+	disconnect();
+
+	socket_.connectToHost(host, port);
+	if(!socket_.waitForConnected(Timeout)) {
+		return Status(tr("Unable to connect to %1:%2: %3").arg(host).arg(port).arg(socket_.errorString()));
+	}
+
+	// Nagle would hold back every pipelined packet after the first
+	socket_.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+	socket_.write("+");
+
+	const QByteArray supported = request("qSupported:multiprocess+;swbreak+;vContSupported+");
+	if(supported.isEmpty() && !socket_.isValid()) {
+		return Status(tr("No reply from %1:%2").arg(host).arg(port));
+	}
+
+	for(const QByteArray &entry : supported.split(';')) {
+		const int equals = entry.indexOf('=');
+		if(equals != -1) {
+			features_[entry.left(equals)] = entry.mid(equals + 1);
+		} else if(entry.endsWith('+')) {
+			features_[entry.left(entry.size() - 1)] = "+";
+		}
+	}
+
+	bool ok;
+	const int size = feature("PacketSize").toInt(&ok, 16);
+	if(ok && size > packet_size_) {
+		packet_size_ = size;
+	}
+
+	// without acks the replies can be matched up with the requests by order
+	// alone, which is what makes pipelining safe
+	if(supports("QStartNoAckMode") && request("QStartNoAckMode") == "OK") {
+		no_ack_ = true;
+	}
+
+	const QByteArray actions = request("vCont?");
+	if(actions.startsWith("vCont;")) {
+		features_["vCont"] = actions.mid(6);
+	}
+
+	qDebug() << "[GdbRemote] connected to" << host << port << "packet size" << packet_size_ << (no_ack_ ? "no-ack mode" : "ack mode");
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: disconnect
+// Desc:
+//------------------------------------------------------------------------------
+void GdbRemote::disconnect() {
+	socket_.abort();
+	buffer_.clear();
+	last_packet_.clear();
+	features_.clear();
+	packet_size_ = 400;
+	no_ack_      = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: connected
+// Desc:
+//------------------------------------------------------------------------------
+bool GdbRemote::connected() const {
+	return socket_.state() == QAbstractSocket::ConnectedState;
+}
+
+//------------------------------------------------------------------------------
+// Name: request
+// Desc:
+//------------------------------------------------------------------------------
+QByteArray GdbRemote::request(const QByteArray &packet) {
+	return request(QList<QByteArray>() << packet).front();
+}
+
+//------------------------------------------------------------------------------
+// Name: request
+// Desc: returns a reply for each of <packets>, in order. Without acks they go
+//       out PipelineDepth at a time, a reply which never came is empty
+//------------------------------------------------------------------------------
+QList<QByteArray> GdbRemote::request(const QList<QByteArray> &packets) {
+
+	QList<QByteArray> replies;
+
+	const int window = no_ack_ ? PipelineDepth : 1;
+
+	int sent = 0;
+	while(replies.size() < packets.size()) {
+
+		if(sent == replies.size()) {
+			++round_trips_;
+		}
+
+		while(sent < packets.size() && sent - replies.size() < window) {
+			if(!write_packet(packets[sent])) {
+				break;
+			}
+			++sent;
+		}
+
+		QByteArray reply;
+		if(sent == replies.size() || !read_packet(&reply, Timeout)) {
+			break;
+		}
+
+		replies.push_back(reply);
+	}
+
+	while(replies.size() < packets.size()) {
+		replies.push_back(QByteArray());
+	}
+
+	return replies;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_object
+// Desc: reads a whole qXfer object, an empty array means it isn't there
+//------------------------------------------------------------------------------
+QByteArray GdbRemote::read_object(const QByteArray &object, const QByteArray &annex) {
+
+	if(!supports("qXfer:" + object + ":read")) {
+		return QByteArray();
+	}
+
+	// the reply is binary, escaping can at most double it
+	const int chunk = (packet_size_ - 16) / 2;
+
+	QByteArray data;
+	for(;;) {
+		const QByteArray reply = request("qXfer:" + object + ":read:" + annex + ":" + QByteArray::number(data.size(), 16) + "," + QByteArray::number(chunk, 16));
+		if(reply.isEmpty() || (reply[0] != 'm' && reply[0] != 'l')) {
+			return QByteArray();
+		}
+
+		data.append(reply.mid(1));
+
+		if(reply[0] == 'l' || reply.size() == 1) {
+			return data;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: send
+// Desc: sends a packet whose reply comes later, if at all
+//------------------------------------------------------------------------------
+bool GdbRemote::send(const QByteArray &packet) {
+	return write_packet(packet);
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_reply
+// Desc:
+//------------------------------------------------------------------------------
+bool GdbRemote::wait_reply(QByteArray *reply, int msecs) {
+	return read_packet(reply, msecs);
+}
+
+//------------------------------------------------------------------------------
+// Name: interrupt
+// Desc: a bare ^C stops a running target, the stop reply comes as usual
+//------------------------------------------------------------------------------
+bool GdbRemote::interrupt() {
+	if(socket_.write("\x03", 1) != 1) {
+		return false;
+	}
+
+	socket_.flush();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: escape
+// Desc: for binary data sent to the stub
+//------------------------------------------------------------------------------
+QByteArray GdbRemote::escape(const QByteArray &data) {
+	QByteArray escaped;
+	escaped.reserve(data.size());
+
+	for(char ch : data) {
+		switch(ch) {
+		case '#':
+		case '$':
+		case '}':
+		case '*':
+			escaped.append('}');
+			escaped.append(ch ^ 0x20);
+			break;
+		default:
+			escaped.append(ch);
+			break;
+		}
+	}
+
+	return escaped;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_error
+// Desc: "Enn", hex data is always lower case so it can't be mistaken for it
+//------------------------------------------------------------------------------
+bool GdbRemote::is_error(const QByteArray &reply) {
+	return reply.size() >= 3 && reply[0] == 'E';
+}
+
+//------------------------------------------------------------------------------
+// Name: write_packet
+// Desc:
+//------------------------------------------------------------------------------
+bool GdbRemote::write_packet(const QByteArray &payload) {
+
+	last_packet_ = "$" + payload + "#" + QByteArray::number(checksum(payload) | 0x100, 16).right(2);
+
+	if(socket_.write(last_packet_) != last_packet_.size()) {
+		return false;
+	}
+
+	socket_.flush();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_packet
+// Desc:
+//------------------------------------------------------------------------------
+bool GdbRemote::read_packet(QByteArray *payload, int msecs) {
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while(!take_packet(payload)) {
+		const qint64 left = msecs - timer.elapsed();
+		if(left <= 0 || !socket_.waitForReadyRead(static_cast<int>(left))) {
+			return false;
+		}
+
+		buffer_.append(socket_.readAll());
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: take_packet
+// Desc: takes the next complete packet out of what was received so far
+//------------------------------------------------------------------------------
+bool GdbRemote::take_packet(QByteArray *payload) {
+
+	for(;;) {
+		// acks, and whatever else comes between packets
+		int start = 0;
+		while(start < buffer_.size() && buffer_[start] != '$' && buffer_[start] != '%') {
+			if(buffer_[start] == '-' && !no_ack_) {
+				socket_.write(last_packet_);
+				socket_.flush();
+			}
+			++start;
+		}
+		buffer_.remove(0, start);
+
+		// any '#' in the payload is escaped, so the first one ends it
+		const int hash = buffer_.indexOf('#');
+		if(buffer_.isEmpty() || hash == -1 || buffer_.size() < hash + 3) {
+			return false;
+		}
+
+		const bool notification = buffer_[0] == '%';
+		const QByteArray body   = buffer_.mid(1, hash - 1);
+
+		bool ok;
+		const bool valid = buffer_.mid(hash + 1, 2).toInt(&ok, 16) == checksum(body) && ok;
+		buffer_.remove(0, hash + 3);
+
+		// only non-stop mode sends these, and we don't ask for it
+		if(notification) {
+			continue;
+		}
+
+		if(!no_ack_) {
+			socket_.write(valid ? "+" : "-");
+			socket_.flush();
+			if(!valid) {
+				continue;
+			}
+		}
+
+		*payload = decode(body);
+		return true;
+	}
+}
+
+}
@@ -0,0 +1,92 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GDB_REMOTE_20170716_H_
+#define GDB_REMOTE_20170716_H_
+
+#include "Status.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QTcpSocket>
+
+namespace DebuggerCorePlugin {
+
+// A connection to a GDB remote serial protocol stub, gdbserver, QEMU's gdbstub
+// and the like. Everything is synchronous, but requests whose answers don't
+// depend on each other go out back to back and their replies are collected
+// afterwards, so a batch of them costs one round trip instead of one each
+class GdbRemote {
+	Q_DECLARE_TR_FUNCTIONS(GdbRemote)
+
+public:
+	// how many requests may be in flight at once, stubs queue what they can't
+	// answer yet in their socket buffer
+	static constexpr int PipelineDepth = 32;
+	static constexpr int Timeout       = 5000;
+
+public:
+	GdbRemote() = default;
+
+private:
+	GdbRemote(const GdbRemote &) = delete;
+	GdbRemote& operator=(const GdbRemote &) = delete;
+
+public:
+	Status connect(const QString &host, quint16 port);
+	void disconnect();
+	bool connected() const;
+
+public:
+	QByteArray request(const QByteArray &packet);
+	QList<QByteArray> request(const QList<QByteArray> &packets);
+	QByteArray read_object(const QByteArray &object, const QByteArray &annex);
+	bool send(const QByteArray &packet);
+	bool wait_reply(QByteArray *reply, int msecs);
+	bool interrupt();
+
+public:
+	bool supports(const QByteArray &feature) const { return features_.contains(feature); }
+	QByteArray feature(const QByteArray &name) const { return features_.value(name); }
+	int packet_size() const                          { return packet_size_; }
+	quint64 round_trips() const                      { return round_trips_; }
+
+public:
+	static QByteArray escape(const QByteArray &data);
+	static bool is_error(const QByteArray &reply);
+
+private:
+	bool write_packet(const QByteArray &payload);
+	bool read_packet(QByteArray *payload, int msecs);
+	bool take_packet(QByteArray *payload);
+
+private:
+	QTcpSocket                     socket_;
+	QByteArray                     buffer_;
+	QByteArray                     last_packet_; // resent if the stub asks for it
+	QHash<QByteArray, QByteArray>  features_;
+	int                            packet_size_ = 400; // what a stub has to take
+	bool                           no_ack_      = false;
+	quint64                        round_trips_ = 0;
+};
+
+}
+
+#endif
@@ -83,9 +83,17 @@ public:
 public:
 	virtual QString format_pointer(edb::address_t address) const;
 
+public:
+	virtual bool read_pages(edb::address_t address, void *buf, std::size_t count);
+	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len);
+	virtual bool write_bytes(edb::address_t address, const void *buf, std::size_t len);
+
 private:
 	virtual long read_data(edb::address_t address, bool *ok);
 	virtual bool write_data(edb::address_t address, long value);
+	std::size_t transfer(int op, edb::address_t address, void *buf, std::size_t len);
+	std::size_t read_words(edb::address_t address, char *buf, std::size_t len);
+	std::size_t write_words(edb::address_t address, const char *buf, std::size_t len);
 
 private:
 	struct thread_info {
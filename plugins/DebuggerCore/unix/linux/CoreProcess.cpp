@@ -0,0 +1,1035 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CoreProcess.h"
+#include "IDebugger.h"
+#include "Module.h"
+#include "PageStore.h"
+#include "PlatformRegion.h"
+#include "PlatformState.h"
+#include "PrStatus.h"
+#include "State.h"
+#include "Util.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <elf.h>
+#include <pwd.h>
+#include <sys/mman.h>
+#include <vector>
+
+#ifndef NT_X86_XSTATE
+#define NT_X86_XSTATE 0x202
+#endif
+
+#ifndef NT_FILE
+#define NT_FILE 0x46494c45
+#endif
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: value_at
+// Desc: reads a T at <offset> of <data>, zero if it runs past the end
+//------------------------------------------------------------------------------
+template <class T>
+T value_at(const QByteArray &data, int offset) {
+	T value = 0;
+	if(offset >= 0 && offset + static_cast<int>(sizeof(T)) <= data.size()) {
+		std::memcpy(&value, data.constData() + offset, sizeof(T));
+	}
+	return value;
+}
+
+//------------------------------------------------------------------------------
+// Name: string_at
+// Desc: a NUL padded, fixed size string field
+//------------------------------------------------------------------------------
+QByteArray string_at(const QByteArray &data, int offset, int size) {
+	const QByteArray field = data.mid(offset, size);
+	const int end = field.indexOf('\0');
+	return end == -1 ? field : field.left(end);
+}
+
+//------------------------------------------------------------------------------
+// Name: align4
+// Desc: note names and descriptions are padded to 4 bytes in both classes
+//------------------------------------------------------------------------------
+quint64 align4(quint64 n) {
+	return (n + 3) & ~quint64(3);
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: CoreThread
+// Desc:
+//------------------------------------------------------------------------------
+CoreThread::CoreThread(const CoreProcess *process, edb::tid_t tid, int signal, const QByteArray &regs) : process_(process), tid_(tid), signal_(signal), regs_(regs) {
+}
+
+//------------------------------------------------------------------------------
+// Name: tid
+// Desc:
+//------------------------------------------------------------------------------
+edb::tid_t CoreThread::tid() const {
+	return tid_;
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc: threads have no names of their own in a core
+//------------------------------------------------------------------------------
+QString CoreThread::name() const {
+	return process_->name();
+}
+
+//------------------------------------------------------------------------------
+// Name: priority
+// Desc:
+//------------------------------------------------------------------------------
+int CoreThread::priority() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: instruction_pointer
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t CoreThread::instruction_pointer() const {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(process_->is64Bit()) {
+		return edb::address_t::fromZeroExtended(value_at<quint64>(regs_, offsetof(PrStatus_X86_64, rip)));
+	} else {
+		return edb::address_t::fromZeroExtended(value_at<quint32>(regs_, offsetof(PrStatus_X86, eip)));
+	}
+#elif defined(EDB_ARM32)
+	return edb::address_t::fromZeroExtended(value_at<quint32>(regs_, 15 * sizeof(quint32)));
+#else
+	return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: runState
+// Desc: the signal it got when the core was written, for the thread which
+//       crashed that is the reason for the core
+//------------------------------------------------------------------------------
+QString CoreThread::runState() const {
+	if(signal_) {
+		return tr("Stopped by signal %1").arg(signal_);
+	}
+
+	return tr("Stopped");
+}
+
+//------------------------------------------------------------------------------
+// Name: get_state
+// Desc: everything is in the notes, so nothing is left to load later
+//------------------------------------------------------------------------------
+void CoreThread::get_state(State *state) {
+
+	if(auto state_impl = static_cast<PlatformState *>(state->writable_impl())) {
+
+		state_impl->clear();
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		if(process_->is64Bit()) {
+			PrStatus_X86_64 regs;
+			if(regs_.size() >= static_cast<int>(sizeof(regs))) {
+				std::memcpy(&regs, regs_.constData(), sizeof(regs));
+				state_impl->fillFrom(regs);
+			}
+
+			// fs and gs have their bases in the registers, the others are flat
+			for(std::size_t i = 0; i < PlatformState::X86::FS; ++i) {
+				state_impl->x86.segRegBases[i]       = 0;
+				state_impl->x86.segRegBasesFilled[i] = true;
+			}
+		} else {
+			PrStatus_X86 regs;
+			if(regs_.size() >= static_cast<int>(sizeof(regs))) {
+				std::memcpy(&regs, regs_.constData(), sizeof(regs));
+				state_impl->fillFrom(regs);
+			}
+		}
+
+		bool extended = false;
+		if(!xstate_.isEmpty() && xstate_.size() <= static_cast<int>(sizeof(X86XState))) {
+			X86XState xstate;
+			std::memset(&xstate, 0, sizeof(xstate));
+			std::memcpy(&xstate, xstate_.constData(), xstate_.size());
+			extended = state_impl->fillFrom(xstate, xstate_.size());
+		}
+
+		if(!extended) {
+			if(process_->is64Bit() && fpregs_.size() == sizeof(UserFPRegsStructX86_64)) {
+				UserFPRegsStructX86_64 fpregs;
+				std::memcpy(&fpregs, fpregs_.constData(), sizeof(fpregs));
+				state_impl->fillFrom(fpregs);
+			} else if(!process_->is64Bit() && fpregs_.size() == sizeof(UserFPRegsStructX86)) {
+				UserFPRegsStructX86 fpregs;
+				std::memcpy(&fpregs, fpregs_.constData(), sizeof(fpregs));
+				state_impl->fillFrom(fpregs);
+			}
+		}
+#elif defined(EDB_ARM32)
+		user_regs regs;
+		if(regs_.size() >= static_cast<int>(sizeof(regs))) {
+			std::memcpy(&regs, regs_.constData(), sizeof(regs));
+			state_impl->fillFrom(regs);
+		}
+#endif
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_state
+// Desc: a core is read only
+//------------------------------------------------------------------------------
+void CoreThread::set_state(const State &state) {
+	Q_UNUSED(state);
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreThread::step() {
+	return Status(tr("A core file can't be stepped"));
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreThread::step(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return step();
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreThread::resume() {
+	return Status(tr("A core file can't be run"));
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreThread::resume(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return resume();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreThread::stop() {
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool CoreThread::isPaused() const {
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: CoreProcess
+// Desc:
+//------------------------------------------------------------------------------
+CoreProcess::CoreProcess() : map_(nullptr), size_(0), is64_(false), pid_(0), uid_(0), entry_point_(0), page_table_offset_(0), page_table_size_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~CoreProcess
+// Desc:
+//------------------------------------------------------------------------------
+CoreProcess::~CoreProcess() {
+	if(map_) {
+		file_.unmap(const_cast<uchar *>(map_));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: maps <filename> and reads its headers, the memory itself isn't
+//       touched until something reads it
+//------------------------------------------------------------------------------
+Status CoreProcess::open(const QString &filename) {
+
+	file_.setFileName(filename);
+	if(!file_.open(QIODevice::ReadOnly)) {
+		return Status(tr("Failed to open %1: %2").arg(filename, file_.errorString()));
+	}
+
+	size_ = file_.size();
+	if(size_ < EI_NIDENT) {
+		return Status(tr("%1 is not an ELF core file").arg(filename));
+	}
+
+	map_ = file_.map(0, size_);
+	if(!map_) {
+		return Status(tr("Failed to map %1: %2").arg(filename, file_.errorString()));
+	}
+
+	// what CoreWriter writes when asked to compress
+	if(map_[0] == 0x1f && map_[1] == 0x8b) {
+		return Status(tr("%1 is compressed, it has to be uncompressed before it can be opened").arg(filename));
+	}
+
+	if(std::memcmp(map_, ELFMAG, SELFMAG) != 0) {
+		return Status(tr("%1 is not an ELF core file").arg(filename));
+	}
+
+	switch(map_[EI_CLASS]) {
+	case ELFCLASS32:
+		is64_ = false;
+		return parse<Elf32_Ehdr, Elf32_Phdr, quint32>();
+	case ELFCLASS64:
+		is64_ = true;
+		return parse<Elf64_Ehdr, Elf64_Phdr, quint64>();
+	default:
+		return Status(tr("%1 is not an ELF core file").arg(filename));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: parse
+// Desc:
+//------------------------------------------------------------------------------
+template <class Ehdr, class Phdr, class Long>
+Status CoreProcess::parse() {
+
+	const QString filename = file_.fileName();
+
+	Ehdr header;
+	if(size_ < sizeof(header)) {
+		return Status(tr("%1 is not an ELF core file").arg(filename));
+	}
+
+	std::memcpy(&header, map_, sizeof(header));
+
+	if(header.e_type != ET_CORE) {
+		return Status(tr("%1 is an ELF file, but not a core file").arg(filename));
+	}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	const bool native = header.e_machine == (sizeof(Long) == 8 ? EM_X86_64 : EM_386);
+#elif defined(EDB_ARM32)
+	const bool native = header.e_machine == EM_ARM;
+#elif defined(EDB_ARM64)
+	const bool native = header.e_machine == EM_AARCH64;
+#else
+	const bool native = false;
+#endif
+
+	if(!native) {
+		return Status(tr("%1 is a core file of another architecture").arg(filename));
+	}
+
+	if(header.e_phentsize != sizeof(Phdr) || header.e_phoff + quint64(header.e_phnum) * sizeof(Phdr) > size_) {
+		return Status(tr("%1 has a damaged program header table").arg(filename));
+	}
+
+	for(int i = 0; i < header.e_phnum; ++i) {
+		Phdr program_header;
+		std::memcpy(&program_header, map_ + header.e_phoff + i * sizeof(Phdr), sizeof(Phdr));
+
+		switch(program_header.p_type) {
+		case PT_LOAD:
+			if(program_header.p_memsz != 0) {
+				Segment segment;
+				segment.start       = program_header.p_vaddr;
+				segment.end         = program_header.p_vaddr + program_header.p_memsz;
+				segment.offset      = program_header.p_offset;
+				segment.permissions = ((program_header.p_flags & PF_R) ? PROT_READ  : 0) |
+				                      ((program_header.p_flags & PF_W) ? PROT_WRITE : 0) |
+				                      ((program_header.p_flags & PF_X) ? PROT_EXEC  : 0);
+
+				// a truncated core still has whatever made it into the file
+				if(program_header.p_offset >= size_) {
+					segment.filesz = 0;
+				} else {
+					segment.filesz = std::min<quint64>(std::min<quint64>(program_header.p_filesz, program_header.p_memsz), size_ - program_header.p_offset);
+				}
+
+				segments_.push_back(segment);
+			}
+			break;
+		case PT_NOTE:
+			if(program_header.p_offset <= size_ && program_header.p_filesz <= size_ - program_header.p_offset) {
+				parse_notes<Long>(program_header.p_offset, program_header.p_filesz);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	std::sort(segments_.begin(), segments_.end(), [](const Segment &a, const Segment &b) {
+		return a.start < b.start;
+	});
+
+	if(page_table_size_ != 0) {
+		const Status status = attach_page_table();
+		if(!status) {
+			return status;
+		}
+	}
+
+	std::sort(mappings_.begin(), mappings_.end(), [](const Mapping &a, const Mapping &b) {
+		return a.start < b.start;
+	});
+
+	if(threads_.isEmpty()) {
+		return Status(tr("%1 doesn't have the registers of any thread").arg(filename));
+	}
+
+	// the kernel puts the thread which got the signal first
+	current_thread_ = threads_.front();
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_notes
+// Desc: NT_PRSTATUS starts a thread, the register sets which follow it are
+//       that thread's
+//------------------------------------------------------------------------------
+template <class Long>
+void CoreProcess::parse_notes(quint64 offset, quint64 size) {
+
+	std::shared_ptr<CoreThread> thread;
+
+	quint64 position = 0;
+	while(size - position >= sizeof(Elf32_Nhdr)) {
+
+		Elf32_Nhdr note;
+		std::memcpy(&note, map_ + offset + position, sizeof(note));
+
+		const quint64 name_offset = position + sizeof(note);
+		const quint64 desc_offset = name_offset + align4(note.n_namesz);
+		if(desc_offset > size || note.n_descsz > size - desc_offset) {
+			break;
+		}
+
+		const QByteArray name = string_at(QByteArray::fromRawData(reinterpret_cast<const char *>(map_ + offset + name_offset), note.n_namesz), 0, note.n_namesz);
+		const QByteArray desc(reinterpret_cast<const char *>(map_ + offset + desc_offset), note.n_descsz);
+
+		if(name == "CORE") {
+			switch(note.n_type) {
+			case NT_PRSTATUS:
+			{
+				// struct elf_prstatus, see CoreWriter::build_prstatus
+				const int pid_offset  = 16 + 2 * sizeof(Long);
+				const int regs_offset = pid_offset + 16 + 8 * sizeof(Long);
+				const int regs_size   = desc.size() - regs_offset - static_cast<int>(sizeof(Long));
+				if(regs_size > 0) {
+					thread = std::make_shared<CoreThread>(this, value_at<qint32>(desc, pid_offset), value_at<qint16>(desc, 12), desc.mid(regs_offset, regs_size));
+					threads_.push_back(thread);
+				}
+				break;
+			}
+			case NT_PRFPREG:
+				if(thread) {
+					thread->fpregs_ = desc;
+				}
+				break;
+			case NT_PRPSINFO:
+			{
+				// struct elf_prpsinfo, uid_t is only 16 bits in the 32-bit one
+				const int uid_offset   = 2 * sizeof(Long);
+				const int pid_offset   = uid_offset + (sizeof(Long) == 8 ? 8 : 4);
+				const int fname_offset = pid_offset + 16;
+				uid_    = sizeof(Long) == 8 ? value_at<quint32>(desc, uid_offset) : value_at<quint16>(desc, uid_offset);
+				pid_    = value_at<qint32>(desc, pid_offset);
+				name_   = QString::fromLocal8Bit(string_at(desc, fname_offset, 16));
+				psargs_ = string_at(desc, fname_offset + 16, 80);
+				break;
+			}
+			case NT_AUXV:
+				for(int i = 0; i + 2 * static_cast<int>(sizeof(Long)) <= desc.size(); i += 2 * sizeof(Long)) {
+					if(value_at<Long>(desc, i) == AT_ENTRY) {
+						entry_point_ = value_at<Long>(desc, i + sizeof(Long));
+					}
+				}
+				break;
+			case NT_FILE:
+				parse_file_note<Long>(desc);
+				break;
+			default:
+				break;
+			}
+		} else if(name == "LINUX" && note.n_type == NT_X86_XSTATE) {
+			if(thread) {
+				thread->xstate_ = desc;
+			}
+		} else if(name == PageStore::NoteName && note.n_type == PageStore::PageTableNote) {
+			// big, so it is used where it is instead of being copied
+			page_table_offset_ = offset + desc_offset;
+			page_table_size_   = note.n_descsz;
+		}
+
+		position = desc_offset + align4(note.n_descsz);
+		if(position > size) {
+			break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_file_note
+// Desc: count, page size, then (start, end, offset in pages) for each
+//       mapping, then their names
+//------------------------------------------------------------------------------
+template <class Long>
+void CoreProcess::parse_file_note(const QByteArray &desc) {
+
+	const Long count     = value_at<Long>(desc, 0);
+	const Long page_size = value_at<Long>(desc, sizeof(Long));
+
+	if(count == 0 || count > static_cast<Long>(desc.size())) {
+		return;
+	}
+
+	int names = 2 * sizeof(Long) + 3 * sizeof(Long) * count;
+	if(names > desc.size()) {
+		return;
+	}
+
+	for(Long i = 0; i < count && names < desc.size(); ++i) {
+		const int entry = 2 * sizeof(Long) + 3 * sizeof(Long) * i;
+
+		int end = desc.indexOf('\0', names);
+		if(end == -1) {
+			end = desc.size();
+		}
+
+		Mapping mapping;
+		mapping.start  = value_at<Long>(desc, entry);
+		mapping.end    = value_at<Long>(desc, entry + sizeof(Long));
+		mapping.offset = quint64(value_at<Long>(desc, entry + 2 * sizeof(Long))) * page_size;
+		mapping.name   = QString::fromLocal8Bit(desc.constData() + names, end - names);
+		mappings_.push_back(mapping);
+
+		names = end + 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: attach_page_table
+// Desc: the note CoreWriter gives a snapshot, see CoreWriter::write. The ids
+//       are 4 byte aligned in the file, so they are used out of the mapping
+//------------------------------------------------------------------------------
+Status CoreProcess::attach_page_table() {
+
+	const QString filename = file_.fileName();
+	const uchar *const table = map_ + page_table_offset_;
+
+	quint32 page_size;
+	quint32 count;
+	if(page_table_size_ < 2 * sizeof(quint32)) {
+		return Status(tr("%1 has a damaged snapshot page table").arg(filename));
+	}
+
+	std::memcpy(&page_size, table, sizeof(page_size));
+	std::memcpy(&count, table + sizeof(page_size), sizeof(count));
+
+	if(page_size == 0 || (page_size & (page_size - 1)) != 0) {
+		return Status(tr("%1 has a damaged snapshot page table").arg(filename));
+	}
+
+	quint64 position = 2 * sizeof(quint32);
+	for(quint32 i = 0; i < count; ++i) {
+		quint64 start;
+		quint64 pages;
+		if(page_table_size_ - position < 2 * sizeof(quint64)) {
+			return Status(tr("%1 has a damaged snapshot page table").arg(filename));
+		}
+
+		std::memcpy(&start, table + position, sizeof(start));
+		std::memcpy(&pages, table + position + sizeof(start), sizeof(pages));
+		position += 2 * sizeof(quint64);
+
+		if(pages > (page_table_size_ - position) / sizeof(quint32)) {
+			return Status(tr("%1 has a damaged snapshot page table").arg(filename));
+		}
+
+		auto it = std::find_if(segments_.begin(), segments_.end(), [start](const Segment &segment) {
+			return segment.start == start;
+		});
+
+		if(it != segments_.end()) {
+			it->pages      = reinterpret_cast<const quint32 *>(table + position);
+			it->page_count = std::min<quint64>(pages, (it->end - it->start) / page_size);
+		}
+
+		position += pages * sizeof(quint32);
+	}
+
+	store_ = util::make_unique<PageStore>();
+	return store_->open(QFileInfo(filename).absolutePath(), page_size, PageStore::Read);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_stored_pages
+// Desc: reads <len> bytes at <offset> into <segment> of a snapshot from the
+//       page store, whole pages go straight to <buf>
+//------------------------------------------------------------------------------
+bool CoreProcess::read_stored_pages(const Segment *segment, quint64 offset, char *buf, quint64 len) const {
+
+	const quint64 page_size = store_->page_size();
+
+	std::vector<char> page;
+	while(len != 0) {
+		const quint64 index  = offset / page_size;
+		const quint64 within = offset % page_size;
+		const quint64 n      = std::min(len, page_size - within);
+
+		if(index >= segment->page_count) {
+			return false;
+		}
+
+		if(n == page_size) {
+			if(!store_->read(segment->pages[index], buf)) {
+				return false;
+			}
+		} else {
+			page.resize(page_size);
+			if(!store_->read(segment->pages[index], page.data())) {
+				return false;
+			}
+			std::memcpy(buf, page.data() + within, n);
+		}
+
+		buf    += n;
+		offset += n;
+		len    -= n;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_segment
+// Desc:
+//------------------------------------------------------------------------------
+const CoreProcess::Segment *CoreProcess::find_segment(quint64 address) const {
+
+	auto it = std::upper_bound(segments_.begin(), segments_.end(), address, [](quint64 address, const Segment &segment) {
+		return address < segment.start;
+	});
+
+	if(it == segments_.begin()) {
+		return nullptr;
+	}
+
+	--it;
+	return address < it->end ? &*it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_mapping
+// Desc:
+//------------------------------------------------------------------------------
+const CoreProcess::Mapping *CoreProcess::find_mapping(quint64 address) const {
+
+	auto it = std::upper_bound(mappings_.begin(), mappings_.end(), address, [](quint64 address, const Mapping &mapping) {
+		return address < mapping.start;
+	});
+
+	if(it == mappings_.begin()) {
+		return nullptr;
+	}
+
+	--it;
+	return address < it->end ? &*it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_mapped_file
+// Desc: reads what a file backed mapping held from the file, for the parts
+//       that weren't dumped. The kernel leaves code out of cores by default
+//------------------------------------------------------------------------------
+bool CoreProcess::read_mapped_file(quint64 address, void *buf, quint64 len) const {
+
+	const Mapping *mapping = find_mapping(address);
+	if(!mapping || len > mapping->end - address) {
+		return false;
+	}
+
+	std::shared_ptr<MappedFile> &file = mapped_files_[mapping->name];
+	if(!file) {
+		file = std::make_shared<MappedFile>();
+		file->file.setFileName(mapping->name);
+		if(file->file.open(QIODevice::ReadOnly)) {
+			file->size = file->file.size();
+			file->data = file->file.map(0, file->size);
+		}
+	}
+
+	const quint64 offset = mapping->offset + (address - mapping->start);
+	if(!file->data || offset > file->size || len > file->size - offset) {
+		return false;
+	}
+
+	std::memcpy(buf, file->data + offset, len);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: no system calls, just copies out of the mapping, or the page store
+//------------------------------------------------------------------------------
+std::size_t CoreProcess::read_bytes(edb::address_t address, void *buf, std::size_t len) const {
+
+	auto ptr = static_cast<char *>(buf);
+	quint64 current = address.toUint();
+
+	std::size_t done = 0;
+	while(done < len) {
+		const Segment *segment = find_segment(current);
+		if(!segment) {
+			break;
+		}
+
+		const quint64 offset = current - segment->start;
+		quint64 n = std::min<quint64>(len - done, segment->end - current);
+
+		if(segment->pages) {
+			if(!read_stored_pages(segment, offset, ptr + done, n)) {
+				break;
+			}
+		} else if(offset < segment->filesz) {
+			n = std::min(n, segment->filesz - offset);
+			std::memcpy(ptr + done, map_ + segment->offset + offset, n);
+		} else if(!read_mapped_file(current, ptr + done, n)) {
+			break;
+		}
+
+		done    += n;
+		current += n;
+	}
+
+	return done;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc:
+//------------------------------------------------------------------------------
+std::size_t CoreProcess::read_pages(edb::address_t address, void *buf, std::size_t count) const {
+	Q_ASSERT(buf);
+
+	const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+	return read_bytes(address, buf, count * page_size) / page_size;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_bytes
+// Desc: a core is read only
+//------------------------------------------------------------------------------
+std::size_t CoreProcess::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_UNUSED(address);
+	Q_UNUSED(buf);
+	Q_UNUSED(len);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: patch_bytes
+// Desc: a core is read only
+//------------------------------------------------------------------------------
+std::size_t CoreProcess::patch_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_UNUSED(address);
+	Q_UNUSED(buf);
+	Q_UNUSED(len);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: executable_name
+// Desc: the file mapped where the program starts
+//------------------------------------------------------------------------------
+QString CoreProcess::executable_name() const {
+
+	if(const Mapping *mapping = find_mapping(entry_point_)) {
+		return mapping->name;
+	}
+
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: start_time
+// Desc: not recorded in a core
+//------------------------------------------------------------------------------
+QDateTime CoreProcess::start_time() const {
+	return QDateTime();
+}
+
+//------------------------------------------------------------------------------
+// Name: arguments
+// Desc: only the first 80 characters of the command line are kept
+//------------------------------------------------------------------------------
+QList<QByteArray> CoreProcess::arguments() const {
+	QList<QByteArray> ret;
+	for(const QByteArray &argument : psargs_.split(' ')) {
+		if(!argument.isEmpty()) {
+			ret.push_back(argument);
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_working_directory
+// Desc: not recorded in a core
+//------------------------------------------------------------------------------
+QString CoreProcess::current_working_directory() const {
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: executable
+// Desc:
+//------------------------------------------------------------------------------
+QString CoreProcess::executable() const {
+	return executable_name();
+}
+
+//------------------------------------------------------------------------------
+// Name: pid
+// Desc:
+//------------------------------------------------------------------------------
+edb::pid_t CoreProcess::pid() const {
+	return pid_;
+}
+
+//------------------------------------------------------------------------------
+// Name: parent
+// Desc: the parent is long gone, or at least not what it was
+//------------------------------------------------------------------------------
+std::shared_ptr<IProcess> CoreProcess::parent() const {
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: code_address
+// Desc: the executable mapping of the program
+//------------------------------------------------------------------------------
+edb::address_t CoreProcess::code_address() const {
+
+	const QString executable = executable_name();
+	for(const Mapping &mapping : mappings_) {
+		if(mapping.name == executable) {
+			const Segment *segment = find_segment(mapping.start);
+			if(segment && (segment->permissions & PROT_EXEC)) {
+				return edb::address_t::fromZeroExtended(mapping.start);
+			}
+		}
+	}
+
+	return edb::address_t::fromZeroExtended(entry_point_);
+}
+
+//------------------------------------------------------------------------------
+// Name: data_address
+// Desc: the writable mapping of the program
+//------------------------------------------------------------------------------
+edb::address_t CoreProcess::data_address() const {
+
+	const QString executable = executable_name();
+	for(const Mapping &mapping : mappings_) {
+		if(mapping.name == executable) {
+			const Segment *segment = find_segment(mapping.start);
+			if(segment && (segment->permissions & PROT_WRITE)) {
+				return edb::address_t::fromZeroExtended(mapping.start);
+			}
+		}
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: regions
+// Desc: one for each PT_LOAD, named after the file mapped there
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IRegion>> CoreProcess::regions() const {
+
+	QList<std::shared_ptr<IRegion>> regions;
+
+	for(const Segment &segment : segments_) {
+		const Mapping *mapping = find_mapping(segment.start);
+
+		const quint64 base = mapping ? mapping->offset + (segment.start - mapping->start) : 0;
+		const QString name = mapping ? mapping->name : QString();
+
+		regions.push_back(std::make_shared<PlatformRegion>(
+			edb::address_t::fromZeroExtended(segment.start),
+			edb::address_t::fromZeroExtended(segment.end),
+			edb::address_t::fromZeroExtended(base),
+			name,
+			segment.permissions));
+	}
+
+	return regions;
+}
+
+//------------------------------------------------------------------------------
+// Name: threads
+// Desc:
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IThread>> CoreProcess::threads() const {
+	return threads_;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_thread
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<IThread> CoreProcess::current_thread() const {
+	return current_thread_;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_current_thread
+// Desc:
+//------------------------------------------------------------------------------
+void CoreProcess::set_current_thread(IThread& thread) {
+	for(const std::shared_ptr<IThread> &t : threads_) {
+		if(t->tid() == thread.tid()) {
+			current_thread_ = t;
+			break;
+		}
+	}
+	edb::v1::update_ui();
+}
+
+//------------------------------------------------------------------------------
+// Name: uid
+// Desc:
+//------------------------------------------------------------------------------
+edb::uid_t CoreProcess::uid() const {
+	return uid_;
+}
+
+//------------------------------------------------------------------------------
+// Name: user
+// Desc:
+//------------------------------------------------------------------------------
+QString CoreProcess::user() const {
+	if(const struct passwd *const pwd = ::getpwuid(uid())) {
+		return pwd->pw_name;
+	}
+
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString CoreProcess::name() const {
+	if(!name_.isEmpty()) {
+		return name_;
+	}
+
+	return QFileInfo(executable_name()).fileName();
+}
+
+//------------------------------------------------------------------------------
+// Name: loaded_modules
+// Desc: every file which was mapped from its start
+//------------------------------------------------------------------------------
+QList<Module> CoreProcess::loaded_modules() const {
+
+	QList<Module> modules;
+	QSet<QString> found_modules;
+
+	for(const Mapping &mapping : mappings_) {
+		if(mapping.offset == 0 && mapping.name.startsWith('/') && !found_modules.contains(mapping.name)) {
+			Module module;
+			module.name         = mapping.name;
+			module.base_address = edb::address_t::fromZeroExtended(mapping.start);
+			found_modules.insert(mapping.name);
+			modules.push_back(module);
+		}
+	}
+
+	return modules;
+}
+
+//------------------------------------------------------------------------------
+// Name: pause
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreProcess::pause() {
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreProcess::resume(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return Status(tr("A core file can't be run"));
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreProcess::step(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return Status(tr("A core file can't be stepped"));
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool CoreProcess::isPaused() const {
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: patches
+// Desc:
+//------------------------------------------------------------------------------
+QMap<edb::address_t, Patch> CoreProcess::patches() const {
+	return QMap<edb::address_t, Patch>();
+}
+
+}
@@ -0,0 +1,193 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CORE_PROCESS_20170714_H_
+#define CORE_PROCESS_20170714_H_
+
+#include "IProcess.h"
+#include "IRegion.h"
+#include "IThread.h"
+#include "Status.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+namespace DebuggerCorePlugin {
+
+class CoreProcess;
+class PageStore;
+
+class CoreThread : public IThread {
+	Q_DECLARE_TR_FUNCTIONS(CoreThread)
+	friend class CoreProcess;
+
+public:
+	CoreThread(const CoreProcess *process, edb::tid_t tid, int signal, const QByteArray &regs);
+
+private:
+	CoreThread(const CoreThread &) = delete;
+	CoreThread& operator=(const CoreThread &) = delete;
+
+public:
+	virtual edb::tid_t tid() const override;
+	virtual QString name() const override;
+	virtual int priority() const override;
+	virtual edb::address_t instruction_pointer() const override;
+	virtual QString runState() const override;
+
+public:
+	virtual void get_state(State *state) override;
+	virtual void set_state(const State &state) override;
+
+public:
+	virtual Status step() override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual Status resume() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status stop() override;
+
+public:
+	virtual bool isPaused() const override;
+
+private:
+	const CoreProcess *const process_;
+	edb::tid_t               tid_;
+	int                      signal_;
+	QByteArray               regs_;   // pr_reg of the NT_PRSTATUS note
+	QByteArray               fpregs_; // NT_PRFPREG
+	QByteArray               xstate_; // NT_X86_XSTATE
+};
+
+// A process as it was when a core file was written, by the kernel or by
+// CoreWriter. The file is mapped, so reads are copies out of the page cache
+// and a dump of any size opens at once. Parts of file backed mappings which
+// weren't dumped are read from the files themselves, if they are still there.
+// The memory of a snapshot is in the PageStore next to it, read a block of
+// pages at a time as it is needed
+class CoreProcess : public IProcess {
+	Q_DECLARE_TR_FUNCTIONS(CoreProcess)
+
+public:
+	CoreProcess();
+	virtual ~CoreProcess() override;
+
+private:
+	CoreProcess(const CoreProcess &) = delete;
+	CoreProcess& operator=(const CoreProcess &) = delete;
+
+public:
+	Status open(const QString &filename);
+	bool is64Bit() const { return is64_; }
+
+public:
+	virtual QDateTime                       start_time() const override;
+	virtual QList<QByteArray>               arguments() const override;
+	virtual QString                         current_working_directory() const override;
+	virtual QString                         executable() const override;
+	virtual edb::pid_t                      pid() const override;
+	virtual std::shared_ptr<IProcess>       parent() const override;
+	virtual edb::address_t                  code_address() const override;
+	virtual edb::address_t                  data_address() const override;
+	virtual QList<std::shared_ptr<IRegion>> regions() const override;
+	virtual QList<std::shared_ptr<IThread>> threads() const override;
+	virtual std::shared_ptr<IThread>        current_thread() const override;
+	virtual void                            set_current_thread(IThread& thread) override;
+	virtual edb::uid_t                      uid() const override;
+	virtual QString                         user() const override;
+	virtual QString                         name() const override;
+	virtual QList<Module>                   loaded_modules() const override;
+
+public:
+	virtual std::size_t write_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t patch_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t read_bytes(edb::address_t address, void *buf, size_t len) const override;
+	virtual std::size_t read_pages(edb::address_t address, void *buf, size_t count) const override;
+	virtual Status pause() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual bool isPaused() const override;
+	virtual QMap<edb::address_t, Patch> patches() const override;
+
+private:
+	struct Segment {
+		quint64                start;
+		quint64                end;
+		quint64                offset; // in the core file
+		quint64                filesz; // how much of it is in the core file
+		IRegion::permissions_t permissions;
+		const quint32         *pages = nullptr; // snapshots: ids in the page store
+		quint64                page_count = 0;
+	};
+
+	struct Mapping {
+		quint64 start;
+		quint64 end;
+		quint64 offset; // in the mapped file
+		QString name;
+	};
+
+	struct MappedFile {
+		QFile        file;
+		const uchar *data = nullptr;
+		quint64      size = 0;
+	};
+
+private:
+	template <class Ehdr, class Phdr, class Long>
+	Status parse();
+
+	template <class Long>
+	void parse_notes(quint64 offset, quint64 size);
+
+	template <class Long>
+	void parse_file_note(const QByteArray &desc);
+
+	Status attach_page_table();
+	const Segment *find_segment(quint64 address) const;
+	const Mapping *find_mapping(quint64 address) const;
+	bool read_mapped_file(quint64 address, void *buf, quint64 len) const;
+	bool read_stored_pages(const Segment *segment, quint64 offset, char *buf, quint64 len) const;
+	QString executable_name() const;
+
+private:
+	QFile                            file_;
+	const uchar                     *map_;
+	quint64                          size_;
+	bool                             is64_;
+	QVector<Segment>                 segments_; // sorted by address
+	QVector<Mapping>                 mappings_; // from NT_FILE
+	QList<std::shared_ptr<IThread>>  threads_;
+	std::shared_ptr<IThread>         current_thread_;
+	edb::pid_t                       pid_;
+	edb::uid_t                       uid_;
+	QString                          name_;
+	QByteArray                       psargs_;
+	quint64                          entry_point_;
+	quint64                          page_table_offset_; // of the snapshot note in the file
+	quint64                          page_table_size_;
+	std::unique_ptr<PageStore>       store_;
+	mutable QHash<QString, std::shared_ptr<MappedFile>> mapped_files_;
+};
+
+}
+
+#endif
@@ -0,0 +1,751 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CoreWriter.h"
+#include "IDebugger.h"
+#include "IRegion.h"
+#include "IThread.h"
+#include "PageStore.h"
+#include "PlatformCommon.h"
+#include "PlatformProcess.h"
+#include "edb.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <elf.h>
+#include <future>
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <vector>
+
+#ifndef PTRACE_GETREGSET
+#define PTRACE_GETREGSET static_cast<__ptrace_request>(0x4204)
+#endif
+
+#ifndef NT_X86_XSTATE
+#define NT_X86_XSTATE 0x202
+#endif
+
+#ifndef NT_FILE
+#define NT_FILE 0x46494c45
+#endif
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+// how much memory is read, and compressed, at a time
+const int ChunkSize = 0x100000;
+
+// large enough for any XSAVE layout so far
+const std::size_t MaxRegisterSet = 0x4000;
+
+//------------------------------------------------------------------------------
+// Name: append
+// Desc: appends the bytes of <value> in native order
+//------------------------------------------------------------------------------
+template <class T>
+void append(QByteArray *data, T value) {
+	data->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+//------------------------------------------------------------------------------
+// Name: pad
+// Desc: zero fills <data> up to a multiple of <alignment>
+//------------------------------------------------------------------------------
+void pad(QByteArray *data, int alignment) {
+	while(data->size() % alignment) {
+		data->append('\0');
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: append_note
+// Desc: notes are the same for both classes, 32-bit fields, 4 byte aligned
+//------------------------------------------------------------------------------
+void append_note(QByteArray *notes, const char *name, quint32 type, const QByteArray &desc) {
+	const quint32 name_size = static_cast<quint32>(std::strlen(name) + 1);
+
+	append<quint32>(notes, name_size);
+	append<quint32>(notes, static_cast<quint32>(desc.size()));
+	append<quint32>(notes, type);
+	notes->append(name, static_cast<int>(name_size));
+	pad(notes, 4);
+	notes->append(desc);
+	pad(notes, 4);
+}
+
+//------------------------------------------------------------------------------
+// Name: get_regset
+// Desc: reads one of the register sets of <tid> in the layout of the process
+//       (not edb's), returns an empty array if it isn't available
+//------------------------------------------------------------------------------
+QByteArray get_regset(edb::tid_t tid, int type) {
+	QByteArray regs(static_cast<int>(MaxRegisterSet), '\0');
+
+	struct iovec iov;
+	iov.iov_base = regs.data();
+	iov.iov_len  = regs.size();
+
+	if(ptrace(PTRACE_GETREGSET, tid, type, &iov) == -1) {
+		return QByteArray();
+	}
+
+	regs.resize(static_cast<int>(iov.iov_len));
+	return regs;
+}
+
+//------------------------------------------------------------------------------
+// Name: crc32
+// Desc: the gzip trailer needs it, Qt only offers the zlib framing
+//------------------------------------------------------------------------------
+quint32 crc32(const QByteArray &data) {
+
+	static const std::vector<quint32> table = [] {
+		std::vector<quint32> t(256);
+		for(quint32 i = 0; i < 256; ++i) {
+			quint32 c = i;
+			for(int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+
+	quint32 crc = 0xffffffff;
+	for(const char ch : data) {
+		crc = table[(crc ^ static_cast<quint8>(ch)) & 0xff] ^ (crc >> 8);
+	}
+	return crc ^ 0xffffffff;
+}
+
+//------------------------------------------------------------------------------
+// Name: gzip_member
+// Desc: compresses <data> into a complete gzip member, any number of them
+//       back to back still make a valid .gz file
+//------------------------------------------------------------------------------
+QByteArray gzip_member(const QByteArray &data) {
+
+	static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3 };
+
+	// qCompress gives a 4 byte length, a 2 byte zlib header, the deflate
+	// stream and a 4 byte adler32, the deflate stream is all we want
+	const QByteArray zlib = qCompress(data, 6);
+
+	QByteArray member;
+	member.reserve(zlib.size() + 8);
+	member.append(header, sizeof(header));
+	member.append(zlib.constData() + 6, zlib.size() - 10);
+	append<quint32>(&member, crc32(data));
+	append<quint32>(&member, static_cast<quint32>(data.size()));
+	return member;
+}
+
+//------------------------------------------------------------------------------
+// Name: dumped
+// Desc: the kernel leaves these out of its cores too, reading them either
+//       fails or has side effects
+//------------------------------------------------------------------------------
+bool dumped(const std::shared_ptr<IRegion> &region) {
+	const QString name = region->name();
+	return region->readable() && name != "[vsyscall]" && !name.startsWith("[vvar");
+}
+
+}
+
+// The output file. Holes are left as holes when writing a plain core, when
+// compressing everything is a stream of members which are made by worker
+// threads, a few of them in flight at a time
+class CoreFile {
+public:
+	CoreFile(const QString &filename, bool compress) : file_(filename), compress_(compress), offset_(0), max_jobs_(std::max(2, QThread::idealThreadCount())) {
+	}
+
+public:
+	bool open() {
+		if(!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return false;
+		}
+		pending_.reserve(ChunkSize);
+		return true;
+	}
+
+	bool write(const void *data, std::size_t size) {
+		offset_ += size;
+
+		if(!compress_) {
+			// the gap left by skip becomes a hole
+			if(file_.pos() != static_cast<qint64>(offset_ - size) && !file_.seek(offset_ - size)) {
+				return false;
+			}
+			return file_.write(static_cast<const char *>(data), size) == static_cast<qint64>(size);
+		}
+
+		auto ptr = static_cast<const char *>(data);
+		while(size != 0) {
+			const std::size_t n = std::min<std::size_t>(size, ChunkSize - pending_.size());
+			pending_.append(ptr, static_cast<int>(n));
+			ptr  += n;
+			size -= n;
+
+			if(pending_.size() == ChunkSize && !submit()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool skip(quint64 size) {
+		offset_ += size;
+
+		if(!compress_) {
+			return true;
+		}
+
+		while(size != 0) {
+			const int n = static_cast<int>(std::min<quint64>(size, ChunkSize - pending_.size()));
+			const int old_size = pending_.size();
+			pending_.resize(old_size + n);
+			std::memset(pending_.data() + old_size, 0, n);
+			size -= n;
+
+			if(pending_.size() == ChunkSize && !submit()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool close() {
+		bool ok = true;
+
+		if(compress_) {
+			if(!pending_.isEmpty()) {
+				ok = submit();
+			}
+
+			while(ok && !jobs_.empty()) {
+				ok = collect();
+			}
+		} else {
+			// a hole at the very end still has to count
+			ok = file_.flush() && file_.resize(offset_);
+		}
+
+		file_.close();
+		return ok;
+	}
+
+	quint64 offset() const       { return offset_; }
+	QString error_string() const { return file_.errorString(); }
+
+private:
+	bool submit() {
+		jobs_.push_back(std::async(std::launch::async, gzip_member, pending_));
+		pending_ = QByteArray();
+		pending_.reserve(ChunkSize);
+
+		while(jobs_.size() > max_jobs_) {
+			if(!collect()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool collect() {
+		const QByteArray member = jobs_.front().get();
+		jobs_.pop_front();
+		return file_.write(member) == member.size();
+	}
+
+private:
+	QFile                               file_;
+	bool                                compress_;
+	quint64                             offset_;
+	std::size_t                         max_jobs_;
+	QByteArray                          pending_;
+	std::deque<std::future<QByteArray>> jobs_;
+};
+
+//------------------------------------------------------------------------------
+// Name: CoreWriter
+// Desc:
+//------------------------------------------------------------------------------
+CoreWriter::CoreWriter(PlatformProcess *process) : process_(process), page_size_(edb::v1::debugger_core->page_size().toUint()) {
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc: writes the core to <filename>, gzip compressed if <compress> is set.
+//       <progress> gets the percentage of the memory copied so far, returning
+//       false from it cancels
+//------------------------------------------------------------------------------
+Status CoreWriter::write(const QString &filename, bool compress, const std::function<bool(int)> &progress) {
+	return write(filename, compress, nullptr, progress);
+}
+
+//------------------------------------------------------------------------------
+// Name: write_snapshot
+// Desc: writes a snapshot to <filename>, its pages go to the store shared by
+//       every snapshot in the same directory
+//------------------------------------------------------------------------------
+Status CoreWriter::write_snapshot(const QString &filename, const std::function<bool(int)> &progress) {
+
+	PageStore store;
+	const Status status = store.open(QFileInfo(filename).absolutePath(), static_cast<quint32>(page_size_), PageStore::Write);
+	if(!status) {
+		return status;
+	}
+
+	return write(filename, false, &store, progress);
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc:
+//------------------------------------------------------------------------------
+Status CoreWriter::write(const QString &filename, bool compress, PageStore *store, const std::function<bool(int)> &progress) {
+
+	CoreFile file(filename, compress);
+	if(!file.open()) {
+		return Status(QObject::tr("Failed to open %1: %2").arg(filename, file.error_string()));
+	}
+
+	Status status = Status::Ok;
+	if(edb::v1::debuggeeIs64Bit()) {
+		status = write<Elf64_Ehdr, Elf64_Phdr, quint64>(&file, store, progress);
+	} else {
+		status = write<Elf32_Ehdr, Elf32_Phdr, quint32>(&file, store, progress);
+	}
+
+	if(!file.close() && status) {
+		status = Status(QObject::tr("Failed to write %1: %2").arg(filename, file.error_string()));
+	}
+
+	if(!status) {
+		QFile::remove(filename);
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc: the headers, then the notes, then one PT_LOAD per mapping with its
+//       contents at a page aligned offset. For a snapshot the contents go to
+//       <store> first, and the notes get a table of the pages of each mapping
+//------------------------------------------------------------------------------
+template <class Ehdr, class Phdr, class Long>
+Status CoreWriter::write(CoreFile *file, PageStore *store, const std::function<bool(int)> &progress) {
+
+	const QList<std::shared_ptr<IRegion>> regions = process_->regions();
+	if(regions.size() + 1 >= PN_XNUM) {
+		return Status(QObject::tr("The process has too many memory mappings for a core file."));
+	}
+
+	quint64 total = 0;
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		if(dumped(region)) {
+			total += region->size().toUint();
+		}
+	}
+
+	QByteArray notes = build_notes<Long>(regions);
+
+	quint64 copied = 0;
+	if(store) {
+		// page size, mapping count, then the address, page count and page ids
+		// of each mapping
+		QByteArray table;
+		append<quint32>(&table, static_cast<quint32>(page_size_));
+		append<quint32>(&table, static_cast<quint32>(std::count_if(regions.begin(), regions.end(), dumped)));
+
+		for(const std::shared_ptr<IRegion> &region : regions) {
+			if(!dumped(region)) {
+				continue;
+			}
+
+			append<quint64>(&table, region->start().toUint());
+			append<quint64>(&table, region->size().toUint() / page_size_);
+
+			const Status status = copy_region(region, [this, store, &table](const char *data, std::size_t size) {
+				for(std::size_t offset = 0; offset < size; offset += page_size_) {
+					append<quint32>(&table, data ? store->add(data + offset) : 0);
+				}
+				return Status(Status::Ok);
+			}, &copied, total, progress);
+
+			if(!status) {
+				return status;
+			}
+		}
+
+		// the ids are only good once the store has everything
+		const Status status = store->close();
+		if(!status) {
+			return status;
+		}
+
+		qDebug() << "Snapshot:" << store->pages_added() << "pages," << store->pages_stored() << "of them new";
+		append_note(&notes, PageStore::NoteName, PageStore::PageTableNote, table);
+	}
+
+	const int phnum = regions.size() + 1;
+
+	QVector<Phdr> headers;
+	headers.reserve(phnum);
+
+	quint64 offset = sizeof(Ehdr) + phnum * sizeof(Phdr);
+
+	Phdr note;
+	std::memset(&note, 0, sizeof(note));
+	note.p_type   = PT_NOTE;
+	note.p_offset = offset;
+	note.p_filesz = notes.size();
+	note.p_align  = 4;
+	headers.push_back(note);
+
+	offset += notes.size();
+
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		offset = (offset + page_size_ - 1) & ~(page_size_ - 1);
+
+		Phdr load;
+		std::memset(&load, 0, sizeof(load));
+		load.p_type   = PT_LOAD;
+		load.p_offset = offset;
+		load.p_vaddr  = region->start().toUint();
+		load.p_memsz  = region->size().toUint();
+		load.p_filesz = dumped(region) && !store ? load.p_memsz : 0;
+		load.p_align  = page_size_;
+		load.p_flags  = (region->readable() ? PF_R : 0) | (region->writable() ? PF_W : 0) | (region->executable() ? PF_X : 0);
+		headers.push_back(load);
+
+		offset += load.p_filesz;
+	}
+
+	Ehdr header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+	header.e_ident[EI_CLASS]   = sizeof(Long) == 8 ? ELFCLASS64 : ELFCLASS32;
+	header.e_ident[EI_DATA]    = ELFDATA2LSB;
+	header.e_ident[EI_VERSION] = EV_CURRENT;
+	header.e_ident[EI_OSABI]   = ELFOSABI_NONE;
+	header.e_type              = ET_CORE;
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	header.e_machine           = sizeof(Long) == 8 ? EM_X86_64 : EM_386;
+#elif defined(EDB_ARM32)
+	header.e_machine           = EM_ARM;
+#elif defined(EDB_ARM64)
+	header.e_machine           = EM_AARCH64;
+#endif
+	header.e_version           = EV_CURRENT;
+	header.e_phoff             = sizeof(Ehdr);
+	header.e_ehsize            = sizeof(Ehdr);
+	header.e_phentsize         = sizeof(Phdr);
+	header.e_phnum             = phnum;
+
+	if(!file->write(&header, sizeof(header)) || !file->write(headers.constData(), headers.size() * sizeof(Phdr)) || !file->write(notes.constData(), notes.size())) {
+		return Status(QObject::tr("Failed to write the core file headers: %1").arg(file->error_string()));
+	}
+
+	for(int i = 0; i < regions.size(); ++i) {
+		const Phdr &load = headers[i + 1];
+		if(load.p_filesz == 0) {
+			continue;
+		}
+
+		if(!file->skip(load.p_offset - file->offset())) {
+			return Status(QObject::tr("Failed to write the core file: %1").arg(file->error_string()));
+		}
+
+		const Status status = copy_region(regions[i], [file](const char *data, std::size_t size) {
+			if(!(data ? file->write(data, size) : file->skip(size))) {
+				return Status(QObject::tr("Failed to write the core file: %1").arg(file->error_string()));
+			}
+			return Status(Status::Ok);
+		}, &copied, total, progress);
+
+		if(!status) {
+			return status;
+		}
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: copy_region
+// Desc: copies the contents of <region> out a chunk at a time to <sink>. Pages
+//       of anonymous memory which were never touched are skipped instead of
+//       read, they'd only be faulted in to read zeros
+//------------------------------------------------------------------------------
+Status CoreWriter::copy_region(const std::shared_ptr<IRegion> &region, const Sink &sink, quint64 *copied, quint64 total, const std::function<bool(int)> &progress) {
+
+	static const quint64 Resident = Q_UINT64_C(0xc000000000000000); // present or swapped
+
+	std::vector<char> buffer(ChunkSize);
+
+	const edb::address_t end = region->end();
+	for(edb::address_t address = region->start(); address < end; ) {
+
+		const std::size_t size  = static_cast<std::size_t>(std::min<quint64>(ChunkSize, (end - address).toUint()));
+		const std::size_t pages = size / page_size_;
+
+		// empty when the region isn't private anonymous memory, then every
+		// page may have contents
+		const QVector<quint64> pagemap = process_->anonymous_pagemap(address, pages);
+
+		struct Run {
+			std::size_t offset;
+			std::size_t size;
+			bool        resident;
+		};
+
+		QVector<Run>         runs;
+		QVector<ReadRequest> requests;
+
+		std::size_t page = 0;
+		while(page < pages) {
+			const bool resident = pagemap.isEmpty() || (pagemap[page] & Resident);
+
+			std::size_t last = page + 1;
+			while(last < pages && (pagemap.isEmpty() || static_cast<bool>(pagemap[last] & Resident) == resident)) {
+				++last;
+			}
+
+			const Run run = { page * page_size_, (last - page) * page_size_, resident };
+			runs.push_back(run);
+
+			if(resident) {
+				const ReadRequest request = { address + run.offset, &buffer[run.offset], run.size };
+				requests.push_back(request);
+			}
+
+			page = last;
+		}
+
+		// whatever can't be read goes in as zeros, like the kernel does
+		const QVector<std::size_t> results = process_->read_many(requests);
+		for(int i = 0; i < requests.size(); ++i) {
+			if(results[i] < requests[i].size) {
+				std::memset(static_cast<char *>(requests[i].buffer) + results[i], 0, requests[i].size - results[i]);
+			}
+		}
+
+		for(const Run &run : runs) {
+			const Status status = sink(run.resident ? &buffer[run.offset] : nullptr, run.size);
+			if(!status) {
+				return status;
+			}
+		}
+
+		address += size;
+		*copied += size;
+
+		if(progress && !progress(total ? static_cast<int>(*copied * 100 / total) : 100)) {
+			return Status(QObject::tr("Cancelled"));
+		}
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: build_notes
+// Desc: the process info, the registers of each thread (the current one
+//       first, that's the one debuggers show), the aux vector and the files
+//       behind the mappings
+//------------------------------------------------------------------------------
+template <class Long>
+QByteArray CoreWriter::build_notes(const QList<std::shared_ptr<IRegion>> &regions) const {
+
+	QByteArray notes;
+
+	append_note(&notes, "CORE", NT_PRPSINFO, build_prpsinfo<Long>());
+
+	QList<edb::tid_t> tids;
+	const std::shared_ptr<IThread> current = process_->current_thread();
+	if(current) {
+		tids.push_back(current->tid());
+	}
+
+	process_->for_each_thread([&tids, &current](const std::shared_ptr<IThread> &thread) {
+		if(!current || thread->tid() != current->tid()) {
+			tids.push_back(thread->tid());
+		}
+	});
+
+	for(const edb::tid_t tid : tids) {
+		append_note(&notes, "CORE", NT_PRSTATUS, build_prstatus<Long>(tid));
+
+		const QByteArray fpregs = get_regset(tid, NT_PRFPREG);
+		if(!fpregs.isEmpty()) {
+			append_note(&notes, "CORE", NT_PRFPREG, fpregs);
+		}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		const QByteArray xstate = get_regset(tid, NT_X86_XSTATE);
+		if(!xstate.isEmpty()) {
+			append_note(&notes, "LINUX", NT_X86_XSTATE, xstate);
+		}
+#endif
+	}
+
+	QFile auxv(QString("/proc/%1/auxv").arg(process_->pid()));
+	if(auxv.open(QIODevice::ReadOnly)) {
+		append_note(&notes, "CORE", NT_AUXV, auxv.readAll());
+	}
+
+	append_note(&notes, "CORE", NT_FILE, build_file_note<Long>(regions));
+	return notes;
+}
+
+//------------------------------------------------------------------------------
+// Name: build_prstatus
+// Desc: struct elf_prstatus, laid out by hand since the process may not be
+//       the same class as edb
+//------------------------------------------------------------------------------
+template <class Long>
+QByteArray CoreWriter::build_prstatus(edb::tid_t tid) const {
+
+	user_stat stat;
+	std::memset(&stat, 0, sizeof(stat));
+	get_user_stat(process_->pid(), &stat);
+
+	QByteArray regs = get_regset(tid, NT_PRSTATUS);
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	regs.resize(sizeof(Long) == 8 ? 27 * 8 : 17 * 4);
+#elif defined(EDB_ARM32)
+	regs.resize(18 * 4);
+#endif
+
+	QByteArray prstatus;
+	append<qint32>(&prstatus, 0);                   // pr_info.si_signo
+	append<qint32>(&prstatus, 0);                   // pr_info.si_code
+	append<qint32>(&prstatus, 0);                   // pr_info.si_errno
+	append<qint16>(&prstatus, 0);                   // pr_cursig
+	pad(&prstatus, sizeof(Long));
+	append<Long>(&prstatus, 0);                     // pr_sigpend
+	append<Long>(&prstatus, 0);                     // pr_sighold
+	append<qint32>(&prstatus, tid);                 // pr_pid
+	append<qint32>(&prstatus, stat.ppid);           // pr_ppid
+	append<qint32>(&prstatus, stat.pgrp);           // pr_pgrp
+	append<qint32>(&prstatus, stat.session);        // pr_sid
+	for(int i = 0; i < 8; ++i) {
+		append<Long>(&prstatus, 0);                 // pr_utime, pr_stime, pr_cutime, pr_cstime
+	}
+	prstatus.append(regs);                          // pr_reg
+	append<qint32>(&prstatus, 1);                   // pr_fpvalid
+	pad(&prstatus, sizeof(Long));
+	return prstatus;
+}
+
+//------------------------------------------------------------------------------
+// Name: build_prpsinfo
+// Desc: struct elf_prpsinfo, uid_t is only 16 bits in the 32-bit one
+//------------------------------------------------------------------------------
+template <class Long>
+QByteArray CoreWriter::build_prpsinfo() const {
+
+	user_stat stat;
+	std::memset(&stat, 0, sizeof(stat));
+	get_user_stat(process_->pid(), &stat);
+
+	const QFileInfo info(QString("/proc/%1").arg(process_->pid()));
+
+	QByteArray fname = process_->name().toLocal8Bit().left(15);
+	fname.resize(16);
+
+	QByteArray psargs;
+	for(const QByteArray &argument : process_->arguments()) {
+		if(!psargs.isEmpty()) {
+			psargs.append(' ');
+		}
+		psargs.append(argument);
+	}
+	psargs = psargs.left(79);
+	psargs.resize(80);
+
+	QByteArray prpsinfo;
+	prpsinfo.append(stat.state);                    // pr_state
+	prpsinfo.append(stat.state);                    // pr_sname
+	prpsinfo.append(static_cast<char>(stat.state == 'Z')); // pr_zomb
+	prpsinfo.append(static_cast<char>(stat.nice));  // pr_nice
+	pad(&prpsinfo, sizeof(Long));
+	append<Long>(&prpsinfo, stat.flags);            // pr_flag
+	if(sizeof(Long) == 8) {
+		append<quint32>(&prpsinfo, process_->uid());   // pr_uid
+		append<quint32>(&prpsinfo, info.groupId());    // pr_gid
+	} else {
+		append<quint16>(&prpsinfo, process_->uid());
+		append<quint16>(&prpsinfo, info.groupId());
+	}
+	append<qint32>(&prpsinfo, process_->pid());     // pr_pid
+	append<qint32>(&prpsinfo, stat.ppid);           // pr_ppid
+	append<qint32>(&prpsinfo, stat.pgrp);           // pr_pgrp
+	append<qint32>(&prpsinfo, stat.session);        // pr_sid
+	prpsinfo.append(fname);                         // pr_fname
+	prpsinfo.append(psargs);                        // pr_psargs
+	pad(&prpsinfo, sizeof(Long));
+	return prpsinfo;
+}
+
+//------------------------------------------------------------------------------
+// Name: build_file_note
+// Desc: NT_FILE, which lets a debugger find the files behind the mappings:
+//       count, page size, then (start, end, offset in pages) for each one,
+//       then their names
+//------------------------------------------------------------------------------
+template <class Long>
+QByteArray CoreWriter::build_file_note(const QList<std::shared_ptr<IRegion>> &regions) const {
+
+	QByteArray entries;
+	QByteArray names;
+	Long count = 0;
+
+	for(const std::shared_ptr<IRegion> &region : regions) {
+		if(region->name().startsWith('/')) {
+			append<Long>(&entries, region->start().toUint());
+			append<Long>(&entries, region->end().toUint());
+			append<Long>(&entries, region->base().toUint() / page_size_);
+			names.append(region->name().toLocal8Bit());
+			names.append('\0');
+			++count;
+		}
+	}
+
+	QByteArray note;
+	append<Long>(&note, count);
+	append<Long>(&note, page_size_);
+	note.append(entries);
+	note.append(names);
+	return note;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CORE_WRITER_20170712_H_
+#define CORE_WRITER_20170712_H_
+
+#include "Status.h"
+#include "Types.h"
+#include <QByteArray>
+#include <QList>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class IRegion;
+class QString;
+
+namespace DebuggerCorePlugin {
+
+class CoreFile;
+class PageStore;
+class PlatformProcess;
+
+// Writes an ELF core file of the stopped process. The memory goes out a
+// chunk at a time through IProcess::read_many, pages of private anonymous
+// mappings which were never touched become holes in the file. Compressed
+// cores are a series of gzip members, compressed on worker threads while
+// the next chunks are read. A snapshot is a core whose memory is in the
+// PageStore of its directory instead, the core only lists the pages
+class CoreWriter {
+public:
+	explicit CoreWriter(PlatformProcess *process);
+
+private:
+	CoreWriter(const CoreWriter &) = delete;
+	CoreWriter& operator=(const CoreWriter &) = delete;
+
+public:
+	Status write(const QString &filename, bool compress, const std::function<bool(int)> &progress);
+	Status write_snapshot(const QString &filename, const std::function<bool(int)> &progress);
+
+private:
+	Status write(const QString &filename, bool compress, PageStore *store, const std::function<bool(int)> &progress);
+
+	template <class Ehdr, class Phdr, class Long>
+	Status write(CoreFile *file, PageStore *store, const std::function<bool(int)> &progress);
+
+	template <class Long>
+	QByteArray build_notes(const QList<std::shared_ptr<IRegion>> &regions) const;
+
+	template <class Long>
+	QByteArray build_prstatus(edb::tid_t tid) const;
+
+	template <class Long>
+	QByteArray build_prpsinfo() const;
+
+	template <class Long>
+	QByteArray build_file_note(const QList<std::shared_ptr<IRegion>> &regions) const;
+
+	// given runs of the region in order, nullptr for ones that are all zeros
+	typedef std::function<Status(const char *data, std::size_t size)> Sink;
+
+	Status copy_region(const std::shared_ptr<IRegion> &region, const Sink &sink, quint64 *copied, quint64 total, const std::function<bool(int)> &progress);
+
+private:
+	PlatformProcess *process_;
+	quint64          page_size_;
+};
+
+}
+
+#endif
@@ -17,29 +17,50 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 
-// TODO(eteran): research usage of process_vm_readv, process_vm_writev
-
 #include "DebuggerCore.h"
+#include "BranchTrace.h"
 #include "Configuration.h"
+#include "CoreProcess.h"
+#include "ImageProcess.h"
 #include "DialogMemoryAccess.h"
 #include "edb.h"
 #include "FeatureDetect.h"
+#include "Instruction.h"
+#include "Instrumentation.h"
 #include "MemoryRegions.h"
+#include "PerfBranchTrace.h"
+#include "PerfProfiler.h"
 #include "PlatformCommon.h"
 #include "PlatformEvent.h"
 #include "PlatformProcess.h"
 #include "PlatformRegion.h"
 #include "PlatformState.h"
 #include "PlatformThread.h"
+#include "RemoteProcess.h"
 #include "State.h"
+#include "StepCondition.h"
+#include "SyscallFilter.h"
+#include "TraceRequest.h"
+#include "TraceWriter.h"
+#include "Util.h"
 #include "string_hash.h"
 
+#include <QApplication>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
 #include <QSettings>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstddef>
 #include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <pwd.h>
 
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE        /* or _BSD_SOURCE or _SVID_SOURCE */
@@ -52,6 +73,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sys/ptrace.h>
 #include <sys/mman.h>
 #include <sys/personality.h>
+#include <sys/stat.h>
+#include <sys/user.h>
+#include <sys/wait.h>
 
 // doesn't always seem to be defined in the headers
 
@@ -59,14 +83,62 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PTRACE_GETSIGINFO static_cast<__ptrace_request>(0x4202)
 #endif
 
+#ifndef PTRACE_EVENT_FORK
+#define PTRACE_EVENT_FORK 1
+#endif
+
+#ifndef PTRACE_EVENT_VFORK
+#define PTRACE_EVENT_VFORK 2
+#endif
+
 #ifndef PTRACE_EVENT_CLONE
 #define PTRACE_EVENT_CLONE 3
 #endif
 
+#ifndef PTRACE_EVENT_EXEC
+#define PTRACE_EVENT_EXEC 4
+#endif
+
+#ifndef PTRACE_O_TRACEFORK
+#define PTRACE_O_TRACEFORK (1 << PTRACE_EVENT_FORK)
+#endif
+
+#ifndef PTRACE_O_TRACEVFORK
+#define PTRACE_O_TRACEVFORK (1 << PTRACE_EVENT_VFORK)
+#endif
+
+#ifndef PTRACE_O_TRACEEXEC
+#define PTRACE_O_TRACEEXEC (1 << PTRACE_EVENT_EXEC)
+#endif
+
 #ifndef PTRACE_O_TRACECLONE
 #define PTRACE_O_TRACECLONE (1 << PTRACE_EVENT_CLONE)
 #endif
 
+#ifndef PTRACE_O_TRACESYSGOOD
+#define PTRACE_O_TRACESYSGOOD 1
+#endif
+
+#ifndef PTRACE_EVENT_SECCOMP
+#define PTRACE_EVENT_SECCOMP 7
+#endif
+
+#ifndef PTRACE_O_TRACESECCOMP
+#define PTRACE_O_TRACESECCOMP (1 << PTRACE_EVENT_SECCOMP)
+#endif
+
+#ifndef PTRACE_SEIZE
+#define PTRACE_SEIZE static_cast<__ptrace_request>(0x4206)
+#endif
+
+#ifndef PTRACE_INTERRUPT
+#define PTRACE_INTERRUPT static_cast<__ptrace_request>(0x4207)
+#endif
+
+#ifndef PTRACE_EVENT_STOP
+#define PTRACE_EVENT_STOP 128
+#endif
+
 #ifndef PTRACE_O_EXITKILL
 #define PTRACE_O_EXITKILL	(1 << 20)
 #endif
@@ -75,12 +147,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PTRACE_O_TRACEEXIT	(1 << PTRACE_EVENT_EXIT)
 #endif
 
+#if defined(EDB_X86) || defined(EDB_X86_64)
+#ifndef PTRACE_SINGLEBLOCK
+#define PTRACE_SINGLEBLOCK static_cast<__ptrace_request>(33)
+#endif
+#endif
+
 namespace DebuggerCorePlugin {
 
 namespace {
 
 const edb::address_t PageSize = 0x1000;
 
+// stopping all threads taking longer than this (in ms) gets logged
+const qint64 SlowStopThreshold = 50;
+
+// how many steps record_trace takes between progress reports
+const quint64 TraceProgressInterval = 0x10000;
+
+// how often (in ms) progress is reported while a filtered out call runs
+const int RunProgressInterval = 50;
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+// what a coverage point puts in place of the first byte of its instruction
+const quint8 CoverageInstruction = 0xcc; // int3
+#endif
+
 //------------------------------------------------------------------------------
 // Name: is_numeric
 // Desc: returns true if the string only contains decimal digits
@@ -95,6 +187,27 @@ bool is_numeric(const QString &s) {
 	return true;
 }
 
+//------------------------------------------------------------------------------
+// Name: process_name
+// Desc: the command name from /proc/<pid>/stat, which is the part between the
+//       first '(' and the last ')', it may contain either itself
+//------------------------------------------------------------------------------
+QString process_name(edb::pid_t pid) {
+	QFile file(QString("/proc/%1/stat").arg(pid));
+	if(!file.open(QIODevice::ReadOnly)) {
+		return QString();
+	}
+
+	const QByteArray line = file.readLine();
+	const int first = line.indexOf('(');
+	const int last  = line.lastIndexOf(')');
+	if(first == -1 || last < first) {
+		return QString();
+	}
+
+	return QString::fromLocal8Bit(line.mid(first + 1, last - first - 1));
+}
+
 //------------------------------------------------------------------------------
 // Name: is_clone_event
 // Desc:
@@ -103,6 +216,82 @@ bool is_clone_event(int status) {
     return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_CLONE << 8)));
 }
 
+//------------------------------------------------------------------------------
+// Name: is_fork_event
+// Desc:
+//------------------------------------------------------------------------------
+bool is_fork_event(int status) {
+	return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_FORK << 8)));
+}
+
+//------------------------------------------------------------------------------
+// Name: reap_process
+// Desc: kills <pid>, which we trace, and waits until it is gone, the threads
+//       in <tids> before the thread group leader, whose exit comes last
+//------------------------------------------------------------------------------
+void reap_process(edb::pid_t pid, const QList<edb::tid_t> &tids) {
+
+	::kill(pid, SIGKILL);
+
+	auto reap = [](edb::tid_t tid) {
+		int status;
+		while(native::waitpid(tid, &status, __WALL) > 0) {
+			if(WIFEXITED(status) || WIFSIGNALED(status)) {
+				break;
+			}
+		}
+	};
+
+	for(edb::tid_t tid : tids) {
+		if(tid != pid) {
+			reap(tid);
+		}
+	}
+
+	reap(pid);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_vfork_event
+// Desc: the child shares the parent's memory until it calls exec
+//------------------------------------------------------------------------------
+bool is_vfork_event(int status) {
+	return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_VFORK << 8)));
+}
+
+//------------------------------------------------------------------------------
+// Name: is_exec_event
+// Desc:
+//------------------------------------------------------------------------------
+bool is_exec_event(int status) {
+	return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8)));
+}
+
+//------------------------------------------------------------------------------
+// Name: is_syscall_stop
+// Desc: with PTRACE_O_TRACESYSGOOD, PTRACE_SYSCALL stops report SIGTRAP | 0x80
+//------------------------------------------------------------------------------
+bool is_syscall_stop(int status) {
+	return WIFSTOPPED(status) && WSTOPSIG(status) == (SIGTRAP | 0x80);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_seccomp_event
+// Desc:
+//------------------------------------------------------------------------------
+bool is_seccomp_event(int status) {
+	return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_SECCOMP << 8)));
+}
+
+//------------------------------------------------------------------------------
+// Name: is_interrupt_stop
+// Desc: the stop of a seized thread caused by PTRACE_INTERRUPT, new threads of
+//       a seized process also start out with one of these
+//------------------------------------------------------------------------------
+bool is_interrupt_stop(int status) {
+	return (status >> 8 == (SIGTRAP | (PTRACE_EVENT_STOP << 8)));
+}
+
 //------------------------------------------------------------------------------
 // Name: is_exit_trace_event
 // Desc:
@@ -162,7 +351,11 @@ DebuggerCore::DebuggerCore() :
 	USER_CS_64(osIs64Bit ? 0x33 : 0xfff8), // RPL 0 can't appear in user segment registers, so 0xfff8 is safe
 	USER_SS(osIs64Bit    ? 0x2b : 0x7b),
 #endif
-	lastMeansOfCapture(MeansOfCapture::NeverCaptured)
+	lastMeansOfCapture(MeansOfCapture::NeverCaptured),
+	soft_dirty_supported_(feature::detect_soft_dirty()),
+	soft_dirty_valid_(false),
+	soft_dirty_cleared_(false),
+	page_cache_(PageSize)
 	
 	 {
 
@@ -173,19 +366,32 @@ DebuggerCore::DebuggerCore() :
 #endif
 #endif
 
-	proc_mem_write_broken_ = true;
-	proc_mem_read_broken_  = true;
+	// probed once per boot, after that this costs a settings lookup
+	const feature::MemoryAccess access = feature::detect_memory_access();
+	proc_mem_read_broken_    = access.proc_mem_read_broken;
+	proc_mem_write_broken_   = access.proc_mem_write_broken;
+	process_vm_read_broken_  = access.process_vm_read_broken;
+	process_vm_write_broken_ = access.process_vm_write_broken;
+
+	io_queue_.set_methods(!process_vm_read_broken_, !proc_mem_read_broken_);
 
-	feature::detect_proc_access(&proc_mem_read_broken_, &proc_mem_write_broken_);
+	if(process_vm_read_broken_ || process_vm_write_broken_) {
+		qDebug() << "Detect that process_vm_readv works    = " << !process_vm_read_broken_;
+		qDebug() << "Detect that process_vm_writev works   = " << !process_vm_write_broken_;
+	}
+
+	// how long (in ms) to wait for all threads to stop, 0 means forever
+	stop_threads_timeout_ = QSettings().value("DebuggerCore/stop_threads_timeout.ms", 5000).toInt();
 
 	if(proc_mem_read_broken_ || proc_mem_write_broken_) {
 
 		qDebug() << "Detect that read /proc/<pid>/mem works  = " << !proc_mem_read_broken_;
 		qDebug() << "Detect that write /proc/<pid>/mem works = " << !proc_mem_write_broken_;
 
+		// a headless session has no widgets to warn with, the log will do
 		QSettings settings;
 		const bool warn = settings.value("DebuggerCore/warn_on_broken_proc_mem.enabled", true).toBool();
-		if(warn) {
+		if(warn && qobject_cast<QApplication *>(QCoreApplication::instance())) {
 			auto dialog = new DialogMemoryAccess(0);
 			dialog->exec();
 
@@ -300,12 +506,20 @@ Status DebuggerCore::ptrace_continue(edb::tid_t tid, long status) {
 	//               in the first place if we aren't stopped on this TID :-(
 	if(waited_threads_.contains(tid)) {
 		Q_ASSERT(tid != 0);
-		if(ptrace(PTRACE_CONT, tid, 0, status)==-1) {
+		invalidate_memory_caches();
+		clear_soft_dirty();
+		invalidate_state_cache(tid);
+		const bool syscall_stops = want_syscall_stops();
+		if(ptrace(syscall_stops ? PTRACE_SYSCALL : PTRACE_CONT, tid, 0, status)==-1) {
 			const char*const strError=strerror(errno);
 			qWarning() << "Unable to continue thread" << tid << ": PTRACE_CONT failed:" << strError;
 			return Status(strError);
 		}
+		if(!syscall_stops) {
+			reset_syscall_state(tid);
+		}
 		waited_threads_.remove(tid);
+		stepping_threads_.remove(tid);
 		return Status::Ok;
 	}
 	return Status(QObject::tr("ptrace_continue(): waited_threads_ doesn't contain tid %1").arg(tid));
@@ -321,17 +535,165 @@ Status DebuggerCore::ptrace_step(edb::tid_t tid, long status) {
 	//               in the first place if we aren't stopped on this TID :-(
 	if(waited_threads_.contains(tid)) {
 		Q_ASSERT(tid != 0);
+		invalidate_memory_caches();
+		invalidate_state_cache(tid);
 		if(ptrace(PTRACE_SINGLESTEP, tid, 0, status)==-1) {
 			const char*const strError=strerror(errno);
 			qWarning() << "Unable to step thread" << tid << ": PTRACE_SINGLESTEP failed:" << strError;
 			return Status(strError);
 		}
+		reset_syscall_state(tid);
 		waited_threads_.remove(tid);
+		stepping_threads_.insert(tid);
 		return Status::Ok;
 	}
 	return Status(QObject::tr("ptrace_step(): waited_threads_ doesn't contain tid %1").arg(tid));
 }
 
+#if defined(EDB_X86) || defined(EDB_X86_64)
+//------------------------------------------------------------------------------
+// Name: ptrace_step_block
+// Desc: like ptrace_step, but the thread runs until it takes a branch (using
+//       the BTF bit of DEBUGCTL), so it stops at the start of the next block
+//------------------------------------------------------------------------------
+Status DebuggerCore::ptrace_step_block(edb::tid_t tid, long status) {
+	if(waited_threads_.contains(tid)) {
+		Q_ASSERT(tid != 0);
+		invalidate_memory_caches();
+		invalidate_state_cache(tid);
+		if(ptrace(PTRACE_SINGLEBLOCK, tid, 0, status)==-1) {
+			const char*const strError=strerror(errno);
+			qWarning() << "Unable to block step thread" << tid << ": PTRACE_SINGLEBLOCK failed:" << strError;
+			return Status(strError);
+		}
+		reset_syscall_state(tid);
+		waited_threads_.remove(tid);
+		stepping_threads_.insert(tid);
+		return Status::Ok;
+	}
+	return Status(QObject::tr("ptrace_step_block(): waited_threads_ doesn't contain tid %1").arg(tid));
+}
+#endif
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+//------------------------------------------------------------------------------
+// Name: inject_syscall
+// Desc: has the stopped thread <tid> make system call <number> with <args>
+//       right now, waiting for it here rather than through wait_debug_event.
+//       The thread's registers and the code bytes borrowed for the syscall
+//       instruction are put back afterwards, other stops it reports in the
+//       meantime are left for wait_debug_event, unless <on_event> takes the
+//       ptrace event stops the call itself causes. Returns the raw return value
+//------------------------------------------------------------------------------
+Result<edb::reg_t> DebuggerCore::inject_syscall(edb::tid_t tid, long number, const QVector<edb::reg_t> &args, const std::function<bool(int)> &on_event) {
+
+	// if a signal keeps getting in the way, give up eventually
+	const int MaxAttempts = 8;
+
+	auto it = threads_.find(tid);
+	if(it == threads_.end() || !waited_threads_.contains(tid) || has_pending_event(tid)) {
+		return Result<edb::reg_t>(tr("Thread %1 is not stopped").arg(tid), edb::reg_t(0));
+	}
+
+	Q_ASSERT(args.size() <= 6);
+
+	const std::shared_ptr<PlatformThread> thread = it.value();
+
+	const edb::address_t code_address = syscall_address();
+	if(code_address == 0) {
+		return Result<edb::reg_t>(tr("There is no executable memory to run a system call from"), edb::reg_t(0));
+	}
+
+	const bool is32 = edb::v1::debuggeeIs32Bit();
+
+	static const quint8 syscall32[2] = { 0xcd, 0x80 }; // int $0x80
+	static const quint8 syscall64[2] = { 0x0f, 0x05 }; // syscall
+
+	static const char *const args32[6] = { "ebx", "ecx", "edx", "esi", "edi", "ebp" };
+	static const char *const args64[6] = { "rdi", "rsi", "rdx", "r10", "r8", "r9" };
+
+	quint8 saved_code[2];
+	if(process_->read_bytes(code_address, saved_code, sizeof(saved_code)) != sizeof(saved_code) ||
+	   process_->write_bytes(code_address, is32 ? syscall32 : syscall64, sizeof(saved_code)) != sizeof(saved_code)) {
+		return Result<edb::reg_t>(tr("Unable to write the system call instruction"), edb::reg_t(0));
+	}
+
+	const int saved_status = thread->status_;
+
+	State saved;
+	thread->get_state(&saved);
+
+	State state(saved);
+	state.set_instruction_pointer(code_address);
+	state.set_register(is32 ? "eax" : "rax", edb::reg_t::fromZeroExtended(number));
+	for(int i = 0; i < args.size(); ++i) {
+		state.set_register(is32 ? args32[i] : args64[i], args[i]);
+	}
+	thread->set_state(state);
+
+	Result<edb::reg_t> result(tr("The system call did not complete"), edb::reg_t(0));
+
+	for(int attempt = 0; attempt < MaxAttempts; ++attempt) {
+
+		const Status step_status = ptrace_step(tid, 0);
+		if(!step_status) {
+			result = Result<edb::reg_t>(step_status.toString(), edb::reg_t(0));
+			break;
+		}
+
+		int status = 0;
+		if(native::waitpid(tid, &status, __WALL) <= 0) {
+			result = Result<edb::reg_t>(tr("Unable to wait for thread %1: %2").arg(tid).arg(strerror(errno)), edb::reg_t(0));
+			break;
+		}
+
+		waited_threads_.insert(tid);
+
+		if(!WIFSTOPPED(status)) {
+			// it is gone, nothing to restore
+			pending_events_.enqueue(qMakePair(tid, status));
+			return Result<edb::reg_t>(tr("Thread %1 exited during a system call").arg(tid), edb::reg_t(0));
+		}
+
+		if(WSTOPSIG(status) == SIGTRAP && (status >> 16) == 0) {
+			State after;
+			thread->get_state(&after);
+			result = Result<edb::reg_t>(after[is32 ? "eax" : "rax"].valueAsAddress());
+			break;
+		}
+
+		// e.g. the fork event of an injected fork(), the step goes on from it
+		if((status >> 16) != 0 && on_event && on_event(status)) {
+			continue;
+		}
+
+		// a signal came first and the instruction didn't run, it gets
+		// reported later as usual
+		pending_events_.enqueue(qMakePair(tid, status));
+	}
+
+	thread->set_state(saved);
+	thread->status_ = saved_status;
+	process_->write_bytes(code_address, saved_code, sizeof(saved_code));
+
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// Name: syscall_address
+// Desc: where inject_syscall borrows the bytes for its syscall instruction,
+//       any executable address will do. 0 if there is none
+//------------------------------------------------------------------------------
+edb::address_t DebuggerCore::syscall_address() const {
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(region->executable()) {
+			return region->start();
+		}
+	}
+	return 0;
+}
+#endif
+
 //------------------------------------------------------------------------------
 // Name: ptrace_set_options
 // Desc:
@@ -372,6 +734,14 @@ long DebuggerCore::ptraceOptions() const {
     // we want to trace clone (thread) creation events
     long options = PTRACE_O_TRACECLONE;
 
+    // and forks, so that the children don't run into the breakpoints they
+    // inherit, see handle_fork
+    options |= PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK;
+
+    // tell system call stops apart from real SIGTRAPs, and get the events of
+    // our seccomp filter, see set_syscall_catchpoints
+    options |= PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACESECCOMP;
+
     // if applicable, we want an auto SIGKILL sent to the child
     // process and its threads
     switch(edb::v1::config().close_behavior) {
@@ -402,200 +772,1913 @@ long DebuggerCore::ptraceOptions() const {
 void DebuggerCore::handle_thread_exit(edb::tid_t tid, int status) {
 
 	threads_.remove(tid);
+	thread_list_valid_ = false;
 	waited_threads_.remove(tid);
+	stepping_threads_.remove(tid);
 }
 
 //------------------------------------------------------------------------------
-// Name: handle_event
-// Desc:
+// Name: handle_fork
+// Desc: decides what becomes of the child <tid> just forked, which is stopped
+//       and still traced by us. A vfork child shares its memory with the
+//       parent, so taking the breakpoints out of it would take them out of
+//       the parent too, it is kept running until it calls exec instead
 //------------------------------------------------------------------------------
-std::shared_ptr<IDebugEvent> DebuggerCore::handle_event(edb::tid_t tid, int status) {
-
-	// note that we have waited on this thread
-	waited_threads_.insert(tid);
+void DebuggerCore::handle_fork(edb::tid_t tid, int status) {
 
-	// was it a thread exit event?
-	if(WIFEXITED(status)) {
-
-		handle_thread_exit(tid,status);
-		// if this was the last thread, return true
-		// so we report it to the user.
-		// if this wasn't, then we should silently
-		// procceed.
-		if(!threads_.empty()) {
-			return nullptr;
-		}
+	unsigned long message;
+	if(!ptrace_get_event_message(tid, &message)) {
+		return;
 	}
 
-    if(is_exit_trace_event(status)) {
+	const auto child = static_cast<edb::pid_t>(message);
 
-    }
+	// its first stop, which may or may not have arrived already
+	int child_status;
+	if(native::waitpid(child, &child_status, __WALL) <= 0 || !WIFSTOPPED(child_status)) {
+		qWarning("handle_fork(): child [%d] did not start as expected: status=0x%x", static_cast<int>(child), child_status);
+		return;
+	}
 
-	// was it a thread create event?
-	if(is_clone_event(status)) {
+	const long exit_kill = ptraceOptions() & PTRACE_O_EXITKILL;
 
-		unsigned long new_tid;
-		if(ptrace_get_event_message(tid, &new_tid)) {
+	if(is_vfork_event(status)) {
+		ptrace_set_options(child, exit_kill | PTRACE_O_TRACEEXEC);
+		forked_children_.insert(child, true);
+		ptrace(PTRACE_CONT, child, 0, 0);
+		return;
+	}
 
-			auto newThread            = std::make_shared<PlatformThread>(this, process_, new_tid);
-			newThread->status_        = 0;
-			newThread->signal_status_ = PlatformThread::Stopped;
+	strip_inherited_breakpoints(child);
+	apply_fork_behavior(child);
+}
 
-			threads_.insert(new_tid, newThread);
+//------------------------------------------------------------------------------
+// Name: apply_fork_behavior
+// Desc: <child> is stopped, and has none of our breakpoints. What is done with
+//       it is up to Configuration::fork_behavior
+//------------------------------------------------------------------------------
+void DebuggerCore::apply_fork_behavior(edb::pid_t child) {
 
-			int thread_status = 0;
-			if(!waited_threads_.contains(new_tid)) {
-				if(native::waitpid(new_tid, &thread_status, __WALL) > 0) {
-					waited_threads_.insert(new_tid);
-				}
-			}
+	switch(edb::v1::config().fork_behavior) {
+	case Configuration::ContinueChild:
+		// none of its own threads or children, nothing but its signals stop it
+		ptrace_set_options(child, ptraceOptions() & PTRACE_O_EXITKILL);
+		forked_children_.insert(child, false);
+		ptrace(PTRACE_CONT, child, 0, 0);
+		break;
+	case Configuration::DebugChild:
+		// it stays stopped until the new instance has attached to it
+		forked_children_.remove(child);
+		if(ptrace(PTRACE_DETACH, child, 0, SIGSTOP) == -1) {
+			qWarning() << "Unable to detach from child" << child << ":" << strerror(errno);
+			break;
+		}
 
-			// A new thread could exit before we have fully created it, no event then since it can't be the last thread
-			if(WIFEXITED(thread_status)) {
-				handle_thread_exit(tid,thread_status);
-				return nullptr;
-			}
+		if(!QProcess::startDetached(QCoreApplication::applicationFilePath(), QStringList() << "--attach" << QString::number(child))) {
+			qWarning() << "Unable to start a debugger for child" << child;
+			::kill(child, SIGCONT);
+		}
+		break;
+	case Configuration::DetachChild:
+	default:
+		forked_children_.remove(child);
+		if(ptrace(PTRACE_DETACH, child, 0, 0) == -1) {
+			qWarning() << "Unable to detach from child" << child << ":" << strerror(errno);
+		}
+		break;
+	}
+}
 
-			if(!WIFSTOPPED(thread_status) || WSTOPSIG(thread_status) != SIGSTOP) {
-				qWarning("handle_event(): new thread [%d] received an event besides SIGSTOP: status=0x%x", static_cast<int>(new_tid),thread_status);
-			}
+//------------------------------------------------------------------------------
+// Name: handle_child_event
+// Desc: a child kept in the background stopped, it is sent on its way with
+//       whatever signal it was going to receive
+//------------------------------------------------------------------------------
+void DebuggerCore::handle_child_event(edb::pid_t child, int status) {
 
-			newThread->status_ = thread_status;
+	if(WIFEXITED(status) || WIFSIGNALED(status)) {
+		forked_children_.remove(child);
+		return;
+	}
 
-			// copy the hardware debug registers from the current thread to the new thread
-			if(process_) {
-				if(auto thread = process_->current_thread()) {
-					for(int i = 0; i < 8; ++i) {
-						auto new_thread = std::static_pointer_cast<PlatformThread>(newThread);
-						auto old_thread = std::static_pointer_cast<PlatformThread>(thread);
-						new_thread->set_debug_register(i, old_thread->get_debug_register(i));
-					}
-				}
-			}
+	if(!WIFSTOPPED(status)) {
+		return;
+	}
 
-			// TODO(eteran): what the heck do we do if this isn't a SIGSTOP?
-			newThread->resume();
+	// a vfork child has a memory of its own now, which can't have any of our
+	// breakpoints in it
+	if(is_exec_event(status)) {
+		if(forked_children_.value(child)) {
+			apply_fork_behavior(child);
+			return;
 		}
 
-		ptrace_continue(tid, 0);
-		return nullptr;
+		ptrace(PTRACE_CONT, child, 0, 0);
+		return;
 	}
 
-	// normal event
-	auto e = std::make_shared<PlatformEvent>();
-
-	e->pid_    = pid();
-	e->tid_    = tid;
-	e->status_ = status;
-	if(!ptrace_getsiginfo(tid, &e->siginfo_)) {
-		// TODO: handle no info?
+	// ptrace's own stops have no signal to pass on
+	const int signal = (status >> 16) ? 0 : WSTOPSIG(status);
+	if(signal == SIGTRAP && forked_children_.value(child)) {
+		qWarning("handle_event(): vfork child [%d] ran into a breakpoint before calling exec", static_cast<int>(child));
 	}
 
-	active_thread_ = tid;
-
-	auto it = threads_.find(tid);
-	if(it != threads_.end()) {
-		it.value()->status_ = status;
-	}
+	ptrace(PTRACE_CONT, child, 0, signal);
+}
 
-	stop_threads();
+//------------------------------------------------------------------------------
+// Name: patched_bytes
+// Desc: the original bytes of everything we patched into the debuggee, the
+//       enabled breakpoints and the coverage points, by address
+//------------------------------------------------------------------------------
+QMap<edb::address_t, quint8> DebuggerCore::patched_bytes() const {
 
-	// Some breakpoint types result in SIGILL or SIGSEGV. We'll transform the
-	// event into breakpoint event if such a breakpoint has triggered.
-	if(it != threads_.end() && WIFSTOPPED(status)) {
-		const auto signo=WSTOPSIG(status);
-		if(signo==SIGILL || signo==SIGSEGV) {
-			// no need to peekuser for SIGILL, but have to for SIGSEGV
-			const auto address = signo==SIGILL ? edb::address_t::fromZeroExtended(e->siginfo_.si_addr)
-											   : (*it)->instruction_pointer();
-			if(edb::v1::find_triggered_breakpoint(address))
-			{
-				e->status_=SIGTRAP<<8|0x7f;
-				e->siginfo_.si_signo=SIGTRAP;
-				e->siginfo_.si_code=TRAP_BRKPT;
+	QMap<edb::address_t, quint8> patched;
+	for(const std::shared_ptr<IBreakpoint> &bp : breakpoints_) {
+		if(bp->enabled()) {
+			const quint8 *const original = bp->original_bytes();
+			for(std::size_t i = 0; i < bp->size(); ++i) {
+				patched.insert(bp->address() + i, original[i]);
 			}
 		}
 	}
 
-#if defined EDB_ARM32
-	if(it != threads_.end()) {
-		const auto& thread=*it;
-		if(thread->singleStepBreakpoint) {
+	for(auto it = coverage_points_.begin(); it != coverage_points_.end(); ++it) {
+		patched.insert(it.key(), it.value());
+	}
+
+	return patched;
+}
+
+//------------------------------------------------------------------------------
+// Name: strip_inherited_breakpoints
+// Desc: a forked child has a copy of every byte we patched, they all go back
+//       to the original ones in a single pass over its memory, coalesced
+//       into one write for each run of neighbouring bytes
+//------------------------------------------------------------------------------
+void DebuggerCore::strip_inherited_breakpoints(edb::pid_t child) {
+
+	const QMap<edb::address_t, quint8> patched = patched_bytes();
+	if(patched.isEmpty()) {
+		return;
+	}
+
+	// /proc/<pid>/mem, unlike process_vm_writev, can write to code
+	const int fd = ::open(qPrintable(QString("/proc/%1/mem").arg(child)), O_RDWR);
+
+	auto it = patched.begin();
+	while(it != patched.end()) {
+		const edb::address_t address = it.key();
+
+		QByteArray run;
+		while(it != patched.end() && it.key() == address + run.size()) {
+			run.append(static_cast<char>(it.value()));
+			++it;
+		}
+
+		if(fd != -1 && !proc_mem_write_broken_ && pwrite(fd, run.constData(), run.size(), address) == run.size()) {
+			continue;
+		}
+
+		// word by word, keeping the bytes around the run
+		for(int i = 0; i < run.size(); ++i) {
+			const edb::address_t byte_address = address + i;
+			const edb::address_t word_address = byte_address & ~edb::address_t(sizeof(long) - 1);
+
+			errno = 0;
+			long word = ptrace(PTRACE_PEEKDATA, child, word_address.toUint(), 0);
+			if(errno != 0) {
+				continue;
+			}
+
+			reinterpret_cast<char *>(&word)[byte_address - word_address] = run[i];
+			ptrace(PTRACE_POKEDATA, child, word_address.toUint(), word);
+		}
+	}
+
+	if(fd != -1) {
+		::close(fd);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: release_forked_children
+// Desc: detaches from the children still traced, they run on by themselves.
+//       They have to be stopped to be detached from
+//------------------------------------------------------------------------------
+void DebuggerCore::release_forked_children() {
+
+	for(auto it = forked_children_.begin(); it != forked_children_.end(); ++it) {
+		const edb::pid_t child = it.key();
+
+		if(::kill(child, SIGSTOP) == -1) {
+			continue;
+		}
+
+		int status;
+		while(native::waitpid(child, &status, __WALL) > 0) {
+			if(WIFEXITED(status) || WIFSIGNALED(status)) {
+				break;
+			}
+
+			if(WIFSTOPPED(status) && WSTOPSIG(status) == SIGSTOP) {
+				ptrace(PTRACE_DETACH, child, 0, 0);
+				::kill(child, SIGCONT);
+				break;
+			}
+
+			// anything else which was on its way is passed on
+			ptrace(PTRACE_CONT, child, 0, (status >> 16) ? 0 : WSTOPSIG(status));
+		}
+	}
+
+	forked_children_.clear();
+}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+//------------------------------------------------------------------------------
+// Name: fork_checkpoint
+// Desc: has the current thread fork, the child is left in its first stop and
+//       fixed up only when it is restored. Until then it still has the
+//       injected syscall instruction and its registers, along with whatever
+//       breakpoints were enabled at the time
+//------------------------------------------------------------------------------
+Status DebuggerCore::fork_checkpoint(CheckpointProcess *checkpoint) {
+
+	Q_ASSERT(checkpoint);
+
+	const edb::tid_t tid = active_thread_;
+
+	auto it = threads_.find(tid);
+	if(it == threads_.end() || !waited_threads_.contains(tid)) {
+		return Status(tr("The current thread is not stopped"));
+	}
+
+	it.value()->get_state(&checkpoint->state);
+
+	// the same bytes inject_syscall is going to borrow
+	quint8 code[2];
+	checkpoint->code_address = syscall_address();
+	if(process_->read_bytes(checkpoint->code_address, code, sizeof(code)) != sizeof(code)) {
+		return Status(tr("Unable to read the code the fork is run from"));
+	}
+
+	checkpoint->code    = QByteArray(reinterpret_cast<const char *>(code), sizeof(code));
+	checkpoint->patched = patched_bytes();
+
+	edb::pid_t child = 0;
+
+	// the fork is reported to us, not to handle_fork, since this child stays
+	// stopped rather than going the way of Configuration::fork_behavior
+	auto on_event = [this, tid, &child, checkpoint](int status) {
+		if(!is_fork_event(status)) {
+			return false;
+		}
+
+		unsigned long message;
+		if(ptrace_get_event_message(tid, &message)) {
+			const auto pid = static_cast<edb::pid_t>(message);
+			if(native::waitpid(pid, &checkpoint->status, __WALL) > 0 && WIFSTOPPED(checkpoint->status)) {
+				child = pid;
+			}
+		}
+		return true;
+	};
+
+	const long fork_number = edb::v1::debuggeeIs32Bit() ? 2 : 57;
+
+	const Result<edb::reg_t> result = inject_syscall(tid, fork_number, QVector<edb::reg_t>(), on_event);
+	if(child == 0) {
+		return Status(result ? tr("The debuggee did not fork") : result.errorMessage());
+	}
+
+	checkpoint->info.pid     = child;
+	checkpoint->info.address = checkpoint->state.instruction_pointer();
+	checkpoint->info.created = QDateTime::currentDateTime();
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: create_checkpoint
+// Desc:
+//------------------------------------------------------------------------------
+Result<int> DebuggerCore::create_checkpoint() {
+
+	if(!process_ || core_process_ || remote_process_) {
+		return Result<int>(tr("Checkpoints need a local process which is running"), 0);
+	}
+
+	CheckpointProcess checkpoint;
+	const Status status = fork_checkpoint(&checkpoint);
+	if(!status) {
+		return Result<int>(status.toString(), 0);
+	}
+
+	checkpoint.info.id = next_checkpoint_id_++;
+	checkpoints_.insert(checkpoint.info.id, checkpoint);
+
+	qDebug() << "[DebuggerCore] checkpoint" << checkpoint.info.id << "is process" << checkpoint.info.pid;
+	return Result<int>(checkpoint.info.id);
+}
+
+//------------------------------------------------------------------------------
+// Name: restore_checkpoint
+// Desc: the debuggee is killed and the checkpoint's process debugged in its
+//       place, with a fork of its own taken first, so the checkpoint can be
+//       restored again
+//------------------------------------------------------------------------------
+Status DebuggerCore::restore_checkpoint(int id) {
+
+	auto it = checkpoints_.find(id);
+	if(it == checkpoints_.end()) {
+		return Status(tr("There is no checkpoint %1").arg(id));
+	}
+
+	if(!process_ || core_process_ || remote_process_) {
+		return Status(tr("Checkpoints need a local process which is running"));
+	}
+
+	const CheckpointProcess checkpoint = it.value();
+	checkpoints_.erase(it);
+
+	const edb::pid_t snapshot = checkpoint.info.pid;
+
+	release_forked_children();
+	reap_process(pid_, threads_.keys());
+
+	threads_.clear();
+	thread_list_valid_ = false;
+	waited_threads_.clear();
+	pending_events_.clear();
+	coverage_points_.clear();
+	coverage_hits_.clear();
+	branch_trace_ = nullptr;
+	profiler_     = nullptr;
+	invalidate_memory_caches();
+	soft_dirty_valid_   = false;
+	soft_dirty_cleared_ = false;
+
+	delete process_;
+	process_ = new PlatformProcess(this, snapshot);
+
+	// fork copies only the thread which called it
+	auto thread            = std::make_shared<PlatformThread>(this, process_, snapshot);
+	thread->status_        = checkpoint.status;
+	thread->signal_status_ = PlatformThread::Stopped;
+
+	threads_.insert(snapshot, thread);
+	thread_list_valid_ = false;
+	waited_threads_.insert(snapshot);
+	pid_           = snapshot;
+	active_thread_ = snapshot;
+
+	// undo the fork, it is still right after the syscall instruction
+	thread->set_state(checkpoint.state);
+	process_->write_bytes(checkpoint.code_address, checkpoint.code.constData(), checkpoint.code.size());
+
+	// it has the breakpoints which were enabled back then, the ones set
+	// since are written to it and the ones gone since taken out
+	QMap<edb::address_t, quint8> stale = checkpoint.patched;
+	for(const std::shared_ptr<IBreakpoint> &bp : breakpoints_) {
+		if(!bp->enabled()) {
+			continue;
+		}
+
+		bool inherited = true;
+		for(std::size_t i = 0; i < bp->size(); ++i) {
+			inherited = stale.remove(bp->address() + i) && inherited;
+		}
+
+		if(!inherited) {
+			bp->disable();
+			bp->enable();
+		}
+	}
+
+	for(auto stale_it = stale.constBegin(); stale_it != stale.constEnd(); ++stale_it) {
+		const quint8 original = stale_it.value();
+		process_->write_bytes(stale_it.key(), &original, 1);
+	}
+
+	CheckpointProcess next;
+	const Status status = fork_checkpoint(&next);
+	if(status) {
+		next.info.id      = id;
+		next.info.address = checkpoint.info.address;
+		next.info.created = checkpoint.info.created;
+		checkpoints_.insert(id, next);
+	} else {
+		qWarning() << "Unable to keep checkpoint" << id << "after restoring it:" << status.toString();
+	}
+
+	qDebug() << "[DebuggerCore] restored checkpoint" << id << "as process" << snapshot;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: discard_checkpoint
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::discard_checkpoint(int id) {
+	auto it = checkpoints_.find(id);
+	if(it != checkpoints_.end()) {
+		reap_process(it->info.pid, QList<edb::tid_t>());
+		checkpoints_.erase(it);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: checkpoints
+// Desc:
+//------------------------------------------------------------------------------
+QVector<Checkpoint> DebuggerCore::checkpoints() const {
+	QVector<Checkpoint> list;
+	list.reserve(checkpoints_.size());
+	for(const CheckpointProcess &checkpoint : checkpoints_) {
+		list.push_back(checkpoint.info);
+	}
+	return list;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_checkpoint
+// Desc: the checkpoint's process is stopped for good, so its memory is read
+//       straight from /proc/<pid>/mem. What the fork and our breakpoints left
+//       in it is put back the way the debuggee had it
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::read_checkpoint(int id, edb::address_t address, void *buf, std::size_t len) const {
+
+	auto it = checkpoints_.find(id);
+	if(it == checkpoints_.end() || len == 0) {
+		return 0;
+	}
+
+	const int fd = ::open(qPrintable(QString("/proc/%1/mem").arg(it->info.pid)), O_RDONLY);
+	if(fd == -1) {
+		return 0;
+	}
+
+	const ssize_t n = pread(fd, buf, len, address);
+	::close(fd);
+
+	if(n <= 0) {
+		return 0;
+	}
+
+	const edb::address_t end = address + n;
+	auto bytes = static_cast<quint8 *>(buf);
+
+	for(int i = 0; i < it->code.size(); ++i) {
+		const edb::address_t code_address = it->code_address + i;
+		if(code_address >= address && code_address < end) {
+			bytes[code_address - address] = static_cast<quint8>(it->code[i]);
+		}
+	}
+
+	for(auto patched = it->patched.lowerBound(address); patched != it->patched.end() && patched.key() < end; ++patched) {
+		bytes[patched.key() - address] = patched.value();
+	}
+
+	return n;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Name: discard_checkpoints
+// Desc: the checkpoints go with the debuggee they were taken of
+//------------------------------------------------------------------------------
+void DebuggerCore::discard_checkpoints() {
+	for(const CheckpointProcess &checkpoint : checkpoints_) {
+		reap_process(checkpoint.info.pid, QList<edb::tid_t>());
+	}
+	checkpoints_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<IDebugEvent> DebuggerCore::handle_event(edb::tid_t tid, int status) {
+
+	EDB_TRACE_SCOPE("DebuggerCore::handle_event");
+
+	// the children we keep running in the background never get reported
+	if(forked_children_.contains(tid)) {
+		handle_child_event(tid, status);
+		return nullptr;
+	}
+
+	// note that we have waited on this thread
+	waited_threads_.insert(tid);
+
+	// the next resume starts a new soft-dirty interval
+	soft_dirty_cleared_ = false;
+
+	// was it a thread exit event?
+	if(WIFEXITED(status)) {
+
+		handle_thread_exit(tid,status);
+		// if this was the last thread, return true
+		// so we report it to the user.
+		// if this wasn't, then we should silently
+		// procceed.
+		if(!threads_.empty()) {
+			return nullptr;
+		}
+	}
+
+    if(is_exit_trace_event(status)) {
+
+    }
+
+	// an interrupt from attaching which arrived after the thread had already
+	// stopped for something else, nobody is waiting for it
+	if(is_interrupt_stop(status)) {
+		ptrace_continue(tid, 0);
+		return nullptr;
+	}
+
+	if(is_fork_event(status) || is_vfork_event(status)) {
+		handle_fork(tid, status);
+		ptrace_continue(tid, 0);
+		return nullptr;
+	}
+
+	// was it a thread create event?
+	if(is_clone_event(status)) {
+
+		unsigned long new_tid;
+		if(ptrace_get_event_message(tid, &new_tid)) {
+
+			auto newThread            = std::make_shared<PlatformThread>(this, process_, new_tid);
+			newThread->status_        = 0;
+			newThread->signal_status_ = PlatformThread::Stopped;
+
+			threads_.insert(new_tid, newThread);
+			thread_list_valid_ = false;
+
+			if(branch_trace_) {
+				const Status traceStatus = branch_trace_->add_thread(new_tid);
+				if(!traceStatus) {
+					qWarning("handle_event(): failed to trace the branches of thread [%d]: %s", static_cast<int>(new_tid), qPrintable(traceStatus.toString()));
+				}
+			}
+
+			if(profiler_) {
+				const Status profileStatus = profiler_->add_thread(new_tid);
+				if(!profileStatus) {
+					qWarning("handle_event(): failed to profile thread [%d]: %s", static_cast<int>(new_tid), qPrintable(profileStatus.toString()));
+				}
+			}
+
+			int thread_status = 0;
+			if(!waited_threads_.contains(new_tid)) {
+				if(native::waitpid(new_tid, &thread_status, __WALL) > 0) {
+					waited_threads_.insert(new_tid);
+				}
+			}
+
+			// A new thread could exit before we have fully created it, no event then since it can't be the last thread
+			if(WIFEXITED(thread_status)) {
+				handle_thread_exit(tid,thread_status);
+				return nullptr;
+			}
+
+			if(!WIFSTOPPED(thread_status) || (WSTOPSIG(thread_status) != SIGSTOP && !is_interrupt_stop(thread_status))) {
+				qWarning("handle_event(): new thread [%d] received an event besides SIGSTOP: status=0x%x", static_cast<int>(new_tid),thread_status);
+			}
+
+			newThread->status_ = thread_status;
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+			// copy the hardware debug registers from the current thread to the new thread
+			if(process_) {
+				if(auto thread = process_->current_thread()) {
+					newThread->set_debug_registers(thread->get_debug_registers());
+				}
+			}
+#endif
+
+			// TODO(eteran): what the heck do we do if this isn't a SIGSTOP?
+			newThread->resume();
+		}
+
+		ptrace_continue(tid, 0);
+		return nullptr;
+	}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	// coverage points never get as far as the UI, which is what makes having
+	// one on every basic block affordable
+	if(take_coverage_point(tid, status)) {
+		ptrace_continue(tid, 0);
+		return nullptr;
+	}
+#endif
+
+	// system call stops, which we turn into plain traps for the UI
+	int syscall_number = -1;
+	bool syscall_exit  = false;
+	if(is_syscall_stop(status) || is_seccomp_event(status)) {
+		if(!syscall_stop(tid, status, &syscall_number, &syscall_exit)) {
+			// not one we are interested in
+			ptrace_continue(tid, 0);
+			return nullptr;
+		}
+
+		status = SIGTRAP << 8 | 0x7f;
+	}
+
+	// signals the user doesn't stop for go straight back to the thread, no
+	// event, no state and no trip through the UI
+	if(WIFSTOPPED(status) && pass_signal(tid, WSTOPSIG(status))) {
+		return nullptr;
+	}
+
+	// normal event
+	auto e = std::make_shared<PlatformEvent>();
+
+	e->pid_    = pid();
+	e->tid_    = tid;
+	e->status_ = status;
+	if(!ptrace_getsiginfo(tid, &e->siginfo_)) {
+		// TODO: handle no info?
+	}
+
+	e->syscall_      = syscall_number;
+	e->syscall_exit_ = syscall_exit;
+
+	active_thread_ = tid;
+
+	auto it = threads_.find(tid);
+	if(it != threads_.end()) {
+		it.value()->status_ = status;
+	}
+
+	// in non-stop mode the other threads keep running
+	if(!edb::v1::config().non_stop_mode) {
+		stop_threads();
+	}
+
+	// Some breakpoint types result in SIGILL or SIGSEGV. We'll transform the
+	// event into breakpoint event if such a breakpoint has triggered.
+	if(it != threads_.end() && WIFSTOPPED(status)) {
+		const auto signo=WSTOPSIG(status);
+		if(signo==SIGILL || signo==SIGSEGV) {
+			// no need to peekuser for SIGILL, but have to for SIGSEGV
+			const auto address = signo==SIGILL ? edb::address_t::fromZeroExtended(e->siginfo_.si_addr)
+											   : (*it)->instruction_pointer();
+			if(edb::v1::find_triggered_breakpoint(address))
+			{
+				e->status_=SIGTRAP<<8|0x7f;
+				e->siginfo_.si_signo=SIGTRAP;
+				e->siginfo_.si_code=TRAP_BRKPT;
+			}
+		}
+	}
+
+#if defined EDB_ARM32
+	if(it != threads_.end()) {
+		const auto& thread=*it;
+		if(thread->singleStepBreakpoint) {
 
 			remove_breakpoint(thread->singleStepBreakpoint->address());
 			thread->singleStepBreakpoint=nullptr;
 
-			assert(e->siginfo_.si_signo==SIGTRAP); // signo must have already be converted to SIGTRAP if needed
-			e->siginfo_.si_code=TRAP_TRACE;
-		}
+			assert(e->siginfo_.si_signo==SIGTRAP); // signo must have already be converted to SIGTRAP if needed
+			e->siginfo_.si_code=TRAP_TRACE;
+		}
+	}
+#endif
+	return e;
+}
+
+//------------------------------------------------------------------------------
+// Name: pass_signal
+// Desc: delivers <signo> to the stopped thread <tid> and lets it carry on if
+//       the policy for it is to pass it, returns false if it has to be
+//       reported instead. What is left to the UI either way: the signals we
+//       use ourselves, the ones which would stop the whole process, anything
+//       a thread gets while being stepped and breakpoints which fault
+//------------------------------------------------------------------------------
+bool DebuggerCore::pass_signal(edb::tid_t tid, int signo) {
+
+	switch(signo) {
+	case SIGTRAP:
+	case SIGSTOP:
+	case SIGTSTP:
+	case SIGTTIN:
+	case SIGTTOU:
+		return false;
+	default:
+		break;
+	}
+
+	if(stepping_threads_.contains(tid)) {
+		return false;
+	}
+
+	const edb::SIGNAL_POLICY policy = edb::v1::signal_policy(signo);
+	if(policy == edb::SIGNAL_STOP) {
+		return false;
+	}
+
+	// see handle_event, these are looked at only when they'd be passed
+	if(signo == SIGILL || signo == SIGSEGV) {
+		auto it = threads_.find(tid);
+		if(it == threads_.end()) {
+			return false;
+		}
+
+		edb::address_t address = 0;
+		if(signo == SIGILL) {
+			siginfo_t siginfo;
+			if(!ptrace_getsiginfo(tid, &siginfo)) {
+				return false;
+			}
+			address = edb::address_t::fromZeroExtended(siginfo.si_addr);
+		} else {
+			address = (*it)->instruction_pointer();
+		}
+
+		if(edb::v1::find_triggered_breakpoint(address)) {
+			return false;
+		}
+	}
+
+	if(policy == edb::SIGNAL_LOG) {
+		qDebug() << "[edb] passed" << exceptionName(signo) << "to thread" << tid;
+	}
+
+	return ptrace_continue(tid, signo).success();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_threads
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::stop_threads() {
+
+	EDB_TRACE_SEGMENT("DebuggerCore::stop_threads", ThreadStop);
+
+	QString errorMessage;
+
+	if(process_) {
+		QElapsedTimer timer;
+		timer.start();
+
+		// signal every thread first and only then wait for them, so that they
+		// all stop in parallel rather than one scheduler round trip at a time
+		QSet<edb::tid_t> stopping;
+		for(auto it = threads_.begin(); it != threads_.end(); ++it) {
+			const edb::tid_t tid = it.key();
+
+			if(!waited_threads_.contains(tid)) {
+				const auto stopStatus=it.value()->stop();
+				if(!stopStatus) {
+					errorMessage+=QObject::tr("Failed to stop thread %1: %2\n").arg(tid).arg(stopStatus.toString());
+				} else {
+					stopping.insert(tid);
+				}
+			}
+		}
+
+		const int thread_count = stopping.size();
+
+		while(!stopping.isEmpty()) {
+
+			for(auto it = stopping.begin(); it != stopping.end(); ) {
+				const edb::tid_t tid = *it;
+
+				int thread_status;
+				if(native::waitpid(tid, &thread_status, __WALL | WNOHANG) <= 0) {
+					++it;
+					continue;
+				}
+
+				// a left over interrupt from attaching got there first, the
+				// SIGSTOP is still coming
+				if(is_interrupt_stop(thread_status)) {
+					ptrace_continue(tid, 0);
+					++it;
+					continue;
+				}
+
+				it = stopping.erase(it);
+				waited_threads_.insert(tid);
+
+				auto thread_it = threads_.find(tid);
+				if(thread_it != threads_.end()) {
+					thread_it.value()->status_ = thread_status;
+				}
+
+				// A thread could have exited between previous waitpid and the latest one...
+				if(WIFEXITED(thread_status)) {
+					handle_thread_exit(tid, thread_status);
+				}
+				// ..., or stopped for a reason of its own before our SIGSTOP
+				// arrived, keep that event so that it gets reported next
+				else if(WIFSTOPPED(thread_status) && WSTOPSIG(thread_status) != SIGSTOP) {
+					bool covered = false;
+#if defined(EDB_X86) || defined(EDB_X86_64)
+					// a coverage point isn't worth reporting, the thread is just
+					// left stopped on the instruction it covered
+					covered = take_coverage_point(tid, thread_status);
+					if(covered && thread_it != threads_.end()) {
+						thread_it.value()->status_ = SIGSTOP << 8 | 0x7f;
+					}
+#endif
+					if(!covered) {
+						pending_events_.enqueue(qMakePair(tid, thread_status));
+					}
+				}
+				// ..., otherwise it must have stopped.
+				else if(!WIFSTOPPED(thread_status)) {
+					qWarning("stop_threads(): paused thread [%d] received an event besides SIGSTOP: status=0x%x", tid,thread_status);
+				}
+			}
+
+			if(stopping.isEmpty()) {
+				break;
+			}
+
+			const qint64 remaining = stop_threads_timeout_ - timer.elapsed();
+			if(stop_threads_timeout_ != 0 && remaining <= 0) {
+				for(const edb::tid_t tid : stopping) {
+					errorMessage+=QObject::tr("Timed out waiting for thread %1 to stop\n").arg(tid);
+				}
+				break;
+			}
+
+			native::wait_for_sigchld(stop_threads_timeout_ == 0 ? 0 : static_cast<int>(remaining));
+		}
+
+		const qint64 elapsed = timer.elapsed();
+		if(elapsed >= SlowStopThreshold) {
+			qDebug() << "[DebuggerCore] stopping" << thread_count << "threads took" << elapsed << "ms";
+		}
+	}
+
+	if(errorMessage.isEmpty())
+		return Status::Ok;
+	qWarning() << errorMessage.toStdString().c_str();
+	return Status("\n"+errorMessage);
+}
+
+//------------------------------------------------------------------------------
+// Name: record_trace
+// Desc: single steps the active thread until one of the request's stop
+//       conditions is met. The other threads stay stopped, and nothing goes
+//       back through the event loop (or the GUI) between steps, which is what
+//       makes this orders of magnitude faster than stepping interactively
+//------------------------------------------------------------------------------
+Status DebuggerCore::record_trace(const TraceRequest &request, TraceResult *result) {
+
+	Q_ASSERT(result);
+
+	*result = TraceResult();
+
+	if(!process_) {
+		return Status(QObject::tr("Not attached to a process"));
+	}
+
+	const edb::tid_t tid = active_thread_;
+
+	auto it = threads_.find(tid);
+	if(it == threads_.end() || !waited_threads_.contains(tid)) {
+		return Status(QObject::tr("The current thread is not stopped"));
+	}
+
+	const std::shared_ptr<PlatformThread> thread = it.value();
+
+	if(request.block_step && !thread->supports_block_step()) {
+		return Status(QObject::tr("Block stepping is not supported on this platform"));
+	}
+
+	TraceWriter writer(request.filename, tid, pointer_size(), request.record_registers);
+	if(!writer.open()) {
+		return Status(QObject::tr("Unable to open %1: %2").arg(request.filename, writer.error_string()));
+	}
+
+	const bool range_filter = request.range_end != 0;
+	const bool step_filter  = !request.filter.empty() && !request.block_step;
+	State state;
+
+	Q_FOREVER {
+		thread->get_state(&state);
+		const edb::address_t ip = state.instruction_pointer();
+		const bool in_range = !range_filter || (ip >= request.range_start && ip < request.range_end);
+
+		if(!in_range && request.stop_outside_range) {
+			result->reason = TraceResult::LeftRange;
+			break;
+		}
+
+		// the first instruction may well be on a breakpoint, we started there
+		const std::shared_ptr<IBreakpoint> bp = find_breakpoint(ip);
+		if(bp && bp->enabled() && !bp->internal() && request.stop_at_breakpoints && result->steps != 0) {
+			result->reason = TraceResult::Breakpoint;
+			break;
+		}
+
+		if(request.stop_condition && request.stop_condition(state)) {
+			result->reason = TraceResult::Condition;
+			break;
+		}
+
+		if(request.max_steps != 0 && result->steps == request.max_steps) {
+			result->reason = TraceResult::StepLimit;
+			break;
+		}
+
+		if(in_range) {
+			if(!writer.write_step(state)) {
+				result->reason = TraceResult::Error;
+				result->bytes  = writer.bytes();
+				return Status(QObject::tr("Unable to write to %1: %2").arg(request.filename, writer.error_string()));
+			}
+			++result->recorded;
+		}
+
+		if(request.progress && (result->steps % TraceProgressInterval) == 0 && result->steps != 0) {
+			if(!request.progress(result->steps)) {
+				result->reason = TraceResult::Cancelled;
+				break;
+			}
+		}
+
+		edb::address_t return_address = 0;
+		if(step_filter) {
+			quint8 buffer[edb::Instruction::MAX_SIZE];
+			if(const int size = edb::v1::get_instruction_bytes(ip, buffer)) {
+				const edb::Instruction inst(buffer, buffer + size, ip);
+				if(is_call(inst)) {
+					return_address = ip + inst.byte_size();
+				}
+			}
+		}
+
+		const edb::address_t stack_pointer = state.stack_pointer();
+
+		bool trapped;
+		const Status step_status = step_in_place(thread, bp, request.block_step, &trapped);
+		if(!step_status) {
+			result->reason = TraceResult::Error;
+			result->bytes  = writer.bytes();
+			return step_status;
+		}
+
+		++result->steps;
+
+		// anything but a plain single step trap ends the trace
+		if(!trapped) {
+			result->reason = TraceResult::Event;
+			break;
+		}
+
+		// the call left the filter, nothing of it is recorded
+		if(return_address != 0 && !request.filter.contains(thread->instruction_pointer())) {
+			bool cancelled;
+			const Status run_status = run_to_return(thread, return_address, stack_pointer, request.progress, result->steps, &trapped, &cancelled);
+			if(!run_status) {
+				result->reason = TraceResult::Error;
+				result->bytes  = writer.bytes();
+				return run_status;
+			}
+
+			if(cancelled) {
+				result->reason = TraceResult::Cancelled;
+				break;
+			}
+
+			if(!trapped) {
+				result->reason = TraceResult::Event;
+				break;
+			}
+		}
+	}
+
+	if(!writer.close()) {
+		result->bytes = writer.bytes();
+		return Status(QObject::tr("Unable to write to %1: %2").arg(request.filename, writer.error_string()));
+	}
+
+	result->bytes = writer.bytes();
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: step_in_place
+// Desc: single steps <thread> (stepping over <bp>, if it is enabled) and waits
+//       for it, without involving the event loop. <trapped> is false when
+//       it stopped for anything but a plain single step trap (a signal, an
+//       exit, a ptrace event...), that stop is then reported by the next call
+//       to wait_debug_event just as if the user had stepped
+//------------------------------------------------------------------------------
+Status DebuggerCore::step_in_place(const std::shared_ptr<PlatformThread> &thread, const std::shared_ptr<IBreakpoint> &bp, bool block, bool *trapped) {
+
+	Q_ASSERT(trapped);
+
+	*trapped = false;
+
+	const edb::tid_t tid = thread->tid();
+
+	// step over our own breakpoint, rather than into it
+	const bool reenable = bp && bp->enabled();
+	if(reenable) {
+		bp->disable();
+	}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	const Status step_status = block ? ptrace_step_block(tid, 0) : ptrace_step(tid, 0);
+#else
+	Q_UNUSED(block);
+	const Status step_status = ptrace_step(tid, 0);
+#endif
+
+	int status = 0;
+	const bool waited = step_status && native::waitpid(tid, &status, __WALL) > 0;
+
+	if(reenable) {
+		bp->enable();
+	}
+
+	if(!step_status) {
+		return step_status;
+	}
+
+	if(!waited) {
+		return Status(QObject::tr("Unable to wait for thread %1: %2").arg(tid).arg(strerror(errno)));
+	}
+
+	waited_threads_.insert(tid);
+	thread->status_ = status;
+
+	if(!WIFSTOPPED(status) || WSTOPSIG(status) != SIGTRAP || (status >> 16) != 0) {
+		pending_events_.enqueue(qMakePair(tid, status));
+		return Status::Ok;
+	}
+
+	// a block step runs whole blocks, so it can execute one of our int3s
+	// rather than stepping over it, put the IP back on the breakpoint
+	siginfo_t siginfo;
+	if(block && ptrace_getsiginfo(tid, &siginfo) && siginfo.si_code == SI_KERNEL) {
+		State state;
+		thread->get_state(&state);
+		if(const std::shared_ptr<IBreakpoint> hit = find_triggered_breakpoint(state.instruction_pointer())) {
+			state.set_instruction_pointer(hit->address());
+			thread->set_state(state);
+		}
+	}
+
+	*trapped = true;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: run_to_return
+// Desc: lets <thread>, which has just stepped into a call, run at full speed
+//       until it gets back to <return_address> in the frame it was called
+//       from (<stack_pointer> being the stack pointer before the call).
+//       <trapped> is false when it stopped for anything else, that stop is
+//       then reported by wait_debug_event. <progress> is polled while it
+//       runs, and the thread is stopped again should it return false
+//------------------------------------------------------------------------------
+Status DebuggerCore::run_to_return(const std::shared_ptr<PlatformThread> &thread, edb::address_t return_address, edb::address_t stack_pointer, const std::function<bool(quint64)> &progress, quint64 steps, bool *trapped, bool *cancelled) {
+
+	Q_ASSERT(trapped);
+	Q_ASSERT(cancelled);
+
+	*trapped   = false;
+	*cancelled = false;
+
+	const edb::tid_t tid = thread->tid();
+
+	// a breakpoint of the user's at the return address will do just as well
+	std::shared_ptr<IBreakpoint> bp = find_breakpoint(return_address);
+	const bool own_breakpoint = !bp;
+	if(own_breakpoint) {
+		bp = add_breakpoint(return_address);
+		if(!bp) {
+			return Status(QObject::tr("Unable to set a breakpoint at %1").arg(return_address.toPointerString()));
+		}
+		bp->set_internal(true);
+	}
+
+	Status status = Status::Ok;
+
+	Q_FOREVER {
+		status = ptrace_continue(tid, 0);
+		if(!status) {
+			break;
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+
+		bool stopping = false;
+		int  wait_status = 0;
+
+		Q_FOREVER {
+			const pid_t ret = native::waitpid(tid, &wait_status, __WALL | WNOHANG);
+			if(ret > 0) {
+				break;
+			}
+
+			if(ret < 0) {
+				status = Status(QObject::tr("Unable to wait for thread %1: %2").arg(tid).arg(strerror(errno)));
+				break;
+			}
+
+			native::wait_for_sigchld(RunProgressInterval);
+
+			if(!stopping && progress && timer.elapsed() >= RunProgressInterval) {
+				timer.restart();
+				if(!progress(steps)) {
+					stopping = static_cast<bool>(thread->stop());
+				}
+			}
+		}
+
+		if(!status) {
+			break;
+		}
+
+		waited_threads_.insert(tid);
+		thread->status_ = wait_status;
+
+		if(stopping && WIFSTOPPED(wait_status) && WSTOPSIG(wait_status) == SIGSTOP) {
+			*cancelled = true;
+			break;
+		}
+
+		if(!WIFSTOPPED(wait_status) || WSTOPSIG(wait_status) != SIGTRAP || (wait_status >> 16) != 0) {
+			pending_events_.enqueue(qMakePair(tid, wait_status));
+			break;
+		}
+
+		State state;
+		thread->get_state(&state);
+
+		// some other breakpoint, it is the user's to see
+		if(find_triggered_breakpoint(state.instruction_pointer()) != bp) {
+			pending_events_.enqueue(qMakePair(tid, wait_status));
+			break;
+		}
+
+		state.set_instruction_pointer(return_address);
+		thread->set_state(state);
+
+		if(state.stack_pointer() >= stack_pointer) {
+			*trapped = true;
+			break;
+		}
+
+		// a deeper, recursive call returned to the same place, carry on
+		status = step_in_place(thread, bp, false, trapped);
+		if(!status || !*trapped) {
+			*trapped = false;
+			break;
+		}
+		*trapped = false;
+	}
+
+	if(own_breakpoint) {
+		remove_breakpoint(return_address);
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+// Name: step_until
+// Desc: single steps the active thread until the condition is met, the way
+//       record_trace does, so "step until" and "trace over" cost a ptrace
+//       round trip per instruction rather than a trip through the GUI. The
+//       call depth is only worked out when something needs it
+//------------------------------------------------------------------------------
+Status DebuggerCore::step_until(const StepCondition &condition, StepResult *result) {
+
+	Q_ASSERT(result);
+
+	*result = StepResult();
+
+	if(!process_) {
+		return Status(QObject::tr("Not attached to a process"));
+	}
+
+	const edb::tid_t tid = active_thread_;
+
+	auto it = threads_.find(tid);
+	if(it == threads_.end() || !waited_threads_.contains(tid)) {
+		return Status(QObject::tr("The current thread is not stopped"));
+	}
+
+	const std::shared_ptr<PlatformThread> thread = it.value();
+
+	const bool range_filter = condition.range_end != 0;
+	const bool track_calls  = condition.depth_limit || condition.over_calls || !condition.filter.empty();
+	State state;
+
+	Q_FOREVER {
+		thread->get_state(&state);
+		const edb::address_t ip = state.instruction_pointer();
+
+		// the first instruction may well be on a breakpoint, we started there
+		const std::shared_ptr<IBreakpoint> bp = find_breakpoint(ip);
+		if(bp && bp->enabled() && !bp->internal() && condition.stop_at_breakpoints && result->steps != 0) {
+			result->reason = StepResult::Breakpoint;
+			break;
+		}
+
+		if(condition.depth_limit && result->depth == condition.depth_target && result->steps != 0) {
+			result->reason = StepResult::Depth;
+			break;
+		}
+
+		if(!condition.over_calls || result->depth <= 0) {
+			if(range_filter && (ip < condition.range_start || ip >= condition.range_end)) {
+				result->reason = StepResult::LeftRange;
+				break;
+			}
+
+			if(condition.condition && condition.condition(state)) {
+				result->reason = StepResult::Condition;
+				break;
+			}
+		}
+
+		if(condition.max_steps != 0 && result->steps == condition.max_steps) {
+			result->reason = StepResult::StepLimit;
+			break;
+		}
+
+		if(condition.progress && (result->steps % TraceProgressInterval) == 0 && result->steps != 0) {
+			if(!condition.progress(result->steps)) {
+				result->reason = StepResult::Cancelled;
+				break;
+			}
+		}
+
+		int depth_change = 0;
+		edb::address_t return_address = 0;
+		if(track_calls) {
+			quint8 buffer[edb::Instruction::MAX_SIZE];
+			if(const int size = edb::v1::get_instruction_bytes(ip, buffer)) {
+				const edb::Instruction inst(buffer, buffer + size, ip);
+				if(is_call(inst)) {
+					depth_change   = 1;
+					return_address = ip + inst.byte_size();
+				} else if(is_return(inst)) {
+					depth_change = -1;
+				}
+			}
+		}
+
+		const edb::address_t stack_pointer = state.stack_pointer();
+
+		bool trapped;
+		const Status step_status = step_in_place(thread, bp, false, &trapped);
+		if(!step_status) {
+			result->reason = StepResult::Error;
+			return step_status;
+		}
+
+		++result->steps;
+
+		if(!trapped) {
+			result->depth += depth_change;
+			result->reason = StepResult::Event;
+			break;
+		}
+
+		if(return_address != 0 && (condition.over_calls || !condition.filter.contains(thread->instruction_pointer()))) {
+			bool cancelled;
+			const Status run_status = run_to_return(thread, return_address, stack_pointer, condition.progress, result->steps, &trapped, &cancelled);
+			if(!run_status) {
+				result->reason = StepResult::Error;
+				return run_status;
+			}
+
+			if(cancelled) {
+				result->reason = StepResult::Cancelled;
+				break;
+			}
+
+			if(!trapped) {
+				result->depth += depth_change;
+				result->reason = StepResult::Event;
+				break;
+			}
+
+			// back where it was called from
+			depth_change = 0;
+		}
+
+		result->depth += depth_change;
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_syscall_catchpoints
+// Desc: takes effect the next time the threads are resumed, a seccomp filter
+//       for the list is only installed when launching
+//------------------------------------------------------------------------------
+Status DebuggerCore::set_syscall_catchpoints(bool enabled, const QSet<int> &syscalls) {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	syscall_catch_enabled_ = enabled;
+	syscall_catch_         = syscalls;
+	return Status::Ok;
+#else
+	Q_UNUSED(enabled);
+	Q_UNUSED(syscalls);
+	return Status(tr("Breaking on system calls is not supported on this architecture"));
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: want_syscall_stops
+// Desc: PTRACE_SYSCALL is only needed when our seccomp filter doesn't
+//       already stop at every system call the user asked for, or when all
+//       of them are being counted
+//------------------------------------------------------------------------------
+bool DebuggerCore::want_syscall_stops() const {
+	if(syscall_stats_enabled_) {
+		return true;
+	}
+
+	if(!syscall_catch_enabled_) {
+		return false;
+	}
+
+	return syscall_catch_.isEmpty() || !seccomp_syscalls_.contains(syscall_catch_);
+}
+
+//------------------------------------------------------------------------------
+// Name: reset_syscall_state
+// Desc: resuming with anything but PTRACE_SYSCALL skips the exit stop of the
+//       system call the thread is in, if any
+//------------------------------------------------------------------------------
+void DebuggerCore::reset_syscall_state(edb::tid_t tid) {
+	auto it = threads_.find(tid);
+	if(it != threads_.end()) {
+		it.value()->syscall_entered_ = false;
+		it.value()->syscall_number_  = -1;
+		it.value()->syscall_started_ = 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: syscall_stop
+// Desc: works out which system call <tid> stopped at, returns false if it
+//       shouldn't be reported
+//------------------------------------------------------------------------------
+bool DebuggerCore::syscall_stop(edb::tid_t tid, int status, int *number, bool *exit) {
+
+	Q_ASSERT(number);
+	Q_ASSERT(exit);
+
+	if(is_seccomp_event(status)) {
+		// the entry stop which follows reports it when PTRACE_SYSCALL is in
+		// use too
+		if(want_syscall_stops()) {
+			return false;
+		}
+
+		// our filter passes the number as the event message, the kernel
+		// hasn't entered the system call yet
+		unsigned long message;
+		if(!ptrace_get_event_message(tid, &message)) {
+			return false;
+		}
+
+		*number = static_cast<int>(message);
+		*exit   = false;
+	} else {
+		auto it = threads_.find(tid);
+		if(it != threads_.end()) {
+			// entry and exit stops alternate
+			*exit = it.value()->syscall_entered_;
+			it.value()->syscall_entered_ = !*exit;
+		}
+
+#if defined(EDB_X86_64)
+		const long offset = offsetof(struct user_regs_struct, orig_rax);
+#elif defined(EDB_X86)
+		const long offset = offsetof(struct user_regs_struct, orig_eax);
+#endif
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		errno = 0;
+		const long value = ptrace(PTRACE_PEEKUSER, tid, offset, 0);
+		if(errno != 0) {
+			return false;
+		}
+
+		*number = static_cast<int>(value);
+
+		if(syscall_stats_enabled_ && it != threads_.end()) {
+			count_syscall(tid, it.value().get(), *number, *exit);
+		}
+#else
+		return false;
+#endif
+	}
+
+	return syscall_catch_enabled_ && (syscall_catch_.isEmpty() || syscall_catch_.contains(*number));
+}
+
+//------------------------------------------------------------------------------
+// Name: count_syscall
+// Desc: notes when <tid> entered system call <number>, or counts it when it
+//       returns. This is done here, instead of for events the UI gets, so
+//       the statistics cost no more than the system call stops themselves
+//------------------------------------------------------------------------------
+void DebuggerCore::count_syscall(edb::tid_t tid, PlatformThread *thread, int number, bool exit) {
+
+	Q_ASSERT(thread);
+
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	const quint64 nanoseconds = static_cast<quint64>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+	if(!exit) {
+		thread->syscall_number_  = number;
+		thread->syscall_started_ = nanoseconds;
+		return;
+	}
+
+#if defined(EDB_X86_64)
+	const long offset = offsetof(struct user_regs_struct, rax);
+#elif defined(EDB_X86)
+	const long offset = offsetof(struct user_regs_struct, eax);
+#endif
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	errno = 0;
+	long result = ptrace(PTRACE_PEEKUSER, tid, offset, 0);
+	const bool have_result = (errno == 0);
+	if(pointer_size_ == 4) {
+		result = static_cast<qint32>(result);
+	}
+
+	SyscallCounts &counts = syscall_stats_.threads[tid][number];
+	++counts.calls;
+
+	if(have_result && result < 0 && result >= -4095) {
+		++counts.errors;
+		++counts.errnos[static_cast<int>(-result)];
+	}
+
+	// one which was entered before counting started has no start time
+	if(thread->syscall_number_ == number && thread->syscall_started_ != 0) {
+		counts.nanoseconds += nanoseconds - thread->syscall_started_;
+	}
+#else
+	Q_UNUSED(tid);
+#endif
+
+	thread->syscall_number_  = -1;
+	thread->syscall_started_ = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_syscall_stats
+// Desc: takes effect the next time the threads are resumed, they are then
+//       resumed with PTRACE_SYSCALL until stop_syscall_stats
+//------------------------------------------------------------------------------
+Status DebuggerCore::start_syscall_stats() {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(!process_) {
+		return Status(tr("Not attached to a process"));
+	}
+
+	syscall_stats_enabled_ = true;
+	return Status::Ok;
+#else
+	return Status(tr("System call statistics are not supported on this architecture"));
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_syscall_stats
+// Desc: what was counted until now can still be taken
+//------------------------------------------------------------------------------
+void DebuggerCore::stop_syscall_stats() {
+	syscall_stats_enabled_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: take_syscall_stats
+// Desc: false if nothing was counted since the last call
+//------------------------------------------------------------------------------
+bool DebuggerCore::take_syscall_stats(SyscallStats *stats) {
+
+	Q_ASSERT(stats);
+
+	if(syscall_stats_.isEmpty()) {
+		return false;
+	}
+
+	*stats = syscall_stats_;
+	syscall_stats_ = SyscallStats();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_branch_trace
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::start_branch_trace(quint64 sample_period) {
+
+	if(!process_) {
+		return Status(tr("Not attached to a process"));
+	}
+
+	if(branch_trace_) {
+		return Status(tr("A branch trace is already running"));
+	}
+
+	if(sample_period == 0) {
+		return Status(tr("The sample period must be at least 1"));
+	}
+
+	auto trace = util::make_unique<PerfBranchTrace>(sample_period);
+	for(edb::tid_t tid : threads_.keys()) {
+		const Status status = trace->add_thread(tid);
+		if(!status) {
+			return status;
+		}
+	}
+
+	branch_trace_ = std::move(trace);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_branch_trace
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::stop_branch_trace(BranchTrace *trace) {
+
+	Q_ASSERT(trace);
+
+	if(!branch_trace_) {
+		return Status(tr("No branch trace is running"));
+	}
+
+	*trace = branch_trace_->take();
+	branch_trace_ = nullptr;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: branch_trace_active
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::branch_trace_active() const {
+	return branch_trace_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_profile
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::start_profile(quint64 frequency, bool call_stacks) {
+
+	if(!process_) {
+		return Status(tr("Not attached to a process"));
+	}
+
+	if(profiler_) {
+		return Status(tr("The profiler is already running"));
+	}
+
+	if(frequency == 0) {
+		return Status(tr("The sample frequency must be at least 1"));
+	}
+
+	auto profiler = util::make_unique<PerfProfiler>(frequency, call_stacks);
+	for(edb::tid_t tid : threads_.keys()) {
+		const Status status = profiler->add_thread(tid);
+		if(!status) {
+			return status;
+		}
+	}
+
+	profiler_ = std::move(profiler);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_profile
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::stop_profile(Profile *profile) {
+
+	Q_ASSERT(profile);
+
+	if(!profiler_) {
+		return Status(tr("The profiler is not running"));
+	}
+
+	*profile = profiler_->take();
+	profiler_ = nullptr;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: profile_active
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::profile_active() const {
+	return profiler_ != nullptr;
+}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+//------------------------------------------------------------------------------
+// Name: add_coverage_points
+// Desc: arms them all with one vectored read of the bytes they replace and
+//       one vectored write
+//------------------------------------------------------------------------------
+Status DebuggerCore::add_coverage_points(const QVector<edb::address_t> &addresses) {
+
+	if(!process_) {
+		return Status(tr("Not attached to a process"));
+	}
+
+	QVector<edb::address_t> points;
+	points.reserve(addresses.size());
+	for(const edb::address_t address : addresses) {
+		if(!coverage_points_.contains(address) && !find_breakpoint(address)) {
+			points.push_back(address);
+		}
+	}
+
+	std::sort(points.begin(), points.end());
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	if(points.isEmpty()) {
+		return Status::Ok;
+	}
+
+	QVector<quint8>      original(points.size());
+	QVector<ReadRequest> reads;
+	reads.reserve(points.size());
+	for(int i = 0; i < points.size(); ++i) {
+		reads.push_back(ReadRequest{points[i], &original[i], 1});
+	}
+
+	const QVector<std::size_t> read = process_->read_many(reads);
+
+	QVector<WriteRequest> writes;
+	QVector<int>          written_points;
+	writes.reserve(points.size());
+	written_points.reserve(points.size());
+	for(int i = 0; i < points.size(); ++i) {
+		if(read[i] == 1) {
+			writes.push_back(WriteRequest{points[i], &CoverageInstruction, 1});
+			written_points.push_back(i);
+		}
+	}
+
+	const QVector<std::size_t> written = process_->write_many(writes);
+
+	int placed = 0;
+	for(int i = 0; i < written.size(); ++i) {
+		if(written[i] == 1) {
+			const int n = written_points[i];
+			coverage_points_.insert(points[n], original[n]);
+			++placed;
+		}
+	}
+
+	if(placed != points.size()) {
+		return Status(tr("%1 of %2 coverage points could not be placed").arg(points.size() - placed).arg(points.size()));
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: take_coverage_hits
+// Desc:
+//------------------------------------------------------------------------------
+QVector<edb::address_t> DebuggerCore::take_coverage_hits() {
+	QVector<edb::address_t> hits;
+	hits.swap(coverage_hits_);
+	return hits;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear_coverage_points
+// Desc: puts back the bytes of all the points which are still armed, except
+//       where a breakpoint was set on top of one since, that one has them
+//------------------------------------------------------------------------------
+void DebuggerCore::clear_coverage_points() {
+
+	if(coverage_points_.isEmpty()) {
+		return;
+	}
+
+	if(process_) {
+		QVector<WriteRequest> writes;
+		writes.reserve(coverage_points_.size());
+		for(auto it = coverage_points_.constBegin(); it != coverage_points_.constEnd(); ++it) {
+			if(!find_breakpoint(it.key())) {
+				writes.push_back(WriteRequest{it.key(), &it.value(), 1});
+			}
+		}
+
+		process_->write_many(writes);
+	}
+
+	coverage_points_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: take_coverage_point
+// Desc: if <tid> stopped on a coverage point, records the hit, puts the byte
+//       back and moves the thread back onto it. Returns true if the event
+//       needs no further handling, the thread is left stopped
+//------------------------------------------------------------------------------
+bool DebuggerCore::take_coverage_point(edb::tid_t tid, int status) {
+
+	if(coverage_points_.isEmpty() || !WIFSTOPPED(status) || WSTOPSIG(status) != SIGTRAP || (status >> 16) != 0) {
+		return false;
+	}
+
+	auto thread = threads_.find(tid);
+	if(thread == threads_.end()) {
+		return false;
+	}
+
+	siginfo_t siginfo;
+	if(!ptrace_getsiginfo(tid, &siginfo) || (siginfo.si_code != SI_KERNEL && siginfo.si_code != TRAP_BRKPT)) {
+		return false;
+	}
+
+	State state;
+	thread.value()->get_state(&state);
+
+	const edb::address_t address = state.instruction_pointer() - 1;
+
+	auto point = coverage_points_.find(address);
+	if(point == coverage_points_.end()) {
+		return false;
+	}
+
+	const quint8 original = point.value();
+	coverage_points_.erase(point);
+	coverage_hits_.push_back(address);
+
+	// somebody put a breakpoint there since, which is theirs to report
+	if(find_breakpoint(address)) {
+		return false;
 	}
-#endif
-	return e;
+
+	if(!process_->write_bytes(address, &original, 1)) {
+		qWarning("take_coverage_point(): failed to restore the byte at %s", qPrintable(address.toPointerString()));
+		return false;
+	}
+
+	state.set_instruction_pointer(address);
+	thread.value()->set_state(state);
+	return true;
 }
+#endif
 
 //------------------------------------------------------------------------------
-// Name: stop_threads
-// Desc:
+// Name: wait_debug_event
+// Desc: waits for a debug event, msecs is a timeout
+//      it will return false if an error or timeout occurs
 //------------------------------------------------------------------------------
-Status DebuggerCore::stop_threads() {
+std::shared_ptr<IDebugEvent> DebuggerCore::wait_debug_event(int msecs) {
 
-	QString errorMessage;
+	EDB_TRACE_SEGMENT("DebuggerCore::wait_debug_event", EventWait);
+
+	if(remote_process_) {
+		return wait_remote_event(msecs);
+	}
 
 	if(process_) {
-		for(auto &thread: process_->threads()) {
-			const edb::tid_t tid = thread->tid();
+		if(branch_trace_) {
+			branch_trace_->drain();
+		}
 
-			if(!waited_threads_.contains(tid)) {
+		if(profiler_) {
+			profiler_->drain();
+		}
 
-				if(auto thread_ptr = std::static_pointer_cast<PlatformThread>(thread)) {
-
-					const auto stopStatus=thread->stop();
-					if(!stopStatus)
-						errorMessage+=QObject::tr("Failed to stop thread %1: %2\n").arg(tid).arg(stopStatus.toString());
-
-					int thread_status;
-					if(native::waitpid(tid, &thread_status, __WALL) > 0) {
-						waited_threads_.insert(tid);
-						thread_ptr->status_ = thread_status;
-
-						// A thread could have exited between previous waitpid and the latest one...
-						if(WIFEXITED(thread_status)) {
-							handle_thread_exit(tid, thread_status);
-						}
-						// ..., otherwise it must have stopped.
-						else if(!WIFSTOPPED(thread_status) || WSTOPSIG(thread_status) != SIGSTOP) {
-							qWarning("stop_threads(): paused thread [%d] received an event besides SIGSTOP: status=0x%x", tid,thread_status);
-						}
-					}
+		// nothing we cached can be trusted while some threads are running
+		if(edb::v1::config().non_stop_mode && waited_threads_.size() != threads_.size()) {
+			invalidate_memory_caches();
+		}
+
+		// statuses picked up while stopping the other threads come first
+		if(!pending_events_.isEmpty()) {
+			const auto pending = pending_events_.dequeue();
+			return handle_event(pending.first, pending.second);
+		}
+
+		// then those of the other inferiors, once they are all running again
+		if(waited_threads_.size() != threads_.size()) {
+			for(auto it = inferiors_.begin(); it != inferiors_.end(); ++it) {
+				if(!it->pending_events.isEmpty()) {
+					const auto pending = it->pending_events.dequeue();
+					return inferior_event(it.key(), pending.first, pending.second);
+				}
+			}
+		}
+
+		if(!native::wait_for_sigchld(msecs)) {
+			edb::tid_t tid;
+			int status;
+			if(wait_any_thread(&tid, &status)) {
+				if(const edb::pid_t owner = inferior_of(tid)) {
+					return inferior_event(owner, tid, status);
 				}
+				return handle_event(tid, status);
 			}
 		}
 	}
-	if(errorMessage.isEmpty())
-		return Status::Ok;
-	qWarning() << errorMessage.toStdString().c_str();
-	return Status("\n"+errorMessage);
+	return nullptr;
 }
 
 //------------------------------------------------------------------------------
-// Name: wait_debug_event
-// Desc: waits for a debug event, msecs is a timeout
-//      it will return false if an error or timeout occurs
+// Name: wait_any_thread
+// Desc: reaps the status of whichever of our threads has something to report,
+//       returns false if none of them do
 //------------------------------------------------------------------------------
-std::shared_ptr<IDebugEvent> DebuggerCore::wait_debug_event(int msecs) {
+bool DebuggerCore::wait_any_thread(edb::tid_t *tid, int *status) {
 
-	if(process_) {
-		if(!native::wait_for_sigchld(msecs)) {
-			for(auto &thread : process_->threads()) {
-				int status;
-				const edb::tid_t tid = native::waitpid(thread->tid(), &status, __WALL | WNOHANG);
-				if(tid > 0) {
-					return handle_event(tid, status);
-				}
+	// ask the kernel which child is waiting, but without reaping it, it may
+	// not be one of ours (edb has children of its own, e.g. QProcess)
+	siginfo_t info;
+	std::memset(&info, 0, sizeof(info));
+
+	int ret;
+	do {
+		ret = waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOHANG | WNOWAIT | __WALL);
+	} while(ret == -1 && errno == EINTR);
+
+	if(ret == 0 && info.si_pid != 0 && (threads_.contains(info.si_pid) || forked_children_.contains(info.si_pid) || inferior_of(info.si_pid))) {
+		if(native::waitpid(info.si_pid, status, __WALL | WNOHANG) > 0) {
+			*tid = info.si_pid;
+			return true;
+		}
+	}
+
+	// older kernels don't accept __WALL for waitid, and a child which isn't
+	// ours may be hiding the others, so fall back to asking each thread
+	for(auto it = threads_.begin(); it != threads_.end(); ++it) {
+		if(native::waitpid(it.key(), status, __WALL | WNOHANG) > 0) {
+			*tid = it.key();
+			return true;
+		}
+	}
+
+	for(auto it = forked_children_.begin(); it != forked_children_.end(); ++it) {
+		if(native::waitpid(it.key(), status, __WALL | WNOHANG) > 0) {
+			*tid = it.key();
+			return true;
+		}
+	}
+
+	for(const Inferior &inferior : inferiors_) {
+		for(auto it = inferior.threads.begin(); it != inferior.threads.end(); ++it) {
+			if(native::waitpid(it.key(), status, __WALL | WNOHANG) > 0) {
+				*tid = it.key();
+				return true;
+			}
+		}
+
+		for(auto it = inferior.forked_children.begin(); it != inferior.forked_children.end(); ++it) {
+			if(native::waitpid(it.key(), status, __WALL | WNOHANG) > 0) {
+				*tid = it.key();
+				return true;
 			}
 		}
 	}
-	return nullptr;
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: has_pending_event
+// Desc: returns true if <tid> reported a status which hasn't been handled yet,
+//       such a thread must stay stopped until it is
+//------------------------------------------------------------------------------
+bool DebuggerCore::has_pending_event(edb::tid_t tid) const {
+	for(const auto &pending : pending_events_) {
+		if(pending.first == tid) {
+			return true;
+		}
+	}
+	return false;
 }
 
 //------------------------------------------------------------------------------
@@ -615,6 +2698,7 @@ int DebuggerCore::attach_thread(edb::tid_t tid) {
 			newThread->signal_status_ = PlatformThread::Stopped;
 
 			threads_[tid] = newThread;
+			thread_list_valid_ = false;
 
 			waited_threads_.insert(tid);
 
@@ -637,106 +2721,503 @@ int DebuggerCore::attach_thread(edb::tid_t tid) {
 }
 
 //------------------------------------------------------------------------------
-// Name: attach
-// Desc:
+// Name: seize_thread
+// Desc: starts tracing <tid> without stopping it, returns 0 if successful,
+//       errno if failed
+//------------------------------------------------------------------------------
+int DebuggerCore::seize_thread(edb::tid_t tid) {
+	if(ptrace(PTRACE_SEIZE, tid, 0, ptraceOptions()) == -1) {
+		return errno;
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: interrupt_threads
+// Desc: stops the seized threads <tids> and waits for them. All of the
+//       interrupts go out before the first wait, so the threads stop in
+//       parallel instead of one after the other
+//------------------------------------------------------------------------------
+void DebuggerCore::interrupt_threads(const QSet<edb::tid_t> &tids) {
+
+	for(const edb::tid_t tid : tids) {
+		if(ptrace(PTRACE_INTERRUPT, tid, 0, 0) == -1) {
+			const char *const strError = strerror(errno);
+			qWarning() << "Unable to interrupt thread" << tid << ": PTRACE_INTERRUPT failed:" << strError;
+		}
+	}
+
+	QList<edb::tid_t> waiting = tids.toList();
+
+	while(!waiting.isEmpty()) {
+		const edb::tid_t tid = waiting.takeFirst();
+
+		int status;
+		if(native::waitpid(tid, &status, __WALL) <= 0 || !WIFSTOPPED(status)) {
+			// exited while we were attaching
+			continue;
+		}
+
+		auto newThread            = std::make_shared<PlatformThread>(this, process_, tid);
+		newThread->status_        = status;
+		newThread->signal_status_ = PlatformThread::Stopped;
+
+		threads_[tid] = newThread;
+		thread_list_valid_ = false;
+		waited_threads_.insert(tid);
+
+		// a thread created since we read the task list is traced already, and
+		// starts out stopped
+		if(is_clone_event(status)) {
+			unsigned long new_tid;
+			if(ptrace_get_event_message(tid, &new_tid)) {
+				if(!threads_.contains(new_tid) && !tids.contains(new_tid) && !waiting.contains(new_tid)) {
+					waiting.push_back(new_tid);
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: attach
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::attach(edb::pid_t pid) {
+
+	end_debug_session();
+
+	return attach_process(pid);
+}
+
+//------------------------------------------------------------------------------
+// Name: attach_process
+// Desc: attaches to <pid>, which becomes the current process, whatever was
+//       being debugged is left to the caller
+//------------------------------------------------------------------------------
+Status DebuggerCore::attach_process(edb::pid_t pid) {
+
+	lastMeansOfCapture = MeansOfCapture::Attach;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// create this, so the threads created can refer to it
+    process_ = new PlatformProcess(this, pid);
+
+	// seized threads keep running until they are interrupted, so a big
+	// process doesn't sit stopped while we go through its task list
+	QSet<edb::tid_t> seized;
+
+	int lastErr = seize_thread(pid); // Fail early if we are going to
+	if(lastErr == EIO) {
+		// PTRACE_SEIZE is new in linux 3.4
+		lastErr = attach_thread(pid);
+	} else if(lastErr == 0) {
+		seized.insert(pid);
+	}
+
+	if(lastErr) {
+        delete process_;
+        process_ = nullptr;
+		return Status(std::strerror(lastErr));
+	}
+
+	const bool seizing = !seized.isEmpty();
+
+	lastErr = -2;
+	bool attached;
+	do {
+		attached = false;
+		QDir proc_directory(QString("/proc/%1/task/").arg(pid));
+		for(const QString &s: proc_directory.entryList(QDir::NoDotAndDotDot | QDir::Dirs)) {
+			// this can get tricky if the threads decide to spawn new threads
+			// when we are attaching. I wish that linux had an atomic way to do this
+			// all in one shot
+			const edb::tid_t tid = s.toUInt();
+			if(!threads_.contains(tid) && !seized.contains(tid)) {
+                const auto errnum = seizing ? seize_thread(tid) : attach_thread(tid);
+				if(errnum == 0) {
+					attached = true;
+					if(seizing) {
+						seized.insert(tid);
+					}
+				} else {
+					lastErr = errnum;
+				}
+			}
+		}
+	} while(attached);
+
+	const qint64 attach_time = timer.restart();
+
+	if(seizing) {
+		interrupt_threads(seized);
+	}
+
+	const qint64 stop_time = timer.restart();
+
+	if(!threads_.empty()) {
+		pid_            = pid;
+		active_thread_  = pid;
+		binary_info_    = edb::v1::get_binary_info(edb::v1::primary_code_region());
+		detectCPUMode();
+
+		qDebug() << "[DebuggerCore] attached to" << threads_.size() << "threads:"
+		         << (seizing ? "seize" : "attach") << attach_time << "ms,"
+		         << "stop" << stop_time << "ms,"
+		         << "binary info" << timer.elapsed() << "ms";
+		return Status::Ok;
+	}
+
+    delete process_;
+    process_ = nullptr;
+	return Status(std::strerror(lastErr));
+}
+
+//------------------------------------------------------------------------------
+// Name: detach
+// Desc:
+//------------------------------------------------------------------------------
+Status DebuggerCore::detach() {
+	if(close_core()) {
+		return Status::Ok;
+	}
+
+	if(remote_process_) {
+		clear_breakpoints();
+		remote_process_->detach();
+		close_remote();
+		return Status::Ok;
+	}
+
+	Status status = detach_current();
+
+	// the session ends for all of them
+	while(!inferiors_.isEmpty()) {
+		switch_to_inferior(inferiors_.firstKey());
+
+		const Status inferior_status = detach_current();
+		if(!inferior_status && status) {
+			status = inferior_status;
+		}
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+// Name: detach_current
+// Desc: detaches from the current process only
+//------------------------------------------------------------------------------
+Status DebuggerCore::detach_current() {
+
+	QString errorMessage;
+	if(process_) {
+
+		stop_threads();
+		release_forked_children();
+		discard_checkpoints();
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		clear_coverage_points();
+#endif
+		clear_breakpoints();
+
+		for(auto it = threads_.cbegin(); it != threads_.cend(); ++it) {
+			if(ptrace(PTRACE_DETACH, it.key(), 0, 0)==-1) {
+				const char*const strError=strerror(errno);
+				errorMessage+=QObject::tr("Unable to detach from thread %1: PTRACE_DETACH failed: %2\n").arg(it.key()).arg(strError);
+			}
+		}
+
+		delete process_;
+		process_ = nullptr;
+
+		reset();
+	}
+	if(errorMessage.isEmpty())
+		return Status::Ok;
+	qWarning() << errorMessage.toStdString().c_str();
+	return Status(errorMessage);
+}
+
+//------------------------------------------------------------------------------
+// Name: kill
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::kill() {
+	if(close_core()) {
+		return;
+	}
+
+	if(remote_process_) {
+		remote_process_->kill();
+		close_remote();
+		return;
+	}
+
+	kill_current();
+
+	// the session ends for all of them
+	while(!inferiors_.isEmpty()) {
+		switch_to_inferior(inferiors_.firstKey());
+		kill_current();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: kill_current
+// Desc: kills the current process only
+//------------------------------------------------------------------------------
+void DebuggerCore::kill_current() {
+	if(attached()) {
+		clear_breakpoints();
+		release_forked_children();
+		discard_checkpoints();
+
+		if(inferiors_.isEmpty()) {
+			::kill(pid(), SIGKILL);
+
+			pid_t ret;
+			while((ret=native::waitpid(-1, 0, __WALL)) != pid() && ret!=-1);
+		} else {
+			// anything else might be a stop of one of the others
+			reap_process(pid(), threads_.keys());
+		}
+
+		delete process_;
+		process_ = nullptr;
+
+		reset();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: attach_inferior
+// Desc: attaches to <pid> without letting go of the current process, which
+//       carries on as one of the other inferiors
+//------------------------------------------------------------------------------
+Status DebuggerCore::attach_inferior(edb::pid_t pid) {
+
+	if(core_process_ || remote_process_) {
+		return Status(tr("Only local processes can be debugged alongside others"));
+	}
+
+	if(!attached()) {
+		return attach(pid);
+	}
+
+	if(pid == pid_ || inferiors_.contains(pid)) {
+		return Status(tr("Process %1 is already being debugged").arg(pid));
+	}
+
+	Inferior current;
+	swap_inferior(&current);
+
+	const Status status = attach_process(pid);
+	if(!status) {
+		swap_inferior(&current);
+		init_cpu_mode(pointer_size_ == sizeof(quint64));
+		return status;
+	}
+
+	inferiors_.insert(current.pid, current);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: select_inferior
+// Desc: makes <pid> the current process, they are all stopped so nothing
+//       else changes
+//------------------------------------------------------------------------------
+Status DebuggerCore::select_inferior(edb::pid_t pid) {
+
+	if(pid == pid_) {
+		return Status::Ok;
+	}
+
+	if(!inferiors_.contains(pid)) {
+		return Status(tr("Process %1 is not being debugged").arg(pid));
+	}
+
+	switch_to_inferior(pid);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: release_inferior
+// Desc: detaches from the current process, and carries on with another.
+//       A process which exited only has its bookkeeping to be dropped
 //------------------------------------------------------------------------------
-Status DebuggerCore::attach(edb::pid_t pid) {
+Status DebuggerCore::release_inferior() {
 
-	end_debug_session();
+	if(inferiors_.isEmpty()) {
+		return detach();
+	}
 
-	lastMeansOfCapture = MeansOfCapture::Attach;
+	const Status status = detach_current();
+	switch_to_inferior(inferiors_.firstKey());
+	return status;
+}
 
-	// create this, so the threads created can refer to it
-    process_ = new PlatformProcess(this, pid);
+//------------------------------------------------------------------------------
+// Name: inferiors
+// Desc:
+//------------------------------------------------------------------------------
+QList<edb::pid_t> DebuggerCore::inferiors() const {
 
-	int lastErr = attach_thread(pid); // Fail early if we are going to
-	if(lastErr) {
-        delete process_;
-        process_ = nullptr;
-		return Status(std::strerror(lastErr));
+	QList<edb::pid_t> pids;
+	if(attached()) {
+		pids.push_back(pid_);
 	}
 
-	lastErr = -2;
-	bool attached;
-	do {
-		attached = false;
-		QDir proc_directory(QString("/proc/%1/task/").arg(pid));
-		for(const QString &s: proc_directory.entryList(QDir::NoDotAndDotDot | QDir::Dirs)) {
-			// this can get tricky if the threads decide to spawn new threads
-			// when we are attaching. I wish that linux had an atomic way to do this
-			// all in one shot
-			const edb::tid_t tid = s.toUInt();
-			if(!threads_.contains(tid)) {
-                const auto errnum = attach_thread(tid);
-				if(errnum == 0)
-					attached = true;
-				else
-					lastErr = errnum;
-			}
-		}
-	} while(attached);
+	pids.append(inferiors_.keys());
+	return pids;
+}
 
+//------------------------------------------------------------------------------
+// Name: swap_inferior
+// Desc: trades everything which belongs to the current process for what
+//       <inferior> has. None of the caches can carry over
+//------------------------------------------------------------------------------
+void DebuggerCore::swap_inferior(Inferior *inferior) {
+
+	Q_ASSERT(inferior);
+
+	qSwap(pid_,               inferior->pid);
+	qSwap(process_,           inferior->process);
+	qSwap(threads_,           inferior->threads);
+	qSwap(waited_threads_,    inferior->waited_threads);
+	qSwap(pending_events_,    inferior->pending_events);
+	qSwap(active_thread_,     inferior->active_thread);
+	qSwap(binary_info_,       inferior->binary_info);
+	qSwap(coverage_points_,   inferior->coverage_points);
+	qSwap(coverage_hits_,     inferior->coverage_hits);
+	qSwap(lastMeansOfCapture, inferior->capture);
+	qSwap(forked_children_,   inferior->forked_children);
+	qSwap(seccomp_syscalls_,  inferior->seccomp_syscalls);
+	qSwap(checkpoints_,       inferior->checkpoints);
+	qSwap(pointer_size_,      inferior->pointer_size);
+	qSwap(cpu_mode_,          inferior->cpu_mode);
+	swap_breakpoints(&inferior->breakpoints);
+
+	invalidate_memory_caches();
+	soft_dirty_valid_   = false;
+	soft_dirty_cleared_ = false;
+	thread_list_valid_  = false;
+}
 
-	if(!threads_.empty()) {
-		pid_            = pid;
-		active_thread_  = pid;
-		binary_info_    = edb::v1::get_binary_info(edb::v1::primary_code_region());
-		detectCPUMode();
-		return Status::Ok;
-	}
+//------------------------------------------------------------------------------
+// Name: with_inferior
+// Desc: calls <function> with <inferior> made the current process for the
+//       duration, everything is put back the way it was afterwards
+//------------------------------------------------------------------------------
+void DebuggerCore::with_inferior(Inferior *inferior, const std::function<void()> &function) {
 
-    delete process_;
-    process_ = nullptr;
-	return Status(std::strerror(lastErr));
+	Inferior current;
+	swap_inferior(&current);
+	swap_inferior(inferior);
+
+	function();
+
+	swap_inferior(inferior);
+	swap_inferior(&current);
 }
 
 //------------------------------------------------------------------------------
-// Name: detach
-// Desc:
+// Name: switch_to_inferior
+// Desc: makes <pid> the current process for good, the current one (if any)
+//       joins the others
 //------------------------------------------------------------------------------
-Status DebuggerCore::detach() {
-	QString errorMessage;
-	if(process_) {
+void DebuggerCore::switch_to_inferior(edb::pid_t pid) {
 
-		stop_threads();
+	Inferior next = inferiors_.take(pid);
 
-		clear_breakpoints();
+	if(attached()) {
+		Inferior current;
+		swap_inferior(&current);
+		inferiors_.insert(current.pid, current);
+	}
 
-		for(auto &thread: process_->threads()) {
-			if(ptrace(PTRACE_DETACH, thread->tid(), 0, 0)==-1) {
-				const char*const strError=strerror(errno);
-				errorMessage+=QObject::tr("Unable to detach from thread %1: PTRACE_DETACH failed: %2\n").arg(thread->tid()).arg(strError);
-			}
+	swap_inferior(&next);
+	init_cpu_mode(pointer_size_ == sizeof(quint64));
+}
+
+//------------------------------------------------------------------------------
+// Name: inferior_of
+// Desc: which of the other inferiors <tid> belongs to, 0 if none of them
+//------------------------------------------------------------------------------
+edb::pid_t DebuggerCore::inferior_of(edb::tid_t tid) const {
+	for(auto it = inferiors_.begin(); it != inferiors_.end(); ++it) {
+		if(it->threads.contains(tid) || it->forked_children.contains(tid)) {
+			return it.key();
 		}
+	}
+	return 0;
+}
 
-		delete process_;
-		process_ = nullptr;
+//------------------------------------------------------------------------------
+// Name: inferior_event
+// Desc: handles the status of <tid> of the inferior <pid>. If that is
+//       something to report, every other process is stopped for it the way
+//       the other threads are, and <pid> becomes the current one
+//------------------------------------------------------------------------------
+std::shared_ptr<IDebugEvent> DebuggerCore::inferior_event(edb::pid_t pid, edb::tid_t tid, int status) {
 
-		reset();
+	std::shared_ptr<IDebugEvent> event;
+	with_inferior(&inferiors_[pid], [&]() {
+		event = handle_event(tid, status);
+	});
+
+	if(!event) {
+		return nullptr;
 	}
-	if(errorMessage.isEmpty())
-		return Status::Ok;
-	qWarning() << errorMessage.toStdString().c_str();
-	return Status(errorMessage);
+
+	stop_threads();
+	for(auto it = inferiors_.begin(); it != inferiors_.end(); ++it) {
+		if(it.key() != pid) {
+			with_inferior(&it.value(), [this]() { stop_threads(); });
+		}
+	}
+
+	qDebug() << "[DebuggerCore] switching to inferior" << pid << "for its event";
+	switch_to_inferior(pid);
+	return event;
 }
 
 //------------------------------------------------------------------------------
-// Name: kill
-// Desc:
+// Name: resume_inferiors
+// Desc: the other inferiors run whenever the current one does. One with an
+//       event still to report stays stopped until wait_debug_event gets to
+//       it, and one stopped on its own breakpoint steps over it first
 //------------------------------------------------------------------------------
-void DebuggerCore::kill() {
-	if(attached()) {
-		clear_breakpoints();
+void DebuggerCore::resume_inferiors() {
 
-		::kill(pid(), SIGKILL);
-
-		pid_t ret;
-		while((ret=native::waitpid(-1, 0, __WALL)) != pid() && ret!=-1);
+	for(auto it = inferiors_.begin(); it != inferiors_.end(); ++it) {
+		with_inferior(&it.value(), [this]() {
+			if(!pending_events_.isEmpty()) {
+				return;
+			}
 
-		delete process_;
-		process_ = nullptr;
+			if(std::shared_ptr<PlatformThread> thread = threads_.value(active_thread_)) {
+				State state;
+				thread->get_state(&state);
+				if(std::shared_ptr<IBreakpoint> bp = find_breakpoint(state.instruction_pointer())) {
+					bool trapped;
+					step_in_place(thread, bp, false, &trapped);
+					if(!trapped) {
+						return;
+					}
+				}
+			}
 
-		reset();
+			for(auto thread = threads_.begin(); thread != threads_.end(); ++thread) {
+				if(waited_threads_.contains(thread.key())) {
+					thread.value()->resume(edb::DEBUG_CONTINUE);
+				}
+			}
+		});
 	}
 }
 
@@ -799,8 +3280,8 @@ void DebuggerCore::detectCPUMode() {
 //------------------------------------------------------------------------------
 void DebuggerCore::get_state(State *state) {
 	// TODO: assert that we are paused
-	if(process_) {
-		if(std::shared_ptr<IThread> thread = process_->current_thread()) {
+	if(IProcess *const process = this->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
 			thread->get_state(state);
 		}
 	}
@@ -813,8 +3294,8 @@ void DebuggerCore::get_state(State *state) {
 void DebuggerCore::set_state(const State &state) {
 
 	// TODO: assert that we are paused
-	if(process_) {
-		if(std::shared_ptr<IThread> thread = process_->current_thread()) {
+	if(IProcess *const process = this->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
 			thread->set_state(state);
 		}
 	}
@@ -830,6 +3311,9 @@ Status DebuggerCore::open(const QString &path, const QString &cwd, const QList<Q
 
     lastMeansOfCapture = MeansOfCapture::Launch;
 
+	// built here, the child shouldn't allocate more than it has to
+	const std::vector<sock_filter> filter = syscall_catch_enabled_ ? syscall_filter::build(syscall_catch_) : std::vector<sock_filter>();
+
 	static constexpr std::size_t sharedMemSize=4096;
 	const auto sharedMem=static_cast<QChar*>(::mmap(nullptr,sharedMemSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0));
 	std::memset(sharedMem,0,sharedMemSize);
@@ -867,6 +3351,11 @@ Status DebuggerCore::open(const QString &path, const QString &cwd, const QList<Q
 			perror("Failed to disable lazy binding");
         }
 
+		// we fall back to PTRACE_SYSCALL without it
+		if(!filter.empty() && !syscall_filter::install(filter)) {
+			perror("Failed to install the system call filter");
+		}
+
 		// do the actual exec
 		const Status status = execute_process(path, cwd, args);
 
@@ -938,6 +3427,7 @@ Status DebuggerCore::open(const QString &path, const QString &cwd, const QList<Q
 			newThread->signal_status_ = PlatformThread::Stopped;
 
 			threads_[pid]   = newThread;
+			thread_list_valid_ = false;
 
 			pid_            = pid;
             active_thread_  = pid;
@@ -945,6 +3435,11 @@ Status DebuggerCore::open(const QString &path, const QString &cwd, const QList<Q
 
 			detectCPUMode();
 
+			// the filter only matches native system calls
+			if(!filter.empty() && pointer_size_ == sizeof(void *) && syscall_filter::installed(pid)) {
+				seccomp_syscalls_ = syscall_catch_;
+			}
+
 			return Status::Ok;
 		} while(0);
 		break;
@@ -960,16 +3455,276 @@ DebuggerCore::MeansOfCapture DebuggerCore::last_means_of_capture() const {
 	return lastMeansOfCapture;
 }
 
+//------------------------------------------------------------------------------
+// Name: open_core
+// Desc: there is no process behind a core, so nothing uses ptrace while it is
+//       open, process() just hands out the CoreProcess
+//------------------------------------------------------------------------------
+Status DebuggerCore::open_core(const QString &filename) {
+
+	end_debug_session();
+
+	auto core = util::make_unique<CoreProcess>();
+
+	const Status status = core->open(filename);
+	if(!status) {
+		return status;
+	}
+
+	init_cpu_mode(core->is64Bit());
+	core_process_ = std::move(core);
+
+	binary_info_ = edb::v1::get_binary_info(edb::v1::primary_code_region());
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: open_image
+// Desc: like a core, but the memory comes from laying out the program's own
+//       file, it stands in the core's place until close_core
+//------------------------------------------------------------------------------
+Status DebuggerCore::open_image(const QString &filename) {
+
+	end_debug_session();
+
+	auto image = util::make_unique<ImageProcess>();
+
+	const Status status = image->open(filename);
+	if(!status) {
+		return status;
+	}
+
+	init_cpu_mode(image->is64Bit());
+	core_process_ = std::move(image);
+
+	binary_info_ = edb::v1::get_binary_info(edb::v1::primary_code_region());
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: init_cpu_mode
+// Desc: for targets which detectCPUMode can't look at with ptrace
+//------------------------------------------------------------------------------
+void DebuggerCore::init_cpu_mode(bool is_64bit) {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(is_64bit) {
+		pointer_size_ = sizeof(quint64);
+		cpu_mode_     = CPUMode::x86_64;
+		CapstoneEDB::init(CapstoneEDB::Architecture::ARCH_AMD64);
+	} else {
+		pointer_size_ = sizeof(quint32);
+		cpu_mode_     = CPUMode::x86_32;
+		CapstoneEDB::init(CapstoneEDB::Architecture::ARCH_X86);
+	}
+#elif defined(EDB_ARM32)
+	Q_UNUSED(is_64bit);
+	pointer_size_ = sizeof(quint32);
+	cpu_mode_     = CPUMode::ARM32;
+	CapstoneEDB::init(CapstoneEDB::Architecture::ARCH_ARM32_ARM);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: close_core
+// Desc: returns true if there was a core file open
+//------------------------------------------------------------------------------
+bool DebuggerCore::close_core() {
+	if(core_process_) {
+		core_process_ = nullptr;
+		reset();
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: connect_remote
+// Desc: the stub does the ptrace work, process() hands out a RemoteProcess
+//       which asks it for everything instead
+//------------------------------------------------------------------------------
+Status DebuggerCore::connect_remote(const QString &host, quint16 port) {
+
+	end_debug_session();
+
+	auto remote = util::make_unique<RemoteProcess>(this, page_size());
+
+	const Status status = remote->connect(host, port);
+	if(!status) {
+		return status;
+	}
+
+	remote_process_ = std::move(remote);
+	init_cpu_mode(remote_process_->is64Bit());
+
+	// breakpoints are for attached processes only
+	pid_               = remote_process_->pid();
+	lastMeansOfCapture = MeansOfCapture::Attach;
+
+	binary_info_ = edb::v1::get_binary_info(edb::v1::primary_code_region());
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: close_remote
+// Desc: returns true if there was a remote session
+//------------------------------------------------------------------------------
+bool DebuggerCore::close_remote() {
+	if(remote_process_) {
+		remote_process_ = nullptr;
+		reset();
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_remote_event
+// Desc: turns a stop reply into the same event a waitpid status would have
+//       made, so that the rest of edb can't tell the difference
+//------------------------------------------------------------------------------
+std::shared_ptr<IDebugEvent> DebuggerCore::wait_remote_event(int msecs) {
+
+	RemoteProcess::Stop stop;
+	if(!remote_process_->wait_stop(msecs, &stop)) {
+		return nullptr;
+	}
+
+	auto e = std::make_shared<PlatformEvent>();
+	std::memset(&e->siginfo_, 0, sizeof(e->siginfo_));
+	e->pid_ = pid();
+	e->tid_ = stop.tid;
+
+	switch(stop.kind) {
+	case RemoteProcess::StopKind::Stopped:
+		e->status_            = W_STOPCODE(stop.signal);
+		e->siginfo_.si_signo  = stop.signal;
+		e->siginfo_.si_code   = stop.stepped ? TRAP_TRACE : SI_KERNEL;
+		active_thread_        = stop.tid;
+		break;
+	case RemoteProcess::StopKind::Exited:
+		e->status_ = W_EXITCODE(stop.code, 0);
+		break;
+	case RemoteProcess::StopKind::Terminated:
+		e->status_ = W_EXITCODE(0, stop.signal);
+		break;
+	}
+
+	return e;
+}
+
+//------------------------------------------------------------------------------
+// Name: end_debug_session
+// Desc: a core file isn't attached to, so the base class would leave it open
+//------------------------------------------------------------------------------
+void DebuggerCore::end_debug_session() {
+	close_core();
+	DebuggerCoreBase::end_debug_session();
+}
+
 //------------------------------------------------------------------------------
 // Name: reset
 // Desc:
 //------------------------------------------------------------------------------
 void DebuggerCore::reset() {
 	threads_.clear();
+	thread_list_valid_ = false;
 	waited_threads_.clear();
+	stepping_threads_.clear();
+	pending_events_.clear();
+	branch_trace_  = nullptr;
+	profiler_      = nullptr;
+	coverage_points_.clear();
+	coverage_hits_.clear();
+	seccomp_syscalls_.clear();
+	forked_children_.clear();
+	syscall_stats_enabled_ = false;
+	syscall_stats_ = SyscallStats();
 	pid_           = 0;
 	active_thread_ = 0;
 	binary_info_   = nullptr;
+	invalidate_memory_caches();
+	soft_dirty_valid_   = false;
+	soft_dirty_cleared_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: ptrace_tid
+// Desc: ptrace only works through a stopped thread, which needn't be the main
+//       one in non-stop mode
+//------------------------------------------------------------------------------
+edb::tid_t DebuggerCore::ptrace_tid() const {
+	if(waited_threads_.contains(active_thread_)) {
+		return active_thread_;
+	}
+
+	if(waited_threads_.contains(pid_) || waited_threads_.isEmpty()) {
+		return pid_;
+	}
+
+	return *waited_threads_.begin();
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_state_cache
+// Desc: forgets the cached registers of <tid>, called before it runs
+//------------------------------------------------------------------------------
+void DebuggerCore::invalidate_state_cache(edb::tid_t tid) {
+	auto it = threads_.find(tid);
+	if(it != threads_.end()) {
+		it.value()->invalidate_state_cache();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear_soft_dirty
+// Desc: resets the soft-dirty bits of the process so that the next stop can
+//       tell which pages were written to while it was running. Only done
+//       once per resume, clearing walks every page table of the process
+//------------------------------------------------------------------------------
+void DebuggerCore::clear_soft_dirty() {
+
+	if(!soft_dirty_supported_ || soft_dirty_cleared_ || !pid_) {
+		return;
+	}
+
+	soft_dirty_cleared_ = true;
+
+	QFile file(QString("/proc/%1/clear_refs").arg(pid_));
+	if(file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+		// "4" clears the soft-dirty bits, see Documentation/vm/soft-dirty.txt
+		soft_dirty_valid_ = file.write("4", 1) == 1;
+	} else {
+		soft_dirty_valid_ = false;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_memory_caches
+// Desc: forgets all cached debuggee memory, must be called before any thread
+//       is allowed to run
+//------------------------------------------------------------------------------
+void DebuggerCore::invalidate_memory_caches() {
+	++memory_epoch_;
+	page_cache_.invalidate();
+	ptrace_words_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_memory_caches
+// Desc: forgets any cached debuggee memory overlapping [address, address + len)
+//------------------------------------------------------------------------------
+void DebuggerCore::invalidate_memory_caches(edb::address_t address, std::size_t len) {
+	++memory_epoch_;
+	page_cache_.invalidate(address, len);
+
+	if(!ptrace_words_.isEmpty() && len != 0) {
+		const edb::address_t first = address - (address & (sizeof(long) - 1));
+		for(edb::address_t word = first; word < address + len; word += sizeof(long)) {
+			ptrace_words_.remove(word);
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -1007,6 +3762,51 @@ QMap<edb::pid_t, std::shared_ptr<IProcess>> DebuggerCore::enumerate_processes()
 }
 
 
+//------------------------------------------------------------------------------
+// Name: enumerate_process_summaries
+// Desc: one stat of /proc/<pid> for the owner and one read of its stat file
+//       for the name per process, no PlatformProcess is made
+//------------------------------------------------------------------------------
+QMap<edb::pid_t, ProcessSummary> DebuggerCore::enumerate_process_summaries() const {
+	QMap<edb::pid_t, ProcessSummary> ret;
+
+	// most processes belong to a handful of users
+	QHash<edb::uid_t, QString> users;
+
+	QDir proc_directory("/proc/");
+	const QStringList entries = proc_directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+	for(const QString &filename: entries) {
+		if(!is_numeric(filename)) {
+			continue;
+		}
+
+		struct stat st;
+		if(::stat(QString("/proc/%1").arg(filename).toLocal8Bit().constData(), &st) != 0) {
+			continue;
+		}
+
+		const edb::pid_t pid = filename.toULong();
+
+		ProcessSummary summary;
+		summary.pid = pid;
+		summary.uid = st.st_uid;
+
+		summary.name = process_name(pid);
+
+		auto user = users.find(summary.uid);
+		if(user == users.end()) {
+			const struct passwd *const pwd = ::getpwuid(summary.uid);
+			user = users.insert(summary.uid, pwd ? QString(pwd->pw_name) : QString());
+		}
+		summary.user = *user;
+
+		ret.insert(pid, summary);
+	}
+
+	return ret;
+}
+
 //------------------------------------------------------------------------------
 // Name:
 // Desc:
@@ -1123,6 +3923,14 @@ QString DebuggerCore::flag_register() const {
 // Desc:
 //------------------------------------------------------------------------------
 IProcess *DebuggerCore::process() const {
+	if(core_process_) {
+		return core_process_.get();
+	}
+
+	if(remote_process_) {
+		return remote_process_.get();
+	}
+
 	return process_;
 }
 
@@ -21,9 +21,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include "DebuggerCoreUNIX.h"
+#include "IoQueue.h"
+#include "PageCache.h"
+#include "State.h"
+#include "SyscallStats.h"
+#include <QByteArray>
 #include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QQueue>
 #include <QSet>
+#include <QVector>
 #include <csignal>
+#include <functional>
 #include <unistd.h>
 
 class IBinary;
@@ -31,6 +41,9 @@ class Status;
 
 namespace DebuggerCorePlugin {
 
+class RemoteProcess;
+class PerfBranchTrace;
+class PerfProfiler;
 class PlatformThread;
 
 class DebuggerCore : public DebuggerCoreUNIX {
@@ -43,6 +56,7 @@ class DebuggerCore : public DebuggerCoreUNIX {
 	Q_CLASSINFO("url", "http://www.codef00.com")
 	friend class PlatformProcess;
 	friend class PlatformThread;
+	friend class RemoteProcess;
 
 	CPUMode cpu_mode() const override { return cpu_mode_; }
 public:
@@ -57,6 +71,7 @@ public:
 	virtual Status attach(edb::pid_t pid) override;
 	virtual Status detach() override;
 	virtual void kill() override;
+	virtual void end_debug_session() override;
 	virtual void get_state(State *state) override;
 	virtual void set_state(const State &state) override;
 	virtual Status open(const QString &path, const QString &cwd, const QList<QByteArray> &args, const QString &tty) override;
@@ -67,12 +82,46 @@ public:
 
 public:
 	virtual IState *create_state() const override;
+	virtual Status record_trace(const TraceRequest &request, TraceResult *result) override;
+	virtual Status step_until(const StepCondition &condition, StepResult *result) override;
+	virtual Status start_branch_trace(quint64 sample_period) override;
+	virtual Status stop_branch_trace(BranchTrace *trace) override;
+	virtual bool branch_trace_active() const override;
+	virtual Status start_profile(quint64 frequency, bool call_stacks) override;
+	virtual Status stop_profile(Profile *profile) override;
+	virtual bool profile_active() const override;
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	virtual Status add_coverage_points(const QVector<edb::address_t> &addresses) override;
+	virtual QVector<edb::address_t> take_coverage_hits() override;
+	virtual void clear_coverage_points() override;
+	virtual int coverage_points() const override { return coverage_points_.size(); }
+	virtual Result<int> create_checkpoint() override;
+	virtual Status restore_checkpoint(int id) override;
+	virtual void discard_checkpoint(int id) override;
+	virtual QVector<Checkpoint> checkpoints() const override;
+	virtual std::size_t read_checkpoint(int id, edb::address_t address, void *buf, std::size_t len) const override;
+#endif
+	virtual Status set_syscall_catchpoints(bool enabled, const QSet<int> &syscalls) override;
+	virtual bool syscall_catchpoints_enabled() const override { return syscall_catch_enabled_; }
+	virtual QSet<int> syscall_catchpoints() const override     { return syscall_catch_; }
+	virtual Status start_syscall_stats() override;
+	virtual void stop_syscall_stats() override;
+	virtual bool syscall_stats_active() const override { return syscall_stats_enabled_; }
+	virtual bool take_syscall_stats(SyscallStats *stats) override;
+	virtual Status open_core(const QString &filename) override;
+	virtual Status open_image(const QString &filename) override;
+	virtual Status connect_remote(const QString &host, quint16 port) override;
+	virtual Status attach_inferior(edb::pid_t pid) override;
+	virtual Status select_inferior(edb::pid_t pid) override;
+	virtual Status release_inferior() override;
+	virtual QList<edb::pid_t> inferiors() const override;
 
 public:
 	virtual quint64 cpu_type() const override;
 
 private:
 	virtual QMap<edb::pid_t, std::shared_ptr<IProcess>> enumerate_processes() const override;
+	virtual QMap<edb::pid_t, ProcessSummary> enumerate_process_summaries() const override;
 
 public:
 	virtual QString stack_pointer() const override;
@@ -90,28 +139,114 @@ private:
 	Status ptrace_getsiginfo(edb::tid_t tid, siginfo_t *siginfo);
 	Status ptrace_continue(edb::tid_t tid, long status);
 	Status ptrace_step(edb::tid_t tid, long status);
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	Status ptrace_step_block(edb::tid_t tid, long status);
+	Result<edb::reg_t> inject_syscall(edb::tid_t tid, long number, const QVector<edb::reg_t> &args, const std::function<bool(int)> &on_event = nullptr);
+	edb::address_t syscall_address() const;
+	bool take_coverage_point(edb::tid_t tid, int status);
+#endif
 	Status ptrace_set_options(edb::tid_t tid, long options);
+	Status step_in_place(const std::shared_ptr<PlatformThread> &thread, const std::shared_ptr<IBreakpoint> &bp, bool block, bool *trapped);
+	Status run_to_return(const std::shared_ptr<PlatformThread> &thread, edb::address_t return_address, edb::address_t stack_pointer, const std::function<bool(quint64)> &progress, quint64 steps, bool *trapped, bool *cancelled);
 	Status ptrace_get_event_message(edb::tid_t tid, unsigned long *message);
 	long ptrace_traceme();
 
 private:
 	void reset();
+	bool close_core();
+	bool close_remote();
+	void init_cpu_mode(bool is_64bit);
+	std::shared_ptr<IDebugEvent> wait_remote_event(int msecs);
+	void invalidate_memory_caches();
+	void invalidate_memory_caches(edb::address_t address, std::size_t len);
+	void invalidate_state_cache(edb::tid_t tid);
+	edb::tid_t ptrace_tid() const;
+	void clear_soft_dirty();
 	Status stop_threads();
 	std::shared_ptr<IDebugEvent> handle_event(edb::tid_t tid, int status);
+	bool pass_signal(edb::tid_t tid, int signo);
+	bool wait_any_thread(edb::tid_t *tid, int *status);
+	bool has_pending_event(edb::tid_t tid) const;
 	void handle_thread_exit(edb::tid_t tid, int status);
+	void handle_fork(edb::tid_t tid, int status);
+	void handle_child_event(edb::pid_t child, int status);
+	void apply_fork_behavior(edb::pid_t child);
+	QMap<edb::address_t, quint8> patched_bytes() const;
+	void strip_inherited_breakpoints(edb::pid_t child);
+	void release_forked_children();
+	bool syscall_stop(edb::tid_t tid, int status, int *number, bool *exit);
+	void count_syscall(edb::tid_t tid, PlatformThread *thread, int number, bool exit);
+	bool want_syscall_stops() const;
+	void reset_syscall_state(edb::tid_t tid);
 	int attach_thread(edb::tid_t tid);
+	int seize_thread(edb::tid_t tid);
+	void interrupt_threads(const QSet<edb::tid_t> &tids);
     void detectCPUMode();
     long ptraceOptions() const;
 
 private:
 	typedef QHash<edb::tid_t, std::shared_ptr<PlatformThread>> threadmap_t;
 
+	// a checkpoint's process, along with what it takes to undo the fork in it
+	struct CheckpointProcess {
+		Checkpoint                   info;
+		int                          status       = 0; // of its first stop
+		State                        state;            // the registers from before the fork
+		edb::address_t               code_address = 0;
+		QByteArray                   code;             // the bytes the syscall instruction took
+		QMap<edb::address_t, quint8> patched;          // the original bytes of the breakpoints it has
+	};
+
+	// what is kept of each of the processes debugged besides the current
+	// one, they are the members of the same names while it is current
+	struct Inferior {
+		edb::pid_t                     pid     = 0;
+		IProcess                      *process = nullptr;
+		threadmap_t                    threads;
+		QSet<edb::tid_t>               waited_threads;
+		QQueue<QPair<edb::tid_t, int>> pending_events;
+		edb::tid_t                     active_thread = 0;
+		std::shared_ptr<IBinary>       binary_info;
+		BreakpointList                 breakpoints;
+		QMap<edb::address_t, quint8>   coverage_points;
+		QVector<edb::address_t>        coverage_hits;
+		MeansOfCapture                 capture = MeansOfCapture::NeverCaptured;
+		QHash<edb::pid_t, bool>        forked_children;
+		QSet<int>                      seccomp_syscalls;
+		QMap<int, CheckpointProcess>   checkpoints;
+		std::size_t                    pointer_size = 0;
+		CPUMode                        cpu_mode     = CPUMode::Unknown;
+	};
+
+private:
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	Status fork_checkpoint(CheckpointProcess *checkpoint);
+#endif
+	void discard_checkpoints();
+
+private:
+	Status attach_process(edb::pid_t pid);
+	Status detach_current();
+	void kill_current();
+	void swap_inferior(Inferior *inferior);
+	void with_inferior(Inferior *inferior, const std::function<void()> &function);
+	void switch_to_inferior(edb::pid_t pid);
+	edb::pid_t inferior_of(edb::tid_t tid) const;
+	std::shared_ptr<IDebugEvent> inferior_event(edb::pid_t pid, edb::tid_t tid, int status);
+	void resume_inferiors();
+
 private:
 	threadmap_t              threads_;
+	QList<std::shared_ptr<IThread>> thread_list_; // threads_ in list form, see PlatformProcess::threads
+	bool                     thread_list_valid_ = false;
 	QSet<edb::tid_t>         waited_threads_;
+	QSet<edb::tid_t>         stepping_threads_; // last resumed with a step, any signal they get stops
+	QQueue<QPair<edb::tid_t, int>> pending_events_;
 	edb::tid_t               active_thread_;
-	std::unique_ptr<IBinary> binary_info_;
+	std::shared_ptr<IBinary> binary_info_;
 	IProcess                *process_;
+	std::unique_ptr<IProcess> core_process_; // when looking at a core or program file instead
+	std::unique_ptr<RemoteProcess> remote_process_; // or debugging through a GDB stub
 	std::size_t              pointer_size_;
 #if defined(EDB_X86) || defined(EDB_X86_64)
 	const bool               edbIsIn64BitSegment;
@@ -123,7 +258,28 @@ private:
 	MeansOfCapture	         lastMeansOfCapture = MeansOfCapture::NeverCaptured;
 	bool                     proc_mem_write_broken_;
 	bool                     proc_mem_read_broken_;
+	bool                     process_vm_read_broken_;
+	bool                     process_vm_write_broken_;
+	bool                     soft_dirty_supported_;
+	bool                     soft_dirty_valid_;
+	bool                     soft_dirty_cleared_;
+	int                      stop_threads_timeout_;
 	CPUMode					 cpu_mode_=CPUMode::Unknown;
+	PageCache                page_cache_;
+	quint64                  memory_epoch_ = 0; // bumped by invalidate_memory_caches
+	IoQueue                  io_queue_; // services PlatformProcess::read_async
+	QHash<edb::address_t, long> ptrace_words_;
+	std::unique_ptr<PerfBranchTrace> branch_trace_;
+	std::unique_ptr<PerfProfiler>    profiler_;
+	bool                     syscall_catch_enabled_ = false;
+	QSet<int>                syscall_catch_;    // empty for all of them
+	QSet<int>                seccomp_syscalls_; // what the filter of the launched process stops at
+	QHash<edb::pid_t, bool>  forked_children_;  // the ones still traced, true until a vfork child has called exec
+	bool                     syscall_stats_enabled_ = false;
+	SyscallStats             syscall_stats_;    // since take_syscall_stats was last called
+	QMap<int, CheckpointProcess> checkpoints_;
+	int                      next_checkpoint_id_ = 1;
+	QMap<edb::pid_t, Inferior> inferiors_; // the ones besides the current one
 };
 
 }
@@ -19,12 +19,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "FeatureDetect.h"
 #include "version.h"
 
+#include <QSettings>
+#include <QString>
+
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <cstdint>
+#include <cstring>
 #include <sys/wait.h>
 #include <sys/ptrace.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -77,14 +85,46 @@ void kill_child(int pid) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: first_line
+// Desc: the first line of <filename>, empty if it can't be read
+//------------------------------------------------------------------------------
+std::string first_line(const char *filename) {
+	std::ifstream file(filename);
+	std::string line;
+	std::getline(file, line);
+	return line;
 }
 
 //------------------------------------------------------------------------------
-// Name: detect_proc_access
-// Desc: detects whether or not reads/writes through /proc/<pid>/mem work
-//       correctly
+// Name: access_key
+// Desc: identifies everything the memory access probes depend on: the exact
+//       kernel, the boot (so a changed sysctl or module is noticed), the
+//       ptrace restrictions and SELinux, and who is doing the tracing
 //------------------------------------------------------------------------------
-bool detect_proc_access(bool *read_broken, bool *write_broken) {
+QString access_key() {
+
+	struct utsname name;
+	std::string kernel;
+	if(uname(&name) == 0) {
+		kernel = std::string(name.release) + " " + name.version;
+	}
+
+	return QString("%1|%2|%3|%4|%5:%6")
+		.arg(QString::fromStdString(kernel))
+		.arg(QString::fromStdString(first_line("/proc/sys/kernel/random/boot_id")))
+		.arg(QString::fromStdString(first_line("/proc/sys/kernel/yama/ptrace_scope")))
+		.arg(QString::fromStdString(first_line("/sys/fs/selinux/enforce")))
+		.arg(getuid())
+		.arg(geteuid());
+}
+
+//------------------------------------------------------------------------------
+// Name: spawn_traced_child
+// Desc: forks a child which is traced by us and waits for it to stop, returns
+//       the pid of the child or -1 on failure
+//------------------------------------------------------------------------------
+pid_t spawn_traced_child() {
 
 	switch (pid_t pid = fork()) {
 	case 0:
@@ -103,71 +143,207 @@ bool detect_proc_access(bool *read_broken, bool *write_broken) {
 
 	case -1:
 		perror("fork");
-		return false;
+		return -1;
 
 	default: {
 		int status;
 		if (waitpid(pid, &status, __WALL) == -1) {
 			perror("parent: waitpid failed");
 			kill_child(pid);
-			return false;
+			return -1;
 		}
 
 		if (!WIFSTOPPED(status) || WSTOPSIG(status) != SIGCONT) {
 			std::cerr << "unexpected status returned by waitpid: 0x" << std::hex << status << "\n";
 			kill_child(pid);
-			return false;
+			return -1;
 		}
 
-		File file("/proc/" + std::to_string(pid) + "/mem");
-		if (!file) {
-			perror("failed to open memory file");
-			kill_child(pid);
-			return false;
-		}
+		return pid;
+	}
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: detect_proc_access
+// Desc: detects whether or not reads/writes through /proc/<pid>/mem work
+//       correctly
+//------------------------------------------------------------------------------
+bool detect_proc_access(bool *read_broken, bool *write_broken) {
 
-		const auto pageAlignMask = ~(sysconf(_SC_PAGESIZE) - 1);
-		const auto addr = reinterpret_cast<uintptr_t>(&edb::version) & pageAlignMask;
-		file.seekp(addr);
+	const pid_t pid = spawn_traced_child();
+	if (pid == -1) {
+		return false;
+	}
+
+	File file("/proc/" + std::to_string(pid) + "/mem");
+	if (!file) {
+		perror("failed to open memory file");
+		kill_child(pid);
+		return false;
+	}
+
+	const auto pageAlignMask = ~(sysconf(_SC_PAGESIZE) - 1);
+	const auto addr = reinterpret_cast<uintptr_t>(&edb::version) & pageAlignMask;
+	file.seekp(addr);
+	if (!file) {
+		perror("failed to seek to address to read");
+		kill_child(pid);
+		return false;
+	}
+
+	int buf = 0x12345678;
+	{
+		file.read(&buf, sizeof(buf));
 		if (!file) {
-			perror("failed to seek to address to read");
+			*read_broken  = true;
+			*write_broken = true;
 			kill_child(pid);
 			return false;
 		}
+	}
 
-		int buf = 0x12345678;
-		{
-			file.read(&buf, sizeof(buf));
-			if (!file) {
-				*read_broken  = true;
-				*write_broken = true;
-				kill_child(pid);
-				return false;
-			}
-		}
+	file.seekp(addr);
+	if (!file) {
+		perror("failed to seek to address to write");
+		kill_child(pid);
+		return false;
+	}
 
-		file.seekp(addr);
+	{
+		file.write(&buf, sizeof(buf));
 		if (!file) {
-			perror("failed to seek to address to write");
-			kill_child(pid);
-			return false;
+			*read_broken  = false;
+			*write_broken = true;
+		} else {
+			*read_broken  = false;
+			*write_broken = false;
 		}
+	}
+	kill_child(pid);
+	return true;
+}
 
-		{
-			file.write(&buf, sizeof(buf));
-			if (!file) {
-				*read_broken  = false;
-				*write_broken = true;
-			} else {
-				*read_broken  = false;
-				*write_broken = false;
-			}
-		}
+//------------------------------------------------------------------------------
+// Name: detect_process_vm_access
+// Desc: detects whether or not reads/writes through process_vm_readv and
+//       process_vm_writev work correctly
+//------------------------------------------------------------------------------
+bool detect_process_vm_access(bool *read_broken, bool *write_broken) {
+
+	const pid_t pid = spawn_traced_child();
+	if (pid == -1) {
+		return false;
+	}
+
+	// the child is a copy of us, so it should see the same bytes that we do
+	static char probe[] = "process_vm_readv probe";
+	char buf[sizeof(probe)] = {};
+
+	struct iovec local;
+	local.iov_base = buf;
+	local.iov_len  = sizeof(buf);
+
+	struct iovec remote;
+	remote.iov_base = probe;
+	remote.iov_len  = sizeof(buf);
+
+	ssize_t n = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+	if (n != static_cast<ssize_t>(sizeof(buf)) || std::memcmp(buf, probe, sizeof(buf)) != 0) {
+		*read_broken  = true;
+		*write_broken = true;
+		kill_child(pid);
+		return true;
+	}
+
+	*read_broken = false;
+
+	// now write something else and make sure that it reads back correctly
+	static const char changed[sizeof(probe)] = "process_vm_writev test";
+	local.iov_base = const_cast<char *>(changed);
+
+	n = process_vm_writev(pid, &local, 1, &remote, 1, 0);
+	if (n != static_cast<ssize_t>(sizeof(buf))) {
+		*write_broken = true;
 		kill_child(pid);
 		return true;
 	}
+
+	local.iov_base = buf;
+	n = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+	*write_broken = (n != static_cast<ssize_t>(sizeof(buf)) || std::memcmp(buf, changed, sizeof(buf)) != 0);
+
+	kill_child(pid);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: detect_soft_dirty
+// Desc: detects whether or not the kernel tracks soft-dirty bits in
+//       /proc/<pid>/pagemap
+//------------------------------------------------------------------------------
+bool detect_soft_dirty() {
+
+	// a page that we just wrote to is always soft-dirty, unless the kernel
+	// was built without CONFIG_MEM_SOFT_DIRTY, in which case the bit is never set
+	static volatile char probe[] = "soft-dirty probe";
+	probe[0] = 'S';
+
+	const int fd = ::open("/proc/self/pagemap", O_RDONLY);
+	if (fd == -1) {
+		return false;
 	}
 
+	const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	const auto offset    = static_cast<off_t>(reinterpret_cast<uintptr_t>(probe) / page_size * sizeof(uint64_t));
+
+	uint64_t entry = 0;
+	const ssize_t n = pread(fd, &entry, sizeof(entry), offset);
+	::close(fd);
+
+	return n == static_cast<ssize_t>(sizeof(entry)) && (entry & (UINT64_C(1) << 55));
+}
+//------------------------------------------------------------------------------
+// Name: detect_memory_access
+// Desc: a probe which couldn't be run (say, fork failed) isn't cached, it is
+//       tried again next time
+//------------------------------------------------------------------------------
+MemoryAccess detect_memory_access(bool *probed) {
+
+	QSettings settings;
+	const QString key = access_key();
+
+	MemoryAccess access;
+	if(settings.value("DebuggerCore/memory_access.key").toString() == key) {
+		access.proc_mem_read_broken    = settings.value("DebuggerCore/memory_access.proc_mem_read_broken", true).toBool();
+		access.proc_mem_write_broken   = settings.value("DebuggerCore/memory_access.proc_mem_write_broken", true).toBool();
+		access.process_vm_read_broken  = settings.value("DebuggerCore/memory_access.process_vm_read_broken", true).toBool();
+		access.process_vm_write_broken = settings.value("DebuggerCore/memory_access.process_vm_write_broken", true).toBool();
+		if(probed) {
+			*probed = false;
+		}
+		return access;
+	}
+
+	const bool proc_probed = detect_proc_access(&access.proc_mem_read_broken, &access.proc_mem_write_broken);
+	const bool vm_probed   = detect_process_vm_access(&access.process_vm_read_broken, &access.process_vm_write_broken);
+
+	if(proc_probed && vm_probed) {
+		settings.setValue("DebuggerCore/memory_access.key", key);
+		settings.setValue("DebuggerCore/memory_access.proc_mem_read_broken", access.proc_mem_read_broken);
+		settings.setValue("DebuggerCore/memory_access.proc_mem_write_broken", access.proc_mem_write_broken);
+		settings.setValue("DebuggerCore/memory_access.process_vm_read_broken", access.process_vm_read_broken);
+		settings.setValue("DebuggerCore/memory_access.process_vm_write_broken", access.process_vm_write_broken);
+	} else {
+		settings.remove("DebuggerCore/memory_access.key");
+	}
+
+	if(probed) {
+		*probed = true;
+	}
+	return access;
 }
 
 }
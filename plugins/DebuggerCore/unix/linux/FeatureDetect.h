@@ -22,7 +22,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace DebuggerCorePlugin {
 namespace feature {
 
+// what detect_proc_access and detect_process_vm_access found
+struct MemoryAccess {
+	bool proc_mem_read_broken    = true;
+	bool proc_mem_write_broken   = true;
+	bool process_vm_read_broken  = true;
+	bool process_vm_write_broken = true;
+};
+
 bool detect_proc_access(bool *read_broken, bool *write_broken);
+bool detect_process_vm_access(bool *read_broken, bool *write_broken);
+bool detect_soft_dirty();
+
+// both of the probes above, each of which forks a traced child. Their
+// results only change with the kernel, a reboot or the ptrace security
+// settings, so they are kept in the settings and only probed again when one
+// of those did. <probed> is set if they had to be probed this time
+MemoryAccess detect_memory_access(bool *probed = nullptr);
 
 }
 }
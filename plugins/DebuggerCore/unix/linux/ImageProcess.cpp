@@ -0,0 +1,768 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ImageProcess.h"
+#include "IDebugger.h"
+#include "Module.h"
+#include "PlatformRegion.h"
+#include "PlatformState.h"
+#include "PrStatus.h"
+#include "State.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+#include <sys/mman.h>
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+// where the kernel puts a position independent program when address space
+// randomization is off
+const quint64 PieBase32 = 0x56555000;
+const quint64 PieBase64 = 0x555555554000;
+
+// PE section characteristics
+const quint32 ImageScnMemExecute = 0x20000000;
+const quint32 ImageScnMemRead    = 0x40000000;
+const quint32 ImageScnMemWrite   = 0x80000000;
+
+//------------------------------------------------------------------------------
+// Name: value_at
+// Desc: reads a T at <offset> of the <size> bytes at <data>, zero if it runs
+//       past the end
+//------------------------------------------------------------------------------
+template <class T>
+T value_at(const uchar *data, quint64 size, quint64 offset) {
+	T value = 0;
+	if(offset <= size && sizeof(T) <= size - offset) {
+		std::memcpy(&value, data + offset, sizeof(T));
+	}
+	return value;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: ImageThread
+// Desc:
+//------------------------------------------------------------------------------
+ImageThread::ImageThread(const ImageProcess *process) : process_(process) {
+}
+
+//------------------------------------------------------------------------------
+// Name: tid
+// Desc: there is no thread, only where one would start
+//------------------------------------------------------------------------------
+edb::tid_t ImageThread::tid() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageThread::name() const {
+	return process_->name();
+}
+
+//------------------------------------------------------------------------------
+// Name: priority
+// Desc:
+//------------------------------------------------------------------------------
+int ImageThread::priority() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: instruction_pointer
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t ImageThread::instruction_pointer() const {
+	return process_->entry_point();
+}
+
+//------------------------------------------------------------------------------
+// Name: runState
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageThread::runState() const {
+	return tr("Not Started");
+}
+
+//------------------------------------------------------------------------------
+// Name: get_state
+// Desc: every register is zero but the instruction pointer, which is at the
+//       entry point
+//------------------------------------------------------------------------------
+void ImageThread::get_state(State *state) {
+
+	if(auto state_impl = static_cast<PlatformState *>(state->writable_impl())) {
+
+		state_impl->clear();
+
+		const quint64 entry_point = process_->entry_point().toUint();
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		if(process_->is64Bit()) {
+			PrStatus_X86_64 regs;
+			std::memset(&regs, 0, sizeof(regs));
+			regs.rip = entry_point;
+			state_impl->fillFrom(regs);
+		} else {
+			PrStatus_X86 regs;
+			std::memset(&regs, 0, sizeof(regs));
+			regs.eip = static_cast<uint32_t>(entry_point);
+			state_impl->fillFrom(regs);
+		}
+
+		// nothing has set up a segment yet, they are all flat
+		for(std::size_t i = 0; i < MAX_SEG_REG_COUNT; ++i) {
+			state_impl->x86.segRegBases[i]       = 0;
+			state_impl->x86.segRegBasesFilled[i] = true;
+		}
+#elif defined(EDB_ARM32)
+		user_regs regs;
+		std::memset(&regs, 0, sizeof(regs));
+		regs.uregs[15] = entry_point;
+		state_impl->fillFrom(regs);
+#endif
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_state
+// Desc: a file which isn't run has no registers to change
+//------------------------------------------------------------------------------
+void ImageThread::set_state(const State &state) {
+	Q_UNUSED(state);
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageThread::step() {
+	return Status(tr("A file opened for analysis can't be stepped"));
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageThread::step(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return step();
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageThread::resume() {
+	return Status(tr("A file opened for analysis can't be run"));
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageThread::resume(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return resume();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageThread::stop() {
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool ImageThread::isPaused() const {
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: ImageProcess
+// Desc:
+//------------------------------------------------------------------------------
+ImageProcess::ImageProcess() : map_(nullptr), size_(0), is64_(false), entry_point_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~ImageProcess
+// Desc:
+//------------------------------------------------------------------------------
+ImageProcess::~ImageProcess() {
+	if(map_) {
+		file_.unmap(const_cast<uchar *>(map_));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: maps <filename> and reads its headers, the contents aren't touched
+//       until something reads them
+//------------------------------------------------------------------------------
+Status ImageProcess::open(const QString &filename) {
+
+	file_.setFileName(filename);
+	if(!file_.open(QIODevice::ReadOnly)) {
+		return Status(tr("Failed to open %1: %2").arg(filename, file_.errorString()));
+	}
+
+	size_ = file_.size();
+	if(size_ < EI_NIDENT) {
+		return Status(tr("%1 is neither an ELF nor a PE file").arg(filename));
+	}
+
+	map_ = file_.map(0, size_);
+	if(!map_) {
+		return Status(tr("Failed to map %1: %2").arg(filename, file_.errorString()));
+	}
+
+	Status status(Status::Ok);
+
+	if(std::memcmp(map_, ELFMAG, SELFMAG) == 0) {
+		switch(map_[EI_CLASS]) {
+		case ELFCLASS32:
+			is64_  = false;
+			status = parse_elf<Elf32_Ehdr, Elf32_Phdr>();
+			break;
+		case ELFCLASS64:
+			is64_  = true;
+			status = parse_elf<Elf64_Ehdr, Elf64_Phdr>();
+			break;
+		default:
+			return Status(tr("%1 is an ELF file of an unknown class").arg(filename));
+		}
+	} else if(map_[0] == 'M' && map_[1] == 'Z') {
+		status = parse_pe();
+	} else {
+		return Status(tr("%1 is neither an ELF nor a PE file").arg(filename));
+	}
+
+	if(!status) {
+		return status;
+	}
+
+	if(segments_.isEmpty()) {
+		return Status(tr("%1 has nothing to load").arg(filename));
+	}
+
+	std::sort(segments_.begin(), segments_.end(), [](const Segment &a, const Segment &b) {
+		return a.start < b.start;
+	});
+
+	// segments which were rounded out to whole pages can meet in the middle
+	// of one, the later one wins it as it would with mmap
+	for(int i = 1; i < segments_.size(); ++i) {
+		Segment &previous = segments_[i - 1];
+		if(previous.end > segments_[i].start) {
+			previous.end    = segments_[i].start;
+			previous.filesz = std::min(previous.filesz, previous.end - previous.start);
+		}
+	}
+
+	thread_ = std::make_shared<ImageThread>(this);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_elf
+// Desc: one segment for each PT_LOAD, a position independent file is put
+//       where it would go without address space randomization
+//------------------------------------------------------------------------------
+template <class Ehdr, class Phdr>
+Status ImageProcess::parse_elf() {
+
+	const QString filename = file_.fileName();
+
+	Ehdr header;
+	if(size_ < sizeof(header)) {
+		return Status(tr("%1 is not a complete ELF file").arg(filename));
+	}
+
+	std::memcpy(&header, map_, sizeof(header));
+
+	switch(header.e_type) {
+	case ET_EXEC:
+	case ET_DYN:
+		break;
+	case ET_CORE:
+		return Status(tr("%1 is a core file, which has to be opened as one").arg(filename));
+	default:
+		return Status(tr("%1 is an ELF file, but neither a program nor a library").arg(filename));
+	}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	const bool native = header.e_machine == (is64_ ? EM_X86_64 : EM_386);
+#elif defined(EDB_ARM32)
+	const bool native = header.e_machine == EM_ARM;
+#elif defined(EDB_ARM64)
+	const bool native = header.e_machine == EM_AARCH64;
+#else
+	const bool native = false;
+#endif
+
+	if(!native) {
+		return Status(tr("%1 is a file of another architecture").arg(filename));
+	}
+
+	if(header.e_phentsize != sizeof(Phdr) || header.e_phoff + quint64(header.e_phnum) * sizeof(Phdr) > size_) {
+		return Status(tr("%1 has a damaged program header table").arg(filename));
+	}
+
+	const quint64 base = (header.e_type == ET_DYN) ? (is64_ ? PieBase64 : PieBase32) : 0;
+
+	for(int i = 0; i < header.e_phnum; ++i) {
+		Phdr program_header;
+		std::memcpy(&program_header, map_ + header.e_phoff + i * sizeof(Phdr), sizeof(Phdr));
+
+		if(program_header.p_type == PT_LOAD && program_header.p_memsz != 0) {
+			add_segment(
+				base + program_header.p_vaddr,
+				program_header.p_memsz,
+				program_header.p_offset,
+				std::min<quint64>(program_header.p_filesz, program_header.p_memsz),
+				((program_header.p_flags & PF_R) ? PROT_READ  : 0) |
+				((program_header.p_flags & PF_W) ? PROT_WRITE : 0) |
+				((program_header.p_flags & PF_X) ? PROT_EXEC  : 0));
+		}
+	}
+
+	entry_point_ = base + header.e_entry;
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_pe
+// Desc: the headers, then one segment for each section, at the image base
+//       the file asks for
+//------------------------------------------------------------------------------
+Status ImageProcess::parse_pe() {
+
+	const QString filename = file_.fileName();
+
+	const quint64 nt_headers = value_at<quint32>(map_, size_, 0x3c);
+	if(value_at<quint32>(map_, size_, nt_headers) != 0x00004550) { // "PE\0\0"
+		return Status(tr("%1 is an MZ file, but not a PE file").arg(filename));
+	}
+
+	const quint64 file_header     = nt_headers + 4;
+	const quint16 machine         = value_at<quint16>(map_, size_, file_header);
+	const quint16 section_count   = value_at<quint16>(map_, size_, file_header + 2);
+	const quint16 optional_size   = value_at<quint16>(map_, size_, file_header + 16);
+	const quint64 optional_header = file_header + 20;
+
+	quint64 image_base;
+	switch(value_at<quint16>(map_, size_, optional_header)) {
+	case 0x10b: // PE32
+		is64_      = false;
+		image_base = value_at<quint32>(map_, size_, optional_header + 28);
+		break;
+	case 0x20b: // PE32+
+		is64_      = true;
+		image_base = value_at<quint64>(map_, size_, optional_header + 24);
+		break;
+	default:
+		return Status(tr("%1 has an optional header of an unknown kind").arg(filename));
+	}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	const bool native = machine == (is64_ ? 0x8664 : 0x14c);
+#elif defined(EDB_ARM32)
+	const bool native = machine == 0x1c0 || machine == 0x1c4;
+#else
+	const bool native = false;
+#endif
+
+	if(!native) {
+		return Status(tr("%1 is a file of another architecture").arg(filename));
+	}
+
+	const quint32 headers_size = value_at<quint32>(map_, size_, optional_header + 60);
+	add_segment(image_base, headers_size, 0, headers_size, PROT_READ);
+
+	const quint64 sections = optional_header + optional_size;
+	if(sections + quint64(section_count) * 40 > size_) {
+		return Status(tr("%1 has a damaged section table").arg(filename));
+	}
+
+	for(int i = 0; i < section_count; ++i) {
+		const quint64 section         = sections + i * 40;
+		const quint32 virtual_size    = value_at<quint32>(map_, size_, section + 8);
+		const quint32 virtual_address = value_at<quint32>(map_, size_, section + 12);
+		const quint32 raw_size        = value_at<quint32>(map_, size_, section + 16);
+		const quint32 raw_offset      = value_at<quint32>(map_, size_, section + 20);
+		const quint32 flags           = value_at<quint32>(map_, size_, section + 36);
+
+		const quint64 memory_size = virtual_size ? virtual_size : raw_size;
+		if(memory_size == 0) {
+			continue;
+		}
+
+		add_segment(
+			image_base + virtual_address,
+			memory_size,
+			raw_offset,
+			std::min<quint64>(raw_size, memory_size),
+			((flags & ImageScnMemRead)    ? PROT_READ  : 0) |
+			((flags & ImageScnMemWrite)   ? PROT_WRITE : 0) |
+			((flags & ImageScnMemExecute) ? PROT_EXEC  : 0));
+	}
+
+	entry_point_ = image_base + value_at<quint32>(map_, size_, optional_header + 16);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: add_segment
+// Desc: rounded out to whole pages like mmap would, taking the bytes of the
+//       file around it along when they line up with the pages
+//------------------------------------------------------------------------------
+void ImageProcess::add_segment(quint64 start, quint64 memsz, quint64 offset, quint64 filesz, IRegion::permissions_t permissions) {
+
+	const quint64 page_size = edb::v1::debugger_core->page_size().toUint();
+	const quint64 delta     = start & (page_size - 1);
+
+	Segment segment;
+	segment.permissions = permissions;
+	segment.end         = (start + memsz + page_size - 1) & ~(page_size - 1);
+
+	if(offset >= delta) {
+		segment.start  = start - delta;
+		segment.offset = offset - delta;
+		segment.filesz = filesz + delta;
+	} else {
+		segment.start  = start;
+		segment.offset = offset;
+		segment.filesz = filesz;
+	}
+
+	// a truncated file still has whatever made it into it
+	if(segment.offset >= size_) {
+		segment.filesz = 0;
+	} else {
+		segment.filesz = std::min(segment.filesz, size_ - segment.offset);
+	}
+
+	segments_.push_back(segment);
+}
+
+//------------------------------------------------------------------------------
+// Name: find_segment
+// Desc:
+//------------------------------------------------------------------------------
+const ImageProcess::Segment *ImageProcess::find_segment(quint64 address) const {
+
+	auto it = std::upper_bound(segments_.begin(), segments_.end(), address, [](quint64 address, const Segment &segment) {
+		return address < segment.start;
+	});
+
+	if(it == segments_.begin()) {
+		return nullptr;
+	}
+
+	--it;
+	return address < it->end ? &*it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: no system calls, just copies out of the mapping
+//------------------------------------------------------------------------------
+std::size_t ImageProcess::read_bytes(edb::address_t address, void *buf, std::size_t len) const {
+
+	auto ptr = static_cast<char *>(buf);
+	quint64 current = address.toUint();
+
+	std::size_t done = 0;
+	while(done < len) {
+		const Segment *segment = find_segment(current);
+		if(!segment) {
+			break;
+		}
+
+		const quint64 offset = current - segment->start;
+		quint64 n = std::min<quint64>(len - done, segment->end - current);
+
+		if(offset < segment->filesz) {
+			n = std::min(n, segment->filesz - offset);
+			std::memcpy(ptr + done, map_ + segment->offset + offset, n);
+		} else {
+			std::memset(ptr + done, 0, n);
+		}
+
+		done    += n;
+		current += n;
+	}
+
+	return done;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc:
+//------------------------------------------------------------------------------
+std::size_t ImageProcess::read_pages(edb::address_t address, void *buf, std::size_t count) const {
+	Q_ASSERT(buf);
+
+	const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+	return read_bytes(address, buf, count * page_size) / page_size;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_bytes
+// Desc: the file is only looked at
+//------------------------------------------------------------------------------
+std::size_t ImageProcess::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_UNUSED(address);
+	Q_UNUSED(buf);
+	Q_UNUSED(len);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: patch_bytes
+// Desc: the file is only looked at
+//------------------------------------------------------------------------------
+std::size_t ImageProcess::patch_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_UNUSED(address);
+	Q_UNUSED(buf);
+	Q_UNUSED(len);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_time
+// Desc: it was never started
+//------------------------------------------------------------------------------
+QDateTime ImageProcess::start_time() const {
+	return QDateTime();
+}
+
+//------------------------------------------------------------------------------
+// Name: arguments
+// Desc:
+//------------------------------------------------------------------------------
+QList<QByteArray> ImageProcess::arguments() const {
+	return QList<QByteArray>();
+}
+
+//------------------------------------------------------------------------------
+// Name: current_working_directory
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageProcess::current_working_directory() const {
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: executable
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageProcess::executable() const {
+	return QFileInfo(file_.fileName()).absoluteFilePath();
+}
+
+//------------------------------------------------------------------------------
+// Name: pid
+// Desc:
+//------------------------------------------------------------------------------
+edb::pid_t ImageProcess::pid() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: parent
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<IProcess> ImageProcess::parent() const {
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: code_address
+// Desc: the first executable segment
+//------------------------------------------------------------------------------
+edb::address_t ImageProcess::code_address() const {
+	for(const Segment &segment : segments_) {
+		if(segment.permissions & PROT_EXEC) {
+			return edb::address_t::fromZeroExtended(segment.start);
+		}
+	}
+
+	return entry_point();
+}
+
+//------------------------------------------------------------------------------
+// Name: data_address
+// Desc: the first writable segment
+//------------------------------------------------------------------------------
+edb::address_t ImageProcess::data_address() const {
+	for(const Segment &segment : segments_) {
+		if(segment.permissions & PROT_WRITE) {
+			return edb::address_t::fromZeroExtended(segment.start);
+		}
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: regions
+// Desc: one for each segment, named after the file
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IRegion>> ImageProcess::regions() const {
+
+	QList<std::shared_ptr<IRegion>> regions;
+
+	const QString name = executable();
+	for(const Segment &segment : segments_) {
+		regions.push_back(std::make_shared<PlatformRegion>(
+			edb::address_t::fromZeroExtended(segment.start),
+			edb::address_t::fromZeroExtended(segment.end),
+			edb::address_t::fromZeroExtended(segment.offset),
+			name,
+			segment.permissions));
+	}
+
+	return regions;
+}
+
+//------------------------------------------------------------------------------
+// Name: threads
+// Desc:
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IThread>> ImageProcess::threads() const {
+	QList<std::shared_ptr<IThread>> threads;
+	threads.push_back(thread_);
+	return threads;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_thread
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<IThread> ImageProcess::current_thread() const {
+	return thread_;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_current_thread
+// Desc: there is only the one
+//------------------------------------------------------------------------------
+void ImageProcess::set_current_thread(IThread& thread) {
+	Q_UNUSED(thread);
+}
+
+//------------------------------------------------------------------------------
+// Name: uid
+// Desc: whoever owns the file
+//------------------------------------------------------------------------------
+edb::uid_t ImageProcess::uid() const {
+	return QFileInfo(file_.fileName()).ownerId();
+}
+
+//------------------------------------------------------------------------------
+// Name: user
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageProcess::user() const {
+	return QFileInfo(file_.fileName()).owner();
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString ImageProcess::name() const {
+	return QFileInfo(file_.fileName()).fileName();
+}
+
+//------------------------------------------------------------------------------
+// Name: loaded_modules
+// Desc: just the file itself
+//------------------------------------------------------------------------------
+QList<Module> ImageProcess::loaded_modules() const {
+
+	QList<Module> modules;
+
+	Module module;
+	module.name         = executable();
+	module.base_address = edb::address_t::fromZeroExtended(segments_.isEmpty() ? 0 : segments_.front().start);
+	modules.push_back(module);
+
+	return modules;
+}
+
+//------------------------------------------------------------------------------
+// Name: pause
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageProcess::pause() {
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageProcess::resume(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return Status(tr("A file opened for analysis can't be run"));
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status ImageProcess::step(edb::EVENT_STATUS status) {
+	Q_UNUSED(status);
+	return Status(tr("A file opened for analysis can't be stepped"));
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool ImageProcess::isPaused() const {
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: patches
+// Desc:
+//------------------------------------------------------------------------------
+QMap<edb::address_t, Patch> ImageProcess::patches() const {
+	return QMap<edb::address_t, Patch>();
+}
+
+}
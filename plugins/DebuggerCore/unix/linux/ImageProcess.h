@@ -0,0 +1,153 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef IMAGE_PROCESS_20171014_H_
+#define IMAGE_PROCESS_20171014_H_
+
+#include "IProcess.h"
+#include "IRegion.h"
+#include "IThread.h"
+#include "Status.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+namespace DebuggerCorePlugin {
+
+class ImageProcess;
+
+class ImageThread : public IThread {
+	Q_DECLARE_TR_FUNCTIONS(ImageThread)
+
+public:
+	explicit ImageThread(const ImageProcess *process);
+
+private:
+	ImageThread(const ImageThread &) = delete;
+	ImageThread& operator=(const ImageThread &) = delete;
+
+public:
+	virtual edb::tid_t tid() const override;
+	virtual QString name() const override;
+	virtual int priority() const override;
+	virtual edb::address_t instruction_pointer() const override;
+	virtual QString runState() const override;
+
+public:
+	virtual void get_state(State *state) override;
+	virtual void set_state(const State &state) override;
+
+public:
+	virtual Status step() override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual Status resume() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status stop() override;
+
+public:
+	virtual bool isPaused() const override;
+
+private:
+	const ImageProcess *const process_;
+};
+
+// A program's file, laid out the way a loader would put it in memory, but
+// never run: an ELF after its PT_LOAD program headers, a PE after its
+// sections. The file is mapped, reads are copies out of the page cache and
+// the parts of segments which aren't in the file read as zeroes. Nothing but
+// the file itself is loaded, there is no interpreter, libraries or stack.
+//
+// It stands in for a process so that everything which only reads regions
+// works on a file which is never executed
+class ImageProcess : public IProcess {
+	Q_DECLARE_TR_FUNCTIONS(ImageProcess)
+
+public:
+	ImageProcess();
+	virtual ~ImageProcess() override;
+
+private:
+	ImageProcess(const ImageProcess &) = delete;
+	ImageProcess& operator=(const ImageProcess &) = delete;
+
+public:
+	Status open(const QString &filename);
+	bool is64Bit() const               { return is64_; }
+	edb::address_t entry_point() const { return edb::address_t::fromZeroExtended(entry_point_); }
+
+public:
+	virtual QDateTime                       start_time() const override;
+	virtual QList<QByteArray>               arguments() const override;
+	virtual QString                         current_working_directory() const override;
+	virtual QString                         executable() const override;
+	virtual edb::pid_t                      pid() const override;
+	virtual std::shared_ptr<IProcess>       parent() const override;
+	virtual edb::address_t                  code_address() const override;
+	virtual edb::address_t                  data_address() const override;
+	virtual QList<std::shared_ptr<IRegion>> regions() const override;
+	virtual QList<std::shared_ptr<IThread>> threads() const override;
+	virtual std::shared_ptr<IThread>        current_thread() const override;
+	virtual void                            set_current_thread(IThread& thread) override;
+	virtual edb::uid_t                      uid() const override;
+	virtual QString                         user() const override;
+	virtual QString                         name() const override;
+	virtual QList<Module>                   loaded_modules() const override;
+
+public:
+	virtual std::size_t write_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t patch_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t read_bytes(edb::address_t address, void *buf, size_t len) const override;
+	virtual std::size_t read_pages(edb::address_t address, void *buf, size_t count) const override;
+	virtual Status pause() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual bool isPaused() const override;
+	virtual QMap<edb::address_t, Patch> patches() const override;
+
+private:
+	struct Segment {
+		quint64                start;
+		quint64                end;
+		quint64                offset; // in the file
+		quint64                filesz; // how much of it is in the file
+		IRegion::permissions_t permissions;
+	};
+
+private:
+	template <class Ehdr, class Phdr>
+	Status parse_elf();
+	Status parse_pe();
+	void add_segment(quint64 start, quint64 memsz, quint64 offset, quint64 filesz, IRegion::permissions_t permissions);
+	const Segment *find_segment(quint64 address) const;
+
+private:
+	QFile                    file_;
+	const uchar             *map_;
+	quint64                  size_;
+	bool                     is64_;
+	quint64                  entry_point_;
+	QVector<Segment>         segments_; // sorted by address
+	std::shared_ptr<IThread> thread_;
+};
+
+}
+
+#endif
@@ -0,0 +1,285 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IoQueue.h"
+#include "PlatformCommon.h"
+#include "edb.h"
+
+#include <QFile>
+
+#include <algorithm>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace DebuggerCorePlugin {
+namespace {
+
+// a run of memory which covers one or more of the queued ranges, along with
+// the parts of it which could actually be read, as [begin, end) offsets
+struct Span {
+	edb::address_t                             address;
+	std::size_t                                size;
+	QByteArray                                 bytes;
+	QVector<QPair<std::size_t, std::size_t>>   readable;
+};
+
+//------------------------------------------------------------------------------
+// Name: read_span
+// Desc: reads as much of <span> as possible, an unreadable page only costs
+//       that page rather than the rest of the span
+//------------------------------------------------------------------------------
+void read_span(edb::pid_t pid, QFile &memory_file, Span &span, bool use_process_vm, bool use_proc_mem) {
+
+	static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+
+	span.bytes = QByteArray(static_cast<int>(span.size), '\0');
+
+	std::size_t offset = 0;
+	while(offset < span.size) {
+		const edb::address_t address = span.address + offset;
+		char *const buf              = span.bytes.data() + offset;
+		const std::size_t len        = span.size - offset;
+		std::size_t read             = 0;
+
+		if(use_process_vm && !(EDB_IS_32_BIT && address + len > 0xffffffffULL)) {
+			struct iovec local  = { buf, len };
+			struct iovec remote = { reinterpret_cast<void *>(address.toUint()), len };
+			read = std::max<ssize_t>(process_vm_readv(pid, &local, 1, &remote, 1, 0), 0);
+		}
+
+		// process_vm_readv stops at the first protected page, the memory
+		// file doesn't
+		if(read < len && use_proc_mem) {
+			if(memory_file.isOpen() || memory_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+				seek_addr(memory_file, address + read);
+				const qint64 n = memory_file.read(buf + read, len - read);
+				if(n > 0) {
+					read += n;
+				}
+			}
+		}
+
+		if(read != 0) {
+			span.readable.push_back(qMakePair(offset, offset + read));
+			offset += read;
+		}
+
+		// skip the page which stopped us and carry on from the next one
+		if(offset < span.size) {
+			const std::size_t skip = page_size - static_cast<std::size_t>((span.address + offset).toUint() & (page_size - 1));
+			offset += std::min(skip, span.size - offset);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: slice
+// Desc: the readable bytes of <span> which start at <address>, up to <size> of
+//       them
+//------------------------------------------------------------------------------
+QByteArray slice(const Span &span, edb::address_t address, std::size_t size) {
+
+	const auto offset = static_cast<std::size_t>((address - span.address).toUint());
+
+	for(const QPair<std::size_t, std::size_t> &part : span.readable) {
+		if(offset >= part.first && offset < part.second) {
+			const std::size_t n = std::min(size, part.second - offset);
+			return span.bytes.mid(static_cast<int>(offset), static_cast<int>(n));
+		}
+	}
+
+	return QByteArray();
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: IoQueue
+// Desc:
+//------------------------------------------------------------------------------
+IoQueue::IoQueue() {
+	start();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~IoQueue
+// Desc: whatever is still queued is answered with empty results
+//------------------------------------------------------------------------------
+IoQueue::~IoQueue() {
+	{
+		QMutexLocker locker(&lock_);
+		stopping_ = true;
+		wake_.wakeOne();
+	}
+	wait();
+}
+
+//------------------------------------------------------------------------------
+// Name: set_methods
+// Desc: which of the ways of reading work for the current debuggee, applies
+//       from the next batch on
+//------------------------------------------------------------------------------
+void IoQueue::set_methods(bool use_process_vm, bool use_proc_mem) {
+	QMutexLocker locker(&lock_);
+	use_process_vm_ = use_process_vm;
+	use_proc_mem_   = use_proc_mem;
+}
+
+//------------------------------------------------------------------------------
+// Name: submit
+// Desc: queues up reads of <ranges> in <pid>, <hidden> are the bytes to put
+//       back in the results where breakpoints have replaced them
+// Note: may be called from any thread
+//------------------------------------------------------------------------------
+QFuture<QVector<QByteArray>> IoQueue::submit(edb::pid_t pid, const QVector<MemoryRange> &ranges, const HiddenBytes &hidden) {
+
+	Request request;
+	request.pid    = pid;
+	request.ranges = ranges;
+	request.hidden = hidden;
+	request.future.reportStarted();
+
+	const QFuture<QVector<QByteArray>> future = request.future.future();
+
+	QMutexLocker locker(&lock_);
+	queue_.push_back(request);
+	wake_.wakeOne();
+	return future;
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: takes everything which has queued up since the last time around and
+//       services it one process at a time
+//------------------------------------------------------------------------------
+void IoQueue::run() {
+
+	Q_FOREVER {
+		QList<Request> batch;
+		bool use_process_vm;
+		bool use_proc_mem;
+		bool stopping;
+
+		{
+			QMutexLocker locker(&lock_);
+			while(queue_.isEmpty() && !stopping_) {
+				wake_.wait(&lock_);
+			}
+
+			batch.swap(queue_);
+			use_process_vm = use_process_vm_;
+			use_proc_mem   = use_proc_mem_;
+			stopping       = stopping_;
+		}
+
+		if(stopping) {
+			for(Request &request : batch) {
+				request.future.reportResult(QVector<QByteArray>(request.ranges.size()));
+				request.future.reportFinished();
+			}
+			return;
+		}
+
+		while(!batch.isEmpty()) {
+			const edb::pid_t pid = batch.front().pid;
+
+			QList<Request> requests;
+			for(auto it = batch.begin(); it != batch.end();) {
+				if(it->pid == pid) {
+					requests.push_back(*it);
+					it = batch.erase(it);
+				} else {
+					++it;
+				}
+			}
+
+			service(pid, requests, use_process_vm, use_proc_mem);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: service
+// Desc: the ranges of all <requests> are merged where they touch or overlap,
+//       each merged span is read once and the results are cut out of it
+//------------------------------------------------------------------------------
+void IoQueue::service(edb::pid_t pid, QList<Request> &requests, bool use_process_vm, bool use_proc_mem) const {
+
+	QVector<MemoryRange> ranges;
+	for(const Request &request : requests) {
+		for(const MemoryRange &range : request.ranges) {
+			if(range.size != 0) {
+				ranges.push_back(range);
+			}
+		}
+	}
+
+	std::sort(ranges.begin(), ranges.end(), [](const MemoryRange &lhs, const MemoryRange &rhs) {
+		return lhs.address < rhs.address;
+	});
+
+	QVector<Span> spans;
+	for(const MemoryRange &range : ranges) {
+		if(!spans.isEmpty() && range.address <= spans.back().address + spans.back().size) {
+			Span &span = spans.back();
+			span.size = std::max(span.size, static_cast<std::size_t>((range.address + range.size - span.address).toUint()));
+		} else {
+			Span span;
+			span.address = range.address;
+			span.size    = range.size;
+			spans.push_back(span);
+		}
+	}
+
+	QFile memory_file(QString("/proc/%1/mem").arg(pid));
+	for(Span &span : spans) {
+		read_span(pid, memory_file, span, use_process_vm, use_proc_mem);
+	}
+
+	for(Request &request : requests) {
+		QVector<QByteArray> results;
+		results.reserve(request.ranges.size());
+
+		for(const MemoryRange &range : request.ranges) {
+			QByteArray bytes;
+
+			if(range.size != 0) {
+				// the last span which starts at or before the range holds it
+				auto it = std::upper_bound(spans.begin(), spans.end(), range.address, [](edb::address_t address, const Span &span) {
+					return address < span.address;
+				});
+
+				bytes = slice(*(it - 1), range.address, range.size);
+			}
+
+			// and what the breakpoints hide, as it was when the read was asked for
+			auto hidden = std::lower_bound(request.hidden.begin(), request.hidden.end(), qMakePair(range.address, quint8(0)));
+			for(; hidden != request.hidden.end() && hidden->first < range.address + bytes.size(); ++hidden) {
+				bytes[static_cast<int>((hidden->first - range.address).toUint())] = static_cast<char>(hidden->second);
+			}
+
+			results.push_back(bytes);
+		}
+
+		request.future.reportResult(results);
+		request.future.reportFinished();
+	}
+}
+
+}
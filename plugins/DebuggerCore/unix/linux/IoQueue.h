@@ -0,0 +1,81 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IO_QUEUE_20171014_H_
+#define IO_QUEUE_20171014_H_
+
+#include "MemoryRange.h"
+#include "OSTypes.h"
+#include "Types.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace DebuggerCorePlugin {
+
+// The thread which services PlatformProcess::read_async. Any thread may
+// submit, the requests queue up and are drained together so that reads of
+// neighbouring memory, even from different callers, become one read.
+// Only process_vm_readv and /proc/pid/mem are used here: ptrace (and so the
+// registers) can only be issued by the thread which attached
+class IoQueue : public QThread {
+	Q_DISABLE_COPY(IoQueue)
+public:
+	IoQueue();
+	virtual ~IoQueue() override;
+
+public:
+	// what to restore in the results, as sorted (address, byte) pairs
+	using HiddenBytes = QVector<QPair<edb::address_t, quint8>>;
+
+public:
+	void set_methods(bool use_process_vm, bool use_proc_mem);
+	QFuture<QVector<QByteArray>> submit(edb::pid_t pid, const QVector<MemoryRange> &ranges, const HiddenBytes &hidden);
+
+protected:
+	virtual void run() override;
+
+private:
+	struct Request {
+		edb::pid_t                            pid;
+		QVector<MemoryRange>                  ranges;
+		HiddenBytes                           hidden;
+		QFutureInterface<QVector<QByteArray>> future;
+	};
+
+private:
+	void service(edb::pid_t pid, QList<Request> &requests, bool use_process_vm, bool use_proc_mem) const;
+
+private:
+	QMutex         lock_;
+	QWaitCondition wake_;
+	QList<Request> queue_;
+	bool           use_process_vm_ = true;
+	bool           use_proc_mem_   = true;
+	bool           stopping_       = false;
+};
+
+}
+
+#endif
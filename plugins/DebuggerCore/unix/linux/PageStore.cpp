@@ -0,0 +1,369 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PageStore.h"
+#include "TaskScheduler.h"
+#include "edb.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QObject>
+#include <cstring>
+
+namespace DebuggerCorePlugin {
+
+const char *const PageStore::NoteName = "EDB";
+
+namespace {
+
+// pages compressed together, the unit of reading them back
+const int BlockPages = 16;
+
+// uncompressed blocks kept around for reading, 4MB with 4K pages
+const int CachedBlocks = 64;
+
+const char IndexMagic[8] = { 'E', 'D', 'B', 'P', 'A', 'G', 'E', 'S' };
+const quint32 IndexVersion = 1;
+
+struct IndexHeader {
+	char    magic[8];
+	quint32 version;
+	quint32 page_size;
+};
+
+//------------------------------------------------------------------------------
+// Name: is_zero
+// Desc:
+//------------------------------------------------------------------------------
+bool is_zero(const void *page, quint32 size) {
+	auto words = static_cast<const quint64 *>(page);
+	for(quint32 i = 0; i < size / sizeof(quint64); ++i) {
+		if(words[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: PageStore
+// Desc:
+//------------------------------------------------------------------------------
+PageStore::PageStore() : mode_(Read), page_size_(0), added_(0), stored_(0), next_id_(1), max_blocks_(2), failed_(false), pack_map_(nullptr), index_map_(nullptr), pack_size_(0), records_(0), cache_(CachedBlocks) {
+	static_assert(sizeof(Record) == 40, "the index record layout is part of the file format");
+}
+
+//------------------------------------------------------------------------------
+// Name: ~PageStore
+// Desc:
+//------------------------------------------------------------------------------
+PageStore::~PageStore() {
+	close();
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: opens the store in <directory>, creating it if it is opened for
+//       writing. <page_size> has to be what the store was made with
+//------------------------------------------------------------------------------
+Status PageStore::open(const QString &directory, quint32 page_size, Mode mode) {
+
+	mode_      = mode;
+	page_size_ = page_size;
+
+	index_.setFileName(QDir(directory).filePath("snapshot-pages.index"));
+	pack_.setFileName(QDir(directory).filePath("snapshot-pages.pack"));
+
+	if(mode == Write) {
+		if(!index_.open(QIODevice::ReadWrite) || !pack_.open(QIODevice::ReadWrite)) {
+			return Status(QObject::tr("Failed to open the snapshot pages in %1: %2").arg(directory, index_.isOpen() ? pack_.errorString() : index_.errorString()));
+		}
+
+		max_blocks_ = std::max(2, edb::v1::task_scheduler().max_threads() * 2);
+	} else {
+		if(!index_.open(QIODevice::ReadOnly) || !pack_.open(QIODevice::ReadOnly)) {
+			return Status(QObject::tr("The pages of the snapshot are missing from %1: %2").arg(directory, index_.isOpen() ? pack_.errorString() : index_.errorString()));
+		}
+	}
+
+	return load_index();
+}
+
+//------------------------------------------------------------------------------
+// Name: load_index
+// Desc: a writer that was interrupted can leave records of blocks that never
+//       made it to the pack, and a partly written block. Readers ignore them,
+//       a writer cuts them off and goes on from there
+//------------------------------------------------------------------------------
+Status PageStore::load_index() {
+
+	if(index_.size() == 0 && mode_ == Write) {
+		IndexHeader header;
+		std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+		header.version   = IndexVersion;
+		header.page_size = page_size_;
+		if(index_.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)) {
+			return Status(QObject::tr("Failed to write %1: %2").arg(index_.fileName(), index_.errorString()));
+		}
+	}
+
+	IndexHeader header;
+	if(!index_.seek(0) || index_.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header) || std::memcmp(header.magic, IndexMagic, sizeof(IndexMagic)) != 0 || header.version != IndexVersion) {
+		return Status(QObject::tr("%1 is not a snapshot page index").arg(index_.fileName()));
+	}
+
+	if(header.page_size != page_size_) {
+		return Status(QObject::tr("%1 holds pages of %2 bytes, not %3").arg(index_.fileName()).arg(header.page_size).arg(page_size_));
+	}
+
+	pack_size_ = pack_.size();
+	records_   = static_cast<quint32>((index_.size() - sizeof(header)) / sizeof(Record));
+
+	if(mode_ == Read) {
+		if(records_ != 0) {
+			index_map_ = index_.map(0, sizeof(header) + quint64(records_) * sizeof(Record));
+			pack_map_  = pack_size_ ? pack_.map(0, pack_size_) : nullptr;
+			if(!index_map_ || !pack_map_) {
+				return Status(QObject::tr("Failed to map the snapshot pages: %1").arg(index_map_ ? pack_.errorString() : index_.errorString()));
+			}
+		}
+		return Status::Ok;
+	}
+
+	// the writer needs every digest to find pages it already has
+	quint32 valid    = 0;
+	quint64 pack_end = 0;
+
+	ids_.reserve(records_);
+	for(quint32 i = 0; i < records_; ++i) {
+		Record record;
+		if(index_.read(reinterpret_cast<char *>(&record), sizeof(record)) != sizeof(record) || record.block_offset + record.block_size > pack_size_) {
+			break;
+		}
+
+		ids_.insert(record.digest, i + 1);
+		pack_end = std::max(pack_end, record.block_offset + record.block_size);
+		++valid;
+	}
+
+	records_   = valid;
+	next_id_   = valid + 1;
+	pack_size_ = pack_end;
+
+	if(!index_.resize(sizeof(header) + quint64(valid) * sizeof(Record)) || !pack_.resize(pack_end) || !index_.seek(index_.size()) || !pack_.seek(pack_end)) {
+		return Status(QObject::tr("Failed to repair the snapshot pages: %1").arg(index_.errorString()));
+	}
+
+	pending_.reserve(BlockPages * page_size_);
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: close
+// Desc: a writer finishes the block it was filling and waits for the ones
+//       being compressed, the pages it handed out ids for are only readable
+//       once this is done
+//------------------------------------------------------------------------------
+Status PageStore::close() {
+
+	if(mode_ == Write && index_.isOpen()) {
+		if(!pending_digests_.isEmpty() && !submit()) {
+			failed_ = true;
+		}
+
+		while(!blocks_.empty()) {
+			if(!collect()) {
+				failed_ = true;
+			}
+		}
+
+		if(!index_.flush() || !pack_.flush()) {
+			failed_ = true;
+		}
+	}
+
+	if(index_map_) {
+		index_.unmap(const_cast<uchar *>(index_map_));
+		index_map_ = nullptr;
+	}
+
+	if(pack_map_) {
+		pack_.unmap(const_cast<uchar *>(pack_map_));
+		pack_map_ = nullptr;
+	}
+
+	const QString error = pack_.errorString();
+	index_.close();
+	pack_.close();
+
+	{
+		QMutexLocker locker(&cache_lock_);
+		cache_.clear();
+	}
+
+	if(failed_) {
+		failed_ = false;
+		return Status(QObject::tr("Failed to write the snapshot pages: %1").arg(error));
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: returns the id of the page_size() bytes at <page>, storing them if the
+//       store doesn't have them yet
+//------------------------------------------------------------------------------
+quint32 PageStore::add(const void *page) {
+	Q_ASSERT(mode_ == Write);
+
+	++added_;
+
+	if(is_zero(page, page_size_)) {
+		return 0;
+	}
+
+	const QByteArray hash = QCryptographicHash::hash(QByteArray::fromRawData(static_cast<const char *>(page), static_cast<int>(page_size_)), QCryptographicHash::Sha1);
+
+	Digest digest;
+	std::memcpy(digest.words, hash.constData(), sizeof(digest.words));
+
+	auto it = ids_.find(digest);
+	if(it != ids_.end()) {
+		return it.value();
+	}
+
+	const quint32 id = next_id_++;
+	ids_.insert(digest, id);
+
+	pending_.append(static_cast<const char *>(page), static_cast<int>(page_size_));
+	pending_digests_.push_back(digest);
+	++stored_;
+
+	if(pending_digests_.size() == BlockPages && !submit()) {
+		failed_ = true;
+	}
+
+	return id;
+}
+
+//------------------------------------------------------------------------------
+// Name: submit
+// Desc: hands the pending pages off to be compressed, waiting for the oldest
+//       block when too many are in flight already
+//------------------------------------------------------------------------------
+bool PageStore::submit() {
+
+	const QByteArray data = pending_;
+
+	Block block;
+	block.digests    = pending_digests_;
+	block.compressed = edb::v1::task_scheduler().run<QByteArray>("PageStore::compress", TaskScheduler::Search, QString(), [data](const TaskToken &) {
+		return qCompress(data, 6);
+	});
+
+	blocks_.push_back(block);
+
+	pending_.clear();
+	pending_.reserve(BlockPages * page_size_);
+	pending_digests_.clear();
+
+	while(blocks_.size() > max_blocks_) {
+		if(!collect()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: collect
+// Desc: appends the oldest block to the pack and its pages to the index,
+//       blocks go out in the order their pages were given ids
+//------------------------------------------------------------------------------
+bool PageStore::collect() {
+
+	const Block block = blocks_.front();
+	blocks_.pop_front();
+
+	const QByteArray compressed = block.compressed.result();
+	if(pack_.write(compressed) != compressed.size()) {
+		return false;
+	}
+
+	QByteArray records;
+	records.reserve(block.digests.size() * sizeof(Record));
+
+	for(int i = 0; i < block.digests.size(); ++i) {
+		Record record;
+		record.digest       = block.digests[i];
+		record.slot         = i;
+		record.block_offset = pack_size_;
+		record.block_size   = compressed.size();
+		record.reserved     = 0;
+		records.append(reinterpret_cast<const char *>(&record), sizeof(record));
+	}
+
+	pack_size_ += compressed.size();
+	records_   += block.digests.size();
+	return index_.write(records) == records.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: read
+// Desc: copies page <id> to <page>, which has room for page_size() bytes.
+//       Safe to call from several threads at once
+//------------------------------------------------------------------------------
+bool PageStore::read(quint32 id, void *page) const {
+	Q_ASSERT(mode_ == Read);
+
+	if(id == 0) {
+		std::memset(page, 0, page_size_);
+		return true;
+	}
+
+	if(id > records_ || !index_map_) {
+		return false;
+	}
+
+	Record record;
+	std::memcpy(&record, index_map_ + sizeof(IndexHeader) + quint64(id - 1) * sizeof(Record), sizeof(record));
+
+	if(record.block_offset + record.block_size > pack_size_) {
+		return false;
+	}
+
+	QMutexLocker locker(&cache_lock_);
+
+	QByteArray *block = cache_.object(record.block_offset);
+	if(!block) {
+		block = new QByteArray(qUncompress(pack_map_ + record.block_offset, static_cast<int>(record.block_size)));
+		cache_.insert(record.block_offset, block);
+	}
+
+	if(static_cast<quint64>(block->size()) < (quint64(record.slot) + 1) * page_size_) {
+		return false;
+	}
+
+	std::memcpy(page, block->constData() + quint64(record.slot) * page_size_, page_size_);
+	return true;
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PAGE_STORE_20171014_H_
+#define PAGE_STORE_20171014_H_
+
+#include "Status.h"
+#include <QByteArray>
+#include <QCache>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+#include <deque>
+
+namespace DebuggerCorePlugin {
+
+// The pages of every snapshot saved in one directory, each distinct page kept
+// once. A page is known by its SHA-1, so a page which is in several snapshots,
+// or several times in one, is stored the first time only, and zero pages are
+// never stored at all: they are page 0. New pages are compressed a block at a
+// time on the task scheduler. The index gives the block of every page, so a
+// snapshot opened later reads just the blocks it touches, out of a mapping of
+// the pack file.
+//
+// There can be one writer of a directory at a time, any number of readers
+class PageStore {
+public:
+	enum Mode {
+		Read,
+		Write
+	};
+
+	// the note of a snapshot which lists the pages of each PT_LOAD
+	static const char *const NoteName;
+	enum { PageTableNote = 0x45444250 }; // 'EDBP'
+
+public:
+	PageStore();
+	~PageStore();
+
+private:
+	PageStore(const PageStore &) = delete;
+	PageStore& operator=(const PageStore &) = delete;
+
+public:
+	Status open(const QString &directory, quint32 page_size, Mode mode);
+	Status close();
+
+public:
+	quint32 add(const void *page);
+	bool read(quint32 id, void *page) const;
+
+public:
+	quint32 page_size() const { return page_size_; }
+	quint64 pages_added() const { return added_; }
+	quint64 pages_stored() const { return stored_; }
+
+private:
+	struct Digest {
+		quint32 words[5];
+
+		bool operator==(const Digest &other) const { return std::equal(words, words + 5, other.words); }
+		friend uint qHash(const Digest &digest) { return digest.words[0]; }
+	};
+
+	// one per page in the index file, page n is record n - 1
+	struct Record {
+		Digest  digest;
+		quint32 slot;         // of the page in its block
+		quint64 block_offset; // in the pack file
+		quint32 block_size;   // compressed
+		quint32 reserved;
+	};
+
+	struct Block {
+		QFuture<QByteArray> compressed;
+		QVector<Digest>     digests;
+	};
+
+private:
+	Status load_index();
+	bool submit();
+	bool collect();
+
+private:
+	QFile                         index_;
+	QFile                         pack_;
+	Mode                          mode_;
+	quint32                       page_size_;
+	quint64                       added_;   // pages passed to add
+	quint64                       stored_;  // of those, new ones
+	quint32                       next_id_;
+	std::size_t                   max_blocks_;
+	QHash<Digest, quint32>        ids_;     // writing: every page in the store
+	QByteArray                    pending_; // writing: pages for the next block
+	QVector<Digest>               pending_digests_;
+	std::deque<Block>             blocks_;  // writing: being compressed
+	bool                          failed_;  // writing: a block couldn't be written
+	const uchar                  *pack_map_;
+	const uchar                  *index_map_;
+	quint64                       pack_size_;
+	quint32                       records_;
+	mutable QMutex                cache_lock_;
+	mutable QCache<quint64, QByteArray> cache_; // reading: uncompressed blocks by offset
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PerfBranchTrace.h"
+#include <QObject>
+#include <algorithm>
+#include <cstring>
+
+namespace DebuggerCorePlugin {
+
+//------------------------------------------------------------------------------
+// Name: PerfBranchTrace
+// Desc:
+//------------------------------------------------------------------------------
+PerfBranchTrace::PerfBranchTrace(quint64 sample_period) : sample_period_(sample_period) {
+}
+
+//------------------------------------------------------------------------------
+// Name: configure
+// Desc:
+//------------------------------------------------------------------------------
+void PerfBranchTrace::configure(perf_event_attr *attr) const {
+	attr->type               = PERF_TYPE_HARDWARE;
+	attr->config             = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+	attr->sample_period      = sample_period_;
+	attr->sample_type        = PERF_SAMPLE_TID | PERF_SAMPLE_BRANCH_STACK;
+	attr->branch_sample_type = PERF_SAMPLE_BRANCH_USER | PERF_SAMPLE_BRANCH_ANY;
+	attr->exclude_kernel     = 1;
+	attr->exclude_hv         = 1;
+}
+
+//------------------------------------------------------------------------------
+// Name: unsupported_message
+// Desc:
+//------------------------------------------------------------------------------
+QString PerfBranchTrace::unsupported_message() const {
+	return QObject::tr("This CPU has no usable branch recording hardware (LBR), this is common inside virtual machines.");
+}
+
+//------------------------------------------------------------------------------
+// Name: add_sample
+// Desc: with PERF_SAMPLE_TID | PERF_SAMPLE_BRANCH_STACK a sample is
+//       u32 pid, u32 tid, u64 nr, then nr entries with the newest first
+//------------------------------------------------------------------------------
+void PerfBranchTrace::add_sample(const quint8 *record, std::size_t size) {
+
+	quint32 ids[2];
+	quint64 count;
+
+	if(size < sizeof(ids) + sizeof(count)) {
+		return;
+	}
+
+	std::memcpy(ids, record, sizeof(ids));
+	std::memcpy(&count, record + sizeof(ids), sizeof(count));
+
+	const quint8 *entries = record + sizeof(ids) + sizeof(count);
+	if(count > (size - sizeof(ids) - sizeof(count)) / sizeof(perf_branch_entry)) {
+		return;
+	}
+
+	if(trace_.samples.size() >= MaxSamples) {
+		++trace_.lost;
+		return;
+	}
+
+	BranchSample sample;
+	sample.tid = ids[1];
+	sample.branches.reserve(static_cast<int>(count));
+
+	for(quint64 i = count; i != 0; --i) {
+		perf_branch_entry entry;
+		std::memcpy(&entry, entries + (i - 1) * sizeof(entry), sizeof(entry));
+
+		BranchRecord branch;
+		branch.from = entry.from;
+		branch.to   = entry.to;
+		sample.branches.push_back(branch);
+	}
+
+	trace_.samples.push_back(sample);
+}
+
+//------------------------------------------------------------------------------
+// Name: take
+// Desc: returns everything recorded so far and starts over
+//------------------------------------------------------------------------------
+BranchTrace PerfBranchTrace::take() {
+	drain();
+
+	BranchTrace trace;
+	std::swap(trace, trace_);
+	return trace;
+}
+
+}
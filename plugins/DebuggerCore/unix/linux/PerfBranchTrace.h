@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PERF_BRANCH_TRACE_20170705_H_
+#define PERF_BRANCH_TRACE_20170705_H_
+
+#include "BranchTrace.h"
+#include "PerfSampler.h"
+
+namespace DebuggerCorePlugin {
+
+// Samples the last branch record (LBR) stack of the debuggee's threads with
+// perf_event_open. Every <sample_period> user mode branches the kernel copies
+// the thread's branch history into a ring buffer which we drain whenever the
+// core gets the chance, so the debuggee never has to stop for it.
+class PerfBranchTrace : public PerfSampler {
+public:
+	static constexpr int MaxSamples = 0x100000;
+
+public:
+	explicit PerfBranchTrace(quint64 sample_period);
+	virtual ~PerfBranchTrace() override = default;
+
+public:
+	BranchTrace take();
+
+protected:
+	virtual void configure(perf_event_attr *attr) const override;
+	virtual void add_sample(const quint8 *record, std::size_t size) override;
+	virtual void add_lost(quint64 count) override { trace_.lost += count; }
+	virtual QString unsupported_message() const override;
+
+private:
+	quint64     sample_period_;
+	BranchTrace trace_;
+};
+
+}
+
+#endif
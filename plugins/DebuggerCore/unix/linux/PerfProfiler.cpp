@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PerfProfiler.h"
+#include <QObject>
+#include <algorithm>
+#include <cstring>
+
+namespace DebuggerCorePlugin {
+
+//------------------------------------------------------------------------------
+// Name: PerfProfiler
+// Desc:
+//------------------------------------------------------------------------------
+PerfProfiler::PerfProfiler(quint64 frequency, bool call_stacks) : frequency_(frequency), call_stacks_(call_stacks) {
+}
+
+//------------------------------------------------------------------------------
+// Name: configure
+// Desc: the task clock only runs while the thread does, so an idle thread
+//       costs nothing and a spinning one shows up in proportion
+//------------------------------------------------------------------------------
+void PerfProfiler::configure(perf_event_attr *attr) const {
+	attr->type           = PERF_TYPE_SOFTWARE;
+	attr->config         = PERF_COUNT_SW_TASK_CLOCK;
+	attr->freq           = 1;
+	attr->sample_freq    = frequency_;
+	attr->sample_type    = PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+	attr->exclude_kernel = 1;
+	attr->exclude_hv     = 1;
+
+	if(call_stacks_) {
+		attr->sample_type            |= PERF_SAMPLE_CALLCHAIN;
+		attr->exclude_callchain_kernel = 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: unsupported_message
+// Desc:
+//------------------------------------------------------------------------------
+QString PerfProfiler::unsupported_message() const {
+	return QObject::tr("This kernel does not support sampling the process with perf events.");
+}
+
+//------------------------------------------------------------------------------
+// Name: add_sample
+// Desc: with PERF_SAMPLE_IP | PERF_SAMPLE_TID [| PERF_SAMPLE_CALLCHAIN] a
+//       sample is u64 ip, u32 pid, u32 tid [, u64 nr, then nr addresses with
+//       the innermost first, mixed with PERF_CONTEXT_* markers]
+//------------------------------------------------------------------------------
+void PerfProfiler::add_sample(const quint8 *record, std::size_t size) {
+
+	quint64 ip;
+	quint32 ids[2];
+
+	if(size < sizeof(ip) + sizeof(ids)) {
+		return;
+	}
+
+	if(profile_.samples.size() >= MaxSamples) {
+		++profile_.lost;
+		return;
+	}
+
+	std::memcpy(&ip, record, sizeof(ip));
+	std::memcpy(ids, record + sizeof(ip), sizeof(ids));
+
+	ProfileSample sample;
+	sample.tid = ids[1];
+	sample.ip  = ip;
+
+	const std::size_t header = sizeof(ip) + sizeof(ids);
+	quint64 count;
+
+	if(call_stacks_ && size >= header + sizeof(count)) {
+		std::memcpy(&count, record + header, sizeof(count));
+
+		const quint8 *entries = record + header + sizeof(count);
+		count = std::min<quint64>(count, (size - header - sizeof(count)) / sizeof(quint64));
+
+		sample.callers.reserve(static_cast<int>(std::min<quint64>(count, MaxCallers)));
+
+		bool first = true;
+		for(quint64 i = 0; i < count && sample.callers.size() < MaxCallers; ++i) {
+			quint64 address;
+			std::memcpy(&address, entries + i * sizeof(address), sizeof(address));
+
+			if(address >= static_cast<quint64>(PERF_CONTEXT_MAX)) {
+				continue;
+			}
+
+			// the chain starts with the sample's own IP
+			if(!(first && address == ip)) {
+				sample.callers.push_back(address);
+			}
+			first = false;
+		}
+	}
+
+	profile_.samples.push_back(sample);
+}
+
+//------------------------------------------------------------------------------
+// Name: take
+// Desc: returns everything recorded so far and starts over
+//------------------------------------------------------------------------------
+Profile PerfProfiler::take() {
+	drain();
+
+	Profile profile;
+	std::swap(profile, profile_);
+	return profile;
+}
+
+}
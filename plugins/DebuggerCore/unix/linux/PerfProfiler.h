@@ -0,0 +1,56 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PERF_PROFILER_20171014_H_
+#define PERF_PROFILER_20171014_H_
+
+#include "PerfSampler.h"
+#include "Profile.h"
+
+namespace DebuggerCorePlugin {
+
+// Samples where the debuggee's threads are, <frequency> times a second of
+// the CPU time each of them uses, optionally with the call chain the kernel
+// finds by following the frame pointers
+class PerfProfiler : public PerfSampler {
+public:
+	static constexpr int MaxSamples  = 0x100000;
+	static constexpr int MaxCallers  = 64;
+
+public:
+	PerfProfiler(quint64 frequency, bool call_stacks);
+	virtual ~PerfProfiler() override = default;
+
+public:
+	Profile take();
+
+protected:
+	virtual void configure(perf_event_attr *attr) const override;
+	virtual void add_sample(const quint8 *record, std::size_t size) override;
+	virtual void add_lost(quint64 count) override { profile_.lost += count; }
+	virtual QString unsupported_message() const override;
+
+private:
+	quint64 frequency_;
+	bool    call_stacks_;
+	Profile profile_;
+};
+
+}
+
+#endif
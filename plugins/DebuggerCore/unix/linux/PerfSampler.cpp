@@ -0,0 +1,179 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "PerfSampler.h"
+#include <QByteArray>
+#include <QObject>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: perf_event_open
+// Desc: glibc has no wrapper for this one
+//------------------------------------------------------------------------------
+int perf_event_open(perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+	return static_cast<int>(::syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags));
+}
+
+//------------------------------------------------------------------------------
+// Name: read_ring
+// Desc: copies <len> bytes starting at <offset> out of a ring buffer of <size>
+//       bytes, records are allowed to wrap around the end
+//------------------------------------------------------------------------------
+void read_ring(const quint8 *ring, quint64 size, quint64 offset, void *dest, std::size_t len) {
+	const quint64 start = offset & (size - 1);
+	const std::size_t first = static_cast<std::size_t>(std::min<quint64>(len, size - start));
+
+	std::memcpy(dest, ring + start, first);
+	std::memcpy(static_cast<quint8 *>(dest) + first, ring, len - first);
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: PerfSampler
+// Desc:
+//------------------------------------------------------------------------------
+PerfSampler::PerfSampler() : page_size_(::sysconf(_SC_PAGESIZE)) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~PerfSampler
+// Desc:
+//------------------------------------------------------------------------------
+PerfSampler::~PerfSampler() {
+	for(const Buffer &buffer : buffers_) {
+		::munmap(buffer.map, (DataPages + 1) * page_size_);
+		::close(buffer.fd);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add_thread
+// Desc: starts sampling <tid>, new threads have to be added as they appear
+//------------------------------------------------------------------------------
+Status PerfSampler::add_thread(edb::tid_t tid) {
+
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	configure(&attr);
+
+	const int fd = perf_event_open(&attr, tid, -1, -1, 0);
+	if(fd == -1) {
+		const int error = errno;
+		switch(error) {
+		case EOPNOTSUPP:
+		case ENOENT:
+			return Status(unsupported_message());
+		case EACCES:
+		case EPERM:
+			return Status(QObject::tr("Not permitted to sample the process, see /proc/sys/kernel/perf_event_paranoid."));
+		default:
+			return Status(QObject::tr("perf_event_open failed: %1").arg(std::strerror(error)));
+		}
+	}
+
+	::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	void *const map = ::mmap(nullptr, (DataPages + 1) * page_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(map == MAP_FAILED) {
+		const int error = errno;
+		::close(fd);
+		return Status(QObject::tr("Failed to map the sample buffer: %1").arg(std::strerror(error)));
+	}
+
+	buffers_.push_back(Buffer{tid, fd, map});
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: drain
+// Desc: moves whatever the kernel has recorded so far out of the ring buffers,
+//       cheap when there is nothing, so it can be called on every poll
+//------------------------------------------------------------------------------
+void PerfSampler::drain() {
+	for(const Buffer &buffer : buffers_) {
+		drain(buffer);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: drain
+// Desc:
+//------------------------------------------------------------------------------
+void PerfSampler::drain(const Buffer &buffer) {
+
+	auto page = static_cast<perf_event_mmap_page *>(buffer.map);
+	auto ring = static_cast<const quint8 *>(buffer.map) + page_size_;
+
+	const quint64 size = DataPages * page_size_;
+	const quint64 head = __atomic_load_n(&page->data_head, __ATOMIC_ACQUIRE);
+	quint64 tail       = page->data_tail;
+
+	QByteArray record;
+
+	while(tail < head) {
+		perf_event_header header;
+		read_ring(ring, size, tail, &header, sizeof(header));
+
+		if(header.size < sizeof(header)) {
+			// shouldn't happen, but don't spin forever if it does
+			tail = head;
+			break;
+		}
+
+		record.resize(header.size);
+		read_ring(ring, size, tail, record.data(), header.size);
+
+		const quint8 *const data = reinterpret_cast<const quint8 *>(record.constData()) + sizeof(header);
+		const std::size_t data_size = header.size - sizeof(header);
+
+		switch(header.type) {
+		case PERF_RECORD_SAMPLE:
+			add_sample(data, data_size);
+			break;
+		case PERF_RECORD_LOST:
+			// u64 id, u64 lost
+			if(data_size >= 2 * sizeof(quint64)) {
+				quint64 lost;
+				std::memcpy(&lost, data + sizeof(quint64), sizeof(lost));
+				add_lost(lost);
+			}
+			break;
+		default:
+			break;
+		}
+
+		tail += header.size;
+	}
+
+	__atomic_store_n(&page->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PERF_SAMPLER_20171014_H_
+#define PERF_SAMPLER_20171014_H_
+
+#include "Status.h"
+#include "Types.h"
+#include <QVector>
+#include <linux/perf_event.h>
+
+namespace DebuggerCorePlugin {
+
+// The part of sampling with perf_event_open which doesn't depend on what is
+// sampled: a counter for every thread, each with a ring buffer the kernel
+// fills while the debuggee runs and we drain whenever the core gets the
+// chance. The kernel writes and we only read up to its head, so nothing has
+// to be locked and the debuggee never stops for it
+class PerfSampler {
+	Q_DISABLE_COPY(PerfSampler)
+public:
+	// size of each thread's ring buffer, must be a power of 2
+	static constexpr int DataPages = 64;
+
+public:
+	PerfSampler();
+	virtual ~PerfSampler();
+
+public:
+	Status add_thread(edb::tid_t tid);
+	void drain();
+
+protected:
+	// fills in the event to count and what a sample holds, the rest of
+	// <attr> is zeroed
+	virtual void configure(perf_event_attr *attr) const = 0;
+	virtual void add_sample(const quint8 *record, std::size_t size) = 0;
+	virtual void add_lost(quint64 count) = 0;
+	virtual QString unsupported_message() const = 0;
+
+private:
+	struct Buffer {
+		edb::tid_t tid;
+		int        fd;
+		void      *map;
+	};
+
+private:
+	void drain(const Buffer &buffer);
+
+private:
+	std::size_t     page_size_;
+	QVector<Buffer> buffers_;
+};
+
+}
+
+#endif
@@ -17,20 +17,106 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "PlatformCommon.h"
+#include "DebuggerCoreUNIX.h"
+#include "PlatformRegion.h"
 #include <QFile>
 #include <QTextStream>
 #include <QRegExp>
 #include <QtDebug>
+#include <QStringList>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 namespace DebuggerCorePlugin {
 
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: parse_hex
+// Desc: reads hex digits at <p> up to <end>, leaving <p> past them
+//------------------------------------------------------------------------------
+bool parse_hex(const char *&p, const char *end, quint64 *value) {
+	const char *const first = p;
+
+	quint64 n = 0;
+	for(; p != end; ++p) {
+		const char ch = *p;
+		if(ch >= '0' && ch <= '9') {
+			n = (n << 4) | (ch - '0');
+		} else if(ch >= 'a' && ch <= 'f') {
+			n = (n << 4) | (ch - 'a' + 10);
+		} else if(ch >= 'A' && ch <= 'F') {
+			n = (n << 4) | (ch - 'A' + 10);
+		} else {
+			break;
+		}
+	}
+
+	*value = n;
+	return p != first;
+}
+
+//------------------------------------------------------------------------------
+// Name: skip_field
+// Desc: past the field at <p> and the spaces after it
+//------------------------------------------------------------------------------
+void skip_field(const char *&p, const char *end) {
+	while(p != end && *p != ' ') {
+		++p;
+	}
+	while(p != end && *p == ' ') {
+		++p;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: has_key
+// Desc: true if the smaps line at <p> is "<key> ...", <key> includes the ':'
+//------------------------------------------------------------------------------
+template <std::size_t N>
+bool has_key(const char *p, const char *end, const char (&key)[N]) {
+	return static_cast<std::size_t>(end - p) >= N - 1 && std::memcmp(p, key, N - 1) == 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: smaps_size
+// Desc: the "<key>: <n> kB" line at <p> as a number of bytes
+//------------------------------------------------------------------------------
+quint64 smaps_size(const char *p, const char *end) {
+	p = static_cast<const char *>(std::memchr(p, ':', end - p));
+	if(!p) {
+		return 0;
+	}
+
+	for(++p; p != end && *p == ' '; ++p) {
+	}
+
+	quint64 n = 0;
+	for(; p != end && *p >= '0' && *p <= '9'; ++p) {
+		n = n * 10 + (*p - '0');
+	}
+
+	return n * 1024;
+}
+
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: resume_code
 // Desc:
 //------------------------------------------------------------------------------
 int resume_code(int status) {
 
+	// ptrace event stops (clone, PTRACE_INTERRUPT and so on) aren't signals
+	if(WIFSTOPPED(status) && (status >> 16) != 0) {
+		return 0;
+	}
+
 	if(WIFSTOPPED(status) && WSTOPSIG(status) == SIGSTOP) {
 		return 0;
 	}
@@ -186,4 +272,275 @@ int get_user_stat(edb::pid_t pid, struct user_stat *user_stat) {
 	return get_user_stat(QString("/proc/%1/stat").arg(pid), user_stat);
 }
 
+//------------------------------------------------------------------------------
+// Name: seek_addr
+// Desc: seeks memory file to given address, taking possible negativity of the
+// address into account
+//------------------------------------------------------------------------------
+void seek_addr(QFile& file, edb::address_t address) {
+	if(address <= UINT64_MAX/2) {
+		file.seek(address);
+	} else {
+		const int fd=file.handle();
+		// Seek in two parts to avoid specifying negative offset: off64_t is a signed type
+		const off64_t halfAddressTruncated=address>>1;
+		lseek64(fd,halfAddressTruncated,SEEK_SET);
+		const off64_t secondHalfAddress=address-halfAddressTruncated;
+		lseek64(fd,secondHalfAddress,SEEK_CUR);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: read
+// Desc: reads the maps file at <path>, returns no regions if it can't be read
+//------------------------------------------------------------------------------
+const QList<std::shared_ptr<IRegion>> &MapsParser::read(const char *path) {
+
+	const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1) {
+		return parse(QByteArray());
+	}
+
+	// the size of a /proc file is 0, so the buffer grows until a read comes
+	// up short. After the first sync it is usually big enough for one read
+	if(buffer_.capacity() < 0x10000) {
+		buffer_.reserve(0x10000);
+	}
+
+	int size = 0;
+	for(;;) {
+		if(size == buffer_.capacity()) {
+			buffer_.reserve(buffer_.capacity() * 2);
+		}
+
+		buffer_.resize(buffer_.capacity());
+		const ssize_t n = native::read(fd, buffer_.data() + size, buffer_.size() - size);
+		if(n <= 0) {
+			break;
+		}
+		size += static_cast<int>(n);
+	}
+
+	::close(fd);
+
+	buffer_.resize(size);
+	if(buffer_ == contents_ && !contents_.isEmpty()) {
+		return regions_;
+	}
+
+	// the old contents are the next read's buffer
+	contents_.swap(buffer_);
+	return parse_contents();
+}
+
+//------------------------------------------------------------------------------
+// Name: parse
+// Desc: for maps read some other way
+//------------------------------------------------------------------------------
+const QList<std::shared_ptr<IRegion>> &MapsParser::parse(const QByteArray &contents) {
+
+	if(contents == contents_ && !contents_.isEmpty()) {
+		return regions_;
+	}
+
+	contents_ = contents;
+	return parse_contents();
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_contents
+// Desc: the lines are "start-end perms offset dev inode name", the name may
+//       be missing and may have spaces in it
+//------------------------------------------------------------------------------
+const QList<std::shared_ptr<IRegion>> &MapsParser::parse_contents() {
+
+	previous_.swap(regions_);
+	regions_.clear();
+	regions_.reserve(previous_.size());
+
+	int previous = 0;
+
+	const char *p         = contents_.constData();
+	const char *const end = p + contents_.size();
+	while(p != end) {
+		const char *line_end = static_cast<const char *>(std::memchr(p, '\n', end - p));
+		if(!line_end) {
+			line_end = end;
+		}
+
+		quint64 start;
+		quint64 stop;
+		quint64 base;
+		if(parse_hex(p, line_end, &start) && p != line_end && *p++ == '-' && parse_hex(p, line_end, &stop) && p != line_end && *p++ == ' ' && line_end - p >= 4) {
+
+			int permissions = 0;
+			if(p[0] == 'r') permissions |= PROT_READ;
+			if(p[1] == 'w') permissions |= PROT_WRITE;
+			if(p[2] == 'x') permissions |= PROT_EXEC;
+
+			skip_field(p, line_end);
+			if(parse_hex(p, line_end, &base)) {
+
+				// past the offset, the device and the inode
+				skip_field(p, line_end);
+				skip_field(p, line_end);
+				skip_field(p, line_end);
+
+				regions_.push_back(region(start, stop, base, permissions, p, static_cast<int>(line_end - p), &previous));
+			}
+		}
+
+		p = line_end == end ? end : line_end + 1;
+	}
+
+	previous_.clear();
+	return regions_;
+}
+
+//------------------------------------------------------------------------------
+// Name: region
+// Desc: the region from the last parse if it is the same, both lists are in
+//       address order so <previous> only ever moves forward
+//------------------------------------------------------------------------------
+std::shared_ptr<IRegion> MapsParser::region(quint64 start, quint64 end, quint64 base, int permissions, const char *name, int name_size, int *previous) {
+
+	while(*previous < previous_.size() && previous_[*previous]->start() < start) {
+		++*previous;
+	}
+
+	const QString interned = intern(name, name_size);
+
+	if(*previous < previous_.size()) {
+		const std::shared_ptr<IRegion> &region = previous_[*previous];
+		if(region->start() == start && region->end() == end && region->base() == base && region->permissions() == static_cast<IRegion::permissions_t>(permissions) && region->name() == interned) {
+			return region;
+		}
+	}
+
+	return std::make_shared<PlatformRegion>(start, end, base, interned, permissions);
+}
+
+//------------------------------------------------------------------------------
+// Name: intern
+// Desc: looked up without copying <name>, only new names are allocated
+//------------------------------------------------------------------------------
+QString MapsParser::intern(const char *name, int size) {
+
+	if(size == 0) {
+		return QString();
+	}
+
+	auto it = names_.find(QByteArray::fromRawData(name, size));
+	if(it != names_.end()) {
+		return it.value();
+	}
+
+	const QByteArray key(name, size);
+	const QString value = QString::fromLocal8Bit(key);
+	names_.insert(key, value);
+	return value;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_smaps
+// Desc: every region starts with a maps line, which starts with a hex digit,
+//       followed by "Key: value" lines, which start with a capital. Lines are
+//       parsed as the chunks come in, only a partial one is carried over
+//------------------------------------------------------------------------------
+bool read_smaps(const char *path, const IProcess::UsageFunction &function) {
+
+	static constexpr int ChunkSize = 0x10000;
+	static constexpr int BatchSize = 256;
+
+	const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd == -1) {
+		return false;
+	}
+
+	QByteArray buffer(ChunkSize, '\0');
+	QVector<RegionUsage> batch;
+	batch.reserve(BatchSize);
+
+	RegionUsage usage   = {};
+	bool in_region      = false;
+	bool stopped        = false;
+	int size            = 0;
+
+	// the region which just ended goes into the batch
+	auto finish_region = [&]() {
+		if(in_region) {
+			batch.push_back(usage);
+			if(batch.size() == BatchSize) {
+				stopped = !function(batch);
+				batch.clear();
+			}
+		}
+	};
+
+	while(!stopped) {
+		if(size == buffer.size()) {
+			// a line longer than a chunk, only a name could be that long
+			buffer.resize(buffer.size() * 2);
+		}
+
+		const ssize_t n = native::read(fd, buffer.data() + size, buffer.size() - size);
+		const bool eof  = n <= 0;
+		if(!eof) {
+			size += static_cast<int>(n);
+		}
+
+		const char *p         = buffer.constData();
+		const char *const end = p + size;
+		while(p != end && !stopped) {
+			const char *line_end = static_cast<const char *>(std::memchr(p, '\n', end - p));
+			if(!line_end) {
+				if(!eof) {
+					break;
+				}
+				line_end = end;
+			}
+
+			const char ch = *p;
+			if((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f')) {
+				finish_region();
+
+				quint64 start;
+				in_region = parse_hex(p, line_end, &start);
+				usage = RegionUsage();
+				usage.start = start;
+			} else if(has_key(p, line_end, "Rss:")) {
+				usage.resident = smaps_size(p, line_end);
+			} else if(has_key(p, line_end, "Pss:")) {
+				usage.proportional = smaps_size(p, line_end);
+			} else if(has_key(p, line_end, "Swap:")) {
+				usage.swapped = smaps_size(p, line_end);
+			} else if(has_key(p, line_end, "Shared_Dirty:") || has_key(p, line_end, "Private_Dirty:")) {
+				usage.dirty += smaps_size(p, line_end);
+			}
+
+			p = line_end == end ? end : line_end + 1;
+		}
+
+		// what is left is the start of a line, the next read finishes it
+		const int remaining = static_cast<int>(end - p);
+		std::memmove(buffer.data(), p, remaining);
+		size = remaining;
+
+		if(eof) {
+			break;
+		}
+	}
+
+	::close(fd);
+
+	if(!stopped) {
+		finish_region();
+		if(!stopped && !batch.isEmpty()) {
+			function(batch);
+		}
+	}
+
+	return !stopped;
+}
+
 }
@@ -20,9 +20,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PLATFORM_COMMON_20151011_H_
 
 #include "edb.h"
+#include "IProcess.h"
 #include "OSTypes.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <memory>
 
-class QString;
+class IRegion;
+class QFile;
 
 namespace DebuggerCorePlugin {
 
@@ -92,6 +99,35 @@ struct user_stat {
 int get_user_stat(const QString &path, struct user_stat *user_stat);
 int get_user_stat(edb::pid_t pid, struct user_stat *user_stat);
 int resume_code(int status);
+void seek_addr(QFile &file, edb::address_t address);
+
+// Parses /proc/<pid>/maps, keeping what it can from one sync to the next:
+// the file is read into the same buffers, an unchanged file isn't parsed
+// again, a region which hasn't changed is the same object as before and the
+// names are interned, so all the regions of a module share one string
+class MapsParser {
+public:
+	const QList<std::shared_ptr<IRegion>> &read(const char *path);
+	const QList<std::shared_ptr<IRegion>> &parse(const QByteArray &contents);
+
+private:
+	const QList<std::shared_ptr<IRegion>> &parse_contents();
+	std::shared_ptr<IRegion> region(quint64 start, quint64 end, quint64 base, int permissions, const char *name, int name_size, int *previous);
+	QString intern(const char *name, int size);
+
+private:
+	QByteArray                      buffer_;   // just read
+	QByteArray                      contents_; // what regions_ was parsed from
+	QList<std::shared_ptr<IRegion>> regions_;
+	QList<std::shared_ptr<IRegion>> previous_;
+	QHash<QByteArray, QString>      names_;
+};
+
+// Streams /proc/<pid>/smaps into <function>, never holding more than a
+// chunk of the file and a batch of regions at once, even for a process with
+// tens of thousands of them. returns false if the file couldn't be read or
+// <function> asked to stop
+bool read_smaps(const char *path, const IProcess::UsageFunction &function);
 
 }
 
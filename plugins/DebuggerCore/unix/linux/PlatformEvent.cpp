@@ -317,6 +317,10 @@ IDebugEvent::REASON PlatformEvent::reason() const {
 // Name:
 //------------------------------------------------------------------------------
 IDebugEvent::TRAP_REASON PlatformEvent::trap_reason() const {
+	if(syscall_ != -1) {
+		return TRAP_SYSCALL;
+	}
+
 	switch(siginfo_.si_code) {
 	case TRAP_TRACE: return TRAP_STEPPING;
 	default:         return TRAP_BREAKPOINT;
@@ -425,4 +429,15 @@ int PlatformEvent::code() const {
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+// Name: fault_address
+//------------------------------------------------------------------------------
+edb::address_t PlatformEvent::fault_address() const {
+	if(stopped() && code() == SIGSEGV) {
+		return edb::address_t::fromZeroExtended(siginfo_.si_addr);
+	}
+
+	return edb::address_t(0);
+}
+
 }
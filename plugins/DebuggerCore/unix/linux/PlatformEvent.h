@@ -54,6 +54,9 @@ public:
 	virtual edb::pid_t process() const override;
 	virtual edb::tid_t thread() const override;
 	virtual int code() const override;
+	virtual int syscall_number() const override { return syscall_; }
+	virtual bool syscall_exit() const override  { return syscall_exit_; }
+	virtual edb::address_t fault_address() const override;
 
 private:
 	static IDebugEvent::Message createUnexpectedSignalMessage(const QString &name, int number);
@@ -63,6 +66,8 @@ private:
 	edb::pid_t pid_;
 	edb::tid_t tid_;
 	int        status_;
+	int        syscall_      = -1;
+	bool       syscall_exit_ = false;
 };
 
 }
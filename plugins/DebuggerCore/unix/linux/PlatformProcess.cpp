@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "MemoryRegions.h"
 #include "Module.h"
 #include "edb.h"
+#include "Configuration.h"
+#include "CoreWriter.h"
 #include "linker.h"
 
 #include <QDebug>
@@ -35,12 +37,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QTextStream>
 #include <QDateTime>
 
-#include <boost/functional/hash.hpp>
-#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 #include <sys/mman.h>
 #include <sys/ptrace.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <climits>
 #include <unistd.h>
 #include <pwd.h>
 #include <elf.h>
@@ -51,81 +56,21 @@ namespace {
 // Used as size of ptrace word
 #define EDB_WORDSIZE sizeof(long)
 
+// bits of a /proc/<pid>/pagemap entry, see Documentation/vm/pagemap.txt
+constexpr quint64 PagemapPresent   = Q_UINT64_C(1) << 63;
+constexpr quint64 PagemapSwapped   = Q_UINT64_C(1) << 62;
+constexpr quint64 PagemapSoftDirty = Q_UINT64_C(1) << 55;
+
 void set_ok(bool &ok, long value) {
 	ok = (value != -1) || (errno == 0);
 }
 
-QStringList split_max(const QString &str, int maxparts) {
-	int prev_idx = 0, idx = 0;
-	QStringList items;
-	for (const QChar &c : str) {
-		if (c == ' ') {
-			if (prev_idx < idx) {
-				if (items.size() < maxparts - 1)
-					items << str.mid(prev_idx, idx - prev_idx);
-				else {
-					items << str.right(str.size() - prev_idx);
-					break;
-				}
-			}
-			prev_idx = idx + 1;
-		}
-		++idx;
-	}
-	if (prev_idx < str.size() && items.size() < maxparts) {
-		items << str.right(str.size() - prev_idx);
-	}
-	return items;
-}
-
-//------------------------------------------------------------------------------
-// Name: process_map_line
-// Desc: parses the data from a line of a memory map file
-//------------------------------------------------------------------------------
-std::shared_ptr<IRegion> process_map_line(const QString &line) {
-
-	edb::address_t start;
-	edb::address_t end;
-	edb::address_t base;
-	IRegion::permissions_t permissions;
-	QString name;
-
-	const QStringList items = split_max(line, 6);
-	if(items.size() >= 3) {
-		bool ok;
-		const QStringList bounds = items[0].split("-");
-		if(bounds.size() == 2) {
-			start = edb::address_t::fromHexString(bounds[0],&ok);
-			if(ok) {
-				end = edb::address_t::fromHexString(bounds[1],&ok);
-				if(ok) {
-					base = edb::address_t::fromHexString(items[2],&ok);
-					if(ok) {
-						const QString perms = items[1];
-						permissions = 0;
-						if(perms[0] == 'r') permissions |= PROT_READ;
-						if(perms[1] == 'w') permissions |= PROT_WRITE;
-						if(perms[2] == 'x') permissions |= PROT_EXEC;
-
-						if(items.size() >= 6) {
-							name = items[5];
-						}
-
-						return std::make_shared<PlatformRegion>(start, end, base, name, permissions);
-					}
-				}
-			}
-		}
-	}
-	return nullptr;;
-}
-
 //------------------------------------------------------------------------------
 // Name:
 // Desc:
 //------------------------------------------------------------------------------
 template<class Addr>
-QList<Module> loaded_modules_(const IProcess* process, const std::unique_ptr<IBinary> &binary_info_) {
+QList<Module> loaded_modules_(const IProcess* process, const std::shared_ptr<IBinary> &binary_info_) {
 	QList<Module> ret;
 
 	if(binary_info_) {
@@ -193,7 +138,7 @@ QList<Module> loaded_modules_(const IProcess* process, const std::unique_ptr<IBi
 // Name: PlatformProcess
 // Desc:
 //------------------------------------------------------------------------------
-PlatformProcess::PlatformProcess(DebuggerCore *core, edb::pid_t pid) : core_(core), pid_(pid), ro_mem_file_(0), rw_mem_file_(0) {
+PlatformProcess::PlatformProcess(DebuggerCore *core, edb::pid_t pid) : core_(core), pid_(pid), ro_mem_file_(0), rw_mem_file_(0), pagemap_file_(0) {
 	if (!core_->proc_mem_read_broken_) {
 		QFile* memory_file = new QFile(QString("/proc/%1/mem").arg(pid_));
 		auto flags = QIODevice::ReadOnly | QIODevice::Unbuffered;
@@ -209,6 +154,13 @@ PlatformProcess::PlatformProcess(DebuggerCore *core, edb::pid_t pid) : core_(cor
 			delete memory_file;
 		}
 	}
+
+	auto pagemap_file = new QFile(QString("/proc/%1/pagemap").arg(pid_));
+	if (pagemap_file->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+		pagemap_file_ = pagemap_file;
+	} else {
+		delete pagemap_file;
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -217,26 +169,209 @@ PlatformProcess::PlatformProcess(DebuggerCore *core, edb::pid_t pid) : core_(cor
 //------------------------------------------------------------------------------
 PlatformProcess::~PlatformProcess() {
 	delete ro_mem_file_;
+	delete pagemap_file_;
 }
 
 //------------------------------------------------------------------------------
-// Name: seek_addr
-// Desc: seeks memory file to given address, taking possible negativity of the
-// address into account
+// Name: read_via_process_vm
+// Desc: reads <len> bytes into <buf> starting at <address> using
+//       process_vm_readv, returns the number of bytes read
+// Note: the remote side is split into page sized pieces so that an unreadable
+//       page results in a short read instead of a complete failure
 //------------------------------------------------------------------------------
-void seek_addr(QFile& file, edb::address_t address) {
-	if(address <= UINT64_MAX/2) {
-		file.seek(address);
-	} else {
-		const int fd=file.handle();
-		// Seek in two parts to avoid specifying negative offset: off64_t is a signed type
-		const off64_t halfAddressTruncated=address>>1;
-		lseek64(fd,halfAddressTruncated,SEEK_SET);
-		const off64_t secondHalfAddress=address-halfAddressTruncated;
-		lseek64(fd,secondHalfAddress,SEEK_CUR);
+std::size_t PlatformProcess::read_via_process_vm(edb::address_t address, char *buf, std::size_t len) const {
+
+	if (EDB_IS_32_BIT && address + len > 0xffffffffULL) {
+		// 32 bit process_vm_readv can't handle such long addresses
+		return 0;
+	}
+
+	const edb::address_t page_size = core_->page_size();
+	std::size_t read = 0;
+
+	while(read < len) {
+		struct iovec remote[IOV_MAX];
+		std::size_t chunk = 0;
+		int count         = 0;
+
+		edb::address_t current = address + read;
+		while(count < IOV_MAX && read + chunk < len) {
+			const std::size_t page_left = page_size - (current & (page_size - 1));
+			const std::size_t n         = std::min(page_left, len - read - chunk);
+
+			remote[count].iov_base = reinterpret_cast<void *>(current.toUint());
+			remote[count].iov_len  = n;
+
+			++count;
+			chunk   += n;
+			current += n;
+		}
+
+		struct iovec local;
+		local.iov_base = buf + read;
+		local.iov_len  = chunk;
+
+		const ssize_t n = process_vm_readv(pid_, &local, 1, remote, count, 0);
+		if(n <= 0) {
+			break;
+		}
+
+		read += n;
+
+		if(static_cast<std::size_t>(n) != chunk) {
+			break;
+		}
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_via_proc_mem
+// Desc: reads <len> bytes into <buf> starting at <address> using
+//       /proc/<pid>/mem, returns the number of bytes read
+//------------------------------------------------------------------------------
+std::size_t PlatformProcess::read_via_proc_mem(edb::address_t address, char *buf, std::size_t len) const {
+	Q_ASSERT(ro_mem_file_);
+
+	seek_addr(*ro_mem_file_, address);
+	const qint64 read = ro_mem_file_->read(buf, len);
+	if(read <= 0) {
+		return 0;
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_via_ptrace
+// Desc: reads <len> bytes into <buf> starting at <address> using ptrace,
+//       returns the number of bytes read
+// Note: memory is fetched a whole aligned word at a time, and the words are
+//       remembered until the debuggee next runs
+//------------------------------------------------------------------------------
+std::size_t PlatformProcess::read_via_ptrace(edb::address_t address, char *buf, std::size_t len) const {
+	std::size_t read = 0;
+
+	while(read < len) {
+		const edb::address_t current = address + read;
+		const std::size_t    offset  = current & (EDB_WORDSIZE - 1);
+		const edb::address_t aligned = current - offset;
+		const std::size_t    n       = std::min(EDB_WORDSIZE - offset, len - read);
+
+		// NOTE(eteran): aligned words never straddle a page boundary, so
+		// an unreadable next page can't make this fail
+		bool ok;
+		const long word = ptrace_peek_cached(aligned, &ok);
+		if(!ok) {
+			break;
+		}
+
+		// We aren't interested in `word` as in number, it's just a buffer, so no endianness magic.
+		std::memcpy(buf + read, reinterpret_cast<const char *>(&word) + offset, n);
+		read += n;
 	}
+
+	return read;
 }
 
+//------------------------------------------------------------------------------
+// Name: ptrace_peek_cached
+// Desc: same as ptrace_peek, but consults the per-stop word cache first
+// Note: <address> must be word aligned
+//------------------------------------------------------------------------------
+long PlatformProcess::ptrace_peek_cached(edb::address_t address, bool *ok) const {
+	Q_ASSERT(ok);
+	Q_ASSERT((address & (EDB_WORDSIZE - 1)) == 0);
+
+	// a page worth of words is plenty, anything bigger is served by the page cache
+	static constexpr int MaxCachedWords = 4096;
+
+	auto &words = core_->ptrace_words_;
+
+	auto it = words.find(address);
+	if(it != words.end()) {
+		*ok = true;
+		return it.value();
+	}
+
+	const long value = ptrace_peek(address, ok);
+	if(*ok) {
+		if(words.size() >= MaxCachedWords) {
+			words.clear();
+		}
+		words.insert(address, value);
+	}
+
+	return value;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_raw
+// Desc: reads <len> bytes into <buf> starting at <address> using the best
+//       method available, returns the number of bytes read
+// Note: does not consult the page cache or restore breakpoint bytes
+//------------------------------------------------------------------------------
+std::size_t PlatformProcess::read_raw(edb::address_t address, char *buf, std::size_t len) const {
+	std::size_t read = 0;
+
+	if(!core_->process_vm_read_broken_) {
+		read = read_via_process_vm(address, buf, len);
+	}
+
+	// process_vm_readv respects page protections, so anything it couldn't
+	// get is retried with the slower (but more permissive) methods
+	if(read < len) {
+		if(ro_mem_file_) {
+			read += read_via_proc_mem(address + read, buf + read, len - read);
+		} else {
+			read += read_via_ptrace(address + read, buf + read, len - read);
+		}
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_via_cache
+// Desc: reads <len> bytes into <buf> starting at <address>, going through the
+//       page cache, returns the number of bytes read
+//------------------------------------------------------------------------------
+std::size_t PlatformProcess::read_via_cache(edb::address_t address, char *buf, std::size_t len) const {
+
+	PageCache &cache = core_->page_cache_;
+	const edb::address_t page_size = cache.page_size();
+	std::size_t read = 0;
+
+	while(read < len) {
+		const edb::address_t current = address + read;
+		const std::size_t    offset  = current & (page_size - 1);
+		const edb::address_t page    = current - offset;
+		const std::size_t    n       = std::min<std::size_t>(page_size - offset, len - read);
+
+		const QByteArray *data = cache.find(page);
+		if(!data) {
+			QByteArray bytes(page_size, Qt::Uninitialized);
+			if(read_raw(page, bytes.data(), page_size) == page_size) {
+				data = cache.insert(page, bytes);
+			}
+		}
+
+		if(data) {
+			std::memcpy(buf + read, data->constData() + offset, n);
+			read += n;
+		} else {
+			// the page isn't entirely readable, so just get what we can
+			const std::size_t r = read_raw(current, buf + read, n);
+			read += r;
+			if(r != n) {
+				break;
+			}
+		}
+	}
+
+	return read;
+}
 
 //------------------------------------------------------------------------------
 // Name: read_bytes
@@ -256,68 +391,117 @@ std::size_t PlatformProcess::read_bytes(edb::address_t address, void* buf, std::
 
 		// small reads take the fast path
 		if(len == 1) {
-
 			auto it = core_->breakpoints_.find(address);
 			if(it != core_->breakpoints_.end()) {
 				*ptr = (*it)->original_bytes()[0];
 				return 1;
 			}
-
-			if(ro_mem_file_) {
-				seek_addr(*ro_mem_file_, address);
-				read = ro_mem_file_->read(ptr, 1);
-				if (read == 1) {
-					return 1;
-				}
-				return 0;
-			} else {
-				bool ok;
-				quint8 x = read_byte_via_ptrace(address, &ok);
-				if(ok) {
-					*ptr = x;
-					return 1;
-				}
-				return 0;
-			}
 		}
 
-		if(ro_mem_file_) {
-			seek_addr(*ro_mem_file_, address);
-			read = ro_mem_file_->read(ptr, len);
-			if(read == 0 || read == quint64(-1)) {
-				return 0;
-			}
+		if(len <= PageCache::MaxCachedRead) {
+			read = read_via_cache(address, ptr, len);
 		} else {
-			for(std::size_t index = 0; index < len; ++index) {
+			read = read_raw(address, ptr, len);
+		}
 
-				// read a byte, if we failed, we are done
-				bool ok;
-				const quint8 x = read_byte_via_ptrace(address + index, &ok);
-				if(!ok) {
-					break;
-				}
+		if(len == 1 || read == 0) {
+			return read;
+		}
 
-				// store it
-				reinterpret_cast<char*>(buf)[index] = x;
+		// replace any breakpoints
+		core_->restore_breakpoint_bytes(address, ptr, read);
+	}
+
+	return read;
+}
 
-				++read;
+//------------------------------------------------------------------------------
+// Name: read_many
+// Desc: services many reads with as few process_vm_readv calls as possible
+// Note: returns the number of bytes read for each request
+// Note: any request which could not be satisfied in full by the vectored
+//       read is retried on its own through read_bytes
+//------------------------------------------------------------------------------
+QVector<std::size_t> PlatformProcess::read_many(const QVector<ReadRequest> &requests) const {
+
+	Q_ASSERT(core_->process_ == this);
+
+	if(core_->process_vm_read_broken_) {
+		return IProcess::read_many(requests);
+	}
+
+	QVector<std::size_t> results(requests.size(), 0);
+
+	int index = 0;
+	while(index < requests.size()) {
+		struct iovec local[IOV_MAX];
+		struct iovec remote[IOV_MAX];
+		int count = 0;
+
+		while(index + count < requests.size() && count < IOV_MAX) {
+			const ReadRequest &request = requests[index + count];
+
+			if (EDB_IS_32_BIT && request.address + request.size > 0xffffffffULL) {
+				// 32 bit process_vm_readv can't handle such long addresses
+				break;
 			}
+
+			local[count].iov_base  = request.buffer;
+			local[count].iov_len   = request.size;
+			remote[count].iov_base = reinterpret_cast<void *>(request.address.toUint());
+			remote[count].iov_len  = request.size;
+			++count;
 		}
 
-		// replace any breakpoints
-		Q_FOREACH(const std::shared_ptr<IBreakpoint> &bp, core_->breakpoints_) {
-			auto*const bpBytes=bp->original_bytes();
-			const auto bpAddr=bp->address();
-			// show the original bytes in the buffer..
-			for(size_t i=0; i < bp->size(); ++i) {
-				if(bpAddr + i >= address && bpAddr + i < address + read) {
-					ptr[bpAddr + i - address] = bpBytes[i];
-				}
-			}
+		ssize_t n = 0;
+		if(count != 0) {
+			n = std::max<ssize_t>(process_vm_readv(pid_, local, count, remote, count, 0), 0);
+		}
+
+		// the data is transferred in order, so hand it out until it runs out
+		int done = 0;
+		while(done < count && n >= static_cast<ssize_t>(requests[index + done].size)) {
+			const ReadRequest &request = requests[index + done];
+			core_->restore_breakpoint_bytes(request.address, request.buffer, request.size);
+			results[index + done] = request.size;
+			n -= request.size;
+			++done;
+		}
+
+		index += done;
+
+		// whatever stopped the batch takes the slow path
+		if(done != count || count == 0) {
+			const ReadRequest &request = requests[index];
+			results[index] = read_bytes(request.address, request.buffer, request.size);
+			++index;
 		}
 	}
 
-	return read;
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_async
+// Desc: queues the reads up for the debugger core's I/O thread, so that large
+//       ones don't hold up the GUI, reads of neighbouring memory queued at
+//       about the same time are done together
+// Note: memory which only ptrace can get at comes back short
+//------------------------------------------------------------------------------
+QFuture<QVector<QByteArray>> PlatformProcess::read_async(const QVector<MemoryRange> &ranges) const {
+
+	Q_ASSERT(core_->process_ == this);
+
+	// the breakpoints may only be looked at from here
+	IoQueue::HiddenBytes hidden;
+	for(const MemoryRange &range : ranges) {
+		hidden += core_->breakpoint_bytes(range.address, range.size);
+	}
+
+	std::sort(hidden.begin(), hidden.end());
+	hidden.erase(std::unique(hidden.begin(), hidden.end()), hidden.end());
+
+	return core_->io_queue_.submit(pid_, ranges, hidden);
 }
 
 //------------------------------------------------------------------------------
@@ -334,17 +518,14 @@ std::size_t PlatformProcess::patch_bytes(edb::address_t address, const void *buf
 	Q_ASSERT(buf);
 	Q_ASSERT(core_->process_ == this);
 
-	Patch patch;
-	patch.address = address;
-	patch.orig_bytes.resize(len);
-	patch.new_bytes = QByteArray(static_cast<const char *>(buf), len);
+	QByteArray orig_bytes(static_cast<int>(len), '\0');
 
-	size_t read_ret = read_bytes(address, patch.orig_bytes.data(), len);
+	const std::size_t read_ret = read_bytes(address, orig_bytes.data(), len);
 	if(read_ret != len) {
 		return 0;
 	}
 
-	patches_.insert(address, patch);
+	patches_.record(address, orig_bytes, QByteArray(static_cast<const char *>(buf), static_cast<int>(len)));
 
 	return write_bytes(address, buf, len);
 }
@@ -360,6 +541,8 @@ std::size_t PlatformProcess::write_bytes(edb::address_t address, const void *buf
 	Q_ASSERT(core_->process_ == this);
 
 	if(len != 0) {
+		core_->invalidate_memory_caches(address, len);
+
 		if(rw_mem_file_) {
 			seek_addr(*rw_mem_file_,address);
 			written = rw_mem_file_->write(reinterpret_cast<const char *>(buf), len);
@@ -368,14 +551,118 @@ std::size_t PlatformProcess::write_bytes(edb::address_t address, const void *buf
 			}
 		}
 		else {
-			// TODO write whole words at a time using ptrace_poke.
-			for(std::size_t byteIndex=0;byteIndex<len;++byteIndex) {
-				bool ok=false;
-				write_byte_via_ptrace(address+byteIndex, *(reinterpret_cast<const char*>(buf)+byteIndex), &ok);
-				if(!ok) return written;
-				++written;
+			written = write_via_ptrace(address, reinterpret_cast<const char *>(buf), len);
+		}
+	}
+
+	return written;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_many
+// Desc: services many writes with as few process_vm_writev calls as possible
+// Note: returns the number of bytes written for each request
+// Note: process_vm_writev can't write to read-only pages (such as code), so
+//       once it fails everything left is written one at a time by write_bytes
+//------------------------------------------------------------------------------
+QVector<std::size_t> PlatformProcess::write_many(const QVector<WriteRequest> &requests) {
+
+	Q_ASSERT(core_->process_ == this);
+
+	if(core_->process_vm_write_broken_) {
+		return IProcess::write_many(requests);
+	}
+
+	QVector<std::size_t> results(requests.size(), 0);
+
+	int index = 0;
+	while(index < requests.size()) {
+		struct iovec local[IOV_MAX];
+		struct iovec remote[IOV_MAX];
+		int count = 0;
+
+		while(index + count < requests.size() && count < IOV_MAX) {
+			const WriteRequest &request = requests[index + count];
+
+			if (EDB_IS_32_BIT && request.address + request.size > 0xffffffffULL) {
+				// 32 bit process_vm_writev can't handle such long addresses
+				break;
+			}
+
+			core_->invalidate_memory_caches(request.address, request.size);
+
+			local[count].iov_base  = const_cast<void *>(request.buffer);
+			local[count].iov_len   = request.size;
+			remote[count].iov_base = reinterpret_cast<void *>(request.address.toUint());
+			remote[count].iov_len  = request.size;
+			++count;
+		}
+
+		ssize_t n = 0;
+		if(count != 0) {
+			n = std::max<ssize_t>(process_vm_writev(pid_, local, count, remote, count, 0), 0);
+		}
+
+		int done = 0;
+		while(done < count && n >= static_cast<ssize_t>(requests[index + done].size)) {
+			results[index + done] = requests[index + done].size;
+			n -= requests[index + done].size;
+			++done;
+		}
+
+		index += done;
+
+		if(done != count || count == 0) {
+			break;
+		}
+	}
+
+	// whatever is left takes the slow path
+	for(; index < requests.size(); ++index) {
+		const WriteRequest &request = requests[index];
+		results[index] = write_bytes(request.address, request.buffer, request.size);
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_via_ptrace
+// Desc: writes <len> bytes from <buf> starting at <address> using ptrace,
+//       returns the number of bytes written
+// Note: whole words are poked directly, only partially covered words at
+//       either end need to be read first
+// Note: assumes the this will not trample any breakpoints, must be handled
+//       in calling code!
+//------------------------------------------------------------------------------
+std::size_t PlatformProcess::write_via_ptrace(edb::address_t address, const char *buf, std::size_t len) {
+	std::size_t written = 0;
+
+	while(written < len) {
+		const edb::address_t current = address + written;
+		const std::size_t    offset  = current & (EDB_WORDSIZE - 1);
+		const edb::address_t aligned = current - offset;
+		const std::size_t    n       = std::min(EDB_WORDSIZE - offset, len - written);
+
+		// NOTE(eteran): aligned words never straddle a page boundary, so
+		// there is no risk of touching an unmapped neighbour here
+		long word = 0;
+		if(n != EDB_WORDSIZE) {
+			bool ok;
+			word = ptrace_peek(aligned, &ok);
+			if(!ok) {
+				break;
 			}
 		}
+
+		// We aren't interested in `word` as in number, it's just a buffer, so no endianness magic.
+		std::memcpy(reinterpret_cast<char *>(&word) + offset, buf + written, n);
+
+		if(!ptrace_poke(aligned, word)) {
+			break;
+		}
+
+		written += n;
 	}
 
 	return written;
@@ -390,7 +677,163 @@ std::size_t PlatformProcess::write_bytes(edb::address_t address, const void *buf
 std::size_t PlatformProcess::read_pages(edb::address_t address, void *buf, std::size_t count) const {
 	Q_ASSERT(buf);
 	Q_ASSERT(core_->process_ == this);
-	return read_bytes(address, buf, count * core_->page_size()) / core_->page_size();
+
+	const std::size_t page_size    = core_->page_size().toUint();
+	const QVector<quint64> pagemap = anonymous_pagemap(address, count);
+
+	if(pagemap.isEmpty()) {
+		return read_bytes(address, buf, count * page_size) / page_size;
+	}
+
+	// pages of an anonymous mapping which are neither present nor swapped out
+	// have never been touched and are known to be zero. reading them anyway
+	// would just fault them in and grow the debuggee for nothing
+	auto ptr = static_cast<char *>(buf);
+
+	std::size_t page = 0;
+	while(page < count) {
+		const bool resident = pagemap[page] & (PagemapPresent | PagemapSwapped);
+
+		std::size_t last = page + 1;
+		while(last < count && static_cast<bool>(pagemap[last] & (PagemapPresent | PagemapSwapped)) == resident) {
+			++last;
+		}
+
+		const std::size_t len = (last - page) * page_size;
+		if(resident) {
+			const std::size_t n = read_bytes(address + page * page_size, ptr + page * page_size, len);
+			if(n != len) {
+				return page + n / page_size;
+			}
+		} else {
+			std::memset(ptr + page * page_size, 0, len);
+		}
+
+		page = last;
+	}
+
+	return count;
+}
+
+//------------------------------------------------------------------------------
+// Name: changed_pages
+// Desc: uses the soft-dirty bits to find the pages of <region> which were
+//       written to since the process was last continued
+//------------------------------------------------------------------------------
+bool PlatformProcess::changed_pages(const std::shared_ptr<IRegion> &region, QVector<edb::address_t> *pages) const {
+	Q_ASSERT(region);
+	Q_ASSERT(pages);
+
+	if(!core_->soft_dirty_valid_) {
+		return false;
+	}
+
+	const edb::address_t page_size = core_->page_size();
+	const std::size_t page_count   = (region->size() / page_size).toUint();
+
+	const QVector<quint64> pagemap = read_pagemap(region->start(), page_count);
+	if(pagemap.size() != static_cast<int>(page_count)) {
+		return false;
+	}
+
+	pages->clear();
+	for(std::size_t i = 0; i < page_count; ++i) {
+		if(pagemap[i] & PagemapSoftDirty) {
+			pages->push_back(region->start() + i * page_size);
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: memory_epoch
+// Desc: changes whenever the debugger core's memory caches are invalidated,
+//       which is on every resume and every write
+//------------------------------------------------------------------------------
+quint64 PlatformProcess::memory_epoch() const {
+	return core_->memory_epoch_;
+}
+
+//------------------------------------------------------------------------------
+// Name: cached_pages
+// Desc:
+//------------------------------------------------------------------------------
+QHash<edb::address_t, QByteArray> PlatformProcess::cached_pages() const {
+	return core_->page_cache_.pages();
+}
+
+//------------------------------------------------------------------------------
+// Name: write_core
+// Desc:
+//------------------------------------------------------------------------------
+Status PlatformProcess::write_core(const QString &filename, bool compress, const std::function<bool(int)> &progress) {
+	Q_ASSERT(core_->process_ == this);
+
+	CoreWriter writer(this);
+	return writer.write(filename, compress, progress);
+}
+
+//------------------------------------------------------------------------------
+// Name: write_snapshot
+// Desc:
+//------------------------------------------------------------------------------
+Status PlatformProcess::write_snapshot(const QString &filename, const std::function<bool(int)> &progress) {
+	Q_ASSERT(core_->process_ == this);
+
+	CoreWriter writer(this);
+	return writer.write_snapshot(filename, progress);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pagemap
+// Desc: reads the /proc/<pid>/pagemap entries of <count> pages starting at
+//       <address>, returns an empty vector if they are not available
+//------------------------------------------------------------------------------
+QVector<quint64> PlatformProcess::read_pagemap(edb::address_t address, std::size_t count) const {
+
+	if(!pagemap_file_ || count == 0) {
+		return QVector<quint64>();
+	}
+
+	const edb::address_t page_size = core_->page_size();
+
+	QVector<quint64> entries(count);
+	const qint64 len = count * sizeof(quint64);
+
+	if(!pagemap_file_->seek((address / page_size).toUint() * sizeof(quint64))) {
+		return QVector<quint64>();
+	}
+
+	if(pagemap_file_->read(reinterpret_cast<char *>(entries.data()), len) != len) {
+		return QVector<quint64>();
+	}
+
+	return entries;
+}
+
+//------------------------------------------------------------------------------
+// Name: anonymous_pagemap
+// Desc: like read_pagemap, but only if all the pages belong to a private
+//       anonymous mapping. For anything else a page which is not present
+//       may still have contents (page cache, shared memory) so the entries
+//       would say nothing about what reading it returns
+//------------------------------------------------------------------------------
+QVector<quint64> PlatformProcess::anonymous_pagemap(edb::address_t address, std::size_t count) const {
+
+	const std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(address);
+	if(!region || region->end() < address + count * core_->page_size()) {
+		return QVector<quint64>();
+	}
+
+	// shared anonymous memory shows up as "/dev/zero (deleted)", so an empty
+	// name, the heap and the stacks are the only private anonymous mappings
+	const QString name = region->name();
+	if(!name.isEmpty() && name != "[heap]" && !name.startsWith("[stack")) {
+		return QVector<quint64>();
+	}
+
+	return read_pagemap(address, count);
 }
 
 //------------------------------------------------------------------------------
@@ -505,122 +948,30 @@ edb::address_t PlatformProcess::data_address() const {
 }
 
 //------------------------------------------------------------------------------
-// Name:
-// Desc:
+// Name: regions
+// Desc: the same list as last time, without parsing, if the maps haven't
+//       changed
 //------------------------------------------------------------------------------
 QList<std::shared_ptr<IRegion>> PlatformProcess::regions() const {
-	static QList<std::shared_ptr<IRegion>> regions;
-	static size_t totalHash = 0;
-
-	const QString map_file(QString("/proc/%1/maps").arg(pid_));
-
-	// hash the region file to see if it changed or not
-	{
-		std::ifstream mf(map_file.toStdString());
-		size_t newHash = 0;
-		std::string line;
-
-		while(std::getline(mf,line)) {
-			boost::hash_combine(newHash, line);
-		}
-
-		if(totalHash == newHash) {
-			return regions;
-		}
-
-		totalHash = newHash;
-		regions.clear();
-	}
-
-	// it changed, so let's process it
-	QFile file(map_file);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-
-		QTextStream in(&file);
-		QString line = in.readLine();
-
-		while(!line.isNull()) {
-			if(std::shared_ptr<IRegion> region = process_map_line(line)) {
-				regions.push_back(region);
-			}
-			line = in.readLine();
-		}
-	}
-
-	return regions;
+	char path[64];
+	std::snprintf(path, sizeof(path), "/proc/%d/maps", static_cast<int>(pid_));
+	return maps_.read(path);
 }
 
 //------------------------------------------------------------------------------
-// Name: read_byte
-// Desc: the base implementation of reading a byte
+// Name: usage_reader
+// Desc: smaps is read without ptrace, by whichever thread runs the reader.
+//       Once the process is gone the file can't be opened, so the reader
+//       just returns
 //------------------------------------------------------------------------------
-quint8 PlatformProcess::read_byte_via_ptrace(edb::address_t address, bool *ok) const {
-	// TODO(eteran): assert that we are paused
-
-	Q_ASSERT(ok);
-	Q_ASSERT(core_->process_ == this);
-
-	*ok = false;
-
-	// if this spot is unreadable, then just return 0xff, otherwise
-	// continue as normal.
-
-	// core_->page_size() - 1 will always be 0xf* because pagesizes
-	// are always 0x10*, so the masking works
-	// range of nBytesToNextPage is [1..n] where n=pagesize, and we have to adjust
-	// if nByteToNextPage < wordsize
-	const edb::address_t nBytesToNextPage = core_->page_size() - (address & (core_->page_size() - 1));
-
-	// Avoid crossing page boundary, since next page may be unreadable
-	const edb::address_t addressShift = nBytesToNextPage < EDB_WORDSIZE ? EDB_WORDSIZE - nBytesToNextPage : 0;
-	address -= addressShift;
-
-	const long value = ptrace_peek(address, ok);
-
-	if(*ok) {
-		quint8 result;
-		// We aren't interested in `value` as in number, it's just a buffer, so no endianness magic.
-		// Just have to compensate for `addressShift` when reading it.
-		std::memcpy(&result,reinterpret_cast<const char*>(&value)+addressShift,sizeof result);
-		return result;
-	}
+IProcess::UsageReader PlatformProcess::usage_reader() const {
+	char path[64];
+	std::snprintf(path, sizeof(path), "/proc/%d/smaps", static_cast<int>(pid_));
 
-	return 0xff;
-}
-
-
-//------------------------------------------------------------------------------
-// Name: write_byte
-// Desc: writes a single byte at a given address via ptrace API.
-// Note: assumes the this will not trample any breakpoints, must be handled
-//       in calling code!
-//------------------------------------------------------------------------------
-void PlatformProcess::write_byte_via_ptrace(edb::address_t address, quint8 value, bool *ok) {
-	// TODO(eteran): assert that we are paused
-
-	Q_ASSERT(ok);
-	Q_ASSERT(core_->process_ == this);
-
-	*ok = false;
-
-	// core_->page_size() - 1 will always be 0xf* because pagesizes
-	// are always 0x10*, so the masking works
-	// range of nBytesToNextPage is [1..n] where n=pagesize, and we have to adjust
-	// if nBytesToNextPage < wordsize
-	const edb::address_t nBytesToNextPage = core_->page_size() - (address & (core_->page_size() - 1));
-
-	// Avoid crossing page boundary, since next page may be inaccessible
-	const edb::address_t addressShift = nBytesToNextPage < EDB_WORDSIZE ? EDB_WORDSIZE - nBytesToNextPage : 0;
-	address -= addressShift;
-
-	long word = ptrace_peek(address, ok);
-	if(!*ok) return;
-
-	// We aren't interested in `value` as in number, it's just a buffer, so no endianness magic.
-	// Just have to compensate for `addressShift` when writing it.
-	std::memcpy(reinterpret_cast<char*>(&word)+addressShift,&value,sizeof value);
-
-	*ok = ptrace_poke(address, word);
+	const QByteArray smaps(path);
+	return [smaps](const UsageFunction &function) {
+		read_smaps(smaps.constData(), function);
+	};
 }
 
 //------------------------------------------------------------------------------
@@ -643,7 +994,7 @@ long PlatformProcess::ptrace_peek(edb::address_t address, bool *ok) const {
 	// NOTE: on some Linux systems ptrace prototype has ellipsis instead of third and fourth arguments
 	// Thus we can't just pass address as is on IA32 systems: it'd put 64 bit integer on stack and cause UB
 	auto nativeAddress=reinterpret_cast<const void* const>(address.toUint());
-	const long v = ptrace(PTRACE_PEEKTEXT, pid_, nativeAddress, 0);
+	const long v = ptrace(PTRACE_PEEKTEXT, core_->ptrace_tid(), nativeAddress, 0);
 	set_ok(*ok, v);
 	return v;
 }
@@ -664,7 +1015,7 @@ bool PlatformProcess::ptrace_poke(edb::address_t address, long value) {
 	// NOTE: on some Linux systems ptrace prototype has ellipsis instead of third and fourth arguments
 	// Thus we can't just pass address as is on IA32 systems: it'd put 64 bit integer on stack and cause UB
 	auto nativeAddress=reinterpret_cast<const void* const>(address.toUint());
-	return ptrace(PTRACE_POKETEXT, pid_, nativeAddress, value) != -1;
+	return ptrace(PTRACE_POKETEXT, core_->ptrace_tid(), nativeAddress, value) != -1;
 }
 
 //------------------------------------------------------------------------------
@@ -675,13 +1026,33 @@ QList<std::shared_ptr<IThread>> PlatformProcess::threads() const {
 
 	Q_ASSERT(core_->process_ == this);
 
-	QList<std::shared_ptr<IThread>> threadList;
+	// the list is only rebuilt once a thread has come or gone since the last
+	// call, otherwise callers just share the previous one
+	if(!core_->thread_list_valid_) {
+		core_->thread_list_.clear();
+		core_->thread_list_.reserve(core_->threads_.size());
+
+		for(auto &thread : core_->threads_) {
+			core_->thread_list_.push_back(thread);
+		}
 
-	for(auto &thread : core_->threads_) {
-		threadList.push_back(thread);
+		core_->thread_list_valid_ = true;
 	}
 
-	return threadList;
+	return core_->thread_list_;
+}
+
+//------------------------------------------------------------------------------
+// Name: for_each_thread
+// Desc: visits the threads straight from the debugger core's table
+//------------------------------------------------------------------------------
+void PlatformProcess::for_each_thread(const std::function<void(const std::shared_ptr<IThread> &)> &function) const {
+
+	Q_ASSERT(core_->process_ == this);
+
+	for(auto it = core_->threads_.cbegin(); it != core_->threads_.cend(); ++it) {
+		function(it.value());
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -792,14 +1163,24 @@ Status PlatformProcess::resume(edb::EVENT_STATUS status) {
 			if(!resumeStatus)
 				errorMessage+=QObject::tr("Failed to resume thread %1: %2\n").arg(thread->tid()).arg(resumeStatus.toString());
 
+			// in non-stop mode the other threads are stopped because of events
+			// of their own, they are resumed one at a time
+			if(edb::v1::config().non_stop_mode) {
+				return errorMessage.isEmpty() ? Status::Ok : Status("\n"+errorMessage);
+			}
+
 			// resume the other threads passing the signal they originally reported had
-			for(auto &other_thread : threads()) {
-				if(core_->waited_threads_.contains(other_thread->tid())) {
+			for(auto it = core_->threads_.cbegin(); it != core_->threads_.cend(); ++it) {
+				const std::shared_ptr<PlatformThread> &other_thread = it.value();
+				if(core_->waited_threads_.contains(other_thread->tid()) && !core_->has_pending_event(other_thread->tid())) {
 					const auto resumeStatus=other_thread->resume();
 					if(!resumeStatus)
 						errorMessage+=QObject::tr("Failed to resume thread %1: %2\n").arg(thread->tid()).arg(resumeStatus.toString());
 				}
 			}
+
+			// and the other processes being debugged along with this one
+			core_->resume_inferiors();
 		}
 	}
 	if(errorMessage.isEmpty())
@@ -829,8 +1210,8 @@ Status PlatformProcess::step(edb::EVENT_STATUS status) {
 // Desc: returns true if ALL threads are currently in the debugger's wait list
 //------------------------------------------------------------------------------
 bool PlatformProcess::isPaused() const {
-	for(auto &thread : threads()) {
-		if(!thread->isPaused()) {
+	for(auto it = core_->threads_.cbegin(); it != core_->threads_.cend(); ++it) {
+		if(!it.value()->isPaused()) {
 			return false;
 		}
 	}
@@ -843,7 +1224,60 @@ bool PlatformProcess::isPaused() const {
 // Desc: returns any patches applied to this process
 //------------------------------------------------------------------------------
 QMap<edb::address_t, Patch> PlatformProcess::patches() const {
-	return patches_;
+	return patches_.patches();
+}
+
+//------------------------------------------------------------------------------
+// Name: patches_in
+// Desc: the patches which have a byte in [address, address + size)
+//------------------------------------------------------------------------------
+QList<Patch> PlatformProcess::patches_in(edb::address_t address, std::size_t size) const {
+	return patches_.patches(address, size);
+}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+//------------------------------------------------------------------------------
+// Name: protect
+// Desc: runs mprotect in the current thread, so that it takes effect before
+//       anything else happens
+//------------------------------------------------------------------------------
+Status PlatformProcess::protect(edb::address_t address, std::size_t size, bool read, bool write, bool execute) {
+	Q_ASSERT(core_->process_ == this);
+
+	std::shared_ptr<IThread> thread = current_thread();
+	if(!thread) {
+		return Status(QObject::tr("There is no thread to change the protection with"));
+	}
+
+	const quint64 page_size = core_->page_size().toUint();
+	const quint64 first     = address.toUint() & ~(page_size - 1);
+	const quint64 last      = (address.toUint() + size + page_size - 1) & ~(page_size - 1);
+
+	long prot = PROT_NONE;
+	if(read)    prot |= PROT_READ;
+	if(write)   prot |= PROT_WRITE;
+	if(execute) prot |= PROT_EXEC;
+
+	const bool is32 = edb::v1::debuggeeIs32Bit();
+
+	const Result<edb::reg_t> ret = core_->inject_syscall(thread->tid(), is32 ? 125 : 10, { // __NR_mprotect
+		edb::reg_t::fromZeroExtended(first),
+		edb::reg_t::fromZeroExtended(last - first),
+		edb::reg_t::fromZeroExtended(prot)
+	});
+
+	if(!ret) {
+		return Status(ret.errorMessage());
+	}
+
+	// failures come back as -errno
+	const long value = is32 ? static_cast<qint32>(ret.value().toUint()) : static_cast<long>(ret.value().toUint());
+	if(value < 0 && value > -4096) {
+		return Status(QObject::tr("mprotect failed: %1").arg(strerror(-value)));
+	}
+
+	return Status::Ok;
 }
+#endif
 
 }
@@ -20,6 +20,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PLATOFORM_PROCESS_20150517_H_
 
 #include "IProcess.h"
+#include "PatchLedger.h"
+#include "PlatformCommon.h"
 #include "Status.h"
 
 #include <QFile>
@@ -29,6 +31,7 @@ namespace DebuggerCorePlugin {
 class DebuggerCore;
 
 class PlatformProcess : public IProcess {
+	friend class CoreWriter;
 	friend class PlatformThread;
 public:
 	PlatformProcess(DebuggerCore *core, edb::pid_t pid);
@@ -49,6 +52,7 @@ public:
 	virtual edb::address_t                  data_address() const override;
 	virtual QList<std::shared_ptr<IRegion>> regions() const override;
 	virtual QList<std::shared_ptr<IThread>> threads() const override;
+	virtual void for_each_thread(const std::function<void(const std::shared_ptr<IThread> &)> &function) const override;
 	virtual std::shared_ptr<IThread>        current_thread() const override;
 	virtual void                            set_current_thread(IThread& thread) override;
 	virtual edb::uid_t                      uid() const override;
@@ -68,19 +72,41 @@ public:
 	virtual std::size_t read_bytes(edb::address_t address, void *buf, size_t len) const override;
 	virtual std::size_t read_pages(edb::address_t address, void *buf, size_t count) const override;
 	virtual QMap<edb::address_t, Patch> patches() const override;
+	virtual QList<Patch> patches_in(edb::address_t address, std::size_t size) const override;
+	virtual QVector<std::size_t> read_many(const QVector<ReadRequest> &requests) const override;
+	virtual QFuture<QVector<QByteArray>> read_async(const QVector<MemoryRange> &ranges) const override;
+	virtual QVector<std::size_t> write_many(const QVector<WriteRequest> &requests) override;
+	virtual bool changed_pages(const std::shared_ptr<IRegion> &region, QVector<edb::address_t> *pages) const override;
+	virtual quint64 memory_epoch() const override;
+	virtual QHash<edb::address_t, QByteArray> cached_pages() const override;
+	virtual Status write_core(const QString &filename, bool compress, const std::function<bool(int)> &progress) override;
+	virtual Status write_snapshot(const QString &filename, const std::function<bool(int)> &progress) override;
+	virtual UsageReader usage_reader() const override;
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	virtual Status protect(edb::address_t address, std::size_t size, bool read, bool write, bool execute) override;
+#endif
 
 private:
 	bool ptrace_poke(edb::address_t address, long value);
 	long ptrace_peek(edb::address_t address, bool *ok) const;
-	quint8 read_byte_via_ptrace(edb::address_t address, bool *ok) const;
-	void write_byte_via_ptrace(edb::address_t address, quint8 value, bool *ok);
+	long ptrace_peek_cached(edb::address_t address, bool *ok) const;
+	std::size_t read_raw(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t read_via_cache(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t read_via_process_vm(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t read_via_proc_mem(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t read_via_ptrace(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t write_via_ptrace(edb::address_t address, const char *buf, std::size_t len);
+	QVector<quint64> read_pagemap(edb::address_t address, std::size_t count) const;
+	QVector<quint64> anonymous_pagemap(edb::address_t address, std::size_t count) const;
 
 private:
 	DebuggerCore*               core_;
 	edb::pid_t                  pid_;
 	QFile*                      ro_mem_file_;
 	QFile*                      rw_mem_file_;
-	QMap<edb::address_t, Patch> patches_;
+	QFile*                      pagemap_file_;
+	PatchLedger                 patches_;
+	mutable MapsParser          maps_;
 };
 
 }
@@ -34,7 +34,7 @@ namespace DebuggerCorePlugin {
 // Name: PlatformThread
 // Desc:
 //------------------------------------------------------------------------------
-PlatformThread::PlatformThread(DebuggerCore *core, IProcess *process, edb::tid_t tid) : core_(core), process_(process), tid_(tid) {
+PlatformThread::PlatformThread(DebuggerCore *core, IProcess *process, edb::tid_t tid) : core_(core), process_(process), tid_(tid), state_cache_hits_(0), state_generation_(0) {
 	assert(process);
 	assert(core);
 }
@@ -146,6 +146,17 @@ QString PlatformThread::runState() const  {
 	return tr("Unknown");
 }
 
+//------------------------------------------------------------------------------
+// Name: invalidate_state_cache
+// Desc: forgets the registers fetched by get_state and anything which could
+//       still fetch more of them, must be done before the thread is allowed
+//       to run
+//------------------------------------------------------------------------------
+void PlatformThread::invalidate_state_cache() {
+	state_cache_.reset();
+	++state_generation_;
+}
+
 //------------------------------------------------------------------------------
 // Name: resume
 // Desc: resumes this thread, passing the signal that stopped it
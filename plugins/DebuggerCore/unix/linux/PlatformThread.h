@@ -21,8 +21,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "IThread.h"
 #include "IBreakpoint.h"
+#include "IDebugger.h"
+#include "IState.h"
+#include <array>
+#include <functional>
 #include <memory>
 #include <QCoreApplication>
+#include <QHash>
 
 class IProcess;
 
@@ -31,6 +36,26 @@ namespace DebuggerCorePlugin {
 class DebuggerCore;
 class PlatformState;
 
+#if defined EDB_ARM32 || defined EDB_ARM64
+// what stepping the instruction at an address comes down to, as far as
+// its bytes tell. Only good while the same bytes are still there
+struct StepSuccessor {
+	enum class Kind {
+		Next,     // doesn't touch the PC
+		Branch,   // goes to <target> when its condition passes
+		Computed  // the destination depends on registers or memory
+	};
+
+	std::array<quint8, 4> bytes;
+	int                   size;
+	IDebugger::CPUMode    mode;
+	Kind                  kind;
+	int                   condition;
+	edb::address_t        target;
+	IDebugger::CPUMode    targetMode;
+};
+#endif
+
 class PlatformThread : public IThread {
 	Q_DECLARE_TR_FUNCTIONS(PlatformThread)
 	friend class DebuggerCore;
@@ -67,9 +92,22 @@ public:
 	virtual Status resume(edb::EVENT_STATUS status) override;
 	virtual Status stop() override;
 
+#if defined(EDB_X86) || defined(EDB_X86_64)
+public:
+	virtual bool supports_block_step() const override { return true; }
+	virtual Status step_block(edb::EVENT_STATUS status) override;
+
+public:
+	virtual DebugRegisters get_debug_registers() override;
+	virtual void set_debug_registers(const DebugRegisters &regs) override;
+#endif
+
 public:
 	virtual bool isPaused() const override;
 
+public:
+	quint64 state_cache_hits() const { return state_cache_hits_; }
+
 private:
 	void fillSegmentBases(PlatformState* state);
 	bool fillStateFromPrStatus(PlatformState* state);
@@ -77,10 +115,16 @@ private:
 #ifdef EDB_ARM32
 	bool fillStateFromVFPRegs(PlatformState* state);
 #endif
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	void fillExtendedState(PlatformState* state);
+	void fillDebugRegisters(PlatformState* state);
+	std::function<void(PlatformState *)> make_loader(void (PlatformThread::*fill)(PlatformState *));
+#endif
 
 private:
 	unsigned long get_debug_register(std::size_t n);
 	long set_debug_register(std::size_t n, long value);
+	void invalidate_state_cache();
 
 private:
 	DebuggerCore *const core_;
@@ -88,11 +132,21 @@ private:
 	edb::tid_t          tid_;
 	int                 status_;
 	SignalStatus        signal_status_;
+	bool                syscall_entered_ = false; // between the entry and exit stops of PTRACE_SYSCALL
+	int                 syscall_number_  = -1;    // what was entered, for the statistics
+	quint64             syscall_started_ = 0;     // and when, in nanoseconds
+
+	// the registers fetched at the current stop, a stopped thread's state
+	// can only change through us, so this is good until it runs again
+	std::shared_ptr<IState> state_cache_;
+	quint64                 state_cache_hits_;
+	quint64                 state_generation_; // bumped whenever the thread runs
 
 #if defined EDB_ARM32 || defined EDB_ARM64
 private:
 	Status doStep(edb::tid_t tid, long status);
 	std::shared_ptr<IBreakpoint> singleStepBreakpoint;
+	QHash<edb::address_t, StepSuccessor> stepSuccessors_; // by the address they were decoded at
 #endif
 };
 
@@ -0,0 +1,1588 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RemoteProcess.h"
+#include "DebuggerCore.h"
+#include "Module.h"
+#include "PlatformCommon.h"
+#include "PlatformRegion.h"
+#include "PlatformState.h"
+#include "PrStatus.h"
+#include "State.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <QtDebug>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <sys/mman.h>
+
+namespace DebuggerCorePlugin {
+
+namespace {
+
+// the protocol numbers signals the way the original Unix did, these are the
+// ones which differ from Linux's, in GDB's order starting from 1
+const int GdbSignals[] = {
+	SIGHUP,  SIGINT,  SIGQUIT, SIGILL,    SIGTRAP,   SIGABRT, 0 /* EMT */, SIGFPE,
+	SIGKILL, SIGBUS,  SIGSEGV, SIGSYS,    SIGPIPE,   SIGALRM, SIGTERM,     SIGURG,
+	SIGSTOP, SIGTSTP, SIGCONT, SIGCHLD,   SIGTTIN,   SIGTTOU, SIGIO,       SIGXCPU,
+	SIGXFSZ, SIGVTALRM, SIGPROF, SIGWINCH, 0 /* LOST */, SIGUSR1, SIGUSR2, SIGPWR,
+};
+
+//------------------------------------------------------------------------------
+// Name: host_signal
+// Desc:
+//------------------------------------------------------------------------------
+int host_signal(int gdb_signal) {
+	if(gdb_signal > 0 && gdb_signal <= static_cast<int>(sizeof(GdbSignals) / sizeof(GdbSignals[0])) && GdbSignals[gdb_signal - 1]) {
+		return GdbSignals[gdb_signal - 1];
+	}
+	return gdb_signal;
+}
+
+//------------------------------------------------------------------------------
+// Name: gdb_signal
+// Desc:
+//------------------------------------------------------------------------------
+int gdb_signal(int host_signal) {
+	for(std::size_t i = 0; i < sizeof(GdbSignals) / sizeof(GdbSignals[0]); ++i) {
+		if(GdbSignals[i] == host_signal) {
+			return static_cast<int>(i + 1);
+		}
+	}
+	return host_signal;
+}
+
+//------------------------------------------------------------------------------
+// Name: hex
+// Desc: numbers in packets are unpadded lower case hex
+//------------------------------------------------------------------------------
+QByteArray hex(quint64 value) {
+	return QByteArray::number(value, 16);
+}
+
+//------------------------------------------------------------------------------
+// Name: process_id
+// Desc: the pid of a "p<pid>.<tid>" thread id, zero if it has none
+//------------------------------------------------------------------------------
+edb::pid_t process_id(const QByteArray &id) {
+	if(!id.startsWith('p')) {
+		return 0;
+	}
+
+	const int dot = id.indexOf('.');
+	const edb::pid_t pid = id.mid(1, dot == -1 ? -1 : dot - 1).toInt(nullptr, 16);
+	return pid > 0 ? pid : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: from_hex
+// Desc: registers the stub can't get at are sent as 'x's, they read as zero
+//------------------------------------------------------------------------------
+QByteArray from_hex(QByteArray data) {
+	data.replace('x', '0');
+	return QByteArray::fromHex(data);
+}
+
+//------------------------------------------------------------------------------
+// Name: get_value
+// Desc: a little endian value of <size> bytes at <offset> of <data>
+//------------------------------------------------------------------------------
+template <class T>
+void get_value(const QByteArray &data, int offset, int size, T *value) {
+	quint64 v = 0;
+	if(offset + size <= data.size()) {
+		std::memcpy(&v, data.constData() + offset, std::min<std::size_t>(size, sizeof(v)));
+	}
+	*value = static_cast<T>(v);
+}
+
+//------------------------------------------------------------------------------
+// Name: put_value
+// Desc:
+//------------------------------------------------------------------------------
+template <class T>
+void put_value(QByteArray *data, int offset, int size, T value) {
+	const quint64 v = static_cast<quint64>(value);
+	if(offset + size <= data->size()) {
+		std::memcpy(data->data() + offset, &v, std::min<std::size_t>(size, sizeof(v)));
+	}
+}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+
+// where the x87 and SSE registers are in a 'g' packet, they come right after
+// the general purpose and segment registers for both architectures
+struct FPLayout {
+	int st;        // st0-st7, 10 bytes each
+	int control;   // fctrl fstat ftag fiseg fioff foseg fooff fop, 4 bytes each
+	int xmm;
+	int xmm_count;
+	int mxcsr;
+};
+
+const FPLayout AMD64Layout = { 164, 244, 276, 16, 532 };
+const FPLayout I386Layout  = {  64, 144, 176,  8, 304 };
+
+// the order of the registers in an amd64 'g' packet, the first 17 are 8 bytes
+// and the rest 4
+uint64_t PrStatus_X86_64::*const AMD64Registers[] = {
+	&PrStatus_X86_64::rax, &PrStatus_X86_64::rbx, &PrStatus_X86_64::rcx,    &PrStatus_X86_64::rdx,
+	&PrStatus_X86_64::rsi, &PrStatus_X86_64::rdi, &PrStatus_X86_64::rbp,    &PrStatus_X86_64::rsp,
+	&PrStatus_X86_64::r8,  &PrStatus_X86_64::r9,  &PrStatus_X86_64::r10,    &PrStatus_X86_64::r11,
+	&PrStatus_X86_64::r12, &PrStatus_X86_64::r13, &PrStatus_X86_64::r14,    &PrStatus_X86_64::r15,
+	&PrStatus_X86_64::rip, &PrStatus_X86_64::rflags,
+	&PrStatus_X86_64::cs,  &PrStatus_X86_64::ss,  &PrStatus_X86_64::ds,     &PrStatus_X86_64::es,
+	&PrStatus_X86_64::fs,  &PrStatus_X86_64::gs,
+};
+
+// and in an i386 one, all 4 bytes
+typedef decltype(UserRegsStructX86::eax) UserRegsStructX86::*I386Register;
+const I386Register I386Registers[] = {
+	&UserRegsStructX86::eax, &UserRegsStructX86::ecx, &UserRegsStructX86::edx,    &UserRegsStructX86::ebx,
+	&UserRegsStructX86::esp, &UserRegsStructX86::ebp, &UserRegsStructX86::esi,    &UserRegsStructX86::edi,
+	&UserRegsStructX86::eip, &UserRegsStructX86::eflags,
+	&UserRegsStructX86::xcs, &UserRegsStructX86::xss, &UserRegsStructX86::xds,    &UserRegsStructX86::xes,
+	&UserRegsStructX86::xfs, &UserRegsStructX86::xgs,
+};
+
+constexpr int AMD64WideRegisters = 17;
+constexpr int AMD64PC = 16;
+constexpr int AMD64SP = 7;
+constexpr int I386PC  = 8;
+constexpr int I386SP  = 4;
+
+//------------------------------------------------------------------------------
+// Name: amd64_offset
+// Desc: where register <n> is in an amd64 'g' packet
+//------------------------------------------------------------------------------
+int amd64_offset(int n) {
+	return n < AMD64WideRegisters ? n * 8 : AMD64WideRegisters * 8 + (n - AMD64WideRegisters) * 4;
+}
+
+//------------------------------------------------------------------------------
+// Name: get_fp_state
+// Desc: the FPU part of a 'g' packet in the form of an XSAVE area, ftag is
+//       sent in full and has to be abridged the way FXSAVE does it
+//------------------------------------------------------------------------------
+bool get_fp_state(const QByteArray &g, const FPLayout &layout, X86XState *xstate) {
+
+	if(g.size() < layout.mxcsr + 4) {
+		return false;
+	}
+
+	std::memset(xstate, 0, sizeof(*xstate));
+
+	for(int i = 0; i < 8; ++i) {
+		std::memcpy(xstate->st_space + 16 * i, g.constData() + layout.st + 10 * i, 10);
+	}
+
+	quint32 ftag;
+	get_value(g, layout.control + 0 * 4, 4, &xstate->cwd);
+	get_value(g, layout.control + 1 * 4, 4, &xstate->swd);
+	get_value(g, layout.control + 2 * 4, 4, &ftag);
+	get_value(g, layout.control + 3 * 4, 4, &xstate->fiseg);
+	get_value(g, layout.control + 4 * 4, 4, &xstate->fioff);
+	get_value(g, layout.control + 5 * 4, 4, &xstate->foseg);
+	get_value(g, layout.control + 6 * 4, 4, &xstate->fooff);
+	get_value(g, layout.control + 7 * 4, 4, &xstate->fop);
+
+	xstate->twd = 0;
+	for(int i = 0; i < 8; ++i) {
+		if(((ftag >> (2 * i)) & 3) != 3) {
+			xstate->twd |= 1 << i;
+		}
+	}
+
+	std::memcpy(xstate->xmm_space, g.constData() + layout.xmm, 16 * layout.xmm_count);
+	get_value(g, layout.mxcsr, 4, &xstate->mxcsr);
+	xstate->mxcsr_mask = 0xffff;
+
+	xstate->xcr0      = X86XState::FEATURE_X87 | X86XState::FEATURE_SSE;
+	xstate->xstate_bv = X86XState::FEATURE_X87 | X86XState::FEATURE_SSE;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: put_fp_state
+// Desc: the reverse of get_fp_state, an abridged tag only says which
+//       registers are empty, the stub works the rest out from the values
+//------------------------------------------------------------------------------
+void put_fp_state(const X86XState &xstate, const FPLayout &layout, QByteArray *g) {
+
+	if(g->size() < layout.mxcsr + 4) {
+		return;
+	}
+
+	if(xstate.xstate_bv & X86XState::FEATURE_X87) {
+		for(int i = 0; i < 8; ++i) {
+			std::memcpy(g->data() + layout.st + 10 * i, xstate.st_space + 16 * i, 10);
+		}
+
+		quint32 ftag = 0;
+		for(int i = 0; i < 8; ++i) {
+			if(!(xstate.twd & (1 << i))) {
+				ftag |= 3 << (2 * i);
+			}
+		}
+
+		put_value(g, layout.control + 0 * 4, 4, xstate.cwd);
+		put_value(g, layout.control + 1 * 4, 4, xstate.swd);
+		put_value(g, layout.control + 2 * 4, 4, ftag);
+		put_value(g, layout.control + 3 * 4, 4, xstate.fiseg);
+		put_value(g, layout.control + 4 * 4, 4, xstate.fioff);
+		put_value(g, layout.control + 5 * 4, 4, xstate.foseg);
+		put_value(g, layout.control + 6 * 4, 4, xstate.fooff);
+		put_value(g, layout.control + 7 * 4, 4, xstate.fop);
+	}
+
+	if(xstate.xstate_bv & X86XState::FEATURE_SSE) {
+		std::memcpy(g->data() + layout.xmm, xstate.xmm_space, 16 * layout.xmm_count);
+		put_value(g, layout.mxcsr, 4, xstate.mxcsr);
+	}
+}
+#endif
+
+}
+
+//------------------------------------------------------------------------------
+// Name: RemoteThread
+// Desc:
+//------------------------------------------------------------------------------
+RemoteThread::RemoteThread(RemoteProcess *process, edb::tid_t tid, const QString &name) : process_(process), tid_(tid), name_(name) {
+}
+
+//------------------------------------------------------------------------------
+// Name: tid
+// Desc:
+//------------------------------------------------------------------------------
+edb::tid_t RemoteThread::tid() const {
+	return tid_;
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString RemoteThread::name() const {
+	if(!name_.isEmpty()) {
+		return name_;
+	}
+	return process_->name();
+}
+
+//------------------------------------------------------------------------------
+// Name: priority
+// Desc: not something the protocol knows about
+//------------------------------------------------------------------------------
+int RemoteThread::priority() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: instruction_pointer
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t RemoteThread::instruction_pointer() const {
+	const QByteArray &regs = const_cast<RemoteThread *>(this)->registers();
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	quint64 ip;
+	if(process_->is64Bit()) {
+		get_value(regs, amd64_offset(AMD64PC), 8, &ip);
+	} else {
+		get_value(regs, I386PC * 4, 4, &ip);
+	}
+	return edb::address_t::fromZeroExtended(ip);
+#else
+	Q_UNUSED(regs);
+	return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: runState
+// Desc:
+//------------------------------------------------------------------------------
+QString RemoteThread::runState() const {
+	return isPaused() ? tr("Stopped") : tr("Running");
+}
+
+//------------------------------------------------------------------------------
+// Name: registers
+// Desc: the whole register file in one 'g', fetched at most once per stop
+//------------------------------------------------------------------------------
+const QByteArray &RemoteThread::registers() {
+
+	if(registers_.isEmpty() && isPaused()) {
+		QList<QByteArray> packets;
+
+		const QByteArray select = process_->select_thread(tid_);
+		if(!select.isEmpty()) {
+			packets.push_back(select);
+		}
+		packets.push_back("g");
+
+		const QByteArray reply = process_->remote_.request(packets).back();
+		if(!reply.isEmpty() && !GdbRemote::is_error(reply)) {
+			registers_ = from_hex(reply);
+		} else {
+			process_->general_thread_ = 0;
+		}
+	}
+
+	return registers_;
+}
+
+//------------------------------------------------------------------------------
+// Name: get_state
+// Desc:
+//------------------------------------------------------------------------------
+void RemoteThread::get_state(State *state) {
+
+	if(auto state_impl = static_cast<PlatformState *>(state->writable_impl())) {
+
+		state_impl->clear();
+
+		const QByteArray &regs = registers();
+		if(regs.isEmpty()) {
+			return;
+		}
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		X86XState xstate;
+		if(process_->is64Bit()) {
+			PrStatus_X86_64 gprs;
+			std::memset(&gprs, 0, sizeof(gprs));
+			for(int i = 0; i < static_cast<int>(sizeof(AMD64Registers) / sizeof(AMD64Registers[0])); ++i) {
+				get_value(regs, amd64_offset(i), i < AMD64WideRegisters ? 8 : 4, &(gprs.*AMD64Registers[i]));
+			}
+			gprs.orig_rax = -1;
+			state_impl->fillFrom(gprs);
+
+			// the packet has no room for the fs and gs bases, the rest are flat
+			for(std::size_t i = 0; i < PlatformState::X86::FS; ++i) {
+				state_impl->x86.segRegBases[i]       = 0;
+				state_impl->x86.segRegBasesFilled[i] = true;
+			}
+			state_impl->x86.segRegBasesFilled[PlatformState::X86::FS] = false;
+			state_impl->x86.segRegBasesFilled[PlatformState::X86::GS] = false;
+
+			if(get_fp_state(regs, AMD64Layout, &xstate)) {
+				state_impl->fillFrom(xstate, X86XState::XSAVE_NONEXTENDED_SIZE);
+			}
+		} else {
+			UserRegsStructX86 gprs;
+			std::memset(&gprs, 0, sizeof(gprs));
+			for(int i = 0; i < static_cast<int>(sizeof(I386Registers) / sizeof(I386Registers[0])); ++i) {
+				get_value(regs, i * 4, 4, &(gprs.*I386Registers[i]));
+			}
+			gprs.orig_eax = -1;
+			state_impl->fillFrom(gprs);
+
+			if(get_fp_state(regs, I386Layout, &xstate)) {
+				state_impl->fillFrom(xstate, X86XState::XSAVE_NONEXTENDED_SIZE);
+			}
+		}
+#endif
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_state
+// Desc: the registers go back in the layout they came in, so only what edb
+//       knows about is changed and anything after it is sent back as it was
+//------------------------------------------------------------------------------
+void RemoteThread::set_state(const State &state) {
+
+	auto state_impl = static_cast<const PlatformState *>(state.impl_.get());
+	if(!state_impl || registers().isEmpty()) {
+		return;
+	}
+
+	QByteArray regs = registers_;
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	X86XState xstate;
+	const bool fp = state_impl->fillStruct(xstate) != 0;
+
+	if(process_->is64Bit()) {
+		PrStatus_X86_64 gprs;
+		state_impl->fillStruct(gprs);
+		for(int i = 0; i < static_cast<int>(sizeof(AMD64Registers) / sizeof(AMD64Registers[0])); ++i) {
+			put_value(&regs, amd64_offset(i), i < AMD64WideRegisters ? 8 : 4, gprs.*AMD64Registers[i]);
+		}
+
+		if(fp) {
+			put_fp_state(xstate, AMD64Layout, &regs);
+		}
+	} else {
+		UserRegsStructX86 gprs;
+		state_impl->fillStruct(gprs);
+		for(int i = 0; i < static_cast<int>(sizeof(I386Registers) / sizeof(I386Registers[0])); ++i) {
+			put_value(&regs, i * 4, 4, gprs.*I386Registers[i]);
+		}
+
+		if(fp) {
+			put_fp_state(xstate, I386Layout, &regs);
+		}
+	}
+#endif
+
+	QList<QByteArray> packets;
+
+	const QByteArray select = process_->select_thread(tid_);
+	if(!select.isEmpty()) {
+		packets.push_back(select);
+	}
+	packets.push_back("G" + regs.toHex());
+
+	if(process_->remote_.request(packets).back() == "OK") {
+		registers_ = regs;
+	} else {
+		registers_.clear();
+		process_->general_thread_ = 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteThread::step() {
+	return process_->run(tid_, true, edb::DEBUG_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteThread::step(edb::EVENT_STATUS status) {
+	return process_->run(tid_, true, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteThread::resume() {
+	return process_->run(tid_, false, edb::DEBUG_CONTINUE);
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteThread::resume(edb::EVENT_STATUS status) {
+	return process_->run(tid_, false, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc: an all-stop stub can only stop everything
+//------------------------------------------------------------------------------
+Status RemoteThread::stop() {
+	return process_->pause();
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool RemoteThread::isPaused() const {
+	return !process_->running_;
+}
+
+//------------------------------------------------------------------------------
+// Name: RemoteProcess
+// Desc:
+//------------------------------------------------------------------------------
+RemoteProcess::RemoteProcess(DebuggerCore *core, edb::address_t page_size) : core_(core), page_cache_(page_size), page_size_(page_size) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~RemoteProcess
+// Desc:
+//------------------------------------------------------------------------------
+RemoteProcess::~RemoteProcess() {
+	remote_.disconnect();
+}
+
+//------------------------------------------------------------------------------
+// Name: connect
+// Desc: the stub is already stopped in the process it runs or is attached
+//       to, so there is nothing to wait for
+//------------------------------------------------------------------------------
+Status RemoteProcess::connect(const QString &host, quint16 port) {
+
+	const Status status = remote_.connect(host, port);
+	if(!status) {
+		return status;
+	}
+
+	// binary replies are half the size of hex ones
+	binary_reads_ = remote_.supports("binary-upload");
+
+	// "?" must come first, some stubs don't know which thread they are in
+	// before it. The target description says which registers 'g' has
+	const QList<QByteArray> replies = remote_.request(QList<QByteArray>() << "?" << "qC");
+	const QByteArray target = remote_.read_object("features", "target.xml");
+
+	if(replies[0].isEmpty() || GdbRemote::is_error(replies[0])) {
+		remote_.disconnect();
+		return Status(tr("The stub at %1:%2 is not debugging anything").arg(host).arg(port));
+	}
+
+	Stop stop;
+	parse_stop(replies[0], &stop);
+
+	if(stop.kind != StopKind::Stopped) {
+		remote_.disconnect();
+		return Status(tr("The process being debugged at %1:%2 has already exited").arg(host).arg(port));
+	}
+
+	if(replies[1].startsWith("QC")) {
+		stop.pid = std::max(stop.pid, process_id(replies[1].mid(2)));
+		stop.tid = parse_thread_id(replies[1].mid(2));
+	}
+
+	// without multiprocess ids the main thread is the best guess, a stub for
+	// a bare machine counts its CPUs as threads from 1
+	pid_ = stop.pid ? stop.pid : stop.tid ? stop.tid : 1;
+
+#if defined(EDB_X86_64)
+	is64_ = target.isEmpty() || target.contains("x86-64");
+#else
+	is64_ = target.contains("x86-64");
+#endif
+
+	update_threads();
+	for(const std::shared_ptr<IThread> &thread : threads_) {
+		if(thread->tid() == stop.tid || !current_thread_) {
+			current_thread_ = thread;
+		}
+	}
+
+	if(!current_thread_) {
+		current_thread_ = std::make_shared<RemoteThread>(this, stop.tid ? stop.tid : pid_, QString());
+		threads_.push_back(current_thread_);
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: thread_id
+// Desc: how the stub wants to see <tid>
+//------------------------------------------------------------------------------
+QByteArray RemoteProcess::thread_id(edb::tid_t tid) const {
+	if(remote_.supports("multiprocess")) {
+		return "p" + hex(pid_) + "." + hex(tid);
+	}
+	return hex(tid);
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_thread_id
+// Desc: "p<pid>.<tid>" or just "<tid>"
+//------------------------------------------------------------------------------
+edb::tid_t RemoteProcess::parse_thread_id(const QByteArray &id) const {
+
+	QByteArray tid = id;
+	if(tid.startsWith('p')) {
+		const int dot = tid.indexOf('.');
+		if(dot == -1) {
+			return process_id(tid);
+		}
+		tid = tid.mid(dot + 1);
+	}
+
+	// -1 and 0 mean all and any, neither names a thread
+	const edb::tid_t n = tid.toInt(nullptr, 16);
+	return n > 0 ? n : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: select_thread
+// Desc: the packet which points the register requests at <tid>, empty if they
+//       already are
+//------------------------------------------------------------------------------
+QByteArray RemoteProcess::select_thread(edb::tid_t tid) {
+	if(general_thread_ == tid) {
+		return QByteArray();
+	}
+
+	general_thread_ = tid;
+	return "Hg" + thread_id(tid);
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: steps <tid> or resumes everything. The signal the thread stopped with
+//       is passed on unless edb handled it
+//------------------------------------------------------------------------------
+Status RemoteProcess::run(edb::tid_t tid, bool step, edb::EVENT_STATUS status) {
+
+	if(running_) {
+		return Status(tr("The process is already running"));
+	}
+
+	if(exited_ || !remote_.connected()) {
+		return Status(tr("The connection to the remote stub is closed"));
+	}
+
+	int signal = 0;
+	if(status == edb::DEBUG_EXCEPTION_NOT_HANDLED && last_signal_ != SIGTRAP && last_signal_ != SIGSTOP) {
+		signal = gdb_signal(last_signal_);
+	}
+
+	const QByteArray actions = remote_.feature("vCont");
+	const QByteArray action  = QByteArray(step ? "s" : "c");
+	const QByteArray id      = thread_id(tid);
+
+	QByteArray packet;
+	if(actions.contains(action.toUpper()) && actions.contains(action)) {
+		packet = "vCont;" + (signal ? action.toUpper() + QByteArray::number(signal, 16).rightJustified(2, '0') : action) + ":" + id;
+		if(!step) {
+			packet += ";c";
+		}
+	} else {
+		if(remote_.request("Hc" + id) != "OK") {
+			return Status(tr("The remote stub can't resume thread %1").arg(tid));
+		}
+		packet = signal ? action.toUpper() + QByteArray::number(signal, 16).rightJustified(2, '0') : action;
+	}
+
+	qDebug() << "[RemoteProcess]" << (remote_.round_trips() - stop_round_trips_) << "round trips while stopped," << page_cache_.hits() << "page cache hits";
+
+	if(!remote_.send(packet)) {
+		return Status(tr("Unable to send to the remote stub"));
+	}
+
+	running_  = true;
+	stepping_ = step;
+	new_epoch();
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: new_epoch
+// Desc: nothing fetched while stopped can be trusted once the process ran
+//------------------------------------------------------------------------------
+void RemoteProcess::new_epoch() {
+	++memory_epoch_;
+	page_cache_.invalidate();
+	unreadable_pages_.clear();
+
+	working_set_ = touched_pages_;
+	touched_pages_.clear();
+	regions_.clear();
+	regions_valid_  = false;
+	threads_valid_  = false;
+
+	for(const std::shared_ptr<IThread> &thread : threads_) {
+		std::static_pointer_cast<RemoteThread>(thread)->registers_.clear();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_stop
+// Desc: false if the process is still running after <msecs>
+//------------------------------------------------------------------------------
+bool RemoteProcess::wait_stop(int msecs, Stop *stop) {
+
+	if(!running_) {
+		return false;
+	}
+
+	QByteArray reply;
+	for(;;) {
+		if(!remote_.wait_reply(&reply, msecs)) {
+			if(remote_.connected()) {
+				return false;
+			}
+
+			qWarning() << "[RemoteProcess] lost the connection to the remote stub";
+			reply = "X09";
+		}
+
+		// console output of the program, the real stop reply comes later
+		if(reply.startsWith('O') && reply != "OK") {
+			qDebug() << "[RemoteProcess]" << from_hex(reply.mid(1)).constData();
+			continue;
+		}
+
+		break;
+	}
+
+	running_          = false;
+	stop_round_trips_ = remote_.round_trips();
+
+	parse_stop(reply, stop);
+	stop->stepped = stepping_ && stop->signal == SIGTRAP;
+	last_signal_  = stop->signal;
+
+	if(stop->kind != StopKind::Stopped) {
+		exited_ = true;
+		return true;
+	}
+
+	if(stop->tid == 0 && current_thread_) {
+		stop->tid = current_thread_->tid();
+	}
+
+	// the thread which stopped becomes the current one, the thread list
+	// itself is only asked for if something wants it
+	std::shared_ptr<IThread> thread;
+	for(const std::shared_ptr<IThread> &t : threads_) {
+		if(t->tid() == stop->tid) {
+			thread = t;
+		}
+	}
+
+	if(!thread) {
+		thread = std::make_shared<RemoteThread>(this, stop->tid, QString());
+		threads_.push_back(thread);
+	}
+
+	current_thread_ = thread;
+
+	// the views want the registers, the code around the IP, the top of the
+	// stack and most likely whatever they looked at the last time, all of
+	// which can be had in the same round trip
+	QVector<edb::address_t> pages;
+	if(!stop->expedited.isEmpty()) {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+		const int pc = is64_ ? AMD64PC : I386PC;
+		const int sp = is64_ ? AMD64SP : I386SP;
+		for(int n : { pc, sp }) {
+			if(stop->expedited.contains(n)) {
+				const edb::address_t address = stop->expedited[n];
+				pages.push_back(address - (address & (page_size_ - 1)));
+			}
+		}
+#endif
+	}
+
+	pages += working_set_;
+
+	auto remote_thread = std::static_pointer_cast<RemoteThread>(thread);
+	QList<QByteArray> extra;
+	const QByteArray select = select_thread(stop->tid);
+	if(!select.isEmpty()) {
+		extra.push_back(select);
+	}
+	extra.push_back("g");
+
+	const QByteArray registers = fetch_pages(pages, extra).back();
+	if(!registers.isEmpty() && !GdbRemote::is_error(registers)) {
+		remote_thread->registers_ = from_hex(registers);
+	} else {
+		general_thread_ = 0;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_stop
+// Desc: S, T, W and X stop replies
+//------------------------------------------------------------------------------
+void RemoteProcess::parse_stop(const QByteArray &reply, Stop *stop) const {
+
+	const int number = reply.mid(1, 2).toInt(nullptr, 16);
+
+	switch(reply.isEmpty() ? 'X' : reply[0]) {
+	case 'S':
+	case 'T':
+		stop->kind   = StopKind::Stopped;
+		stop->signal = host_signal(number);
+
+		for(const QByteArray &pair : reply.mid(3).split(';')) {
+			const int colon = pair.indexOf(':');
+			if(colon == -1) {
+				continue;
+			}
+
+			const QByteArray key   = pair.left(colon);
+			const QByteArray value = pair.mid(colon + 1);
+
+			if(key == "thread") {
+				stop->pid = process_id(value);
+				stop->tid = parse_thread_id(value);
+			} else {
+				bool ok;
+				const int n = key.toInt(&ok, 16);
+				if(ok) {
+					quint64 v;
+					get_value(from_hex(value), 0, value.size() / 2, &v);
+					stop->expedited[n] = edb::address_t::fromZeroExtended(v);
+				}
+			}
+		}
+		break;
+	case 'W':
+		stop->kind = StopKind::Exited;
+		stop->code = number;
+		break;
+	case 'X':
+		stop->kind   = StopKind::Terminated;
+		stop->signal = host_signal(number);
+		break;
+	default:
+		// "N", nothing is left running
+		stop->kind = StopKind::Exited;
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_threads
+// Desc: qXfer:threads:read has every thread, with names, in one object.
+//       Threads which were already known are kept, with their registers
+//------------------------------------------------------------------------------
+void RemoteProcess::update_threads() const {
+
+	if(threads_valid_ || running_) {
+		return;
+	}
+
+	QList<QPair<edb::tid_t, QString>> found;
+
+	const QByteArray xml = remote_.read_object("threads", "");
+	if(!xml.isEmpty()) {
+		QXmlStreamReader reader(xml);
+		while(!reader.atEnd()) {
+			if(reader.readNext() == QXmlStreamReader::StartElement && reader.name() == QLatin1String("thread")) {
+				const QXmlStreamAttributes attributes = reader.attributes();
+				if(const edb::tid_t tid = parse_thread_id(attributes.value("id").toString().toLatin1())) {
+					found.push_back(qMakePair(tid, attributes.value("name").toString()));
+				}
+			}
+		}
+	} else {
+		for(QByteArray reply = remote_.request("qfThreadInfo"); reply.startsWith('m'); reply = remote_.request("qsThreadInfo")) {
+			for(const QByteArray &id : reply.mid(1).split(',')) {
+				if(const edb::tid_t tid = parse_thread_id(id)) {
+					found.push_back(qMakePair(tid, QString()));
+				}
+			}
+		}
+	}
+
+	if(found.isEmpty()) {
+		return;
+	}
+
+	QList<std::shared_ptr<IThread>> threads;
+	for(const QPair<edb::tid_t, QString> &entry : found) {
+		std::shared_ptr<IThread> thread;
+		for(const std::shared_ptr<IThread> &t : threads_) {
+			if(t->tid() == entry.first) {
+				thread = t;
+			}
+		}
+
+		if(!thread) {
+			thread = std::make_shared<RemoteThread>(const_cast<RemoteProcess *>(this), entry.first, entry.second);
+		} else if(!entry.second.isEmpty()) {
+			std::static_pointer_cast<RemoteThread>(thread)->name_ = entry.second;
+		}
+
+		threads.push_back(thread);
+	}
+
+	threads_       = threads;
+	threads_valid_ = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: fetch_pages
+// Desc: reads every page of <pages> into the cache in one pipelined batch,
+//       unless it is there already. <extra> goes out in front of them, and
+//       its replies are returned
+//------------------------------------------------------------------------------
+QList<QByteArray> RemoteProcess::fetch_pages(const QVector<edb::address_t> &pages, const QList<QByteArray> &extra) const {
+
+	QList<QByteArray> packets = extra;
+	QVector<edb::address_t> missing;
+
+	// a reply is hex, twice the size of what it holds, plus the framing
+	const std::size_t page_size = page_size_.toUint();
+	const std::size_t chunk     = std::min<std::size_t>((remote_.packet_size() - 4) / 2, page_size);
+
+	for(const edb::address_t page : pages) {
+		if(page_cache_.find(page) || unreadable_pages_.contains(page) || missing.contains(page)) {
+			continue;
+		}
+
+		missing.push_back(page);
+		for(std::size_t offset = 0; offset < page_size; offset += chunk) {
+			packets.push_back(read_request(page + offset, std::min(chunk, page_size - offset)));
+		}
+	}
+
+	if(packets.isEmpty()) {
+		return extra;
+	}
+
+	const QList<QByteArray> replies = remote_.request(packets);
+
+	int index = extra.size();
+	for(const edb::address_t page : missing) {
+		QByteArray data;
+		for(std::size_t offset = 0; offset < page_size; offset += chunk) {
+			QByteArray bytes;
+			if(read_reply(replies[index++], &bytes)) {
+				data.append(bytes);
+			}
+		}
+
+		if(data.size() == static_cast<int>(page_size)) {
+			page_cache_.insert(page, data);
+		} else {
+			unreadable_pages_.insert(page);
+		}
+	}
+
+	return replies.mid(0, extra.size());
+}
+
+//------------------------------------------------------------------------------
+// Name: touch_pages
+// Desc: notes which pages were read while stopped, the first few of them are
+//       prefetched at the next stop
+//------------------------------------------------------------------------------
+void RemoteProcess::touch_pages(const QVector<edb::address_t> &pages) const {
+	for(const edb::address_t page : pages) {
+		if(touched_pages_.size() >= PrefetchPages) {
+			break;
+		}
+
+		if(!touched_pages_.contains(page)) {
+			touched_pages_.push_back(page);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: read_request
+// Desc: the packet reading <len> bytes at <address>. Chunks are sized for hex
+//       replies, so a binary one fits even if every byte needs escaping
+//------------------------------------------------------------------------------
+QByteArray RemoteProcess::read_request(edb::address_t address, std::size_t len) const {
+	return (binary_reads_ ? "x" : "m") + hex(address.toUint()) + "," + hex(len);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_reply
+// Desc: the bytes of a read_request reply, false if it is an error
+//------------------------------------------------------------------------------
+bool RemoteProcess::read_reply(const QByteArray &reply, QByteArray *data) const {
+
+	Q_ASSERT(data);
+
+	if(GdbRemote::is_error(reply)) {
+		return false;
+	}
+
+	if(binary_reads_) {
+		if(!reply.startsWith('b')) {
+			return false;
+		}
+		*data = reply.mid(1);
+	} else {
+		*data = from_hex(reply);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_direct
+// Desc: reads too big for the cache are split into as many requests as it
+//       takes, all of which are in flight at once
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::read_direct(edb::address_t address, char *buf, std::size_t len) const {
+
+	const std::size_t chunk = (remote_.packet_size() - 4) / 2;
+
+	QList<QByteArray> packets;
+	for(std::size_t offset = 0; offset < len; offset += chunk) {
+		packets.push_back(read_request(address + offset, std::min(chunk, len - offset)));
+	}
+
+	std::size_t read = 0;
+	for(const QByteArray &reply : remote_.request(packets)) {
+		QByteArray data;
+		if(!read_reply(reply, &data)) {
+			break;
+		}
+
+		const std::size_t n   = std::min<std::size_t>(data.size(), len - read);
+		std::memcpy(buf + read, data.constData(), n);
+		read += n;
+
+		// a short reply means the rest isn't readable
+		if(n < std::min(chunk, len - (read - n))) {
+			break;
+		}
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_cached
+// Desc: the pages the read touches come from the cache, the missing ones are
+//       all fetched at once first
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::read_cached(edb::address_t address, char *buf, std::size_t len) const {
+
+	const edb::address_t first = address - (address & (page_size_ - 1));
+
+	QVector<edb::address_t> pages;
+	for(edb::address_t page = first; page < address + len; page += page_size_) {
+		pages.push_back(page);
+	}
+	touch_pages(pages);
+	fetch_pages(pages, QList<QByteArray>());
+
+	std::size_t read = 0;
+	while(read < len) {
+		const edb::address_t current = address + read;
+		const std::size_t    offset  = current & (page_size_ - 1);
+		const edb::address_t page    = current - offset;
+		const std::size_t    n       = std::min<std::size_t>(page_size_.toUint() - offset, len - read);
+
+		if(const QByteArray *data = page_cache_.find(page)) {
+			std::memcpy(buf + read, data->constData() + offset, n);
+			read += n;
+		} else {
+			// the page isn't entirely readable, so just get what we can
+			read += read_direct(current, buf + read, n);
+			break;
+		}
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: reads <len> bytes into <buf> starting at <address>
+// Note: returns the number of bytes read <N>
+// Note: if the read is short, only the first <N> bytes are defined
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::read_bytes(edb::address_t address, void *buf, std::size_t len) const {
+	Q_ASSERT(buf);
+
+	// an all-stop stub takes no requests while the process runs
+	if(len == 0 || running_ || exited_) {
+		return 0;
+	}
+
+	auto ptr = reinterpret_cast<char *>(buf);
+
+	std::size_t read;
+	if(len <= PageCache::MaxCachedRead) {
+		read = read_cached(address, ptr, len);
+	} else {
+		read = read_direct(address, ptr, len);
+	}
+
+	// replace any breakpoints
+	core_->restore_breakpoint_bytes(address, ptr, read);
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc: reads <count> pages from the process starting at <address>
+// Note: buf's size must be >= count * page_size()
+// Note: address MUST be page aligned.
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::read_pages(edb::address_t address, void *buf, std::size_t count) const {
+	Q_ASSERT(buf);
+	Q_ASSERT((address & (page_size_ - 1)) == 0);
+
+	const std::size_t page_size = page_size_.toUint();
+	return read_bytes(address, buf, count * page_size) / page_size;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_many
+// Desc: the pages all of the small reads need are fetched in one batch, after
+//       which each of them is just a copy out of the cache
+//------------------------------------------------------------------------------
+QVector<std::size_t> RemoteProcess::read_many(const QVector<ReadRequest> &requests) const {
+
+	if(!running_ && !exited_) {
+		QVector<edb::address_t> pages;
+		for(const ReadRequest &request : requests) {
+			if(request.size != 0 && request.size <= PageCache::MaxCachedRead) {
+				const edb::address_t first = request.address - (request.address & (page_size_ - 1));
+				for(edb::address_t page = first; page < request.address + request.size; page += page_size_) {
+					pages.push_back(page);
+				}
+			}
+		}
+		touch_pages(pages);
+		fetch_pages(pages, QList<QByteArray>());
+	}
+
+	return IProcess::read_many(requests);
+}
+
+//------------------------------------------------------------------------------
+// Name: write_bytes
+// Desc: writes <len> bytes from <buf> starting at <address>
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_ASSERT(buf);
+
+	WriteRequest request;
+	request.address = address;
+	request.buffer  = buf;
+	request.size    = len;
+	return write_many(QVector<WriteRequest>() << request).front();
+}
+
+//------------------------------------------------------------------------------
+// Name: write_many
+// Desc: every 'M' request of every write goes out in the same batch
+//------------------------------------------------------------------------------
+QVector<std::size_t> RemoteProcess::write_many(const QVector<WriteRequest> &requests) {
+
+	QVector<std::size_t> results(requests.size(), 0);
+	if(running_ || exited_) {
+		return results;
+	}
+
+	// "M<address>,<length>:" and the framing, then two hex digits a byte
+	const std::size_t chunk = (remote_.packet_size() - 40) / 2;
+
+	QList<QByteArray> packets;
+	QVector<QPair<int, std::size_t>> owners; // which request, and how much of it
+
+	for(int i = 0; i < requests.size(); ++i) {
+		const WriteRequest &request = requests[i];
+		auto ptr = reinterpret_cast<const char *>(request.buffer);
+
+		for(std::size_t offset = 0; offset < request.size; offset += chunk) {
+			const std::size_t n = std::min(chunk, request.size - offset);
+			packets.push_back("M" + hex((request.address + offset).toUint()) + "," + hex(n) + ":" + QByteArray::fromRawData(ptr + offset, n).toHex());
+			owners.push_back(qMakePair(i, n));
+		}
+
+		page_cache_.invalidate(request.address, request.size);
+		unreadable_pages_.clear();
+	}
+
+	++memory_epoch_;
+
+	const QList<QByteArray> replies = remote_.request(packets);
+
+	QSet<int> failed;
+	for(int i = 0; i < replies.size(); ++i) {
+		const int owner = owners[i].first;
+		if(replies[i] == "OK" && !failed.contains(owner)) {
+			results[owner] += owners[i].second;
+		} else {
+			failed.insert(owner);
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: patch_bytes
+// Desc: same as write_bytes, except that it also records the original data
+//       that was found at the address being written to.
+//------------------------------------------------------------------------------
+std::size_t RemoteProcess::patch_bytes(edb::address_t address, const void *buf, std::size_t len) {
+	Q_ASSERT(buf);
+
+	QByteArray orig_bytes(static_cast<int>(len), '\0');
+
+	const std::size_t read_ret = read_bytes(address, orig_bytes.data(), len);
+	if(read_ret != len) {
+		return 0;
+	}
+
+	patches_.record(address, orig_bytes, QByteArray(static_cast<const char *>(buf), static_cast<int>(len)));
+
+	return write_bytes(address, buf, len);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_remote_file
+// Desc: a file on the machine the stub runs on, through its host I/O
+//       requests. Empty if the stub can't do that
+//------------------------------------------------------------------------------
+QByteArray RemoteProcess::read_remote_file(const QByteArray &path) const {
+
+	const QByteArray open = remote_.request("vFile:open:" + path.toHex() + ",0,0");
+	if(!open.startsWith('F') || open.startsWith("F-")) {
+		return QByteArray();
+	}
+
+	const QByteArray fd = open.mid(1);
+
+	// host I/O replies are binary, which may take up to twice the space
+	const int chunk = (remote_.packet_size() - 32) / 2;
+
+	QByteArray data;
+	for(;;) {
+		const QByteArray reply = remote_.request("vFile:pread:" + fd + "," + hex(chunk) + "," + hex(data.size()));
+		const int semicolon    = reply.indexOf(';');
+		if(!reply.startsWith('F') || reply.startsWith("F-") || semicolon == -1) {
+			break;
+		}
+
+		const QByteArray bytes = reply.mid(semicolon + 1);
+		if(bytes.isEmpty()) {
+			break;
+		}
+		data.append(bytes);
+	}
+
+	remote_.request("vFile:close:" + fd);
+	return data;
+}
+
+//------------------------------------------------------------------------------
+// Name: regions
+// Desc: gdbserver can read /proc/<pid>/maps for us, which is the best there
+//       is. Stubs with a memory map have coarser regions, and without either
+//       all of memory is one big region. Asked for once per stop
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IRegion>> RemoteProcess::regions() const {
+
+	if(regions_valid_ || running_ || exited_) {
+		return regions_;
+	}
+
+	regions_ = maps_.parse(read_remote_file("/proc/" + QByteArray::number(pid_) + "/maps"));
+
+	if(regions_.isEmpty()) {
+		QXmlStreamReader reader(remote_.read_object("memory-map", ""));
+		while(!reader.atEnd()) {
+			if(reader.readNext() == QXmlStreamReader::StartElement && reader.name() == QLatin1String("memory")) {
+				const QXmlStreamAttributes attributes = reader.attributes();
+
+				bool ok1;
+				bool ok2;
+				const quint64 start  = attributes.value("start").toString().toULongLong(&ok1, 0);
+				const quint64 length = attributes.value("length").toString().toULongLong(&ok2, 0);
+				if(ok1 && ok2 && length != 0) {
+					const bool writable = attributes.value("type") == QLatin1String("ram");
+					regions_.push_back(std::make_shared<PlatformRegion>(
+						edb::address_t::fromZeroExtended(start),
+						edb::address_t::fromZeroExtended(start + length),
+						0,
+						QString(),
+						PROT_READ | PROT_EXEC | (writable ? PROT_WRITE : 0)));
+				}
+			}
+		}
+	}
+
+	if(regions_.isEmpty()) {
+		const edb::address_t end = edb::address_t::fromZeroExtended(is64_ ? Q_UINT64_C(0xfffffffffffff000) : Q_UINT64_C(0xfffff000));
+		regions_.push_back(std::make_shared<PlatformRegion>(page_size_, end, 0, QString(), PROT_READ | PROT_WRITE | PROT_EXEC));
+	}
+
+	regions_valid_ = true;
+	return regions_;
+}
+
+//------------------------------------------------------------------------------
+// Name: executable
+// Desc: the path on the machine the stub runs on
+//------------------------------------------------------------------------------
+QString RemoteProcess::executable() const {
+
+	if(executable_.isEmpty() && !running_ && !exited_) {
+		const QByteArray annex = remote_.supports("multiprocess") ? hex(pid_) : QByteArray();
+		executable_ = QString::fromLocal8Bit(remote_.read_object("exec-file", annex));
+
+		if(executable_.isEmpty()) {
+			for(const std::shared_ptr<IRegion> &region : regions()) {
+				if(region->executable() && region->name().startsWith('/')) {
+					executable_ = region->name();
+					break;
+				}
+			}
+		}
+	}
+
+	return executable_;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_time
+// Desc: not something the protocol knows about
+//------------------------------------------------------------------------------
+QDateTime RemoteProcess::start_time() const {
+	return QDateTime();
+}
+
+//------------------------------------------------------------------------------
+// Name: arguments
+// Desc:
+//------------------------------------------------------------------------------
+QList<QByteArray> RemoteProcess::arguments() const {
+	QList<QByteArray> ret;
+	if(!running_ && !exited_) {
+		for(const QByteArray &argument : read_remote_file("/proc/" + QByteArray::number(pid_) + "/cmdline").split('\0')) {
+			if(!argument.isEmpty()) {
+				ret.push_back(argument);
+			}
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_working_directory
+// Desc: not something the protocol knows about
+//------------------------------------------------------------------------------
+QString RemoteProcess::current_working_directory() const {
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: pid
+// Desc:
+//------------------------------------------------------------------------------
+edb::pid_t RemoteProcess::pid() const {
+	return pid_;
+}
+
+//------------------------------------------------------------------------------
+// Name: parent
+// Desc: lives on another machine, if anywhere
+//------------------------------------------------------------------------------
+std::shared_ptr<IProcess> RemoteProcess::parent() const {
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: code_address
+// Desc: the executable mapping of the program
+//------------------------------------------------------------------------------
+edb::address_t RemoteProcess::code_address() const {
+	const QString path = executable();
+	for(const std::shared_ptr<IRegion> &region : regions()) {
+		if(region->name() == path && region->executable()) {
+			return region->start();
+		}
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: data_address
+// Desc: the writable mapping of the program
+//------------------------------------------------------------------------------
+edb::address_t RemoteProcess::data_address() const {
+	const QString path = executable();
+	for(const std::shared_ptr<IRegion> &region : regions()) {
+		if(region->name() == path && region->writable()) {
+			return region->start();
+		}
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: threads
+// Desc:
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<IThread>> RemoteProcess::threads() const {
+	update_threads();
+	return threads_;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_thread
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<IThread> RemoteProcess::current_thread() const {
+	return current_thread_;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_current_thread
+// Desc:
+//------------------------------------------------------------------------------
+void RemoteProcess::set_current_thread(IThread& thread) {
+	for(const std::shared_ptr<IThread> &t : threads()) {
+		if(t->tid() == thread.tid()) {
+			current_thread_ = t;
+			break;
+		}
+	}
+	edb::v1::update_ui();
+}
+
+//------------------------------------------------------------------------------
+// Name: uid
+// Desc: not something the protocol knows about
+//------------------------------------------------------------------------------
+edb::uid_t RemoteProcess::uid() const {
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: user
+// Desc:
+//------------------------------------------------------------------------------
+QString RemoteProcess::user() const {
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString RemoteProcess::name() const {
+	return QFileInfo(executable()).fileName();
+}
+
+//------------------------------------------------------------------------------
+// Name: loaded_modules
+// Desc: the files mapped from their start
+//------------------------------------------------------------------------------
+QList<Module> RemoteProcess::loaded_modules() const {
+
+	QList<Module> modules;
+	QSet<QString> found_modules;
+
+	for(const std::shared_ptr<IRegion> &region : regions()) {
+		if(region->base() == 0 && region->name().startsWith('/') && !found_modules.contains(region->name())) {
+			Module module;
+			module.name         = region->name();
+			module.base_address = region->start();
+			found_modules.insert(region->name());
+			modules.push_back(module);
+		}
+	}
+
+	return modules;
+}
+
+//------------------------------------------------------------------------------
+// Name: pause
+// Desc: the stop reply comes like any other
+//------------------------------------------------------------------------------
+Status RemoteProcess::pause() {
+	if(running_ && !remote_.interrupt()) {
+		return Status(tr("Unable to send to the remote stub"));
+	}
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteProcess::resume(edb::EVENT_STATUS status) {
+	if(!current_thread_) {
+		return Status(tr("No thread to resume"));
+	}
+	return run(current_thread_->tid(), false, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+Status RemoteProcess::step(edb::EVENT_STATUS status) {
+	if(!current_thread_) {
+		return Status(tr("No thread to step"));
+	}
+	return run(current_thread_->tid(), true, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: isPaused
+// Desc:
+//------------------------------------------------------------------------------
+bool RemoteProcess::isPaused() const {
+	return !running_;
+}
+
+//------------------------------------------------------------------------------
+// Name: patches
+// Desc:
+//------------------------------------------------------------------------------
+QMap<edb::address_t, Patch> RemoteProcess::patches() const {
+	return patches_.patches();
+}
+
+//------------------------------------------------------------------------------
+// Name: patches_in
+// Desc: the patches which have a byte in [address, address + size)
+//------------------------------------------------------------------------------
+QList<Patch> RemoteProcess::patches_in(edb::address_t address, std::size_t size) const {
+	return patches_.patches(address, size);
+}
+
+//------------------------------------------------------------------------------
+// Name: detach
+// Desc: lets the process go on without us, the stub decides what happens
+//       to it then
+//------------------------------------------------------------------------------
+void RemoteProcess::detach() {
+	if(remote_.connected() && !exited_) {
+		if(running_) {
+			remote_.interrupt();
+			QByteArray reply;
+			remote_.wait_reply(&reply, GdbRemote::Timeout);
+			running_ = false;
+		}
+
+		remote_.request(remote_.supports("multiprocess") ? "D;" + hex(pid_) : QByteArray("D"));
+	}
+	remote_.disconnect();
+}
+
+//------------------------------------------------------------------------------
+// Name: kill
+// Desc: "k" has no reply on most stubs, which tend to hang up right after
+//------------------------------------------------------------------------------
+void RemoteProcess::kill() {
+	if(remote_.connected() && !exited_) {
+		if(remote_.supports("multiprocess")) {
+			remote_.request("vKill;" + hex(pid_));
+		} else {
+			remote_.send("k");
+		}
+	}
+	remote_.disconnect();
+}
+
+}
@@ -0,0 +1,213 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REMOTE_PROCESS_20170716_H_
+#define REMOTE_PROCESS_20170716_H_
+
+#include "GdbRemote.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "PageCache.h"
+#include "PatchLedger.h"
+#include "PlatformCommon.h"
+#include "Status.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <memory>
+
+namespace DebuggerCorePlugin {
+
+class DebuggerCore;
+class RemoteProcess;
+
+class RemoteThread : public IThread {
+	Q_DECLARE_TR_FUNCTIONS(RemoteThread)
+	friend class RemoteProcess;
+
+public:
+	RemoteThread(RemoteProcess *process, edb::tid_t tid, const QString &name);
+
+private:
+	RemoteThread(const RemoteThread &) = delete;
+	RemoteThread& operator=(const RemoteThread &) = delete;
+
+public:
+	virtual edb::tid_t tid() const override;
+	virtual QString name() const override;
+	virtual int priority() const override;
+	virtual edb::address_t instruction_pointer() const override;
+	virtual QString runState() const override;
+
+public:
+	virtual void get_state(State *state) override;
+	virtual void set_state(const State &state) override;
+
+public:
+	virtual Status step() override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual Status resume() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status stop() override;
+
+public:
+	virtual bool isPaused() const override;
+
+private:
+	const QByteArray &registers();
+
+private:
+	RemoteProcess *const process_;
+	edb::tid_t           tid_;
+	QString              name_;
+	QByteArray           registers_; // the raw 'g' reply, until the next resume
+};
+
+// A process behind a GDB remote stub. The stub is asked as little as possible:
+// memory is cached a page at a time until the process runs again, reads of
+// many pages go out as one pipelined batch, and the registers, the memory map
+// and the thread list are fetched once per stop. What the views read at one
+// stop is fetched along with the registers at the next, so a stop usually
+// costs a single round trip
+class RemoteProcess : public IProcess {
+	Q_DECLARE_TR_FUNCTIONS(RemoteProcess)
+	friend class RemoteThread;
+
+public:
+	// the most pages prefetched at a stop, what is read first is what the
+	// views show, scans and the like come later
+	static constexpr int PrefetchPages = 32;
+
+public:
+	enum class StopKind {
+		Stopped,
+		Exited,
+		Terminated
+	};
+
+	struct Stop {
+		StopKind   kind    = StopKind::Stopped;
+		edb::pid_t pid     = 0;
+		edb::tid_t tid     = 0;
+		int        signal  = 0;     // host numbering
+		int        code    = 0;     // the exit code
+		bool       stepped = false; // the stop ends a single step
+		QHash<int, edb::address_t> expedited; // registers sent with the stop
+	};
+
+public:
+	RemoteProcess(DebuggerCore *core, edb::address_t page_size);
+	virtual ~RemoteProcess() override;
+
+private:
+	RemoteProcess(const RemoteProcess &) = delete;
+	RemoteProcess& operator=(const RemoteProcess &) = delete;
+
+public:
+	Status connect(const QString &host, quint16 port);
+	bool wait_stop(int msecs, Stop *stop);
+	bool is64Bit() const { return is64_; }
+
+public:
+	virtual QDateTime                       start_time() const override;
+	virtual QList<QByteArray>               arguments() const override;
+	virtual QString                         current_working_directory() const override;
+	virtual QString                         executable() const override;
+	virtual edb::pid_t                      pid() const override;
+	virtual std::shared_ptr<IProcess>       parent() const override;
+	virtual edb::address_t                  code_address() const override;
+	virtual edb::address_t                  data_address() const override;
+	virtual QList<std::shared_ptr<IRegion>> regions() const override;
+	virtual QList<std::shared_ptr<IThread>> threads() const override;
+	virtual std::shared_ptr<IThread>        current_thread() const override;
+	virtual void                            set_current_thread(IThread& thread) override;
+	virtual edb::uid_t                      uid() const override;
+	virtual QString                         user() const override;
+	virtual QString                         name() const override;
+	virtual QList<Module>                   loaded_modules() const override;
+
+public:
+	virtual std::size_t write_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t patch_bytes(edb::address_t address, const void *buf, size_t len) override;
+	virtual std::size_t read_bytes(edb::address_t address, void *buf, size_t len) const override;
+	virtual std::size_t read_pages(edb::address_t address, void *buf, size_t count) const override;
+	virtual Status pause() override;
+	virtual Status resume(edb::EVENT_STATUS status) override;
+	virtual Status step(edb::EVENT_STATUS status) override;
+	virtual bool isPaused() const override;
+	virtual QMap<edb::address_t, Patch> patches() const override;
+	virtual QList<Patch> patches_in(edb::address_t address, std::size_t size) const override;
+
+public:
+	virtual QVector<std::size_t> read_many(const QVector<ReadRequest> &requests) const override;
+	virtual QVector<std::size_t> write_many(const QVector<WriteRequest> &requests) override;
+	virtual quint64 memory_epoch() const override { return memory_epoch_; }
+
+public:
+	void detach();
+	void kill();
+
+private:
+	QByteArray thread_id(edb::tid_t tid) const;
+	edb::tid_t parse_thread_id(const QByteArray &id) const;
+	QByteArray select_thread(edb::tid_t tid);
+	Status run(edb::tid_t tid, bool step, edb::EVENT_STATUS status);
+	void new_epoch();
+	void parse_stop(const QByteArray &reply, Stop *stop) const;
+	void update_threads() const;
+	QList<QByteArray> fetch_pages(const QVector<edb::address_t> &pages, const QList<QByteArray> &extra) const;
+	void touch_pages(const QVector<edb::address_t> &pages) const;
+	QByteArray read_request(edb::address_t address, std::size_t len) const;
+	bool read_reply(const QByteArray &reply, QByteArray *data) const;
+	std::size_t read_cached(edb::address_t address, char *buf, std::size_t len) const;
+	std::size_t read_direct(edb::address_t address, char *buf, std::size_t len) const;
+	QByteArray read_remote_file(const QByteArray &path) const;
+
+private:
+	DebuggerCore                            *core_;
+	mutable GdbRemote                        remote_;
+	mutable PageCache                        page_cache_;
+	mutable QSet<edb::address_t>             unreadable_pages_; // for this stop
+	mutable QVector<edb::address_t>          touched_pages_;    // in the order this stop read them
+	QVector<edb::address_t>                  working_set_;      // what the last stop read, prefetched at the next
+	mutable QList<std::shared_ptr<IRegion>>  regions_;
+	mutable MapsParser                       maps_;
+	mutable bool                             regions_valid_ = false;
+	mutable QList<std::shared_ptr<IThread>>  threads_;
+	mutable bool                             threads_valid_ = false;
+	mutable QString                          executable_;
+	std::shared_ptr<IThread>                 current_thread_;
+	PatchLedger                              patches_;
+	edb::address_t                           page_size_;
+	edb::pid_t                               pid_            = 0;
+	edb::tid_t                               general_thread_ = 0; // what Hg last selected
+	bool                                     is64_           = false;
+	bool                                     running_        = false;
+	bool                                     stepping_       = false;
+	bool                                     exited_         = false;
+	bool                                     binary_reads_   = false; // 'x' instead of hex 'm'
+	int                                      last_signal_    = 0; // what the last stop was for
+	quint64                                  stop_round_trips_ = 0;
+	quint64                                  memory_epoch_     = 0; // bumped whenever page_cache_ is invalidated
+};
+
+}
+
+#endif
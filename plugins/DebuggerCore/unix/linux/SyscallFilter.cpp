@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SyscallFilter.h"
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <cstddef>
+#include <linux/audit.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#ifndef PR_SET_NO_NEW_PRIVS
+#define PR_SET_NO_NEW_PRIVS 38
+#endif
+
+namespace DebuggerCorePlugin {
+namespace syscall_filter {
+
+namespace {
+
+#if defined(EDB_X86_64)
+const quint32 NativeArch = AUDIT_ARCH_X86_64;
+#elif defined(EDB_X86)
+const quint32 NativeArch = AUDIT_ARCH_I386;
+#endif
+
+//------------------------------------------------------------------------------
+// Name: statement
+// Desc:
+//------------------------------------------------------------------------------
+sock_filter statement(quint16 code, quint32 k) {
+	sock_filter s = BPF_STMT(code, k);
+	return s;
+}
+
+//------------------------------------------------------------------------------
+// Name: jump
+// Desc:
+//------------------------------------------------------------------------------
+sock_filter jump(quint16 code, quint32 k, quint8 jt, quint8 jf) {
+	sock_filter j = BPF_JUMP(code, k, jt, jf);
+	return j;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: build
+// Desc: a filter which hands <syscalls> to the tracer, with the number as
+//       the event message, and allows everything else. Returns an empty
+//       filter when the list can't be done this way:
+//       * an empty list means every system call, which PTRACE_SYSCALL does
+//         better
+//       * the filter is installed right before the exec, and a traced exec
+//         would fail with ENOSYS since the ptrace options aren't set yet
+//       * only native system calls are matched, so 32-bit processes run by
+//         a 64-bit edb get nothing from it
+//------------------------------------------------------------------------------
+std::vector<sock_filter> build(const QSet<int> &syscalls) {
+
+	std::vector<sock_filter> filter;
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(syscalls.isEmpty() || syscalls.size() > MaxSyscalls) {
+		return filter;
+	}
+
+#ifdef __NR_execveat
+	if(syscalls.contains(__NR_execveat)) {
+		return filter;
+	}
+#endif
+
+	if(syscalls.contains(__NR_execve)) {
+		return filter;
+	}
+
+	const QList<int> numbers = syscalls.toList();
+	const quint8 count       = static_cast<quint8>(numbers.size());
+
+	// other architectures skip ahead to the final allow
+	filter.push_back(statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)));
+	filter.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, NativeArch, 0, 2 * count + 1));
+	filter.push_back(statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)));
+
+	for(int number : numbers) {
+		filter.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, number, 0, 1));
+		filter.push_back(statement(BPF_RET | BPF_K, SECCOMP_RET_TRACE | (number & SECCOMP_RET_DATA)));
+	}
+
+	filter.push_back(statement(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+#else
+	Q_UNUSED(syscalls);
+#endif
+
+	return filter;
+}
+
+//------------------------------------------------------------------------------
+// Name: install
+// Desc: applies <filter> to the calling process, meant to be called by the
+//       child between fork and exec
+//------------------------------------------------------------------------------
+bool install(const std::vector<sock_filter> &filter) {
+
+	sock_fprog program;
+	program.len    = static_cast<unsigned short>(filter.size());
+	program.filter = const_cast<sock_filter *>(filter.data());
+
+	// required to install a filter without CAP_SYS_ADMIN
+	if(::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1) {
+		return false;
+	}
+
+	return ::prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program, 0, 0) != -1;
+}
+
+//------------------------------------------------------------------------------
+// Name: installed
+// Desc: returns true if <pid> runs under a seccomp filter, so we can tell if
+//       the child managed to install ours
+//------------------------------------------------------------------------------
+bool installed(edb::pid_t pid) {
+
+	QFile file(QString("/proc/%1/status").arg(pid));
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+
+	while(!file.atEnd()) {
+		const QString line = QString::fromLatin1(file.readLine());
+		if(line.startsWith("Seccomp:")) {
+			return line.mid(8).trimmed().toInt() == SECCOMP_MODE_FILTER;
+		}
+	}
+
+	return false;
+}
+
+}
+}
@@ -0,0 +1,40 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SYSCALL_FILTER_20170707_H_
+#define SYSCALL_FILTER_20170707_H_
+
+#include "OSTypes.h"
+#include <QSet>
+#include <linux/filter.h>
+#include <vector>
+
+namespace DebuggerCorePlugin {
+namespace syscall_filter {
+
+// longer lists are left to PTRACE_SYSCALL, the filter is a linear search
+// and the jumps in it only have 8 bits
+constexpr int MaxSyscalls = 64;
+
+std::vector<sock_filter> build(const QSet<int> &syscalls);
+bool install(const std::vector<sock_filter> &filter);
+bool installed(edb::pid_t pid);
+
+}
+}
+
+#endif
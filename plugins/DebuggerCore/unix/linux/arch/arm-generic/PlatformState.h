@@ -40,6 +40,9 @@ struct user_vfp
 };
 
 class PlatformState : public IState {
+	friend class CoreThread;
+	friend class ImageThread;
+	friend class RemoteThread;
 	friend class DebuggerCore;
 	friend class PlatformThread;
 
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PlatformThread.h"
 #include "DebuggerCore.h"
 #include "IProcess.h"
+#include "Instrumentation.h"
 #include "PlatformCommon.h"
 #include "PlatformState.h"
 #include <QtDebug>
@@ -33,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define _GNU_SOURCE        /* or _BSD_SOURCE or _SVID_SOURCE */
 #endif
 
+#include <cstring>
 #include <elf.h>
 #include <linux/uio.h>
 #include <sys/ptrace.h>
@@ -124,14 +126,31 @@ bool PlatformThread::fillStateFromVFPRegs(PlatformState* state) {
 // Desc:
 //------------------------------------------------------------------------------
 void PlatformThread::get_state(State *state) {
+	EDB_TRACE_SEGMENT("PlatformThread::get_state", StateFetch);
+
 	// TODO: assert that we are paused
 
 	core_->detectCPUMode();
 
-	if(auto state_impl = static_cast<PlatformState *>(state->impl_)) {
+	if(state_cache_) {
+		// the caller's copy shares the cached registers until it changes them
+		state->impl_ = state_cache_;
+		++state_cache_hits_;
+		return;
+	}
+
+	// start from a fresh state rather than detaching whatever the caller had
+	state->impl_.reset();
+
+	if(auto state_impl = static_cast<PlatformState *>(state->writable_impl())) {
 
 		fillStateFromSimpleRegs(state_impl);
 		fillStateFromVFPRegs(state_impl);
+
+		// only a stopped thread's registers stay put
+		if(core_->waited_threads_.contains(tid_)) {
+			state_cache_ = state->impl_;
+		}
 	}
 }
 
@@ -143,7 +162,9 @@ void PlatformThread::set_state(const State &state) {
 
 	// TODO: assert that we are paused
 
-	if(auto state_impl = static_cast<PlatformState *>(state.impl_)) {
+	state_cache_.reset();
+
+	if(auto state_impl = static_cast<PlatformState *>(state.impl_.get())) {
 
 		user_regs regs;
 		state_impl->fillStruct(regs);
@@ -175,183 +196,361 @@ long PlatformThread::set_debug_register(std::size_t n, long value) {
 	return 0;
 }
 
-Status PlatformThread::doStep(const edb::tid_t tid, const long status) {
+namespace {
+
+enum {
+	CPSR_Tbit     = 1<<5,
+
+	CPSR_ITbits72 = 1<<10,
+	CPSR_ITmask72 = 0xfc00,
+
+	CPSR_Jbit     = 1<<24,
+
+	CPSR_ITbits10 = 1<<25,
+	CPSR_ITmask10 = 0x06000000,
+};
+
+const auto addrSize=4; // The code here is ARM32-specific anyway...
+
+// the successor table is only a shortcut, it starts over once it gets this big
+constexpr int MaxStepSuccessors = 4096;
+
+//------------------------------------------------------------------------------
+// Name: condition_passed
+// Desc: whether an instruction with condition <cond> executes under <cpsr>
+//------------------------------------------------------------------------------
+bool condition_passed(quint32 cpsr, int cond) {
+	const bool N = (cpsr & 0x80000000) != 0;
+	const bool Z = (cpsr & 0x40000000) != 0;
+	const bool C = (cpsr & 0x20000000) != 0;
+	const bool V = (cpsr & 0x10000000) != 0;
+
+	bool passed = true;
+	switch(cond & 0xe) {
+	case 0x0: passed = Z;               break;
+	case 0x2: passed = C;               break;
+	case 0x4: passed = N;               break;
+	case 0x6: passed = V;               break;
+	case 0x8: passed = C && !Z;         break;
+	case 0xa: passed = N == V;          break;
+	case 0xc: passed = !Z && (N == V);  break;
+	case 0xe: return true; // AL, and the unconditional 0b1111
+	}
+
+	return (cond & 1) ? !passed : passed;
+}
+
+//------------------------------------------------------------------------------
+// Name: it_condition
+// Desc: the condition an IT block puts on the current Thumb instruction, or -1
+//       outside of one. capstone can't know it, it doesn't see the IT
+//------------------------------------------------------------------------------
+int it_condition(quint32 cpsr) {
+	if(!(cpsr & CPSR_Tbit)) {
+		return -1;
+	}
+
+	const quint32 itstate = ((cpsr & CPSR_ITmask72) >> 8) | ((cpsr & CPSR_ITmask10) >> 25);
+	if((itstate & 0xf) == 0) {
+		return -1;
+	}
+
+	return itstate >> 4;
+}
+
+//------------------------------------------------------------------------------
+// Name: interworking_target
+// Desc: where writing <value> to the PC goes when bit 0 selects the mode, as
+//       BX and loads into the PC do
+//------------------------------------------------------------------------------
+Status interworking_target(edb::address_t value, edb::address_t *target, IDebugger::CPUMode *targetMode) {
+	// FIXME: for ARMv5 or below (without "T" in the name) bits [1:0] are simply ignored, without any mode change
+	if(value&1) {
+		*targetMode=IDebugger::CPUMode::Thumb;
+		*target=value&~1;
+	} else {
+		if(value&0x3)
+			return Status(QObject::tr("won't try to set breakpoint at unaligned address"));
+		*targetMode=IDebugger::CPUMode::ARM32;
+		*target=value;
+	}
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: loaded_target
+// Desc: where an instruction loading the PC from <address> goes
+//------------------------------------------------------------------------------
+Status loaded_target(IProcess *process, edb::address_t address, edb::address_t *target, IDebugger::CPUMode *targetMode) {
+	edb::address_t value=0;
+	if(process->read_bytes(address, &value, addrSize)!=addrSize)
+		return Status(QObject::tr("failed to read memory the PC is loaded from (address %1).").arg(address.toPointerString()));
+	return interworking_target(value, target, targetMode);
+}
+
+//------------------------------------------------------------------------------
+// Name: classify_instruction
+// Desc: works out what can be known about stepping <insn> from its bytes alone,
+//       everything but <successor>'s bytes, which the caller copies
+//------------------------------------------------------------------------------
+Status classify_instruction(const edb::Instruction &insn, IDebugger::CPUMode mode, StepSuccessor *successor) {
+
+	successor->size       = insn.byte_size();
+	successor->mode       = mode;
+	successor->kind       = StepSuccessor::Kind::Next;
+	successor->condition  = insn.condition_code();
+	successor->target     = insn.rva() + insn.byte_size();
+	successor->targetMode = mode;
+
+	if(!modifies_pc(insn))
+		return Status::Ok;
+
+	const auto op=insn.operation();
+	if(op==ARM_INS_BXJ)
+		return Status(QObject::tr("EDB doesn't yet support single-stepping into Jazelle state."));
+
+	const auto opCount=insn.operand_count();
+	if(opCount==0)
+		return Status(QObject::tr("instruction %1 isn't supported yet.").arg(insn.mnemonic().c_str()));
+
+	switch(op)
+	{
+	case ARM_INS_BX:
+	case ARM_INS_BLX:
+	case ARM_INS_B:
+	case ARM_INS_BL:
+	{
+		if(opCount!=1)
+			return Status(QObject::tr("unexpected form of instruction %1 with %2 operands.").arg(insn.mnemonic().c_str()).arg(opCount));
+		const auto& operand=insn.operand(0);
+		assert(operand);
+		if(is_immediate(operand))
+		{
+			successor->kind=StepSuccessor::Kind::Branch;
+			successor->target=edb::address_t(util::to_unsigned(operand->imm));
+			if(op==ARM_INS_BX || op==ARM_INS_BLX)
+			{
+				if(mode==IDebugger::CPUMode::ARM32)
+					successor->targetMode=IDebugger::CPUMode::Thumb;
+				else
+					successor->targetMode=IDebugger::CPUMode::ARM32;
+			}
+			return Status::Ok;
+		}
+		else if(is_register(operand))
+		{
+			if(operand->reg==ARM_REG_PC && (op==ARM_INS_BX || op==ARM_INS_BLX))
+				return Status(QObject::tr("unpredictable instruction"));
+			// This may happen only with BX or BLX: B and BL require an immediate operand
+			successor->kind=StepSuccessor::Kind::Computed;
+			return Status::Ok;
+		}
+		return Status(QObject::tr("bad operand for %1 instruction.").arg(insn.mnemonic().c_str()));
+	}
+	case ARM_INS_LDR:
+	case ARM_INS_POP:
+	case ARM_INS_LDM:
+	case ARM_INS_LDMIB:
+	case ARM_INS_LDMDA:
+	case ARM_INS_LDMDB:
+	case ARM_INS_MOV:
+		successor->kind=StepSuccessor::Kind::Computed;
+		return Status::Ok;
+	default:
+		return Status(QObject::tr("instruction %1 modifies PC, but isn't a branch instruction known to EDB's single-stepper.").arg(insn.mnemonic().c_str()));
+	}
+}
 
-	const auto addrSize=4; // The code here is ARM32-specific anyway...
+//------------------------------------------------------------------------------
+// Name: computed_target
+// Desc: where <insn>, which writes the PC from registers or memory, goes when
+//       it is executed in <state>
+//------------------------------------------------------------------------------
+Status computed_target(IProcess *process, const edb::Instruction &insn, const State &state, IDebugger::CPUMode mode, edb::address_t *target, IDebugger::CPUMode *targetMode) {
+
+	const auto op=insn.operation();
+	const auto opCount=insn.operand_count();
+
+	switch(op)
+	{
+	case ARM_INS_LDR:
+	{
+		const auto destOperand=insn.operand(0);
+		if(!is_register(destOperand) || destOperand->reg!=ARM_REG_PC)
+			return Status(QObject::tr("instruction %1 with non-PC destination isn't supported yet.").arg(insn.mnemonic().c_str()));
+		const auto srcOperand=insn.operand(1);
+		if(!is_expression(srcOperand))
+			return Status(QObject::tr("unexpected type of second operand of LDR instruction."));
+		// with post-indexing the offset is a separate operand, and the load
+		// still comes from the unmodified base
+		const auto effAddrR=edb::v1::arch_processor().get_effective_address(insn, srcOperand, state);
+		if(!effAddrR) return Status(effAddrR.errorMessage());
+		return loaded_target(process, effAddrR.value(), target, targetMode);
+	}
+	case ARM_INS_POP:
+	{
+		for(int i=0;i<opCount;++i)
+		{
+			const auto operand=insn.operand(i);
+			if(is_register(operand) && operand->reg==ARM_REG_PC)
+			{
+				assert(operand->access==CS_AC_WRITE);
+				const auto sp=state.gp_register_value(PlatformState::GPR::SP);
+				return loaded_target(process, sp+addrSize*i, target, targetMode);
+			}
+		}
+		return Status(QObject::tr("internal EDB error: failed to locate PC in the instruction operand list"));
+	}
+	case ARM_INS_LDM:
+	case ARM_INS_LDMIB:
+	case ARM_INS_LDMDA:
+	case ARM_INS_LDMDB:
+	{
+		// the base, then the register list, where the PC always comes last
+		const auto baseOperand=insn.operand(0);
+		const auto lastOperand=insn.operand(opCount-1);
+		if(opCount<2 || !is_register(baseOperand) || !is_register(lastOperand) || lastOperand->reg!=ARM_REG_PC)
+			return Status(QObject::tr("unexpected form of instruction %1.").arg(insn.mnemonic().c_str()));
+		const auto baseR=edb::v1::arch_processor().get_effective_address(insn, baseOperand, state);
+		if(!baseR) return Status(baseR.errorMessage());
+
+		const auto base=baseR.value();
+		const int count=opCount-1;
+		switch(op)
+		{
+		case ARM_INS_LDM:   return loaded_target(process, base+addrSize*(count-1), target, targetMode);
+		case ARM_INS_LDMIB: return loaded_target(process, base+addrSize*count, target, targetMode);
+		case ARM_INS_LDMDA: return loaded_target(process, base, target, targetMode);
+		default:            return loaded_target(process, base-addrSize, target, targetMode);
+		}
+	}
+	case ARM_INS_MOV:
+	{
+		const auto srcOperand=insn.operand(1);
+		if(opCount!=2 || !is_register(srcOperand))
+			return Status(QObject::tr("unexpected form of instruction %1.").arg(insn.mnemonic().c_str()));
+		const auto result=edb::v1::arch_processor().get_effective_address(insn, srcOperand, state);
+		if(!result) return Status(result.errorMessage());
+		// ARM state interworks like BX does, Thumb state just branches
+		if(mode==IDebugger::CPUMode::ARM32)
+			return interworking_target(result.value(), target, targetMode);
+		*target=result.value()&~1;
+		*targetMode=mode;
+		return Status::Ok;
+	}
+	case ARM_INS_BX:
+	case ARM_INS_BLX:
+	{
+		const auto result=edb::v1::arch_processor().get_effective_address(insn, insn.operand(0), state);
+		if(!result) return Status(result.errorMessage());
+		return interworking_target(result.value(), target, targetMode);
+	}
+	default:
+		return Status(QObject::tr("instruction %1 modifies PC, but isn't a branch instruction known to EDB's single-stepper.").arg(insn.mnemonic().c_str()));
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: doStep
+// Desc: steps by running to a one time breakpoint on the next instruction,
+//       there's no hardware single-step to use
+//------------------------------------------------------------------------------
+Status PlatformThread::doStep(const edb::tid_t tid, const long status) {
 
 	State state;
 	get_state(&state);
 	if(state.empty()) return Status(QObject::tr("failed to get thread state."));
 	const auto pc=state.instruction_pointer();
-	const auto flags=state.flags();
-	enum {
-		CPSR_Tbit     = 1<<5,
-
-		CPSR_ITbits72 = 1<<10,
-		CPSR_ITmask72 = 0xfc00,
-
-		CPSR_Jbit     = 1<<24,
-
-		CPSR_ITbits10 = 1<<25,
-		CPSR_ITmask10 = 0x06000000,
-	};
+	const quint32 flags=state.flags().toUint();
 	if(flags & CPSR_Jbit)
 		return Status(QObject::tr("EDB doesn't yet support single-stepping in Jazelle state."));
-	if(flags&CPSR_Tbit && flags&(CPSR_ITmask10 | CPSR_ITmask72))
-		return Status(QObject::tr("EDB doesn't yet support single-stepping inside Thumb-2 IT-block."));
+
 	quint8 buffer[4];
-	if(const int size = edb::v1::get_instruction_bytes(pc, buffer))
+	const int size=edb::v1::get_instruction_bytes(pc, buffer);
+	if(!size)
+		return Status(QObject::tr("failed to get instruction bytes at address %1.").arg(pc.toPointerString()));
+
+	const auto mode=core_->cpu_mode();
+
+	// the bytes decide everything but computed destinations, so an instruction
+	// which was stepped before only needs its condition checked again
+	StepSuccessor successor;
+	auto cached=stepSuccessors_.constFind(pc);
+	if(cached!=stepSuccessors_.constEnd() && cached->mode==mode && cached->size<=size && std::memcmp(cached->bytes.data(), buffer, cached->size)==0)
 	{
-		if(const auto insn=edb::Instruction(buffer, buffer + size, pc))
-		{
+		successor=*cached;
+	}
+	else
+	{
+		const auto insn=edb::decode(buffer, buffer + size, pc.toUint());
+		if(!insn || !*insn)
+			return Status(QObject::tr("failed to disassemble instruction at address %1.").arg(pc.toPointerString()));
 
-			const auto op=insn.operation();
-			edb::address_t addrAfterInsn=pc+insn.byte_size();
+		const Status classified=classify_instruction(*insn, mode, &successor);
+		if(!classified) return classified;
 
-			auto targetMode=core_->cpu_mode();
-			if(modifies_pc(insn) && edb::v1::arch_processor().is_executed(insn,state))
-			{
-				if(op==ARM_INS_BXJ)
-					return Status(QObject::tr("EDB doesn't yet support single-stepping into Jazelle state."));
-
-				const auto opCount=insn.operand_count();
-				if(opCount==0)
-					return Status(QObject::tr("instruction %1 isn't supported yet.").arg(insn.mnemonic().c_str()));
-
-				switch(op)
-				{
-				case ARM_INS_LDR:
-				{
-					const auto destOperand=insn.operand(0);
-					if(!is_register(destOperand) || destOperand->reg!=ARM_REG_PC)
-						return Status(QObject::tr("instruction %1 with non-PC destination isn't supported yet.").arg(insn.mnemonic().c_str()));
-					const auto srcOperand=insn.operand(1);
-					if(!is_expression(srcOperand))
-						return Status(QObject::tr("unexpected type of second operand of LDR instruction."));
-					const auto effAddrR=edb::v1::arch_processor().get_effective_address(insn, srcOperand, state);
-					if(!effAddrR) return Status(effAddrR.errorMessage());
-
-					const auto effAddr=effAddrR.value();
-					if(process_->read_bytes(effAddr, &addrAfterInsn, addrSize)!=addrSize)
-						return Status(QObject::tr("failed to read memory referred to by LDR operand (address %1).").arg(effAddr.toPointerString()));
-
-					// FIXME: for ARMv5 or below (without "T" in the name) bits [1:0] are simply ignored, without any mode change
-					if(addrAfterInsn&1)
-						targetMode=IDebugger::CPUMode::Thumb;
-					else
-						targetMode=IDebugger::CPUMode::ARM32;
-					switch(edb::v1::debugger_core->cpu_mode())
-					{
-					case IDebugger::CPUMode::Thumb:
-						addrAfterInsn&=-2;
-						break;
-					case IDebugger::CPUMode::ARM32:
-						addrAfterInsn&=-4;
-						break;
-					default:
-						return Status(QObject::tr("single-stepping LDR instruction in modes other than ARM or Thumb is not supported yet."));
-					}
-					break;
-				}
-				case ARM_INS_POP:
-				{
-					int i=0;
-					for(;i<opCount;++i)
-					{
-						const auto operand=insn.operand(i);
-						if(is_register(operand) && operand->reg==ARM_REG_PC)
-						{
-							assert(operand->access==CS_AC_WRITE);
-							const auto sp=state.gp_register(PlatformState::GPR::SP);
-							if(!sp) return Status(QObject::tr("failed to get value of SP register"));
-							if(process_->read_bytes(sp.valueAsAddress()+addrSize*i, &addrAfterInsn, addrSize)!=addrSize)
-								return Status(QObject::tr("failed to read thread stack"));
-							break;
-						}
-					}
-					if(i==opCount)
-						return Status(QObject::tr("internal EDB error: failed to locate PC in the instruction operand list"));
-					break;
-				}
-				case ARM_INS_BX:
-				case ARM_INS_BLX:
-				case ARM_INS_B:
-				case ARM_INS_BL:
-				{
-					if(opCount!=1)
-						return Status(QObject::tr("unexpected form of instruction %1 with %2 operands.").arg(insn.mnemonic().c_str()).arg(opCount));
-					const auto& operand=insn.operand(0);
-					assert(operand);
-					if(is_immediate(operand))
-					{
-						addrAfterInsn=edb::address_t(util::to_unsigned(operand->imm));
-						if(op==ARM_INS_BX || op==ARM_INS_BLX)
-						{
-							if(targetMode==IDebugger::CPUMode::ARM32)
-								targetMode=IDebugger::CPUMode::Thumb;
-							else
-								targetMode=IDebugger::CPUMode::ARM32;
-						}
-						break;
-					}
-					else if(is_register(operand))
-					{
-						if(operand->reg==ARM_REG_PC && (op==ARM_INS_BX || op==ARM_INS_BLX))
-							return Status(QObject::tr("unpredictable instruction"));
-						// This may happen only with BX or BLX: B and BL require an immediate operand
-						const auto result=edb::v1::arch_processor().get_effective_address(insn, operand, state);
-						if(!result) return Status(result.errorMessage());
-						addrAfterInsn=result.value();
-						if(addrAfterInsn&1)
-							targetMode=IDebugger::CPUMode::Thumb;
-						else
-							targetMode=IDebugger::CPUMode::ARM32;
-						addrAfterInsn&=~1;
-						if(addrAfterInsn&0x3 && targetMode!=IDebugger::CPUMode::Thumb)
-							return Status(QObject::tr("won't try to set breakpoint at unaligned address"));
-						break;
-					}
-					return Status(QObject::tr("bad operand for %1 instruction.").arg(insn.mnemonic().c_str()));
-				}
-				default:
-					return Status(QObject::tr("instruction %1 modifies PC, but isn't a branch instruction known to EDB's single-stepper.").arg(insn.mnemonic().c_str()));
-				}
-			}
+		std::memcpy(successor.bytes.data(), buffer, successor.size);
+		if(stepSuccessors_.size()>=MaxStepSuccessors)
+			stepSuccessors_.clear();
+		stepSuccessors_.insert(pc, successor);
+	}
 
-			if(singleStepBreakpoint)
-				return Status(QObject::tr("internal EDB error: single-step breakpoint still present"));
-			if(const auto oldBP=core_->find_breakpoint(addrAfterInsn))
-			{
-				// TODO: EDB should support overlapping breakpoints
-				if(!oldBP->enabled())
-					return Status(QObject::tr("a disabled breakpoint is present at address %1, can't set one for single step.").arg(addrAfterInsn.toPointerString()));
-			}
-			else
+	// inside an IT block the condition comes from ITSTATE, not the encoding
+	const int itCondition=it_condition(flags);
+	const int condition=itCondition>=0 ? itCondition : successor.condition;
+
+	edb::address_t addrAfterInsn=pc+successor.size;
+	auto targetMode=mode;
+	if(successor.kind!=StepSuccessor::Kind::Next && condition_passed(flags, condition))
+	{
+		if(successor.kind==StepSuccessor::Kind::Branch)
+		{
+			addrAfterInsn=successor.target;
+			targetMode=successor.targetMode;
+		}
+		else
+		{
+			const auto insn=edb::decode(buffer, buffer + successor.size, pc.toUint());
+			if(!insn || !*insn)
+				return Status(QObject::tr("failed to disassemble instruction at address %1.").arg(pc.toPointerString()));
+
+			const Status computed=computed_target(process_, *insn, state, mode, &addrAfterInsn, &targetMode);
+			if(!computed) return computed;
+		}
+	}
+
+	if(singleStepBreakpoint)
+		return Status(QObject::tr("internal EDB error: single-step breakpoint still present"));
+	if(const auto oldBP=core_->find_breakpoint(addrAfterInsn))
+	{
+		// TODO: EDB should support overlapping breakpoints
+		if(!oldBP->enabled())
+			return Status(QObject::tr("a disabled breakpoint is present at address %1, can't set one for single step.").arg(addrAfterInsn.toPointerString()));
+	}
+	else
+	{
+		singleStepBreakpoint=core_->add_breakpoint(addrAfterInsn);
+		if(!singleStepBreakpoint)
+			return Status(QObject::tr("failed to set breakpoint at address %1.").arg(addrAfterInsn.toPointerString()));
+		const auto bp=std::static_pointer_cast<Breakpoint>(singleStepBreakpoint);
+		if(targetMode!=core_->cpu_mode())
+		{
+			switch(targetMode)
 			{
-				singleStepBreakpoint=core_->add_breakpoint(addrAfterInsn);
-				if(!singleStepBreakpoint)
-					return Status(QObject::tr("failed to set breakpoint at address %1.").arg(addrAfterInsn.toPointerString()));
-				const auto bp=std::static_pointer_cast<Breakpoint>(singleStepBreakpoint);
-				if(targetMode!=core_->cpu_mode())
-				{
-					switch(targetMode)
-					{
-					case IDebugger::CPUMode::ARM32:
-						bp->set_type(Breakpoint::TypeId::ARM32);
-						break;
-					case IDebugger::CPUMode::Thumb:
-						bp->set_type(Breakpoint::TypeId::Thumb2Byte);
-						break;
-					}
-				}
-				singleStepBreakpoint->set_one_time(true); // TODO: don't forget to remove it once we've paused after this, even if the BP wasn't hit (e.g. due to an exception on current instruction)
-				singleStepBreakpoint->set_internal(true);
+			case IDebugger::CPUMode::ARM32:
+				bp->set_type(Breakpoint::TypeId::ARM32);
+				break;
+			case IDebugger::CPUMode::Thumb:
+				bp->set_type(Breakpoint::TypeId::Thumb2Byte);
+				break;
 			}
-			return core_->ptrace_continue(tid, status);
 		}
-		return Status(QObject::tr("failed to disassemble instruction at address %1.").arg(pc.toPointerString()));
+		singleStepBreakpoint->set_one_time(true); // TODO: don't forget to remove it once we've paused after this, even if the BP wasn't hit (e.g. due to an exception on current instruction)
+		singleStepBreakpoint->set_internal(true);
 	}
-	return Status(QObject::tr("failed to get instruction bytes at address %1.").arg(pc.toPointerString()));
+	return core_->ptrace_continue(tid, status);
 }
 
 //------------------------------------------------------------------------------
@@ -752,8 +752,9 @@ void PlatformState::AVX::setZMM(size_t index, edb::value512 value) {
 
 void PlatformState::X86::clear() {
 	util::markMemory(this, sizeof(*this));
-	gpr32Filled = false;
-	gpr64Filled = false;
+	gpr32Filled   = false;
+	gpr64Filled   = false;
+	dbgRegsFilled = false;
 	for (auto &base : segRegBasesFilled) {
 		base = false;
 	}
@@ -908,7 +909,11 @@ Register PlatformState::value(const QString &reg) const {
 			return make_Register<16>(x86.IP16Name, x86.IP, Register::TYPE_IP);
 	}
 
-	if (x86.gpr32Filled) {
+	if (regName.startsWith("dr")) {
+		ensureDebug();
+	}
+
+	if (x86.gpr32Filled && x86.dbgRegsFilled) {
 		QRegExp DRx("^dr([0-7])$");
 		if (DRx.indexIn(regName) != -1) {
 			QChar digit = DRx.cap(1).at(0);
@@ -925,6 +930,11 @@ Register PlatformState::value(const QString &reg) const {
 		}
 	}
 
+	// only fetch the FPU/SIMD state for names which could be part of it
+	if (regName.startsWith('r') || regName.startsWith('f') || regName.startsWith("st") || regName.startsWith("mm") || regName.startsWith("xmm") || regName.startsWith("ymm") || regName == avx.mxcsrName) {
+		ensureExtended();
+	}
+
 	if (x87.filled) {
 		QRegExp Rx("^r([0-7])$");
 		if (Rx.indexIn(regName) != -1) {
@@ -1048,7 +1058,7 @@ Register PlatformState::instruction_pointer_register() const {
 // Desc: returns what is conceptually the frame pointer for this platform
 //------------------------------------------------------------------------------
 edb::address_t PlatformState::frame_pointer() const {
-	return gp_register(X86::RBP).valueAsAddress();
+	return gp_register_value(X86::RBP);
 }
 
 //------------------------------------------------------------------------------
@@ -1056,7 +1066,14 @@ edb::address_t PlatformState::frame_pointer() const {
 // Desc: returns the instruction pointer for this platform
 //------------------------------------------------------------------------------
 edb::address_t PlatformState::instruction_pointer() const {
-	return instruction_pointer_register().valueAsAddress();
+
+	if (x86.gpr64Filled && is64Bit()) {
+		return x86.IP;
+	} else if (x86.gpr32Filled) {
+		return edb::address_t::fromZeroExtended(edb::value32(x86.IP));
+	}
+
+	return 0;
 }
 
 //------------------------------------------------------------------------------
@@ -1064,7 +1081,7 @@ edb::address_t PlatformState::instruction_pointer() const {
 // Desc: returns the stack pointer for this platform
 //------------------------------------------------------------------------------
 edb::address_t PlatformState::stack_pointer() const {
-	return gp_register(X86::RSP).valueAsAddress();
+	return gp_register_value(X86::RSP);
 }
 
 //------------------------------------------------------------------------------
@@ -1073,6 +1090,7 @@ edb::address_t PlatformState::stack_pointer() const {
 //------------------------------------------------------------------------------
 edb::reg_t PlatformState::debug_register(size_t n) const {
 	assert(dbgIndexValid(n));
+	ensureDebug();
 	return x86.dbgRegs[n];
 }
 
@@ -1103,6 +1121,7 @@ edb::reg_t PlatformState::flags() const {
 // Desc:
 //------------------------------------------------------------------------------
 int PlatformState::fpu_stack_pointer() const {
+	ensureExtended();
 	return x87.stackPointer();
 }
 
@@ -1112,6 +1131,7 @@ int PlatformState::fpu_stack_pointer() const {
 //------------------------------------------------------------------------------
 edb::value80 PlatformState::fpu_register(size_t n) const {
 	assert(fpuIndexValid(n));
+	ensureExtended();
 
 	if (!x87.filled) {
 		edb::value80        v;
@@ -1131,6 +1151,7 @@ edb::value80 PlatformState::fpu_register(size_t n) const {
 // Desc: Returns true if Rn register is empty when treated in terms of FPU stack
 //------------------------------------------------------------------------------
 bool PlatformState::fpu_register_is_empty(size_t n) const {
+	ensureExtended();
 	return x87.tag(n) == X87::TAG_EMPTY;
 }
 
@@ -1139,6 +1160,7 @@ bool PlatformState::fpu_register_is_empty(size_t n) const {
 // Desc:
 //------------------------------------------------------------------------------
 QString PlatformState::fpu_register_tag_string(size_t n) const {
+	ensureExtended();
 	int tag = x87.tag(n);
 	static const std::unordered_map<int, QString> names{
 		{X87::TAG_VALID,   "Valid"},
@@ -1151,14 +1173,17 @@ QString PlatformState::fpu_register_tag_string(size_t n) const {
 }
 
 edb::value16 PlatformState::fpu_control_word() const {
+	ensureExtended();
 	return x87.controlWord;
 }
 
 edb::value16 PlatformState::fpu_status_word() const {
+	ensureExtended();
 	return x87.statusWord;
 }
 
 edb::value16 PlatformState::fpu_tag_word() const {
+	ensureExtended();
 	return x87.tagWord;
 }
 
@@ -1178,6 +1203,32 @@ void PlatformState::clear() {
 	x86.clear();
 	x87.clear();
 	avx.clear();
+	extendedLoader = nullptr;
+	debugLoader    = nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: ensureExtended
+// Desc: fetches the x87/SSE/AVX state if that hasn't been done yet
+//------------------------------------------------------------------------------
+void PlatformState::ensureExtended() const {
+	if (extendedLoader) {
+		const Loader loader = std::move(extendedLoader);
+		extendedLoader = nullptr;
+		loader(const_cast<PlatformState *>(this));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: ensureDebug
+// Desc: fetches the debug registers if that hasn't been done yet
+//------------------------------------------------------------------------------
+void PlatformState::ensureDebug() const {
+	if (debugLoader) {
+		const Loader loader = std::move(debugLoader);
+		debugLoader = nullptr;
+		loader(const_cast<PlatformState *>(this));
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -1194,6 +1245,7 @@ bool PlatformState::empty() const {
 //------------------------------------------------------------------------------
 void PlatformState::set_debug_register(size_t n, edb::reg_t value) {
 	assert(dbgIndexValid(n));
+	ensureDebug();
 	x86.dbgRegs[n] = value;
 }
 
@@ -1231,6 +1283,23 @@ Register PlatformState::gp_register(size_t n) const {
 	return Register();
 }
 
+//------------------------------------------------------------------------------
+// Name: gp_register_value
+// Desc: the value gp_register would hold, without naming it
+//------------------------------------------------------------------------------
+edb::reg_t PlatformState::gp_register_value(size_t n) const {
+
+	if (gprIndexValid(n)) {
+		if (x86.gpr64Filled && is64Bit()) {
+			return x86.GPRegs[n];
+		} else if (x86.gpr32Filled && n < IA32_GPR_COUNT) {
+			return edb::reg_t::fromZeroExtended(edb::value32(x86.GPRegs[n]));
+		}
+	}
+
+	return 0;
+}
+
 //------------------------------------------------------------------------------
 // Name: set_register
 // Desc:
@@ -1238,6 +1307,10 @@ Register PlatformState::gp_register(size_t n) const {
 void PlatformState::set_register(const Register &reg) {
 	const QString regName = reg.name().toLower();
 
+	// the whole state gets written back, so it all has to be there
+	ensureExtended();
+	ensureDebug();
+
 	const auto gpr_end            = GPRegNames().begin() + gpr_count();
 	const auto GPRegNameFoundIter = std::find(GPRegNames().begin(), gpr_end, regName);
 
@@ -1400,6 +1473,7 @@ void PlatformState::set_register(const QString &name, edb::reg_t value) {
 // Desc:
 //------------------------------------------------------------------------------
 Register PlatformState::mmx_register(size_t n) const {
+	ensureExtended();
 	if (!mmxIndexValid(n)) {
 		return Register();
 	}
@@ -1413,6 +1487,7 @@ Register PlatformState::mmx_register(size_t n) const {
 // Desc:
 //------------------------------------------------------------------------------
 Register PlatformState::xmm_register(size_t n) const {
+	ensureExtended();
 	if (!xmmIndexValid(n) || !avx.xmmFilledIA32) {
 		return Register();
 	}
@@ -1430,6 +1505,7 @@ Register PlatformState::xmm_register(size_t n) const {
 // Desc:
 //------------------------------------------------------------------------------
 Register PlatformState::ymm_register(size_t n) const {
+	ensureExtended();
 	if (!ymmIndexValid(n) || !avx.ymmFilled) {
 		return Register();
 	}
@@ -1437,4 +1513,34 @@ Register PlatformState::ymm_register(size_t n) const {
 	edb::value256 value(avx.ymm(n));
 	return make_Register(QString("ymm%1").arg(n), value, Register::TYPE_SIMD);
 }
+
+//------------------------------------------------------------------------------
+// Name: xmm_register_value
+// Desc: the value xmm_register would hold, without naming it
+//------------------------------------------------------------------------------
+edb::value128 PlatformState::xmm_register_value(size_t n) const {
+	ensureExtended();
+	if (!xmmIndexValid(n) || !avx.xmmFilledIA32) {
+		return edb::value128(std::array<std::uint8_t, 16>());
+	}
+
+	if (n >= IA32_XMM_REG_COUNT && !avx.xmmFilledAMD64) {
+		return edb::value128(std::array<std::uint8_t, 16>());
+	}
+
+	return edb::value128(avx.xmm(n));
+}
+
+//------------------------------------------------------------------------------
+// Name: ymm_register_value
+// Desc: the value ymm_register would hold, without naming it
+//------------------------------------------------------------------------------
+edb::value256 PlatformState::ymm_register_value(size_t n) const {
+	ensureExtended();
+	if (!ymmIndexValid(n) || !avx.ymmFilled) {
+		return edb::value256(std::array<std::uint8_t, 32>());
+	}
+
+	return edb::value256(avx.ymm(n));
+}
 }
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PrStatus.h"
 #include "edb.h"
 #include <cstddef>
+#include <functional>
 #include <sys/user.h>
 
 namespace DebuggerCorePlugin {
@@ -223,6 +224,9 @@ static_assert(offsetof(X86XState, xcr0) == 464, "XCR0 should appear at offset 46
 static_assert(offsetof(X86XState, ymmh_space) == 576, "YMM_H space should appear at offset 576");
 
 class PlatformState : public IState {
+	friend class CoreThread;
+	friend class ImageThread;
+	friend class RemoteThread;
 	friend class DebuggerCore;
 	friend class PlatformThread;
 
@@ -262,6 +266,9 @@ public:
 	virtual Register xmm_register(size_t n) const;
 	virtual Register ymm_register(size_t n) const;
 	virtual Register gp_register(size_t n) const;
+	virtual edb::reg_t gp_register_value(size_t n) const;
+	virtual edb::value128 xmm_register_value(size_t n) const;
+	virtual edb::value256 ymm_register_value(size_t n) const;
 
 	bool is64Bit() const {
 		return edb::v1::debuggeeIs64Bit();
@@ -464,12 +471,23 @@ private:
 		std::array<bool, MAX_SEG_REG_COUNT>           segRegBasesFilled = {{false}};
 		bool                                          gpr64Filled = false;
 		bool                                          gpr32Filled = false;
+		bool                                          dbgRegsFilled = false;
 
 	public:
 		void clear();
 		bool empty() const;
 	} x86;
 
+	// The x87/SSE/AVX state and the debug registers are only fetched from the
+	// thread once something asks for them, these do the fetching
+	using Loader = std::function<void(PlatformState *)>;
+
+	mutable Loader extendedLoader;
+	mutable Loader debugLoader;
+
+	void ensureExtended() const;
+	void ensureDebug() const;
+
 	bool dbgIndexValid(size_t n) const {
 		return n < dbg_reg_count();
 	}
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PlatformThread.h"
 #include "DebuggerCore.h"
 #include "IProcess.h"
+#include "Instrumentation.h"
 #include "PlatformCommon.h"
 #include "PlatformState.h"
 #include <QtDebug>
@@ -156,16 +157,125 @@ bool PlatformThread::fillStateFromSimpleRegs(PlatformState* state) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: fillExtendedState
+// Desc: fetches the x87/SSE/AVX state
+//------------------------------------------------------------------------------
+void PlatformThread::fillExtendedState(PlatformState *state_impl) {
+
+	// First try to get full XSTATE
+	X86XState xstate;
+	struct iovec iov = { &xstate, sizeof(xstate) };
+
+	long status = ptrace(PTRACE_GETREGSET, tid_, NT_X86_XSTATE, &iov);
+
+	if(status == -1 || !state_impl->fillFrom(xstate,iov.iov_len)) {
+
+		// No XSTATE available, get just floating point and SSE registers
+		static bool getFPXRegsSupported = EDB_IS_32_BIT;
+
+		UserFPXRegsStructX86 fpxregs;
+
+		// This should be automatically optimized out on amd64. If not, not a big deal.
+		// Avoiding conditional compilation to facilitate syntax error checking
+		if(getFPXRegsSupported) {
+			getFPXRegsSupported = (ptrace(PTRACE_GETFPXREGS, tid_, 0, &fpxregs) != -1);
+		}
+
+		if(getFPXRegsSupported) {
+			state_impl->fillFrom(fpxregs);
+		} else {
+			// No GETFPXREGS: on x86 this means SSE is not supported
+			//                on x86_64 FPREGS already contain SSE state
+			struct user_fpregs_struct fpregs;
+			status = ptrace(PTRACE_GETFPREGS, tid_, 0, &fpregs);
+
+			if(status != -1) {
+				state_impl->fillFrom(fpregs);
+			} else {
+				perror("PTRACE_GETFPREGS failed");
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: fillDebugRegisters
+// Desc:
+//------------------------------------------------------------------------------
+void PlatformThread::fillDebugRegisters(PlatformState *state_impl) {
+	for(std::size_t i = 0; i < 8; ++i) {
+		state_impl->x86.dbgRegs[i] = get_debug_register(i);
+	}
+	state_impl->x86.dbgRegsFilled = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: make_loader
+// Desc: returns a loader which fills in part of a state using <fill>, as long
+//       as this thread hasn't run since the state was fetched. The thread's
+//       cached copy is filled in along the way so that it is only done once
+//------------------------------------------------------------------------------
+std::function<void(PlatformState *)> PlatformThread::make_loader(void (PlatformThread::*fill)(PlatformState *)) {
+
+	DebuggerCore *const core = core_;
+	const edb::tid_t tid     = tid_;
+	const quint64 generation = state_generation_;
+
+	return [core, tid, generation, fill](PlatformState *state) {
+		auto it = core->threads_.find(tid);
+		if(it == core->threads_.end() || it.value()->state_generation_ != generation) {
+			// it has run since, whatever we'd read now belongs to another stop
+			return;
+		}
+
+		PlatformThread *const thread = it.value().get();
+		auto cached = static_cast<PlatformState *>(thread->state_cache_.get());
+
+		if(!cached || cached == state) {
+			(thread->*fill)(state);
+			return;
+		}
+
+		// fetch it once for the cache, then copy it from there
+		if(fill == &PlatformThread::fillExtendedState) {
+			cached->ensureExtended();
+		} else {
+			cached->ensureDebug();
+		}
+
+		if(fill == &PlatformThread::fillExtendedState) {
+			state->x87 = cached->x87;
+			state->avx = cached->avx;
+		} else {
+			state->x86.dbgRegs       = cached->x86.dbgRegs;
+			state->x86.dbgRegsFilled = cached->x86.dbgRegsFilled;
+		}
+	};
+}
+
 //------------------------------------------------------------------------------
 // Name: get_state
 // Desc:
 //------------------------------------------------------------------------------
 void PlatformThread::get_state(State *state) {
+	EDB_TRACE_SEGMENT("PlatformThread::get_state", StateFetch);
+
 	// TODO: assert that we are paused
 
 	core_->detectCPUMode();
 
-	if(auto state_impl = static_cast<PlatformState *>(state->impl_)) {
+	if(state_cache_) {
+		// the caller's copy shares the cached registers until it changes them
+		state->impl_ = state_cache_;
+		++state_cache_hits_;
+		return;
+	}
+
+	// start from a fresh state rather than detaching whatever the caller had
+	state->impl_.reset();
+
+	if(auto state_impl = static_cast<PlatformState *>(state->writable_impl())) {
 
 		// State must be cleared before filling to zero all presence flags, otherwise something
 		// may remain not updated. Also, this way we'll mark all the unfilled values.
@@ -180,44 +290,14 @@ void PlatformThread::get_state(State *state) {
 			// failing that, try to just get what we can
 		}
 
-		// First try to get full XSTATE
-		X86XState xstate;
-		struct iovec iov = { &xstate, sizeof(xstate) };
-
-		long status = ptrace(PTRACE_GETREGSET, tid_, NT_X86_XSTATE, &iov);
-
-		if(status == -1 || !state_impl->fillFrom(xstate,iov.iov_len)) {
+		// the FPU/SIMD state and the debug registers take a lot more to fetch
+		// and are rarely looked at, so leave them until something asks
+		state_impl->extendedLoader = make_loader(&PlatformThread::fillExtendedState);
+		state_impl->debugLoader    = make_loader(&PlatformThread::fillDebugRegisters);
 
-			// No XSTATE available, get just floating point and SSE registers
-			static bool getFPXRegsSupported = EDB_IS_32_BIT;
-
-			UserFPXRegsStructX86 fpxregs;
-
-			// This should be automatically optimized out on amd64. If not, not a big deal.
-			// Avoiding conditional compilation to facilitate syntax error checking
-			if(getFPXRegsSupported) {
-				getFPXRegsSupported = (ptrace(PTRACE_GETFPXREGS, tid_, 0, &fpxregs) != -1);
-			}
-
-			if(getFPXRegsSupported) {
-				state_impl->fillFrom(fpxregs);
-			} else {
-				// No GETFPXREGS: on x86 this means SSE is not supported
-				//                on x86_64 FPREGS already contain SSE state
-				struct user_fpregs_struct fpregs;
-				status = ptrace(PTRACE_GETFPREGS, tid_, 0, &fpregs);
-
-				if(status != -1) {
-					state_impl->fillFrom(fpregs);
-				} else {
-					perror("PTRACE_GETFPREGS failed");
-				}
-			}
-		}
-
-		// debug registers
-		for(std::size_t i = 0; i < 8; ++i) {
-			state_impl->x86.dbgRegs[i] = get_debug_register(i);
+		// only a stopped thread's registers stay put
+		if(core_->waited_threads_.contains(tid_)) {
+			state_cache_ = state->impl_;
 		}
 	}
 }
@@ -230,7 +310,9 @@ void PlatformThread::set_state(const State &state) {
 
 	// TODO: assert that we are paused
 
-	if(auto state_impl = static_cast<PlatformState *>(state.impl_)) {
+	state_cache_.reset();
+
+	if(auto state_impl = static_cast<PlatformState *>(state.impl_.get())) {
 		bool setPrStatusDone = false;
 
 		if(EDB_IS_32_BIT && state_impl->is64Bit()) {
@@ -253,9 +335,17 @@ void PlatformThread::set_state(const State &state) {
 			ptrace(PTRACE_SETREGS, tid_, 0, &regs);
 		}
 
-		// debug registers
-		for(std::size_t i = 0;i < 8; ++i) {
-			set_debug_register(i, state_impl->x86.dbgRegs[i]);
+		// debug registers, unless they were never fetched and so can't have
+		// been changed either
+		if(state_impl->x86.dbgRegsFilled) {
+			for(std::size_t i = 0;i < 8; ++i) {
+				set_debug_register(i, state_impl->x86.dbgRegs[i]);
+			}
+		}
+
+		// same for the FPU/SIMD state
+		if(!state_impl->x87.filled) {
+			return;
 		}
 
 		// hope for the best, adjust for reality
@@ -307,9 +397,56 @@ unsigned long PlatformThread::get_debug_register(std::size_t n) {
 // Desc:
 //------------------------------------------------------------------------------
 long PlatformThread::set_debug_register(std::size_t n, long value) {
+	state_cache_.reset();
 	return ptrace(PTRACE_POKEUSER, tid_, offsetof(struct user, u_debugreg[n]), value);
 }
 
+//------------------------------------------------------------------------------
+// Name: get_debug_registers
+// Desc: from the cached state when it already has them
+//------------------------------------------------------------------------------
+IThread::DebugRegisters PlatformThread::get_debug_registers() {
+
+	if(auto cached = static_cast<PlatformState *>(state_cache_.get())) {
+		if(cached->x86.dbgRegsFilled) {
+			return cached->x86.dbgRegs;
+		}
+	}
+
+	DebugRegisters regs;
+	for(std::size_t i = 0; i < regs.size(); ++i) {
+		regs[i] = get_debug_register(i);
+	}
+	return regs;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_debug_registers
+// Desc: pokes just the address and control registers, the rest of the cached
+//       state stays good
+//------------------------------------------------------------------------------
+void PlatformThread::set_debug_registers(const DebugRegisters &regs) {
+
+	static const std::size_t Written[] = { 0, 1, 2, 3, 7 };
+
+	for(std::size_t n : Written) {
+		ptrace(PTRACE_POKEUSER, tid_, offsetof(struct user, u_debugreg[n]), static_cast<long>(regs[n].toUint()));
+	}
+
+	// states handed out earlier keep the registers they were fetched with
+	if(state_cache_.use_count() > 1) {
+		state_cache_.reset(state_cache_->clone());
+	}
+
+	if(auto cached = static_cast<PlatformState *>(state_cache_.get())) {
+		if(cached->x86.dbgRegsFilled) {
+			for(std::size_t n : Written) {
+				cached->x86.dbgRegs[n] = regs[n];
+			}
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: step
 // Desc: steps this thread one instruction, passing the signal that stopped it
@@ -329,4 +466,14 @@ Status PlatformThread::step(edb::EVENT_STATUS status) {
 	return core_->ptrace_step(tid_, code);
 }
 
+//------------------------------------------------------------------------------
+// Name: step_block
+// Desc: runs this thread until it takes a branch, passing the signal that
+//       stopped it (unless the passed status != DEBUG_EXCEPTION_NOT_HANDLED)
+//------------------------------------------------------------------------------
+Status PlatformThread::step_block(edb::EVENT_STATUS status) {
+	const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(status_) : 0;
+	return core_->ptrace_step_block(tid_, code);
+}
+
 }
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QMessageBox>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 
@@ -268,6 +269,149 @@ bool DebuggerCore::write_data(edb::address_t address, long value) {
 	return ptrace(PT_WRITE_D, pid(), reinterpret_cast<char*>(address), value) != -1;
 }
 
+//------------------------------------------------------------------------------
+// Name: transfer
+// Desc: moves <len> bytes between <buf> and the process with a single PT_IO
+//       request, returns how many bytes the kernel actually moved
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::transfer(int op, edb::address_t address, void *buf, std::size_t len) {
+
+	struct ptrace_io_desc io;
+	io.piod_op   = op;
+	io.piod_offs = reinterpret_cast<void *>(address.toUint());
+	io.piod_addr = buf;
+	io.piod_len  = len;
+
+	if(ptrace(PT_IO, pid(), reinterpret_cast<caddr_t>(&io), 0) == -1) {
+		return 0;
+	}
+
+	return io.piod_len;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_words
+// Desc: the slow path, one PT_READ_D per word. Only used for what PT_IO
+//       couldn't transfer
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::read_words(edb::address_t address, char *buf, std::size_t len) {
+
+	std::size_t read = 0;
+	while(read < len) {
+		bool ok;
+		const long v = read_data(address + read, &ok);
+		if(!ok) {
+			break;
+		}
+
+		const std::size_t n = std::min(sizeof(long), len - read);
+		std::memcpy(buf + read, &v, n);
+		read += n;
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_words
+// Desc: the slow path, one PT_WRITE_D per word. A partial word at the end is
+//       merged with what is already there
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::write_words(edb::address_t address, const char *buf, std::size_t len) {
+
+	std::size_t written = 0;
+	while(written < len) {
+		const std::size_t n = std::min(sizeof(long), len - written);
+
+		long v = 0;
+		if(n != sizeof(long)) {
+			bool ok;
+			v = read_data(address + written, &ok);
+			if(!ok) {
+				break;
+			}
+		}
+
+		std::memcpy(&v, buf + written, n);
+		if(!write_data(address + written, v)) {
+			break;
+		}
+		written += n;
+	}
+
+	return written;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc: reads <count> pages from the process starting at <address>
+// Note: buf's size must be >= count * page_size()
+// Note: address MUST be page aligned.
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_pages(edb::address_t address, void *buf, std::size_t count) {
+
+	Q_ASSERT(address % page_size() == 0);
+
+	return read_bytes(address, buf, page_size() * count);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: reads <len> bytes into <buf> starting at <address>
+// Note: if the read failed, the part of the buffer that could not be read will
+//       be filled with 0xff bytes
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_bytes(edb::address_t address, void *buf, std::size_t len) {
+
+	Q_ASSERT(buf);
+
+	if(attached()) {
+		if(len == 0) {
+			return true;
+		}
+
+		auto ptr = reinterpret_cast<char *>(buf);
+
+		// PT_IO stops at the first unreadable page, the word path picks up
+		// anything it may have refused in the middle of one
+		std::size_t bytes_read = transfer(PIOD_READ_D, address, ptr, len);
+		if(bytes_read != len) {
+			bytes_read += read_words(address + bytes_read, ptr + bytes_read, len - bytes_read);
+		}
+
+		std::memset(ptr + bytes_read, 0xff, len - bytes_read);
+		restore_breakpoint_bytes(address, buf, bytes_read);
+		return bytes_read == len;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_bytes
+// Desc: writes <len> bytes from <buf> starting at <address>
+//------------------------------------------------------------------------------
+bool DebuggerCore::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
+
+	Q_ASSERT(buf);
+
+	if(attached()) {
+		if(len == 0) {
+			return true;
+		}
+
+		// PIOD_WRITE_D doesn't modify the buffer, it just isn't declared const
+		auto ptr = reinterpret_cast<const char *>(buf);
+
+		std::size_t written = transfer(PIOD_WRITE_D, address, const_cast<char *>(ptr), len);
+		if(written != len) {
+			written += write_words(address + written, ptr + written, len - written);
+		}
+
+		return written == len;
+	}
+	return false;
+}
+
 //------------------------------------------------------------------------------
 // Name: attach
 // Desc:
@@ -371,7 +515,7 @@ void DebuggerCore::get_state(State *state) {
 	Q_ASSERT(state);
 
 	// TODO: assert that we are paused
-	auto state_impl = static_cast<PlatformState *>(state->impl_);
+	auto state_impl = static_cast<PlatformState *>(state->writable_impl());
 
 	if(attached()) {
 		if(ptrace(PT_GETREGS, active_thread(), reinterpret_cast<char*>(&state_impl->regs_), 0) != -1) {
@@ -397,7 +541,7 @@ void DebuggerCore::get_state(State *state) {
 void DebuggerCore::set_state(const State &state) {
 
 	// TODO: assert that we are paused
-	auto state_impl = static_cast<PlatformState *>(state.impl_);
+	auto state_impl = static_cast<PlatformState *>(state.impl_.get());
 
 	if(attached()) {
 		ptrace(PT_SETREGS, active_thread(), reinterpret_cast<char*>(&state_impl->regs_), 0);
@@ -25,6 +25,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDebug>
 
+#include <algorithm>
+#include <cstring>
+
 #include <fcntl.h>
 #include <mach/mach.h>
 #include <mach/mach_vm.h>
@@ -60,7 +63,9 @@ int resume_code(int status) {
 // Desc: constructor
 //------------------------------------------------------------------------------
 DebuggerCore::DebuggerCore() {
-	page_size_ = 0x1000;
+	page_size_     = 0x1000;
+	task_          = MACH_PORT_NULL;
+	regions_valid_ = false;
 }
 
 //------------------------------------------------------------------------------
@@ -108,6 +113,7 @@ std::shared_ptr<const IDebugEvent> DebuggerCore::wait_debug_event(int msecs) {
 
 				active_thread_       = tid;
 				threads_[tid].status = status;
+				regions_valid_       = false;
 				return e;
 			}
 		}
@@ -123,17 +129,8 @@ long DebuggerCore::read_data(edb::address_t address, bool *ok) {
 
 	Q_ASSERT(ok);
 
-	mach_port_t task;
-	kern_return_t err = task_for_pid(mach_task_self(), pid(), &task);
-	if(err != KERN_SUCCESS) {
-		qDebug("task_for_pid() failed with %x [%d]", err, pid());
-		*ok = false;
-		return -1;
-	}
-
-	long x;
-	vm_size_t size;
-	*ok =  vm_read_overwrite(task, address, sizeof(long), (vm_address_t)&x, &size) == 0;
+	long x = -1;
+	*ok = read_raw(address, &x, sizeof(long)) == sizeof(long);
 	return x;
 }
 
@@ -145,6 +142,111 @@ bool DebuggerCore::write_data(edb::address_t address, long value) {
 	return ptrace(PT_WRITE_D, pid(), (char *)address, value) != -1;
 }
 
+//------------------------------------------------------------------------------
+// Name: task
+// Desc: the task port of the debuggee. task_for_pid is a round trip through
+//       the kernel's security checks, so it is only done once per process
+//------------------------------------------------------------------------------
+task_t DebuggerCore::task() const {
+	if(task_ == MACH_PORT_NULL && pid_ != 0) {
+		const kern_return_t err = task_for_pid(mach_task_self(), pid_, &task_);
+		if(err != KERN_SUCCESS) {
+			qDebug("task_for_pid() failed with %x [%d]", err, pid_);
+			task_ = MACH_PORT_NULL;
+		}
+	}
+	return task_;
+}
+
+//------------------------------------------------------------------------------
+// Name: release_task
+// Desc: must be called whenever pid_ stops referring to the process
+//------------------------------------------------------------------------------
+void DebuggerCore::release_task() {
+	if(task_ != MACH_PORT_NULL) {
+		mach_port_deallocate(mach_task_self(), task_);
+		task_ = MACH_PORT_NULL;
+	}
+	regions_.clear();
+	regions_valid_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_raw
+// Desc: reads <len> bytes into <buf> starting at <address>, returns how many
+//       could be read
+// Note: mach_vm_read_overwrite is all or nothing, so a range which runs into
+//       a hole is retried a page at a time to get what is readable before it
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::read_raw(edb::address_t address, void *buf, std::size_t len) const {
+
+	const task_t t = task();
+	if(t == MACH_PORT_NULL) {
+		return 0;
+	}
+
+	mach_vm_size_t size = 0;
+	if(mach_vm_read_overwrite(t, address, len, reinterpret_cast<mach_vm_address_t>(buf), &size) == KERN_SUCCESS) {
+		return size;
+	}
+
+	auto ptr = reinterpret_cast<char *>(buf);
+
+	std::size_t read = 0;
+	while(read < len) {
+		const edb::address_t current = address + read;
+		const std::size_t    n       = std::min<std::size_t>(page_size_ - (current & (page_size_ - 1)), len - read);
+
+		size = 0;
+		if(mach_vm_read_overwrite(t, current, n, reinterpret_cast<mach_vm_address_t>(ptr + read), &size) != KERN_SUCCESS || size == 0) {
+			break;
+		}
+		read += size;
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc: reads <count> pages from the process starting at <address>
+// Note: buf's size must be >= count * page_size()
+// Note: address MUST be page aligned.
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_pages(edb::address_t address, void *buf, std::size_t count) {
+
+	Q_ASSERT(address % page_size() == 0);
+
+	return read_bytes(address, buf, page_size() * count);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: reads <len> bytes into <buf> starting at <address>, in one
+//       mach_vm_read_overwrite where possible
+// Note: if the read failed, the part of the buffer that could not be read will
+//       be filled with 0xff bytes
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_bytes(edb::address_t address, void *buf, std::size_t len) {
+
+	Q_ASSERT(buf);
+
+	if(attached()) {
+		if(len == 0) {
+			return true;
+		}
+
+		auto ptr = reinterpret_cast<char *>(buf);
+
+		const std::size_t bytes_read = read_raw(address, ptr, len);
+
+		std::memset(ptr + bytes_read, 0xff, len - bytes_read);
+		restore_breakpoint_bytes(address, buf, bytes_read);
+		return bytes_read == len;
+	}
+	return false;
+}
+
 //------------------------------------------------------------------------------
 // Name: attach
 // Desc:
@@ -179,6 +281,7 @@ void DebuggerCore::detach() {
 			ptrace(PT_DETACH, it.key(), 0, 0);
 		}
 
+		release_task();
 		pid_ = 0;
 		threads_.clear();
 	}
@@ -193,6 +296,7 @@ void DebuggerCore::kill() {
 		clear_breakpoints();
 		ptrace(PT_KILL, pid(), 0, 0);
 		native::waitpid(pid(), 0, WAIT_ANY);
+		release_task();
 		pid_ = 0;
 		threads_.clear();
 	}
@@ -221,6 +325,7 @@ void DebuggerCore::resume(edb::EVENT_STATUS status) {
 		if(status != edb::DEBUG_STOP) {
 			const edb::tid_t tid = active_thread();
 			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
+			regions_valid_ = false;
 			ptrace(PT_CONTINUE, tid, reinterpret_cast<caddr_t>(1), code);
 		}
 	}
@@ -237,6 +342,7 @@ void DebuggerCore::step(edb::EVENT_STATUS status) {
 		if(status != edb::DEBUG_STOP) {
 			const edb::tid_t tid = active_thread();
 			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
+			regions_valid_ = false;
 			ptrace(PT_STEP, tid, reinterpret_cast<caddr_t>(1), code);
 		}
 	}
@@ -251,7 +357,7 @@ void DebuggerCore::get_state(State *state) {
 	Q_ASSERT(state);
 
 	// TODO: assert that we are paused
-	auto state_impl = static_cast<PlatformState *>(state->impl_);
+	auto state_impl = static_cast<PlatformState *>(state->writable_impl());
 
 	if(attached()) {
 
@@ -370,7 +476,7 @@ void DebuggerCore::get_state(State *state) {
 void DebuggerCore::set_state(const State &state) {
 
 	// TODO: assert that we are paused
-	auto state_impl = static_cast<PlatformState *>(state.impl_);
+	auto state_impl = static_cast<PlatformState *>(state.impl_.get());
 
 	if(attached()) {
 
@@ -586,87 +692,63 @@ edb::pid_t DebuggerCore::parent_pid(edb::pid_t pid) const {
 }
 
 //------------------------------------------------------------------------------
-// Name:
-// Desc:
+// Name: memory_regions
+// Desc: walks the task's map with mach_vm_region_recurse, descending into
+//       submaps (the shared cache lives in one). The walk is cached until the
+//       process runs again
 //------------------------------------------------------------------------------
 QList<std::shared_ptr<IRegion>> DebuggerCore::memory_regions() const {
 
-#if 0
-    static const char * inheritance_strings[] = {
-		"SHARE", "COPY", "NONE", "DONATE_COPY",
-	};
-
-	static const char * behavior_strings[] = {
-		"DEFAULT", "RANDOM", "SEQUENTIAL", "RESQNTL", "WILLNEED", "DONTNEED",
-	};
-#endif
+	if(regions_valid_) {
+		return regions_;
+	}
 
 	QList<std::shared_ptr<IRegion>> regions;
-	if(pid_ != 0) {
-		task_t the_task;
-		kern_return_t kr = task_for_pid(mach_task_self(), pid_, &the_task);
+
+	const task_t t = task();
+	if(t == MACH_PORT_NULL) {
+		return regions;
+	}
+
+	mach_vm_address_t address = 0;
+	natural_t         depth   = 0;
+
+	for(;;) {
+		mach_vm_size_t                  vmsize     = 0;
+		vm_region_submap_info_data_64_t info;
+		mach_msg_type_number_t          info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+
+		const kern_return_t kr = mach_vm_region_recurse(t, &address, &vmsize, &depth, reinterpret_cast<vm_region_recurse_info_t>(&info), &info_count);
+		if(kr == KERN_INVALID_ADDRESS) {
+			break;
+		}
+
 		if(kr != KERN_SUCCESS) {
-			qDebug("task_for_pid failed");
-            return QList<std::shared_ptr<IRegion>>();
+			// a partial map is worse than none, don't cache it either
+			return QList<std::shared_ptr<IRegion>>();
 		}
 
-		vm_size_t vmsize;
-		vm_address_t address;
-		vm_region_basic_info_data_64_t info;
-		mach_msg_type_number_t info_count;
-		vm_region_flavor_t flavor;
-		memory_object_name_t object;
+		if(info.is_submap) {
+			++depth;
+			continue;
+		}
 
-		kr = KERN_SUCCESS;
-		address = 0;
+		const edb::address_t start               = address;
+		const edb::address_t end                 = address + vmsize;
+		const edb::address_t base                = address;
+		const QString name                       = QString();
+		const IRegion::permissions_t permissions =
+			((info.protection & VM_PROT_READ)    ? PROT_READ  : 0) |
+			((info.protection & VM_PROT_WRITE)   ? PROT_WRITE : 0) |
+			((info.protection & VM_PROT_EXECUTE) ? PROT_EXEC  : 0);
 
-		do {
-			flavor     = VM_REGION_BASIC_INFO_64;
-			info_count = VM_REGION_BASIC_INFO_COUNT_64;
-			kr = vm_region_64(the_task, &address, &vmsize, flavor, (vm_region_info_64_t)&info, &info_count, &object);
-			if(kr == KERN_SUCCESS) {
-
-				const edb::address_t start               = address;
-				const edb::address_t end                 = address + vmsize;
-				const edb::address_t base                = address;
-				const QString name                       = QString();
-				const IRegion::permissions_t permissions =
-					((info.protection & VM_PROT_READ)    ? PROT_READ  : 0) |
-					((info.protection & VM_PROT_WRITE)   ? PROT_WRITE : 0) |
-					((info.protection & VM_PROT_EXECUTE) ? PROT_EXEC  : 0);
-
-				regions.push_back(std::make_shared<PlatformRegion>(start, end, base, name, permissions));
-
-				/*
-				printf("%016llx-%016llx %8uK %c%c%c/%c%c%c %11s %6s %10s uwir=%hu sub=%u\n",
-				address, (address + vmsize), (vmsize >> 10),
-				(info.protection & VM_PROT_READ)        ? 'r' : '-',
-				(info.protection & VM_PROT_WRITE)       ? 'w' : '-',
-				(info.protection & VM_PROT_EXECUTE)     ? 'x' : '-',
-				(info.max_protection & VM_PROT_READ)    ? 'r' : '-',
-				(info.max_protection & VM_PROT_WRITE)   ? 'w' : '-',
-				(info.max_protection & VM_PROT_EXECUTE) ? 'x' : '-',
-				inheritance_strings[info.inheritance],
-				(info.shared) ? "shared" : "-",
-				behavior_strings[info.behavior],
-				info.user_wired_count,
-				info.reserved);
-				*/
-
-				address += vmsize;
-			} else if(kr != KERN_INVALID_ADDRESS) {
-				if(the_task != MACH_PORT_NULL) {
-					mach_port_deallocate(mach_task_self(), the_task);
-				}
-                return QList<std::shared_ptr<IRegion>>();
-			}
-		} while(kr != KERN_INVALID_ADDRESS);
+		regions.push_back(std::make_shared<PlatformRegion>(start, end, base, name, permissions));
 
-		if(the_task != MACH_PORT_NULL) {
-			mach_port_deallocate(mach_task_self(), the_task);
-		}
+		address += vmsize;
 	}
 
+	regions_       = regions;
+	regions_valid_ = true;
 	return regions;
 }
 
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "DebuggerCoreUNIX.h"
 #include <QHash>
+#include <mach/mach.h>
 
 namespace DebuggerCore {
 
@@ -83,9 +84,16 @@ public:
 public:
 	virtual QString format_pointer(edb::address_t address) const;
 
+public:
+	virtual bool read_pages(edb::address_t address, void *buf, std::size_t count);
+	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len);
+
 private:
 	virtual long read_data(edb::address_t address, bool *ok);
 	virtual bool write_data(edb::address_t address, long value);
+	task_t task() const;
+	void release_task();
+	std::size_t read_raw(edb::address_t address, void *buf, std::size_t len) const;
 
 private:
 	struct thread_info {
@@ -101,8 +109,11 @@ private:
 
 	typedef QHash<edb::tid_t, thread_info> threadmap_t;
 
-	edb::address_t page_size_;
-	threadmap_t    threads_;
+	edb::address_t                          page_size_;
+	threadmap_t                             threads_;
+	mutable task_t                          task_;          // for pid_, looked up once
+	mutable QList<std::shared_ptr<IRegion>> regions_;       // until the process runs again
+	mutable bool                            regions_valid_;
 };
 
 }
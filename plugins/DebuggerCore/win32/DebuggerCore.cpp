@@ -37,6 +37,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <Psapi.h>
 
 #include <algorithm>
+#include <cstring>
 
 #ifdef _MSC_VER
 #pragma comment(lib, "Advapi32.lib")
@@ -184,6 +185,16 @@ namespace {
 
         return ok;
     }
+
+	//------------------------------------------------------------------------------
+	// Name: system_page_size
+	// Desc:
+	//------------------------------------------------------------------------------
+	edb::address_t system_page_size() {
+		SYSTEM_INFO sys_info;
+		GetSystemInfo(&sys_info);
+		return sys_info.dwPageSize;
+	}
 }
 
 
@@ -191,13 +202,9 @@ namespace {
 // Name: DebuggerCore
 // Desc: constructor
 //------------------------------------------------------------------------------
-DebuggerCore::DebuggerCore() : start_address(0), image_base(0), page_size_(0), process_handle_(0) {
+DebuggerCore::DebuggerCore() : start_address(0), image_base(0), page_size_(system_page_size()), process_handle_(0), page_cache_(page_size_), regions_valid_(false) {
 	DebugSetProcessKillOnExit(false);
 
-	SYSTEM_INFO sys_info;
-	GetSystemInfo(&sys_info);
-	page_size_ = sys_info.dwPageSize;
-
 	set_debug_privilege(GetCurrentProcess(), true); // gogo magic powers
 }
 
@@ -261,17 +268,24 @@ std::shared_ptr<IDebugEvent> DebuggerCore::wait_debug_event(int msecs) {
 			switch(de.dwDebugEventCode) {
 			case CREATE_THREAD_DEBUG_EVENT:
 				threads_.insert(active_thread_);
+				regions_valid_ = false; // a new stack and TEB
 				break;
 			case EXIT_THREAD_DEBUG_EVENT:
 				threads_.remove(active_thread_);
+				regions_valid_ = false;
 				break;
 			case CREATE_PROCESS_DEBUG_EVENT:
 				CloseHandle(de.u.CreateProcessInfo.hFile);
 				start_address = edb::address_t::fromZeroExtended(de.u.CreateProcessInfo.lpStartAddress);
 				image_base    = edb::address_t::fromZeroExtended(de.u.CreateProcessInfo.lpBaseOfImage);
+				regions_valid_ = false;
 				break;
 			case LOAD_DLL_DEBUG_EVENT:
 				CloseHandle(de.u.LoadDll.hFile);
+				regions_valid_ = false;
+				break;
+			case UNLOAD_DLL_DEBUG_EVENT:
+				regions_valid_ = false;
 				break;
 			case EXIT_PROCESS_DEBUG_EVENT:
 				CloseHandle(process_handle_);
@@ -317,6 +331,67 @@ bool DebuggerCore::read_pages(edb::address_t address, void *buf, std::size_t cou
 	return read_bytes(address, buf, page_size() * count);
 }
 
+//------------------------------------------------------------------------------
+// Name: read_raw
+// Desc: reads <len> bytes into <buf> starting at <address>, returns how many
+//       could be read
+// Note: a read which runs into an unreadable page fails, but still reports
+//       what it copied before that
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::read_raw(edb::address_t address, void *buf, std::size_t len) {
+	SIZE_T bytes_read = 0;
+	ReadProcessMemory(process_handle_, reinterpret_cast<LPCVOID>(address.toUint()), buf, len, &bytes_read);
+	return bytes_read;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_via_cache
+// Desc: reads <len> bytes into <buf> starting at <address>, going through the
+//       page cache, returns the number of bytes read
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::read_via_cache(edb::address_t address, char *buf, std::size_t len) {
+
+	std::size_t read = 0;
+
+	while(read < len) {
+		const edb::address_t current = address + read;
+		const std::size_t    offset  = current & (page_size_ - 1);
+		const edb::address_t page    = current - offset;
+		const std::size_t    n       = std::min<std::size_t>(page_size_ - offset, len - read);
+
+		const QByteArray *data = page_cache_.find(page);
+		if(!data) {
+			QByteArray bytes(page_size_, Qt::Uninitialized);
+			if(read_raw(page, bytes.data(), page_size_) == page_size_) {
+				data = page_cache_.insert(page, bytes);
+			}
+		}
+
+		if(data) {
+			std::memcpy(buf + read, data->constData() + offset, n);
+			read += n;
+		} else {
+			// the page isn't entirely readable, so just get what we can
+			const std::size_t r = read_raw(current, buf + read, n);
+			read += r;
+			if(r != n) {
+				break;
+			}
+		}
+	}
+
+	return read;
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_memory_caches
+// Desc: must be called whenever the debuggee is allowed to run
+//------------------------------------------------------------------------------
+void DebuggerCore::invalidate_memory_caches() {
+	page_cache_.invalidate();
+	regions_valid_ = false;
+}
+
 //------------------------------------------------------------------------------
 // Name: read_bytes
 // Desc: reads <len> bytes into <buf> starting at <address>
@@ -332,19 +407,78 @@ bool DebuggerCore::read_bytes(edb::address_t address, void *buf, std::size_t len
 			return true;
 		}
 
-		memset(buf, 0xff, len);
-		SIZE_T bytes_read = 0;
-        if(ReadProcessMemory(process_handle_, reinterpret_cast<LPCVOID>(address.toUint()), buf, len, &bytes_read)) {
-			for(const std::shared_ptr<IBreakpoint> &bp: breakpoints_) {
+		auto ptr = reinterpret_cast<char *>(buf);
 
-				if(bp->address() >= address && bp->address() < address + bytes_read) {
-					reinterpret_cast<quint8 *>(buf)[bp->address() - address] = bp->original_bytes()[0];
+		std::size_t bytes_read;
+		if(len <= PageCache::MaxCachedRead) {
+			bytes_read = read_via_cache(address, ptr, len);
+		} else {
+			bytes_read = read_raw(address, ptr, len);
+		}
+
+		std::memset(ptr + bytes_read, 0xff, len - bytes_read);
+		restore_breakpoint_bytes(address, buf, bytes_read);
+		return bytes_read == len;
+	}
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_many
+// Desc: services many reads with as few ReadProcessMemory calls as possible.
+//       The pages the small reads need are merged into contiguous runs, each
+//       of which is read in one go into the page cache
+// Note: returns the number of bytes read for each request
+//------------------------------------------------------------------------------
+QVector<std::size_t> DebuggerCore::read_many(const QVector<ReadRequest> &requests) {
+
+	QVector<std::size_t> results(requests.size(), 0);
+	if(!attached()) {
+		return results;
+	}
+
+	QVector<edb::address_t> pages;
+	for(const ReadRequest &request : requests) {
+		if(request.size != 0 && request.size <= PageCache::MaxCachedRead) {
+			const edb::address_t first = request.address - (request.address & (page_size_ - 1));
+			for(edb::address_t page = first; page < request.address + request.size; page += page_size_) {
+				if(!page_cache_.find(page)) {
+					pages.push_back(page);
 				}
 			}
-            return true;
 		}
 	}
-    return false;
+
+	std::sort(pages.begin(), pages.end());
+	pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+	for(int i = 0; i < pages.size();) {
+		int j = i + 1;
+		while(j < pages.size() && pages[j] == pages[j - 1] + page_size_) {
+			++j;
+		}
+
+		// a run which can't be read in full is left to the reads themselves,
+		// which work out page by page what is readable
+		const std::size_t size = (j - i) * page_size_.toUint();
+		QByteArray run(size, Qt::Uninitialized);
+		if(read_raw(pages[i], run.data(), size) == size) {
+			for(int k = i; k < j; ++k) {
+				page_cache_.insert(pages[k], run.mid((k - i) * page_size_.toUint(), page_size_.toUint()));
+			}
+		}
+
+		i = j;
+	}
+
+	for(int i = 0; i < requests.size(); ++i) {
+		const ReadRequest &request = requests[i];
+		if(read_bytes(request.address, request.buffer, request.size)) {
+			results[i] = request.size;
+		}
+	}
+
+	return results;
 }
 
 //------------------------------------------------------------------------------
@@ -360,6 +494,8 @@ bool DebuggerCore::write_bytes(edb::address_t address, const void *buf, std::siz
 			return true;
 		}
 
+		page_cache_.invalidate(address, len);
+
 		SIZE_T bytes_written = 0;
         return WriteProcessMemory(process_handle_, reinterpret_cast<LPVOID>(address.toUint()), buf, len, &bytes_written);
 	}
@@ -407,6 +543,8 @@ Status DebuggerCore::detach() {
 		start_address   = 0;
 		image_base      = 0;
 		threads_.clear();
+		invalidate_memory_caches();
+		regions_.clear();
 	}
 	return Status::Ok;
 }
@@ -441,6 +579,8 @@ void DebuggerCore::resume(edb::EVENT_STATUS status) {
 
 	if(attached()) {
 		if(status != edb::DEBUG_STOP) {
+			invalidate_memory_caches();
+
 			// TODO: does this resume *all* threads?
 			// it does! (unless you manually paused one using SuspendThread)
 			ContinueDebugEvent(
@@ -489,7 +629,7 @@ void DebuggerCore::get_state(State *state) {
 	// TODO: assert that we are paused
 	Q_ASSERT(state);
 
-	auto state_impl = static_cast<PlatformState *>(state->impl_);
+	auto state_impl = static_cast<PlatformState *>(state->writable_impl());
 
 	if(attached() && state_impl) {
 
@@ -529,7 +669,7 @@ void DebuggerCore::set_state(const State &state) {
 
 	// TODO: assert that we are paused
 
-	auto state_impl = static_cast<PlatformState *>(state.impl_);
+	auto state_impl = static_cast<PlatformState *>(state.impl_.get());
 
 	if(attached()) {
 		state_impl->context_.ContextFlags = CONTEXT_ALL; //CONTEXT_FULL | CONTEXT_DEBUG_REGISTERS | CONTEXT_FLOATING_POINT;
@@ -756,6 +896,11 @@ edb::pid_t DebuggerCore::parent_pid(edb::pid_t pid) const {
 // Desc:
 //------------------------------------------------------------------------------
 QList<std::shared_ptr<IRegion>> DebuggerCore::memory_regions() const {
+
+	if(regions_valid_) {
+		return regions_;
+	}
+
 	QList<std::shared_ptr<IRegion>> regions;
 
 	if(pid_ != 0) {
@@ -765,7 +910,9 @@ QList<std::shared_ptr<IRegion>> DebuggerCore::memory_regions() const {
 
 			Q_FOREVER {
 				MEMORY_BASIC_INFORMATION info;
-				VirtualQueryEx(ph, reinterpret_cast<LPVOID>(addr.toUint()), &info, sizeof(info));
+				if(!VirtualQueryEx(ph, reinterpret_cast<LPVOID>(addr.toUint()), &info, sizeof(info))) {
+					break;
+				}
 
 				if(last_base == info.BaseAddress) {
 					break;
@@ -793,6 +940,9 @@ QList<std::shared_ptr<IRegion>> DebuggerCore::memory_regions() const {
 			}
 
 			CloseHandle(ph);
+
+			regions_       = regions;
+			regions_valid_ = true;
 		}
 	}
 
@@ -22,7 +22,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DebuggerCoreBase.h"
 #include "IRegion.h"
 #include "Module.h"
+#include "PageCache.h"
+#include "ReadRequest.h"
 #include <QSet>
+#include <QVector>
 
 namespace DebuggerCorePlugin {
 
@@ -61,6 +64,7 @@ public:
 	virtual bool read_pages(edb::address_t address, void *buf, std::size_t count);
 	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len);
 	virtual bool write_bytes(edb::address_t address, const void *buf, std::size_t len);
+	QVector<std::size_t> read_many(const QVector<ReadRequest> &requests);
 	virtual int sys_pointer_size() const;
 	virtual QMap<qlonglong, QString> exceptions() const;
 	virtual QString exceptionName(qlonglong value) {
@@ -123,12 +127,22 @@ public:
 
 private:
 	bool attached() { return DebuggerCoreBase::attached() && process_handle_ != 0; }
+	std::size_t read_raw(edb::address_t address, void *buf, std::size_t len);
+	std::size_t read_via_cache(edb::address_t address, char *buf, std::size_t len);
+	void invalidate_memory_caches();
 
 private:
 	edb::address_t   page_size_;
 	HANDLE           process_handle_;
 	QSet<edb::tid_t> threads_;
 	edb::tid_t       active_thread_;
+	PageCache        page_cache_;
+
+	// walking the address space takes a VirtualQueryEx per region, which adds
+	// up to thousands for big processes, so it is only done again once
+	// something could have changed the layout
+	mutable QList<std::shared_ptr<IRegion>> regions_;
+	mutable bool                            regions_valid_;
 };
 
 }
@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LatencyDialog.h"
+#include "Instrumentation.h"
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace DebuggerErrorConsolePlugin
+{
+
+namespace
+{
+
+QString formatDuration(qint64 ns)
+{
+	if(ns < 10000)
+		return QObject::tr("%1 ns").arg(ns);
+	if(ns < 10000000)
+		return QObject::tr("%1 µs").arg(ns/1000.0, 0, 'f', 1);
+	return QObject::tr("%1 ms").arg(ns/1000000.0, 0, 'f', 1);
+}
+
+}
+
+LatencyDialog::LatencyDialog(QWidget* parent)
+	: QDialog(parent)
+{
+	setWindowTitle(tr("Command Latency"));
+	resize(760, 480);
+
+	tree_ = new QTreeWidget(this);
+	tree_->setHeaderLabels(QStringList() << tr("Command") << tr("Count") << tr("Min") << tr("Median")
+	                                     << tr("90%") << tr("99%") << tr("Max") << tr("Mean"));
+	tree_->setRootIsDecorated(true);
+	tree_->setUniformRowHeights(true);
+
+	auto*const buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+	auto*const refreshButton = buttons->addButton(tr("&Refresh"), QDialogButtonBox::ActionRole);
+	auto*const resetButton = buttons->addButton(tr("R&eset"), QDialogButtonBox::ResetRole);
+	connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+	connect(resetButton, SIGNAL(clicked()), this, SLOT(reset()));
+	connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+
+	auto*const layout = new QVBoxLayout(this);
+	layout->addWidget(tree_);
+	layout->addWidget(buttons);
+}
+
+// One entry per command with its total, the segments below it. Time spent in
+// nested segments only counts for the innermost one, so they add up
+void LatencyDialog::refresh()
+{
+	tree_->clear();
+
+	for(int command=0; command<Instrumentation::CommandCount; ++command)
+	{
+		auto*const commandItem = new QTreeWidgetItem(tree_);
+		for(int segment=0; segment<Instrumentation::HistogramCount; ++segment)
+		{
+			const LatencyHistogram histogram = Instrumentation::histogram(static_cast<Instrumentation::Command>(command), segment);
+
+			QTreeWidgetItem* item = commandItem;
+			if(segment == Instrumentation::Total)
+				item->setText(0, Instrumentation::command_name(command));
+			else
+			{
+				item = new QTreeWidgetItem(commandItem);
+				item->setText(0, Instrumentation::segment_name(segment));
+			}
+
+			item->setText(1, QString::number(histogram.count()));
+			if(histogram.count())
+			{
+				item->setText(2, formatDuration(histogram.min()));
+				item->setText(3, formatDuration(histogram.percentile(50)));
+				item->setText(4, formatDuration(histogram.percentile(90)));
+				item->setText(5, formatDuration(histogram.percentile(99)));
+				item->setText(6, formatDuration(histogram.max()));
+				item->setText(7, formatDuration(histogram.mean()));
+			}
+			for(int column=1; column<item->columnCount(); ++column)
+				item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+		}
+		commandItem->setExpanded(commandItem->text(1)!="0");
+	}
+
+	for(int column=0; column<tree_->columnCount(); ++column)
+		tree_->resizeColumnToContents(column);
+}
+
+void LatencyDialog::reset()
+{
+	Instrumentation::reset_histograms();
+	refresh();
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LATENCY_DIALOG_H_20171014
+#define LATENCY_DIALOG_H_20171014
+
+#include <QDialog>
+
+class QTreeWidget;
+
+namespace DebuggerErrorConsolePlugin
+{
+
+// How long the commands of the user took, from the command to the views having
+// been brought up to date, and where that time went
+class LatencyDialog : public QDialog
+{
+	Q_OBJECT
+
+	QTreeWidget* tree_=nullptr;
+
+public:
+	LatencyDialog(QWidget* parent=nullptr);
+public Q_SLOTS:
+	void refresh();
+private Q_SLOTS:
+	void reset();
+};
+
+}
+
+#endif
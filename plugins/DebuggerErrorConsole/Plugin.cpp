@@ -16,9 +16,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "Plugin.h"
+#include "LatencyDialog.h"
+#include "Instrumentation.h"
 #include "edb.h"
 #include <QMenu>
 #include <QDebug>
+#include <QFile>
+#include <QFileDialog>
 #include <QMainWindow>
 #include <QDockWidget>
 #include <QPlainTextEdit>
@@ -101,6 +105,14 @@ QMenu* Plugin::menu(QWidget* parent)
 
 			menu_ = new QMenu(tr("Debugger Error Console"), parent);
 			menu_->addAction(dockWidget->toggleViewAction());
+			menu_->addSeparator();
+
+			auto*const traceAction = menu_->addAction(tr("Record Hot Path &Trace"));
+			traceAction->setCheckable(true);
+			traceAction->setChecked(Instrumentation::enabled());
+			connect(traceAction, SIGNAL(toggled(bool)), this, SLOT(toggleTracing(bool)));
+			menu_->addAction(tr("&Save Hot Path Trace..."), this, SLOT(saveTrace()));
+			menu_->addAction(tr("Command &Latency..."), this, SLOT(showLatency()));
 
 			auto docks = mainWindow->findChildren<QDockWidget *>();
 			// We want to put it to the same area as Stack dock
@@ -125,6 +137,40 @@ QMenu* Plugin::menu(QWidget* parent)
 	return menu_;
 }
 
+// Starting a recording drops what an earlier one left in the rings
+void Plugin::toggleTracing(bool enable)
+{
+	if(enable)
+		Instrumentation::clear();
+	Instrumentation::set_enabled(enable);
+	qDebug() << (enable ? "Recording a hot path trace" : "Stopped recording the hot path trace");
+}
+
+// The file can be loaded in chrome://tracing
+void Plugin::saveTrace()
+{
+	const QString filename = QFileDialog::getSaveFileName(edb::v1::debugger_ui, tr("Save Hot Path Trace"), QString(), tr("Chrome Trace (*.json);;All Files (*)"));
+	if(filename.isEmpty())
+		return;
+
+	QFile file(filename);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Failed to save the trace to" << filename << ":" << file.errorString();
+		return;
+	}
+	file.write(Instrumentation::chrome_trace());
+	qDebug() << "Saved the hot path trace to" << filename;
+}
+
+void Plugin::showLatency()
+{
+	if(!latencyDialog_)
+		latencyDialog_ = new LatencyDialog(edb::v1::debugger_ui);
+	latencyDialog_->refresh();
+	latencyDialog_->show();
+	latencyDialog_->raise();
+}
 
 DebuggerErrorConsole::DebuggerErrorConsole(QWidget* parent)
 	: QDialog(parent)
@@ -28,6 +28,8 @@ class QPlainTextEdit;
 namespace DebuggerErrorConsolePlugin
 {
 
+class LatencyDialog;
+
 class DebuggerErrorConsole : public QDialog
 {
 	Q_OBJECT
@@ -50,6 +52,7 @@ class Plugin : public QObject, public IPlugin
 
 	QPlainTextEdit* textWidget_=nullptr;
 	QMenu* menu_=nullptr;
+	LatencyDialog* latencyDialog_=nullptr;
 	static Plugin* instance;
 
 #if QT_VERSION < 0x50000
@@ -61,6 +64,10 @@ public:
 	Plugin();
 	~Plugin();
 	virtual QMenu* menu(QWidget* parent = 0) override;
+private Q_SLOTS:
+	void toggleTracing(bool enable);
+	void saveTrace();
+	void showLatency();
 };
 
 }
@@ -24,9 +24,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IThread.h"
 #include "OptionsPage.h"
 #include "State.h"
+#include "StateLogger.h"
 #include "Util.h"
 #include "edb.h"
 
+#include <QAction>
+#include <QFileDialog>
 #include <QMenu>
 #include <QSettings>
 #include <iomanip>
@@ -112,7 +115,7 @@ std::string format_address(const T& value) {
 // Name: DumpState
 // Desc:
 //------------------------------------------------------------------------------
-DumpState::DumpState() : menu_(0) {
+DumpState::DumpState() : menu_(0), log_action_(0), logger_(new StateLogger) {
 }
 
 //------------------------------------------------------------------------------
@@ -120,6 +123,7 @@ DumpState::DumpState() : menu_(0) {
 // Desc:
 //------------------------------------------------------------------------------
 DumpState::~DumpState() {
+	delete logger_;
 }
 
 //------------------------------------------------------------------------------
@@ -133,6 +137,19 @@ QMenu *DumpState::menu(QWidget *parent) {
 	if(!menu_) {
 		menu_ = new QMenu(tr("DumpState"), parent);
 		menu_->addAction (tr("&Dump Current State"), this, SLOT(show_menu()), QKeySequence(tr("Ctrl+D")));
+
+		log_action_ = menu_->addAction(tr("&Log State on Every Stop"));
+		log_action_->setCheckable(true);
+
+		// logging from the command line started before the main window put
+		// itself into the event handlers, starting over puts the log back in
+		// front of it
+		if(logger_->active()) {
+			logger_->start(log_file_);
+			log_action_->setChecked(true);
+		}
+
+		connect(log_action_, SIGNAL(toggled(bool)), this, SLOT(toggle_logging(bool)));
 	}
 
 	return menu_;
@@ -330,6 +347,65 @@ void DumpState::show_menu() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: toggle_logging
+// Desc: writes a JSON record of every stop to the log file from the options,
+//       asking for one if none is set
+//------------------------------------------------------------------------------
+void DumpState::toggle_logging(bool enabled) {
+
+	if(!enabled) {
+		logger_->stop();
+		return;
+	}
+
+	QSettings settings;
+	QString filename = settings.value("DumpState/log_file").toString();
+	if(filename.isEmpty()) {
+		filename = QFileDialog::getSaveFileName(edb::v1::debugger_ui, tr("Log State To"), QString(), tr("JSON Lines (*.jsonl);;All Files (*)"), 0, QFileDialog::DontConfirmOverwrite);
+		settings.setValue("DumpState/log_file", filename);
+	}
+
+	if(!logger_->start(filename)) {
+		log_action_->setChecked(false);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: log_state
+// Desc: writes a single record of the current state to the log, if it is
+//       open
+//------------------------------------------------------------------------------
+bool DumpState::log_state() {
+	return logger_->log();
+}
+
+//------------------------------------------------------------------------------
+// Name: extra_arguments
+// Desc:
+//------------------------------------------------------------------------------
+QString DumpState::extra_arguments() const {
+	return " --log-state <filename>    : log a JSON record of every stop to <filename>";
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_arguments
+// Desc:
+//------------------------------------------------------------------------------
+IPlugin::ArgumentStatus DumpState::parse_arguments(QStringList &args) {
+
+	if(args.size() >= 2 && args[1] == "--log-state") {
+		if(args.size() < 3 || !logger_->start(args[2])) {
+			return ARG_ERROR;
+		}
+
+		log_file_ = args[2];
+		args.erase(args.begin() + 1, args.begin() + 3);
+	}
+
+	return ARG_SUCCESS;
+}
+
 //------------------------------------------------------------------------------
 // Name: options_page
 // Desc:
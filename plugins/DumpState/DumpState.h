@@ -22,11 +22,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IPlugin.h"
 #include "Types.h"
 
+class QAction;
 class QMenu;
 class State;
 
 namespace DumpStatePlugin {
 
+class StateLogger;
+
 class DumpState : public QObject, public IPlugin {
 	Q_OBJECT
 	Q_INTERFACES(IPlugin)
@@ -42,9 +45,13 @@ public:
 
 public:
 	virtual QMenu *menu(QWidget *parent = 0);
+	virtual QString extra_arguments() const;
+	virtual ArgumentStatus parse_arguments(QStringList &args);
 
 public Q_SLOTS:
 	void show_menu();
+	void toggle_logging(bool enabled);
+	bool log_state();
 
 private:
 	virtual QWidget *options_page();
@@ -57,7 +64,10 @@ private:
 	void dump_lines(edb::address_t address, int lines);
 
 private:
-	QMenu * menu_;
+	QMenu *      menu_;
+	QAction *    log_action_;
+	StateLogger *logger_;
+	QString      log_file_; // from --log-state
 };
 
 }
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "OptionsPage.h"
+#include <QFileDialog>
 #include <QSettings>
 
 #include "ui_OptionsPage.h"
@@ -50,6 +51,10 @@ void OptionsPage::showEvent(QShowEvent *event) {
 	ui->instructionsBeforeIP->setValue(settings.value("DumpState/instructions_before_ip", 0).toInt());
 	ui->instructionsAfterIP->setValue(settings.value("DumpState/instructions_after_ip", 5).toInt());
 	ui->colorizeOutput->setChecked(settings.value("DumpState/colorize", true).toBool());
+	ui->logFile->setText(settings.value("DumpState/log_file").toString());
+	ui->logStackBytes->setValue(settings.value("DumpState/log_stack_bytes", 128).toInt());
+	ui->logDataBytes->setValue(settings.value("DumpState/log_data_bytes", 64).toInt());
+	ui->logRanges->setText(settings.value("DumpState/log_ranges").toString());
 }
 
 //------------------------------------------------------------------------------
@@ -79,4 +84,51 @@ void OptionsPage::on_colorizeOutput_toggled(bool value) {
 	settings.setValue("DumpState/colorize", value);
 }
 
+//------------------------------------------------------------------------------
+// Name: on_logFile_textChanged
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_logFile_textChanged(const QString &text) {
+	QSettings settings;
+	settings.setValue("DumpState/log_file", text);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_logStackBytes_valueChanged
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_logStackBytes_valueChanged(int i) {
+	QSettings settings;
+	settings.setValue("DumpState/log_stack_bytes", i);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_logDataBytes_valueChanged
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_logDataBytes_valueChanged(int i) {
+	QSettings settings;
+	settings.setValue("DumpState/log_data_bytes", i);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_logRanges_textChanged
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_logRanges_textChanged(const QString &text) {
+	QSettings settings;
+	settings.setValue("DumpState/log_ranges", text);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnLogFile_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void OptionsPage::on_btnLogFile_clicked() {
+	const QString filename = QFileDialog::getSaveFileName(this, tr("Log State To"), ui->logFile->text(), tr("JSON Lines (*.jsonl);;All Files (*)"), 0, QFileDialog::DontConfirmOverwrite);
+	if(!filename.isEmpty()) {
+		ui->logFile->setText(filename);
+	}
+}
+
 }
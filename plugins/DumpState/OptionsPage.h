@@ -39,6 +39,11 @@ public Q_SLOTS:
 	void on_instructionsBeforeIP_valueChanged(int i);
 	void on_instructionsAfterIP_valueChanged(int i);
 	void on_colorizeOutput_toggled(bool value);
+	void on_logFile_textChanged(const QString &text);
+	void on_logStackBytes_valueChanged(int i);
+	void on_logDataBytes_valueChanged(int i);
+	void on_logRanges_textChanged(const QString &text);
+	void on_btnLogFile_clicked();
 
 private:
 	Ui::OptionsPage *const ui;
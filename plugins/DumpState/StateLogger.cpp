@@ -0,0 +1,445 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "StateLogger.h"
+#include "Expression.h"
+#include "IDebugEvent.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "Instruction.h"
+#include "Register.h"
+#include "State.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QStringList>
+#include <QtDebug>
+
+namespace DumpStatePlugin {
+namespace {
+
+// how far behind the writer may fall before records are dropped
+constexpr qint64 MaxQueuedBytes = 64 * 1024 * 1024;
+
+const char *const Registers32[] = {
+	"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "eip", "eflags",
+	"es", "cs", "ss", "ds", "fs", "gs"
+};
+
+const char *const Registers64[] = {
+	"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+	"r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "rip", "rflags",
+	"es", "cs", "ss", "ds", "fs", "gs"
+};
+
+//------------------------------------------------------------------------------
+// Name: append_string
+// Desc: appends <s> as a JSON string
+//------------------------------------------------------------------------------
+void append_string(QByteArray *out, const QString &s) {
+	out->append('"');
+	for(const char ch : s.toUtf8()) {
+		switch(ch) {
+		case '"':  out->append("\\\""); break;
+		case '\\': out->append("\\\\"); break;
+		case '\n': out->append("\\n"); break;
+		case '\t': out->append("\\t"); break;
+		default:
+			if(static_cast<unsigned char>(ch) < 0x20) {
+				out->append(QString("\\u%1").arg(static_cast<int>(ch), 4, 16, QChar('0')).toLatin1());
+			} else {
+				out->append(ch);
+			}
+			break;
+		}
+	}
+	out->append('"');
+}
+
+//------------------------------------------------------------------------------
+// Name: append_address
+// Desc:
+//------------------------------------------------------------------------------
+void append_address(QByteArray *out, edb::address_t address) {
+	out->append('"');
+	out->append(address.toHexString().toLatin1());
+	out->append('"');
+}
+
+//------------------------------------------------------------------------------
+// Name: append_block
+// Desc: {"address":..., "bytes":...}, the bytes in hex
+//------------------------------------------------------------------------------
+void append_block(QByteArray *out, edb::address_t address, const QByteArray &bytes) {
+	out->append("{\"address\":");
+	append_address(out, address);
+	out->append(",\"bytes\":\"");
+	out->append(bytes.toHex());
+	out->append("\"}");
+}
+
+//------------------------------------------------------------------------------
+// Name: event_kind
+// Desc:
+//------------------------------------------------------------------------------
+const char *event_kind(const std::shared_ptr<IDebugEvent> &event) {
+	if(!event) {
+		return "dump";
+	}
+
+	if(event->is_trap()) {
+		switch(event->trap_reason()) {
+		case IDebugEvent::TRAP_STEPPING:   return "step";
+		case IDebugEvent::TRAP_BREAKPOINT: return "breakpoint";
+		case IDebugEvent::TRAP_SYSCALL:    return "syscall";
+		}
+	}
+	return "signal";
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: LogWriter
+// Desc:
+//------------------------------------------------------------------------------
+LogWriter::LogWriter(const QString &filename, QObject *parent) : QThread(parent), filename_(filename) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~LogWriter
+// Desc:
+//------------------------------------------------------------------------------
+LogWriter::~LogWriter() {
+	finish();
+	wait();
+}
+
+//------------------------------------------------------------------------------
+// Name: post
+// Desc: queues a record for writing, never blocks on the file
+//------------------------------------------------------------------------------
+void LogWriter::post(QByteArray record) {
+	QMutexLocker locker(&mutex_);
+
+	if(queued_bytes_ + record.size() > MaxQueuedBytes) {
+		++dropped_;
+		return;
+	}
+
+	queued_bytes_ += record.size();
+	queue_.enqueue(record);
+	ready_.wakeOne();
+}
+
+//------------------------------------------------------------------------------
+// Name: finish
+// Desc: the writer exits once everything queued so far is written
+//------------------------------------------------------------------------------
+void LogWriter::finish() {
+	QMutexLocker locker(&mutex_);
+	finished_ = true;
+	ready_.wakeOne();
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: writes whatever has piled up since the last time in one go. The file
+//       is opened here, opening a pipe blocks until there is a reader
+//------------------------------------------------------------------------------
+void LogWriter::run() {
+
+	QFile file(filename_);
+	const bool opened = file.open(QIODevice::WriteOnly | QIODevice::Append);
+	if(!opened) {
+		qWarning() << "[DumpState] unable to open" << filename_ << ":" << file.errorString();
+	}
+
+	Q_FOREVER {
+		QQueue<QByteArray> records;
+		quint64 dropped;
+
+		{
+			QMutexLocker locker(&mutex_);
+			while(queue_.isEmpty() && dropped_ == 0 && !finished_) {
+				ready_.wait(&mutex_);
+			}
+
+			if(queue_.isEmpty() && dropped_ == 0 && finished_) {
+				break;
+			}
+
+			records.swap(queue_);
+			dropped       = dropped_;
+			queued_bytes_ = 0;
+			dropped_      = 0;
+		}
+
+		if(!opened) {
+			continue;
+		}
+
+		if(dropped != 0) {
+			file.write(QString("{\"dropped\":%1}\n").arg(dropped).toLatin1());
+		}
+
+		for(const QByteArray &record : records) {
+			file.write(record);
+		}
+
+		file.flush();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: StateLogger
+// Desc:
+//------------------------------------------------------------------------------
+StateLogger::StateLogger() {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~StateLogger
+// Desc:
+//------------------------------------------------------------------------------
+StateLogger::~StateLogger() {
+	stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: starts logging to <filename>, which is appended to. The ranges logged
+//       are those set in the options at this point
+//------------------------------------------------------------------------------
+bool StateLogger::start(const QString &filename) {
+
+	stop();
+
+	if(filename.isEmpty()) {
+		return false;
+	}
+
+	QSettings settings;
+	instructions_ = settings.value("DumpState/instructions_after_ip", 6).toInt() + 1;
+	stack_bytes_  = settings.value("DumpState/log_stack_bytes", 128).toInt();
+	data_bytes_   = settings.value("DumpState/log_data_bytes", 64).toInt();
+
+	// "expression:size", separated by semicolons
+	ranges_.clear();
+	for(const QString &range : settings.value("DumpState/log_ranges").toString().split(';', QString::SkipEmptyParts)) {
+		const int colon = range.lastIndexOf(':');
+		bool ok;
+		const int size = range.mid(colon + 1).trimmed().toInt(&ok, 0);
+		if(colon > 0 && ok && size > 0) {
+			ranges_.push_back(qMakePair(range.left(colon).trimmed(), size));
+		} else {
+			qWarning() << "[DumpState] ignoring the range" << range;
+		}
+	}
+
+	writer_ = new LogWriter(filename);
+	writer_->start();
+	edb::v1::add_debug_event_handler(this);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc: whatever is still queued is written before this returns
+//------------------------------------------------------------------------------
+void StateLogger::stop() {
+	if(writer_) {
+		edb::v1::remove_debug_event_handler(this);
+		delete writer_;
+		writer_ = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: interest
+// Desc: there is no state to log once it has exited
+//------------------------------------------------------------------------------
+IDebugEventHandler::Interest StateLogger::interest() const {
+	Interest interest;
+	interest.kinds = EVENT_STOPPED;
+	return interest;
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc: logs the stop, and leaves the event to the other handlers
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS StateLogger::handle_event(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(writer_ && event->stopped()) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			if(std::shared_ptr<IThread> thread = process->current_thread()) {
+				State state;
+				thread->get_state(&state);
+				writer_->post(make_record(event, state));
+			}
+		}
+	}
+
+	return edb::DEBUG_NEXT_HANDLER;
+}
+
+//------------------------------------------------------------------------------
+// Name: log
+// Desc: logs the state as it is now, outside of any event
+//------------------------------------------------------------------------------
+bool StateLogger::log() {
+
+	if(writer_) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			if(std::shared_ptr<IThread> thread = process->current_thread()) {
+				State state;
+				thread->get_state(&state);
+				writer_->post(make_record(nullptr, state));
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: make_record
+// Desc: everything the record needs from memory is read in a single batch.
+//       <event> is null for a record asked for with log()
+//------------------------------------------------------------------------------
+QByteArray StateLogger::make_record(const std::shared_ptr<IDebugEvent> &event, const State &state) {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+
+	const edb::address_t ip = state.instruction_pointer();
+	const edb::address_t sp = state.stack_pointer();
+
+	// the code, the stack, the data view and then the extra ranges
+	QVector<edb::address_t> addresses;
+	QVector<QByteArray>     blocks;
+	addresses.push_back(ip);
+	blocks.push_back(QByteArray(instructions_ * edb::Instruction::MAX_SIZE, '\0'));
+	addresses.push_back(sp);
+	blocks.push_back(QByteArray(stack_bytes_, '\0'));
+	// there is no data view to follow without the main window
+	addresses.push_back(edb::v1::debugger_ui ? edb::v1::current_data_view_address() : edb::address_t(0));
+	blocks.push_back(QByteArray(edb::v1::debugger_ui ? data_bytes_ : 0, '\0'));
+
+	for(const QPair<QString, int> &range : ranges_) {
+		bool ok;
+		ExpressionError err;
+		const edb::address_t address = edb::v1::evaluate_expression(range.first, &ok, &err);
+		addresses.push_back(address);
+		blocks.push_back(ok ? QByteArray(range.second, '\0') : QByteArray());
+	}
+
+	QVector<ReadRequest> requests;
+	for(int i = 0; i < blocks.size(); ++i) {
+		requests.push_back({addresses[i], blocks[i].data(), static_cast<std::size_t>(blocks[i].size())});
+	}
+
+	const QVector<std::size_t> results = process->read_many(requests);
+	for(int i = 0; i < blocks.size(); ++i) {
+		blocks[i].resize(static_cast<int>(results[i]));
+	}
+
+	QByteArray record;
+	record.reserve(1024 + (stack_bytes_ + data_bytes_) * 2);
+
+	record.append(QString("{\"seq\":%1,\"time\":%2,\"pid\":%3,\"tid\":%4,\"event\":\"%5\",\"code\":%6")
+		.arg(++sequence_)
+		.arg(QDateTime::currentMSecsSinceEpoch())
+		.arg(event ? event->process() : process->pid())
+		.arg(event ? event->thread() : process->current_thread()->tid())
+		.arg(event_kind(event))
+		.arg(event ? event->code() : 0).toLatin1());
+
+	record.append(",\"regs\":{");
+	bool first = true;
+	auto append_registers = [&](const char *const *names, std::size_t count) {
+		for(std::size_t i = 0; i < count; ++i) {
+			if(const Register reg = state[names[i]]) {
+				if(!first) {
+					record.append(',');
+				}
+				first = false;
+				record.append('"');
+				record.append(names[i]);
+				record.append("\":\"");
+				record.append(reg.toHexString().toLatin1());
+				record.append('"');
+			}
+		}
+	};
+
+	if(edb::v1::debuggeeIs32Bit()) {
+		append_registers(Registers32, sizeof(Registers32) / sizeof(Registers32[0]));
+	} else {
+		append_registers(Registers64, sizeof(Registers64) / sizeof(Registers64[0]));
+	}
+	record.append('}');
+
+	// decoded from the one block, rather than read instruction by instruction
+	record.append(",\"disasm\":[");
+	const QByteArray &code = blocks[0];
+	int offset = 0;
+	for(int i = 0; i < instructions_ && offset < code.size(); ++i) {
+		const auto bytes = reinterpret_cast<const quint8 *>(code.constData()) + offset;
+		edb::Instruction inst(bytes, bytes + (code.size() - offset), ip + offset);
+		if(!inst) {
+			break;
+		}
+
+		if(i != 0) {
+			record.append(',');
+		}
+
+		record.append("{\"address\":");
+		append_address(&record, ip + offset);
+		record.append(",\"bytes\":\"");
+		record.append(code.mid(offset, static_cast<int>(inst.byte_size())).toHex());
+		record.append("\",\"text\":");
+		append_string(&record, QString::fromStdString(edb::v1::formatter().to_string(inst)));
+		record.append('}');
+
+		offset += static_cast<int>(inst.byte_size());
+	}
+	record.append(']');
+
+	record.append(",\"stack\":");
+	append_block(&record, addresses[1], blocks[1]);
+
+	record.append(",\"data\":[");
+	append_block(&record, addresses[2], blocks[2]);
+	for(int i = 0; i < ranges_.size(); ++i) {
+		record.append(',');
+		append_block(&record, addresses[i + 3], blocks[i + 3]);
+	}
+	record.append("]}\n");
+
+	return record;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef STATE_LOGGER_20171014_H_
+#define STATE_LOGGER_20171014_H_
+
+#include "IDebugEventHandler.h"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+class State;
+
+namespace DumpStatePlugin {
+
+// writes the records handed to it to a file (or pipe) on a thread of its own,
+// so that a slow reader never holds up the debuggee. If it falls too far
+// behind, records are dropped, and how many is noted in the log
+class LogWriter : public QThread {
+	Q_OBJECT
+
+public:
+	explicit LogWriter(const QString &filename, QObject *parent = 0);
+	virtual ~LogWriter();
+
+public:
+	void post(QByteArray record);
+	void finish();
+
+protected:
+	virtual void run();
+
+private:
+	QString            filename_;
+	QMutex             mutex_;
+	QWaitCondition     ready_;
+	QQueue<QByteArray> queue_;
+	qint64             queued_bytes_ = 0;
+	quint64            dropped_      = 0;
+	bool               finished_     = false;
+};
+
+// while enabled, emits a JSON record for every stop of the debuggee: the
+// registers, a disassembly window, a stack window and the data ranges asked
+// for, one record per line
+class StateLogger : public IDebugEventHandler {
+public:
+	StateLogger();
+	virtual ~StateLogger();
+
+public:
+	bool start(const QString &filename);
+	void stop();
+	bool active() const { return writer_ != nullptr; }
+	bool log();
+
+public:
+	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event);
+	virtual Interest interest() const;
+
+private:
+	QByteArray make_record(const std::shared_ptr<IDebugEvent> &event, const State &state);
+
+private:
+	LogWriter                   *writer_       = nullptr;
+	quint64                      sequence_     = 0;
+	int                          instructions_ = 0;
+	int                          stack_bytes_  = 0;
+	int                          data_bytes_   = 0;
+	QVector<QPair<QString, int>> ranges_; // expression, size
+};
+
+}
+
+#endif
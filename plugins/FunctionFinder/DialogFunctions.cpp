@@ -17,10 +17,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogFunctions.h"
+#include "FunctionsModel.h"
 #include "edb.h"
 #include "IAnalyzer.h"
 #include "MemoryRegions.h"
-#include "ISymbolManager.h"
 #ifdef ENABLE_GRAPH
 #include "GraphWidget.h"
 #include "GraphNode.h"
@@ -34,8 +34,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ui_DialogFunctions.h"
 
-#define MIN_REFCOUNT 2
-
 namespace FunctionFinderPlugin {
 
 //------------------------------------------------------------------------------
@@ -47,15 +45,20 @@ DialogFunctions::DialogFunctions(QWidget *parent) : QDialog(parent), ui(new Ui::
 
 #if QT_VERSION >= 0x050000
 	ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-	ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	ui->tableFunctions->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
 #else
 	ui->tableView->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
-	ui->tableWidget->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
+	ui->tableFunctions->horizontalHeader()->setResizeMode(QHeaderView::Interactive);
 #endif
 
 	filter_model_ = new QSortFilterProxyModel(this);
 	connect(ui->txtSearch, SIGNAL(textChanged(const QString &)), filter_model_, SLOT(setFilterFixedString(const QString &)));
 
+	functions_model_ = new FunctionsModel(this);
+	ui->tableFunctions->setModel(functions_model_);
+	ui->tableFunctions->sortByColumn(FunctionsModel::EntryColumn, Qt::AscendingOrder);
+	connect(ui->txtFilter, SIGNAL(textChanged(const QString &)), functions_model_, SLOT(setFilter(const QString &)));
+
 #ifdef ENABLE_GRAPH
 	ui->btnGraph->setEnabled(true);
 #else
@@ -72,14 +75,11 @@ DialogFunctions::~DialogFunctions() {
 }
 
 //------------------------------------------------------------------------------
-// Name: on_tableWidget_cellDoubleClicked
+// Name: on_tableFunctions_doubleClicked
 // Desc: follows the found item in the data view
 //------------------------------------------------------------------------------
-void DialogFunctions::on_tableWidget_cellDoubleClicked(int row, int column) {
-	Q_UNUSED(column);
-
-	QTableWidgetItem *const item = ui->tableWidget->item(row, 0);
-	const edb::address_t addr = item->data(Qt::UserRole).toULongLong();
+void DialogFunctions::on_tableFunctions_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(FunctionsModel::AddressRole).toULongLong();
 	edb::v1::jump_to_address(addr);
 }
 
@@ -91,9 +91,12 @@ void DialogFunctions::showEvent(QShowEvent *) {
 	filter_model_->setFilterKeyColumn(3);
 	filter_model_->setSourceModel(&edb::v1::memory_regions());
 	ui->tableView->setModel(filter_model_);
+	for(int column = MemoryRegions::FirstUsageColumn; column < filter_model_->columnCount(); ++column) {
+		ui->tableView->hideColumn(column);
+	}
 
 	ui->progressBar->setValue(0);
-	ui->tableWidget->setRowCount(0);
+	functions_model_->clear();
 }
 
 //------------------------------------------------------------------------------
@@ -117,64 +120,26 @@ void DialogFunctions::do_find() {
 			connect(analyzer_object, SIGNAL(update_progress(int)), ui->progressBar, SLOT(setValue(int)));
 		}
 
-		ui->tableWidget->setRowCount(0);
-		ui->tableWidget->setSortingEnabled(false);
+		functions_model_->clear();
+
+		QVector<IAnalyzer::FunctionIndex> indexes;
 
 		for(const QModelIndex &selected_item: sel) {
 
 			const QModelIndex index = filter_model_->mapToSource(selected_item);
 
-			// do the search for this region!
+			// do the search for this region, unless it's been done already
 			if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
 
-				analyzer->analyze(region);
-
-				const IAnalyzer::FunctionMap &results = analyzer->functions(region);
-
-				for(const Function &info: results) {
-
-					const int row = ui->tableWidget->rowCount();
-					ui->tableWidget->insertRow(row);
-
-					// entry point
-					auto p = new QTableWidgetItem(edb::v1::format_pointer(info.entry_address()));
-					p->setData(Qt::UserRole, info.entry_address());
-					ui->tableWidget->setItem(row, 0, p);
-
-					// upper bound of the function
-					if(info.reference_count() >= MIN_REFCOUNT) {
-						ui->tableWidget->setItem(row, 1, new QTableWidgetItem(edb::v1::format_pointer(info.end_address())));
-
-						auto size_item = new QTableWidgetItem;
-						size_item->setData(Qt::DisplayRole, info.end_address() - info.entry_address() + 1);
-
-						ui->tableWidget->setItem(row, 2, size_item);
-					}
-
-					// reference count
-					auto itemCount = new QTableWidgetItem;
-					itemCount->setData(Qt::DisplayRole, info.reference_count());
-					ui->tableWidget->setItem(row, 3, itemCount);
-
-					// type
-					switch(info.type()) {
-					case Function::FUNCTION_THUNK:
-						ui->tableWidget->setItem(row, 4, new QTableWidgetItem(tr("Thunk")));
-						break;
-					case Function::FUNCTION_STANDARD:
-						ui->tableWidget->setItem(row, 4, new QTableWidgetItem(tr("Standard Function")));
-						break;
-					}
-
-
-					QString symbol_name = edb::v1::symbol_manager().find_address_name(info.entry_address());
-					if(!symbol_name.isEmpty()) {
-						ui->tableWidget->setItem(row, 5, new QTableWidgetItem(symbol_name));
-					}
+				if(!analyzer->analyzed(region)) {
+					analyzer->analyze(region);
 				}
+
+				indexes.push_back(analyzer->function_index(region));
 			}
 		}
-		ui->tableWidget->setSortingEnabled(true);
+
+		functions_model_->setFunctions(indexes);
 
 		if(analyzer_object) {
 			disconnect(analyzer_object, SIGNAL(update_progress(int)), ui->progressBar, SLOT(setValue(int)));
@@ -207,81 +172,107 @@ void DialogFunctions::on_btnGraph_clicked() {
 
 	qDebug("[FunctionFinder] Constructing Graph...");
 
-	QModelIndexList indexList = ui->tableWidget->selectionModel()->selectedIndexes();
+	QModelIndexList indexList = ui->tableFunctions->selectionModel()->selectedIndexes();
 	if (indexList.size() >= 1) {
-		if (QTableWidgetItem *item = ui->tableWidget->item(indexList[0].row(), 0)) {
-			const edb::address_t addr = item->data(Qt::UserRole).toULongLong();
-			if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
-				const IAnalyzer::FunctionMap &functions = analyzer->functions();
+		const edb::address_t addr = functions_model_->address(indexList[0].row());
+		if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+			const IAnalyzer::FunctionMap &functions = analyzer->functions();
 
 
-				auto it = functions.find(addr);
-				if(it != functions.end()) {
-					Function f = *it;
+			auto it = functions.find(addr);
+			if(it != functions.end()) {
+				Function f = *it;
 
-					auto graph = new GraphWidget(nullptr);
-					graph->setAttribute(Qt::WA_DeleteOnClose);
+				auto graph = new GraphWidget(nullptr);
+				graph->setAttribute(Qt::WA_DeleteOnClose);
 
-					QMap<edb::address_t, GraphNode *> nodes;
+				QMap<edb::address_t, GraphNode *> nodes;
 
-					// first create all of the nodes
-					for(const BasicBlock &bb : f) {
-						auto node = new GraphNode(graph, bb.toString(), Qt::lightGray);
-						nodes.insert(bb.firstAddress(), node);
-					}
+				// first create all of the nodes
+				for(const BasicBlock &bb : f) {
+					auto node = new GraphNode(graph, bb.toString(), Qt::lightGray);
+					nodes.insert(bb.firstAddress(), node);
+				}
 
-					// then connect them!
-					for(const BasicBlock &bb : f) {
+				// then connect them!
+				for(const BasicBlock &bb : f) {
 
 
-						if(!bb.empty()) {
+					if(!bb.empty()) {
 
-							auto term = bb.back();
-							auto &inst = *term;
+						auto term = bb.back();
+						auto &inst = *term;
 
-							if(is_unconditional_jump(inst)) {
+						if(is_unconditional_jump(inst)) {
 
-								Q_ASSERT(inst.operand_count() >= 1);
-								const auto op = inst[0];
+							Q_ASSERT(inst.operand_count() >= 1);
+							const auto op = inst[0];
 
-								// TODO: we need some heuristic for detecting when this is
-								//       a call/ret -> jmp optimization
-								if(is_immediate(op)) {
-									const edb::address_t ea = op->imm;
+							// TODO: we need some heuristic for detecting when this is
+							//       a call/ret -> jmp optimization
+							if(is_immediate(op)) {
+								const edb::address_t ea = op->imm;
 
-									auto from = nodes.find(bb.firstAddress());
-									auto to = nodes.find(ea);
-									if(to != nodes.end() && from != nodes.end()) {
-										new GraphEdge(from.value(), to.value(), Qt::black);
-									}
+								auto from = nodes.find(bb.firstAddress());
+								auto to = nodes.find(ea);
+								if(to != nodes.end() && from != nodes.end()) {
+									new GraphEdge(from.value(), to.value(), Qt::black);
 								}
-							} else if(is_conditional_jump(inst)) {
+							}
+						} else if(is_conditional_jump(inst)) {
 
-								Q_ASSERT(inst.operand_count() == 1);
-								const auto op = inst[0];
+							Q_ASSERT(inst.operand_count() == 1);
+							const auto op = inst[0];
 
-								if(is_immediate(op)) {
+							if(is_immediate(op)) {
 
-									auto from = nodes.find(bb.firstAddress());
+								auto from = nodes.find(bb.firstAddress());
 
-									auto to_taken = nodes.find(op->imm);
-									if(to_taken != nodes.end() && from != nodes.end()) {
-										new GraphEdge(from.value(), to_taken.value(), Qt::green);
-									}
+								auto to_taken = nodes.find(op->imm);
+								if(to_taken != nodes.end() && from != nodes.end()) {
+									new GraphEdge(from.value(), to_taken.value(), Qt::green);
+								}
 
-									auto to_skipped = nodes.find(inst.rva() + inst.byte_size());
-									if(to_taken != nodes.end() && from != nodes.end()) {
-										new GraphEdge(from.value(), to_skipped.value(), Qt::red);
-									}
+								auto to_skipped = nodes.find(inst.rva() + inst.byte_size());
+								if(to_taken != nodes.end() && from != nodes.end()) {
+									new GraphEdge(from.value(), to_skipped.value(), Qt::red);
 								}
-							} else if(is_terminator(inst)) {
 							}
+						} else if(is_terminator(inst)) {
 						}
 					}
+				}
 
-					graph->layout();
-					graph->show();
+				// then the functions around it, from the call graph
+				auto entry = nodes.find(f.entry_address());
+				if(entry != nodes.end()) {
+					for(const edb::address_t caller : analyzer->callers(f.entry_address())) {
+						auto node = new GraphNode(graph, edb::v1::find_function_symbol(caller, caller.toPointerString()), Qt::cyan);
+						new GraphEdge(node, entry.value(), Qt::blue);
+					}
 				}
+
+				const QVector<edb::address_t> callees = analyzer->callees(f.entry_address());
+
+				QMap<edb::address_t, GraphNode *> callee_nodes;
+				for(const edb::address_t callee : callees) {
+					if(!nodes.contains(callee)) {
+						callee_nodes.insert(callee, new GraphNode(graph, edb::v1::find_function_symbol(callee, callee.toPointerString()), Qt::cyan));
+					}
+				}
+
+				for(const BasicBlock &bb : f) {
+					auto from = nodes.find(bb.firstAddress());
+					for(const QPair<edb::address_t, edb::address_t> &ref : bb.refs()) {
+						auto to = callee_nodes.find(ref.second);
+						if(to != callee_nodes.end() && from != nodes.end()) {
+							new GraphEdge(from.value(), to.value(), Qt::blue);
+						}
+					}
+				}
+
+				graph->layout();
+				graph->show();
 			}
 		}
 	}
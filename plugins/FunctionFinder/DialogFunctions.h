@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include <QDialog>
 
+class QModelIndex;
 class QSortFilterProxyModel;
 class IAnalyzer;
 
@@ -29,6 +30,8 @@ namespace FunctionFinderPlugin {
 
 namespace Ui { class DialogFunctions; }
 
+class FunctionsModel;
+
 class DialogFunctions : public QDialog {
 	Q_OBJECT
 
@@ -38,7 +41,7 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
-	void on_tableWidget_cellDoubleClicked (int row, int column);
+	void on_tableFunctions_doubleClicked(const QModelIndex &index);
 	void on_btnGraph_clicked();
 
 private:
@@ -50,6 +53,7 @@ private:
 private:
 	Ui::DialogFunctions *const ui;
 	QSortFilterProxyModel *    filter_model_;
+	FunctionsModel *           functions_model_;
 };
 
 }
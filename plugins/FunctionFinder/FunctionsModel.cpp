@@ -0,0 +1,358 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "FunctionsModel.h"
+#include "edb.h"
+#include "ISymbolManager.h"
+
+#include <QTimer>
+
+#include <algorithm>
+
+namespace FunctionFinderPlugin {
+
+namespace {
+
+// below this many references the end of a function is only a guess
+const int MIN_REFCOUNT = 2;
+
+// how many functions are looked up each time the event loop is idle, a few
+// milliseconds worth
+const int LOOKUP_BATCH = 1000;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: FunctionsModel
+// Desc:
+//------------------------------------------------------------------------------
+FunctionsModel::FunctionsModel(QObject *parent) : QAbstractTableModel(parent), next_lookup_(0), sort_column_(EntryColumn), sort_order_(Qt::AscendingOrder) {
+	timer_ = new QTimer(this);
+	timer_->setInterval(0);
+	connect(timer_, SIGNAL(timeout()), this, SLOT(lookup_batch()));
+}
+
+//------------------------------------------------------------------------------
+// Name: headerData
+// Desc:
+//------------------------------------------------------------------------------
+QVariant FunctionsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+
+	if(role == Qt::DisplayRole && orientation == Qt::Horizontal) {
+		switch(section) {
+		case EntryColumn:  return tr("Start Address");
+		case EndColumn:    return tr("End Address");
+		case SizeColumn:   return tr("Size");
+		case ScoreColumn:  return tr("Score");
+		case XrefsColumn:  return tr("References");
+		case TypeColumn:   return tr("Type");
+		case SymbolColumn: return tr("Symbol");
+		}
+	}
+
+	return QVariant();
+}
+
+//------------------------------------------------------------------------------
+// Name: data
+// Desc:
+//------------------------------------------------------------------------------
+QVariant FunctionsModel::data(const QModelIndex &index, int role) const {
+
+	if(!index.isValid() || index.row() >= rows_.size()) {
+		return QVariant();
+	}
+
+	const int n = rows_[index.row()];
+
+	if(role == AddressRole) {
+		return functions_.entries[n].toUint();
+	}
+
+	if(role != Qt::DisplayRole) {
+		return QVariant();
+	}
+
+	const bool has_end = functions_.reference_counts[n] >= MIN_REFCOUNT;
+
+	switch(index.column()) {
+	case EntryColumn:
+		return edb::v1::format_pointer(functions_.entries[n]);
+	case EndColumn:
+		return has_end ? edb::v1::format_pointer(functions_.ends[n]) : QVariant();
+	case SizeColumn:
+		return has_end ? (functions_.ends[n] - functions_.entries[n] + 1).toUint() : QVariant();
+	case ScoreColumn:
+		return functions_.reference_counts[n];
+	case XrefsColumn:
+		lookup(n);
+		return xrefs_[n];
+	case TypeColumn:
+		return (functions_.types[n] == Function::FUNCTION_THUNK) ? tr("Thunk") : tr("Standard Function");
+	case SymbolColumn:
+		lookup(n);
+		return symbols_[n];
+	}
+
+	return QVariant();
+}
+
+//------------------------------------------------------------------------------
+// Name: rowCount
+// Desc:
+//------------------------------------------------------------------------------
+int FunctionsModel::rowCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return rows_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: columnCount
+// Desc:
+//------------------------------------------------------------------------------
+int FunctionsModel::columnCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return ColumnCount;
+}
+
+//------------------------------------------------------------------------------
+// Name: address
+// Desc: the entry point of the function shown in <row>
+//------------------------------------------------------------------------------
+edb::address_t FunctionsModel::address(int row) const {
+	return functions_.entries[rows_[row]];
+}
+
+//------------------------------------------------------------------------------
+// Name: setFunctions
+// Desc: shows the functions of <indexes>, one for each region
+//------------------------------------------------------------------------------
+void FunctionsModel::setFunctions(const QVector<IAnalyzer::FunctionIndex> &indexes) {
+
+	beginResetModel();
+
+	if(indexes.size() == 1) {
+		functions_ = indexes.front();
+	} else {
+		// in address order, so the functions are too
+		QVector<IAnalyzer::FunctionIndex> sorted = indexes;
+		std::sort(sorted.begin(), sorted.end(), [](const IAnalyzer::FunctionIndex &lhs, const IAnalyzer::FunctionIndex &rhs) {
+			return !lhs.entries.isEmpty() && (rhs.entries.isEmpty() || lhs.entries.front() < rhs.entries.front());
+		});
+
+		functions_ = IAnalyzer::FunctionIndex();
+		for(const IAnalyzer::FunctionIndex &index : sorted) {
+			functions_.entries          += index.entries;
+			functions_.ends             += index.ends;
+			functions_.reference_counts += index.reference_counts;
+			functions_.types            += index.types;
+		}
+	}
+
+	const int count = functions_.entries.size();
+	xrefs_       = QVector<int>(count, 0);
+	symbols_     = QVector<QString>(count);
+	looked_up_   = QBitArray(count);
+	next_lookup_ = 0;
+
+	apply_filter();
+	apply_sort();
+
+	endResetModel();
+
+	if(count != 0) {
+		timer_->start();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void FunctionsModel::clear() {
+	setFunctions(QVector<IAnalyzer::FunctionIndex>());
+	timer_->stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: lookup
+// Desc: fills in the columns of function <n> which take a lookup
+//------------------------------------------------------------------------------
+void FunctionsModel::lookup(int n) const {
+
+	if(looked_up_.testBit(n)) {
+		return;
+	}
+
+	const edb::address_t entry = functions_.entries[n];
+
+	if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+		xrefs_[n] = analyzer->references(entry).size();
+	}
+
+	symbols_[n] = edb::v1::symbol_manager().find_address_name(entry);
+	looked_up_.setBit(n);
+}
+
+//------------------------------------------------------------------------------
+// Name: lookup_batch
+// Desc: the idle time part of filling in the columns, the view is told about
+//       each batch at once
+//------------------------------------------------------------------------------
+void FunctionsModel::lookup_batch() {
+
+	const int count = functions_.entries.size();
+	const int last  = std::min(count, next_lookup_ + LOOKUP_BATCH);
+
+	for(; next_lookup_ < last; ++next_lookup_) {
+		lookup(next_lookup_);
+	}
+
+	if(next_lookup_ == count) {
+		timer_->stop();
+	}
+
+	if(!rows_.isEmpty()) {
+		Q_EMIT dataChanged(index(0, XrefsColumn), index(rows_.size() - 1, SymbolColumn));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: lookup_all
+// Desc: sorting or filtering on the looked up columns can't wait for the timer
+//------------------------------------------------------------------------------
+void FunctionsModel::lookup_all() {
+
+	const int count = functions_.entries.size();
+	for(; next_lookup_ < count; ++next_lookup_) {
+		lookup(next_lookup_);
+	}
+	timer_->stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: setFilter
+// Desc: only shows the functions whose address or symbol contains <text>
+//------------------------------------------------------------------------------
+void FunctionsModel::setFilter(const QString &text) {
+
+	beginResetModel();
+	filter_ = text;
+	apply_filter();
+	apply_sort();
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_filter
+// Desc:
+//------------------------------------------------------------------------------
+void FunctionsModel::apply_filter() {
+
+	const int count = functions_.entries.size();
+
+	rows_.clear();
+
+	if(filter_.isEmpty()) {
+		rows_.reserve(count);
+		for(int n = 0; n < count; ++n) {
+			rows_.push_back(n);
+		}
+		return;
+	}
+
+	lookup_all();
+
+	for(int n = 0; n < count; ++n) {
+		if(symbols_[n].contains(filter_, Qt::CaseInsensitive) || edb::v1::format_pointer(functions_.entries[n]).contains(filter_, Qt::CaseInsensitive)) {
+			rows_.push_back(n);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: sort_key
+// Desc: what function <n> is sorted by in the current sort column, other than
+//       the symbol. Functions without a known end sort first by size or end
+//------------------------------------------------------------------------------
+quint64 FunctionsModel::sort_key(int n) const {
+
+	const bool has_end = functions_.reference_counts[n] >= MIN_REFCOUNT;
+
+	switch(sort_column_) {
+	case EndColumn:    return has_end ? functions_.ends[n].toUint() : 0;
+	case SizeColumn:   return has_end ? (functions_.ends[n] - functions_.entries[n] + 1).toUint() : 0;
+	case ScoreColumn:  return functions_.reference_counts[n];
+	case XrefsColumn:  return xrefs_[n];
+	case TypeColumn:   return functions_.types[n];
+	default:           return functions_.entries[n].toUint();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_sort
+// Desc: the functions are in address order to begin with, and ties stay in it
+//------------------------------------------------------------------------------
+void FunctionsModel::apply_sort() {
+
+	std::sort(rows_.begin(), rows_.end());
+
+	const bool descending = (sort_order_ == Qt::DescendingOrder);
+
+	if(sort_column_ == EntryColumn) {
+		if(descending) {
+			std::reverse(rows_.begin(), rows_.end());
+		}
+		return;
+	}
+
+	if(sort_column_ == XrefsColumn || sort_column_ == SymbolColumn) {
+		lookup_all();
+	}
+
+	if(sort_column_ == SymbolColumn) {
+		std::stable_sort(rows_.begin(), rows_.end(), [this, descending](int lhs, int rhs) {
+			return descending ? symbols_[rhs] < symbols_[lhs] : symbols_[lhs] < symbols_[rhs];
+		});
+	} else {
+		QVector<quint64> keys(functions_.entries.size());
+		for(const int n : rows_) {
+			keys[n] = sort_key(n);
+		}
+
+		std::stable_sort(rows_.begin(), rows_.end(), [&keys, descending](int lhs, int rhs) {
+			return descending ? keys[rhs] < keys[lhs] : keys[lhs] < keys[rhs];
+		});
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: sort
+// Desc:
+//------------------------------------------------------------------------------
+void FunctionsModel::sort(int column, Qt::SortOrder order) {
+
+	beginResetModel();
+	sort_column_ = column;
+	sort_order_  = order;
+	apply_sort();
+	endResetModel();
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FUNCTIONS_MODEL_20170716_H_
+#define FUNCTIONS_MODEL_20170716_H_
+
+#include "IAnalyzer.h"
+#include "Types.h"
+#include <QAbstractTableModel>
+#include <QBitArray>
+#include <QString>
+#include <QVector>
+
+class QTimer;
+
+namespace FunctionFinderPlugin {
+
+// The functions of the analyzed regions, straight from the analyzer's flat
+// index instead of its FunctionMaps. Nothing is made for a row until the
+// view asks for it; the columns which need a lookup, the cross references
+// and the symbol, are filled in a batch at a time while the event loop is
+// idle, or at once for the rows on screen. Sorting and filtering only move
+// row numbers around, those on the looked up columns finish the lookups first
+class FunctionsModel : public QAbstractTableModel {
+	Q_OBJECT
+
+public:
+	enum Column {
+		EntryColumn,
+		EndColumn,
+		SizeColumn,
+		ScoreColumn,
+		XrefsColumn,
+		TypeColumn,
+		SymbolColumn,
+		ColumnCount
+	};
+
+	enum Role {
+		AddressRole = Qt::UserRole
+	};
+
+public:
+	FunctionsModel(QObject *parent = 0);
+
+public:
+	virtual QVariant data(const QModelIndex &index, int role) const;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+public:
+	void setFunctions(const QVector<IAnalyzer::FunctionIndex> &indexes);
+	void clear();
+	edb::address_t address(int row) const;
+
+public Q_SLOTS:
+	void setFilter(const QString &text);
+
+private Q_SLOTS:
+	void lookup_batch();
+
+private:
+	void lookup(int n) const;
+	void lookup_all();
+	void apply_filter();
+	void apply_sort();
+	quint64 sort_key(int n) const;
+
+private:
+	// the indexes of all the regions end to end, a single region's is
+	// shared as it is
+	IAnalyzer::FunctionIndex functions_;
+
+	// filled in by lookup(), as the view asks or the timer gets to them
+	mutable QVector<int>     xrefs_;
+	mutable QVector<QString> symbols_;
+	mutable QBitArray        looked_up_;
+	int                      next_lookup_;
+	QTimer *                 timer_;
+
+	// the functions shown, in order
+	QVector<int>             rows_;
+	QString                  filter_;
+	int                      sort_column_;
+	Qt::SortOrder            sort_order_;
+};
+
+}
+
+#endif
@@ -42,6 +42,47 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace HardwareBreakpointsPlugin {
 
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: update_debug_registers
+// Desc: lets <update> change the current thread's debug registers, then writes
+//       the result into every thread in one go, without a full register round
+//       trip for each of them
+//------------------------------------------------------------------------------
+template <class F>
+void update_debug_registers(IProcess *process, F update) {
+
+	std::shared_ptr<IThread> current = process->current_thread();
+	if(!current) {
+		return;
+	}
+
+	IThread::DebugRegisters regs = current->get_debug_registers();
+	update(&regs);
+
+	process->for_each_thread([&regs](const std::shared_ptr<IThread> &thread) {
+		thread->set_debug_registers(regs);
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: size_index
+// Desc: the breakpoint size for <size> bytes, or -1 if there is none
+//------------------------------------------------------------------------------
+int size_index(int size) {
+	switch(size) {
+	case 1: return 0;
+	case 2: return 1;
+	case 4: return 2;
+	case 8: return 3;
+	default:
+		return -1;
+	}
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: HardwareBreakpoints
 // Desc:
@@ -164,14 +205,11 @@ void HardwareBreakpoints::setupBreakpoints() {
 			// hook it
 			edb::v1::add_debug_event_handler(this);
 
-			for(std::shared_ptr<IThread> &thread : process->threads()) {
-				State state;
-				thread->get_state(&state);
-
+			update_debug_registers(process, [&](IThread::DebugRegisters *regs) {
 				for(int i = 0; i < RegisterCount; ++i) {
 					if(ok[i]) {
 						setBreakpointState(
-							&state,
+							regs,
 							i,
 							{
 								enabled_[i]->isChecked(),
@@ -181,18 +219,13 @@ void HardwareBreakpoints::setupBreakpoints() {
 							});
 					}
 				}
-
-				thread->set_state(state);
-			}
+			});
 
 		} else {
 
-			for(std::shared_ptr<IThread> &thread : process->threads()) {
-				State state;
-				thread->get_state(&state);
-				state.set_debug_register(7, 0);
-				thread->set_state(state);
-			}
+			update_debug_registers(process, [](IThread::DebugRegisters *regs) {
+				(*regs)[7] = 0;
+			});
 
 			// we want to be disabled and we have hooked, so unhook
 			edb::v1::remove_debug_event_handler(this);
@@ -214,6 +247,16 @@ void HardwareBreakpoints::show_menu() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: interest
+// Desc: hardware breakpoints only ever show up as traps
+//------------------------------------------------------------------------------
+IDebugEventHandler::Interest HardwareBreakpoints::interest() const {
+	Interest interest;
+	interest.kinds = EVENT_STEP | EVENT_BREAKPOINT | EVENT_SYSCALL;
+	return interest;
+}
+
 //------------------------------------------------------------------------------
 // Name: handle_event
 // Desc: this hooks the debug event handler so we can make the breakpoints
@@ -386,12 +429,9 @@ void HardwareBreakpoints::setExecuteBP(int index, bool inUse) {
 
 		edb::address_t address = edb::v1::cpu_selected_address();
 
-		for(std::shared_ptr<IThread> &thread : process->threads()) {
-			State state;
-			thread->get_state(&state);
-			setBreakpointState(&state, index, { true, address, 0, 0 });
-			thread->set_state(state);
-		}
+		update_debug_registers(process, [&](IThread::DebugRegisters *regs) {
+			setBreakpointState(regs, index, { true, address, 0, 0 });
+		});
 	}
 
 	edb::v1::update_ui();
@@ -423,30 +463,15 @@ void HardwareBreakpoints::setWriteBP(int index, bool inUse, edb::address_t addre
 			}
 		}
 
-		for(std::shared_ptr<IThread> &thread : process->threads()) {
-			State state;
-			thread->get_state(&state);
-
-			switch(size) {
-			case 1:
-				setBreakpointState(&state, index, { true, address, 1, 0 });
-				break;
-			case 2:
-				setBreakpointState(&state, index, { true, address, 1, 1 });
-				break;
-			case 4:
-				setBreakpointState(&state, index, { true, address, 1, 2 });
-				break;
-			case 8:
-				setBreakpointState(&state, index, { true, address, 1, 3 });
-				break;
-			default:
-				QMessageBox::critical(nullptr, tr("Invalid Selection Size"), tr("Please select 1, 2, 4, or 8 bytes for this type of hardware breakpoint"));
-				return;
-			}
-
-			thread->set_state(state);
+		const int size_bp = size_index(size);
+		if(size_bp == -1) {
+			QMessageBox::critical(nullptr, tr("Invalid Selection Size"), tr("Please select 1, 2, 4, or 8 bytes for this type of hardware breakpoint"));
+			return;
 		}
+
+		update_debug_registers(process, [&](IThread::DebugRegisters *regs) {
+			setBreakpointState(regs, index, { true, address, 1, size_bp });
+		});
 	}
 
 	edb::v1::update_ui();
@@ -478,30 +503,15 @@ void HardwareBreakpoints::setReadWriteBP(int index, bool inUse, edb::address_t a
 			}
 		}
 
-		for(std::shared_ptr<IThread> &thread : process->threads()) {
-			State state;
-			thread->get_state(&state);
-
-			switch(size) {
-			case 1:
-				setBreakpointState(&state, index, { true, address, 2, 0 });
-				break;
-			case 2:
-				setBreakpointState(&state, index, { true, address, 2, 1 });
-				break;
-			case 4:
-				setBreakpointState(&state, index, { true, address, 2, 2 });
-				break;
-			case 8:
-				setBreakpointState(&state, index, { true, address, 2, 3 });
-				break;
-			default:
-				QMessageBox::critical(nullptr, tr("Invalid Selection Size"), tr("Please select 1, 2, 4, or 8 bytes for this type of hardward breakpoint"));
-				return;
-			}
-
-			thread->set_state(state);
+		const int size_bp = size_index(size);
+		if(size_bp == -1) {
+			QMessageBox::critical(nullptr, tr("Invalid Selection Size"), tr("Please select 1, 2, 4, or 8 bytes for this type of hardward breakpoint"));
+			return;
 		}
+
+		update_debug_registers(process, [&](IThread::DebugRegisters *regs) {
+			setBreakpointState(regs, index, { true, address, 2, size_bp });
+		});
 	}
 
 	edb::v1::update_ui();
@@ -50,6 +50,7 @@ public:
 public:
 	virtual QMenu *menu(QWidget *parent = 0);
 	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event);
+	virtual Interest interest() const;
 	virtual QList<QAction *> cpu_context_menu();
 	virtual QList<QAction *> stack_context_menu();
 	virtual QList<QAction *> data_context_menu();
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define LIB_HARDWARE_BREAKPOINTS_H_
 
 #include "edb.h"
+#include "IThread.h"
 
 namespace HardwareBreakpointsPlugin {
 
@@ -43,7 +44,7 @@ enum BreakpointStatus {
 };
 
 BreakpointState breakpointState(const State *state, int num);
-void setBreakpointState(State *state, int num, const BreakpointState &bp_state);
+void setBreakpointState(IThread::DebugRegisters *regs, int num, const BreakpointState &bp_state);
 BreakpointStatus validateBreakpoint(const BreakpointState &bp_state);
 
 }
@@ -18,14 +18,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "DialogHeap.h"
 #include "Configuration.h"
+#include "IDebugEvent.h"
 #include "IDebugger.h"
 #include "IProcess.h"
 #include "ISymbolManager.h"
 #include "MemoryRegions.h"
 #include "Module.h"
+#include "RegionScanner.h"
 #include "Symbol.h"
 #include "IRegion.h"
 #include "Util.h"
+#include "WordScan.h"
 #include "edb.h"
 
 #ifdef ENABLE_GRAPH
@@ -35,20 +38,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QSortFilterProxyModel>
-#include <QStack>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <QtDebug>
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <functional>
+#include <memory>
 
 #if QT_VERSION >= 0x050000
 #include <QtConcurrent>
 #elif QT_VERSION >= 0x040800
 #include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #endif
 
 #include "ui_DialogHeap.h"
@@ -97,13 +105,800 @@ edb::address_t block_start(const Result &result) {
 	return block_start(result.block);
 }
 
+// a block as a target of pointers, the words of [first, last) are all in it
+struct PointerTarget {
+	edb::address_t first;
+	edb::address_t last;
+	edb::address_t block;
+};
+
+// how far the search for pointers in a block has come
+struct PointerScan {
+	Result        *result;
+	edb::address_t next; // the next word to look at
+	edb::address_t end;
+};
+
+//------------------------------------------------------------------------------
+// Name: find_target
+// Desc: the block <pointer> points into, or nullptr. Where two of them overlap
+//       it is the later one
+//------------------------------------------------------------------------------
+const PointerTarget *find_target(const QVector<PointerTarget> &targets, edb::address_t pointer) {
+	auto it = std::upper_bound(targets.begin(), targets.end(), pointer, [](edb::address_t address, const PointerTarget &target) {
+		return address < target.first;
+	});
+
+	if(it == targets.begin()) {
+		return nullptr;
+	}
+
+	--it;
+	return (pointer < it->last) ? &*it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_block_pointers
+// Desc: looks through the words of <scan>'s block which are wholly in the
+//       window [window_first, window_last) at <data>. Words the window starts
+//       after were unreadable and are passed over. Runs on the thread pool, so
+//       it touches nothing but its own block's result
+//------------------------------------------------------------------------------
+template <class Word>
+void find_block_pointers(const QVector<PointerTarget> &targets, edb::address_t window_first, edb::address_t window_last, const quint8 *data, PointerScan *scan) {
+
+	const std::size_t n = sizeof(Word);
+
+	while(scan->next < scan->end && scan->next < window_first) {
+		scan->next += n;
+	}
+
+	if(scan->next >= scan->end || scan->next + n > window_last) {
+		return;
+	}
+
+	// the words starting before the end of the block, as offsets into the
+	// window, so the loop is over nothing but the bytes
+	const std::size_t first = (scan->next - window_first).toUint();
+	const std::size_t size  = std::min((window_last - window_first).toUint(), (scan->end - window_first).toUint() + n - 1);
+
+	util::for_each_word<Word>(data, size, first, [&](std::size_t, quint64 value) {
+		const edb::address_t pointer(value);
+		if(const PointerTarget *target = find_target(targets, pointer)) {
+		#if QT_POINTER_SIZE == 4
+			scan->result->data += QString("dword ptr [%1] |").arg(edb::v1::format_pointer(pointer));
+		#elif QT_POINTER_SIZE == 8
+			scan->result->data += QString("qword ptr [%1] |").arg(edb::v1::format_pointer(pointer));
+		#endif
+			scan->result->points_to.push_back(target->block);
+		}
+	});
+
+	scan->next += (size - first) / n * n;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_block_pointers
+// Desc: as above, for pointers of <pointer_size> bytes
+//------------------------------------------------------------------------------
+void find_block_pointers(const QVector<PointerTarget> &targets, edb::address_t window_first, edb::address_t window_last, const quint8 *data, std::size_t pointer_size, PointerScan *scan) {
+	if(pointer_size == 8) {
+		find_block_pointers<quint64>(targets, window_first, window_last, data, scan);
+	} else {
+		find_block_pointers<quint32>(targets, window_first, window_last, data, scan);
+	}
+}
+
+// Reads the heap a window at a time while its chunks are walked. The walk
+// only ever moves forward, so whatever lies in the current window is copied
+// out of it, only the few reads which straddle the end of a window go to the
+// process on their own
+class HeapReader {
+public:
+	HeapReader(IProcess *process, edb::address_t start, edb::address_t end) : process_(process), end_(end), scanner_(new RegionScanner(start, end)), exhausted_(false) {
+	}
+
+public:
+	// the bytes of the window from <address> on, and how many there are,
+	// moving on to the window holding <address> if need be. Chunks which are
+	// known not to have changed are skipped, so when the walk goes well past
+	// the next window the scanner starts over where it is instead
+	const quint8 *data(edb::address_t address, std::size_t *available) {
+
+		if(!exhausted_ && address >= scanner_->address() + scanner_->size() + RegionScanner::DefaultWindowSize) {
+			scanner_.reset(new RegionScanner(address, end_));
+		}
+
+		while(!exhausted_ && address >= scanner_->address() + scanner_->size()) {
+			exhausted_ = !scanner_->next();
+		}
+
+		if(exhausted_ || address < scanner_->address()) {
+			*available = 0;
+			return nullptr;
+		}
+
+		const std::size_t offset = (address - scanner_->address()).toUint();
+		*available = scanner_->size() - offset;
+		return scanner_->data() + offset;
+	}
+
+	bool read(edb::address_t address, void *buf, std::size_t n) {
+		std::size_t available;
+		if(const quint8 *p = data(address, &available)) {
+			if(available >= n) {
+				std::memcpy(buf, p, n);
+				return true;
+			}
+		}
+
+		return process_->read_bytes(address, buf, n) == n;
+	}
+
+	// whether what data() doesn't have can't be read at all
+	bool complete() const {
+		return false;
+	}
+
+private:
+	IProcess                      *process_;
+	edb::address_t                 end_;
+	std::unique_ptr<RegionScanner> scanner_;
+	bool                           exhausted_;
+};
+
+// A heap segment which was read in full beforehand. It never goes to the
+// process, so the walk of a segment can run on the thread pool
+class SegmentReader {
+public:
+	SegmentReader(edb::address_t start, const QByteArray &bytes) : start_(start), bytes_(bytes) {
+	}
+
+public:
+	const quint8 *data(edb::address_t address, std::size_t *available) const {
+		if(address < start_ || address >= start_ + bytes_.size()) {
+			*available = 0;
+			return nullptr;
+		}
+
+		const std::size_t offset = (address - start_).toUint();
+		*available = bytes_.size() - offset;
+		return reinterpret_cast<const quint8 *>(bytes_.constData()) + offset;
+	}
+
+	bool read(edb::address_t address, void *buf, std::size_t n) const {
+		std::size_t available;
+		if(const quint8 *p = data(address, &available)) {
+			if(available >= n) {
+				std::memcpy(buf, p, n);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool complete() const {
+		return true;
+	}
+
+private:
+	edb::address_t start_;
+	QByteArray     bytes_;
+};
+
+//------------------------------------------------------------------------------
+// Name: escape
+// Desc: the same escapes edb::v1::get_ascii_string_at_address uses
+//------------------------------------------------------------------------------
+QString escape(QString s) {
+	s.replace("\r", "\\r");
+	s.replace("\n", "\\n");
+	s.replace("\t", "\\t");
+	s.replace("\v", "\\v");
+	s.replace("\"", "\\\"");
+	return s;
+}
+
+//------------------------------------------------------------------------------
+// Name: block_data
+// Desc: what the <size> bytes at <address> look like they hold, if anything.
+//       The strings are looked for in the window, only one which runs up to
+//       the end of it is read again from the process
+//------------------------------------------------------------------------------
+template <class Reader>
+QString block_data(Reader &reader, edb::address_t address, int size, int min_string_length) {
+
+	std::size_t available;
+	const quint8 *const p = reader.data(address, &available);
+
+	if(min_string_length <= size) {
+		QString s;
+		int length;
+
+		const std::size_t ascii_limit = std::min<std::size_t>(available, size);
+
+		std::size_t ascii_length = 0;
+		while(ascii_length < ascii_limit && p[ascii_length] < 0x80 && (std::isprint(p[ascii_length]) || std::isspace(p[ascii_length]))) {
+			++ascii_length;
+		}
+
+		if(ascii_length == available && ascii_length < static_cast<std::size_t>(size) && !reader.complete()) {
+			if(edb::v1::get_ascii_string_at_address(address, s, min_string_length, size, length)) {
+				return QString("ASCII \"%1\"").arg(s);
+			}
+		} else if(ascii_length >= static_cast<std::size_t>(min_string_length)) {
+			return QString("ASCII \"%1\"").arg(escape(QString::fromLatin1(reinterpret_cast<const char *>(p), ascii_length)));
+		}
+
+		const std::size_t utf16_limit = std::min<std::size_t>(available / 2, size);
+
+		std::size_t utf16_length = 0;
+		while(utf16_length < utf16_limit && p[utf16_length * 2 + 1] == 0 && p[utf16_length * 2] >= 0x20 && p[utf16_length * 2] < 0x80) {
+			++utf16_length;
+		}
+
+		if(utf16_length == available / 2 && utf16_length < static_cast<std::size_t>(size) && !reader.complete()) {
+			if(edb::v1::get_utf16_string_at_address(address, s, min_string_length, size, length)) {
+				return QString("UTF-16 \"%1\"").arg(s);
+			}
+		} else if(utf16_length >= static_cast<std::size_t>(min_string_length)) {
+			QString utf16;
+			for(std::size_t i = 0; i < utf16_length; ++i) {
+				utf16 += QChar(p[i * 2]);
+			}
+			return QString("UTF-16 \"%1\"").arg(escape(utf16));
+		}
+	}
+
+	quint8 bytes[16];
+	if(!reader.read(address, bytes, sizeof(bytes))) {
+		return QString();
+	}
+
+	using std::memcmp;
+
+	if(memcmp(bytes, "\x89\x50\x4e\x47", 4) == 0) {
+		return "PNG IMAGE";
+	} else if(memcmp(bytes, "\x2f\x2a\x20\x58\x50\x4d\x20\x2a\x2f", 9) == 0) {
+		return "XPM IMAGE";
+	} else if(memcmp(bytes, "\x42\x5a", 2) == 0) {
+		return "BZIP FILE";
+	} else if(memcmp(bytes, "\x1f\x9d", 2) == 0) {
+		return "COMPRESS FILE";
+	} else if(memcmp(bytes, "\x1f\x8b", 2) == 0) {
+		return "GZIP FILE";
+	}
+
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: read_block
+// Desc: parses the chunk at <address>. Returns false if it ends the walk,
+//       because it can't be read or the heap looks broken
+//------------------------------------------------------------------------------
+template <class Addr, class Reader>
+bool read_block(Reader &reader, edb::address_t address, edb::address_t start_address, edb::address_t end_address, int min_string_length, DialogHeap::BlockState *block) {
+
+	malloc_chunk<Addr> currentChunk;
+	if(!reader.read(address, &currentChunk, sizeof(currentChunk))) {
+		return false;
+	}
+
+	const edb::address_t nextChunkAddress = next_chunk(address, currentChunk);
+
+	block->address = address;
+	block->size    = currentChunk.chunk_size();
+	block->data.clear();
+
+	// is this the last chunk (if so, it's the 'top')
+	if(nextChunkAddress == end_address) {
+		block->flags     = DialogHeap::BLOCK_TOP;
+		block->clean_end = address + sizeof(currentChunk);
+		return true;
+	}
+
+	// make sure we aren't following a broken heap...
+	if(nextChunkAddress > end_address || nextChunkAddress < start_address) {
+		return false;
+	}
+
+	// if this block is a container for an ascii string, display it...
+	// there is a lot of room for improvement here, but it's a start
+	block->data = block_data(reader, block_start(address), block->size.toUint(), min_string_length);
+
+	// read in the next chunk
+	malloc_chunk<Addr> nextChunk;
+	if(!reader.read(nextChunkAddress, &nextChunk, sizeof(nextChunk))) {
+		return false;
+	}
+
+	block->flags = nextChunk.prev_inuse() ? DialogHeap::BLOCK_BUSY : DialogHeap::BLOCK_FREE;
+
+	// everything the above may have looked at, a UTF-16 string can run on
+	// for twice the size of the block
+	block->clean_end = std::max(nextChunkAddress + sizeof(nextChunk), block_start(address) + std::max<edb::address_t>(block->size * 2, 16));
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: heap_changed_pages
+// Desc: the pages of [start_address, end_address) written to since the process
+//       was last continued, sorted. Returns false if that isn't known
+//------------------------------------------------------------------------------
+bool heap_changed_pages(IProcess *process, edb::address_t start_address, edb::address_t end_address, QVector<edb::address_t> *pages) {
+
+	pages->clear();
+
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(region->end() <= start_address || region->start() >= end_address) {
+			continue;
+		}
+
+		QVector<edb::address_t> region_pages;
+		if(!process->changed_pages(region, &region_pages)) {
+			return false;
+		}
+
+		*pages += region_pages;
+	}
+
+	std::sort(pages->begin(), pages->end());
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_clean
+// Desc: true if none of the pages of [first, last) is one of the sorted <pages>
+//------------------------------------------------------------------------------
+bool is_clean(const QVector<edb::address_t> &pages, edb::address_t first, edb::address_t last, edb::address_t page_size) {
+	auto it = std::lower_bound(pages.begin(), pages.end(), first - first % page_size);
+	return it == pages.end() || *it >= last;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pointer
+// Desc: the pointer at <address>, 0 if it can't be read
+//------------------------------------------------------------------------------
+template <class Addr>
+edb::address_t read_pointer(IProcess *process, edb::address_t address) {
+	Addr value(0);
+	if(process->read_bytes(address, &value, sizeof(value)) != sizeof(value)) {
+		return 0;
+	}
+	return edb::address_t::fromZeroExtended(value);
+}
+
+//------------------------------------------------------------------------------
+// Name: find_arenas
+// Desc: the heap segments of all of the malloc arenas but the main one, whose
+//       heap is found through __curbrk. The arenas are a circular list from
+//       main_arena, each of them lives at the start of its first heap_info
+//       segment, the segments of an arena are linked back from the one its
+//       top chunk is in. The layout of malloc_state changed over glibc
+//       versions, the one which makes a list which returns to main_arena, and
+//       whose arenas are where their heaps say, is taken
+//------------------------------------------------------------------------------
+template <class Addr>
+QVector<DialogHeap::ArenaSegment> find_arenas(IProcess *process, edb::address_t main_arena) {
+
+	const std::size_t P = sizeof(Addr);
+
+	// glibc's HEAP_MAX_SIZE, heaps are aligned to it
+	const quint64 heap_max_size = (P == 8) ? 0x4000000 : 0x100000;
+
+	// the mutex, the flags and have_fastchunks (since 2.27) come before the
+	// fastbins, of which there are 10 or 11
+	struct Layout {
+		std::size_t fastbins;
+		std::size_t count;
+	};
+
+	const std::size_t have_fastchunks = (P == 8) ? 16 : 12;
+	const Layout layouts[] = {
+		{ have_fastchunks, 10 },
+		{ 8,               10 },
+		{ have_fastchunks, 11 },
+		{ 8,               11 }
+	};
+
+	for(const Layout &layout : layouts) {
+		// fastbinsY, top, last_remainder, bins, binmap and then next
+		const std::size_t top_offset   = layout.fastbins + layout.count * P;
+		const std::size_t next_offset  = top_offset + 2 * P + 254 * P + 16;
+		const std::size_t state_size   = next_offset + 5 * P;
+
+		QVector<DialogHeap::ArenaSegment> segments;
+		QSet<edb::address_t>              seen;
+
+		edb::address_t arena = read_pointer<Addr>(process, main_arena + next_offset);
+		bool valid = true;
+		while(valid && arena != main_arena) {
+
+			// a broken list, or not the right layout
+			if(arena == 0 || seen.contains(arena) || seen.size() > 1024) {
+				valid = false;
+				break;
+			}
+			seen.insert(arena);
+
+			const edb::address_t first_heap = arena - (arena % heap_max_size);
+			const edb::address_t top        = read_pointer<Addr>(process, arena + top_offset);
+			const edb::address_t top_size   = read_pointer<Addr>(process, top + P) & ~quint64(SIZE_BITS);
+			const QString        name       = DialogHeap::tr("Arena %1").arg(edb::v1::format_pointer(arena));
+
+			// the heap_info comes first in each segment, the arena follows it
+			// in the first one, with the chunks after it aligned for malloc
+			edb::address_t heap = top - (top % heap_max_size);
+			for(int n = 0; heap != 0 && n < 1024; ++n) {
+				if(read_pointer<Addr>(process, heap) != arena) {
+					valid = (n != 0);
+					break;
+				}
+
+				edb::address_t start = heap + (arena - first_heap);
+				if(heap == first_heap) {
+					start = arena + state_size;
+
+					const std::size_t misalign = ((start + 2 * P) % 16).toUint();
+					if(misalign != 0) {
+						start += 16 - misalign;
+					}
+				}
+
+				const edb::address_t end = (top >= heap && top < heap + heap_max_size) ? top + top_size : heap + read_pointer<Addr>(process, heap + 2 * P);
+				if(start < end) {
+					segments.push_back(DialogHeap::ArenaSegment{start, end, name});
+				}
+
+				heap = read_pointer<Addr>(process, heap + P);
+			}
+
+			arena = read_pointer<Addr>(process, arena + next_offset);
+		}
+
+		if(valid) {
+			return segments;
+		}
+	}
+
+	qDebug() << "[Heap Analyzer] the arena list of main_arena could not be followed";
+	return QVector<DialogHeap::ArenaSegment>();
+}
+
+//------------------------------------------------------------------------------
+// Name: walk_segment
+// Desc: the chunks of a segment, read in full into <bytes> beforehand. Runs on
+//       the thread pool
+//------------------------------------------------------------------------------
+template <class Addr>
+QVector<DialogHeap::BlockState> walk_segment(const DialogHeap::ArenaSegment &segment, const QByteArray &bytes, int min_string_length) {
+
+	QVector<DialogHeap::BlockState> blocks;
+
+	SegmentReader reader(segment.start, bytes);
+
+	edb::address_t address = segment.start;
+	while(address != segment.end) {
+		DialogHeap::BlockState block;
+		if(!read_block<Addr>(reader, address, segment.start, segment.end, min_string_length, &block)) {
+			break;
+		}
+
+		blocks.push_back(block);
+
+		// the fenceposts at the end of a segment are of size 0
+		const edb::address_t next = block.address + block.size;
+		if(next == address) {
+			break;
+		}
+
+		address = next;
+	}
+
+	return blocks;
+}
+
+//------------------------------------------------------------------------------
+// Name: block_delta
+// Desc: how <block> differs from what was at its address at the last search
+//------------------------------------------------------------------------------
+QString block_delta(const DialogHeap::BlockState *previous, const DialogHeap::BlockState &block) {
+
+	if(!previous) {
+		return (block.flags & DialogHeap::BLOCK_BUSY) ? DialogHeap::tr("Allocated") : DialogHeap::tr("New");
+	}
+
+	if(previous->size != block.size) {
+		return DialogHeap::tr("Resized From %1").arg(edb::v1::format_pointer(previous->size));
+	}
+
+	if(previous->flags != block.flags) {
+		return (block.flags & DialogHeap::BLOCK_BUSY) ? DialogHeap::tr("Allocated") : DialogHeap::tr("Freed");
+	}
+
+	return QString();
+}
+
+
+#ifdef ENABLE_GRAPH
+// up to this many blocks are shown one node each, more are grouped into at
+// most about MaxClusters nodes which can be opened in a graph of their own
+const int MaxDetailedBlocks = 400;
+const int MaxClusters       = 64;
+
+//------------------------------------------------------------------------------
+// Name: size_class
+// Desc: blocks of [2^n, 2^(n+1)) bytes are of class n
+//------------------------------------------------------------------------------
+int size_class(edb::address_t size) {
+	int n = 0;
+	while(size >>= 1) {
+		++n;
+	}
+	return n;
+}
+
+//------------------------------------------------------------------------------
+// Name: strongly_connected
+// Desc: the strongly connected component of each of the <nodes> of the
+//       snapshot, considering only the pointers between them. <local> maps a
+//       block to its position in <nodes>, or -1. This is Tarjan's algorithm,
+//       with an explicit stack, long chains of pointers are common in heaps
+//------------------------------------------------------------------------------
+QVector<int> strongly_connected(const HeapSnapshot &snapshot, const QVector<int> &nodes, const QVector<int> &local, int *components) {
+
+	struct Frame {
+		int node;
+		int edge;
+	};
+
+	const int count = nodes.size();
+
+	QVector<int>  index(count, -1);
+	QVector<int>  low(count, 0);
+	QVector<int>  component(count, -1);
+	QVector<bool> on_stack(count, false);
+	QVector<int>  stack;
+	QVector<Frame> calls;
+
+	int next_index = 0;
+	*components    = 0;
+
+	const auto visit = [&](int node) {
+		index[node] = low[node] = next_index++;
+		stack.push_back(node);
+		on_stack[node] = true;
+		calls.push_back(Frame{node, snapshot.edge_first[nodes[node]]});
+	};
+
+	for(int root = 0; root < count; ++root) {
+		if(index[root] != -1) {
+			continue;
+		}
+
+		visit(root);
+
+		while(!calls.isEmpty()) {
+			const int node = calls.back().node;
+			const int edge = calls.back().edge;
+
+			if(edge != snapshot.edge_first[nodes[node] + 1]) {
+				++calls.back().edge;
+
+				const int target = local[snapshot.edge_targets[edge]];
+				if(target == -1) {
+					continue;
+				}
+
+				if(index[target] == -1) {
+					visit(target);
+				} else if(on_stack[target]) {
+					low[node] = std::min(low[node], index[target]);
+				}
+				continue;
+			}
+
+			if(low[node] == index[node]) {
+				int member;
+				do {
+					member = stack.back();
+					stack.pop_back();
+					on_stack[member]  = false;
+					component[member] = *components;
+				} while(member != node);
+				++*components;
+			}
+
+			calls.pop_back();
+			if(!calls.isEmpty()) {
+				const int caller = calls.back().node;
+				low[caller] = std::min(low[caller], low[node]);
+			}
+		}
+	}
+
+	return component;
+}
+
+//------------------------------------------------------------------------------
+// Name: summarize
+// Desc: the graph of the <seeds>, and with <follow_pointers> everything they
+//       lead to. When there are too many blocks for one node each, blocks in
+//       a cycle are grouped by the cycle (only with <follow_pointers>, the
+//       members of a cycle are what is expanded from its node), the rest by
+//       their size class and whether they are in use. If that still makes a
+//       single group, it is split into address ranges
+//------------------------------------------------------------------------------
+HeapSummary summarize(const std::shared_ptr<const HeapSnapshot> &snapshot, const QVector<int> &seeds, bool follow_pointers) {
+
+	HeapSummary summary;
+	summary.snapshot = snapshot;
+
+	const HeapSnapshot &heap = *snapshot;
+
+	QVector<int> local(heap.blocks.size(), -1);
+	QVector<int> nodes;
+
+	for(int block : seeds) {
+		if(local[block] == -1) {
+			local[block] = nodes.size();
+			nodes.push_back(block);
+		}
+	}
+
+	if(follow_pointers) {
+		for(int i = 0; i < nodes.size(); ++i) {
+			const int block = nodes[i];
+			for(int edge = heap.edge_first[block]; edge != heap.edge_first[block + 1]; ++edge) {
+				const int target = heap.edge_targets[edge];
+				if(local[target] == -1) {
+					local[target] = nodes.size();
+					nodes.push_back(target);
+				}
+			}
+		}
+	}
+
+	const int count = nodes.size();
+	QVector<int> cluster_of(count);
+
+	if(count <= MaxDetailedBlocks) {
+		for(int i = 0; i < count; ++i) {
+			const int block = nodes[i];
+			cluster_of[i] = i;
+			summary.clusters.push_back(HeapCluster{
+				QVector<int>(1, block),
+				edb::v1::format_pointer(heap.blocks[block]),
+				heap.busy[block] ? Qt::lightGray : Qt::red
+			});
+		}
+	} else {
+		QVector<int> component;
+		QVector<int> component_size;
+		if(follow_pointers) {
+			int components;
+			component = strongly_connected(heap, nodes, local, &components);
+			component_size.fill(0, components);
+			for(int c : component) {
+				++component_size[c];
+			}
+		}
+
+		// cycles get negative keys, the size classes positive ones
+		QHash<qint64, int> clusters;
+		for(int i = 0; i < count; ++i) {
+			const int block = nodes[i];
+
+			qint64 key;
+			if(follow_pointers && component_size[component[i]] > 1) {
+				key = -1 - component[i];
+			} else {
+				key = (size_class(heap.sizes[block]) << 1) | (heap.busy[block] ? 1 : 0);
+			}
+
+			auto it = clusters.find(key);
+			if(it == clusters.end()) {
+				it = clusters.insert(key, clusters.size());
+			}
+			cluster_of[i] = *it;
+		}
+
+		if(clusters.size() == 1) {
+			// the blocks are sorted by address, so are their indexes
+			QVector<int> order(count);
+			for(int i = 0; i < count; ++i) {
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [&nodes](int lhs, int rhs) {
+				return nodes[lhs] < nodes[rhs];
+			});
+
+			const int chunk = (count + MaxClusters - 1) / MaxClusters;
+			for(int i = 0; i < count; ++i) {
+				cluster_of[order[i]] = i / chunk;
+			}
+
+			summary.clusters.resize((count + chunk - 1) / chunk);
+			for(int i = 0; i < count; ++i) {
+				summary.clusters[cluster_of[order[i]]].members.push_back(nodes[order[i]]);
+			}
+
+			for(HeapCluster &cluster : summary.clusters) {
+				cluster.label = DialogHeap::tr("%1 Blocks\n%2 - %3")
+					.arg(cluster.members.size())
+					.arg(edb::v1::format_pointer(heap.blocks[cluster.members.front()]))
+					.arg(edb::v1::format_pointer(heap.blocks[cluster.members.back()]));
+				cluster.color = Qt::cyan;
+			}
+		} else {
+			summary.clusters.resize(clusters.size());
+			for(int i = 0; i < count; ++i) {
+				summary.clusters[cluster_of[i]].members.push_back(nodes[i]);
+			}
+
+			for(auto it = clusters.begin(); it != clusters.end(); ++it) {
+				HeapCluster &cluster = summary.clusters[*it];
+
+				edb::address_t bytes = 0;
+				for(int block : cluster.members) {
+					bytes += heap.sizes[block];
+				}
+
+				if(it.key() < 0) {
+					cluster.label = DialogHeap::tr("%1 Blocks In A Cycle\n%2 Bytes").arg(cluster.members.size()).arg(bytes);
+					cluster.color = Qt::yellow;
+				} else {
+					const int  size = it.key() >> 1;
+					const bool busy = it.key() & 1;
+					cluster.label = DialogHeap::tr("%1 %2 Blocks\n%3 - %4 Bytes Each")
+						.arg(cluster.members.size())
+						.arg(busy ? DialogHeap::tr("Busy") : DialogHeap::tr("Free"))
+						.arg(1ull << size)
+						.arg((2ull << size) - 1);
+					cluster.color = busy ? Qt::lightGray : Qt::red;
+				}
+			}
+		}
+	}
+
+	// the pointers between the clusters, each pair once. Pointers within a
+	// cluster are only of interest when they are between single blocks
+	QSet<quint64> seen;
+	for(int i = 0; i < count; ++i) {
+		const int block = nodes[i];
+		for(int edge = heap.edge_first[block]; edge != heap.edge_first[block + 1]; ++edge) {
+			const int target = local[heap.edge_targets[edge]];
+			if(target == -1) {
+				continue;
+			}
+
+			const int from = cluster_of[i];
+			const int to   = cluster_of[target];
+			if(from == to && summary.clusters[from].members.size() != 1) {
+				continue;
+			}
+
+			const quint64 key = (static_cast<quint64>(from) << 32) | static_cast<quint32>(to);
+			if(!seen.contains(key)) {
+				seen.insert(key);
+				summary.edges.push_back(qMakePair(from, to));
+			}
+		}
+	}
+
+	return summary;
+}
+#endif
+
 }
 
 //------------------------------------------------------------------------------
 // Name: DialogHeap
 // Desc:
 //------------------------------------------------------------------------------
-DialogHeap::DialogHeap(QWidget *parent) : QDialog(parent), ui(new Ui::DialogHeap) {
+DialogHeap::DialogHeap(QWidget *parent) : QDialog(parent), ui(new Ui::DialogHeap), snapshot_pid_(0), events_since_snapshot_(0) {
 	ui->setupUi(this);
 
 	model_ = new ResultViewModel(this);
@@ -121,6 +916,8 @@ DialogHeap::DialogHeap(QWidget *parent) : QDialog(parent), ui(new Ui::DialogHeap
 #else
 	ui->btnGraph->setEnabled(false);
 #endif
+
+	edb::v1::add_debug_event_handler(this);
 }
 
 //------------------------------------------------------------------------------
@@ -128,9 +925,21 @@ DialogHeap::DialogHeap(QWidget *parent) : QDialog(parent), ui(new Ui::DialogHeap
 // Desc:
 //------------------------------------------------------------------------------
 DialogHeap::~DialogHeap() {
+	edb::v1::remove_debug_event_handler(this);
 	delete ui;
 }
 
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc: only counts the events, to know whether the soft-dirty bits still
+//       cover everything since the last search
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS DialogHeap::handle_event(const std::shared_ptr<IDebugEvent> &event) {
+	Q_UNUSED(event);
+	++events_since_snapshot_;
+	return edb::DEBUG_NEXT_HANDLER;
+}
+
 //------------------------------------------------------------------------------
 // Name: showEvent
 // Desc:
@@ -200,176 +1009,175 @@ void DialogHeap::get_library_names(QString *libcName, QString *ldName) const {
 	}
 }
 
-//------------------------------------------------------------------------------
-// Name: process_potential_pointer
-// Desc:
-//------------------------------------------------------------------------------
-void DialogHeap::process_potential_pointer(const QHash<edb::address_t, edb::address_t> &targets, Result &result) {
-
-	if(IProcess *process = edb::v1::debugger_core->process()) {
-		if(result.data.isEmpty()) {
-			edb::address_t pointer(0);
-			edb::address_t block_ptr = block_start(result);
-			edb::address_t block_end = block_ptr + result.size;
-
-			while(block_ptr < block_end) {
-
-				if(process->read_bytes(block_ptr, &pointer, edb::v1::pointer_size())) {
-					auto it = targets.find(pointer);
-					if(it != targets.end()) {
-					#if QT_POINTER_SIZE == 4
-						result.data += QString("dword ptr [%1] |").arg(edb::v1::format_pointer(it.key()));
-					#elif QT_POINTER_SIZE == 8
-						result.data += QString("qword ptr [%1] |").arg(edb::v1::format_pointer(it.key()));
-					#endif
-					result.points_to.push_back(it.value());
-					}
-				}
-
-				block_ptr += edb::v1::pointer_size();
-			}
-
-			result.data.truncate(result.data.size() - 2);
-		}
-	}
-}
-
 //------------------------------------------------------------------------------
 // Name: detect_pointers
-// Desc:
+// Desc: finds the words in the blocks which point anywhere into a block. The
+//       heap is read a window at a time here, the words of the blocks in each
+//       window are then looked up on the thread pool
 //------------------------------------------------------------------------------
 void DialogHeap::detect_pointers() {
 
 	qDebug() << "[Heap Analyzer] detecting pointers in heap blocks";
 
-	QHash<edb::address_t, edb::address_t> targets;
 	QVector<Result> &results = model_->results();
 
-	// the potential targets
+	// the potential targets, sorted by where they start
 	qDebug() << "[Heap Analyzer] collecting possible targets addresses";
+
+	QVector<PointerTarget> targets;
+	targets.reserve(results.size());
 	for(const Result &result: results) {
-		edb::address_t block_ptr = block_start(result);
-		edb::address_t block_end = block_ptr + result.size;
-		while(block_ptr < block_end) {
-			targets.insert(block_ptr, result.block);
-			block_ptr += edb::v1::pointer_size();
-		}
+		targets.push_back(PointerTarget{block_start(result), block_start(result) + result.size, result.block});
 	}
 
-#if QT_VERSION >= 0x040800
-	QtConcurrent::blockingMap(results, [this, targets](Result &result) {
-		process_potential_pointer(targets, result);
+	std::sort(targets.begin(), targets.end(), [](const PointerTarget &lhs, const PointerTarget &rhs) {
+		return lhs.first < rhs.first;
 	});
 
-#else
-	std::for_each(results.begin(), results.end(), [this, targets](Result &result) {
-		process_potential_pointer(targets, result);
+	// the blocks to look through, those which hold something else are skipped
+	QVector<PointerScan> scans;
+	for(Result &result: results) {
+		if(result.data.isEmpty() && result.size != 0) {
+			scans.push_back(PointerScan{&result, block_start(result), block_start(result) + result.size});
+		}
+	}
+
+	std::sort(scans.begin(), scans.end(), [](const PointerScan &lhs, const PointerScan &rhs) {
+		return lhs.next < rhs.next;
 	});
-#endif
+
+	if(!scans.isEmpty()) {
+		const std::size_t pointer_size = edb::v1::pointer_size();
+
+		edb::address_t last = scans.front().end;
+		for(const PointerScan &scan : scans) {
+			last = std::max(last, scan.end);
+		}
+
+		// a word read at the end of a block may run pointer_size - 1 bytes past it
+		RegionScanner scanner(scans.front().next, last + pointer_size - 1, pointer_size - 1);
+
+		int first_scan = 0;
+		while(scanner.next()) {
+			const edb::address_t window_first = scanner.address();
+			const edb::address_t window_last  = scanner.address() + scanner.size();
+
+			while(first_scan != scans.size() && scans[first_scan].next >= scans[first_scan].end) {
+				++first_scan;
+			}
+
+			int last_scan = first_scan;
+			while(last_scan != scans.size() && scans[last_scan].next < window_last) {
+				++last_scan;
+			}
+
+			const quint8 *const data = scanner.data();
+
+			const auto find_pointers = [&](PointerScan &scan) {
+				find_block_pointers(targets, window_first, window_last, data, pointer_size, &scan);
+			};
+
+		#if QT_VERSION >= 0x040800
+			QtConcurrent::blockingMap(scans.begin() + first_scan, scans.begin() + last_scan, find_pointers);
+		#else
+			std::for_each(scans.begin() + first_scan, scans.begin() + last_scan, find_pointers);
+		#endif
+		}
+	}
+
+	for(const PointerScan &scan : scans) {
+		scan.result->data.truncate(scan.result->data.size() - 2);
+	}
 
 	model_->update();
 }
 
 //------------------------------------------------------------------------------
 // Name: collect_blocks
-// Desc:
+// Desc: walks the chunks of [start_address, end_address), reading the heap in
+//       large windows instead of a few bytes at a time for every chunk. The
+//       chunks found are kept for the next search, which only parses again
+//       those which touch a page written to in the meantime, when it is known
+//       which those are, and can show what changed. The segments of the other
+//       <arenas> are all read at once, then walked in parallel
 //------------------------------------------------------------------------------
 template<class Addr>
-void DialogHeap::collect_blocks(edb::address_t start_address, edb::address_t end_address) {
+void DialogHeap::collect_blocks(edb::address_t start_address, edb::address_t end_address, const QVector<ArenaSegment> &arenas) {
 	model_->clearResults();
 
 	if(IProcess *process = edb::v1::debugger_core->process()) {
 		const int min_string_length = edb::v1::config().min_string_length;
 
-		if(start_address != 0 && end_address != 0) {
 	#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD)
-			malloc_chunk<Addr> currentChunk;
-			malloc_chunk<Addr> nextChunk;
-			edb::address_t currentChunkAddress = start_address;
+		const edb::address_t page_size = edb::v1::debugger_core->page_size();
+		const bool same_process        = !snapshot_.isEmpty() && snapshot_pid_ == process->pid();
+		const bool show_delta          = same_process && ui->chkDelta->isChecked();
 
-			model_->setUpdatesEnabled(false);
+		QVector<BlockState> blocks;
 
-			const edb::address_t how_many = end_address - start_address;
-			while(currentChunkAddress != end_address) {
-				// read in the current chunk..
-				process->read_bytes(currentChunkAddress, &currentChunk, sizeof(currentChunk));
+		model_->setUpdatesEnabled(false);
 
-				// figure out the address of the next chunk
-				const edb::address_t nextChunkAddress = next_chunk(currentChunkAddress, currentChunk);
+		const auto add_result = [&](const BlockState &block, const BlockState *previous, const QString &arena) {
+			Result r;
+			if(block.flags & BLOCK_TOP) {
+				r = Result(
+					block.address,
+					block.size,
+					tr("Top"));
+			} else {
+				r = Result(
+					block.address,
+					block.size + sizeof(unsigned int),
+					(block.flags & BLOCK_BUSY) ? tr("Busy") : tr("Free"),
+					block.data);
+			}
 
-				// is this the last chunk (if so, it's the 'top')
-				if(nextChunkAddress == end_address) {
+			if(show_delta) {
+				r.delta = block_delta(previous, block);
+			}
 
-					const Result r(
-						currentChunkAddress,
-						currentChunk.chunk_size(),
-						tr("Top"));
+			r.arena = arena;
+			model_->addResult(r);
+			blocks.push_back(block);
+		};
 
-					model_->addResult(r);
+		if(start_address != 0 && end_address != 0) {
 
-				} else {
+			// the soft-dirty bits only cover the last run of the process, any
+			// other event since the snapshot may hide writes from them
+			QVector<edb::address_t> dirty_pages;
+			const bool reuse = same_process && events_since_snapshot_ <= 1 && heap_changed_pages(process, start_address, end_address, &dirty_pages);
 
-					// make sure we aren't following a broken heap...
-					if(nextChunkAddress > end_address || nextChunkAddress < start_address) {
-						break;
-					}
+			int previous_index = 0;
 
-					QString data;
-
-					// read in the next chunk
-					process->read_bytes(nextChunkAddress, &nextChunk, sizeof(nextChunk));
-
-					// if this block is a container for an ascii string, display it...
-					// there is a lot of room for improvement here, but it's a start
-					QString asciiData;
-					QString utf16Data;
-					int asciisz;
-					int utf16sz;
-					if(edb::v1::get_ascii_string_at_address(
-							block_start(currentChunkAddress),
-							asciiData,
-							min_string_length,
-							currentChunk.chunk_size(),
-							asciisz)) {
-
-						data = QString("ASCII \"%1\"").arg(asciiData);
-					} else if(edb::v1::get_utf16_string_at_address(
-							block_start(currentChunkAddress),
-							utf16Data,
-							min_string_length,
-							currentChunk.chunk_size(),
-							utf16sz)) {
-						data = QString("UTF-16 \"%1\"").arg(utf16Data);
-					} else {
-
-						using std::memcmp;
-
-						quint8 bytes[16];
-						process->read_bytes(block_start(currentChunkAddress), bytes, sizeof(bytes));
-
-						if(memcmp(bytes, "\x89\x50\x4e\x47", 4) == 0) {
-							data = "PNG IMAGE";
-						} else if(memcmp(bytes, "\x2f\x2a\x20\x58\x50\x4d\x20\x2a\x2f", 9) == 0) {
-							data = "XPM IMAGE";
-						} else if(memcmp(bytes, "\x42\x5a", 2) == 0) {
-							data = "BZIP FILE";
-						} else if(memcmp(bytes, "\x1f\x9d", 2) == 0) {
-							data = "COMPRESS FILE";
-						} else if(memcmp(bytes, "\x1f\x8b", 2) == 0) {
-							data = "GZIP FILE";
-						}
+			edb::address_t currentChunkAddress = start_address;
 
-					}
+			HeapReader reader(process, start_address, end_address);
 
-					const Result r(
-						currentChunkAddress,
-						currentChunk.chunk_size() + sizeof(unsigned int),
-						nextChunk.prev_inuse() ? tr("Busy") : tr("Free"),
-						data);
+			const edb::address_t how_many = end_address - start_address;
+			while(currentChunkAddress != end_address) {
+
+				while(previous_index < snapshot_.size() && snapshot_[previous_index].address < currentChunkAddress) {
+					++previous_index;
+				}
 
-					model_->addResult(r);
+				const BlockState *previous = nullptr;
+				if(previous_index < snapshot_.size() && snapshot_[previous_index].address == currentChunkAddress) {
+					previous = &snapshot_[previous_index];
 				}
 
+				BlockState block;
+				if(reuse && previous && is_clean(dirty_pages, previous->address, previous->clean_end, page_size) && (previous->address + previous->size == end_address) == static_cast<bool>(previous->flags & BLOCK_TOP)) {
+					block = *previous;
+				} else if(!read_block<Addr>(reader, currentChunkAddress, start_address, end_address, min_string_length, &block)) {
+					break;
+				}
+
+				// figure out the address of the next chunk
+				const edb::address_t nextChunkAddress = block.address + block.size;
+
+				add_result(block, previous, tr("main_arena"));
+
 				// avoif self referencing blocks
 				if(currentChunkAddress == nextChunkAddress) {
 					break;
@@ -379,15 +1187,63 @@ void DialogHeap::collect_blocks(edb::address_t start_address, edb::address_t end
 
 				ui->progressBar->setValue(util::percentage(currentChunkAddress - start_address, how_many));
 			}
+		}
 
-			detect_pointers();
-			model_->setUpdatesEnabled(true);
+		if(!arenas.isEmpty()) {
 
+			// only the reads need the debugger, the walks are of the copies
+			QVector<MemoryRange> ranges;
+			for(const ArenaSegment &segment : arenas) {
+				ranges.push_back(MemoryRange{segment.start, (segment.end - segment.start).toUint()});
+			}
+
+			const QVector<QByteArray> segments = process->read_async(ranges).result();
+
+			QVector<int> indexes;
+			for(int i = 0; i < arenas.size(); ++i) {
+				indexes.push_back(i);
+			}
+
+			const std::function<QVector<BlockState>(int)> walk = [&](int i) {
+				return walk_segment<Addr>(arenas[i], segments[i], min_string_length);
+			};
+
+		#if QT_VERSION >= 0x040800
+			const QList<QVector<BlockState>> walked = QtConcurrent::blockingMapped<QList<QVector<BlockState>>>(indexes, walk);
+		#else
+			QList<QVector<BlockState>> walked;
+			for(int i : indexes) {
+				walked.push_back(walk(i));
+			}
+		#endif
+
+			for(int i = 0; i < walked.size(); ++i) {
+				for(const BlockState &block : walked[i]) {
+					auto it = std::lower_bound(snapshot_.begin(), snapshot_.end(), block.address, [](const BlockState &state, edb::address_t address) {
+						return state.address < address;
+					});
+
+					const BlockState *previous = (it != snapshot_.end() && it->address == block.address) ? &*it : nullptr;
+					add_result(block, previous, arenas[i].arena);
+				}
+			}
+		}
+
+		// sorted, the next search looks blocks up by address
+		std::sort(blocks.begin(), blocks.end(), [](const BlockState &lhs, const BlockState &rhs) {
+			return lhs.address < rhs.address;
+		});
+
+		snapshot_              = blocks;
+		snapshot_pid_          = process->pid();
+		events_since_snapshot_ = 0;
+
+		detect_pointers();
+		model_->setUpdatesEnabled(true);
 
 	#else
 		#error "Unsupported Platform"
 	#endif
-		}
 	}
 }
 
@@ -485,8 +1341,17 @@ void DialogHeap::do_find() {
 			}
 		}
 
+		// the arenas of the other threads, which have heaps of their own
+		QVector<ArenaSegment> arenas;
+		if(std::shared_ptr<Symbol> s = edb::v1::symbol_manager().find(libcName + "::main_arena")) {
+			arenas = find_arenas<Addr>(process, s->address);
+			qDebug() << "[Heap Analyzer] found" << arenas.size() << "heap segments of other arenas";
+		} else {
+			qDebug() << "[Heap Analyzer] main_arena symbol not found in libc, only the main heap is shown";
+		}
+
 		// ok, I give up
-		if(start_address == 0 || end_address == 0) {
+		if((start_address == 0 || end_address == 0) && arenas.isEmpty()) {
 			QMessageBox::critical(this, tr("Could not calculate heap bounds"), tr("Failed to calculate the bounds of the heap."));
 			return;
 		}
@@ -498,7 +1363,7 @@ void DialogHeap::do_find() {
 		qDebug() << "[Heap Analyzer] heap start : " << edb::v1::format_pointer(start_address);
 		qDebug() << "[Heap Analyzer] heap end   : " << edb::v1::format_pointer(end_address);
 
-		collect_blocks<Addr>(start_address, end_address);
+		collect_blocks<Addr>(start_address, end_address, arenas);
 	}
 }
 
@@ -518,87 +1383,173 @@ void DialogHeap::on_btnFind_clicked() {
 }
 
 //------------------------------------------------------------------------------
-// Name: on_btnGraph_clicked
-// Desc:
+// Name: heap_snapshot
+// Desc: the blocks of the last search and their pointers, in a form which
+//       can be worked on in the background
 //------------------------------------------------------------------------------
-void DialogHeap::on_btnGraph_clicked() {
-#ifdef ENABLE_GRAPH
+std::shared_ptr<const HeapSnapshot> DialogHeap::heap_snapshot() const {
 
-	auto graph = new GraphWidget(nullptr);
-	graph->setAttribute(Qt::WA_DeleteOnClose);
+	const QVector<Result> &results = model_->results();
 
+	QVector<const Result *> sorted;
+	sorted.reserve(results.size());
+	for(const Result &result: results) {
+		sorted.push_back(&result);
+	}
 
-	const QVector<Result> &results = model_->results();
+	std::sort(sorted.begin(), sorted.end(), [](const Result *lhs, const Result *rhs) {
+		return lhs->block < rhs->block;
+	});
 
-	do {
-		QMap<edb::address_t, GraphNode *>     nodes;
-		QHash<edb::address_t, const Result *> result_map;
-		QStack<const Result *>                result_stack;
-		QSet<const Result *>                  seen_results;
+	auto snapshot = std::make_shared<HeapSnapshot>();
+	snapshot->blocks.reserve(sorted.size());
+	snapshot->busy.reserve(sorted.size());
+	snapshot->sizes.reserve(sorted.size());
+	snapshot->edge_first.reserve(sorted.size() + 1);
 
-		// first we make a nice index for our results, this is likely redundant,
-		// but won't take long
-		for(const Result &result: results) {
-			result_map.insert(result.block, &result);
-		}
+	for(const Result *result : sorted) {
+		snapshot->blocks.push_back(result->block);
+		snapshot->busy.push_back(result->type == tr("Busy"));
+		snapshot->sizes.push_back(result->size);
+	}
 
-		// seed our search with the selected blocks
-		const QItemSelectionModel *const selModel = ui->tableView->selectionModel();
-		const QModelIndexList sel = selModel->selectedRows();
-		if(sel.size() != 0) {
-			for(const QModelIndex &index: sel) {
-				auto item = static_cast<Result *>(index.internalPointer());
-				result_stack.push(item);
-				seen_results.insert(item);
+	const QVector<edb::address_t> &blocks = snapshot->blocks;
+	for(const Result *result : sorted) {
+		snapshot->edge_first.push_back(snapshot->edge_targets.size());
+		for(edb::address_t pointer : result->points_to) {
+			auto it = std::lower_bound(blocks.begin(), blocks.end(), pointer);
+			if(it != blocks.end() && *it == pointer) {
+				snapshot->edge_targets.push_back(it - blocks.begin());
 			}
 		}
+	}
+	snapshot->edge_first.push_back(snapshot->edge_targets.size());
 
-		while(!result_stack.isEmpty()) {
-			const Result *const result = result_stack.pop();
+	return snapshot;
+}
 
-			GraphNode *node;
-			if(result->type == tr("Busy")) {
-				node = new GraphNode(graph, edb::v1::format_pointer(result->block), Qt::lightGray);
-			} else {
-				node = new GraphNode(graph, edb::v1::format_pointer(result->block), Qt::red);
-			}
+//------------------------------------------------------------------------------
+// Name: start_graph
+// Desc: summarizes the graph in the background, it is shown when done
+//------------------------------------------------------------------------------
+void DialogHeap::start_graph(const std::shared_ptr<const HeapSnapshot> &snapshot, const QVector<int> &seeds, bool follow_pointers) {
+#ifdef ENABLE_GRAPH
+#if QT_VERSION >= 0x040800
+	auto watcher = new QFutureWatcher<HeapSummary>(this);
+	connect(watcher, SIGNAL(finished()), this, SLOT(graph_ready()));
+	watcher->setFuture(QtConcurrent::run(summarize, snapshot, seeds, follow_pointers));
+#else
+	show_graph(summarize(snapshot, seeds, follow_pointers));
+#endif
+#else
+	Q_UNUSED(snapshot);
+	Q_UNUSED(seeds);
+	Q_UNUSED(follow_pointers);
+#endif
+}
 
-			nodes.insert(result->block, node);
+//------------------------------------------------------------------------------
+// Name: graph_ready
+// Desc:
+//------------------------------------------------------------------------------
+void DialogHeap::graph_ready() {
+	if(auto watcher = static_cast<QFutureWatcher<HeapSummary> *>(sender())) {
+		show_graph(watcher->result());
+		watcher->deleteLater();
+	}
+}
 
-			for(edb::address_t pointer: result->points_to) {
-				const Result *next_result = result_map[pointer];
-				if(!seen_results.contains(next_result)) {
-					seen_results.insert(next_result);
-					result_stack.push(next_result);
-				}
-			}
-		}
+//------------------------------------------------------------------------------
+// Name: show_graph
+// Desc:
+//------------------------------------------------------------------------------
+void DialogHeap::show_graph(const HeapSummary &summary) {
+#ifdef ENABLE_GRAPH
 
-		qDebug("[Heap Analyzer] Done Processing %d Nodes", nodes.size());
+	qDebug("[Heap Analyzer] Graphing %d Nodes And %d Edges", summary.clusters.size(), summary.edges.size());
 
-#if 1
-		if(nodes.size() > 5000) {
-			qDebug("[Heap Analyzer] Too Many Nodes! (%d)", nodes.size());
-			delete graph;
-			return;
-		}
-#endif
+	auto graph = new GraphWidget(nullptr);
+	graph->setAttribute(Qt::WA_DeleteOnClose);
 
-		Q_FOREACH(const Result *result, result_map) {
-			const edb::address_t addr = result->block;
-			if(nodes.contains(addr)) {
-				for(edb::address_t pointer: result->points_to) {
-					new GraphEdge(nodes[addr], nodes[pointer]);
-				}
-			}
+	GraphClusters &clusters = graphs_[graph];
+	clusters.snapshot = summary.snapshot;
+
+	QVector<GraphNode *> nodes;
+	nodes.reserve(summary.clusters.size());
+	for(const HeapCluster &cluster : summary.clusters) {
+		auto node = new GraphNode(graph, cluster.label, cluster.color);
+		if(cluster.members.size() != 1) {
+			clusters.members.insert(node, cluster.members);
 		}
+		nodes.push_back(node);
+	}
 
-		qDebug("[Heap Analyzer] Done Processing Edges");
-	} while(0);
+	for(const QPair<int, int> &edge : summary.edges) {
+		new GraphEdge(nodes[edge.first], nodes[edge.second]);
+	}
 
+	connect(graph, SIGNAL(nodeDoubleClickEvent(QMouseEvent*, GraphNode*)), this, SLOT(expand_cluster(QMouseEvent*, GraphNode*)));
+	connect(graph, SIGNAL(destroyed(QObject*)), this, SLOT(graph_destroyed(QObject*)));
 
 	graph->layout();
 	graph->show();
+#else
+	Q_UNUSED(summary);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: expand_cluster
+// Desc: opens the blocks of a cluster node in a graph of their own
+//------------------------------------------------------------------------------
+void DialogHeap::expand_cluster(QMouseEvent *event, GraphNode *node) {
+	Q_UNUSED(event);
+
+	auto it = graphs_.find(sender());
+	if(it != graphs_.end()) {
+		auto members = it->members.find(node);
+		if(members != it->members.end()) {
+			start_graph(it->snapshot, *members, false);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: graph_destroyed
+// Desc:
+//------------------------------------------------------------------------------
+void DialogHeap::graph_destroyed(QObject *graph) {
+	graphs_.remove(graph);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnGraph_clicked
+// Desc: graphs the selected blocks and everything they point to, or the whole
+//       heap without a selection
+//------------------------------------------------------------------------------
+void DialogHeap::on_btnGraph_clicked() {
+#ifdef ENABLE_GRAPH
+	const std::shared_ptr<const HeapSnapshot> snapshot = heap_snapshot();
+	const QVector<edb::address_t> &blocks = snapshot->blocks;
+
+	QVector<int> seeds;
+
+	const QItemSelectionModel *const selModel = ui->tableView->selectionModel();
+	for(const QModelIndex &index: selModel->selectedRows()) {
+		auto item = static_cast<Result *>(index.internalPointer());
+		auto it = std::lower_bound(blocks.begin(), blocks.end(), item->block);
+		if(it != blocks.end() && *it == item->block) {
+			seeds.push_back(it - blocks.begin());
+		}
+	}
+
+	if(seeds.isEmpty()) {
+		for(int i = 0; i < blocks.size(); ++i) {
+			seeds.push_back(i);
+		}
+	}
+
+	start_graph(snapshot, seeds, true);
 #endif
 }
 
@@ -20,45 +20,122 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define DIALOGHEAP_20061101_H_
 
 #include "Types.h"
+#include "IDebugEventHandler.h"
 #include "ResultViewModel.h"
 
+#include <QColor>
 #include <QDialog>
-
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class GraphNode;
+class QMouseEvent;
 class QSortFilterProxyModel;
 
 namespace HeapAnalyzerPlugin {
 
 namespace Ui { class DialogHeap; }
 
-class DialogHeap : public QDialog {
+// the blocks, sorted by address, and the pointers between them, which is all
+// the graph is built from. It is made once and shared by every graph which is
+// expanded from the first one
+struct HeapSnapshot {
+	QVector<edb::address_t> blocks;
+	QVector<bool>           busy;
+	QVector<edb::address_t> sizes;
+	QVector<int>            edge_first;   // the pointers of block i are [edge_first[i], edge_first[i + 1])
+	QVector<int>            edge_targets; // indexes into blocks
+};
+
+// a node of the graph, either a single block or a group of them
+struct HeapCluster {
+	QVector<int> members; // indexes into HeapSnapshot::blocks
+	QString      label;
+	QColor       color;
+};
+
+struct HeapSummary {
+	std::shared_ptr<const HeapSnapshot> snapshot;
+	QVector<HeapCluster>                clusters;
+	QVector<QPair<int, int>>            edges; // between clusters
+};
+
+class DialogHeap : public QDialog, public IDebugEventHandler {
 	Q_OBJECT
 
+public:
+	enum {
+		BLOCK_BUSY = 0x01,
+		BLOCK_FREE = 0x02,
+		BLOCK_TOP  = 0x04
+	};
+
+	// a chunk as it was at the last search
+	struct BlockState {
+		edb::address_t address;
+		edb::address_t size;
+		edb::address_t clean_end; // the end of the bytes the chunk was parsed from
+		quint32        flags;
+		QString        data;
+	};
+
+	// a heap_info segment of one of the arenas other than the main one
+	struct ArenaSegment {
+		edb::address_t start;
+		edb::address_t end;
+		QString        arena;
+	};
+
 public:
 	DialogHeap(QWidget *parent = 0);
 	virtual ~DialogHeap() override;
 
+public:
+	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event) override;
+
 public Q_SLOTS:
 	void on_btnFind_clicked();
 	void on_btnGraph_clicked();
 	void on_tableView_doubleClicked(const QModelIndex & index);
 
+private Q_SLOTS:
+	void graph_ready();
+	void graph_destroyed(QObject *graph);
+	void expand_cluster(QMouseEvent *event, GraphNode *node);
+
 private:
 	virtual void showEvent(QShowEvent *event) override;
 
 private:
 	void get_library_names(QString *libcName, QString *ldName) const;
 	template<class Addr>
-	void collect_blocks(edb::address_t start_address, edb::address_t end_address);
+	void collect_blocks(edb::address_t start_address, edb::address_t end_address, const QVector<ArenaSegment> &arenas);
 	void detect_pointers();
 	template<class Addr>
 	void do_find();
-	void process_potential_pointer(const QHash<edb::address_t, edb::address_t> &targets, Result &result);
 
 	edb::address_t find_heap_start_heuristic(edb::address_t end_address, size_t offset) const;
+	std::shared_ptr<const HeapSnapshot> heap_snapshot() const;
+	void start_graph(const std::shared_ptr<const HeapSnapshot> &snapshot, const QVector<int> &seeds, bool follow_pointers);
+	void show_graph(const HeapSummary &summary);
 
 private:
 	 Ui::DialogHeap *const ui;
 	 ResultViewModel *     model_;
+	 QVector<BlockState>   snapshot_;
+	 edb::pid_t            snapshot_pid_;
+	 int                   events_since_snapshot_;
+
+	 // the blocks behind each cluster node of the open graphs
+	 struct GraphClusters {
+		std::shared_ptr<const HeapSnapshot> snapshot;
+		QHash<GraphNode *, QVector<int>>    members;
+	 };
+
+	 QHash<QObject *, GraphClusters> graphs_;
 };
 
 }
@@ -27,6 +27,10 @@ namespace {
 	bool BlockLess(const Result &s1, const Result &s2)    { return s1.block < s2.block; }
 	bool DataGreater(const Result &s1, const Result &s2)  { return s1.data > s2.data; }
 	bool DataLess(const Result &s1, const Result &s2)     { return s1.data < s2.data; }
+	bool DeltaGreater(const Result &s1, const Result &s2) { return s1.delta > s2.delta; }
+	bool DeltaLess(const Result &s1, const Result &s2)    { return s1.delta < s2.delta; }
+	bool ArenaGreater(const Result &s1, const Result &s2) { return s1.arena > s2.arena; }
+	bool ArenaLess(const Result &s1, const Result &s2)    { return s1.arena < s2.arena; }
 	bool SizeGreater(const Result &s1, const Result &s2)  { return s1.size > s2.size; }
 	bool SizeLess(const Result &s1, const Result &s2)     { return s1.size < s2.size; }
 	bool TypeGreater(const Result &s1, const Result &s2)  { return s1.type > s2.type; }
@@ -52,6 +56,8 @@ QVariant ResultViewModel::headerData(int section, Qt::Orientation orientation, i
 		case 1: return tr("Size");
 		case 2: return tr("Type");
 		case 3: return tr("Data");
+		case 4: return tr("Delta");
+		case 5: return tr("Arena");
 		}
 	}
 
@@ -77,6 +83,8 @@ QVariant ResultViewModel::data(const QModelIndex &index, int role) const {
 	case 1:  return edb::v1::format_pointer(result.size);
 	case 2:  return result.type;
 	case 3:  return result.data;
+	case 4:  return result.delta;
+	case 5:  return result.arena;
 	default: return QVariant();
 	}
 }
@@ -122,7 +130,7 @@ QModelIndex ResultViewModel::index(int row, int column, const QModelIndex &paren
 		return QModelIndex();
 	}
 
-	if(column >= 4) {
+	if(column >= 6) {
 		return QModelIndex();
 	}
 
@@ -157,7 +165,7 @@ int ResultViewModel::rowCount(const QModelIndex &parent) const {
 //------------------------------------------------------------------------------
 int ResultViewModel::columnCount(const QModelIndex &parent) const {
 	Q_UNUSED(parent);
-	return 4;
+	return 6;
 }
 
 //------------------------------------------------------------------------------
@@ -172,6 +180,8 @@ void ResultViewModel::sort(int column, Qt::SortOrder order) {
 		case 1: qSort(results_.begin(), results_.end(), SizeLess);  break;
 		case 2: qSort(results_.begin(), results_.end(), TypeLess);  break;
 		case 3: qSort(results_.begin(), results_.end(), DataLess);  break;
+		case 4: qSort(results_.begin(), results_.end(), DeltaLess); break;
+		case 5: qSort(results_.begin(), results_.end(), ArenaLess); break;
 		}
 	} else {
 		switch(column) {
@@ -179,6 +189,8 @@ void ResultViewModel::sort(int column, Qt::SortOrder order) {
 		case 1: qSort(results_.begin(), results_.end(), SizeGreater);  break;
 		case 2: qSort(results_.begin(), results_.end(), TypeGreater);  break;
 		case 3: qSort(results_.begin(), results_.end(), DataGreater);  break;
+		case 4: qSort(results_.begin(), results_.end(), DeltaGreater); break;
+		case 5: qSort(results_.begin(), results_.end(), ArenaGreater); break;
 		}
 	}
 
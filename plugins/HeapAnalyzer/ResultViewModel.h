@@ -36,6 +36,8 @@ struct Result {
 	edb::address_t        size;
 	QString               type;
 	QString               data;
+	QString               delta; // how the block changed since the last search
+	QString               arena; // which malloc arena the block belongs to
 	QList<edb::address_t> points_to;
 };
 
@@ -79,8 +79,17 @@ int FieldWidget::fieldWidth() const {
 	return fieldWidth_;
 }
 
+QModelIndex FieldWidget::modelIndex() const {
+	return index;
+}
+
 void FieldWidget::adjustToData() {
-	QLabel::setText(text());
+	// most fields show the same text from one stop to the next, and only a
+	// new text can change the size, so those are neither relaid out nor redrawn
+	const auto newText = text();
+	if (newText == QLabel::text())
+		return;
+	QLabel::setText(newText);
 	adjustSize();
 }
 
@@ -46,6 +46,7 @@ public:
 	int             lineNumber() const;
 	int             columnNumber() const;
 	int             fieldWidth() const;
+	QModelIndex     modelIndex() const;
 
 public Q_SLOTS:
 	virtual void adjustToData();
@@ -82,6 +82,17 @@ static_assert(registerGroupTypeNames.size() == ODBRegView::RegisterGroupType::NU
 
 const auto SETTINGS_GROUPS_ARRAY_NODE = QLatin1String("visibleGroups");
 
+// whether <index> or one of its parents is among the rows from <topLeft> to <bottomRight>,
+// a bit field or an element of a SIMD register shows its register's value
+bool inRange(QModelIndex index, QModelIndex const &topLeft, QModelIndex const &bottomRight) {
+	const auto parent = topLeft.parent();
+	for (; index.isValid(); index = index.parent()) {
+		if (index.parent() == parent && index.row() >= topLeft.row() && index.row() <= bottomRight.row())
+			return true;
+	}
+	return false;
+}
+
 }
 
 // ------------------------- BitFieldFormatter impl ------------------------------
@@ -592,7 +603,7 @@ void ODBRegView::saveState(QString const &settingsGroup) const {
 void ODBRegView::setModel(RegisterViewModelBase::Model *model) {
 	model_ = model;
 	connect(model, SIGNAL(modelReset()), this, SLOT(modelReset()));
-	connect(model, SIGNAL(dataChanged(QModelIndex const &, QModelIndex const &)), this, SLOT(modelUpdated()));
+	connect(model, SIGNAL(dataChanged(QModelIndex const &, QModelIndex const &)), this, SLOT(modelUpdated(QModelIndex const &, QModelIndex const &)));
 	modelReset();
 }
 
@@ -758,15 +769,47 @@ void ODBRegView::modelReset() {
 	widget()->show();
 }
 
-void ODBRegView::modelUpdated() {
-	Q_FOREACH(const auto field, fields()) {
-		field->adjustToData();
+void ODBRegView::modelUpdated(QModelIndex const &topLeft, QModelIndex const &bottomRight) {
+
+	// nobody would see it, catch up in one go once we're shown
+	if (!isVisible()) {
+		updatePending_ = true;
+		return;
 	}
 
 	Q_FOREACH(const auto group, groups) {
-		if (group) {
-			group->adjustWidth();
+		if (!group)
+			continue;
+
+		// fields can depend on others in their group, like FPU registers on the tag word,
+		// so a group is redone as a whole, but only if something in it changed
+		const auto fields = group->fields();
+		const bool changed = updatePending_ || std::any_of(fields.begin(), fields.end(), [&](FieldWidget *field) {
+			return inRange(field->modelIndex(), topLeft, bottomRight);
+		});
+
+		if (!changed)
+			continue;
+
+		bool resized = false;
+		Q_FOREACH(const auto field, fields) {
+			const auto oldWidth = field->width();
+			field->adjustToData();
+			resized |= field->width() != oldWidth;
 		}
+
+		if (resized)
+			group->adjustWidth();
+	}
+
+	updatePending_ = false;
+}
+
+void ODBRegView::showEvent(QShowEvent *event) {
+	QScrollArea::showEvent(event);
+
+	if (updatePending_ && model_) {
+		modelUpdated(model_->index(0, 0), model_->index(model_->rowCount() - 1, 0));
 	}
 }
 
@@ -103,14 +103,16 @@ private:
 	void        updateFieldsPalette();
 	void keyPressEvent(QKeyEvent *event) override;
 	void mousePressEvent(QMouseEvent *event) override;
+	void showEvent(QShowEvent *event) override;
 
 private:
 	QList<RegisterGroup *> groups;
+	bool                   updatePending_ = false; // data changed while hidden
 
 private Q_SLOTS:
 	void fieldSelected();
 	void modelReset();
-	void modelUpdated();
+	void modelUpdated(QModelIndex const &topLeft, QModelIndex const &bottomRight);
 	void copyAllRegisters();
 	void copyRegisterToClipboard() const;
 	void settingsUpdated();
@@ -154,6 +156,10 @@ private:
 	QPersistentModelIndex tagValueIndex;
 
 	bool groupDigits = false;
+	bool showsEmpty_ = false; // drawn grayed out for an empty tag
+
+protected:
+	bool paletteOutdated() const override;
 
 public:
 	// Will add itself and commentWidget to the group and renew their positions as needed
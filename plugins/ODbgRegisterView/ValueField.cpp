@@ -250,11 +250,20 @@ void ValueField::adjustToData() {
 		setToZeroAction->setVisible(value != 0u);
 	}
 	FieldWidget::adjustToData();
-	updatePalette();
+
+	// a field which was red on the last stop and isn't now has to be redrawn
+	// even if its text stayed the same
+	if (paletteOutdated())
+		updatePalette();
+}
+
+bool ValueField::paletteOutdated() const {
+	return changed() != showsChanged_;
 }
 
 void ValueField::updatePalette() {
-	if (changed()) {
+	showsChanged_ = changed();
+	if (showsChanged_) {
 		auto         palette        = this->palette();
 		const QColor changedFGColor = fgColorForChangedField();
 		palette.setColor(foregroundRole(), changedFGColor);
@@ -318,7 +327,7 @@ void ValueField::paintEvent(QPaintEvent *) {
 #endif
 	option.rect                   = rect();
 	option.showDecorationSelected = true;
-	option.text                   = text();
+	option.text                   = QLabel::text(); // as of the last adjustToData
 	option.font                   = font();
 	option.palette                = palette();
 	option.textElideMode          = Qt::ElideNone;
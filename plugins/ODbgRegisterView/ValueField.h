@@ -41,6 +41,7 @@ private:
 
 protected:
 	QList<QAction *> menuItems;
+	bool             showsChanged_ = false; // drawn in the changed color
 
 private:
 	void   init();
@@ -50,6 +51,7 @@ private:
 protected:
 	RegisterViewModelBase::Model *model() const;
 	bool                          changed() const;
+	virtual bool                  paletteOutdated() const;
 
 	void enterEvent(QEvent *) override;
 	void leaveEvent(QEvent *) override;
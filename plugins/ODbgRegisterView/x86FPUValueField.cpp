@@ -97,8 +97,14 @@ void FPUValueField::displayFormatChanged() {
 	commentWidget->move(x() + maximumWidth(), commentWidget->y());
 }
 
+bool FPUValueField::paletteOutdated() const {
+	return ValueField::paletteOutdated() || (tagValueIndex.data().toUInt() == FPU_TAG_EMPTY) != showsEmpty_;
+}
+
 void FPUValueField::updatePalette() {
-	if (!changed() && tagValueIndex.data().toUInt() == FPU_TAG_EMPTY) {
+	showsEmpty_ = tagValueIndex.data().toUInt() == FPU_TAG_EMPTY;
+	if (!changed() && showsEmpty_) {
+		showsChanged_ = false;
 		auto palette = group()->palette();
 		palette.setColor(foregroundRole(), palette.color(QPalette::Disabled, QPalette::Text));
 		setPalette(palette);
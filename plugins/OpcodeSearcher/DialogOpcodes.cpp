@@ -19,19 +19,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DialogOpcodes.h"
 #include "ByteShiftArray.h"
 #include "IDebugger.h"
-#include "IProcess.h"
 #include "IRegion.h"
 #include "MemoryRegions.h"
-#include "ShiftBuffer.h"
+#include "RegionSearch.h"
+#include "SearchResultView.h"
 #include "Util.h"
 #include "edb.h"
 
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QSortFilterProxyModel>
-#include <QListWidgetItem>
 #include <QDebug>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 #include "ui_DialogOpcodes.h"
 
 namespace OpcodeSearcherPlugin {
@@ -46,6 +49,116 @@ const int STACK_REG = ARM_REG_SP;
 #elif defined EDB_ARM64
 const int STACK_REG = ARM64_REG_SP;
 #endif
+
+// what a byte is when an instruction starts with it, as far as the searches
+// are concerned
+const quint8 OPCODE_PREFIX   = 0x01; // a legacy prefix
+const quint8 OPCODE_REX      = 0x02; // a REX prefix in 64-bit code, inc or dec otherwise
+const quint8 OPCODE_INDIRECT = 0x04; // call, jmp or push through a register or memory
+const quint8 OPCODE_PUSH     = 0x08; // push of a register
+const quint8 OPCODE_POP      = 0x10; // any pop
+const quint8 OPCODE_RET      = 0x20; // near ret
+const quint8 OPCODE_ADD_SUB  = 0x40; // add or sub of an immediate
+
+//------------------------------------------------------------------------------
+// Name: make_opcode_classes
+// Desc:
+//------------------------------------------------------------------------------
+std::array<quint8, 256> make_opcode_classes() {
+	std::array<quint8, 256> classes;
+	classes.fill(0);
+
+	for(const quint8 prefix : { 0x26, 0x2e, 0x36, 0x3e, 0x64, 0x65, 0x66, 0x67, 0xf0, 0xf2, 0xf3 }) {
+		classes[prefix] |= OPCODE_PREFIX;
+	}
+
+	for(int op = 0; op < 8; ++op) {
+		classes[0x40 + op] |= OPCODE_REX;
+		classes[0x48 + op] |= OPCODE_REX;
+		classes[0x50 + op] |= OPCODE_PUSH;
+		classes[0x58 + op] |= OPCODE_POP;
+	}
+
+	// 0x0f for pop fs and pop gs, the others pop segment registers in 32-bit code
+	for(const quint8 op : { 0x07, 0x0f, 0x17, 0x1f, 0x8f }) {
+		classes[op] |= OPCODE_POP;
+	}
+
+	classes[0xc2] |= OPCODE_RET;
+	classes[0xc3] |= OPCODE_RET;
+	classes[0x81] |= OPCODE_ADD_SUB;
+	classes[0x83] |= OPCODE_ADD_SUB;
+	classes[0xff] |= OPCODE_INDIRECT;
+	return classes;
+}
+
+const std::array<quint8, 256> opcode_classes = make_opcode_classes();
+
+//------------------------------------------------------------------------------
+// Name: first_opcodes
+// Desc: the kinds of instruction a match for <classtype> can start with
+//------------------------------------------------------------------------------
+quint8 first_opcodes(int classtype) {
+	if(classtype >= 1 && classtype <= 17) {
+		// call reg, jmp reg or push reg
+		return OPCODE_INDIRECT | OPCODE_PUSH;
+	}
+
+	if(classtype >= 22 && classtype <= 37) {
+		// call [reg] or jmp [reg]
+		return OPCODE_INDIRECT;
+	}
+
+	switch(classtype) {
+	case 18:
+		return OPCODE_INDIRECT | OPCODE_POP | OPCODE_RET;
+	case 19:
+	case 20:
+		return OPCODE_INDIRECT | OPCODE_POP | OPCODE_ADD_SUB;
+	case 21:
+		return OPCODE_INDIRECT | OPCODE_ADD_SUB;
+	default:
+		return 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: lead_opcode
+// Desc: what kind of instruction the one at [p, last) is, past any prefixes.
+//       Only offsets for which this shares a bit with what a search wants
+//       need to be decoded
+//------------------------------------------------------------------------------
+quint8 lead_opcode(const quint8 *p, const quint8 *last, bool is_64bit) {
+	const quint8 prefixes = is_64bit ? (OPCODE_PREFIX | OPCODE_REX) : OPCODE_PREFIX;
+
+	while(p != last && (opcode_classes[*p] & prefixes)) {
+		++p;
+	}
+
+	return p != last ? opcode_classes[*p] : 0;
+}
+
+// the combo box entry which searches for every other entry at once
+const int ALL_CLASSES = -1;
+
+// one of the searches a pass over the memory serves, in the "all" mode the
+// results are labelled with what they were found for
+struct SearchClass {
+	int     classtype;
+	quint8  first;
+	QString label;
+};
+
+//------------------------------------------------------------------------------
+// Name: instruction_pool
+// Desc: where the tests decode their candidates, one per thread of the search.
+//       What they decode is valid until run_tests starts on the next offset
+//------------------------------------------------------------------------------
+edb::InstructionPool &instruction_pool() {
+	thread_local edb::InstructionPool pool;
+	return pool;
+}
+
 }
 
 //------------------------------------------------------------------------------
@@ -74,12 +187,12 @@ DialogOpcodes::~DialogOpcodes() {
 }
 
 //------------------------------------------------------------------------------
-// Name: on_listWidget_itemDoubleClicked
-// Desc: follows the found item in the data view
+// Name: on_listView_doubleClicked
+// Desc: follows the found item in the disassembly view
 //------------------------------------------------------------------------------
-void DialogOpcodes::on_listWidget_itemDoubleClicked(QListWidgetItem *item) {
+void DialogOpcodes::on_listView_doubleClicked(const QModelIndex &index) {
 	bool ok;
-	const edb::address_t addr = item->data(Qt::UserRole).toULongLong(&ok);
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong(&ok);
 	if(ok) {
 		edb::v1::jump_to_address(addr);
 	}
@@ -93,8 +206,11 @@ void DialogOpcodes::showEvent(QShowEvent *) {
 	filter_model_->setFilterKeyColumn(3);
 	filter_model_->setSourceModel(&edb::v1::memory_regions());
 	ui->tableView->setModel(filter_model_);
+	for(int column = MemoryRegions::FirstUsageColumn; column < filter_model_->columnCount(); ++column) {
+		ui->tableView->hideColumn(column);
+	}
 	ui->progressBar->setValue(0);
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 
 
 	ui->comboBox->clear();
@@ -137,6 +253,7 @@ void DialogOpcodes::showEvent(QShowEvent *) {
 		ui->comboBox->addItem("[R13] -> RIP", 35);
 		ui->comboBox->addItem("[R14] -> RIP", 36);
 		ui->comboBox->addItem("[R15] -> RIP", 37);
+		ui->comboBox->addItem(tr("ALL OF THE ABOVE"), ALL_CLASSES);
 	} else {
 		ui->comboBox->addItem("EAX -> EIP", 1);
 		ui->comboBox->addItem("EBX -> EIP", 2);
@@ -159,6 +276,7 @@ void DialogOpcodes::showEvent(QShowEvent *) {
 		ui->comboBox->addItem("[EBP] -> EIP", 26);
 		ui->comboBox->addItem("[ESI] -> EIP", 28);
 		ui->comboBox->addItem("[EDI] -> EIP", 29);
+		ui->comboBox->addItem(tr("ALL OF THE ABOVE"), ALL_CLASSES);
 	}
 #elif defined(EDB_ARM32)
 	// TODO(eteran): implement
@@ -169,28 +287,23 @@ void DialogOpcodes::showEvent(QShowEvent *) {
 
 //------------------------------------------------------------------------------
 // Name: add_result
-// Desc:
+// Desc: the tests run on the thread pool, so the results are collected in
+//       <results> for the view to take over in one go
 //------------------------------------------------------------------------------
-void DialogOpcodes::add_result(const InstructionList &instructions, edb::address_t rva) {
+void DialogOpcodes::add_result(const InstructionList &instructions, edb::address_t rva, QVector<SearchResult> *results) const {
 	if(!instructions.empty()) {
 	
 		auto it = instructions.begin();
 		const edb::Instruction *inst1 = *it++;
 
-		QString instruction_string = QString("%1: %2").arg(
-			edb::v1::format_pointer(rva),
-			QString::fromStdString(edb::v1::formatter().to_string(*inst1)));
-
+		QString instruction_string = edb::v1::formatter().to_qstring(*inst1);
 
 		for(; it != instructions.end(); ++it) {
 			const edb::Instruction *inst = *it;
-			instruction_string.append(QString("; %1").arg(QString::fromStdString(edb::v1::formatter().to_string(*inst))));
+			instruction_string.append(QString("; %1").arg(edb::v1::formatter().to_qstring(*inst)));
 		}
 
-		auto item = new QListWidgetItem(instruction_string);
-
-		item->setData(Qt::UserRole, rva);
-		ui->listWidget->addItem(item);
+		results->push_back(SearchResult{rva, instruction_string, 0, 0});
 	}
 }
 
@@ -199,11 +312,11 @@ void DialogOpcodes::add_result(const InstructionList &instructions, edb::address
 // Desc:
 //------------------------------------------------------------------------------
 template <int REG>
-void DialogOpcodes::test_deref_reg_to_ip(const OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_deref_reg_to_ip(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		
@@ -214,12 +327,12 @@ void DialogOpcodes::test_deref_reg_to_ip(const OpcodeData &data, edb::address_t
 				if(op1->mem.disp == 0) {
 
 					if(op1->mem.base == REG && op1->mem.index == X86_REG_INVALID && op1->mem.scale == 1) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 						return;
 					}
 
 					if(op1->mem.index == REG && op1->mem.base == X86_REG_INVALID && op1->mem.scale == 1) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 						return;
 					}
 				}
@@ -234,19 +347,19 @@ void DialogOpcodes::test_deref_reg_to_ip(const OpcodeData &data, edb::address_t
 // Desc:
 //------------------------------------------------------------------------------
 template <int REG>
-void DialogOpcodes::test_reg_to_ip(const DialogOpcodes::OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_reg_to_ip(const DialogOpcodes::OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		if(is_call(inst) || is_jump(inst)) {
 			const auto op1 = inst[0];
 			if(is_register(op1)) {
 				if(op1->reg == REG) {
-					add_result({ &inst }, start_address);
+					add_result({ &inst }, start_address, results);
 					return;
 				}
 			}
@@ -258,12 +371,12 @@ void DialogOpcodes::test_reg_to_ip(const DialogOpcodes::OpcodeData &data, edb::a
 					if(op1->reg == REG) {
 
 						p += inst.byte_size();
-						edb::Instruction inst2(p, last, 0);
+						const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 						if(inst2) {
 							const auto op2 = inst2[0];
 
 							if(is_ret(inst2)) {
-								add_result({ &inst, &inst2 }, start_address);
+								add_result({ &inst, &inst2 }, start_address, results);
 							} else {
 								switch(inst2.operation()) {
 								case X86_INS_JMP:
@@ -274,12 +387,12 @@ void DialogOpcodes::test_reg_to_ip(const DialogOpcodes::OpcodeData &data, edb::a
 										if(op2->mem.disp == 0) {
 
 											if(op2->mem.base == STACK_REG && op2->mem.index == X86_REG_INVALID) {
-												add_result({ &inst, &inst2 }, start_address);
+												add_result({ &inst, &inst2 }, start_address, results);
 												return;
 											}
 
 											if(op2->mem.index == STACK_REG && op2->mem.base == X86_REG_INVALID) {
-												add_result({ &inst, &inst2 }, start_address);
+												add_result({ &inst, &inst2 }, start_address, results);
 												return;
 											}
 										}
@@ -304,29 +417,29 @@ void DialogOpcodes::test_reg_to_ip(const DialogOpcodes::OpcodeData &data, edb::a
 // Name: test_esp_add_0
 // Desc:
 //------------------------------------------------------------------------------
-void DialogOpcodes::test_esp_add_0(const OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_esp_add_0(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		const auto op1 = inst[0];
 		if(is_ret(inst)) {
-			add_result({ &inst }, start_address);
+			add_result({ &inst }, start_address, results);
 		} else if(is_call(inst) || is_jump(inst)) {
 				if(is_expression(op1)) {
 
 					if(op1->mem.disp == 0) {
 
 						if(op1->mem.base == STACK_REG && op1->mem.index == X86_REG_INVALID) {
-							add_result({ &inst }, start_address);
+							add_result({ &inst }, start_address, results);
 							return;
 						}
 
 						if(op1->mem.index == STACK_REG && op1->mem.base == X86_REG_INVALID) {
-							add_result({ &inst }, start_address);
+							add_result({ &inst }, start_address, results);
 							return;
 						}
 					}
@@ -337,7 +450,7 @@ void DialogOpcodes::test_esp_add_0(const OpcodeData &data, edb::address_t start_
 				if(is_register(op1)) {
 
 					p += inst.byte_size();
-					edb::Instruction inst2(p, last, 0);
+					const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 					if(inst2) {
 						const auto op2 = inst2[0];
 						switch(inst2.operation()) {
@@ -347,7 +460,7 @@ void DialogOpcodes::test_esp_add_0(const OpcodeData &data, edb::address_t start_
 							if(is_register(op2)) {
 
 								if(op1->reg == op2->reg) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 							break;
@@ -368,12 +481,12 @@ void DialogOpcodes::test_esp_add_0(const OpcodeData &data, edb::address_t start_
 // Name: test_esp_add_regx1
 // Desc:
 //------------------------------------------------------------------------------
-void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		const auto op1 = inst[0];
@@ -382,9 +495,9 @@ void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t st
 
 					if(op1->mem.disp == 4) {
 						if(op1->mem.base == STACK_REG && op1->mem.index == X86_REG_INVALID) {
-							add_result({ &inst }, start_address);
+							add_result({ &inst }, start_address, results);
 						} else if(op1->mem.base == X86_REG_INVALID && op1->mem.index == STACK_REG && op1->mem.scale == 1) {
-							add_result({ &inst }, start_address);
+							add_result({ &inst }, start_address, results);
 						}
 
 					}
@@ -395,10 +508,10 @@ void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t st
 
 				if(!is_register(op1) || op1->reg != STACK_REG) {
 					p += inst.byte_size();
-					edb::Instruction inst2(p, last, 0);
+					const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 					if(inst2) {
 						if(is_ret(inst2)) {
-							add_result({ &inst, &inst2 }, start_address);
+							add_result({ &inst, &inst2 }, start_address, results);
 						}
 					}
 				}
@@ -411,10 +524,10 @@ void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == -static_cast<int>(sizeof(edb::reg_t))) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -429,10 +542,10 @@ void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == sizeof(edb::reg_t)) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -451,12 +564,12 @@ void DialogOpcodes::test_esp_add_regx1(const OpcodeData &data, edb::address_t st
 // Name: test_esp_add_regx2
 // Desc:
 //------------------------------------------------------------------------------
-void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		const auto op1 = inst[0];
@@ -465,9 +578,9 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 
 				if(op1->mem.disp == (sizeof(edb::reg_t) * 2)) {
 					if(op1->mem.base == STACK_REG && op1->mem.index == X86_REG_INVALID) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 					} else if(op1->mem.base == X86_REG_INVALID && op1->mem.index == STACK_REG && op1->mem.scale == 1) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 					}
 
 				}
@@ -478,7 +591,7 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 
 				if(!is_register(op1) || op1->reg != STACK_REG) {
 					p += inst.byte_size();
-					edb::Instruction inst2(p, last, 0);
+					const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 					if(inst2) {
 						const auto op2 = inst2[0];
 						switch(inst2.operation()) {
@@ -486,10 +599,10 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 
 							if(!is_register(op2) || op2->reg != STACK_REG) {
 								p += inst2.byte_size();
-								edb::Instruction inst3(p, last, 0);
+								const edb::Instruction &inst3 = instruction_pool().decode(p, last, 0);
 								if(inst3) {
 									if(is_ret(inst3)) {
-										add_result({ &inst, &inst2, &inst3 }, start_address);
+										add_result({ &inst, &inst2, &inst3 }, start_address, results);
 									}
 								}
 							}
@@ -508,10 +621,10 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == -static_cast<int>(sizeof(edb::reg_t) * 2)) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -527,10 +640,10 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == (sizeof(edb::reg_t) * 2)) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -549,12 +662,12 @@ void DialogOpcodes::test_esp_add_regx2(const OpcodeData &data, edb::address_t st
 // Name: test_esp_sub_regx1
 // Desc:
 //------------------------------------------------------------------------------
-void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t start_address) {
+void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const {
 
 	const quint8 *p = data.data;
 	const quint8 *last = p + sizeof(data);
 
-	edb::Instruction inst(p, last, 0);
+	const edb::Instruction &inst = instruction_pool().decode(p, last, 0);
 
 	if(inst) {
 		const auto op1 = inst[0];
@@ -563,9 +676,9 @@ void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t st
 
 				if(op1->mem.disp == -static_cast<int>(sizeof(edb::reg_t))) {
 					if(op1->mem.base == STACK_REG && op1->mem.index == X86_REG_INVALID) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 					} else if(op1->mem.base == X86_REG_INVALID && op1->mem.index == STACK_REG && op1->mem.scale == 1) {
-						add_result({ &inst }, start_address);
+						add_result({ &inst }, start_address, results);
 					}
 
 				}
@@ -580,10 +693,10 @@ void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == static_cast<int>(sizeof(edb::reg_t))) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -599,10 +712,10 @@ void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t st
 
 						if(op2->imm == -static_cast<int>(sizeof(edb::reg_t))) {
 							p += inst.byte_size();
-							edb::Instruction inst2(p, last, 0);
+							const edb::Instruction &inst2 = instruction_pool().decode(p, last, 0);
 							if(inst2) {
 								if(is_ret(inst2)) {
-									add_result({ &inst, &inst2 }, start_address);
+									add_result({ &inst, &inst2 }, start_address, results);
 								}
 							}
 						}
@@ -621,99 +734,101 @@ void DialogOpcodes::test_esp_sub_regx1(const OpcodeData &data, edb::address_t st
 // Name:
 // Desc:
 //------------------------------------------------------------------------------
-void DialogOpcodes::run_tests(int classtype, const OpcodeData &opcode, edb::address_t address) {
+void DialogOpcodes::run_tests(int classtype, const OpcodeData &opcode, edb::address_t address, QVector<SearchResult> *results) const {
+
+	instruction_pool().reset();
 
 	switch(classtype) {
 #if defined(EDB_X86)
-	case 1: test_reg_to_ip<X86_REG_EAX>(opcode, address); break;
-	case 2: test_reg_to_ip<X86_REG_EBX>(opcode, address); break;
-	case 3: test_reg_to_ip<X86_REG_ECX>(opcode, address); break;
-	case 4: test_reg_to_ip<X86_REG_EDX>(opcode, address); break;
-	case 5: test_reg_to_ip<X86_REG_EBP>(opcode, address); break;
-	case 6: test_reg_to_ip<X86_REG_ESP>(opcode, address); break;
-	case 7: test_reg_to_ip<X86_REG_ESI>(opcode, address); break;
-	case 8: test_reg_to_ip<X86_REG_EDI>(opcode, address); break;
+	case 1: test_reg_to_ip<X86_REG_EAX>(opcode, address, results); break;
+	case 2: test_reg_to_ip<X86_REG_EBX>(opcode, address, results); break;
+	case 3: test_reg_to_ip<X86_REG_ECX>(opcode, address, results); break;
+	case 4: test_reg_to_ip<X86_REG_EDX>(opcode, address, results); break;
+	case 5: test_reg_to_ip<X86_REG_EBP>(opcode, address, results); break;
+	case 6: test_reg_to_ip<X86_REG_ESP>(opcode, address, results); break;
+	case 7: test_reg_to_ip<X86_REG_ESI>(opcode, address, results); break;
+	case 8: test_reg_to_ip<X86_REG_EDI>(opcode, address, results); break;
 #elif defined(EDB_X86_64)
-	case 1: test_reg_to_ip<X86_REG_RAX>(opcode, address); break;
-	case 2: test_reg_to_ip<X86_REG_RBX>(opcode, address); break;
-	case 3: test_reg_to_ip<X86_REG_RCX>(opcode, address); break;
-	case 4: test_reg_to_ip<X86_REG_RDX>(opcode, address); break;
-	case 5: test_reg_to_ip<X86_REG_RBP>(opcode, address); break;
-	case 6: test_reg_to_ip<X86_REG_RSP>(opcode, address); break;
-	case 7: test_reg_to_ip<X86_REG_RSI>(opcode, address); break;
-	case 8: test_reg_to_ip<X86_REG_RDI>(opcode, address); break;
-	case 9: test_reg_to_ip<X86_REG_R8>(opcode, address); break;
-	case 10: test_reg_to_ip<X86_REG_R9>(opcode, address); break;
-	case 11: test_reg_to_ip<X86_REG_R10>(opcode, address); break;
-	case 12: test_reg_to_ip<X86_REG_R11>(opcode, address); break;
-	case 13: test_reg_to_ip<X86_REG_R12>(opcode, address); break;
-	case 14: test_reg_to_ip<X86_REG_R13>(opcode, address); break;
-	case 15: test_reg_to_ip<X86_REG_R14>(opcode, address); break;
-	case 16: test_reg_to_ip<X86_REG_R15>(opcode, address); break;
+	case 1: test_reg_to_ip<X86_REG_RAX>(opcode, address, results); break;
+	case 2: test_reg_to_ip<X86_REG_RBX>(opcode, address, results); break;
+	case 3: test_reg_to_ip<X86_REG_RCX>(opcode, address, results); break;
+	case 4: test_reg_to_ip<X86_REG_RDX>(opcode, address, results); break;
+	case 5: test_reg_to_ip<X86_REG_RBP>(opcode, address, results); break;
+	case 6: test_reg_to_ip<X86_REG_RSP>(opcode, address, results); break;
+	case 7: test_reg_to_ip<X86_REG_RSI>(opcode, address, results); break;
+	case 8: test_reg_to_ip<X86_REG_RDI>(opcode, address, results); break;
+	case 9: test_reg_to_ip<X86_REG_R8>(opcode, address, results); break;
+	case 10: test_reg_to_ip<X86_REG_R9>(opcode, address, results); break;
+	case 11: test_reg_to_ip<X86_REG_R10>(opcode, address, results); break;
+	case 12: test_reg_to_ip<X86_REG_R11>(opcode, address, results); break;
+	case 13: test_reg_to_ip<X86_REG_R12>(opcode, address, results); break;
+	case 14: test_reg_to_ip<X86_REG_R13>(opcode, address, results); break;
+	case 15: test_reg_to_ip<X86_REG_R14>(opcode, address, results); break;
+	case 16: test_reg_to_ip<X86_REG_R15>(opcode, address, results); break;
 #endif
 
 	case 17:
 	#if defined(EDB_X86)
-		test_reg_to_ip<X86_REG_EAX>(opcode, address);
-		test_reg_to_ip<X86_REG_EBX>(opcode, address);
-		test_reg_to_ip<X86_REG_ECX>(opcode, address);
-		test_reg_to_ip<X86_REG_EDX>(opcode, address);
-		test_reg_to_ip<X86_REG_EBP>(opcode, address);
-		test_reg_to_ip<X86_REG_ESP>(opcode, address);
-		test_reg_to_ip<X86_REG_ESI>(opcode, address);
-		test_reg_to_ip<X86_REG_EDI>(opcode, address);
+		test_reg_to_ip<X86_REG_EAX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_EBX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_ECX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_EDX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_EBP>(opcode, address, results);
+		test_reg_to_ip<X86_REG_ESP>(opcode, address, results);
+		test_reg_to_ip<X86_REG_ESI>(opcode, address, results);
+		test_reg_to_ip<X86_REG_EDI>(opcode, address, results);
 	#elif defined(EDB_X86_64)
-		test_reg_to_ip<X86_REG_RAX>(opcode, address);
-		test_reg_to_ip<X86_REG_RBX>(opcode, address);
-		test_reg_to_ip<X86_REG_RCX>(opcode, address);
-		test_reg_to_ip<X86_REG_RDX>(opcode, address);
-		test_reg_to_ip<X86_REG_RBP>(opcode, address);
-		test_reg_to_ip<X86_REG_RSP>(opcode, address);
-		test_reg_to_ip<X86_REG_RSI>(opcode, address);
-		test_reg_to_ip<X86_REG_RDI>(opcode, address);
-		test_reg_to_ip<X86_REG_R8>(opcode, address);
-		test_reg_to_ip<X86_REG_R9>(opcode, address);
-		test_reg_to_ip<X86_REG_R10>(opcode, address);
-		test_reg_to_ip<X86_REG_R11>(opcode, address);
-		test_reg_to_ip<X86_REG_R12>(opcode, address);
-		test_reg_to_ip<X86_REG_R13>(opcode, address);
-		test_reg_to_ip<X86_REG_R14>(opcode, address);
-		test_reg_to_ip<X86_REG_R15>(opcode, address);
+		test_reg_to_ip<X86_REG_RAX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RBX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RCX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RDX>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RBP>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RSP>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RSI>(opcode, address, results);
+		test_reg_to_ip<X86_REG_RDI>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R8>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R9>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R10>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R11>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R12>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R13>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R14>(opcode, address, results);
+		test_reg_to_ip<X86_REG_R15>(opcode, address, results);
 	#endif
 		break;
 	case 18:
 		// [ESP] -> EIP
-		test_esp_add_0(opcode, address);
+		test_esp_add_0(opcode, address, results);
 		break;
 	case 19:
 		// [ESP + 4] -> EIP
-		test_esp_add_regx1(opcode, address);
+		test_esp_add_regx1(opcode, address, results);
 		break;
 	case 20:
 		// [ESP + 8] -> EIP
-		test_esp_add_regx2(opcode, address);
+		test_esp_add_regx2(opcode, address, results);
 		break;
 	case 21:
 		// [ESP - 4] -> EIP
-		test_esp_sub_regx1(opcode, address);
+		test_esp_sub_regx1(opcode, address, results);
 		break;
 
 
-	case 22: test_deref_reg_to_ip<X86_REG_RAX>(opcode, address); break;
-	case 23: test_deref_reg_to_ip<X86_REG_RBX>(opcode, address); break;
-	case 24: test_deref_reg_to_ip<X86_REG_RCX>(opcode, address); break;
-	case 25: test_deref_reg_to_ip<X86_REG_RDX>(opcode, address); break;
-	case 26: test_deref_reg_to_ip<X86_REG_RBP>(opcode, address); break;
-	case 28: test_deref_reg_to_ip<X86_REG_RSI>(opcode, address); break;
-	case 29: test_deref_reg_to_ip<X86_REG_RDI>(opcode, address); break;
-	case 30: test_deref_reg_to_ip<X86_REG_R8>(opcode, address); break;
-	case 31: test_deref_reg_to_ip<X86_REG_R9>(opcode, address); break;
-	case 32: test_deref_reg_to_ip<X86_REG_R10>(opcode, address); break;
-	case 33: test_deref_reg_to_ip<X86_REG_R11>(opcode, address); break;
-	case 34: test_deref_reg_to_ip<X86_REG_R12>(opcode, address); break;
-	case 35: test_deref_reg_to_ip<X86_REG_R13>(opcode, address); break;
-	case 36: test_deref_reg_to_ip<X86_REG_R14>(opcode, address); break;
-	case 37: test_deref_reg_to_ip<X86_REG_R15>(opcode, address); break;
+	case 22: test_deref_reg_to_ip<X86_REG_RAX>(opcode, address, results); break;
+	case 23: test_deref_reg_to_ip<X86_REG_RBX>(opcode, address, results); break;
+	case 24: test_deref_reg_to_ip<X86_REG_RCX>(opcode, address, results); break;
+	case 25: test_deref_reg_to_ip<X86_REG_RDX>(opcode, address, results); break;
+	case 26: test_deref_reg_to_ip<X86_REG_RBP>(opcode, address, results); break;
+	case 28: test_deref_reg_to_ip<X86_REG_RSI>(opcode, address, results); break;
+	case 29: test_deref_reg_to_ip<X86_REG_RDI>(opcode, address, results); break;
+	case 30: test_deref_reg_to_ip<X86_REG_R8>(opcode, address, results); break;
+	case 31: test_deref_reg_to_ip<X86_REG_R9>(opcode, address, results); break;
+	case 32: test_deref_reg_to_ip<X86_REG_R10>(opcode, address, results); break;
+	case 33: test_deref_reg_to_ip<X86_REG_R11>(opcode, address, results); break;
+	case 34: test_deref_reg_to_ip<X86_REG_R12>(opcode, address, results); break;
+	case 35: test_deref_reg_to_ip<X86_REG_R13>(opcode, address, results); break;
+	case 36: test_deref_reg_to_ip<X86_REG_R14>(opcode, address, results); break;
+	case 37: test_deref_reg_to_ip<X86_REG_R15>(opcode, address, results); break;
 	}
 }
 
@@ -735,60 +850,85 @@ void DialogOpcodes::do_find() {
 			tr("You must select a region which is to be scanned for the desired opcode."));
 	} else {
 
-		if(IProcess *process = edb::v1::debugger_core->process()) {
-			for(const QModelIndex &selected_item: sel) {
+		// in the "all" mode each offset is classified once and then only
+		// tested for the searches which can start with what is there. "ANY
+		// REGISTER" would only repeat the single register searches
+		QVector<SearchClass> classes;
+		if(classtype == ALL_CLASSES) {
+			for(int i = 0; i < ui->comboBox->count(); ++i) {
+				const int type = ui->comboBox->itemData(i).toInt();
+				if(type != ALL_CLASSES && type != 17) {
+					classes.push_back(SearchClass{type, first_opcodes(type), ui->comboBox->itemText(i)});
+				}
+			}
+		} else {
+			classes.push_back(SearchClass{classtype, first_opcodes(classtype), QString()});
+		}
 
-				const QModelIndex index = filter_model_->mapToSource(selected_item);
+		quint8 wanted = 0;
+		for(const SearchClass &c : classes) {
+			wanted |= c.first;
+		}
 
-				if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
+		const bool is_64bit = edb::v1::debuggeeIs64Bit();
+
+		// every offset is tested with the sizeof(OpcodeData) bytes from it, so
+		// the windows overlap by one less than that. The last few offsets of a
+		// window are tested in the next one, unless nothing follows it, then
+		// they are tested here with 0's shifted in and we hope it doesn't give
+		// false positives. Offsets which can't start a match, most of them,
+		// are passed over without decoding anything
+		const RegionSearch search([this, classes, wanted, is_64bit](const RegionSearch::Window &window) {
+			QVector<SearchResult> results;
+
+			const quint8 *const data = window.data.constData();
+			const std::size_t size   = window.data.size();
+			const std::size_t tail   = window.continued ? std::min(size, sizeof(OpcodeData) - 1) : 0;
+
+			for(std::size_t i = 0; i < size - tail; ++i) {
+				const std::size_t n = std::min(sizeof(OpcodeData), size - i);
+				const quint8 lead   = lead_opcode(data + i, data + i + n, is_64bit);
+				if(!(lead & wanted)) {
+					continue;
+				}
 
-					edb::address_t start_address     = region->start();
-					edb::address_t address           = region->start();
-					const edb::address_t end_address = region->end();
-					const edb::address_t orig_start  = region->start();
+				OpcodeData opcode;
+				opcode.qword = 0;
+				std::memcpy(opcode.data, data + i, n);
 
-					ShiftBuffer<sizeof(OpcodeData)> shift_buffer;
+				for(const SearchClass &c : classes) {
+					if(!(lead & c.first)) {
+						continue;
+					}
 
-					// this will read the rest of the region
-					size_t i = 0;
-					while(start_address < end_address) {
+					const int first_result = results.size();
+					run_tests(c.classtype, opcode, window.address + i, &results);
 
-						// create a reference to the bsa's data so we can pass it to the testXXXX functions
-						// but only do so if we have read enough bytes to fill our shift buffer
-						if(i >= shift_buffer.size()) {
-							auto opcode = *reinterpret_cast<const OpcodeData *>(&shift_buffer[0]);
-							run_tests(classtype, opcode, address - shift_buffer.size());
+					for(int r = first_result; r < results.size(); ++r) {
+						results[r].tag = c.classtype;
+						if(!c.label.isEmpty()) {
+							results[r].text = QString("%1: %2").arg(c.label, results[r].text);
 						}
-
-						quint8 byte;
-						process->read_bytes(start_address, &byte, 1);
-						shift_buffer.shl();
-						shift_buffer[shift_buffer.size() - 1] = byte;
-
-						++start_address;
-
-						ui->progressBar->setValue(util::percentage(address - orig_start, region->size()));
-						++address;
-						++i;
 					}
+				}
+			}
 
-					// test the stuff at the regions edge
-					for(size_t i = 0; i < shift_buffer.size(); ++i) {
-
-						// create a reference to the bsa's data so we can pass it to the testXXXX functions
-						auto opcode = *reinterpret_cast<const OpcodeData *>(&shift_buffer[0]);
-						run_tests(classtype, opcode, address - shift_buffer.size());
-
-						// we just shift in 0's and hope it doesn't give false positives
-						shift_buffer.shl();
-						shift_buffer[shift_buffer.size() - 1] = 0x00;
+			return results;
+		}, sizeof(OpcodeData) - 1);
 
-						ui->progressBar->setValue(util::percentage(address - orig_start, region->size()));
-						++address;
-					}
-				}
+		QList<std::shared_ptr<IRegion>> regions;
+		for(const QModelIndex &selected_item: sel) {
+			const QModelIndex index = filter_model_->mapToSource(selected_item);
+			if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
+				regions.push_back(region);
 			}
 		}
+
+		search.run(regions, [this](const QVector<SearchResult> &results) {
+			ui->listView->results()->append(results);
+		}, [this](int progress) {
+			ui->progressBar->setValue(progress);
+		});
 	}
 }
 
@@ -798,7 +938,7 @@ void DialogOpcodes::do_find() {
 //------------------------------------------------------------------------------
 void DialogOpcodes::on_btnFind_clicked() {
 	ui->btnFind->setEnabled(false);
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 	ui->progressBar->setValue(0);
 	do_find();
 	ui->progressBar->setValue(100);
@@ -21,13 +21,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Types.h"
 #include "Instruction.h"
+#include "SearchResultModel.h"
 
 #include <QDialog>
 #include <QList>
+#include <QVector>
 #include <vector>
 
 class QSortFilterProxyModel;
-class QListWidgetItem;
+class QModelIndex;
 
 namespace OpcodeSearcherPlugin {
 
@@ -42,10 +44,10 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
-	void on_listWidget_itemDoubleClicked(QListWidgetItem *);
+	void on_listView_doubleClicked(const QModelIndex &index);
 
 private:
-	using InstructionList = std::vector<edb::Instruction *>;
+	using InstructionList = std::vector<const edb::Instruction *>;
 
 private:
 	// we currently only support opcodes sequences up to 8 bytes big
@@ -55,19 +57,19 @@ private:
 		quint8  data[sizeof(quint64)];
 	};
 
-	void test_esp_add_0(const OpcodeData &data, edb::address_t start_address);
-	void test_esp_add_regx1(const OpcodeData &data, edb::address_t start_address);
-	void test_esp_add_regx2(const OpcodeData &data, edb::address_t start_address);
-	void test_esp_sub_regx1(const OpcodeData &data, edb::address_t start_address);
+	void test_esp_add_0(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
+	void test_esp_add_regx1(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
+	void test_esp_add_regx2(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
+	void test_esp_sub_regx1(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
 	void do_find();
-	void add_result(const InstructionList &instructions, edb::address_t rva);
-	void run_tests(int classtype, const OpcodeData &opcode, edb::address_t address);
+	void add_result(const InstructionList &instructions, edb::address_t rva, QVector<SearchResult> *results) const;
+	void run_tests(int classtype, const OpcodeData &opcode, edb::address_t address, QVector<SearchResult> *results) const;
 
 	template <int REG>
-	void test_reg_to_ip(const OpcodeData &data, edb::address_t start_address);
+	void test_reg_to_ip(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
 
 	template <int REG>
-	void test_deref_reg_to_ip(const OpcodeData &data, edb::address_t start_address);
+	void test_deref_reg_to_ip(const OpcodeData &data, edb::address_t start_address, QVector<SearchResult> *results) const;
 
 private:
 	virtual void showEvent(QShowEvent *event);
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DialogProcessProperties.h"
 #include "Configuration.h"
 #include "DialogStrings.h"
+#include "HandlesModel.h"
 #include "IDebugger.h"
 #include "IProcess.h"
 #include "IRegion.h"
@@ -38,6 +39,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStringListModel>
 #include <QUrl>
 
+#include <algorithm>
+
 #if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD)
 #include <link.h>
 #include <arpa/inet.h>
@@ -68,14 +71,15 @@ QString size_to_string(size_t n) {
 
 #if defined(Q_OS_LINUX)
 //------------------------------------------------------------------------------
-// Name: tcp_socket_prcoessor
-// Desc:
+// Name: inet_socket_processor
+// Desc: a line of /proc/net/tcp or /proc/net/udp, split on ':' and ' '
 //------------------------------------------------------------------------------
-bool tcp_socket_prcoessor(QString *symlink, int sock, const QStringList &lst) {
+bool inet_socket_processor(const char *protocol, const QStringList &lst, quint32 *inode, QString *description) {
 
-	Q_ASSERT(symlink);
+	Q_ASSERT(inode);
+	Q_ASSERT(description);
 
-	if(lst.size() >= 13) {
+	if(lst.size() > 13) {
 
 		bool ok;
 		const quint32 local_address = ntohl(lst[1].toUInt(&ok, 16));
@@ -86,20 +90,15 @@ bool tcp_socket_prcoessor(QString *symlink, int sock, const QStringList &lst) {
 				if(ok) {
 					const quint16 remote_port = lst[4].toUInt(&ok, 16);
 					if(ok) {
-						const quint8 state = lst[5].toUInt(&ok, 16);
-						Q_UNUSED(state);
+						*inode = lst[13].toUInt(&ok, 10);
 						if(ok) {
-							const int inode = lst[13].toUInt(&ok, 10);
-							if(ok) {
-								if(inode == sock) {
-									*symlink = QString("TCP: %1:%2 -> %3:%4")
-										.arg(QHostAddress(local_address).toString())
-										.arg(local_port)
-										.arg(QHostAddress(remote_address).toString())
-										.arg(remote_port);
-										return true;
-								}
-							}
+							*description = QString("%1: %2:%3 -> %4:%5")
+								.arg(protocol)
+								.arg(QHostAddress(local_address).toString())
+								.arg(local_port)
+								.arg(QHostAddress(remote_address).toString())
+								.arg(remote_port);
+							return true;
 						}
 					}
 				}
@@ -110,145 +109,85 @@ bool tcp_socket_prcoessor(QString *symlink, int sock, const QStringList &lst) {
 }
 
 //------------------------------------------------------------------------------
-// Name: udp_socket_processor
+// Name: tcp_socket_processor
 // Desc:
 //------------------------------------------------------------------------------
-bool udp_socket_processor(QString *symlink, int sock, const QStringList &lst) {
-
-	Q_ASSERT(symlink);
-
-	if(lst.size() >= 13) {
+bool tcp_socket_processor(const QStringList &lst, quint32 *inode, QString *description) {
+	return inet_socket_processor("TCP", lst, inode, description);
+}
 
-		bool ok;
-		const quint32 local_address = ntohl(lst[1].toUInt(&ok, 16));
-		if(ok) {
-			const quint16 local_port = lst[2].toUInt(&ok, 16);
-			if(ok) {
-				const quint32 remote_address = ntohl(lst[3].toUInt(&ok, 16));
-				if(ok) {
-					const quint16 remote_port = lst[4].toUInt(&ok, 16);
-					if(ok) {
-						const quint8 state = lst[5].toUInt(&ok, 16);
-						Q_UNUSED(state);
-						if(ok) {
-							const int inode = lst[13].toUInt(&ok, 10);
-							if(ok) {
-								if(inode == sock) {
-									*symlink = QString("UDP: %1:%2 -> %3:%4")
-										.arg(QHostAddress(local_address).toString())
-										.arg(local_port)
-										.arg(QHostAddress(remote_address).toString())
-										.arg(remote_port);
-										return true;
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-	return false;
+//------------------------------------------------------------------------------
+// Name: udp_socket_processor
+// Desc:
+//------------------------------------------------------------------------------
+bool udp_socket_processor(const QStringList &lst, quint32 *inode, QString *description) {
+	return inet_socket_processor("UDP", lst, inode, description);
 }
 
 //------------------------------------------------------------------------------
 // Name: unix_socket_processor
 // Desc:
 //------------------------------------------------------------------------------
-bool unix_socket_processor(QString *symlink, int sock, const QStringList &lst) {
+bool unix_socket_processor(const QStringList &lst, quint32 *inode, QString *description) {
 
-	Q_ASSERT(symlink);
+	Q_ASSERT(inode);
+	Q_ASSERT(description);
 
-	if(lst.size() >= 6) {
+	if(lst.size() > 6) {
 		bool ok;
-		const int inode = lst[6].toUInt(&ok, 10);
+		*inode = lst[6].toUInt(&ok, 10);
 		if(ok) {
-			if(inode == sock) {
-				*symlink = QString("UNIX [%1]").arg(lst[0]);
-				return true;
-			}
+			*description = QString("UNIX [%1]").arg(lst[0]);
+			return true;
 		}
 	}
 	return false;
 }
 
 //------------------------------------------------------------------------------
-// Name: process_socket_file
-// Desc:
+// Name: read_socket_table
+// Desc: adds every socket of the /proc/net table <filename> to <sockets>, by
+//       inode. A socket already in there (from an earlier table) is kept
 //------------------------------------------------------------------------------
 template <class F>
-QString process_socket_file(const QString &filename, QString *symlink, int sock, F fp) {
+void read_socket_table(const QString &filename, QHash<quint32, QString> *sockets, F fp) {
 
-	Q_ASSERT(symlink);
+	Q_ASSERT(sockets);
 
 	QFile net(filename);
-	net.open(QIODevice::ReadOnly | QIODevice::Text);
-	if(net.isOpen()) {
-		QTextStream in(&net);
-		QString line;
-
-		// ditch first line, it is just table headings
-		in.readLine();
-
-		// read in the first line we care about
-		line = in.readLine();
+	if(!net.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return;
+	}
 
-		// a null string means end of file (but not an empty string!)
-		while(!line.isNull()) {
+	QTextStream in(&net);
 
-			QString lline(line);
-			const QStringList lst = lline.replace(":", " ").split(" ", QString::SkipEmptyParts);
+	// ditch first line, it is just table headings
+	in.readLine();
 
-			if(fp(symlink, sock, lst)) {
-				break;
-			}
+	// a null string means end of file (but not an empty string!)
+	for(QString line = in.readLine(); !line.isNull(); line = in.readLine()) {
+		const QStringList lst = line.replace(":", " ").split(" ", QString::SkipEmptyParts);
 
-			line = in.readLine();
+		quint32 inode;
+		QString description;
+		if(fp(lst, &inode, &description) && !sockets->contains(inode)) {
+			sockets->insert(inode, description);
 		}
 	}
-	return *symlink;
 }
 
 //------------------------------------------------------------------------------
-// Name: process_socket_tcp
-// Desc:
+// Name: socket_inode
+// Desc: the inode of a "socket:[inode]" link, 0 if it isn't one
 //------------------------------------------------------------------------------
-QString process_socket_tcp(QString *symlink) {
-
-	Q_ASSERT(symlink);
+quint32 socket_inode(const QString &symlink) {
 
-	const QString socket_info(symlink->mid(symlink->indexOf("socket:[")));
-	const int socket_number = socket_info.mid(8).remove("]").toUInt();
-
-	return process_socket_file("/proc/net/tcp", symlink, socket_number, tcp_socket_prcoessor);
-}
-
-//------------------------------------------------------------------------------
-// Name: process_socket_unix
-// Desc:
-//------------------------------------------------------------------------------
-QString process_socket_unix(QString *symlink) {
-
-	Q_ASSERT(symlink);
-
-	const QString socket_info(symlink->mid(symlink->indexOf("socket:[")));
-	const int socket_number = socket_info.mid(8).remove("]").toUInt();
-
-	return process_socket_file("/proc/net/unix", symlink, socket_number, unix_socket_processor);
-}
-
-//------------------------------------------------------------------------------
-// Name: process_socket_udp
-// Desc:
-//------------------------------------------------------------------------------
-QString process_socket_udp(QString *symlink) {
-
-	Q_ASSERT(symlink);
-
-	const QString socket_info(symlink->mid(symlink->indexOf("socket:[")));
-	const int socket_number = socket_info.mid(8).remove("]").toUInt();
+	const int first = symlink.indexOf("socket:[");
+	if(first == -1) {
+		return 0;
+	}
 
-	return process_socket_file("/proc/net/udp", symlink, socket_number, udp_socket_processor);
+	return symlink.mid(first + 8).remove("]").toUInt();
 }
 
 //------------------------------------------------------------------------------
@@ -299,6 +238,13 @@ DialogProcessProperties::DialogProcessProperties(QWidget *parent) : QDialog(pare
 	threads_filter_->setFilterCaseSensitivity(Qt::CaseInsensitive);
 
 	ui->threadTable->setModel(threads_filter_);
+
+	// the proxy sorts on the raw values, the handle number as a number
+	handles_model_  = new HandlesModel(this);
+	handles_filter_ = new QSortFilterProxyModel(this);
+	handles_filter_->setSourceModel(handles_model_);
+	handles_filter_->setSortRole(Qt::UserRole);
+	ui->tableHandles->setModel(handles_filter_);
 }
 
 //------------------------------------------------------------------------------
@@ -454,45 +400,47 @@ void DialogProcessProperties::updateEnvironmentPage(const QString &filter) {
 //------------------------------------------------------------------------------
 void DialogProcessProperties::updateHandles() {
 
-	ui->tableHandles->setSortingEnabled(false);
-	ui->tableHandles->setRowCount(0);
+	QVector<HandlesModel::Item> handles;
+	QHash<quint32, QString>     sockets;
 
 #ifdef Q_OS_LINUX
 	if(IProcess *process = edb::v1::debugger_core->process()) {
 		QDir dir(QString("/proc/%1/fd/").arg(process->pid()));
 		const QFileInfoList entries = dir.entryInfoList(QStringList() << "[0-9]*");
+		handles.reserve(entries.size());
+
 		for(const QFileInfo &info: entries) {
 			if(info.isSymLink()) {
-				QString symlink(info.symLinkTarget());
-				const QString type(file_type(symlink));
-
-				if(type == tr("Socket")) {
-					symlink = process_socket_tcp(&symlink);
-					symlink = process_socket_udp(&symlink);
-					symlink = process_socket_unix(&symlink);
+				HandlesModel::Item handle;
+				handle.fd     = info.fileName().toInt();
+				handle.target = info.symLinkTarget();
+				handle.type   = file_type(handle.target);
+				handle.inode  = 0;
+
+				if(handle.type == tr("Socket")) {
+					handle.inode = socket_inode(handle.target);
 				}
 
-				if(type == tr("Pipe")) {
-					symlink = tr("FIFO");
+				if(handle.type == tr("Pipe")) {
+					handle.target = tr("FIFO");
 				}
 
-				const int row = ui->tableHandles->rowCount();
-				ui->tableHandles->insertRow(row);
-
-
-				auto itemFD = new QTableWidgetItem;
-				itemFD->setData(Qt::DisplayRole, info.fileName().toUInt());
-
-				ui->tableHandles->setItem(row, 0, new QTableWidgetItem(type));
-				ui->tableHandles->setItem(row, 1, itemFD);
-				ui->tableHandles->setItem(row, 2, new QTableWidgetItem(symlink));
+				handles.push_back(handle);
 			}
 		}
+
+		// each table is read once for all of the sockets, rather than once
+		// for each of them, and only if there are any
+		auto is_socket = [](const HandlesModel::Item &handle) { return handle.inode != 0; };
+		if(std::any_of(handles.begin(), handles.end(), is_socket)) {
+			read_socket_table("/proc/net/tcp", &sockets, tcp_socket_processor);
+			read_socket_table("/proc/net/udp", &sockets, udp_socket_processor);
+			read_socket_table("/proc/net/unix", &sockets, unix_socket_processor);
+		}
 	}
 #endif
 
-	ui->tableHandles->setSortingEnabled(true);
-
+	handles_model_->update(handles, sockets);
 }
 
 //------------------------------------------------------------------------------
@@ -586,20 +534,10 @@ void DialogProcessProperties::on_btnRefreshThreads_clicked() {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogProcessProperties::updateThreads() {
-	threads_model_->clear();
-
 	if(IProcess *process = edb::v1::debugger_core->process()) {
-
-		std::shared_ptr<IThread> current = process->current_thread();
-
-		for(std::shared_ptr<IThread> &thread : process->threads()) {
-
-			if(thread == current) {
-				threads_model_->addThread(thread, true);
-			} else {
-				threads_model_->addThread(thread, false);
-			}
-		}
+		threads_model_->update(process->threads(), process->current_thread());
+	} else {
+		threads_model_->clear();
 	}
 }
 
@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace ProcessPropertiesPlugin {
 
+class HandlesModel;
+
 namespace Ui { class DialogProcessProperties; }
 
 class DialogProcessProperties : public QDialog {
@@ -59,6 +61,8 @@ private:
 	Ui::DialogProcessProperties *const ui;
 	ThreadsModel          *threads_model_;
 	QSortFilterProxyModel *threads_filter_;
+	HandlesModel          *handles_model_;
+	QSortFilterProxyModel *handles_filter_;
 };
 
 }
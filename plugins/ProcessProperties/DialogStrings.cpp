@@ -18,25 +18,192 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "DialogStrings.h"
 #include "Configuration.h"
+#include "IDebugger.h"
+#include "IProcess.h"
 #include "IRegion.h"
 #include "MemoryRegions.h"
+#include "RegionScanner.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
 #include "Util.h"
 #include "edb.h"
 
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QSortFilterProxyModel>
+#include <QVector>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
 
 #include "ui_DialogStrings.h"
 
 namespace ProcessPropertiesPlugin {
 
+namespace {
+
+// strings are cut off after this many characters, which take up at most
+// MAX_STRING_BYTES as UTF-16
+const int         MAX_STRING_LENGTH = 256;
+const std::size_t MAX_STRING_BYTES  = MAX_STRING_LENGTH * sizeof(quint16);
+
+//------------------------------------------------------------------------------
+// Name: escaped
+// Desc:
+//------------------------------------------------------------------------------
+QString escaped(QString s) {
+	s.replace("\r", "\\r");
+	s.replace("\n", "\\n");
+	s.replace("\t", "\\t");
+	s.replace("\v", "\\v");
+	s.replace("\"", "\\\"");
+	return s;
+}
+
+enum StringEncoding {
+	ENCODING_ASCII = 0,
+	ENCODING_UTF16 = 1
+};
+
+// what a byte can be part of, as get_ascii_string_at_address and
+// get_utf16_string_at_address see it. UTF-16 characters also need a zero
+// high byte
+enum CharClass {
+	ASCII_CHAR = 0x01,
+	UTF16_CHAR = 0x02
+};
+
+//------------------------------------------------------------------------------
+// Name: make_char_classes
+// Desc:
+//------------------------------------------------------------------------------
+std::array<quint8, 256> make_char_classes() {
+	std::array<quint8, 256> classes;
+	for(int ch = 0; ch < 256; ++ch) {
+		classes[ch] = 0;
+		if(ch < 0x80 && (std::isprint(ch) || std::isspace(ch))) {
+			classes[ch] |= ASCII_CHAR;
+		}
+		if(ch >= 0x20 && ch < 0x80) {
+			classes[ch] |= UTF16_CHAR;
+		}
+	}
+	return classes;
+}
+
+const std::array<quint8, 256> char_classes = make_char_classes();
+
+//------------------------------------------------------------------------------
+// Name: ascii_length
+// Desc: how many ASCII characters there are at [p, last), up to
+//       MAX_STRING_LENGTH of them
+//------------------------------------------------------------------------------
+int ascii_length(const quint8 *p, const quint8 *last) {
+	const quint8 *const end = std::min(last, p + MAX_STRING_LENGTH);
+
+	const quint8 *it = p;
+	while(it != end && (char_classes[*it] & ASCII_CHAR)) {
+		++it;
+	}
+	return it - p;
+}
+
+//------------------------------------------------------------------------------
+// Name: utf16_length
+// Desc: like ascii_length, for ASCII characters encoded as UTF-16
+//------------------------------------------------------------------------------
+int utf16_length(const quint8 *p, const quint8 *last) {
+	int length = 0;
+	while(last - p >= 2 && length < MAX_STRING_LENGTH && p[1] == 0 && (char_classes[p[0]] & UTF16_CHAR)) {
+		p += 2;
+		++length;
+	}
+	return length;
+}
+
+//------------------------------------------------------------------------------
+// Name: string_text
+// Desc: reads a found string back for the rows which are shown, it is never
+//       kept as a QString
+//------------------------------------------------------------------------------
+QString string_text(const SearchResult &result) {
+
+	QByteArray bytes(result.size, '\0');
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process || process->read_bytes(result.address, bytes.data(), bytes.size()) != static_cast<std::size_t>(bytes.size())) {
+		return QObject::tr("[%1] (unreadable)").arg(result.tag == ENCODING_UTF16 ? "UTF16" : "ASCII");
+	}
+
+	if(result.tag == ENCODING_UTF16) {
+		QString str;
+		for(int i = 0; i + 1 < bytes.size(); i += 2) {
+			str += QChar(static_cast<quint8>(bytes[i]) | (static_cast<quint8>(bytes[i + 1]) << 8));
+		}
+		return QString("[UTF16] %1").arg(escaped(str));
+	}
+
+	return QString("[ASCII] %1").arg(escaped(QString::fromLatin1(bytes)));
+}
+
+//------------------------------------------------------------------------------
+// Name: find_strings
+// Desc: looks for strings at the addresses from <from> up to <limit> of the
+//       <size> bytes at <data>, read from <address>. A string which is found
+//       is skipped over, by its length in characters. Returns the address to
+//       go on from
+//------------------------------------------------------------------------------
+edb::address_t find_strings(const quint8 *data, std::size_t size, edb::address_t address, edb::address_t from, edb::address_t limit, int min_length, bool unicode, QVector<SearchResult> *results) {
+
+	const quint8 *const last = data + size;
+
+	edb::address_t current = from;
+	while(current < limit) {
+		const quint8 *const p = data + (current - address).toUint();
+
+		// nothing can start here
+		const quint8 char_class = char_classes[*p];
+		if(char_class == 0) {
+			++current;
+			continue;
+		}
+
+		const int length = (char_class & ASCII_CHAR) ? ascii_length(p, last) : 0;
+		if(length >= min_length) {
+			results->push_back(SearchResult{current, QString(), ENCODING_ASCII, static_cast<quint32>(length)});
+			current += length;
+			continue;
+		}
+
+		if(unicode && (char_class & UTF16_CHAR)) {
+			const int utf16 = utf16_length(p, last);
+			if(utf16 >= min_length) {
+				results->push_back(SearchResult{current, QString(), ENCODING_UTF16, static_cast<quint32>(utf16 * 2)});
+				current += utf16;
+				continue;
+			}
+		}
+
+		// the rest of a run too short to be a string is shorter still, and
+		// a UTF-16 character can't start where a non zero byte follows, so
+		// only its last character needs to be looked at again
+		current += std::max(length - 1, 1);
+	}
+
+	return current;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: DialogStrings
 // Desc:
 //------------------------------------------------------------------------------
 DialogStrings::DialogStrings(QWidget *parent) : QDialog(parent), ui(new Ui::DialogStrings) {
 	ui->setupUi(this);
+	ui->listView->results()->setTextFunction(string_text);
 	ui->tableView->verticalHeader()->hide();
 #if QT_VERSION >= 0x050000
 	ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
@@ -57,12 +224,12 @@ DialogStrings::~DialogStrings() {
 }
 
 //------------------------------------------------------------------------------
-// Name: on_listWidget_itemDoubleClicked
+// Name: on_listView_doubleClicked
 // Desc: follows the found item in the data view
 //------------------------------------------------------------------------------
-void DialogStrings::on_listWidget_itemDoubleClicked(QListWidgetItem *item) {
+void DialogStrings::on_listView_doubleClicked(const QModelIndex &index) {
 	bool ok;
-	const edb::address_t addr = item->data(Qt::UserRole).toULongLong(&ok);
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong(&ok);
 	if(ok) {
 		edb::v1::dump_data(addr, false);
 	}
@@ -76,24 +243,31 @@ void DialogStrings::showEvent(QShowEvent *) {
 	filter_model_->setFilterKeyColumn(3);
 	filter_model_->setSourceModel(&edb::v1::memory_regions());
 	ui->tableView->setModel(filter_model_);
+	for(int column = MemoryRegions::FirstUsageColumn; column < filter_model_->columnCount(); ++column) {
+		ui->tableView->hideColumn(column);
+	}
 
 	ui->progressBar->setValue(0);
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 }
 
 //------------------------------------------------------------------------------
 // Name: do_find
-// Desc:
+// Desc: the regions are read a window at a time instead of a byte at a time
+//       for every address. Each window is looked through as a whole, which
+//       finds the same strings as get_ascii_string_at_address and
+//       get_utf16_string_at_address would. Only where they are and how long
+//       is kept, the text is read back when it is shown
 //------------------------------------------------------------------------------
 void DialogStrings::do_find() {
 
-	const int min_string_length = edb::v1::config().min_string_length;
+	// an empty string would be found everywhere, without ever moving on
+	const int min_string_length = std::max(1, edb::v1::config().min_string_length);
+	const bool unicode          = ui->search_unicode->isChecked();
 
 	const QItemSelectionModel *const selection_model = ui->tableView->selectionModel();
 	const QModelIndexList sel = selection_model->selectedRows();
 
-	QString str;
-
 	if(sel.size() == 0) {
 		QMessageBox::critical(
 			this,
@@ -101,47 +275,54 @@ void DialogStrings::do_find() {
 			tr("You must select a region which is to be scanned for strings."));
 	}
 
+	int i = 0;
 	for(const QModelIndex &selected_item: sel) {
 
 		const QModelIndex index = filter_model_->mapToSource(selected_item);
 
 		if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
 
-			edb::address_t start_address     = region->start();
-			const edb::address_t end_address = region->end();
-			const edb::address_t orig_start  = start_address;
-
-			// do the search for this region!
-			while(start_address < end_address) {
-
-				int string_length = 0;
-				bool ok = edb::v1::get_ascii_string_at_address(start_address, str, min_string_length, 256, string_length);
-				if(ok) {
-					auto item = new QListWidgetItem(QString("%1: [ASCII] %2").arg(edb::v1::format_pointer(start_address), str));
-					item->setData(Qt::UserRole, start_address);
-					ui->listWidget->addItem(item);
-				} else {
-
-					if(ui->search_unicode->isChecked()) {
-						string_length = 0;
-						ok = edb::v1::get_utf16_string_at_address(start_address, str, min_string_length, 256, string_length);
-						if(ok) {
-							auto item = new QListWidgetItem(QString("%1: [UTF16] %2").arg(edb::v1::format_pointer(start_address), str));
-							item->setData(Qt::UserRole, start_address);
-							ui->listWidget->addItem(item);
-						}
-					}
-				}
+			// an address is only looked at once the whole string which could
+			// start there has been read, so the windows overlap by that much.
+			// The tail of a window is kept until we know whether the next one
+			// goes on from it
+			RegionScanner scanner(region, MAX_STRING_BYTES);
 
-				ui->progressBar->setValue(util::percentage((start_address - orig_start), region->size()));
+			edb::address_t  next = region->start();
+			edb::address_t  tail_address = region->start();
+			QVector<quint8> tail;
 
-				if(ok) {
-					start_address += string_length;
-				} else {
-					++start_address;
+			while(scanner.next()) {
+				QVector<SearchResult> results;
+
+				const edb::address_t tail_end = tail_address + tail.size();
+				if(!tail.isEmpty() && scanner.address() >= tail_end) {
+					next = find_strings(tail.constData(), tail.size(), tail_address, next, tail_end, min_string_length, unicode, &results);
 				}
+
+				next = std::max(next, scanner.address());
+
+				const std::size_t keep = std::min(scanner.size(), MAX_STRING_BYTES);
+				const edb::address_t limit = scanner.address() + (scanner.size() - keep);
+
+				next = find_strings(scanner.data(), scanner.size(), scanner.address(), next, limit, min_string_length, unicode, &results);
+
+				tail_address = limit;
+				tail.resize(keep);
+				std::memcpy(tail.data(), scanner.data() + (scanner.size() - keep), keep);
+
+				ui->listView->results()->append(results);
+				ui->progressBar->setValue(util::percentage(i, sel.size(), scanner.progress(), 100));
+			}
+
+			if(!tail.isEmpty()) {
+				QVector<SearchResult> results;
+				find_strings(tail.constData(), tail.size(), tail_address, next, tail_address + tail.size(), min_string_length, unicode, &results);
+				ui->listView->results()->append(results);
 			}
 		}
+
+		++i;
 	}
 }
 
@@ -151,7 +332,7 @@ void DialogStrings::do_find() {
 //------------------------------------------------------------------------------
 void DialogStrings::on_btnFind_clicked() {
 	ui->btnFind->setEnabled(false);
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 	ui->progressBar->setValue(0);
 	do_find();
 	ui->progressBar->setValue(100);
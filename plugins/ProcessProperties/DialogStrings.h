@@ -23,7 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 
 class QSortFilterProxyModel;
-class QListWidgetItem;
+class QModelIndex;
 
 namespace ProcessPropertiesPlugin {
 
@@ -38,7 +38,7 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
-	void on_listWidget_itemDoubleClicked(QListWidgetItem *);
+	void on_listView_doubleClicked(const QModelIndex &index);
 
 private:
 	virtual void showEvent(QShowEvent *event);
@@ -0,0 +1,140 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HandlesModel.h"
+
+namespace ProcessPropertiesPlugin {
+
+//------------------------------------------------------------------------------
+// Name: HandlesModel
+// Desc:
+//------------------------------------------------------------------------------
+HandlesModel::HandlesModel(QObject *parent) : QAbstractItemModel(parent) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~HandlesModel
+// Desc:
+//------------------------------------------------------------------------------
+HandlesModel::~HandlesModel() {
+}
+
+//------------------------------------------------------------------------------
+// Name: update
+// Desc: replaces all of the handles, they are all read again on a refresh
+//------------------------------------------------------------------------------
+void HandlesModel::update(const QVector<Item> &items, const QHash<quint32, QString> &sockets) {
+	beginResetModel();
+	items_   = items;
+	sockets_ = sockets;
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc: a socket which isn't in any of the tables is shown as its link
+//------------------------------------------------------------------------------
+QString HandlesModel::name(const Item &item) const {
+	if(item.inode != 0) {
+		auto it = sockets_.find(item.inode);
+		if(it != sockets_.end()) {
+			return it.value();
+		}
+	}
+
+	return item.target;
+}
+
+//------------------------------------------------------------------------------
+// Name: data
+// Desc:
+//------------------------------------------------------------------------------
+QVariant HandlesModel::data(const QModelIndex &index, int role) const {
+
+	if(index.isValid() && (role == Qt::DisplayRole || role == Qt::UserRole)) {
+
+		const Item &item = items_[index.row()];
+
+		switch(index.column()) {
+		case 0: return item.type;
+		case 1: return item.fd;
+		case 2: return name(item);
+		}
+	}
+
+	return QVariant();
+}
+
+//------------------------------------------------------------------------------
+// Name: index
+// Desc:
+//------------------------------------------------------------------------------
+QModelIndex HandlesModel::index(int row, int column, const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+
+	if(row >= rowCount(parent) || column >= columnCount(parent)) {
+		return QModelIndex();
+	}
+
+	return createIndex(row, column);
+}
+
+//------------------------------------------------------------------------------
+// Name: parent
+// Desc:
+//------------------------------------------------------------------------------
+QModelIndex HandlesModel::parent(const QModelIndex &index) const {
+	Q_UNUSED(index);
+	return QModelIndex();
+}
+
+//------------------------------------------------------------------------------
+// Name: rowCount
+// Desc:
+//------------------------------------------------------------------------------
+int HandlesModel::rowCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return items_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: columnCount
+// Desc:
+//------------------------------------------------------------------------------
+int HandlesModel::columnCount(const QModelIndex &parent) const {
+	Q_UNUSED(parent);
+	return 3;
+}
+
+//------------------------------------------------------------------------------
+// Name: headerData
+// Desc:
+//------------------------------------------------------------------------------
+QVariant HandlesModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	if(role == Qt::DisplayRole && orientation == Qt::Horizontal) {
+		switch(section) {
+		case 0: return tr("Type");
+		case 1: return tr("Handle");
+		case 2: return tr("Name");
+		}
+	}
+
+	return QVariant();
+}
+
+}
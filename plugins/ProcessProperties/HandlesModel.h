@@ -0,0 +1,67 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HANDLES_MODEL_20171014_H_
+#define HANDLES_MODEL_20171014_H_
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace ProcessPropertiesPlugin {
+
+// The open files of the process. Sockets are only described by a lookup at
+// the time their row is shown, in the tables of sockets read for the update
+class HandlesModel : public QAbstractItemModel {
+	Q_OBJECT
+
+public:
+	struct Item {
+		QString type;
+		int     fd;
+		QString target; // where the fd link points
+		quint32 inode;  // of a socket, 0 otherwise
+	};
+
+public:
+	HandlesModel(QObject *parent = 0);
+	virtual ~HandlesModel();
+
+public:
+	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+	virtual QModelIndex parent(const QModelIndex &index) const;
+	virtual QVariant data(const QModelIndex &index, int role) const;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+
+public:
+	void update(const QVector<Item> &items, const QHash<quint32, QString> &sockets);
+
+private:
+	QString name(const Item &item) const;
+
+private:
+	QVector<Item>           items_;
+	QHash<quint32, QString> sockets_; // description of every socket, by inode
+};
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogProfile.h"
+#include "ProfileReport.h"
+#include "edb.h"
+
+#include <QTableWidgetItem>
+#include <QTreeWidgetItem>
+
+#include <algorithm>
+
+#include "ui_DialogProfile.h"
+
+namespace ProfilerPlugin {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: percent
+// Desc:
+//------------------------------------------------------------------------------
+QString percent(quint64 count, quint64 samples) {
+	return samples ? QString::number(100.0 * count / samples, 'f', 2) : QString();
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DialogProfile
+// Desc: everything is filled in here, the report doesn't change afterwards
+//------------------------------------------------------------------------------
+DialogProfile::DialogProfile(const ProfileReport &report, QWidget *parent) : QDialog(parent), ui(new Ui::DialogProfile) {
+	ui->setupUi(this);
+
+	ui->labelSummary->setText(tr("%1 samples, %2 lost").arg(report.samples()).arg(report.lost()));
+
+	add_functions(report);
+	add_calls(report, 0, nullptr);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogProfile
+// Desc:
+//------------------------------------------------------------------------------
+DialogProfile::~DialogProfile() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: add_functions
+// Desc:
+//------------------------------------------------------------------------------
+void DialogProfile::add_functions(const ProfileReport &report) {
+
+	const QVector<ProfileReport::Function> functions = report.functions();
+
+	ui->tableFunctions->setRowCount(functions.size());
+	for(int row = 0; row < functions.size(); ++row) {
+		const ProfileReport::Function &function = functions[row];
+
+		auto item = new QTableWidgetItem(QString::number(function.self));
+		item->setData(Qt::UserRole, static_cast<qulonglong>(function.address.toUint()));
+		ui->tableFunctions->setItem(row, 0, item);
+		ui->tableFunctions->setItem(row, 1, new QTableWidgetItem(percent(function.self, report.samples())));
+		ui->tableFunctions->setItem(row, 2, new QTableWidgetItem(QString::number(function.total)));
+		ui->tableFunctions->setItem(row, 3, new QTableWidgetItem(percent(function.total, report.samples())));
+		ui->tableFunctions->setItem(row, 4, new QTableWidgetItem(function.address.toPointerString()));
+		ui->tableFunctions->setItem(row, 5, new QTableWidgetItem(function.name));
+	}
+
+	ui->tableFunctions->resizeColumnsToContents();
+}
+
+//------------------------------------------------------------------------------
+// Name: add_calls
+// Desc: the callees of <node> under <parent>, the busiest first, down to the
+//       functions the samples were taken in
+//------------------------------------------------------------------------------
+void DialogProfile::add_calls(const ProfileReport &report, int node, QTreeWidgetItem *parent) {
+
+	const QVector<ProfileReport::CallNode> &nodes = report.nodes();
+
+	QVector<int> children;
+	for(const int child : nodes[node].children) {
+		children.push_back(child);
+	}
+
+	std::sort(children.begin(), children.end(), [&nodes](int lhs, int rhs) {
+		return nodes[lhs].samples > nodes[rhs].samples;
+	});
+
+	for(const int child : children) {
+		const ProfileReport::CallNode &callee = nodes[child];
+
+		auto item = parent ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(ui->treeCalls);
+		item->setText(0, report.name(callee.function));
+		item->setText(1, QString::number(callee.samples));
+		item->setText(2, percent(callee.samples, report.samples()));
+		item->setData(0, Qt::UserRole, static_cast<qulonglong>(callee.function.toUint()));
+
+		add_calls(report, child, item);
+
+		// the paths most of the time was spent on are open to begin with
+		if(callee.samples * 10 >= report.samples()) {
+			item->setExpanded(true);
+		}
+	}
+
+	if(!parent) {
+		ui->treeCalls->resizeColumnToContents(0);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_tableFunctions_itemDoubleClicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogProfile::on_tableFunctions_itemDoubleClicked(QTableWidgetItem *item) {
+	const QTableWidgetItem *const first = ui->tableFunctions->item(item->row(), 0);
+	edb::v1::jump_to_address(edb::address_t::fromZeroExtended(first->data(Qt::UserRole).toULongLong()));
+}
+
+//------------------------------------------------------------------------------
+// Name: on_treeCalls_itemDoubleClicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogProfile::on_treeCalls_itemDoubleClicked(QTreeWidgetItem *item, int column) {
+	Q_UNUSED(column);
+	edb::v1::jump_to_address(edb::address_t::fromZeroExtended(item->data(0, Qt::UserRole).toULongLong()));
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIALOG_PROFILE_20171014_H_
+#define DIALOG_PROFILE_20171014_H_
+
+#include <QDialog>
+
+class QTableWidgetItem;
+class QTreeWidgetItem;
+
+namespace ProfilerPlugin {
+
+class ProfileReport;
+
+namespace Ui { class DialogProfile; }
+
+class DialogProfile : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogProfile(const ProfileReport &report, QWidget *parent = 0);
+	virtual ~DialogProfile() override;
+
+public Q_SLOTS:
+	void on_tableFunctions_itemDoubleClicked(QTableWidgetItem *item);
+	void on_treeCalls_itemDoubleClicked(QTreeWidgetItem *item, int column);
+
+private:
+	void add_functions(const ProfileReport &report);
+	void add_calls(const ProfileReport &report, int node, QTreeWidgetItem *parent);
+
+private:
+	Ui::DialogProfile *const ui;
+};
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ProfileReport.h"
+#include "IAnalyzer.h"
+#include "Profile.h"
+#include "edb.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+namespace ProfilerPlugin {
+
+//------------------------------------------------------------------------------
+// Name: ProfileReport
+// Desc:
+//------------------------------------------------------------------------------
+ProfileReport::ProfileReport(const Profile &profile) : nodes_(1), samples_(profile.samples.size()), lost_(profile.lost) {
+
+	QVector<edb::address_t> stack;
+	QSet<edb::address_t>    seen;
+
+	for(const ProfileSample &sample : profile.samples) {
+
+		// innermost first. A return address is just past its call, the byte
+		// before it is still in the function which made the call
+		stack.clear();
+		stack.push_back(function_of(sample.ip));
+		for(const edb::address_t caller : sample.callers) {
+			stack.push_back(function_of(caller - 1));
+		}
+
+		++functions_[stack.front()].self;
+
+		// a function which recursed is on the stack more than once, but was
+		// only there for one sample
+		seen.clear();
+		for(const edb::address_t function : stack) {
+			if(!seen.contains(function)) {
+				seen.insert(function);
+				++functions_[function].total;
+			}
+		}
+
+		// nodes_ may grow below, so it is walked by index
+		int node = 0;
+		++nodes_[node].samples;
+		for(auto it = stack.rbegin(); it != stack.rend(); ++it) {
+			auto child = nodes_[node].children.find(*it);
+			if(child == nodes_[node].children.end()) {
+				CallNode callee;
+				callee.function = *it;
+				child = nodes_[node].children.insert(*it, nodes_.size());
+				nodes_.push_back(callee);
+			}
+
+			node = *child;
+			++nodes_[node].samples;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: function_of
+// Desc: the start of the function <address> is in, as the analyzer knows it
+//       or guessed from the nearest symbol, otherwise <address> itself
+//------------------------------------------------------------------------------
+edb::address_t ProfileReport::function_of(edb::address_t address) {
+
+	auto it = containing_.find(address);
+	if(it != containing_.end()) {
+		return *it;
+	}
+
+	edb::address_t function = address;
+	bool found = false;
+
+	if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+		if(const Result<edb::address_t> entry = analyzer->find_containing_function(address)) {
+			function = *entry;
+			found    = true;
+		}
+	}
+
+	if(!found) {
+		int offset = 0;
+		if(!edb::v1::find_function_symbol(address, QString(), &offset).isEmpty()) {
+			function = address - offset;
+		}
+	}
+
+	Function &entry = functions_[function];
+	if(entry.name.isEmpty()) {
+		entry.address = function;
+		entry.name    = edb::v1::find_function_symbol(function, function.toPointerString());
+	}
+
+	containing_.insert(address, function);
+	return function;
+}
+
+//------------------------------------------------------------------------------
+// Name: functions
+// Desc: the hottest first
+//------------------------------------------------------------------------------
+QVector<ProfileReport::Function> ProfileReport::functions() const {
+
+	QVector<Function> result;
+	result.reserve(functions_.size());
+	for(const Function &function : functions_) {
+		result.push_back(function);
+	}
+
+	std::sort(result.begin(), result.end(), [](const Function &lhs, const Function &rhs) {
+		if(lhs.self != rhs.self) {
+			return lhs.self > rhs.self;
+		}
+		return lhs.total > rhs.total;
+	});
+
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString ProfileReport::name(edb::address_t function) const {
+	return functions_.value(function).name;
+}
+
+}
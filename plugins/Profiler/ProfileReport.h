@@ -0,0 +1,74 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILE_REPORT_20171014_H_
+#define PROFILE_REPORT_20171014_H_
+
+#include "Types.h"
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+struct Profile;
+
+namespace ProfilerPlugin {
+
+// Folds the samples of a Profile by the function they fell in, once, when
+// profiling stops: how often each function was at the top of the stack
+// (self) and anywhere on it (total), and the tree of the call chains that
+// led there, outermost caller first
+class ProfileReport {
+public:
+	struct Function {
+		edb::address_t address = 0;
+		QString        name;
+		quint64        self    = 0;
+		quint64        total   = 0;
+	};
+
+	struct CallNode {
+		edb::address_t               function = 0;
+		quint64                      samples  = 0;
+		QMap<edb::address_t, int>    children; // function -> index in nodes()
+	};
+
+public:
+	explicit ProfileReport(const Profile &profile);
+
+public:
+	QVector<Function> functions() const;
+	const QVector<CallNode> &nodes() const { return nodes_; } // [0] is the root
+	QString name(edb::address_t function) const;
+	quint64 samples() const                 { return samples_; }
+	quint64 lost() const                    { return lost_; }
+
+private:
+	edb::address_t function_of(edb::address_t address);
+
+private:
+	QHash<edb::address_t, edb::address_t> containing_; // address -> function, looked up once each
+	QHash<edb::address_t, Function>        functions_;
+	QVector<CallNode>                      nodes_;
+	quint64                                samples_ = 0;
+	quint64                                lost_    = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Profiler.h"
+#include "DialogProfile.h"
+#include "IDebugger.h"
+#include "Profile.h"
+#include "ProfileReport.h"
+#include "edb.h"
+
+#include <QInputDialog>
+#include <QMenu>
+#include <QMessageBox>
+
+namespace ProfilerPlugin {
+
+namespace {
+
+// samples a second of CPU time, per thread
+const int DefaultFrequency = 1000;
+const int MaxFrequency     = 100000;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: Profiler
+// Desc:
+//------------------------------------------------------------------------------
+Profiler::Profiler() : menu_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *Profiler::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		menu_ = new QMenu(tr("Profiler"), parent);
+		menu_->addAction(tr("&Start Profiling"), this, SLOT(start_profile()));
+		menu_->addAction(tr("S&top Profiling"), this, SLOT(stop_profile()));
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_profile
+// Desc: the samples are collected while the process runs, nothing is shown
+//       until profiling is stopped
+//------------------------------------------------------------------------------
+void Profiler::start_profile() {
+
+	bool ok;
+	const int frequency = QInputDialog::getInt(
+		edb::v1::debugger_ui,
+		tr("Profiler"),
+		tr("Samples a second of CPU time:"),
+		DefaultFrequency,
+		1,
+		MaxFrequency,
+		100,
+		&ok);
+
+	if(!ok) {
+		return;
+	}
+
+	const bool call_stacks = QMessageBox::question(
+		edb::v1::debugger_ui,
+		tr("Profiler"),
+		tr("Record call stacks too? They are only found for code built with frame pointers."),
+		QMessageBox::Yes | QMessageBox::No,
+		QMessageBox::Yes) == QMessageBox::Yes;
+
+	const Status status = edb::v1::debugger_core->start_profile(frequency, call_stacks);
+	if(!status) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Profiler"), tr("Failed to start profiling: %1").arg(status.toString()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_profile
+// Desc:
+//------------------------------------------------------------------------------
+void Profiler::stop_profile() {
+
+	Profile profile;
+	const Status status = edb::v1::debugger_core->stop_profile(&profile);
+	if(!status) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Profiler"), tr("Failed to stop profiling: %1").arg(status.toString()));
+		return;
+	}
+
+	const ProfileReport report(profile);
+
+	auto dialog = new DialogProfile(report, edb::v1::debugger_ui);
+	dialog->setAttribute(Qt::WA_DeleteOnClose);
+	dialog->show();
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Profiler, Profiler)
+#endif
+
+}
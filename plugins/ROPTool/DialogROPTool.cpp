@@ -17,11 +17,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogROPTool.h"
-#include "ByteShiftArray.h"
+#include "GadgetCache.h"
 #include "IDebugger.h"
 #include "IProcess.h"
 #include "IRegion.h"
 #include "MemoryRegions.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
 #include "Util.h"
 #include "edb.h"
 
@@ -31,6 +33,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QModelIndex>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
+#include <QStringList>
+
+#include <algorithm>
 
 #include "ui_DialogROPTool.h"
 
@@ -38,14 +43,20 @@ namespace ROPToolPlugin {
 
 namespace {
 
+// lent out by an InstructionPool
+using InstructionList = std::vector<const edb::Instruction *>;
+
+// the most bytes a gadget may span
+const std::size_t GADGET_SIZE = 32;
+
 // See issue #457, thanks mrexodia!
-bool isSafe64NopRegOp(const edb::Operand &op) {
+bool isSafe64NopRegOp(const edb::Operand &op, bool is_64bit) {
 
 	if(op->type != X86_OP_REG) {
 		return true; // a non-register is safe
 	}
 
-	if(edb::v1::debuggeeIs64Bit()) {
+	if(is_64bit) {
 		switch(op->reg) {
 		case X86_REG_EAX:
 		case X86_REG_EBX:
@@ -64,7 +75,7 @@ bool isSafe64NopRegOp(const edb::Operand &op) {
 	}
 }
 
-bool is_effective_nop(const edb::Instruction &inst) {
+bool is_effective_nop(const edb::Instruction &inst, bool is_64bit) {
 
 	if(!inst) {
 		return false;
@@ -104,7 +115,7 @@ bool is_effective_nop(const edb::Instruction &inst) {
 	case X86_INS_MOVUPD:
 	case X86_INS_XCHG:
 		// mov edi, edi
-		return inst[0]->type == X86_OP_REG && inst[1]->type == X86_OP_REG && inst[0]->reg == inst[1]->reg && isSafe64NopRegOp(inst[0]);
+		return inst[0]->type == X86_OP_REG && inst[1]->type == X86_OP_REG && inst[0]->reg == inst[1]->reg && isSafe64NopRegOp(inst[0], is_64bit);
 	case X86_INS_LEA:
 	{
 		// lea eax, [eax + 0]
@@ -112,7 +123,7 @@ bool is_effective_nop(const edb::Instruction &inst) {
 		auto mem = inst[1]->mem;
 		return inst[0]->type == X86_OP_REG && inst[1]->type == X86_OP_MEM && mem.disp == 0 &&
 			((mem.index == X86_REG_INVALID && mem.base == reg) ||
-			(mem.index == reg && mem.base == X86_REG_INVALID && mem.scale == 1)) && isSafe64NopRegOp(inst[0]);
+			(mem.index == reg && mem.base == X86_REG_INVALID && mem.scale == 1)) && isSafe64NopRegOp(inst[0], is_64bit);
 	}
 	case X86_INS_JMP:
 	case X86_INS_JA:
@@ -143,124 +154,21 @@ bool is_effective_nop(const edb::Instruction &inst) {
 	case X86_INS_SAR:
 	case X86_INS_SAL:
 		// shl eax, 0
-		return inst[1]->type == X86_OP_IMM && inst[1]->imm == 0 && isSafe64NopRegOp(inst[0]);
+		return inst[1]->type == X86_OP_IMM && inst[1]->imm == 0 && isSafe64NopRegOp(inst[0], is_64bit);
 	case X86_INS_SHLD:
 	case X86_INS_SHRD:
 		// shld eax, ebx, 0
-		return inst[2]->type == X86_OP_IMM && inst[2]->imm == 0 && isSafe64NopRegOp(inst[0]) && isSafe64NopRegOp(inst[1]);
+		return inst[2]->type == X86_OP_IMM && inst[2]->imm == 0 && isSafe64NopRegOp(inst[0], is_64bit) && isSafe64NopRegOp(inst[1], is_64bit);
 	default:
 		return false;
 	}
 }
 
-}
-
-//------------------------------------------------------------------------------
-// Name: DialogROPTool
-// Desc:
-//------------------------------------------------------------------------------
-DialogROPTool::DialogROPTool(QWidget *parent) : QDialog(parent), ui(new Ui::DialogROPTool) {
-	ui->setupUi(this);
-	ui->tableView->verticalHeader()->hide();
-#if QT_VERSION >= 0x050000
-	ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-#else
-	ui->tableView->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
-#endif
-
-	filter_model_ = new QSortFilterProxyModel(this);
-	connect(ui->txtSearch, SIGNAL(textChanged(const QString &)), filter_model_, SLOT(setFilterFixedString(const QString &)));
-
-	result_model_ = new QStandardItemModel(this);
-	result_filter_ = new ResultFilterProxy(this);
-	result_filter_->setSourceModel(result_model_);
-	ui->listView->setModel(result_filter_);
-}
-
 //------------------------------------------------------------------------------
-// Name: ~DialogROPTool
-// Desc:
+// Name: gadget_role
+// Desc: which of the kinds of gadget the filters know <inst1> makes
 //------------------------------------------------------------------------------
-DialogROPTool::~DialogROPTool() {
-	delete ui;
-}
-
-//------------------------------------------------------------------------------
-// Name: on_listView_itemDoubleClicked
-// Desc: follows the found item in the data view
-//------------------------------------------------------------------------------
-void DialogROPTool::on_listView_doubleClicked(const QModelIndex &index) {
-	bool ok;
-	const edb::address_t addr = index.data(Qt::UserRole).toULongLong(&ok);
-	if(ok) {
-		edb::v1::jump_to_address(addr);
-	}
-}
-
-//------------------------------------------------------------------------------
-// Name: showEvent
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::showEvent(QShowEvent *) {
-	filter_model_->setFilterKeyColumn(3);
-	filter_model_->setSourceModel(&edb::v1::memory_regions());
-	ui->tableView->setModel(filter_model_);
-	ui->progressBar->setValue(0);
-
-	result_filter_->set_mask_bit(0x01, ui->chkShowALU->isChecked());
-	result_filter_->set_mask_bit(0x02, ui->chkShowStack->isChecked());
-	result_filter_->set_mask_bit(0x04, ui->chkShowLogic->isChecked());
-	result_filter_->set_mask_bit(0x08, ui->chkShowData->isChecked());
-	result_filter_->set_mask_bit(0x10, ui->chkShowOther->isChecked());
-
-	result_model_->clear();
-}
-
-//------------------------------------------------------------------------------
-// Name: on_chkShowALU_stateChanged
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::on_chkShowALU_stateChanged(int state) {
-	result_filter_->set_mask_bit(0x01, state);
-}
-
-//------------------------------------------------------------------------------
-// Name: on_chkShowStack_stateChanged
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::on_chkShowStack_stateChanged(int state) {
-	result_filter_->set_mask_bit(0x02, state);
-}
-
-//------------------------------------------------------------------------------
-// Name: on_chkShowLogic_stateChanged
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::on_chkShowLogic_stateChanged(int state) {
-	result_filter_->set_mask_bit(0x04, state);
-}
-
-//------------------------------------------------------------------------------
-// Name: on_chkShowData_stateChanged
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::on_chkShowData_stateChanged(int state) {
-	result_filter_->set_mask_bit(0x08, state);
-}
-
-//------------------------------------------------------------------------------
-// Name: on_chkShowOther_stateChanged
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::on_chkShowOther_stateChanged(int state) {
-	result_filter_->set_mask_bit(0x10, state);
-}
-
-//------------------------------------------------------------------------------
-// Name: set_gadget_role
-// Desc:
-//------------------------------------------------------------------------------
-void DialogROPTool::set_gadget_role(QStandardItem *item, const edb::Instruction &inst1) {
+int gadget_role(const edb::Instruction &inst1) {
 
 	switch(inst1.operation()) {
 	case X86_INS_ADD:
@@ -282,8 +190,7 @@ void DialogROPTool::set_gadget_role(QStandardItem *item, const edb::Instruction
 	case X86_INS_AAM:
 	case X86_INS_AAD:
 		// ALU ops
-		item->setData(0x01, Qt::UserRole + 1);
-		break;
+		return 0x01;
 	case X86_INS_PUSH:
 	case X86_INS_PUSHAW:
 	case X86_INS_PUSHAL:
@@ -291,8 +198,7 @@ void DialogROPTool::set_gadget_role(QStandardItem *item, const edb::Instruction
 	case X86_INS_POPAW:
 	case X86_INS_POPAL:
 		// stack ops
-		item->setData(0x02, Qt::UserRole + 1);
-		break;
+		return 0x02;
 	case X86_INS_AND:
 	case X86_INS_OR:
 	case X86_INS_XOR:
@@ -314,8 +220,7 @@ void DialogROPTool::set_gadget_role(QStandardItem *item, const edb::Instruction
 	case X86_INS_BSF:
 	case X86_INS_BSR:
 		// logic ops
-		item->setData(0x04, Qt::UserRole + 1);
-		break;
+		return 0x04;
 	case X86_INS_MOV:
 	case X86_INS_MOVABS:
 	case X86_INS_CMOVA:
@@ -371,53 +276,337 @@ void DialogROPTool::set_gadget_role(QStandardItem *item, const edb::Instruction
 	case X86_INS_CMPXCHG8B:
 	case X86_INS_CMPXCHG16B:
 		// data ops
-		item->setData(0x08, Qt::UserRole + 1);
-		break;
+		return 0x08;
 	default:
 		// other ops
-		item->setData(0x10, Qt::UserRole + 1);
-		break;
+		return 0x10;
+	}
+}
 
+//------------------------------------------------------------------------------
+// Name: may_end_gadget
+// Desc: true if <p> is where the last instruction of a gadget could be: a
+//       ret, an int 0x80, a sysenter, a syscall or a jmp through a register.
+//       Prefixes don't matter, they come before these bytes
+//------------------------------------------------------------------------------
+bool may_end_gadget(const quint8 *p, const quint8 *last) {
+	switch(*p) {
+	case 0xc2:
+	case 0xc3:
+		return true;
+	case 0xcd:
+		return last - p >= 2 && p[1] == 0x80;
+	case 0x0f:
+		return last - p >= 2 && (p[1] == 0x05 || p[1] == 0x34);
+	case 0xff:
+		return last - p >= 2 && (p[1] & 0xf8) == 0xe0;
+	default:
+		return false;
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: add_gadget
+// Name: gadget_text
 // Desc:
 //------------------------------------------------------------------------------
-void DialogROPTool::add_gadget(const InstructionList &instructions) {
+QString gadget_text(const InstructionList &instructions) {
+
+	QStringList instruction_strings;
+	for(const edb::Instruction *inst : instructions) {
+		instruction_strings.push_back(edb::v1::formatter().to_qstring(*inst));
+	}
+
+	return instruction_strings.join("; ");
+}
+
+//------------------------------------------------------------------------------
+// Name: decode_gadget
+// Desc: the instructions of a gadget read from the cache, lent out by <pool>
+//------------------------------------------------------------------------------
+InstructionList decode_gadget(const Gadget &gadget, edb::InstructionPool *pool) {
 
-	if(!instructions.empty()) {
+	InstructionList instruction_list;
 
-		auto it = instructions.begin();
-		auto inst1 = *it++;
+	const quint8 *p       = reinterpret_cast<const quint8 *>(gadget.bytes.constData());
+	const quint8 *const l = p + gadget.bytes.size();
+	edb::address_t rva    = gadget.address;
 
-		QString instruction_string = QString("%1").arg(QString::fromStdString(edb::v1::formatter().to_string(*inst1)));
-		for(; it != instructions.end(); ++it) {
-			auto inst = *it;
-			instruction_string.append(QString("; %1").arg(QString::fromStdString(edb::v1::formatter().to_string(*inst))));
+	while(p < l) {
+		const edb::Instruction &inst = pool->decode(p, l, rva);
+		if(!inst.valid()) {
+			break;
 		}
 
-		if(!ui->checkUnique->isChecked() || !unique_results_.contains(instruction_string)) {
-			unique_results_.insert(instruction_string);
+		instruction_list.push_back(&inst);
+		p   += inst.byte_size();
+		rva += inst.byte_size();
+	}
+
+	return instruction_list;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_gadgets
+// Desc: the gadgets starting in <window>, each no more than GADGET_SIZE
+//       bytes long. Only the offsets with something which could end a gadget
+//       close enough after them are decoded at all
+//------------------------------------------------------------------------------
+QVector<SearchResult> find_gadgets(const RegionSearch::Window &window, bool is_64bit) {
+
+	QVector<SearchResult> results;
+
+	const quint8 *const data = window.data.constData();
+	const std::size_t size   = window.data.size();
+
+	// the last offsets are looked at in the next window, with all the bytes
+	// which may follow them, unless nothing follows this one
+	const std::size_t tail = window.continued ? std::min(size, GADGET_SIZE - 1) : 0;
 
-			// found a gadget
-			auto item = new QStandardItem(QString("%1: %2").arg(edb::v1::format_pointer(inst1->rva()), instruction_string));
+	const quint8 *terminator = data;
 
-			item->setData(static_cast<qulonglong>(inst1->rva()), Qt::UserRole);
+	// nearly every candidate is thrown away, and only the text of the others
+	// is kept, so none of them is worth a place in the decode cache
+	edb::InstructionPool pool;
 
-			// TODO: make this look for 1st non-NOP
-			set_gadget_role(item, *inst1);
+	for(std::size_t offset = 0; offset < size - tail; ++offset) {
 
-			result_model_->insertRow(result_model_->rowCount(), item);
+		const quint8 *const first = data + offset;
+		const quint8 *const l     = data + std::min(size, offset + GADGET_SIZE);
+
+		terminator = std::max(terminator, first);
+		while(terminator < l && !may_end_gadget(terminator, data + size)) {
+			++terminator;
+		}
+
+		if(terminator >= l) {
+			continue;
+		}
+
+		const quint8 *p    = first;
+		edb::address_t rva = window.address + offset;
+
+		pool.reset();
+
+		InstructionList instruction_list;
+
+		auto found = [&](const edb::Instruction &inst) {
+			const quint8 *const end = p + inst.byte_size();
+			results.push_back(SearchResult{window.address + offset, gadget_text(instruction_list), gadget_role(*instruction_list.front()), static_cast<quint32>(end - first)});
+		};
+
+		// eat up any NOPs in front...
+		Q_FOREVER {
+			const edb::Instruction &inst = pool.decode(p, l, rva);
+			if(!is_effective_nop(inst, is_64bit)) {
+				break;
+			}
+
+			instruction_list.push_back(&inst);
+			p   += inst.byte_size();
+			rva += inst.byte_size();
+		}
+
+		const edb::Instruction &inst1 = pool.decode(p, l, rva);
+		if(inst1.valid()) {
+			instruction_list.push_back(&inst1);
+
+			if(is_int(inst1) && is_immediate(inst1.operand(0)) && (inst1.operand(0)->imm & 0xff) == 0x80) {
+				found(inst1);
+			} else if(is_sysenter(inst1)) {
+				found(inst1);
+			} else if(is_syscall(inst1)) {
+				found(inst1);
+			} else if(is_ret(inst1)) {
+				continue;
+			} else {
+
+				p   += inst1.byte_size();
+				rva += inst1.byte_size();
+
+				// eat up any NOPs in between...
+				Q_FOREVER {
+					const edb::Instruction &inst = pool.decode(p, l, rva);
+					if(!is_effective_nop(inst, is_64bit)) {
+						break;
+					}
+
+					instruction_list.push_back(&inst);
+					p   += inst.byte_size();
+					rva += inst.byte_size();
+				}
+
+				const edb::Instruction &inst2 = pool.decode(p, l, rva);
+
+				if(is_ret(inst2)) {
+					instruction_list.push_back(&inst2);
+					found(inst2);
+				} else if(inst2.valid() && inst2.operation() == X86_INS_POP) {
+					instruction_list.push_back(&inst2);
+					p   += inst2.byte_size();
+					rva += inst2.byte_size();
+
+					const edb::Instruction &inst3 = pool.decode(p, l, rva);
+
+					if(inst3.valid() && is_jump(inst3)) {
+
+						instruction_list.push_back(&inst3);
+
+						if(inst2.operand_count() == 1 && is_register(inst2.operand(0))) {
+							if(inst3.operand_count() == 1 && is_register(inst3.operand(0))) {
+								if(inst2.operand(0)->reg == inst3.operand(0)->reg) {
+									found(inst3);
+								}
+							}
+						}
+					}
+				}
+			}
+
+			// TODO(eteran): catch things like "add rsp, 8; jmp [rsp - 8]" and similar, it's rare,
+			// but could happen
 		}
 	}
+
+	return results;
+}
+
 }
 
 //------------------------------------------------------------------------------
-// Name: do_find
+// Name: DialogROPTool
+// Desc:
+//------------------------------------------------------------------------------
+DialogROPTool::DialogROPTool(QWidget *parent) : QDialog(parent), ui(new Ui::DialogROPTool) {
+	ui->setupUi(this);
+	ui->tableView->verticalHeader()->hide();
+#if QT_VERSION >= 0x050000
+	ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+#else
+	ui->tableView->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
+#endif
+
+	filter_model_ = new QSortFilterProxyModel(this);
+	connect(ui->txtSearch, SIGNAL(textChanged(const QString &)), filter_model_, SLOT(setFilterFixedString(const QString &)));
+
+	result_model_ = new QStandardItemModel(this);
+	result_filter_ = new ResultFilterProxy(this);
+	result_filter_->setSourceModel(result_model_);
+	ui->listView->setModel(result_filter_);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogROPTool
+// Desc:
+//------------------------------------------------------------------------------
+DialogROPTool::~DialogROPTool() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_listView_itemDoubleClicked
+// Desc: follows the found item in the data view
+//------------------------------------------------------------------------------
+void DialogROPTool::on_listView_doubleClicked(const QModelIndex &index) {
+	bool ok;
+	const edb::address_t addr = index.data(Qt::UserRole).toULongLong(&ok);
+	if(ok) {
+		edb::v1::jump_to_address(addr);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void DialogROPTool::showEvent(QShowEvent *) {
+	filter_model_->setFilterKeyColumn(3);
+	filter_model_->setSourceModel(&edb::v1::memory_regions());
+	ui->tableView->setModel(filter_model_);
+	for(int column = MemoryRegions::FirstUsageColumn; column < filter_model_->columnCount(); ++column) {
+		ui->tableView->hideColumn(column);
+	}
+	ui->progressBar->setValue(0);
+
+	result_filter_->set_mask_bit(0x01, ui->chkShowALU->isChecked());
+	result_filter_->set_mask_bit(0x02, ui->chkShowStack->isChecked());
+	result_filter_->set_mask_bit(0x04, ui->chkShowLogic->isChecked());
+	result_filter_->set_mask_bit(0x08, ui->chkShowData->isChecked());
+	result_filter_->set_mask_bit(0x10, ui->chkShowOther->isChecked());
+
+	result_model_->clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkShowALU_stateChanged
 // Desc:
 //------------------------------------------------------------------------------
+void DialogROPTool::on_chkShowALU_stateChanged(int state) {
+	result_filter_->set_mask_bit(0x01, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkShowStack_stateChanged
+// Desc:
+//------------------------------------------------------------------------------
+void DialogROPTool::on_chkShowStack_stateChanged(int state) {
+	result_filter_->set_mask_bit(0x02, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkShowLogic_stateChanged
+// Desc:
+//------------------------------------------------------------------------------
+void DialogROPTool::on_chkShowLogic_stateChanged(int state) {
+	result_filter_->set_mask_bit(0x04, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkShowData_stateChanged
+// Desc:
+//------------------------------------------------------------------------------
+void DialogROPTool::on_chkShowData_stateChanged(int state) {
+	result_filter_->set_mask_bit(0x08, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkShowOther_stateChanged
+// Desc:
+//------------------------------------------------------------------------------
+void DialogROPTool::on_chkShowOther_stateChanged(int state) {
+	result_filter_->set_mask_bit(0x10, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: add_gadget
+// Desc: gadgets are the same if their bytes are, whatever they are called
+//------------------------------------------------------------------------------
+void DialogROPTool::add_gadget(const Gadget &gadget, const QString &text) {
+
+	if(ui->checkUnique->isChecked()) {
+		if(unique_results_.contains(gadget.bytes)) {
+			return;
+		}
+
+		unique_results_.insert(gadget.bytes);
+	}
+
+	// found a gadget
+	auto item = new QStandardItem(QString("%1: %2").arg(edb::v1::format_pointer(gadget.address), text));
+
+	item->setData(static_cast<qulonglong>(gadget.address), Qt::UserRole);
+
+	// TODO: make this look for 1st non-NOP
+	item->setData(gadget.role, Qt::UserRole + 1);
+
+	result_model_->insertRow(result_model_->rowCount(), item);
+}
+
+//------------------------------------------------------------------------------
+// Name: do_find
+// Desc: a region whose module has been searched before has its gadgets read
+//       from the cache. The others are read in windows and searched on the
+//       thread pool, the gadgets are added here in address order
+//------------------------------------------------------------------------------
 void DialogROPTool::do_find() {
 
 	const QItemSelectionModel *const selModel = ui->tableView->selectionModel();
@@ -428,116 +617,59 @@ void DialogROPTool::do_find() {
 			this,
 			tr("No Region Selected"),
 			tr("You must select a region which is to be scanned for gadgets."));
-	} else {
+	} else if(IProcess *process = edb::v1::debugger_core->process()) {
 
 		unique_results_.clear();
 
-		if(IProcess *process = edb::v1::debugger_core->process()) {
-			for(const QModelIndex &selected_item: sel) {
-
-				const QModelIndex index = filter_model_->mapToSource(selected_item);
-				if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
-
-					edb::address_t start_address     = region->start();
-					const edb::address_t end_address = region->end();
-					const edb::address_t orig_start  = start_address;
-
-					ByteShiftArray bsa(32);
-
-					while(start_address < end_address) {
-
-						// read in the next byte
-						quint8 byte;
-						if(process->read_bytes(start_address, &byte, 1)) {
-							bsa << byte;
-
-							const quint8       *p = bsa.data();
-							const quint8 *const l = p + bsa.size();
-							edb::address_t    rva = start_address - bsa.size() + 1;
-
-							InstructionList instruction_list;
-
-							// eat up any NOPs in front...
-							Q_FOREVER {
-								auto inst = std::make_shared<edb::Instruction>(p, l, rva);
-								if(!is_effective_nop(*inst)) {
-									break;
-								}
+		QList<std::shared_ptr<IRegion>> regions;
+		for(const QModelIndex &selected_item: sel) {
+			const QModelIndex index = filter_model_->mapToSource(selected_item);
+			if(auto region = *reinterpret_cast<const std::shared_ptr<IRegion> *>(index.internalPointer())) {
+				regions.push_back(region);
+			}
+		}
 
-								instruction_list.push_back(inst);
-								p   += inst->byte_size();
-								rva += inst->byte_size();
-							}
+		const bool is_64bit = edb::v1::debuggeeIs64Bit();
 
+		const RegionSearch search([is_64bit](const RegionSearch::Window &window) {
+			return find_gadgets(window, is_64bit);
+		}, GADGET_SIZE - 1);
 
-							auto inst1 = std::make_shared<edb::Instruction>(p, l, rva);
-							if(inst1->valid()) {
-								instruction_list.push_back(inst1);
-
-								if(is_int(*inst1) && is_immediate(inst1->operand(0)) && (inst1->operand(0)->imm & 0xff) == 0x80) {
-									add_gadget(instruction_list);
-								} else if(is_sysenter(*inst1)) {
-									add_gadget(instruction_list);
-								} else if(is_syscall(*inst1)) {
-									add_gadget(instruction_list);
-								} else if(is_ret(*inst1)) {
-									ui->progressBar->setValue(util::percentage(start_address - orig_start, region->size()));
-									++start_address;
-									continue;
-								} else {
-
-									p   += inst1->byte_size();
-									rva += inst1->byte_size();
-
-									// eat up any NOPs in between...
-									Q_FOREVER {
-										auto inst = std::make_shared<edb::Instruction>(p, l, rva);
-										if(!is_effective_nop(*inst)) {
-											break;
-										}
-
-										instruction_list.push_back(inst);
-										p   += inst->byte_size();
-										rva += inst->byte_size();
-									}
-
-									auto inst2 = std::make_shared<edb::Instruction>(p, l, rva);
-
-									if(is_ret(*inst2)) {
-										instruction_list.push_back(inst2);
-										add_gadget(instruction_list);
-									} else if(inst2->valid() && inst2->operation() == X86_INS_POP) {
-										instruction_list.push_back(inst2);
-										p   += inst2->byte_size();
-										rva += inst2->byte_size();
-
-										auto inst3 = std::make_shared<edb::Instruction>(p, l, rva);
-
-										if(inst3->valid() && is_jump(*inst3)) {
-
-											instruction_list.push_back(inst3);
-
-											if(inst2->operand_count() == 1 && is_register(inst2->operand(0))) {
-												if(inst3->operand_count() == 1 && is_register(inst3->operand(0))) {
-													if(inst2->operand(0)->reg == inst3->operand(0)->reg) {
-														add_gadget(instruction_list);
-													}
-												}
-											}
-										}
-									}
-								}
+		for(int i = 0; i < regions.size(); ++i) {
+			const std::shared_ptr<IRegion> &region = regions[i];
+			const GadgetCache cache(region, is_64bit);
 
-								// TODO(eteran): catch things like "add rsp, 8; jmp [rsp - 8]" and similar, it's rare,
-								// but could happen
-							}
+			QVector<Gadget> gadgets;
+			if(cache.load(&gadgets)) {
+				edb::InstructionPool pool;
+				for(const Gadget &gadget : gadgets) {
+					pool.reset();
+					add_gadget(gadget, gadget_text(decode_gadget(gadget, &pool)));
+				}
+			} else {
+				bool complete = true;
+
+				search.run(region, [&](const QVector<SearchResult> &results) {
+					for(const SearchResult &result : results) {
+						Gadget gadget = { result.address, QByteArray(result.size, '\0'), result.tag };
+						if(process->read_bytes(gadget.address, gadget.bytes.data(), gadget.bytes.size()) != result.size) {
+							complete = false;
+							continue;
 						}
 
-						ui->progressBar->setValue(util::percentage(start_address - orig_start, region->size()));
-						++start_address;
+						gadgets.push_back(gadget);
+						add_gadget(gadget, result.text);
 					}
+				}, [this, i, &regions](int progress) {
+					ui->progressBar->setValue(util::percentage(i, regions.size(), progress, 100));
+				});
+
+				if(complete) {
+					cache.save(gadgets);
 				}
 			}
+
+			ui->progressBar->setValue(util::percentage(i + 1, regions.size(), 0, 100));
 		}
 	}
 }
@@ -23,13 +23,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Instruction.h"
 
 #include <QDialog>
+#include <QByteArray>
 #include <QSet>
 #include <QList>
 #include <QSortFilterProxyModel>
 #include <vector>
 #include <memory>
 
-class QListWidgetItem;
 class QModelIndex;
 class QSortFilterProxyModel;
 class QStandardItem;
@@ -41,6 +41,8 @@ class ResultFilterProxy;
 
 namespace Ui { class DialogROPTool; }
 
+struct Gadget;
+
 class ResultFilterProxy : public QSortFilterProxyModel {
 	Q_OBJECT
 public:
@@ -90,13 +92,9 @@ public Q_SLOTS:
 	void on_chkShowData_stateChanged(int state);
 	void on_chkShowOther_stateChanged(int state);
 
-private:
-	using InstructionList = std::vector<std::shared_ptr<edb::Instruction>>;
-	
 private:
 	void do_find();
-	void add_gadget(const InstructionList &instructions);
-	void set_gadget_role(QStandardItem *item, const edb::Instruction &inst1);
+	void add_gadget(const Gadget &gadget, const QString &text);
 
 private:
 	virtual void showEvent(QShowEvent *event);
@@ -106,7 +104,7 @@ private:
 	QSortFilterProxyModel *  filter_model_;
 	QStandardItemModel *     result_model_;
 	ResultFilterProxy *      result_filter_;
-	QSet<QString>            unique_results_;
+	QSet<QByteArray>         unique_results_;
 };
 
 }
@@ -0,0 +1,199 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "GadgetCache.h"
+#include "IRegion.h"
+#include "edb.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include <cstring>
+
+namespace ROPToolPlugin {
+
+namespace {
+
+// Bump the version whenever the layout changes
+const char    CACHE_MAGIC[8] = { 'E', 'D', 'B', 'R', 'O', 'P', 'G', 'D' };
+const quint32 CACHE_VERSION  = 1;
+
+// each gadget's entry in the index: its offset in the region, how many bytes
+// it has and its role
+const std::size_t ENTRY_SIZE = sizeof(quint32) + sizeof(quint8) + sizeof(quint8);
+
+//------------------------------------------------------------------------------
+// Name: put
+// Desc: appends <value> to a cache file being built
+//------------------------------------------------------------------------------
+template <class T>
+void put(QByteArray &out, T value) {
+	out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+//------------------------------------------------------------------------------
+// Name: get
+// Desc: reads a <T> from <p>, which needn't be aligned for it, and moves past it
+//------------------------------------------------------------------------------
+template <class T>
+T get(const uchar *&p) {
+	T value;
+	std::memcpy(&value, p, sizeof(T));
+	p += sizeof(T);
+	return value;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: GadgetCache
+// Desc: the md5 is that of the module's file, not of the region, so nothing
+//       has to be read from the debuggee to know whether the cache is good
+//------------------------------------------------------------------------------
+GadgetCache::GadgetCache(const std::shared_ptr<IRegion> &region, bool is_64bit) : region_(region), is_64bit_(is_64bit) {
+	path_ = edb::v1::module_cache_path(region, "Gadgets");
+	if(!path_.isEmpty()) {
+		md5_ = edb::v1::get_file_md5(region->name());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: save
+// Desc: writes <gadgets>, which are all in the region, to the cache file
+//------------------------------------------------------------------------------
+void GadgetCache::save(const QVector<Gadget> &gadgets) const {
+
+	if(!isValid()) {
+		return;
+	}
+
+	const edb::address_t start = region_->start();
+
+	QByteArray out;
+	out.append(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	put<quint32>(out, CACHE_VERSION);
+	put<quint32>(out, is_64bit_);
+	out.append(md5_);
+	put<quint64>(out, region_->size().toUint());
+	put<quint32>(out, gadgets.size());
+
+	for(const Gadget &gadget : gadgets) {
+		put<quint32>(out, (gadget.address - start).toUint());
+		put<quint8>(out, gadget.bytes.size());
+		put<quint8>(out, gadget.role);
+	}
+
+	for(const Gadget &gadget : gadgets) {
+		out.append(gadget.bytes);
+	}
+
+	QFile file(path_);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(out) != out.size()) {
+		qDebug("[ROPTool] unable to write the gadget cache %s", qPrintable(path_));
+		file.remove();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: fills in <gadgets> from the cache file, rebased to where the region is
+//       now. Returns false if there is no cache for this version of the module
+//------------------------------------------------------------------------------
+bool GadgetCache::load(QVector<Gadget> *gadgets) const {
+
+	Q_ASSERT(gadgets);
+
+	if(!isValid()) {
+		return false;
+	}
+
+	QFile file(path_);
+	if(!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	const std::size_t HEADER_SIZE = sizeof(CACHE_MAGIC) + sizeof(quint32) + sizeof(quint32) + 16 + sizeof(quint64) + sizeof(quint32);
+
+	const qint64 file_size = file.size();
+	if(file_size < static_cast<qint64>(HEADER_SIZE)) {
+		return false;
+	}
+
+	const uchar *const map = file.map(0, file_size);
+	if(!map) {
+		return false;
+	}
+
+	const uchar *p          = map;
+	const uchar *const last = map + file_size;
+
+	if(std::memcmp(p, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) {
+		return false;
+	}
+	p += sizeof(CACHE_MAGIC);
+
+	if(get<quint32>(p) != CACHE_VERSION || get<quint32>(p) != static_cast<quint32>(is_64bit_)) {
+		return false;
+	}
+
+	if(std::memcmp(p, md5_.constData(), 16) != 0) {
+		return false;
+	}
+	p += 16;
+
+	const quint64 region_size = region_->size().toUint();
+	if(get<quint64>(p) != region_size) {
+		return false;
+	}
+
+	const quint32 count = get<quint32>(p);
+	if(static_cast<std::size_t>(last - p) < count * ENTRY_SIZE) {
+		return false;
+	}
+
+	const uchar *index = p;
+	const uchar *bytes = p + count * ENTRY_SIZE;
+
+	const edb::address_t start = region_->start();
+
+	QVector<Gadget> cached;
+	cached.reserve(count);
+
+	for(quint32 i = 0; i < count; ++i) {
+		const quint32 offset = get<quint32>(index);
+		const quint8  size   = get<quint8>(index);
+		const quint8  role   = get<quint8>(index);
+
+		if(offset + size > region_size || last - bytes < size) {
+			return false;
+		}
+
+		cached.push_back(Gadget{start + offset, QByteArray(reinterpret_cast<const char *>(bytes), size), role});
+		bytes += size;
+	}
+
+	if(bytes != last) {
+		return false;
+	}
+
+	*gadgets = cached;
+	return true;
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef GADGET_CACHE_20170716_H_
+#define GADGET_CACHE_20170716_H_
+
+#include "Types.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class IRegion;
+
+namespace ROPToolPlugin {
+
+struct Gadget {
+	edb::address_t address;
+	QByteArray     bytes;
+	int            role; // the filter bits of the first instruction
+};
+
+// The gadgets of a module's region never change while the module doesn't, so
+// they are kept in a file beside the analysis cache, keyed by the md5 of the
+// module. Offsets are stored relative to the region so the file is good
+// wherever the module is loaded. The file is a fixed size index followed by
+// the bytes of all of the gadgets, and is read straight out of its mapping
+class GadgetCache {
+public:
+	GadgetCache(const std::shared_ptr<IRegion> &region, bool is_64bit);
+
+public:
+	bool isValid() const { return !path_.isEmpty() && md5_.size() == 16; }
+
+public:
+	bool load(QVector<Gadget> *gadgets) const;
+	void save(const QVector<Gadget> &gadgets) const;
+
+private:
+	std::shared_ptr<IRegion> region_;
+	QString                  path_;
+	QByteArray               md5_;
+	bool                     is_64bit_;
+};
+
+}
+
+#endif
@@ -17,22 +17,151 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogReferences.h"
+#include "Function.h"
+#include "IAnalyzer.h"
 #include "IDebugger.h"
 #include "MemoryRegions.h"
+#include "PointerMatcher.h"
+#include "RegionSearch.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
 #include "Util.h"
 #include "edb.h"
 
+#include <QMap>
 #include <QMessageBox>
 #include <QVector>
 
+#include <algorithm>
+#include <cstring>
+
 #include "ui_DialogReferences.h"
 
 namespace ReferencesPlugin {
 
-enum Role {
-	TypeRole    = Qt::UserRole + 0,
-	AddressRole = Qt::UserRole + 1
-};
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: find_references
+// Desc: looks through <window> for pointers into the range of <targets>, and
+//       unless the analysis already covers it, for instructions using them
+//------------------------------------------------------------------------------
+QVector<SearchResult> find_references(const RegionSearch::Window &window, const PointerMatcher &targets, int pointer_size, bool use_analysis) {
+
+	QVector<SearchResult> results;
+
+	const quint8 *const window_start = window.data.constData();
+	const quint8 *const window_end   = window_start + window.data.size();
+
+	// each offset needs up to one full instruction after it, so the tail of
+	// a window is only looked at once we know nothing follows it, otherwise
+	// it is the start of the next window
+	const std::size_t tail = window.continued ? std::min<std::size_t>(window.data.size(), edb::Instruction::MAX_SIZE) : 0;
+	const quint8 *const scan_end = window_end - tail;
+
+	// the pointers starting before scan_end
+	const std::size_t pointer_bytes = std::min<std::size_t>(window.data.size(), (scan_end - window_start) + pointer_size - 1);
+	targets.scan(window.address, window_start, pointer_bytes, [&](std::size_t offset) {
+		results.push_back(SearchResult{window.address + offset, QString(), 'D', static_cast<quint32>(pointer_size)});
+	});
+
+	if(use_analysis) {
+		return results;
+	}
+
+	for(const quint8 *p = window_start; p < scan_end; ++p) {
+
+		const edb::address_t addr = p - window_start + window.address;
+
+		edb::Instruction inst(p, window_end, addr);
+
+		if(inst) {
+			switch(inst.operation()) {
+			case X86_INS_MOV:
+				// instructions of the form: mov [ADDR], 0xNNNNNNNN
+				Q_ASSERT(inst.operand_count() == 2);
+
+				if(is_expression(inst[0])) {
+					if(is_immediate(inst[1]) && targets.contains(static_cast<edb::address_t>(inst[1]->imm))) {
+						results.push_back(SearchResult{addr, QString(), 'C', 0});
+					}
+				}
+
+				break;
+			case X86_INS_PUSH:
+				// instructions of the form: push 0xNNNNNNNN
+				Q_ASSERT(inst.operand_count() == 1);
+
+				if(is_immediate(inst[0]) && targets.contains(static_cast<edb::address_t>(inst[0]->imm))) {
+					results.push_back(SearchResult{addr, QString(), 'C', 0});
+				}
+				break;
+			default:
+				if(is_jump(inst) || is_call(inst)) {
+					if(is_immediate(inst[0])) {
+						if(targets.contains(static_cast<edb::address_t>(inst[0]->imm))) {
+							results.push_back(SearchResult{addr, QString(), 'C', 0});
+						}
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	// the data references come first where both are at one address
+	std::stable_sort(results.begin(), results.end(), [](const SearchResult &a, const SearchResult &b) {
+		return a.address < b.address;
+	});
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: target_range
+// Desc: what to find references to, an address, the range up to another one
+//       or the function containing it
+//------------------------------------------------------------------------------
+bool target_range(QWidget *parent, const QString &text, const QString &last_text, bool whole_function, edb::address_t *first, edb::address_t *last) {
+
+	if(text.isEmpty() || !edb::v1::eval_expression(text, first)) {
+		return false;
+	}
+
+	*last = *first;
+
+	if(whole_function) {
+		IAnalyzer *const analyzer = edb::v1::analyzer();
+		if(analyzer) {
+			if(const Result<edb::address_t> entry = analyzer->find_containing_function(*first)) {
+				const IAnalyzer::FunctionMap functions = analyzer->functions();
+				auto it = functions.find(*entry);
+				if(it != functions.end()) {
+					*first = it->entry_address();
+					*last  = it->end_address();
+					return true;
+				}
+			}
+		}
+
+		QMessageBox::warning(parent, QObject::tr("No Function Found"), QObject::tr("The address is not part of any analyzed function."));
+		return false;
+	}
+
+	if(!last_text.isEmpty()) {
+		if(!edb::v1::eval_expression(last_text, last)) {
+			return false;
+		}
+
+		if(*last < *first) {
+			std::swap(*first, *last);
+		}
+	}
+
+	return true;
+}
+
+}
 
 //------------------------------------------------------------------------------
 // Name: DialogReferences
@@ -56,7 +185,7 @@ DialogReferences::~DialogReferences() {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogReferences::showEvent(QShowEvent *) {
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 	ui->progressBar->setValue(0);
 }
 
@@ -65,105 +194,71 @@ void DialogReferences::showEvent(QShowEvent *) {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogReferences::do_find() {
-	bool ok = false;
-	edb::address_t address;
-	const edb::address_t page_size = edb::v1::debugger_core->page_size();
 
-	const QString text = ui->txtAddress->text();
-	if(!text.isEmpty()) {
-		ok = edb::v1::eval_expression(text, &address);
-	}
+	edb::address_t first;
+	edb::address_t last;
 
+	if(!target_range(this, ui->txtAddress->text(), ui->txtLastAddress->text(), ui->chkFunction->isChecked(), &first, &last)) {
+		return;
+	}
 
-	if(ok) {
-		edb::v1::memory_regions().sync();
-		const QList<std::shared_ptr<IRegion>> regions = edb::v1::memory_regions().regions();
-
-		int i = 0;
-		for(const std::shared_ptr<IRegion> &region: regions) {
-			// a short circut for speading things up
-			if(region->accessible() || !ui->chkSkipNoAccess->isChecked()) {
-
-				const edb::address_t page_count = region->size() / page_size;
-				const QVector<quint8> pages = edb::v1::read_pages(region->start(), page_count);
-
-				if(!pages.isEmpty()) {
-					const quint8 *p = &pages[0];
-					const quint8 *const pages_end = &pages[0] + region->size();
-
-					while(p != pages_end) {
-
-						if(pages_end - p < edb::v1::pointer_size()) {
-							break;
-						}
+	edb::v1::memory_regions().sync();
 
-						const edb::address_t addr = p - &pages[0] + region->start();
+	QList<std::shared_ptr<IRegion>> regions;
+	for(const std::shared_ptr<IRegion> &region: edb::v1::memory_regions().regions()) {
+		// a short circut for speading things up
+		if(region->accessible() || !ui->chkSkipNoAccess->isChecked()) {
+			regions.push_back(region);
+		}
+	}
 
-						edb::address_t test_address(0);
-						memcpy(&test_address, p, edb::v1::pointer_size());
+	// the code of analyzed regions doesn't have to be decoded, the analyzer
+	// already knows what in it refers to what
+	IAnalyzer *const analyzer = ui->chkUseAnalysis->isChecked() ? edb::v1::analyzer() : nullptr;
 
-						if(test_address == address) {
-							auto item = new QListWidgetItem(edb::v1::format_pointer(addr));
-							item->setData(TypeRole, 'D');
-							item->setData(AddressRole, addr);
-							ui->listWidget->addItem(item);
-						}
+	QMap<edb::address_t, edb::address_t> analyzed;
+	if(analyzer) {
+		const QVector<edb::address_t> analyzed_refs = analyzer->references(first, last);
 
-						edb::Instruction inst(p, pages_end, addr);
-
-						if(inst) {
-							switch(inst.operation()) {
-							case X86_INS_MOV:
-								// instructions of the form: mov [ADDR], 0xNNNNNNNN
-								Q_ASSERT(inst.operand_count() == 2);
-
-								if(is_expression(inst[0])) {
-									if(is_immediate(inst[1]) && static_cast<edb::address_t>(inst[1]->imm) == address) {
-										auto item = new QListWidgetItem(edb::v1::format_pointer(addr));
-										item->setData(TypeRole, 'C');
-										item->setData(AddressRole, addr);
-										ui->listWidget->addItem(item);
-									}
-								}
-
-								break;
-							case X86_INS_PUSH:
-								// instructions of the form: push 0xNNNNNNNN
-								Q_ASSERT(inst.operand_count() == 1);
-
-								if(is_immediate(inst[0]) && static_cast<edb::address_t>(inst[0]->imm) == address) {
-									auto item = new QListWidgetItem(edb::v1::format_pointer(addr));
-									item->setData(TypeRole, 'C');
-									item->setData(AddressRole, addr);
-									ui->listWidget->addItem(item);
-								}
-								break;
-							default:
-								if(is_jump(inst) || is_call(inst)) {
-									if(is_immediate(inst[0])) {
-										if(inst[0]->imm == address) {
-											auto item = new QListWidgetItem(edb::v1::format_pointer(addr));
-											item->setData(TypeRole, 'C');
-											item->setData(AddressRole, addr);
-											ui->listWidget->addItem(item);
-										}
-									}
-								}
-								break;
-							}
-						}
+		QVector<SearchResult> results;
+		for(const std::shared_ptr<IRegion> &region: regions) {
+			if(analyzer->analyzed(region)) {
+				analyzed.insert(region->start(), region->end());
 
-						Q_EMIT updateProgress(util::percentage(i, regions.size(), p - &pages[0], region->size()));
-						++p;
+				for(const edb::address_t site : analyzed_refs) {
+					if(region->contains(site)) {
+						results.push_back(SearchResult{site, QString(), 'C', 0});
 					}
 				}
+			}
+		}
 
-			} else {
-				Q_EMIT updateProgress(util::percentage(i, regions.size()));
+		// for a whole function, the functions calling it come from the call
+		// graph, without having to work out which function each site is in
+		if(ui->chkFunction->isChecked()) {
+			for(const edb::address_t caller : analyzer->callers(first)) {
+				results.push_back(SearchResult{caller, tr("calls this function"), 'F', 0});
 			}
-			++i;
 		}
+		ui->listView->results()->append(results);
 	}
+
+	const int pointer_size = edb::v1::pointer_size();
+	const PointerMatcher targets(first, last, pointer_size, ui->chkAligned->isChecked());
+
+	// all the regions go through one search, so the workers are kept busy
+	// from one region into the next
+	const RegionSearch search([targets, pointer_size, analyzed](const RegionSearch::Window &window) {
+		auto it = analyzed.upperBound(window.address);
+		const bool use_analysis = it != analyzed.begin() && window.address < *(--it);
+		return find_references(window, targets, pointer_size, use_analysis);
+	}, edb::Instruction::MAX_SIZE);
+
+	search.run(regions, [this](const QVector<SearchResult> &results) {
+		ui->listView->results()->append(results);
+	}, [this](int progress) {
+		Q_EMIT updateProgress(progress);
+	});
 }
 
 //------------------------------------------------------------------------------
@@ -173,19 +268,19 @@ void DialogReferences::do_find() {
 void DialogReferences::on_btnFind_clicked() {
 	ui->btnFind->setEnabled(false);
 	ui->progressBar->setValue(0);
-	ui->listWidget->clear();
+	ui->listView->results()->clear();
 	do_find();
 	ui->progressBar->setValue(100);
 	ui->btnFind->setEnabled(true);
 }
 
 //------------------------------------------------------------------------------
-// Name: on_listWidget_itemDoubleClicked
+// Name: on_listView_doubleClicked
 // Desc: follows the found item in the data view
 //------------------------------------------------------------------------------
-void DialogReferences::on_listWidget_itemDoubleClicked(QListWidgetItem *item) {
-	const edb::address_t addr = item->data(AddressRole).toULongLong();
-	if(item->data(TypeRole).toChar() == 'D') {
+void DialogReferences::on_listView_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong();
+	if(index.data(SearchResultModel::TagRole).toInt() == 'D') {
 		edb::v1::dump_data(addr, false);
 	} else {
 		edb::v1::jump_to_address(addr);
@@ -23,7 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include "IRegion.h"
 
-class QListWidgetItem;
+class QModelIndex;
 
 namespace ReferencesPlugin {
 
@@ -38,7 +38,7 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
-	void on_listWidget_itemDoubleClicked(QListWidgetItem *item);
+	void on_listView_doubleClicked(const QModelIndex &index);
 
 Q_SIGNALS:
 	void updateProgress(int);
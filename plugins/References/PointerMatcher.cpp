@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "PointerMatcher.h"
+#include "WordScan.h"
+
+#include <QByteArray>
+
+namespace ReferencesPlugin {
+
+//------------------------------------------------------------------------------
+// Name: PointerMatcher
+// Desc:
+//------------------------------------------------------------------------------
+PointerMatcher::PointerMatcher(edb::address_t first, edb::address_t last, int pointer_size, bool aligned) : first_(first), span_(last - first), pointer_size_(pointer_size), aligned_(aligned) {
+
+	Q_ASSERT(first <= last);
+	Q_ASSERT(pointer_size == 4 || pointer_size == 8);
+
+	// every value in the range agrees with first above the highest bit in
+	// which first and last differ
+	const quint64 diff = first.toUint() ^ last.toUint();
+
+	quint64 mask = ~quint64(0);
+	for(quint64 d = diff; d != 0; d >>= 1) {
+		mask <<= 1;
+	}
+
+	const quint64 value = first.toUint();
+
+	QByteArray bytes;
+	QByteArray masks;
+	for(int i = 0; i < pointer_size_; ++i) {
+		bytes.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+		masks.push_back(static_cast<char>((mask >> (i * 8)) & 0xff));
+	}
+
+	prefix_ = BytePattern(bytes, masks);
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: calls <match> for every pointer into the range which lies entirely in
+//       the <size> bytes at <data>, read from <address>
+//------------------------------------------------------------------------------
+void PointerMatcher::scan(edb::address_t address, const quint8 *data, std::size_t size, const MatchFunction &match) const {
+	if(pointer_size_ == 8) {
+		scan_words<quint64>(address, data, size, match);
+	} else {
+		scan_words<quint32>(address, data, size, match);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: scan_words
+// Desc: scan for one size of pointer, so the loops don't check it
+//------------------------------------------------------------------------------
+template <class Word>
+void PointerMatcher::scan_words(edb::address_t address, const quint8 *data, std::size_t size, const MatchFunction &match) const {
+
+	const std::size_t n = sizeof(Word);
+	if(size < n) {
+		return;
+	}
+
+	const quint64 first = first_.toUint();
+	const quint64 span  = span_.toUint();
+
+	if(aligned_) {
+		const std::size_t misalignment = address.toUint() % n;
+		util::for_each_word<Word>(data, size, misalignment ? n - misalignment : 0, [&](std::size_t offset, quint64 value) {
+			if(value - first <= span) {
+				match(offset);
+			}
+		});
+		return;
+	}
+
+	const quint8 *const last = data + size;
+	for(const quint8 *p = data; (p = prefix_.find(p, last)); ++p) {
+		if(util::load_word<Word>(p) - first <= span) {
+			match(p - data);
+		}
+	}
+}
+
+}
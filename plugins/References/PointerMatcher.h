@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef POINTER_MATCHER_20170716_H_
+#define POINTER_MATCHER_20170716_H_
+
+#include "BytePattern.h"
+#include "Types.h"
+#include <cstddef>
+#include <functional>
+
+namespace ReferencesPlugin {
+
+// Finds the pointers in a block of memory whose value lies in [first, last],
+// a single address or a whole function or object at once. The bits which all
+// of those values share make a BytePattern, which skips to the candidates
+// with memchr, and only those are read and compared in full. Aligned
+// pointers are compared a word at a time instead, which the compiler can
+// turn into vector compares
+class PointerMatcher {
+public:
+	// the offset of a match
+	typedef std::function<void(std::size_t)> MatchFunction;
+
+public:
+	PointerMatcher(edb::address_t first, edb::address_t last, int pointer_size, bool aligned);
+
+public:
+	bool contains(edb::address_t value) const { return (value - first_) <= span_; }
+	void scan(edb::address_t address, const quint8 *data, std::size_t size, const MatchFunction &match) const;
+
+private:
+	template <class Word>
+	void scan_words(edb::address_t address, const quint8 *data, std::size_t size, const MatchFunction &match) const;
+
+private:
+	edb::address_t first_;
+	edb::address_t span_; // last - first, so one unsigned compare covers the range
+	int            pointer_size_;
+	bool           aligned_;
+	BytePattern    prefix_;
+};
+
+}
+
+#endif
@@ -0,0 +1,618 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ScriptApi.h"
+#include "Expression.h"
+#include "Function.h"
+#include "IAnalyzer.h"
+#include "IBreakpoint.h"
+#include "IDebugEvent.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "ISymbolManager.h"
+#include "IThread.h"
+#include "MemoryRegions.h"
+#include "ReadRequest.h"
+#include "Register.h"
+#include "State.h"
+#include "Symbol.h"
+#include "WriteRequest.h"
+#include "edb.h"
+
+#include <QElapsedTimer>
+#include <QJSEngine>
+#include <QVector>
+#include <QtDebug>
+
+namespace ScriptingPlugin {
+namespace {
+
+// how long a single wait for a debug event is, between which the timeout
+// is checked
+const int WaitSlice = 10;
+
+//------------------------------------------------------------------------------
+// Name: to_address
+// Desc: numbers are taken as they are, strings are evaluated like anything
+//       typed into the expression dialog ("rsp+8", "main", ...)
+//------------------------------------------------------------------------------
+bool to_address(const QJSValue &value, edb::address_t *address) {
+
+	if(value.isString()) {
+		bool ok;
+		ExpressionError err;
+		*address = edb::v1::evaluate_expression(value.toString(), &ok, &err);
+		return ok;
+	}
+
+	if(value.isNumber()) {
+		*address = edb::address_t::fromZeroExtended(static_cast<quint64>(value.toNumber()));
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: from_address
+// Desc: user space addresses fit in a double without losing anything
+//------------------------------------------------------------------------------
+QJSValue from_address(edb::address_t address) {
+	return QJSValue(static_cast<double>(address.toUint()));
+}
+
+//------------------------------------------------------------------------------
+// Name: to_bytes
+// Desc: an ArrayBuffer, or the part of one a typed array looks at
+//------------------------------------------------------------------------------
+QByteArray to_bytes(const QJSValue &value) {
+
+	if(value.hasProperty("buffer") && value.hasProperty("byteOffset")) {
+		const QByteArray buffer = value.property("buffer").toVariant().toByteArray();
+		return buffer.mid(value.property("byteOffset").toInt(), value.property("byteLength").toInt());
+	}
+
+	return value.toVariant().toByteArray();
+}
+
+//------------------------------------------------------------------------------
+// Name: event_kind
+// Desc:
+//------------------------------------------------------------------------------
+const char *event_kind(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(event->exited()) {
+		return "exit";
+	}
+
+	if(event->terminated()) {
+		return "terminated";
+	}
+
+	if(event->is_trap()) {
+		switch(event->trap_reason()) {
+		case IDebugEvent::TRAP_STEPPING:   return "step";
+		case IDebugEvent::TRAP_BREAKPOINT: return "breakpoint";
+		case IDebugEvent::TRAP_SYSCALL:    return "syscall";
+		}
+	}
+
+	return event->is_stop() ? "pause" : "signal";
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: ScriptApi
+// Desc:
+//------------------------------------------------------------------------------
+ScriptApi::ScriptApi(QJSEngine *engine, QObject *parent) : QObject(parent), engine_(engine) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~ScriptApi
+// Desc:
+//------------------------------------------------------------------------------
+ScriptApi::~ScriptApi() {
+}
+
+//------------------------------------------------------------------------------
+// Name: pid
+// Desc:
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::pid() const {
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		return QJSValue(static_cast<int>(process->pid()));
+	}
+	return QJSValue(QJSValue::NullValue);
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate
+// Desc:
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::evaluate(const QString &expression) const {
+	edb::address_t value;
+	if(to_address(QJSValue(expression), &value)) {
+		return from_address(value);
+	}
+	return QJSValue(QJSValue::NullValue);
+}
+
+//------------------------------------------------------------------------------
+// Name: registerValue
+// Desc: the value of a register of the current thread, as a number. Only
+//       registers of up to 64 bits are available
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::registerValue(const QString &name) const {
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+	if(const Register reg = state[name]) {
+		if(reg.bitSize() <= 64) {
+			return QJSValue(static_cast<double>(reg.valueAsInteger()));
+		}
+	}
+	return QJSValue(QJSValue::NullValue);
+}
+
+//------------------------------------------------------------------------------
+// Name: setRegister
+// Desc:
+//------------------------------------------------------------------------------
+bool ScriptApi::setRegister(const QString &name, const QJSValue &value) {
+	edb::address_t v;
+	if(!edb::v1::debugger_core->process() || !to_address(value, &v)) {
+		return false;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+	if(!state[name]) {
+		return false;
+	}
+
+	state.set_register(name, v);
+	edb::v1::debugger_core->set_state(state);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: read
+// Desc: an ArrayBuffer of what could be read, null if nothing could
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::read(const QJSValue &address, int size) const {
+	const QJSValue results = readMany(QJSValue(address), QJSValue(size));
+	return results.isArray() ? results.property(0) : results;
+}
+
+//------------------------------------------------------------------------------
+// Name: readMany
+// Desc: reads every address of the array <addresses> in one go, <sizes> is
+//       either a single size for all of them or an array of sizes. Returns an
+//       array of ArrayBuffers, each as long as what could be read there. The
+//       buffers are the very ones the debuggee was read into.
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::readMany(const QJSValue &addresses, const QJSValue &sizes) const {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	if(!process) {
+		return QJSValue(QJSValue::NullValue);
+	}
+
+	const bool single = !addresses.isArray();
+	const int count   = single ? 1 : addresses.property("length").toInt();
+
+	QVector<QByteArray>  blocks;
+	QVector<ReadRequest> requests;
+	blocks.reserve(count);
+	requests.reserve(count);
+
+	for(int i = 0; i < count; ++i) {
+		edb::address_t address;
+		const int size = sizes.isArray() ? sizes.property(i).toInt() : sizes.toInt();
+		if(to_address(single ? addresses : addresses.property(i), &address) && size > 0) {
+			blocks.push_back(QByteArray(size, '\0'));
+		} else {
+			address = 0;
+			blocks.push_back(QByteArray());
+		}
+
+		requests.push_back({address, blocks.back().data(), static_cast<std::size_t>(blocks.back().size())});
+	}
+
+	const QVector<std::size_t> read = process->read_many(requests);
+
+	QJSValue results = engine_->newArray(count);
+	for(int i = 0; i < count; ++i) {
+		blocks[i].resize(static_cast<int>(read[i]));
+		results.setProperty(i, read[i] ? engine_->toScriptValue(blocks[i]) : QJSValue(QJSValue::NullValue));
+	}
+
+	return single ? results.property(0) : results;
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc: writes an ArrayBuffer (or typed array) to <address>, returns how many
+//       bytes were written
+//------------------------------------------------------------------------------
+int ScriptApi::write(const QJSValue &address, const QJSValue &data) {
+
+	QJSValue write = engine_->newObject();
+	write.setProperty("address", address);
+	write.setProperty("data", data);
+
+	QJSValue writes = engine_->newArray(1);
+	writes.setProperty(0, write);
+
+	return writeMany(writes).property(0).toInt();
+}
+
+//------------------------------------------------------------------------------
+// Name: writeMany
+// Desc: <writes> is an array of {address, data}, all of which are written in
+//       one go. Returns how many bytes were written for each
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::writeMany(const QJSValue &writes) {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	if(!process) {
+		return QJSValue(QJSValue::NullValue);
+	}
+
+	const int count = writes.property("length").toInt();
+
+	QVector<QByteArray>   blocks;
+	QVector<WriteRequest> requests;
+	blocks.reserve(count);
+	requests.reserve(count);
+
+	for(int i = 0; i < count; ++i) {
+		const QJSValue write = writes.property(i);
+
+		edb::address_t address;
+		if(to_address(write.property("address"), &address)) {
+			blocks.push_back(to_bytes(write.property("data")));
+		} else {
+			address = 0;
+			blocks.push_back(QByteArray());
+		}
+
+		requests.push_back({address, blocks.back().constData(), static_cast<std::size_t>(blocks.back().size())});
+	}
+
+	const QVector<std::size_t> written = process->write_many(requests);
+
+	QJSValue results = engine_->newArray(count);
+	for(int i = 0; i < count; ++i) {
+		results.setProperty(i, static_cast<int>(written[i]));
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: setBreakpoint
+// Desc:
+//------------------------------------------------------------------------------
+bool ScriptApi::setBreakpoint(const QJSValue &address) {
+	edb::address_t a;
+	return edb::v1::debugger_core->process() && to_address(address, &a) && edb::v1::debugger_core->add_breakpoint(a);
+}
+
+//------------------------------------------------------------------------------
+// Name: removeBreakpoint
+// Desc:
+//------------------------------------------------------------------------------
+void ScriptApi::removeBreakpoint(const QJSValue &address) {
+	edb::address_t a;
+	if(to_address(address, &a)) {
+		edb::v1::debugger_core->remove_breakpoint(a);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: breakpoints
+// Desc: an array of {address, hits, enabled}, internal ones left out
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::breakpoints() const {
+
+	const IDebugger::BreakpointList list = edb::v1::debugger_core->backup_breakpoints();
+
+	QJSValue results = engine_->newArray();
+	int n = 0;
+	for(const std::shared_ptr<IBreakpoint> &bp : list) {
+		if(!bp->internal()) {
+			QJSValue entry = engine_->newObject();
+			entry.setProperty("address", from_address(bp->address()));
+			entry.setProperty("hits", static_cast<double>(bp->hit_count()));
+			entry.setProperty("enabled", bp->enabled());
+			results.setProperty(n++, entry);
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: symbol
+// Desc: "symbol+offset" for <address>, null if it isn't near any
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::symbol(const QJSValue &address) const {
+	edb::address_t a;
+	if(to_address(address, &a)) {
+		const QString name = edb::v1::find_function_symbol(a);
+		if(!name.isEmpty()) {
+			return QJSValue(name);
+		}
+	}
+	return QJSValue(QJSValue::NullValue);
+}
+
+//------------------------------------------------------------------------------
+// Name: lookup
+// Desc:
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::lookup(const QString &name) const {
+	if(const std::shared_ptr<Symbol> sym = edb::v1::symbol_manager().find(name)) {
+		return from_address(sym->address);
+	}
+	return QJSValue(QJSValue::NullValue);
+}
+
+//------------------------------------------------------------------------------
+// Name: regions
+// Desc: an array of {start, end, name, permissions}, end being one past the
+//       last byte
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::regions() const {
+
+	edb::v1::memory_regions().sync();
+
+	QJSValue results = engine_->newArray();
+	int n = 0;
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		QJSValue entry = engine_->newObject();
+		entry.setProperty("start", from_address(region->start()));
+		entry.setProperty("end", from_address(region->end()));
+		entry.setProperty("name", region->name());
+		entry.setProperty("permissions", QString("%1%2%3").arg(region->readable() ? 'r' : '-').arg(region->writable() ? 'w' : '-').arg(region->executable() ? 'x' : '-'));
+		results.setProperty(n++, entry);
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: functions
+// Desc: what the analyzer found in the region containing <address>, as an
+//       array of {entry, end, references}. Empty if it hasn't been analyzed
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::functions(const QJSValue &address) const {
+
+	QJSValue results = engine_->newArray();
+
+	edb::address_t a;
+	IAnalyzer *const analyzer = edb::v1::analyzer();
+	if(!analyzer || !to_address(address, &a)) {
+		return results;
+	}
+
+	if(const std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(a)) {
+		const IAnalyzer::FunctionMap functions = analyzer->functions(region);
+		int n = 0;
+		for(const Function &function : functions) {
+			QJSValue entry = engine_->newObject();
+			entry.setProperty("entry", from_address(function.entry_address()));
+			entry.setProperty("end", from_address(function.end_address()));
+			entry.setProperty("references", function.reference_count());
+			results.setProperty(n++, entry);
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc: steps the current thread, returns the event it stopped with
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::step() {
+	return drive(Step, QJSValue(), -1);
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: runs until the first event, or until <timeout> ms are up
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::run(int timeout) {
+	return drive(Run, QJSValue(), timeout);
+}
+
+//------------------------------------------------------------------------------
+// Name: runUntil
+// Desc: runs, calling <callback> with every event, until it returns true or
+//       <timeout> ms are up. Breakpoints are stepped over and signals passed
+//       on for as long as the callback returns false
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::runUntil(const QJSValue &callback, int timeout) {
+	return drive(Run, callback, timeout);
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc: like Debugger::resume_execution, a breakpoint we are sitting on is
+//       stepped over with it disabled
+//------------------------------------------------------------------------------
+bool ScriptApi::resume(IProcess *process, Mode mode, edb::EVENT_STATUS status) {
+
+	const std::shared_ptr<IThread> thread = process->current_thread();
+	if(!thread) {
+		return false;
+	}
+
+	State state;
+	thread->get_state(&state);
+	if(const std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core->find_breakpoint(state.instruction_pointer())) {
+		if(bp->enabled()) {
+			bp->disable();
+			reenable_breakpoint_ = bp;
+			return static_cast<bool>(thread->step(status));
+		}
+	}
+
+	return static_cast<bool>(mode == Step ? thread->step(status) : process->resume(status));
+}
+
+//------------------------------------------------------------------------------
+// Name: arrived_at_breakpoint
+// Desc: the part of Debugger::handle_trap that counts a hit and backs the
+//       instruction pointer up to the breakpoint
+//------------------------------------------------------------------------------
+std::shared_ptr<IBreakpoint> ScriptApi::arrived_at_breakpoint(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(!event->is_trap() || event->trap_reason() != IDebugEvent::TRAP_BREAKPOINT) {
+		return nullptr;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+
+	const std::shared_ptr<IBreakpoint> bp = edb::v1::find_triggered_breakpoint(state.instruction_pointer());
+	if(bp && bp->enabled()) {
+		bp->hit();
+		state.set_instruction_pointer(bp->address());
+		edb::v1::debugger_core->set_state(state);
+
+		if(bp->one_time()) {
+			edb::v1::debugger_core->remove_breakpoint(bp->address());
+		}
+		return bp;
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: make_event
+// Desc: {kind, pid, tid, code, ip} for the callbacks
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::make_event(const std::shared_ptr<IDebugEvent> &event, const char *kind) const {
+
+	QJSValue result = engine_->newObject();
+	result.setProperty("kind", kind);
+	result.setProperty("pid", static_cast<int>(event->process()));
+	result.setProperty("tid", static_cast<int>(event->thread()));
+	result.setProperty("code", event->code());
+
+	if(event->stopped()) {
+		State state;
+		edb::v1::debugger_core->get_state(&state);
+		result.setProperty("ip", from_address(state.instruction_pointer()));
+	}
+
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// Name: drive
+// Desc: the loop behind step(), run() and runUntil(). Nothing else of edb sees
+//       the events on the way, only the one the run ends with is handed to the
+//       main window, if the process is gone by then
+//------------------------------------------------------------------------------
+QJSValue ScriptApi::drive(Mode mode, const QJSValue &callback, int timeout) {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return QJSValue(QJSValue::NullValue);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	bool timed_out = false;
+	edb::EVENT_STATUS status = edb::DEBUG_CONTINUE;
+
+	Q_FOREVER {
+		if(!resume(process, mode, status)) {
+			return QJSValue(QJSValue::NullValue);
+		}
+
+		std::shared_ptr<IDebugEvent> event;
+		while(!event) {
+			event = edb::v1::debugger_core->wait_debug_event(WaitSlice);
+
+			if(event && reenable_breakpoint_) {
+				reenable_breakpoint_->enable();
+				reenable_breakpoint_ = nullptr;
+
+				// that was just the step off of a breakpoint
+				if(mode == Run && event->is_trap() && event->trap_reason() == IDebugEvent::TRAP_STEPPING) {
+					event = nullptr;
+					if(!process->resume(edb::DEBUG_CONTINUE)) {
+						return QJSValue(QJSValue::NullValue);
+					}
+					continue;
+				}
+			}
+
+			if(!event && !timed_out && timeout >= 0 && timer.elapsed() >= timeout) {
+				timed_out = true;
+				process->pause();
+			}
+		}
+
+		if(!event->stopped()) {
+			const QJSValue result = make_event(event, event_kind(event));
+			edb::v1::execute_debug_event_handlers(event);
+			return result;
+		}
+
+		const std::shared_ptr<IBreakpoint> bp = arrived_at_breakpoint(event);
+
+		// edb's own breakpoints (the linker hook) aren't the script's business
+		if(!timed_out && bp && bp->internal()) {
+			status = edb::DEBUG_CONTINUE;
+			continue;
+		}
+
+		const QJSValue result = make_event(event, timed_out ? "timeout" : event_kind(event));
+		if(timed_out || mode == Step || !callback.isCallable()) {
+			edb::v1::memory_regions().sync();
+			return result;
+		}
+
+		const QJSValue stop = QJSValue(callback).call(QJSValueList() << result);
+		if(stop.isError()) {
+			qWarning() << "[Scripting] the runUntil callback threw:" << qPrintable(stop.toString());
+			edb::v1::memory_regions().sync();
+			return stop;
+		}
+
+		if(stop.toBool()) {
+			edb::v1::memory_regions().sync();
+			return result;
+		}
+
+		status = (event->is_trap() || event->is_stop()) ? edb::DEBUG_CONTINUE : edb::DEBUG_EXCEPTION_NOT_HANDLED;
+	}
+}
+
+}
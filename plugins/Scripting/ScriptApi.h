@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SCRIPT_API_20171014_H_
+#define SCRIPT_API_20171014_H_
+
+#include "Types.h"
+
+#include <QJSValue>
+#include <QObject>
+#include <memory>
+
+class IBreakpoint;
+class IDebugEvent;
+class IProcess;
+class QJSEngine;
+
+namespace ScriptingPlugin {
+
+// the "edb" object scripts see. Addresses and register values are plain
+// numbers (or expression strings going in), memory is ArrayBuffers, and
+// anything taking several of them does a single trip to the debuggee.
+//
+// run() and runUntil() drive the debugger core themselves, the main window
+// only hears about where the run ended, so callbacks aren't held up by views
+// being refreshed on every event
+class ScriptApi : public QObject {
+	Q_OBJECT
+
+public:
+	ScriptApi(QJSEngine *engine, QObject *parent = 0);
+	virtual ~ScriptApi();
+
+public:
+	Q_INVOKABLE QJSValue pid() const;
+	Q_INVOKABLE QJSValue evaluate(const QString &expression) const;
+	Q_INVOKABLE QJSValue registerValue(const QString &name) const;
+	Q_INVOKABLE bool setRegister(const QString &name, const QJSValue &value);
+
+public:
+	Q_INVOKABLE QJSValue read(const QJSValue &address, int size) const;
+	Q_INVOKABLE QJSValue readMany(const QJSValue &addresses, const QJSValue &sizes) const;
+	Q_INVOKABLE int write(const QJSValue &address, const QJSValue &data);
+	Q_INVOKABLE QJSValue writeMany(const QJSValue &writes);
+
+public:
+	Q_INVOKABLE bool setBreakpoint(const QJSValue &address);
+	Q_INVOKABLE void removeBreakpoint(const QJSValue &address);
+	Q_INVOKABLE QJSValue breakpoints() const;
+
+public:
+	Q_INVOKABLE QJSValue symbol(const QJSValue &address) const;
+	Q_INVOKABLE QJSValue lookup(const QString &name) const;
+	Q_INVOKABLE QJSValue regions() const;
+	Q_INVOKABLE QJSValue functions(const QJSValue &address) const;
+
+public:
+	Q_INVOKABLE QJSValue step();
+	Q_INVOKABLE QJSValue run(int timeout = -1);
+	Q_INVOKABLE QJSValue runUntil(const QJSValue &callback, int timeout = -1);
+
+private:
+	enum Mode { Run, Step };
+
+	QJSValue drive(Mode mode, const QJSValue &callback, int timeout);
+	bool resume(IProcess *process, Mode mode, edb::EVENT_STATUS status);
+	std::shared_ptr<IBreakpoint> arrived_at_breakpoint(const std::shared_ptr<IDebugEvent> &event);
+	QJSValue make_event(const std::shared_ptr<IDebugEvent> &event, const char *kind) const;
+
+private:
+	QJSEngine *                  engine_;
+	std::shared_ptr<IBreakpoint> reenable_breakpoint_;
+};
+
+}
+
+#endif
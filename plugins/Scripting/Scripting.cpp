@@ -0,0 +1,173 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Scripting.h"
+#include "ScriptApi.h"
+#include "edb.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QJSEngine>
+#include <QMenu>
+#include <QMessageBox>
+#include <QSettings>
+#include <QTimer>
+#include <QtDebug>
+
+namespace ScriptingPlugin {
+
+//------------------------------------------------------------------------------
+// Name: Scripting
+// Desc:
+//------------------------------------------------------------------------------
+Scripting::Scripting() : menu_(0) {
+	QSettings settings;
+	last_script_ = settings.value("Scripting/last_script").toString();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~Scripting
+// Desc:
+//------------------------------------------------------------------------------
+Scripting::~Scripting() {
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *Scripting::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		menu_ = new QMenu(tr("Scripting"), parent);
+		menu_->addAction(tr("&Run Script..."), this, SLOT(show_menu()));
+		menu_->addAction(tr("Run &Last Script"), this, SLOT(run_last_script()));
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: extra_arguments
+// Desc:
+//------------------------------------------------------------------------------
+QString Scripting::extra_arguments() const {
+	return " --script <filename>       : run the JavaScript in <filename> once edb is up";
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_arguments
+// Desc: the script can only run once the main window and the debuggee are
+//       there, so it waits for the event loop to start
+//------------------------------------------------------------------------------
+IPlugin::ArgumentStatus Scripting::parse_arguments(QStringList &args) {
+
+	if(args.size() >= 2 && args[1] == "--script") {
+		if(args.size() < 3) {
+			return ARG_ERROR;
+		}
+
+		pending_script_ = args[2];
+		args.erase(args.begin() + 1, args.begin() + 3);
+		QTimer::singleShot(0, this, SLOT(run_pending_script()));
+	}
+
+	return ARG_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Name: run_pending_script
+// Desc:
+//------------------------------------------------------------------------------
+void Scripting::run_pending_script() {
+	const QString filename = pending_script_;
+	pending_script_.clear();
+	run_script(filename);
+}
+
+//------------------------------------------------------------------------------
+// Name: show_menu
+// Desc:
+//------------------------------------------------------------------------------
+void Scripting::show_menu() {
+	const QString filename = QFileDialog::getOpenFileName(edb::v1::debugger_ui, tr("Run Script"), last_script_, tr("JavaScript (*.js);;All Files (*)"));
+	if(!filename.isEmpty()) {
+		run_script(filename);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: run_last_script
+// Desc:
+//------------------------------------------------------------------------------
+void Scripting::run_last_script() {
+	if(last_script_.isEmpty()) {
+		show_menu();
+	} else {
+		run_script(last_script_);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: run_script
+// Desc: evaluates <filename> with the debugger API as the global "edb" object.
+//       returns false if it couldn't be read or threw
+//------------------------------------------------------------------------------
+bool Scripting::run_script(const QString &filename) {
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		QMessageBox::warning(edb::v1::debugger_ui, tr("Run Script"), tr("Unable to open %1: %2").arg(filename, file.errorString()));
+		return false;
+	}
+
+	last_script_ = filename;
+	QSettings settings;
+	settings.setValue("Scripting/last_script", filename);
+
+	QJSEngine engine;
+	engine.installExtensions(QJSEngine::ConsoleExtension);
+
+	// parented, so that the engine leaves its lifetime to us
+	auto api = new ScriptApi(&engine, this);
+	engine.globalObject().setProperty("edb", engine.newQObject(api));
+
+	const QJSValue result = engine.evaluate(QString::fromUtf8(file.readAll()), filename);
+	delete api;
+
+	// whatever the script did to the debuggee is shown once, at the end
+	edb::v1::update_ui();
+
+	if(result.isError()) {
+		const QString message = tr("%1:%2: %3").arg(filename, result.property("lineNumber").toString(), result.toString());
+		qWarning() << "[Scripting]" << qPrintable(message);
+		QMessageBox::warning(edb::v1::debugger_ui, tr("Script Error"), message);
+		return false;
+	}
+
+	return true;
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Scripting, Scripting)
+#endif
+
+}
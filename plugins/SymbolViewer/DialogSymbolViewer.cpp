@@ -25,12 +25,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "edb.h"
 
 #include <QStringListModel>
-#include <QSortFilterProxyModel>
 #include <QMenu>
 
 #include "ui_DialogSymbolViewer.h"
 
 namespace SymbolViewerPlugin {
+namespace {
+
+// a filter matching more than this shows only the first ones, a list that
+// long is no use and only takes time to build
+const int MAX_MATCHES = 10000;
+
+}
 
 //------------------------------------------------------------------------------
 // Name: DialogSymbolViewer
@@ -41,15 +47,10 @@ DialogSymbolViewer::DialogSymbolViewer(QWidget *parent) : QDialog(parent), ui(ne
 
 	ui->listView->setContextMenuPolicy(Qt::CustomContextMenu);
 
-	model_        = new QStringListModel(this);
-	filter_model_ = new QSortFilterProxyModel(this);
+	model_ = new QStringListModel(this);
 
-	filter_model_->setFilterKeyColumn(0);
-	filter_model_->setSourceModel(model_);
-	ui->listView->setModel(filter_model_);
+	ui->listView->setModel(model_);
 	ui->listView->setUniformItemSizes(true);
-
-	connect(ui->txtSearch, SIGNAL(textChanged(const QString &)), filter_model_, SLOT(setFilterFixedString(const QString &)));
 }
 
 //------------------------------------------------------------------------------
@@ -154,19 +155,43 @@ void DialogSymbolViewer::mnuFollowInCPU() {
 
 //------------------------------------------------------------------------------
 // Name: do_find
-// Desc:
+// Desc: lists the symbols whose names contain the filter, which the symbol
+//       manager searches for rather than every row being matched against it
 //------------------------------------------------------------------------------
 void DialogSymbolViewer::do_find() {
 	QStringList results;
 
-	const QList<std::shared_ptr<Symbol>> symbols = edb::v1::symbol_manager().symbols();
-	for(const std::shared_ptr<Symbol> &sym: symbols) {
+	const QString filter = ui->txtSearch->text();
+	bool truncated       = false;
+
+	edb::v1::symbol_manager().search(filter, false, [&](const std::shared_ptr<Symbol> &sym) {
+		if(!filter.isEmpty() && results.size() == MAX_MATCHES) {
+			truncated = true;
+			return false;
+		}
+
 		results << QString("%1: %2").arg(edb::v1::format_pointer(sym->address), sym->name);
+		return true;
+	});
+
+	if(truncated) {
+		ui->label->setText(tr("Loaded Symbols (the first %1 matches):").arg(MAX_MATCHES));
+	} else {
+		ui->label->setText(tr("Loaded Symbols:"));
 	}
 
 	model_->setStringList(results);
 }
 
+//------------------------------------------------------------------------------
+// Name: on_txtSearch_textChanged
+// Desc:
+//------------------------------------------------------------------------------
+void DialogSymbolViewer::on_txtSearch_textChanged(const QString &text) {
+	Q_UNUSED(text);
+	do_find();
+}
+
 //------------------------------------------------------------------------------
 // Name: on_btnRefresh_clicked
 // Desc:
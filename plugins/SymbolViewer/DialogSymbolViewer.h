@@ -24,7 +24,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 class QModelIndex;
 class QPoint;
-class QSortFilterProxyModel;
 class QStringListModel;
 
 namespace SymbolViewerPlugin {
@@ -42,6 +41,7 @@ public Q_SLOTS:
 	void on_listView_doubleClicked(const QModelIndex &index);
 	void on_listView_customContextMenuRequested(const QPoint &pos);
 	void on_btnRefresh_clicked();
+	void on_txtSearch_textChanged(const QString &text);
 
 private Q_SLOTS:
 	void mnuFollowInDump();
@@ -58,7 +58,6 @@ private:
 private:
 	 Ui::DialogSymbolViewer *const ui;
 	 QStringListModel *            model_;
-	 QSortFilterProxyModel *       filter_model_;
 };
 
 }
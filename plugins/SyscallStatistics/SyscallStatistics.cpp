@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SyscallStatistics.h"
+#include "SyscallStatsWidget.h"
+#include "edb.h"
+
+#include <QDockWidget>
+#include <QMainWindow>
+#include <QMenu>
+
+namespace SyscallStatisticsPlugin {
+
+//------------------------------------------------------------------------------
+// Name: SyscallStatistics
+// Desc:
+//------------------------------------------------------------------------------
+SyscallStatistics::SyscallStatistics() : menu_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *SyscallStatistics::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		if(auto main_window = qobject_cast<QMainWindow *>(edb::v1::debugger_ui)) {
+			auto widget = new SyscallStatsWidget;
+
+			// the name is what gets its state saved with the GUI's
+			auto dock_widget = new QDockWidget(tr("System Calls"), main_window);
+			dock_widget->setObjectName(QString::fromUtf8("SyscallStatistics"));
+			dock_widget->setWidget(widget);
+
+			main_window->addDockWidget(Qt::BottomDockWidgetArea, dock_widget);
+			dock_widget->hide();
+
+			menu_ = new QMenu(tr("System Call Statistics"), parent);
+			menu_->addAction(dock_widget->toggleViewAction());
+		}
+	}
+
+	return menu_;
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(SyscallStatistics, SyscallStatistics)
+#endif
+
+}
@@ -0,0 +1,365 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SyscallStatsWidget.h"
+#include "IDebugger.h"
+#include "edb.h"
+
+#include <QFile>
+#include <QMessageBox>
+#include <QStringList>
+#include <QTableWidgetItem>
+#include <QTimer>
+#include <QXmlStreamReader>
+#include <QtDebug>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include "errno-names-linux.h"
+#endif
+
+#include "ui_SyscallStatsWidget.h"
+
+namespace SyscallStatisticsPlugin {
+
+namespace {
+
+// a few times a second is enough to watch, and costs nothing per system call
+const int FlushInterval = 250;
+
+// how many of the errors a system call returned are named in its row
+const int ErrorsShown = 3;
+
+enum Column {
+	ColumnName,
+	ColumnCalls,
+	ColumnErrors,
+	ColumnErrorRate,
+	ColumnTime,
+	ColumnAverage,
+	ColumnErrnos
+};
+
+//------------------------------------------------------------------------------
+// Name: load_syscall_names
+// Desc: the names syscalls.xml gives the system calls of <arch>
+//------------------------------------------------------------------------------
+QHash<int, QString> load_syscall_names(const QString &arch) {
+
+	QHash<int, QString> names;
+
+	QFile file(":/debugger/xml/syscalls.xml");
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return names;
+	}
+
+	QXmlStreamReader xml(&file);
+	bool    in_arch = false;
+	QString name;
+
+	while(!xml.atEnd()) {
+		if(xml.readNext() != QXmlStreamReader::StartElement) {
+			continue;
+		}
+
+		if(xml.name() == QLatin1String("linux")) {
+			in_arch = (xml.attributes().value("arch").toString() == arch);
+		} else if(in_arch && xml.name() == QLatin1String("syscall")) {
+			name = xml.attributes().value("name").toString();
+		} else if(in_arch && xml.name() == QLatin1String("index")) {
+			bool ok;
+			const int index = xml.readElementText().trimmed().toInt(&ok, 0);
+			if(ok) {
+				names.insert(index, name);
+			}
+		}
+	}
+
+	if(xml.hasError()) {
+		qDebug() << "error reading syscalls.xml:" << xml.errorString();
+	}
+
+	return names;
+}
+
+//------------------------------------------------------------------------------
+// Name: errno_name
+// Desc:
+//------------------------------------------------------------------------------
+QString errno_name(int error) {
+#ifdef Q_OS_LINUX
+	const std::size_t index = error;
+	if(index < sizeof errnoNames / sizeof *errnoNames && errnoNames[index]) {
+		return errnoNames[index];
+	}
+#endif
+	return QString::number(error);
+}
+
+//------------------------------------------------------------------------------
+// Name: number_item
+// Desc: an item which sorts by its value instead of its text
+//------------------------------------------------------------------------------
+QTableWidgetItem *number_item(const QVariant &value) {
+	auto item = new QTableWidgetItem;
+	item->setData(Qt::DisplayRole, value);
+	item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	return item;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: SyscallStatsWidget
+// Desc:
+//------------------------------------------------------------------------------
+SyscallStatsWidget::SyscallStatsWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), ui(new Ui::SyscallStatsWidget), timer_(new QTimer(this)), dirty_(false) {
+	ui->setupUi(this);
+	ui->cmbThread->addItem(tr("All Threads"), QVariant());
+
+	timer_->setInterval(FlushInterval);
+	connect(timer_, SIGNAL(timeout()), this, SLOT(flush()));
+	connect(edb::v1::debugger_ui, SIGNAL(detachEvent()), this, SLOT(detached()));
+
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~SyscallStatsWidget
+// Desc:
+//------------------------------------------------------------------------------
+SyscallStatsWidget::~SyscallStatsWidget() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnStart_clicked
+// Desc: counting starts when the process is next resumed
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::on_btnStart_clicked() {
+
+	const Status status = edb::v1::debugger_core->start_syscall_stats();
+	if(!status) {
+		QMessageBox::critical(this, tr("System Call Statistics"), status.toString());
+		return;
+	}
+
+	timer_->start();
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnStop_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::on_btnStop_clicked() {
+	edb::v1::debugger_core->stop_syscall_stats();
+	timer_->stop();
+	flush();
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnClear_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::on_btnClear_clicked() {
+
+	// what the core has counted so far is part of what is being cleared
+	SyscallStats discarded;
+	edb::v1::debugger_core->take_syscall_stats(&discarded);
+
+	stats_ = SyscallStats();
+
+	ui->cmbThread->blockSignals(true);
+	while(ui->cmbThread->count() > 1) {
+		ui->cmbThread->removeItem(1);
+	}
+	ui->cmbThread->blockSignals(false);
+
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_cmbThread_currentIndexChanged
+// Desc:
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::on_cmbThread_currentIndexChanged(int index) {
+	Q_UNUSED(index);
+	update_table();
+}
+
+//------------------------------------------------------------------------------
+// Name: flush
+// Desc: adds up what the core counted since the last time. The table is only
+//       redone when something changed, and it can be seen
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::flush() {
+
+	SyscallStats counted;
+	if(!edb::v1::debugger_core->take_syscall_stats(&counted)) {
+		return;
+	}
+
+	stats_ += counted;
+	dirty_ = true;
+
+	if(isVisible()) {
+		update_threads();
+		update_table();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: detached
+// Desc: the counts stay to be looked at, the core forgets its own
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::detached() {
+	timer_->stop();
+	update_buttons();
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::showEvent(QShowEvent *event) {
+	QWidget::showEvent(event);
+
+	if(dirty_) {
+		update_threads();
+		update_table();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_buttons
+// Desc:
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::update_buttons() {
+	const bool active = edb::v1::debugger_core && edb::v1::debugger_core->syscall_stats_active();
+	ui->btnStart->setEnabled(!active);
+	ui->btnStop->setEnabled(active);
+}
+
+//------------------------------------------------------------------------------
+// Name: update_threads
+// Desc: adds the threads which made their first system calls to the list
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::update_threads() {
+
+	QList<edb::tid_t> tids = stats_.threads.keys();
+	std::sort(tids.begin(), tids.end());
+
+	for(edb::tid_t tid : tids) {
+		if(ui->cmbThread->findData(static_cast<qlonglong>(tid)) == -1) {
+			ui->cmbThread->addItem(tr("Thread %1").arg(tid), static_cast<qlonglong>(tid));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_table
+// Desc: one row for each system call of the chosen thread, or of them all
+//------------------------------------------------------------------------------
+void SyscallStatsWidget::update_table() {
+
+	dirty_ = false;
+
+	QMap<int, SyscallCounts> counts;
+
+	const QVariant selected = ui->cmbThread->itemData(ui->cmbThread->currentIndex());
+	for(auto thread = stats_.threads.begin(); thread != stats_.threads.end(); ++thread) {
+		if(selected.isNull() || selected.toLongLong() == static_cast<qlonglong>(thread.key())) {
+			for(auto it = thread->begin(); it != thread->end(); ++it) {
+				counts[it.key()] += it.value();
+			}
+		}
+	}
+
+	quint64 total_calls       = 0;
+	quint64 total_errors      = 0;
+	quint64 total_nanoseconds = 0;
+
+	ui->tableWidget->setSortingEnabled(false);
+	ui->tableWidget->setRowCount(0);
+	ui->tableWidget->setRowCount(counts.size());
+
+	int row = 0;
+	for(auto it = counts.begin(); it != counts.end(); ++it, ++row) {
+		const SyscallCounts &c = it.value();
+
+		total_calls       += c.calls;
+		total_errors      += c.errors;
+		total_nanoseconds += c.nanoseconds;
+
+		// the most frequent errors first
+		QList<QPair<quint64, int>> errnos;
+		for(auto e = c.errnos.begin(); e != c.errnos.end(); ++e) {
+			errnos.push_back(qMakePair(e.value(), e.key()));
+		}
+		std::sort(errnos.begin(), errnos.end(), [](const QPair<quint64, int> &lhs, const QPair<quint64, int> &rhs) {
+			return lhs.first > rhs.first;
+		});
+
+		QStringList errors;
+		for(int i = 0; i < errnos.size() && i < ErrorsShown; ++i) {
+			errors << QString("%1 %2").arg(errno_name(errnos[i].second)).arg(errnos[i].first);
+		}
+
+		const double rate    = c.calls ? (100.0 * c.errors / c.calls) : 0.0;
+		const double ms      = c.nanoseconds / 1e6;
+		const double average = c.calls ? (c.nanoseconds / 1e3 / c.calls) : 0.0;
+
+		ui->tableWidget->setItem(row, ColumnName,      new QTableWidgetItem(syscall_name(it.key())));
+		ui->tableWidget->setItem(row, ColumnCalls,     number_item(static_cast<qulonglong>(c.calls)));
+		ui->tableWidget->setItem(row, ColumnErrors,    number_item(static_cast<qulonglong>(c.errors)));
+		ui->tableWidget->setItem(row, ColumnErrorRate, number_item(QString::number(rate, 'f', 1).toDouble()));
+		ui->tableWidget->setItem(row, ColumnTime,      number_item(QString::number(ms, 'f', 3).toDouble()));
+		ui->tableWidget->setItem(row, ColumnAverage,   number_item(QString::number(average, 'f', 1).toDouble()));
+		ui->tableWidget->setItem(row, ColumnErrnos,    new QTableWidgetItem(errors.join(", ")));
+	}
+
+	ui->tableWidget->setSortingEnabled(true);
+
+	ui->labelSummary->setText(tr("%1 calls, %2 failed, %3 ms in system calls")
+		.arg(total_calls)
+		.arg(total_errors)
+		.arg(total_nanoseconds / 1e6, 0, 'f', 3));
+}
+
+//------------------------------------------------------------------------------
+// Name: syscall_name
+// Desc: the names are those of the debuggee's architecture, which is only
+//       known once there is one
+//------------------------------------------------------------------------------
+QString SyscallStatsWidget::syscall_name(int number) {
+
+	const QString arch = edb::v1::debuggeeIs64Bit() ? "x86-64" : "x86";
+	if(arch != names_arch_) {
+		names_      = load_syscall_names(arch);
+		names_arch_ = arch;
+	}
+
+	const QString name = names_.value(number);
+	return name.isEmpty() ? QString::number(number) : QString("%1 (%2)").arg(name).arg(number);
+}
+
+}
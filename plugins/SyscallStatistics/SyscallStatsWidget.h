@@ -0,0 +1,74 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SYSCALL_STATS_WIDGET_20171014_H_
+#define SYSCALL_STATS_WIDGET_20171014_H_
+
+#include "SyscallStats.h"
+#include <QHash>
+#include <QString>
+#include <QWidget>
+
+class QTimer;
+
+namespace SyscallStatisticsPlugin {
+
+namespace Ui { class SyscallStatsWidget; }
+
+// Shows what the core counted of the system calls, see
+// IDebugger::start_syscall_stats. The counts are collected a few times a
+// second, however many system calls there were in between
+class SyscallStatsWidget : public QWidget {
+	Q_OBJECT
+
+public:
+	SyscallStatsWidget(QWidget *parent = 0, Qt::WindowFlags f = 0);
+	virtual ~SyscallStatsWidget() override;
+
+public Q_SLOTS:
+	void on_btnStart_clicked();
+	void on_btnStop_clicked();
+	void on_btnClear_clicked();
+	void on_cmbThread_currentIndexChanged(int index);
+
+private Q_SLOTS:
+	void flush();
+	void detached();
+
+protected:
+	virtual void showEvent(QShowEvent *event) override;
+
+private:
+	void update_buttons();
+	void update_threads();
+	void update_table();
+	QString syscall_name(int number);
+
+private:
+	Ui::SyscallStatsWidget *ui;
+	QTimer                 *timer_;
+	SyscallStats            stats_;
+	bool                    dirty_;
+	QString                 names_arch_;
+	QHash<int, QString>     names_;
+};
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BranchTraceDecoder.h"
+#include "BranchTrace.h"
+#include "IDebugger.h"
+#include "Instruction.h"
+#include "edb.h"
+
+namespace TraceRecorderPlugin {
+
+namespace {
+
+const char TraceMagic[8]   = { 'E', 'D', 'B', 'T', 'R', 'A', 'C', 'E' };
+const quint32 TraceVersion = 1;
+
+const int FlushSize        = 0x100000;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: decode
+// Desc: an empty filename only collects the statistics and call targets
+//------------------------------------------------------------------------------
+bool BranchTraceDecoder::decode(const BranchTrace &trace, const QString &filename) {
+
+	if(!filename.isEmpty()) {
+		file_.setFileName(filename);
+		if(!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			error_ = file_.errorString();
+			return false;
+		}
+
+		// the samples can come from any thread, so no tid, and no registers
+		const quint32 fields[] = {
+			TraceVersion,
+			static_cast<quint32>(edb::v1::pointer_size()),
+			0,
+			0
+		};
+
+		if(!write(TraceMagic, sizeof(TraceMagic)) || !write(fields, sizeof(fields))) {
+			return false;
+		}
+	}
+
+	for(const BranchSample &sample : trace.samples) {
+		const QVector<BranchRecord> &branches = sample.branches;
+
+		for(int i = 0; i < branches.size(); ++i) {
+
+			if(is_call_at(branches[i].from)) {
+				call_targets_.insert(branches[i].to);
+			}
+
+			// the last branch of a sample has no known end
+			if(i + 1 == branches.size()) {
+				break;
+			}
+
+			const QVector<quint64> *run = decode_run(branches[i].to, branches[i + 1].from);
+			if(!run) {
+				++undecodable_;
+				continue;
+			}
+
+			++runs_;
+			instructions_ += run->size();
+
+			if(file_.isOpen()) {
+				for(quint64 ip : *run) {
+					const quint8 no_deltas = 0;
+					if(!write(&ip, sizeof(ip)) || !write(&no_deltas, sizeof(no_deltas))) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	if(file_.isOpen()) {
+		const bool ok = flush();
+		file_.close();
+		return ok;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: decode_run
+// Desc: returns the addresses of the instructions from <from> up to and
+//       including the branch at <to>, or nullptr if the code doesn't get there
+//------------------------------------------------------------------------------
+const QVector<quint64> *BranchTraceDecoder::decode_run(edb::address_t from, edb::address_t to) {
+
+	const QPair<quint64, quint64> key(from.toUint(), to.toUint());
+
+	auto it = run_cache_.find(key);
+	if(it != run_cache_.end()) {
+		return it->isEmpty() ? nullptr : &*it;
+	}
+
+	QVector<quint64> run;
+	edb::address_t address = from;
+
+	for(int i = 0; i < MaxRunLength && address <= to; ++i) {
+		quint8 buffer[edb::Instruction::MAX_SIZE];
+		const int size = edb::v1::get_instruction_bytes(address, buffer);
+		if(!size) {
+			break;
+		}
+
+		const edb::Instruction inst(buffer, buffer + size, address);
+		if(!inst.valid()) {
+			break;
+		}
+
+		run.push_back(address.toUint());
+
+		if(address == to) {
+			// an empty vector marks a failed run, this one always has the branch
+			return &*run_cache_.insert(key, run);
+		}
+
+		address += inst.byte_size();
+	}
+
+	run_cache_.insert(key, QVector<quint64>());
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_call_at
+// Desc:
+//------------------------------------------------------------------------------
+bool BranchTraceDecoder::is_call_at(edb::address_t address) {
+
+	auto it = call_cache_.find(address.toUint());
+	if(it != call_cache_.end()) {
+		return *it;
+	}
+
+	bool call = false;
+
+	quint8 buffer[edb::Instruction::MAX_SIZE];
+	if(const int size = edb::v1::get_instruction_bytes(address, buffer)) {
+		const edb::Instruction inst(buffer, buffer + size, address);
+		call = inst.valid() && is_call(inst);
+	}
+
+	call_cache_.insert(address.toUint(), call);
+	return call;
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc:
+//------------------------------------------------------------------------------
+bool BranchTraceDecoder::write(const void *data, int size) {
+	buffer_.append(static_cast<const char *>(data), size);
+	return buffer_.size() < FlushSize || flush();
+}
+
+//------------------------------------------------------------------------------
+// Name: flush
+// Desc:
+//------------------------------------------------------------------------------
+bool BranchTraceDecoder::flush() {
+	if(file_.write(buffer_) != buffer_.size()) {
+		error_ = file_.errorString();
+		return false;
+	}
+
+	buffer_.clear();
+	return true;
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BRANCH_TRACE_DECODER_20170705_H_
+#define BRANCH_TRACE_DECODER_20170705_H_
+
+#include "Types.h"
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+struct BranchTrace;
+
+namespace TraceRecorderPlugin {
+
+// Rebuilds the instructions executed between the branches of a hardware
+// branch trace by disassembling the process image, optionally writing them
+// out in the trace file format described in TraceRequest.h
+class BranchTraceDecoder {
+	Q_DISABLE_COPY(BranchTraceDecoder)
+public:
+	// a straight line run longer than this means the trace doesn't match
+	// the code (e.g. it was modified since)
+	static constexpr int MaxRunLength = 0x1000;
+
+public:
+	BranchTraceDecoder() = default;
+
+public:
+	bool decode(const BranchTrace &trace, const QString &filename);
+
+public:
+	QString error_string() const                 { return error_; }
+	quint64 instructions() const                 { return instructions_; }
+	quint64 runs() const                         { return runs_; }
+	quint64 undecodable() const                  { return undecodable_; }
+	QSet<edb::address_t> call_targets() const    { return call_targets_; }
+
+private:
+	const QVector<quint64> *decode_run(edb::address_t from, edb::address_t to);
+	bool is_call_at(edb::address_t address);
+	bool write(const void *data, int size);
+	bool flush();
+
+private:
+	QFile                                         file_;
+	QByteArray                                    buffer_;
+	QString                                       error_;
+	quint64                                       instructions_ = 0;
+	quint64                                       runs_         = 0;
+	quint64                                       undecodable_  = 0;
+	QSet<edb::address_t>                          call_targets_;
+	QHash<QPair<quint64, quint64>, QVector<quint64>> run_cache_;
+	QHash<quint64, bool>                          call_cache_;
+};
+
+}
+
+#endif
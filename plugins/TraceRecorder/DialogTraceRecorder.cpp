@@ -0,0 +1,211 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DialogTraceRecorder.h"
+#include "Expression.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "State.h"
+#include "TraceRequest.h"
+#include "edb.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
+
+#include <memory>
+
+#include "ui_DialogTraceRecorder.h"
+
+namespace TraceRecorderPlugin {
+
+//------------------------------------------------------------------------------
+// Name: DialogTraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+DialogTraceRecorder::DialogTraceRecorder(QWidget *parent) : QDialog(parent), ui(new Ui::DialogTraceRecorder) {
+	ui->setupUi(this);
+	ui->txtFile->setText(QDir::home().filePath("edb.trace"));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogTraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+DialogTraceRecorder::~DialogTraceRecorder() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void DialogTraceRecorder::showEvent(QShowEvent *) {
+
+	bool block_step = false;
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
+			block_step = thread->supports_block_step();
+		}
+	}
+
+	ui->chkBlockStep->setEnabled(block_step);
+	if(!block_step) {
+		ui->chkBlockStep->setChecked(false);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnBrowse_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogTraceRecorder::on_btnBrowse_clicked() {
+	const QString filename = QFileDialog::getSaveFileName(this, tr("Trace File"), ui->txtFile->text());
+	if(!filename.isEmpty()) {
+		ui->txtFile->setText(filename);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: optional_address
+// Desc: an empty field means 0, anything else has to be a valid expression
+//------------------------------------------------------------------------------
+bool DialogTraceRecorder::optional_address(const QString &text, edb::address_t *address) {
+	*address = 0;
+	return text.trimmed().isEmpty() || edb::v1::eval_expression(text, address);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnRecord_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogTraceRecorder::on_btnRecord_clicked() {
+
+	if(!edb::v1::debugger_core || !edb::v1::debugger_core->process()) {
+		QMessageBox::critical(this, tr("Not Debugging"), tr("There is no process to trace."));
+		return;
+	}
+
+	TraceRequest request;
+	request.filename            = ui->txtFile->text();
+	request.stop_outside_range  = ui->chkStopOutsideRange->isChecked();
+	request.stop_at_breakpoints = ui->chkStopAtBreakpoints->isChecked();
+	request.record_registers    = ui->chkRecordRegisters->isChecked();
+	request.block_step          = ui->chkBlockStep->isChecked();
+
+	bool ok;
+	request.max_steps = ui->txtMaxSteps->text().toULongLong(&ok, 0);
+	if(!ok) {
+		QMessageBox::critical(this, tr("Invalid Step Count"), tr("The maximum number of steps must be a number."));
+		return;
+	}
+
+	if(!optional_address(ui->txtRangeStart->text(), &request.range_start) || !optional_address(ui->txtRangeEnd->text(), &request.range_end)) {
+		return;
+	}
+
+	const QString modules = ui->txtModules->text().trimmed();
+	if(!modules.isEmpty()) {
+		QStringList names;
+		for(const QString &name : modules.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+			names << name.trimmed();
+		}
+
+		request.filter = edb::v1::module_step_filter(names);
+		if(request.filter.empty()) {
+			QMessageBox::critical(this, tr("Unknown Module"), tr("None of %1 are loaded.").arg(modules));
+			return;
+		}
+	}
+
+	// the condition is parsed once here, and only run for each step
+	std::shared_ptr<Expression<edb::address_t>> condition;
+	ExpressionError condition_error;
+	bool condition_failed = false;
+
+	const QString condition_text = ui->txtCondition->text().trimmed();
+	if(!condition_text.isEmpty()) {
+		condition = std::make_shared<Expression<edb::address_t>>(condition_text, edb::v1::get_variable, edb::v1::get_value);
+		if(!condition->compile(nullptr, &condition_error)) {
+			QMessageBox::critical(this, tr("Error In Expression!"), condition_error.what());
+			return;
+		}
+
+		request.stop_condition = [&](const State &state) {
+			auto state_variable = [&state](const QString &name, bool *ok, ExpressionError *err) {
+				return edb::v1::get_state_variable(state, name, ok, err);
+			};
+
+			bool ok;
+			const edb::address_t value = condition->evaluate_expression(state_variable, edb::v1::get_value, &ok, &condition_error);
+			if(!ok) {
+				condition_failed = true;
+				return true;
+			}
+			return static_cast<bool>(value);
+		};
+	}
+
+	QProgressDialog progress(tr("Recording trace..."), tr("Stop"), 0, 0, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	request.progress = [&progress](quint64 steps) {
+		progress.setLabelText(tr("Recording trace... %1 steps").arg(steps));
+		QApplication::processEvents();
+		return !progress.wasCanceled();
+	};
+
+	TraceResult result;
+	const Status status = edb::v1::debugger_core->record_trace(request, &result);
+
+	progress.reset();
+	edb::v1::update_ui();
+
+	if(!status) {
+		QMessageBox::critical(this, tr("Trace Failed"), status.toString());
+		return;
+	}
+
+	if(condition_failed) {
+		QMessageBox::critical(this, tr("Error In Expression!"), condition_error.what());
+	}
+
+	QString reason;
+	switch(result.reason) {
+	case TraceResult::StepLimit:  reason = tr("the step limit was reached"); break;
+	case TraceResult::Breakpoint: reason = tr("a breakpoint was hit"); break;
+	case TraceResult::Condition:  reason = tr("the stop condition was met"); break;
+	case TraceResult::LeftRange:  reason = tr("execution left the range"); break;
+	case TraceResult::Cancelled:  reason = tr("it was cancelled"); break;
+	case TraceResult::Event:      reason = tr("the process received a debug event"); break;
+	case TraceResult::Error:      reason = tr("an error occurred"); break;
+	}
+
+	QMessageBox::information(this, tr("Trace Recorded"),
+		tr("Recorded %1 of %2 steps (%3 bytes) to %4.\nThe trace stopped because %5.")
+			.arg(result.recorded)
+			.arg(result.steps)
+			.arg(result.bytes)
+			.arg(request.filename)
+			.arg(reason));
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIALOG_TRACE_RECORDER_20170622_H_
+#define DIALOG_TRACE_RECORDER_20170622_H_
+
+#include "Types.h"
+#include <QDialog>
+
+namespace TraceRecorderPlugin {
+
+namespace Ui { class DialogTraceRecorder; }
+
+class DialogTraceRecorder : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogTraceRecorder(QWidget *parent = 0);
+	virtual ~DialogTraceRecorder();
+
+public Q_SLOTS:
+	void on_btnBrowse_clicked();
+	void on_btnRecord_clicked();
+
+private:
+	virtual void showEvent(QShowEvent *event);
+
+private:
+	bool optional_address(const QString &text, edb::address_t *address);
+
+private:
+	Ui::DialogTraceRecorder *const ui;
+};
+
+}
+
+#endif
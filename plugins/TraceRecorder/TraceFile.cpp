@@ -0,0 +1,440 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TraceFile.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace TraceRecorderPlugin {
+
+namespace {
+
+const char    TraceMagic[8] = { 'E', 'D', 'B', 'T', 'R', 'A', 'C', 'E' };
+const quint32 TraceVersion  = 1;
+
+// ip and delta count, each delta is an index and a value
+const qint64 RecordSize = sizeof(quint64) + 1;
+const qint64 DeltaSize  = 1 + sizeof(quint64);
+
+template <class T>
+T read_value(const uchar *p) {
+	T value;
+	std::memcpy(&value, p, sizeof(T));
+	return value;
+}
+
+}
+
+const quint64 TraceFile::NoStep;
+
+//------------------------------------------------------------------------------
+// Name: ~TraceFile
+// Desc:
+//------------------------------------------------------------------------------
+TraceFile::~TraceFile() {
+	close();
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: maps the whole file, only the header is read
+//------------------------------------------------------------------------------
+bool TraceFile::open(const QString &filename) {
+
+	close();
+
+	file_.setFileName(filename);
+	if(!file_.open(QIODevice::ReadOnly)) {
+		error_ = file_.errorString();
+		return false;
+	}
+
+	size_ = file_.size();
+	map_  = file_.map(0, size_);
+	if(!map_) {
+		error_ = file_.errorString();
+		close();
+		return false;
+	}
+
+	if(!parse_header()) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_header
+// Desc:
+//------------------------------------------------------------------------------
+bool TraceFile::parse_header() {
+
+	const qint64 fixed = sizeof(TraceMagic) + 4 * sizeof(quint32);
+	if(size_ < fixed || std::memcmp(map_, TraceMagic, sizeof(TraceMagic)) != 0) {
+		error_ = QObject::tr("This is not a trace file");
+		return false;
+	}
+
+	const uchar *p = map_ + sizeof(TraceMagic);
+	if(read_value<quint32>(p) != TraceVersion) {
+		error_ = QObject::tr("Unsupported trace version %1").arg(read_value<quint32>(p));
+		return false;
+	}
+
+	pointer_size_                = read_value<quint32>(p + 4);
+	tid_                         = read_value<quint32>(p + 8);
+	const quint32 register_count = read_value<quint32>(p + 12);
+
+	qint64 offset = fixed;
+	for(quint32 i = 0; i < register_count; ++i) {
+		if(offset >= size_ || offset + 1 + map_[offset] > size_) {
+			error_ = QObject::tr("The trace header is truncated");
+			return false;
+		}
+
+		const int length = map_[offset];
+		registers_.push_back(QString::fromLatin1(reinterpret_cast<const char *>(map_ + offset + 1), length));
+		offset += 1 + length;
+	}
+
+	data_offset_ = offset;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: open_index
+// Desc: maps the index next to the trace, if there is one which is up to date
+//------------------------------------------------------------------------------
+bool TraceFile::open_index() {
+
+	index_file_.setFileName(index_filename());
+	if(!index_file_.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	const qint64 size = index_file_.size();
+	if(size < static_cast<qint64>(sizeof(IndexHeader)) || !(index_map_ = index_file_.map(0, size))) {
+		index_file_.close();
+		return false;
+	}
+
+	auto header = reinterpret_cast<const IndexHeader *>(index_map_);
+
+	const quint64 entry_size = sizeof(quint64) * (1 + header->register_count);
+	const quint64 expected   = sizeof(IndexHeader) + header->block_count * entry_size + header->address_count * sizeof(IndexAddress) + header->posting_count * sizeof(quint64);
+
+	if(std::memcmp(header->magic, IndexMagic, sizeof(IndexMagic)) != 0 ||
+	   header->trace_size     != static_cast<quint64>(size_) ||
+	   header->trace_modified != modified() ||
+	   header->block_size     != IndexBlockSize ||
+	   header->register_count != static_cast<quint32>(registers_.size()) ||
+	   expected               != static_cast<quint64>(size)) {
+
+		index_file_.unmap(index_map_);
+		index_file_.close();
+		index_map_ = nullptr;
+		return false;
+	}
+
+	index_     = header;
+	addresses_ = reinterpret_cast<const IndexAddress *>(index_map_ + sizeof(IndexHeader) + header->block_count * entry_size);
+	postings_  = reinterpret_cast<const quint64 *>(addresses_ + header->address_count);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: close
+// Desc:
+//------------------------------------------------------------------------------
+void TraceFile::close() {
+
+	if(index_map_) {
+		index_file_.unmap(index_map_);
+	}
+
+	if(map_) {
+		file_.unmap(map_);
+	}
+
+	index_file_.close();
+	file_.close();
+
+	map_          = nullptr;
+	index_map_    = nullptr;
+	index_        = nullptr;
+	addresses_    = nullptr;
+	postings_     = nullptr;
+	size_         = 0;
+	data_offset_  = 0;
+	pointer_size_ = 0;
+	tid_          = 0;
+	registers_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: modified
+// Desc:
+//------------------------------------------------------------------------------
+qint64 TraceFile::modified() const {
+	return QFileInfo(file_).lastModified().toMSecsSinceEpoch();
+}
+
+//------------------------------------------------------------------------------
+// Name: steps
+// Desc: without registers every record is the same size, so it is known
+//       before the trace is indexed
+//------------------------------------------------------------------------------
+quint64 TraceFile::steps() const {
+	if(index_) {
+		return index_->steps;
+	}
+
+	if(map_ && registers_.isEmpty()) {
+		return (size_ - data_offset_) / RecordSize;
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: block_entry
+// Desc:
+//------------------------------------------------------------------------------
+const uchar *TraceFile::block_entry(quint64 block) const {
+	Q_ASSERT(index_);
+	Q_ASSERT(block < index_->block_count);
+	return index_map_ + sizeof(IndexHeader) + block * sizeof(quint64) * (1 + index_->register_count);
+}
+
+//------------------------------------------------------------------------------
+// Name: walk
+// Desc: calls <f> for the steps in [first, last), until it returns false
+//------------------------------------------------------------------------------
+void TraceFile::walk(quint64 first, quint64 last, const std::function<bool(quint64, const Step &)> &f) const {
+
+	last = qMin(last, steps());
+	if(first >= last) {
+		return;
+	}
+
+	const uchar *p;
+	quint64 n;
+
+	if(registers_.isEmpty()) {
+		p = map_ + data_offset_ + first * RecordSize;
+		n = first;
+	} else {
+		const quint64 block = first / IndexBlockSize;
+		p = map_ + read_value<quint64>(block_entry(block));
+		n = block * IndexBlockSize;
+	}
+
+	const uchar *const end = map_ + size_;
+
+	while(n < last && p + RecordSize <= end) {
+		Step step;
+		step.ip          = read_value<quint64>(p);
+		step.delta_count = p[sizeof(quint64)];
+		step.deltas      = p + RecordSize;
+
+		const qint64 size = RecordSize + step.delta_count * DeltaSize;
+		if(p + size > end) {
+			break;
+		}
+
+		if(n >= first && !f(n, step)) {
+			return;
+		}
+
+		p += size;
+		++n;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+bool TraceFile::step(quint64 n, Step *step) const {
+
+	Q_ASSERT(step);
+
+	bool found = false;
+	walk(n, n + 1, [&](quint64, const Step &s) {
+		*step = s;
+		found = true;
+		return false;
+	});
+
+	return found;
+}
+
+//------------------------------------------------------------------------------
+// Name: registers_at
+// Desc: the registers at step <n>, in the order of registers(), starting from
+//       what the index kept for its block
+//------------------------------------------------------------------------------
+QVector<quint64> TraceFile::registers_at(quint64 n) const {
+
+	if(!index_ || registers_.isEmpty() || n >= index_->steps) {
+		return QVector<quint64>();
+	}
+
+	const quint64 block = n / IndexBlockSize;
+	const uchar *entry = block_entry(block) + sizeof(quint64);
+
+	QVector<quint64> values(registers_.size());
+	for(int i = 0; i < values.size(); ++i) {
+		values[i] = read_value<quint64>(entry + i * sizeof(quint64));
+	}
+
+	walk(block * IndexBlockSize, n + 1, [&values](quint64, const Step &step) {
+		for(int i = 0; i < step.delta_count; ++i) {
+			const uchar *delta = step.deltas + i * DeltaSize;
+			if(delta[0] < values.size()) {
+				values[delta[0]] = read_value<quint64>(delta + 1);
+			}
+		}
+		return true;
+	});
+
+	return values;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_address
+// Desc:
+//------------------------------------------------------------------------------
+const IndexAddress *TraceFile::find_address(quint64 address) const {
+
+	if(!index_) {
+		return nullptr;
+	}
+
+	const IndexAddress *const first = addresses_;
+	const IndexAddress *const last  = addresses_ + index_->address_count;
+
+	const IndexAddress *it = std::lower_bound(first, last, address, [](const IndexAddress &entry, quint64 value) {
+		return entry.address < value;
+	});
+
+	return (it != last && it->address == address) ? it : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// Name: next_visit
+// Desc: the first step at or after <from> which is at <address>
+//------------------------------------------------------------------------------
+quint64 TraceFile::next_visit(quint64 address, quint64 from) const {
+
+	const IndexAddress *entry = find_address(address);
+	if(!entry) {
+		return NoStep;
+	}
+
+	const quint64 *const first = postings_ + entry->first_posting;
+	const quint64 *const last  = first + entry->postings;
+
+	for(const quint64 *it = std::lower_bound(first, last, from / IndexBlockSize); it != last; ++it) {
+		quint64 found = NoStep;
+		walk(qMax(from, *it * IndexBlockSize), (*it + 1) * IndexBlockSize, [&](quint64 n, const Step &step) {
+			if(step.ip == address) {
+				found = n;
+				return false;
+			}
+			return true;
+		});
+
+		if(found != NoStep) {
+			return found;
+		}
+	}
+
+	return NoStep;
+}
+
+//------------------------------------------------------------------------------
+// Name: previous_visit
+// Desc: the last step before <from> which is at <address>
+//------------------------------------------------------------------------------
+quint64 TraceFile::previous_visit(quint64 address, quint64 from) const {
+
+	const IndexAddress *entry = find_address(address);
+	if(!entry || from == 0) {
+		return NoStep;
+	}
+
+	const quint64 *const first = postings_ + entry->first_posting;
+	const quint64 *const last  = first + entry->postings;
+
+	for(const quint64 *it = std::upper_bound(first, last, (from - 1) / IndexBlockSize); it != first; ) {
+		--it;
+
+		quint64 found = NoStep;
+		walk(*it * IndexBlockSize, qMin(from, (*it + 1) * IndexBlockSize), [&](quint64 n, const Step &step) {
+			if(step.ip == address) {
+				found = n;
+			}
+			return true;
+		});
+
+		if(found != NoStep) {
+			return found;
+		}
+	}
+
+	return NoStep;
+}
+
+//------------------------------------------------------------------------------
+// Name: coverage
+// Desc: every address which was visited, the most visited ones hottest on a
+//       log scale
+//------------------------------------------------------------------------------
+QVector<HeatRange> TraceFile::coverage() const {
+
+	QVector<HeatRange> ranges;
+	if(!index_) {
+		return ranges;
+	}
+
+	quint64 most = 1;
+	for(quint64 i = 0; i < index_->address_count; ++i) {
+		most = qMax(most, addresses_[i].visits);
+	}
+
+	const double scale = (most > 1) ? 254.0 / std::log(static_cast<double>(most)) : 0.0;
+
+	ranges.reserve(static_cast<int>(qMin<quint64>(index_->address_count, INT_MAX)));
+	for(quint64 i = 0; i < index_->address_count && ranges.size() < INT_MAX; ++i) {
+		const edb::address_t address = edb::address_t::fromZeroExtended(addresses_[i].address);
+		const int heat = 1 + static_cast<int>(std::log(static_cast<double>(addresses_[i].visits)) * scale);
+		ranges.push_back({ address, address, static_cast<quint8>(qMin(heat, 255)) });
+	}
+
+	return ranges;
+}
+
+}
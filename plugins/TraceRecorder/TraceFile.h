@@ -0,0 +1,107 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TRACE_FILE_20171014_H_
+#define TRACE_FILE_20171014_H_
+
+#include "HeatRange.h"
+#include "TraceIndex.h"
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+namespace TraceRecorderPlugin {
+
+// A trace written by IDebugger::record_trace or a hardware branch trace,
+// see TraceRequest.h for the format. The file is memory mapped, so opening
+// even a huge one costs nothing until steps are read. Traces without
+// registers have fixed size records and can be read straight away, other
+// ones (and finding visits) need the index, see TraceIndexer
+class TraceFile {
+public:
+	struct Step {
+		quint64       ip;
+		const uchar  *deltas;      // delta_count times quint8 index, quint64 value (unaligned)
+		int           delta_count;
+	};
+
+	static const quint64 NoStep = ~0ull;
+
+public:
+	TraceFile() = default;
+	~TraceFile();
+
+private:
+	Q_DISABLE_COPY(TraceFile)
+
+public:
+	bool open(const QString &filename);
+	bool open_index();
+	void close();
+
+public:
+	QString filename() const       { return file_.fileName(); }
+	QString index_filename() const { return file_.fileName() + QLatin1String(".idx"); }
+	QString error_string() const   { return error_; }
+	bool is_open() const           { return map_ != nullptr; }
+	bool indexed() const           { return index_ != nullptr; }
+
+public:
+	const uchar *data() const    { return map_; }
+	qint64 size() const          { return size_; }
+	qint64 data_offset() const   { return data_offset_; }
+	qint64 modified() const;
+	quint32 pointer_size() const { return pointer_size_; }
+	quint32 tid() const          { return tid_; }
+	const QVector<QString> &registers() const { return registers_; }
+
+public:
+	quint64 steps() const;
+	bool step(quint64 n, Step *step) const;
+	QVector<quint64> registers_at(quint64 n) const;
+	quint64 next_visit(quint64 address, quint64 from) const;
+	quint64 previous_visit(quint64 address, quint64 from) const;
+	QVector<HeatRange> coverage() const;
+	void walk(quint64 first, quint64 last, const std::function<bool(quint64, const Step &)> &f) const;
+
+private:
+	bool parse_header();
+	const IndexAddress *find_address(quint64 address) const;
+	const uchar *block_entry(quint64 block) const;
+
+private:
+	QFile               file_;
+	QFile               index_file_;
+	uchar              *map_           = nullptr;
+	uchar              *index_map_     = nullptr;
+	const IndexHeader  *index_         = nullptr;
+	const IndexAddress *addresses_     = nullptr;
+	const quint64      *postings_      = nullptr;
+	qint64              size_          = 0;
+	qint64              data_offset_   = 0;
+	quint32             pointer_size_  = 0;
+	quint32             tid_           = 0;
+	QVector<QString>    registers_;
+	QString             error_;
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TRACE_INDEX_20171014_H_
+#define TRACE_INDEX_20171014_H_
+
+#include <QtGlobal>
+
+namespace TraceRecorderPlugin {
+
+// The index of a trace file, kept next to it as <trace>.idx so that a trace
+// is only ever read from start to end once (all fields native endian):
+//
+//   IndexHeader
+//   block_count times:   quint64 offset of the first step of the block,
+//                        then register_count times quint64, the registers
+//                        as they were before that step
+//   address_count times: IndexAddress, sorted by address
+//   posting_count times: quint64 block number, each address's are sorted
+//
+// A block is IndexBlockSize steps, so finding any step takes walking at most
+// that many records, and finding the next visit of an address a binary
+// search for the address and one for the block.
+
+const char    IndexMagic[8]  = { 'E', 'D', 'B', 'T', 'I', 'D', 'X', '1' };
+const quint32 IndexBlockSize = 256;
+
+struct IndexHeader {
+	char    magic[8];
+	quint64 trace_size;
+	qint64  trace_modified; // ms since the epoch, a changed trace isn't indexed by this any more
+	quint64 steps;
+	quint64 block_count;
+	quint64 address_count;
+	quint64 posting_count;
+	quint32 block_size;
+	quint32 register_count;
+};
+
+struct IndexAddress {
+	quint64 address;
+	quint64 visits;
+	quint64 first_posting;
+	quint64 postings;
+};
+
+}
+
+#endif
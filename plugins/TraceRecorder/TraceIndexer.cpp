@@ -0,0 +1,225 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TraceIndexer.h"
+#include "TraceFile.h"
+#include "TraceIndex.h"
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+namespace TraceRecorderPlugin {
+
+namespace {
+
+const qint64 RecordSize = sizeof(quint64) + 1;
+const qint64 DeltaSize  = 1 + sizeof(quint64);
+
+// how much of the index is buffered before it is written out
+const int FlushSize = 1 << 20;
+
+// progress is reported (and cancelling noticed) every this many blocks
+const quint64 ProgressBlocks = 0x400;
+
+struct Visits {
+	quint64          count = 0;
+	QVector<quint64> blocks;
+};
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceIndexer
+// Desc:
+//------------------------------------------------------------------------------
+TraceIndexer::TraceIndexer(const TraceFile &trace, QObject *parent) : QThread(parent), trace_(trace), cancelled_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceIndexer
+// Desc:
+//------------------------------------------------------------------------------
+TraceIndexer::~TraceIndexer() {
+	cancel();
+	wait();
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc:
+//------------------------------------------------------------------------------
+void TraceIndexer::run() {
+	succeeded_ = index();
+}
+
+//------------------------------------------------------------------------------
+// Name: index
+// Desc: the index is written to a temporary file first, so that one which is
+//       only half done is never mistaken for a good one
+//------------------------------------------------------------------------------
+bool TraceIndexer::index() {
+
+	const QString filename = trace_.index_filename();
+
+	QFile file(filename + QLatin1String(".tmp"));
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		error_ = file.errorString();
+		return false;
+	}
+
+	QByteArray buffer;
+
+	auto flush = [&]() {
+		if(file.write(buffer) != buffer.size()) {
+			error_ = file.errorString();
+			return false;
+		}
+		buffer.clear();
+		return true;
+	};
+
+	auto fail = [&]() {
+		file.close();
+		file.remove();
+		return false;
+	};
+
+	IndexHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+	header.trace_size     = trace_.size();
+	header.trace_modified = trace_.modified();
+	header.block_size     = IndexBlockSize;
+	header.register_count = trace_.registers().size();
+
+	// the counts are filled in once they are known
+	buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	QHash<quint64, Visits> visits;
+	QVector<quint64> values(trace_.registers().size());
+
+	const uchar *const data = trace_.data();
+	const uchar *const end  = data + trace_.size();
+	const uchar *p          = data + trace_.data_offset();
+
+	int percent = -1;
+
+	while(p + RecordSize <= end) {
+		const quint8 count = p[sizeof(quint64)];
+		const qint64 size  = RecordSize + count * DeltaSize;
+		if(p + size > end) {
+			break;
+		}
+
+		const quint64 block = header.steps / IndexBlockSize;
+		if(header.steps % IndexBlockSize == 0) {
+			const quint64 offset = p - data;
+			buffer.append(reinterpret_cast<const char *>(&offset), sizeof(offset));
+			buffer.append(reinterpret_cast<const char *>(values.constData()), values.size() * sizeof(quint64));
+			++header.block_count;
+
+			if(buffer.size() >= FlushSize && !flush()) {
+				return fail();
+			}
+
+			if((header.block_count % ProgressBlocks) == 0) {
+				if(cancelled_.fetchAndAddRelaxed(0)) {
+					return fail();
+				}
+
+				const int now = static_cast<int>((p - data) * 100 / trace_.size());
+				if(now != percent) {
+					percent = now;
+					Q_EMIT progress(percent);
+				}
+			}
+		}
+
+		for(int i = 0; i < count; ++i) {
+			const uchar *delta = p + RecordSize + i * DeltaSize;
+			if(delta[0] < values.size()) {
+				std::memcpy(&values[delta[0]], delta + 1, sizeof(quint64));
+			}
+		}
+
+		quint64 ip;
+		std::memcpy(&ip, p, sizeof(ip));
+
+		Visits &entry = visits[ip];
+		++entry.count;
+		if(entry.blocks.isEmpty() || entry.blocks.last() != block) {
+			entry.blocks.push_back(block);
+		}
+
+		p += size;
+		++header.steps;
+	}
+
+	QList<quint64> addresses = visits.keys();
+	std::sort(addresses.begin(), addresses.end());
+
+	for(quint64 address : addresses) {
+		const Visits &entry = visits[address];
+
+		const IndexAddress record = { address, entry.count, header.posting_count, static_cast<quint64>(entry.blocks.size()) };
+		buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
+		header.posting_count += entry.blocks.size();
+		++header.address_count;
+
+		if(buffer.size() >= FlushSize && !flush()) {
+			return fail();
+		}
+	}
+
+	for(quint64 address : addresses) {
+		const Visits &entry = visits[address];
+		buffer.append(reinterpret_cast<const char *>(entry.blocks.constData()), entry.blocks.size() * sizeof(quint64));
+
+		if(buffer.size() >= FlushSize && !flush()) {
+			return fail();
+		}
+	}
+
+	if(!flush()) {
+		return fail();
+	}
+
+	if(!file.seek(0) || file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)) {
+		error_ = file.errorString();
+		return fail();
+	}
+
+	file.close();
+
+	QFile::remove(filename);
+	if(!file.rename(filename)) {
+		error_ = file.errorString();
+		file.remove();
+		return false;
+	}
+
+	Q_EMIT progress(100);
+	return true;
+}
+
+}
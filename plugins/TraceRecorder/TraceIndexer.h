@@ -0,0 +1,63 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TRACE_INDEXER_20171014_H_
+#define TRACE_INDEXER_20171014_H_
+
+#include <QAtomicInt>
+#include <QString>
+#include <QThread>
+
+namespace TraceRecorderPlugin {
+
+class TraceFile;
+
+// reads a trace from start to end once, in the background, and writes its
+// index, see TraceIndex.h. The trace must stay open until this has finished
+class TraceIndexer : public QThread {
+	Q_OBJECT
+
+public:
+	TraceIndexer(const TraceFile &trace, QObject *parent = 0);
+	virtual ~TraceIndexer() override;
+
+public:
+	void cancel() { cancelled_.fetchAndStoreOrdered(1); }
+	bool succeeded() const       { return succeeded_; }
+	QString error_string() const { return error_; }
+
+Q_SIGNALS:
+	void progress(int percent);
+
+protected:
+	virtual void run() override;
+
+private:
+	bool index();
+
+private:
+	const TraceFile &trace_;
+	QAtomicInt       cancelled_;
+	bool             succeeded_ = false;
+	QString          error_;
+};
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "TraceRecorder.h"
+#include "BranchTrace.h"
+#include "BranchTraceDecoder.h"
+#include "DialogTraceRecorder.h"
+#include "IAnalyzer.h"
+#include "IDebugger.h"
+#include "TraceViewer.h"
+#include "edb.h"
+#include <QDockWidget>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMainWindow>
+#include <QMenu>
+#include <QMessageBox>
+#include <limits>
+
+namespace TraceRecorderPlugin {
+
+namespace {
+
+// one sample every this many branches, each sample holds the last 16 or 32
+// of them depending on the CPU
+const int DefaultSamplePeriod = 10000;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+TraceRecorder::TraceRecorder() : menu_(0), dialog_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+TraceRecorder::~TraceRecorder() {
+	delete dialog_;
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *TraceRecorder::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		menu_ = new QMenu(tr("TraceRecorder"), parent);
+		menu_->addAction(tr("&Record Instruction Trace"), this, SLOT(show_menu()));
+		menu_->addSeparator();
+		menu_->addAction(tr("Start &Hardware Branch Trace"), this, SLOT(start_branch_trace()));
+		menu_->addAction(tr("Stop Hardware Branch Trace"), this, SLOT(stop_branch_trace()));
+
+		if(auto main_window = qobject_cast<QMainWindow *>(edb::v1::debugger_ui)) {
+			auto viewer = new TraceViewer;
+
+			// the name is what gets its state saved with the GUI's
+			auto dock_widget = new QDockWidget(tr("Trace Viewer"), main_window);
+			dock_widget->setObjectName(QString::fromUtf8("TraceViewer"));
+			dock_widget->setWidget(viewer);
+
+			main_window->addDockWidget(Qt::BottomDockWidgetArea, dock_widget);
+			dock_widget->hide();
+
+			menu_->addSeparator();
+			menu_->addAction(dock_widget->toggleViewAction());
+		}
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: show_menu
+// Desc:
+//------------------------------------------------------------------------------
+void TraceRecorder::show_menu() {
+
+	if(!dialog_) {
+		dialog_ = new DialogTraceRecorder(edb::v1::debugger_ui);
+	}
+
+	dialog_->show();
+}
+
+//------------------------------------------------------------------------------
+// Name: start_branch_trace
+// Desc: the trace keeps recording while the process runs, until stopped
+//------------------------------------------------------------------------------
+void TraceRecorder::start_branch_trace() {
+
+	bool ok;
+	const int period = QInputDialog::getInt(
+		edb::v1::debugger_ui,
+		tr("Hardware Branch Trace"),
+		tr("Sample the branch history every N branches:"),
+		DefaultSamplePeriod,
+		1,
+		std::numeric_limits<int>::max(),
+		1,
+		&ok);
+
+	if(!ok) {
+		return;
+	}
+
+	const Status status = edb::v1::debugger_core->start_branch_trace(period);
+	if(!status) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Hardware Branch Trace"), tr("Failed to start the trace: %1").arg(status.toString()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_branch_trace
+// Desc: decodes what was recorded, optionally saves it as a trace file, and
+//       hands the call targets to the analyzer
+//------------------------------------------------------------------------------
+void TraceRecorder::stop_branch_trace() {
+
+	BranchTrace trace;
+	const Status status = edb::v1::debugger_core->stop_branch_trace(&trace);
+	if(!status) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Hardware Branch Trace"), tr("Failed to stop the trace: %1").arg(status.toString()));
+		return;
+	}
+
+	const QString filename = QFileDialog::getSaveFileName(edb::v1::debugger_ui, tr("Save Branch Trace (cancel to only analyze it)"));
+
+	BranchTraceDecoder decoder;
+	if(!decoder.decode(trace, filename)) {
+		QMessageBox::critical(edb::v1::debugger_ui, tr("Hardware Branch Trace"), tr("Failed to write the trace: %1").arg(decoder.error_string()));
+		return;
+	}
+
+	if(IAnalyzer *analyzer = edb::v1::analyzer()) {
+		analyzer->add_traced_functions(decoder.call_targets());
+	}
+
+	QMessageBox::information(
+		edb::v1::debugger_ui,
+		tr("Hardware Branch Trace"),
+		tr("Samples: %1 (%2 lost)\nInstructions decoded: %3 in %4 runs\nRuns which did not match the code: %5\nCalled functions found: %6")
+			.arg(trace.samples.size())
+			.arg(trace.lost)
+			.arg(decoder.instructions())
+			.arg(decoder.runs())
+			.arg(decoder.undecodable())
+			.arg(decoder.call_targets().size()));
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(TraceRecorder, TraceRecorder)
+#endif
+
+}
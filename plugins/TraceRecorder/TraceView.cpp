@@ -0,0 +1,296 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TraceView.h"
+#include "Configuration.h"
+#include "IDebugger.h"
+#include "Instruction.h"
+#include "TraceFile.h"
+#include "edb.h"
+#include <QFontMetrics>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <climits>
+#include <cstring>
+
+namespace TraceRecorderPlugin {
+
+namespace {
+
+// how wide the disassembly column is, in characters
+const int InstructionColumn = 48;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceView
+// Desc:
+//------------------------------------------------------------------------------
+TraceView::TraceView(QWidget *parent) : QAbstractScrollArea(parent) {
+
+	QFont font;
+	if(font.fromString(edb::v1::config().disassembly_font)) {
+		setFont(font);
+	}
+
+	setFocusPolicy(Qt::StrongFocus);
+	connect(verticalScrollBar(), SIGNAL(valueChanged(int)), viewport(), SLOT(update()));
+}
+
+//------------------------------------------------------------------------------
+// Name: set_trace
+// Desc:
+//------------------------------------------------------------------------------
+void TraceView::set_trace(const TraceFile *trace) {
+	trace_    = trace;
+	selected_ = 0;
+	verticalScrollBar()->setValue(0);
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh
+// Desc: for when the number of steps is known, once the trace is indexed
+//------------------------------------------------------------------------------
+void TraceView::refresh() {
+	update_scrollbar();
+	viewport()->update();
+}
+
+//------------------------------------------------------------------------------
+// Name: line_height
+// Desc:
+//------------------------------------------------------------------------------
+int TraceView::line_height() const {
+	return fontMetrics().lineSpacing() + 1;
+}
+
+//------------------------------------------------------------------------------
+// Name: visible_lines
+// Desc: the lines which fit completely
+//------------------------------------------------------------------------------
+int TraceView::visible_lines() const {
+	return qMax(1, viewport()->height() / line_height());
+}
+
+//------------------------------------------------------------------------------
+// Name: first_step
+// Desc:
+//------------------------------------------------------------------------------
+quint64 TraceView::first_step() const {
+	return static_cast<quint64>(verticalScrollBar()->value()) * scale_;
+}
+
+//------------------------------------------------------------------------------
+// Name: update_scrollbar
+// Desc:
+//------------------------------------------------------------------------------
+void TraceView::update_scrollbar() {
+
+	steps_ = trace_ ? trace_->steps() : 0;
+
+	const quint64 lines   = visible_lines();
+	const quint64 maximum = (steps_ > lines) ? steps_ - lines : 0;
+
+	scale_ = maximum / INT_MAX + 1;
+	verticalScrollBar()->setRange(0, static_cast<int>(maximum / scale_));
+	verticalScrollBar()->setPageStep(static_cast<int>(qMax<quint64>(1, lines / scale_)));
+	verticalScrollBar()->setSingleStep(1);
+}
+
+//------------------------------------------------------------------------------
+// Name: select_step
+// Desc: scrolls to the step if needed
+//------------------------------------------------------------------------------
+void TraceView::select_step(quint64 step) {
+
+	if(steps_ == 0) {
+		return;
+	}
+
+	selected_ = qMin(step, steps_ - 1);
+
+	const quint64 first = first_step();
+	const quint64 lines = visible_lines();
+
+	if(selected_ < first) {
+		verticalScrollBar()->setValue(static_cast<int>(selected_ / scale_));
+	} else if(selected_ >= first + lines) {
+		verticalScrollBar()->setValue(static_cast<int>((selected_ - lines + 1) / scale_));
+	}
+
+	viewport()->update();
+	Q_EMIT stepSelected(selected_);
+}
+
+//------------------------------------------------------------------------------
+// Name: disassemble
+// Desc: a trace has no code in it, so this is only possible while the
+//       process it came from (or one with the same code) is being debugged
+//------------------------------------------------------------------------------
+QString TraceView::disassemble(quint64 ip) const {
+
+	const edb::address_t address = edb::address_t::fromZeroExtended(ip);
+
+	QString text;
+	if(edb::v1::debugger_core && edb::v1::debugger_core->process()) {
+		quint8 buffer[edb::Instruction::MAX_SIZE];
+		if(const int size = edb::v1::get_instruction_bytes(address, buffer)) {
+			const auto inst = edb::decode(buffer, buffer + size, address);
+			if(inst->valid()) {
+				text = QString::fromStdString(edb::v1::formatter().to_string(*inst));
+			}
+		}
+	}
+
+	const QString symbol = edb::v1::find_function_symbol(address);
+	if(!symbol.isEmpty()) {
+		text = QString("%1 <%2>").arg(text.leftJustified(InstructionColumn / 2), symbol);
+	}
+
+	return text;
+}
+
+//------------------------------------------------------------------------------
+// Name: paintEvent
+// Desc: step, address, instruction and the registers it changed
+//------------------------------------------------------------------------------
+void TraceView::paintEvent(QPaintEvent *event) {
+
+	Q_UNUSED(event);
+
+	QPainter painter(viewport());
+
+	if(!trace_ || steps_ == 0) {
+		return;
+	}
+
+	const QFontMetrics metrics(font());
+	const int height = line_height();
+	const int width  = metrics.width('X');
+
+	const int step_x        = width / 2;
+	const int address_x     = step_x + (QString::number(steps_ - 1).size() + 2) * width;
+	const int instruction_x = address_x + (static_cast<int>(trace_->pointer_size()) * 2 + 2) * width;
+	const int registers_x   = instruction_x + (InstructionColumn + 2) * width;
+
+	const QVector<QString> &registers = trace_->registers();
+	const quint64 first = first_step();
+
+	trace_->walk(first, first + visible_lines() + 1, [&](quint64 n, const TraceFile::Step &step) {
+
+		const int y = static_cast<int>(n - first) * height;
+
+		if(n == selected_) {
+			painter.fillRect(0, y, viewport()->width(), height, palette().color(QPalette::Highlight));
+			painter.setPen(palette().color(QPalette::HighlightedText));
+		} else {
+			painter.setPen(palette().color(QPalette::Text));
+		}
+
+		const int baseline = y + metrics.ascent();
+		painter.drawText(step_x, baseline, QString::number(n));
+		painter.drawText(address_x, baseline, QString("%1").arg(step.ip, trace_->pointer_size() * 2, 16, QChar('0')));
+		painter.drawText(instruction_x, baseline, disassemble(step.ip));
+
+		QStringList changes;
+		for(int i = 0; i < step.delta_count; ++i) {
+			const uchar *delta = step.deltas + i * (1 + sizeof(quint64));
+
+			quint64 value;
+			std::memcpy(&value, delta + 1, sizeof(value));
+
+			const QString name = (delta[0] < registers.size()) ? registers[delta[0]] : QString::number(delta[0]);
+			changes << QString("%1=%2").arg(name).arg(value, 0, 16);
+		}
+
+		if(!changes.isEmpty()) {
+			painter.drawText(registers_x, baseline, changes.join(" "));
+		}
+
+		return true;
+	});
+}
+
+//------------------------------------------------------------------------------
+// Name: resizeEvent
+// Desc:
+//------------------------------------------------------------------------------
+void TraceView::resizeEvent(QResizeEvent *event) {
+	QAbstractScrollArea::resizeEvent(event);
+	update_scrollbar();
+}
+
+//------------------------------------------------------------------------------
+// Name: mousePressEvent
+// Desc:
+//------------------------------------------------------------------------------
+void TraceView::mousePressEvent(QMouseEvent *event) {
+
+	if(event->button() != Qt::LeftButton) {
+		return;
+	}
+
+	const quint64 step = first_step() + event->y() / line_height();
+	if(step < steps_) {
+		select_step(step);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: keyPressEvent
+// Desc:
+//------------------------------------------------------------------------------
+void TraceView::keyPressEvent(QKeyEvent *event) {
+
+	if(steps_ == 0) {
+		QAbstractScrollArea::keyPressEvent(event);
+		return;
+	}
+
+	const quint64 page = visible_lines();
+
+	switch(event->key()) {
+	case Qt::Key_Up:
+		select_step(selected_ > 0 ? selected_ - 1 : 0);
+		break;
+	case Qt::Key_Down:
+		select_step(selected_ + 1);
+		break;
+	case Qt::Key_PageUp:
+		select_step(selected_ > page ? selected_ - page : 0);
+		break;
+	case Qt::Key_PageDown:
+		select_step(selected_ + page);
+		break;
+	case Qt::Key_Home:
+		select_step(0);
+		break;
+	case Qt::Key_End:
+		select_step(steps_ - 1);
+		break;
+	default:
+		QAbstractScrollArea::keyPressEvent(event);
+		break;
+	}
+}
+
+}
@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TRACE_VIEW_20171014_H_
+#define TRACE_VIEW_20171014_H_
+
+#include <QAbstractScrollArea>
+
+namespace TraceRecorderPlugin {
+
+class TraceFile;
+
+// one line per step of a trace, only the lines on screen are ever read from
+// the trace or disassembled
+class TraceView : public QAbstractScrollArea {
+	Q_OBJECT
+
+public:
+	explicit TraceView(QWidget *parent = 0);
+	virtual ~TraceView() override = default;
+
+public:
+	void set_trace(const TraceFile *trace);
+	void refresh();
+	quint64 selected_step() const { return selected_; }
+	void select_step(quint64 step);
+
+Q_SIGNALS:
+	void stepSelected(quint64 step);
+
+protected:
+	virtual void paintEvent(QPaintEvent *event) override;
+	virtual void resizeEvent(QResizeEvent *event) override;
+	virtual void mousePressEvent(QMouseEvent *event) override;
+	virtual void keyPressEvent(QKeyEvent *event) override;
+
+private:
+	int line_height() const;
+	int visible_lines() const;
+	quint64 first_step() const;
+	void update_scrollbar();
+	QString disassemble(quint64 ip) const;
+
+private:
+	const TraceFile *trace_    = nullptr;
+	quint64          steps_    = 0;
+	quint64          selected_ = 0;
+	quint64          scale_    = 1; // steps per scrollbar unit, a scrollbar only counts to INT_MAX
+};
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TraceViewer.h"
+#include "IDebugger.h"
+#include "TraceIndexer.h"
+#include "edb.h"
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QStringList>
+
+#include "ui_TraceViewer.h"
+
+namespace TraceRecorderPlugin {
+
+//------------------------------------------------------------------------------
+// Name: TraceViewer
+// Desc:
+//------------------------------------------------------------------------------
+TraceViewer::TraceViewer(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), ui(new Ui::TraceViewer), indexer_(nullptr) {
+	ui->setupUi(this);
+	connect(ui->view, SIGNAL(stepSelected(quint64)), this, SLOT(step_selected(quint64)));
+	update_buttons();
+	update_status();
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceViewer
+// Desc:
+//------------------------------------------------------------------------------
+TraceViewer::~TraceViewer() {
+	stop_indexing();
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: open_trace
+// Desc: a trace with an up to date index is ready straight away, otherwise
+//       the index is built in the background, what can be done without it
+//       works in the meantime
+//------------------------------------------------------------------------------
+void TraceViewer::open_trace(const QString &filename) {
+
+	stop_indexing();
+	ui->chkCoverage->setChecked(false);
+	ui->view->set_trace(nullptr);
+	indexing_status_.clear();
+
+	if(!trace_.open(filename)) {
+		QMessageBox::critical(this, tr("Trace Viewer"), tr("Unable to open %1: %2").arg(filename, trace_.error_string()));
+		update_buttons();
+		update_status();
+		return;
+	}
+
+	if(!trace_.open_index()) {
+		indexer_ = new TraceIndexer(trace_, this);
+		connect(indexer_, SIGNAL(progress(int)), this, SLOT(indexing_progress(int)));
+		connect(indexer_, SIGNAL(finished()), this, SLOT(indexing_finished()));
+		indexing_status_ = tr("indexing...");
+		indexer_->start(QThread::LowPriority);
+	}
+
+	ui->view->set_trace(&trace_);
+	update_buttons();
+	update_status();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_indexing
+// Desc: the trace may only be closed once the indexer is done with it
+//------------------------------------------------------------------------------
+void TraceViewer::stop_indexing() {
+	if(indexer_) {
+		indexer_->cancel();
+		indexer_->wait();
+		delete indexer_;
+		indexer_ = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: indexing_progress
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::indexing_progress(int percent) {
+	if(sender() == indexer_) {
+		indexing_status_ = tr("indexing... %1%").arg(percent);
+		update_status();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: indexing_finished
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::indexing_finished() {
+
+	// an indexer we stopped may still have had this queued
+	if(!indexer_ || sender() != indexer_) {
+		return;
+	}
+
+	const bool succeeded = indexer_->succeeded();
+	const QString error  = indexer_->error_string();
+
+	indexer_->deleteLater();
+	indexer_ = nullptr;
+
+	if(succeeded && trace_.open_index()) {
+		indexing_status_.clear();
+		ui->view->refresh();
+	} else {
+		indexing_status_ = tr("not indexed: %1").arg(error);
+	}
+
+	update_buttons();
+	update_status();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_buttons
+// Desc: visits and coverage come from the index
+//------------------------------------------------------------------------------
+void TraceViewer::update_buttons() {
+	const bool stepping = trace_.steps() != 0;
+	ui->txtStep->setEnabled(stepping);
+	ui->btnGoto->setEnabled(stepping);
+	ui->btnPrevious->setEnabled(trace_.indexed());
+	ui->btnNext->setEnabled(trace_.indexed());
+	ui->chkCoverage->setEnabled(trace_.indexed());
+}
+
+//------------------------------------------------------------------------------
+// Name: update_status
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::update_status() {
+
+	QString status;
+	if(!trace_.is_open()) {
+		status = tr("No trace open");
+	} else if(trace_.steps() != 0) {
+		status = tr("Step %1 of %2").arg(ui->view->selected_step()).arg(trace_.steps());
+	}
+
+	if(!indexing_status_.isEmpty()) {
+		status = status.isEmpty() ? indexing_status_ : tr("%1, %2").arg(status, indexing_status_);
+	}
+
+	ui->lblStatus->setText(status);
+}
+
+//------------------------------------------------------------------------------
+// Name: step_selected
+// Desc: shows the step in the CPU view, and the registers as they were then
+//------------------------------------------------------------------------------
+void TraceViewer::step_selected(quint64 step) {
+
+	update_status();
+
+	TraceFile::Step record;
+	if(!trace_.step(step, &record)) {
+		return;
+	}
+
+	if(edb::v1::debugger_core && edb::v1::debugger_core->process()) {
+		edb::v1::jump_to_address(edb::address_t::fromZeroExtended(record.ip));
+	}
+
+	QStringList registers;
+	const QVector<quint64> values = trace_.registers_at(step);
+	for(int i = 0; i < values.size(); ++i) {
+		registers << QString("%1 = %2").arg(trace_.registers()[i]).arg(values[i], trace_.pointer_size() * 2, 16, QChar('0'));
+	}
+
+	ui->lblStatus->setToolTip(registers.join("\n"));
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnOpen_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::on_btnOpen_clicked() {
+	const QString filename = QFileDialog::getOpenFileName(this, tr("Open Trace"), trace_.filename());
+	if(!filename.isEmpty()) {
+		open_trace(filename);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnGoto_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::on_btnGoto_clicked() {
+
+	bool ok;
+	const quint64 step = ui->txtStep->text().toULongLong(&ok, 0);
+	if(!ok || step >= trace_.steps()) {
+		QMessageBox::critical(this, tr("Invalid Step"), tr("The step must be a number less than %1.").arg(trace_.steps()));
+		return;
+	}
+
+	ui->view->select_step(step);
+	ui->view->setFocus();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnPrevious_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::on_btnPrevious_clicked() {
+
+	TraceFile::Step record;
+	if(!trace_.step(ui->view->selected_step(), &record)) {
+		return;
+	}
+
+	const quint64 step = trace_.previous_visit(record.ip, ui->view->selected_step());
+	if(step == TraceFile::NoStep) {
+		ui->lblStatus->setText(tr("No earlier visit of %1").arg(record.ip, 0, 16));
+		return;
+	}
+
+	ui->view->select_step(step);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnNext_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::on_btnNext_clicked() {
+
+	TraceFile::Step record;
+	if(!trace_.step(ui->view->selected_step(), &record)) {
+		return;
+	}
+
+	const quint64 step = trace_.next_visit(record.ip, ui->view->selected_step() + 1);
+	if(step == TraceFile::NoStep) {
+		ui->lblStatus->setText(tr("No later visit of %1").arg(record.ip, 0, 16));
+		return;
+	}
+
+	ui->view->select_step(step);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_chkCoverage_toggled
+// Desc:
+//------------------------------------------------------------------------------
+void TraceViewer::on_chkCoverage_toggled(bool checked) {
+	edb::v1::set_code_heat(checked ? trace_.coverage() : QVector<HeatRange>());
+}
+
+}
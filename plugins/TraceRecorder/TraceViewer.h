@@ -0,0 +1,70 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TRACE_VIEWER_20171014_H_
+#define TRACE_VIEWER_20171014_H_
+
+#include "TraceFile.h"
+#include <QWidget>
+
+namespace TraceRecorderPlugin {
+
+namespace Ui { class TraceViewer; }
+
+class TraceIndexer;
+
+// browses a recorded trace, see TraceFile. Selecting a step shows its
+// address in the CPU view
+class TraceViewer : public QWidget {
+	Q_OBJECT
+
+public:
+	TraceViewer(QWidget *parent = 0, Qt::WindowFlags f = 0);
+	virtual ~TraceViewer() override;
+
+public:
+	void open_trace(const QString &filename);
+
+public Q_SLOTS:
+	void on_btnOpen_clicked();
+	void on_btnGoto_clicked();
+	void on_btnPrevious_clicked();
+	void on_btnNext_clicked();
+	void on_chkCoverage_toggled(bool checked);
+
+private Q_SLOTS:
+	void step_selected(quint64 step);
+	void indexing_progress(int percent);
+	void indexing_finished();
+
+private:
+	void update_buttons();
+	void update_status();
+	void stop_indexing();
+
+private:
+	Ui::TraceViewer *ui;
+	TraceFile        trace_;
+	TraceIndexer    *indexer_;
+	QString          indexing_status_;
+};
+
+}
+
+#endif
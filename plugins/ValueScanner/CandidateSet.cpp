@@ -0,0 +1,378 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "CandidateSet.h"
+#include "BytePattern.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "ReadRequest.h"
+#include "RegionSearch.h"
+#include "Util.h"
+#include "edb.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ValueScannerPlugin {
+
+namespace {
+
+// the most pages read into one buffer, and read at once
+const std::size_t MAX_RUN_PAGES   = 64;
+const std::size_t MAX_BATCH_BYTES = 0x400000;
+const int         MAX_BATCH_READS = 256;
+
+//------------------------------------------------------------------------------
+// Name: compare_as
+// Desc: -1, 0 or 1 as the <T> at <a> is less than, equal to or greater than
+//       the one at <b>. A NaN is neither
+//------------------------------------------------------------------------------
+template <class T>
+int compare_as(const quint8 *a, const quint8 *b) {
+	T x;
+	T y;
+	std::memcpy(&x, a, sizeof(T));
+	std::memcpy(&y, b, sizeof(T));
+	return (x < y) ? -1 : (y < x) ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: put_integer
+// Desc: the low <width> bytes of <n>, or false if it doesn't fit in them
+//       either as a signed or as an unsigned number
+//------------------------------------------------------------------------------
+bool put_integer(const QString &text, std::size_t width, QByteArray *value) {
+
+	bool ok;
+	qint64 n = text.toLongLong(&ok, 0);
+	if(!ok) {
+		n = static_cast<qint64>(text.toULongLong(&ok, 0));
+		if(!ok || width != sizeof(quint64)) {
+			return false;
+		}
+	}
+
+	if(width < sizeof(qint64)) {
+		const qint64 min = -(Q_INT64_C(1) << (width * 8 - 1));
+		const qint64 max = (Q_INT64_C(1) << (width * 8)) - 1;
+		if(n < min || n > max) {
+			return false;
+		}
+	}
+
+	*value = QByteArray(reinterpret_cast<const char *>(&n), width);
+	return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: CandidateSet
+// Desc:
+//------------------------------------------------------------------------------
+CandidateSet::CandidateSet() : type_(Int32), width_(sizeof(qint32)) {
+}
+
+//------------------------------------------------------------------------------
+// Name: encode
+// Desc: the bytes of <text> as a <type>, as they'd be in the debuggee's
+//       memory. Returns false if <text> isn't one
+//------------------------------------------------------------------------------
+bool CandidateSet::encode(Type type, const QString &text, QByteArray *value) {
+
+	Q_ASSERT(value);
+
+	bool ok = false;
+
+	switch(type) {
+	case Int8:
+		return put_integer(text, sizeof(qint8), value);
+	case Int16:
+		return put_integer(text, sizeof(qint16), value);
+	case Int32:
+		return put_integer(text, sizeof(qint32), value);
+	case Int64:
+		return put_integer(text, sizeof(qint64), value);
+	case Float:
+		{
+			const float f = text.toFloat(&ok);
+			*value = QByteArray(reinterpret_cast<const char *>(&f), sizeof(f));
+		}
+		return ok;
+	case Double:
+		{
+			const double d = text.toDouble(&ok);
+			*value = QByteArray(reinterpret_cast<const char *>(&d), sizeof(d));
+		}
+		return ok;
+	case String:
+		*value = text.toUtf8();
+		return !value->isEmpty();
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void CandidateSet::clear() {
+	addresses_.clear();
+	values_.clear();
+	addresses_.squeeze();
+	values_.squeeze();
+}
+
+//------------------------------------------------------------------------------
+// Name: scan
+// Desc: starts over with every place in <regions> which holds <value>. With
+//       <aligned>, numbers are only looked for at multiples of their size
+//------------------------------------------------------------------------------
+void CandidateSet::scan(Type type, const QByteArray &value, bool aligned, const QList<std::shared_ptr<IRegion>> &regions, const ProgressFunction &progress) {
+
+	Q_ASSERT(!value.isEmpty());
+
+	clear();
+
+	type_  = type;
+	width_ = value.size();
+
+	const BytePattern pattern(value);
+	const std::size_t width = width_;
+	const std::size_t align = (aligned && type != String) ? width_ : 1;
+
+	// the windows overlap by one byte less than the value, a match which
+	// starts in the last few bytes of one is found again in the next
+	const RegionSearch search([pattern, width, align](const RegionSearch::Window &window) {
+		QVector<SearchResult> results;
+
+		const quint8 *const data = window.data.constData();
+		const std::size_t size   = window.data.size();
+		const std::size_t tail   = window.continued ? std::min(size, width - 1) : 0;
+
+		const quint8 *const last_start = data + size - tail;
+
+		const quint8 *p = data;
+		while((p = pattern.find(p, data + size)) && p < last_start) {
+			const edb::address_t address = window.address + (p - data);
+			if(address % align == 0) {
+				results.push_back(SearchResult{address, QString(), 0, static_cast<quint32>(width)});
+			}
+			++p;
+		}
+
+		return results;
+	}, width_ - 1);
+
+	search.run(regions, [this](const QVector<SearchResult> &results) {
+		for(const SearchResult &result : results) {
+			addresses_.push_back(result.address);
+		}
+	}, progress);
+
+	std::sort(addresses_.begin(), addresses_.end());
+	addresses_.erase(std::unique(addresses_.begin(), addresses_.end()), addresses_.end());
+
+	values_.resize(addresses_.size() * width_);
+	for(int i = 0; i < addresses_.size(); ++i) {
+		std::memcpy(values_.data() + i * width_, value.constData(), width_);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: rescan
+// Desc: keeps the candidates which meet <condition> now. <value> is only used
+//       by Equal. <dirty_pages> is the sorted list of pages written to since
+//       the last scan, or null if that isn't known; the others still hold
+//       what they did and aren't read again
+//------------------------------------------------------------------------------
+void CandidateSet::rescan(Condition condition, const QByteArray &value, const QVector<edb::address_t> *dirty_pages, const ProgressFunction &progress) {
+
+	IProcess *process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		return;
+	}
+
+	const edb::address_t page_size = edb::v1::debugger_core->page_size();
+	const int count                = addresses_.size();
+
+	// a run of pages read into one part of the buffer, and the candidates on them
+	struct Run {
+		edb::address_t first;
+		std::size_t    size;
+		std::size_t    offset; // into the buffer, unused if clean
+		int            first_candidate;
+		int            last_candidate;
+		bool           clean;
+	};
+
+	QVector<edb::address_t> addresses;
+	QVector<quint8>         values;
+
+	int i = 0;
+	while(i < count) {
+
+		// put a batch of runs together
+		QVector<Run> runs;
+		std::size_t  batch_size = 0;
+		int          reads      = 0;
+
+		while(i < count && reads < MAX_BATCH_READS && batch_size < MAX_BATCH_BYTES) {
+			const edb::address_t first = addresses_[i] - addresses_[i] % page_size;
+			edb::address_t last        = addresses_[i] + width_;
+
+			int j = i + 1;
+			while(j < count && addresses_[j] < last + page_size && (last - first).toUint() < MAX_RUN_PAGES * page_size.toUint()) {
+				last = std::max(last, addresses_[j] + width_);
+				++j;
+			}
+
+			last += (page_size - last % page_size) % page_size;
+
+			bool clean = false;
+			if(dirty_pages) {
+				auto it = std::lower_bound(dirty_pages->begin(), dirty_pages->end(), first);
+				clean   = (it == dirty_pages->end() || *it >= last);
+			}
+
+			const Run run = { first, (last - first).toUint(), batch_size, i, j, clean };
+			runs.push_back(run);
+
+			if(!clean) {
+				batch_size += run.size;
+				++reads;
+			}
+
+			i = j;
+		}
+
+		QVector<quint8>      buffer(batch_size);
+		QVector<ReadRequest> requests;
+		for(const Run &run : runs) {
+			if(!run.clean) {
+				requests.push_back(ReadRequest{run.first, buffer.data() + run.offset, run.size});
+			}
+		}
+
+		const QVector<std::size_t> sizes = process->read_many(requests);
+
+		int request = 0;
+		for(const Run &run : runs) {
+			const std::size_t size = run.clean ? run.size : sizes[request++];
+
+			for(int k = run.first_candidate; k != run.last_candidate; ++k) {
+				const std::size_t offset = (addresses_[k] - run.first).toUint();
+				if(offset + width_ > size) {
+					continue;
+				}
+
+				const quint8 *const previous = values_.constData() + k * width_;
+				const quint8 *const current  = run.clean ? previous : buffer.constData() + run.offset + offset;
+
+				if(matches(condition, current, previous, value)) {
+					addresses.push_back(addresses_[k]);
+					for(std::size_t b = 0; b < width_; ++b) {
+						values.push_back(current[b]);
+					}
+				}
+			}
+		}
+
+		if(progress) {
+			progress(util::percentage(i, count));
+		}
+	}
+
+	addresses_ = addresses;
+	values_    = values;
+}
+
+//------------------------------------------------------------------------------
+// Name: matches
+// Desc: floating point values are equal when their bytes are, so a NaN which
+//       stays the same is unchanged
+//------------------------------------------------------------------------------
+bool CandidateSet::matches(Condition condition, const quint8 *current, const quint8 *previous, const QByteArray &value) const {
+
+	switch(condition) {
+	case Equal:
+		return static_cast<std::size_t>(value.size()) == width_ && std::memcmp(current, value.constData(), width_) == 0;
+	case Changed:
+		return std::memcmp(current, previous, width_) != 0;
+	case Unchanged:
+		return std::memcmp(current, previous, width_) == 0;
+	case Increased:
+	case Decreased:
+		break;
+	}
+
+	int order = 0;
+	switch(type_) {
+	case Int8:   order = compare_as<qint8>(current, previous);  break;
+	case Int16:  order = compare_as<qint16>(current, previous); break;
+	case Int32:  order = compare_as<qint32>(current, previous); break;
+	case Int64:  order = compare_as<qint64>(current, previous); break;
+	case Float:  order = compare_as<float>(current, previous);  break;
+	case Double: order = compare_as<double>(current, previous); break;
+	case String: return false;
+	}
+
+	return (condition == Increased) ? order > 0 : order < 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: has_candidates
+// Desc: true if any candidate is in [first, last)
+//------------------------------------------------------------------------------
+bool CandidateSet::has_candidates(edb::address_t first, edb::address_t last) const {
+	auto it = std::lower_bound(addresses_.begin(), addresses_.end(), first);
+	return it != addresses_.end() && *it < last;
+}
+
+//------------------------------------------------------------------------------
+// Name: text
+// Desc: the value the <n>th candidate had at the last scan
+//------------------------------------------------------------------------------
+QString CandidateSet::text(int n) const {
+
+	const quint8 *const p = values_.constData() + n * width_;
+
+	switch(type_) {
+	case Int8:
+		{ qint8 v;  std::memcpy(&v, p, sizeof(v)); return QString::number(v); }
+	case Int16:
+		{ qint16 v; std::memcpy(&v, p, sizeof(v)); return QString::number(v); }
+	case Int32:
+		{ qint32 v; std::memcpy(&v, p, sizeof(v)); return QString::number(v); }
+	case Int64:
+		{ qint64 v; std::memcpy(&v, p, sizeof(v)); return QString::number(v); }
+	case Float:
+		{ float v;  std::memcpy(&v, p, sizeof(v)); return QString::number(v); }
+	case Double:
+		{ double v; std::memcpy(&v, p, sizeof(v)); return QString::number(v, 'g', 17); }
+	case String:
+		return QString("\"%1\"").arg(QString::fromUtf8(reinterpret_cast<const char *>(p), width_));
+	}
+
+	return QString();
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CANDIDATE_SET_20170716_H_
+#define CANDIDATE_SET_20170716_H_
+
+#include "Types.h"
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class IRegion;
+
+namespace ValueScannerPlugin {
+
+// The addresses which still hold the value being looked for, each with the
+// value it had at the last scan, kept sorted in two flat arrays so that a
+// scan which matches millions of places costs little more than the address
+// and the value of each. A rescan reads only the pages which have candidates
+// on them, many at a time through IProcess::read_many, and skips even those
+// which the debugger core knows weren't written to since the last scan
+class CandidateSet {
+public:
+	enum Type {
+		Int8,
+		Int16,
+		Int32,
+		Int64,
+		Float,
+		Double,
+		String
+	};
+
+	enum Condition {
+		Equal,
+		Changed,
+		Unchanged,
+		Increased,
+		Decreased
+	};
+
+	typedef std::function<void(int)> ProgressFunction;
+
+public:
+	CandidateSet();
+
+public:
+	static bool encode(Type type, const QString &text, QByteArray *value);
+	static bool is_ordered(Type type) { return type != String; }
+
+public:
+	void scan(Type type, const QByteArray &value, bool aligned, const QList<std::shared_ptr<IRegion>> &regions, const ProgressFunction &progress = ProgressFunction());
+	void rescan(Condition condition, const QByteArray &value, const QVector<edb::address_t> *dirty_pages, const ProgressFunction &progress = ProgressFunction());
+	void clear();
+
+public:
+	bool has_candidates(edb::address_t first, edb::address_t last) const;
+	int size() const                        { return addresses_.size(); }
+	bool isEmpty() const                    { return addresses_.isEmpty(); }
+	Type type() const                       { return type_; }
+	std::size_t width() const               { return width_; }
+	edb::address_t address(int n) const     { return addresses_[n]; }
+	QString text(int n) const;
+
+private:
+	bool matches(Condition condition, const quint8 *current, const quint8 *previous, const QByteArray &value) const;
+
+private:
+	Type                    type_;
+	std::size_t             width_;
+	QVector<edb::address_t> addresses_;
+	QVector<quint8>         values_; // width_ bytes for each address
+};
+
+}
+
+#endif
@@ -0,0 +1,254 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "DialogValueScanner.h"
+#include "IDebugEvent.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "SearchResultModel.h"
+#include "SearchResultView.h"
+#include "edb.h"
+
+#include <QMessageBox>
+#include <QModelIndex>
+
+#include <algorithm>
+
+#include "ui_DialogValueScanner.h"
+
+namespace ValueScannerPlugin {
+
+namespace {
+
+// past this many the candidates are counted, but not listed
+const int MAX_SHOWN = 100000;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DialogValueScanner
+// Desc:
+//------------------------------------------------------------------------------
+DialogValueScanner::DialogValueScanner(QWidget *parent) : QDialog(parent), ui(new Ui::DialogValueScanner), pid_(0), events_since_scan_(0) {
+	ui->setupUi(this);
+
+	ui->comboType->addItem(tr("Int8"),   CandidateSet::Int8);
+	ui->comboType->addItem(tr("Int16"),  CandidateSet::Int16);
+	ui->comboType->addItem(tr("Int32"),  CandidateSet::Int32);
+	ui->comboType->addItem(tr("Int64"),  CandidateSet::Int64);
+	ui->comboType->addItem(tr("Float"),  CandidateSet::Float);
+	ui->comboType->addItem(tr("Double"), CandidateSet::Double);
+	ui->comboType->addItem(tr("String"), CandidateSet::String);
+	ui->comboType->setCurrentIndex(2);
+
+	ui->comboCondition->addItem(tr("Equal To The Value"), CandidateSet::Equal);
+	ui->comboCondition->addItem(tr("Changed"),            CandidateSet::Changed);
+	ui->comboCondition->addItem(tr("Unchanged"),          CandidateSet::Unchanged);
+	ui->comboCondition->addItem(tr("Increased"),          CandidateSet::Increased);
+	ui->comboCondition->addItem(tr("Decreased"),          CandidateSet::Decreased);
+
+	ui->listView->results()->setTextFunction([this](const SearchResult &result) {
+		return candidates_.text(result.tag);
+	});
+
+	ui->btnNextScan->setEnabled(false);
+
+	edb::v1::add_debug_event_handler(this);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogValueScanner
+// Desc:
+//------------------------------------------------------------------------------
+DialogValueScanner::~DialogValueScanner() {
+	edb::v1::remove_debug_event_handler(this);
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc: only counts the events, to know whether the soft-dirty bits still
+//       cover everything since the last scan
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS DialogValueScanner::handle_event(const std::shared_ptr<IDebugEvent> &event) {
+	Q_UNUSED(event);
+	++events_since_scan_;
+	return edb::DEBUG_NEXT_HANDLER;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_listView_doubleClicked
+// Desc: follows the candidate in the data view
+//------------------------------------------------------------------------------
+void DialogValueScanner::on_listView_doubleClicked(const QModelIndex &index) {
+	const edb::address_t addr = index.data(SearchResultModel::AddressRole).toULongLong();
+	edb::v1::dump_data(addr, false);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnNewScan_clicked
+// Desc: looks for the value in every writable region
+//------------------------------------------------------------------------------
+void DialogValueScanner::on_btnNewScan_clicked() {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return;
+	}
+
+	const auto type = static_cast<CandidateSet::Type>(ui->comboType->itemData(ui->comboType->currentIndex()).toInt());
+
+	QByteArray value;
+	if(!CandidateSet::encode(type, ui->txtValue->text(), &value)) {
+		QMessageBox::critical(this, tr("Invalid Value"), tr("The value to scan for is not a valid %1.").arg(ui->comboType->currentText()));
+		return;
+	}
+
+	edb::v1::memory_regions().sync();
+
+	QList<std::shared_ptr<IRegion>> regions;
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(region->readable() && region->writable()) {
+			regions.push_back(region);
+		}
+	}
+
+	ui->btnNewScan->setEnabled(false);
+	ui->progressBar->setValue(0);
+	ui->listView->results()->clear();
+
+	candidates_.scan(type, value, ui->chkAligned->isChecked(), regions, [this](int progress) {
+		ui->progressBar->setValue(progress);
+	});
+
+	pid_               = process->pid();
+	events_since_scan_ = 0;
+
+	ui->progressBar->setValue(100);
+	ui->btnNewScan->setEnabled(true);
+	show_candidates();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnNextScan_clicked
+// Desc: keeps the candidates which meet the condition now
+//------------------------------------------------------------------------------
+void DialogValueScanner::on_btnNextScan_clicked() {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process || process->pid() != pid_) {
+		QMessageBox::critical(this, tr("Scan Again"), tr("The candidates are from a process which is no longer being debugged, start a new scan."));
+		return;
+	}
+
+	const auto condition = static_cast<CandidateSet::Condition>(ui->comboCondition->itemData(ui->comboCondition->currentIndex()).toInt());
+
+	if((condition == CandidateSet::Increased || condition == CandidateSet::Decreased) && !CandidateSet::is_ordered(candidates_.type())) {
+		QMessageBox::critical(this, tr("Invalid Condition"), tr("Strings can't be compared for being greater or less."));
+		return;
+	}
+
+	QByteArray value;
+	if(condition == CandidateSet::Equal && !CandidateSet::encode(candidates_.type(), ui->txtValue->text(), &value)) {
+		QMessageBox::critical(this, tr("Invalid Value"), tr("The value to compare with is not valid for the type scanned for."));
+		return;
+	}
+
+	QVector<edb::address_t> pages;
+	const bool known = dirty_pages(&pages);
+
+	ui->btnNextScan->setEnabled(false);
+	ui->progressBar->setValue(0);
+	ui->listView->results()->clear();
+
+	candidates_.rescan(condition, value, known ? &pages : nullptr, [this](int progress) {
+		ui->progressBar->setValue(progress);
+	});
+
+	events_since_scan_ = 0;
+
+	ui->progressBar->setValue(100);
+	show_candidates();
+}
+
+//------------------------------------------------------------------------------
+// Name: dirty_pages
+// Desc: the sorted pages with candidates on them which may have been written
+//       to since the last scan. Returns false if that isn't known: the
+//       soft-dirty bits only cover the last run of the process, so with any
+//       other event in between they may not tell the whole story
+//------------------------------------------------------------------------------
+bool DialogValueScanner::dirty_pages(QVector<edb::address_t> *pages) const {
+
+	pages->clear();
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process || events_since_scan_ > 1) {
+		return false;
+	}
+
+	edb::v1::memory_regions().sync();
+
+	for(const std::shared_ptr<IRegion> &region : edb::v1::memory_regions().regions()) {
+		if(!candidates_.has_candidates(region->start(), region->end())) {
+			continue;
+		}
+
+		QVector<edb::address_t> region_pages;
+		if(!process->changed_pages(region, &region_pages)) {
+			return false;
+		}
+
+		*pages += region_pages;
+	}
+
+	std::sort(pages->begin(), pages->end());
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: show_candidates
+// Desc: the values are formatted by the view, only for the rows it shows
+//------------------------------------------------------------------------------
+void DialogValueScanner::show_candidates() {
+
+	const int count = candidates_.size();
+
+	QVector<SearchResult> results;
+	if(count <= MAX_SHOWN) {
+		results.reserve(count);
+		for(int i = 0; i < count; ++i) {
+			results.push_back(SearchResult{candidates_.address(i), QString(), i, static_cast<quint32>(candidates_.width())});
+		}
+	}
+
+	ui->listView->results()->append(results);
+
+	if(count <= MAX_SHOWN) {
+		ui->lblCount->setText(tr("%n Candidate(s)", "", count));
+	} else {
+		ui->lblCount->setText(tr("%n Candidate(s), Scan Again To List Them", "", count));
+	}
+
+	ui->btnNextScan->setEnabled(count != 0);
+}
+
+}
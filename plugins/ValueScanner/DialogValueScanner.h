@@ -0,0 +1,63 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DIALOG_VALUE_SCANNER_20170716_H_
+#define DIALOG_VALUE_SCANNER_20170716_H_
+
+#include "CandidateSet.h"
+#include "IDebugEventHandler.h"
+#include "Types.h"
+
+#include <QDialog>
+
+class QModelIndex;
+
+namespace ValueScannerPlugin {
+
+namespace Ui { class DialogValueScanner; }
+
+class DialogValueScanner : public QDialog, public IDebugEventHandler {
+	Q_OBJECT
+
+public:
+	DialogValueScanner(QWidget *parent = 0);
+	virtual ~DialogValueScanner() override;
+
+public:
+	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event) override;
+
+public Q_SLOTS:
+	void on_btnNewScan_clicked();
+	void on_btnNextScan_clicked();
+	void on_listView_doubleClicked(const QModelIndex &index);
+
+private:
+	bool dirty_pages(QVector<edb::address_t> *pages) const;
+	void show_candidates();
+
+private:
+	Ui::DialogValueScanner *const ui;
+	CandidateSet                  candidates_;
+	edb::pid_t                    pid_;
+	int                           events_since_scan_;
+};
+
+}
+
+#endif
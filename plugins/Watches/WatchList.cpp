@@ -0,0 +1,238 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WatchList.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "MemoryRegions.h"
+#include "ReadRequest.h"
+#include "State.h"
+#include "Symbol.h"
+#include "ISymbolManager.h"
+#include "edb.h"
+#include <QHash>
+#include <QSet>
+
+namespace WatchesPlugin {
+namespace {
+
+// a dereference can depend on another one ([[rsp]+8]), so each round of
+// reads can make more addresses known, past this many rounds whatever is
+// left is read one value at a time
+const int MAX_ROUNDS = 8;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: append
+// Desc:
+//------------------------------------------------------------------------------
+void WatchList::append(const QString &text) {
+	Watch watch;
+	watch.text = text;
+	watches_.push_back(watch);
+}
+
+//------------------------------------------------------------------------------
+// Name: replace
+// Desc: the new expression starts over, it has no previous value to compare
+//       against
+//------------------------------------------------------------------------------
+void WatchList::replace(int i, const QString &text) {
+	Watch watch;
+	watch.text = text;
+	watches_[i] = watch;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove
+// Desc:
+//------------------------------------------------------------------------------
+void WatchList::remove(int i) {
+	watches_.remove(i);
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void WatchList::clear() {
+	watches_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: reset
+// Desc: forgets the compiled expressions and their values, for when the
+//       process they were evaluated in is gone
+//------------------------------------------------------------------------------
+void WatchList::reset() {
+	for(Watch &watch : watches_) {
+		const QString text = watch.text;
+		watch = Watch();
+		watch.text = text;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: compile
+// Desc: parses the expressions which haven't been yet, symbols are resolved
+//       as part of that, so all of them are parsed again once modules were
+//       loaded or unloaded
+//------------------------------------------------------------------------------
+void WatchList::compile(const State &state) {
+
+	const quint64 generation = edb::v1::memory_regions().modules_generation();
+
+	auto resolver = [&state](const QString &name, edb::address_t *value) {
+		// registers take priority over symbols of the same name
+		if(state.value(name).valid()) {
+			return false;
+		}
+
+		if(const std::shared_ptr<Symbol> sym = edb::v1::symbol_manager().find(name)) {
+			*value = sym->address;
+			return true;
+		}
+
+		return false;
+	};
+
+	for(Watch &watch : watches_) {
+		if(!watch.expression || generation != generation_) {
+			watch.expression = std::make_shared<Expression<edb::address_t>>(watch.text, edb::v1::get_variable, edb::v1::get_value);
+
+			ExpressionError compile_error;
+			watch.expression->compile(resolver, &compile_error);
+		}
+	}
+
+	generation_ = generation;
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate
+// Desc: runs every expression against <state>. Rather than reading memory as
+//       each dereference is reached, a round runs all of them, noting every
+//       address not read yet, those are then read with a single vectored
+//       read and the expressions which were missing one run again. If
+//       <new_stop> is set, the values so far become the previous ones the
+//       new ones are compared against
+//------------------------------------------------------------------------------
+void WatchList::evaluate(const State &state, bool new_stop) {
+
+	compile(state);
+
+	if(new_stop) {
+		for(Watch &watch : watches_) {
+			watch.previous  = watch.value;
+			watch.was_valid = watch.valid;
+		}
+	}
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	const std::size_t size  = edb::v1::pointer_size();
+
+	QHash<edb::address_t, edb::address_t> memory;
+	QSet<edb::address_t>                  unreadable;
+	QSet<edb::address_t>                  requested;
+	QVector<edb::address_t>               wanted;
+	bool                                  missing = false;
+
+	const Expression<edb::address_t>::variable_getter_t state_variable = [&state](const QString &name, bool *ok, ExpressionError *err) {
+		return edb::v1::get_state_variable(state, name, ok, err);
+	};
+
+	const Expression<edb::address_t>::memory_reader_t batched_read = [&](edb::address_t address, bool *ok, ExpressionError *err) -> edb::address_t {
+		auto it = memory.find(address);
+		if(it != memory.end()) {
+			*ok = true;
+			return *it;
+		}
+
+		if(!unreadable.contains(address)) {
+			if(!requested.contains(address)) {
+				requested.insert(address);
+				wanted.push_back(address);
+			}
+			missing = true;
+		}
+
+		*ok  = false;
+		*err = ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
+		return 0;
+	};
+
+	const Expression<edb::address_t>::memory_reader_t direct_read = edb::v1::get_value;
+
+	QVector<int> pending;
+	pending.reserve(watches_.size());
+	for(int i = 0; i < watches_.size(); ++i) {
+		pending.push_back(i);
+	}
+
+	for(int round = 0; !pending.isEmpty(); ++round) {
+
+		const bool last_round = !process || round == MAX_ROUNDS;
+
+		QVector<int> next;
+		for(int i : pending) {
+			Watch &watch = watches_[i];
+
+			missing = false;
+			bool ok;
+			ExpressionError error;
+			const edb::address_t value = watch.expression->evaluate_expression(state_variable, last_round ? direct_read : batched_read, &ok, &error);
+
+			if(!ok && missing) {
+				next.push_back(i);
+				continue;
+			}
+
+			watch.valid   = ok;
+			watch.value   = ok ? value : edb::address_t(0);
+			watch.error   = error;
+			watch.changed = watch.valid && watch.was_valid && watch.value != watch.previous;
+		}
+
+		if(next.isEmpty()) {
+			break;
+		}
+
+		QVector<edb::address_t> buffers(wanted.size(), 0);
+		QVector<ReadRequest>    requests;
+		requests.reserve(wanted.size());
+		for(int j = 0; j < wanted.size(); ++j) {
+			requests.push_back(ReadRequest{wanted[j], &buffers[j], size});
+		}
+
+		const QVector<std::size_t> results = process->read_many(requests);
+		for(int j = 0; j < wanted.size(); ++j) {
+			if(results[j] == size) {
+				memory.insert(wanted[j], buffers[j]);
+			} else {
+				unreadable.insert(wanted[j]);
+			}
+		}
+
+		wanted.clear();
+		requested.clear();
+		pending = next;
+	}
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WATCH_LIST_20171014_H_
+#define WATCH_LIST_20171014_H_
+
+#include "Expression.h"
+#include "Types.h"
+#include <QString>
+#include <QVector>
+#include <memory>
+
+class State;
+
+namespace WatchesPlugin {
+
+// the expressions of the watch dock, each one is compiled once and every
+// evaluation of the whole list reads the memory they dereference together
+class WatchList {
+public:
+	struct Watch {
+		QString                                     text;
+		std::shared_ptr<Expression<edb::address_t>> expression;
+		ExpressionError                             error;
+		edb::address_t                              value     = 0;
+		edb::address_t                              previous  = 0; // as of the stop before this one
+		bool                                        valid     = false;
+		bool                                        was_valid = false;
+		bool                                        changed   = false;
+	};
+
+public:
+	int size() const             { return watches_.size(); }
+	const Watch &at(int i) const { return watches_[i]; }
+
+public:
+	void append(const QString &text);
+	void replace(int i, const QString &text);
+	void remove(int i);
+	void clear();
+	void reset();
+
+public:
+	void evaluate(const State &state, bool new_stop);
+
+private:
+	void compile(const State &state);
+
+private:
+	QVector<Watch> watches_;
+	quint64        generation_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,281 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WatchWidget.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "State.h"
+#include "edb.h"
+#include <QAction>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QMenu>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace WatchesPlugin {
+
+//------------------------------------------------------------------------------
+// Name: WatchWidget
+// Desc:
+//------------------------------------------------------------------------------
+WatchWidget::WatchWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f), table_(new QTableWidget(0, 2, this)) {
+
+	table_->setHorizontalHeaderLabels(QStringList() << tr("Expression") << tr("Value"));
+	table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table_->setContextMenuPolicy(Qt::CustomContextMenu);
+	table_->verticalHeader()->hide();
+	table_->horizontalHeader()->setStretchLastSection(true);
+
+	auto layout = new QVBoxLayout(this);
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->addWidget(table_);
+
+	connect(table_, SIGNAL(itemDoubleClicked(QTableWidgetItem *)), this, SLOT(item_double_clicked(QTableWidgetItem *)));
+	connect(table_, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(context_menu(const QPoint &)));
+
+	connect(edb::v1::debugger_ui, SIGNAL(debugEvent()), this, SLOT(stopped()));
+	connect(edb::v1::debugger_ui, SIGNAL(detachEvent()), this, SLOT(detached()));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~WatchWidget
+// Desc:
+//------------------------------------------------------------------------------
+WatchWidget::~WatchWidget() {
+}
+
+//------------------------------------------------------------------------------
+// Name: expressions
+// Desc:
+//------------------------------------------------------------------------------
+QStringList WatchWidget::expressions() const {
+	QStringList ret;
+	for(int i = 0; i < watches_.size(); ++i) {
+		ret << watches_.at(i).text;
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_expressions
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::set_expressions(const QStringList &expressions) {
+
+	watches_.clear();
+	table_->setRowCount(0);
+
+	for(const QString &text : expressions) {
+		append_row(text);
+	}
+
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: append_row
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::append_row(const QString &text) {
+
+	watches_.append(text);
+
+	const int row = table_->rowCount();
+	table_->insertRow(row);
+	table_->setItem(row, 0, new QTableWidgetItem(text));
+	table_->setItem(row, 1, new QTableWidgetItem);
+}
+
+//------------------------------------------------------------------------------
+// Name: add_watch
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::add_watch() {
+
+	bool ok;
+	const QString text = QInputDialog::getText(this, tr("Add Watch"), tr("Expression:"), QLineEdit::Normal, QString(), &ok);
+	if(ok && !text.trimmed().isEmpty()) {
+		append_row(text.trimmed());
+		refresh();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: edit_watch
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::edit_watch() {
+
+	const int row = table_->currentRow();
+	if(row < 0 || row >= watches_.size()) {
+		return;
+	}
+
+	bool ok;
+	const QString text = QInputDialog::getText(this, tr("Edit Watch"), tr("Expression:"), QLineEdit::Normal, watches_.at(row).text, &ok);
+	if(ok && !text.trimmed().isEmpty()) {
+		watches_.replace(row, text.trimmed());
+		table_->item(row, 0)->setText(text.trimmed());
+		refresh();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_watch
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::remove_watch() {
+
+	const int row = table_->currentRow();
+	if(row >= 0 && row < watches_.size()) {
+		watches_.remove(row);
+		table_->removeRow(row);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_all
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::remove_all() {
+	watches_.clear();
+	table_->setRowCount(0);
+}
+
+//------------------------------------------------------------------------------
+// Name: item_double_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::item_double_clicked(QTableWidgetItem *item) {
+	if(item) {
+		edit_watch();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: context_menu
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::context_menu(const QPoint &pos) {
+
+	QMenu menu;
+	menu.addAction(tr("&Add Watch..."), this, SLOT(add_watch()));
+
+	if(table_->itemAt(pos)) {
+		menu.addAction(tr("&Edit Watch..."), this, SLOT(edit_watch()));
+		menu.addAction(tr("&Remove Watch"), this, SLOT(remove_watch()));
+	}
+
+	if(watches_.size() != 0) {
+		menu.addSeparator();
+		menu.addAction(tr("Remove A&ll"), this, SLOT(remove_all()));
+	}
+
+	menu.exec(table_->viewport()->mapToGlobal(pos));
+}
+
+//------------------------------------------------------------------------------
+// Name: stopped
+// Desc: notes that the process stopped, the next evaluation compares against
+//       the values of the one before
+//------------------------------------------------------------------------------
+void WatchWidget::stopped() {
+	new_stop_ = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: detached
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::detached() {
+	watches_.reset();
+	new_stop_ = false;
+	update_rows();
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh
+// Desc: evaluates the watches, unless they can't be seen, then that is left
+//       until they can be again
+//------------------------------------------------------------------------------
+void WatchWidget::refresh() {
+
+	if(!isVisible()) {
+		stale_ = true;
+		return;
+	}
+
+	stale_ = false;
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process || watches_.size() == 0) {
+		update_rows();
+		return;
+	}
+
+	State state;
+	if(std::shared_ptr<IThread> thread = process->current_thread()) {
+		thread->get_state(&state);
+	}
+
+	watches_.evaluate(state, new_stop_);
+	new_stop_ = false;
+	update_rows();
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void WatchWidget::showEvent(QShowEvent *event) {
+	QWidget::showEvent(event);
+	if(stale_) {
+		refresh();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_rows
+// Desc: values which differ from the previous stop are shown in red
+//------------------------------------------------------------------------------
+void WatchWidget::update_rows() {
+
+	const QBrush normal = palette().brush(QPalette::Text);
+	const QBrush dimmed = palette().brush(QPalette::Disabled, QPalette::Text);
+
+	for(int row = 0; row < watches_.size(); ++row) {
+		const WatchList::Watch &watch = watches_.at(row);
+		QTableWidgetItem *const item  = table_->item(row, 1);
+
+		if(watch.valid) {
+			item->setText(edb::v1::format_pointer(watch.value));
+			item->setForeground(watch.changed ? QBrush(Qt::red) : normal);
+		} else if(watch.expression) {
+			item->setText(QString::fromLatin1(watch.error.what()));
+			item->setForeground(dimmed);
+		} else {
+			item->setText(QString());
+			item->setForeground(normal);
+		}
+	}
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WATCH_WIDGET_20171014_H_
+#define WATCH_WIDGET_20171014_H_
+
+#include "WatchList.h"
+#include <QStringList>
+#include <QWidget>
+
+class QPoint;
+class QTableWidget;
+class QTableWidgetItem;
+
+namespace WatchesPlugin {
+
+class WatchWidget : public QWidget {
+	Q_OBJECT
+
+public:
+	WatchWidget(QWidget *parent = 0, Qt::WindowFlags f = 0);
+	virtual ~WatchWidget();
+
+public:
+	QStringList expressions() const;
+	void set_expressions(const QStringList &expressions);
+
+public Q_SLOTS:
+	void add_watch();
+	void edit_watch();
+	void remove_watch();
+	void remove_all();
+	void refresh();
+	void stopped();
+	void detached();
+
+private Q_SLOTS:
+	void item_double_clicked(QTableWidgetItem *item);
+	void context_menu(const QPoint &pos);
+
+protected:
+	virtual void showEvent(QShowEvent *event);
+
+private:
+	void append_row(const QString &text);
+	void update_rows();
+
+private:
+	QTableWidget *table_;
+	WatchList     watches_;
+	bool          new_stop_ = false; // a debug event happened since the last evaluation
+	bool          stale_    = false; // the values shown are from before the last update
+};
+
+}
+
+#endif
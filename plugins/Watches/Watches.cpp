@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Watches.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "WatchWidget.h"
+#include "edb.h"
+#include <QDockWidget>
+#include <QMainWindow>
+#include <QMenu>
+
+namespace WatchesPlugin {
+
+//------------------------------------------------------------------------------
+// Name: Watches
+// Desc:
+//------------------------------------------------------------------------------
+Watches::Watches() : QObject(0), menu_(0), watch_widget_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *Watches::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		if(auto main_window = qobject_cast<QMainWindow *>(edb::v1::debugger_ui)) {
+			watch_widget_ = new WatchWidget;
+
+			// make the dock widget and _name_ it, it is important to name it so
+			// that it's state is saved in the GUI info
+			auto dock_widget = new QDockWidget(tr("Watches"), main_window);
+			dock_widget->setObjectName(QString::fromUtf8("Watches"));
+			dock_widget->setWidget(watch_widget_);
+
+			main_window->addDockWidget(Qt::RightDockWidgetArea, dock_widget);
+
+			QList<QDockWidget *> dockWidgets = main_window->findChildren<QDockWidget *>();
+			for(QDockWidget *widget : dockWidgets) {
+				if(widget != dock_widget) {
+					if(main_window->dockWidgetArea(widget) == Qt::RightDockWidgetArea) {
+						main_window->tabifyDockWidget(widget, dock_widget);
+
+						// place the new doc widget UNDER the one we tabbed with
+						widget->show();
+						widget->raise();
+						break;
+					}
+				}
+			}
+
+			menu_ = new QMenu(tr("Watches"), parent);
+			menu_->addAction(dock_widget->toggleViewAction());
+			menu_->addAction(tr("&Add Watch..."), watch_widget_, SLOT(add_watch()));
+		}
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: save_state
+// Desc:
+//------------------------------------------------------------------------------
+QVariantMap Watches::save_state() const {
+	QVariantMap state;
+	if(watch_widget_) {
+		state["expressions"] = watch_widget_->expressions();
+	}
+	return state;
+}
+
+//------------------------------------------------------------------------------
+// Name: restore_state
+// Desc:
+//------------------------------------------------------------------------------
+void Watches::restore_state(const QVariantMap &state) {
+	if(watch_widget_) {
+		watch_widget_->set_expressions(state["expressions"].toStringList());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_mode
+// Desc: evaluating many watches may take a while, it can wait until the stop
+//       is shown
+//------------------------------------------------------------------------------
+IPlugin::UpdateMode Watches::update_mode() const {
+	return UPDATE_DEFERRED;
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_updated
+// Desc: the watches are read from the process, which may have been continued
+//       since the stop. Then the next one brings them up to date instead
+//------------------------------------------------------------------------------
+void Watches::stop_updated(const std::shared_ptr<const StopSnapshot> &snapshot) {
+	Q_UNUSED(snapshot);
+
+	if(watch_widget_) {
+		IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+		if(process && process->isPaused()) {
+			watch_widget_->refresh();
+		}
+	}
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Watches, Watches)
+#endif
+
+}
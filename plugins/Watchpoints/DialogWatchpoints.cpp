@@ -0,0 +1,136 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "DialogWatchpoints.h"
+#include "WatchpointEngine.h"
+#include "edb.h"
+
+#include <QMessageBox>
+#include <QTableWidgetItem>
+
+#include "ui_DialogWatchpoints.h"
+
+namespace WatchpointsPlugin {
+
+//------------------------------------------------------------------------------
+// Name: DialogWatchpoints
+// Desc:
+//------------------------------------------------------------------------------
+DialogWatchpoints::DialogWatchpoints(WatchpointEngine *engine, QWidget *parent) : QDialog(parent), ui(new Ui::DialogWatchpoints), engine_(engine) {
+	ui->setupUi(this);
+
+	connect(engine_, SIGNAL(changed()), this, SLOT(refresh()));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogWatchpoints
+// Desc:
+//------------------------------------------------------------------------------
+DialogWatchpoints::~DialogWatchpoints() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc:
+//------------------------------------------------------------------------------
+void DialogWatchpoints::showEvent(QShowEvent *event) {
+	Q_UNUSED(event);
+	refresh();
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh
+// Desc:
+//------------------------------------------------------------------------------
+void DialogWatchpoints::refresh() {
+
+	if(!isVisible()) {
+		return;
+	}
+
+	const QList<WatchpointEngine::Watch> watches = engine_->watches();
+
+	ui->tableWatches->setRowCount(watches.size());
+	for(int row = 0; row < watches.size(); ++row) {
+		const WatchpointEngine::Watch &watch = watches[row];
+
+		auto item = new QTableWidgetItem(QString::number(watch.id));
+		item->setData(Qt::UserRole, watch.id);
+
+		ui->tableWatches->setItem(row, 0, item);
+		ui->tableWatches->setItem(row, 1, new QTableWidgetItem(watch.address.toPointerString()));
+		ui->tableWatches->setItem(row, 2, new QTableWidgetItem(QString::number(watch.size)));
+		ui->tableWatches->setItem(row, 3, new QTableWidgetItem(watch.type == WatchpointEngine::Write ? tr("Write") : tr("Read/Write")));
+		ui->tableWatches->setItem(row, 4, new QTableWidgetItem(QString::number(watch.hits)));
+	}
+
+	const QList<WatchpointEngine::PageStatistics> pages = engine_->page_statistics();
+
+	ui->tablePages->setRowCount(pages.size());
+	for(int row = 0; row < pages.size(); ++row) {
+		const WatchpointEngine::PageStatistics &page = pages[row];
+
+		ui->tablePages->setItem(row, 0, new QTableWidgetItem(page.page.toPointerString()));
+		ui->tablePages->setItem(row, 1, new QTableWidgetItem(QString::number(page.watches)));
+		ui->tablePages->setItem(row, 2, new QTableWidgetItem(QString::number(page.faults)));
+		ui->tablePages->setItem(row, 3, new QTableWidgetItem(QString::number(page.false_positives)));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnAdd_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogWatchpoints::on_btnAdd_clicked() {
+
+	edb::address_t address;
+	if(!edb::v1::eval_expression(ui->txtAddress->text(), &address)) {
+		return;
+	}
+
+	const auto type = ui->cmbType->currentIndex() == 0 ? WatchpointEngine::Write : WatchpointEngine::Access;
+
+	const Status status = engine_->add(address, ui->spinSize->value(), type);
+	if(!status) {
+		QMessageBox::critical(this, tr("Unable to Add Watchpoint"), status.toString());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnRemove_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogWatchpoints::on_btnRemove_clicked() {
+
+	const QList<QTableWidgetItem *> selected = ui->tableWatches->selectedItems();
+	if(selected.isEmpty()) {
+		return;
+	}
+
+	const int row = selected.front()->row();
+	const int id  = ui->tableWatches->item(row, 0)->data(Qt::UserRole).toInt();
+
+	const Status status = engine_->remove(id);
+	if(!status) {
+		QMessageBox::critical(this, tr("Unable to Remove Watchpoint"), status.toString());
+	}
+}
+
+}
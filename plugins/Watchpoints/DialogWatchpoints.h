@@ -0,0 +1,55 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DIALOG_WATCHPOINTS_20171014_H_
+#define DIALOG_WATCHPOINTS_20171014_H_
+
+#include <QDialog>
+
+namespace WatchpointsPlugin {
+
+class WatchpointEngine;
+
+namespace Ui { class DialogWatchpoints; }
+
+class DialogWatchpoints : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogWatchpoints(WatchpointEngine *engine, QWidget *parent = 0);
+	virtual ~DialogWatchpoints() override;
+
+private:
+	virtual void showEvent(QShowEvent *event) override;
+
+public Q_SLOTS:
+	void on_btnAdd_clicked();
+	void on_btnRemove_clicked();
+
+private Q_SLOTS:
+	void refresh();
+
+private:
+	Ui::DialogWatchpoints *const ui;
+	WatchpointEngine *const      engine_;
+};
+
+}
+
+#endif
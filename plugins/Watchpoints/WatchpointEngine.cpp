@@ -0,0 +1,396 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "WatchpointEngine.h"
+#include "IDebugEvent.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "MemoryRegions.h"
+#include "edb.h"
+
+#include <QtDebug>
+
+#include <algorithm>
+#include <csignal>
+
+namespace WatchpointsPlugin {
+
+namespace {
+
+// the fault address is where the access starts, so anything up to a general
+// purpose register's width below a range may still reach into it
+const int MaxAccessSize = 8;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: WatchpointEngine
+// Desc:
+//------------------------------------------------------------------------------
+WatchpointEngine::WatchpointEngine(QObject *parent) : QObject(parent) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~WatchpointEngine
+// Desc:
+//------------------------------------------------------------------------------
+WatchpointEngine::~WatchpointEngine() {
+	if(hooked_) {
+		edb::v1::remove_debug_event_handler(this);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: watches [address, address + size), for writes only or for any access
+//------------------------------------------------------------------------------
+Status WatchpointEngine::add(edb::address_t address, std::size_t size, Type type) {
+
+	if(size == 0) {
+		return Status(tr("A watchpoint needs at least one byte"));
+	}
+
+	QList<Watch> watches = watches_;
+	watches.push_back({ next_id_, address, size, type, 0 });
+
+	const Status status = rebuild(watches);
+	if(status) {
+		++next_id_;
+	}
+
+	return status;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove
+// Desc:
+//------------------------------------------------------------------------------
+Status WatchpointEngine::remove(int id) {
+
+	QList<Watch> watches = watches_;
+
+	auto it = std::find_if(watches.begin(), watches.end(), [id](const Watch &watch) {
+		return watch.id == id;
+	});
+
+	if(it == watches.end()) {
+		return Status::Ok;
+	}
+
+	watches.erase(it);
+	return rebuild(watches);
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc: removes every watch, giving the pages their protection back
+//------------------------------------------------------------------------------
+void WatchpointEngine::clear() {
+
+	if(watches_.isEmpty()) {
+		return;
+	}
+
+	const Status status = rebuild(QList<Watch>());
+	if(!status) {
+		qDebug("[Watchpoints] unable to restore page protections: %s", qPrintable(status.toString()));
+		forget();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: forget
+// Desc: drops every watch without touching the process, which is gone
+//------------------------------------------------------------------------------
+void WatchpointEngine::forget() {
+
+	watches_.clear();
+	pages_.clear();
+	stepping_ = false;
+
+	if(hooked_) {
+		edb::v1::remove_debug_event_handler(this);
+		hooked_ = false;
+	}
+
+	Q_EMIT changed();
+}
+
+//------------------------------------------------------------------------------
+// Name: page_statistics
+// Desc:
+//------------------------------------------------------------------------------
+QList<WatchpointEngine::PageStatistics> WatchpointEngine::page_statistics() const {
+
+	QList<PageStatistics> statistics;
+	for(auto it = pages_.begin(); it != pages_.end(); ++it) {
+		statistics.push_back({ it.key(), it->watches, it->faults, it->false_positives });
+	}
+	return statistics;
+}
+
+//------------------------------------------------------------------------------
+// Name: page_of
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t WatchpointEngine::page_of(edb::address_t address) const {
+	const quint64 page_size = edb::v1::debugger_core->page_size().toUint();
+	return edb::address_t::fromZeroExtended(address.toUint() & ~(page_size - 1));
+}
+
+//------------------------------------------------------------------------------
+// Name: overlaps
+// Desc: true if [start, end) touches one of the ranges of <page>
+//------------------------------------------------------------------------------
+bool WatchpointEngine::overlaps(const Page &page, edb::address_t start, edb::address_t end) {
+
+	// the ranges don't overlap, so their ends are sorted as well
+	auto it = std::upper_bound(page.ranges.begin(), page.ranges.end(), start, [](edb::address_t address, const Interval &range) {
+		return address < range.end;
+	});
+
+	return it != page.ranges.end() && it->start < end;
+}
+
+//------------------------------------------------------------------------------
+// Name: protect
+// Desc: takes away what the watches on <page> need to see
+//------------------------------------------------------------------------------
+Status WatchpointEngine::protect(edb::address_t page, const Page &info) {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return Status(tr("No process is being debugged"));
+	}
+
+	const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+
+	if(info.access) {
+		return process->protect(page, page_size, false, false, false);
+	}
+
+	return process->protect(page, page_size, info.read, false, info.execute);
+}
+
+//------------------------------------------------------------------------------
+// Name: unprotect
+// Desc: gives <page> the protection it had before it was watched
+//------------------------------------------------------------------------------
+Status WatchpointEngine::unprotect(edb::address_t page, const Page &info) {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return Status(tr("No process is being debugged"));
+	}
+
+	const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+	return process->protect(page, page_size, info.read, info.write, info.execute);
+}
+
+//------------------------------------------------------------------------------
+// Name: rebuild
+// Desc: makes <watches> the ones in effect, only the pages whose protection
+//       has to change are touched
+//------------------------------------------------------------------------------
+Status WatchpointEngine::rebuild(QList<Watch> watches) {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return Status(tr("No process is being debugged"));
+	}
+
+	if(!process->isPaused() || stepping_) {
+		return Status(tr("The process has to be paused to change watchpoints"));
+	}
+
+	const edb::address_t page_size = edb::v1::debugger_core->page_size();
+
+	QMap<edb::address_t, Page> pages;
+
+	for(const Watch &watch : watches) {
+		const edb::address_t end = watch.address + edb::address_t::fromZeroExtended(watch.size);
+
+		for(edb::address_t page = page_of(watch.address); page < end; page += page_size) {
+
+			auto it = pages.find(page);
+			if(it == pages.end()) {
+				Page info;
+
+				auto old = pages_.find(page);
+				if(old != pages_.end()) {
+					info.read            = old->read;
+					info.write           = old->write;
+					info.execute         = old->execute;
+					info.faults          = old->faults;
+					info.false_positives = old->false_positives;
+				} else if(std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(page)) {
+					info.read    = region->readable();
+					info.write   = region->writable();
+					info.execute = region->executable();
+				} else {
+					return Status(tr("The address %1 is not mapped").arg(page.toPointerString()));
+				}
+
+				it = pages.insert(page, info);
+			}
+
+			it->ranges.push_back({ std::max(watch.address, page), std::min(end, page + page_size) });
+			it->access = it->access || watch.type == Access;
+			++it->watches;
+		}
+	}
+
+	for(Page &info : pages) {
+		std::sort(info.ranges.begin(), info.ranges.end(), [](const Interval &a, const Interval &b) {
+			return a.start < b.start;
+		});
+
+		QVector<Interval> merged;
+		for(const Interval &range : info.ranges) {
+			if(!merged.isEmpty() && range.start <= merged.back().end) {
+				merged.back().end = std::max(merged.back().end, range.end);
+			} else {
+				merged.push_back(range);
+			}
+		}
+		info.ranges = merged;
+	}
+
+	// newly watched pages, or ones which now have to catch reads too
+	for(auto it = pages.begin(); it != pages.end(); ++it) {
+		auto old = pages_.find(it.key());
+		if(old == pages_.end() || old->access != it->access) {
+			const Status status = protect(it.key(), *it);
+			if(!status) {
+				return status;
+			}
+		}
+	}
+
+	// and the ones nothing watches any more
+	for(auto it = pages_.begin(); it != pages_.end(); ++it) {
+		if(!pages.contains(it.key())) {
+			const Status status = unprotect(it.key(), *it);
+			if(!status) {
+				qDebug("[Watchpoints] unable to restore the protection of %s: %s", qPrintable(it.key().toPointerString()), qPrintable(status.toString()));
+			}
+		}
+	}
+
+	watches_ = watches;
+	pages_   = pages;
+
+	if(!watches_.isEmpty() && !hooked_) {
+		edb::v1::add_debug_event_handler(this);
+		hooked_ = true;
+	} else if(watches_.isEmpty() && hooked_) {
+		edb::v1::remove_debug_event_handler(this);
+		hooked_ = false;
+	}
+
+	Q_EMIT changed();
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: interest
+// Desc: the faults on our pages, and the traps of stepping past them
+//------------------------------------------------------------------------------
+IDebugEventHandler::Interest WatchpointEngine::interest() const {
+	Interest interest;
+	interest.kinds   = EVENT_STEP | EVENT_BREAKPOINT | EVENT_SIGNAL;
+	interest.signal_codes = { SIGSEGV };
+	return interest;
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc: a fault on one of our pages is stepped past with the page's own
+//       protection, then the page is protected again and we either carry on
+//       or, when a watched range was touched, stop
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS WatchpointEngine::handle_event(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(!event->stopped()) {
+		return edb::DEBUG_NEXT_HANDLER;
+	}
+
+	if(stepping_ && event->thread() == pending_.tid) {
+		if(!event->is_trap()) {
+			// something else stopped it before it got there
+			return edb::DEBUG_NEXT_HANDLER;
+		}
+
+		stepping_ = false;
+
+		auto it = pages_.find(pending_.page);
+		if(it != pages_.end()) {
+			const Status status = protect(it.key(), *it);
+			if(!status) {
+				qDebug("[Watchpoints] unable to protect %s again: %s", qPrintable(it.key().toPointerString()), qPrintable(status.toString()));
+			}
+		}
+
+		if(!pending_.hit) {
+			return edb::DEBUG_CONTINUE;
+		}
+
+		const edb::address_t end = pending_.address + MaxAccessSize;
+		for(Watch &watch : watches_) {
+			if(pending_.address < watch.address + edb::address_t::fromZeroExtended(watch.size) && watch.address < end) {
+				++watch.hits;
+				edb::v1::set_status(tr("Watchpoint #%1 hit, %2 was accessed").arg(watch.id).arg(pending_.address.toPointerString()), 0);
+			}
+		}
+
+		Q_EMIT changed();
+		return edb::DEBUG_STOP;
+	}
+
+	if(event->code() != SIGSEGV) {
+		return edb::DEBUG_NEXT_HANDLER;
+	}
+
+	const edb::address_t address = event->fault_address();
+
+	auto it = pages_.find(page_of(address));
+	if(it == pages_.end()) {
+		return edb::DEBUG_NEXT_HANDLER;
+	}
+
+	++it->faults;
+
+	const bool hit = overlaps(*it, address, address + MaxAccessSize);
+	if(!hit) {
+		++it->false_positives;
+	}
+
+	const Status status = unprotect(it.key(), *it);
+	if(!status) {
+		qDebug("[Watchpoints] unable to unprotect %s: %s", qPrintable(it.key().toPointerString()), qPrintable(status.toString()));
+		return edb::DEBUG_NEXT_HANDLER;
+	}
+
+	pending_  = { event->thread(), it.key(), address, hit };
+	stepping_ = true;
+	return edb::DEBUG_CONTINUE_STEP;
+}
+
+}
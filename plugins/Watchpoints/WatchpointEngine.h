@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef WATCHPOINT_ENGINE_20171014_H_
+#define WATCHPOINT_ENGINE_20171014_H_
+
+#include "IDebugEventHandler.h"
+#include "OSTypes.h"
+#include "Status.h"
+#include "Types.h"
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+#include <memory>
+
+namespace WatchpointsPlugin {
+
+// Watches any number of ranges of any size by taking the access rights to
+// their pages away. A fault on such a page is looked up in a page -> ranges
+// index, then the faulting instruction is stepped with the page's original
+// protection and the page protected again. Accesses which fall outside
+// every range of their page only cost that round trip, and are counted per
+// page so that badly placed watches can be spotted
+class WatchpointEngine : public QObject, public IDebugEventHandler {
+	Q_OBJECT
+
+public:
+	enum Type {
+		Write,
+		Access
+	};
+
+	struct Watch {
+		int            id;
+		edb::address_t address;
+		std::size_t    size;
+		Type           type;
+		quint64        hits;
+	};
+
+	struct PageStatistics {
+		edb::address_t page;
+		int            watches;
+		quint64        faults;
+		quint64        false_positives;
+	};
+
+public:
+	explicit WatchpointEngine(QObject *parent = nullptr);
+	virtual ~WatchpointEngine() override;
+
+public:
+	Status add(edb::address_t address, std::size_t size, Type type);
+	Status remove(int id);
+
+public Q_SLOTS:
+	void clear();
+	void forget();
+
+public:
+	QList<Watch> watches() const { return watches_; }
+	QList<PageStatistics> page_statistics() const;
+
+public:
+	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event) override;
+	virtual Interest interest() const override;
+
+Q_SIGNALS:
+	void changed();
+
+private:
+	struct Interval {
+		edb::address_t start;
+		edb::address_t end;
+	};
+
+	struct Page {
+		QVector<Interval> ranges;          // merged, sorted by address
+		int               watches         = 0;
+		bool              access          = false; // reads fault too
+		bool              read            = true;  // the protection it had before
+		bool              write           = true;
+		bool              execute         = false;
+		quint64           faults          = 0;
+		quint64           false_positives = 0;
+	};
+
+	// the thread stepping past an access with its page's protection restored
+	struct Pending {
+		edb::tid_t     tid;
+		edb::address_t page;
+		edb::address_t address;
+		bool           hit;
+	};
+
+private:
+	Status rebuild(QList<Watch> watches);
+	Status protect(edb::address_t page, const Page &info);
+	Status unprotect(edb::address_t page, const Page &info);
+	edb::address_t page_of(edb::address_t address) const;
+	static bool overlaps(const Page &page, edb::address_t start, edb::address_t end);
+
+private:
+	QList<Watch>                watches_;
+	QMap<edb::address_t, Page>  pages_;
+	Pending                     pending_  = {};
+	bool                        stepping_ = false;
+	int                         next_id_  = 1;
+	bool                        hooked_   = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Watchpoints.h"
+#include "DialogWatchpoints.h"
+#include "WatchpointEngine.h"
+#include "edb.h"
+
+#include <QMenu>
+#include <QMessageBox>
+
+#include <algorithm>
+
+namespace WatchpointsPlugin {
+
+//------------------------------------------------------------------------------
+// Name: Watchpoints
+// Desc:
+//------------------------------------------------------------------------------
+Watchpoints::Watchpoints() : engine_(new WatchpointEngine(this)) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~Watchpoints
+// Desc:
+//------------------------------------------------------------------------------
+Watchpoints::~Watchpoints() {
+	delete dialog_;
+}
+
+//------------------------------------------------------------------------------
+// Name: private_init
+// Desc: the pages have to get their protection back before we let go of the
+//       process, once it is gone there is nothing left to restore
+//------------------------------------------------------------------------------
+void Watchpoints::private_init() {
+	connect(edb::v1::debugger_ui, SIGNAL(aboutToDetach()), engine_, SLOT(clear()));
+	connect(edb::v1::debugger_ui, SIGNAL(detachEvent()), engine_, SLOT(forget()));
+}
+
+//------------------------------------------------------------------------------
+// Name: menu
+// Desc:
+//------------------------------------------------------------------------------
+QMenu *Watchpoints::menu(QWidget *parent) {
+
+	Q_ASSERT(parent);
+
+	if(!menu_) {
+		menu_ = new QMenu(tr("Watchpoints"), parent);
+		menu_->addAction(tr("&Watchpoints"), this, SLOT(show_menu()));
+	}
+
+	return menu_;
+}
+
+//------------------------------------------------------------------------------
+// Name: data_context_menu
+// Desc:
+//------------------------------------------------------------------------------
+QList<QAction *> Watchpoints::data_context_menu() {
+
+	auto menu = new QMenu(tr("Watchpoints"));
+	menu->addAction(tr("Watch &Writes"), this, SLOT(watch_writes()));
+	menu->addAction(tr("Watch &Reads/Writes"), this, SLOT(watch_accesses()));
+
+	QList<QAction *> ret;
+
+	auto action = new QAction(tr("Watchpoints"), this);
+	action->setMenu(menu);
+	ret << action;
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: show_menu
+// Desc:
+//------------------------------------------------------------------------------
+void Watchpoints::show_menu() {
+
+	if(!dialog_) {
+		dialog_ = new DialogWatchpoints(engine_, edb::v1::debugger_ui);
+	}
+
+	dialog_->show();
+}
+
+//------------------------------------------------------------------------------
+// Name: watch_writes
+// Desc: watches the selected bytes of the data view
+//------------------------------------------------------------------------------
+void Watchpoints::watch_writes() {
+	const Status status = engine_->add(edb::v1::selected_data_address(), std::max<std::size_t>(edb::v1::selected_data_size(), 1), WatchpointEngine::Write);
+	if(!status) {
+		QMessageBox::critical(nullptr, tr("Unable to Add Watchpoint"), status.toString());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: watch_accesses
+// Desc:
+//------------------------------------------------------------------------------
+void Watchpoints::watch_accesses() {
+	const Status status = engine_->add(edb::v1::selected_data_address(), std::max<std::size_t>(edb::v1::selected_data_size(), 1), WatchpointEngine::Access);
+	if(!status) {
+		QMessageBox::critical(nullptr, tr("Unable to Add Watchpoint"), status.toString());
+	}
+}
+
+#if QT_VERSION < 0x050000
+Q_EXPORT_PLUGIN2(Watchpoints, Watchpoints)
+#endif
+
+}
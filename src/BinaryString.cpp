@@ -55,18 +55,28 @@ void BinaryString::setMaxLength(int n) {
 	setEntriesMaxLength(n);
 }
 
+//------------------------------------------------------------------------------
+// Name: setWildcardsAllowed
+// Desc: for patterns to search for, a '?' in the hex entry matches any nibble,
+//       see mask()
+//------------------------------------------------------------------------------
+void BinaryString::setWildcardsAllowed(bool allowed) {
+	validator_->setWildcardsAllowed(allowed);
+}
+
 //------------------------------------------------------------------------------
 // Name: BinaryString
 // Desc: constructor
 //------------------------------------------------------------------------------
 BinaryString::BinaryString(QWidget *parent) : QWidget(parent),
 											  ui(new Ui::BinaryStringWidget),
+											  validator_(new HexStringValidator(this)),
 											  mode_(Mode::MemoryEditing),
 											  requestedMaxLength_(0),
 											  valueOriginalLength_(0)
 {
 	ui->setupUi(this);
-	ui->txtHex->setValidator(new HexStringValidator(this));
+	ui->txtHex->setValidator(validator_);
 	ui->keepSize->setFocusPolicy(Qt::TabFocus);
 	ui->txtHex->setFocus(Qt::OtherFocusReason);
 	connect(ui->keepSize,SIGNAL(stateChanged(int)),this,SLOT(on_keepSize_stateChanged()));
@@ -201,8 +211,30 @@ QByteArray BinaryString::value() const {
 	QByteArray ret;
 	const QStringList list1 = ui->txtHex->text().split(" ", QString::SkipEmptyParts);
 
+	for(QString i: list1) {
+		// wildcards read as zero, mask() tells them apart
+		ret += static_cast<quint8>(i.replace('?', '0').toUInt(nullptr, 16));
+	}
+
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: mask
+// Desc: which bits of each byte of value() were given, a '?' clears those of
+//       its nibble
+//------------------------------------------------------------------------------
+QByteArray BinaryString::mask() const {
+
+	QByteArray ret;
+	const QStringList list1 = ui->txtHex->text().split(" ", QString::SkipEmptyParts);
+
 	for(const QString &i: list1) {
-		ret += static_cast<quint8>(i.toUInt(nullptr, 16));
+		quint8 m = 0;
+		for(QChar ch: i) {
+			m = (m << 4) | (ch == '?' ? 0x0 : 0xf);
+		}
+		ret += m;
 	}
 
 	return ret;
@@ -0,0 +1,175 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BytePattern.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// below this, or when a wildcard near the end keeps the shifts short, it is
+// faster to let memchr find candidates than to take Horspool's steps
+const int HORSPOOL_MIN_SIZE  = 8;
+const int HORSPOOL_MIN_SHIFT = 4;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: BytePattern
+// Desc:
+//------------------------------------------------------------------------------
+BytePattern::BytePattern(const QByteArray &bytes) : bytes_(bytes), mask_(bytes.size(), '\xff') {
+	prepare();
+}
+
+//------------------------------------------------------------------------------
+// Name: BytePattern
+// Desc: <mask> is as long as <bytes>, or missing bytes are taken as 0xff
+//------------------------------------------------------------------------------
+BytePattern::BytePattern(const QByteArray &bytes, const QByteArray &mask) : bytes_(bytes), mask_(mask.left(bytes.size())) {
+	if(mask_.size() < bytes_.size()) {
+		mask_.append(QByteArray(bytes_.size() - mask_.size(), '\xff'));
+	}
+	prepare();
+}
+
+//------------------------------------------------------------------------------
+// Name: prepare
+// Desc: works out how the pattern is best searched for
+//------------------------------------------------------------------------------
+void BytePattern::prepare() {
+
+	const int n = bytes_.size();
+
+	exact_  = true;
+	anchor_ = -1;
+	shift_.clear();
+
+	for(int i = 0; i < n; ++i) {
+		bytes_[i] = bytes_[i] & mask_[i];
+
+		if(static_cast<quint8>(mask_[i]) != 0xff) {
+			exact_ = false;
+			continue;
+		}
+
+		// zeros and 0xff are everywhere in memory, they make poor anchors
+		const quint8 byte = bytes_[i];
+		if(anchor_ == -1 || ((byte != 0x00 && byte != 0xff) && (bytes_[anchor_] == '\x00' || bytes_[anchor_] == '\xff'))) {
+			anchor_ = i;
+		}
+	}
+
+	if(n < HORSPOOL_MIN_SIZE) {
+		return;
+	}
+
+	// how far the window can move when its last byte is c, every position
+	// but the last one whose (masked) byte c could be limits it
+	QVector<int> shift(256, n);
+	for(int i = 0; i < n - 1; ++i) {
+		const quint8 mask = mask_[i];
+		const quint8 byte = bytes_[i];
+
+		if(mask == 0xff) {
+			shift[byte] = n - 1 - i;
+		} else {
+			for(int c = 0; c < 256; ++c) {
+				if((c & mask) == byte) {
+					shift[c] = n - 1 - i;
+				}
+			}
+		}
+	}
+
+	if(*std::min_element(shift.begin(), shift.end()) >= HORSPOOL_MIN_SHIFT || anchor_ == -1) {
+		shift_ = shift;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: matches
+// Desc: true if the pattern is at <p>, which has at least size() bytes
+//------------------------------------------------------------------------------
+bool BytePattern::matches(const quint8 *p) const {
+
+	if(exact_) {
+		return std::memcmp(p, bytes_.constData(), bytes_.size()) == 0;
+	}
+
+	for(int i = 0; i < bytes_.size(); ++i) {
+		if((p[i] & static_cast<quint8>(mask_[i])) != static_cast<quint8>(bytes_[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: the first match which lies entirely in [first, last), or nullptr
+//------------------------------------------------------------------------------
+const quint8 *BytePattern::find(const quint8 *first, const quint8 *last) const {
+
+	const int n = bytes_.size();
+	if(n == 0 || last - first < n) {
+		return nullptr;
+	}
+
+	const quint8 *const final_start = last - n;
+
+	if(!shift_.isEmpty()) {
+		const quint8 last_mask = mask_[n - 1];
+		const quint8 last_byte = bytes_[n - 1];
+
+		for(const quint8 *p = first; p <= final_start; p += shift_[p[n - 1]]) {
+			if((p[n - 1] & last_mask) == last_byte && matches(p)) {
+				return p;
+			}
+		}
+		return nullptr;
+	}
+
+	if(anchor_ != -1) {
+		const int byte = static_cast<quint8>(bytes_[anchor_]);
+
+		const quint8 *p         = first + anchor_;
+		const quint8 *const end = final_start + anchor_ + 1;
+		while(p < end) {
+			const auto hit = static_cast<const quint8 *>(std::memchr(p, byte, end - p));
+			if(!hit) {
+				return nullptr;
+			}
+
+			if(matches(hit - anchor_)) {
+				return hit - anchor_;
+			}
+			p = hit + 1;
+		}
+		return nullptr;
+	}
+
+	// nothing but wildcards and partial bytes
+	for(const quint8 *p = first; p <= final_start; ++p) {
+		if(matches(p)) {
+			return p;
+		}
+	}
+	return nullptr;
+}
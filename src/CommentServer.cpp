@@ -20,7 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Configuration.h"
 #include "IDebugger.h"
 #include "IProcess.h"
+#include "ISymbolManager.h"
 #include "Instruction.h"
+#include "ReadRequest.h"
+#include "StringProbe.h"
 #include "edb.h"
 
 #include <QString>
@@ -46,6 +49,8 @@ CommentServer::~CommentServer() {
 //------------------------------------------------------------------------------
 void CommentServer::set_comment(QHexView::address_t address, const QString &comment) {
 	custom_comments_[address] = comment;
+	comments_.clear();
+	previous_comments_.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -54,38 +59,62 @@ void CommentServer::set_comment(QHexView::address_t address, const QString &comm
 //------------------------------------------------------------------------------
 void CommentServer::clear() {
 	custom_comments_.clear();
+	comments_.clear();
+	previous_comments_.clear();
 }
 
+//------------------------------------------------------------------------------
+// Name: invalidate
+// Desc: forgets the comments worked out so far, the debuggee's memory may not
+//       be what they were worked out from anymore. They are kept aside to be
+//       compared against, unless nothing was asked for since the last call
+//------------------------------------------------------------------------------
+void CommentServer::invalidate() {
+	if(!comments_.isEmpty()) {
+		previous_comments_.swap(comments_);
+		comments_.clear();
+	}
+}
+
+namespace {
+
 // a call can be anywhere from 2 to 7 bytes long depends on if there is a Mod/RM byte
 // or a SIB byte, etc
 // this is ignoring prefixes, fortunately, no calls have mandatory prefixes
 // TODO(eteran): this is an arch specific concept
-#define CALL_MAX_SIZE 7
-#define CALL_MIN_SIZE 2
+const int CALL_MAX_SIZE = 7;
+const int CALL_MIN_SIZE = 2;
+
+const int MAX_STRING_LENGTH = 256;
+
+// the views show a few hundred rows at most, this is just in case
+const int MAX_COMMENTS = 16384;
+
+// the views ask row by row going down, so this many words from the first one
+// asked for are read, and what they point to resolved, together
+const int WINDOW_WORDS = 64;
+
+}
 
 //------------------------------------------------------------------------------
 // Name: resolve_function_call
-// Desc:
+// Desc: <code> holds the bytes in front of <address>, up to it
 //------------------------------------------------------------------------------
-Result<QString> CommentServer::resolve_function_call(QHexView::address_t address) const {
+Result<QString> CommentServer::resolve_function_call(QHexView::address_t address, const quint8 *code, std::size_t size) const {
 
 	// ok, we now want to locate the instruction before this one
 	// so we need to look back a few bytes
-	quint8 buffer[edb::Instruction::MAX_SIZE];
-
 	// TODO(eteran): portability warning, makes assumptions on the size of a call
-	if(IProcess *process = edb::v1::debugger_core->process()) {
-		if(process->read_bytes(address - CALL_MAX_SIZE, buffer, sizeof(buffer))) {
-			for(int i = (CALL_MAX_SIZE - CALL_MIN_SIZE); i >= 0; --i) {
-				edb::Instruction inst(buffer + i, buffer + sizeof(buffer), 0);
-				if(is_call(inst)) {
-					const QString symname = edb::v1::find_function_symbol(address);
-
-					if(!symname.isEmpty()) {
-						return edb::v1::make_result(tr("return to %1 <%2>").arg(edb::v1::format_pointer(address), symname));
-					} else {
-						return edb::v1::make_result(tr("return to %1").arg(edb::v1::format_pointer(address)));
-					}
+	if(size == edb::Instruction::MAX_SIZE) {
+		for(int i = (CALL_MAX_SIZE - CALL_MIN_SIZE); i >= 0; --i) {
+			edb::Instruction inst(code + i, code + size, 0);
+			if(is_call(inst)) {
+				const QString symname = edb::v1::find_function_symbol(address);
+
+				if(!symname.isEmpty()) {
+					return edb::v1::make_result(tr("return to %1 <%2>").arg(edb::v1::format_pointer(address), symname));
+				} else {
+					return edb::v1::make_result(tr("return to %1").arg(edb::v1::format_pointer(address)));
 				}
 			}
 		}
@@ -96,49 +125,149 @@ Result<QString> CommentServer::resolve_function_call(QHexView::address_t address
 
 //------------------------------------------------------------------------------
 // Name: resolve_string
-// Desc:
+// Desc: <data> holds what is at the address, as much of it as could be read
 //------------------------------------------------------------------------------
-Result<QString> CommentServer::resolve_string(QHexView::address_t address) const {
+Result<QString> CommentServer::resolve_string(const quint8 *data, std::size_t size) const {
 
 	const int min_string_length = edb::v1::config().min_string_length;
-	const int max_string_length = 256;
 
-	int stringLen;
 	QString temp;
 
-	if(edb::v1::get_ascii_string_at_address(address, temp, min_string_length, max_string_length, stringLen)) {
+	if(StringProbe::ascii_string(data, size, min_string_length, MAX_STRING_LENGTH, &temp)) {
 		return edb::v1::make_result(tr("ASCII \"%1\"").arg(temp));
-	} else if(edb::v1::get_utf16_string_at_address(address, temp, min_string_length, max_string_length, stringLen)) {
+	} else if(StringProbe::utf16_string(data, size, min_string_length, MAX_STRING_LENGTH, &temp)) {
 		return edb::v1::make_result(tr("UTF16 \"%1\"").arg(temp));
 	}
 
 	return Result<QString>(tr("Failed to resolve string"), tr(""));
 }
 
+//------------------------------------------------------------------------------
+// Name: resolve_import
+// Desc: names <address> if it is the PLT stub or GOT slot of an import
+//------------------------------------------------------------------------------
+Result<QString> CommentServer::resolve_import(QHexView::address_t address) const {
+
+	const QString import = edb::v1::symbol_manager().find_import(address);
+	if(!import.isEmpty()) {
+		return edb::v1::make_result(tr("import <%1>").arg(import));
+	}
+
+	return Result<QString>(tr("Failed to resolve import"), tr(""));
+}
+
+//------------------------------------------------------------------------------
+// Name: resolve
+// Desc: what <value> points to, if anything. <code> holds the bytes in front
+//       of it and <data> the ones it points to
+//------------------------------------------------------------------------------
+QString CommentServer::resolve(QHexView::address_t value, const quint8 *code, std::size_t code_size, const quint8 *data, std::size_t data_size) const {
+
+	auto it = custom_comments_.find(value);
+	if(it != custom_comments_.end()) {
+		return it.value();
+	}
+
+	if(Result<QString> ret = resolve_function_call(value, code, code_size)) {
+		return *ret;
+	} else if(Result<QString> ret = resolve_import(value)) {
+		return *ret;
+	} else if(Result<QString> ret = resolve_string(data, data_size)) {
+		return *ret;
+	}
+
+	return QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: resolve_window
+// Desc: works out the comments for WINDOW_WORDS words from <address> on, with
+//       one batch for the words and one for everything they point to
+//------------------------------------------------------------------------------
+void CommentServer::resolve_window(QHexView::address_t address) const {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return;
+	}
+
+	const std::size_t pointer_size = edb::v1::pointer_size();
+	const std::size_t target_size  = edb::Instruction::MAX_SIZE + MAX_STRING_LENGTH * 2;
+
+	QVector<edb::address_t> values(WINDOW_WORDS, edb::address_t(0));
+	QVector<ReadRequest>    requests;
+	requests.reserve(WINDOW_WORDS);
+
+	for(int i = 0; i < WINDOW_WORDS; ++i) {
+		requests.push_back(ReadRequest{edb::address_t(address + i * pointer_size), &values[i], pointer_size});
+	}
+
+	const QVector<std::size_t> value_sizes = process->read_many(requests);
+
+	// the code in front of each value and the string it may be, back to back
+	QByteArray targets(WINDOW_WORDS * target_size, '\0');
+	quint8 *const buffer = reinterpret_cast<quint8 *>(targets.data());
+
+	requests.clear();
+	QVector<int> pending;
+	for(int i = 0; i < WINDOW_WORDS; ++i) {
+		if(value_sizes[i] != pointer_size || comments_.contains(address + i * pointer_size)) {
+			continue;
+		}
+
+		quint8 *const target = buffer + pending.size() * target_size;
+		requests.push_back(ReadRequest{edb::address_t(values[i] - CALL_MAX_SIZE), target, edb::Instruction::MAX_SIZE});
+		requests.push_back(ReadRequest{values[i], target + edb::Instruction::MAX_SIZE, MAX_STRING_LENGTH * 2});
+		pending.push_back(i);
+	}
+
+	const QVector<std::size_t> target_sizes = process->read_many(requests);
+
+	if(comments_.size() + pending.size() > MAX_COMMENTS) {
+		comments_.clear();
+	}
+
+	for(int n = 0; n < pending.size(); ++n) {
+		const quint64 slot_address = address + pending[n] * pointer_size;
+		const quint8 *const target = buffer + n * target_size;
+		const std::size_t code_size = target_sizes[n * 2];
+		const std::size_t data_size = target_sizes[n * 2 + 1];
+
+		Comment comment;
+		comment.value     = values[pending[n]].toUint();
+		comment.code_size = code_size;
+		comment.data_size = data_size;
+		comment.target    = QByteArray(reinterpret_cast<const char *>(target), static_cast<int>(target_size));
+
+		auto it = previous_comments_.find(slot_address);
+		if(it != previous_comments_.end() && it->value == comment.value && it->code_size == code_size && it->data_size == data_size && it->target == comment.target) {
+			comment.text = it->text;
+		} else {
+			comment.text = resolve(values[pending[n]], target, code_size, target + edb::Instruction::MAX_SIZE, data_size);
+		}
+
+		comments_.insert(slot_address, comment);
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: comment
 // Desc:
 //------------------------------------------------------------------------------
 QString CommentServer::comment(QHexView::address_t address, int size) const {
 
-	if(IProcess *process = edb::v1::debugger_core->process()) {
-		// if the view is currently looking at words which are a pointer in size
-		// then see if it points to anything...
-		if(size == edb::v1::pointer_size()) {
-			edb::address_t value(0);
-			if(process->read_bytes(address, &value, edb::v1::pointer_size())) {
+	// if the view is currently looking at words which are a pointer in size
+	// then see if it points to anything...
+	if(size == edb::v1::pointer_size()) {
 
-				auto it = custom_comments_.find(value);
-				if(it != custom_comments_.end()) {
-					return it.value();
-				} else {
-					if(Result<QString> ret = resolve_function_call(value)) {
-						return *ret;
-					} else if(Result<QString> ret = resolve_string(value)) {
-						return *ret;
-					}
-				}
-			}
+		auto it = comments_.find(address);
+		if(it == comments_.end()) {
+			resolve_window(address);
+			it = comments_.find(address);
+		}
+
+		if(it != comments_.end()) {
+			return it->text;
 		}
 	}
 
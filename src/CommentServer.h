@@ -22,10 +22,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "QHexView"
 #include "Status.h"
 
+#include <QByteArray>
 #include <QHash>
 #include <QObject>
 #include <QString>
 
+#include <cstddef>
+
 class CommentServer : public QObject, public QHexView::CommentServerInterface {
 	Q_OBJECT
 
@@ -38,12 +41,35 @@ public:
 	virtual QString comment(QHexView::address_t address, int size) const;
 	virtual void clear();
 
+public:
+	void invalidate();
+
 private:
-	Result<QString> resolve_function_call(QHexView::address_t address) const;
-	Result<QString> resolve_string(QHexView::address_t address) const;
+	struct Comment {
+		quint64     value;     // the word at the address
+		std::size_t code_size; // how much of the code in front of it could be read
+		std::size_t data_size; // and how much of what it points to
+		QByteArray  target;    // both, as they were read
+		QString     text;
+	};
+
+private:
+	void resolve_window(QHexView::address_t address) const;
+	QString resolve(QHexView::address_t value, const quint8 *code, std::size_t code_size, const quint8 *data, std::size_t data_size) const;
+	Result<QString> resolve_function_call(QHexView::address_t address, const quint8 *code, std::size_t size) const;
+	Result<QString> resolve_string(const quint8 *data, std::size_t size) const;
+	Result<QString> resolve_import(QHexView::address_t address) const;
 
 private:
 	QHash<quint64, QString> custom_comments_;
+
+	// what comment() worked out since the debuggee last ran or was written
+	// to, see invalidate(). Keyed by the address the comment is for
+	mutable QHash<quint64, Comment> comments_;
+
+	// the ones before that, a slot which still holds the same value pointing
+	// to the same bytes gets its text back without working it out again
+	mutable QHash<quint64, Comment> previous_comments_;
 };
 
 #endif
@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtDebug>
 #include <QDataStream>
 
+#include <algorithm>
+
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
@@ -96,7 +98,8 @@ void Configuration::readSettings() {
 	QSettings settings;
 
 	settings.beginGroup("General");
-	close_behavior = static_cast<CloseBehavior>(settings.value("close_behavior").value<uint>());
+	close_behavior     = static_cast<CloseBehavior>(settings.value("close_behavior").value<uint>());
+	max_worker_threads = std::max(0, settings.value("max_worker_threads", 0).toInt());
 	settings.endGroup();
 
 	settings.beginGroup("Appearance");
@@ -125,6 +128,9 @@ void Configuration::readSettings() {
 	disableASLR           = settings.value("debugger.disableASLR.enabled", false).toBool();
 	disableLazyBinding    = settings.value("debugger.disableLazyBinding.enabled", false).toBool();
 	break_on_library_load = settings.value("debugger.break_on_library_load_event.enabled", false).toBool();
+	non_stop_mode         = settings.value("debugger.non_stop_mode.enabled", false).toBool();
+	fork_behavior         = static_cast<ForkBehavior>(settings.value("debugger.fork_behavior", DetachChild).value<uint>());
+	gui_update_interval   = settings.value("debugger.gui_update_interval", 16).toInt();
 	default_breakpoint_type = settings.value("debugger.default_breakpoint_type",
 											 QVariant::fromValue(IBreakpoint::TypeId::Automatic)).value<IBreakpoint::TypeId>();
 	settings.endGroup();
@@ -167,6 +173,11 @@ void Configuration::readSettings() {
         ignored_exceptions.push_back(exception.toLongLong());
     }
 
+	logged_exceptions.clear();
+	for(const QVariant &exception : settings.value("signals.log_list", QVariantList()).toList()) {
+		logged_exceptions.push_back(exception.toLongLong());
+	}
+
 	settings.endGroup();
 
 	settings.beginGroup("Window");
@@ -214,6 +225,7 @@ void Configuration::writeSettings() {
 
 	settings.beginGroup("General");
 	settings.setValue("close_behavior", close_behavior);
+	settings.setValue("max_worker_threads", max_worker_threads);
 	settings.endGroup();
 
 	settings.beginGroup("Appearance");
@@ -242,6 +254,9 @@ void Configuration::writeSettings() {
 	settings.setValue("debugger.disableASLR.enabled", disableASLR);
 	settings.setValue("debugger.disableLazyBinding.enabled", disableLazyBinding);
 	settings.setValue("debugger.break_on_library_load_event.enabled", break_on_library_load);
+	settings.setValue("debugger.non_stop_mode.enabled", non_stop_mode);
+	settings.setValue("debugger.fork_behavior", fork_behavior);
+	settings.setValue("debugger.gui_update_interval", gui_update_interval);
 	settings.setValue("debugger.default_breakpoint_type", QVariant::fromValue(default_breakpoint_type));
 	settings.endGroup();
 
@@ -273,6 +288,13 @@ void Configuration::writeSettings() {
     }
 	
 	settings.setValue("signals.ignore_list", temp_ignored_exceptions);
+
+	QVariantList temp_logged_exceptions;
+	for(qlonglong exception : logged_exceptions) {
+		temp_logged_exceptions.push_back(exception);
+	}
+
+	settings.setValue("signals.log_list", temp_logged_exceptions);
 	settings.endGroup();
 
 	settings.beginGroup("Window");
@@ -17,8 +17,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DataViewInfo.h"
+#include "MemoryDiff.h"
 #include "QHexView"
 #include "RegionBuffer.h"
+#include "ViewSearch.h"
 
 //------------------------------------------------------------------------------
 // Name: DataViewInfo
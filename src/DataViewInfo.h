@@ -21,11 +21,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <memory>
 
+#include <QSharedPointer>
 #include <QtGlobal>
 
 class QHexView;
 class RegionBuffer;
 class IRegion;
+class MemoryDiff;
+class ViewSearch;
 
 class DataViewInfo {
 public:
@@ -39,6 +42,9 @@ public:
 	std::shared_ptr<IRegion>  region;
 	RegionBuffer *const       stream;
 	std::shared_ptr<QHexView> view;
+	QSharedPointer<MemoryDiff> diff; // what the view gets its comments from, the data tabs only
+	QSharedPointer<ViewSearch> search; // find in the view, which stands in front of diff
+	bool                      stale = false; // not updated since its tab was hidden
 
 public:
 	void update();
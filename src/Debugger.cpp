@@ -18,15 +18,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Debugger.h"
 #include "ArchProcessor.h"
+#include "BinaryString.h"
 #include "CommentServer.h"
 #include "Configuration.h"
 #include "DebuggerInternal.h"
 #include "DialogAbout.h"
 #include "DialogArguments.h"
 #include "DialogAttach.h"
+#include "DialogInputBinaryString.h"
 #include "DialogMemoryRegions.h"
 #include "DialogOpenProgram.h"
-#include "DialogOptions.h"
 #include "DialogPlugins.h"
 #include "DialogThreads.h"
 #include "Expression.h"
@@ -39,7 +40,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IProcess.h"
 #include "IThread.h"
 #include "Instruction.h"
+#include "Instrumentation.h"
+#include "MemoryDiff.h"
 #include "MemoryRegions.h"
+#include "PluginUpdates.h"
 #include "QHexView"
 #include "QJsonDocument.h"
 #include "QJsonObject.h"
@@ -48,8 +52,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "RegionBuffer.h"
 #include "RegisterViewModelBase.h"
 #include "State.h"
+#include "StepCondition.h"
 #include "Symbol.h"
 #include "SymbolManager.h"
+#include "TaskScheduler.h"
+#include "TraceLog.h"
+#include "ViewSearch.h"
 #include "SessionManager.h"
 #include "SessionError.h"
 #include "edb.h"
@@ -58,6 +66,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "linker.h"
 #endif
 
+#include <QActionGroup>
 #include <QCloseEvent>
 #include <QDateTime>
 #include <QDesktopServices>
@@ -65,13 +74,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDir>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QLabel>
+#include <QMenu>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
 #include <QStringListModel>
@@ -104,35 +116,6 @@ const quint64 ld_loader_tag     = Q_UINT64_C(0x4c49424556454e54); // "LIBEVENT"
 
 
 
-template <class Addr>
-void handle_library_event(IProcess *process, edb::address_t debug_pointer) {
-	edb::linux_struct::r_debug<Addr> dynamic_info;
-	const bool ok = process->read_bytes(debug_pointer, &dynamic_info, sizeof(dynamic_info));
-	if(ok) {
-
-		// NOTE(eteran): at least on my system, the name of
-		//               what is being loaded is either in
-		//               r8 or r13 depending on which event
-		//               we are looking at.
-		// TODO(eteran): find a way to get the name reliably
-
-		switch(dynamic_info.r_state) {
-		case edb::linux_struct::r_debug<Addr>::RT_CONSISTENT:
-			// TODO(eteran): enable this once we are confident
-	#if 0
-			edb::v1::memory_regions().sync();
-	#endif
-			break;
-		case edb::linux_struct::r_debug<Addr>::RT_ADD:
-			//qDebug("LIBRARY LOAD EVENT");
-			break;
-		case edb::linux_struct::r_debug<Addr>::RT_DELETE:
-			//qDebug("LIBRARY UNLOAD EVENT");
-			break;
-		}
-	}
-}
-
 template <class Addr>
 edb::address_t find_linker_hook_address(IProcess *process, edb::address_t debug_pointer) {
 
@@ -354,9 +337,13 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 		stack_view_info_(nullptr),
 		arguments_dialog_(new DialogArguments),
 		timer_(new QTimer(this)),
+		gui_update_timer_(new QTimer(this)),
 		recent_file_manager_(new RecentFileManager(this)),
         comment_server_(new CommentServer),
-		stack_view_locked_(false)
+		last_remote_address_("localhost:1234"),
+		stack_view_locked_(false),
+		stepping_until_(false),
+		cancel_step_until_(false)
 #ifdef Q_OS_UNIX
 		,debug_pointer_(0), dynamic_info_bp_set_(false)
 #endif
@@ -366,11 +353,16 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 	// connect the timer to the debug event
 	connect(timer_, SIGNAL(timeout()), this, SLOT(next_debug_event()));
 
+	gui_update_timer_->setSingleShot(true);
+	connect(gui_update_timer_, SIGNAL(timeout()), this, SLOT(update_gui()));
+
 	// create a context menu for the tab bar as well
 	connect(ui.tabWidget, SIGNAL(customContextMenuRequested(int, const QPoint &)), this, SLOT(tab_context_menu(int, const QPoint &)));
 
 	// CPU Shortcuts
 	gotoAddressAction_           = createAction(tr("&Goto Expression..."),                           QKeySequence(tr("Ctrl+G")),   SLOT(goto_triggered()));
+	findAction_                  = createAction(tr("F&ind In View..."),                              QKeySequence(tr("Ctrl+Alt+F")), SLOT(mnuFind()));
+	findNextAction_              = createAction(tr("Find &Next In View"),                            QKeySequence(tr("Ctrl+L")),   SLOT(mnuFindNext()));
 
 	editCommentAction_           = createAction(tr("Add &Comment..."),                               QKeySequence(tr(";")),        SLOT(mnuCPUEditComment()));
 	toggleBreakpointAction_      = createAction(tr("&Toggle Breakpoint"),                            QKeySequence(tr("F2")),       SLOT(mnuCPUToggleBreakpoint()));
@@ -458,6 +450,12 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 	list_model_ = new QStringListModel(this);
 	ui.listView->setModel(list_model_);
 
+	// the processes being debugged together, listed when the menu is shown
+	auto inferiors_menu = new QMenu(this);
+	ui.action_Inferiors->setMenu(inferiors_menu);
+	connect(inferiors_menu, SIGNAL(aboutToShow()), SLOT(populate_inferiors_menu()));
+	connect(inferiors_menu, SIGNAL(triggered(QAction *)), SLOT(inferior_selected(QAction *)));
+
 	// setup the recent file manager
 	ui.action_Recent_Files->setMenu(recent_file_manager_->create_menu());
 	connect(recent_file_manager_, SIGNAL(file_selected(const QString &,const QList<QByteArray>&)), SLOT(open_file(const QString &,const QList<QByteArray>&)));
@@ -465,6 +463,9 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 	// make us the default event handler
 	edb::v1::add_debug_event_handler(this);
 
+	// size the worker pool before any plugin or view starts using it
+	edb::v1::task_scheduler().apply_settings();
+
 	// enable the arch processor
 #if 0
 	ui.registerList->setModel(&edb::v1::arch_processor().get_register_view_model());
@@ -506,6 +507,12 @@ QAction *Debugger::createAction(const QString &text, const QKeySequence &keySequ
 //------------------------------------------------------------------------------
 void Debugger::update_menu_state(GUI_STATE state) {
 
+	// resuming from a breakpoint which doesn't stop, like a tracepoint, finds
+	// everything set up for running already
+	if(state == RUNNING && gui_state_ == RUNNING) {
+		return;
+	}
+
 	static const QString Paused     = tr("paused");
 	static const QString Running    = tr("running");
 	static const QString Terminated = tr("terminated");
@@ -513,6 +520,9 @@ void Debugger::update_menu_state(GUI_STATE state) {
 	switch(state) {
 	case PAUSED:
 		ui.actionRun_Until_Return->setEnabled(true);
+		ui.actionStep_Until_Branch->setEnabled(block_step_supported());
+		ui.actionStep_Into_Until->setEnabled(true);
+		ui.actionTrace_Over_Until->setEnabled(true);
 		ui.action_Restart->setEnabled(true);
 		ui.action_Run->setEnabled(true);
 		ui.action_Pause->setEnabled(false);
@@ -524,12 +534,19 @@ void Debugger::update_menu_state(GUI_STATE state) {
 		ui.action_Run_Pass_Signal_To_Application->setEnabled(true);
 		ui.action_Detach->setEnabled(true);
 		ui.action_Kill->setEnabled(true);
+		ui.action_Attach_Inferior->setEnabled(true);
+		ui.action_Inferiors->setEnabled(true);
+		ui.actionDump_Core->setEnabled(true);
+		ui.actionSave_Snapshot->setEnabled(true);
 		add_tab_->setEnabled(true);
 		status_->setText(Paused);
 		status_->repaint();
 		break;
 	case RUNNING:
 		ui.actionRun_Until_Return->setEnabled(false);
+		ui.actionStep_Until_Branch->setEnabled(false);
+		ui.actionStep_Into_Until->setEnabled(false);
+		ui.actionTrace_Over_Until->setEnabled(false);
 		ui.action_Restart->setEnabled(false);
 		ui.action_Run->setEnabled(false);
 		ui.action_Pause->setEnabled(true);
@@ -541,12 +558,19 @@ void Debugger::update_menu_state(GUI_STATE state) {
 		ui.action_Run_Pass_Signal_To_Application->setEnabled(false);
 		ui.action_Detach->setEnabled(true);
 		ui.action_Kill->setEnabled(true);
+		ui.action_Attach_Inferior->setEnabled(false);
+		ui.action_Inferiors->setEnabled(false);
+		ui.actionDump_Core->setEnabled(false);
+		ui.actionSave_Snapshot->setEnabled(false);
 		add_tab_->setEnabled(true);
 		status_->setText(Running);
 		status_->repaint();
 		break;
 	case TERMINATED:
 		ui.actionRun_Until_Return->setEnabled(false);
+		ui.actionStep_Until_Branch->setEnabled(false);
+		ui.actionStep_Into_Until->setEnabled(false);
+		ui.actionTrace_Over_Until->setEnabled(false);
 		ui.action_Restart->setEnabled(recent_file_manager_->entry_count()>0);
 		ui.action_Run->setEnabled(false);
 		ui.action_Pause->setEnabled(false);
@@ -558,6 +582,10 @@ void Debugger::update_menu_state(GUI_STATE state) {
 		ui.action_Run_Pass_Signal_To_Application->setEnabled(false);
 		ui.action_Detach->setEnabled(false);
 		ui.action_Kill->setEnabled(false);
+		ui.action_Attach_Inferior->setEnabled(false);
+		ui.action_Inferiors->setEnabled(false);
+		ui.actionDump_Core->setEnabled(false);
+		ui.actionSave_Snapshot->setEnabled(false);
 		add_tab_->setEnabled(false);
 		status_->setText(Terminated);
 		status_->repaint();
@@ -754,7 +782,10 @@ void Debugger::create_data_tab() {
 	}
 
     // NOTE(eteran): for issue #522, allow comments in data view when single word width
-    hexview->setCommentServer(comment_server_);
+    new_data_view->diff = QSharedPointer<MemoryDiff>(new MemoryDiff(comment_server_));
+    new_data_view->search = QSharedPointer<ViewSearch>(new ViewSearch(new_data_view->diff, 0));
+    connect(new_data_view->search.data(), SIGNAL(matches_changed()), SLOT(search_matches_changed()));
+    hexview->setCommentServer(new_data_view->search);
 
 	hexview->setData(new_data_view->stream);
 
@@ -806,28 +837,30 @@ void Debugger::create_data_tab() {
 void Debugger::finish_plugin_setup() {
 
 
+	const QMap<QString, QObject *> plugins = edb::v1::plugin_list();
+
 	// call the init function for each plugin, this is done after
 	// ALL plugins are loaded in case there are inter-plugin dependencies
-	for(QObject *plugin: edb::v1::plugin_list()) {
-		if(auto p = qobject_cast<IPlugin *>(plugin)) {
+	for(auto it = plugins.begin(); it != plugins.end(); ++it) {
+		if(auto p = qobject_cast<IPlugin *>(it.value())) {
+			QElapsedTimer timer;
+			timer.start();
 			p->init();
+			edb::internal::add_plugin_startup_time(it.key(), timer.elapsed());
 		}
 	}
 
-	// setup the menu for all plugins that which to do so
-	QPointer<DialogOptions> options = qobject_cast<DialogOptions *>(edb::v1::dialog_options());
-	for(QObject *plugin: edb::v1::plugin_list()) {
-		if(auto p = qobject_cast<IPlugin *>(plugin)) {
+	// setup the menu for all plugins that which to do so, their options pages
+	// are only made once the options dialog is first shown
+	for(auto it = plugins.begin(); it != plugins.end(); ++it) {
+		if(auto p = qobject_cast<IPlugin *>(it.value())) {
+			QElapsedTimer timer;
+			timer.start();
+
 			if(QMenu *const menu = p->menu(this)) {
 				ui.menu_Plugins->addMenu(menu);
 			}
 
-			if(QWidget *const options_page = p->options_page()) {
-				if(options) {
-					options->addOptionsPage(options_page);
-				}
-			}
-
 			// setup the shortcuts for these actions
 			const QList<QAction *> register_actions = p->register_context_menu();
 			const QList<QAction *> cpu_actions      = p->cpu_context_menu();
@@ -841,6 +874,8 @@ void Debugger::finish_plugin_setup() {
 					connect(new QShortcut(shortcut, this), SIGNAL(activated()), action, SLOT(trigger()));
 				}
 			}
+
+			edb::internal::add_plugin_startup_time(it.key(), timer.elapsed());
 		}
 	}
 }
@@ -961,8 +996,10 @@ void Debugger::setup_stack_view() {
 	// this may get transitioned to heap allocated, we'll see
 	stack_view_info_.view = stack_view_;
 
-	// setup the comment server for the stack viewer
-    stack_view_->setCommentServer(comment_server_);
+	// setup the comment server for the stack viewer, one word to a row
+	stack_view_info_.search = QSharedPointer<ViewSearch>(new ViewSearch(comment_server_, 1));
+	connect(stack_view_info_.search.data(), SIGNAL(matches_changed()), SLOT(search_matches_changed()));
+    stack_view_->setCommentServer(stack_view_info_.search);
 }
 
 //------------------------------------------------------------------------------
@@ -978,6 +1015,7 @@ void Debugger::closeEvent(QCloseEvent *event) {
 	}
 
 	if(const auto& dc = edb::v1::debugger_core) {
+		Q_EMIT aboutToDetach();
 		dc->end_debug_session();
 	}
 
@@ -1318,8 +1356,14 @@ void Debugger::step_over(F1 run_func, F2 step_func) {
 				edb::Instruction inst(buffer, buffer + sz, 0);
 				if(inst && edb::v1::arch_processor().can_step_over(inst)) {
 
-					// add a temporary breakpoint at the instruction just
-					// after the call
+					// stop at the instruction just after the call, a free
+					// debug register does that without touching the code
+					if(add_hardware_stop(ip + inst.byte_size())) {
+						run_func();
+						return;
+					}
+
+					// otherwise add a temporary breakpoint there
 					if(std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core->add_breakpoint(ip + inst.byte_size())) {
 						bp->set_internal(true);
 						bp->set_one_time(true);
@@ -1802,6 +1846,9 @@ void Debugger::mnuStackContextMenu(const QPoint &pos) {
 	menu->addAction(gotoAddressAction_);
 	menu->addAction(stackGotoRSPAction_);
 	menu->addAction(stackGotoRBPAction_);
+	menu->addSeparator();
+	menu->addAction(findAction_);
+	menu->addAction(findNextAction_);
 
 	menu->addSeparator();
 	menu->addAction(editBytesAction_);
@@ -1839,13 +1886,61 @@ void Debugger::mnuDumpContextMenu(const QPoint &pos) {
 	menu->addAction(dumpFollowInStackAction_);
 	menu->addAction(gotoAddressAction_);
 	menu->addSeparator();
+	menu->addAction(findAction_);
+	menu->addAction(findNextAction_);
+	menu->addSeparator();
 	menu->addAction(editBytesAction_);
 	menu->addSeparator();
 	menu->addAction(dumpSaveToFileAction_);
 
+	// the changes are marked for this tab only
+	const std::shared_ptr<DataViewInfo> info = current_data_view_info();
+	QAction *highlight = nullptr;
+	QActionGroup *baselines = nullptr;
+
+	if(info && info->diff) {
+		menu->addSeparator();
+		highlight = menu->addAction(tr("&Highlight Changes"));
+		highlight->setCheckable(true);
+		highlight->setChecked(info->diff->enabled());
+
+		QMenu *const since = menu->addMenu(tr("Changes Si&nce"));
+		baselines = new QActionGroup(menu);
+
+		QAction *const previous = since->addAction(tr("The &Previous Stop"));
+		previous->setData(0);
+		baselines->addAction(previous);
+
+		for(const Checkpoint &checkpoint : edb::v1::debugger_core->checkpoints()) {
+			QAction *const action = since->addAction(tr("Checkpoint %1 at %2").arg(checkpoint.id).arg(edb::v1::format_pointer(checkpoint.address)));
+			action->setData(checkpoint.id);
+			baselines->addAction(action);
+		}
+
+		for(QAction *action : baselines->actions()) {
+			action->setCheckable(true);
+			action->setChecked(action->data().toInt() == info->diff->baseline());
+		}
+	}
+
 	add_plugin_context_menu(menu, &IPlugin::data_context_menu);
 
-	menu->exec(s->mapToGlobal(pos));
+	QAction *const chosen = menu->exec(s->mapToGlobal(pos));
+	if(chosen && (chosen == highlight || (baselines && chosen->actionGroup() == baselines))) {
+		if(chosen == highlight) {
+			info->diff->set_enabled(chosen->isChecked());
+		} else {
+			info->diff->set_baseline(chosen->data().toInt());
+			info->diff->set_enabled(true);
+		}
+
+		// the changes are shown where the comments go
+		if(info->diff->enabled()) {
+			s->setShowComments(true);
+		}
+		s->update();
+	}
+
 	delete menu;
 }
 
@@ -1883,9 +1978,11 @@ void Debugger::cpu_fill(quint8 byte) {
 	if(size != 0) {
 		if(IProcess *process = edb::v1::debugger_core->process()) {
 			if(edb::v1::overwrite_check(address, size)) {
-				QByteArray bytes(size, byte);
+				// one read of what was there, one write and one refresh, however
+				// large the selection. The patch is merged with any it touches
+				const QByteArray bytes(size, byte);
 
-				process->write_bytes(address, bytes.data(), size);
+				process->patch_bytes(address, bytes.constData(), size);
 
 				// do a refresh, not full update
 				refresh_gui();
@@ -1944,7 +2041,7 @@ void Debugger::mnuCPURemoveComment() {
 void Debugger::run_to_this_line(EXCEPTION_RESUME pass_signal) {
 	const edb::address_t address = ui.cpuView->selectedAddress();
 	std::shared_ptr<IBreakpoint> bp = edb::v1::find_breakpoint(address);
-	if(!bp) {
+	if(!bp && !add_hardware_stop(address)) {
 		bp = edb::v1::create_breakpoint(address);
 		if(!bp) return;
 		bp->set_one_time(true);
@@ -2127,6 +2224,97 @@ void Debugger::mnuModifyBytes() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: find_in_view
+// Desc: find (or find next, if <next> is set and there was a find before) in
+//       the stack view if it has the focus, otherwise in the current data tab
+//------------------------------------------------------------------------------
+void Debugger::find_in_view(bool next) {
+
+	std::shared_ptr<QHexView> view;
+	std::shared_ptr<IRegion>  region;
+	QSharedPointer<ViewSearch> search;
+
+	if(QApplication::focusWidget() == stack_view_.get()) {
+		view   = stack_view_;
+		region = stack_view_info_.region;
+		search = stack_view_info_.search;
+	} else if(const std::shared_ptr<DataViewInfo> info = current_data_view_info()) {
+		view   = info->view;
+		region = info->region;
+		search = info->search;
+	}
+
+	if(!view || !region || !search) {
+		return;
+	}
+
+	edb::address_t from = region->start();
+	if(view->hasSelectedText()) {
+		from = view->selectedBytesAddress();
+	}
+
+	if(next && !search->isEmpty()) {
+		if(search->has_last_match()) {
+			from = search->last_match() + 1;
+		}
+	} else {
+		static auto dialog = new DialogInputBinaryString(this);
+		dialog->setWindowTitle(tr("Find In View"));
+
+		BinaryString *const bs = dialog->binary_string();
+		bs->setWildcardsAllowed(true);
+		bs->setValue(search->bytes());
+
+		if(dialog->exec() != QDialog::Accepted || bs->value().isEmpty()) {
+			return;
+		}
+
+		search->set_pattern(bs->value(), bs->mask());
+	}
+
+	const Result<edb::address_t> match = search->find_next(region, from);
+	if(!match) {
+		edb::v1::set_status(match.errorMessage());
+		return;
+	}
+
+	view->scrollTo(*match - region->start());
+	edb::v1::set_status(search->describe(*match), 0);
+}
+
+//------------------------------------------------------------------------------
+// Name: mnuFind
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::mnuFind() {
+	find_in_view(false);
+}
+
+//------------------------------------------------------------------------------
+// Name: mnuFindNext
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::mnuFindNext() {
+	find_in_view(true);
+}
+
+//------------------------------------------------------------------------------
+// Name: search_matches_changed
+// Desc: the views mark the rows with matches where the comments go
+//------------------------------------------------------------------------------
+void Debugger::search_matches_changed() {
+	if(stack_view_info_.search.data() == sender()) {
+		stack_view_->update();
+	}
+
+	Q_FOREACH(const std::shared_ptr<DataViewInfo> &info, data_regions_) {
+		if(info->search.data() == sender()) {
+			info->view->update();
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: mnuDumpModify
 // Desc:
@@ -2143,19 +2331,88 @@ void Debugger::mnuStackModify() {
 	modify_bytes(stack_view_);
 }
 
+//------------------------------------------------------------------------------
+// Name: evaluate_breakpoint_expression
+// Desc: the expression is only parsed when it is first evaluated after being
+//       set (or after modules were loaded or unloaded, since symbols are
+//       resolved as part of that), every other hit just runs the compiled
+//       form against the already fetched state
+//------------------------------------------------------------------------------
+bool Debugger::evaluate_breakpoint_expression(CompiledBreakpointExpression *compiled, const QString &text, const State &state, edb::address_t *value, ExpressionError *err) {
+
+	Q_ASSERT(compiled);
+	Q_ASSERT(value);
+	Q_ASSERT(err);
+
+	const quint64 generation = edb::v1::memory_regions().modules_generation();
+
+	std::shared_ptr<Expression<edb::address_t>> &expr = compiled->expression;
+	if(!expr || expr->expression() != text || compiled->generation != generation) {
+		expr = std::make_shared<Expression<edb::address_t>>(text, edb::v1::get_variable, edb::v1::get_value);
+		compiled->generation = generation;
+
+		ExpressionError compile_error;
+		expr->compile([&state](const QString &name, edb::address_t *value) {
+			// registers take priority over symbols of the same name
+			if(state.value(name).valid()) {
+				return false;
+			}
+
+			if(const std::shared_ptr<Symbol> sym = edb::v1::symbol_manager().find(name)) {
+				*value = sym->address;
+				return true;
+			}
+
+			return false;
+		}, &compile_error);
+	}
+
+	auto state_variable = [&state](const QString &name, bool *ok, ExpressionError *err) {
+		return edb::v1::get_state_variable(state, name, ok, err);
+	};
+
+	bool ok;
+	*value = expr->evaluate_expression(state_variable, edb::v1::get_value, &ok, err);
+	return ok;
+}
+
 //------------------------------------------------------------------------------
 // Name: breakpoint_condition_true
 // Desc:
 //------------------------------------------------------------------------------
-bool Debugger::breakpoint_condition_true(const QString &condition) {
+bool Debugger::breakpoint_condition_true(const std::shared_ptr<IBreakpoint> &bp, const State &state) {
 
 	edb::address_t condition_value;
-	if(!edb::v1::eval_expression(condition, &condition_value)) {
+	ExpressionError err;
+	if(!evaluate_breakpoint_expression(&bp->compiled_condition, bp->condition, state, &condition_value, &err)) {
+		QMessageBox::critical(this, tr("Error In Expression!"), err.what());
 		return true;
 	}
+
 	return condition_value;
 }
 
+//------------------------------------------------------------------------------
+// Name: record_tracepoint
+// Desc: logs a tracepoint hit. This never stops, so a bad expression is just
+//       recorded as having no value
+//------------------------------------------------------------------------------
+void Debugger::record_tracepoint(const std::shared_ptr<IBreakpoint> &bp, const std::shared_ptr<IDebugEvent> &event, const State &state) {
+
+	TraceRecord &record = edb::v1::trace_log().append();
+	record.hit_count    = bp->hit_count();
+	record.address      = bp->address();
+	record.tid          = event->thread();
+
+	if(bp->trace_expression.isEmpty()) {
+		record.state     = state;
+		record.has_state = true;
+	} else {
+		ExpressionError err;
+		record.has_value = evaluate_breakpoint_expression(&bp->compiled_trace_expression, bp->trace_expression, state, &record.value, &err);
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: handle_trap
 // Desc: returns true if we should resume as if this trap never happened
@@ -2167,9 +2424,32 @@ edb::EVENT_STATUS Debugger::handle_trap(const std::shared_ptr<IDebugEvent> &even
 	// #2: we did a step
 	// #3: we hit a 0xcc naturally in the program
 	// #4: we hit a hardware breakpoint!
+	// #5: a system call we asked to stop at
+	if(event->trap_reason() == IDebugEvent::TRAP_SYSCALL) {
+		if(event->syscall_exit()) {
+			edb::v1::set_status(tr("Stopped on return from system call %1").arg(event->syscall_number()), 0);
+		} else {
+			edb::v1::set_status(tr("Stopped on entry to system call %1").arg(event->syscall_number()), 0);
+		}
+		return edb::DEBUG_STOP;
+	}
+
 	State state;
 	edb::v1::debugger_core->get_state(&state);
 
+	// a hardware stop is done with once we get to it, however we got there.
+	// If its debug register was what triggered, the stop is ours
+	for(auto it = hardware_stops_.begin(); it != hardware_stops_.end(); ++it) {
+		if(it.value() == state.instruction_pointer()) {
+			const int slot = it.key();
+			remove_hardware_stop(slot);
+			if(state.debug_register(6) & (1u << slot)) {
+				return edb::DEBUG_STOP;
+			}
+			break;
+		}
+	}
+
 	// look it up in our breakpoint list, make sure it is one of OUR int3s!
 	// if it is, we need to backup EIP and pause ourselves
 	const std::shared_ptr<IBreakpoint> bp = event->trap_reason()==IDebugEvent::TRAP_STEPPING ?
@@ -2181,7 +2461,10 @@ edb::EVENT_STATUS Debugger::handle_trap(const std::shared_ptr<IDebugEvent> &even
 		const edb::address_t previous_ip = bp->address();
 
 		// TODO: check if the breakpoint was corrupted?
-		bp->hit();
+		const bool counted = bp->counts_hits_by(event->thread());
+		if(counted) {
+			bp->hit();
+		}
 
 		// back up eip the size of a breakpoint, since we executed a breakpoint
 		// instead of the real code that belongs there
@@ -2194,19 +2477,25 @@ edb::EVENT_STATUS Debugger::handle_trap(const std::shared_ptr<IDebugEvent> &even
 		// TODO(eteran): add an option to let the user stop of debug events
 		if(bp->internal() && bp->tag == ld_loader_tag) {
 
+			LinkMapTracker::Changes changes;
 			if(dynamic_info_bp_set_) {
-				if(IProcess *process = edb::v1::debugger_core->process()) {
-					if(debug_pointer_) {
-						if(edb::v1::debuggeeIs32Bit()) {
-							handle_library_event<uint32_t>(process, debug_pointer_);
-						} else {
-							handle_library_event<uint64_t>(process, debug_pointer_);
-						}
-					}
-				}
+				changes = link_map_.update(edb::v1::debugger_core->process(), debug_pointer_, edb::v1::debuggeeIs32Bit());
 			}
 
-			if(edb::v1::config().break_on_library_load) {
+			arm_pending_breakpoints(changes.added);
+
+			// only stop once the linker is done, the intermediate states aren't interesting
+			if(edb::v1::config().break_on_library_load && !changes.isEmpty()) {
+				QStringList names;
+				for(const Module &module : changes.added) {
+					names << tr("loaded %1").arg(module.name);
+				}
+
+				for(const Module &module : changes.removed) {
+					names << tr("unloaded %1").arg(module.name);
+				}
+
+				edb::v1::set_status(tr("Library event: %1").arg(names.join(", ")), 0);
 				return edb::DEBUG_STOP;
 			} else {
 				return edb::DEBUG_CONTINUE_BP;
@@ -2214,15 +2503,26 @@ edb::EVENT_STATUS Debugger::handle_trap(const std::shared_ptr<IDebugEvent> &even
 		}
 #endif
 
-		const QString condition = bp->condition;
+		// the native filters cost next to nothing, unlike a condition doing
+		// the same, so they go first
+		if(!counted || bp->hit_filtered(bp->hit_count())) {
+			return edb::DEBUG_CONTINUE_BP;
+		}
 
 		// handle conditional breakpoints
-		if(!condition.isEmpty()) {
-			if(!breakpoint_condition_true(condition)) {
+		if(!bp->condition.isEmpty()) {
+			if(!breakpoint_condition_true(bp, state)) {
 				return edb::DEBUG_CONTINUE_BP;
 			}
 		}
 
+		// tracepoints only leave a record behind, so we don't pay for a full
+		// stop and GUI refresh on every hit
+		if(bp->tracepoint) {
+			record_tracepoint(bp, event, state);
+			return edb::DEBUG_CONTINUE_BP;
+		}
+
 		// if it's a one time breakpoint then we should remove it upon
 		// triggering, this is mainly used for situations like step over
 
@@ -2234,6 +2534,72 @@ edb::EVENT_STATUS Debugger::handle_trap(const std::shared_ptr<IDebugEvent> &even
 	return edb::DEBUG_STOP;
 }
 
+//------------------------------------------------------------------------------
+// Name: add_hardware_stop
+// Desc: arms a free debug register in every thread to stop on executing
+//       <address>. Returns false if there isn't one, the caller falls back to
+//       a one-time breakpoint
+//------------------------------------------------------------------------------
+bool Debugger::add_hardware_stop(edb::address_t address) {
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
+
+			// it would trigger again right away, a breakpoint there gets
+			// stepped over when resuming instead
+			State state;
+			thread->get_state(&state);
+			if(state.instruction_pointer() == address) {
+				return false;
+			}
+
+			// DR7 holds a local and a global enable bit for each slot, a slot
+			// is only ours to use if neither is set (e.g. by the plugin)
+			const IThread::DebugRegisters current = thread->get_debug_registers();
+			for(int slot = 0; slot < 4; ++slot) {
+				if(hardware_stops_.contains(slot) || (current[7] & (0x03 << (slot * 2))) != 0) {
+					continue;
+				}
+
+				process->for_each_thread([address, slot](const std::shared_ptr<IThread> &t) {
+					IThread::DebugRegisters regs = t->get_debug_registers();
+					regs[slot] = address;
+					// locally enabled, execute, 1 byte
+					regs[7] = (regs[7] & ~(0x0f << (16 + slot * 4))) | (0x01 << (slot * 2));
+					t->set_debug_registers(regs);
+				});
+
+				hardware_stops_.insert(slot, address);
+				return true;
+			}
+		}
+	}
+#else
+	Q_UNUSED(address);
+#endif
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_hardware_stop
+// Desc: gives a debug register taken by add_hardware_stop back
+//------------------------------------------------------------------------------
+void Debugger::remove_hardware_stop(int slot) {
+
+	hardware_stops_.remove(slot);
+
+#if defined(EDB_X86) || defined(EDB_X86_64)
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		process->for_each_thread([slot](const std::shared_ptr<IThread> &t) {
+			IThread::DebugRegisters regs = t->get_debug_registers();
+			regs[slot] = 0;
+			regs[7]    = regs[7] & ~(0x03 << (slot * 2));
+			t->set_debug_registers(regs);
+		});
+	}
+#endif
+}
+
 //------------------------------------------------------------------------------
 // Name: handle_event_stopped
 // Desc:
@@ -2281,7 +2647,7 @@ edb::EVENT_STATUS Debugger::handle_event_stopped(const std::shared_ptr<IDebugEve
 	if(it != known_exceptions.end()) {
 
     	const Configuration &config = edb::v1::config();
-    	if(config.ignored_exceptions.contains(it.key())) {
+    	if(config.ignored_exceptions.contains(it.key()) || config.logged_exceptions.contains(it.key())) {
         	return edb::DEBUG_EXCEPTION_NOT_HANDLED;
     	}
 
@@ -2314,6 +2680,14 @@ edb::EVENT_STATUS Debugger::handle_event_stopped(const std::shared_ptr<IDebugEve
 // Desc:
 //------------------------------------------------------------------------------
 edb::EVENT_STATUS Debugger::handle_event_terminated(const std::shared_ptr<IDebugEvent> &event) {
+	if(release_exited_inferior()) {
+		QMessageBox::information(
+			this,
+			tr("Process Terminated"),
+			tr("Process %1 was terminated with exit code %2, the other processes are still being debugged.").arg(event->process()).arg(event->code()));
+		return edb::DEBUG_STOP;
+	}
+
 	on_action_Detach_triggered();
 	QMessageBox::information(
 		this,
@@ -2328,6 +2702,14 @@ edb::EVENT_STATUS Debugger::handle_event_terminated(const std::shared_ptr<IDebug
 // Desc:
 //------------------------------------------------------------------------------
 edb::EVENT_STATUS Debugger::handle_event_exited(const std::shared_ptr<IDebugEvent> &event) {
+	if(release_exited_inferior()) {
+		QMessageBox::information(
+			this,
+			tr("Process Exited"),
+			tr("Process %1 exited normally with exit code %2, the other processes are still being debugged.").arg(event->process()).arg(event->code()));
+		return edb::DEBUG_STOP;
+	}
+
 	on_action_Detach_triggered();
 	QMessageBox::information(
 		this,
@@ -2409,7 +2791,12 @@ void Debugger::update_data(const std::shared_ptr<DataViewInfo> &v) {
 
 	Q_ASSERT(view);
 
+	if(v->diff) {
+		v->diff->update(v->region, stops_);
+	}
+
 	v->update();
+	v->stale = false;
 
 	update_tab_caption(view, v->region->start(), v->region->end());
 }
@@ -2428,6 +2815,7 @@ void Debugger::clear_data(const std::shared_ptr<DataViewInfo> &v) {
 
 	view->clear();
 	view->scrollTo(0);
+	v->stale = false;
 
 	update_tab_caption(view, 0, 0);
 }
@@ -2496,23 +2884,60 @@ void Debugger::update_data_views() {
 
 		// make sure the regions are still valid..
 		if(info->region && edb::v1::memory_regions().find_region(info->region->start())) {
-			update_data(info);
+
+			// only the tab in front can be seen, the others catch up when
+			// they are brought to the front
+			if(ui.tabWidget->currentWidget() == info->view.get()) {
+				update_data(info);
+			} else {
+				info->stale = true;
+			}
 		} else {
 			clear_data(info);
 		}
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: on_tabWidget_currentChanged
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::on_tabWidget_currentChanged(int index) {
+
+	QWidget *const widget = ui.tabWidget->widget(index);
+
+	Q_FOREACH(const std::shared_ptr<DataViewInfo> &info, data_regions_) {
+		if(info->view.get() == widget && info->stale) {
+			if(info->region && edb::v1::memory_regions().find_region(info->region->start())) {
+				update_data(info);
+			} else {
+				clear_data(info);
+			}
+			break;
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: refresh_gui
 // Desc: refreshes all the different displays
 //------------------------------------------------------------------------------
 void Debugger::refresh_gui() {
 
+	// this is how the debuggee's memory having been written to is announced
+	comment_server_->invalidate();
+	edb::v1::arch_processor().invalidate_instruction_info();
+
 	ui.cpuView->update();
 	stack_view_->update();
 
+	stack_view_info_.search->invalidate();
+
 	Q_FOREACH(const std::shared_ptr<DataViewInfo> &info, data_regions_) {
+		if(info->diff) {
+			info->diff->invalidate();
+		}
+		info->search->invalidate();
 		info->view->update();
 	}
 
@@ -2531,9 +2956,38 @@ void Debugger::refresh_gui() {
 
 //------------------------------------------------------------------------------
 // Name: update_gui
-// Desc: updates all the different displays
+// Desc: updates all the different displays, which is where the command that
+//       led here (a step, a run, ...) is done
 //------------------------------------------------------------------------------
 void Debugger::update_gui() {
+	{
+		EDB_TRACE_SEGMENT("Debugger::update_gui", GuiRefresh);
+		update_views();
+	}
+	Instrumentation::end_command();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_views
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::update_views() {
+
+	gui_update_timer_->stop();
+	last_gui_update_.start();
+
+	if(skipped_gui_updates_ != 0) {
+		qDebug("[Debugger] drew %d stops in one update", skipped_gui_updates_ + 1);
+		skipped_gui_updates_ = 0;
+	}
+
+	comment_server_->invalidate();
+
+	// the matches found at the previous stop may be gone
+	stack_view_info_.search->invalidate();
+	Q_FOREACH(const std::shared_ptr<DataViewInfo> &info, data_regions_) {
+		info->search->invalidate();
+	}
 
 	if(edb::v1::debugger_core) {
 
@@ -2544,8 +2998,21 @@ void Debugger::update_gui() {
 			}
 		}
 
-		update_data_views();
-		update_stack_view(state);
+		// the views which can't be seen are brought up to date when they
+		// can be again
+		if(ui.dataDock->isVisible()) {
+			update_data_views();
+			data_views_stale_ = false;
+		} else {
+			data_views_stale_ = true;
+		}
+
+		if(ui.stackDock->isVisible()) {
+			update_stack_view(state);
+			stack_view_stale_ = false;
+		} else {
+			stack_view_stale_ = true;
+		}
 
 		if(const std::shared_ptr<IRegion> region = update_cpu_view(state)) {
 			edb::v1::arch_processor().update_register_view(region->name(), state);
@@ -2557,33 +3024,92 @@ void Debugger::update_gui() {
 	//Signal all connected slots that the GUI has been updated.
 	//Useful for plugins with windows that should updated after
 	//hitting breakpoints, Step Over, etc.
+	EDB_TRACE_SCOPE("gui_updated handlers");
 	Q_EMIT gui_updated();
+
+	// and the plugins which asked to be updated in their own way, which
+	// unlike the above are timed one by one
+	PluginUpdates::instance().dispatch();
 }
 
 //------------------------------------------------------------------------------
-// Name: resume_status
-// Desc:
+// Name: schedule_gui_update
+// Desc: like update_gui, for stops which may come faster than they can be
+//       drawn, while a step is held down for example. A stop within
+//       gui_update_interval of the last update is drawn together with any
+//       others which follow it, once the interval is over. The stops are still
+//       handled in full, only drawing them is put off
 //------------------------------------------------------------------------------
-edb::EVENT_STATUS Debugger::resume_status(bool pass_exception) {
+void Debugger::schedule_gui_update() {
 
-	if(pass_exception && last_event_ && last_event_->stopped() && !last_event_->is_trap()) {
-		return edb::DEBUG_EXCEPTION_NOT_HANDLED;
-	} else {
-		return edb::DEBUG_CONTINUE;
+	const int interval = edb::v1::config().gui_update_interval;
+
+	if(interval <= 0 || !last_gui_update_.isValid() || last_gui_update_.elapsed() >= interval) {
+		update_gui();
+		return;
+	}
+
+	++skipped_gui_updates_;
+
+	if(!gui_update_timer_->isActive()) {
+		gui_update_timer_->start(static_cast<int>(interval - last_gui_update_.elapsed()));
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: resume_execution
-// Desc: resumes execution, handles the situation of being on a breakpoint as well
+// Name: on_dataDock_visibilityChanged
+// Desc:
 //------------------------------------------------------------------------------
-void Debugger::resume_execution(EXCEPTION_RESUME pass_exception, DEBUG_MODE mode, ResumeFlags flags) {
-
-	edb::v1::clear_status();
-	Q_ASSERT(edb::v1::debugger_core);
+void Debugger::on_dataDock_visibilityChanged(bool visible) {
+	if(visible && data_views_stale_) {
+		data_views_stale_ = false;
+		update_data_views();
+	}
+}
 
-	if(IProcess *process = edb::v1::debugger_core->process()) {
-		if(std::shared_ptr<IThread> thread = process->current_thread()) {
+//------------------------------------------------------------------------------
+// Name: on_stackDock_visibilityChanged
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::on_stackDock_visibilityChanged(bool visible) {
+	if(visible && stack_view_stale_) {
+		stack_view_stale_ = false;
+
+		State state;
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			if(std::shared_ptr<IThread> thread = process->current_thread()) {
+				thread->get_state(&state);
+			}
+		}
+
+		update_stack_view(state);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: resume_status
+// Desc:
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS Debugger::resume_status(bool pass_exception) {
+
+	if(pass_exception && last_event_ && last_event_->stopped() && !last_event_->is_trap()) {
+		return edb::DEBUG_EXCEPTION_NOT_HANDLED;
+	} else {
+		return edb::DEBUG_CONTINUE;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: resume_execution
+// Desc: resumes execution, handles the situation of being on a breakpoint as well
+//------------------------------------------------------------------------------
+void Debugger::resume_execution(EXCEPTION_RESUME pass_exception, DEBUG_MODE mode, ResumeFlags flags) {
+
+	edb::v1::clear_status();
+	Q_ASSERT(edb::v1::debugger_core);
+
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
 
 			// if necessary pass the trap to the application, otherwise just resume
 			// as normal
@@ -2601,6 +3127,10 @@ void Debugger::resume_execution(EXCEPTION_RESUME pass_exception, DEBUG_MODE mode
 			}
 
 			edb::v1::arch_processor().about_to_resume();
+			comment_server_->invalidate();
+
+			// a stop which is yet to be drawn is out of date now
+			gui_update_timer_->stop();
 
 			if(mode == MODE_STEP) {
 				reenable_breakpoint_step_ = bp;
@@ -2609,6 +3139,13 @@ void Debugger::resume_execution(EXCEPTION_RESUME pass_exception, DEBUG_MODE mode
 					QMessageBox::critical(this,tr("Error"),tr("Failed to step thread: %1").arg(stepStatus.toString()));
 					return;
 				}
+			} else if(mode == MODE_STEP_BLOCK) {
+				reenable_breakpoint_step_ = bp;
+				const auto stepStatus=thread->step_block(status);
+				if(!stepStatus) {
+					QMessageBox::critical(this,tr("Error"),tr("Failed to step thread: %1").arg(stepStatus.toString()));
+					return;
+				}
 			} else if(mode == MODE_RUN) {
 				reenable_breakpoint_run_ = bp;
 				if(bp) {
@@ -2638,6 +3175,7 @@ void Debugger::resume_execution(EXCEPTION_RESUME pass_exception, DEBUG_MODE mode
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Run_Pass_Signal_To_Application_triggered() {
+	Instrumentation::begin_command(Instrumentation::Run);
 	resume_execution(PASS_EXCEPTION, MODE_RUN, ResumeFlag::None);
 }
 
@@ -2646,6 +3184,7 @@ void Debugger::on_action_Run_Pass_Signal_To_Application_triggered() {
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Step_Into_Pass_Signal_To_Application_triggered() {
+	Instrumentation::begin_command(Instrumentation::StepInto);
 	resume_execution(PASS_EXCEPTION, MODE_STEP, ResumeFlag::None);
 }
 
@@ -2654,6 +3193,7 @@ void Debugger::on_action_Step_Into_Pass_Signal_To_Application_triggered() {
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Run_triggered() {
+	Instrumentation::begin_command(Instrumentation::Run);
 	resume_execution(IGNORE_EXCEPTION, MODE_RUN, ResumeFlag::None);
 }
 
@@ -2662,6 +3202,7 @@ void Debugger::on_action_Run_triggered() {
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Step_Into_triggered() {
+	Instrumentation::begin_command(Instrumentation::StepInto);
 	resume_execution(IGNORE_EXCEPTION, MODE_STEP, ResumeFlag::None);
 }
 
@@ -2681,14 +3222,114 @@ void Debugger::on_action_Kill_triggered() {
 	detach_from_process(KILL_ON_DETACH);
 }
 
+//------------------------------------------------------------------------------
+// Name: on_actionDump_Core_triggered
+// Desc: writes a core file of the paused process, so that it can be looked at
+//       later while the process itself is restarted
+//------------------------------------------------------------------------------
+void Debugger::on_actionDump_Core_triggered() {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return;
+	}
+
+	const QString filename = QFileDialog::getSaveFileName(
+		this,
+		tr("Dump Core"),
+		QString("%1/core.%2").arg(working_directory_.isEmpty() ? QDir::currentPath() : working_directory_).arg(process->pid()),
+		tr("Core Files (core.*);;Compressed Core Files (*.gz);;All Files (*)"));
+
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	// asking for a .gz gets a compressed one
+	const bool compress = filename.endsWith(".gz", Qt::CaseInsensitive);
+
+	QProgressDialog progress(tr("Writing the core file..."), tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	const Status status = process->write_core(filename, compress, [&progress](int percent) {
+		progress.setValue(percent);
+		return !progress.wasCanceled();
+	});
+
+	progress.reset();
+
+	if(!status) {
+		if(!progress.wasCanceled()) {
+			QMessageBox::critical(this, tr("Dump Core"), tr("Failed to write the core file: %1").arg(status.toString()));
+		}
+		return;
+	}
+
+	edb::v1::set_status(tr("Wrote %1 in %2 ms").arg(filename).arg(timer.elapsed()), 0);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_actionSave_Snapshot_triggered
+// Desc: like dumping a core, but snapshots saved in the same directory share
+//       their pages, so a process can be snapshotted again and again to
+//       compare. The session goes alongside, it is loaded with the snapshot
+//------------------------------------------------------------------------------
+void Debugger::on_actionSave_Snapshot_triggered() {
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return;
+	}
+
+	const QString filename = QFileDialog::getSaveFileName(
+		this,
+		tr("Save Snapshot"),
+		QString("%1/%2-%3.snapshot").arg(last_open_directory_.isEmpty() ? QDir::currentPath() : QFileInfo(last_open_directory_).absolutePath(), process->name(), QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")),
+		tr("Snapshots (*.snapshot);;All Files (*)"));
+
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	QProgressDialog progress(tr("Saving the snapshot..."), tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	const Status status = process->write_snapshot(filename, [&progress](int percent) {
+		progress.setValue(percent);
+		return !progress.wasCanceled();
+	});
+
+	progress.reset();
+
+	if(!status) {
+		if(!progress.wasCanceled()) {
+			QMessageBox::critical(this, tr("Save Snapshot"), tr("Failed to save the snapshot: %1").arg(status.toString()));
+		}
+		return;
+	}
+
+	SessionManager::instance().save_session(QString("%1.edb").arg(filename));
+
+	edb::v1::set_status(tr("Saved %1 in %2 ms").arg(filename).arg(timer.elapsed()), 0);
+}
+
 //------------------------------------------------------------------------------
 // Name: on_action_Step_Over_Pass_Signal_To_Application_triggered
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Step_Over_Pass_Signal_To_Application_triggered() {
+	// not through the run and step slots, this is timed as a step over
+	Instrumentation::begin_command(Instrumentation::StepOver);
 	step_over(
-		std::bind(&Debugger::on_action_Run_Pass_Signal_To_Application_triggered, this),
-		std::bind(&Debugger::on_action_Step_Into_Pass_Signal_To_Application_triggered, this));
+		[this]() { resume_execution(PASS_EXCEPTION, MODE_RUN, ResumeFlag::None); },
+		[this]() { resume_execution(PASS_EXCEPTION, MODE_STEP, ResumeFlag::None); });
 }
 
 //------------------------------------------------------------------------------
@@ -2696,9 +3337,10 @@ void Debugger::on_action_Step_Over_Pass_Signal_To_Application_triggered() {
 // Desc:
 //------------------------------------------------------------------------------
 void Debugger::on_action_Step_Over_triggered() {
+	Instrumentation::begin_command(Instrumentation::StepOver);
 	step_over(
-		std::bind(&Debugger::on_action_Run_triggered, this),
-		std::bind(&Debugger::on_action_Step_Into_triggered, this));
+		[this]() { resume_execution(IGNORE_EXCEPTION, MODE_RUN, ResumeFlag::None); },
+		[this]() { resume_execution(IGNORE_EXCEPTION, MODE_STEP, ResumeFlag::None); });
 }
 
 //------------------------------------------------------------------------------
@@ -2709,6 +3351,144 @@ void Debugger::on_actionStep_Out_triggered() {
 	on_actionRun_Until_Return_triggered();
 }
 
+//------------------------------------------------------------------------------
+// Name: block_step_supported
+// Desc:
+//------------------------------------------------------------------------------
+bool Debugger::block_step_supported() const {
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		if(std::shared_ptr<IThread> thread = process->current_thread()) {
+			return thread->supports_block_step();
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_actionStep_Until_Branch_triggered
+// Desc: runs until the next taken branch, a single stop instead of one per
+//       instruction
+//------------------------------------------------------------------------------
+void Debugger::on_actionStep_Until_Branch_triggered() {
+	resume_execution(IGNORE_EXCEPTION, MODE_STEP_BLOCK, ResumeFlag::None);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_actionStep_Into_Until_triggered
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::on_actionStep_Into_Until_triggered() {
+	step_until(tr("Step Into Until"), false);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_actionTrace_Over_Until_triggered
+// Desc: like step into until, but the condition isn't checked inside of
+//       the functions which get called
+//------------------------------------------------------------------------------
+void Debugger::on_actionTrace_Over_Until_triggered() {
+	step_until(tr("Trace Over Until"), true);
+}
+
+//------------------------------------------------------------------------------
+// Name: step_until
+// Desc: the core does the stepping, without coming back here (or redrawing)
+//       for each instruction, and only the final stop is shown. Pause
+//       cancels it
+//------------------------------------------------------------------------------
+void Debugger::step_until(const QString &title, bool over_calls) {
+
+	bool ok;
+	const QString text = QInputDialog::getText(
+	                         this,
+	                         title,
+	                         tr("Stop once this expression is true:"),
+	                         QLineEdit::Normal,
+	                         last_step_condition_,
+	                         &ok).trimmed();
+	if(!ok || text.isEmpty()) {
+		return;
+	}
+
+	last_step_condition_ = text;
+
+	// the condition is parsed once here, and only run for each step
+	auto expression = std::make_shared<Expression<edb::address_t>>(text, edb::v1::get_variable, edb::v1::get_value);
+	ExpressionError error;
+	if(!expression->compile(nullptr, &error)) {
+		QMessageBox::critical(this, tr("Error In Expression!"), error.what());
+		return;
+	}
+
+	bool condition_failed = false;
+
+	StepCondition condition;
+	condition.over_calls = over_calls;
+	condition.condition  = [&](const State &state) {
+		auto state_variable = [&state](const QString &name, bool *ok, ExpressionError *err) {
+			return edb::v1::get_state_variable(state, name, ok, err);
+		};
+
+		bool ok;
+		const edb::address_t value = expression->evaluate_expression(state_variable, edb::v1::get_value, &ok, &error);
+		if(!ok) {
+			condition_failed = true;
+			return true;
+		}
+		return static_cast<bool>(value);
+	};
+
+	// keeps the window responsive, and is where a pause is noticed
+	condition.progress = [this](quint64 steps) {
+		edb::v1::set_status(tr("Stepping... %1 instructions").arg(steps), 0);
+		QCoreApplication::processEvents();
+		return !cancel_step_until_;
+	};
+
+	edb::v1::clear_status();
+	edb::v1::arch_processor().about_to_resume();
+	comment_server_->invalidate();
+	gui_update_timer_->stop();
+
+	// the core waits for the thread itself, nothing else may while it does
+	timer_->stop();
+	update_menu_state(RUNNING);
+	ui.action_Detach->setEnabled(false);
+	ui.action_Kill->setEnabled(false);
+
+	stepping_until_    = true;
+	cancel_step_until_ = false;
+
+	StepResult result;
+	const Status status = edb::v1::debugger_core->step_until(condition, &result);
+
+	stepping_until_ = false;
+	timer_->start(0);
+
+	// something else stopped it, that is reported like any other event
+	if(result.reason == StepResult::Event) {
+		ui.action_Detach->setEnabled(true);
+		ui.action_Kill->setEnabled(true);
+		return;
+	}
+
+	edb::v1::memory_regions().sync();
+	update_menu_state(PAUSED);
+	update_gui();
+
+	if(!status) {
+		QMessageBox::critical(this, title, status.toString());
+		return;
+	}
+
+	if(condition_failed) {
+		QMessageBox::critical(this, tr("Error In Expression!"), error.what());
+		return;
+	}
+
+	edb::v1::set_status(tr("Stopped after %1 instructions").arg(result.steps), 0);
+}
+
 //------------------------------------------------------------------------------
 // Name: on_actionRun_Until_Return_triggered
 // Desc:
@@ -2730,7 +3510,13 @@ void Debugger::on_actionRun_Until_Return_triggered() {
 //------------------------------------------------------------------------------
 void Debugger::on_action_Pause_triggered() {
 	Q_ASSERT(edb::v1::debugger_core);
+	if(stepping_until_) {
+		cancel_step_until_ = true;
+		return;
+	}
+
 	if(IProcess *process = edb::v1::debugger_core->process()) {
+		Instrumentation::begin_command(Instrumentation::Pause);
 		process->pause();
 	}
 }
@@ -2744,6 +3530,8 @@ void Debugger::cleanup_debugger() {
 	timer_->stop();
 
 	ui.cpuView->clear_comments();
+	inferior_states_.clear();
+	current_inferior_ = 0;
 	edb::v1::memory_regions().clear();
 	edb::v1::symbol_manager().clear();
 	edb::v1::arch_processor().reset();
@@ -2773,6 +3561,10 @@ QString Debugger::session_filename() const {
 
 	static bool show_path_notice = true;
 
+	if(!snapshot_session_.isEmpty()) {
+		return snapshot_session_;
+	}
+
 	QString session_path = edb::v1::config().session_path;
 	if(session_path.isEmpty()) {
 		if(show_path_notice) {
@@ -2813,10 +3605,15 @@ void Debugger::detach_from_process(DETACH_ACTION kill) {
 	}
 
 	program_executable_.clear();
+	snapshot_session_.clear();
 
 	if(edb::v1::debugger_core) {
-		if(kill == KILL_ON_DETACH) edb::v1::debugger_core->kill();
-		else                       edb::v1::debugger_core->detach();
+		if(kill == KILL_ON_DETACH) {
+			edb::v1::debugger_core->kill();
+		} else {
+			Q_EMIT aboutToDetach();
+			edb::v1::debugger_core->detach();
+		}
 	}
 
 	last_event_ = nullptr;
@@ -2847,14 +3644,19 @@ void Debugger::set_initial_debugger_state() {
 
 	reenable_breakpoint_run_  = nullptr;
 	reenable_breakpoint_step_ = nullptr;
+	hardware_stops_.clear();
 
 #ifdef Q_OS_LINUX
 	debug_pointer_ = 0;
 	dynamic_info_bp_set_ = false;
+	link_map_.reset();
 #endif
 
 	IProcess *process = edb::v1::debugger_core->process();
 
+	inferior_states_.clear();
+	current_inferior_ = process ? process->pid() : 0;
+
 	const QString executable = process ? process->executable() : QString();
 
 	set_debugger_caption(executable);
@@ -3074,8 +3876,13 @@ void Debugger::attach(edb::pid_t pid) {
 		}
 	}
 
+	QElapsedTimer timer;
+	timer.start();
+
 	if(const auto status = edb::v1::debugger_core->attach(pid)) {
 
+		const qint64 attach_time = timer.restart();
+
 		working_directory_ = edb::v1::debugger_core->process()->current_working_directory();
 
 		QList<QByteArray> args = edb::v1::debugger_core->process()->arguments();
@@ -3085,12 +3892,15 @@ void Debugger::attach(edb::pid_t pid) {
 		}
 
 		arguments_dialog_->set_arguments(args);
+
 		attachComplete();
+		update_gui();
+
+		qDebug() << "[Debugger] attach took" << attach_time << "ms, setting up the views" << timer.elapsed() << "ms";
 	} else {
 		QMessageBox::critical(this, tr("Attach"), tr("Failed to attach to process: %1").arg(status.toString()));
+		update_gui();
 	}
-
-	update_gui();
 }
 
 //------------------------------------------------------------------------------
@@ -3149,6 +3959,114 @@ void Debugger::on_action_Open_triggered() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: on_action_Open_Core_triggered
+// Desc: looks at a core file the way a stopped process is looked at, only
+//       nothing can be run or changed
+//------------------------------------------------------------------------------
+void Debugger::on_action_Open_Core_triggered() {
+
+	const QString filename = QFileDialog::getOpenFileName(this, tr("Open Core File"), last_open_directory_);
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	// the core takes the place of whatever was being debugged
+	detach_from_process(KILL_ON_DETACH);
+
+	if(const Status status = edb::v1::debugger_core->open_core(filename)) {
+		last_open_directory_ = QFileInfo(filename).canonicalFilePath();
+
+		// a snapshot brings the session it was saved with
+		const QString session = QString("%1.edb").arg(filename);
+		if(QFileInfo(session).exists()) {
+			snapshot_session_ = session;
+		}
+
+		attachComplete();
+	} else {
+		QMessageBox::critical(
+			this,
+			tr("Could Not Open"),
+			tr("Failed to open the core file:\n%1.").arg(status.toString()));
+	}
+
+	update_gui();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_action_Open_Image_triggered
+// Desc: looks at a program laid out from its file, for when it shouldn't or
+//       can't be run
+//------------------------------------------------------------------------------
+void Debugger::on_action_Open_Image_triggered() {
+
+	const QString filename = QFileDialog::getOpenFileName(this, tr("Open File Without Running"), last_open_directory_);
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	detach_from_process(KILL_ON_DETACH);
+
+	if(const Status status = edb::v1::debugger_core->open_image(filename)) {
+		last_open_directory_ = QFileInfo(filename).canonicalFilePath();
+		attachComplete();
+	} else {
+		QMessageBox::critical(
+			this,
+			tr("Could Not Open"),
+			tr("Failed to open the file:\n%1.").arg(status.toString()));
+	}
+
+	update_gui();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_action_Connect_Remote_triggered
+// Desc: debugs what a gdbserver or some other GDB stub is stopped in
+//------------------------------------------------------------------------------
+void Debugger::on_action_Connect_Remote_triggered() {
+
+	bool ok;
+	const QString address = QInputDialog::getText(
+		this,
+		tr("Connect to GDB Server"),
+		tr("Host and port of the GDB server:"),
+		QLineEdit::Normal,
+		last_remote_address_,
+		&ok).trimmed();
+
+	if(!ok || address.isEmpty()) {
+		return;
+	}
+
+	const int colon     = address.lastIndexOf(':');
+	const QString host  = colon == -1 ? QString("localhost") : address.left(colon);
+	const quint16 port  = (colon == -1 ? address : address.mid(colon + 1)).toUShort(&ok);
+	if(!ok || port == 0 || host.isEmpty()) {
+		QMessageBox::critical(
+			this,
+			tr("Could Not Connect"),
+			tr("%1 is not a valid host:port pair.").arg(address));
+		return;
+	}
+
+	// the remote process takes the place of whatever was being debugged
+	detach_from_process(KILL_ON_DETACH);
+
+	if(const Status status = edb::v1::debugger_core->connect_remote(host, port)) {
+		last_remote_address_ = address;
+		attachComplete();
+	} else {
+		QMessageBox::critical(
+			this,
+			tr("Could Not Connect"),
+			tr("Failed to debug through the GDB server:\n%1.").arg(status.toString()));
+	}
+
+	update_gui();
+}
+
 //------------------------------------------------------------------------------
 // Name: on_action_Attach_triggered
 // Desc:
@@ -3171,6 +4089,165 @@ void Debugger::on_action_Attach_triggered() {
 	delete dlg;
 }
 
+//------------------------------------------------------------------------------
+// Name: on_action_Attach_Inferior_triggered
+// Desc: debugs another process along with the ones being debugged already
+//------------------------------------------------------------------------------
+void Debugger::on_action_Attach_Inferior_triggered() {
+
+	QPointer<DialogAttach> dlg = new DialogAttach(this);
+
+	if(dlg->exec() == QDialog::Accepted) {
+		if(dlg) {
+			if(const Result<edb::pid_t> pid = dlg->selected_pid()) {
+				if(const Status status = edb::v1::debugger_core->attach_inferior(*pid)) {
+					inferior_changed();
+				} else {
+					QMessageBox::critical(
+						this,
+						tr("Attach"),
+						tr("Failed to attach to process %1:\n%2").arg(*pid).arg(status.toString()));
+				}
+			}
+		}
+	}
+
+	delete dlg;
+}
+
+//------------------------------------------------------------------------------
+// Name: populate_inferiors_menu
+// Desc: one entry for each process being debugged, the current one checked
+//------------------------------------------------------------------------------
+void Debugger::populate_inferiors_menu() {
+
+	QMenu *const menu = ui.action_Inferiors->menu();
+	menu->clear();
+
+	const QMap<edb::pid_t, ProcessSummary> summaries = edb::v1::debugger_core->enumerate_process_summaries();
+
+	for(const edb::pid_t pid : edb::v1::debugger_core->inferiors()) {
+		QAction *const action = menu->addAction(tr("%1 %2").arg(pid).arg(summaries.value(pid).name));
+		action->setData(qlonglong(pid));
+		action->setCheckable(true);
+		action->setChecked(pid == current_inferior_);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: inferior_selected
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::inferior_selected(QAction *action) {
+
+	const auto pid = static_cast<edb::pid_t>(action->data().toLongLong());
+
+	if(const Status status = edb::v1::debugger_core->select_inferior(pid)) {
+		inferior_changed();
+	} else {
+		QMessageBox::critical(
+			this,
+			tr("Inferiors"),
+			tr("Failed to switch to process %1:\n%2").arg(pid).arg(status.toString()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: inferior_changed
+// Desc: catches up with the debugger core having made another process the
+//       current one, keeping what belongs to the previous one aside. The
+//       symbols are addresses in the process, so they are loaded again, but
+//       the symbol files of the modules the processes share are only mapped
+//       once and the analysis of a region carries over to any process with
+//       the same bytes, see Analyzer::prepare_region
+//------------------------------------------------------------------------------
+void Debugger::inferior_changed() {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	const edb::pid_t pid = process ? process->pid() : 0;
+
+	if(pid == current_inferior_ || pid == 0) {
+		return;
+	}
+
+	InferiorState &previous = inferior_states_[current_inferior_];
+	previous.program_executable  = program_executable_;
+	previous.binary_info         = binary_info_;
+	previous.hardware_stops      = hardware_stops_;
+#if defined(Q_OS_LINUX)
+	previous.debug_pointer       = debug_pointer_;
+	previous.dynamic_info_bp_set = dynamic_info_bp_set_;
+	previous.link_map            = link_map_;
+#endif
+
+	// nothing is kept of the ones which are gone
+	const QList<edb::pid_t> inferiors = edb::v1::debugger_core->inferiors();
+	for(auto it = inferior_states_.begin(); it != inferior_states_.end(); ) {
+		if(!inferiors.contains(it.key())) {
+			it = inferior_states_.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	const bool seen = inferior_states_.contains(pid);
+	const InferiorState next = inferior_states_.take(pid);
+
+	current_inferior_ = pid;
+
+	reenable_breakpoint_run_  = nullptr;
+	reenable_breakpoint_step_ = nullptr;
+	hardware_stops_           = next.hardware_stops;
+
+	edb::v1::symbol_manager().clear();
+	edb::v1::memory_regions().sync();
+
+	Q_ASSERT(!data_regions_.isEmpty());
+	data_regions_.first()->region = edb::v1::primary_data_region();
+
+	if(seen) {
+		program_executable_  = next.program_executable;
+		binary_info_         = next.binary_info;
+#if defined(Q_OS_LINUX)
+		debug_pointer_       = next.debug_pointer;
+		dynamic_info_bp_set_ = next.dynamic_info_bp_set;
+		link_map_            = next.link_map;
+#endif
+	} else {
+		program_executable_  = process->executable();
+		binary_info_         = edb::v1::get_binary_info(edb::v1::primary_code_region());
+#if defined(Q_OS_LINUX)
+		debug_pointer_       = 0;
+		dynamic_info_bp_set_ = false;
+		link_map_.reset();
+#endif
+	}
+
+	comment_server_->clear();
+	if(binary_info_) {
+		comment_server_->set_comment(binary_info_->entry_point(), "<entry point>");
+	}
+
+	set_debugger_caption(program_executable_);
+	update_gui();
+}
+
+//------------------------------------------------------------------------------
+// Name: release_exited_inferior
+// Desc: when the process which exited is one of several, drops it and
+//       carries on with another, returns false when it was the only one
+//------------------------------------------------------------------------------
+bool Debugger::release_exited_inferior() {
+
+	if(edb::v1::debugger_core->inferiors().size() < 2) {
+		return false;
+	}
+
+	edb::v1::debugger_core->release_inferior();
+	inferior_changed();
+	return true;
+}
+
 //------------------------------------------------------------------------------
 // Name: on_action_Memory_Regions_triggered
 // Desc: displays the memory regions dialog, and optionally dumps some data
@@ -3338,7 +4415,14 @@ bool Debugger::dump_stack(edb::address_t address, bool scroll_to) {
 	stack_view_info_.region = edb::v1::memory_regions().find_region(address);
 
 	if(stack_view_info_.region) {
-		stack_view_info_.update();
+
+		// the same stack as last time only needs repainting, handing the view
+		// its data again would have it start over and drop the selection
+		if(stack_view_info_.region->equals(last_region)) {
+			stack_view_->update();
+		} else {
+			stack_view_info_.update();
+		}
 
 		if(IProcess *process = edb::v1::debugger_core->process()) {
 			if(std::shared_ptr<IThread> thread = process->current_thread()) {
@@ -3388,6 +4472,126 @@ void Debugger::tab_context_menu(int index, const QPoint &pos) {
 	update_gui();
 }
 
+//------------------------------------------------------------------------------
+// Name: add_pending_breakpoint
+// Desc: the module may be loaded already, then it is placed right away
+//------------------------------------------------------------------------------
+bool Debugger::add_pending_breakpoint(const PendingBreakpoints::Breakpoint &breakpoint) {
+
+	if(!pending_breakpoints_.add(breakpoint)) {
+		return false;
+	}
+
+#if defined(Q_OS_LINUX)
+	if(edb::v1::debugger_core && edb::v1::debugger_core->process()) {
+		PendingBreakpoints added;
+		added.add(breakpoint);
+
+		const QVector<edb::address_t> addresses = added.resolve(link_map_.modules());
+		if(!addresses.isEmpty()) {
+			edb::v1::debugger_core->add_breakpoints(addresses);
+		}
+	}
+#endif
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_pending_breakpoint
+// Desc: what was placed already stays, like any other breakpoint
+//------------------------------------------------------------------------------
+bool Debugger::remove_pending_breakpoint(const PendingBreakpoints::Breakpoint &breakpoint) {
+	return pending_breakpoints_.remove(breakpoint);
+}
+
+//------------------------------------------------------------------------------
+// Name: pending_breakpoints
+// Desc:
+//------------------------------------------------------------------------------
+QList<PendingBreakpoints::Breakpoint> Debugger::pending_breakpoints() const {
+	return pending_breakpoints_.breakpoints();
+}
+
+//------------------------------------------------------------------------------
+// Name: arm_pending_breakpoints
+// Desc: places the pending breakpoints in <modules>, which the linker hook
+//       just reported as loaded. They are all written in one batch, the hook
+//       is hit for every library so this has to be quick
+//------------------------------------------------------------------------------
+void Debugger::arm_pending_breakpoints(const QList<Module> &modules) {
+
+	if(modules.isEmpty() || pending_breakpoints_.isEmpty()) {
+		return;
+	}
+
+	const QVector<edb::address_t> addresses = pending_breakpoints_.resolve(modules);
+	if(addresses.isEmpty()) {
+		return;
+	}
+
+	for(const edb::address_t address : edb::v1::debugger_core->add_breakpoints(addresses)) {
+		qDebug("unable to place the pending breakpoint at %s", qPrintable(address.toPointerString()));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: is_library_event
+// Desc: true if <event> is a hit of the linker hook, or the step which moves
+//       off of it before it is put back
+//------------------------------------------------------------------------------
+bool Debugger::is_library_event(const std::shared_ptr<IDebugEvent> &event) const {
+#if defined(Q_OS_LINUX)
+	if(dynamic_info_bp_set_ && event->is_trap()) {
+
+		if(reenable_breakpoint_run_ && reenable_breakpoint_run_->internal() && reenable_breakpoint_run_->tag == ld_loader_tag) {
+			return true;
+		}
+
+		State state;
+		edb::v1::debugger_core->get_state(&state);
+		if(std::shared_ptr<IBreakpoint> bp = edb::v1::find_triggered_breakpoint(state.instruction_pointer())) {
+			return bp->internal() && bp->tag == ld_loader_tag;
+		}
+	}
+#else
+	Q_UNUSED(event);
+#endif
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_passing_breakpoint_event
+// Desc: true if <event> is a hit of a breakpoint which is known not to stop, a
+//       tracepoint or one whose filters leave the hit out, or the step which
+//       moves off of a breakpoint while running before it is put back
+//------------------------------------------------------------------------------
+bool Debugger::is_passing_breakpoint_event(const std::shared_ptr<IDebugEvent> &event) const {
+	if(!event->is_trap()) {
+		return false;
+	}
+
+	if(reenable_breakpoint_run_) {
+		return true;
+	}
+
+	if(event->trap_reason() == IDebugEvent::TRAP_STEPPING) {
+		return false;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+	if(std::shared_ptr<IBreakpoint> bp = edb::v1::find_triggered_breakpoint(state.instruction_pointer())) {
+		if(!bp->enabled() || bp->internal()) {
+			return false;
+		}
+
+		// the hit isn't counted yet
+		return bp->tracepoint || !bp->counts_hits_by(event->thread()) || bp->hit_filtered(bp->hit_count() + 1);
+	}
+
+	return false;
+}
+
 //------------------------------------------------------------------------------
 // Name: next_debug_event
 // Desc:
@@ -3408,11 +4612,17 @@ void Debugger::next_debug_event() {
 
 		last_event_ = e;
 
-		// TODO(eteran): disable this in favor of only doing it on library load events
-		//               once we are confident. We should be able to just enclose it inside
-		//               an "if(!dynamic_info_bp_set_) {" test (since we still want to
-		//               do this when the hook isn't set.
-		edb::v1::memory_regions().sync();
+		// the first of the inferiors to report an event becomes the current one
+		inferior_changed();
+
+		// the linker hook can fire thousands of times while a program starts up,
+		// and a tracepoint in a hot loop millions of times, so those events
+		// leave the regions alone unless we end up stopping there, the next
+		// ordinary event brings them up to date
+		const bool library_event = is_library_event(e) || is_passing_breakpoint_event(e);
+		if(!library_event) {
+			edb::v1::memory_regions().sync();
+		}
 
 #if defined(Q_OS_LINUX)
 		if(!dynamic_info_bp_set_) {
@@ -3438,12 +4648,16 @@ void Debugger::next_debug_event() {
 		}
 #endif
 
+		++stops_;
 		Q_EMIT debugEvent();
 
 		const edb::EVENT_STATUS status = edb::v1::execute_debug_event_handlers(e);
 		switch(status) {
 		case edb::DEBUG_STOP:
-			update_gui();
+			if(library_event) {
+				edb::v1::memory_regions().sync();
+			}
+			schedule_gui_update();
 			update_menu_state(edb::v1::debugger_core->process() ? PAUSED : TERMINATED);
 			break;
 		case edb::DEBUG_CONTINUE:
@@ -22,12 +22,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Debugger.h"
 #include "DataViewInfo.h"
 #include "IDebugEventHandler.h"
+#include "LinkMapTracker.h"
+#include "PendingBreakpoints.h"
 #include "OSTypes.h"
 #include "QHexView"
 
 template <class T>
 class Result;
 
+class CommentServer;
 class DialogArguments;
 class IBinary;
 class IBreakpoint;
@@ -35,6 +38,9 @@ class IDebugEvent;
 class IPlugin;
 class RecentFileManager;
 
+struct CompiledBreakpointExpression;
+struct ExpressionError;
+
 class QStringListModel;
 class QTimer;
 class QToolButton;
@@ -43,7 +49,10 @@ class QDragEnterEvent;
 class QDropEvent;
 class QLabel;
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMainWindow>
+#include <QMap>
 #include <QProcess>
 #include <QVector>
 
@@ -69,6 +78,7 @@ private:
 
 	enum DEBUG_MODE {
 		MODE_STEP,
+		MODE_STEP_BLOCK,
 		MODE_TRACE,
 		MODE_RUN
 	};
@@ -101,15 +111,24 @@ public:
 	void execute(const QString &s, const QList<QByteArray> &args);
 	void refresh_gui();
 	void update_data(const std::shared_ptr<DataViewInfo> &v);
-	void update_gui();
+	void schedule_gui_update();
 	QLabel *statusLabel() const;
 
+public:
+	bool add_pending_breakpoint(const PendingBreakpoints::Breakpoint &breakpoint);
+	bool remove_pending_breakpoint(const PendingBreakpoints::Breakpoint &breakpoint);
+	QList<PendingBreakpoints::Breakpoint> pending_breakpoints() const;
+
+public Q_SLOTS:
+	void update_gui();
+
 Q_SIGNALS:
 	void gui_updated();
 
 	// TODO(eteran): maybe this is better off as a single event
 	//               with a type passed?
 	void debugEvent();
+	void aboutToDetach(); // while the process can still be changed
 	void detachEvent();
 	void attachEvent();
 
@@ -120,13 +139,22 @@ public Q_SLOTS:
 	void on_actionApplication_Arguments_triggered();
 	void on_actionApplication_Working_Directory_triggered();
 	void on_actionRun_Until_Return_triggered();
+	void on_actionStep_Until_Branch_triggered();
+	void on_actionStep_Into_Until_triggered();
+	void on_actionTrace_Over_Until_triggered();
 	void on_action_About_triggered();
 	void on_action_Attach_triggered();
+	void on_action_Attach_Inferior_triggered();
 	void on_action_Configure_Debugger_triggered();
+	void on_action_Connect_Remote_triggered();
 	void on_action_Detach_triggered();
+	void on_actionDump_Core_triggered();
+	void on_actionSave_Snapshot_triggered();
 	void on_action_Kill_triggered();
 	void on_action_Memory_Regions_triggered();
 	void on_action_Open_triggered();
+	void on_action_Open_Core_triggered();
+	void on_action_Open_Image_triggered();
 	void on_action_Pause_triggered();
 	void on_action_Plugins_triggered();
 	void on_action_Restart_triggered();
@@ -140,6 +168,11 @@ public Q_SLOTS:
 	void on_action_Threads_triggered();
 	void on_cpuView_breakPointToggled(edb::address_t);
 	void on_cpuView_customContextMenuRequested(const QPoint &);
+	void on_dataDock_visibilityChanged(bool visible);
+	void on_stackDock_visibilityChanged(bool visible);
+	void on_tabWidget_currentChanged(int index);
+	void populate_inferiors_menu();
+	void inferior_selected(QAction *action);
 	QList<QAction*> getCurrentRegisterContextMenuItems() const;
 	Register active_register() const;
 
@@ -161,6 +194,9 @@ private:
 private Q_SLOTS:
 	// the manually connected general slots
 	void mnuModifyBytes();
+	void mnuFind();
+	void mnuFindNext();
+	void search_matches_changed();
 
 private Q_SLOTS:
 	// the manually connected CPU slots
@@ -234,12 +270,21 @@ private:
 	std::shared_ptr<IRegion> update_cpu_view(const State &state);
 	QString create_tty();
 	QString session_filename() const;
-	bool breakpoint_condition_true(const QString &condition);
+	bool breakpoint_condition_true(const std::shared_ptr<IBreakpoint> &bp, const State &state);
+	bool evaluate_breakpoint_expression(CompiledBreakpointExpression *compiled, const QString &text, const State &state, edb::address_t *value, ExpressionError *err);
+	bool block_step_supported() const;
+	void step_until(const QString &title, bool over_calls);
+	void record_tracepoint(const std::shared_ptr<IBreakpoint> &bp, const std::shared_ptr<IDebugEvent> &event, const State &state);
 	bool common_open(const QString &s, const QList<QByteArray> &args);
 	edb::EVENT_STATUS handle_event_exited(const std::shared_ptr<IDebugEvent> &event);
 	edb::EVENT_STATUS handle_event_stopped(const std::shared_ptr<IDebugEvent> &event);
 	edb::EVENT_STATUS handle_event_terminated(const std::shared_ptr<IDebugEvent> &event);
 	edb::EVENT_STATUS handle_trap(const std::shared_ptr<IDebugEvent> &event);
+	bool is_library_event(const std::shared_ptr<IDebugEvent> &event) const;
+	void arm_pending_breakpoints(const QList<Module> &modules);
+	bool is_passing_breakpoint_event(const std::shared_ptr<IDebugEvent> &event) const;
+	bool add_hardware_stop(edb::address_t address);
+	void remove_hardware_stop(int slot);
 	edb::EVENT_STATUS resume_status(bool pass_exception);
 	Result<edb::address_t> get_goto_expression();
 	Result<edb::reg_t> get_follow_register() const;
@@ -269,8 +314,11 @@ private:
 	void update_menu_state(GUI_STATE state);
 	void update_stack_view(const State &state);
 	void update_tab_caption(const std::shared_ptr<QHexView> &view, edb::address_t start, edb::address_t end);
+	void update_views();
 	QAction *createAction(const QString &text, const QKeySequence &keySequence, const char *slot);
 	void attachComplete();
+	void inferior_changed();
+	bool release_exited_inferior();
 
 private:
 	template <class F>
@@ -297,6 +345,8 @@ private:
 	template <class T>
 	void modify_bytes(const T &hexview);
 
+	void find_in_view(bool next);
+
 	template <class F1, class F2>
 	void step_over(F1 run_func, F2 step_func);
 
@@ -315,27 +365,63 @@ private:
 	QStringListModel *                               list_model_;
 	DialogArguments *                                arguments_dialog_;
 	QTimer *                                         timer_;
+	QTimer *                                         gui_update_timer_;   // for the stop schedule_gui_update held back
+	QElapsedTimer                                    last_gui_update_;
+	int                                              skipped_gui_updates_ = 0;
+	bool                                             data_views_stale_    = false; // not updated while hidden
+	bool                                             stack_view_stale_    = false;
+	quint64                                          stops_               = 0;     // debug events so far, see MemoryDiff
 	RecentFileManager *                              recent_file_manager_;
 
-	QSharedPointer<QHexView::CommentServerInterface> comment_server_;
+	QSharedPointer<CommentServer>                    comment_server_;
 	std::shared_ptr<IBreakpoint>                     reenable_breakpoint_run_;
 	std::shared_ptr<IBreakpoint>                     reenable_breakpoint_step_;
-	std::unique_ptr<IBinary>                         binary_info_;
+	std::shared_ptr<IBinary>                         binary_info_;
 
 	QString                                          last_open_directory_;
+	QString                                          last_remote_address_;
 	QString                                          working_directory_;
 	QString                                          program_executable_;
+	QString                                          snapshot_session_; // of the open snapshot, kept next to it
 	bool                                             stack_view_locked_;
+	bool                                             stepping_until_;
+	bool                                             cancel_step_until_;
+	QString                                          last_step_condition_;
 	std::shared_ptr<const IDebugEvent>               last_event_;
 	QLabel *                                         status_;
 
+	// one-time internal stops (step over, run to cursor) placed in a free
+	// execute debug register instead of as an int3, by slot
+	QMap<int, edb::address_t>                        hardware_stops_;
+
+	// placed in each module of their name as it is loaded, in every process
+	PendingBreakpoints                               pending_breakpoints_;
+
 #if defined(Q_OS_LINUX)
 	edb::address_t                                   debug_pointer_;
 	bool                                             dynamic_info_bp_set_;
+	LinkMapTracker                                   link_map_;
 #endif
 
+	// what is kept of each inferior while another one is the current one
+	struct InferiorState {
+		QString                   program_executable;
+		std::shared_ptr<IBinary>  binary_info;
+		QMap<int, edb::address_t> hardware_stops;
+#if defined(Q_OS_LINUX)
+		edb::address_t            debug_pointer       = 0;
+		bool                      dynamic_info_bp_set = false;
+		LinkMapTracker            link_map;
+#endif
+	};
+
+	QHash<edb::pid_t, InferiorState>                 inferior_states_;
+	edb::pid_t                                       current_inferior_ = 0;
+
 private:
 	QAction *gotoAddressAction_;
+	QAction *findAction_;
+	QAction *findNextAction_;
 	QAction *editCommentAction_;
 	QAction *editBytesAction_;
 	QAction *toggleBreakpointAction_;
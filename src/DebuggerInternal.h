@@ -28,7 +28,8 @@ namespace edb {
 namespace internal {
 
 bool register_plugin(const QString &filename, QObject *plugin);
-void load_function_db();
+void add_plugin_startup_time(const QString &filename, qint64 msecs);
+qint64 plugin_startup_time(const QString &filename);
 
 }
 }
@@ -0,0 +1,107 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Demangler.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <cstdlib>
+#include <memory>
+#endif
+
+namespace {
+
+// the cache starts over once it holds this many names, a session rarely
+// shows more than a fraction of that
+const int MAX_CACHED_NAMES = 65536;
+
+QMutex                     cache_mutex;
+QHash<QByteArray, QString> cache;
+
+//------------------------------------------------------------------------------
+// Name: demangle_uncached
+// Desc: anything after an '@', as in name@plt, is kept as it is
+//------------------------------------------------------------------------------
+QString demangle_uncached(const char *name) {
+
+	const QString mangled = QString::fromUtf8(name);
+
+#ifdef __GNUG__
+	QStringList split = mangled.split(QLatin1Char('@'));
+
+	int failed = 0;
+	std::unique_ptr<char, decltype(std::free)*> demangled(abi::__cxa_demangle(split.front().toUtf8().constData(), 0, 0, &failed), std::free);
+	if(failed || !demangled) {
+		return mangled;
+	}
+
+	split.front() = QString::fromUtf8(demangled.get());
+	return split.join(QLatin1String("@"));
+#else
+	return mangled;
+#endif
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: is_mangled
+// Desc: only names starting with _Z are taken to be, otherwise C functions
+//       named like types, "f" for one, would be shown as "float"
+//------------------------------------------------------------------------------
+bool Demangler::is_mangled(const char *name) {
+	return name[0] == '_' && name[1] == 'Z';
+}
+
+//------------------------------------------------------------------------------
+// Name: demangle
+// Desc: <name> as it is to be shown, itself if it isn't mangled or can't be
+//       demangled
+//------------------------------------------------------------------------------
+QString Demangler::demangle(const char *name) {
+
+	if(!is_mangled(name)) {
+		return QString::fromUtf8(name);
+	}
+
+	const QByteArray key(name);
+
+	{
+		QMutexLocker locker(&cache_mutex);
+		auto it = cache.find(key);
+		if(it != cache.end()) {
+			return it.value();
+		}
+	}
+
+	// done unlocked, two threads demangling the same name only costs time
+	const QString demangled = demangle_uncached(name);
+
+	QMutexLocker locker(&cache_mutex);
+	if(cache.size() >= MAX_CACHED_NAMES) {
+		cache.clear();
+	}
+	cache.insert(key, demangled);
+	return demangled;
+}
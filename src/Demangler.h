@@ -0,0 +1,37 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEMANGLER_20171014_H_
+#define DEMANGLER_20171014_H_
+
+#include <QString>
+
+// Turns the mangled C++ names symbol files keep into what is shown. Most of
+// the names of a C++ library are never looked at, so they are demangled as
+// they are asked for, and each once: the results are cached for the whole
+// process, which any thread may share
+class Demangler {
+public:
+	static bool is_mangled(const char *name);
+	static QString demangle(const char *name);
+
+private:
+	Demangler() = delete;
+};
+
+#endif
@@ -116,19 +116,23 @@ void DialogAttach::update_list() {
 
 	const auto selectedPid = selected_pid();
 
-	process_model_->clear();
-
 	if(edb::v1::debugger_core) {
-		QMap<edb::pid_t, std::shared_ptr<IProcess>> procs = edb::v1::debugger_core->enumerate_processes();
-
-		const edb::uid_t user_id = getuid();
-		const bool filterUID = ui->filter_uid->isChecked();
-
-		for(const std::shared_ptr<IProcess> &process: procs) {
-			if(!filterUID || process->uid() == user_id) {
-				process_model_->addProcess(process);
+		QMap<edb::pid_t, ProcessSummary> procs = edb::v1::debugger_core->enumerate_process_summaries();
+
+		if(ui->filter_uid->isChecked()) {
+			const edb::uid_t user_id = getuid();
+			for(auto it = procs.begin(); it != procs.end(); ) {
+				if(it->uid != user_id) {
+					it = procs.erase(it);
+				} else {
+					++it;
+				}
 			}
 		}
+
+		process_model_->setProcesses(procs);
+	} else {
+		process_model_->clear();
 	}
 
 	if(selectedPid) {
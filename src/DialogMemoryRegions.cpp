@@ -18,19 +18,39 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "DialogMemoryRegions.h"
 #include "IDebugger.h"
+#include "IProcess.h"
 #include "IRegion.h"
 #include "MemoryRegions.h"
+#include "TaskScheduler.h"
 #include "edb.h"
 
 #include <QDebug>
+#include <QFileInfo>
 #include <QHeaderView>
 #include <QItemSelectionModel>
 #include <QMenu>
+#include <QPair>
+#include <QPushButton>
 #include <QSortFilterProxyModel>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <algorithm>
 
 #include "ui_DialogMemoryRegions.h"
 
+namespace {
+
+// how often the usage columns are brought up to date while they are shown.
+// reading smaps walks the page tables of the whole process, so not often
+constexpr int UsageInterval = 5000;
+
+// how many regions the summary names
+constexpr int TopRegions = 5;
+
+}
+
 //------------------------------------------------------------------------------
 // Name: DialogMemoryRegions
 // Desc:
@@ -39,13 +59,29 @@ DialogMemoryRegions::DialogMemoryRegions(QWidget *parent) : QDialog(parent), ui(
 	ui->setupUi(this);
 
 	ui->regions_table->verticalHeader()->hide();
-#if QT_VERSION >= 0x050000
-	ui->regions_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-#else
-	ui->regions_table->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
-#endif
+
+	// the regions are kept in address order and updated in place by sync(),
+	// so the proxy is set up once and only ever sees the rows which change.
+	// It sorts and filters on the raw values, formatting is left to the rows
+	// which are shown
 	filter_model_ = new QSortFilterProxyModel(this);
+	filter_model_->setFilterKeyColumn(3);
+	filter_model_->setSortRole(Qt::UserRole);
+	filter_model_->setFilterRole(Qt::UserRole);
+	filter_model_->setSourceModel(&edb::v1::memory_regions());
+	ui->regions_table->setModel(filter_model_);
+
 	connect(ui->filter, SIGNAL(textChanged(const QString &)), filter_model_, SLOT(setFilterFixedString(const QString &)));
+
+	// the usage columns are read in the background, never more than one
+	// read at a time, and merged in as they come
+	usage_timer_ = new QTimer(this);
+	usage_timer_->setInterval(UsageInterval);
+	connect(usage_timer_, SIGNAL(timeout()), this, SLOT(refresh_usage()));
+
+	QPushButton *const refresh = ui->button_box->addButton(tr("&Refresh Usage"), QDialogButtonBox::ActionRole);
+	connect(refresh, SIGNAL(clicked()), this, SLOT(refresh_usage()));
+	connect(&edb::v1::memory_regions(), SIGNAL(modelReset()), this, SLOT(update_summary()));
 }
 
 //------------------------------------------------------------------------------
@@ -53,6 +89,8 @@ DialogMemoryRegions::DialogMemoryRegions(QWidget *parent) : QDialog(parent), ui(
 // Desc:
 //------------------------------------------------------------------------------
 DialogMemoryRegions::~DialogMemoryRegions() {
+	usage_token_.cancel();
+	usage_future_.waitForFinished();
 	delete ui;
 }
 
@@ -62,9 +100,109 @@ DialogMemoryRegions::~DialogMemoryRegions() {
 //------------------------------------------------------------------------------
 void DialogMemoryRegions::showEvent(QShowEvent *) {
 
-	filter_model_->setFilterKeyColumn(3);
-	filter_model_->setSourceModel(&edb::v1::memory_regions());
-	ui->regions_table->setModel(filter_model_);
+	// sized once from the rows in view, rather than again on every sync
+	ui->regions_table->resizeColumnsToContents();
+
+	refresh_usage();
+	usage_timer_->start();
+}
+
+//------------------------------------------------------------------------------
+// Name: hideEvent
+// Desc: nobody is looking at the usage, so it isn't read
+//------------------------------------------------------------------------------
+void DialogMemoryRegions::hideEvent(QHideEvent *) {
+	usage_timer_->stop();
+	usage_token_.cancel();
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh_usage
+// Desc: starts reading the usage of every region, unless a read is still
+//       going. The reader hands it over a batch at a time, the first batch
+//       of a run schedules a merge on this thread, the rest join it
+//------------------------------------------------------------------------------
+void DialogMemoryRegions::refresh_usage() {
+
+	if(usage_future_.isRunning()) {
+		return;
+	}
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		return;
+	}
+
+	const IProcess::UsageReader reader = process->usage_reader();
+	if(!reader) {
+		ui->usage_summary->setText(tr("Memory usage isn't known for this process"));
+		return;
+	}
+
+	usage_future_ = edb::v1::task_scheduler().run("DialogMemoryRegions::usage", TaskScheduler::Background, QString(), [this, reader](const TaskToken &token) {
+		reader([this, &token](const QVector<RegionUsage> &batch) {
+			if(token.cancelled()) {
+				return false;
+			}
+
+			QMutexLocker locker(&usage_lock_);
+			if(pending_usage_.isEmpty()) {
+				QMetaObject::invokeMethod(this, "merge_usage", Qt::QueuedConnection);
+			}
+			pending_usage_ += batch;
+			return true;
+		});
+	}, &usage_token_);
+}
+
+//------------------------------------------------------------------------------
+// Name: merge_usage
+// Desc: hands what the reader has come up with so far to the model
+//------------------------------------------------------------------------------
+void DialogMemoryRegions::merge_usage() {
+
+	QVector<RegionUsage> usage;
+	{
+		QMutexLocker locker(&usage_lock_);
+		usage = pending_usage_;
+		pending_usage_.clear();
+	}
+
+	edb::v1::memory_regions().merge_usage(usage);
+	update_summary();
+}
+
+//------------------------------------------------------------------------------
+// Name: update_summary
+// Desc: names the regions with the most memory resident, largest first
+//------------------------------------------------------------------------------
+void DialogMemoryRegions::update_summary() {
+
+	MemoryRegions &regions = edb::v1::memory_regions();
+
+	QVector<QPair<quint64, int>> resident;
+	for(int row = 0; row < regions.rowCount(); ++row) {
+		RegionUsage usage;
+		if(regions.find_usage(regions.regions()[row], &usage) && usage.resident != 0) {
+			resident.push_back(qMakePair(usage.resident, row));
+		}
+	}
+
+	const int count = std::min(TopRegions, resident.size());
+	std::partial_sort(resident.begin(), resident.begin() + count, resident.end(), [](const QPair<quint64, int> &lhs, const QPair<quint64, int> &rhs) {
+		return lhs.first > rhs.first;
+	});
+
+	QStringList top;
+	for(int i = 0; i < count; ++i) {
+		const int row = resident[i].second;
+		const std::shared_ptr<IRegion> &region = regions.regions()[row];
+
+		const QString name = region->name().isEmpty() ? edb::v1::format_pointer(region->start()) : QFileInfo(region->name()).fileName();
+		top << tr("%1 (%2)").arg(name, regions.index(row, MemoryRegions::FirstUsageColumn).data().toString());
+	}
+
+	ui->usage_summary->setText(top.isEmpty() ? QString() : tr("Most resident: %1").arg(top.join(", ")));
 }
 
 //------------------------------------------------------------------------------
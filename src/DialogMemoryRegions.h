@@ -19,7 +19,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef DIALOGMEMORYREGIONS_20061101_H_
 #define DIALOGMEMORYREGIONS_20061101_H_
 
+#include "RegionUsage.h"
+#include "TaskScheduler.h"
+
 #include <QDialog>
+#include <QFuture>
+#include <QMutex>
+#include <QVector>
 
 #include <memory>
 
@@ -27,6 +33,7 @@ class IRegion;
 
 class QSortFilterProxyModel;
 class QModelIndex;
+class QTimer;
 
 namespace Ui { class DialogMemoryRegions; }
 
@@ -38,6 +45,7 @@ public:
 
 private:
 	virtual void showEvent(QShowEvent *event);
+	virtual void hideEvent(QHideEvent *event);
 
 private Q_SLOTS:
 	void on_regions_table_customContextMenuRequested(const QPoint &pos);
@@ -53,6 +61,9 @@ private Q_SLOTS:
 	void view_in_cpu();
 	void view_in_stack();
 	void view_in_dump();
+	void refresh_usage();
+	void merge_usage();
+	void update_summary();
 
 private:
 	std::shared_ptr<IRegion> selected_region() const;
@@ -61,6 +72,11 @@ private:
 private:
 	Ui::DialogMemoryRegions *const ui;
 	QSortFilterProxyModel *        filter_model_;
+	QTimer *                       usage_timer_;
+	TaskToken                      usage_token_;
+	QFuture<void>                  usage_future_;
+	QMutex                         usage_lock_;
+	QVector<RegionUsage>           pending_usage_; // read, not yet merged
 };
 
 #endif
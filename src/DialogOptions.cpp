@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DialogOptions.h"
 #include "Configuration.h"
 #include "IDebugger.h"
+#include "IPlugin.h"
 #include "edb.h"
 
 #include <QCloseEvent>
@@ -51,7 +52,7 @@ int width_to_index(int n) {
 // Name: DialogOptions
 // Desc:
 //------------------------------------------------------------------------------
-DialogOptions::DialogOptions(QWidget *parent) : QDialog(parent), ui(new Ui::DialogOptions), toolbox_(nullptr) {
+DialogOptions::DialogOptions(QWidget *parent) : QDialog(parent), ui(new Ui::DialogOptions), toolbox_(nullptr), plugin_pages_added_(false) {
 	ui->setupUi(this);
 }
 
@@ -158,6 +159,18 @@ void DialogOptions::showEvent(QShowEvent *event) {
 
 	QDialog::showEvent(event);
 
+	// the plugins' pages aren't made until someone actually wants to see them
+	if(!plugin_pages_added_) {
+		plugin_pages_added_ = true;
+		for(QObject *plugin: edb::v1::plugin_list()) {
+			if(auto p = qobject_cast<IPlugin *>(plugin)) {
+				if(QWidget *const options_page = p->options_page()) {
+					addOptionsPage(options_page);
+				}
+			}
+		}
+	}
+
 	const Configuration &config = edb::v1::config();
 
     ui->chkHexOffsets->setChecked(config.function_offsets_in_hex);
@@ -180,6 +193,8 @@ void DialogOptions::showEvent(QShowEvent *event) {
 	ui->chkDisableLazyBinding->setChecked(config.disableLazyBinding);
 	
 	ui->chkBreakOnLibraryLoad->setChecked(config.break_on_library_load);
+	ui->chkNonStopMode->setChecked(config.non_stop_mode);
+	ui->cmbForkBehavior->setCurrentIndex(config.fork_behavior);
 
 	ui->chkZerosAreFilling->setChecked(config.zeros_are_filling);
 	ui->chkRegisterBadges->setChecked(config.show_register_badges);
@@ -221,6 +236,7 @@ void DialogOptions::showEvent(QShowEvent *event) {
 	ui->rdoPlaceRestore ->setChecked(config.startup_window_location == Configuration::Restore);
 	
 	ui->listIgnoredExceptions->clear();
+	ui->listLoggedExceptions->clear();
 	if(edb::v1::debugger_core) {
         QMap<qlonglong, QString> known_exceptions = edb::v1::debugger_core->exceptions();
 		
@@ -234,6 +250,11 @@ void DialogOptions::showEvent(QShowEvent *event) {
                 item->setCheckState(Qt::Unchecked);
             }
             item->setData(Qt::UserRole, it.key());
+
+			auto logged = new QListWidgetItem(*it, ui->listLoggedExceptions);
+			logged->setFlags(logged->flags() | Qt::ItemIsUserCheckable);
+			logged->setCheckState(config.logged_exceptions.contains(it.key()) ? Qt::Checked : Qt::Unchecked);
+			logged->setData(Qt::UserRole, it.key());
 		}	
 	}
 
@@ -287,6 +308,8 @@ void DialogOptions::closeEvent(QCloseEvent *event) {
 	config.disableASLR			 = ui->chkDisableASLR->isChecked();
 	config.disableLazyBinding	 = ui->chkDisableLazyBinding->isChecked();
 	config.break_on_library_load = ui->chkBreakOnLibraryLoad->isChecked();
+	config.non_stop_mode         = ui->chkNonStopMode->isChecked();
+	config.fork_behavior         = static_cast<Configuration::ForkBehavior>(ui->cmbForkBehavior->currentIndex());
 	config.default_breakpoint_type = ui->cmbDefaultBreakpointType->itemData(ui->cmbDefaultBreakpointType->currentIndex()).value<IBreakpoint::TypeId>();
 
     config.function_offsets_in_hex = ui->chkHexOffsets->isChecked();
@@ -345,6 +368,14 @@ void DialogOptions::closeEvent(QCloseEvent *event) {
         }
     }
 
+	config.logged_exceptions.clear();
+	for(int i = 0; i < ui->listLoggedExceptions->count(); ++i) {
+		auto item = ui->listLoggedExceptions->item(i);
+		if(item->checkState() == Qt::Checked) {
+			config.logged_exceptions.push_back(item->data(Qt::UserRole).toLongLong());
+		}
+	}
+
 	config.sendChangeNotification();
 	event->accept();
 }
@@ -50,6 +50,7 @@ private:
 private:
 	Ui::DialogOptions *const ui;
 	QToolBox *               toolbox_;
+	bool                     plugin_pages_added_;
 };
 
 #endif
@@ -17,8 +17,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogPlugins.h"
+#include "DebuggerInternal.h"
 #include "IPlugin.h"
 #include "PluginModel.h"
+#include "PluginUpdates.h"
 #include "edb.h"
 
 #include <QMetaClassInfo>
@@ -38,6 +40,7 @@ DialogPlugins::DialogPlugins(QWidget *parent, Qt::WindowFlags f) : QDialog(paren
 
 	plugin_filter_->setSourceModel(plugin_model_);
 	plugin_filter_->setFilterCaseSensitivity(Qt::CaseInsensitive);
+	plugin_filter_->setSortRole(Qt::UserRole);
 
 	ui->plugins_table->setModel(plugin_filter_);
 }
@@ -82,7 +85,7 @@ void DialogPlugins::showEvent(QShowEvent *) {
 			}
 		}
 
-		plugin_model_->addPlugin(filename, plugin_name, author, url);
+		plugin_model_->addPlugin(filename, plugin_name, author, url, edb::internal::plugin_startup_time(filename), PluginUpdates::instance().timing(filename));
 	}
 
 	ui->plugins_table->resizeColumnsToContents();
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogThreads.h"
+#include "Configuration.h"
 #include "IDebugger.h"
 #include "IProcess.h"
 #include "IThread.h"
@@ -24,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "edb.h"
 
 #include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QMessageBox>
 #include <QSortFilterProxyModel>
 
 #include "ui_DialogThreads.h"
@@ -43,6 +46,8 @@ DialogThreads::DialogThreads(QWidget *parent, Qt::WindowFlags f) : QDialog(paren
 
 	ui->thread_table->setModel(threads_filter_);
 
+	connect(ui->thread_table->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(updateButtons()));
+
 	connect(edb::v1::debugger_ui, SIGNAL(debugEvent()), this, SLOT(updateThreads()));
 	connect(edb::v1::debugger_ui, SIGNAL(detachEvent()), this, SLOT(updateThreads()));
 	connect(edb::v1::debugger_ui, SIGNAL(attachEvent()), this, SLOT(updateThreads()));
@@ -71,35 +76,113 @@ void DialogThreads::showEvent(QShowEvent *) {
 void DialogThreads::on_thread_table_doubleClicked(const QModelIndex &index) {
 
 	const QModelIndex internal_index = threads_filter_->mapToSource(index);
-	if(auto item = reinterpret_cast<ThreadsModel::Item *>(internal_index.internalPointer())) {
-		if(std::shared_ptr<IThread> thread = item->thread) {
-			if(IProcess *process = edb::v1::debugger_core->process()) {
-				process->set_current_thread(*thread);
-				updateThreads();
-			}
+	if(std::shared_ptr<IThread> thread = threads_model_->thread(internal_index)) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			process->set_current_thread(*thread);
+			updateThreads();
 		}
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: updateThreads
+// Name: selectedThread
 // Desc:
 //------------------------------------------------------------------------------
-void DialogThreads::updateThreads() {
-	threads_model_->clear();
+std::shared_ptr<IThread> DialogThreads::selectedThread() const {
 
-	if(IProcess *process = edb::v1::debugger_core->process()) {
-		std::shared_ptr<IThread> current = process->current_thread();
+	const QModelIndexList selected = ui->thread_table->selectionModel()->selectedRows();
+	if(selected.size() != 1) {
+		return nullptr;
+	}
+
+	const QModelIndex internal_index = threads_filter_->mapToSource(selected.front());
+	return threads_model_->thread(internal_index);
+}
+
+//------------------------------------------------------------------------------
+// Name: updateButtons
+// Desc: the current thread is run and stepped through the main window, and
+//       with all threads stopping together there is nothing to do per thread
+//------------------------------------------------------------------------------
+void DialogThreads::updateButtons() {
 
-		for(std::shared_ptr<IThread> &thread : process->threads()) {
+	bool paused  = false;
+	bool running = false;
 
-			if(thread == current) {
-				threads_model_->addThread(thread, true);
-			} else {
-				threads_model_->addThread(thread, false);
+	if(edb::v1::config().non_stop_mode) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			if(std::shared_ptr<IThread> thread = selectedThread()) {
+				const bool current = thread == process->current_thread();
+				paused  = thread->isPaused() && !current;
+				running = !thread->isPaused();
 			}
 		}
 	}
 
+	ui->btnResume->setEnabled(paused);
+	ui->btnStep->setEnabled(paused);
+	ui->btnSuspend->setEnabled(running);
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnResume_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogThreads::on_btnResume_clicked() {
+	if(std::shared_ptr<IThread> thread = selectedThread()) {
+		const Status status = thread->resume(edb::DEBUG_CONTINUE);
+		if(!status) {
+			QMessageBox::critical(this, tr("Error"), tr("Failed to resume thread: %1").arg(status.toString()));
+		}
+		updateThreads();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnStep_clicked
+// Desc: the step is reported like any other debug event, making the thread
+//       the current one
+//------------------------------------------------------------------------------
+void DialogThreads::on_btnStep_clicked() {
+	if(std::shared_ptr<IThread> thread = selectedThread()) {
+		const Status status = thread->step(edb::DEBUG_CONTINUE);
+		if(!status) {
+			QMessageBox::critical(this, tr("Error"), tr("Failed to step thread: %1").arg(status.toString()));
+		}
+		updateThreads();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnSuspend_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogThreads::on_btnSuspend_clicked() {
+	if(std::shared_ptr<IThread> thread = selectedThread()) {
+		const Status status = thread->stop();
+		if(!status) {
+			QMessageBox::critical(this, tr("Error"), tr("Failed to stop thread: %1").arg(status.toString()));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: updateThreads
+// Desc:
+//------------------------------------------------------------------------------
+void DialogThreads::updateThreads() {
+
+	// every debug event lands here, showEvent catches up on the ones missed
+	if(!isVisible()) {
+		return;
+	}
+
+	if(IProcess *process = edb::v1::debugger_core->process()) {
+		threads_model_->update(process->threads(), process->current_thread());
+	} else {
+		threads_model_->clear();
+	}
+
 	ui->thread_table->horizontalHeader()->resizeSections(QHeaderView::Stretch);
+	updateButtons();
 }
@@ -22,7 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace Ui { class DialogThreads; }
 
 #include <QDialog>
+#include <memory>
 
+class IThread;
 class ThreadsModel;
 class QSortFilterProxyModel;
 class QModelIndex;
@@ -35,8 +37,15 @@ public:
 
 private Q_SLOTS:
 	void on_thread_table_doubleClicked(const QModelIndex &index);
+	void on_btnResume_clicked();
+	void on_btnStep_clicked();
+	void on_btnSuspend_clicked();
+	void updateButtons();
 	void updateThreads();
 
+private:
+	std::shared_ptr<IThread> selectedThread() const;
+
 public:
 	void showEvent(QShowEvent *);
 
@@ -24,6 +24,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QCompleter>
 #include <QPushButton>
+#include <QSet>
+#include <QStringListModel>
+
+namespace {
+
+// the popup only has room for so many, and past that typing more narrows it
+// down faster than scrolling would
+const int MAX_COMPLETIONS = 200;
+
+}
 
 ExpressionDialog::ExpressionDialog(const QString &title, const QString prompt) : QDialog(edb::v1::debugger_ui),
 	layout_(this),
@@ -50,21 +60,40 @@ ExpressionDialog::ExpressionDialog(const QString &title, const QString prompt) :
 	connect(&expression_, SIGNAL(textChanged(const QString&)), this, SLOT(on_text_changed(const QString&)));
 	expression_.selectAll();
 
-	QList<std::shared_ptr<Symbol>> symbols = edb::v1::symbol_manager().symbols();
-	QList<QString> allLabels;
+	// the completions are looked up as the text changes instead of every
+	// symbol being listed up front
+	completions_ = new QStringListModel(this);
+	expression_.setCompleter(new QCompleter(completions_, this));
+}
 
-	for(const std::shared_ptr<Symbol> &sym: symbols)
-	{
-		allLabels.append(sym->name_no_prefix);
+void ExpressionDialog::update_completions(const QString& text) {
+	QStringList names;
+
+	if(!text.isEmpty()) {
+		QSet<QString> seen;
+
+		for(const QString &label : edb::v1::symbol_manager().labels()) {
+			if(label.startsWith(text) && !seen.contains(label)) {
+				seen.insert(label);
+				names.append(label);
+			}
+		}
+
+		edb::v1::symbol_manager().search(text, true, [&](const std::shared_ptr<Symbol> &sym) {
+			if(!seen.contains(sym->name_no_prefix)) {
+				seen.insert(sym->name_no_prefix);
+				names.append(sym->name_no_prefix);
+			}
+			return names.size() < MAX_COMPLETIONS;
+		});
 	}
-	allLabels.append(edb::v1::symbol_manager().labels().values());
 
-	QCompleter *completer = new QCompleter(allLabels);
-	expression_.setCompleter(completer);
-	allLabels.clear();
+	completions_->setStringList(names);
 }
 
 void ExpressionDialog::on_text_changed(const QString& text) {
+	update_completions(text);
+
 	QHash<edb::address_t, QString> labels = edb::v1::symbol_manager().labels();
 	edb::address_t resAddr = labels.key(text);
 
@@ -77,11 +106,10 @@ void ExpressionDialog::on_text_changed(const QString& text) {
 	}
 	else
 	{
-		Expression<edb::address_t> expr(text, edb::v1::get_variable, edb::v1::get_value);
 		ExpressionError err;
 
 		bool ok;
-		last_address_ = expr.evaluate_expression(&ok, &err);
+		last_address_ = edb::v1::evaluate_expression(text, &ok, &err);
 		if(ok) {
 			retval = true;
 		} else {
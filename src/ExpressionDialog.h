@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPalette>
 
 class QString;
+class QStringListModel;
 
 class ExpressionDialog : public QDialog {
 	Q_OBJECT
@@ -38,7 +39,10 @@ public:
 	
 private Q_SLOTS:
 	void on_text_changed(const QString& text);
-	
+
+private:
+	void update_completions(const QString& text);
+
 private:
 	QVBoxLayout      layout_;
 	QLabel           label_text_;
@@ -46,5 +50,6 @@ private:
 	QLineEdit        expression_;
 	QDialogButtonBox button_box_;
 	QPalette         palette_error_;
+	QStringListModel *completions_;
 	edb::address_t   last_address_;
 };
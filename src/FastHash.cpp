@@ -0,0 +1,178 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FastHash.h"
+
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const quint64 PRIME1 = Q_UINT64_C(0x9e3779b185ebca87);
+const quint64 PRIME2 = Q_UINT64_C(0xc2b2ae3d27d4eb4f);
+const quint64 PRIME3 = Q_UINT64_C(0x165667b19e3779f9);
+const quint64 PRIME4 = Q_UINT64_C(0x85ebca77c2b2ae63);
+const quint64 PRIME5 = Q_UINT64_C(0x27d4eb2f165667c5);
+
+// pages are hashed on the thread pool this many at a time, fewer than that in
+// all are done in place
+const std::size_t PAGES_PER_TASK = 256;
+
+inline quint64 rotl(quint64 x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 read64(const quint8 *p) {
+	quint64 v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline quint32 read32(const quint8 *p) {
+	quint32 v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline quint64 lane_round(quint64 acc, quint64 input) {
+	acc += input * PRIME2;
+	acc  = rotl(acc, 31);
+	return acc * PRIME1;
+}
+
+inline quint64 merge_round(quint64 acc, quint64 value) {
+	acc ^= lane_round(0, value);
+	return acc * PRIME1 + PRIME4;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: hash
+// Desc: of the <n> bytes at <p>, read in the byte order of the machine
+//------------------------------------------------------------------------------
+quint64 FastHash::hash(const void *p, std::size_t n, quint64 seed) {
+
+	const quint8 *data       = static_cast<const quint8 *>(p);
+	const quint8 *const last = data + n;
+
+	quint64 h;
+
+	if(n >= 32) {
+		quint64 v1 = seed + PRIME1 + PRIME2;
+		quint64 v2 = seed + PRIME2;
+		quint64 v3 = seed;
+		quint64 v4 = seed - PRIME1;
+
+		const quint8 *const limit = last - 32;
+		do {
+			v1 = lane_round(v1, read64(data));
+			v2 = lane_round(v2, read64(data + 8));
+			v3 = lane_round(v3, read64(data + 16));
+			v4 = lane_round(v4, read64(data + 24));
+			data += 32;
+		} while(data <= limit);
+
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge_round(h, v1);
+		h = merge_round(h, v2);
+		h = merge_round(h, v3);
+		h = merge_round(h, v4);
+	} else {
+		h = seed + PRIME5;
+	}
+
+	h += n;
+
+	for(; data + 8 <= last; data += 8) {
+		h ^= lane_round(0, read64(data));
+		h  = rotl(h, 27) * PRIME1 + PRIME4;
+	}
+
+	if(data + 4 <= last) {
+		h ^= quint64(read32(data)) * PRIME1;
+		h  = rotl(h, 23) * PRIME2 + PRIME3;
+		data += 4;
+	}
+
+	for(; data != last; ++data) {
+		h ^= *data * PRIME5;
+		h  = rotl(h, 11) * PRIME1;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+//------------------------------------------------------------------------------
+// Name: hash_pages
+// Desc: the hash of each of the <page_count> pages of <page_size> bytes at <p>.
+//       Large ranges are split between the threads of the pool
+//------------------------------------------------------------------------------
+QVector<quint64> FastHash::hash_pages(const void *p, std::size_t page_count, std::size_t page_size) {
+
+	QVector<quint64> hashes(static_cast<int>(page_count));
+
+	const quint8 *const data = static_cast<const quint8 *>(p);
+	quint64 *const results   = hashes.data();
+
+	auto hash_run = [data, results, page_count, page_size](std::size_t first) {
+		const std::size_t end = std::min(first + PAGES_PER_TASK, page_count);
+		for(std::size_t i = first; i < end; ++i) {
+			results[i] = hash(data + i * page_size, page_size);
+		}
+	};
+
+#ifdef QT_CONCURRENT_LIB
+	if(page_count > PAGES_PER_TASK) {
+		QVector<std::size_t> runs;
+		for(std::size_t first = 0; first < page_count; first += PAGES_PER_TASK) {
+			runs.push_back(first);
+		}
+
+		QtConcurrent::blockingMap(runs, [hash_run](std::size_t first) {
+			hash_run(first);
+		});
+		return hashes;
+	}
+#endif
+
+	for(std::size_t first = 0; first < page_count; first += PAGES_PER_TASK) {
+		hash_run(first);
+	}
+
+	return hashes;
+}
+
+//------------------------------------------------------------------------------
+// Name: digest
+// Desc: one hash for all of <hashes>, which is never 0, so that 0 can stand
+//       for none
+//------------------------------------------------------------------------------
+quint64 FastHash::digest(const QVector<quint64> &hashes) {
+	const quint64 h = hash(hashes.constData(), hashes.size() * sizeof(quint64), hashes.size());
+	return h ? h : 1;
+}
@@ -18,6 +18,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "FloatX.h"
 
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -281,6 +285,71 @@ long double toFloatValue(edb::value80 value)
 	return value.toFloatValue();
 }
 
+namespace
+{
+// printf and strtod for each width, so that shortestString can be one template
+int printFloat(char* buffer,std::size_t size,int precision,float value)
+{
+	return std::snprintf(buffer,size,"%.*g",precision,static_cast<double>(value));
+}
+
+int printFloat(char* buffer,std::size_t size,int precision,double value)
+{
+	return std::snprintf(buffer,size,"%.*g",precision,value);
+}
+
+int printFloat(char* buffer,std::size_t size,int precision,long double value)
+{
+	return std::snprintf(buffer,size,"%.*Lg",precision,value);
+}
+
+bool readsBack(const char* buffer,float value)
+{
+	return std::strtof(buffer,nullptr)==value;
+}
+
+bool readsBack(const char* buffer,double value)
+{
+	return std::strtod(buffer,nullptr)==value;
+}
+
+bool readsBack(const char* buffer,long double value)
+{
+	return std::strtold(buffer,nullptr)==value;
+}
+
+// The shortest decimal string which reads back as <value>, which must be
+// finite. Rounded to p digits, a value is the p-digit number nearest to it,
+// so if any p-digit number reads back as the value, that one does. Fewer
+// than digits10 digits are never tried since %g drops the trailing zeros
+// anyway, and almost every value the registers hold is done after the first
+// try. This is a couple of snprintf calls into a buffer on the stack, rather
+// than the locale machinery and allocations of a std::ostringstream
+template<typename T>
+QString shortestString(T value)
+{
+	using Limits=std::numeric_limits<T>;
+
+	char buffer[64];
+	for(int precision=Limits::digits10;;++precision)
+	{
+		printFloat(buffer,sizeof buffer,precision,value);
+		if(precision>=Limits::max_digits10 || readsBack(buffer,value))
+			break;
+	}
+
+	// printf writes the decimal point of the C library's locale, which the
+	// application may have set to something other than '.'
+	const char point=*std::localeconv()->decimal_point;
+	if(point!='.')
+	{
+		if(char* p=std::strchr(buffer,point))
+			*p='.';
+	}
+	return QString::fromLatin1(buffer);
+}
+}
+
 template<typename Float>
 QString formatFloat(Float value)
 {
@@ -305,9 +374,7 @@ QString formatFloat(Float value)
 	case FloatValueClass::Normal:
 	case FloatValueClass::Denormal:
 		{
-			std::ostringstream ss;
-			ss << std::setprecision(std::numeric_limits<decltype(toFloatValue(value))>::max_digits10) << toFloatValue(value);
-			const auto result=QString::fromStdString(ss.str());
+			const auto result=shortestString(toFloatValue(value));
 			if(result.size()==1 && result[0].isDigit())
 				return result+".0"; // avoid printing small whole numbers as integers
 			return result;
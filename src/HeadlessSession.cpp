@@ -0,0 +1,391 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "HeadlessSession.h"
+#include "Expression.h"
+#include "IBreakpoint.h"
+#include "IDebugEvent.h"
+#include "IDebugger.h"
+#include "IPlugin.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "MemoryRegions.h"
+#include "State.h"
+#include "edb.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <iostream>
+
+namespace {
+
+// how long a single wait for a debug event is, between which Qt gets to
+// service its events and the timeout is checked
+const int WaitSlice = 100;
+
+//------------------------------------------------------------------------------
+// Name: dump_state_plugin
+// Desc: the DumpState plugin, if it was loaded. It is only ever talked to
+//       through its slots, so there is nothing to link against
+//------------------------------------------------------------------------------
+QObject *dump_state_plugin() {
+	for(QObject *plugin : edb::v1::plugin_list()) {
+		if(qstrcmp(plugin->metaObject()->className(), "DumpStatePlugin::DumpState") == 0) {
+			return plugin;
+		}
+	}
+	return nullptr;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: HeadlessSession
+// Desc:
+//------------------------------------------------------------------------------
+HeadlessSession::HeadlessSession() {
+	edb::v1::add_debug_event_handler(this);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~HeadlessSession
+// Desc:
+//------------------------------------------------------------------------------
+HeadlessSession::~HeadlessSession() {
+	edb::v1::remove_debug_event_handler(this);
+}
+
+//------------------------------------------------------------------------------
+// Name: report
+// Desc: one line of output for whoever runs the session
+//------------------------------------------------------------------------------
+void HeadlessSession::report(const QString &message) {
+	std::cout << "edb: " << qPrintable(message) << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: starts the program (or attaches to <attach_pid>) and runs the script
+//       on it, one command per line. Returns the exit code of the program if
+//       it exited, 0 otherwise and -1 if the session failed
+//------------------------------------------------------------------------------
+int HeadlessSession::run(const QString &script, edb::pid_t attach_pid, const QString &program, const QList<QByteArray> &args) {
+
+	QFile file(script);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		report(QString("unable to open the script %1: %2").arg(script, file.errorString()));
+		return -1;
+	}
+
+	if(attach_pid != 0) {
+		if(const Status status = edb::v1::debugger_core->attach(attach_pid)) {
+			report(QString("attached to %1").arg(attach_pid));
+		} else {
+			report(QString("unable to attach to %1: %2").arg(attach_pid).arg(status.toString()));
+			return -1;
+		}
+	} else if(!program.isEmpty()) {
+		if(const Status status = edb::v1::debugger_core->open(program, QString(), args, QString())) {
+			report(QString("started %1").arg(program));
+		} else {
+			report(QString("unable to start %1: %2").arg(program, status.toString()));
+			return -1;
+		}
+	} else {
+		report("nothing to debug, use --run or --attach");
+		return -1;
+	}
+
+	edb::v1::memory_regions().sync();
+
+	QTextStream in(&file);
+	while(!in.atEnd()) {
+		const QString line = in.readLine().trimmed();
+
+		if(line.isEmpty() || line.startsWith('#')) {
+			continue;
+		}
+
+		if(!execute(line)) {
+			break;
+		}
+	}
+
+	// nothing outlives the session
+	if(edb::v1::debugger_core->process()) {
+		edb::v1::debugger_core->kill();
+	}
+
+	return exit_code_;
+}
+
+//------------------------------------------------------------------------------
+// Name: execute
+// Desc: runs one command of the script, returns false once the session is
+//       over
+//------------------------------------------------------------------------------
+bool HeadlessSession::execute(const QString &line) {
+
+	const QString command  = line.section(' ', 0, 0, QString::SectionSkipEmpty);
+	const QString argument = line.section(' ', 1, -1, QString::SectionSkipEmpty);
+
+	if(command == "quit" || command == "exit") {
+		return false;
+	}
+
+	if(command == "timeout") {
+		bool ok;
+		const double seconds = argument.toDouble(&ok);
+		if(!ok) {
+			report(QString("bad timeout: %1").arg(argument));
+			return false;
+		}
+		timeout_ = (seconds <= 0) ? -1 : static_cast<int>(seconds * 1000);
+		return true;
+	}
+
+	if(!edb::v1::debugger_core->process()) {
+		report(QString("%1: the process is gone").arg(command));
+		return false;
+	}
+
+	if(command == "break" || command == "print") {
+		bool ok;
+		ExpressionError err;
+		const edb::address_t value = edb::v1::evaluate_expression(argument, &ok, &err);
+		if(!ok) {
+			report(QString("%1: %2").arg(argument, err.what()));
+			return false;
+		}
+
+		if(command == "print") {
+			report(QString("%1 = %2").arg(argument, value.toPointerString()));
+		} else if(edb::v1::debugger_core->add_breakpoint(value)) {
+			report(QString("breakpoint at %1").arg(value.toPointerString()));
+		} else {
+			report(QString("unable to set a breakpoint at %1").arg(value.toPointerString()));
+			return false;
+		}
+		return true;
+	}
+
+	if(command == "continue" || command == "run") {
+		return resume(Run, argument == "pass");
+	}
+
+	if(command == "step") {
+		const int count = argument.isEmpty() ? 1 : argument.toInt();
+		for(int i = 0; i < count; ++i) {
+			if(!resume(Step, false)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	if(command == "dump") {
+		QObject *const plugin = dump_state_plugin();
+		bool logged = false;
+		if(!plugin || !QMetaObject::invokeMethod(plugin, "log_state", Qt::DirectConnection, Q_RETURN_ARG(bool, logged)) || !logged) {
+			report("dump: the state log isn't open, see --log-state");
+		}
+		return true;
+	}
+
+	if(command == "kill") {
+		edb::v1::debugger_core->kill();
+		report("killed");
+		return false;
+	}
+
+	if(command == "detach") {
+		edb::v1::debugger_core->detach();
+		report("detached");
+		return false;
+	}
+
+	report(QString("unknown command: %1").arg(command));
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc: like Debugger::resume_execution, a breakpoint we are sitting on is
+//       stepped over with it disabled, then put back once that step is done
+//------------------------------------------------------------------------------
+bool HeadlessSession::resume(ResumeMode mode, bool pass_signal) {
+
+	IProcess *const process = edb::v1::debugger_core->process();
+	const std::shared_ptr<IThread> thread = process->current_thread();
+	if(!thread) {
+		return false;
+	}
+
+	const edb::EVENT_STATUS status = (pass_signal && last_event_ && last_event_->stopped() && !last_event_->is_trap()) ? edb::DEBUG_EXCEPTION_NOT_HANDLED : edb::DEBUG_CONTINUE;
+
+	State state;
+	thread->get_state(&state);
+	if(std::shared_ptr<IBreakpoint> bp = edb::v1::debugger_core->find_breakpoint(state.instruction_pointer())) {
+		bp->disable();
+		reenable_breakpoint_ = bp;
+	}
+
+	run_after_step_ = (mode == Run) && reenable_breakpoint_;
+
+	const Status resumed = (mode == Step || reenable_breakpoint_) ? thread->step(status) : process->resume(status);
+
+	if(!resumed) {
+		report(QString("unable to resume: %1").arg(resumed.toString()));
+		return false;
+	}
+
+	return wait_for_stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_for_stop
+// Desc: pumps debug events through the handlers (DumpState's log among them)
+//       until one of them stops, returns false if the process went away or
+//       the timeout ran out first
+//------------------------------------------------------------------------------
+bool HeadlessSession::wait_for_stop() {
+
+	QElapsedTimer timer;
+	timer.start();
+
+	Q_FOREVER {
+		const std::shared_ptr<IDebugEvent> event = edb::v1::debugger_core->wait_debug_event(WaitSlice);
+		QCoreApplication::processEvents();
+
+		if(!event) {
+			if(timeout_ >= 0 && timer.elapsed() >= timeout_) {
+				report("timed out");
+				return false;
+			}
+			continue;
+		}
+
+		last_event_ = event;
+		edb::v1::memory_regions().sync();
+
+		// the step over a breakpoint is done, unless something else happened
+		// on the way, we can carry on
+		bool stepped_over = false;
+		if(reenable_breakpoint_) {
+			reenable_breakpoint_->enable();
+			reenable_breakpoint_ = nullptr;
+			stepped_over = run_after_step_ && event->is_trap() && event->trap_reason() == IDebugEvent::TRAP_STEPPING;
+		}
+
+		if(stepped_over) {
+			if(!edb::v1::debugger_core->process()->resume(edb::DEBUG_CONTINUE)) {
+				return false;
+			}
+			continue;
+		}
+
+		switch(edb::v1::execute_debug_event_handlers(event)) {
+		case edb::DEBUG_STOP:
+			describe(event);
+			return edb::v1::debugger_core->process() != nullptr;
+		case edb::DEBUG_CONTINUE:
+		case edb::DEBUG_CONTINUE_BP:
+			return resume(Run, false);
+		case edb::DEBUG_CONTINUE_STEP:
+			return resume(Step, false);
+		case edb::DEBUG_EXCEPTION_NOT_HANDLED:
+			return resume(Run, true);
+		default:
+			return false;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: describe
+// Desc: reports the stop, and tidies up after a process which is gone
+//------------------------------------------------------------------------------
+void HeadlessSession::describe(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(event->exited()) {
+		exit_code_ = event->code();
+		report(QString("exited with code %1").arg(event->code()));
+		edb::v1::debugger_core->detach();
+		return;
+	}
+
+	if(event->terminated()) {
+		exit_code_ = -1;
+		report(QString("terminated by signal %1").arg(event->code()));
+		edb::v1::debugger_core->detach();
+		return;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+	const QString where = state.instruction_pointer().toPointerString();
+
+	if(event->is_trap()) {
+		switch(event->trap_reason()) {
+		case IDebugEvent::TRAP_BREAKPOINT:
+			report(QString("breakpoint at %1").arg(where));
+			return;
+		case IDebugEvent::TRAP_STEPPING:
+			report(QString("stepped to %1").arg(where));
+			return;
+		case IDebugEvent::TRAP_SYSCALL:
+			report(QString("system call %1 at %2").arg(event->syscall_number()).arg(where));
+			return;
+		}
+	}
+
+	const QMap<qlonglong, QString> exceptions = edb::v1::debugger_core->exceptions();
+	report(QString("signal %1 (%2) at %3").arg(event->code()).arg(exceptions.value(event->code(), "unknown"), where));
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc: the part of Debugger::handle_trap that a script needs, our breakpoints
+//       back the instruction pointer up to where they are, everything stops
+//------------------------------------------------------------------------------
+edb::EVENT_STATUS HeadlessSession::handle_event(const std::shared_ptr<IDebugEvent> &event) {
+
+	if(event->stopped() && event->is_trap() && event->trap_reason() == IDebugEvent::TRAP_BREAKPOINT) {
+
+		State state;
+		edb::v1::debugger_core->get_state(&state);
+
+		const std::shared_ptr<IBreakpoint> bp = edb::v1::find_triggered_breakpoint(state.instruction_pointer());
+		if(bp && bp->enabled()) {
+			bp->hit();
+			state.set_instruction_pointer(bp->address());
+			edb::v1::debugger_core->set_state(state);
+
+			if(bp->one_time()) {
+				edb::v1::debugger_core->remove_breakpoint(bp->address());
+			}
+		}
+	}
+
+	return edb::DEBUG_STOP;
+}
@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HEADLESS_SESSION_20171014_H_
+#define HEADLESS_SESSION_20171014_H_
+
+#include "IDebugEventHandler.h"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <memory>
+
+class IBreakpoint;
+class IDebugEvent;
+
+// drives the debugger core from a command script, with no main window or
+// plugin UIs. It is the bottom debug event handler for the session, the way
+// Debugger is for an interactive one
+class HeadlessSession : public IDebugEventHandler {
+public:
+	HeadlessSession();
+	virtual ~HeadlessSession();
+
+public:
+	int run(const QString &script, edb::pid_t attach_pid, const QString &program, const QList<QByteArray> &args);
+
+public:
+	virtual edb::EVENT_STATUS handle_event(const std::shared_ptr<IDebugEvent> &event);
+
+private:
+	enum ResumeMode {
+		Run,
+		Step
+	};
+
+private:
+	bool execute(const QString &line);
+	bool resume(ResumeMode mode, bool pass_signal);
+	bool wait_for_stop();
+	void describe(const std::shared_ptr<IDebugEvent> &event);
+	void report(const QString &message);
+
+private:
+	std::shared_ptr<IDebugEvent> last_event_;
+	std::shared_ptr<IBreakpoint> reenable_breakpoint_;
+	bool                         run_after_step_ = false;
+	int                          timeout_        = -1; // in milliseconds, -1 is forever
+	int                          exit_code_      = 0;
+};
+
+#endif
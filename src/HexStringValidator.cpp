@@ -39,7 +39,7 @@ void HexStringValidator::fixup(QString &input) const {
 
 	for(QChar ch: input) {
 		const int c = ch.toLatin1();
-		if(c < 0x80 && std::isxdigit(c)) {
+		if(c < 0x80 && (std::isxdigit(c) || (wildcards_ && c == '?'))) {
 
 			if(index != 0 && (index & 1) == 0) {
 				temp += ' ';
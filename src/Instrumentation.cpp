@@ -0,0 +1,394 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Instrumentation.h"
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<int> Instrumentation::flags_(0);
+
+namespace {
+
+struct Event {
+	const char *name;
+	qint64      start;
+	qint64      duration;
+};
+
+// the scopes of one thread. Only that thread writes to it, the lock is for
+// chrome_trace and clear, so it is never contended while recording
+struct Ring {
+	std::mutex     mutex;
+	QVector<Event> events;
+	int            next = 0;
+	bool           full = false;
+	int            id;
+	QString        name;
+};
+
+// rings outlive their threads, so that what a worker recorded can still be
+// exported after it is gone
+struct Registry {
+	std::mutex                         mutex;
+	std::vector<std::unique_ptr<Ring>> rings;
+	QElapsedTimer                      clock;
+
+	Registry() {
+		clock.start();
+	}
+};
+
+Registry &registry() {
+	static Registry instance;
+	return instance;
+}
+
+thread_local Ring *thread_ring = nullptr;
+
+// the innermost segment being timed on this thread
+thread_local ScopedTrace *thread_segment = nullptr;
+
+// the command under way and what its segments took so far
+struct CommandTiming {
+	int                 command = -1;
+	qint64              start   = 0;
+	std::atomic<qint64> segments[Instrumentation::SegmentCount];
+
+	CommandTiming() {
+		for(std::atomic<qint64> &segment : segments) {
+			segment.store(0);
+		}
+	}
+};
+
+CommandTiming &command_timing() {
+	static CommandTiming instance;
+	return instance;
+}
+
+struct Histograms {
+	std::mutex       mutex;
+	LatencyHistogram histograms[Instrumentation::CommandCount][Instrumentation::HistogramCount];
+};
+
+Histograms &histograms() {
+	static Histograms instance;
+	return instance;
+}
+
+//------------------------------------------------------------------------------
+// Name: current_ring
+// Desc:
+//------------------------------------------------------------------------------
+Ring *current_ring() {
+
+	if(!thread_ring) {
+		auto ring = std::unique_ptr<Ring>(new Ring);
+		ring->events.resize(Instrumentation::RingSize);
+
+		QThread *const thread = QThread::currentThread();
+		if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+			ring->name = "GUI";
+		} else if(thread && !thread->objectName().isEmpty()) {
+			ring->name = thread->objectName();
+		}
+
+		Registry &r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		ring->id = static_cast<int>(r.rings.size()) + 1;
+		if(ring->name.isEmpty()) {
+			ring->name = QString("Thread %1").arg(ring->id);
+		}
+
+		thread_ring = ring.get();
+		r.rings.push_back(std::move(ring));
+	}
+
+	return thread_ring;
+}
+
+//------------------------------------------------------------------------------
+// Name: append_json_string
+// Desc:
+//------------------------------------------------------------------------------
+void append_json_string(QByteArray *out, const QByteArray &s) {
+	out->append('"');
+	for(char ch : s) {
+		if(ch == '"' || ch == '\\') {
+			out->append('\\');
+		}
+		out->append(ch);
+	}
+	out->append('"');
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: set_enabled
+// Desc:
+//------------------------------------------------------------------------------
+void Instrumentation::set_enabled(bool enable) {
+	registry();
+	if(enable) {
+		flags_.fetch_or(Recording, std::memory_order_relaxed);
+	} else {
+		flags_.fetch_and(~Recording, std::memory_order_relaxed);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc: forgets everything recorded so far
+//------------------------------------------------------------------------------
+void Instrumentation::clear() {
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for(const std::unique_ptr<Ring> &ring : r.rings) {
+		std::lock_guard<std::mutex> ring_lock(ring->mutex);
+		ring->next = 0;
+		ring->full = false;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: now
+// Desc: nanoseconds since the first use
+//------------------------------------------------------------------------------
+qint64 Instrumentation::now() {
+	return registry().clock.nsecsElapsed();
+}
+
+//------------------------------------------------------------------------------
+// Name: record
+// Desc:
+//------------------------------------------------------------------------------
+void Instrumentation::record(const char *name, qint64 start, qint64 end) {
+
+	Ring *const ring = current_ring();
+
+	std::lock_guard<std::mutex> lock(ring->mutex);
+	ring->events[ring->next] = { name, start, end - start };
+	if(++ring->next == RingSize) {
+		ring->next = 0;
+		ring->full = true;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: chrome_trace
+// Desc: complete ("X") events in microseconds, plus the names of the threads
+//------------------------------------------------------------------------------
+QByteArray Instrumentation::chrome_trace() {
+
+	QByteArray json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+
+	auto separator = [&]() {
+		if(!first) {
+			json.append(",\n");
+		}
+		first = false;
+	};
+
+	const qint64 pid = QCoreApplication::applicationPid();
+
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for(const std::unique_ptr<Ring> &ring : r.rings) {
+		std::lock_guard<std::mutex> ring_lock(ring->mutex);
+
+		separator();
+		json.append(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":").arg(pid).arg(ring->id).toLatin1());
+		append_json_string(&json, ring->name.toUtf8());
+		json.append("}}");
+
+		const int count = ring->full ? RingSize : ring->next;
+		const int begin = ring->full ? ring->next : 0;
+		for(int i = 0; i < count; ++i) {
+			const Event &event = ring->events[(begin + i) % RingSize];
+			separator();
+			json.append("{\"name\":");
+			append_json_string(&json, event.name);
+			json.append(QString(",\"ph\":\"X\",\"pid\":%1,\"tid\":%2,\"ts\":%3,\"dur\":%4}")
+				.arg(pid)
+				.arg(ring->id)
+				.arg(event.start / 1000.0, 0, 'f', 3)
+				.arg(event.duration / 1000.0, 0, 'f', 3).toLatin1());
+		}
+	}
+
+	json.append("]}\n");
+	return json;
+}
+
+//------------------------------------------------------------------------------
+// Name: begin_command
+// Desc:
+//------------------------------------------------------------------------------
+void Instrumentation::begin_command(Command command) {
+
+	CommandTiming &timing = command_timing();
+	for(std::atomic<qint64> &segment : timing.segments) {
+		segment.store(0, std::memory_order_relaxed);
+	}
+
+	timing.command = command;
+	timing.start   = now();
+	flags_.fetch_or(Measuring, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Name: end_command
+// Desc: called once the views show where the command ended up
+//------------------------------------------------------------------------------
+void Instrumentation::end_command() {
+
+	if(!(flags() & Measuring)) {
+		return;
+	}
+
+	flags_.fetch_and(~Measuring, std::memory_order_relaxed);
+
+	CommandTiming &timing = command_timing();
+	const qint64 total = now() - timing.start;
+
+	Histograms &h = histograms();
+	std::lock_guard<std::mutex> lock(h.mutex);
+	LatencyHistogram *const command = h.histograms[timing.command];
+
+	qint64 accounted = 0;
+	for(int i = 0; i < SegmentCount; ++i) {
+		const qint64 ns = timing.segments[i].load(std::memory_order_relaxed);
+		command[i].add(ns);
+		accounted += ns;
+	}
+
+	command[Other].add(std::max<qint64>(total - accounted, 0));
+	command[Total].add(total);
+}
+
+//------------------------------------------------------------------------------
+// Name: add_segment
+// Desc:
+//------------------------------------------------------------------------------
+void Instrumentation::add_segment(int segment, qint64 ns) {
+	if(segment >= 0 && segment < SegmentCount) {
+		command_timing().segments[segment].fetch_add(ns, std::memory_order_relaxed);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: histogram
+// Desc:
+//------------------------------------------------------------------------------
+LatencyHistogram Instrumentation::histogram(Command command, int segment) {
+	Histograms &h = histograms();
+	std::lock_guard<std::mutex> lock(h.mutex);
+	return h.histograms[command][segment];
+}
+
+//------------------------------------------------------------------------------
+// Name: reset_histograms
+// Desc:
+//------------------------------------------------------------------------------
+void Instrumentation::reset_histograms() {
+	Histograms &h = histograms();
+	std::lock_guard<std::mutex> lock(h.mutex);
+	for(LatencyHistogram (&command)[HistogramCount] : h.histograms) {
+		for(LatencyHistogram &histogram : command) {
+			histogram.clear();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: command_name
+// Desc:
+//------------------------------------------------------------------------------
+QString Instrumentation::command_name(int command) {
+	switch(command) {
+	case StepInto: return QObject::tr("Step Into");
+	case StepOver: return QObject::tr("Step Over");
+	case Run:      return QObject::tr("Run");
+	case Pause:    return QObject::tr("Pause");
+	default:       return QString();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: segment_name
+// Desc:
+//------------------------------------------------------------------------------
+QString Instrumentation::segment_name(int segment) {
+	switch(segment) {
+	case EventWait:     return QObject::tr("Event wait");
+	case ThreadStop:    return QObject::tr("Stopping threads");
+	case StateFetch:    return QObject::tr("State fetch");
+	case EventHandlers: return QObject::tr("Event handlers");
+	case GuiRefresh:    return QObject::tr("GUI refresh");
+	case Other:         return QObject::tr("Other");
+	case Total:         return QObject::tr("Total");
+	default:            return QString();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: begin
+// Desc:
+//------------------------------------------------------------------------------
+void ScopedTrace::begin() {
+	start_ = Instrumentation::now();
+	if(segment_ >= 0 && (flags_ & Instrumentation::Measuring)) {
+		parent_        = thread_segment;
+		thread_segment = this;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: end
+// Desc:
+//------------------------------------------------------------------------------
+void ScopedTrace::end() {
+
+	const qint64 end = Instrumentation::now();
+
+	if(flags_ & Instrumentation::Recording) {
+		Instrumentation::record(name_, start_, end);
+	}
+
+	if(segment_ >= 0 && (flags_ & Instrumentation::Measuring)) {
+		const qint64 duration = end - start_;
+		Instrumentation::add_segment(segment_, duration - children_);
+		if(parent_) {
+			parent_->children_ += duration;
+		}
+		thread_segment = parent_;
+	}
+}
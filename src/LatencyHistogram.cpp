@@ -0,0 +1,144 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// the values below 2^SubBucketBits each get a bucket of their own, beyond
+// that every power of two is split into half as many buckets
+const int SubBucketBits = 7;
+const int SubBuckets    = 1 << SubBucketBits;
+const int HalfBuckets   = SubBuckets / 2;
+const int BucketCount   = SubBuckets + (64 - SubBucketBits) * HalfBuckets;
+
+//------------------------------------------------------------------------------
+// Name: highest_bit
+// Desc:
+//------------------------------------------------------------------------------
+int highest_bit(quint64 value) {
+	int bit = 0;
+	while(value >>= 1) {
+		++bit;
+	}
+	return bit;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: bucket
+// Desc:
+//------------------------------------------------------------------------------
+int LatencyHistogram::bucket(qint64 ns) {
+
+	const quint64 value = static_cast<quint64>(std::max<qint64>(ns, 0));
+	if(value < static_cast<quint64>(SubBuckets)) {
+		return static_cast<int>(value);
+	}
+
+	const int shift = highest_bit(value) - (SubBucketBits - 1);
+	const int sub   = static_cast<int>(value >> shift) - HalfBuckets;
+	return SubBuckets + (shift - 1) * HalfBuckets + sub;
+}
+
+//------------------------------------------------------------------------------
+// Name: bucket_value
+// Desc: the middle of the values which fall into bucket <index>
+//------------------------------------------------------------------------------
+qint64 LatencyHistogram::bucket_value(int index) {
+
+	if(index < SubBuckets) {
+		return index;
+	}
+
+	const int shift     = (index - SubBuckets) / HalfBuckets + 1;
+	const quint64 first = static_cast<quint64>((index - SubBuckets) % HalfBuckets + HalfBuckets) << shift;
+	return static_cast<qint64>(first + ((quint64(1) << shift) >> 1));
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc:
+//------------------------------------------------------------------------------
+void LatencyHistogram::add(qint64 ns) {
+
+	if(counts_.isEmpty()) {
+		counts_.resize(BucketCount);
+	}
+
+	++counts_[bucket(ns)];
+
+	if(count_ == 0 || ns < min_) {
+		min_ = ns;
+	}
+
+	if(count_ == 0 || ns > max_) {
+		max_ = ns;
+	}
+
+	++count_;
+	sum_ += ns;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void LatencyHistogram::clear() {
+	counts_.clear();
+	count_ = 0;
+	min_   = 0;
+	max_   = 0;
+	sum_   = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: mean
+// Desc:
+//------------------------------------------------------------------------------
+qint64 LatencyHistogram::mean() const {
+	return count_ ? static_cast<qint64>(sum_ / count_) : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: percentile
+// Desc: the value which <p> percent of the values are at or below
+//------------------------------------------------------------------------------
+qint64 LatencyHistogram::percentile(double p) const {
+
+	if(count_ == 0) {
+		return 0;
+	}
+
+	const quint64 wanted = std::max<quint64>(1, static_cast<quint64>(std::ceil(count_ * std::min(p, 100.0) / 100.0)));
+
+	quint64 seen = 0;
+	for(int i = 0; i < counts_.size(); ++i) {
+		seen += counts_[i];
+		if(seen >= wanted) {
+			return std::min(std::max(bucket_value(i), min_), max_);
+		}
+	}
+
+	return max_;
+}
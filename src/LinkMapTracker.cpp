@@ -0,0 +1,233 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LinkMapTracker.h"
+#include "IProcess.h"
+
+#if defined(Q_OS_LINUX)
+#include "linker.h"
+#endif
+
+#include <QByteArray>
+#include <QSet>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+#if defined(Q_OS_LINUX)
+
+// a corrupt chain could loop forever otherwise
+const int MaxChainLength = 0x10000;
+
+//------------------------------------------------------------------------------
+// Name: read_name
+// Desc: reads the NUL terminated string at <address> in small pieces, most
+//       names are short and a PATH_MAX sized read can run off the mapping
+//------------------------------------------------------------------------------
+QString read_name(IProcess *process, edb::address_t address) {
+
+	QByteArray name;
+
+	while(address && name.size() < PATH_MAX) {
+		char buffer[256];
+		const std::size_t n = process->read_bytes(address, buffer, sizeof(buffer));
+		if(n == 0) {
+			break;
+		}
+
+		if(const void *end = std::memchr(buffer, '\0', n)) {
+			name.append(buffer, static_cast<int>(static_cast<const char *>(end) - buffer));
+			break;
+		}
+
+		name.append(buffer, static_cast<int>(n));
+		address += n;
+	}
+
+	return QString::fromLocal8Bit(name);
+}
+
+//------------------------------------------------------------------------------
+// Name: add_change
+// Desc: the main program is on the chain too, but only with an empty name
+//------------------------------------------------------------------------------
+void add_change(QList<Module> *list, const Module &module) {
+	if(!module.name.isEmpty()) {
+		list->push_back(module);
+	}
+}
+
+#endif
+
+}
+
+//------------------------------------------------------------------------------
+// Name: reset
+// Desc: forget everything, for when a new process is debugged
+//------------------------------------------------------------------------------
+void LinkMapTracker::reset() {
+	nodes_.clear();
+	previous_state_ = 0;
+	walked_         = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: modules
+// Desc:
+//------------------------------------------------------------------------------
+QList<Module> LinkMapTracker::modules() const {
+	QList<Module> results;
+	for(const Node &node : nodes_) {
+		results.push_back(node.module);
+	}
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: update
+// Desc: to be called each time the linker hook is hit, returns the libraries
+//       which were loaded or unloaded since the last time the chain was
+//       consistent. Nothing is reported while the linker is still changing it
+//------------------------------------------------------------------------------
+LinkMapTracker::Changes LinkMapTracker::update(IProcess *process, edb::address_t debug_pointer, bool is32) {
+#if defined(Q_OS_LINUX)
+	if(process && debug_pointer) {
+		return is32 ? update<quint32>(process, debug_pointer) : update<quint64>(process, debug_pointer);
+	}
+#else
+	Q_UNUSED(process);
+	Q_UNUSED(debug_pointer);
+	Q_UNUSED(is32);
+#endif
+	return Changes();
+}
+
+#if defined(Q_OS_LINUX)
+
+//------------------------------------------------------------------------------
+// Name: update
+// Desc:
+//------------------------------------------------------------------------------
+template <class Addr>
+LinkMapTracker::Changes LinkMapTracker::update(IProcess *process, edb::address_t debug_pointer) {
+
+	using r_debug  = edb::linux_struct::r_debug<Addr>;
+	using link_map = edb::linux_struct::link_map<Addr>;
+
+	Changes changes;
+
+	r_debug dynamic_info;
+	if(!process->read_bytes(debug_pointer, &dynamic_info, sizeof(dynamic_info))) {
+		return changes;
+	}
+
+	if(dynamic_info.r_state != r_debug::RT_CONSISTENT) {
+		// the chain is only safe to read once the linker is done with it
+		previous_state_ = dynamic_info.r_state;
+		return changes;
+	}
+
+	if(walked_) {
+		switch(previous_state_) {
+		case r_debug::RT_CONSISTENT:
+			return changes;
+		case r_debug::RT_ADD:
+			// the last node we know of is still there, everything after it is new
+			if(!nodes_.isEmpty()) {
+				link_map tail;
+				QVector<Node> added;
+				if(process->read_bytes(nodes_.last().address, &tail, sizeof(tail)) && walk<Addr>(process, edb::address_t::fromZeroExtended(tail.l_next), &added)) {
+					for(const Node &node : added) {
+						add_change(&changes.added, node.module);
+					}
+
+					nodes_ += added;
+					previous_state_ = r_debug::RT_CONSISTENT;
+					return changes;
+				}
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// an unload can take nodes out from anywhere, so read it all and compare
+	QVector<Node> nodes;
+	if(!walk<Addr>(process, edb::address_t::fromZeroExtended(dynamic_info.r_map), &nodes)) {
+		return changes;
+	}
+
+	QSet<quint64> old_addresses;
+	QSet<quint64> new_addresses;
+
+	for(const Node &node : nodes_) {
+		old_addresses.insert(node.address.toUint());
+	}
+
+	for(const Node &node : nodes) {
+		new_addresses.insert(node.address.toUint());
+		if(!old_addresses.contains(node.address.toUint())) {
+			add_change(&changes.added, node.module);
+		}
+	}
+
+	for(const Node &node : nodes_) {
+		if(!new_addresses.contains(node.address.toUint())) {
+			add_change(&changes.removed, node.module);
+		}
+	}
+
+	nodes_          = nodes;
+	previous_state_ = r_debug::RT_CONSISTENT;
+	walked_         = true;
+	return changes;
+}
+
+//------------------------------------------------------------------------------
+// Name: walk
+// Desc: appends the nodes from <link_address> to the end of the chain
+//------------------------------------------------------------------------------
+template <class Addr>
+bool LinkMapTracker::walk(IProcess *process, edb::address_t link_address, QVector<Node> *nodes) {
+
+	for(int i = 0; link_address; ++i) {
+
+		if(i == MaxChainLength) {
+			return false;
+		}
+
+		edb::linux_struct::link_map<Addr> map;
+		if(!process->read_bytes(link_address, &map, sizeof(map))) {
+			return false;
+		}
+
+		Node node;
+		node.address             = link_address;
+		node.module.name         = read_name(process, edb::address_t::fromZeroExtended(map.l_name));
+		node.module.base_address = edb::address_t::fromZeroExtended(map.l_addr);
+		nodes->push_back(node);
+
+		link_address = edb::address_t::fromZeroExtended(map.l_next);
+	}
+
+	return true;
+}
+
+#endif
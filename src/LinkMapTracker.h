@@ -0,0 +1,68 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LINK_MAP_TRACKER_20170710_H_
+#define LINK_MAP_TRACKER_20170710_H_
+
+#include "Module.h"
+#include "Types.h"
+#include <QList>
+#include <QVector>
+
+class IProcess;
+
+// Follows the dynamic linker's list of loaded objects (r_debug/link_map)
+// across the library events. The linker appends new objects to the end of
+// the chain, so after a load only the nodes past the last one we know of are
+// read, the whole chain is only walked again after an unload.
+class LinkMapTracker {
+public:
+	struct Changes {
+		QList<Module> added;
+		QList<Module> removed;
+
+		bool isEmpty() const { return added.isEmpty() && removed.isEmpty(); }
+	};
+
+public:
+	void reset();
+	Changes update(IProcess *process, edb::address_t debug_pointer, bool is32);
+
+	// the libraries loaded as of the last update which found the chain consistent
+	QList<Module> modules() const;
+
+private:
+	struct Node {
+		edb::address_t address; // of the link_map itself
+		Module         module;
+	};
+
+private:
+	template <class Addr>
+	Changes update(IProcess *process, edb::address_t debug_pointer);
+
+	template <class Addr>
+	bool walk(IProcess *process, edb::address_t link_address, QVector<Node> *nodes);
+
+private:
+	QVector<Node> nodes_;
+	int           previous_state_ = 0; // RT_CONSISTENT
+	bool          walked_         = false;
+};
+
+#endif
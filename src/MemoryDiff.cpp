@@ -0,0 +1,286 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "MemoryDiff.h"
+#include "Checkpoint.h"
+#include "Configuration.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "edb.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: describe_changes
+// Desc: the offsets into the row of the bytes which differ, runs of them
+//       written as ranges. Empty if nothing changed, or there is nothing to
+//       compare against
+//------------------------------------------------------------------------------
+QString describe_changes(const QByteArray &before, const QByteArray &after) {
+
+	const int size = std::min(before.size(), after.size());
+
+	QStringList runs;
+	int i = 0;
+	while(i < size) {
+		if(before[i] == after[i]) {
+			++i;
+			continue;
+		}
+
+		const int first = i;
+		while(i < size && before[i] != after[i]) {
+			++i;
+		}
+
+		const int last = i - 1;
+		if(first == last) {
+			runs << QString("+%1").arg(first, 0, 16);
+		} else {
+			runs << QString("+%1..+%2").arg(first, 0, 16).arg(last, 0, 16);
+		}
+	}
+
+	if(runs.isEmpty()) {
+		return QString();
+	}
+
+	return QObject::tr("changed %1").arg(runs.join(", "));
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: MemoryDiff
+// Desc:
+//------------------------------------------------------------------------------
+MemoryDiff::MemoryDiff(const QSharedPointer<QHexView::CommentServerInterface> &comments) : comments_(comments) {
+}
+
+//------------------------------------------------------------------------------
+// Name: set_comment
+// Desc:
+//------------------------------------------------------------------------------
+void MemoryDiff::set_comment(QHexView::address_t address, const QString &comment) {
+	if(comments_) {
+		comments_->set_comment(address, comment);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void MemoryDiff::clear() {
+	if(comments_) {
+		comments_->clear();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_enabled
+// Desc: the first stop drawn afterwards is what the next one is compared to
+//------------------------------------------------------------------------------
+void MemoryDiff::set_enabled(bool enabled) {
+	enabled_ = enabled;
+	rows_.clear();
+	previous_rows_.clear();
+	changes_known_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_baseline
+// Desc: compares against checkpoint <checkpoint> from now on, or against the
+//       previous stop if it is 0
+//------------------------------------------------------------------------------
+void MemoryDiff::set_baseline(int checkpoint) {
+	baseline_ = checkpoint;
+	rows_.clear();
+	checkpoint_rows_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: update
+// Desc: the view is drawn for stop number <stop>, which may be the one it was
+//       drawn for last time, in which case it is only read again
+//------------------------------------------------------------------------------
+void MemoryDiff::update(const std::shared_ptr<IRegion> &region, quint64 stop) {
+
+	if(stop == stop_) {
+		invalidate();
+		return;
+	}
+
+	// the soft-dirty bits go back to the last time the debuggee was continued,
+	// which covers no more than the stop before this one
+	const bool consecutive = (stop == stop_ + 1);
+	stop_ = stop;
+
+	previous_rows_.clear();
+	for(auto it = rows_.constBegin(); it != rows_.constEnd(); ++it) {
+		previous_rows_.insert(it.key(), it->bytes);
+	}
+
+	rows_.clear();
+	changed_pages_.clear();
+	changes_known_ = false;
+
+	if(!enabled_ || !edb::v1::debugger_core) {
+		return;
+	}
+
+	if(baseline_ != 0) {
+		bool found = false;
+		for(const Checkpoint &checkpoint : edb::v1::debugger_core->checkpoints()) {
+			found = found || checkpoint.id == baseline_;
+		}
+
+		if(!found) {
+			set_baseline(0);
+		}
+	}
+
+	if(consecutive && region) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			QVector<edb::address_t> pages;
+			if(process->changed_pages(region, &pages)) {
+				changes_known_ = true;
+				for(edb::address_t page : pages) {
+					changed_pages_.insert(page);
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate
+// Desc: the debuggee's memory was written to while it is stopped, the rows
+//       have to be read again, and the soft-dirty bits can't tell which
+//------------------------------------------------------------------------------
+void MemoryDiff::invalidate() {
+	rows_.clear();
+	changes_known_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: comment
+// Desc: a row is read and compared once for each stop, whenever it is first
+//       drawn
+//------------------------------------------------------------------------------
+QString MemoryDiff::comment(QHexView::address_t address, int size) const {
+
+	const QString text = comments_ ? comments_->comment(address, size) : QString();
+
+	if(!enabled_ || size <= 0) {
+		return text;
+	}
+
+	auto it = rows_.find(address);
+	if(it == rows_.end()) {
+		const int row_size = size * edb::v1::config().data_row_width;
+
+		Row row;
+		const QByteArray before = baseline_row(address, row_size);
+		if(baseline_ == 0 && before.size() == row_size && row_unchanged(address, row_size)) {
+			row.bytes = before;
+		} else {
+			row.bytes = read_row(address, row_size);
+			row.text  = describe_changes(before, row.bytes);
+		}
+
+		it = rows_.insert(address, row);
+	}
+
+	if(it->text.isEmpty()) {
+		return text;
+	}
+
+	return text.isEmpty() ? it->text : QString("%1  %2").arg(it->text, text);
+}
+
+//------------------------------------------------------------------------------
+// Name: read_row
+// Desc:
+//------------------------------------------------------------------------------
+QByteArray MemoryDiff::read_row(edb::address_t address, int size) const {
+
+	QByteArray bytes(size, '\0');
+
+	IProcess *process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		return QByteArray();
+	}
+
+	bytes.resize(static_cast<int>(process->read_bytes(address, bytes.data(), size)));
+	return bytes;
+}
+
+//------------------------------------------------------------------------------
+// Name: baseline_row
+// Desc: what the row is compared against, empty if there is nothing to
+//       compare it against
+//------------------------------------------------------------------------------
+QByteArray MemoryDiff::baseline_row(edb::address_t address, int size) const {
+
+	if(baseline_ == 0) {
+		return previous_rows_.value(address);
+	}
+
+	// a checkpoint never changes, what was read from it stays good
+	auto it = checkpoint_rows_.find(address);
+	if(it != checkpoint_rows_.end() && it->size() == size) {
+		return *it;
+	}
+
+	QByteArray bytes(size, '\0');
+	bytes.resize(static_cast<int>(edb::v1::debugger_core->read_checkpoint(baseline_, address, bytes.data(), size)));
+	checkpoint_rows_.insert(address, bytes);
+	return bytes;
+}
+
+//------------------------------------------------------------------------------
+// Name: row_unchanged
+// Desc: true if none of the pages the row is in were written to since the
+//       previous stop
+//------------------------------------------------------------------------------
+bool MemoryDiff::row_unchanged(edb::address_t address, int size) const {
+
+	if(!changes_known_) {
+		return false;
+	}
+
+	const edb::address_t page_size = edb::v1::debugger_core->page_size();
+	const edb::address_t last      = address + size - 1;
+
+	for(edb::address_t page = address & ~(page_size - 1); page <= last; page += page_size) {
+		if(changed_pages_.contains(page)) {
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,84 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MEMORY_DIFF_20171014_H_
+#define MEMORY_DIFF_20171014_H_
+
+#include "QHexView"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+
+#include <memory>
+
+class IRegion;
+
+// Marks the bytes of the rows a data view shows which changed since the
+// previous stop, or since a checkpoint was taken, in the view's comment
+// column, ahead of the comments of the comment server it stands in front of.
+//
+// The rows are remembered as they were drawn at each stop, so only what could
+// be seen is compared. Rows in pages the soft-dirty bits say weren't written
+// to since the previous stop aren't read again.
+class MemoryDiff : public QHexView::CommentServerInterface {
+public:
+	explicit MemoryDiff(const QSharedPointer<QHexView::CommentServerInterface> &comments);
+	virtual ~MemoryDiff() = default;
+
+public:
+	virtual void set_comment(QHexView::address_t address, const QString &comment);
+	virtual QString comment(QHexView::address_t address, int size) const;
+	virtual void clear();
+
+public:
+	bool enabled() const  { return enabled_; }
+	int baseline() const  { return baseline_; }
+	void set_enabled(bool enabled);
+	void set_baseline(int checkpoint);
+	void update(const std::shared_ptr<IRegion> &region, quint64 stop);
+	void invalidate();
+
+private:
+	struct Row {
+		QByteArray bytes;
+		QString    text;
+	};
+
+private:
+	QByteArray read_row(edb::address_t address, int size) const;
+	QByteArray baseline_row(edb::address_t address, int size) const;
+	bool row_unchanged(edb::address_t address, int size) const;
+
+private:
+	QSharedPointer<QHexView::CommentServerInterface> comments_;
+	bool                          enabled_        = false;
+	int                           baseline_       = 0; // a checkpoint, or 0 for the previous stop
+	quint64                       stop_           = 0;
+	bool                          changes_known_  = false;
+	QSet<edb::address_t>          changed_pages_; // since the previous stop, if known
+	mutable QHash<quint64, Row>   rows_;          // as drawn at this stop
+	QHash<quint64, QByteArray>    previous_rows_; // and at the previous one
+	mutable QHash<quint64, QByteArray> checkpoint_rows_;
+};
+
+#endif
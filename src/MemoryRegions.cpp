@@ -20,16 +20,42 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IProcess.h"
 #include "IRegion.h"
 #include "ISymbolManager.h"
+#include "Instrumentation.h"
 #include "MemoryRegions.h"
 #include "edb.h"
 
 #include <QDebug>
 
+#include <algorithm>
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: format_size
+// Desc:
+//------------------------------------------------------------------------------
+QString format_size(quint64 n) {
+
+	static constexpr quint64 KiB = 1024;
+	static constexpr quint64 MiB = KiB * 1024;
+	static constexpr quint64 GiB = MiB * 1024;
+
+	if(n < MiB) {
+		return QString::number(n / KiB) + " KiB";
+	} else if(n < GiB) {
+		return QString::number(static_cast<double>(n) / MiB, 'f', 1) + " MiB";
+	} else {
+		return QString::number(static_cast<double>(n) / GiB, 'f', 1) + " GiB";
+	}
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: MemoryRegions
 // Desc: constructor
 //------------------------------------------------------------------------------
-MemoryRegions::MemoryRegions() : QAbstractItemModel(0) {
+MemoryRegions::MemoryRegions() : QAbstractItemModel(0), modules_generation_(0) {
 }
 
 //------------------------------------------------------------------------------
@@ -44,40 +70,225 @@ MemoryRegions::~MemoryRegions() {
 // Desc:
 //------------------------------------------------------------------------------
 void MemoryRegions::clear() {
+	beginResetModel();
 	regions_.clear();
+	region_ends_.clear();
+	new_modules_.clear();
+	usage_.clear();
+	++modules_generation_;
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: is_module
+// Desc: if the region has a name, is mapped starting at the beginning of the
+//       file, and is executable, sounds like a module mapping!
+//------------------------------------------------------------------------------
+bool MemoryRegions::is_module(const std::shared_ptr<IRegion> &region) {
+	return !region->name().isEmpty() && region->base() == 0 && region->executable();
+}
+
+//------------------------------------------------------------------------------
+// Name: note_module
+// Desc: notes a newly mapped module, it is handed to the symbol manager once
+//       the sync knows all of its regions
+//------------------------------------------------------------------------------
+void MemoryRegions::note_module(const std::shared_ptr<IRegion> &region) {
+	if(is_module(region)) {
+		new_modules_.push_back(region);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add_modules
+// Desc: tells the symbol manager where the new modules are. Their symbols are
+//       only loaded once something inside them is looked up, so attaching to
+//       a process with hundreds of libraries costs nothing for the ones which
+//       are never looked at
+//------------------------------------------------------------------------------
+void MemoryRegions::add_modules() {
+
+	for(const std::shared_ptr<IRegion> &region : new_modules_) {
+		const int row = find_row(region->start());
+		if(row == -1) {
+			continue;
+		}
+
+		// the module is the run of regions mapping its file, together with
+		// the anonymous ones directly after them, where its .bss usually is
+		int first = row;
+		while(first > 0 && regions_[first - 1]->name() == region->name()) {
+			--first;
+		}
+
+		int last = row;
+		while(last + 1 < regions_.size()) {
+			const std::shared_ptr<IRegion> &next = regions_[last + 1];
+			if(next->name() != region->name() && !(next->name().isEmpty() && next->start() == regions_[last]->end())) {
+				break;
+			}
+			++last;
+		}
+
+		++modules_generation_;
+		edb::v1::symbol_manager().add_module(region->name(), region->start(), regions_[first]->start(), regions_[last]->end());
+	}
+
+	new_modules_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: note_removed
+// Desc: called for the rows [first, last) before they are removed
+//------------------------------------------------------------------------------
+void MemoryRegions::note_removed(int first, int last) {
+	for(int row = first; row < last; ++row) {
+		if(is_module(regions_[row])) {
+			++modules_generation_;
+			break;
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
 // Name: sync
-// Desc: reads a memory map file line by line
+// Desc: brings the list of regions up to date with the process' memory map.
+//       The new map is merged into the old one so that views only see the
+//       rows which actually changed and only new modules get their symbols
+//       loaded.
 //------------------------------------------------------------------------------
 void MemoryRegions::sync() {
 
-	beginResetModel();
+	EDB_TRACE_SCOPE("MemoryRegions::sync");
 
 	QList<std::shared_ptr<IRegion>> regions;
 
 	if(edb::v1::debugger_core) {
 		if(IProcess *process = edb::v1::debugger_core->process()) {
 			regions = process->regions();
-			Q_FOREACH(const std::shared_ptr<IRegion> &region, regions) {
-				// if the region has a name, is mapped starting
-				// at the beginning of the file, and is executable, sounds
-				// like a module mapping!
-				if(!region->name().isEmpty()) {
-					if(region->base() == 0) {
-						if(region->executable()) {
-							edb::v1::symbol_manager().load_symbol_file(region->name(), region->start());
-						}
-					}
+		}
+	}
+
+	auto by_start = [](const std::shared_ptr<IRegion> &lhs, const std::shared_ptr<IRegion> &rhs) {
+		return lhs->start() < rhs->start();
+	};
+
+	// the merge below relies on both lists being ordered by address
+	if(!std::is_sorted(regions.begin(), regions.end(), by_start)) {
+		std::sort(regions.begin(), regions.end(), by_start);
+	}
+
+	int row = 0;
+	int i   = 0;
+
+	while(i < regions.size()) {
+
+		const std::shared_ptr<IRegion> &region = regions[i];
+
+		if(row == regions_.size()) {
+			// everything left over is new
+			beginInsertRows(QModelIndex(), row, row + regions.size() - i - 1);
+			for(; i < regions.size(); ++i, ++row) {
+				regions_.insert(row, regions[i]);
+				note_module(regions[i]);
+			}
+			endInsertRows();
+			break;
+		}
+
+		const std::shared_ptr<IRegion> current = regions_[row];
+
+		if(current->start() < region->start()) {
+			// a run of regions which are no longer mapped
+			int last = row + 1;
+			while(last < regions_.size() && regions_[last]->start() < region->start()) {
+				++last;
+			}
+
+			beginRemoveRows(QModelIndex(), row, last - 1);
+			note_removed(row, last);
+			regions_.erase(regions_.begin() + row, regions_.begin() + last);
+			endRemoveRows();
+
+		} else if(region->start() < current->start()) {
+			// a run of newly mapped regions
+			int last = i + 1;
+			while(last < regions.size() && regions[last]->start() < current->start()) {
+				++last;
+			}
+
+			beginInsertRows(QModelIndex(), row, row + last - i - 1);
+			for(; i < last; ++i, ++row) {
+				regions_.insert(row, regions[i]);
+				note_module(regions[i]);
+			}
+			endInsertRows();
+
+		} else {
+			if(current != region && !current->equals(region)) {
+				// same place, but resized, reprotected or remapped
+				const bool same_mapping = current->name() == region->name() && current->base() == region->base();
+
+				regions_[row] = region;
+				Q_EMIT dataChanged(index(row, 0), index(row, columnCount() - 1));
+
+				if(!same_mapping && is_module(current)) {
+					++modules_generation_;
+				}
+
+				if(!same_mapping || !current->executable()) {
+					note_module(region);
 				}
 			}
+
+			++row;
+			++i;
 		}
 	}
 
+	// anything after the last region of the new map is gone
+	if(row < regions_.size()) {
+		beginRemoveRows(QModelIndex(), row, regions_.size() - 1);
+		note_removed(row, regions_.size());
+		regions_.erase(regions_.begin() + row, regions_.end());
+		endRemoveRows();
+	}
 
-	qSwap(regions_, regions);
-	endResetModel();
+	rebuild_index();
+	add_modules();
+}
+
+//------------------------------------------------------------------------------
+// Name: rebuild_index
+// Desc: regions_ is kept sorted by address and regions never overlap, so
+//       their end addresses are sorted too and can be binary searched
+//------------------------------------------------------------------------------
+void MemoryRegions::rebuild_index() {
+	region_ends_.clear();
+	region_ends_.reserve(regions_.size());
+	for(const std::shared_ptr<IRegion> &region: regions_) {
+		region_ends_.push_back(region->end());
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: find_row
+// Desc: returns the row of the region containing <address>, or -1
+//------------------------------------------------------------------------------
+int MemoryRegions::find_row(edb::address_t address) const {
+
+	// the first region which ends after the address is the only candidate
+	const auto it = std::upper_bound(region_ends_.begin(), region_ends_.end(), address);
+	if(it == region_ends_.end()) {
+		return -1;
+	}
+
+	const int row = it - region_ends_.begin();
+	if(!regions_[row]->contains(address)) {
+		return -1;
+	}
+
+	return row;
 }
 
 //------------------------------------------------------------------------------
@@ -85,30 +296,143 @@ void MemoryRegions::sync() {
 // Desc:
 //------------------------------------------------------------------------------
 std::shared_ptr<IRegion> MemoryRegions::find_region(edb::address_t address) const {
+	const int row = find_row(address);
+	if(row == -1) {
+		return nullptr;
+	}
+
+	return regions_[row];
+}
+
+//------------------------------------------------------------------------------
+// Name: find_regions
+// Desc: looks up the region of many addresses at once, the result has one
+//       entry (possibly null) for each address, in the same order
+//------------------------------------------------------------------------------
+QVector<std::shared_ptr<IRegion>> MemoryRegions::find_regions(const QVector<edb::address_t> &addresses) const {
+	QVector<std::shared_ptr<IRegion>> results;
+	results.reserve(addresses.size());
+
+	int last = -1;
+	for(const edb::address_t address: addresses) {
+		// neighbouring addresses tend to be in the same region
+		if(last == -1 || !regions_[last]->contains(address)) {
+			last = find_row(address);
+		}
+
+		results.push_back(last == -1 ? nullptr : regions_[last]);
+	}
+
+	return results;
+}
 
-	for(const std::shared_ptr<IRegion> &i: regions_) {
-		if(i->contains(address)) {
-			return i;
+//------------------------------------------------------------------------------
+// Name: merge_usage
+// Desc: takes the usage of some of the regions, as it comes in from a reader
+//       (see IProcess::usage_reader). Only their rows are updated, so a view
+//       fills in a batch at a time. Regions keep what they were last given
+//       until they are given something new
+//------------------------------------------------------------------------------
+void MemoryRegions::merge_usage(const QVector<RegionUsage> &usage) {
+
+	int first = -1;
+	int last  = -1;
+
+	for(const RegionUsage &entry : usage) {
+		usage_.insert(entry.start.toUint(), entry);
+
+		// the batches are in address order, so the rows come in runs
+		const int row = find_row(entry.start);
+		if(row == -1) {
+			continue;
+		}
+
+		if(row != last + 1 && first != -1) {
+			Q_EMIT dataChanged(index(first, FirstUsageColumn), index(last, columnCount() - 1));
+			first = -1;
+		}
+
+		if(first == -1) {
+			first = row;
 		}
+		last = row;
+	}
+
+	if(first != -1) {
+		Q_EMIT dataChanged(index(first, FirstUsageColumn), index(last, columnCount() - 1));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: find_usage
+// Desc: returns false if nothing is known about the region's usage yet
+//------------------------------------------------------------------------------
+bool MemoryRegions::find_usage(const std::shared_ptr<IRegion> &region, RegionUsage *usage) const {
+	Q_ASSERT(usage);
+
+	auto it = usage_.find(region->start().toUint());
+	if(it == usage_.end()) {
+		return false;
 	}
-	return nullptr;
+
+	*usage = it.value();
+	return true;
 }
 
 //------------------------------------------------------------------------------
 // Name: data
-// Desc:
+// Desc: the text is only made for the rows which are shown, Qt::UserRole has
+//       the raw values for sorting and filtering on, which with tens of
+//       thousands of regions would otherwise format every row
 //------------------------------------------------------------------------------
 QVariant MemoryRegions::data(const QModelIndex &index, int role) const {
 
-	if(index.isValid() && role == Qt::DisplayRole) {
+	if(index.isValid()) {
 
 		const std::shared_ptr<IRegion> &region = regions_[index.row()];
 
-		switch(index.column()) {
-		case 0: return edb::v1::format_pointer(region->start());
-		case 1: return edb::v1::format_pointer(region->end());
-		case 2: return QString("%1%2%3").arg(region->readable() ? 'r' : '-').arg(region->writable() ? 'w' : '-').arg(region->executable() ? 'x' : '-');
-		case 3: return region->name();
+		if(index.column() >= FirstUsageColumn) {
+			if(role == Qt::TextAlignmentRole) {
+				return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+			}
+
+			if(role != Qt::DisplayRole && role != Qt::UserRole) {
+				return QVariant();
+			}
+
+			RegionUsage usage;
+			if(!find_usage(region, &usage)) {
+				return QVariant();
+			}
+
+			quint64 size = 0;
+			switch(index.column()) {
+			case 4: size = usage.resident;     break;
+			case 5: size = usage.proportional; break;
+			case 6: size = usage.swapped;      break;
+			case 7: size = usage.dirty;        break;
+			}
+
+			if(role == Qt::UserRole) {
+				return static_cast<qulonglong>(size);
+			}
+			return format_size(size);
+		}
+
+		if(role == Qt::DisplayRole) {
+			switch(index.column()) {
+			case 0: return edb::v1::format_pointer(region->start());
+			case 1: return edb::v1::format_pointer(region->end());
+			case 2: return QString("%1%2%3").arg(region->readable() ? 'r' : '-').arg(region->writable() ? 'w' : '-').arg(region->executable() ? 'x' : '-');
+			case 3: return region->name();
+			}
+		} else if(role == Qt::UserRole) {
+			switch(index.column()) {
+			case 0: return static_cast<qulonglong>(region->start().toUint());
+			case 1: return static_cast<qulonglong>(region->end().toUint());
+			case 2: return (region->readable() ? 4 : 0) | (region->writable() ? 2 : 0) | (region->executable() ? 1 : 0);
+			case 3: return region->name();
+			}
 		}
 	}
 
@@ -153,7 +477,7 @@ int MemoryRegions::rowCount(const QModelIndex &parent) const {
 //------------------------------------------------------------------------------
 int MemoryRegions::columnCount(const QModelIndex &parent) const {
 	Q_UNUSED(parent);
-	return 4;
+	return 8;
 }
 
 //------------------------------------------------------------------------------
@@ -167,6 +491,10 @@ QVariant MemoryRegions::headerData(int section, Qt::Orientation orientation, int
 		case 1: return tr("End Address");
 		case 2: return tr("Permissions");
 		case 3: return tr("Name");
+		case 4: return tr("Resident");
+		case 5: return tr("Proportional");
+		case 6: return tr("Swapped");
+		case 7: return tr("Dirty");
 		}
 	}
 
@@ -0,0 +1,113 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PatchLedger.h"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// Name: record
+// Desc: adds the patch of <new_bytes> at <address>, which replaced
+//       <orig_bytes>, merging it with the ranges it overlaps or touches
+//------------------------------------------------------------------------------
+void PatchLedger::record(edb::address_t address, const QByteArray &orig_bytes, const QByteArray &new_bytes) {
+
+	Q_ASSERT(orig_bytes.size() == new_bytes.size());
+
+	if(new_bytes.isEmpty()) {
+		return;
+	}
+
+	edb::address_t first = address;
+	edb::address_t last  = address + new_bytes.size();
+
+	// the one range which starts below <address> may still reach it
+	auto it = patches_.lowerBound(address);
+	if(it != patches_.begin()) {
+		auto previous = it - 1;
+		if(previous.key() + previous.value().new_bytes.size() >= address) {
+			it = previous;
+		}
+	}
+
+	QList<Patch> merged;
+	while(it != patches_.end() && it.key() <= last) {
+		merged.push_back(it.value());
+		first = std::min(first, it.key());
+		last  = std::max(last, it.key() + it.value().new_bytes.size());
+		it    = patches_.erase(it);
+	}
+
+	Patch patch;
+	patch.address = first;
+
+	if(merged.isEmpty()) {
+		patch.orig_bytes = orig_bytes;
+		patch.new_bytes  = new_bytes;
+	} else {
+		const int size   = static_cast<int>(last.toUint() - first.toUint());
+		const int offset = static_cast<int>(address.toUint() - first.toUint());
+
+		patch.orig_bytes = QByteArray(size, '\0');
+		patch.new_bytes  = QByteArray(size, '\0');
+
+		std::memcpy(patch.orig_bytes.data() + offset, orig_bytes.constData(), orig_bytes.size());
+		for(const Patch &older : merged) {
+			const int at = static_cast<int>(older.address.toUint() - first.toUint());
+			std::memcpy(patch.orig_bytes.data() + at, older.orig_bytes.constData(), older.orig_bytes.size());
+			std::memcpy(patch.new_bytes.data() + at, older.new_bytes.constData(), older.new_bytes.size());
+		}
+		std::memcpy(patch.new_bytes.data() + offset, new_bytes.constData(), new_bytes.size());
+	}
+
+	patches_.insert(first, patch);
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void PatchLedger::clear() {
+	patches_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: patches
+// Desc: the ranges which have a byte in [address, address + size), in address
+//       order
+//------------------------------------------------------------------------------
+QList<Patch> PatchLedger::patches(edb::address_t address, std::size_t size) const {
+
+	QList<Patch> results;
+
+	auto it = patches_.lowerBound(address);
+	if(it != patches_.begin()) {
+		auto previous = it - 1;
+		if(previous.key() + previous.value().new_bytes.size() > address) {
+			it = previous;
+		}
+	}
+
+	const edb::address_t end = address + size;
+	for(; it != patches_.end() && it.key() < end; ++it) {
+		results.push_back(it.value());
+	}
+
+	return results;
+}
@@ -0,0 +1,186 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PendingBreakpoints.h"
+#include "ISymbolManager.h"
+#include "Symbol.h"
+#include "edb.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMultiHash>
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: parse_offset
+// Desc:
+//------------------------------------------------------------------------------
+bool parse_offset(const QString &text, edb::address_t *offset) {
+	bool ok;
+	const quint64 value = text.trimmed().toULongLong(&ok, 0);
+	if(ok) {
+		*offset = edb::address_t::fromZeroExtended(value);
+	}
+	return ok;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: parse
+// Desc: module names may have a '+' in them, libstdc++ does, so only what is
+//       after the last one can be the offset
+//------------------------------------------------------------------------------
+bool PendingBreakpoints::parse(const QString &text, Breakpoint *breakpoint) {
+
+	Q_ASSERT(breakpoint);
+
+	const QString trimmed = text.trimmed();
+	const int bang        = trimmed.indexOf(QLatin1Char('!'));
+	const int plus        = trimmed.lastIndexOf(QLatin1Char('+'));
+
+	Breakpoint result;
+	result.offset = 0;
+
+	if(bang != -1) {
+		result.module = trimmed.left(bang).trimmed();
+		result.symbol = trimmed.mid(bang + 1).trimmed();
+
+		if(plus > bang && parse_offset(trimmed.mid(plus + 1), &result.offset)) {
+			result.symbol = trimmed.mid(bang + 1, plus - bang - 1).trimmed();
+		}
+
+		if(result.symbol.isEmpty()) {
+			return false;
+		}
+	} else {
+		if(plus == -1 || !parse_offset(trimmed.mid(plus + 1), &result.offset)) {
+			return false;
+		}
+		result.module = trimmed.left(plus).trimmed();
+	}
+
+	if(result.module.isEmpty()) {
+		return false;
+	}
+
+	*breakpoint = result;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: to_string
+// Desc: the form which parse() takes
+//------------------------------------------------------------------------------
+QString PendingBreakpoints::to_string(const Breakpoint &breakpoint) {
+
+	QString text = breakpoint.module;
+	if(!breakpoint.symbol.isEmpty()) {
+		text += QLatin1Char('!') + breakpoint.symbol;
+	}
+
+	if(breakpoint.symbol.isEmpty() || breakpoint.offset != 0) {
+		text += QString("+0x%1").arg(breakpoint.offset.toUint(), 0, 16);
+	}
+	return text;
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: returns false if there already is the same one
+//------------------------------------------------------------------------------
+bool PendingBreakpoints::add(const Breakpoint &breakpoint) {
+
+	for(const Breakpoint &existing : breakpoints_) {
+		if(existing.module == breakpoint.module && existing.symbol == breakpoint.symbol && existing.offset == breakpoint.offset) {
+			return false;
+		}
+	}
+
+	breakpoints_.push_back(breakpoint);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove
+// Desc:
+//------------------------------------------------------------------------------
+bool PendingBreakpoints::remove(const Breakpoint &breakpoint) {
+
+	for(auto it = breakpoints_.begin(); it != breakpoints_.end(); ++it) {
+		if(it->module == breakpoint.module && it->symbol == breakpoint.symbol && it->offset == breakpoint.offset) {
+			breakpoints_.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: resolve
+// Desc: the breakpoints are grouped by module first, so each new module costs
+//       one lookup whether or not any of them are in it, and its symbols are
+//       loaded at most once, however many of them name a symbol
+//------------------------------------------------------------------------------
+QVector<edb::address_t> PendingBreakpoints::resolve(const QList<Module> &modules) const {
+
+	QVector<edb::address_t> addresses;
+	if(breakpoints_.isEmpty()) {
+		return addresses;
+	}
+
+	QMultiHash<QString, int> by_module;
+	for(int i = 0; i < breakpoints_.size(); ++i) {
+		by_module.insert(breakpoints_[i].module, i);
+	}
+
+	for(const Module &module : modules) {
+		const QString name = QFileInfo(module.name).fileName();
+		if(name.isEmpty() || !by_module.contains(name)) {
+			continue;
+		}
+
+		bool symbols_loaded = false;
+		for(const int n : by_module.values(name)) {
+			const Breakpoint &breakpoint = breakpoints_[n];
+
+			if(breakpoint.symbol.isEmpty()) {
+				addresses.push_back(module.base_address + breakpoint.offset.toUint());
+				continue;
+			}
+
+			if(!symbols_loaded) {
+				edb::v1::symbol_manager().load_symbol_file(module.name, module.base_address);
+				symbols_loaded = true;
+			}
+
+			// a lookup which finds nothing in the module may fall back on a
+			// symbol of the same name in another one
+			const QString prefix = name + QLatin1Char('!');
+			const std::shared_ptr<Symbol> symbol = edb::v1::symbol_manager().find(prefix + breakpoint.symbol);
+			if(symbol && symbol->name.startsWith(prefix)) {
+				addresses.push_back(symbol->address + breakpoint.offset.toUint());
+			} else {
+				qDebug() << "No symbol" << breakpoint.symbol << "in" << module.name << "for a pending breakpoint";
+			}
+		}
+	}
+
+	return addresses;
+}
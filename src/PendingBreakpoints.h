@@ -0,0 +1,59 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PENDING_BREAKPOINTS_20171014_H_
+#define PENDING_BREAKPOINTS_20171014_H_
+
+#include "Module.h"
+#include "Types.h"
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Breakpoints on code in modules which may not be loaded yet, by the file name
+// of the module and a symbol in it or an offset from where it is loaded. They
+// are looked up whenever the linker reports new modules, those of all the
+// modules of one library event together
+class PendingBreakpoints {
+public:
+	struct Breakpoint {
+		QString        module; // the file name, without the directory
+		QString        symbol; // empty if it is only an offset from the base
+		edb::address_t offset;
+	};
+
+public:
+	// "module!symbol", "module!symbol+offset" or "module+offset"
+	static bool parse(const QString &text, Breakpoint *breakpoint);
+	static QString to_string(const Breakpoint &breakpoint);
+
+public:
+	bool add(const Breakpoint &breakpoint);
+	bool remove(const Breakpoint &breakpoint);
+	QList<Breakpoint> breakpoints() const { return breakpoints_; }
+	bool isEmpty() const                  { return breakpoints_.isEmpty(); }
+
+	// where the pending breakpoints are in <modules>, which were just loaded.
+	// The symbols of a module are only loaded if one of them needs it
+	QVector<edb::address_t> resolve(const QList<Module> &modules) const;
+
+private:
+	QList<Breakpoint> breakpoints_;
+};
+
+#endif
@@ -18,8 +18,34 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "PluginModel.h"
 
+#include <QBrush>
 #include <QtAlgorithms>
 
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: mode_name
+// Desc:
+//------------------------------------------------------------------------------
+QString mode_name(IPlugin::UpdateMode mode) {
+	switch(mode) {
+	case IPlugin::UPDATE_IMMEDIATE:  return PluginModel::tr("immediate");
+	case IPlugin::UPDATE_DEFERRED:   return PluginModel::tr("deferred");
+	case IPlugin::UPDATE_BACKGROUND: return PluginModel::tr("background");
+	default:                         return QString();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: to_ms
+// Desc:
+//------------------------------------------------------------------------------
+double to_ms(qint64 ns) {
+	return static_cast<double>(ns) / 1e6;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: PluginModel
 // Desc:
@@ -81,6 +107,35 @@ QVariant PluginModel::data(const QModelIndex &index, int role) const {
 				return item.author;
 			case 3:
 				return item.url;
+			case 4:
+				return tr("%1 ms").arg(item.startup_time);
+			case 5:
+				if(item.update_timing.calls == 0) {
+					return QVariant();
+				}
+				return tr("%1 ms (%2)").arg(to_ms(item.update_timing.mean_ns()), 0, 'f', 2).arg(mode_name(item.update_timing.mode));
+			}
+		} else if(role == Qt::UserRole) {
+			// for sorting by the numbers
+			switch(index.column()) {
+			case 4:
+				return item.startup_time;
+			case 5:
+				return item.update_timing.mean_ns();
+			default:
+				return data(index, Qt::DisplayRole);
+			}
+		} else if(role == Qt::ForegroundRole) {
+			if(index.column() == 5 && item.update_timing.over_budget()) {
+				return QBrush(Qt::red);
+			}
+		} else if(role == Qt::ToolTipRole) {
+			if(index.column() == 5 && item.update_timing.calls != 0) {
+				QString tip = tr("%1 updates, the slowest took %2 ms").arg(item.update_timing.calls).arg(to_ms(item.update_timing.max_ns), 0, 'f', 2);
+				if(item.update_timing.over_budget()) {
+					tip += tr("\nOver the budget of %1 ms, this plugin holds up every stop").arg(to_ms(PluginUpdates::BudgetNs), 0, 'f', 0);
+				}
+				return tip;
 			}
 		}
 	}
@@ -104,6 +159,10 @@ QVariant PluginModel::headerData(int section, Qt::Orientation orientation, int r
 			return tr("Author");
 		case 3:
 			return tr("Website");
+		case 4:
+			return tr("Startup Time");
+		case 5:
+			return tr("Stop Update Time");
 		}
 	}
 
@@ -116,7 +175,7 @@ QVariant PluginModel::headerData(int section, Qt::Orientation orientation, int r
 //------------------------------------------------------------------------------
 int PluginModel::columnCount(const QModelIndex &parent) const {
 	Q_UNUSED(parent);
-	return 4;
+	return 6;
 }
 
 //------------------------------------------------------------------------------
@@ -132,11 +191,11 @@ int PluginModel::rowCount(const QModelIndex &parent) const {
 // Name: addPlugin
 // Desc:
 //------------------------------------------------------------------------------
-void PluginModel::addPlugin(const QString &filename, const QString &plugin, const QString &author, const QString &url) {
+void PluginModel::addPlugin(const QString &filename, const QString &plugin, const QString &author, const QString &url, qint64 startup_time, const PluginUpdates::Timing &update_timing) {
 	beginInsertRows(QModelIndex(), rowCount(), rowCount());
 
 	const Item item = {
-		filename, plugin, author, url
+		filename, plugin, author, url, startup_time, update_timing
 	};
 	items_.push_back(item);
 	endInsertRows();
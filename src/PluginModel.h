@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef PLUGIN_MODEL_H_
 #define PLUGIN_MODEL_H_
 
+#include "PluginUpdates.h"
 #include <QAbstractItemModel>
 #include <QVector>
 #include <QString>
@@ -32,6 +33,8 @@ public:
 		QString plugin;
 		QString author;
 		QString url;
+		qint64  startup_time; // in ms, loading and setting it up
+		PluginUpdates::Timing update_timing; // of its updates at each stop
 	};
 
 public:
@@ -47,7 +50,7 @@ public:
 	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
 
 public:
-	void addPlugin(const QString &filename, const QString &plugin, const QString &author, const QString &url);
+	void addPlugin(const QString &filename, const QString &plugin, const QString &author, const QString &url, qint64 startup_time, const PluginUpdates::Timing &update_timing);
 	void clear();
 
 private:
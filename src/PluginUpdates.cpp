@@ -0,0 +1,187 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PluginUpdates.h"
+#include "Instrumentation.h"
+#include "StopSnapshot.h"
+#include "edb.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTimer>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Name: over_budget
+// Desc: only an update on the GUI thread holds anything up
+//------------------------------------------------------------------------------
+bool PluginUpdates::Timing::over_budget() const {
+	return mode != IPlugin::UPDATE_BACKGROUND && mean_ns() > BudgetNs;
+}
+
+//------------------------------------------------------------------------------
+// Name: instance
+// Desc:
+//------------------------------------------------------------------------------
+PluginUpdates &PluginUpdates::instance() {
+	static PluginUpdates inst;
+	return inst;
+}
+
+//------------------------------------------------------------------------------
+// Name: PluginUpdates
+// Desc:
+//------------------------------------------------------------------------------
+PluginUpdates::PluginUpdates() : QObject(nullptr) {
+}
+
+//------------------------------------------------------------------------------
+// Name: dispatch
+// Desc: the snapshot is only taken if some plugin wants it, and then shared
+//       by all of them
+//------------------------------------------------------------------------------
+void PluginUpdates::dispatch() {
+
+	const QMap<QString, QObject *> &plugins = edb::v1::plugin_list();
+
+	std::shared_ptr<const StopSnapshot> snapshot;
+	bool deferred = false;
+
+	for(auto it = plugins.begin(); it != plugins.end(); ++it) {
+		IPlugin *const plugin = qobject_cast<IPlugin *>(it.value());
+		if(!plugin) {
+			continue;
+		}
+
+		const IPlugin::UpdateMode mode = plugin->update_mode();
+		if(mode == IPlugin::UPDATE_NONE) {
+			continue;
+		}
+
+		if(!snapshot) {
+			snapshot = StopSnapshot::capture();
+			if(!snapshot) {
+				return;
+			}
+		}
+
+		const QString filename = it.key();
+
+		switch(mode) {
+		case IPlugin::UPDATE_IMMEDIATE:
+			call(filename, mode, trace_name(filename), plugin, snapshot);
+			break;
+		case IPlugin::UPDATE_DEFERRED:
+			deferred = true;
+			break;
+		case IPlugin::UPDATE_BACKGROUND:
+			{
+				// one still busy with an earlier stop misses this one
+				auto running = background_.find(filename);
+				if(running != background_.end() && !running->finished()) {
+					break;
+				}
+
+				const char *const trace = trace_name(filename);
+				background_[filename] = edb::v1::task_scheduler().start("PluginUpdates::background", TaskScheduler::Interactive, QString(), [this, filename, mode, trace, plugin, snapshot](const TaskToken &) {
+					call(filename, mode, trace, plugin, snapshot);
+				});
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// stops which come faster than the event loop gets around to them only
+	// update once, with the newest one
+	if(deferred) {
+		const bool scheduled = deferred_snapshot_ != nullptr;
+		deferred_snapshot_ = snapshot;
+		if(!scheduled) {
+			QTimer::singleShot(0, this, SLOT(run_deferred()));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: run_deferred
+// Desc:
+//------------------------------------------------------------------------------
+void PluginUpdates::run_deferred() {
+
+	std::shared_ptr<const StopSnapshot> snapshot;
+	snapshot.swap(deferred_snapshot_);
+	if(!snapshot) {
+		return;
+	}
+
+	const QMap<QString, QObject *> &plugins = edb::v1::plugin_list();
+	for(auto it = plugins.begin(); it != plugins.end(); ++it) {
+		IPlugin *const plugin = qobject_cast<IPlugin *>(it.value());
+		if(plugin && plugin->update_mode() == IPlugin::UPDATE_DEFERRED) {
+			call(it.key(), IPlugin::UPDATE_DEFERRED, trace_name(it.key()), plugin, snapshot);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: call
+// Desc: may be called on any thread
+//------------------------------------------------------------------------------
+void PluginUpdates::call(const QString &filename, IPlugin::UpdateMode mode, const char *trace, IPlugin *plugin, const std::shared_ptr<const StopSnapshot> &snapshot) {
+
+	const qint64 start = Instrumentation::now();
+	plugin->stop_updated(snapshot);
+	const qint64 end = Instrumentation::now();
+
+	if(Instrumentation::enabled()) {
+		Instrumentation::record(trace, start, end);
+	}
+
+	QMutexLocker locker(&lock_);
+	Timing &timing = timings_[filename];
+	timing.mode      = mode;
+	timing.calls    += 1;
+	timing.total_ns += end - start;
+	timing.max_ns    = std::max(timing.max_ns, end - start);
+}
+
+//------------------------------------------------------------------------------
+// Name: trace_name
+// Desc: the instrumentation only keeps the pointer to a name, so these are
+//       never freed. The hash may move the byte arrays, but not their data
+//------------------------------------------------------------------------------
+const char *PluginUpdates::trace_name(const QString &filename) {
+
+	auto it = trace_names_.find(filename);
+	if(it == trace_names_.end()) {
+		it = trace_names_.insert(filename, QFileInfo(filename).fileName().toUtf8() + "::stop_updated");
+	}
+	return it->constData();
+}
+
+//------------------------------------------------------------------------------
+// Name: timing
+// Desc:
+//------------------------------------------------------------------------------
+PluginUpdates::Timing PluginUpdates::timing(const QString &filename) const {
+	QMutexLocker locker(&lock_);
+	return timings_.value(filename);
+}
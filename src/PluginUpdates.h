@@ -0,0 +1,81 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLUGIN_UPDATES_20171014_H_
+#define PLUGIN_UPDATES_20171014_H_
+
+#include "IPlugin.h"
+#include "TaskScheduler.h"
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class StopSnapshot;
+
+// Calls IPlugin::stop_updated of the plugins which have an update mode, each
+// in the way it asks for, and times every call. The timings are kept by the
+// file name of the plugin, for the plugins dialog, and recorded with the
+// instrumentation when that is on
+class PluginUpdates : public QObject {
+	Q_OBJECT
+
+public:
+	// an update on the GUI thread taking longer than this on average holds up
+	// every stop noticeably
+	static constexpr qint64 BudgetNs = 20 * 1000 * 1000;
+
+	struct Timing {
+		IPlugin::UpdateMode mode     = IPlugin::UPDATE_NONE;
+		quint64             calls    = 0;
+		qint64              total_ns = 0;
+		qint64              max_ns   = 0;
+
+		qint64 mean_ns() const { return calls ? static_cast<qint64>(total_ns / static_cast<qint64>(calls)) : 0; }
+		bool over_budget() const;
+	};
+
+public:
+	static PluginUpdates &instance();
+
+private:
+	PluginUpdates();
+
+public:
+	// to be called after gui_updated() was emitted for a stop
+	void dispatch();
+	Timing timing(const QString &filename) const;
+
+private Q_SLOTS:
+	void run_deferred();
+
+private:
+	void call(const QString &filename, IPlugin::UpdateMode mode, const char *trace, IPlugin *plugin, const std::shared_ptr<const StopSnapshot> &snapshot);
+	const char *trace_name(const QString &filename);
+
+private:
+	mutable QMutex                      lock_;    // guards timings_, background updates finish on other threads
+	QHash<QString, Timing>              timings_;
+	QHash<QString, QByteArray>          trace_names_;
+	QHash<QString, TaskToken>           background_;
+	std::shared_ptr<const StopSnapshot> deferred_snapshot_; // of the newest stop, while a deferred update is due
+};
+
+#endif
@@ -105,8 +105,54 @@ void ProcessModel::addProcess(const std::shared_ptr<IProcess> &process) {
 	endInsertRows();
 }
 
+void ProcessModel::setProcesses(const QMap<edb::pid_t, ProcessSummary> &processes) {
+
+	// from one refresh to the next the processes rarely change, only the list
+	// has to be rebuilt when they do
+	bool same = (processes.size() == items_.size());
+	if(same) {
+		auto it = processes.begin();
+		for(const Item &item : items_) {
+			if(item.pid != it.key()) {
+				same = false;
+				break;
+			}
+			++it;
+		}
+	}
+
+	if(!same) {
+		beginResetModel();
+		items_ = processes.values().toVector();
+		endResetModel();
+		return;
+	}
+
+	int first = -1;
+	int last  = -1;
+	auto it = processes.begin();
+	for(int row = 0; row < items_.size(); ++row, ++it) {
+		Item &item = items_[row];
+		if(item.uid != it->uid || item.user != it->user || item.name != it->name) {
+			item = *it;
+			if(first == -1) {
+				first = row;
+			}
+			last = row;
+		}
+	}
+
+	if(first != -1) {
+		Q_EMIT dataChanged(index(first, 0), index(last, columnCount() - 1));
+	}
+}
+
 void ProcessModel::clear() {
-	beginRemoveRows(QModelIndex(), 0, rowCount());
+	if(items_.isEmpty()) {
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
 	items_.clear();
 	endRemoveRows();
 }
@@ -20,8 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PROCESS_MODEL_H_
 
 #include "OSTypes.h"
+#include "ProcessSummary.h"
 
 #include <QAbstractItemModel>
+#include <QMap>
 #include <QString>
 #include <QVector>
 
@@ -33,12 +35,7 @@ class ProcessModel : public QAbstractItemModel {
 	Q_OBJECT
 
 public:
-	struct Item {
-		edb::pid_t pid;
-		edb::uid_t uid;
-		QString    user;
-		QString    name;
-	};
+	typedef ProcessSummary Item;
 
 public:
 	ProcessModel(QObject *parent = 0);
@@ -54,6 +51,7 @@ public:
 
 public:
 	void addProcess(const std::shared_ptr<IProcess> &process);
+	void setProcesses(const QMap<edb::pid_t, ProcessSummary> &processes);
 	void clear();
 
 private:
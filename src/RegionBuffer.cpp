@@ -19,14 +19,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "RegionBuffer.h"
 #include "IDebugger.h"
 #include "IProcess.h"
+#include "WriteRequest.h"
 #include "edb.h"
 
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
 //------------------------------------------------------------------------------
 // Name: RegionBuffer
 // Desc:
 //------------------------------------------------------------------------------
 RegionBuffer::RegionBuffer(const std::shared_ptr<IRegion> &region) : QIODevice(), region_(region) {
-	setOpenMode(QIODevice::ReadOnly);
+	// unbuffered, or QIODevice reads ahead far more than the rows of a view,
+	// readData keeps a window of its own
+	setOpenMode(QIODevice::ReadWrite | QIODevice::Unbuffered);
 }
 
 //------------------------------------------------------------------------------
@@ -34,7 +42,7 @@ RegionBuffer::RegionBuffer(const std::shared_ptr<IRegion> &region) : QIODevice()
 // Desc:
 //------------------------------------------------------------------------------
 RegionBuffer::RegionBuffer(const std::shared_ptr<IRegion> &region, QObject *parent) : QIODevice(parent), region_(region) {
-	setOpenMode(QIODevice::ReadOnly);
+	setOpenMode(QIODevice::ReadWrite | QIODevice::Unbuffered);
 }
 
 //------------------------------------------------------------------------------
@@ -43,12 +51,14 @@ RegionBuffer::RegionBuffer(const std::shared_ptr<IRegion> &region, QObject *pare
 //------------------------------------------------------------------------------
 void RegionBuffer::set_region(const std::shared_ptr<IRegion> &region) {
 	region_ = region;
+	cache_.clear();
 	reset();
 }
 
 //------------------------------------------------------------------------------
 // Name: readData
-// Desc:
+// Desc: reads which fit in a window are copied out of the last window read,
+//       for as long as the memory of the process hasn't changed since
 //------------------------------------------------------------------------------
 qint64 RegionBuffer::readData(char *data, qint64 maxSize) {
 
@@ -57,15 +67,44 @@ qint64 RegionBuffer::readData(char *data, qint64 maxSize) {
 			const edb::address_t start = region_->start() + pos();
 			const edb::address_t end   = region_->start() + region_->size();
 
-		if(start + maxSize > end) {
-					maxSize = end - start;
+			if(start + maxSize > end) {
+				maxSize = end - start;
 			}
 
-			if(maxSize == 0) {
+			if(maxSize <= 0) {
 				return 0;
 			}
 
-			if(process->read_bytes(start, data, maxSize)) {
+			const auto size     = static_cast<std::size_t>(maxSize);
+			const quint64 epoch = process->memory_epoch();
+
+			if(cache_process_ != process || cache_epoch_ != epoch) {
+				cache_.clear();
+			}
+
+			if(cache_.isEmpty() || start < cache_start_ || start + size > cache_start_ + cache_.size()) {
+
+				const edb::address_t page_size = edb::v1::debugger_core->page_size();
+				const edb::address_t window    = std::max(region_->start(), start - (start % page_size));
+
+				if((start - window) + size <= ReadAhead) {
+					const auto window_size = static_cast<std::size_t>(std::min<edb::address_t>(ReadAhead, end - window).toUint());
+
+					cache_.resize(static_cast<int>(window_size));
+					cache_.resize(static_cast<int>(process->read_bytes(window, cache_.data(), window_size)));
+					cache_start_   = window;
+					cache_process_ = process;
+					cache_epoch_   = epoch;
+				}
+			}
+
+			if(!cache_.isEmpty() && start >= cache_start_ && start + size <= cache_start_ + cache_.size()) {
+				std::memcpy(data, cache_.constData() + (start - cache_start_).toUint(), size);
+				return maxSize;
+			}
+
+			// too big for the window, or it ran into something unreadable
+			if(process->read_bytes(start, data, size)) {
 				return maxSize;
 			} else {
 				return -1;
@@ -74,13 +113,55 @@ qint64 RegionBuffer::readData(char *data, qint64 maxSize) {
 	}
 
 	return -1;
-
 }
 
 //------------------------------------------------------------------------------
 // Name: writeData
-// Desc:
+// Desc: writes all of <data> with a single write_many, one request per page so
+//       that a page which can't be written only stops the write there
 //------------------------------------------------------------------------------
-qint64 RegionBuffer::writeData(const char*, qint64) {
+qint64 RegionBuffer::writeData(const char *data, qint64 maxSize) {
+
+	if(region_) {
+		if(IProcess *process = edb::v1::debugger_core->process()) {
+			const edb::address_t start = region_->start() + pos();
+			const edb::address_t end   = region_->start() + region_->size();
+
+			if(start + maxSize > end) {
+				maxSize = end - start;
+			}
+
+			if(maxSize <= 0) {
+				return 0;
+			}
+
+			const edb::address_t page_size = edb::v1::debugger_core->page_size();
+			const auto size                = static_cast<std::size_t>(maxSize);
+
+			QVector<WriteRequest> requests;
+			for(std::size_t offset = 0; offset < size;) {
+				const edb::address_t address = start + offset;
+				const auto n = std::min(size - offset, static_cast<std::size_t>((page_size - address % page_size).toUint()));
+				requests.push_back(WriteRequest{address, data + offset, n});
+				offset += n;
+			}
+
+			const QVector<std::size_t> written = process->write_many(requests);
+
+			// the window may hold what was just overwritten
+			cache_.clear();
+
+			qint64 total = 0;
+			for(int i = 0; i < requests.size(); ++i) {
+				total += written[i];
+				if(written[i] != requests[i].size) {
+					break;
+				}
+			}
+
+			return total != 0 ? total : -1;
+		}
+	}
+
 	return -1;
 }
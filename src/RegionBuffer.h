@@ -21,10 +21,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "IRegion.h"
 
+#include <QByteArray>
 #include <QIODevice>
 
 #include <memory>
 
+class IProcess;
 class IRegion;
 
 class RegionBuffer : public QIODevice {
@@ -38,12 +40,21 @@ public:
 
 public:
 	virtual qint64 readData(char * data, qint64 maxSize);
-	virtual qint64 writeData(const char*, qint64);
+	virtual qint64 writeData(const char *data, qint64 maxSize);
 	virtual qint64 size() const       { return region_ ? region_->size().toUint() : 0; }
 	virtual bool isSequential() const { return false; }
 
+private:
+	// small reads are served from a page aligned window of this size, so that
+	// scrolling a view costs one read per window instead of one per row
+	static constexpr std::size_t ReadAhead = 0x4000;
+
 private:
 	std::shared_ptr<IRegion> region_;
+	QByteArray               cache_;         // the window, short where it stopped being readable
+	edb::address_t           cache_start_   = 0;
+	const IProcess          *cache_process_ = nullptr;
+	quint64                  cache_epoch_   = 0; // IProcess::memory_epoch when the window was read
 };
 
 #endif
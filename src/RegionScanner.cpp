@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RegionScanner.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "edb.h"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// Name: RegionScanner
+// Desc: constructor
+//------------------------------------------------------------------------------
+RegionScanner::RegionScanner(const std::shared_ptr<IRegion> &region, std::size_t overlap, std::size_t window_size) : RegionScanner(region->start(), region->end(), overlap, window_size) {
+}
+
+//------------------------------------------------------------------------------
+// Name: RegionScanner
+// Desc: constructor
+//------------------------------------------------------------------------------
+RegionScanner::RegionScanner(edb::address_t start, edb::address_t end, std::size_t overlap, std::size_t window_size) :
+	start_(start), end_(end), position_(start), address_(start), overlap_(overlap), window_size_(window_size), size_(0), cancelled_(false) {
+
+	Q_ASSERT(window_size_ != 0);
+
+	// keep the windows page aligned, it makes the reads cheaper
+	if(edb::v1::debugger_core) {
+		const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+		if(window_size_ > page_size) {
+			window_size_ -= window_size_ % page_size;
+		}
+	}
+
+	buffer_.resize(overlap_ + window_size_);
+}
+
+//------------------------------------------------------------------------------
+// Name: next
+// Desc: reads the next window of the region, returns false once there is
+//       nothing left to read or the scan was cancelled
+//------------------------------------------------------------------------------
+bool RegionScanner::next() {
+
+	if(cancelled_ || !edb::v1::debugger_core) {
+		return false;
+	}
+
+	IProcess *process = edb::v1::debugger_core->process();
+	if(!process) {
+		return false;
+	}
+
+	const std::size_t page_size = edb::v1::debugger_core->page_size().toUint();
+
+	while(position_ < end_) {
+
+		// carry the tail of the previous window over, but only if it is
+		// actually adjacent to what we are about to read
+		std::size_t keep = 0;
+		if(size_ != 0 && address_ + size_ == position_) {
+			keep = std::min(overlap_, size_);
+			std::memmove(buffer_.data(), buffer_.constData() + size_ - keep, keep);
+		}
+
+		const std::size_t want = std::min<quint64>(window_size_, (end_ - position_).toUint());
+
+		// whole pages go through read_pages, which lets the platform skip
+		// pages it knows to be zero instead of faulting them in
+		std::size_t got;
+		if((position_ & (page_size - 1)) == 0 && (want & (page_size - 1)) == 0) {
+			got = process->read_pages(position_, buffer_.data() + keep, want / page_size) * page_size;
+		} else {
+			got = process->read_bytes(position_, buffer_.data() + keep, want);
+		}
+
+		if(got == 0) {
+			// unreadable page, skip it and start over without any overlap
+			size_      = 0;
+			position_ += page_size - (position_ & (page_size - 1));
+			continue;
+		}
+
+		address_   = position_ - keep;
+		size_      = keep + got;
+		position_ += got;
+		return true;
+	}
+
+	size_ = 0;
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: cancel
+// Desc: stops the scan, the next call to next() will return false
+//------------------------------------------------------------------------------
+void RegionScanner::cancel() {
+	cancelled_ = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: progress
+// Desc: returns how much of the region has been scanned, as a percentage
+//------------------------------------------------------------------------------
+int RegionScanner::progress() const {
+	const quint64 total = (end_ - start_).toUint();
+	if(total == 0) {
+		return 100;
+	}
+
+	const quint64 done  = (std::min(position_, end_) - start_).toUint();
+	return static_cast<int>(static_cast<double>(done) / static_cast<double>(total) * 100);
+}
@@ -0,0 +1,123 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "RegionSearch.h"
+#include "IRegion.h"
+#include "RegionScanner.h"
+#include "TaskScheduler.h"
+#include "Util.h"
+#include "edb.h"
+
+#include <QList>
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// Name: RegionSearch
+// Desc: the windows overlap by <overlap> bytes, as with RegionScanner
+//------------------------------------------------------------------------------
+RegionSearch::RegionSearch(const Matcher &matcher, std::size_t overlap) : matcher_(matcher), overlap_(overlap) {
+	Q_ASSERT(matcher_);
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc:
+//------------------------------------------------------------------------------
+void RegionSearch::run(const std::shared_ptr<IRegion> &region, const ResultFunction &results, const ProgressFunction &progress) const {
+	run(QList<std::shared_ptr<IRegion>>() << region, results, progress);
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: searches all of <regions>, one after another but without waiting for
+//       one to be matched before reading the next. A window is only handed to
+//       the matcher once the one after it has been read, so it can be told
+//       whether its tail will be looked at again. <progress> is for all of
+//       them together
+//------------------------------------------------------------------------------
+void RegionSearch::run(const QList<std::shared_ptr<IRegion>> &regions, const ResultFunction &results, const ProgressFunction &progress) const {
+
+	Q_ASSERT(results);
+
+	// enough to keep every worker busy, with a window or so each to spare
+	// while this thread is reading, but bounded since every one is a copy
+	TaskScheduler &scheduler = edb::v1::task_scheduler();
+	const int max_pending = std::max(2, scheduler.max_threads() * 2);
+	QList<QFuture<QVector<SearchResult>>> pending;
+
+	auto submit = [&](const Window &window) {
+		const Matcher matcher = matcher_;
+		pending.push_back(scheduler.run<QVector<SearchResult>>("RegionSearch::match", TaskScheduler::Search, QString(), [matcher, window](const TaskToken &) {
+			return matcher(window);
+		}));
+
+		while(pending.size() >= max_pending) {
+			results(pending.takeFirst().result());
+		}
+	};
+
+	int i = 0;
+	for(const std::shared_ptr<IRegion> &region : regions) {
+
+		Q_ASSERT(region);
+
+		RegionScanner scanner(region, overlap_);
+		std::unique_ptr<Window> held;
+
+		while(scanner.next()) {
+
+			auto window = std::unique_ptr<Window>(new Window);
+			window->address   = scanner.address();
+			window->repeated  = 0;
+			window->continued = false;
+			window->data.resize(scanner.size());
+			std::memcpy(window->data.data(), scanner.data(), scanner.size());
+
+			if(held) {
+				const edb::address_t held_end = held->address + held->data.size();
+				if(window->address < held_end) {
+					window->repeated = (held_end - window->address).toUint();
+				}
+
+				held->continued = (window->address + window->repeated == held_end);
+				submit(*held);
+			}
+
+			held = std::move(window);
+
+			if(progress) {
+				progress(util::percentage(i, regions.size(), scanner.progress(), 100));
+			}
+		}
+
+		// whatever follows the last window, even an adjacent region, is
+		// searched without it
+		if(held) {
+			submit(*held);
+		}
+
+		++i;
+	}
+
+	while(!pending.isEmpty()) {
+		results(pending.takeFirst().result());
+	}
+}
@@ -582,8 +582,10 @@ void RegisterItem<T>::invalidate()
 	util::markMemory(&value_,sizeof value_);
 	util::markMemory(&prevValue_,sizeof prevValue_);
 	comment_.clear();
+	commentSource_=nullptr;
 	valueKnown_=false;
 	prevValueKnown_=false;
+	updated_=true;
 }
 
 template<typename T>
@@ -601,8 +603,20 @@ bool RegisterItem<T>::changed() const
 template<typename T>
 void RegisterItem<T>::saveValue()
 {
+	const bool wasChanged=changed();
 	prevValue_=value_;
 	prevValueKnown_=valueKnown_;
+	// the views show changed registers differently
+	if(changed()!=wasChanged)
+		updated_=true;
+}
+
+template<typename T>
+bool RegisterItem<T>::takeUpdated()
+{
+	const bool updated=updated_;
+	updated_=false;
+	return updated;
 }
 
 template<typename T>
@@ -624,6 +638,17 @@ QString RegisterItem<T>::valueString() const
 	return this->value_.toHexString();
 }
 
+template<typename T>
+QString RegisterItem<T>::comment() const
+{
+	if(commentSource_)
+	{
+		comment_=commentSource_();
+		commentSource_=nullptr;
+	}
+	return comment_;
+}
+
 template<typename T>
 QVariant RegisterItem<T>::data(int column) const
 {
@@ -631,7 +656,7 @@ QVariant RegisterItem<T>::data(int column) const
 	{
 	case Model::NAME_COLUMN:    return this->name_;
 	case Model::VALUE_COLUMN:   return valueString();
-	case Model::COMMENT_COLUMN: return this->comment_;
+	case Model::COMMENT_COLUMN: return comment();
 	}
 	return {};
 }
@@ -694,9 +719,23 @@ template class RegisterItem<edb::value256>;
 template<typename T>
 void SimpleRegister<T>::update(T const& value, QString const& comment)
 {
+	if(!this->valueKnown_ || this->value_!=value || this->commentSource_ || this->comment_!=comment)
+		this->updated_=true;
+
 	this->value_=value;
 	this->comment_=comment;
+	this->commentSource_=nullptr;
+	this->valueKnown_=true;
+}
+
+template<typename T>
+void SimpleRegister<T>::updateLazily(T const& value, std::function<QString()> const& commentSource)
+{
+	this->value_=value;
+	this->comment_.clear();
+	this->commentSource_=commentSource;
 	this->valueKnown_=true;
+	this->updated_=true;
 }
 
 template<typename T>
@@ -1369,7 +1408,25 @@ NumberDisplayMode FPUCategory::chosenFormat() const
 
 void Model::dataUpdateFinished()
 {
-	Q_EMIT dataChanged(index(0,1/*names don't change*/,QModelIndex()), index(rowCount()-1,NUM_COLS-1,QModelIndex()));
+	// Views redo every field in the range they are given, so neighbouring registers are
+	// announced together, and the ones which are as they were not at all
+	for(const auto& cat : rootItem->categories)
+	{
+		if(!cat->visible()) continue;
+
+		const auto catIndex=createIndex(cat->row(),0,cat.get());
+		const int count=cat->childCount();
+		for(int first=0;first<count;++first)
+		{
+			if(!cat->getRegister(first)->takeUpdated()) continue;
+
+			int last=first;
+			while(last+1<count && cat->getRegister(last+1)->takeUpdated())
+				++last;
+			Q_EMIT dataChanged(index(first,VALUE_COLUMN/*names don't change*/,catIndex), index(last,NUM_COLS-1,catIndex));
+			first=last;
+		}
+	}
 }
 
 }
@@ -0,0 +1,205 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SearchResultModel.h"
+#include "edb.h"
+
+#include <QIODevice>
+#include <QPair>
+#include <QTextStream>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Name: SearchResultModel
+// Desc:
+//------------------------------------------------------------------------------
+SearchResultModel::SearchResultModel(QObject *parent) : QAbstractListModel(parent) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~SearchResultModel
+// Desc:
+//------------------------------------------------------------------------------
+SearchResultModel::~SearchResultModel() {
+}
+
+//------------------------------------------------------------------------------
+// Name: text
+// Desc: the text of a result, from the TextFunction if it has none of its own
+//------------------------------------------------------------------------------
+QString SearchResultModel::text(int row) const {
+
+	const SearchResult &result = results_[row];
+
+	if(result.text.isEmpty() && text_function_) {
+		return text_function_(result);
+	}
+
+	return result.text;
+}
+
+//------------------------------------------------------------------------------
+// Name: displayText
+// Desc:
+//------------------------------------------------------------------------------
+QString SearchResultModel::displayText(int row) const {
+
+	const QString str = text(row);
+
+	if(str.isEmpty()) {
+		return edb::v1::format_pointer(results_[row].address);
+	}
+
+	return QString("%1: %2").arg(edb::v1::format_pointer(results_[row].address), str);
+}
+
+//------------------------------------------------------------------------------
+// Name: data
+// Desc:
+//------------------------------------------------------------------------------
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const {
+
+	if(!index.isValid() || index.row() >= results_.size()) {
+		return QVariant();
+	}
+
+	switch(role) {
+	case Qt::DisplayRole:
+		return displayText(index.row());
+	case AddressRole:
+		return QVariant::fromValue<qulonglong>(results_[index.row()].address.toUint());
+	case TagRole:
+		return results_[index.row()].tag;
+	default:
+		return QVariant();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: rowCount
+// Desc:
+//------------------------------------------------------------------------------
+int SearchResultModel::rowCount(const QModelIndex &parent) const {
+	if(parent.isValid()) {
+		return 0;
+	}
+	return results_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: sort
+// Desc: <column> is a SortKey, ties are broken by address so that the order
+//       is the same every time
+//------------------------------------------------------------------------------
+void SearchResultModel::sort(int column, Qt::SortOrder order) {
+
+	Q_EMIT layoutAboutToBeChanged();
+
+	if(column == SortByText) {
+		// the texts may have to be made first, so each is made once
+		QVector<QPair<QString, SearchResult>> keyed;
+		keyed.reserve(results_.size());
+		for(int i = 0; i < results_.size(); ++i) {
+			keyed.push_back(qMakePair(text(i), results_[i]));
+		}
+
+		std::stable_sort(keyed.begin(), keyed.end(), [](const QPair<QString, SearchResult> &a, const QPair<QString, SearchResult> &b) {
+			const int n = QString::compare(a.first, b.first);
+			return n != 0 ? n < 0 : a.second.address < b.second.address;
+		});
+
+		for(int i = 0; i < keyed.size(); ++i) {
+			results_[i] = keyed[i].second;
+		}
+	} else {
+		std::stable_sort(results_.begin(), results_.end(), [](const SearchResult &a, const SearchResult &b) {
+			return a.address < b.address;
+		});
+	}
+
+	if(order == Qt::DescendingOrder) {
+		std::reverse(results_.begin(), results_.end());
+	}
+
+	Q_EMIT layoutChanged();
+}
+
+//------------------------------------------------------------------------------
+// Name: append
+// Desc: adds a whole batch with a single insertion
+//------------------------------------------------------------------------------
+void SearchResultModel::append(const QVector<SearchResult> &results) {
+
+	if(results.isEmpty()) {
+		return;
+	}
+
+	beginInsertRows(QModelIndex(), results_.size(), results_.size() + results.size() - 1);
+	results_ += results;
+	endInsertRows();
+}
+
+//------------------------------------------------------------------------------
+// Name: append
+// Desc:
+//------------------------------------------------------------------------------
+void SearchResultModel::append(edb::address_t address, const QString &text, int tag) {
+	beginInsertRows(QModelIndex(), results_.size(), results_.size());
+	results_.push_back(SearchResult{address, text, tag, 0});
+	endInsertRows();
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void SearchResultModel::clear() {
+	beginResetModel();
+	results_.clear();
+	results_.squeeze();
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: setTextFunction
+// Desc:
+//------------------------------------------------------------------------------
+void SearchResultModel::setTextFunction(const TextFunction &function) {
+	beginResetModel();
+	text_function_ = function;
+	endResetModel();
+}
+
+//------------------------------------------------------------------------------
+// Name: save
+// Desc: writes the results out one a line, as they are shown
+//------------------------------------------------------------------------------
+bool SearchResultModel::save(QIODevice *device) const {
+
+	Q_ASSERT(device);
+
+	QTextStream stream(device);
+	for(int i = 0; i < results_.size(); ++i) {
+		stream << displayText(i) << '\n';
+	}
+
+	stream.flush();
+	return stream.status() == QTextStream::Ok;
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SearchResultView.h"
+#include "SearchResultModel.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QMenu>
+#include <QMessageBox>
+
+//------------------------------------------------------------------------------
+// Name: SearchResultView
+// Desc:
+//------------------------------------------------------------------------------
+SearchResultView::SearchResultView(QWidget *parent) : QListView(parent), model_(new SearchResultModel(this)) {
+
+	// every row is one line of the same font, telling the view so spares it
+	// from measuring them all whenever a batch of results arrives
+	setUniformItemSizes(true);
+	setSelectionMode(QAbstractItemView::ExtendedSelection);
+	setEditTriggers(QAbstractItemView::NoEditTriggers);
+	setModel(model_);
+
+	setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(showContextMenu(const QPoint &)));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~SearchResultView
+// Desc:
+//------------------------------------------------------------------------------
+SearchResultView::~SearchResultView() {
+}
+
+//------------------------------------------------------------------------------
+// Name: showContextMenu
+// Desc:
+//------------------------------------------------------------------------------
+void SearchResultView::showContextMenu(const QPoint &pos) {
+
+	QMenu menu;
+	QAction *const byAddress = menu.addAction(tr("Sort By &Address"));
+	QAction *const byText    = menu.addAction(tr("Sort By &Text"));
+	menu.addSeparator();
+	QAction *const save      = menu.addAction(tr("&Export..."));
+
+	const bool empty = model_->rowCount() == 0;
+	byAddress->setEnabled(!empty);
+	byText->setEnabled(!empty);
+	save->setEnabled(!empty);
+
+	QAction *const chosen = menu.exec(viewport()->mapToGlobal(pos));
+	if(chosen == byAddress) {
+		model_->sort(SearchResultModel::SortByAddress);
+	} else if(chosen == byText) {
+		model_->sort(SearchResultModel::SortByText);
+	} else if(chosen == save) {
+		exportResults();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: exportResults
+// Desc: saves the results as a text file, one a line
+//------------------------------------------------------------------------------
+void SearchResultView::exportResults() {
+
+	const QString file_name = QFileDialog::getSaveFileName(this, tr("Export Results"), QDir::homePath());
+	if(file_name.isEmpty()) {
+		return;
+	}
+
+	QFile file(file_name);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) || !model_->save(&file)) {
+		QMessageBox::critical(this, tr("Error Exporting Results"), tr("Unable to write the results to: %1").arg(file_name));
+	}
+}
@@ -25,24 +25,38 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 //------------------------------------------------------------------------------
 // Name: State
-// Desc: constructor
+// Desc: constructor, the platform state is only created once it is written to
 //------------------------------------------------------------------------------
-State::State() : impl_(edb::v1::debugger_core ? edb::v1::debugger_core->create_state() : nullptr) {
+State::State() {
 }
 
 //------------------------------------------------------------------------------
 // Name: ~State
 // Desc:
 //------------------------------------------------------------------------------
-State::~State() {
-	delete impl_;
-}
+State::~State() = default;
 
 //------------------------------------------------------------------------------
 // Name: State
-// Desc:
+// Desc: copies share the platform state until one of them writes to it
+//------------------------------------------------------------------------------
+State::State(const State &other) : impl_(other.impl_) {
+}
+
 //------------------------------------------------------------------------------
-State::State(const State &other) : impl_(other.impl_ ? other.impl_->clone() : nullptr) {
+// Name: writable_impl
+// Desc: returns a platform state which is safe to modify, creating it if there
+//       is none yet and detaching it from any copies of this State
+//------------------------------------------------------------------------------
+IState *State::writable_impl() {
+	if(!impl_) {
+		if(edb::v1::debugger_core) {
+			impl_.reset(edb::v1::debugger_core->create_state());
+		}
+	} else if(impl_.use_count() > 1) {
+		impl_.reset(impl_->clone());
+	}
+	return impl_.get();
 }
 
 //------------------------------------------------------------------------------
@@ -69,13 +83,12 @@ State &State::operator=(const State &other) {
 // Desc:
 //------------------------------------------------------------------------------
 void State::clear() {
-	if(impl_) {
-		impl_->clear();
-	}
+	// an absent state reads as empty, so there is nothing worth cloning
+	impl_ = nullptr;
 }
 
 //------------------------------------------------------------------------------
-// Name: clear
+// Name: empty
 // Desc:
 //------------------------------------------------------------------------------
 bool State::empty() const {
@@ -178,8 +191,8 @@ Register State::operator[](const QString &reg) const {
 // Desc:
 //------------------------------------------------------------------------------
 void State::set_register(const Register& reg) {
-	if(impl_) {
-		impl_->set_register(reg);
+	if(IState *const impl = writable_impl()) {
+		impl->set_register(reg);
 	}
 }
 
@@ -188,8 +201,8 @@ void State::set_register(const Register& reg) {
 // Desc:
 //------------------------------------------------------------------------------
 void State::set_register(const QString &name, edb::reg_t value) {
-	if(impl_) {
-		impl_->set_register(name, value);
+	if(IState *const impl = writable_impl()) {
+		impl->set_register(name, value);
 	}
 }
 
@@ -198,8 +211,8 @@ void State::set_register(const QString &name, edb::reg_t value) {
 // Desc:
 //------------------------------------------------------------------------------
 void State::adjust_stack(int bytes) {
-	if(impl_) {
-		impl_->adjust_stack(bytes);
+	if(IState *const impl = writable_impl()) {
+		impl->adjust_stack(bytes);
 	}
 }
 
@@ -208,8 +221,8 @@ void State::adjust_stack(int bytes) {
 // Desc:
 //------------------------------------------------------------------------------
 void State::set_instruction_pointer(edb::address_t value) {
-	if(impl_) {
-		impl_->set_instruction_pointer(value);
+	if(IState *const impl = writable_impl()) {
+		impl->set_instruction_pointer(value);
 	}
 }
 
@@ -240,8 +253,8 @@ QString State::flags_to_string(edb::reg_t flags) const {
 // Desc:
 //------------------------------------------------------------------------------
 void State::set_flags(edb::reg_t flags) {
-	if(impl_) {
-		return impl_->set_flags(flags);
+	if(IState *const impl = writable_impl()) {
+		return impl->set_flags(flags);
 	}
 }
 
@@ -261,8 +274,8 @@ edb::reg_t State::debug_register(size_t n) const {
 // Desc:
 //------------------------------------------------------------------------------
 void State::set_debug_register(size_t n, edb::reg_t value) {
-	if(impl_) {
-		impl_->set_debug_register(n, value);
+	if(IState *const impl = writable_impl()) {
+		impl->set_debug_register(n, value);
 	}
 }
 
@@ -367,7 +380,7 @@ Register State::xmm_register(std::size_t n) const {
 }
 
 //------------------------------------------------------------------------------
-// Name: xmm_register
+// Name: ymm_register
 // Desc:
 //------------------------------------------------------------------------------
 Register State::ymm_register(std::size_t n) const {
@@ -376,6 +389,28 @@ Register State::ymm_register(std::size_t n) const {
 	}
 	return Register();
 }
+
+//------------------------------------------------------------------------------
+// Name: xmm_register_value
+// Desc:
+//------------------------------------------------------------------------------
+edb::value128 State::xmm_register_value(std::size_t n) const {
+	if(impl_) {
+		return impl_->xmm_register_value(n);
+	}
+	return edb::value128(std::array<std::uint8_t, 16>());
+}
+
+//------------------------------------------------------------------------------
+// Name: ymm_register_value
+// Desc:
+//------------------------------------------------------------------------------
+edb::value256 State::ymm_register_value(std::size_t n) const {
+	if(impl_) {
+		return impl_->ymm_register_value(n);
+	}
+	return edb::value256(std::array<std::uint8_t, 32>());
+}
 #endif
 
 //------------------------------------------------------------------------------
@@ -388,3 +423,14 @@ Register State::gp_register(size_t n) const {
 	}
 	return Register();
 }
+
+//------------------------------------------------------------------------------
+// Name: gp_register_value
+// Desc: like gp_register, but without building a named Register
+//------------------------------------------------------------------------------
+edb::reg_t State::gp_register_value(size_t n) const {
+	if(impl_) {
+		return impl_->gp_register_value(n);
+	}
+	return 0;
+}
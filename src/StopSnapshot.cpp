@@ -0,0 +1,102 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StopSnapshot.h"
+#include "IBreakpoint.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IThread.h"
+#include "edb.h"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+// Name: capture
+// Desc: the pages are shared with the cache, only those with a breakpoint in
+//       them are copied
+//------------------------------------------------------------------------------
+std::shared_ptr<const StopSnapshot> StopSnapshot::capture() {
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		return nullptr;
+	}
+
+	std::shared_ptr<StopSnapshot> snapshot(new StopSnapshot);
+
+	if(std::shared_ptr<IThread> thread = process->current_thread()) {
+		thread->get_state(&snapshot->state_);
+		snapshot->thread_ = thread->tid();
+	}
+
+	snapshot->page_size_ = edb::v1::debugger_core->page_size().toUint();
+	snapshot->pages_     = process->cached_pages();
+
+	if(snapshot->page_size_ == 0 || snapshot->pages_.isEmpty()) {
+		return snapshot;
+	}
+
+	for(const std::shared_ptr<IBreakpoint> &bp : edb::v1::debugger_core->backup_breakpoints()) {
+		const quint8 *const original = bp->original_bytes();
+		for(std::size_t i = 0; i < bp->size(); ++i) {
+			const quint64 address = bp->address().toUint() + i;
+			const quint64 page    = address - address % snapshot->page_size_;
+
+			auto it = snapshot->pages_.find(edb::address_t::fromZeroExtended(page));
+			if(it != snapshot->pages_.end()) {
+				it.value()[static_cast<int>(address - page)] = static_cast<char>(original[i]);
+			}
+		}
+	}
+
+	return snapshot;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: returns the number of bytes read, which stops short at the first page
+//       which wasn't cached
+//------------------------------------------------------------------------------
+std::size_t StopSnapshot::read_bytes(edb::address_t address, void *buf, std::size_t len) const {
+
+	Q_ASSERT(buf);
+
+	if(page_size_ == 0) {
+		return 0;
+	}
+
+	auto ptr = reinterpret_cast<char *>(buf);
+	std::size_t read = 0;
+
+	while(read < len) {
+		const quint64     current = address.toUint() + read;
+		const std::size_t offset  = current % page_size_;
+		const std::size_t n       = std::min<std::size_t>(page_size_ - offset, len - read);
+
+		auto it = pages_.find(edb::address_t::fromZeroExtended(current - offset));
+		if(it == pages_.end()) {
+			break;
+		}
+
+		std::memcpy(ptr + read, it->constData() + offset, n);
+		read += n;
+	}
+
+	return read;
+}
@@ -0,0 +1,174 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StringProbe.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const quint64 ONES = 0x0101010101010101ULL;
+const quint64 HIGH = 0x8080808080808080ULL;
+
+//------------------------------------------------------------------------------
+// Name: is_ascii_char
+// Desc: isprint() or isspace() in the C locale, below 0x80
+//------------------------------------------------------------------------------
+bool is_ascii_char(quint8 ch) {
+	return (ch >= 0x20 && ch < 0x7f) || (ch >= 0x09 && ch <= 0x0d);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_utf16_char
+// Desc: for now, we only acknowledge ASCII chars encoded as unicode
+//------------------------------------------------------------------------------
+bool is_utf16_char(quint16 ch) {
+	return ch >= 0x20 && ch < 0x80;
+}
+
+//------------------------------------------------------------------------------
+// Name: all_printable
+// Desc: true if every byte of <word> is in [0x20, 0x7e]. A byte below 0x20
+//       borrows into its top bit when 0x20 is taken away from it, one above
+//       0x7e carries into it when 1 is added
+//------------------------------------------------------------------------------
+bool all_printable(quint64 word) {
+	const quint64 below = (word - ONES * 0x20) & ~word & HIGH;
+	const quint64 above = ((word + ONES) | word) & HIGH;
+	return (below | above) == 0;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: ascii_run
+// Desc: how many bytes at the start of <data> can be part of an ASCII string.
+//       Whitespace other than ' ' is rare enough to leave to the byte by byte
+//       check of the word which ends the fast path
+//------------------------------------------------------------------------------
+std::size_t StringProbe::ascii_run(const quint8 *data, std::size_t size) {
+
+	std::size_t i = 0;
+	for(; i + sizeof(quint64) <= size; i += sizeof(quint64)) {
+		quint64 word;
+		std::memcpy(&word, data + i, sizeof(word));
+		if(!all_printable(word)) {
+			break;
+		}
+	}
+
+	while(i < size && is_ascii_char(data[i])) {
+		++i;
+	}
+
+	return i;
+}
+
+//------------------------------------------------------------------------------
+// Name: utf16_run
+// Desc: how many characters at the start of <data> can be part of a UTF-16
+//       string, little endian as the debuggee keeps them. A word holds four,
+//       they qualify when each high byte is zero and each low byte printable
+//------------------------------------------------------------------------------
+std::size_t StringProbe::utf16_run(const quint8 *data, std::size_t size) {
+
+	const quint64 high_bytes = 0xff00ff00ff00ff00ULL;
+	const quint64 filler     = 0x2000200020002000ULL; // printable, for the high bytes
+
+	std::size_t i = 0;
+	for(; i + sizeof(quint64) <= size; i += sizeof(quint64)) {
+		quint64 word = quint64(data[i + 0])       | quint64(data[i + 1]) << 8  |
+		               quint64(data[i + 2]) << 16 | quint64(data[i + 3]) << 24 |
+		               quint64(data[i + 4]) << 32 | quint64(data[i + 5]) << 40 |
+		               quint64(data[i + 6]) << 48 | quint64(data[i + 7]) << 56;
+
+		if((word & high_bytes) != 0 || !all_printable((word & ~high_bytes) | filler)) {
+			break;
+		}
+	}
+
+	// 0x7f is not printable as a byte, but it is as a UTF-16 character
+	while(i + 1 < size && is_utf16_char(static_cast<quint16>(data[i] | (data[i + 1] << 8)))) {
+		i += 2;
+	}
+
+	return i / 2;
+}
+
+//------------------------------------------------------------------------------
+// Name: escape
+// Desc: as edb::v1::get_ascii_string_at_address does
+//------------------------------------------------------------------------------
+void StringProbe::escape(QString *s) {
+	s->replace("\r", "\\r");
+	s->replace("\n", "\\n");
+	s->replace("\t", "\\t");
+	s->replace("\v", "\\v");
+	s->replace("\"", "\\\"");
+}
+
+//------------------------------------------------------------------------------
+// Name: ascii_string
+// Desc: the same string edb::v1::get_ascii_string_at_address would find at
+//       <data>, but read from a buffer
+//------------------------------------------------------------------------------
+bool StringProbe::ascii_string(const quint8 *data, std::size_t size, int min_length, int max_length, QString *s) {
+
+	s->clear();
+
+	if(max_length < 0) {
+		return false;
+	}
+
+	const std::size_t length = ascii_run(data, std::min(size, static_cast<std::size_t>(max_length)));
+	if(length < static_cast<std::size_t>(std::max(min_length, 0))) {
+		return false;
+	}
+
+	*s = QString::fromLatin1(reinterpret_cast<const char *>(data), static_cast<int>(length));
+	escape(s);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: utf16_string
+// Desc: the same string edb::v1::get_utf16_string_at_address would find at
+//       <data>, but read from a buffer
+//------------------------------------------------------------------------------
+bool StringProbe::utf16_string(const quint8 *data, std::size_t size, int min_length, int max_length, QString *s) {
+
+	s->clear();
+
+	if(max_length < 0) {
+		return false;
+	}
+
+	const std::size_t length = utf16_run(data, std::min(size, static_cast<std::size_t>(max_length) * 2));
+	if(length < static_cast<std::size_t>(std::max(min_length, 0))) {
+		return false;
+	}
+
+	// every character is below 0x80, so the low bytes are the whole string
+	s->reserve(static_cast<int>(length));
+	for(std::size_t i = 0; i < length; ++i) {
+		*s += QChar(data[i * 2]);
+	}
+
+	escape(s);
+	return true;
+}
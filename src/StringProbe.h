@@ -0,0 +1,44 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STRING_PROBE_20171014_H_
+#define STRING_PROBE_20171014_H_
+
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+
+// Finds the strings edb::v1::get_ascii_string_at_address and
+// get_utf16_string_at_address would, in bytes which were already read. Runs
+// of characters are measured a word at a time, so what isn't a string, most
+// of what pointers point to, is turned down after looking at a word or two
+class StringProbe {
+public:
+	static std::size_t ascii_run(const quint8 *data, std::size_t size);
+	static std::size_t utf16_run(const quint8 *data, std::size_t size);
+
+public:
+	static bool ascii_string(const quint8 *data, std::size_t size, int min_length, int max_length, QString *s);
+	static bool utf16_string(const quint8 *data, std::size_t size, int min_length, int max_length, QString *s);
+	static void escape(QString *s);
+
+private:
+	StringProbe() = delete;
+};
+
+#endif
@@ -0,0 +1,274 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SymbolFile.h"
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'E', 'D', 'B', 'S', 'Y', 'M', 'S', '\0'};
+
+// the name hash is kept at most half full, so probes stay short
+const quint32 MIN_SLOTS = 64;
+
+static_assert(sizeof(SymbolFile::Header) == 48, "the symbol file header has changed size");
+static_assert(sizeof(SymbolFile::Entry) == 24, "the symbol file entry has changed size");
+
+}
+
+//------------------------------------------------------------------------------
+// Name: ~SymbolFile
+// Desc:
+//------------------------------------------------------------------------------
+SymbolFile::~SymbolFile() = default;
+
+//------------------------------------------------------------------------------
+// Name: hash
+// Desc: FNV-1a, which unlike qHash is the same on every build of edb, so it can
+//       be kept in the files
+//------------------------------------------------------------------------------
+quint32 SymbolFile::hash(const char *name, std::size_t size) {
+	quint32 h = 2166136261u;
+	for(std::size_t i = 0; i < size; ++i) {
+		h ^= static_cast<quint8>(name[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+//------------------------------------------------------------------------------
+// Name: write
+// Desc: writes the symbols of <binary>, whose MD5 is <md5>, to <filename>. It
+//       is written beside it and then moved over, so a reader never sees half
+//       of a file
+//------------------------------------------------------------------------------
+Status SymbolFile::write(const QString &filename, const QString &binary, const QByteArray &md5, QVector<Symbol> symbols) {
+
+	if(md5.size() != sizeof(Header::md5)) {
+		return Status(QObject::tr("There is no MD5 for %1.").arg(binary));
+	}
+
+	std::stable_sort(symbols.begin(), symbols.end(), [](const Symbol &lhs, const Symbol &rhs) {
+		return lhs.address < rhs.address;
+	});
+
+	QByteArray                 strings;
+	QHash<QByteArray, quint32> offsets;
+
+	auto intern = [&strings, &offsets](const QByteArray &string) {
+		auto it = offsets.find(string);
+		if(it == offsets.end()) {
+			it = offsets.insert(string, strings.size());
+			strings.append(string);
+			strings.append('\0');
+		}
+		return it.value();
+	};
+
+	const quint32 path = intern(binary.toUtf8());
+
+	QVector<Entry> entries;
+	entries.reserve(symbols.size());
+	for(const Symbol &symbol : symbols) {
+		Entry entry;
+		std::memset(&entry, 0, sizeof(entry));
+		entry.address = symbol.address;
+		entry.size    = symbol.size;
+		entry.name    = intern(symbol.name);
+		entry.type    = static_cast<quint8>(symbol.type);
+		entry.flags   = symbol.flags;
+		entries.push_back(entry);
+	}
+
+	quint32 slot_count = MIN_SLOTS;
+	while(slot_count < (static_cast<quint32>(entries.size()) + 1) * 2) {
+		slot_count *= 2;
+	}
+
+	// the first entry with a name is the one it finds
+	QVector<quint32> table(slot_count, 0);
+	const quint32 mask = slot_count - 1;
+
+	for(int i = 0; i < entries.size(); ++i) {
+		const char *const name = strings.constData() + entries[i].name;
+
+		quint32 slot = hash(name, std::strlen(name)) & mask;
+		while(table[slot] && std::strcmp(strings.constData() + entries[table[slot] - 1].name, name) != 0) {
+			slot = (slot + 1) & mask;
+		}
+
+		if(!table[slot]) {
+			table[slot] = i + 1;
+		}
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+	std::memcpy(header.md5, md5.constData(), sizeof(header.md5));
+	header.version      = VERSION;
+	header.header_size  = sizeof(Header);
+	header.entry_count  = entries.size();
+	header.slot_count   = slot_count;
+	header.strings_size = strings.size();
+	header.path         = path;
+
+	QByteArray data;
+	data.reserve(sizeof(Header) + entries.size() * sizeof(Entry) + table.size() * sizeof(quint32) + strings.size());
+	data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	data.append(reinterpret_cast<const char *>(entries.constData()), entries.size() * sizeof(Entry));
+	data.append(reinterpret_cast<const char *>(table.constData()), table.size() * sizeof(quint32));
+	data.append(strings);
+
+	const QString temporary = filename + QLatin1String(".tmp");
+
+	QFile file(temporary);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return Status(QObject::tr("Could not create %1: %2").arg(temporary, file.errorString()));
+	}
+
+	if(file.write(data) != data.size()) {
+		const QString message = QObject::tr("Could not write %1: %2").arg(temporary, file.errorString());
+		file.close();
+		file.remove();
+		return Status(message);
+	}
+
+	file.close();
+
+	QFile::remove(filename);
+	if(!QFile::rename(temporary, filename)) {
+		QFile::remove(temporary);
+		return Status(QObject::tr("Could not replace %1.").arg(filename));
+	}
+
+	return Status::Ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: open
+// Desc: maps <filename>. Only the header and the sizes of the tables are
+//       checked, the rest is read where it lies as it is needed
+//------------------------------------------------------------------------------
+Result<std::shared_ptr<SymbolFile>> SymbolFile::open(const QString &filename) {
+
+	typedef Result<std::shared_ptr<SymbolFile>> ResultT;
+
+	std::shared_ptr<SymbolFile> symbols(new SymbolFile);
+	symbols->file_.reset(new QFile(filename));
+
+	QFile &file = *symbols->file_;
+	if(!file.open(QIODevice::ReadOnly)) {
+		return ResultT(QObject::tr("Could not open %1: %2").arg(filename, file.errorString()), nullptr);
+	}
+
+	const qint64 size = file.size();
+	if(size < static_cast<qint64>(sizeof(Header))) {
+		return ResultT(QObject::tr("%1 is not a symbol file.").arg(filename), nullptr);
+	}
+
+	const uchar *const data = file.map(0, size);
+	if(!data) {
+		return ResultT(QObject::tr("Could not map %1: %2").arg(filename, file.errorString()), nullptr);
+	}
+
+	const auto header = reinterpret_cast<const Header *>(data);
+	if(std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+		return ResultT(QObject::tr("%1 is not a symbol file.").arg(filename), nullptr);
+	}
+
+	if(header->version != VERSION || header->header_size != sizeof(Header)) {
+		return ResultT(QObject::tr("%1 was written by a different version of edb.").arg(filename), nullptr);
+	}
+
+	const quint64 expected = sizeof(Header) + quint64(header->entry_count) * sizeof(Entry) + quint64(header->slot_count) * sizeof(quint32) + header->strings_size;
+	const bool valid_slots = header->slot_count > header->entry_count && (header->slot_count & (header->slot_count - 1)) == 0;
+
+	if(expected != static_cast<quint64>(size) || !valid_slots || header->path >= header->strings_size) {
+		return ResultT(QObject::tr("%1 is corrupt.").arg(filename), nullptr);
+	}
+
+	symbols->header_  = header;
+	symbols->entries_ = reinterpret_cast<const Entry *>(data + sizeof(Header));
+	symbols->table_   = reinterpret_cast<const quint32 *>(symbols->entries_ + header->entry_count);
+	symbols->strings_ = reinterpret_cast<const char *>(symbols->table_ + header->slot_count);
+
+	// every string can then be read without running off the end
+	if(symbols->strings_[header->strings_size - 1] != '\0') {
+		return ResultT(QObject::tr("%1 is corrupt.").arg(filename), nullptr);
+	}
+
+	return ResultT(symbols);
+}
+
+//------------------------------------------------------------------------------
+// Name: md5
+// Desc: of the binary the symbols are for
+//------------------------------------------------------------------------------
+QByteArray SymbolFile::md5() const {
+	return QByteArray(reinterpret_cast<const char *>(header_->md5), sizeof(header_->md5));
+}
+
+//------------------------------------------------------------------------------
+// Name: path
+// Desc: of the binary the symbols are for
+//------------------------------------------------------------------------------
+QString SymbolFile::path() const {
+	return QString::fromUtf8(strings_ + header_->path);
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc: of entry <n>, empty if its offset is out of range
+//------------------------------------------------------------------------------
+const char *SymbolFile::name(quint32 n) const {
+	const quint32 offset = entries_[n].name;
+	return (offset < header_->strings_size) ? strings_ + offset : "";
+}
+
+//------------------------------------------------------------------------------
+// Name: find_name
+// Desc: the index of the first entry named <name>, whose hash() is <hash>, or
+//       -1
+//------------------------------------------------------------------------------
+int SymbolFile::find_name(const QByteArray &name, quint32 hash) const {
+
+	const quint32 mask = header_->slot_count - 1;
+
+	quint32 slot = hash & mask;
+	for(quint32 probes = 0; probes < header_->slot_count; ++probes) {
+		const quint32 n = table_[slot];
+		if(n == 0 || n > header_->entry_count) {
+			break;
+		}
+
+		if(std::strcmp(this->name(n - 1), name.constData()) == 0) {
+			return n - 1;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	return -1;
+}
@@ -18,25 +18,54 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "SymbolManager.h"
 #include "Configuration.h"
+#include "IBinary.h"
+#include "IRegion.h"
 #include "ISymbolGenerator.h"
+#include "MemoryRegions.h"
 #include "Symbol.h"
+#include "SymbolFile.h"
 #include "edb.h"
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QPair>
 #include <QProcess>
 #include <QtDebug>
 
-#include <fstream>
-#include <iostream>
-#include <istream>
+#include <algorithm>
+
+#if QT_VERSION >= 0x050000
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+#elif QT_VERSION >= 0x040800
+#include <QtConcurrentMap>
+
+#ifndef QT_NO_CONCURRENT
+#define QT_CONCURRENT_LIB
+#endif
+
+#endif
+
+namespace {
+
+// names which are looked for over and over are usually expressions and
+// function signatures naming symbols which aren't loaded. Past this many the
+// misses are forgotten rather than kept growing
+const int MAX_MISSING_NAMES = 4096;
+
+// a few screens of disassembly and stack name far fewer addresses than this
+const int MAX_ADDRESS_NAMES = 8192;
+
+}
 
 //------------------------------------------------------------------------------
 // Name: SymbolManager
 // Desc:
 //------------------------------------------------------------------------------
-SymbolManager::SymbolManager() : symbol_generator_(nullptr), show_path_notice_(true) {
+SymbolManager::SymbolManager() : symbol_generator_(nullptr), show_path_notice_(true), generation_(0), address_names_generation_(0) {
 }
 
 
@@ -46,19 +75,21 @@ SymbolManager::SymbolManager() : symbol_generator_(nullptr), show_path_notice_(t
 //------------------------------------------------------------------------------
 void SymbolManager::clear() {
 	symbol_files_.clear();
+	pending_modules_.clear();
+	imports_.clear();
 	symbols_.clear();
-	symbols_by_address_.clear();
-	symbols_by_file_.clear();
-	symbols_by_name_.clear();
+	missing_names_.clear();
 	labels_.clear();
 	labels_by_name_.clear();
+	++generation_;
 }
 
 //------------------------------------------------------------------------------
-// Name: load_symbol_file
-// Desc:
+// Name: symbol_file_name
+// Desc: where the symbols of <filename> are cached, or an empty string if they
+//       can't be
 //------------------------------------------------------------------------------
-void SymbolManager::load_symbol_file(const QString &filename, edb::address_t base) {
+QString SymbolManager::symbol_file_name(const QString &filename) {
 
 	const QString symbol_directory = edb::v1::config().symbol_path;
 
@@ -67,7 +98,7 @@ void SymbolManager::load_symbol_file(const QString &filename, edb::address_t bas
 			qDebug() << "No symbol path specified. Please set it in the preferences to enable symbols.";
 			show_path_notice_ = false;
 		}
-		return;
+		return QString();
 	}
 
 	// ensure that the directory exists
@@ -75,48 +106,281 @@ void SymbolManager::load_symbol_file(const QString &filename, edb::address_t bas
 
 	QFileInfo info(filename);
 
-	if(info.exists() && info.isReadable()) {
+	if(!info.exists() || !info.isReadable()) {
+		return QString();
+	}
+
+	if(info.isRelative()) {
+		info.makeAbsolute();
+	}
+
+	const QString path = QString("%1/%2").arg(symbol_directory, info.absolutePath());
+
+	// ensure that the sub-directory exists
+	QDir().mkpath(path);
+
+	return QString("%1/%2.sym").arg(path, info.fileName());
+}
+
+//------------------------------------------------------------------------------
+// Name: load_symbol_file
+// Desc:
+//------------------------------------------------------------------------------
+void SymbolManager::load_symbol_file(const QString &filename, edb::address_t base) {
+
+	const QString symbol_file = symbol_file_name(filename);
+	if(symbol_file.isEmpty()) {
+		return;
+	}
+
+	const QString library = QFileInfo(filename).absoluteFilePath();
+	if(!symbol_files_.contains(library)) {
+		if(process_symbol_file(symbol_file, base, filename, true)) {
+			symbol_files_.insert(library);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add_module
+// Desc: notes that <filename> is mapped over [start, end), with its symbols
+//       relative to <base>. They are only loaded once an address in that range,
+//       or a name which may be one of them, is looked up. Its imports are
+//       indexed once an address in it is asked about, see find_import
+//------------------------------------------------------------------------------
+void SymbolManager::add_module(const QString &filename, edb::address_t base, edb::address_t start, edb::address_t end) {
+
+	ModuleImports imports;
+	imports.base    = base;
+	imports.end     = end;
+	imports.indexed = false;
+	imports_.insert(start, imports);
+
+	if(symbol_files_.contains(QFileInfo(filename).absoluteFilePath())) {
+		return;
+	}
+
+	PendingModule module;
+	module.filename = filename;
+	module.base     = base;
+	module.end      = end;
+	pending_modules_.insert(start, module);
+
+	// a name which was missing may be in it
+	missing_names_.clear();
+	++generation_;
+}
+
+//------------------------------------------------------------------------------
+// Name: load_modules
+// Desc: loads the symbols of <modules>, which are no longer pending. Loading
+//       them on demand changes when the work is done, not what lookups find,
+//       which is why the const lookups may do it
+//------------------------------------------------------------------------------
+void SymbolManager::load_modules(const QList<PendingModule> &modules) const {
+
+	auto self = const_cast<SymbolManager *>(this);
+
+	if(modules.size() > 1) {
+		QList<QString> names;
+		for(const PendingModule &module : modules) {
+			names.push_back(module.filename);
+		}
+		self->generate_symbol_files(names);
+	}
+
+	for(const PendingModule &module : modules) {
+		self->load_symbol_file(module.filename, module.base);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: load_module_at
+// Desc: loads the pending module which <address> is in, if there is one
+//------------------------------------------------------------------------------
+bool SymbolManager::load_module_at(edb::address_t address) const {
+
+	if(pending_modules_.isEmpty()) {
+		return false;
+	}
+
+	auto it = pending_modules_.upperBound(address);
+	if(it == pending_modules_.begin()) {
+		return false;
+	}
+
+	--it;
+	if(address >= it.value().end) {
+		return false;
+	}
+
+	QList<PendingModule> modules;
+	modules.push_back(it.value());
+	pending_modules_.erase(it);
+
+	load_modules(modules);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: load_modules_named
+// Desc: loads the pending modules which a symbol called <name> could be in:
+//       those of its prefix, or all of them if it has none
+//------------------------------------------------------------------------------
+bool SymbolManager::load_modules_named(const QString &name) const {
+
+	if(pending_modules_.isEmpty()) {
+		return false;
+	}
+
+	const int bang = name.indexOf(QLatin1Char('!'));
+	if(bang == -1) {
+		load_all_modules();
+		return true;
+	}
 
-		if(info.isRelative()) {
-			info.makeAbsolute();
+	const QString prefix = name.left(bang);
+
+	QList<PendingModule> modules;
+	for(auto it = pending_modules_.begin(); it != pending_modules_.end(); ) {
+		if(QFileInfo(it.value().filename).fileName() == prefix) {
+			modules.push_back(it.value());
+			it = pending_modules_.erase(it);
+		} else {
+			++it;
 		}
+	}
+
+	if(modules.isEmpty()) {
+		return false;
+	}
+
+	load_modules(modules);
+	return true;
+}
 
-		const QString path = QString("%1/%2").arg(symbol_directory, info.absolutePath());
-		const QString name = info.fileName();
+//------------------------------------------------------------------------------
+// Name: load_all_modules
+// Desc: loads every pending module, for the callers which want all symbols
+//------------------------------------------------------------------------------
+void SymbolManager::load_all_modules() const {
 
-		// ensure that the sub-directory exists
-		QDir().mkpath(path);
+	if(pending_modules_.isEmpty()) {
+		return;
+	}
 
-		if(!symbol_files_.contains(info.absoluteFilePath())) {
-			const QString map_file = QString("%1/%2.map").arg(path, name);
+	const QList<PendingModule> modules = pending_modules_.values();
+	pending_modules_.clear();
+
+	load_modules(modules);
+}
+
+//------------------------------------------------------------------------------
+// Name: index_imports
+// Desc: notes where the stubs and slots of <module>'s imports are
+//------------------------------------------------------------------------------
+void SymbolManager::index_imports(ModuleImports *module) const {
 
-			if(process_symbol_file(map_file, base, filename, true)) {
-				symbol_files_.insert(info.absoluteFilePath());
+	module->indexed = true;
+
+	if(const std::shared_ptr<IRegion> region = edb::v1::memory_regions().find_region(module->base)) {
+		if(const std::shared_ptr<IBinary> binary = edb::v1::get_binary_info(region)) {
+			for(const IBinary::Import &import : binary->imports()) {
+				if(import.plt) {
+					module->names.insert(import.plt, import.name + QLatin1String("@plt"));
+				}
+				module->names.insert(import.got, import.name + QLatin1String("@got"));
 			}
 		}
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: generate_symbol_files
+// Desc: makes the symbol files which <filenames> don't have yet, several at
+//       once. Loading them afterwards only has to map them
+//------------------------------------------------------------------------------
+void SymbolManager::generate_symbol_files(const QList<QString> &filenames) {
+
+	if(!symbol_generator_) {
+		return;
+	}
+
+	QList<QPair<QString, QString>> jobs;
+	QSet<QString>                  seen;
+
+	for(const QString &filename : filenames) {
+		if(symbol_files_.contains(QFileInfo(filename).absoluteFilePath())) {
+			continue;
+		}
+
+		const QString symbol_file = symbol_file_name(filename);
+		if(!symbol_file.isEmpty() && !seen.contains(symbol_file) && !QFile::exists(symbol_file)) {
+			seen.insert(symbol_file);
+			jobs.push_back(qMakePair(filename, symbol_file));
+		}
+	}
+
+	// a single one is no faster here than when it is loaded
+	if(jobs.size() < 2) {
+		return;
+	}
+
+	edb::v1::set_status(QObject::tr("Auto-Generating Symbol Files for %1 modules").arg(jobs.size()), 0);
+
+	ISymbolGenerator *const generator = symbol_generator_;
+	auto generate = [generator](const QPair<QString, QString> &job) {
+		generator->generate_symbol_file(job.first, job.second);
+	};
+
+#ifdef QT_CONCURRENT_LIB
+	QtConcurrent::blockingMap(jobs, generate);
+#else
+	std::for_each(jobs.begin(), jobs.end(), generate);
+#endif
+
+	edb::v1::clear_status();
+}
+
 //------------------------------------------------------------------------------
 // Name: find
 // Desc:
 //------------------------------------------------------------------------------
 const std::shared_ptr<Symbol> SymbolManager::find(const QString &name) const {
 
-	auto it = symbols_by_name_.find(name);
-	if(it != symbols_by_name_.end()) {
-		return it.value();
+	if(missing_names_.contains(name)) {
+		return nullptr;
 	}
 
-	// slow path... look for any symbol which matches the name, but skipping the prefix
-	// we can make this faster later at the cost of yet another hash table if we
-	// feel the need
-	for(auto &&symbol : symbols_) {
-		if(symbol->name_no_prefix == name) {
+	auto lookup = [this, &name]() -> std::shared_ptr<Symbol> {
+		if(const SymbolTable::Handle handle = symbols_.find(name)) {
+			return symbols_.symbol(handle);
+		}
+
+		// then any symbol which matches the name, but skipping the prefix
+		if(const SymbolTable::Handle handle = symbols_.find_unprefixed(name)) {
+			return symbols_.symbol(handle);
+		}
+
+		return nullptr;
+	};
+
+	if(const std::shared_ptr<Symbol> symbol = lookup()) {
+		return symbol;
+	}
+
+	// it may be in a module whose symbols aren't loaded yet
+	if(load_modules_named(name)) {
+		if(const std::shared_ptr<Symbol> symbol = lookup()) {
 			return symbol;
 		}
 	}
 
+	if(missing_names_.size() >= MAX_MISSING_NAMES) {
+		missing_names_.clear();
+	}
+	missing_names_.insert(name);
+
 	return nullptr;
 }
 
@@ -125,8 +389,8 @@ const std::shared_ptr<Symbol> SymbolManager::find(const QString &name) const {
 // Desc:
 //------------------------------------------------------------------------------
 const std::shared_ptr<Symbol> SymbolManager::find(edb::address_t address) const {
-	auto it = symbols_by_address_.find(address);
-	return (it != symbols_by_address_.end()) ? it.value() : nullptr;
+	load_module_at(address);
+	return symbols_.symbol(symbols_.find(address));
 }
 
 //------------------------------------------------------------------------------
@@ -134,27 +398,22 @@ const std::shared_ptr<Symbol> SymbolManager::find(edb::address_t address) const
 // Desc:
 //------------------------------------------------------------------------------
 const std::shared_ptr<Symbol> SymbolManager::find_near_symbol(edb::address_t address) const {
+	load_module_at(address);
+	return symbols_.symbol(symbols_.find_near(address));
+}
 
-	auto it = symbols_by_address_.lowerBound(address);
-	if(it != symbols_by_address_.end()) {
+//------------------------------------------------------------------------------
+// Name: search
+// Desc: the symbols whose names contain <text>, or start with it if <prefix>
+//       is set. See SymbolTable::search
+//------------------------------------------------------------------------------
+void SymbolManager::search(const QString &text, bool prefix, const SearchFunction &found) const {
 
-		// not an exact match, we should backup one
-		if(address != it.value()->address) {
-			// not safe to backup!, return early
-			if(it == symbols_by_address_.begin()) {
-				return nullptr;
-			}
-			--it;
-		}
+	load_all_modules();
 
-		if(const std::shared_ptr<Symbol> sym = it.value()) {
-			if(address >= sym->address && address < sym->address + sym->size) {
-				return sym;
-			}
-		}
-	}
-
-	return nullptr;
+	symbols_.search(text, prefix, [this, &found](SymbolTable::Handle handle) {
+		return found(symbols_.symbol(handle));
+	});
 }
 
 //------------------------------------------------------------------------------
@@ -163,97 +422,95 @@ const std::shared_ptr<Symbol> SymbolManager::find_near_symbol(edb::address_t add
 //------------------------------------------------------------------------------
 void SymbolManager::add_symbol(const std::shared_ptr<Symbol> &symbol) {
 	Q_ASSERT(symbol);
-	symbols_.push_back(symbol);
-	symbols_by_address_[symbol->address] = symbol;
-	symbols_by_name_[symbol->name]       = symbol;
-	symbols_by_file_[symbol->file].push_back(symbol);
+
+	// kept as the prefix and the rest, which the name is split into if it is
+	// made of them
+	const QString suffix = QLatin1Char('!') + symbol->name_no_prefix;
+	if(symbol->name.endsWith(suffix)) {
+		symbols_.add(symbol->file, symbol->name.left(symbol->name.size() - suffix.size()), symbol->name_no_prefix.toUtf8(), symbol->address, symbol->size, symbol->type);
+	} else {
+		symbols_.add(symbol->file, QString(), symbol->name.toUtf8(), symbol->address, symbol->size, symbol->type);
+	}
+
+	// a name which was missing may be this one
+	if(!missing_names_.isEmpty()) {
+		missing_names_.clear();
+	}
+	++generation_;
 }
 
 //------------------------------------------------------------------------------
 // Name: process_symbol_file
-// Desc:
+// Desc: maps the SymbolFile <f> of <library_filename>, making it first if
+//       there is a generator
 // Note: returning false means 'try again', true means, 'we loaded what we could'
 //------------------------------------------------------------------------------
 bool SymbolManager::process_symbol_file(const QString &f, edb::address_t base, const QString &library_filename, bool allow_retry) {
 
 	// TODO(eteran): support filename starting with "http://" being fetched from a web server
 
-	QFile symbolFile(f);
-	if(symbolFile.size() == 0) {
-		symbolFile.remove();
+	const QFileInfo library_info(library_filename);
+
+	// loaded before, either by another process or before the symbols were
+	// cleared, and the module hasn't changed since
+	auto checked = checked_files_.find(f);
+	if(checked != checked_files_.end()) {
+		if(checked->size == library_info.size() && checked->modified == library_info.lastModified() && QFile::exists(f)) {
+			symbols_.add(f, QFileInfo(checked->file->path()).fileName(), checked->file, base);
+			missing_names_.clear();
+			++generation_;
+			return true;
+		}
+
+		checked_files_.erase(checked);
 	}
 
-	std::ifstream file(qPrintable(f));
-	if(file) {
+	if(QFile::exists(f)) {
 		edb::v1::set_status(QObject::tr("Loading symbols: %1").arg(f),0);
-		edb::address_t sym_start;
-		edb::address_t sym_end;
-		std::string    sym_name;
-		std::string    date;
-		std::string    md5;
-		std::string    filename;
-
-		if(std::getline(file, date)) {
-			if(file >> md5 >> filename) {
-
-				const QByteArray file_md5   = QByteArray::fromHex(md5.c_str());
-				const QByteArray actual_md5 = edb::v1::get_file_md5(library_filename);
-
-				if(file_md5 != actual_md5) {
-					qDebug() << "Your symbol file for" << library_filename << "appears to not match the actual file, perhaps you should rebuild your symbols?";
-					const Configuration &config = edb::v1::config();
-					if(config.remove_stale_symbols) {
-						symbolFile.remove();
-
-						if(allow_retry) {
-							return process_symbol_file(f, base, library_filename, false);
-						}
-
-					}
-					edb::v1::clear_status();
-					return false;
-				}
-
-				const QFileInfo info(QString::fromStdString(filename));
-				const QString prefix = info.fileName();
-				char sym_type;
-
-				while(true) {
-					file >> std::hex >> sym_start >> std::hex >> sym_end >> sym_type;
-					// For symbol name we can't use operator>>() as it may have spaces if demangled
-					// Thus, get the rest of the line as the symbol name
-					std::getline(file,sym_name);
 
-					if(!file) {
-						if(!file.eof()) qWarning() << "WARNING: File" << f << "seems corrupt";
-						break;
-					}
+		const Result<std::shared_ptr<SymbolFile>> file = SymbolFile::open(f);
+		if(!file) {
+			// one from another version of edb, or broken, is of no use to anyone
+			qWarning() << "WARNING:" << file.errorMessage();
+			QFile::remove(f);
+			edb::v1::clear_status();
 
-					auto sym = std::make_shared<Symbol>();
-
-					sym->file           = f;
-					sym->name_no_prefix = QString::fromStdString(sym_name).trimmed();
-					sym->name           = QString("%1!%2").arg(prefix, sym->name_no_prefix);
-					sym->address        = sym_start;
-					sym->size           = sym_end;
-					sym->type           = sym_type;
+			if(allow_retry) {
+				return process_symbol_file(f, base, library_filename, false);
+			}
+			return true;
+		}
 
-					// fixup the base address based on where it is loaded
-					if(sym->address < base) {
-						sym->address += base;
-					}
+		if((*file)->md5() != edb::v1::get_file_md5(library_filename)) {
+			qDebug() << "Your symbol file for" << library_filename << "appears to not match the actual file, perhaps you should rebuild your symbols?";
+			const Configuration &config = edb::v1::config();
+			if(config.remove_stale_symbols) {
+				QFile::remove(f);
 
-					add_symbol(sym);
+				if(allow_retry) {
+					edb::v1::clear_status();
+					return process_symbol_file(f, base, library_filename, false);
 				}
-				edb::v1::clear_status();
-				return true;
 			}
+			edb::v1::clear_status();
+			return false;
 		}
+
+		symbols_.add(f, QFileInfo((*file)->path()).fileName(), *file, base);
+		checked_files_.insert(f, CheckedFile{*file, library_info.size(), library_info.lastModified()});
+
+		missing_names_.clear();
+		++generation_;
+		edb::v1::clear_status();
+		return true;
 	} else if(symbol_generator_) {
 		edb::v1::set_status(QObject::tr("Auto-Generating Symbol File: %1").arg(f),0);
-		bool generatedOK=symbol_generator_->generate_symbol_file(library_filename, f);
+		const bool generated = symbol_generator_->generate_symbol_file(library_filename, f);
 		edb::v1::clear_status();
-		if(generatedOK) return false;
+
+		if(generated) {
+			return allow_retry ? process_symbol_file(f, base, library_filename, false) : false;
+		}
 	}
 
 	// TODO: should we return false and try again later?
@@ -266,7 +523,8 @@ bool SymbolManager::process_symbol_file(const QString &f, edb::address_t base, c
 // Desc:
 //------------------------------------------------------------------------------
 const QList<std::shared_ptr<Symbol>> SymbolManager::symbols() const {
-	return symbols_;
+	load_all_modules();
+	return symbols_.symbols();
 }
 
 //------------------------------------------------------------------------------
@@ -287,6 +545,7 @@ void SymbolManager::set_label(edb::address_t address, const QString &label) {
 	if(label.isEmpty()) {
 		labels_by_name_.remove(labels_[address]);
 		labels_.remove(address);
+		++generation_;
 	} else {
 
 		if(labels_by_name_.contains(label) && labels_by_name_[label] != address) {
@@ -300,12 +559,14 @@ void SymbolManager::set_label(edb::address_t address, const QString &label) {
 
 		labels_[address] = label;
 		labels_by_name_[label] = address;
+		++generation_;
 	}
 }
 
 //------------------------------------------------------------------------------
 // Name: find_address_name
-// Desc:
+// Desc: the names are remembered until the symbols change, painting asks for
+//       the same ones over and over
 //------------------------------------------------------------------------------
 QString SymbolManager::find_address_name(edb::address_t address,bool prefixed) {
 	auto it = labels_.find(address);
@@ -313,12 +574,33 @@ QString SymbolManager::find_address_name(edb::address_t address,bool prefixed) {
 		return it.value();
 	}
 
-	if(const std::shared_ptr<Symbol> sym = find(address)) {
-		return prefixed ? sym->name : sym->name_no_prefix;
+	if(address_names_generation_ != generation_ || address_names_[prefixed].size() >= MAX_ADDRESS_NAMES) {
+		address_names_[false].clear();
+		address_names_[true].clear();
+		address_names_generation_ = generation_;
 	}
 
-	return QString();
+	auto cached = address_names_[prefixed].find(address);
+	if(cached != address_names_[prefixed].end()) {
+		return cached.value();
+	}
 
+	load_module_at(address);
+
+	QString name;
+	if(const SymbolTable::Handle handle = symbols_.find(address)) {
+		name = symbols_.name(handle, prefixed);
+	}
+
+	// loading the module makes what was remembered before it out of date
+	if(address_names_generation_ != generation_) {
+		address_names_[false].clear();
+		address_names_[true].clear();
+		address_names_generation_ = generation_;
+	}
+
+	address_names_[prefixed].insert(address, name);
+	return name;
 }
 
 //------------------------------------------------------------------------------
@@ -334,5 +616,39 @@ QHash<edb::address_t, QString> SymbolManager::labels() const {
 // Desc:
 //------------------------------------------------------------------------------
 QList<QString> SymbolManager::files() const {
-	return symbols_by_file_.keys();
+	load_all_modules();
+	return symbols_.files();
+}
+
+//------------------------------------------------------------------------------
+// Name: generation
+// Desc:
+//------------------------------------------------------------------------------
+quint64 SymbolManager::generation() const {
+	return generation_;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_import
+// Desc: one lookup in the module <address> is in, whose imports are indexed
+//       the first time it is asked about. Calls through the PLT and the GOT
+//       are named this way without reading either
+//------------------------------------------------------------------------------
+QString SymbolManager::find_import(edb::address_t address) const {
+
+	auto it = imports_.upperBound(address);
+	if(it == imports_.begin()) {
+		return QString();
+	}
+
+	--it;
+	if(address >= it.value().end) {
+		return QString();
+	}
+
+	if(!it.value().indexed) {
+		index_imports(&it.value());
+	}
+
+	return it.value().names.value(address);
 }
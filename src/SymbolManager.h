@@ -20,12 +20,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SYMBOLMANAGER_20060814_H_
 
 #include "ISymbolManager.h"
+#include "SymbolTable.h"
 
+#include <QDateTime>
 #include <QHash>
 #include <QMap>
 #include <QSet>
+#include <memory>
 
 class QString;
+class SymbolFile;
 
 class SymbolManager : public ISymbolManager {
 public:
@@ -36,28 +40,68 @@ public:
 	virtual const std::shared_ptr<Symbol> find(const QString &name) const override;
 	virtual const std::shared_ptr<Symbol> find(edb::address_t address) const override;
 	virtual const std::shared_ptr<Symbol> find_near_symbol(edb::address_t address) const override;
+	virtual void search(const QString &text, bool prefix, const SearchFunction &found) const override;
 	virtual void add_symbol(const std::shared_ptr<Symbol> &symbol) override;
 	virtual void clear() override;
 	virtual void load_symbol_file(const QString &filename, edb::address_t base) override;
+	virtual void add_module(const QString &filename, edb::address_t base, edb::address_t start, edb::address_t end) override;
 	virtual void set_symbol_generator(ISymbolGenerator *generator) override;
 	virtual void set_label(edb::address_t address, const QString &label) override;
 	virtual QString find_address_name(edb::address_t address,bool prefixed=true) override;
 	virtual QHash<edb::address_t, QString> labels() const override;
 	virtual QList<QString> files() const override;
+	virtual quint64 generation() const override;
+	virtual QString find_import(edb::address_t address) const override;
 
 private:
+	struct PendingModule {
+		QString        filename;
+		edb::address_t base;
+		edb::address_t end;
+	};
+
+	// a symbol file already checked against the md5 of its module, for as
+	// long as the module stays the same. Every process debugged in the
+	// session which loads the module shares the one mapping
+	struct CheckedFile {
+		std::shared_ptr<SymbolFile> file;
+		qint64                      size;
+		QDateTime                   modified;
+	};
+
+	// the imports of a module, by the address of each stub and slot. They are
+	// read from its file the first time something in the module is asked for
+	struct ModuleImports {
+		edb::address_t                 base;
+		edb::address_t                 end;
+		bool                           indexed;
+		QHash<edb::address_t, QString> names;
+	};
+
+private:
+	QString symbol_file_name(const QString &filename);
 	bool process_symbol_file(const QString &f, edb::address_t base, const QString &library_filename, bool allow_retry);
+	void generate_symbol_files(const QList<QString> &filenames);
+	void load_modules(const QList<PendingModule> &modules) const;
+	bool load_module_at(edb::address_t address) const;
+	bool load_modules_named(const QString &name) const;
+	void load_all_modules() const;
+	void index_imports(ModuleImports *module) const;
 
 private:
 	QSet<QString>                          symbol_files_;
-	QList<std::shared_ptr<Symbol>>                 symbols_;
-	QMap<edb::address_t, std::shared_ptr<Symbol>>  symbols_by_address_;
-	QHash<QString, QList<std::shared_ptr<Symbol>>> symbols_by_file_;
-	QHash<QString, std::shared_ptr<Symbol>>        symbols_by_name_;
+	mutable QMap<edb::address_t, PendingModule> pending_modules_; // by start, added but not loaded yet
+	mutable QMap<edb::address_t, ModuleImports> imports_;         // by start
+	QHash<QString, CheckedFile>            checked_files_;   // by symbol file, kept through clear()
+	SymbolTable                            symbols_;
+	mutable QSet<QString>                  missing_names_; // looked up and not found, since the last symbol was added
 	ISymbolGenerator                      *symbol_generator_;
 	bool                                   show_path_notice_;
 	QHash<edb::address_t, QString>         labels_;
 	QHash<QString, edb::address_t>         labels_by_name_;
+	quint64                                generation_;
+	QHash<edb::address_t, QString>         address_names_[2]; // find_address_name's results, unprefixed and prefixed
+	quint64                                address_names_generation_;
 
 };
 
@@ -0,0 +1,709 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SymbolTable.h"
+#include "BytePattern.h"
+#include "Demangler.h"
+#include "Symbol.h"
+#include "SymbolFile.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// the name hash of a module starts with this many slots, a power of two, and
+// doubles whenever it would become more than half full
+const int MIN_NAME_SLOTS = 64;
+
+//------------------------------------------------------------------------------
+// Name: name_hash
+// Desc: the one the symbol files use, so a name is hashed once for all modules
+//------------------------------------------------------------------------------
+quint32 name_hash(const QByteArray &name) {
+	return SymbolFile::hash(name.constData(), name.size());
+}
+
+//------------------------------------------------------------------------------
+// Name: source_name
+// Desc: for a demangled name like "ns::vector<int>::push_back(int)", the
+//       length prefixed identifier, "9push_back", which its mangled form
+//       contains as it is. Empty if <name> isn't qualified or a function
+//------------------------------------------------------------------------------
+QByteArray source_name(const QString &name) {
+
+	int end = name.indexOf(QLatin1Char('('));
+	if(end == -1) {
+		end = name.size();
+	}
+
+	// the template arguments of the name itself
+	int last  = end;
+	int depth = 0;
+	while(last > 0) {
+		const QChar ch = name[last - 1];
+		if(ch == QLatin1Char('>')) {
+			++depth;
+		} else if(ch == QLatin1Char('<') && depth != 0) {
+			--depth;
+		} else if(depth == 0) {
+			break;
+		}
+		--last;
+	}
+
+	int first = last;
+	while(first > 0 && (name[first - 1].isLetterOrNumber() || name[first - 1] == QLatin1Char('_'))) {
+		--first;
+	}
+
+	if(first == last || (first == 0 && end == name.size())) {
+		return QByteArray();
+	}
+
+	const QByteArray identifier = name.mid(first, last - first).toUtf8();
+	return QByteArray::number(identifier.size()) + identifier;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: adds a symbol of <file>, named <prefix>!<name>, <name> being UTF-8.
+//       Names already in the module aren't stored again, and lookups by name
+//       find the first symbol added with it
+//------------------------------------------------------------------------------
+void SymbolTable::add(const QString &file, const QString &prefix, const QByteArray &name, edb::address_t address, quint32 size, char type) {
+
+	const QString key = file + QLatin1Char('\n') + prefix;
+
+	int m = modules_by_key_.value(key, -1);
+	if(m == -1) {
+		Module module;
+		module.file          = file;
+		module.prefix        = prefix;
+		module.bias          = 0;
+		module.by_name       = QVector<quint32>(MIN_NAME_SLOTS, 0);
+		module.low           = address;
+		module.high          = address;
+		module.sorted        = true;
+		module.names_indexed = false;
+
+		m = modules_.size();
+		modules_.push_back(module);
+		modules_by_key_.insert(key, m);
+		modules_by_prefix_[prefix].push_back(m);
+	}
+
+	Module &module = modules_[m];
+
+	if((module.entries.size() + 1) * 2 > module.by_name.size()) {
+		grow_names(&module);
+	}
+
+	const quint32 mask = module.by_name.size() - 1;
+
+	quint32 slot   = name_hash(name) & mask;
+	quint32 offset = 0;
+	bool interned  = false;
+
+	while(const quint32 n = module.by_name[slot]) {
+		const Entry &other = module.entries[n - 1];
+		if(qstrcmp(module.strings.constData() + other.name, name.constData()) == 0) {
+			offset   = other.name;
+			interned = true;
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	if(!interned) {
+		offset = module.strings.size();
+		module.strings.append(name);
+		module.strings.append('\0');
+	}
+
+	const Entry entry = {address, size, offset, type};
+	module.entries.push_back(entry);
+
+	if(!interned) {
+		module.by_name[slot] = module.entries.size();
+	}
+
+	module.low           = std::min(module.low, address);
+	module.high          = std::max(module.high, address);
+	module.sorted        = false;
+	module.names_indexed = false;
+	++count_;
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: adds the symbols of <file> in a mapped symbol file, named
+//       <prefix>!<name>. Like the text files did, addresses below <base> are
+//       taken to be relative to it, which is decided for the file as a whole
+//       by its lowest address so that they stay in order
+//------------------------------------------------------------------------------
+void SymbolTable::add(const QString &file, const QString &prefix, const std::shared_ptr<const SymbolFile> &symbols, edb::address_t base) {
+
+	Q_ASSERT(symbols);
+
+	if(symbols->count() == 0) {
+		return;
+	}
+
+	Module module;
+	module.file          = file;
+	module.prefix        = prefix;
+	module.mapped        = symbols;
+	module.bias          = (base > symbols->entry(0).address) ? base : edb::address_t(0);
+	module.low           = module.bias + symbols->entry(0).address;
+	module.high          = module.bias + symbols->entry(symbols->count() - 1).address;
+	module.sorted        = true;
+	module.names_indexed = false;
+
+	modules_by_prefix_[prefix].push_back(modules_.size());
+	modules_.push_back(module);
+	count_ += symbols->count();
+}
+
+//------------------------------------------------------------------------------
+// Name: grow_names
+// Desc: doubles the slots of the name hash of <module>
+//------------------------------------------------------------------------------
+void SymbolTable::grow_names(Module *module) {
+
+	Q_ASSERT(module);
+
+	QVector<quint32> table(std::max(MIN_NAME_SLOTS, module->by_name.size() * 2), 0);
+	const quint32 mask = table.size() - 1;
+
+	for(const quint32 n : module->by_name) {
+		if(n == 0) {
+			continue;
+		}
+
+		const char *const name = module->strings.constData() + module->entries[n - 1].name;
+
+		quint32 slot = SymbolFile::hash(name, std::strlen(name)) & mask;
+		while(table[slot]) {
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = n;
+	}
+
+	qSwap(module->by_name, table);
+}
+
+//------------------------------------------------------------------------------
+// Name: count
+// Desc: the number of entries <module> has
+//------------------------------------------------------------------------------
+int SymbolTable::count(const Module &module) const {
+	return module.mapped ? static_cast<int>(module.mapped->count()) : module.entries.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: entry
+// Desc: entry <index> of <module>, with its final address
+//------------------------------------------------------------------------------
+SymbolTable::Entry SymbolTable::entry(const Module &module, int index) const {
+
+	if(!module.mapped) {
+		return module.entries[index];
+	}
+
+	const SymbolFile::Entry &mapped = module.mapped->entry(index);
+
+	const Entry entry = {module.bias + mapped.address, mapped.size, mapped.name, static_cast<char>(mapped.type)};
+	return entry;
+}
+
+//------------------------------------------------------------------------------
+// Name: entry_name
+// Desc: the UTF-8 name of entry <index> of <module>
+//------------------------------------------------------------------------------
+const char *SymbolTable::entry_name(const Module &module, int index) const {
+
+	if(module.mapped) {
+		return module.mapped->name(index);
+	}
+
+	return module.strings.constData() + module.entries[index].name;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_name
+// Desc: the index of the entry of <module> named <name>, or -1
+//------------------------------------------------------------------------------
+int SymbolTable::find_name(const Module &module, const QByteArray &name, quint32 hash) const {
+
+	if(module.mapped) {
+		return module.mapped->find_name(name, hash);
+	}
+
+	const quint32 mask = module.by_name.size() - 1;
+
+	for(quint32 slot = hash & mask; const quint32 n = module.by_name[slot]; slot = (slot + 1) & mask) {
+		if(qstrcmp(module.strings.constData() + module.entries[n - 1].name, name.constData()) == 0) {
+			return n - 1;
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_mangled
+// Desc: true if the name of entry <index> of <module> is shown demangled. Only
+//       the symbol files mark names so
+//------------------------------------------------------------------------------
+bool SymbolTable::is_mangled(const Module &module, int index) const {
+	return module.mapped && (module.mapped->entry(index).flags & SymbolFile::MANGLED);
+}
+
+//------------------------------------------------------------------------------
+// Name: find_demangled
+// Desc: the index of the first entry of <module> whose demangled name is
+//       <name>, or -1. The names are kept mangled, so they can't be hashed as
+//       they are shown. Instead the arena is scanned for <source_name>, see
+//       source_name(), like search() does, and only the mangled names which
+//       contain it are demangled to be compared
+//------------------------------------------------------------------------------
+int SymbolTable::find_demangled(const Module &module, const QString &name, const QByteArray &source_name) const {
+
+	if(!module.mapped || source_name.isEmpty()) {
+		return -1;
+	}
+
+	index_names(module);
+
+	const BytePattern pattern(source_name);
+	const auto first = reinterpret_cast<const quint8 *>(module.mapped->strings());
+	const auto last  = first + module.mapped->strings_size();
+
+	for(const quint8 *hit = first; (hit = pattern.find(hit, last)); ) {
+
+		const quint8 *start = hit;
+		while(start != first && start[-1] != '\0') {
+			--start;
+		}
+
+		const char *const mangled = reinterpret_cast<const char *>(start);
+		if(Demangler::is_mangled(mangled)) {
+			const quint32 offset = start - first;
+
+			auto it = std::lower_bound(module.by_offset.begin(), module.by_offset.end(), offset, [this, &module](quint32 n, quint32 value) {
+				return entry(module, n).name < value;
+			});
+
+			for(; it != module.by_offset.end() && entry(module, *it).name == offset; ++it) {
+				if(is_mangled(module, *it)) {
+					if(Demangler::demangle(mangled) == name) {
+						return *it;
+					}
+					break;
+				}
+			}
+		}
+
+		hit = start + std::strlen(mangled) + 1;
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// Name: sort
+// Desc: brings the address order of <module> up to date. Symbols at the same
+//       address stay in the order they were added. Mapped files are in order
+//       already
+//------------------------------------------------------------------------------
+void SymbolTable::sort(const Module &module) const {
+
+	if(module.sorted) {
+		return;
+	}
+
+	module.by_address.resize(module.entries.size());
+	for(int i = 0; i < module.by_address.size(); ++i) {
+		module.by_address[i] = i;
+	}
+
+	const QVector<Entry> &entries = module.entries;
+	std::stable_sort(module.by_address.begin(), module.by_address.end(), [&entries](quint32 lhs, quint32 rhs) {
+		return entries[lhs].address < entries[rhs].address;
+	});
+
+	module.sorted = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: at
+// Desc: the index of the entry of <module> at <position> in address order
+//------------------------------------------------------------------------------
+int SymbolTable::at(const Module &module, int position) const {
+	return module.mapped ? position : static_cast<int>(module.by_address[position]);
+}
+
+//------------------------------------------------------------------------------
+// Name: upper_bound
+// Desc: the position in address order of the first entry of <module> which is
+//       above <address>
+//------------------------------------------------------------------------------
+int SymbolTable::upper_bound(const Module &module, edb::address_t address) const {
+
+	sort(module);
+
+	int first = 0;
+	int last  = count(module);
+
+	while(first < last) {
+		const int middle = first + (last - first) / 2;
+		if(address < entry(module, at(module, middle)).address) {
+			last = middle;
+		} else {
+			first = middle + 1;
+		}
+	}
+
+	return first;
+}
+
+//------------------------------------------------------------------------------
+// Name: index_names
+// Desc: brings the name offset order of <module> up to date
+//------------------------------------------------------------------------------
+void SymbolTable::index_names(const Module &module) const {
+
+	if(module.names_indexed) {
+		return;
+	}
+
+	module.by_offset.resize(count(module));
+	for(int i = 0; i < module.by_offset.size(); ++i) {
+		module.by_offset[i] = i;
+	}
+
+	std::stable_sort(module.by_offset.begin(), module.by_offset.end(), [this, &module](quint32 lhs, quint32 rhs) {
+		return entry(module, lhs).name < entry(module, rhs).name;
+	});
+
+	module.names_indexed = true;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void SymbolTable::clear() {
+	modules_.clear();
+	modules_by_key_.clear();
+	modules_by_prefix_.clear();
+	count_ = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: by the prefixed name, the most recently loaded module wins
+//------------------------------------------------------------------------------
+SymbolTable::Handle SymbolTable::find(const QString &name) const {
+
+	Handle handle;
+
+	const int bang = name.indexOf(QLatin1Char('!'));
+
+	auto it = modules_by_prefix_.find((bang == -1) ? QString() : name.left(bang));
+	if(it == modules_by_prefix_.end()) {
+		return handle;
+	}
+
+	const QString demangled     = name.mid(bang + 1);
+	const QByteArray unprefixed = demangled.toUtf8();
+	const quint32 hash          = name_hash(unprefixed);
+	const QByteArray source     = source_name(demangled);
+
+	const QList<int> &modules = it.value();
+	for(int i = modules.size() - 1; i >= 0; --i) {
+		int index = find_name(modules_[modules[i]], unprefixed, hash);
+		if(index == -1) {
+			index = find_demangled(modules_[modules[i]], demangled, source);
+		}
+
+		if(index != -1) {
+			handle.module = modules[i];
+			handle.index  = index;
+			break;
+		}
+	}
+
+	return handle;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_unprefixed
+// Desc: by the name without the prefix, the first module loaded with it wins
+//------------------------------------------------------------------------------
+SymbolTable::Handle SymbolTable::find_unprefixed(const QString &name) const {
+
+	Handle handle;
+
+	const QByteArray unprefixed = name.toUtf8();
+	const quint32 hash          = name_hash(unprefixed);
+	const QByteArray source     = source_name(name);
+
+	for(int m = 0; m < modules_.size(); ++m) {
+		int index = find_name(modules_[m], unprefixed, hash);
+		if(index == -1) {
+			index = find_demangled(modules_[m], name, source);
+		}
+
+		if(index != -1) {
+			handle.module = m;
+			handle.index  = index;
+			break;
+		}
+	}
+
+	return handle;
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: the symbol at <address>, the most recently added one if there are
+//       several
+//------------------------------------------------------------------------------
+SymbolTable::Handle SymbolTable::find(edb::address_t address) const {
+
+	Handle handle;
+
+	for(int m = modules_.size() - 1; m >= 0; --m) {
+		const Module &module = modules_[m];
+		if(address < module.low || address > module.high) {
+			continue;
+		}
+
+		const int position = upper_bound(module, address);
+		if(position != 0) {
+			const int index = at(module, position - 1);
+			if(entry(module, index).address == address) {
+				handle.module = m;
+				handle.index  = index;
+				break;
+			}
+		}
+	}
+
+	return handle;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_near
+// Desc: the closest symbol at or below <address>, if <address> is within it
+//------------------------------------------------------------------------------
+SymbolTable::Handle SymbolTable::find_near(edb::address_t address) const {
+
+	Handle handle;
+	Entry best;
+
+	for(int m = modules_.size() - 1; m >= 0; --m) {
+		const Module &module = modules_[m];
+		if(address < module.low) {
+			continue;
+		}
+
+		const int position = upper_bound(module, address);
+		if(position != 0) {
+			const int index     = at(module, position - 1);
+			const Entry nearest = entry(module, index);
+			if(!handle || nearest.address > best.address) {
+				handle.module = m;
+				handle.index  = index;
+				best          = nearest;
+			}
+		}
+	}
+
+	if(handle && address >= best.address + best.size) {
+		return Handle();
+	}
+
+	return handle;
+}
+
+//------------------------------------------------------------------------------
+// Name: search
+// Desc: calls <found> for the symbols whose names contain <text>, or start
+//       with it if <prefix> is set, module by module. A "module!" in front of
+//       the text only searches the modules whose prefix contains "module".
+//       Every name is kept once in its module's arena, so the arena itself is
+//       scanned rather than an index kept which would take several times its
+//       size. Each hit is then walked back to the start of its name and
+//       matched up with the entries which have it
+//------------------------------------------------------------------------------
+void SymbolTable::search(const QString &text, bool prefix, const SearchFunction &found) const {
+
+	const int bang             = text.indexOf(QLatin1Char('!'));
+	const QString module_part  = text.left(std::max(bang, 0));
+	const QByteArray name_part = text.mid(bang + 1).toUtf8();
+	const BytePattern pattern(name_part);
+
+	for(int m = 0; m < modules_.size(); ++m) {
+		const Module &module = modules_[m];
+		if(bang != -1 && !module.prefix.contains(module_part)) {
+			continue;
+		}
+
+		Handle handle;
+		handle.module = m;
+
+		if(name_part.isEmpty()) {
+			for(handle.index = 0; handle.index < count(module); ++handle.index) {
+				if(!found(handle)) {
+					return;
+				}
+			}
+			continue;
+		}
+
+		index_names(module);
+
+		const auto first = reinterpret_cast<const quint8 *>(module.mapped ? module.mapped->strings() : module.strings.constData());
+		const auto last  = first + (module.mapped ? module.mapped->strings_size() : module.strings.size());
+
+		for(const quint8 *hit = first; (hit = pattern.find(hit, last)); ) {
+
+			const quint8 *name = hit;
+			while(name != first && name[-1] != '\0') {
+				--name;
+			}
+
+			if(!prefix || name == hit) {
+				const quint32 offset = name - first;
+
+				auto it = std::lower_bound(module.by_offset.begin(), module.by_offset.end(), offset, [this, &module](quint32 n, quint32 value) {
+					return entry(module, n).name < value;
+				});
+
+				for(; it != module.by_offset.end() && entry(module, *it).name == offset; ++it) {
+					handle.index = *it;
+					if(!found(handle)) {
+						return;
+					}
+				}
+			}
+
+			// the rest of this name can't add anything
+			hit = name + std::strlen(reinterpret_cast<const char *>(name)) + 1;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: address
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t SymbolTable::address(Handle handle) const {
+	Q_ASSERT(handle);
+	return entry(modules_[handle.module], handle.index).address;
+}
+
+//------------------------------------------------------------------------------
+// Name: name
+// Desc:
+//------------------------------------------------------------------------------
+QString SymbolTable::name(Handle handle, bool prefixed) const {
+
+	Q_ASSERT(handle);
+
+	const Module &module  = modules_[handle.module];
+	const char *const raw = entry_name(module, handle.index);
+	const QString name    = is_mangled(module, handle.index) ? Demangler::demangle(raw) : QString::fromUtf8(raw);
+
+	if(prefixed && !module.prefix.isEmpty()) {
+		return module.prefix + QLatin1Char('!') + name;
+	}
+
+	return name;
+}
+
+//------------------------------------------------------------------------------
+// Name: symbol
+// Desc: makes a Symbol out of the compact entry
+//------------------------------------------------------------------------------
+std::shared_ptr<Symbol> SymbolTable::symbol(Handle handle) const {
+
+	if(!handle) {
+		return nullptr;
+	}
+
+	const Module &module = modules_[handle.module];
+	const Entry entry    = this->entry(module, handle.index);
+
+	auto sym = std::make_shared<Symbol>();
+	sym->file           = module.file;
+	sym->name_no_prefix = name(handle, false);
+	sym->name           = module.prefix.isEmpty() ? sym->name_no_prefix : module.prefix + QLatin1Char('!') + sym->name_no_prefix;
+	sym->address        = entry.address;
+	sym->size           = entry.size;
+	sym->type           = entry.type;
+	return sym;
+}
+
+//------------------------------------------------------------------------------
+// Name: symbols
+// Desc: all of them, in the order they were added. Every one is made anew, so
+//       this is best avoided where a lookup will do
+//------------------------------------------------------------------------------
+QList<std::shared_ptr<Symbol>> SymbolTable::symbols() const {
+
+	QList<std::shared_ptr<Symbol>> results;
+	results.reserve(count_);
+
+	for(int m = 0; m < modules_.size(); ++m) {
+		for(int i = 0; i < count(modules_[m]); ++i) {
+			Handle handle;
+			handle.module = m;
+			handle.index  = i;
+			results.push_back(symbol(handle));
+		}
+	}
+
+	return results;
+}
+
+//------------------------------------------------------------------------------
+// Name: files
+// Desc: the files symbols came from, each once
+//------------------------------------------------------------------------------
+QList<QString> SymbolTable::files() const {
+
+	QList<QString> results;
+	QSet<QString>  seen;
+
+	for(const Module &module : modules_) {
+		if(!seen.contains(module.file)) {
+			seen.insert(module.file);
+			results.push_back(module.file);
+		}
+	}
+
+	return results;
+}
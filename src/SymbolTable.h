@@ -0,0 +1,136 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SYMBOL_TABLE_20170716_H_
+#define SYMBOL_TABLE_20170716_H_
+
+#include "Types.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+class Symbol;
+class SymbolFile;
+
+// The symbols of every module, kept compactly: each module has its names
+// once each in a single arena, fixed size entries pointing into it, an array
+// of their indexes sorted by address and an open addressed hash of them by
+// name. That is a few dozen bytes a symbol where a Symbol with its strings
+// and the maps indexing it took hundreds. A module loaded from a SymbolFile
+// has all of that already, so it is used where it is mapped rather than
+// copied. Lookups give a Handle, from which the parts of the symbol are read;
+// a Symbol is only made when one is asked for, and a mangled name is only
+// demangled then. Like the rest of the symbol manager, this is only for the
+// GUI thread
+class SymbolTable {
+public:
+	// refers to a symbol until the table is cleared
+	struct Handle {
+		int module = -1;
+		int index  = -1;
+
+		explicit operator bool() const { return module != -1; }
+	};
+
+	// given each match of a search, returns false to end it
+	typedef std::function<bool(Handle)> SearchFunction;
+
+public:
+	SymbolTable() = default;
+
+public:
+	void add(const QString &file, const QString &prefix, const QByteArray &name, edb::address_t address, quint32 size, char type);
+	void add(const QString &file, const QString &prefix, const std::shared_ptr<const SymbolFile> &symbols, edb::address_t base);
+	void clear();
+
+public:
+	Handle find(const QString &name) const;
+	Handle find_unprefixed(const QString &name) const;
+	Handle find(edb::address_t address) const;
+	Handle find_near(edb::address_t address) const;
+	void search(const QString &text, bool prefix, const SearchFunction &found) const;
+
+public:
+	edb::address_t address(Handle handle) const;
+	QString name(Handle handle, bool prefixed = true) const;
+	std::shared_ptr<Symbol> symbol(Handle handle) const;
+
+public:
+	QList<std::shared_ptr<Symbol>> symbols() const;
+	QList<QString> files() const;
+
+private:
+	struct Entry {
+		edb::address_t address;
+		quint32        size;
+		quint32        name; // offset in the arena
+		char           type;
+	};
+
+	struct Module {
+		QString          file;
+		QString          prefix;
+
+		// a mapped file with the entries, or null if they are kept below
+		std::shared_ptr<const SymbolFile> mapped;
+		edb::address_t                    bias; // added to the mapped addresses
+
+		QByteArray       strings;    // the NUL terminated UTF-8 names
+		QVector<Entry>   entries;    // in the order they were added
+		QVector<quint32> by_name;    // open addressed, entry index + 1, 0 if empty
+		edb::address_t   low;        // the range the entries are in
+		edb::address_t   high;
+
+		// entry indexes in address order, rebuilt on the next lookup after an
+		// entry was added
+		mutable QVector<quint32> by_address;
+		mutable bool             sorted;
+
+		// entry indexes by the offset of their names, which is how the names
+		// found by a search are matched up with their entries. Rebuilt on the
+		// next search after an entry was added
+		mutable QVector<quint32> by_offset;
+		mutable bool             names_indexed;
+	};
+
+private:
+	int count(const Module &module) const;
+	Entry entry(const Module &module, int index) const;
+	const char *entry_name(const Module &module, int index) const;
+	int find_name(const Module &module, const QByteArray &name, quint32 hash) const;
+	int find_demangled(const Module &module, const QString &name, const QByteArray &source_name) const;
+	bool is_mangled(const Module &module, int index) const;
+	int upper_bound(const Module &module, edb::address_t address) const;
+	int at(const Module &module, int position) const;
+	void index_names(const Module &module) const;
+	void grow_names(Module *module);
+	void sort(const Module &module) const;
+
+private:
+	QVector<Module>            modules_;
+	QHash<QString, int>        modules_by_key_;    // file and prefix to the module symbols are added to
+	QHash<QString, QList<int>> modules_by_prefix_;
+	int                        count_ = 0;
+};
+
+#endif
@@ -0,0 +1,283 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TaskScheduler.h"
+#include "Configuration.h"
+#include "Instrumentation.h"
+#include "edb.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+
+struct TaskToken::State {
+	std::atomic<bool> cancelled{false};
+	std::atomic<bool> finished{false};
+	std::atomic<int>  progress{-1};
+	QString           description; // set before the task is started, then only read
+};
+
+namespace {
+
+// how often the status bar follows the tasks which have a description
+constexpr int StatusInterval = 250; // ms
+
+class ScheduledTask : public QRunnable {
+public:
+	ScheduledTask(const char *name, const TaskToken &token, const TaskScheduler::Function &function, const std::function<void()> &done)
+		: name_(name), token_(token), function_(function), done_(done) {
+	}
+
+public:
+	virtual void run() override {
+		{
+			ScopedTrace trace(name_);
+			function_(token_);
+		}
+		done_();
+	}
+
+private:
+	const char              *name_;
+	TaskToken                token_;
+	TaskScheduler::Function  function_;
+	std::function<void()>    done_;
+};
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TaskToken
+// Desc:
+//------------------------------------------------------------------------------
+TaskToken::TaskToken() : state_(std::make_shared<State>()) {
+}
+
+//------------------------------------------------------------------------------
+// Name: cancel
+// Desc: asks the task to stop, it is up to the task to notice
+//------------------------------------------------------------------------------
+void TaskToken::cancel() const {
+	state_->cancelled.store(true, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Name: cancelled
+// Desc:
+//------------------------------------------------------------------------------
+bool TaskToken::cancelled() const {
+	return state_->cancelled.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Name: finished
+// Desc:
+//------------------------------------------------------------------------------
+bool TaskToken::finished() const {
+	return state_->finished.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+// Name: progress
+// Desc:
+//------------------------------------------------------------------------------
+int TaskToken::progress() const {
+	return state_->progress.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Name: set_progress
+// Desc: called by the task itself, from any thread
+//------------------------------------------------------------------------------
+void TaskToken::set_progress(int percent) const {
+	state_->progress.store(qBound(0, percent, 100), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Name: description
+// Desc:
+//------------------------------------------------------------------------------
+QString TaskToken::description() const {
+	return state_->description;
+}
+
+//------------------------------------------------------------------------------
+// Name: TaskScheduler
+// Desc: the status bar is only touched from the GUI thread, whichever thread
+//       happens to use the scheduler first
+//------------------------------------------------------------------------------
+TaskScheduler::TaskScheduler() {
+	if(QCoreApplication *app = QCoreApplication::instance()) {
+		moveToThread(app->thread());
+	}
+
+	connect(&edb::v1::config(), SIGNAL(settingsUpdated()), SLOT(apply_settings()));
+	apply_settings();
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_settings
+// Desc: the limit is on the global pool, so that QtConcurrent keeps to it too
+//------------------------------------------------------------------------------
+void TaskScheduler::apply_settings() {
+	const int threads = edb::v1::config().max_worker_threads;
+	QThreadPool::globalInstance()->setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+//------------------------------------------------------------------------------
+// Name: max_threads
+// Desc:
+//------------------------------------------------------------------------------
+int TaskScheduler::max_threads() const {
+	return QThreadPool::globalInstance()->maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: queues <function> up, <name> is what instrumentation records it as and
+//       a non-empty <description> has it shown in the status bar
+// Note: <function> is still called if the task was cancelled before it got to
+//       run, so it can tell whoever waits on it; it should check cancelled()
+//       first
+//------------------------------------------------------------------------------
+TaskToken TaskScheduler::start(const char *name, Priority priority, const QString &description, const Function &function) {
+
+	Q_ASSERT(function);
+
+	TaskToken token;
+	token.state_->description = description;
+
+	{
+		QMutexLocker locker(&lock_);
+		running_.push_back(token);
+
+		if(!description.isEmpty() && !status_scheduled_) {
+			status_scheduled_ = true;
+			QMetaObject::invokeMethod(this, "update_status", Qt::QueuedConnection);
+		}
+	}
+
+	QThreadPool::globalInstance()->start(new ScheduledTask(name, token, function, [this, token]() { finished(token); }), priority);
+	return token;
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: like start, with a future which is finished once the task is
+//------------------------------------------------------------------------------
+QFuture<void> TaskScheduler::run(const char *name, Priority priority, const QString &description, const Function &function, TaskToken *token) {
+
+	QFutureInterface<void> future;
+	future.reportStarted();
+
+	const TaskToken started = start(name, priority, description, [future, function](const TaskToken &token) mutable {
+		if(!token.cancelled()) {
+			function(token);
+		}
+		future.reportFinished();
+	});
+
+	if(token) {
+		*token = started;
+	}
+	return future.future();
+}
+
+//------------------------------------------------------------------------------
+// Name: cancel_all
+// Desc: asks every task which hasn't finished yet to stop
+//------------------------------------------------------------------------------
+void TaskScheduler::cancel_all() {
+	QMutexLocker locker(&lock_);
+	for(const TaskToken &token : running_) {
+		token.cancel();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: finished
+// Desc: called on the worker thread, once the task's function returned
+//------------------------------------------------------------------------------
+void TaskScheduler::finished(const TaskToken &token) {
+	QMutexLocker locker(&lock_);
+	token.state_->finished.store(true, std::memory_order_release);
+
+	for(auto it = running_.begin(); it != running_.end(); ++it) {
+		if(it->state_ == token.state_) {
+			running_.erase(it);
+			break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: update_status
+// Desc: shows the oldest running task with a description, and how many more
+//       there are, for as long as there are any
+//------------------------------------------------------------------------------
+void TaskScheduler::update_status() {
+
+	QString text;
+
+	{
+		QMutexLocker locker(&lock_);
+
+		const TaskToken *shown = nullptr;
+		int others = 0;
+		for(const TaskToken &token : running_) {
+			if(!token.state_->description.isEmpty()) {
+				if(shown) {
+					++others;
+				} else {
+					shown = &token;
+				}
+			}
+		}
+
+		if(shown) {
+			text = shown->description();
+
+			const int progress = shown->progress();
+			if(progress >= 0) {
+				text = tr("%1... %2%").arg(text).arg(progress);
+			} else {
+				text = tr("%1...").arg(text);
+			}
+
+			if(others != 0) {
+				text = tr("%1 (and %2 more)").arg(text).arg(others);
+			}
+		}
+
+		status_scheduled_ = !text.isEmpty();
+	}
+
+	if(!text.isEmpty()) {
+		status_shown_ = true;
+		edb::v1::set_status(text, 0);
+		QTimer::singleShot(StatusInterval, this, SLOT(update_status()));
+	} else if(status_shown_) {
+		status_shown_ = false;
+		edb::v1::clear_status();
+	}
+}
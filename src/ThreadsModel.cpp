@@ -35,11 +35,8 @@ QModelIndex ThreadsModel::index(int row, int column, const QModelIndex &parent)
 		return QModelIndex();
 	}
 
-	if(row >= 0) {
-		return createIndex(row, column, const_cast<Item *>(&items_[row]));
-	} else {
-		return createIndex(row, column);
-	}
+	// rows come and go as threads do, so the index doesn't point into items_
+	return createIndex(row, column);
 }
 
 QModelIndex ThreadsModel::parent(const QModelIndex &index) const {
@@ -51,9 +48,9 @@ QVariant ThreadsModel::data(const QModelIndex &index, int role) const {
 
 	if(index.isValid()) {
 
-		const Item &item = items_[index.row()];
-
 		if(role == Qt::DisplayRole) {
+			const Item &item = fetch(index.row());
+
 			switch(index.column()) {
 			case 0:
 				if(item.current) {
@@ -62,24 +59,27 @@ QVariant ThreadsModel::data(const QModelIndex &index, int role) const {
 					return QVariant::fromValue(item.thread->tid());
 				}
 			case 1:
-				return item.thread->priority();
+				return item.priority;
 			case 2:
 				{
 					const QString default_region_name;
-					const QString symname = edb::v1::find_function_symbol(item.thread->instruction_pointer(), default_region_name);
+					const QString symname = edb::v1::find_function_symbol(item.instruction_pointer, default_region_name);
 
 					if(!symname.isEmpty()) {
-						return QString("%1 <%2>").arg(edb::v1::format_pointer(item.thread->instruction_pointer()), symname);
+						return QString("%1 <%2>").arg(edb::v1::format_pointer(item.instruction_pointer), symname);
 					} else {
-						return QString("%1").arg(edb::v1::format_pointer(item.thread->instruction_pointer()));
+						return QString("%1").arg(edb::v1::format_pointer(item.instruction_pointer));
 					}
 				}
 			case 3:
-				return item.thread->runState();
+				return item.run_state;
 			case 4:
-				return item.thread->name();
+				return item.name;
 			}
-		} else if(role == Qt::UserRole) {
+		}
+
+		const Item &item = items_[index.row()];
+		if(role == Qt::UserRole) {
 			return QVariant::fromValue(item.thread->tid());
 		}
 	}
@@ -120,15 +120,114 @@ int ThreadsModel::rowCount(const QModelIndex &parent) const {
 void ThreadsModel::addThread(const std::shared_ptr<IThread> &thread, bool current) {
 	beginInsertRows(QModelIndex(), rowCount(), rowCount());
 
-	const Item item = {
-		thread, current
-	};
+	Item item;
+	item.thread  = thread;
+	item.current = current;
+	item.fetched = false;
+
+	rows_.insert(thread->tid(), items_.size());
 	items_.push_back(item);
 	endInsertRows();
 }
 
+// brings the rows in line with <threads>. The ones which exited are removed and
+// the new ones appended, everything else stays where it is (and selected, if it
+// was) and is read again when it's next shown
+void ThreadsModel::update(const QList<std::shared_ptr<IThread>> &threads, const std::shared_ptr<IThread> &current) {
+
+	QHash<edb::tid_t, std::shared_ptr<IThread>> live;
+	live.reserve(threads.size());
+	for(const std::shared_ptr<IThread> &thread : threads) {
+		live.insert(thread->tid(), thread);
+	}
+
+	// from the back, a run of exited threads at a time, so the rows in front
+	// of each run keep their numbers
+	int row = items_.size() - 1;
+	while(row >= 0) {
+		if(live.contains(items_[row].thread->tid())) {
+			--row;
+			continue;
+		}
+
+		int first = row;
+		while(first > 0 && !live.contains(items_[first - 1].thread->tid())) {
+			--first;
+		}
+
+		beginRemoveRows(QModelIndex(), first, row);
+		items_.remove(first, row - first + 1);
+		endRemoveRows();
+		row = first - 1;
+	}
+
+	rows_.clear();
+	for(int i = 0; i < items_.size(); ++i) {
+		Item &item = items_[i];
+		item.thread  = live.value(item.thread->tid());
+		item.current = item.thread == current;
+		item.fetched = false;
+		rows_.insert(item.thread->tid(), i);
+	}
+
+	if(!items_.isEmpty()) {
+		Q_EMIT dataChanged(index(0, 0), index(items_.size() - 1, columnCount() - 1));
+	}
+
+	// the new ones, in the order the process lists them
+	QList<std::shared_ptr<IThread>> created;
+	for(const std::shared_ptr<IThread> &thread : threads) {
+		if(!rows_.contains(thread->tid())) {
+			created.push_back(thread);
+		}
+	}
+
+	if(!created.isEmpty()) {
+		beginInsertRows(QModelIndex(), items_.size(), items_.size() + created.size() - 1);
+		for(const std::shared_ptr<IThread> &thread : created) {
+			Item item;
+			item.thread  = thread;
+			item.current = thread == current;
+			item.fetched = false;
+
+			rows_.insert(thread->tid(), items_.size());
+			items_.push_back(item);
+		}
+		endInsertRows();
+	}
+}
+
+// the item in <row>, with what is shown of its thread read in
+const ThreadsModel::Item &ThreadsModel::fetch(int row) const {
+
+	const Item &item = items_[row];
+
+	if(!item.fetched) {
+		item.priority            = item.thread->priority();
+		item.instruction_pointer = item.thread->instruction_pointer();
+		item.run_state           = item.thread->runState();
+		item.name                = item.thread->name();
+		item.fetched             = true;
+	}
+
+	return item;
+}
+
+std::shared_ptr<IThread> ThreadsModel::thread(const QModelIndex &index) const {
+	if(!index.isValid() || index.row() >= items_.size()) {
+		return nullptr;
+	}
+
+	return items_[index.row()].thread;
+}
+
 void ThreadsModel::clear() {
-	beginRemoveRows(QModelIndex(), 0, rowCount());
+	if(items_.isEmpty()) {
+		return;
+	}
+
+	beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
 	items_.clear();
+	rows_.clear();
 	endRemoveRows();
 }
@@ -0,0 +1,88 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TraceLog.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Name: TraceLog
+// Desc:
+//------------------------------------------------------------------------------
+TraceLog::TraceLog(int capacity) : capacity_(std::max(capacity, 1)), next_sequence_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: append
+// Desc: returns the record for a new hit, with its sequence number filled in.
+//       Once the ring is full this reuses the slot of the oldest record
+//------------------------------------------------------------------------------
+TraceRecord &TraceLog::append() {
+
+	const quint64 sequence = next_sequence_++;
+
+	if(ring_.size() < capacity_) {
+		ring_.push_back(TraceRecord());
+		TraceRecord &record = ring_.back();
+		record.sequence = sequence;
+		return record;
+	}
+
+	TraceRecord &record = ring_[sequence % capacity_];
+	record.sequence  = sequence;
+	record.has_value = false;
+	record.has_state = false;
+	return record;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void TraceLog::clear() {
+	ring_.clear();
+	next_sequence_ = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_capacity
+// Desc: changing the capacity discards what was recorded so far
+//------------------------------------------------------------------------------
+void TraceLog::set_capacity(int capacity) {
+	clear();
+	capacity_ = std::max(capacity, 1);
+}
+
+//------------------------------------------------------------------------------
+// Name: records
+// Desc: returns the records, oldest first
+//------------------------------------------------------------------------------
+QVector<TraceRecord> TraceLog::records() const {
+
+	QVector<TraceRecord> ret;
+	ret.reserve(ring_.size());
+
+	// until the ring wraps, the oldest record is the first one
+	const int oldest = (ring_.size() < capacity_) ? 0 : static_cast<int>(next_sequence_ % capacity_);
+
+	for(int i = 0; i < ring_.size(); ++i) {
+		ret.push_back(ring_[(oldest + i) % ring_.size()]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,271 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ViewSearch.h"
+#include "Configuration.h"
+#include "IDebugger.h"
+#include "IProcess.h"
+#include "IRegion.h"
+#include "MemoryRange.h"
+#include "RegionScanner.h"
+#include "edb.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Name: ViewSearch
+// Desc:
+//------------------------------------------------------------------------------
+ViewSearch::ViewSearch(const QSharedPointer<QHexView::CommentServerInterface> &comments, int row_width) : comments_(comments), row_width_(row_width) {
+	connect(&reader_, SIGNAL(finished()), SLOT(window_read()));
+}
+
+//------------------------------------------------------------------------------
+// Name: set_comment
+// Desc:
+//------------------------------------------------------------------------------
+void ViewSearch::set_comment(QHexView::address_t address, const QString &comment) {
+	if(comments_) {
+		comments_->set_comment(address, comment);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void ViewSearch::clear() {
+	if(comments_) {
+		comments_->clear();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: comment
+// Desc: marks the row if any of the matches listed so far start in it
+//------------------------------------------------------------------------------
+QString ViewSearch::comment(QHexView::address_t address, int size) const {
+
+	const QString text = comments_ ? comments_->comment(address, size) : QString();
+
+	if(matches_.isEmpty() || size <= 0) {
+		return text;
+	}
+
+	const int row_size = size * (row_width_ != 0 ? row_width_ : edb::v1::config().data_row_width);
+
+	const edb::address_t row = address;
+	auto first = std::lower_bound(matches_.begin(), matches_.end(), row);
+	auto last  = std::lower_bound(first, matches_.end(), row + row_size);
+
+	const int count = static_cast<int>(last - first);
+	if(count == 0) {
+		return text;
+	}
+
+	const QString mark = (count == 1) ? tr("[match]") : tr("[%1 matches]").arg(count);
+	return text.isEmpty() ? mark : QString("%1  %2").arg(mark, text);
+}
+
+//------------------------------------------------------------------------------
+// Name: set_pattern
+// Desc: what the next find looks for, see BytePattern for <mask>
+//------------------------------------------------------------------------------
+void ViewSearch::set_pattern(const QByteArray &bytes, const QByteArray &mask) {
+	bytes_          = bytes;
+	pattern_        = BytePattern(bytes, mask);
+	has_last_match_ = false;
+	invalidate();
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate
+// Desc: forgets the matches, a listing which is still being read is dropped
+//------------------------------------------------------------------------------
+void ViewSearch::invalidate() {
+
+	const bool had_matches = !matches_.isEmpty();
+
+	++generation_;
+	matches_.clear();
+	listing_  = false;
+	complete_ = false;
+
+	if(had_matches) {
+		Q_EMIT matches_changed();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: find_next
+// Desc: the first match in <region> which starts at or after <from>
+//------------------------------------------------------------------------------
+Result<edb::address_t> ViewSearch::find_next(const std::shared_ptr<IRegion> &region, edb::address_t from) {
+
+	if(pattern_.isEmpty() || !region) {
+		return Result<edb::address_t>(tr("Nothing to search for"), 0);
+	}
+
+	if(region->start() != start_ || region->end() != end_) {
+		start_ = region->start();
+		end_   = region->end();
+		invalidate();
+	}
+
+	if(!listing_ && !complete_) {
+		start_listing();
+	}
+
+	from = std::max(from, start_);
+
+	// the list holds every match which starts ahead of where the listing got,
+	// anything it has past <from> is the answer
+	auto it = std::lower_bound(matches_.begin(), matches_.end(), from);
+	if(it != matches_.end()) {
+		return found(*it);
+	}
+
+	if(complete_ && matches_.size() < MaxMatches) {
+		return Result<edb::address_t>(tr("No more matches"), 0);
+	}
+
+	// otherwise scan on from where the listing got, no further than the
+	// next match
+	const std::size_t overlap = pattern_.size() - 1;
+
+	edb::address_t scan_from = from;
+	if(listed_ > start_ + overlap) {
+		scan_from = std::max(from, listed_ - overlap);
+	}
+
+	RegionScanner scanner(scan_from, end_, overlap);
+	while(scanner.next()) {
+		const quint8 *const first = scanner.data();
+		if(const quint8 *p = pattern_.find(first, first + scanner.size())) {
+			return found(scanner.address() + static_cast<std::size_t>(p - first));
+		}
+	}
+
+	return Result<edb::address_t>(tr("No more matches"), 0);
+}
+
+//------------------------------------------------------------------------------
+// Name: found
+// Desc: remembers <match> as where find next goes on from
+//------------------------------------------------------------------------------
+Result<edb::address_t> ViewSearch::found(edb::address_t match) {
+	last_match_     = match;
+	has_last_match_ = true;
+	return Result<edb::address_t>(match);
+}
+
+//------------------------------------------------------------------------------
+// Name: describe
+// Desc: for the status bar, where <match> is among all of them if that is
+//       known yet
+//------------------------------------------------------------------------------
+QString ViewSearch::describe(edb::address_t match) const {
+
+	if(complete_ && matches_.size() < MaxMatches) {
+		auto it = std::lower_bound(matches_.begin(), matches_.end(), match);
+		if(it != matches_.end() && *it == match) {
+			return tr("Match %1 of %2 at %3").arg(it - matches_.begin() + 1).arg(matches_.size()).arg(edb::v1::format_pointer(match));
+		}
+	}
+
+	return tr("Match at %1").arg(edb::v1::format_pointer(match));
+}
+
+//------------------------------------------------------------------------------
+// Name: start_listing
+// Desc:
+//------------------------------------------------------------------------------
+void ViewSearch::start_listing() {
+	listing_ = true;
+	listed_  = start_;
+	matches_.clear();
+	read_window();
+}
+
+//------------------------------------------------------------------------------
+// Name: read_window
+// Desc: asks for the next window of the listing, overlapping the previous one
+//       so that no match is split between them
+//------------------------------------------------------------------------------
+void ViewSearch::read_window() {
+
+	IProcess *process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!process) {
+		listing_ = false;
+		return;
+	}
+
+	if(listed_ >= end_ || matches_.size() >= MaxMatches) {
+		listing_  = false;
+		complete_ = true;
+		Q_EMIT matches_changed();
+		return;
+	}
+
+	const std::size_t overlap = std::min<quint64>(pattern_.size() - 1, (listed_ - start_).toUint());
+
+	window_            = listed_ - overlap;
+	window_size_       = std::min<quint64>(RegionScanner::DefaultWindowSize, (end_ - listed_).toUint()) + overlap;
+	reader_generation_ = generation_;
+	reader_.setFuture(process->read_async(QVector<MemoryRange>() << MemoryRange{window_, window_size_}));
+}
+
+//------------------------------------------------------------------------------
+// Name: window_read
+// Desc: adds the matches of the window which came in and goes on to the next
+//------------------------------------------------------------------------------
+void ViewSearch::window_read() {
+
+	// invalidated since it was asked for
+	if(reader_generation_ != generation_ || !listing_) {
+		return;
+	}
+
+	const QVector<QByteArray> results = reader_.result();
+	const QByteArray bytes            = results.isEmpty() ? QByteArray() : results.front();
+
+	auto first = reinterpret_cast<const quint8 *>(bytes.constData());
+	auto last  = first + bytes.size();
+
+	for(const quint8 *p = first; (p = pattern_.find(p, last)); ++p) {
+		matches_.push_back(window_ + static_cast<std::size_t>(p - first));
+		if(matches_.size() == MaxMatches) {
+			// the list ends with this match, scanning goes on right after it
+			listed_ = matches_.back() + pattern_.size();
+			read_window();
+			return;
+		}
+	}
+
+	if(static_cast<std::size_t>(bytes.size()) == window_size_) {
+		listed_ = window_ + window_size_;
+	} else {
+		// something unreadable, skip the page it is in
+		const edb::address_t page_size = edb::v1::debugger_core->page_size();
+		const edb::address_t stopped   = std::max(window_ + bytes.size(), listed_);
+		listed_ = stopped - (stopped % page_size) + page_size;
+	}
+
+	Q_EMIT matches_changed();
+	read_window();
+}
@@ -0,0 +1,105 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VIEW_SEARCH_20171014_H_
+#define VIEW_SEARCH_20171014_H_
+
+#include "BytePattern.h"
+#include "QHexView"
+#include "Status.h"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+class IRegion;
+
+// Find and find next within the region a hex view shows. The next match
+// after the cursor is looked for straight away, a window at a time, and
+// nothing past it is read. Meanwhile the list of all the matches in the
+// region is put together in the background from asynchronous reads; once it
+// is complete find next is a lookup. The rows with a match are marked in
+// the view's comment column, ahead of the comments of the comment server it
+// stands in front of.
+//
+// The matches only hold until the debuggee runs or is written to, after
+// invalidate() the list is put together again on the next find
+class ViewSearch : public QObject, public QHexView::CommentServerInterface {
+	Q_OBJECT
+public:
+	// the list stops here, find next goes back to scanning past its end
+	static constexpr int MaxMatches = 0x10000;
+
+public:
+	// <row_width> is in words, 0 for the configured width of the data views
+	ViewSearch(const QSharedPointer<QHexView::CommentServerInterface> &comments, int row_width);
+	virtual ~ViewSearch() = default;
+
+public:
+	virtual void set_comment(QHexView::address_t address, const QString &comment);
+	virtual QString comment(QHexView::address_t address, int size) const;
+	virtual void clear();
+
+public:
+	const QByteArray &bytes() const   { return bytes_; }
+	bool isEmpty() const              { return pattern_.isEmpty(); }
+	bool has_last_match() const       { return has_last_match_; }
+	edb::address_t last_match() const { return last_match_; }
+	void set_pattern(const QByteArray &bytes, const QByteArray &mask);
+	Result<edb::address_t> find_next(const std::shared_ptr<IRegion> &region, edb::address_t from);
+	QString describe(edb::address_t match) const;
+	void invalidate();
+
+Q_SIGNALS:
+	void matches_changed();
+
+private Q_SLOTS:
+	void window_read();
+
+private:
+	Result<edb::address_t> found(edb::address_t match);
+	void start_listing();
+	void read_window();
+
+private:
+	QSharedPointer<QHexView::CommentServerInterface> comments_;
+	int                                 row_width_;
+	QByteArray                          bytes_;
+	BytePattern                         pattern_;
+	edb::address_t                      last_match_        = 0; // what find_next last found
+	bool                                has_last_match_    = false;
+	edb::address_t                      start_             = 0; // the region searched
+	edb::address_t                      end_               = 0;
+	QVector<edb::address_t>             matches_;               // sorted, as far as the listing got
+	edb::address_t                      listed_            = 0; // where the listing goes on from
+	bool                                listing_           = false;
+	bool                                complete_          = false;
+	quint64                             generation_        = 0; // bumped by invalidate()
+	QFutureWatcher<QVector<QByteArray>> reader_;
+	quint64                             reader_generation_ = 0; // of what reader_ is reading
+	edb::address_t                      window_            = 0;
+	std::size_t                         window_size_       = 0;
+};
+
+#endif
@@ -227,9 +227,15 @@ bool ArchProcessor::is_filling(const edb::Instruction &inst) const {
 }
 
 void ArchProcessor::reset() {
+	invalidate_instruction_info();
+}
+
+void ArchProcessor::invalidate_instruction_info() {
+	++epoch_;
 }
 
 void ArchProcessor::about_to_resume() {
+	invalidate_instruction_info();
 	getModel().saveValues();
 }
 
@@ -246,25 +252,19 @@ QString pcComment(Register const& reg, QString const& default_region_name) {
 	return symname.isEmpty() ? symname : '<'+symname+'>';
 }
 
-QString gprComment(Register const& reg) {
-
-	QString regString;
-	int stringLength;
-	QString comment;
-	if(edb::v1::get_ascii_string_at_address(reg.valueAsAddress(), regString, edb::v1::config().min_string_length, 256, stringLength))
-		comment=QString("ASCII \"%1\"").arg(regString);
-	else if(edb::v1::get_utf16_string_at_address(reg.valueAsAddress(), regString, edb::v1::config().min_string_length, 256, stringLength))
-		comment=QString("UTF16 \"%1\"").arg(regString);
-	return comment;
-}
-
 void updateGPRs(RegisterViewModel& model, State const& state, QString const& default_region_name) {
+	// the strings the registers point to are looked for with one read
+	QVector<edb::address_t> addresses;
+	for(std::size_t i=0;i<GPR_COUNT;++i)
+		addresses.push_back(state.gp_register(i).valueAsAddress());
+	const QVector<QString> strings=edb::v1::get_human_strings_at_addresses(addresses);
+
 	for(std::size_t i=0;i<GPR_COUNT;++i) {
 		const auto reg=state.gp_register(i);
 		Q_ASSERT(!!reg); Q_ASSERT(reg.bitSize()==32);
 		QString comment;
 		if(i!=15)
-			comment=gprComment(reg);
+			comment=strings[i];
 		else
 			comment=pcComment(reg,default_region_name);
 		model.updateGPR(i,reg.value<edb::value32>(),comment);
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "FloatX.h"
 #include "IDebugger.h"
 #include "IProcess.h"
+#include "ISymbolManager.h"
 #include "Instruction.h"
 #include "Prototype.h"
 #include "RegisterViewModel.h"
@@ -31,12 +32,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QApplication>
 #include <QDebug>
-#include <QDomDocument>
 #include <QFile>
+#include <QHash>
 #include <QMenu>
 #include <QSignalMapper>
 #include <QVector>
-#include <QXmlQuery>
+#include <QXmlStreamReader>
 
 #include <cctype>
 #include <climits>
@@ -368,10 +369,10 @@ QString format_argument(const QString &type, const Register& arg) {
 }
 
 //------------------------------------------------------------------------------
-// Name: resolve_function_parameters
-// Desc:
+// Name: resolve_function_arguments
+// Desc: the arguments <func_name> is called with, if its prototype is known
 //------------------------------------------------------------------------------
-void resolve_function_parameters(const State &state, const QString &symname, int offset, QStringList &ret) {
+void resolve_function_arguments(const State &state, const QString &func_name, int offset, QStringList &ret) {
 
 	/*
 	 * The calling convention of the AMD64 application binary interface is
@@ -396,21 +397,7 @@ void resolve_function_parameters(const State &state, const QString &symname, int
 
 	const std::vector<const char *> &parameter_registers = (debuggeeIs64Bit() ? parameter_registers_x64 : parameter_registers_x86);
 
-	static const QString prefix(QLatin1String("!"));
-
 	if(IProcess *process = edb::v1::debugger_core->process()) {
-		// we will always be removing the last 2 chars '+0' from the string as well
-		// as chopping the region prefix we like to prepend to symbols
-		QString func_name;
-		const int colon_index = symname.indexOf(prefix);
-
-		if(colon_index != -1) {
-			func_name = symname.left(symname.length() - 2).mid(colon_index + prefix.size());
-		}
-
-		// safe not to check for -1, it means 'rest of string' for the mid function
-		func_name = func_name.mid(0, func_name.indexOf("@"));
-
 		if(const edb::Prototype *const info = edb::v1::get_function_info(func_name)) {
 
 			QStringList arguments;
@@ -438,6 +425,27 @@ void resolve_function_parameters(const State &state, const QString &symname, int
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: resolve_function_parameters
+// Desc:
+//------------------------------------------------------------------------------
+void resolve_function_parameters(const State &state, const QString &symname, int offset, QStringList &ret) {
+
+	static const QString prefix(QLatin1String("!"));
+
+	// we will always be removing the last 2 chars '+0' from the string as well
+	// as chopping the region prefix we like to prepend to symbols
+	QString func_name;
+	const int colon_index = symname.indexOf(prefix);
+
+	if(colon_index != -1) {
+		func_name = symname.left(symname.length() - 2).mid(colon_index + prefix.size());
+	}
+
+	// safe not to check for -1, it means 'rest of string' for the mid function
+	resolve_function_arguments(state, func_name.mid(0, func_name.indexOf("@")), offset, ret);
+}
+
 //------------------------------------------------------------------------------
 // Name: is_jcc_taken
 // Desc:
@@ -581,6 +589,19 @@ void analyze_call(const State &state, const edb::Instruction &inst, QStringList
 			if(!ok) return;
 			const auto temp_operand = QString::fromStdString(edb::v1::formatter().to_string(operand));
 
+			// a call to a PLT stub, or through a GOT slot, is named by the
+			// import index without decoding the stub or reading the slot
+			const QString import = edb::v1::symbol_manager().find_import(effective_address);
+			if(import.endsWith(is_expression(operand) ? QLatin1String("@got") : QLatin1String("@plt"))) {
+				if(is_expression(operand)) {
+					ret << QString("%1 = [%2] <%3>").arg(temp_operand, edb::v1::format_pointer(effective_address), import);
+				} else {
+					ret << QString("%1 = %2 <%3>").arg(temp_operand, edb::v1::format_pointer(effective_address), import);
+				}
+
+				resolve_function_arguments(state, import.left(import.indexOf(QLatin1Char('@'))), is_call(inst) ? 0 : 4, ret);
+				return;
+			}
 
 			if(is_immediate(operand)) {
 				int offset;
@@ -887,6 +908,88 @@ void analyze_jump_targets(const edb::Instruction &inst, QStringList &ret) {
 	}
 }
 
+#ifdef Q_OS_LINUX
+struct SyscallArgument {
+	QString type;
+	QString reg;
+};
+
+struct Syscall {
+	QString                  name;
+	QVector<SyscallArgument> arguments;
+};
+
+//------------------------------------------------------------------------------
+// Name: load_syscall_table
+// Desc: every syscall of syscalls.xml, by architecture and number
+//------------------------------------------------------------------------------
+QHash<QPair<QString, int>, Syscall> load_syscall_table() {
+
+	QHash<QPair<QString, int>, Syscall> table;
+
+	QFile file(":/debugger/xml/syscalls.xml");
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return table;
+	}
+
+	QXmlStreamReader xml(&file);
+	QString arch;
+	Syscall syscall;
+	int     index      = -1;
+	bool    in_syscall = false;
+
+	while(!xml.atEnd()) {
+		switch(xml.readNext()) {
+		case QXmlStreamReader::StartElement:
+			if(xml.name() == QLatin1String("linux")) {
+				arch = xml.attributes().value("arch").toString();
+			} else if(xml.name() == QLatin1String("syscall")) {
+				syscall      = Syscall();
+				syscall.name = xml.attributes().value("name").toString();
+				index        = -1;
+				in_syscall   = true;
+			} else if(in_syscall && xml.name() == QLatin1String("index")) {
+				bool ok;
+				index = xml.readElementText().trimmed().toInt(&ok, 0);
+				if(!ok) {
+					index = -1;
+				}
+			} else if(in_syscall && xml.name() == QLatin1String("argument")) {
+				const QXmlStreamAttributes attributes = xml.attributes();
+				syscall.arguments.push_back(SyscallArgument{attributes.value("type").toString(), attributes.value("register").toString()});
+			}
+			break;
+		case QXmlStreamReader::EndElement:
+			if(in_syscall && xml.name() == QLatin1String("syscall")) {
+				if(index != -1) {
+					table.insert(qMakePair(arch, index), syscall);
+				}
+				in_syscall = false;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if(xml.hasError()) {
+		qDebug() << "error reading syscalls.xml:" << xml.errorString();
+	}
+
+	return table;
+}
+
+//------------------------------------------------------------------------------
+// Name: syscall_table
+// Desc: read the first time a syscall is analyzed, instead of querying the
+//       whole document for every one
+//------------------------------------------------------------------------------
+const QHash<QPair<QString, int>, Syscall> &syscall_table() {
+	static const QHash<QPair<QString, int>, Syscall> table = load_syscall_table();
+	return table;
+}
+#endif
+
 //------------------------------------------------------------------------------
 // Name: analyze_syscall
 // Desc:
@@ -900,30 +1003,15 @@ void analyze_syscall(const State &state, const edb::Instruction &inst, QStringLi
 	const bool isX32=regAX & __X32_SYSCALL_BIT;
 	regAX &= ~__X32_SYSCALL_BIT;
 
-	QString syscall_entry;
-	QDomDocument syscall_xml;
-	QFile file(":/debugger/xml/syscalls.xml");
-	if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-
-		QXmlQuery query;
-		query.setFocus(&file);
-		const QString arch = debuggeeIs64Bit() ? "x86-64" : "x86";
-		query.setQuery(QString("syscalls[@version='1.0']/linux[@arch='"+arch+"']/syscall[index=%1]").arg(regAX));
-		if (query.isValid()) {
-			query.evaluateTo(&syscall_entry);
-		}
-		file.close();
-	}
-
-	if(!syscall_entry.isEmpty()) {
-		syscall_xml.setContent("" + syscall_entry + "");
-		QDomElement root = syscall_xml.documentElement();
+	const QString arch = debuggeeIs64Bit() ? "x86-64" : "x86";
+	const auto syscall = syscall_table().find(qMakePair(arch, static_cast<int>(regAX)));
 
+	if(syscall != syscall_table().end()) {
 		QStringList arguments;
 
-		for (QDomElement argument = root.firstChildElement("argument"); !argument.isNull(); argument = argument.nextSiblingElement("argument")) {
-			const QString argument_type     = argument.attribute("type");
-			const QString argument_register = argument.attribute("register");
+		for(const SyscallArgument &argument : syscall->arguments) {
+			const QString &argument_type     = argument.type;
+			const QString &argument_register = argument.reg;
 			if(argument_register=="ebp" && inst.operation()==X86_INS_SYSENTER) {
 				if(IProcess *process = edb::v1::debugger_core->process()) {
 					char buf[4];
@@ -959,7 +1047,7 @@ void analyze_syscall(const State &state, const edb::Instruction &inst, QStringLi
 			}
 		}
 
-		ret << ArchProcessor::tr("SYSCALL: %1%2(%3)").arg(isX32?"x32:":"",root.attribute("name"), arguments.join(","));
+		ret << ArchProcessor::tr("SYSCALL: %1%2(%3)").arg(isX32?"x32:":"",syscall->name, arguments.join(","));
 	}
 #endif
 }
@@ -1107,28 +1195,40 @@ void ArchProcessor::setup_register_view() {
 //------------------------------------------------------------------------------
 void ArchProcessor::reset() {
 
+	invalidate_instruction_info();
+
 	if(edb::v1::debugger_core) {
 		update_register_view(QString(), State());
 	}
 }
 
-QString gprComment(const Register& reg)
-{
-	QString regString;
-	int stringLength;
-	QString comment;
-	if(edb::v1::get_ascii_string_at_address(reg.valueAsAddress(), regString, edb::v1::config().min_string_length, 256, stringLength))
-		comment=QString("ASCII \"%1\"").arg(regString);
-	else if(edb::v1::get_utf16_string_at_address(reg.valueAsAddress(), regString, edb::v1::config().min_string_length, 256, stringLength))
-		comment=QString("UTF16 \"%1\"").arg(regString);
-	return comment;
-}
+// the strings the GPRs point to, looked for once the first of them is shown,
+// and then for all of them with one read
+class GPRStrings {
+public:
+	explicit GPRStrings(const State& state, std::size_t count) {
+		for(std::size_t i=0;i<count;++i)
+			addresses_.push_back(state.gp_register(i).valueAsAddress());
+	}
+
+	QString comment(std::size_t i) {
+		if(strings_.isEmpty())
+			strings_=edb::v1::get_human_strings_at_addresses(addresses_);
+		return strings_[i];
+	}
+
+private:
+	QVector<edb::address_t> addresses_;
+	QVector<QString>        strings_;
+};
 
 RegisterViewModel& getModel() {
 	return static_cast<RegisterViewModel&>(edb::v1::arch_processor().get_register_view_model());
 }
 
 void updateGPRs(RegisterViewModel& model, const State& state, bool is64Bit) {
+	const std::size_t count=is64Bit ? GPR64_COUNT : GPR32_COUNT;
+	const auto strings=std::make_shared<GPRStrings>(state, count);
 	if(is64Bit) {
 		for(std::size_t i=0;i<GPR64_COUNT;++i) {
 			const auto reg=state.gp_register(i);
@@ -1144,9 +1244,11 @@ void updateGPRs(RegisterViewModel& model, const State& state, bool is64Bit) {
 						comment="-"+errName+"; "+comment;
 				}
 			}
+			// the string it might point to is only looked for if it's shown
 			if(comment.isEmpty())
-				comment=gprComment(reg);
-			model.updateGPR(i,reg.value<edb::value64>(),comment);
+				model.updateGPR(i,reg.value<edb::value64>(),[strings,i]() { return strings->comment(i); });
+			else
+				model.updateGPR(i,reg.value<edb::value64>(),comment);
 		}
 	} else {
 		for(std::size_t i=0;i<GPR32_COUNT;++i) {
@@ -1163,9 +1265,11 @@ void updateGPRs(RegisterViewModel& model, const State& state, bool is64Bit) {
 						comment="-"+errName+"; "+comment;
 				}
 			}
+			// the string it might point to is only looked for if it's shown
 			if(comment.isEmpty())
-				comment=gprComment(reg);
-			model.updateGPR(i,reg.value<edb::value32>(),comment);
+				model.updateGPR(i,reg.value<edb::value32>(),[strings,i]() { return strings->comment(i); });
+			else
+				model.updateGPR(i,reg.value<edb::value32>(),comment);
 		}
 	}
 }
@@ -1189,7 +1293,8 @@ void updateGeneralStatusRegs(RegisterViewModel& model, const State& state, bool
 	const auto flags=state.flags_register();
 	Q_ASSERT(!!ip);
 	Q_ASSERT(!!flags);
-	const auto ipComment=rIPcomment(ip.valueAsAddress(),default_region_name);
+	const auto ipAddress=ip.valueAsAddress();
+	const auto ipComment=[ipAddress,default_region_name]() { return rIPcomment(ipAddress,default_region_name); };
 	const auto flagsComment=eflagsComment(flags.valueAsInteger());
 	if(is64Bit) {
 		model.updateIP(ip.value<edb::value64>(),ipComment);
@@ -1385,6 +1490,7 @@ void ArchProcessor::update_register_view(const QString &default_region_name, con
 }
 
 void ArchProcessor::about_to_resume() {
+	invalidate_instruction_info();
 	getModel().saveValues();
 }
 
@@ -1395,44 +1501,43 @@ void ArchProcessor::justAttached() {
 bool falseSyscallReturn(State const& state, std::int64_t origAX) {
 	// Prevent reporting of returns from execve() when the process has just launched
 	if(EDB_IS_32_BIT && origAX==11) {
-		return state.gp_register(rAX).valueAsInteger()==0 &&
-			   state.gp_register(rCX).valueAsInteger()==0 &&
-			   state.gp_register(rDX).valueAsInteger()==0 &&
-			   state.gp_register(rBX).valueAsInteger()==0 &&
-			   state.gp_register(rBP).valueAsInteger()==0 &&
-			   state.gp_register(rSI).valueAsInteger()==0 &&
-			   state.gp_register(rDI).valueAsInteger()==0;
+		return state.gp_register_value(rAX)==0 &&
+			   state.gp_register_value(rCX)==0 &&
+			   state.gp_register_value(rDX)==0 &&
+			   state.gp_register_value(rBX)==0 &&
+			   state.gp_register_value(rBP)==0 &&
+			   state.gp_register_value(rSI)==0 &&
+			   state.gp_register_value(rDI)==0;
 	}
 	else if(EDB_IS_64_BIT && origAX==59) {
-		return state.gp_register(rAX).valueAsInteger()==0 &&
-			   state.gp_register(rCX).valueAsInteger()==0 &&
-			   state.gp_register(rDX).valueAsInteger()==0 &&
-			   state.gp_register(rBX).valueAsInteger()==0 &&
-			   state.gp_register(rBP).valueAsInteger()==0 &&
-			   state.gp_register(rSI).valueAsInteger()==0 &&
-			   state.gp_register(rDI).valueAsInteger()==0 &&
-			   state.gp_register(R8 ).valueAsInteger()==0 &&
-			   state.gp_register(R9 ).valueAsInteger()==0 &&
-			   state.gp_register(R10).valueAsInteger()==0 &&
-			   state.gp_register(R11).valueAsInteger()==0 &&
-			   state.gp_register(R12).valueAsInteger()==0 &&
-			   state.gp_register(R13).valueAsInteger()==0 &&
-			   state.gp_register(R14).valueAsInteger()==0 &&
-			   state.gp_register(R15).valueAsInteger()==0;
+		return state.gp_register_value(rAX)==0 &&
+			   state.gp_register_value(rCX)==0 &&
+			   state.gp_register_value(rDX)==0 &&
+			   state.gp_register_value(rBX)==0 &&
+			   state.gp_register_value(rBP)==0 &&
+			   state.gp_register_value(rSI)==0 &&
+			   state.gp_register_value(rDI)==0 &&
+			   state.gp_register_value(R8 )==0 &&
+			   state.gp_register_value(R9 )==0 &&
+			   state.gp_register_value(R10)==0 &&
+			   state.gp_register_value(R11)==0 &&
+			   state.gp_register_value(R12)==0 &&
+			   state.gp_register_value(R13)==0 &&
+			   state.gp_register_value(R14)==0 &&
+			   state.gp_register_value(R15)==0;
 	}
 	return false;
 }
 
 //------------------------------------------------------------------------------
-// Name: update_instruction_info
-// Desc:
+// Name: instruction_info
+// Desc: what there is to say about the instruction at <address>, if it's run
+//       in <state>
 //------------------------------------------------------------------------------
-QStringList ArchProcessor::update_instruction_info(edb::address_t address) {
+QStringList instruction_info(edb::address_t address, const State &state) {
 
 	QStringList ret;
 
-	Q_ASSERT(edb::v1::debugger_core);
-
 	if(IProcess *process = edb::v1::debugger_core->process()) {
 		quint8 buffer[edb::Instruction::MAX_SIZE];
 
@@ -1440,9 +1545,6 @@ QStringList ArchProcessor::update_instruction_info(edb::address_t address) {
 			edb::Instruction inst(buffer, buffer + sizeof(buffer), address);
 			if(inst) {
 
-				State state;
-				edb::v1::debugger_core->get_state(&state);
-
 				std::int64_t origAX;
 				if(debuggeeIs64Bit())
 					origAX=state["orig_rax"].valueAsSignedInteger();
@@ -1533,6 +1635,73 @@ QStringList ArchProcessor::update_instruction_info(edb::address_t address) {
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// Name: instruction_info_registers
+// Desc: the registers instruction_info depends on the most, the analysis is
+//       redone whenever one of them was changed
+//------------------------------------------------------------------------------
+std::vector<Register> instruction_info_registers(const State &state) {
+
+	std::vector<Register> registers;
+
+	const std::size_t count = debuggeeIs64Bit() ? GPR64_COUNT : GPR32_COUNT;
+	for(std::size_t i = 0; i < count; ++i) {
+		registers.push_back(state.gp_register(i));
+	}
+
+	registers.push_back(state.instruction_pointer_register());
+	registers.push_back(state.flags_register());
+	registers.push_back(state[debuggeeIs64Bit() ? "orig_rax" : "orig_eax"]);
+	return registers;
+}
+
+//------------------------------------------------------------------------------
+// Name: update_instruction_info
+// Desc: the views are refreshed much more often than the debuggee changes, so
+//       the analysis of the last (address, stop) is kept. It's redone when the
+//       debuggee has run or been written to (see invalidate_instruction_info),
+//       its registers were changed, or symbols were loaded
+//------------------------------------------------------------------------------
+QStringList ArchProcessor::update_instruction_info(edb::address_t address) {
+
+	Q_ASSERT(edb::v1::debugger_core);
+
+	if(!edb::v1::debugger_core->process()) {
+		return QStringList();
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+
+	std::vector<Register> registers = instruction_info_registers(state);
+	const quint64 symbols_generation = edb::v1::symbol_manager().generation();
+
+	if(instruction_info_.valid &&
+	   instruction_info_.address == address &&
+	   instruction_info_.epoch == epoch_ &&
+	   instruction_info_.symbols_generation == symbols_generation &&
+	   instruction_info_.registers == registers) {
+		return instruction_info_.text;
+	}
+
+	instruction_info_.valid              = true;
+	instruction_info_.address            = address;
+	instruction_info_.epoch              = epoch_;
+	instruction_info_.symbols_generation = symbols_generation;
+	instruction_info_.registers          = std::move(registers);
+	instruction_info_.text               = instruction_info(address, state);
+	return instruction_info_.text;
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_instruction_info
+// Desc: has update_instruction_info start over, for when the debuggee's memory
+//       was changed
+//------------------------------------------------------------------------------
+void ArchProcessor::invalidate_instruction_info() {
+	++epoch_;
+}
+
 //------------------------------------------------------------------------------
 // Name: can_step_over
 // Desc:
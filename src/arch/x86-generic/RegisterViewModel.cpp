@@ -408,7 +408,19 @@ RegisterViewModel::RegisterViewModel(int cpuSuppFlags, QObject* parent)
 }
 
 template<typename RegType, typename ValueType>
-void updateRegister(RegisterViewModelBase::Category* cat, int row, ValueType value, QString const& comment, const char* nameToCheck = nullptr)
+void assignRegister(RegType* reg, ValueType value, QString const& comment)
+{
+	reg->update(value,comment);
+}
+
+template<typename RegType, typename ValueType>
+void assignRegister(RegType* reg, ValueType value, std::function<QString()> const& commentSource)
+{
+	reg->updateLazily(value,commentSource);
+}
+
+template<typename RegType, typename ValueType, typename CommentType>
+void updateRegister(RegisterViewModelBase::Category* cat, int row, ValueType value, CommentType const& comment, const char* nameToCheck = nullptr)
 {
 	const auto reg=cat->getRegister(row);
 	if(!dynamic_cast<RegType*>(reg))
@@ -418,7 +430,7 @@ void updateRegister(RegisterViewModelBase::Category* cat, int row, ValueType val
 		return;
 	}
 	Q_ASSERT(!nameToCheck || reg->name()==nameToCheck); Q_UNUSED(nameToCheck);
-	static_cast<RegType*>(reg)->update(value,comment);
+	assignRegister(static_cast<RegType*>(reg),value,comment);
 }
 
 void RegisterViewModel::updateGPR(std::size_t i, edb::value32 val, QString const& comment)
@@ -433,6 +445,18 @@ void RegisterViewModel::updateGPR(std::size_t i, edb::value64 val, QString const
 	updateRegister<GPR64>(gprs64, static_cast<int>(i), val, comment);
 }
 
+void RegisterViewModel::updateGPR(std::size_t i, edb::value32 val, std::function<QString()> const& commentSource)
+{
+	Q_ASSERT(int(i)<gprs32->childCount());
+	updateRegister<GPR32>(gprs32, static_cast<int>(i), val, commentSource);
+}
+
+void RegisterViewModel::updateGPR(std::size_t i, edb::value64 val, std::function<QString()> const& commentSource)
+{
+	Q_ASSERT(int(i)<gprs64->childCount());
+	updateRegister<GPR64>(gprs64, static_cast<int>(i), val, commentSource);
+}
+
 void RegisterViewModel::updateIP(edb::value64 value,QString const& comment)
 {
 	updateRegister<RIP>(genStatusRegs64,RIP_ROW,value,comment,"RIP");
@@ -443,6 +467,16 @@ void RegisterViewModel::updateIP(edb::value32 value,QString const& comment)
 	updateRegister<EIP>(genStatusRegs32,EIP_ROW,value,comment,"EIP");
 }
 
+void RegisterViewModel::updateIP(edb::value64 value,std::function<QString()> const& commentSource)
+{
+	updateRegister<RIP>(genStatusRegs64,RIP_ROW,value,commentSource,"RIP");
+}
+
+void RegisterViewModel::updateIP(edb::value32 value,std::function<QString()> const& commentSource)
+{
+	updateRegister<EIP>(genStatusRegs32,EIP_ROW,value,commentSource,"EIP");
+}
+
 void RegisterViewModel::updateFlags(edb::value64 value, QString const& comment)
 {
 	updateRegister<RFLAGS>(genStatusRegs64,RFLAGS_ROW,value,comment);
@@ -65,8 +65,13 @@ public:
 	// Use dataUpdateFinished() to have dataChanged emitted.
 	void updateGPR(std::size_t i, edb::value32 val, QString const& comment=QString());
 	void updateGPR(std::size_t i, edb::value64 val, QString const& comment=QString());
+	// the comment is made only when it's shown
+	void updateGPR(std::size_t i, edb::value32 val, std::function<QString()> const& commentSource);
+	void updateGPR(std::size_t i, edb::value64 val, std::function<QString()> const& commentSource);
 	void updateIP(edb::value32,QString const& comment=QString());
 	void updateIP(edb::value64,QString const& comment=QString());
+	void updateIP(edb::value32,std::function<QString()> const& commentSource);
+	void updateIP(edb::value64,std::function<QString()> const& commentSource);
 	void updateFlags(edb::value32, QString const& comment=QString());
 	void updateFlags(edb::value64, QString const& comment=QString());
 	void updateSegReg(std::size_t i, edb::value16, QString const& comment=QString());
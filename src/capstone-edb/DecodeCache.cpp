@@ -0,0 +1,136 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DecodeCache.h"
+#include "Instruction.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace CapstoneEDB {
+
+namespace {
+
+// a decoded x86 instruction carries about 1.5K of detail, this keeps the
+// cache to a few megabytes while still covering a screenful of disassembly
+// and the working set of an analysis pass many times over
+constexpr std::size_t SLOT_COUNT   = 4096;
+constexpr std::size_t STRIPE_COUNT = 64;
+
+struct Slot {
+	uint64_t                     rva  = 0;
+	Architecture                 arch = Architecture::ARCH_X86;
+	uint8_t                      size = 0; // 0 for an empty slot
+	uint8_t                      bytes[Instruction::MAX_SIZE];
+	std::shared_ptr<Instruction> insn;
+};
+
+std::array<Slot, SLOT_COUNT>        slots;
+std::array<std::mutex, STRIPE_COUNT> stripes;
+std::atomic<uint64_t>               hits(0);
+std::atomic<uint64_t>               misses(0);
+
+//------------------------------------------------------------------------------
+// Name: slot_index
+// Desc: mixes the address with the leading bytes so that callers which decode
+//       everything at rva 0 still spread across the table
+//------------------------------------------------------------------------------
+std::size_t slot_index(const uint8_t *first, std::size_t available, uint64_t rva) {
+	uint64_t key = rva;
+	for(std::size_t i = 0; i < available && i < 4; ++i) {
+		key = (key << 8) ^ (key >> 56) ^ first[i];
+	}
+
+	key *= 0x9e3779b97f4a7c15ull;
+	return static_cast<std::size_t>(key >> 52) % SLOT_COUNT;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: decode
+// Desc:
+//------------------------------------------------------------------------------
+std::shared_ptr<Instruction> decode(const void *first, const void *last, uint64_t rva) {
+	return decode(first, last, rva, architecture());
+}
+
+//------------------------------------------------------------------------------
+// Name: decode
+// Desc: the same bytes decode differently in each mode, so the mode is part
+//       of what a decode is remembered by
+//------------------------------------------------------------------------------
+std::shared_ptr<Instruction> decode(const void *first, const void *last, uint64_t rva, Architecture arch) {
+
+	const auto p         = static_cast<const uint8_t *>(first);
+	const auto available = static_cast<std::size_t>(static_cast<const uint8_t *>(last) - p);
+
+	const std::size_t index = slot_index(p, available, rva);
+	Slot &slot = slots[index];
+
+	{
+		std::lock_guard<std::mutex> lock(stripes[index % STRIPE_COUNT]);
+		if(slot.size != 0 && slot.rva == rva && slot.arch == arch && slot.size <= available && std::memcmp(slot.bytes, p, slot.size) == 0) {
+			++hits;
+			return slot.insn;
+		}
+	}
+
+	++misses;
+
+	auto insn = std::make_shared<Instruction>(first, last, rva, arch);
+
+	// failed decodes are cheap to repeat and depend on how much was available
+	if(insn->valid()) {
+		std::lock_guard<std::mutex> lock(stripes[index % STRIPE_COUNT]);
+		slot.rva  = rva;
+		slot.arch = arch;
+		slot.size = static_cast<uint8_t>(insn->byte_size());
+		std::memcpy(slot.bytes, p, slot.size);
+		slot.insn = insn;
+	}
+
+	return insn;
+}
+
+//------------------------------------------------------------------------------
+// Name: clear_decode_cache
+// Desc: decodes depend on the syntax, so changing it has to start over
+//------------------------------------------------------------------------------
+void clear_decode_cache() {
+	for(std::size_t i = 0; i < SLOT_COUNT; ++i) {
+		std::lock_guard<std::mutex> lock(stripes[i % STRIPE_COUNT]);
+		slots[i].size = 0;
+		slots[i].insn.reset();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: decode_cache_stats
+// Desc:
+//------------------------------------------------------------------------------
+DecodeCacheStats decode_cache_stats() {
+	DecodeCacheStats stats;
+	stats.hits   = hits;
+	stats.misses = misses;
+	return stats;
+}
+
+}
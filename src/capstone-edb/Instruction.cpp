@@ -23,9 +23,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <cstring>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
@@ -33,12 +36,26 @@ namespace CapstoneEDB {
 
 namespace {
 
-constexpr int MAX_OPERANDS       = 3;
+constexpr int         MAX_OPERANDS = 3;
+constexpr std::size_t ARCH_COUNT   = 5;
 
-Architecture capstoneArch        = Architecture::ARCH_X86;
-bool         capstoneInitialized = false;
-csh          csh                 = 0;
-Formatter    activeFormatter;
+// the handles of one mode, opened the first time anything is decoded in it
+// and kept open from then on
+struct Handles {
+	::csh             detail = 0;
+	::csh             brief  = 0; // the same, but without CS_OPT_DETAIL
+	std::atomic<bool> open{false};
+};
+
+std::array<Handles, ARCH_COUNT> handles;
+std::mutex                      handlesMutex;
+
+// the mode init() last selected and its handles
+std::atomic<Architecture> capstoneArch(Architecture::ARCH_X86);
+std::atomic<bool>         capstoneInitialized(false);
+std::atomic<::csh>        csh(0);
+std::atomic<::csh>        briefCsh(0);
+Formatter                 activeFormatter;
 
 bool is_simd_register(const Operand &operand) {
 
@@ -103,98 +120,288 @@ std::size_t simdOperandNormalizedNumberInInstruction(const Instruction &insn, co
 	return number;
 }
 
+void apply_syntax(::csh handle, const Formatter::FormatOptions &options) {
+#if defined EDB_X86 || defined EDB_X86_64
+	if (options.syntax == Formatter::SyntaxATT)
+		cs_option(handle, CS_OPT_SYNTAX, CS_OPT_SYNTAX_ATT);
+	else
+		cs_option(handle, CS_OPT_SYNTAX, CS_OPT_SYNTAX_INTEL);
+#elif defined EDB_ARM32 // FIXME(ARM): does this apply to AArch64?
+	// TODO: make this optional. Don't forget to reflect this in register view!
+	(void)options;
+	cs_option(handle, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
+#else
+	(void)handle;
+	(void)options;
+#endif
 }
 
-bool isX86_64() {
-	return capstoneArch == Architecture::ARCH_AMD64;
-}
-
-bool init(Architecture arch) {
+// the handles for <arch>, opening them if this is the first use of it.
+// nullptr if capstone doesn't support it
+const Handles *handles_for(Architecture arch) {
 
-	capstoneArch = arch;
-
-	if (capstoneInitialized) {
-		cs_close(&csh);
+	Handles &h = handles[static_cast<std::size_t>(arch)];
+	if (h.open.load(std::memory_order_acquire)) {
+		return &h;
 	}
 
-	capstoneInitialized = false;
+	std::lock_guard<std::mutex> lock(handlesMutex);
+	if (h.open.load(std::memory_order_relaxed)) {
+		return &h;
+	}
 
-	const cs_err result = [arch]() {
+	const auto open = [arch](::csh *handle) {
 		switch (arch) {
 		case Architecture::ARCH_AMD64:
-			return cs_open(CS_ARCH_X86, CS_MODE_64, &csh);
+			return cs_open(CS_ARCH_X86, CS_MODE_64, handle);
 		case Architecture::ARCH_X86:
-			return cs_open(CS_ARCH_X86, CS_MODE_32, &csh);
+			return cs_open(CS_ARCH_X86, CS_MODE_32, handle);
 		case Architecture::ARCH_ARM32_ARM:
-			return cs_open(CS_ARCH_ARM, CS_MODE_ARM, &csh);
+			return cs_open(CS_ARCH_ARM, CS_MODE_ARM, handle);
 		case Architecture::ARCH_ARM32_THUMB:
-			return cs_open(CS_ARCH_ARM, CS_MODE_THUMB, &csh);
+			return cs_open(CS_ARCH_ARM, CS_MODE_THUMB, handle);
 		case Architecture::ARCH_ARM64:
-			return cs_open(CS_ARCH_ARM64, CS_MODE_ARM, &csh);
+			return cs_open(CS_ARCH_ARM64, CS_MODE_ARM, handle);
 		default:
 			return CS_ERR_ARCH;
 		}
-	}();
+	};
 
-	if (result != CS_ERR_OK) {
-		return false;
+	if (open(&h.detail) != CS_ERR_OK) {
+		return nullptr;
 	}
 
-	capstoneInitialized = true;
+	if (open(&h.brief) != CS_ERR_OK) {
+		cs_close(&h.detail);
+		return nullptr;
+	}
+
+	cs_option(h.detail, CS_OPT_DETAIL, CS_OPT_ON);
+	apply_syntax(h.detail, activeFormatter.options());
+
+	h.open.store(true, std::memory_order_release);
+	return &h;
+}
+
+// corrects what capstone gets wrong in a detailed decode
+void fix_up(cs_insn *insn) {
+#if defined EDB_ARM32
+	if(insn->detail->arm.op_count>=2)
+	{
+		// XXX: this is a work around capstone bug #1013
+		auto& op=insn->detail->arm.operands[1];
+		if(op.type==ARM_OP_MEM && op.subtracted && op.mem.scale==1)
+			op.mem.scale=-1;
+	}
+#else
+	(void)insn;
+#endif
+}
+
+}
+
+namespace {
+
+// Formatted instructions are remembered by what they were formatted from,
+// the way DecodeCache remembers decodes. Each slot keeps the text in a fixed
+// buffer, longer text is never remembered, and converts it to a QString at
+// most once
+constexpr std::size_t FORMAT_SLOT_COUNT   = 2048;
+constexpr std::size_t FORMAT_STRIPE_COUNT = 64;
+constexpr std::size_t FORMAT_TEXT_SIZE    = 64;
+
+struct FormatSlot {
+	uint64_t                 generation = 0; // 0 for an empty slot
+	Formatter::FormatOptions options;
+	Architecture             arch       = Architecture::ARCH_X86;
+	uint64_t                 rva        = 0;
+	uint8_t                  size       = 0;
+	uint8_t                  bytes[Instruction::MAX_SIZE];
+	uint8_t                  length     = 0;
+	char                     text[FORMAT_TEXT_SIZE];
+	QString                  qtext;
+};
+
+std::array<FormatSlot, FORMAT_SLOT_COUNT>    formatSlots;
+std::array<std::mutex, FORMAT_STRIPE_COUNT> formatStripes;
+
+// bumped by anything which changes what the same bytes would format as
+std::atomic<uint64_t> formatGeneration(1);
+
+bool same_options(const Formatter::FormatOptions &lhs, const Formatter::FormatOptions &rhs) {
+	return lhs.syntax == rhs.syntax &&
+	       lhs.capitalization == rhs.capitalization &&
+	       lhs.tabBetweenMnemonicAndOperands == rhs.tabBetweenMnemonicAndOperands &&
+	       lhs.simplifyRIPRelativeTargets == rhs.simplifyRIPRelativeTargets;
+}
+
+std::size_t format_slot_index(const Instruction &insn) {
+	uint64_t key = insn.rva();
+	for (std::size_t i = 0; i < insn.byte_size() && i < 4; ++i) {
+		key = (key << 8) ^ (key >> 56) ^ insn.bytes()[i];
+	}
+
+	key *= 0x9e3779b97f4a7c15ull;
+	return static_cast<std::size_t>(key >> 52) % FORMAT_SLOT_COUNT;
+}
+
+bool format_slot_matches(const FormatSlot &slot, const Instruction &insn, const Formatter::FormatOptions &options) {
+	return slot.generation == formatGeneration &&
+	       slot.arch == insn.architecture() &&
+	       slot.rva == insn.rva() &&
+	       slot.size == insn.byte_size() &&
+	       std::memcmp(slot.bytes, insn.bytes(), slot.size) == 0 &&
+	       same_options(slot.options, options);
+}
+
+}
+
+bool isX86_64() {
+	return capstoneArch == Architecture::ARCH_AMD64;
+}
 
-	cs_option(csh, CS_OPT_DETAIL, CS_OPT_ON);
+bool init(Architecture arch) {
+
+	// what was decoded or formatted before records the mode it was in, so
+	// none of it has to be thrown away
+	const Handles *const h = handles_for(arch);
+	if (!h) {
+		return false;
+	}
 
-	// Set selected formatting options on reinit
-	activeFormatter.setOptions(activeFormatter.options());
+	csh                 = h->detail;
+	briefCsh            = h->brief;
+	capstoneArch        = arch;
+	capstoneInitialized = true;
 	return true;
 }
 
-Instruction::Instruction(Instruction &&other) : insn_(other.insn_), byte0_(other.byte0_), rva_(other.rva_) {
+Architecture architecture() {
+	return capstoneArch;
+}
+
+Instruction::Instruction(Instruction &&other) : insn_(other.insn_), owned_(other.owned_), arch_(other.arch_), byte0_(other.byte0_), rva_(other.rva_) {
 	other.insn_  = nullptr;
+	other.owned_ = true;
 	other.byte0_ = 0;
 	other.rva_   = 0;
 }
 
 Instruction &Instruction::operator=(Instruction &&rhs) {
-	insn_      = rhs.insn_;
-	byte0_     = rhs.byte0_;
-	rva_       = rhs.rva_;
-	rhs.insn_  = nullptr;
-	rhs.byte0_ = 0;
-	rhs.rva_   = 0;
+	if (this != &rhs) {
+		if (insn_ && owned_) {
+			cs_free(insn_, 1);
+		}
+		insn_      = rhs.insn_;
+		owned_     = rhs.owned_;
+		arch_      = rhs.arch_;
+		byte0_     = rhs.byte0_;
+		rva_       = rhs.rva_;
+		rhs.insn_  = nullptr;
+		rhs.owned_ = true;
+		rhs.byte0_ = 0;
+		rhs.rva_   = 0;
+	}
 	return *this;
 }
 
 Instruction::~Instruction() {
-	if (insn_) {
+	if (insn_ && owned_) {
 		cs_free(insn_, 1);
 	}
 }
 
-Instruction::Instruction(const void *first, const void *last, uint64_t rva) noexcept : rva_(rva) {
+Instruction::Instruction(const void *first, const void *last, uint64_t rva) noexcept : Instruction(first, last, rva, capstoneArch) {
+}
+
+Instruction::Instruction(const void *first, const void *last, uint64_t rva, Architecture arch) noexcept : arch_(arch), rva_(rva) {
 	assert(capstoneInitialized);
 	auto codeBegin = static_cast<const uint8_t *>(first);
 	auto codeEnd   = static_cast<const uint8_t *>(last);
 
 	byte0_ = codeBegin[0];
 
+	const Handles *const h = handles_for(arch);
+
 	cs_insn *insn = nullptr;
-	if (first < last && cs_disasm(csh, codeBegin, codeEnd - codeBegin, rva, 1, &insn)) {
+	if (h && first < last && cs_disasm(h->detail, codeBegin, codeEnd - codeBegin, rva, 1, &insn)) {
 		insn_ = insn;
-#if defined EDB_ARM32
-		if(insn_->detail->arm.op_count>=2)
-		{
-			// XXX: this is a work around capstone bug #1013
-			auto& op=insn_->detail->arm.operands[1];
-			if(op.type==ARM_OP_MEM && op.subtracted && op.mem.scale==1)
-				op.mem.scale=-1;
-		}
-#endif
+		fix_up(insn_);
 	} else {
 		insn_ = nullptr;
 	}
 }
 
+Decoder::Decoder() : buffer_(nullptr) {
+	assert(capstoneInitialized);
+	buffer_             = cs_malloc(csh);
+	instruction_.owned_ = false;
+}
+
+Decoder::~Decoder() {
+	instruction_.insn_ = nullptr;
+	if (buffer_) {
+		cs_free(buffer_, 1);
+	}
+}
+
+const Instruction &Decoder::decode(const void *first, const void *last, uint64_t rva) {
+	auto code = static_cast<const uint8_t *>(first);
+	auto size = static_cast<std::size_t>(static_cast<const uint8_t *>(last) - code);
+	uint64_t address = rva;
+
+	const Architecture arch = capstoneArch;
+	const Handles *const h  = handles_for(arch);
+
+	instruction_.rva_   = rva;
+	instruction_.arch_  = arch;
+	instruction_.byte0_ = first < last ? code[0] : 0;
+
+	// the buffer's detail fits any mode, so it doesn't matter which handle
+	// allocated it
+	if (h && buffer_ && first < last && cs_disasm_iter(h->detail, &code, &size, &address, buffer_)) {
+		fix_up(buffer_);
+		instruction_.insn_ = buffer_;
+	} else {
+		instruction_.insn_ = nullptr;
+	}
+
+	return instruction_;
+}
+
+const Instruction &InstructionPool::decode(const void *first, const void *last, uint64_t rva) {
+	if (used_ == decoders_.size()) {
+		decoders_.push_back(std::unique_ptr<Decoder>(new Decoder));
+	}
+	return decoders_[used_++]->decode(first, last, rva);
+}
+
+BriefInstruction decode_brief(const void *first, const void *last, uint64_t rva) {
+	assert(capstoneInitialized);
+
+	// without detail, a cs_insn is the same whichever handle allocated it
+	struct Buffer {
+		Buffer() : insn(cs_malloc(briefCsh)) {}
+		~Buffer() { cs_free(insn, 1); }
+		cs_insn *const insn;
+	};
+
+	thread_local Buffer buffer;
+
+	BriefInstruction brief;
+
+	auto code = static_cast<const uint8_t *>(first);
+	auto size = static_cast<std::size_t>(static_cast<const uint8_t *>(last) - code);
+	uint64_t address = rva;
+
+	if (buffer.insn && first < last && cs_disasm_iter(briefCsh, &code, &size, &address, buffer.insn)) {
+		brief.size      = buffer.insn->size;
+		brief.operation = buffer.insn->id;
+	}
+
+	return brief;
+}
+
 Operand Instruction::operator[](size_t n) const {
 	if (!valid())
 		return Operand();
@@ -291,6 +498,7 @@ Instruction::ConditionCode Instruction::condition_code() const {
 void Instruction::swap(Instruction &other) {
 	using std::swap;
 	swap(insn_,  other.insn_);
+	swap(arch_,  other.arch_);
 	swap(byte0_, other.byte0_);
 	swap(rva_,   other.rva_);
 }
@@ -323,22 +531,84 @@ void Formatter::setOptions(const Formatter::FormatOptions &options) {
 	assert(capstoneInitialized);
 
 	options_ = options;
+	clear_decode_cache();
+	++formatGeneration;
 
-#if defined EDB_X86 || defined EDB_X86_64
-	if (options.syntax == SyntaxATT)
-		cs_option(csh, CS_OPT_SYNTAX, CS_OPT_SYNTAX_ATT);
-	else
-		cs_option(csh, CS_OPT_SYNTAX, CS_OPT_SYNTAX_INTEL);
-#elif defined EDB_ARM32 // FIXME(ARM): does this apply to AArch64?
-	// TODO: make this optional. Don't forget to reflect this in register view!
-	cs_option(csh, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
-#endif
+	// every mode opened so far follows, the others pick it up as they open
+	{
+		std::lock_guard<std::mutex> lock(handlesMutex);
+		for (Handles &h : handles) {
+			if (h.open.load(std::memory_order_relaxed)) {
+				apply_syntax(h.detail, options);
+			}
+		}
 
-	activeFormatter = *this;
+		activeFormatter = *this;
+	}
 }
 
 std::string Formatter::to_string(const Instruction &insn) const {
 
+	if (!insn) {
+		return format(insn);
+	}
+
+	const std::size_t index = format_slot_index(insn);
+	FormatSlot &slot = formatSlots[index];
+
+	{
+		std::lock_guard<std::mutex> lock(formatStripes[index % FORMAT_STRIPE_COUNT]);
+		if (format_slot_matches(slot, insn, options_)) {
+			return std::string(slot.text, slot.length);
+		}
+	}
+
+	std::string str = format(insn);
+	remember(insn, str);
+	return str;
+}
+
+QString Formatter::to_qstring(const Instruction &insn) const {
+
+	if (insn) {
+		const std::size_t index = format_slot_index(insn);
+		FormatSlot &slot = formatSlots[index];
+
+		std::lock_guard<std::mutex> lock(formatStripes[index % FORMAT_STRIPE_COUNT]);
+		if (format_slot_matches(slot, insn, options_)) {
+			if (slot.qtext.isNull()) {
+				slot.qtext = QString::fromLatin1(slot.text, slot.length);
+			}
+			return slot.qtext;
+		}
+	}
+
+	return QString::fromStdString(to_string(insn));
+}
+
+void Formatter::remember(const Instruction &insn, const std::string &str) const {
+
+	if (str.size() >= FORMAT_TEXT_SIZE) {
+		return;
+	}
+
+	const std::size_t index = format_slot_index(insn);
+	FormatSlot &slot = formatSlots[index];
+
+	std::lock_guard<std::mutex> lock(formatStripes[index % FORMAT_STRIPE_COUNT]);
+	slot.generation = formatGeneration;
+	slot.options    = options_;
+	slot.arch       = insn.architecture();
+	slot.rva        = insn.rva();
+	slot.size       = static_cast<uint8_t>(insn.byte_size());
+	slot.length     = static_cast<uint8_t>(str.size());
+	std::memcpy(slot.bytes, insn.bytes(), slot.size);
+	std::memcpy(slot.text, str.data(), str.size());
+	slot.qtext      = QString();
+}
+
+std::string Formatter::format(const Instruction &insn) const {
+
 	enum {
 		tab1Size = 8,
 		tab2Size = 11,
@@ -379,6 +649,118 @@ std::string Formatter::to_string(const Instruction &insn) const {
 	return str;
 }
 
+std::string Formatter::to_string(const Instruction &insn, std::vector<Token> *tokens) const {
+	std::string str = to_string(insn);
+	if (tokens) {
+		tokenize(insn, str, tokens);
+	}
+	return str;
+}
+
+// The words of the operands are told apart by what capstone says the operands
+// are, so this is the only pass over the text, however many kinds of token
+// there are
+void Formatter::tokenize(const Instruction &insn, const std::string &str, std::vector<Token> *tokens) const {
+
+	static const char *const pointerWords[] = {
+		"byte", "word", "dword", "qword", "fword", "tbyte", "xmmword", "ymmword", "zmmword", "ptr"
+	};
+
+	auto equalsWord = [&str](std::size_t start, std::size_t length, const std::string &word) {
+		if (length != word.size()) {
+			return false;
+		}
+		for (std::size_t i = 0; i < length; ++i) {
+			if (std::tolower(static_cast<unsigned char>(str[start + i])) != std::tolower(static_cast<unsigned char>(word[i]))) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	auto isWordChar = [](char ch) {
+		return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '.';
+	};
+
+	tokens->clear();
+
+	// the mnemonic, with any prefixes which capstone puts in front of it
+	const std::size_t mnemonicEnd = std::min(str.size(), insn ? std::strlen(insn->mnemonic) : std::strlen("db"));
+
+	std::size_t word = 0;
+	for (std::size_t i = 0; i <= mnemonicEnd; ++i) {
+		if (i == mnemonicEnd || str[i] == ' ') {
+			if (i > word) {
+				tokens->push_back(Token{i == mnemonicEnd ? TokenMnemonic : TokenPrefix, static_cast<int>(word), static_cast<int>(i - word)});
+			}
+			word = i + 1;
+		}
+	}
+
+	std::vector<std::string> registers;
+	if (insn) {
+		for (std::size_t i = 0; i < insn.operand_count(); ++i) {
+			const auto op = insn[i];
+			if (static_cast<cs_op_type>(op->type) == CS_OP_REG) {
+				registers.push_back(register_name(op->reg));
+			} else if (static_cast<cs_op_type>(op->type) == CS_OP_MEM) {
+				if (op->mem.base) {
+					registers.push_back(register_name(op->mem.base));
+				}
+				if (op->mem.index) {
+					registers.push_back(register_name(op->mem.index));
+				}
+#if defined EDB_X86 || defined EDB_X86_64
+				if (op->mem.segment) {
+					registers.push_back(register_name(op->mem.segment));
+				}
+#endif
+			}
+		}
+	}
+
+	for (std::size_t i = mnemonicEnd; i < str.size(); ) {
+		const char ch = str[i];
+
+		if (ch == '[' || ch == ']' || ch == '(' || ch == ')' || ch == '{' || ch == '}' || ch == ',') {
+			tokens->push_back(Token{TokenBracket, static_cast<int>(i), 1});
+			++i;
+		} else if (ch == '+' || ch == '-' || ch == '*') {
+			tokens->push_back(Token{TokenOperator, static_cast<int>(i), 1});
+			++i;
+		} else if (std::isdigit(static_cast<unsigned char>(ch)) || ((ch == '#' || ch == '$') && i + 1 < str.size() && std::isdigit(static_cast<unsigned char>(str[i + 1])))) {
+			std::size_t end = i + 1;
+			while (end < str.size() && isWordChar(str[end])) {
+				++end;
+			}
+			tokens->push_back(Token{TokenConstant, static_cast<int>(i), static_cast<int>(end - i)});
+			i = end;
+		} else if (isWordChar(ch) || ch == '%') {
+			// AT&T puts a % in front of registers
+			const std::size_t start = (ch == '%') ? i + 1 : i;
+			std::size_t end = start;
+			while (end < str.size() && isWordChar(str[end])) {
+				++end;
+			}
+
+			const std::size_t length = end - start;
+			if (std::any_of(registers.begin(), registers.end(), [&](const std::string &reg) { return equalsWord(start, length, reg); })) {
+				tokens->push_back(Token{TokenRegister, static_cast<int>(start), static_cast<int>(length)});
+			} else if (std::any_of(std::begin(pointerWords), std::end(pointerWords), [&](const char *ptr) { return equalsWord(start, length, ptr); })) {
+				// "dword ptr" is one token, as it is highlighted as one
+				if (!tokens->empty() && tokens->back().type == TokenPointer && tokens->back().start + tokens->back().length + 1 == static_cast<int>(start)) {
+					tokens->back().length += static_cast<int>(length) + 1;
+				} else {
+					tokens->push_back(Token{TokenPointer, static_cast<int>(start), static_cast<int>(length)});
+				}
+			}
+			i = std::max(end, i + 1);
+		} else {
+			++i;
+		}
+	}
+}
+
 void Formatter::checkCapitalize(std::string &str, bool canContainHex) const {
 	if (options_.capitalization == UpperCase) {
 		std::transform(str.begin(), str.end(), str.begin(), ::toupper);
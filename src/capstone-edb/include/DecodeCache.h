@@ -0,0 +1,52 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DECODE_CACHE_20171014_H
+#define DECODE_CACHE_20171014_H
+
+#include <cstdint>
+#include <memory>
+
+namespace CapstoneEDB {
+
+class Instruction;
+enum class Architecture;
+
+struct DecodeCacheStats {
+	uint64_t hits   = 0;
+	uint64_t misses = 0;
+};
+
+// Decodes the instruction at the start of [first, last) as if it were at <rva>.
+// Successful decodes are remembered by address and by the bytes they consumed,
+// so a lookup only hits when the same bytes are still at the same address and
+// writes to the debuggee never need to be reported. The result is shared with
+// other callers and must not be modified. Safe to call from any thread
+std::shared_ptr<Instruction> decode(const void *first, const void *last, uint64_t rva);
+
+// the same, but decoded in <arch> rather than the mode init() selected, for
+// code which isn't in the mode the process currently is (Thumb code called
+// from ARM code, the bytes of a 32-bit segment of a 64-bit process)
+std::shared_ptr<Instruction> decode(const void *first, const void *last, uint64_t rva, Architecture arch);
+
+void clear_decode_cache();
+DecodeCacheStats decode_cache_stats();
+
+}
+
+#endif
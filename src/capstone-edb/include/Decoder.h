@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DECODER_20171014_H
+#define DECODER_20171014_H
+
+#include "Instruction.h"
+#include <capstone/capstone.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace CapstoneEDB {
+
+// Decodes into a buffer which it allocates once, for the loops which decode
+// at one address after another and look at each result only briefly. The
+// instruction returned is the Decoder's own, it is overwritten by the next
+// decode and must not outlive the Decoder. Each thread needs its own
+class Decoder {
+public:
+	Decoder();
+	Decoder(const Decoder &)            = delete;
+	Decoder &operator=(const Decoder &) = delete;
+	~Decoder();
+
+public:
+	const Instruction &decode(const void *first, const void *last, uint64_t rva);
+
+private:
+	cs_insn     *buffer_;
+	Instruction  instruction_;
+};
+
+// Lends out instructions which all stay valid until reset(), for searches
+// which decode many candidates at each offset and keep almost none of them.
+// The buffers are allocated as they are first needed and reused after every
+// reset, so whatever is kept has to be copied out, as text or through
+// decode(), before then. Each thread needs its own
+class InstructionPool {
+public:
+	InstructionPool()                                   = default;
+	InstructionPool(const InstructionPool &)            = delete;
+	InstructionPool &operator=(const InstructionPool &) = delete;
+
+public:
+	const Instruction &decode(const void *first, const void *last, uint64_t rva);
+	void reset() { used_ = 0; }
+
+private:
+	std::vector<std::unique_ptr<Decoder>> decoders_;
+	std::size_t                           used_ = 0;
+};
+
+// what is left of an instruction when its operands are not decoded
+struct BriefInstruction {
+	std::size_t  size      = 0; // 0 if the bytes are not an instruction
+	unsigned int operation = 0; // as in Instruction::operation()
+
+	explicit operator bool() const {
+		return size != 0;
+	}
+};
+
+// Decodes the instruction at the start of [first, last) without any detail,
+// which is much cheaper when all that matters is where the next one starts.
+// Allocates nothing after the first call on a thread
+BriefInstruction decode_brief(const void *first, const void *last, uint64_t rva);
+
+}
+
+#endif
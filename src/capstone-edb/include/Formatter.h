@@ -3,6 +3,7 @@
 #define FORMATTER_H_
 
 #include <string>
+#include <vector>
 class QString;
 
 namespace CapstoneEDB {
@@ -29,8 +30,28 @@ public:
 		bool           simplifyRIPRelativeTargets;
 	};
 
+	// what a piece of a formatted instruction is, so that it can be
+	// highlighted without parsing the text again
+	enum TokenType {
+		TokenPrefix,
+		TokenMnemonic,
+		TokenRegister,
+		TokenConstant,
+		TokenPointer,  // the size of a memory operand, "dword ptr"
+		TokenBracket,  // brackets, braces and commas
+		TokenOperator
+	};
+
+	struct Token {
+		TokenType type;
+		int       start; // in characters
+		int       length;
+	};
+
 public:
 	std::string to_string(const Instruction &) const;
+	std::string to_string(const Instruction &, std::vector<Token> *tokens) const;
+	QString to_qstring(const Instruction &) const;
 	std::string to_string(const Operand &) const;
 	std::string register_name(int) const;
 
@@ -41,7 +62,10 @@ public:
 	void setOptions(const FormatOptions &options);
 
 private:
+	std::string format(const Instruction &insn) const;
+	void remember(const Instruction &insn, const std::string &str) const;
 	void checkCapitalize(std::string &str, bool canContainHex = true) const;
+	void tokenize(const Instruction &insn, const std::string &str, std::vector<Token> *tokens) const;
 	QString adjustInstructionText(const Instruction &instruction) const;
 
 private:
@@ -36,7 +36,12 @@ enum class Architecture {
 	ARCH_ARM64
 };
 
+// makes <arch> the one instructions are decoded for unless they ask for
+// another. The handles of every mode used so far stay open, so switching back
+// and forth between them (ARM and Thumb, 32-bit code in a 64-bit process)
+// costs nothing and keeps what was already decoded
 bool init(Architecture arch);
+Architecture architecture();
 
 class Instruction;
 class Formatter;
@@ -44,6 +49,7 @@ class Formatter;
 class Instruction {
 	friend class Formatter;
 	friend class Operand;
+	friend class Decoder;
 
 public:
 #if defined EDB_X86 || defined EDB_X86_64
@@ -54,6 +60,7 @@ public:
 
 public:
 	Instruction(const void *first, const void *end, uint64_t rva) noexcept;
+	Instruction(const void *first, const void *end, uint64_t rva, Architecture arch) noexcept;
 	Instruction(const Instruction &)            = delete;
 	Instruction &operator=(const Instruction &) = delete;
 	Instruction(Instruction &&);
@@ -85,6 +92,7 @@ public:
 	uint64_t rva() const              { return insn_ ? insn_->address              : rva_;          }
 	std::string mnemonic() const      { return insn_ ? insn_->mnemonic             : std::string(); }
 	const uint8_t *bytes() const      { return insn_ ? insn_->bytes                : &byte0_;       }
+	Architecture architecture() const { return arch_; }
 
 public:
 	Operand operator[](size_t n) const;
@@ -161,16 +169,23 @@ public:
 	ConditionCode condition_code() const;
 
 private:
-	cs_insn *insn_;
-	
+	Instruction() noexcept = default;
+
+private:
+	cs_insn     *insn_  = nullptr;
+	bool         owned_ = true; // false when a Decoder lends out its buffer
+	Architecture arch_  = Architecture::ARCH_X86; // the mode it was decoded in
+
 	// we have our own copies of this data so we can give something meaningful
 	// even during a failed disassembly
-	uint8_t  byte0_ = 0;
-	uint64_t rva_   = 0;
+	uint8_t      byte0_ = 0;
+	uint64_t     rva_   = 0;
 };
 
 }
 
 #include "Inspection.h"
+#include "DecodeCache.h"
+#include "Decoder.h"
 
 #endif
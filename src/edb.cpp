@@ -27,17 +27,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DialogOptions.h"
 #include "Expression.h"
 #include "ExpressionDialog.h"
+#include "HeatRange.h"
 #include "IBreakpoint.h"
+#include "IDebugEvent.h"
+#include "IDebugEventHandler.h"
 #include "IDebugger.h"
 #include "IPlugin.h"
 #include "IProcess.h"
 #include "IRegion.h"
+#include "IThread.h"
+#include "Instrumentation.h"
 #include "MemoryRegions.h"
 #include "Prototype.h"
 #include "QHexView"
 #include "State.h"
+#include "StepFilter.h"
+#include "StringProbe.h"
 #include "Symbol.h"
 #include "SymbolManager.h"
+#include "TaskScheduler.h"
+#include "TraceLog.h"
 #include "version.h"
 
 #include <QAction>
@@ -45,14 +54,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QByteArray>
 #include <QCompleter>
 #include <QCoreApplication>
-#include <QDomDocument>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QXmlStreamReader>
 #include <QCryptographicHash>
 
 #include <QDebug>
+#include <algorithm>
 #include <cctype>
+#include <vector>
 
 IDebugger *edb::v1::debugger_core = 0;
 QWidget   *edb::v1::debugger_ui   = 0;
@@ -65,10 +80,123 @@ namespace {
 	std::deque<IDebugEventHandler*>    g_DebugEventHandlers;
 	QAtomicPointer<IAnalyzer>          g_Analyzer          = 0;
 	QMap<QString, QObject *>           g_GeneralPlugins;
+	QHash<QString, qint64>             g_PluginStartupTimes;
 	BinaryInfoList                     g_BinaryInfoList;
 	CapstoneEDB::Formatter             g_Formatter;
 
-	QHash<QString, edb::Prototype>     g_FunctionDB;
+	// what find_function_symbol made of an address, for as long as the
+	// symbols and the offset format stay the same
+	struct FunctionSymbol {
+		QString name;   // empty if there is no symbol before the address
+		int     offset;
+	};
+
+	const int MAX_FUNCTION_SYMBOLS = 8192;
+
+	QHash<edb::address_t, FunctionSymbol> g_FunctionSymbols;
+	quint64                               g_FunctionSymbolsGeneration = 0;
+	bool                                  g_FunctionSymbolsHex        = false;
+
+	// the parsed binary (or nullptr, if no parser took it) of each named
+	// region by where it starts, for as long as the modules stay the same
+	struct CachedBinary {
+		QString                  module;
+		std::shared_ptr<IBinary> binary;
+	};
+
+	QHash<edb::address_t, CachedBinary> g_BinaryInfos;
+	quint64                             g_BinaryInfosGeneration = 0;
+
+	// the MD5 of each file hashed, for as long as its size and modification
+	// time stay the same. The same modules are checked again whenever their
+	// symbols load, and hashing a large one takes a while. Symbol files are
+	// made on the thread pool, so this is locked
+	struct FileMD5 {
+		qint64     size;
+		QDateTime  modified;
+		QByteArray md5;
+	};
+
+	QMutex                   g_FileMD5sMutex;
+	QHash<QString, FileMD5>  g_FileMD5s;
+
+	// where locate_main_function found main in each executable, relative to
+	// the region it is in so that it still holds once the executable is
+	// loaded somewhere else. Restarting the same binary then needn't
+	// parse it and search for main again
+	struct MainFunction {
+		QByteArray md5;
+		quint64    offset;
+	};
+
+	QHash<QString, MainFunction> g_MainFunctions;
+
+	// asks each of the parsers, they turn down regions which don't start with
+	// the magic of their format by returning NULL, so only a damaged header in
+	// the right format can still make one throw
+	std::shared_ptr<IBinary> create_binary_info(const std::shared_ptr<IRegion> &region) {
+		Q_FOREACH(IBinary::create_func_ptr_t f, g_BinaryInfoList) {
+			try {
+				if(std::unique_ptr<IBinary> p = (*f)(region)) {
+					// reorder the list to put this successful plugin
+					// in front.
+					if (g_BinaryInfoList[0] != f) {
+						g_BinaryInfoList.removeOne(f);
+						g_BinaryInfoList.push_front(f);
+					}
+					return std::move(p);
+				}
+			} catch (const std::exception &e) {
+				qDebug() << "[edb] failed to parse the binary at" << region->start().toPointerString() << ":" << e.what();
+			}
+		}
+
+		return nullptr;
+	}
+
+	// the handlers interested in each kind of event, in the order of the
+	// handler chain, along with what they asked for. so an event only goes
+	// past the handlers which want it
+	struct InterestedHandler {
+		IDebugEventHandler             *handler;
+		IDebugEventHandler::Interest    interest;
+	};
+
+	const int EVENT_KINDS = 5;
+
+	std::vector<InterestedHandler> g_DispatchTables[EVENT_KINDS];
+
+	void rebuild_dispatch_tables() {
+		for(std::vector<InterestedHandler> &table : g_DispatchTables) {
+			table.clear();
+		}
+
+		for(IDebugEventHandler *handler : g_DebugEventHandlers) {
+			const IDebugEventHandler::Interest interest = handler->interest();
+			for(int kind = 0; kind < EVENT_KINDS; ++kind) {
+				if(interest.kinds & (1u << kind)) {
+					g_DispatchTables[kind].push_back({ handler, interest });
+				}
+			}
+		}
+	}
+
+	// the position of the event's EventKind bit
+	int event_kind(const std::shared_ptr<IDebugEvent> &e) {
+		if(!e->stopped()) {
+			return 4; // EVENT_EXIT
+		}
+
+		if(e->is_trap()) {
+			switch(e->trap_reason()) {
+			case IDebugEvent::TRAP_STEPPING:   return 0; // EVENT_STEP
+			case IDebugEvent::TRAP_BREAKPOINT: return 1; // EVENT_BREAKPOINT
+			case IDebugEvent::TRAP_SYSCALL:    return 2; // EVENT_SYSCALL
+			}
+		}
+
+		return 3; // EVENT_SIGNAL
+	}
 
 	Debugger *ui() {
 		return qobject_cast<Debugger *>(edb::v1::debugger_ui);
@@ -88,6 +216,63 @@ namespace {
 		*offset = 0;
 		return false;
 	}
+
+	// the prototypes of functions.xml, read with a stream reader the first
+	// time one is asked for rather than at startup
+	QHash<QString, edb::Prototype> load_function_db() {
+
+		QHash<QString, edb::Prototype> db;
+
+		QFile file(":/debugger/xml/functions.xml");
+		if(!file.open(QIODevice::ReadOnly)) {
+			return db;
+		}
+
+		QXmlStreamReader xml(&file);
+		edb::Prototype func;
+		bool in_function = false;
+
+		while(!xml.atEnd()) {
+			switch(xml.readNext()) {
+			case QXmlStreamReader::StartElement:
+				if(xml.name() == QLatin1String("function")) {
+					const QXmlStreamAttributes attributes = xml.attributes();
+					func          = edb::Prototype();
+					func.name     = attributes.value("name").toString();
+					func.type     = attributes.value("type").toString();
+					func.noreturn = attributes.value("noreturn") == QLatin1String("true");
+					in_function   = true;
+				} else if(in_function && xml.name() == QLatin1String("argument")) {
+					const QXmlStreamAttributes attributes = xml.attributes();
+					edb::Argument arg;
+					arg.name = attributes.value("name").toString();
+					arg.type = attributes.value("type").toString();
+					func.arguments.push_back(arg);
+				}
+				break;
+			case QXmlStreamReader::EndElement:
+				if(in_function && xml.name() == QLatin1String("function")) {
+					db[func.name] = func;
+					in_function   = false;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+		if(xml.hasError()) {
+			qDebug() << "error reading functions.xml:" << xml.errorString();
+		}
+
+		return db;
+	}
+
+	// the analyzer asks from its worker threads too, the first one loads it
+	const QHash<QString, edb::Prototype> &function_db() {
+		static const QHash<QString, edb::Prototype> db = load_function_db();
+		return db;
+	}
 }
 
 namespace edb {
@@ -110,38 +295,20 @@ bool register_plugin(const QString &filename, QObject *plugin) {
 }
 
 //------------------------------------------------------------------------------
-// Name:
-// Desc:
+// Name: add_plugin_startup_time
+// Desc: loading and setting up a plugin are timed separately, this adds up
+//       what each of them took
 //------------------------------------------------------------------------------
-void load_function_db() {
-	QFile file(":/debugger/xml/functions.xml");
-	QDomDocument doc;
-
-	if(file.open(QIODevice::ReadOnly)) {
-		if(doc.setContent(&file)) {
-			QDomElement root = doc.firstChildElement("functions");
-			QDomElement function = root.firstChildElement("function");
-			for (; !function.isNull(); function = function.nextSiblingElement("function")) {
-
-
-				Prototype func;
-				func.name     = function.attribute("name");
-				func.type     = function.attribute("type");
-				func.noreturn = function.attribute("noreturn", "false") == "true";
-
-				QDomElement argument = function.firstChildElement("argument");
-				for (; !argument.isNull(); argument = argument.nextSiblingElement("argument")) {
-
-					Argument arg;
-					arg.name = argument.attribute("name");
-					arg.type = argument.attribute("type");
-					func.arguments.push_back(arg);
-				}
+void add_plugin_startup_time(const QString &filename, qint64 msecs) {
+	g_PluginStartupTimes[filename] += msecs;
+}
 
-				g_FunctionDB[func.name] = func;
-			}
-		}
-	}
+//------------------------------------------------------------------------------
+// Name: plugin_startup_time
+// Desc:
+//------------------------------------------------------------------------------
+qint64 plugin_startup_time(const QString &filename) {
+	return g_PluginStartupTimes.value(filename);
 }
 
 }
@@ -213,6 +380,16 @@ void repaint_cpu_view() {
 	gui->ui.cpuView->update();
 }
 
+//------------------------------------------------------------------------------
+// Name: set_code_heat
+// Desc:
+//------------------------------------------------------------------------------
+void set_code_heat(const QVector<HeatRange> &ranges) {
+	Debugger *const gui = ui();
+	Q_ASSERT(gui);
+	gui->ui.cpuView->setHeat(ranges);
+}
+
 //------------------------------------------------------------------------------
 // Name: symbol_manager
 // Desc:
@@ -231,6 +408,24 @@ MemoryRegions &memory_regions() {
 	return g_MemoryRegions;
 }
 
+//------------------------------------------------------------------------------
+// Name: trace_log
+// Desc:
+//------------------------------------------------------------------------------
+TraceLog &trace_log() {
+	static TraceLog g_TraceLog;
+	return g_TraceLog;
+}
+
+//------------------------------------------------------------------------------
+// Name: task_scheduler
+// Desc:
+//------------------------------------------------------------------------------
+TaskScheduler &task_scheduler() {
+	static TaskScheduler g_TaskScheduler;
+	return g_TaskScheduler;
+}
+
 //------------------------------------------------------------------------------
 // Name: arch_processor
 // Desc:
@@ -267,13 +462,42 @@ IAnalyzer *analyzer() {
 //------------------------------------------------------------------------------
 EVENT_STATUS execute_debug_event_handlers(const std::shared_ptr<IDebugEvent> &e) {
 
+	EDB_TRACE_SEGMENT("execute_debug_event_handlers", EventHandlers);
+
 	// if somehow no handler is run, then let's just assume we should stop...
 	EVENT_STATUS status = DEBUG_STOP;
 
-	// loop through all of the handlers, stopping when one thinks that it handled
-	// the event
-	for(auto it = g_DebugEventHandlers.begin(); it != g_DebugEventHandlers.end(); ++it) {
-		status = (*it)->handle_event(e);
+	const int kind = event_kind(e);
+
+	// only read when some handler asked for an address range
+	bool           have_ip = false;
+	edb::address_t ip      = 0;
+
+	// loop through the handlers interested in this kind of event, stopping
+	// when one thinks that it handled the event
+	for(const InterestedHandler &entry : g_DispatchTables[kind]) {
+		const IDebugEventHandler::Interest &interest = entry.interest;
+
+		if(kind == 3 && !interest.signal_codes.isEmpty() && !interest.signal_codes.contains(e->code())) {
+			continue;
+		}
+
+		if(interest.high != 0 && e->stopped()) {
+			if(!have_ip) {
+				if(IProcess *process = debugger_core ? debugger_core->process() : nullptr) {
+					if(std::shared_ptr<IThread> thread = process->current_thread()) {
+						ip = thread->instruction_pointer();
+					}
+				}
+				have_ip = true;
+			}
+
+			if(ip < interest.low || ip >= interest.high) {
+				continue;
+			}
+		}
+
+		status = entry.handler->handle_event(e);
 		if(status != DEBUG_NEXT_HANDLER) {
 			break;
 		}
@@ -284,6 +508,38 @@ EVENT_STATUS execute_debug_event_handlers(const std::shared_ptr<IDebugEvent> &e)
 	return status;
 }
 
+//------------------------------------------------------------------------------
+// Name: signal_policy
+// Desc: the signals set to be ignored or logged in the options are passed
+//       unless a handler besides the bottom one asked for them, watchpoints
+//       for one are faults on purpose
+//------------------------------------------------------------------------------
+SIGNAL_POLICY signal_policy(int signal) {
+
+	const Configuration &config = edb::v1::config();
+
+	SIGNAL_POLICY policy = SIGNAL_STOP;
+	if(config.logged_exceptions.contains(signal)) {
+		policy = SIGNAL_LOG;
+	} else if(config.ignored_exceptions.contains(signal)) {
+		policy = SIGNAL_PASS;
+	}
+
+	if(policy == SIGNAL_STOP) {
+		return policy;
+	}
+
+	const std::vector<InterestedHandler> &table = g_DispatchTables[3];
+	for(std::size_t i = 0; i + 1 < table.size(); ++i) {
+		const IDebugEventHandler::Interest &interest = table[i].interest;
+		if(interest.signal_codes.isEmpty() || interest.signal_codes.contains(signal)) {
+			return SIGNAL_STOP;
+		}
+	}
+
+	return policy;
+}
+
 //------------------------------------------------------------------------------
 // Name: add_debug_event_handler
 // Desc:
@@ -292,6 +548,7 @@ void add_debug_event_handler(IDebugEventHandler *p) {
 	auto it = std::find(g_DebugEventHandlers.begin(), g_DebugEventHandlers.end(), p);
 	if(it == g_DebugEventHandlers.end()) {
 		g_DebugEventHandlers.push_front(p);
+		rebuild_dispatch_tables();
 	}
 }
 
@@ -303,6 +560,18 @@ void remove_debug_event_handler(IDebugEventHandler *p) {
 	auto it = std::find(g_DebugEventHandlers.begin(), g_DebugEventHandlers.end(), p);
 	if(it != g_DebugEventHandlers.end()) {
 		g_DebugEventHandlers.erase(it);
+		rebuild_dispatch_tables();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: refresh_debug_event_handler
+// Desc: reads the handler's interest again, for when it has changed
+//------------------------------------------------------------------------------
+void refresh_debug_event_handler(IDebugEventHandler *p) {
+	auto it = std::find(g_DebugEventHandlers.begin(), g_DebugEventHandlers.end(), p);
+	if(it != g_DebugEventHandlers.end()) {
+		rebuild_dispatch_tables();
 	}
 }
 
@@ -383,6 +652,35 @@ void set_breakpoint_condition(address_t address, const QString &condition) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: set_breakpoint_tracepoint
+// Desc: a tracepoint records each hit in trace_log() (the value of
+//       <expression>, or the registers if it's empty) and then continues
+//       instead of stopping
+//------------------------------------------------------------------------------
+void set_breakpoint_tracepoint(address_t address, bool tracepoint, const QString &expression) {
+
+	if(std::shared_ptr<IBreakpoint> bp = find_breakpoint(address)) {
+		bp->tracepoint       = tracepoint;
+		bp->trace_expression = expression;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_breakpoint_filters
+// Desc: the hits of a breakpoint which don't stop, without a condition: the
+//       first <ignore_count>, those after <hit_limit> (0 for no limit) and
+//       those by threads not in <threads> (empty for any thread)
+//------------------------------------------------------------------------------
+void set_breakpoint_filters(address_t address, quint64 ignore_count, quint64 hit_limit, const QSet<tid_t> &threads) {
+
+	if(std::shared_ptr<IBreakpoint> bp = find_breakpoint(address)) {
+		bp->ignore_count = ignore_count;
+		bp->hit_limit    = hit_limit;
+		bp->threads      = threads;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: get_breakpoint_condition
 // Desc:
@@ -500,6 +798,59 @@ void toggle_breakpoint(address_t address) {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: add_pending_breakpoint
+// Desc:
+//------------------------------------------------------------------------------
+bool add_pending_breakpoint(const QString &location) {
+
+	PendingBreakpoints::Breakpoint breakpoint;
+	if(!PendingBreakpoints::parse(location, &breakpoint)) {
+		return false;
+	}
+
+	Debugger *const gui = ui();
+	Q_ASSERT(gui);
+	if(!gui->add_pending_breakpoint(breakpoint)) {
+		return false;
+	}
+
+	repaint_cpu_view();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_pending_breakpoint
+// Desc:
+//------------------------------------------------------------------------------
+bool remove_pending_breakpoint(const QString &location) {
+
+	PendingBreakpoints::Breakpoint breakpoint;
+	if(!PendingBreakpoints::parse(location, &breakpoint)) {
+		return false;
+	}
+
+	Debugger *const gui = ui();
+	Q_ASSERT(gui);
+	return gui->remove_pending_breakpoint(breakpoint);
+}
+
+//------------------------------------------------------------------------------
+// Name: pending_breakpoints
+// Desc:
+//------------------------------------------------------------------------------
+QStringList pending_breakpoints() {
+
+	Debugger *const gui = ui();
+	Q_ASSERT(gui);
+
+	QStringList results;
+	for(const PendingBreakpoints::Breakpoint &breakpoint : gui->pending_breakpoints()) {
+		results.push_back(PendingBreakpoints::to_string(breakpoint));
+	}
+	return results;
+}
+
 //------------------------------------------------------------------------------
 // Name: remove_breakpoint
 // Desc: removes a breakpoint
@@ -517,11 +868,10 @@ bool eval_expression(const QString &expression, address_t *value) {
 
 	Q_ASSERT(value);
 
-	Expression<address_t> expr(expression, get_variable, get_value);
 	ExpressionError err;
 
 	bool ok;
-	const address_t address = expr.evaluate_expression(&ok, &err);
+	const address_t address = evaluate_expression(expression, &ok, &err);
 	if(ok) {
 		*value = address;
 		return true;
@@ -620,37 +970,139 @@ Configuration &config() {
 	return g_Configuration;
 }
 
+namespace {
+
+// the longest string get_human_string_at_address shows, in characters
+const int HUMAN_STRING_LENGTH = 256;
+
+// how much of each address get_human_strings_at_addresses reads first, which
+// is enough to turn down almost everything which isn't a string
+const std::size_t HUMAN_STRING_PROBE = 64;
+
+//------------------------------------------------------------------------------
+// Name: human_string
+// Desc: what get_human_string_at_address shows for <data>, if anything
+//------------------------------------------------------------------------------
+bool human_string(const quint8 *data, std::size_t size, int min_length, QString *s) {
+
+	QString string_param;
+
+	if(StringProbe::ascii_string(data, size, min_length, HUMAN_STRING_LENGTH, &string_param)) {
+		*s = QString("ASCII \"%1\"").arg(string_param);
+		return true;
+	} else if(StringProbe::utf16_string(data, size, min_length, HUMAN_STRING_LENGTH, &string_param)) {
+		*s = QString("UTF16 \"%1\"").arg(string_param);
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: needs_more
+// Desc: true if what is in a full probe of <size> bytes may be the start of a
+//       string which goes on past it, so it can't be decided on yet
+//------------------------------------------------------------------------------
+bool needs_more(const quint8 *data, std::size_t size, int min_length) {
+
+	const std::size_t ascii = StringProbe::ascii_run(data, size);
+	if(ascii == size) {
+		return true;
+	}
+
+	if(ascii >= static_cast<std::size_t>(min_length)) {
+		return false;
+	}
+
+	return StringProbe::utf16_run(data, size) == size / 2;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: get_human_string_at_address
 // Desc: attempts to create a summary of the content at address appropriate for
 // display in a user interface.
 // Note: strings are comprised of printable characters and whitespace.
-// Note: found_length is needed because we replace characters which need an
-//       escape char with the escape sequence (thus the resultant string may be
-//       longer than the original). found_length is the original length.
 //------------------------------------------------------------------------------
-
 bool get_human_string_at_address(address_t address, QString &s) {
-	bool ret = false;
-	if (address > 0x10000ULL) { // FIXME use page size
-		QString string_param;
-		int string_length;
-
-		if (get_ascii_string_at_address(address, string_param, edb::v1::config().min_string_length, 256, string_length)) {
-			ret = true;
-			s.append(
-				QString("ASCII \"%1\" ").arg(string_param)
-			);
-		} else if (get_utf16_string_at_address(address, string_param, edb::v1::config().min_string_length, 256, string_length)) {
-			ret = true;
-			s.append(
-				QString("UTF16 \"%1\" ").arg(string_param)
-			);
-		}
+
+	const QString string = get_human_strings_at_addresses(QVector<address_t>(1, address)).front();
+	if(string.isEmpty()) {
+		return false;
 	}
-	return ret;
+
+	s.append(string + QLatin1Char(' '));
+	return true;
 }
 
+//------------------------------------------------------------------------------
+// Name: get_human_strings_at_addresses
+// Desc: what get_human_string_at_address finds at each of <addresses>, empty
+//       where there is no string. The start of every one is read with a single
+//       vectored read, nearly all are decided by that, and only the few which
+//       may be longer are read again in full, together
+//------------------------------------------------------------------------------
+QVector<QString> get_human_strings_at_addresses(const QVector<address_t> &addresses) {
+
+	QVector<QString> strings(addresses.size());
+
+	IProcess *const process = debugger_core ? debugger_core->process() : nullptr;
+	if(!process) {
+		return strings;
+	}
+
+	const int min_length = config().min_string_length;
+
+	QVector<int>         candidates;
+	QVector<ReadRequest> requests;
+	QVector<quint8>      probes(addresses.size() * HUMAN_STRING_PROBE);
+
+	for(int i = 0; i < addresses.size(); ++i) {
+		if(addresses[i] > 0x10000ULL) { // FIXME use page size
+			candidates.push_back(i);
+			requests.push_back(ReadRequest{addresses[i], &probes[i * HUMAN_STRING_PROBE], HUMAN_STRING_PROBE});
+		}
+	}
+
+	if(requests.isEmpty()) {
+		return strings;
+	}
+
+	const QVector<std::size_t> probe_sizes = process->read_many(requests);
+
+	QVector<int> longer;
+	for(int j = 0; j < candidates.size(); ++j) {
+		const int i         = candidates[j];
+		const quint8 *probe = &probes[i * HUMAN_STRING_PROBE];
+
+		if(probe_sizes[j] == HUMAN_STRING_PROBE && needs_more(probe, HUMAN_STRING_PROBE, min_length)) {
+			longer.push_back(i);
+		} else {
+			human_string(probe, probe_sizes[j], min_length, &strings[i]);
+		}
+	}
+
+	if(longer.isEmpty()) {
+		return strings;
+	}
+
+	// enough for the longest string of either kind
+	const std::size_t full_size = HUMAN_STRING_LENGTH * sizeof(quint16);
+
+	QVector<quint8> full(longer.size() * full_size);
+	requests.clear();
+	for(int j = 0; j < longer.size(); ++j) {
+		requests.push_back(ReadRequest{addresses[longer[j]], &full[j * full_size], full_size});
+	}
+
+	const QVector<std::size_t> full_sizes = process->read_many(requests);
+	for(int j = 0; j < longer.size(); ++j) {
+		human_string(&full[j * full_size], full_sizes[j], min_length, &strings[longer[j]]);
+	}
+
+	return strings;
+}
 
 //------------------------------------------------------------------------------
 // Name: get_ascii_string_at_address
@@ -759,23 +1211,46 @@ bool get_utf16_string_at_address(address_t address, QString &s, int min_length,
 //------------------------------------------------------------------------------
 QString find_function_symbol(address_t address, const QString &default_value, int *offset) {
 
-	QString symname(default_value);
-	int off;
+	const bool hex = config().function_offsets_in_hex;
 
-	if(function_symbol_base(address, &symname, &off)) {
+	if(g_FunctionSymbolsGeneration != symbol_manager().generation() || g_FunctionSymbolsHex != hex || g_FunctionSymbols.size() >= MAX_FUNCTION_SYMBOLS) {
+		g_FunctionSymbols.clear();
+		g_FunctionSymbolsGeneration = symbol_manager().generation();
+		g_FunctionSymbolsHex        = hex;
+	}
+
+	auto it = g_FunctionSymbols.find(address);
+	if(it == g_FunctionSymbols.end()) {
 
-        if(config().function_offsets_in_hex) {
-            symname = QString("%1+0x%2").arg(symname).arg(off, 0, 16);
-        } else {
-            symname = QString("%1+%2").arg(symname).arg(off, 0, 10);
-        }
+		FunctionSymbol entry;
+		QString symname;
 
-		if(offset) {
-			*offset = off;
+		if(function_symbol_base(address, &symname, &entry.offset)) {
+			if(hex) {
+				entry.name = QString("%1+0x%2").arg(symname).arg(entry.offset, 0, 16);
+			} else {
+				entry.name = QString("%1+%2").arg(symname).arg(entry.offset, 0, 10);
+			}
 		}
+
+		// the lookup may have loaded the symbols of a module
+		if(g_FunctionSymbolsGeneration != symbol_manager().generation()) {
+			g_FunctionSymbols.clear();
+			g_FunctionSymbolsGeneration = symbol_manager().generation();
+		}
+
+		it = g_FunctionSymbols.insert(address, entry);
 	}
 
-	return symname;
+	if(it->name.isEmpty()) {
+		return default_value;
+	}
+
+	if(offset) {
+		*offset = it->offset;
+	}
+
+	return it->name;
 }
 
 //------------------------------------------------------------------------------
@@ -806,6 +1281,19 @@ address_t get_variable(const QString &s, bool *ok, ExpressionError *err) {
 
 	State state;
 	debugger_core->get_state(&state);
+	return get_state_variable(state, s, ok, err);
+}
+
+//------------------------------------------------------------------------------
+// Name: get_state_variable
+// Desc: like get_variable, but registers are read from an already fetched
+//       state, so evaluating an expression needs to fetch it only once
+//------------------------------------------------------------------------------
+address_t get_state_variable(const State &state, const QString &s, bool *ok, ExpressionError *err) {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(err);
+
 	const Register reg = state.value(s);
 	*ok = reg.valid();
 	if(!*ok) {
@@ -830,6 +1318,33 @@ address_t get_variable(const QString &s, bool *ok, ExpressionError *err) {
 	return reg.valueAsAddress();
 }
 
+//------------------------------------------------------------------------------
+// Name: evaluate_expression
+// Desc: evaluates <expression> with all of its registers read from a single
+//       fetch of the state, which is only made once a variable is looked up
+//------------------------------------------------------------------------------
+address_t evaluate_expression(const QString &expression, bool *ok, ExpressionError *err) {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(err);
+
+	State state;
+	bool fetched = false;
+
+	auto state_variable = [&state, &fetched](const QString &name, bool *ok, ExpressionError *err) {
+		if(!fetched) {
+			if(debugger_core) {
+				debugger_core->get_state(&state);
+			}
+			fetched = true;
+		}
+		return get_state_variable(state, name, ok, err);
+	};
+
+	Expression<address_t> expr(expression, state_variable, get_value);
+	return expr.evaluate_expression(ok, err);
+}
+
 //------------------------------------------------------------------------------
 // Name: get_value
 // Desc:
@@ -877,36 +1392,100 @@ bool get_instruction_bytes(address_t address, quint8 *buf, int *size) {
 //------------------------------------------------------------------------------
 // Name: get_binary_info
 // Desc: gets an object which knows how to analyze the binary file provided
-//       or NULL if none-found.
-// Note: the caller is responsible for deleting the object!
-//------------------------------------------------------------------------------
-std::unique_ptr<IBinary> get_binary_info(const std::shared_ptr<IRegion> &region) {
-	Q_FOREACH(IBinary::create_func_ptr_t f, g_BinaryInfoList) {
-		try {
-			std::unique_ptr<IBinary> p((*f)(region));
-			// reorder the list to put this successful plugin
-			// in front.
-			if (g_BinaryInfoList[0] != f) {
-				g_BinaryInfoList.removeOne(f);
-				g_BinaryInfoList.push_front(f);
+//       or NULL if none-found. The object is shared with everyone else who
+//       asks about the same module region until the modules change, regions
+//       without a name could be anything next time, so they are parsed anew
+//------------------------------------------------------------------------------
+std::shared_ptr<IBinary> get_binary_info(const std::shared_ptr<IRegion> &region) {
+
+	if(!region) {
+		return nullptr;
+	}
+
+	const QString module = region->name();
+	if(module.isEmpty()) {
+		return create_binary_info(region);
+	}
+
+	const quint64 generation = memory_regions().modules_generation();
+	if(generation != g_BinaryInfosGeneration) {
+		g_BinaryInfos.clear();
+		g_BinaryInfosGeneration = generation;
+	}
+
+	auto it = g_BinaryInfos.find(region->start());
+	if(it == g_BinaryInfos.end() || it->module != module) {
+		it = g_BinaryInfos.insert(region->start(), CachedBinary{module, create_binary_info(region)});
+	}
+
+	return it->binary;
+}
+
+//------------------------------------------------------------------------------
+// Name: module_cache_path
+// Desc: where what <kind> of plugin learns about <region> is kept between
+//       sessions, next to the module's path under the session directory. The
+//       name carries where the region is in the module's own address space,
+//       so it stays the same wherever the module is loaded. Empty if the
+//       region is not part of a module or there is no session directory
+//------------------------------------------------------------------------------
+QString module_cache_path(const std::shared_ptr<IRegion> &region, const QString &kind) {
+	if (region->name().isEmpty()) {
+		return QString();
+	}
+
+	QString session_path = config().session_path;
+	if(session_path.isEmpty()) {
+		return QString();
+	}
+
+	// We need the base address of this region. However, this region might not
+	// be the same region that has the header. For instance, on Windows the
+	// PE header is not in the same region as the ELF header. The binary might
+	// also have multiple code sections.
+	address_t base_address = 0;
+	address_t loaded_address = 0;
+	{
+		QList<std::shared_ptr<IRegion>> regions = memory_regions().regions();
+		bool base_addr_found = false;
+		for(const std::shared_ptr<IRegion> &iregion: regions) {
+			if (iregion->name() == region->name()) {
+				if(auto binary_info = get_binary_info(iregion)) {
+					base_address = binary_info->base_address();
+					loaded_address = iregion->start();
+					base_addr_found = true;
+					break;
+				}
 			}
-			return p;
+		}
 
-		} catch (std::exception e) {
-			// let's just ignore it...
+		if (!base_addr_found) {
+			return QString();
 		}
 	}
 
-#if 0
-	qDebug() << "Failed to find any binary parser for region"
-		<< QString::number(region->start(), 16);
-#endif
-	return nullptr;
+	QFileInfo info(region->name());
+
+	if(info.isRelative()) {
+		info.makeAbsolute();
+	}
+
+	auto path          = QString("%1/%2").arg(session_path, info.absolutePath());
+	const QString name = info.fileName();
+
+	// ensure that the sub-directory exists
+	QDir().mkpath(path);
+
+	return QString("%1/%2.%3.%4").arg(
+		path,
+		name,
+		kind,
+		QString::number(region->start() - loaded_address + base_address, 16));
 }
 
 //------------------------------------------------------------------------------
 // Name: locate_main_function
-// Desc:
+// Desc: the result is remembered for as long as the executable stays the same
 // Note: this currently only works for glibc linked elf files
 //------------------------------------------------------------------------------
 address_t locate_main_function() {
@@ -916,13 +1495,26 @@ address_t locate_main_function() {
 			const address_t address = process->code_address();
 			memory_regions().sync();
 			if(std::shared_ptr<IRegion> region = memory_regions().find_region(address)) {
+
+				const QString module = region->name();
+				const QByteArray md5 = module.isEmpty() ? QByteArray() : get_file_md5(module);
+
+				auto it = g_MainFunctions.find(module);
+				if(it != g_MainFunctions.end() && !md5.isEmpty() && it->md5 == md5 && it->offset < region->size().toUint()) {
+					return region->start() + it->offset;
+				}
+
 				if(auto binfo = get_binary_info(region)) {
-					const address_t main_func = binfo->calculate_main();
-					if(main_func != 0) {
-						return main_func;
-					} else {
-						return binfo->entry_point();
+					address_t main_func = binfo->calculate_main();
+					if(main_func == 0) {
+						main_func = binfo->entry_point();
 					}
+
+					if(!md5.isEmpty() && main_func >= region->start() && main_func < region->end()) {
+						g_MainFunctions.insert(module, MainFunction{md5, (main_func - region->start()).toUint()});
+					}
+
+					return main_func;
 				}
 			}
 		}
@@ -966,14 +1558,40 @@ void reload_symbols() {
 //------------------------------------------------------------------------------
 const Prototype *get_function_info(const QString &function) {
 
-	auto it = g_FunctionDB.find(function);
-	if(it != g_FunctionDB.end()) {
+	const QHash<QString, Prototype> &db = function_db();
+
+	auto it = db.find(function);
+	if(it != db.end()) {
 		return &(it.value());
 	}
 
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+// Name: module_step_filter
+// Desc: the executable regions of the modules named, by either their file
+//       name or their full path
+//------------------------------------------------------------------------------
+StepFilter module_step_filter(const QStringList &modules) {
+
+	StepFilter filter;
+
+	memory_regions().sync();
+	for(const std::shared_ptr<IRegion> &region : memory_regions().regions()) {
+		if(!region->executable() || region->name().isEmpty()) {
+			continue;
+		}
+
+		const QString name = region->name();
+		if(modules.contains(name) || modules.contains(QFileInfo(name).fileName())) {
+			filter.ranges.push_back({ region->start(), region->end() });
+		}
+	}
+
+	return filter;
+}
+
 //------------------------------------------------------------------------------
 // Name: primary_data_region
 // Desc: returns the main .data section of the main executable module
@@ -1127,7 +1745,7 @@ bool modify_bytes(address_t address, unsigned int size, QByteArray &bytes, quint
 				bytes.push_back(fill);
 			}
 
-			process->write_bytes(address, bytes.data(), size);
+			process->patch_bytes(address, bytes.data(), size);
 
 			// do a refresh, not full update
 			Debugger *const gui = ui();
@@ -1158,17 +1776,46 @@ QByteArray get_md5(const void *p, size_t n) {
 
 //------------------------------------------------------------------------------
 // Name: get_file_md5
-// Desc: returns a byte array representing the MD5 of a file
+// Desc: returns a byte array representing the MD5 of a file. It is the file's
+//       identity in what is kept on disk, so it stays MD5; a file which didn't
+//       change since it was last hashed isn't hashed again
 //------------------------------------------------------------------------------
 QByteArray get_file_md5(const QString &s) {
 
+	const QFileInfo info(s);
+	const QString key = info.absoluteFilePath();
+
+	{
+		QMutexLocker locker(&g_FileMD5sMutex);
+		auto it = g_FileMD5s.find(key);
+		if(it != g_FileMD5s.end() && it->size == info.size() && it->modified == info.lastModified()) {
+			return it->md5;
+		}
+	}
+
 	QFile file(s);
 	file.open(QIODevice::ReadOnly);
 	if(file.isOpen()) {
-		if(file.size() != 0) {
+		const qint64 size = file.size();
+		if(size != 0) {
 			QCryptographicHash hasher(QCryptographicHash::Md5);
-			hasher.addData(file.readAll());
-			return hasher.result();
+
+			// hashed where it is mapped, every module is hashed as its symbols
+			// load and reading each one in whole is a copy for nothing
+			if(const uchar *const data = file.map(0, size)) {
+				const qint64 chunk = 1 << 30;
+				for(qint64 offset = 0; offset < size; offset += chunk) {
+					hasher.addData(reinterpret_cast<const char *>(data + offset), static_cast<int>(std::min(chunk, size - offset)));
+				}
+			} else {
+				hasher.addData(file.readAll());
+			}
+
+			const FileMD5 entry = { size, info.lastModified(), hasher.result() };
+
+			QMutexLocker locker(&g_FileMD5sMutex);
+			g_FileMD5s.insert(key, entry);
+			return entry.md5;
 		}
 	}
 
@@ -1476,7 +2123,7 @@ QString disassemble_address(address_t address) {
 	if(const int size = edb::v1::get_instruction_bytes(address, buffer)) {
 		edb::Instruction inst(buffer, buffer + size, address);
 		if(inst) {
-			return QString::fromStdString(g_Formatter.to_string(inst));
+			return g_Formatter.to_qstring(inst);
 		}
 	}
 
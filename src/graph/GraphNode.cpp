@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QGraphicsColorizeEffect>
 #include <QPainter>
 #include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
 #include <QtDebug>
 
 #include <cmath>
@@ -38,6 +39,7 @@ const int NodeWidth         = 100;
 const int NodeHeight        = 50;
 const int LabelFontSize     = 10;
 const int BorderScaleFactor = 4;
+const qreal LabelDetail     = 0.4; // below this the text is too small to read
 const QColor TextColor      = Qt::black;
 const QColor BorderColor    = Qt::blue;
 const QColor SelectColor    = Qt::lightGray;
@@ -74,7 +76,11 @@ GraphNode::GraphNode(GraphWidget *graph, const QString &text, const QColor &colo
 
 	drawLabel(text);
 
+	// until the first layout every node would be drawn on top of each other
+	setVisible(graph->laidOut_);
+
 	graph->scene()->addItem(this);
+	graph->waitForLayout();
 
 	QString name = QString("Node%1").arg(reinterpret_cast<uintptr_t>(this));
 	node_ = _agnode(graph->graph_, name);
@@ -115,9 +121,15 @@ QRectF GraphNode::boundingRect() const {
 //------------------------------------------------------------------------------
 void GraphNode::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
 
-	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
+	// zoomed out this far, a plain box is all that can be seen anyway
+	if(option->levelOfDetailFromTransform(painter->worldTransform()) < LabelDetail) {
+		painter->fillRect(boundingRect(), isSelected() ? SelectColor : BorderColor);
+		painter->fillRect(picture_.boundingRect(), color_);
+		return;
+	}
+
 	painter->save();
 
 	// draw border
@@ -28,6 +28,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QLabel>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPropertyAnimation>
 #include <QScrollBar>
 #include <QWheelEvent>
@@ -37,6 +39,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cmath>
 
+#if QT_VERSION >= 0x050000
+#ifdef QT_CONCURRENT_LIB
+#include <QtConcurrent>
+#endif
+#elif QT_VERSION >= 0x040800
+#include <QtConcurrentRun>
+
+#ifndef QT_NO_CONCURRENT
+#define QT_CONCURRENT_LIB
+#endif
+#endif
+
 namespace {
 
 const int ScenePadding   = 30000;
@@ -101,21 +115,34 @@ QPointF centerToOrigin(const QPointF &p, qreal width, qreal height) {
     return QPointF(p.x() - width/2, p.y() - height/2);
 }
 
+// graphviz keeps the state of a layout in globals, so no matter how many
+// graphs there are, only one of them may be laid out at a time
+QMutex layoutMutex;
+
+void layoutGraph(GVC_t *context, Agraph_t *graph) {
+	QMutexLocker locker(&layoutMutex);
+	gvFreeLayout(context, graph);
+	gvLayout(context, graph, "dot");
+}
+
 }
 
 //------------------------------------------------------------------------------
 // Name: GraphWidget
 // Desc:
 //------------------------------------------------------------------------------
-GraphWidget::GraphWidget(QWidget *parent) : QGraphicsView(parent), inLayout_(false), HUDLayout_(nullptr), HUDLabel_(nullptr) {
+GraphWidget::GraphWidget(QWidget *parent) : QGraphicsView(parent), inLayout_(false), laidOut_(false), layoutPending_(false), HUDLayout_(nullptr), HUDLabel_(nullptr) {
 
 #if 0
 	setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers)));
 #endif
 	setDragMode(ScrollHandDrag);
+	setOptimizationFlags(QGraphicsView::DontSavePainterState);
 
 	setScene(new GraphicsScene(this));
 
+	connect(&layoutWatcher_, SIGNAL(finished()), this, SLOT(layoutFinished()));
+
 	// Setup the HUD
 	HUDLabel_ = new QLabel(this);
 	HUDLabel_->hide();
@@ -215,41 +242,87 @@ void GraphWidget::setHUDNotification(const QString &s, int duration) {
 
 //------------------------------------------------------------------------------
 // Name: layout
-// Desc:
+// Desc: lays the graph out in the background, the nodes move once it is done.
+//       asking again while a layout runs does one more when it is finished
 //------------------------------------------------------------------------------
 void GraphWidget::layout() {
 
-	inLayout_ = true;
+	if(layoutWatcher_.isRunning()) {
+		layoutPending_ = true;
+		return;
+	}
 
 	qDebug() << "Starting Layout Engine";
 
-#if 1
-	gvFreeLayout(context_, graph_);
-	gvLayout(context_, graph_, "dot");
+#ifdef QT_CONCURRENT_LIB
+	layoutWatcher_.setFuture(QtConcurrent::run(layoutGraph, context_, graph_));
+#else
+	layoutGraph(context_, graph_);
+	layoutFinished();
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: layoutFinished
+// Desc: moves the nodes to where the layout put them, only the edges of the
+//       nodes which actually moved are redone
+//------------------------------------------------------------------------------
+void GraphWidget::layoutFinished() {
+
+	inLayout_ = true;
 
+	const qreal gheight = graphHeight(graph_);
+
+	QSet<GraphEdge *> moved;
 
 	Q_FOREACH(QGraphicsItem *item, items()) {
 		if(auto node = qgraphicsitem_cast<GraphNode *>(item)) {
-			qreal gheight = graphHeight(graph_);
 			if(auto internalNode = node->node_) {
-				QPointF point = toPoint(ND_coord(internalNode), gheight);
-				node->setPos(centerToOrigin(point, node->boundingRect().width(), node->boundingRect().height()));
+				const QPointF point    = toPoint(ND_coord(internalNode), gheight);
+				const QPointF position = centerToOrigin(point, node->boundingRect().width(), node->boundingRect().height());
+				if(position != node->pos() || !laidOut_) {
+					node->setPos(position);
+					moved.unite(node->edges_);
+				}
+			}
+			node->setVisible(true);
+		} else if(auto edge = qgraphicsitem_cast<GraphEdge *>(item)) {
+			// new edges between nodes which stayed put haven't been drawn yet
+			if(edge->childItems().empty()) {
+				moved.insert(edge);
 			}
 		}
 	}
 
-	Q_FOREACH(QGraphicsItem *item, items()) {
-		if(auto edge = qgraphicsitem_cast<GraphEdge *>(item)) {
-			edge->syncState();
-		}
+	for(GraphEdge *edge : moved) {
+		edge->syncState();
 	}
-#endif
+
 	qDebug() << "Layout Complete";
 
 	// make the scene HUGE so it feels like you can just scroll forever
-	scene()->setSceneRect(sceneRect().adjusted(-ScenePadding, -ScenePadding, +ScenePadding, +ScenePadding));
+	const QRectF bounds = scene()->itemsBoundingRect();
+	scene()->setSceneRect(bounds.adjusted(-ScenePadding, -ScenePadding, +ScenePadding, +ScenePadding));
+
+	if(!laidOut_) {
+		laidOut_ = true;
+		centerOn(bounds.center());
+	}
 
 	inLayout_ = false;
+
+	if(layoutPending_) {
+		layoutPending_ = false;
+		layout();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: waitForLayout
+// Desc: the graph may not be touched while it is being laid out
+//------------------------------------------------------------------------------
+void GraphWidget::waitForLayout() {
+	layoutWatcher_.waitForFinished();
 }
 
 //------------------------------------------------------------------------------
@@ -257,6 +330,7 @@ void GraphWidget::layout() {
 // Desc:
 //------------------------------------------------------------------------------
 GraphWidget::~GraphWidget() {
+	waitForLayout();
 	gvFreeLayout(context_, graph_);
 	agclose(graph_);
 	gvFreeContext(context_);
@@ -20,12 +20,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Debugger.h"
 #include "DebuggerInternal.h"
 #include "IDebugger.h"
+#include "HeadlessSession.h"
 #include "IPlugin.h"
 #include "edb.h"
 #include "version.h"
 
 #include <QApplication>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QLibrary>
 #include <QLibraryInfo>
 #include <QMessageBox>
@@ -35,14 +38,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <ctime>
 #include <iostream>
+#include <memory>
 
 namespace {
 
 //------------------------------------------------------------------------------
 // Name: load_plugins
-// Desc: attempts to load all plugins in a given directory
+// Desc: attempts to load all plugins in a given directory, if <only> isn't
+//       empty, just the ones named in it (and the debugger core)
 //------------------------------------------------------------------------------
-void load_plugins(const QString &directory) {
+void load_plugins(const QString &directory, const QStringList &only = QStringList()) {
 
 	QDir plugins_dir(qApp->applicationDirPath());
 
@@ -55,10 +60,25 @@ void load_plugins(const QString &directory) {
 
 	Q_FOREACH(const QString &file_name, plugins_dir.entryList(QDir::Files)) {
 		if(QLibrary::isLibrary(file_name)) {
+
+			if(!only.isEmpty()) {
+				QString name = QFileInfo(file_name).completeBaseName().section('.', 0, 0);
+				if(name.startsWith("lib")) {
+					name.remove(0, 3);
+				}
+
+				if(name != "DebuggerCore" && !only.contains(name, Qt::CaseInsensitive)) {
+					continue;
+				}
+			}
+
 			const QString full_path = plugins_dir.absoluteFilePath(file_name);
 			QPluginLoader loader(full_path);
 			loader.setLoadHints(QLibrary::ExportExternalSymbolsHint);
 
+			QElapsedTimer timer;
+			timer.start();
+
 			if(QObject *const plugin = loader.instance()) {
 
 				// TODO: handle the case where we find more than one core plugin...
@@ -68,6 +88,7 @@ void load_plugins(const QString &directory) {
 					}
 				} else if(qobject_cast<IPlugin *>(plugin)) {
 					if(edb::internal::register_plugin(full_path, plugin)) {
+						edb::internal::add_plugin_startup_time(full_path, timer.elapsed());
 					}
 				}
 			} else {
@@ -86,8 +107,6 @@ int start_debugger(edb::pid_t attach_pid, const QString &program, const QList<QB
 	qDebug() << "Starting edb version:" << edb::version;
 	qDebug("Please Report Bugs & Requests At: https://github.com/eteran/edb-debugger/issues");
 
-	edb::internal::load_function_db();
-
 	// create the main window object
 	Debugger debugger;
 
@@ -124,6 +143,20 @@ int start_debugger(edb::pid_t attach_pid, const QString &program, const QList<QB
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: start_headless
+// Desc: runs <script> against the program without any of the user interface
+//------------------------------------------------------------------------------
+int start_headless(HeadlessSession *session, const QString &script, edb::pid_t attach_pid, const QString &program, const QList<QByteArray> &programArgs) {
+
+	if(!edb::v1::debugger_core) {
+		std::cerr << "edb: failed to load the debugger core plugin, please check the plugin path" << std::endl;
+		return -1;
+	}
+
+	return session->run(script, attach_pid, program, programArgs);
+}
+
 //------------------------------------------------------------------------------
 // Name: load_translations
 // Desc:
@@ -153,6 +186,12 @@ void usage() {
 	std::cerr << " --version                 : output version information and exit" << std::endl;
 	std::cerr << " --dump-version            : display terse version string and exit" << std::endl;
 	std::cerr << " --help                    : display this help and exit" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << " --headless <script> [--plugins <a,b,...>] (--attach <pid> | --run <program> (args...))" << std::endl;
+	std::cerr << "                           : run the commands in <script> without a user interface," << std::endl;
+	std::cerr << "                             loading only the listed plugins (default: DumpState)." << std::endl;
+	std::cerr << "                             commands: break <expr>, continue [pass], step [n], dump," << std::endl;
+	std::cerr << "                             print <expr>, timeout <seconds>, kill, detach, quit" << std::endl;
 
 	for(QObject *plugin: edb::v1::plugin_list()) {
 		if(auto p = qobject_cast<IPlugin *>(plugin)) {
@@ -186,8 +225,17 @@ int main(int argc, char *argv[]) {
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
 #endif
 
-	QApplication app(argc, argv);
-	QApplication::setWindowIcon(QIcon(":/debugger/images/edb48-logo.png"));
+	// a headless session must work without a display, so it doesn't get the
+	// widget stack at all
+	const bool headless = (argc >= 3 && qstrcmp(argv[1], "--headless") == 0);
+
+	std::unique_ptr<QCoreApplication> app;
+	if(headless) {
+		app.reset(new QCoreApplication(argc, argv));
+	} else {
+		app.reset(new QApplication(argc, argv));
+		QApplication::setWindowIcon(QIcon(":/debugger/images/edb48-logo.png"));
+	}
 
 	qsrand(std::time(0));
 
@@ -199,13 +247,35 @@ int main(int argc, char *argv[]) {
 
 	load_translations();
 
-	// look for some plugins..
-	load_plugins(edb::v1::config().plugin_path);
-
-	QStringList args = app.arguments();
+	QStringList args = app->arguments();
 	edb::pid_t        attach_pid = 0;
 	QList<QByteArray> run_args;
 	QString           run_app;
+	QString           script;
+
+	if(headless) {
+		script = args[2];
+		args.erase(args.begin() + 1, args.begin() + 3);
+
+		QStringList plugins("DumpState");
+		if(args.size() >= 3 && args[1] == "--plugins") {
+			plugins = args[2].split(',', QString::SkipEmptyParts);
+			args.erase(args.begin() + 1, args.begin() + 3);
+		}
+
+		// look for the plugins we were asked for..
+		load_plugins(edb::v1::config().plugin_path, plugins);
+	} else {
+		// look for some plugins..
+		load_plugins(edb::v1::config().plugin_path);
+	}
+
+	// the session has to be the last of the debug event handlers, so it must
+	// exist before any plugin gets to add one while parsing its arguments
+	std::unique_ptr<HeadlessSession> session;
+	if(headless) {
+		session.reset(new HeadlessSession);
+	}
 
 	// call the init function for each plugin, this is done after
 	// ALL plugins are loaded in case there are inter-plugin dependencies
@@ -232,8 +302,15 @@ int main(int argc, char *argv[]) {
 		} else if(args.size() >= 3 && args[1] == "--run") {
 			run_app = args[2];
 
-			for(int i = 3; i < args.size(); ++i) {
-				run_args.push_back(argv[i]);
+			if(headless) {
+				// the plugins may have taken arguments out already
+				for(int i = 3; i < args.size(); ++i) {
+					run_args.push_back(args[i].toLocal8Bit());
+				}
+			} else {
+				for(int i = 3; i < args.size(); ++i) {
+					run_args.push_back(argv[i]);
+				}
 			}
 		} else if(args.size() == 2 && args[1] == "--version") {
 			std::cout << "edb version: " << edb::version << std::endl;
@@ -246,5 +323,9 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	if(headless) {
+		return start_headless(session.get(), script, attach_pid, run_app, run_args);
+	}
+
 	return start_debugger(attach_pid, run_app, run_args);
 }
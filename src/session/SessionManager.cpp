@@ -23,14 +23,75 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "QJsonParseError.h"
 #include "edb.h"
 
+#include <QDataStream>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
 #include <QMessageBox>
 
+#include <cstring>
+
 const int  SessionFileVersion  = 1;
 const auto SessionFileIdString = QLatin1String("edb-session");
 
+namespace {
+
+// a binary session is this, followed by the session data as a QDataStream
+// of a QVariantMap, with the plugins' sections in it just like in JSON
+const char BinarySessionMagic[] = "EDBSESS1";
+const int  BinarySessionMagicSize = sizeof(BinarySessionMagic) - 1;
+
+//------------------------------------------------------------------------------
+// Name: read_session_data
+// Desc: reads either format, a binary one straight from the mapped file
+//------------------------------------------------------------------------------
+bool read_session_data(QFile &file, QVariantMap *data, SessionError &session_error) {
+
+  const qint64 size = file.size();
+
+  if(size >= BinarySessionMagicSize) {
+    if(const uchar *const mapped = file.map(0, size)) {
+      if(std::memcmp(mapped, BinarySessionMagic, BinarySessionMagicSize) == 0) {
+        const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped) + BinarySessionMagicSize, size - BinarySessionMagicSize);
+
+        QDataStream stream(bytes);
+        stream.setVersion(QDataStream::Qt_4_6);
+        stream >> *data;
+
+        if(stream.status() != QDataStream::Ok) {
+          session_error.err = SessionError::UnknownError;
+          session_error.setErrorMessage("An error occured while loading the binary session file.");
+          return false;
+        }
+
+        return true;
+      }
+    }
+  }
+
+  file.seek(0);
+  const QByteArray json = file.readAll();
+
+  QJsonParseError error;
+  auto doc = QJsonDocument::fromJson(json, &error);
+  if(error.error != QJsonParseError::NoError) {
+    session_error.err = SessionError::UnknownError;
+    session_error.setErrorMessage(QString("An error occured while loading session JSON file. %1").arg(error.errorString()));
+    return false;
+  }
+
+  if(!doc.isObject()) {
+    session_error.err = SessionError::NotAnObject;
+    session_error.setErrorMessage("Session file is invalid. Not an object.");
+    return false;
+  }
+
+  *data = doc.object().toVariantMap();
+  return true;
+}
+
+}
+
 SessionManager& SessionManager::instance() {
   static SessionManager inst;
   return inst;
@@ -43,27 +104,11 @@ SessionManager& SessionManager::instance() {
 bool SessionManager::load_session(const QString &session_file, SessionError& session_error) {
 
 	QFile file(session_file);
-	if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		QByteArray json = file.readAll();
-		QJsonParseError error;
-		auto doc = QJsonDocument::fromJson(json, &error);
-		if(error.error != QJsonParseError::NoError) {
-	      session_error.err = SessionError::UnknownError;
-	      session_error.setErrorMessage(QString("An error occured while loading session JSON file. %1").arg(error.errorString()));
-
-		  return false;
-		}
-
-		if(!doc.isObject()) {
-	      session_error.err = SessionError::NotAnObject;
-	      session_error.setErrorMessage("Session file is invalid. Not an object.");
-
-		  return false;
+	if(file.open(QIODevice::ReadOnly)) {
+		if(!read_session_data(file, &session_data, session_error)) {
+			return false;
 		}
 
-		QJsonObject object = doc.object();
-		session_data = object.toVariantMap();
-
 		QString id  = session_data["id"].toString();
 		QString ts  = session_data["timestamp"].toString();
 		int version = session_data["version"].toInt();
@@ -77,6 +122,15 @@ bool SessionManager::load_session(const QString &session_file, SessionError& ses
 		  return false;
 		}
 
+		comments_.clear();
+		for(const QVariant &entry : session_data["comments"].toList()) {
+			const QVariantMap comment = entry.toMap();
+			if(const Result<edb::address_t> address = edb::v1::string_to_address(comment["address"].toString())) {
+				comments_.insert(*address, comment["comment"].toString());
+			}
+		}
+		session_data.remove("comments");
+
 		qDebug("Loading session file");
 		load_plugin_data(); //First, load the plugin-data
 		return true;
@@ -88,7 +142,7 @@ bool SessionManager::load_session(const QString &session_file, SessionError& ses
 // Name: save_session
 // Desc:
 //------------------------------------------------------------------------------
-void SessionManager::save_session(const QString &session_file) {
+void SessionManager::save_session(const QString &session_file, Format format) {
 
 	qDebug("Saving session file");
 
@@ -118,14 +172,29 @@ void SessionManager::save_session(const QString &session_file) {
 #endif
 	session_data["plugin-data"] = plugin_data;
 
-	auto object = QJsonObject::fromVariantMap(session_data);
-	QJsonDocument doc(object);
+	QVariantList comments;
+	get_comments(comments);
+
+	QVariantMap data = session_data;
+	data["comments"] = comments;
 
-	QByteArray json = doc.toJson();
 	QFile file(session_file);
 
-	if(file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-		file.write(json);
+	if(format == Json) {
+		auto object = QJsonObject::fromVariantMap(data);
+		QJsonDocument doc(object);
+
+		if(file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+			file.write(doc.toJson());
+		}
+	} else {
+		if(file.open(QIODevice::WriteOnly)) {
+			file.write(BinarySessionMagic, BinarySessionMagicSize);
+
+			QDataStream stream(&file);
+			stream.setVersion(QDataStream::Qt_4_6);
+			stream << data;
+		}
 	}
 }
 void SessionManager::load_plugin_data() {
@@ -155,51 +224,26 @@ void SessionManager::load_plugin_data() {
 * @param QVariantList &
 */
 void SessionManager::get_comments(QVariantList &data) {
-  data = session_data["comments"].toList();
+  data.clear();
+  data.reserve(comments_.size());
+  for(auto it = comments_.begin(); it != comments_.end(); ++it) {
+    QVariantMap comment;
+    comment["address"] = it.key().toHexString();
+    comment["comment"] = it.value();
+    data.push_back(comment);
+  }
 }
 /**
 * Adds a comment to the session_data
 * @param Comment & (struct in Types.h)
 */
 void SessionManager::add_comment(Comment &c) {
-  QVariantList comments_data = session_data["comments"].toList();
-  QVariantMap comment;
-  comment["address"] = c.address.toHexString();
-  comment["comment"] = c.comment;
-  if(!comments_data.isEmpty()) {
-    //Check if we already have an entry with the same address and overwrite it
-    bool found_comment = false;
-    for(auto it = comments_data.begin(); it != comments_data.end(); ++it) {
-      QVariantMap data = it->toMap();
-      if(comment["address"] == data["address"]) {
-        qDebug("Found");
-        *it = comment;
-        found_comment = true;
-        break;
-      }
-    }
-    if(!found_comment) {
-      //We found no entry with the same address
-      comments_data.push_back(comment);
-    }
-  } else {
-    comments_data.push_back(comment);
-  }
-  session_data["comments"] = comments_data;
+  comments_.insert(c.address, c.comment);
 }
 /**
 * Removes a comment from the session_data
 * @param edb::address_t
 */
 void SessionManager::remove_comment(edb::address_t address) {
-  QString hexAddressString = address.toHexString();
-  QVariantList comments_data = session_data["comments"].toList();
-  for(auto it = comments_data.begin(); it != comments_data.end(); ++it) {
-    QVariantMap data = it->toMap();
-    if(hexAddressString == data["address"]) {
-      comments_data.erase(it);
-      break;
-    }
-  }
-  session_data["comments"] = comments_data;
+  comments_.remove(address);
 }
@@ -22,19 +22,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "SessionError.h"
 #include "Types.h"
 
+#include <QHash>
 #include <QString>
 #include <QVariant>
 
 class SessionManager {
+public:
+  // sessions are saved in the binary format, JSON is kept for exporting them,
+  // loading takes either
+  enum Format {
+    Binary,
+    Json
+  };
+
 public:
   static SessionManager &instance();
   bool load_session(const QString &, SessionError&);
-  void save_session(const QString &);
+  void save_session(const QString &, Format format = Binary);
   void get_comments(QVariantList &);
   void add_comment(Comment &);
   void remove_comment(edb::address_t);
 private:
   QVariantMap session_data;
+  QHash<edb::address_t, QString> comments_; // by address, so editing one doesn't copy them all
   SessionManager() {}
   SessionManager( const SessionManager& );
   SessionManager & operator = (const SessionManager &);
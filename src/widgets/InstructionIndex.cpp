@@ -0,0 +1,91 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "InstructionIndex.h"
+#include "Status.h"
+
+#include <QObject>
+
+namespace {
+
+// a few bytes each, this is a lot of scrolling through one region
+const int MAX_STARTS = 1 << 20;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: notes that an instruction of <size> bytes starts at <address>
+//------------------------------------------------------------------------------
+void InstructionIndex::add(edb::address_t address, int size) {
+
+	if(size <= 0) {
+		return;
+	}
+
+	if(starts_.size() >= MAX_STARTS) {
+		starts_.clear();
+	}
+
+	starts_.insert(address, static_cast<quint8>(size));
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void InstructionIndex::clear() {
+	starts_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: previous
+// Desc: the start of the instruction which runs up to <address>, or which
+//       <address> is in the middle of
+//------------------------------------------------------------------------------
+Result<edb::address_t> InstructionIndex::previous(edb::address_t address) const {
+
+	auto it = starts_.lowerBound(address);
+	if(it == starts_.begin()) {
+		return Result<edb::address_t>(QObject::tr("No instruction is known before this address"), 0);
+	}
+
+	--it;
+	if(it.key() + it.value() < address) {
+		return Result<edb::address_t>(QObject::tr("The instructions before this address aren't known"), 0);
+	}
+
+	return Result<edb::address_t>(it.key());
+}
+
+//------------------------------------------------------------------------------
+// Name: boundary_before
+// Desc: the nearest address below <address> which an instruction is known to
+//       start at, or end at, to decode forwards from
+//------------------------------------------------------------------------------
+Result<edb::address_t> InstructionIndex::boundary_before(edb::address_t address) const {
+
+	auto it = starts_.lowerBound(address);
+	if(it == starts_.begin()) {
+		return Result<edb::address_t>(QObject::tr("No instruction is known before this address"), 0);
+	}
+
+	--it;
+	const edb::address_t end = it.key() + it.value();
+	return Result<edb::address_t>(end < address ? end : it.key());
+}
@@ -0,0 +1,46 @@
+/*
+Copyright (C) 2017 - 2017 Evan Teran
+                          evan.teran@gmail.com
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INSTRUCTION_INDEX_20170716_H_
+#define INSTRUCTION_INDEX_20170716_H_
+
+#include "Types.h"
+
+#include <QMap>
+
+template <class T>
+class Result;
+
+// The instruction boundaries known in one region, so that the instruction
+// before an address is a lookup rather than decoding backwards. What goes in
+// has to be a real boundary: instructions of the analyzer's basic blocks, or
+// ones decoded forwards from a boundary which was known already
+class InstructionIndex {
+public:
+	void add(edb::address_t address, int size);
+	void clear();
+
+public:
+	Result<edb::address_t> previous(edb::address_t address) const;
+	Result<edb::address_t> boundary_before(edb::address_t address) const;
+
+private:
+	QMap<edb::address_t, quint8> starts_; // the size of the instruction at each
+};
+
+#endif
@@ -26,10 +26,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IRegion.h"
 #include "ISymbolManager.h"
 #include "Instruction.h"
+#include "Instrumentation.h"
 #include "MemoryRegions.h"
 #include "SessionManager.h"
 #include "State.h"
 #include "SyntaxHighlighter.h"
+#include "TaskScheduler.h"
 #include "Util.h"
 #include "edb.h"
 
@@ -42,6 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPixmap>
 #include <QScrollBar>
 #include <QTextLayout>
+#include <QTimer>
 #include <QToolTip>
 #include <QtGlobal>
 
@@ -49,9 +52,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
 #include <climits>
+#include <cstring>
 
 namespace {
 
+// how far back from an address previous_instruction decodes forwards from, to
+// find the instruction before it
+const edb::address_t MAX_FORWARD_SWEEP = 4096;
+
+// how many screens above and below the view are read, and decoded, ahead of
+// scrolling to them
+const unsigned int PREFETCH_SCREENS = 3;
+const edb::address_t PREFETCH_PAGE_SIZE = 0x1000;
+
+//------------------------------------------------------------------------------
+// Name: decode_ahead
+// Desc: decodes [address, address + bytes.size()) so that painting it finds
+//       the instructions in the decode cache
+//------------------------------------------------------------------------------
+void decode_ahead(QVector<quint8> bytes, int offset, edb::address_t address) {
+
+	const quint8 *const first = bytes.constData();
+	const quint8 *const last  = first + bytes.size();
+
+	for(const quint8 *p = first + offset; p < last; ) {
+		const auto inst = edb::decode(p, last, address + (p - first));
+		p += inst->valid() ? inst->byte_size() : 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: replace_tokens
+// Desc: keeps <tokens> in step with the text when [index, index + length) of it
+//       is replaced by <replacement> characters
+//------------------------------------------------------------------------------
+void replace_tokens(std::vector<CapstoneEDB::Formatter::Token> *tokens, int index, int length, int replacement) {
+
+	auto it = tokens->begin();
+	while(it != tokens->end()) {
+		if(it->start + it->length <= index) {
+			++it;
+		} else if(it->start >= index + length) {
+			it->start += replacement - length;
+			++it;
+		} else {
+			it = tokens->erase(it);
+		}
+	}
+}
+
 struct WidgetState1 {
 	int version;
 	int line1;
@@ -115,12 +164,12 @@ bool near_line(int x, int linex) {
 }
 
 //------------------------------------------------------------------------------
-// Name:
-// Desc:
+// Name: instruction_size
+// Desc: the size of the instruction in <buffer>, or 1 if it isn't one
 //------------------------------------------------------------------------------
 int instruction_size(const quint8 *buffer, std::size_t size) {
-	edb::Instruction inst(buffer, buffer + size, 0);
-	return inst.byte_size();
+	const auto inst = edb::decode_brief(buffer, buffer + size, 0);
+	return inst ? static_cast<int>(inst.size) : 1;
 }
 
 //------------------------------------------------------------------------------
@@ -132,9 +181,9 @@ size_t length_disasm_back(const quint8 *buf,const size_t bufSize,const size_t cu
 	// stage 1: try to find longest instruction which ends exactly before current one
 	size_t finalSize=0;
 	for(size_t offs = curInstOffset-1;offs!=size_t(-1);--offs) {
-		const edb::Instruction inst(buf+offs, buf+curInstOffset, 0);
-		if(inst && offs+inst.byte_size()==curInstOffset) {
-			finalSize=inst.byte_size();
+		const auto inst = edb::decode(buf+offs, buf+curInstOffset, 0);
+		if(*inst && offs+inst->byte_size()==curInstOffset) {
+			finalSize=inst->byte_size();
 		}
 	}
 	if(finalSize) return finalSize;
@@ -142,12 +191,12 @@ size_t length_disasm_back(const quint8 *buf,const size_t bufSize,const size_t cu
 	// stage2: try to find a combination of previous instruction + new current instruction
 	// such that it would end exactly at the end of original current instruction
 	// we still want previous instruction to be the longest possible
-	const edb::Instruction originalCurrentInst(buf+curInstOffset,buf+bufSize,0);
+	const auto originalCurrentInst = edb::decode(buf+curInstOffset,buf+bufSize,0);
 	for(size_t offs = curInstOffset-1;offs!=size_t(-1);--offs) {
-		const edb::Instruction instPrev(buf+offs, buf+curInstOffset,0);
-		if(!instPrev) continue;
-		const edb::Instruction instNewCur(buf+offs+instPrev.byte_size(),buf+bufSize,0);
-		if(instNewCur && offs+instPrev.byte_size()+instNewCur.byte_size()==curInstOffset+originalCurrentInst.byte_size()) {
+		const auto instPrev = edb::decode(buf+offs, buf+curInstOffset,0);
+		if(!*instPrev) continue;
+		const auto instNewCur = edb::decode(buf+offs+instPrev->byte_size(),buf+bufSize,0);
+		if(*instNewCur && offs+instPrev->byte_size()+instNewCur->byte_size()==curInstOffset+originalCurrentInst->byte_size()) {
 			finalSize=curInstOffset-offs;
 		}
 	}
@@ -156,9 +205,9 @@ size_t length_disasm_back(const quint8 *buf,const size_t bufSize,const size_t cu
 	// stage 3: try to make sure the invalid single-byte won't eat the next line becoming
 	// a valid instruction: we want exactly one _new_ line above
 	for(size_t offs = curInstOffset-1;offs!=size_t(-1);--offs) {
-		const edb::Instruction inst(buf+offs, buf+bufSize, 0);
+		const auto inst = edb::decode(buf+offs, buf+bufSize, 0);
 		// all next bytes start with valid insturctions, and this one is one invalid byte
-		if(!inst) return curInstOffset-offs;
+		if(!*inst) return curInstOffset-offs;
 	}
 	// all our tries were fruitless, return failure
 	return 0;
@@ -182,6 +231,41 @@ QString format_instruction_bytes(const edb::Instruction &inst, int maxStringPx,
 	return metrics.elidedText(byte_buffer, Qt::ElideRight, maxStringPx);
 }
 
+#if QT_VERSION >= 0x040700
+//------------------------------------------------------------------------------
+// Name: make_line_text
+// Desc: lays out <text> once, so that painting it again needs no text shaping
+//------------------------------------------------------------------------------
+QStaticText make_line_text(const QString &text, const QFont &font) {
+	QStaticText layout(text);
+	layout.setTextFormat(Qt::PlainText);
+	layout.setPerformanceHint(QStaticText::AggressiveCaching);
+	layout.prepare(QTransform(), font);
+	return layout;
+}
+
+//------------------------------------------------------------------------------
+// Name: draw_line_text
+// Desc: draws <text> in the cell at <x>, <y>, it has been elided to fit already
+//------------------------------------------------------------------------------
+void draw_line_text(QPainter &painter, int x, int y, int width, int height, Qt::Alignment alignment, const QStaticText &text) {
+	Q_UNUSED(width);
+	qreal top = y;
+	if(alignment & Qt::AlignVCenter) {
+		top += (height - text.size().height()) / 2;
+	}
+	painter.drawStaticText(QPointF(x, top), text);
+}
+#else
+QString make_line_text(const QString &text, const QFont &) {
+	return text;
+}
+
+void draw_line_text(QPainter &painter, int x, int y, int width, int height, Qt::Alignment alignment, const QString &text) {
+	painter.drawText(x, y, width, height, alignment, text);
+}
+#endif
+
 }
 
 //------------------------------------------------------------------------------
@@ -207,7 +291,20 @@ QDisassemblyView::QDisassemblyView(QWidget * parent) : QAbstractScrollArea(paren
 		breakpoint_renderer_(QLatin1String(":/debugger/images/breakpoint.svg")),
 		current_renderer_(QLatin1String(":/debugger/images/arrow-right.svg")),
 		current_bp_renderer_(QLatin1String(":/debugger/images/arrow-right-red.svg")),
-		syntax_cache_(256) {
+		syntax_cache_(256),
+		lines_address_(0),
+		lines_requested_(0),
+		lines_symbols_generation_(0),
+		lines_symbol_width_(-1),
+		lines_bytes_width_(-1),
+		lines_text_width_(-1),
+		lines_laid_out_(false),
+		lines_valid_(false),
+		prefetch_address_(0),
+		prefetch_pending_(false),
+		prefetch_start_(0),
+		prefetch_generation_(0),
+		prefetch_read_generation_(0) {
 
 	setShowAddressSeparator(true);
 
@@ -216,6 +313,7 @@ QDisassemblyView::QDisassemblyView(QWidget * parent) : QAbstractScrollArea(paren
 	setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
 
 	connect(verticalScrollBar(), SIGNAL(actionTriggered(int)), this, SLOT(scrollbar_action_triggered(int)));
+	connect(&prefetch_read_, SIGNAL(finished()), this, SLOT(prefetch_read()));
 }
 
 //------------------------------------------------------------------------------
@@ -223,6 +321,7 @@ QDisassemblyView::QDisassemblyView(QWidget * parent) : QAbstractScrollArea(paren
 // Desc:
 //------------------------------------------------------------------------------
 QDisassemblyView::~QDisassemblyView() {
+	prefetch_decode_.waitForFinished();
 }
 
 //------------------------------------------------------------------------------
@@ -232,7 +331,7 @@ void QDisassemblyView::resetColumns() {
 	line1_ = 0;
 	line2_ = 0;
 	line3_ = 0;
-	update();
+	redraw();
 }
 
 //------------------------------------------------------------------------------
@@ -293,68 +392,98 @@ void QDisassemblyView::keyPressEvent(QKeyEvent *event) {
 }
 
 //------------------------------------------------------------------------------
-// Name: previous_instructions
-// Desc: attempts to find the address of the instruction <count> instructions
-//       before <current_address>
-// Note: <current_address> is a 0 based value relative to the begining of the
-//       current region, not an absolute address within the program
+// Name: previous_instruction
+// Desc: the start of the instruction before the absolute <address>, if the
+//       instruction boundaries around it are known or can be found out:
+//       from the analyzer's basic blocks, else by decoding forwards from the
+//       nearest known boundary
 //------------------------------------------------------------------------------
-edb::address_t QDisassemblyView::previous_instructions(edb::address_t current_address, int count) {
+Result<edb::address_t> QDisassemblyView::previous_instruction(edb::address_t address) {
 
-	IAnalyzer *const analyzer = edb::v1::analyzer();
+	if(const Result<edb::address_t> previous = instruction_index_.previous(address)) {
+		return previous;
+	}
 
-	for(int i = 0; i < count; ++i) {
+	if(!region_ || address <= region_->start()) {
+		return Result<edb::address_t>(tr("There is nothing before the start of the region"), 0);
+	}
 
-		// If we have an analyzer, and the current address is within a function
-		// then first we find the begining of that function.
-		// Then, we attempt to disassemble from there until we run into
-		// the address we were on (stopping one instruction early).
-		// this allows us to identify with good accuracy where the
-		// previous instruction was making upward scrolling more functional.
-		//
-		// If all else fails, fall back on the old heuristic which works "ok"
-		if(analyzer) {
-			edb::address_t address = address_offset_ + current_address;
-
-			// find the containing function
-			if(Result<edb::address_t> function_address = analyzer->find_containing_function(address)) {
-
-				if(address != *function_address) {
-					edb::address_t function_start = *function_address;
-
-					// disassemble from function start until the NEXT address is where we started
-					while(true) {
-						quint8 buf[edb::Instruction::MAX_SIZE];
-
-						int buf_size = sizeof(buf);
-						if(region_) {
-							buf_size = qMin<edb::address_t>((function_start - region_->base()), sizeof(buf));
-						}
+	if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+		analyzer->for_funcs_in_range(address - 1, address - 1, [this, address](const Function *function) {
+			for(const BasicBlock &block : *function) {
+				if(!block.empty() && block.firstAddress() < address && address <= block.lastAddress()) {
+					for(const auto &inst : block) {
+						instruction_index_.add(inst->rva(), inst->byte_size());
+					}
+				}
+			}
+			return true;
+		});
 
-						if(edb::v1::get_instruction_bytes(function_start, buf, &buf_size)) {
-							const edb::Instruction inst(buf, buf + buf_size, function_start);
-							if(!inst) {
-								break;
-							}
+		if(const Result<edb::address_t> previous = instruction_index_.previous(address)) {
+			return previous;
+		}
+	}
 
-							// if the NEXT address would be our target, then
-							// we are at the previous instruction!
-							if(function_start + inst.byte_size() >= current_address + address_offset_) {
-								break;
-							}
+	// the closest of a known boundary, the start of the function and the start
+	// of the region
+	edb::address_t anchor = region_->start();
 
-							function_start += inst.byte_size();
-						} else {
-							break;
-						}
-					}
+	if(const Result<edb::address_t> boundary = instruction_index_.boundary_before(address)) {
+		anchor = std::max(anchor, *boundary);
+	}
 
-					current_address = (function_start - address_offset_);
-					continue;
-				}
+	if(IAnalyzer *const analyzer = edb::v1::analyzer()) {
+		if(const Result<edb::address_t> function_address = analyzer->find_containing_function(address - 1)) {
+			if(*function_address < address) {
+				anchor = std::max(anchor, *function_address);
 			}
 		}
+	}
+
+	// decoding whole functions to get one line further up isn't worth it
+	if(address - anchor > MAX_FORWARD_SWEEP) {
+		return Result<edb::address_t>(tr("No instruction boundary is known close enough to this address"), 0);
+	}
+
+	int buf_size = static_cast<int>(address - anchor) + edb::Instruction::MAX_SIZE;
+	buf_size     = qMin<edb::address_t>(region_->end() - anchor, buf_size);
+
+	QVector<quint8> buf(buf_size);
+	if(!read_code(anchor, buf.data(), &buf_size)) {
+		return Result<edb::address_t>(tr("Could not read the instructions before this address"), 0);
+	}
+
+	edb::address_t current = anchor;
+	while(current < address) {
+		const int offset = static_cast<int>(current - anchor);
+		const auto inst  = edb::decode(buf.data() + offset, buf.data() + buf_size, current);
+		if(!inst->valid()) {
+			break;
+		}
+
+		instruction_index_.add(current, inst->byte_size());
+		current += inst->byte_size();
+	}
+
+	return instruction_index_.previous(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: previous_instructions
+// Desc: attempts to find the address of the instruction <count> instructions
+//       before <current_address>
+// Note: <current_address> is a 0 based value relative to the begining of the
+//       current region, not an absolute address within the program
+//------------------------------------------------------------------------------
+edb::address_t QDisassemblyView::previous_instructions(edb::address_t current_address, int count) {
+
+	for(int i = 0; i < count; ++i) {
 
+		if(const Result<edb::address_t> previous = previous_instruction(address_offset_ + current_address)) {
+			current_address = *previous - address_offset_;
+			continue;
+		}
 
 		// fall back on the old heuristic
 		// iteration goal: to get exactly one new line above current instruction line
@@ -366,8 +495,8 @@ edb::address_t QDisassemblyView::previous_instructions(edb::address_t current_ad
 			prevInstBytesSize = qMin<edb::address_t>((current_address - region_->base()), prevInstBytesSize);
 		}
 
-		if(!edb::v1::get_instruction_bytes(address_offset_+current_address-prevInstBytesSize,buf,&prevInstBytesSize) ||
-		   !edb::v1::get_instruction_bytes(address_offset_+current_address,buf+prevInstBytesSize,&curInstBytesSize)) {
+		if(!read_code(address_offset_+current_address-prevInstBytesSize,buf,&prevInstBytesSize) ||
+		   !read_code(address_offset_+current_address,buf+prevInstBytesSize,&curInstBytesSize)) {
 			current_address -= 1;
 			break;
 		}
@@ -402,12 +531,11 @@ edb::address_t QDisassemblyView::following_instructions(edb::address_t current_a
 		}
 
 		// read in the bytes...
-		if(!edb::v1::get_instruction_bytes(address_offset_ + current_address, buf, &buf_size)) {
+		if(!read_code(address_offset_ + current_address, buf, &buf_size)) {
 			current_address += 1;
 			break;
 		} else {
-			const edb::Instruction inst(buf, buf + buf_size, current_address);
-			current_address += inst.byte_size();
+			current_address += edb::decode(buf, buf + buf_size, current_address)->byte_size();
 		}
 	}
 
@@ -501,6 +629,7 @@ void QDisassemblyView::scrollbar_action_triggered(int action) {
 //------------------------------------------------------------------------------
 void QDisassemblyView::setShowAddressSeparator(bool value) {
 	show_address_separator_ = value;
+	lines_laid_out_         = false;
 }
 
 //------------------------------------------------------------------------------
@@ -519,6 +648,20 @@ QString QDisassemblyView::formatAddress(edb::address_t address) const {
 // Desc:
 //------------------------------------------------------------------------------
 void QDisassemblyView::update() {
+	// the debuggee may have run, or its code been patched
+	lines_valid_ = false;
+	instruction_index_.clear();
+	prefetch_bytes_.clear();
+	++prefetch_generation_;
+	redraw();
+}
+
+//------------------------------------------------------------------------------
+// Name: redraw
+// Desc: repaints what is shown already, for changes to the view itself rather
+//       than to what it shows
+//------------------------------------------------------------------------------
+void QDisassemblyView::redraw() {
 	viewport()->update();
 	Q_EMIT signal_updated();
 }
@@ -557,6 +700,9 @@ void QDisassemblyView::setRegion(const std::shared_ptr<IRegion> &r) {
 	// reset region, so we don't bother check that condition
 	if((r && !r->equals(region_)) || (!r)) {
 		region_ = r;
+		instruction_index_.clear();
+		prefetch_bytes_.clear();
+		++prefetch_generation_;
 		updateScrollbars();
 		Q_EMIT regionChanged();
 
@@ -602,8 +748,8 @@ bool targetIsLocal(edb::address_t targetAddress,edb::address_t insnAddress) {
 // Name: instructionString
 // Desc:
 //------------------------------------------------------------------------------
-QString QDisassemblyView::instructionString(const edb::Instruction &inst) const {
-    QString opcode = QString::fromStdString(edb::v1::formatter().to_string(inst));
+QString QDisassemblyView::instructionString(const edb::Instruction &inst, std::vector<CapstoneEDB::Formatter::Token> *tokens) const {
+    QString opcode = QString::fromStdString(edb::v1::formatter().to_string(inst, tokens));
 
     if(is_call(inst) || is_jump(inst)) {
         if(inst.operand_count() == 1) {
@@ -626,9 +772,17 @@ QString QDisassemblyView::instructionString(const edb::Instruction &inst) const
                 }
 
                 if(!sym.isEmpty()) {
-                    if(showSymbolicAddresses)
-                        opcode.replace(addrPattern, sym);
-                    else
+                    if(showSymbolicAddresses) {
+                        int index = 0;
+                        while((index = addrPattern.indexIn(opcode, index)) != -1) {
+                            const int length = addrPattern.matchedLength();
+                            opcode.replace(index, length, sym);
+                            if(tokens) {
+                                replace_tokens(tokens, index, length, sym.size());
+                            }
+                            index += sym.size();
+                        }
+                    } else
                         opcode.append(QString(" <%2>").arg(sym));
                 }
             }
@@ -642,7 +796,7 @@ QString QDisassemblyView::instructionString(const edb::Instruction &inst) const
 // Name: draw_instruction
 // Desc:
 //------------------------------------------------------------------------------
-int QDisassemblyView::draw_instruction(QPainter &painter, const edb::Instruction &inst, int y, int line_height, int l2, int l3, bool selected) {
+int QDisassemblyView::draw_instruction(QPainter &painter, const edb::Instruction &inst, const Line &entry, int y, int line_height, int l2, int l3, bool selected) {
 
 	const bool is_filling = edb::v1::arch_processor().is_filling(inst);
 	int x                 = font_width_ + font_width_ + l2 + (font_width_ / 2);
@@ -651,32 +805,19 @@ int QDisassemblyView::draw_instruction(QPainter &painter, const edb::Instruction
 
 	const bool syntax_highlighting_enabled = edb::v1::config().syntax_highlighting_enabled && !selected;
 
-    QString opcode = instructionString(inst);
+	const QString &opcode = entry.text_shown;
 
 	if(is_filling) {
         if(syntax_highlighting_enabled) {
 			painter.setPen(filling_dis_color);
 		}
 
-		opcode = painter.fontMetrics().elidedText(opcode, Qt::ElideRight, inst_pixel_width);
-
-		painter.drawText(
-			x,
-			y,
-			opcode.length() * font_width_,
-			line_height,
-			Qt::AlignVCenter,
-			opcode);
+		draw_line_text(painter, x, y, inst_pixel_width, line_height, Qt::AlignVCenter, entry.text_layout);
 	} else {
 
-        // NOTE(eteran): do this early, so that elided text still gets the part shown
-        // properly highlighted
-        QVector<QTextLayout::FormatRange> highlightData;
-        if(syntax_highlighting_enabled) {
-            highlightData = highlighter_->highlightBlock(opcode);
-        }
-
-		opcode = painter.fontMetrics().elidedText(opcode, Qt::ElideRight, inst_pixel_width);
+        // NOTE(eteran): this is of the whole text, so that elided text still
+        // gets the part shown properly highlighted
+        const QVector<QTextLayout::FormatRange> &highlightData = entry.highlight;
 
 		if(syntax_highlighting_enabled) {
 			if(!inst) {
@@ -726,14 +867,93 @@ int QDisassemblyView::draw_instruction(QPainter &painter, const edb::Instruction
 			}
 			painter.drawPixmap(x, y, *map);
 		} else {
-			QRectF rectangle(x, y, opcode.length() * font_width_, line_height);
-			painter.drawText(rectangle, Qt::AlignVCenter, opcode);
+			draw_line_text(painter, x, y, inst_pixel_width, line_height, Qt::AlignVCenter, entry.text_layout);
 		}
 	}
 
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// Name: layout_lines
+// Desc: elides and lays out the texts of lines_ for the current font, only
+//       those of the columns whose widths changed since they were last laid out
+//------------------------------------------------------------------------------
+void QDisassemblyView::layout_lines(int symbol_width, int bytes_width, int text_width) {
+
+	if(lines_laid_out_ && lines_symbol_width_ == symbol_width && lines_bytes_width_ == bytes_width && lines_text_width_ == text_width) {
+		return;
+	}
+
+	const QFont &font = this->font();
+	const QFontMetrics metrics(font);
+
+	if(!lines_laid_out_) {
+		for(std::size_t line = 0; line < lines_.size(); ++line) {
+			Line &entry = lines_[line];
+			const edb::Instruction &inst = *instructions_[line];
+
+			entry.address_shown    = make_line_text(formatAddress(show_addresses_[line]), font);
+			entry.annotation_shown = make_line_text(entry.annotation, font);
+			entry.jump_shown       = LineText();
+
+			if(is_jump(inst) && is_immediate(inst[0])) {
+				const edb::address_t target = inst[0]->imm;
+				if(target != inst.rva()) {
+					entry.jump_shown = make_line_text(QString((target > inst.rva()) ? QChar(0x2304) : QChar(0x2303)), font);
+				}
+			}
+		}
+
+		// the targets of branches from out of view get where they come from
+		// instead, as far as the analysis knows them
+		IAnalyzer *const analyzer = edb::v1::analyzer();
+		if(analyzer && !lines_.empty()) {
+			const edb::address_t first = show_addresses_.front();
+			const edb::address_t last  = show_addresses_.back() + instructions_.back()->byte_size() - 1;
+
+			for(const QPair<edb::address_t, edb::address_t> &ref : analyzer->references_into(first, last)) {
+				const edb::address_t site = ref.first;
+				if(site >= first && site <= last) {
+					continue;
+				}
+
+				auto it = std::lower_bound(show_addresses_.begin(), show_addresses_.end(), ref.second);
+				if(it != show_addresses_.end() && *it == ref.second) {
+					Line &entry = lines_[it - show_addresses_.begin()];
+					if(entry.jump_shown == LineText()) {
+						entry.jump_shown = make_line_text(QString((site < first) ? QChar(0x21b3) : QChar(0x21b1)), font);
+					}
+				}
+			}
+		}
+
+		lines_laid_out_ = true;
+	}
+
+	if(lines_symbol_width_ != symbol_width) {
+		for(Line &entry : lines_) {
+			entry.symbol_shown = make_line_text(metrics.elidedText(entry.symbol, Qt::ElideRight, symbol_width), font);
+		}
+		lines_symbol_width_ = symbol_width;
+	}
+
+	if(lines_bytes_width_ != bytes_width) {
+		for(std::size_t line = 0; line < lines_.size(); ++line) {
+			lines_[line].bytes_shown = make_line_text(format_instruction_bytes(*instructions_[line], bytes_width, metrics), font);
+		}
+		lines_bytes_width_ = bytes_width;
+	}
+
+	if(lines_text_width_ != text_width) {
+		for(Line &entry : lines_) {
+			entry.text_shown  = metrics.elidedText(entry.text, Qt::ElideRight, text_width);
+			entry.text_layout = make_line_text(entry.text_shown, font);
+		}
+		lines_text_width_ = text_width;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: paint_line_bg
 // Desc: A helper function for painting a rectangle representing a background
@@ -744,6 +964,37 @@ void QDisassemblyView::paint_line_bg(QPainter& painter, QBrush brush, int line,
 	painter.fillRect(0, lh*line, width(), lh*num_lines, brush);
 }
 
+//------------------------------------------------------------------------------
+// Name: heat_at
+// Desc: how hot the code at <address> is, 0 if it isn't
+//------------------------------------------------------------------------------
+int QDisassemblyView::heat_at(edb::address_t address) const {
+
+	auto it = heat_.upperBound(address);
+	if(it == heat_.begin()) {
+		return 0;
+	}
+
+	--it;
+	return (address <= it->last) ? it->heat : 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: setHeat
+// Desc: see edb::v1::set_code_heat
+//------------------------------------------------------------------------------
+void QDisassemblyView::setHeat(const QVector<HeatRange> &ranges) {
+
+	heat_.clear();
+	for(const HeatRange &range : ranges) {
+		if(range.heat != 0) {
+			heat_.insert(range.first, range);
+		}
+	}
+
+	viewport()->update();
+}
+
 //------------------------------------------------------------------------------
 // Name: get_line_of_address
 // Desc: A helper function which sets line to the line on which addr appears,
@@ -763,40 +1014,81 @@ bool QDisassemblyView::get_line_of_address(edb::address_t addr, unsigned int &li
 
 //------------------------------------------------------------------------------
 // Name: updateDisassembly
-// Desc: Updates instructions_, show_addresses_, partial_last_line_
-//		 Returns update for number of lines_to_render
+// Desc: Updates instructions_, show_addresses_, lines_, partial_last_line_
+//		 Returns update for number of lines_to_render. Most paints are for the
+//		 mouse, the selection or the focus, those find that nothing they show
+//		 has changed and neither read nor decode anything
 //------------------------------------------------------------------------------
 unsigned QDisassemblyView::updateDisassembly(unsigned lines_to_render)
 {
+	const edb::address_t start_address = address_offset_ + verticalScrollBar()->value();
+	const quint64 symbols_generation   = edb::v1::symbol_manager().generation();
+
+	if(lines_valid_ && start_address == lines_address_ && lines_to_render == lines_requested_ && symbols_generation == lines_symbols_generation_) {
+		if (lines_to_render != instructions_.size()) {
+			partial_last_line_ = false;
+		}
+		return instructions_.size();
+	}
+
+	lines_valid_              = true;
+	lines_address_            = start_address;
+	lines_requested_          = lines_to_render;
+	lines_symbols_generation_ = symbols_generation;
+	lines_symbol_width_       = -1;
+	lines_bytes_width_        = -1;
+	lines_text_width_         = -1;
+	lines_laid_out_           = false;
+
 	instructions_.clear();
 	show_addresses_.clear();
+	lines_.clear();
 
 	int bufsize = instruction_buffer_.size();
 	quint8 *inst_buf = &instruction_buffer_[0];
-	const edb::address_t start_address = address_offset_ + verticalScrollBar()->value();
 
-	if (!edb::v1::get_instruction_bytes(start_address, inst_buf, &bufsize)) {
+	if (!read_code(start_address, inst_buf, &bufsize)) {
 		qDebug() << "Failed to read" << bufsize << "bytes from" << QString::number(start_address, 16);
 		lines_to_render = 0;
 	}
 
 	instructions_.reserve(lines_to_render);
 	show_addresses_.reserve(lines_to_render);
+	lines_.reserve(lines_to_render);
+
+	// the addresses which the operands point to, and the line of each
+	QVector<edb::address_t> string_addresses;
+	QVector<unsigned int>   string_lines;
 
 	const int max_offset = std::min(int(region_->end() - start_address), bufsize);
 	unsigned int line = 0;
 	int offset = 0;
 	while (line < lines_to_render && offset < max_offset) {
 		edb::address_t address = start_address + offset;
-		instructions_.emplace_back(
+		instructions_.push_back(edb::decode(
 			&inst_buf[offset], // instruction bytes
 			&inst_buf[bufsize], // end of buffer
 			address // address of instruction
-		);
+		));
 		show_addresses_.push_back(address);
-;
-		if(instructions_[line].valid()) {
-			offset += instructions_[line].byte_size();
+
+		const edb::Instruction &inst = *instructions_[line];
+
+		std::vector<CapstoneEDB::Formatter::Token> tokens;
+
+		Line entry;
+		entry.symbol     = edb::v1::symbol_manager().find_address_name(address);
+		entry.text       = instructionString(inst, &tokens);
+		entry.annotation = line_annotation(address, inst, &string_addresses);
+		entry.highlight  = highlighter_->highlightTokens(entry.text, tokens);
+		lines_.push_back(entry);
+
+		while(string_lines.size() < string_addresses.size()) {
+			string_lines.push_back(line);
+		}
+
+		if(inst.valid()) {
+			offset += inst.byte_size();
 		} else {
 			++offset;
 		}
@@ -808,15 +1100,228 @@ unsigned QDisassemblyView::updateDisassembly(unsigned lines_to_render)
 		partial_last_line_ = false;
 	}
 
+	// every line's strings are looked for with one read
+	const QVector<QString> strings = edb::v1::get_human_strings_at_addresses(string_addresses);
+	for(int i = 0; i < strings.size(); ++i) {
+		if(!strings[i].isEmpty()) {
+			lines_[string_lines[i]].annotation.append(strings[i] + QLatin1Char(' '));
+		}
+	}
+
 	lines_to_render = line;
+	schedule_prefetch(start_address, lines_requested_);
 	return lines_to_render;
 }
 
+//------------------------------------------------------------------------------
+// Name: read_code
+// Desc: like edb::v1::get_instruction_bytes, but served from what prefetch()
+//       read when it covers the range
+//------------------------------------------------------------------------------
+bool QDisassemblyView::read_code(edb::address_t address, quint8 *buf, int *size) const {
+
+	Q_ASSERT(size);
+
+	if(!prefetch_bytes_.isEmpty() && region_ && address >= prefetch_address_) {
+		const edb::address_t prefetch_end = prefetch_address_ + prefetch_bytes_.size();
+		if(address < prefetch_end) {
+			const edb::address_t available = prefetch_end - address;
+
+			// a shorter read is only right if the region ends there
+			if(available >= static_cast<edb::address_t>(*size) || prefetch_end >= region_->end()) {
+				*size = qMin<edb::address_t>(available, *size);
+				std::memcpy(buf, prefetch_bytes_.constData() + (address - prefetch_address_), *size);
+				return *size != 0;
+			}
+		}
+	}
+
+	return edb::v1::get_instruction_bytes(address, buf, size);
+}
+
+//------------------------------------------------------------------------------
+// Name: schedule_prefetch
+// Desc: has prefetch() run once the pending events are handled, unless what
+//       it read last time still covers the view at <address> with room to spare
+//------------------------------------------------------------------------------
+void QDisassemblyView::schedule_prefetch(edb::address_t address, unsigned int lines) {
+
+	if(prefetch_pending_ || !region_) {
+		return;
+	}
+
+	const edb::address_t screen = lines * edb::Instruction::MAX_SIZE;
+	const edb::address_t first  = std::max(region_->start(), address - std::min(address - region_->start(), screen));
+	const edb::address_t last   = std::min(region_->end(), address + 2 * screen);
+
+	if(!prefetch_bytes_.isEmpty() && first >= prefetch_address_ && last <= prefetch_address_ + prefetch_bytes_.size()) {
+		return;
+	}
+
+	// or is on its way
+	if(prefetch_read_.isRunning() && prefetch_read_generation_ == prefetch_generation_ && !prefetch_ranges_.isEmpty()) {
+		const MemoryRange &back = prefetch_ranges_.back();
+		if(first >= prefetch_ranges_.front().address && last <= back.address + back.size) {
+			return;
+		}
+	}
+
+	prefetch_pending_ = true;
+	QTimer::singleShot(0, this, SLOT(prefetch()));
+}
+
+//------------------------------------------------------------------------------
+// Name: prefetch
+// Desc: asks for a few screens either side of the view in one batch, which
+//       prefetch_read() picks up once they have been read
+//------------------------------------------------------------------------------
+void QDisassemblyView::prefetch() {
+
+	prefetch_pending_ = false;
+
+	IProcess *const process = edb::v1::debugger_core ? edb::v1::debugger_core->process() : nullptr;
+	if(!region_ || !process) {
+		return;
+	}
+
+	const unsigned int lines   = 1 + viewport()->height() / line_height();
+	const edb::address_t span  = lines * edb::Instruction::MAX_SIZE * PREFETCH_SCREENS;
+	const edb::address_t start = address_offset_ + verticalScrollBar()->value();
+
+	const edb::address_t first = start - std::min(start - region_->start(), span);
+	const edb::address_t last  = std::min(region_->end(), start + lines * edb::Instruction::MAX_SIZE + span);
+	if(first >= last || start >= last) {
+		return;
+	}
+
+	// a page at a time, so that one which can't be read only loses itself
+	QVector<MemoryRange> ranges;
+	for(edb::address_t page = first; page < last; ) {
+		const edb::address_t next = std::min(last, page - (page % PREFETCH_PAGE_SIZE) + PREFETCH_PAGE_SIZE);
+		ranges.push_back(MemoryRange{page, static_cast<std::size_t>(next - page)});
+		page = next;
+	}
+
+	// whatever an earlier request brings back is no longer wanted
+	prefetch_ranges_          = ranges;
+	prefetch_start_           = start;
+	prefetch_read_generation_ = prefetch_generation_;
+	prefetch_read_.setFuture(process->read_async(ranges));
+}
+
+//------------------------------------------------------------------------------
+// Name: prefetch_read
+// Desc: keeps what prefetch() asked for, and has it decoded in the background.
+//       Until it is here, the view reads what it shows by itself
+//------------------------------------------------------------------------------
+void QDisassemblyView::prefetch_read() {
+
+	if(prefetch_read_.isCanceled() || prefetch_read_generation_ != prefetch_generation_ || !region_) {
+		return;
+	}
+
+	const QVector<QByteArray> pages = prefetch_read_.result();
+	const QVector<MemoryRange> &ranges = prefetch_ranges_;
+	if(pages.size() != ranges.size() || ranges.isEmpty()) {
+		return;
+	}
+
+	const edb::address_t start = prefetch_start_;
+
+	// keep the readable run which the view is in
+	int lo = 0;
+	int hi = ranges.size();
+	for(int i = 0; i < ranges.size(); ++i) {
+		if(static_cast<std::size_t>(pages[i].size()) == ranges[i].size) {
+			continue;
+		}
+
+		if(ranges[i].address + ranges[i].size <= start) {
+			lo = i + 1;
+		} else {
+			hi = i;
+			break;
+		}
+	}
+
+	if(lo >= hi) {
+		prefetch_bytes_.clear();
+		return;
+	}
+
+	const edb::address_t window_first = ranges[lo].address;
+	const edb::address_t window_last  = ranges[hi - 1].address + ranges[hi - 1].size;
+
+	QVector<quint8> bytes;
+	bytes.reserve(static_cast<int>(window_last - window_first));
+	for(int i = lo; i < hi; ++i) {
+		const QByteArray &page = pages[i];
+		for(int j = 0; j < page.size(); ++j) {
+			bytes.push_back(static_cast<quint8>(page[j]));
+		}
+	}
+
+	prefetch_address_ = window_first;
+	prefetch_bytes_   = bytes;
+
+	// going down, the instructions are where decoding from the view's start
+	// says. Going up they depend on where the index finds the boundaries, so
+	// only the way down is decoded ahead
+	if(start >= window_first && start < window_last) {
+		const int offset = static_cast<int>(start - window_first);
+
+		prefetch_decode_.waitForFinished();
+		prefetch_decode_ = edb::v1::task_scheduler().run("QDisassemblyView::decode_ahead", TaskScheduler::Interactive, QString(), [bytes, offset, window_first](const TaskToken &) {
+			decode_ahead(bytes, offset, window_first);
+		});
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: line_annotation
+// Desc: the comment at <address>. Failing that, the addresses which the
+//       operands of <inst> point to are added to <strings>, the strings there
+//       are looked for once all of the lines are known
+//------------------------------------------------------------------------------
+QString QDisassemblyView::line_annotation(edb::address_t address, const edb::Instruction &inst, QVector<edb::address_t> *strings) const {
+
+	Q_ASSERT(strings);
+
+	QString annotation = comments_.value(address, QString(""));
+	if (annotation.isEmpty() && inst && !is_jump(inst) && !is_call(inst)) {
+		// draw ascii representations of immediate constants
+		unsigned int op_count = inst.operand_count();
+		for (unsigned int op_idx = 0; op_idx < op_count; op_idx++) {
+			auto oper = inst[op_idx];
+			edb::address_t ascii_address = 0;
+			if (is_immediate(oper)) {
+				ascii_address = oper->imm;
+			} else if (
+				is_expression(oper) &&
+				oper->mem.index == X86_REG_INVALID &&
+				oper->mem.disp != 0)
+			{
+				if (oper->mem.base == X86_REG_RIP) {
+					ascii_address += address + inst.byte_size() + oper->mem.disp;
+				} else if (oper->mem.base == X86_REG_INVALID && oper->mem.disp > 0) {
+					ascii_address = oper->mem.disp;
+				}
+			}
+
+			if (ascii_address != 0) {
+				strings->push_back(ascii_address);
+			}
+		}
+	}
+
+	return annotation;
+}
+
 unsigned QDisassemblyView::getSelectedLineNumber() const
 {
 	unsigned int selected_line = 65535; // can't accidentally hit this
 	for(unsigned line=0;line<instructions_.size();++line) {
-		if (instructions_[line].rva() == selectedAddress()) {
+		if (instructions_[line]->rva() == selectedAddress()) {
 			selected_line = line;
 		}
 	}
@@ -829,6 +1334,8 @@ unsigned QDisassemblyView::getSelectedLineNumber() const
 //------------------------------------------------------------------------------
 void QDisassemblyView::paintEvent(QPaintEvent *) {
 
+	EDB_TRACE_SCOPE("QDisassemblyView::paintEvent");
+
 	QElapsedTimer timer;
 	timer.start();
 
@@ -886,6 +1393,39 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 				}
 			}
 		}
+		// the heat goes over the alternation, so it has to be translucent
+		if(!heat_.isEmpty()) {
+			for(unsigned int n = 0; n < lines_to_render; ++n) {
+				if(const int heat = heat_at(show_addresses_[n])) {
+					paint_line_bg(painter, QColor(255, 128, 0, 32 + heat / 2), n);
+				}
+			}
+		}
+
+		// and so do the lines with patched bytes, found with one range query
+		// for all that is shown
+		if(lines_to_render != 0) {
+			if(IProcess *process = edb::v1::debugger_core->process()) {
+				const edb::address_t first = show_addresses_[0];
+				const edb::address_t last  = show_addresses_[lines_to_render - 1] + instructions_[lines_to_render - 1]->byte_size();
+				const QList<Patch> patches = process->patches_in(first, last.toUint() - first.toUint());
+
+				auto patch = patches.begin();
+				for(unsigned int n = 0; n < lines_to_render && patch != patches.end(); ++n) {
+					const edb::address_t line_start = show_addresses_[n];
+					const edb::address_t line_end   = line_start + instructions_[n]->byte_size();
+
+					while(patch != patches.end() && patch->address + patch->new_bytes.size() <= line_start) {
+						++patch;
+					}
+
+					if(patch != patches.end() && patch->address < line_end) {
+						paint_line_bg(painter, QColor(255, 0, 0, 48), n);
+					}
+				}
+			}
+		}
+
 		if (selected_line < lines_to_render) {
 			paint_line_bg(painter, palette().color(group, QPalette::Highlight), selected_line);
 		}
@@ -979,25 +1519,18 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 	const int l2 = line2() + l0;
 	const int l3 = line3() + l0;
 
+	const int symbol_x    = l0 + auto_line1();
+	const int bytes_width = l2 - l1 - font_width_ / 2;
+	const int text_x      = font_width_ + font_width_ + l2 + (font_width_ / 2);
+	layout_lines(l1 - symbol_x, bytes_width, l3 - text_x);
+
 	{ // SYMBOL NAMES
 		painter.setPen(palette().color(group,QPalette::Text));
-		const int x = l0 + auto_line1();
-		const int width = l1 - x;
+		const int width = l1 - symbol_x;
 		if (width > 0) {
 			for (unsigned int line = 0; line < lines_to_render; line++) {
-				auto address = show_addresses_[line];
-				const QString sym = edb::v1::symbol_manager().find_address_name(address);
-				if(!sym.isEmpty()) {
-					const QString symbol_buffer = painter.fontMetrics().elidedText(sym, Qt::ElideRight, width);
-
-					painter.drawText(
-						x,
-						line * line_height,
-						width,
-						line_height,
-						Qt::AlignVCenter,
-						symbol_buffer
-					);
+				if(!lines_[line].symbol.isEmpty()) {
+					draw_line_text(painter, symbol_x, line * line_height, width, line_height, Qt::AlignVCenter, lines_[line].symbol_shown);
 				}
 			}
 		}
@@ -1027,68 +1560,29 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 				icon->render(&painter, QRectF(icon_x, line*line_height + 1, icon_width_, icon_height_));
 			}
 
-			const QString address_buffer = formatAddress(address);
 			// draw the address
-			painter.drawText(
-				addr_x,
-				line * line_height,
-				addr_width,
-				line_height,
-				Qt::AlignVCenter,
-				address_buffer
-			);
+			draw_line_text(painter, addr_x, line * line_height, addr_width, line_height, Qt::AlignVCenter, lines_[line].address_shown);
 		}
 	}
 
 	{ // INSTRUCTION BYTES AND RELJMP INDICATOR RENDERING
-		const int bytes_width = l2 - l1 - font_width_ / 2;
-		const auto metrics = painter.fontMetrics();
-
-		auto painter_lambda = [&](const edb::Instruction &inst, int line) {
+		auto painter_lambda = [&](int line) {
 			// for relative jumps draw the jump direction indicators
-			if(is_jump(inst) && is_immediate(inst[0])) {
-				const edb::address_t target = inst[0]->imm;
-
-				if(target != inst.rva()) {
-					painter.drawText(
-						l2,
-						line * line_height,
-						l3 - l2,
-						line_height,
-						Qt::AlignVCenter,
-						QString((target > inst.rva()) ? QChar(0x2304) : QChar(0x2303))
-					);
-				}
-			}
-			const QString byte_buffer = format_instruction_bytes(
-				inst,
-				bytes_width,
-				metrics
-			);
-
-			painter.drawText(
-				l1 + (font_width_ / 2),
-				line * line_height,
-				bytes_width,
-				line_height,
-				Qt::AlignVCenter,
-				byte_buffer
-			);
+			draw_line_text(painter, l2, line * line_height, l3 - l2, line_height, Qt::AlignVCenter, lines_[line].jump_shown);
+			draw_line_text(painter, l1 + (font_width_ / 2), line * line_height, bytes_width, line_height, Qt::AlignVCenter, lines_[line].bytes_shown);
 		};
 
 		painter.setPen(palette().color(group,QPalette::Text));
 
 		for (unsigned int line = 0; line < lines_to_render; line++) {
-
-			auto &&inst = instructions_[line];
 			if (selected_line != line) {
-				painter_lambda(inst, line);
+				painter_lambda(line);
 			}
 		}
 
 		if (selected_line < lines_to_render) {
 			painter.setPen(palette().color(group,QPalette::HighlightedText));
-			painter_lambda(instructions_[selected_line], selected_line);
+			painter_lambda(selected_line);
 		}
 	}
 
@@ -1135,7 +1629,7 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 
 				// find the end and draw the other corner
 				for (end_line = start_line; end_line < lines_to_render; end_line++) {
-					auto adjusted_end_addr = show_addresses_[end_line] + instructions_[end_line].byte_size() - 1;
+					auto adjusted_end_addr = show_addresses_[end_line] + instructions_[end_line]->byte_size() - 1;
 					if (adjusted_end_addr == end_addr) {
 						auto y = end_line * line_height;
 						// half of a vertical
@@ -1176,50 +1670,13 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 		auto comment_width = width() - x_pos;
 
 		for (unsigned int line = 0; line < lines_to_render; line++) {
-			auto address = show_addresses_[line];
-
 			if (selected_line == line) {
 				painter.setPen(palette().color(group, QPalette::HighlightedText));
 			} else {
 				painter.setPen(palette().color(group, QPalette::Text));
 			}
 
-			QString annotation = comments_.value(address, QString(""));
-			auto && inst = instructions_[line];
-			if (annotation.isEmpty() && inst && !is_jump(inst) && !is_call(inst)) {
-				// draw ascii representations of immediate constants
-				unsigned int op_count = inst.operand_count();
-				for (unsigned int op_idx = 0; op_idx < op_count; op_idx++) {
-					auto oper = inst[op_idx];
-					edb::address_t ascii_address = 0;
-					if (is_immediate(oper)) {
-						ascii_address = oper->imm;
-					} else if (
-						is_expression(oper) &&
-						oper->mem.index == X86_REG_INVALID &&
-						oper->mem.disp != 0)
-					{
-						if (oper->mem.base == X86_REG_RIP) {
-							ascii_address += address + inst.byte_size() + oper->mem.disp;
-						} else if (oper->mem.base == X86_REG_INVALID && oper->mem.disp > 0) {
-							ascii_address = oper->mem.disp;
-						}
-					}
-
-					QString string_param;
-					if (edb::v1::get_human_string_at_address(ascii_address, string_param)) {
-						annotation.append(string_param);
-					}
-				}
-			}
-			painter.drawText(
-				x_pos,
-				line * line_height,
-				comment_width,
-				line_height,
-				Qt::AlignLeft,
-				annotation
-			);
+			draw_line_text(painter, x_pos, line * line_height, comment_width, line_height, Qt::AlignLeft, lines_[line].annotation_shown);
 		}
 
 	}
@@ -1231,10 +1688,10 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 			// syntax highlighting
 			if (selected_line == line) {
 				painter.setPen(palette().color(group, QPalette::HighlightedText));
-				draw_instruction(painter, instructions_[line], line * line_height, line_height, l2, l3, true);
+				draw_instruction(painter, *instructions_[line], lines_[line], line * line_height, line_height, l2, l3, true);
 			} else {
 				painter.setPen(palette().color(group, QPalette::Text));
-				draw_instruction(painter, instructions_[line], line * line_height, line_height, l2, l3, false);
+				draw_instruction(painter, *instructions_[line], lines_[line], line * line_height, line_height, l2, l3, false);
 			}
 		}
 	}
@@ -1259,6 +1716,7 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 //------------------------------------------------------------------------------
 void QDisassemblyView::setFont(const QFont &f) {
 	syntax_cache_.clear();
+	lines_valid_ = false;
 
 	QFont newFont(f);
 
@@ -1403,7 +1861,7 @@ Result<int> QDisassemblyView::get_instruction_size(edb::address_t address, quint
 
 
 	if(*size >= 0) {
-		bool ok = edb::v1::get_instruction_bytes(address, buf, size);
+		bool ok = read_code(address, buf, size);
 
 		if(ok) {
 			return edb::v1::make_result(instruction_size(buf, *size));
@@ -1473,7 +1931,7 @@ void QDisassemblyView::mouseDoubleClickEvent(QMouseEvent *event) {
 
 				if(region_->contains(address)) {
 					Q_EMIT breakPointToggled(address);
-					update();
+					redraw();
 				}
 			}
 		}
@@ -1501,8 +1959,7 @@ bool QDisassemblyView::event(QEvent *event) {
 				// do the longest read we can while still not passing the region end
 				int buf_size = qMin<edb::address_t>((region_->end() - address), sizeof(buf));
 				if(edb::v1::get_instruction_bytes(address, buf, &buf_size)) {
-					const edb::Instruction inst(buf, buf + buf_size, address);
-					const QString byte_buffer = format_instruction_bytes(inst);
+					const QString byte_buffer = format_instruction_bytes(*edb::decode(buf, buf + buf_size, address));
 
 					if((line1() + byte_buffer.size() * font_width_) > line2()) {
                         QToolTip::showText(helpEvent->globalPos(), byte_buffer);
@@ -1536,7 +1993,7 @@ void QDisassemblyView::mouseReleaseEvent(QMouseEvent *event) {
 	selecting_address_ = false;
 
 	setCursor(Qt::ArrowCursor);
-	update();
+	redraw();
 }
 
 //------------------------------------------------------------------------------
@@ -1590,7 +2047,7 @@ void QDisassemblyView::mouseMoveEvent(QMouseEvent *event) {
 			const int min_line1 = icon_width_ + font_width_ * 5;
 			const int max_line1 = line2() - font_width_;
 			line1_ = std::min(std::max(min_line1, x_pos), max_line1);
-			update();
+			redraw();
 		} else if(moving_line2_) {
 			if(line3_ == 0) {
 				line3_ = line3();
@@ -1598,12 +2055,12 @@ void QDisassemblyView::mouseMoveEvent(QMouseEvent *event) {
 			const int min_line2 = line1() + font_width_ + font_width_/2;
 			const int max_line2 = line3() - font_width_;
 			line2_ = std::min(std::max(min_line2, x_pos), max_line2);
-			update();
+			redraw();
 		} else if(moving_line3_) {
 			const int min_line3 = line2() + font_width_;
 			const int max_line3 = width() - 1 - (verticalScrollBar()->width() + 3);
 			line3_ = std::min(std::max(min_line3, x_pos), max_line3);
-			update();
+			redraw();
 		} else {
 			if(near_line(x_pos, line1()) || near_line(x_pos, line2()) || near_line(x_pos, line3())) {
 				setCursor(Qt::SplitHCursor);
@@ -1643,7 +2100,7 @@ void QDisassemblyView::setSelectedAddress(edb::address_t address) {
 			selected_instruction_size_    = 0;
 		}
 
-		update();
+		redraw();
 	}
 }
 
@@ -1675,6 +2132,7 @@ void QDisassemblyView::add_comment(edb::address_t address, QString comment) {
 	};
 	SessionManager::instance().add_comment(temp_comment);
 	comments_.insert(address, comment);
+	lines_valid_ = false;
 }
 
 //------------------------------------------------------------------------------
@@ -1683,6 +2141,7 @@ void QDisassemblyView::add_comment(edb::address_t address, QString comment) {
 //------------------------------------------------------------------------------
 int QDisassemblyView::remove_comment(edb::address_t address) {
 	SessionManager::instance().remove_comment(address);
+	lines_valid_ = false;
 	return comments_.remove(address);
 }
 
@@ -1700,6 +2159,7 @@ QString QDisassemblyView::get_comment(edb::address_t address) {
 //------------------------------------------------------------------------------
 void QDisassemblyView::clear_comments() {
 	comments_.clear();
+	lines_valid_ = false;
 }
 
 //------------------------------------------------------------------------------
@@ -19,14 +19,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef QDISASSEMBLYVIEW_20061101_H_
 #define QDISASSEMBLYVIEW_20061101_H_
 
+#include "Formatter.h"
+#include "HeatRange.h"
+#include "InstructionIndex.h"
+#include "MemoryRange.h"
 #include "NavigationHistory.h"
 #include "Types.h"
 
 #include <QAbstractScrollArea>
 #include <QAbstractSlider>
 #include <QCache>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QMap>
 #include <QPixmap>
 #include <QSvgRenderer>
+#include <QTextLayout>
+#include <QVector>
+#if QT_VERSION >= 0x040700
+#include <QStaticText>
+#endif
+
+#include <vector>
 
 template <class T>
 class Result;
@@ -68,6 +82,7 @@ public:
 	QByteArray saveState() const;
 	void restoreState(const QByteArray &stateBuffer);
 	void restoreComments(QVariantList &);
+	void setHeat(const QVector<HeatRange> &ranges);
 
 Q_SIGNALS:
 	void signal_updated();
@@ -86,20 +101,53 @@ public Q_SLOTS:
 
 private Q_SLOTS:
 	void scrollbar_action_triggered(int action);
+	void prefetch();
+	void prefetch_read();
 
 signals:
 	void breakPointToggled(edb::address_t address);
 	void regionChanged();
 
 private:
+#if QT_VERSION >= 0x040700
+	typedef QStaticText LineText;
+#else
+	typedef QString LineText; // no QStaticText before Qt 4.7, shaped per paint
+#endif
+
+	// what painting a line needs which is costly to work out, it stays valid
+	// until the view scrolls, the symbols change or update() says the debuggee
+	// may have. The *_shown texts are laid out by layout_lines for the font and
+	// column widths they are painted with
+	struct Line {
+		QString symbol;
+		QString text;       // the instruction, with its target's name
+		QString text_shown; // text elided to lines_text_width_, keys syntax_cache_
+		QString annotation; // the comment, or the strings the operands point to
+		QVector<QTextLayout::FormatRange> highlight; // of text
+		LineText symbol_shown;     // elided to lines_symbol_width_
+		LineText address_shown;
+		LineText bytes_shown;      // elided to lines_bytes_width_
+		LineText jump_shown;       // the direction of a relative jump, or of one to it
+		LineText text_layout;      // of text_shown
+		LineText annotation_shown;
+	};
+
+private:
+	QString line_annotation(edb::address_t address, const edb::Instruction &inst, QVector<edb::address_t> *strings) const;
+	void redraw();
+	bool read_code(edb::address_t address, quint8 *buf, int *size) const;
+	void schedule_prefetch(edb::address_t address, unsigned int lines);
 	QString formatAddress(edb::address_t address) const;
 	edb::address_t address_from_coord(int x, int y) const;
 	edb::address_t previous_instructions(edb::address_t current_address, int count);
+	Result<edb::address_t> previous_instruction(edb::address_t address);
 	edb::address_t following_instructions(edb::address_t current_address, int count);
 	int address_length() const;
 	int auto_line1() const;
-	int draw_instruction(QPainter &painter, const edb::Instruction &inst, int y, int line_height, int l2, int l3, bool selected);
-    QString instructionString(const edb::Instruction &inst) const;
+	int draw_instruction(QPainter &painter, const edb::Instruction &inst, const Line &entry, int y, int line_height, int l2, int l3, bool selected);
+	void layout_lines(int symbol_width, int bytes_width, int text_width);
+	QString instructionString(const edb::Instruction &inst, std::vector<CapstoneEDB::Formatter::Token> *tokens = nullptr) const;
 	Result<int> get_instruction_size(edb::address_t address) const;
 	Result<int> get_instruction_size(edb::address_t address, quint8 *buf, int *size) const;
 	int line1() const;
@@ -109,6 +157,7 @@ private:
 	void updateScrollbars();
 	void updateSelectedAddress(QMouseEvent *event);
 	void paint_line_bg(QPainter &painter, QBrush brush, int line, int num_lines = 1);
+	int heat_at(edb::address_t address) const;
 	bool get_line_of_address(edb::address_t addr, unsigned int& line) const;
 	unsigned updateDisassembly(unsigned lines_to_render);
 	unsigned getSelectedLineNumber() const;
@@ -116,7 +165,7 @@ private:
 private:
 	std::shared_ptr<IRegion>          region_;
 	QVector<edb::address_t>           show_addresses_;
-	std::vector<CapstoneEDB::Instruction> instructions_;
+	std::vector<std::shared_ptr<CapstoneEDB::Instruction>> instructions_;
 	SyntaxHighlighter *const          highlighter_;
 	edb::address_t                    address_offset_;
 	edb::address_t                    selected_instruction_address_;
@@ -137,12 +186,32 @@ private:
 	bool                              show_address_separator_;
 	bool                              partial_last_line_;
 	QHash<edb::address_t, QString>    comments_;
+	QMap<edb::address_t, HeatRange>   heat_; // by first address
 	NavigationHistory                 history_;
+	InstructionIndex                  instruction_index_; // of region_
 	QSvgRenderer                      breakpoint_renderer_;
 	QSvgRenderer                      current_renderer_;
 	QSvgRenderer                      current_bp_renderer_;
 	QVector<quint8>                   instruction_buffer_;
 	QCache<QString, QPixmap>          syntax_cache_;
+	std::vector<Line>                 lines_;
+	edb::address_t                    lines_address_;
+	unsigned int                      lines_requested_;
+	quint64                           lines_symbols_generation_;
+	int                               lines_symbol_width_;
+	int                               lines_bytes_width_;
+	int                               lines_text_width_;
+	bool                              lines_laid_out_;   // the texts which don't depend on a column width
+	bool                              lines_valid_;
+	QVector<quint8>                   prefetch_bytes_;   // a few screens around the view, read ahead of scrolling
+	edb::address_t                    prefetch_address_;
+	QFuture<void>                     prefetch_decode_;
+	bool                              prefetch_pending_;
+	QFutureWatcher<QVector<QByteArray>> prefetch_read_; // the pages prefetch() asked for, until they arrive
+	QVector<MemoryRange>              prefetch_ranges_;
+	edb::address_t                    prefetch_start_;
+	quint64                           prefetch_generation_; // bumped whenever bytes read before may be stale
+	quint64                           prefetch_read_generation_;
 };
 
 #endif
@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace {
 
+// there are only so many mnemonics, this is just in case of garbage
+const int MAX_MNEMONIC_RANGES = 4096;
+
 QTextCharFormat createRule(const QBrush &foreground, const QBrush &background, int weight, bool italic, bool underline) {
 	QTextCharFormat format;
 	format.setForeground(foreground);
@@ -45,7 +48,7 @@ SyntaxHighlighter::SyntaxHighlighter(QObject *parent) : QObject(parent) {
 // Name: HighlightingRule::HighlightingRule
 // Desc:
 //------------------------------------------------------------------------------
-SyntaxHighlighter::HighlightingRule::HighlightingRule() {
+SyntaxHighlighter::HighlightingRule::HighlightingRule() : token(CapstoneEDB::Formatter::TokenMnemonic) {
 
 }
 
@@ -53,7 +56,7 @@ SyntaxHighlighter::HighlightingRule::HighlightingRule() {
 // Name: HighlightingRule::HighlightingRule
 // Desc:
 //------------------------------------------------------------------------------
-SyntaxHighlighter::HighlightingRule::HighlightingRule(const QString &regex, const QBrush &foreground, const QBrush &background, int weight, bool italic, bool underline) : pattern(regex) {
+SyntaxHighlighter::HighlightingRule::HighlightingRule(TokenType token, const QString &regex, const QBrush &foreground, const QBrush &background, int weight, bool italic, bool underline) : token(token), pattern(regex) {
 
 	pattern.setCaseSensitivity(Qt::CaseInsensitive);
 	format = createRule(foreground, background, weight, italic, underline);
@@ -76,6 +79,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// comma
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenBracket,
 		"(?:,)",
 		QColor(settings.value("theme.brackets.foreground", "blue").toString()),
 		QColor(settings.value("theme.brackets.background", "transparent").toString()),
@@ -86,6 +90,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// expression brackets
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenBracket,
 		"(?:[\\(?:\\)\\[\\]])",
 		QColor(settings.value("theme.brackets.foreground", "blue").toString()),
 		QColor(settings.value("theme.brackets.background", "transparent").toString()),
@@ -96,6 +101,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// math operators
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenOperator,
 		"\\b(?:[\\+\\-\\*])\\b",
 		QColor(settings.value("theme.operator.foreground", "blue").toString()),
 		QColor(settings.value("theme.operator.background", "transparent").toString()),
@@ -107,6 +113,7 @@ void SyntaxHighlighter::create_rules() {
 	// registers
 	// TODO: support ST(N)
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenRegister,
 #if defined EDB_X86 || defined EDB_X86_64
 		"\\b(?:(?:(?:e|r)?(?:ax|bx|cx|dx|bp|sp|si|di|ip))|(?:[abcd](?:l|h))|(?:sp|bp|si|di)l|(?:[cdefgs]s)|[xyz]?mm(?:[0-9]|[12][0-9]|3[01])|r(?:8|9|(?:1[0-5]))[dwb]?)\\b",
 #elif defined EDB_ARM32
@@ -125,6 +132,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// constants
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenConstant,
 #if defined EDB_ARM32 || defined EDB_ARM64
 		"#?" /* concatenated with general number pattern */
 #endif
@@ -139,6 +147,7 @@ void SyntaxHighlighter::create_rules() {
 #if defined EDB_X86 || defined EDB_X86_64
 	// pointer modifiers
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenPointer,
 		"\\b(?:t?byte|(?:[xyz]mm|[qdf]?)word)(?: ptr)?\\b",
 		QColor(settings.value("theme.ptr.foreground", "darkGreen").toString()),
 		QColor(settings.value("theme.ptr.background", "transparent").toString()),
@@ -149,6 +158,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// prefix
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenPrefix,
 		"\\b(?:lock|rep(?:ne)?)\\b",
 		QColor(settings.value("theme.prefix.foreground", "black").toString()),
 		QColor(settings.value("theme.prefix.background", "transparent").toString()),
@@ -161,6 +171,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// flow control
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 #if defined EDB_X86 || defined EDB_X86_64
 		"\\b(?:l?jmp[bswlqt]?|loopn?[ez]|(?:jn?(?:a|ae|b|be|c|e|g|ge|l|le|o|p|s|z)|j(?:pe|po|cxz|ecxz)))\\b",
 #elif defined EDB_ARM32 || defined EDB_ARM64
@@ -180,6 +191,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// function call
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 #if defined EDB_X86 || defined EDB_X86_64
 		"\\b(?:call|ret[nf]?)[bswlqt]?\\b",
 #elif defined EDB_ARM32 || defined EDB_ARM64
@@ -199,6 +211,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// stack operations
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:pushf?|popf?|enter|leave)\\b",
 		QColor(settings.value("theme.stack.foreground", "blue").toString()),
 		QColor(settings.value("theme.stack.background", "transparent").toString()),
@@ -209,6 +222,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// comparison
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:cmp|test)[bswlqt]?\\b",
 		QColor(settings.value("theme.comparison.foreground", "blue").toString()),
 		QColor(settings.value("theme.comparison.background", "transparent").toString()),
@@ -220,6 +234,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// data transfer
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:c?movs[bw]|lea|xchg|mov(?:[zs]x?)?)[bswlqt]?\\b",
 		QColor(settings.value("theme.data_xfer.foreground", "blue").toString()),
 		QColor(settings.value("theme.data_xfer.background", "transparent").toString()),
@@ -230,6 +245,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// arithmetic
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:add|sub|i?mul|i?div|neg|adc|sbb|inc|dec)[bswlqt]?\\b",
 		QColor(settings.value("theme.arithmetic.foreground", "blue").toString()),
 		QColor(settings.value("theme.arithmetic.background", "transparent").toString()),
@@ -240,6 +256,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// logic
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:and|x?or|not)[bswlqt]?\\b",
 		QColor(settings.value("theme.logic.foreground", "blue").toString()),
 		QColor(settings.value("theme.logic.background", "transparent").toString()),
@@ -250,6 +267,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// shift
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:sh|sa|sc|ro)[rl][bswlqt]?\\b",
 		QColor(settings.value("theme.shift.foreground", "blue").toString()),
 		QColor(settings.value("theme.shift.background", "transparent").toString()),
@@ -260,6 +278,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// system
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:sti|cli|hlt|in|out|sysenter|sysexit|syscall|sysret|int)\\b",
 		QColor(settings.value("theme.system.foreground", "blue").toString()),
 		QColor(settings.value("theme.system.background", "transparent").toString()),
@@ -271,6 +290,7 @@ void SyntaxHighlighter::create_rules() {
 
 	// data bytes
 	rules_.push_back(HighlightingRule(
+		CapstoneEDB::Formatter::TokenMnemonic,
 		"\\b(?:db|dw|dd|dq)\\b",
 		QColor(settings.value("theme.data.foreground", "black").toString()),
 		QColor(settings.value("theme.data.background", "transparent").toString()),
@@ -307,3 +327,61 @@ QVector<QTextLayout::FormatRange> SyntaxHighlighter::highlightBlock(const QStrin
 
 	return ranges;
 }
+
+//------------------------------------------------------------------------------
+// Name: highlightTokens
+// Desc: like highlightBlock, but for text which the formatter has already
+//       split up, so only the mnemonics are ever matched against a pattern
+//------------------------------------------------------------------------------
+QVector<QTextLayout::FormatRange> SyntaxHighlighter::highlightTokens(const QString &text, const std::vector<Token> &tokens) {
+
+	QVector<QTextLayout::FormatRange> ranges;
+
+	for(const Token &token : tokens) {
+		if(token.start < 0 || token.length <= 0 || token.start + token.length > text.size()) {
+			continue;
+		}
+
+		if(token.type == CapstoneEDB::Formatter::TokenMnemonic) {
+			const QString mnemonic = text.mid(token.start, token.length);
+
+			auto it = mnemonic_ranges_.find(mnemonic);
+			if(it == mnemonic_ranges_.end()) {
+				if(mnemonic_ranges_.size() >= MAX_MNEMONIC_RANGES) {
+					mnemonic_ranges_.clear();
+				}
+
+				QVector<QTextLayout::FormatRange> matched;
+				Q_FOREACH(const HighlightingRule &rule, rules_) {
+					if(rule.token == CapstoneEDB::Formatter::TokenMnemonic && rule.pattern.exactMatch(mnemonic)) {
+						QTextLayout::FormatRange range;
+						range.format = rule.format;
+						range.start  = 0;
+						range.length = mnemonic.size();
+						matched.push_back(range);
+					}
+				}
+				it = mnemonic_ranges_.insert(mnemonic, matched);
+			}
+
+			for(QTextLayout::FormatRange range : *it) {
+				range.start += token.start;
+				ranges.push_back(range);
+			}
+			continue;
+		}
+
+		Q_FOREACH(const HighlightingRule &rule, rules_) {
+			if(rule.token == token.type) {
+				QTextLayout::FormatRange range;
+				range.format = rule.format;
+				range.start  = token.start;
+				range.length = token.length;
+				ranges.push_back(range);
+				break;
+			}
+		}
+	}
+
+	return ranges;
+}
@@ -19,6 +19,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef SYNTAX_HIGHLIGHTER_H
 #define SYNTAX_HIGHLIGHTER_H
 
+#include "Formatter.h"
+#include <QHash>
 #include <QVector>
 #include <QRegExp>
 #include <QTextCharFormat>
@@ -33,19 +35,29 @@ public:
 private:
 	void create_rules();
 
+public:
+	typedef CapstoneEDB::Formatter::Token     Token;
+	typedef CapstoneEDB::Formatter::TokenType TokenType;
+
 public:
 	QVector<QTextLayout::FormatRange> highlightBlock(const QString &text);
+	QVector<QTextLayout::FormatRange> highlightTokens(const QString &text, const std::vector<Token> &tokens);
 
 private:
 	struct HighlightingRule {
 		HighlightingRule();
-		HighlightingRule(const QString &regex, const QBrush &foreground, const QBrush &background, int weight, bool italic, bool underline);
+		HighlightingRule(TokenType token, const QString &regex, const QBrush &foreground, const QBrush &background, int weight, bool italic, bool underline);
 
+		TokenType       token;
 		QRegExp         pattern;
 		QTextCharFormat format;
 	};
 
 	QVector<HighlightingRule> rules_;
+
+	// the rules for mnemonics are still patterns, but each distinct mnemonic
+	// only has to be matched against them once
+	QHash<QString, QVector<QTextLayout::FormatRange>> mnemonic_ranges_;
 };
 
 #endif